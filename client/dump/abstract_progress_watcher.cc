@@ -91,7 +91,7 @@ void Abstract_progress_watcher::object_processing_ended(
           finished_process_data->get_process_task_object());
   if (processed_table_task != nullptr &&
       finished_process_data->had_chain_created()) {
-    m_progress.m_table_count++;
+    if (processed_table_task->is_last_chunk()) m_progress.m_table_count++;
     this->progress_changed();
     return;
   }
@@ -0,0 +1,101 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+
+#include "client/dump/compression_zstd_writer.h"
+
+#include <functional>
+
+using namespace Mysql::Tools::Dump;
+
+void Compression_zstd_writer::process_buffer(ZSTD_inBuffer *input,
+                                             ZSTD_EndDirective directive) {
+  size_t remaining;
+  do {
+    ZSTD_outBuffer output = {&m_buffer[0], m_buffer.size(), 0};
+    remaining = ZSTD_compressStream2(m_compression_context, &output, input,
+                                     directive);
+    if (ZSTD_isError(remaining)) {
+      this->pass_message(Mysql::Tools::Base::Message_data(
+          0,
+          std::string("zstd compression failed: ") +
+              ZSTD_getErrorName(remaining),
+          Mysql::Tools::Base::Message_type_error));
+      return;
+    }
+    if (output.pos > 0)
+      this->append_output(std::string(&m_buffer[0], output.pos));
+    /*
+      With workers input is consumed once it is copied to their buffers, the
+      frame is complete once nothing remains to be flushed.
+    */
+  } while (directive == ZSTD_e_end ? remaining != 0
+                                   : input->pos < input->size);
+}
+
+void Compression_zstd_writer::append(const std::string &data_to_append) {
+  std::lock_guard<std::mutex> lock(m_zstd_mutex);
+  ZSTD_inBuffer input = {data_to_append.data(), data_to_append.size(), 0};
+  this->process_buffer(&input, ZSTD_e_continue);
+}
+
+Compression_zstd_writer::~Compression_zstd_writer() {
+  std::lock_guard<std::mutex> lock(m_zstd_mutex);
+  if (m_compression_context == nullptr) return;
+  ZSTD_inBuffer input = {nullptr, 0, 0};
+  this->process_buffer(&input, ZSTD_e_end);
+  ZSTD_freeCCtx(m_compression_context);
+}
+
+Compression_zstd_writer::Compression_zstd_writer(
+    std::function<bool(const Mysql::Tools::Base::Message_data &)>
+        *message_handler,
+    Simple_id_generator *object_id_generator, int compression_level,
+    uint worker_threads, bool long_distance_matching)
+    : Abstract_output_writer_wrapper(message_handler, object_id_generator),
+      m_compression_context(nullptr),
+      m_compression_level(compression_level),
+      m_worker_threads(worker_threads),
+      m_long_distance_matching(long_distance_matching) {}
+
+bool Compression_zstd_writer::init() {
+  m_compression_context = ZSTD_createCCtx();
+  m_buffer.resize(ZSTD_CStreamOutSize());
+  if (m_compression_context == nullptr ||
+      ZSTD_isError(ZSTD_CCtx_setParameter(m_compression_context,
+                                          ZSTD_c_compressionLevel,
+                                          m_compression_level)) ||
+      ZSTD_isError(ZSTD_CCtx_setParameter(m_compression_context,
+                                          ZSTD_c_enableLongDistanceMatching,
+                                          m_long_distance_matching ? 1 : 0))) {
+    this->pass_message(Mysql::Tools::Base::Message_data(
+        0, "zstd compression initialization failed",
+        Mysql::Tools::Base::Message_type_error));
+    return true;
+  }
+  /*
+    Worker threads need libzstd built with ZSTD_MULTITHREAD, without it the
+    data is compressed by the appending thread.
+  */
+  if (m_worker_threads > 0 &&
+      ZSTD_isError(ZSTD_CCtx_setParameter(
+          m_compression_context, ZSTD_c_nbWorkers, (int)m_worker_threads))) {
+    this->pass_message(Mysql::Tools::Base::Message_data(
+        0, "zstd worker threads not supported, compressing inline",
+        Mysql::Tools::Base::Message_type_warning));
+  }
+  return false;
+}
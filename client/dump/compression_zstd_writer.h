@@ -0,0 +1,84 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+
+#ifndef COMPRESSION_ZSTD_WRITER_INCLUDED
+#define COMPRESSION_ZSTD_WRITER_INCLUDED
+
+#include <zstd.h>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "client/dump/abstract_output_writer_wrapper.h"
+#include "client/dump/i_output_writer.h"
+#include "my_inttypes.h"
+
+namespace Mysql {
+namespace Tools {
+namespace Dump {
+
+/**
+  Wrapper to another Output Writer, compresses formatted data stream with zstd.
+  With worker threads the data appended is handed to the zstd thread pool and
+  compressed there, while the formatters go on with the next rows.
+ */
+class Compression_zstd_writer : public I_output_writer,
+                                public Abstract_output_writer_wrapper {
+ public:
+  Compression_zstd_writer(
+      std::function<bool(const Mysql::Tools::Base::Message_data &)>
+          *message_handler,
+      Simple_id_generator *object_id_generator, int compression_level,
+      uint worker_threads, bool long_distance_matching);
+
+  ~Compression_zstd_writer() override;
+
+  bool init() override;
+  void append(const std::string &data_to_append) override;
+
+  // Fix "inherits ... via dominance" warnings
+  void register_progress_watcher(
+      I_progress_watcher *new_progress_watcher) override {
+    Abstract_chain_element::register_progress_watcher(new_progress_watcher);
+  }
+
+  // Fix "inherits ... via dominance" warnings
+  uint64 get_id() const override { return Abstract_chain_element::get_id(); }
+
+ protected:
+  // Fix "inherits ... via dominance" warnings
+  void item_completion_in_child_callback(
+      Item_processing_data *item_processed) override {
+    Abstract_chain_element::item_completion_in_child_callback(item_processed);
+  }
+
+ private:
+  void process_buffer(ZSTD_inBuffer *input, ZSTD_EndDirective directive);
+
+  std::mutex m_zstd_mutex;
+  ZSTD_CCtx *m_compression_context;
+  int m_compression_level;
+  uint m_worker_threads;
+  bool m_long_distance_matching;
+  std::vector<char> m_buffer;
+};
+
+}  // namespace Dump
+}  // namespace Tools
+}  // namespace Mysql
+
+#endif
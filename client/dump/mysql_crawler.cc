@@ -25,7 +25,9 @@
 #include "client/dump/mysql_crawler.h"
 
 #include <stdlib.h>
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -241,11 +243,23 @@ void Mysql_crawler::enumerate_tables(const Database &db) {
                                 " FROM " + this->quote_name(db.get_name()),
                             &fields_data);
     std::vector<Field> fields;
+    std::string pk_column;
+    bool pk_chunkable = false;
+    bool pk_unsigned = false;
+    int pk_parts = 0;
     for (std::vector<const Mysql::Tools::Base::Mysql_query_runner::Row
                          *>::iterator field_it = fields_data.begin();
          field_it != fields_data.end(); ++field_it) {
       fields.push_back(Field((**field_it)[0], (**field_it)[1]));
+      if ((**field_it)[3] == "PRI") {  // "Key"
+        const std::string &type = (**field_it)[1];
+        pk_parts++;
+        pk_column = (**field_it)[0];
+        pk_chunkable = type.find("int") != std::string::npos;
+        pk_unsigned = type.find("unsigned") != std::string::npos;
+      }
     }
+    if (pk_parts != 1 || !pk_chunkable) pk_column.clear();
     Mysql::Tools::Base::Mysql_query_runner::cleanup_result(&fields_data);
     /*
       For views create a dummy view so that dependent objects are
@@ -290,22 +304,44 @@ void Mysql_crawler::enumerate_tables(const Database &db) {
 
     Table_definition_dump_task *ddl_task =
         new Table_definition_dump_task(table);
-    Table_rows_dump_task *rows_task = new Table_rows_dump_task(table);
     Table_deferred_indexes_dump_task *indexes_task =
         new Table_deferred_indexes_dump_task(table);
 
     ddl_task->add_dependency(m_current_database_start_dump_task);
-    rows_task->add_dependency(ddl_task);
-    indexes_task->add_dependency(rows_task);
     m_current_database_end_dump_task->add_dependency(indexes_task);
     m_tables_definition_ready_dump_task->add_dependency(ddl_task);
 
     this->process_dump_task(ddl_task);
-    this->process_dump_task(rows_task);
 
-    this->enumerate_table_triggers(*table, rows_task);
+    std::vector<std::string> ranges =
+        this->get_table_chunk_ranges(runner, *table, pk_column, pk_unsigned);
+    Abstract_dump_task *rows_done_task = indexes_task;
+    if (ranges.empty()) {
+      Table_rows_dump_task *rows_task = new Table_rows_dump_task(table);
+      rows_task->add_dependency(ddl_task);
+      indexes_task->add_dependency(rows_task);
+      this->process_dump_task(rows_task);
+      rows_done_task = rows_task;
+    } else {
+      /*
+        Chunks are read in any order by the threads of the queue, so objects
+        that are to follow the rows wait for the deferred indexes task, which
+        waits for all chunks.
+      */
+      std::shared_ptr<std::atomic<uint32>> chunks_left =
+          std::make_shared<std::atomic<uint32>>((uint32)ranges.size());
+      for (const std::string &range : ranges) {
+        Table_rows_dump_task *rows_task =
+            new Table_rows_dump_task(table, range, chunks_left);
+        rows_task->add_dependency(ddl_task);
+        indexes_task->add_dependency(rows_task);
+        this->process_dump_task(rows_task);
+      }
+    }
+
+    this->enumerate_table_triggers(*table, rows_done_task);
 
-    this->enumerate_column_statistics(*table, rows_task);
+    this->enumerate_column_statistics(*table, rows_done_task);
 
     this->process_dump_task(indexes_task);
   }
@@ -320,6 +356,61 @@ void Mysql_crawler::enumerate_tables(const Database &db) {
   delete runner;
 }
 
+std::vector<std::string> Mysql_crawler::get_table_chunk_ranges(
+    Mysql::Tools::Base::Mysql_query_runner *runner, const Table &table,
+    const std::string &pk_column, bool pk_unsigned) {
+  std::vector<std::string> ranges;
+  uint64 chunk_rows = m_mysqldump_tool_cmaker_options->m_table_chunk_rows;
+  if (chunk_rows == 0 || pk_column.empty() ||
+      table.get_row_count() <= chunk_rows)
+    return ranges;
+
+  std::string pk = this->quote_name(pk_column);
+  std::vector<const Mysql::Tools::Base::Mysql_query_runner::Row *> bounds;
+  if (runner->run_query_store("SELECT MIN(" + pk + "), MAX(" + pk +
+                                  ") FROM " +
+                                  this->get_quoted_object_full_name(&table),
+                              &bounds) ||
+      bounds.size() != 1 || bounds[0]->is_value_null(0)) {
+    Mysql::Tools::Base::Mysql_query_runner::cleanup_result(&bounds);
+    return ranges;
+  }
+
+  /*
+    Keys are handled as uint64, the span of signed keys is the same with
+    two's complement.
+  */
+  const char *min_value = (*bounds[0])[0].c_str();
+  const char *max_value = (*bounds[0])[1].c_str();
+  uint64 min = pk_unsigned ? strtoull(min_value, nullptr, 10)
+                           : (uint64)strtoll(min_value, nullptr, 10);
+  uint64 max = pk_unsigned ? strtoull(max_value, nullptr, 10)
+                           : (uint64)strtoll(max_value, nullptr, 10);
+  Mysql::Tools::Base::Mysql_query_runner::cleanup_result(&bounds);
+
+  uint64 span = max - min;
+  uint64 chunks = (table.get_row_count() + chunk_rows - 1) / chunk_rows;
+  if (span < chunks) chunks = span;
+  if (chunks < 2) return ranges;
+
+  std::string previous;
+  for (uint64 i = 1; i <= chunks; ++i) {
+    std::string bound;
+    if (i < chunks) {
+      uint64 value = min + span / chunks * i;
+      bound = pk_unsigned ? std::to_string(value)
+                          : std::to_string((int64)value);
+    }
+    std::string range;
+    if (!previous.empty()) range = pk + " >= " + previous;
+    if (!previous.empty() && !bound.empty()) range += " AND ";
+    if (!bound.empty()) range += pk + " < " + bound;
+    ranges.push_back(range);
+    previous = bound;
+  }
+  return ranges;
+}
+
 void Mysql_crawler::enumerate_views(const Database &db) {
   Mysql::Tools::Base::Mysql_query_runner *runner = this->get_runner();
   std::vector<const Mysql::Tools::Base::Mysql_query_runner::Row *> tables;
@@ -26,9 +26,12 @@
 #define MYSQL_CRAWLER_INCLUDED
 
 #include <functional>
+#include <string>
+#include <vector>
 
 #include "client/base/abstract_program.h"
 #include "client/base/message_data.h"
+#include "client/base/mysql_query_runner.h"
 #include "client/dump/abstract_crawler.h"
 #include "client/dump/abstract_dump_task.h"
 #include "client/dump/abstract_mysql_chain_element_extension.h"
@@ -90,6 +93,16 @@ class Mysql_crawler : public Abstract_crawler,
 
   void enumerate_tables(const Database &db);
 
+  /**
+    Returns conditions on the integer primary key pk_column splitting rows of
+    the table into chunks of about --table-chunk-rows rows, or nothing if the
+    table is not to be split. The first and the last ranges are open, so the
+    chunks hold all rows of any snapshot.
+   */
+  std::vector<std::string> get_table_chunk_ranges(
+      Mysql::Tools::Base::Mysql_query_runner *runner, const Table &table,
+      const std::string &pk_column, bool pk_unsigned);
+
   void enumerate_table_triggers(const Table &table,
                                 Abstract_dump_task *dependency);
 
@@ -132,14 +132,19 @@ void Mysql_object_reader::read_table_rows_task(
   Rows_fetching_context *row_fetching_context = new Rows_fetching_context(
       this, item_to_process, has_generated_columns, has_invisible_columns);
 
+  std::string range;
+  if (!table_rows_dump_task->get_range().empty())
+    range = " WHERE " + table_rows_dump_task->get_range();
+
   runner->run_query("SELECT " + column_names + "  FROM " +
-                        this->get_quoted_object_full_name(table),
+                        this->get_quoted_object_full_name(table) + range,
                     new std::function<int64(
                         const Mysql::Tools::Base::Mysql_query_runner::Row &)>(
                         std::bind(&Rows_fetching_context::result_callback,
                                   row_fetching_context, _1)));
 
   row_fetching_context->process_buffer();
+  table_rows_dump_task->chunk_completed();
   if (row_fetching_context->is_all_rows_processed())
     delete row_fetching_context;
   if (m_options->m_skip_gipk)
@@ -30,6 +30,7 @@
 
 #include "client/dump/compression_lz4_writer.h"
 #include "client/dump/compression_zlib_writer.h"
+#include "client/dump/compression_zstd_writer.h"
 #include "client/dump/file_writer.h"
 #include "client/dump/i_output_writer.h"
 #include "client/dump/mysqldump_tool_chain_maker_options.h"
@@ -103,6 +104,19 @@ I_object_reader *Mysqldump_tool_chain_maker::create_chain(
         }
         compression_writer_as_wrapper = compression_writer;
         compression_writer_as_writer = compression_writer;
+      } else if (algorithm_name == "zstd") {
+        Compression_zstd_writer *compression_writer =
+            new Compression_zstd_writer(
+                this->get_message_handler(), this->get_object_id_generator(),
+                m_options->m_zstd_compression_level,
+                m_options->m_zstd_compression_threads,
+                m_options->m_zstd_long_distance_matching);
+        if (compression_writer->init()) {
+          delete compression_writer;
+          return nullptr;
+        }
+        compression_writer_as_wrapper = compression_writer;
+        compression_writer_as_writer = compression_writer;
       } else {
         this->pass_message(Mysql::Tools::Base::Message_data(
             0, "Unknown compression method: " + algorithm_name,
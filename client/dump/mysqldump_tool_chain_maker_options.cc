@@ -287,10 +287,37 @@ void Mysqldump_tool_chain_maker_options::create_options() {
       "Direct all output generated for all objects to a given file.");
   this->create_new_option(
       &m_compress_output_algorithm, "compress-output",
-      "Compresses all output files with LZ4 or ZLIB compression algorithm.");
+      "Compresses all output files with LZ4, ZLIB or ZSTD compression "
+      "algorithm.");
+  this->create_new_option(&m_zstd_compression_level, "zstd-compression-level",
+                          "Compression level for --compress-output=ZSTD, "
+                          "from 1 to 22. Default value is 3.")
+      ->set_minimum_value(1)
+      ->set_maximum_value(22)
+      ->set_value(3);
+  this->create_new_option(
+          &m_zstd_compression_threads, "zstd-compression-threads",
+          "Number of threads compressing output for --compress-output=ZSTD, "
+          "apart from the threads dumping objects. If N is 0 the output is "
+          "compressed by the threads dumping objects. Default value is 4.")
+      ->set_maximum_value(256)
+      ->set_value(4);
+  this->create_new_option(
+      &m_zstd_long_distance_matching, "zstd-long-distance-matching",
+      "Use long distance matching for --compress-output=ZSTD, finding "
+      "repeats further back in the output at the cost of memory.")
+      ->set_value(false);
   this->create_new_option(&m_skip_rows_data, "skip-dump-rows",
                           "Skip dumping rows of all tables to output.")
       ->set_short_character('d');
+  this->create_new_option(
+          &m_table_chunk_rows, "table-chunk-rows",
+          "Split rows of tables with more than N rows and an integer primary "
+          "key into chunks of about N rows, by ranges of the key, dumped in "
+          "parallel by the threads of the queue of the table. Each chunk is "
+          "written as INSERT statements of its own. If N is 0 tables are not "
+          "split. Default value is 0.")
+      ->set_value(0);
 }
 
 Mysqldump_tool_chain_maker_options::~Mysqldump_tool_chain_maker_options() {
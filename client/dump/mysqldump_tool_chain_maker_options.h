@@ -69,7 +69,11 @@ class Mysqldump_tool_chain_maker_options
   uint32 m_default_parallelism;
   std::optional<std::string> m_result_file;
   std::optional<std::string> m_compress_output_algorithm;
+  uint32 m_zstd_compression_level;
+  uint32 m_zstd_compression_threads;
+  bool m_zstd_long_distance_matching;
   bool m_skip_rows_data;
+  uint64 m_table_chunk_rows;
 
  private:
   void parallel_schemas_callback(char *);
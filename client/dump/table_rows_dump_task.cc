@@ -28,3 +28,20 @@ using namespace Mysql::Tools::Dump;
 
 Table_rows_dump_task::Table_rows_dump_task(Table *related_table)
     : Abstract_table_dump_task(related_table) {}
+
+Table_rows_dump_task::Table_rows_dump_task(
+    Table *related_table, const std::string &range,
+    std::shared_ptr<std::atomic<uint32>> chunks_left)
+    : Abstract_table_dump_task(related_table),
+      m_range(range),
+      m_chunks_left(chunks_left) {}
+
+const std::string &Table_rows_dump_task::get_range() const { return m_range; }
+
+void Table_rows_dump_task::chunk_completed() {
+  m_last_chunk = m_chunks_left == nullptr || --*m_chunks_left == 0;
+}
+
+bool Table_rows_dump_task::is_last_chunk() const {
+  return m_chunks_left == nullptr || m_last_chunk;
+}
@@ -25,7 +25,12 @@
 #ifndef TABLE_ROWS_DUMP_TASK_INCLUDED
 #define TABLE_ROWS_DUMP_TASK_INCLUDED
 
+#include <atomic>
+#include <memory>
+#include <string>
+
 #include "client/dump/abstract_table_dump_task.h"
+#include "my_inttypes.h"
 
 namespace Mysql {
 namespace Tools {
@@ -37,6 +42,34 @@ namespace Dump {
 class Table_rows_dump_task : public Abstract_table_dump_task {
  public:
   explicit Table_rows_dump_task(Table *related_table);
+
+  /**
+    Creates task for extracting rows of one chunk of a table split by ranges
+    of its primary key. All chunks of the table share chunks_left.
+   */
+  Table_rows_dump_task(Table *related_table, const std::string &range,
+                       std::shared_ptr<std::atomic<uint32>> chunks_left);
+
+  /**
+    Returns condition selecting rows of the chunk, empty for whole table.
+   */
+  const std::string &get_range() const;
+
+  /**
+    Marks rows of the chunk as read.
+   */
+  void chunk_completed();
+
+  /**
+    Returns true if all rows of the table are read once this chunk is, that
+    is for the last chunk completed or the table not split.
+   */
+  bool is_last_chunk() const;
+
+ private:
+  std::string m_range;
+  std::shared_ptr<std::atomic<uint32>> m_chunks_left;
+  bool m_last_chunk{false};
 };
 
 }  // namespace Dump
@@ -0,0 +1,701 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+/*
+  Throughput of the multi-threaded replication applier.
+
+  Needs a replica already replicating from the source with GTIDs. For every
+  number of workers given, the SQL thread of the replica is stopped, a
+  synthetic workload is run on the source and the IO thread is stopped once
+  the replica has received all of it. The relay log then holds transactions
+  with a known dependency graph: each row updated goes to one of a few hot
+  rows with the conflict probability given, to rows no other client touches
+  otherwise. The SQL thread is started with replica_parallel_workers set and
+  the time to apply the relay log is measured, so only the applier runs.
+
+  Prints transactions/s, events/s, the utilization of the workers and the
+  time they spent waiting for preceding transactions to commit and for
+  dependencies, as CSV or JSON. Set mts_dependency_replication on the
+  replica to measure the dependency applier rather than the logical clock
+  one.
+*/
+
+#include <mysql.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "caching_sha2_passwordopt-vars.h"
+#include "client/client_priv.h"
+#include "my_alloc.h"
+#include "my_dbug.h"
+#include "my_default.h"
+#include "my_inttypes.h"
+#include "my_macros.h"
+#include "my_sys.h"
+#include "print_version.h"
+#include "sslopt-vars.h"
+#include "typelib.h"
+#include "welcome_copyright_notice.h" /* ORACLE_WELCOME_COPYRIGHT_NOTICE */
+
+static char *host = nullptr, *user = nullptr;
+static char *opt_mysql_unix_port = nullptr;
+static uint opt_mysql_port = 0;
+static char *opt_source_host = nullptr;
+static char *opt_source_socket = nullptr;
+static uint opt_source_port = 0;
+static uint opt_protocol = 0;
+static uint my_end_arg = 0;
+static const char *opt_database = "applier_bench";
+static uint opt_tables = 8;
+static ulong opt_table_rows = 10000;
+static ulong opt_transactions = 10000;
+static uint opt_trx_rows = 4;
+static uint opt_conflict_pct = 10;
+static uint opt_hot_rows = 16;
+static uint opt_pad_length = 100;
+static uint opt_clients = 8;
+static ulong opt_seed = 1;
+static ulong opt_timeout = 3600;
+static bool opt_load = false;
+static const char *opt_workers = "4";
+static const char *opt_format = "csv";
+
+#include "multi_factor_passwordopt-vars.h"
+
+static const char *load_default_groups[] = {"mysql_applier_bench", "client",
+                                            nullptr};
+
+static struct my_option my_long_options[] = {
+    {"clients", OPT_MAX_CLIENT_OPTION,
+     "Concurrent clients running the workload on the source.", &opt_clients,
+     &opt_clients, nullptr, GET_UINT, REQUIRED_ARG, 8, 1, 1024, nullptr, 0,
+     nullptr},
+    {"conflict-pct", OPT_MAX_CLIENT_OPTION,
+     "Percent of the rows updated that go to the hot rows, which "
+     "transactions of all clients update.",
+     &opt_conflict_pct, &opt_conflict_pct, nullptr, GET_UINT, REQUIRED_ARG, 10,
+     0, 100, nullptr, 0, nullptr},
+    {"database", 'D', "Database of the tables, on the source.", &opt_database,
+     &opt_database, nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0, nullptr, 0,
+     nullptr},
+    {"debug", '#', "Output debug log. Often this is 'd:t:o,filename'.", nullptr,
+     nullptr, nullptr, GET_STR, OPT_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"format", OPT_MAX_CLIENT_OPTION, "Output format, csv or json.",
+     &opt_format, &opt_format, nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0, nullptr,
+     0, nullptr},
+    {"help", '?', "Display this help and exit.", nullptr, nullptr, nullptr,
+     GET_NO_ARG, NO_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"host", 'h', "Connect to the replica on host.", &host, &host, nullptr,
+     GET_STR, REQUIRED_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"hot-rows", OPT_MAX_CLIENT_OPTION,
+     "Rows at the start of every table that conflicting updates go to.",
+     &opt_hot_rows, &opt_hot_rows, nullptr, GET_UINT, REQUIRED_ARG, 16, 1,
+     1000000, nullptr, 0, nullptr},
+    {"load", OPT_MAX_CLIENT_OPTION,
+     "Create the tables on the source and fill them, dropping the database "
+     "if it exists.",
+     &opt_load, &opt_load, nullptr, GET_BOOL, NO_ARG, 0, 0, 0, nullptr, 0,
+     nullptr},
+    {"pad-length", OPT_MAX_CLIENT_OPTION,
+     "Length of the padding column, which makes the row events larger.",
+     &opt_pad_length, &opt_pad_length, nullptr, GET_UINT, REQUIRED_ARG, 100, 0,
+     255, nullptr, 0, nullptr},
+#include "multi_factor_passwordopt-longopts.h"
+    {"port", 'P', "Port number of the replica.", &opt_mysql_port,
+     &opt_mysql_port, nullptr, GET_UINT, REQUIRED_ARG, 0, 0, 0, nullptr, 0,
+     nullptr},
+    {"protocol", OPT_MYSQL_PROTOCOL,
+     "The protocol to use for connection (tcp, socket, pipe, memory).", nullptr,
+     nullptr, nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"seed", OPT_MAX_CLIENT_OPTION, "Seed of the workload generator.",
+     &opt_seed, &opt_seed, nullptr, GET_ULONG, REQUIRED_ARG, 1, 0, 0, nullptr,
+     0, nullptr},
+    {"socket", 'S', "The socket file of the replica.", &opt_mysql_unix_port,
+     &opt_mysql_unix_port, nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0, nullptr, 0,
+     nullptr},
+    {"source-host", OPT_MAX_CLIENT_OPTION, "Connect to the source on host.",
+     &opt_source_host, &opt_source_host, nullptr, GET_STR, REQUIRED_ARG, 0, 0,
+     0, nullptr, 0, nullptr},
+    {"source-port", OPT_MAX_CLIENT_OPTION, "Port number of the source.",
+     &opt_source_port, &opt_source_port, nullptr, GET_UINT, REQUIRED_ARG, 0, 0,
+     0, nullptr, 0, nullptr},
+    {"source-socket", OPT_MAX_CLIENT_OPTION, "The socket file of the source.",
+     &opt_source_socket, &opt_source_socket, nullptr, GET_STR, REQUIRED_ARG, 0,
+     0, 0, nullptr, 0, nullptr},
+#include "caching_sha2_passwordopt-longopts.h"
+#include "sslopt-longopts.h"
+
+    {"table-rows", OPT_MAX_CLIENT_OPTION, "Rows of every table.",
+     &opt_table_rows, &opt_table_rows, nullptr, GET_ULONG, REQUIRED_ARG, 10000,
+     1, 0, nullptr, 0, nullptr},
+    {"tables", OPT_MAX_CLIENT_OPTION,
+     "Tables the rows updated are spread over.", &opt_tables, &opt_tables,
+     nullptr, GET_UINT, REQUIRED_ARG, 8, 1, 1024, nullptr, 0, nullptr},
+    {"timeout", OPT_MAX_CLIENT_OPTION,
+     "Seconds to wait for the replica to receive or apply a run.",
+     &opt_timeout, &opt_timeout, nullptr, GET_ULONG, REQUIRED_ARG, 3600, 1, 0,
+     nullptr, 0, nullptr},
+    {"transactions", OPT_MAX_CLIENT_OPTION, "Transactions of every run.",
+     &opt_transactions, &opt_transactions, nullptr, GET_ULONG, REQUIRED_ARG,
+     10000, 1, 0, nullptr, 0, nullptr},
+    {"trx-rows", OPT_MAX_CLIENT_OPTION, "Rows updated by every transaction.",
+     &opt_trx_rows, &opt_trx_rows, nullptr, GET_UINT, REQUIRED_ARG, 4, 1,
+     10000, nullptr, 0, nullptr},
+    {"user", 'u', "User for login on both servers if not current user.", &user,
+     &user, nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"version", 'V', "Output version information and exit.", nullptr, nullptr,
+     nullptr, GET_NO_ARG, NO_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"workers", OPT_MAX_CLIENT_OPTION,
+     "Comma separated values of replica_parallel_workers to apply with.",
+     &opt_workers, &opt_workers, nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0,
+     nullptr, 0, nullptr},
+    {nullptr, 0, nullptr, nullptr, nullptr, nullptr, GET_NO_ARG, NO_ARG, 0, 0,
+     0, nullptr, 0, nullptr}};
+
+static void usage(void) {
+  print_version();
+  puts(ORACLE_WELCOME_COPYRIGHT_NOTICE("2025"));
+  puts(
+      "Measures the throughput of the multi-threaded replication applier on "
+      "synthetic workloads.\n");
+  printf("Usage: %s [OPTIONS] --source-host=HOST\n", my_progname);
+  print_defaults("my", load_default_groups);
+  my_print_help(my_long_options);
+  my_print_variables(my_long_options);
+}
+
+extern "C" {
+static bool get_one_option(int optid, const struct my_option *opt,
+                           char *argument) {
+  switch (optid) {
+    PARSE_COMMAND_LINE_PASSWORD_OPTION;
+    case OPT_MYSQL_PROTOCOL:
+      opt_protocol =
+          find_type_or_exit(argument, &sql_protocol_typelib, opt->name);
+      break;
+    case '#':
+      DBUG_PUSH(argument ? argument : "d:t:o");
+      break;
+#include "sslopt-case.h"
+
+    case 'V':
+      print_version();
+      exit(0);
+    case '?':
+      usage();
+      exit(0);
+  }
+  return false;
+}
+}  // extern "C"
+
+namespace {
+
+/** stages of the workers reported, as instrumented by the applier */
+const char *const commit_order_stage =
+    "stage/sql/Waiting for preceding transaction to commit";
+const char *const dependency_stages[] = {
+    "stage/sql/Waiting for dependent transaction to commit",
+    "stage/sql/Waiting for dependencies to be satisfied"};
+
+struct Run_result {
+  double seconds = 0;
+  double trx_per_sec = 0;
+  double events_per_sec = 0;
+  double utilization = 0;
+  double commit_order_wait_s = 0;
+  double dependency_wait_s = 0;
+  ulonglong begin_waits = 0;
+  ulonglong next_waits = 0;
+  ulonglong deadlocks = 0;
+  ulonglong events = 0;
+};
+
+/** parse a comma separated list of positive numbers, return true on error */
+bool parse_list(const char *name, const char *value, std::vector<uint> *list) {
+  list->clear();
+  std::string item;
+  for (const char *pos = value;; ++pos) {
+    if (*pos == ',' || *pos == '\0') {
+      char *end;
+      const unsigned long number = strtoul(item.c_str(), &end, 10);
+      if (item.empty() || *end != '\0' || number == 0) {
+        fprintf(stderr, "%s: bad value '%s' of --%s\n", my_progname,
+                item.c_str(), name);
+        return true;
+      }
+      list->push_back(static_cast<uint>(number));
+      item.clear();
+      if (*pos == '\0') break;
+    } else {
+      item += *pos;
+    }
+  }
+  return false;
+}
+
+MYSQL *connect(bool source) {
+  MYSQL *mysql = mysql_init(nullptr);
+  if (mysql == nullptr) return nullptr;
+  if (SSL_SET_OPTIONS(mysql)) {
+    fprintf(stderr, "%s", SSL_SET_OPTIONS_ERROR);
+    mysql_close(mysql);
+    return nullptr;
+  }
+  if (opt_protocol)
+    mysql_options(mysql, MYSQL_OPT_PROTOCOL, (char *)&opt_protocol);
+  mysql_options(mysql, MYSQL_OPT_CONNECT_ATTR_RESET, nullptr);
+  mysql_options4(mysql, MYSQL_OPT_CONNECT_ATTR_ADD, "program_name",
+                 "mysql_applier_bench");
+  set_server_public_key(mysql);
+  set_get_server_public_key_option(mysql);
+  set_password_options(mysql);
+  if (!mysql_real_connect(
+          mysql, source ? opt_source_host : host, user, nullptr, nullptr,
+          source ? opt_source_port : opt_mysql_port,
+          source ? opt_source_socket : opt_mysql_unix_port, 0)) {
+    fprintf(stderr, "%s: %s: %s\n", my_progname, source ? "source" : "replica",
+            mysql_error(mysql));
+    mysql_close(mysql);
+    return nullptr;
+  }
+  if (ssl_client_check_post_connect_ssl_setup(
+          mysql, [](const char *err) { fprintf(stderr, "%s\n", err); })) {
+    mysql_close(mysql);
+    return nullptr;
+  }
+  return mysql;
+}
+
+bool run_query(MYSQL *mysql, const std::string &query) {
+  if (mysql_real_query(mysql, query.data(), query.length())) {
+    fprintf(stderr, "%s: %s\n", my_progname, mysql_error(mysql));
+    return true;
+  }
+  MYSQL_RES *result = mysql_store_result(mysql);
+  if (result) mysql_free_result(result);
+  return false;
+}
+
+/** the rows of a query, nullptr values as empty strings */
+bool select_rows(MYSQL *mysql, const std::string &query,
+                 std::vector<std::vector<std::string>> *rows) {
+  rows->clear();
+  MYSQL_RES *res = nullptr;
+  if (mysql_real_query(mysql, query.data(), query.length()) ||
+      (res = mysql_store_result(mysql)) == nullptr) {
+    fprintf(stderr, "%s: %s\n", my_progname, mysql_error(mysql));
+    return true;
+  }
+  const uint fields = mysql_num_fields(res);
+  while (MYSQL_ROW row = mysql_fetch_row(res)) {
+    rows->emplace_back();
+    for (uint i = 0; i < fields; ++i)
+      rows->back().emplace_back(row[i] ? row[i] : "");
+  }
+  mysql_free_result(res);
+  return false;
+}
+
+/** the first column of the first row of a query */
+bool select_value(MYSQL *mysql, const std::string &query, std::string *value) {
+  std::vector<std::vector<std::string>> rows;
+  if (select_rows(mysql, query, &rows)) return true;
+  if (rows.empty()) {
+    fprintf(stderr, "%s: no rows for %s\n", my_progname, query.c_str());
+    return true;
+  }
+  *value = rows[0][0];
+  return false;
+}
+
+std::string quoted(const std::string &value) { return "'" + value + "'"; }
+
+std::string table_name(uint table) {
+  return std::string(opt_database) + ".t" + std::to_string(table);
+}
+
+bool load(MYSQL *source) {
+  if (run_query(source, std::string("DROP DATABASE IF EXISTS ") +
+                            opt_database) ||
+      run_query(source, std::string("CREATE DATABASE ") + opt_database))
+    return true;
+
+  const std::string pad(opt_pad_length, 'x');
+  for (uint table = 0; table < opt_tables; ++table) {
+    if (run_query(source, "CREATE TABLE " + table_name(table) +
+                              " (id BIGINT NOT NULL PRIMARY KEY, k BIGINT "
+                              "NOT NULL, pad VARCHAR(255) NOT NULL)"))
+      return true;
+    for (ulong row = 0; row < opt_table_rows; row += 1000) {
+      std::string insert = "INSERT INTO " + table_name(table) + " VALUES ";
+      const ulong end = std::min<ulong>(opt_table_rows, row + 1000);
+      for (ulong i = row; i < end; ++i) {
+        if (i != row) insert += ",";
+        insert += "(" + std::to_string(i) + ",0,'" + pad + "')";
+      }
+      if (run_query(source, insert)) return true;
+    }
+  }
+  return false;
+}
+
+/**
+  run opt_transactions transactions over opt_clients connections to the
+  source. every client updates its own slice of the rows past the hot ones,
+  so only the hot rows make transactions depend on each other
+*/
+bool generate(uint run) {
+  std::atomic<ulong> next{0};
+  std::atomic<bool> failed{false};
+  const ulong cold_rows =
+      opt_table_rows > opt_hot_rows ? opt_table_rows - opt_hot_rows : 0;
+  const ulong slice = std::max<ulong>(1, cold_rows / opt_clients);
+
+  auto client = [&](uint client_id) {
+    mysql_thread_init();
+    std::mt19937_64 generator(opt_seed + run * 1000003ULL + client_id);
+    std::uniform_int_distribution<uint> percent(0, 99);
+    std::uniform_int_distribution<uint> table(0, opt_tables - 1);
+    std::uniform_int_distribution<ulong> hot(
+        0, std::min<ulong>(opt_hot_rows, opt_table_rows) - 1);
+    std::uniform_int_distribution<ulong> cold(0, slice - 1);
+    const ulong cold_start = std::min<ulong>(opt_hot_rows, opt_table_rows) +
+                             (client_id % opt_clients) * slice;
+
+    MYSQL *mysql = connect(true);
+    if (mysql == nullptr) failed = true;
+    while (!failed && next++ < opt_transactions) {
+      if (run_query(mysql, "BEGIN")) failed = true;
+      for (uint row = 0; row < opt_trx_rows && !failed; ++row) {
+        ulong id;
+        if (cold_rows == 0 || percent(generator) < opt_conflict_pct)
+          id = hot(generator);
+        else
+          id = std::min(cold_start + cold(generator), opt_table_rows - 1);
+        if (run_query(mysql, "UPDATE " + table_name(table(generator)) +
+                                 " SET k = k + 1 WHERE id = " +
+                                 std::to_string(id)))
+          failed = true;
+      }
+      if (!failed && run_query(mysql, "COMMIT")) failed = true;
+    }
+    if (mysql) mysql_close(mysql);
+    mysql_thread_end();
+  };
+
+  std::vector<std::thread> threads;
+  for (uint i = 0; i < opt_clients; ++i) threads.emplace_back(client, i);
+  for (auto &thread : threads) thread.join();
+  return failed;
+}
+
+/**
+  events the source logged since file:pos, which the replica applies. the
+  binary logs rotated to since then are counted as well
+*/
+bool count_events(MYSQL *source, const std::string &file,
+                  const std::string &pos, ulonglong *events) {
+  std::vector<std::vector<std::string>> logs;
+  if (select_rows(source, "SHOW BINARY LOGS", &logs)) return true;
+  *events = 0;
+  bool counting = false;
+  for (const auto &log : logs) {
+    if (log[0] == file) counting = true;
+    if (!counting) continue;
+    std::string show = "SHOW BINLOG EVENTS IN " + quoted(log[0]);
+    if (log[0] == file) show += " FROM " + pos;
+    if (mysql_real_query(source, show.data(), show.length())) {
+      fprintf(stderr, "%s: %s\n", my_progname, mysql_error(source));
+      return true;
+    }
+    MYSQL_RES *res = mysql_use_result(source);
+    if (res == nullptr) {
+      fprintf(stderr, "%s: %s\n", my_progname, mysql_error(source));
+      return true;
+    }
+    while (MYSQL_ROW row = mysql_fetch_row(res)) {
+      // the rotate and previous gtids events are not applied
+      const std::string type = row[2] ? row[2] : "";
+      if (type != "Rotate" && type != "Previous_gtids" &&
+          type != "Format_desc")
+        (*events)++;
+    }
+    mysql_free_result(res);
+  }
+  return false;
+}
+
+/** the global status counters of the replica whose names start with prefix */
+bool status_counters(MYSQL *replica, const char *prefix,
+                     std::map<std::string, ulonglong> *counters) {
+  std::vector<std::vector<std::string>> rows;
+  if (select_rows(replica,
+                  std::string("SHOW GLOBAL STATUS LIKE '") + prefix + "%'",
+                  &rows))
+    return true;
+  counters->clear();
+  for (const auto &row : rows)
+    (*counters)[row[0]] = strtoull(row[1].c_str(), nullptr, 10);
+  return false;
+}
+
+/** seconds the replica workers spent in the stages given */
+bool worker_stage_seconds(MYSQL *replica, const std::string &stages,
+                          double *seconds) {
+  std::string value;
+  if (select_value(
+          replica,
+          "SELECT IFNULL(SUM(s.SUM_TIMER_WAIT), 0) / 1e12 FROM "
+          "performance_schema.events_stages_summary_by_thread_by_event_name "
+          "s JOIN performance_schema.threads t USING (THREAD_ID) WHERE "
+          "t.NAME = 'thread/sql/replica_worker' AND s.EVENT_NAME IN (" +
+              stages + ")",
+          &value))
+    return true;
+  *seconds = strtod(value.c_str(), nullptr);
+  return false;
+}
+
+/** enable the instruments the busy and waiting times are read from */
+bool setup_instruments(MYSQL *replica) {
+  std::string stages = quoted(commit_order_stage);
+  for (const char *stage : dependency_stages) stages += "," + quoted(stage);
+  return run_query(replica,
+                   "UPDATE performance_schema.setup_instruments SET "
+                   "ENABLED = 'YES', TIMED = 'YES' WHERE NAME IN (" +
+                       stages + ") OR NAME = 'transaction'") ||
+         run_query(replica,
+                   "UPDATE performance_schema.setup_consumers SET ENABLED = "
+                   "'YES' WHERE NAME IN ('events_stages_current', "
+                   "'events_transactions_current')");
+}
+
+/** wait until the replica received every transaction the source executed */
+bool wait_received(MYSQL *replica, const std::string &gtids) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(opt_timeout);
+  for (;;) {
+    std::string done;
+    if (select_value(replica,
+                     "SELECT GTID_SUBSET(GTID_SUBTRACT(" + quoted(gtids) +
+                         ", @@GLOBAL.gtid_executed), "
+                         "GROUP_CONCAT(RECEIVED_TRANSACTION_SET)) FROM "
+                         "performance_schema.replication_connection_status",
+                     &done))
+      return true;
+    if (done == "1") return false;
+    if (std::chrono::steady_clock::now() > deadline) {
+      fprintf(stderr, "%s: the replica did not receive the workload\n",
+              my_progname);
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+}
+
+/** wait until the replica applied gtids, return true on error or timeout */
+bool wait_applied(MYSQL *replica, const std::string &gtids) {
+  std::string timed_out;
+  if (select_value(replica,
+                   "SELECT WAIT_FOR_EXECUTED_GTID_SET(" + quoted(gtids) + ", " +
+                       std::to_string(opt_timeout) + ")",
+                   &timed_out))
+    return true;
+  if (timed_out != "0") {
+    fprintf(stderr, "%s: the replica did not apply the workload\n",
+            my_progname);
+    return true;
+  }
+  return false;
+}
+
+/**
+  queue a workload in the relay log of the replica and measure how fast
+  workers workers apply it
+*/
+bool measure(MYSQL *source, MYSQL *replica, uint run, uint workers,
+             Run_result *result) {
+  std::vector<std::vector<std::string>> status;
+  if (run_query(replica, "STOP REPLICA SQL_THREAD") ||
+      run_query(replica, "START REPLICA IO_THREAD") ||
+      select_rows(source, "SHOW MASTER STATUS", &status))
+    return true;
+  if (status.empty()) {
+    fprintf(stderr, "%s: binary logging is off on the source\n",
+            my_progname);
+    return true;
+  }
+
+  std::string gtids;
+  if (generate(run) ||
+      select_value(source, "SELECT @@GLOBAL.gtid_executed", &gtids) ||
+      count_events(source, status[0][0], status[0][1], &result->events) ||
+      wait_received(replica, gtids) ||
+      run_query(replica, "STOP REPLICA IO_THREAD") ||
+      run_query(replica, "SET GLOBAL replica_parallel_workers = " +
+                             std::to_string(workers)))
+    return true;
+
+  std::map<std::string, ulonglong> before, after;
+  if (status_counters(replica, "Slave_", &before)) return true;
+
+  const auto start = std::chrono::steady_clock::now();
+  if (run_query(replica, "START REPLICA SQL_THREAD") ||
+      wait_applied(replica, gtids))
+    return true;
+  result->seconds = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+  // the workers were started for this run, so their summaries are of it
+  std::string busy;
+  std::string stages;
+  for (const char *stage : dependency_stages)
+    stages += (stages.empty() ? "" : ",") + quoted(stage);
+  if (status_counters(replica, "Slave_", &after) ||
+      select_value(
+          replica,
+          "SELECT IFNULL(SUM(s.SUM_TIMER_WAIT), 0) / 1e12 FROM "
+          "performance_schema.events_transactions_summary_by_thread_by_event_"
+          "name s JOIN performance_schema.threads t USING (THREAD_ID) WHERE "
+          "t.NAME = 'thread/sql/replica_worker'",
+          &busy) ||
+      worker_stage_seconds(replica, quoted(commit_order_stage),
+                           &result->commit_order_wait_s) ||
+      worker_stage_seconds(replica, stages, &result->dependency_wait_s))
+    return true;
+
+  auto delta = [&](const char *name) {
+    return after[name] >= before[name] ? after[name] - before[name] : 0;
+  };
+  result->begin_waits = delta("Slave_dependency_begin_waits");
+  result->next_waits = delta("Slave_dependency_next_waits");
+  result->deadlocks = delta("Slave_commit_order_deadlocks");
+  if (result->seconds > 0) {
+    result->trx_per_sec = opt_transactions / result->seconds;
+    result->events_per_sec = result->events / result->seconds;
+    result->utilization =
+        strtod(busy.c_str(), nullptr) / (result->seconds * workers);
+  }
+  return false;
+}
+
+void print_result(uint workers, const Run_result &result, bool first) {
+  const bool json = strcmp(opt_format, "json") == 0;
+  if (first && !json)
+    printf(
+        "workers,tables,trx_rows,conflict_pct,transactions,events,seconds,"
+        "trx_per_sec,events_per_sec,utilization,commit_order_wait_s,"
+        "dependency_wait_s,begin_waits,next_waits,commit_order_deadlocks\n");
+  if (json) {
+    printf(
+        "%s{\"workers\": %u, \"tables\": %u, \"trx_rows\": %u, "
+        "\"conflict_pct\": %u, \"transactions\": %lu, \"events\": %llu, "
+        "\"seconds\": %.3f, \"trx_per_sec\": %.1f, \"events_per_sec\": %.1f, "
+        "\"utilization\": %.3f, \"commit_order_wait_s\": %.3f, "
+        "\"dependency_wait_s\": %.3f, \"begin_waits\": %llu, "
+        "\"next_waits\": %llu, \"commit_order_deadlocks\": %llu}",
+        first ? "[\n  " : ",\n  ", workers, opt_tables, opt_trx_rows,
+        opt_conflict_pct, opt_transactions, result.events, result.seconds,
+        result.trx_per_sec, result.events_per_sec, result.utilization,
+        result.commit_order_wait_s, result.dependency_wait_s,
+        result.begin_waits, result.next_waits, result.deadlocks);
+  } else {
+    printf(
+        "%u,%u,%u,%u,%lu,%llu,%.3f,%.1f,%.1f,%.3f,%.3f,%.3f,%llu,%llu,%llu\n",
+        workers, opt_tables, opt_trx_rows, opt_conflict_pct, opt_transactions,
+        result.events, result.seconds, result.trx_per_sec,
+        result.events_per_sec, result.utilization, result.commit_order_wait_s,
+        result.dependency_wait_s, result.begin_waits, result.next_waits,
+        result.deadlocks);
+  }
+  fflush(stdout);
+}
+
+int bench() {
+  std::vector<uint> workers;
+  if (parse_list("workers", opt_workers, &workers)) return 1;
+  if (opt_source_host == nullptr && opt_source_socket == nullptr) {
+    fprintf(stderr, "%s: --source-host or --source-socket is required\n",
+            my_progname);
+    return 1;
+  }
+
+  MYSQL *source = connect(true);
+  MYSQL *replica = source ? connect(false) : nullptr;
+  bool error = replica == nullptr;
+  if (!error && opt_load) {
+    std::string gtids;
+    // the tables must be on the replica before the first run
+    error = load(source) ||
+            select_value(source, "SELECT @@GLOBAL.gtid_executed", &gtids) ||
+            run_query(replica, "START REPLICA") || wait_applied(replica, gtids);
+  }
+  if (!error) error = setup_instruments(replica);
+
+  bool first = true;
+  for (uint run = 0; run < workers.size() && !error; ++run) {
+    Run_result result;
+    error = measure(source, replica, run, workers[run], &result);
+    if (!error) print_result(workers[run], result, first);
+    first = false;
+  }
+  if (!first && !error && strcmp(opt_format, "json") == 0) printf("\n]\n");
+
+  // leave the replica replicating
+  if (replica) run_query(replica, "START REPLICA");
+  if (replica) mysql_close(replica);
+  if (source) mysql_close(source);
+  return error ? 1 : 0;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  MY_INIT(argv[0]);
+
+  my_getopt_use_args_separator = true;
+  MEM_ROOT alloc{PSI_NOT_INSTRUMENTED, 512};
+  if (load_defaults("my", load_default_groups, &argc, &argv, &alloc)) exit(1);
+  my_getopt_use_args_separator = false;
+
+  if (int ho_error =
+          handle_options(&argc, &argv, my_long_options, get_one_option))
+    exit(ho_error);
+
+  if (mysql_library_init(-1, nullptr, nullptr)) {
+    fprintf(stderr, "%s: cannot initialize the client library\n",
+            my_progname);
+    exit(1);
+  }
+  const int error = bench();
+
+  free_passwords();
+  mysql_library_end();
+  my_end(my_end_arg);
+  exit(error);
+}
@@ -0,0 +1,440 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+/*
+  Generates a hybrid query workload for mysqlslap.
+
+  Writes a table of points of interest, with a location, relational columns,
+  a text and the embedding of the text, to --create-file, and a mix of
+  vector, spatial, relational, semantic and hybrid queries over it to
+  --query-file. Both are plain SQL statements ending in ';', e.g.
+
+    mysql_hybrid_workload --create-file=create.sql --query-file=query.sql
+    mysqlslap --create=create.sql --query=query.sql --delimiter=";"
+              --concurrency=1,8,32 --create-schema=hybrid
+
+  The semantic queries are meant to be answered by the mock model of
+  mysql_server_mock --llm, with semantic_local_url pointing at it and the
+  semantic_*_model variables naming the 'local' backend; give --dimension
+  the --llm-embedding-dimension of the mock for SEMANTIC_RANK(). The same
+  --seed always writes the same workload.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "client/client_priv.h"
+#include "my_default.h"
+#include "my_inttypes.h"
+#include "my_sys.h"
+#include "print_version.h"
+#include "welcome_copyright_notice.h" /* ORACLE_WELCOME_COPYRIGHT_NOTICE */
+
+static ulong opt_rows = 10000;
+static ulong opt_queries = 1000;
+static ulong opt_dimension = 128;
+static ulong opt_seed = 1;
+static ulong opt_batch_size = 500;
+static const char *opt_table = "poi";
+static char *opt_create_file = nullptr, *opt_query_file = nullptr;
+static const char *opt_mix =
+    "vector:1,spatial:1,relational:1,semantic:1,hybrid:1";
+static const char *opt_vector_index_type = "lsmidx";
+static const char *opt_spatial_index_type = "global";
+
+static const char *load_default_groups[] = {"mysql_hybrid_workload", nullptr};
+
+static struct my_option my_long_options[] = {
+    {"batch-size", OPT_MAX_CLIENT_OPTION, "Rows per INSERT of the table.",
+     &opt_batch_size, &opt_batch_size, nullptr, GET_ULONG, REQUIRED_ARG, 500, 1,
+     100000, nullptr, 0, nullptr},
+    {"create-file", OPT_MAX_CLIENT_OPTION,
+     "File to write the CREATE TABLE and INSERT statements to.",
+     &opt_create_file, &opt_create_file, nullptr, GET_STR, REQUIRED_ARG, 0, 0,
+     0, nullptr, 0, nullptr},
+    {"dimension", OPT_MAX_CLIENT_OPTION, "Dimension of the text embeddings.",
+     &opt_dimension, &opt_dimension, nullptr, GET_ULONG, REQUIRED_ARG, 128, 1,
+     16000, nullptr, 0, nullptr},
+    {"help", '?', "Display this help and exit.", nullptr, nullptr, nullptr,
+     GET_NO_ARG, NO_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"mix", OPT_MAX_CLIENT_OPTION,
+     "Relative weights of the kinds of queries, as a comma separated list of "
+     "kind:weight. The kinds are vector, spatial, relational, semantic and "
+     "hybrid.",
+     &opt_mix, &opt_mix, nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0, nullptr, 0,
+     nullptr},
+    {"queries", OPT_MAX_CLIENT_OPTION, "Number of queries to write.",
+     &opt_queries, &opt_queries, nullptr, GET_ULONG, REQUIRED_ARG, 1000, 1, 0,
+     nullptr, 0, nullptr},
+    {"query-file", OPT_MAX_CLIENT_OPTION, "File to write the queries to.",
+     &opt_query_file, &opt_query_file, nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0,
+     nullptr, 0, nullptr},
+    {"rows", OPT_MAX_CLIENT_OPTION, "Number of rows of the table.", &opt_rows,
+     &opt_rows, nullptr, GET_ULONG, REQUIRED_ARG, 10000, 1, 0, nullptr, 0,
+     nullptr},
+    {"seed", OPT_MAX_CLIENT_OPTION, "Seed of the random generator.", &opt_seed,
+     &opt_seed, nullptr, GET_ULONG, REQUIRED_ARG, 1, 0, 0, nullptr, 0, nullptr},
+    {"spatial-index-type", OPT_MAX_CLIENT_OPTION,
+     "NEXT_SPATIAL_INDEX_TYPE of the index of the locations.",
+     &opt_spatial_index_type, &opt_spatial_index_type, nullptr, GET_STR,
+     REQUIRED_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"table", OPT_MAX_CLIENT_OPTION, "Name of the table.", &opt_table,
+     &opt_table, nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"vector-index-type", OPT_MAX_CLIENT_OPTION,
+     "FB_VECTOR_INDEX_TYPE of the index of the embeddings.",
+     &opt_vector_index_type, &opt_vector_index_type, nullptr, GET_STR,
+     REQUIRED_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"version", 'V', "Output version information and exit.", nullptr, nullptr,
+     nullptr, GET_NO_ARG, NO_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {nullptr, 0, nullptr, nullptr, nullptr, nullptr, GET_NO_ARG, NO_ARG, 0, 0,
+     0, nullptr, 0, nullptr}};
+
+static void usage(void) {
+  print_version();
+  puts(ORACLE_WELCOME_COPYRIGHT_NOTICE("2025"));
+  puts("Generates a hybrid query workload for mysqlslap.\n");
+  printf("Usage: %s [OPTIONS] --create-file=FILE --query-file=FILE\n",
+         my_progname);
+  print_defaults("my", load_default_groups);
+  my_print_help(my_long_options);
+  my_print_variables(my_long_options);
+}
+
+extern "C" {
+static bool get_one_option(int optid, const struct my_option *, char *) {
+  switch (optid) {
+    case 'V':
+      print_version();
+      exit(0);
+    case '?':
+      usage();
+      exit(0);
+  }
+  return false;
+}
+}  // extern "C"
+
+namespace {
+
+enum Query_kind { VECTOR, SPATIAL, RELATIONAL, SEMANTIC, HYBRID, KIND_COUNT };
+
+const char *kind_names[KIND_COUNT] = {"vector", "spatial", "relational",
+                                      "semantic", "hybrid"};
+
+// cities the points cluster around, as longitude and latitude
+const double cities[][2] = {
+    {103.82, 1.35}, {-0.13, 51.51},  {-74.01, 40.71},  {139.69, 35.69},
+    {2.35, 48.86},  {116.40, 39.90}, {151.21, -33.87}, {-122.42, 37.77},
+    {77.21, 28.61}, {-46.63, -23.55}, {37.62, 55.76},  {31.24, 30.04}};
+constexpr size_t city_count = sizeof(cities) / sizeof(cities[0]);
+
+// topics of the texts; the embedding of a text is near the centroid of its
+// topic
+const char *topics[] = {"food",  "coffee",   "museum", "park",
+                        "hotel", "shopping", "music",  "sports"};
+constexpr size_t topic_count = sizeof(topics) / sizeof(topics[0]);
+
+const char *words[] = {"quiet",   "busy",    "cheap",  "friendly", "modern",
+                       "old",     "famous",  "small",  "large",    "clean",
+                       "crowded", "cozy",    "open",   "late",     "local",
+                       "new",     "popular", "scenic", "historic", "family"};
+constexpr size_t word_count = sizeof(words) / sizeof(words[0]);
+
+// @ stands for the table of the text
+const char *semantic_questions[] = {
+    "Is {@.text} about somewhere to eat?",
+    "Does {@.text} describe a place suitable for children?",
+    "Is {@.text} a positive description?",
+    "Would a tourist want to visit the place of {@.text}?"};
+constexpr size_t question_count =
+    sizeof(semantic_questions) / sizeof(semantic_questions[0]);
+
+class Generator {
+ public:
+  explicit Generator(ulong seed) : m_random(seed) {
+    std::normal_distribution<double> normal;
+    m_centroids.resize(topic_count * opt_dimension);
+    for (auto &element : m_centroids) element = normal(m_random);
+  }
+
+  size_t uniform(size_t n) {
+    return std::uniform_int_distribution<size_t>(0, n - 1)(m_random);
+  }
+
+  double uniform(double low, double high) {
+    return std::uniform_real_distribution<double>(low, high)(m_random);
+  }
+
+  /** a point near one of the cities, as ST_SRID(POINT(lon, lat), 4326) */
+  std::string point() {
+    const double *city = cities[uniform(city_count)];
+    std::normal_distribution<double> offset(0, 0.05);
+    char buf[96];
+    snprintf(buf, sizeof(buf), "ST_SRID(POINT(%.6f, %.6f), 4326)",
+             city[0] + offset(m_random),
+             std::max(-89.0, std::min(89.0, city[1] + offset(m_random))));
+    return buf;
+  }
+
+  /** an embedding near the centroid of the topic, as a JSON array */
+  std::string embedding(size_t topic) {
+    std::normal_distribution<double> noise(0, 0.5);
+    std::string json = "[";
+    char buf[32];
+    for (size_t i = 0; i < opt_dimension; ++i) {
+      snprintf(buf, sizeof(buf), "%s%.5f", i ? "," : "",
+               m_centroids[topic * opt_dimension + i] + noise(m_random));
+      json += buf;
+    }
+    json += "]";
+    return json;
+  }
+
+  std::string question(const std::string &table) {
+    std::string question = semantic_questions[uniform(question_count)];
+    question.replace(question.find('@'), 1, table);
+    return question;
+  }
+
+  std::string text(size_t topic) {
+    std::string text = "A";
+    for (int i = 0; i < 3; ++i) {
+      text += " ";
+      text += words[uniform(word_count)];
+    }
+    text += " ";
+    text += topics[topic];
+    text += " place";
+    return text;
+  }
+
+ private:
+  std::mt19937_64 m_random;
+  std::vector<double> m_centroids;
+};
+
+/** parse --mix into a weight per kind, return true on error */
+bool parse_mix(std::vector<double> *weights) {
+  weights->assign(KIND_COUNT, 0);
+  std::string mix = opt_mix;
+  size_t begin = 0;
+  while (begin < mix.size()) {
+    size_t end = mix.find(',', begin);
+    if (end == std::string::npos) end = mix.size();
+    const std::string item = mix.substr(begin, end - begin);
+    begin = end + 1;
+
+    const size_t colon = item.find(':');
+    const std::string name = item.substr(0, colon);
+    size_t kind = 0;
+    while (kind < KIND_COUNT && name != kind_names[kind]) ++kind;
+    char *weight_end = nullptr;
+    const double weight =
+        colon == std::string::npos
+            ? 1
+            : strtod(item.c_str() + colon + 1, &weight_end);
+    if (kind == KIND_COUNT || weight < 0 ||
+        (weight_end != nullptr && *weight_end != '\0')) {
+      fprintf(stderr, "%s: bad --mix entry '%s'\n", my_progname,
+              item.c_str());
+      return true;
+    }
+    (*weights)[kind] = weight;
+  }
+  double total = 0;
+  for (const double weight : *weights) total += weight;
+  if (total <= 0) {
+    fprintf(stderr, "%s: --mix has no query\n", my_progname);
+    return true;
+  }
+  return false;
+}
+
+bool write_create(Generator &gen, FILE *file) {
+  fprintf(file, "DROP TABLE IF EXISTS %s;\n", opt_table);
+  fprintf(file,
+          "CREATE TABLE %s (\n"
+          "  id INT NOT NULL,\n"
+          "  coordinate POINT NOT NULL SRID 4326,\n"
+          "  category INT NOT NULL,\n"
+          "  rating DOUBLE NOT NULL,\n"
+          "  text TEXT NOT NULL,\n"
+          "  text_embedding JSON NOT NULL FB_VECTOR_DIMENSION %lu,\n"
+          "  PRIMARY KEY (id) COMMENT 'cfname=cf1',\n"
+          "  INDEX key_category(category) COMMENT 'cfname=cf1',\n"
+          "  SPATIAL INDEX key_coordinate(coordinate) "
+          "NEXT_SPATIAL_INDEX_TYPE '%s' COMMENT 'cfname=cf1',\n"
+          "  INDEX key_embedding(text_embedding) FB_VECTOR_INDEX_TYPE '%s' "
+          "COMMENT 'cfname=cf1'\n"
+          ") ENGINE=ROCKSDB;\n",
+          opt_table, opt_dimension, opt_spatial_index_type,
+          opt_vector_index_type);
+
+  for (ulong row = 0; row < opt_rows; ++row) {
+    if (row % opt_batch_size == 0) {
+      fprintf(file, "%sINSERT INTO %s VALUES\n", row ? ";\n" : "", opt_table);
+    } else {
+      fputs(",\n", file);
+    }
+    const size_t topic = gen.uniform(topic_count);
+    fprintf(file, "(%lu, %s, %zu, %.1f, '%s', '%s')", row, gen.point().c_str(),
+            topic, gen.uniform(1.0, 5.0), gen.text(topic).c_str(),
+            gen.embedding(topic).c_str());
+  }
+  if (opt_rows) fputs(";\n", file);
+  return ferror(file) != 0;
+}
+
+std::string hybrid_query(Generator &gen, size_t topic, size_t k) {
+  char buf[512];
+  switch (gen.uniform(3)) {
+    case 0:
+      // vector search filtered by location and rating
+      snprintf(buf, sizeof(buf),
+               "SELECT id FROM %s WHERE rating >= %.1f AND "
+               "ST_Distance(coordinate, %s) < %.0f ORDER BY ",
+               opt_table, gen.uniform(1.0, 4.0), gen.point().c_str(),
+               gen.uniform(1000.0, 20000.0));
+      return buf + std::string("FB_VECTOR_L2(text_embedding, '") +
+             gen.embedding(topic) + "') LIMIT " + std::to_string(k);
+    case 1:
+      // nearest by a weighted sum of both distances
+      snprintf(buf, sizeof(buf),
+               "SELECT id FROM %s ORDER BY %.6f * "
+               "ST_Distance(coordinate, %s) + ",
+               opt_table, gen.uniform(0.0001, 0.01), gen.point().c_str());
+      return buf + std::string("FB_VECTOR_L2(text_embedding, '") +
+             gen.embedding(topic) + "') LIMIT " + std::to_string(k);
+    default:
+      // the model judges the nearest neighbours only
+      return "SELECT id FROM (SELECT id, text FROM " + std::string(opt_table) +
+             " ORDER BY FB_VECTOR_L2(text_embedding, '" +
+             gen.embedding(topic) + "') LIMIT " + std::to_string(2 * k) +
+             ") t WHERE SEMANTIC_FILTER_SINGLE_COL('" + gen.question("t") +
+             "', text) = 1";
+  }
+}
+
+std::string query(Generator &gen, Query_kind kind) {
+  const size_t topic = gen.uniform(topic_count);
+  const size_t k = 10;
+  char buf[512];
+  switch (kind) {
+    case VECTOR:
+      return "SELECT id FROM " + std::string(opt_table) +
+             " ORDER BY FB_VECTOR_L2(text_embedding, '" + gen.embedding(topic) +
+             "') LIMIT " + std::to_string(k);
+    case SPATIAL:
+      snprintf(buf, sizeof(buf),
+               "SELECT id FROM %s WHERE ST_Distance(coordinate, %s) < %.0f",
+               opt_table, gen.point().c_str(), gen.uniform(200.0, 2000.0));
+      return buf;
+    case RELATIONAL:
+      snprintf(buf, sizeof(buf),
+               "SELECT category, COUNT(*), AVG(rating) FROM %s "
+               "WHERE category = %zu AND rating >= %.1f GROUP BY category",
+               opt_table, topic, gen.uniform(1.0, 5.0));
+      return buf;
+    case SEMANTIC:
+      // a selective relational predicate keeps the calls to the model few
+      if (gen.uniform(2) == 0) {
+        snprintf(buf, sizeof(buf),
+                 "SELECT id FROM %s WHERE category = %zu AND rating >= 4.9 "
+                 "AND SEMANTIC_FILTER_SINGLE_COL('%s', text) = 1",
+                 opt_table, topic, gen.question(opt_table).c_str());
+        return buf;
+      }
+      return "SELECT id, SEMANTIC_RANK(text_embedding, 'a " +
+             std::string(topics[topic]) + " place') AS score FROM " +
+             opt_table + " WHERE category = " + std::to_string(topic) +
+             " ORDER BY score DESC LIMIT " + std::to_string(k);
+    case HYBRID:
+      return hybrid_query(gen, topic, k);
+    case KIND_COUNT:
+      break;
+  }
+  return "";
+}
+
+bool write_queries(Generator &gen, const std::vector<double> &weights,
+                   FILE *file) {
+  std::discrete_distribution<int> pick(weights.begin(), weights.end());
+  std::mt19937_64 random(opt_seed + 1);
+  for (ulong i = 0; i < opt_queries; ++i) {
+    const auto kind = static_cast<Query_kind>(pick(random));
+    fprintf(file, "%s;\n", query(gen, kind).c_str());
+  }
+  return ferror(file) != 0;
+}
+
+bool write_file(const char *path, const std::function<bool(FILE *)> &write) {
+  FILE *file = fopen(path, "w");
+  if (file == nullptr) {
+    fprintf(stderr, "%s: cannot open %s for writing\n", my_progname, path);
+    return true;
+  }
+  const bool error = write(file);
+  if (fclose(file) != 0 || error) {
+    fprintf(stderr, "%s: cannot write %s\n", my_progname, path);
+    return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  MY_INIT(argv[0]);
+
+  MEM_ROOT alloc{PSI_NOT_INSTRUMENTED, 512};
+  if (load_defaults("my", load_default_groups, &argc, &argv, &alloc)) exit(1);
+  if (int ho_error =
+          handle_options(&argc, &argv, my_long_options, get_one_option))
+    exit(ho_error);
+
+  if (opt_create_file == nullptr && opt_query_file == nullptr) {
+    fprintf(stderr, "%s: nothing to do, give --create-file or --query-file\n",
+            my_progname);
+    exit(1);
+  }
+  std::vector<double> weights;
+  if (parse_mix(&weights)) exit(1);
+
+  // the same seed draws the same topics for the table and the queries, and
+  // the queries do not depend on whether the table is written
+  Generator table_gen(opt_seed);
+  Generator query_gen(opt_seed);
+  int error = 0;
+  if (opt_create_file &&
+      write_file(opt_create_file,
+                 [&](FILE *file) { return write_create(table_gen, file); }))
+    error = 1;
+  if (!error && opt_query_file &&
+      write_file(opt_query_file, [&](FILE *file) {
+        return write_queries(query_gen, weights, file);
+      }))
+    error = 1;
+
+  my_end(0);
+  exit(error);
+}
@@ -0,0 +1,633 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+/*
+  Recall and latency of the vector indexes, in the style of ann-benchmarks.
+
+  Loads the base vectors of a dataset in the TEXMEX .fvecs format (SIFT1M,
+  GIST1M, DEEP1B; GloVe once converted) into a MyRocks table with a vector
+  index, then runs the query vectors with every combination of k, nprobe,
+  limit multiplier and number of concurrent clients given, and prints
+  recall@k, QPS and p50/p99 latency per combination as CSV or JSON.
+*/
+
+#include <mysql.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "caching_sha2_passwordopt-vars.h"
+#include "client/client_priv.h"
+#include "my_alloc.h"
+#include "my_dbug.h"
+#include "my_default.h"
+#include "my_inttypes.h"
+#include "my_macros.h"
+#include "my_sys.h"
+#include "print_version.h"
+#include "sslopt-vars.h"
+#include "typelib.h"
+#include "welcome_copyright_notice.h" /* ORACLE_WELCOME_COPYRIGHT_NOTICE */
+
+static char *host = nullptr, *user = nullptr;
+static char *opt_mysql_unix_port = nullptr;
+static uint opt_mysql_port = 0;
+static uint opt_protocol = 0;
+static uint my_end_arg = 0;
+static const char *opt_database = "test";
+static const char *opt_table = "vector_bench";
+static char *opt_base = nullptr, *opt_queries = nullptr;
+static char *opt_groundtruth = nullptr;
+static ulong opt_base_rows = 0, opt_query_count = 0;
+static ulong opt_batch_size = 1000;
+static bool opt_load = false;
+static const char *opt_index_type = "ivfflat";
+static char *opt_index_options = nullptr;
+static const char *opt_metric = "l2";
+static const char *opt_k = "10";
+static const char *opt_nprobe = "16";
+static const char *opt_limit_multiplier = "1";
+static const char *opt_concurrency = "1";
+static const char *opt_format = "csv";
+
+#include "multi_factor_passwordopt-vars.h"
+
+static const char *load_default_groups[] = {"mysql_vector_bench", "client",
+                                            nullptr};
+
+static struct my_option my_long_options[] = {
+    {"base", OPT_MAX_CLIENT_OPTION, "Base vectors of the dataset, .fvecs.",
+     &opt_base, &opt_base, nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0, nullptr, 0,
+     nullptr},
+    {"base-rows", OPT_MAX_CLIENT_OPTION,
+     "Use only this many base vectors, 0 for all of them.", &opt_base_rows,
+     &opt_base_rows, nullptr, GET_ULONG, REQUIRED_ARG, 0, 0, 0, nullptr, 0,
+     nullptr},
+    {"batch-size", OPT_MAX_CLIENT_OPTION, "Rows per INSERT when loading.",
+     &opt_batch_size, &opt_batch_size, nullptr, GET_ULONG, REQUIRED_ARG, 1000,
+     1, 100000, nullptr, 0, nullptr},
+    {"concurrency", OPT_MAX_CLIENT_OPTION,
+     "Comma separated numbers of concurrent clients to run the queries with.",
+     &opt_concurrency, &opt_concurrency, nullptr, GET_STR, REQUIRED_ARG, 0, 0,
+     0, nullptr, 0, nullptr},
+    {"database", 'D', "Database of the table.", &opt_database, &opt_database,
+     nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"debug", '#', "Output debug log. Often this is 'd:t:o,filename'.", nullptr,
+     nullptr, nullptr, GET_STR, OPT_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"format", OPT_MAX_CLIENT_OPTION, "Output format, csv or json.",
+     &opt_format, &opt_format, nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0, nullptr,
+     0, nullptr},
+    {"groundtruth", OPT_MAX_CLIENT_OPTION,
+     "Ids of the nearest base vectors of each query, .ivecs. Computed by "
+     "brute force when not given, or when --base-rows is.",
+     &opt_groundtruth, &opt_groundtruth, nullptr, GET_STR, REQUIRED_ARG, 0, 0,
+     0, nullptr, 0, nullptr},
+    {"help", '?', "Display this help and exit.", nullptr, nullptr, nullptr,
+     GET_NO_ARG, NO_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"host", 'h', "Connect to host.", &host, &host, nullptr, GET_STR,
+     REQUIRED_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"index-options", OPT_MAX_CLIENT_OPTION,
+     "More attributes of the vector index, e.g. "
+     "\"FB_VECTOR_TRAINED_INDEX_TABLE 'VECTORDB_DATA' "
+     "FB_VECTOR_TRAINED_INDEX_ID 'sift_ivf' COMMENT 'cfname=cf1'\".",
+     &opt_index_options, &opt_index_options, nullptr, GET_STR, REQUIRED_ARG, 0,
+     0, 0, nullptr, 0, nullptr},
+    {"index-type", OPT_MAX_CLIENT_OPTION,
+     "FB_VECTOR_INDEX_TYPE of the vector index: flat, ivfflat, ivfpq, "
+     "ivfsq8, ivffp16, lsmidx or graph.",
+     &opt_index_type, &opt_index_type, nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0,
+     nullptr, 0, nullptr},
+    {"k", OPT_MAX_CLIENT_OPTION,
+     "Comma separated LIMITs of the queries, recall is measured at each.",
+     &opt_k, &opt_k, nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0, nullptr, 0,
+     nullptr},
+    {"limit-multiplier", OPT_MAX_CLIENT_OPTION,
+     "Comma separated values of fb_vector_search_limit_multiplier.",
+     &opt_limit_multiplier, &opt_limit_multiplier, nullptr, GET_STR,
+     REQUIRED_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"load", OPT_MAX_CLIENT_OPTION,
+     "Create the table and load the base vectors into it, dropping the table "
+     "if it exists.",
+     &opt_load, &opt_load, nullptr, GET_BOOL, NO_ARG, 0, 0, 0, nullptr, 0,
+     nullptr},
+    {"metric", OPT_MAX_CLIENT_OPTION,
+     "Distance of the search: l2, ip or cosine.", &opt_metric, &opt_metric,
+     nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"nprobe", OPT_MAX_CLIENT_OPTION,
+     "Comma separated values of fb_vector_search_nprobe.", &opt_nprobe,
+     &opt_nprobe, nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0, nullptr, 0, nullptr},
+#include "multi_factor_passwordopt-longopts.h"
+    {"port", 'P', "Port number to use for connection.", &opt_mysql_port,
+     &opt_mysql_port, nullptr, GET_UINT, REQUIRED_ARG, 0, 0, 0, nullptr, 0,
+     nullptr},
+    {"protocol", OPT_MYSQL_PROTOCOL,
+     "The protocol to use for connection (tcp, socket, pipe, memory).", nullptr,
+     nullptr, nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"queries", OPT_MAX_CLIENT_OPTION, "Query vectors of the dataset, .fvecs.",
+     &opt_queries, &opt_queries, nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0,
+     nullptr, 0, nullptr},
+    {"query-count", OPT_MAX_CLIENT_OPTION,
+     "Run only this many query vectors, 0 for all of them.", &opt_query_count,
+     &opt_query_count, nullptr, GET_ULONG, REQUIRED_ARG, 0, 0, 0, nullptr, 0,
+     nullptr},
+    {"socket", 'S', "The socket file to use for connection.",
+     &opt_mysql_unix_port, &opt_mysql_unix_port, nullptr, GET_STR, REQUIRED_ARG,
+     0, 0, 0, nullptr, 0, nullptr},
+#include "caching_sha2_passwordopt-longopts.h"
+#include "sslopt-longopts.h"
+
+    {"table", OPT_MAX_CLIENT_OPTION, "Table holding the base vectors.",
+     &opt_table, &opt_table, nullptr, GET_STR, REQUIRED_ARG, 0, 0, 0, nullptr,
+     0, nullptr},
+    {"user", 'u', "User for login if not current user.", &user, &user, nullptr,
+     GET_STR, REQUIRED_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {"version", 'V', "Output version information and exit.", nullptr, nullptr,
+     nullptr, GET_NO_ARG, NO_ARG, 0, 0, 0, nullptr, 0, nullptr},
+    {nullptr, 0, nullptr, nullptr, nullptr, nullptr, GET_NO_ARG, NO_ARG, 0, 0,
+     0, nullptr, 0, nullptr}};
+
+static void usage(void) {
+  print_version();
+  puts(ORACLE_WELCOME_COPYRIGHT_NOTICE("2025"));
+  puts(
+      "Measures recall@k, QPS and latency of the vector indexes of MyRocks "
+      "tables.\n");
+  printf("Usage: %s [OPTIONS] --base=FILE --queries=FILE\n", my_progname);
+  print_defaults("my", load_default_groups);
+  my_print_help(my_long_options);
+  my_print_variables(my_long_options);
+}
+
+extern "C" {
+static bool get_one_option(int optid, const struct my_option *opt,
+                           char *argument) {
+  switch (optid) {
+    PARSE_COMMAND_LINE_PASSWORD_OPTION;
+    case OPT_MYSQL_PROTOCOL:
+      opt_protocol =
+          find_type_or_exit(argument, &sql_protocol_typelib, opt->name);
+      break;
+    case '#':
+      DBUG_PUSH(argument ? argument : "d:t:o");
+      break;
+#include "sslopt-case.h"
+
+    case 'V':
+      print_version();
+      exit(0);
+    case '?':
+      usage();
+      exit(0);
+  }
+  return false;
+}
+}  // extern "C"
+
+namespace {
+
+/** vectors of one dimension stored back to back */
+struct Vectors {
+  size_t dimension = 0;
+  std::vector<float> data;
+
+  size_t size() const { return dimension ? data.size() / dimension : 0; }
+  const float *at(size_t i) const { return data.data() + i * dimension; }
+};
+
+/** one combination of the parameters swept */
+struct Run {
+  uint k;
+  uint nprobe;
+  uint limit_multiplier;
+  uint concurrency;
+};
+
+struct Run_result {
+  double recall = 0;
+  double qps = 0;
+  double p50_ms = 0;
+  double p99_ms = 0;
+  size_t errors = 0;
+};
+
+/**
+  read up to max_rows records of a TEXMEX file: each one is the dimension as
+  a little endian int32, then that many 4 byte elements. return true on error
+*/
+template <typename T>
+bool read_vecs(const char *path, size_t max_rows, size_t *dimension,
+               std::vector<T> *data) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    fprintf(stderr, "%s: cannot open %s\n", my_progname, path);
+    return true;
+  }
+  *dimension = 0;
+  data->clear();
+  int32_t d;
+  while ((max_rows == 0 || data->size() / std::max<size_t>(*dimension, 1) <
+                               max_rows) &&
+         in.read(reinterpret_cast<char *>(&d), sizeof(d))) {
+    if (d <= 0 || (*dimension != 0 && static_cast<size_t>(d) != *dimension)) {
+      fprintf(stderr, "%s: %s is not a .fvecs/.ivecs file\n", my_progname,
+              path);
+      return true;
+    }
+    *dimension = d;
+    const size_t offset = data->size();
+    data->resize(offset + d);
+    if (!in.read(reinterpret_cast<char *>(data->data() + offset),
+                 d * sizeof(T))) {
+      fprintf(stderr, "%s: %s is truncated\n", my_progname, path);
+      return true;
+    }
+  }
+  return false;
+}
+
+/** parse a comma separated list of positive numbers, return true on error */
+bool parse_list(const char *name, const char *value, std::vector<uint> *list) {
+  list->clear();
+  std::string item;
+  for (const char *pos = value;; ++pos) {
+    if (*pos == ',' || *pos == '\0') {
+      char *end;
+      const unsigned long number = strtoul(item.c_str(), &end, 10);
+      if (item.empty() || *end != '\0' || number == 0) {
+        fprintf(stderr, "%s: bad value '%s' of --%s\n", my_progname,
+                item.c_str(), name);
+        return true;
+      }
+      list->push_back(static_cast<uint>(number));
+      item.clear();
+      if (*pos == '\0') break;
+    } else {
+      item += *pos;
+    }
+  }
+  return false;
+}
+
+bool is_l2() { return strcmp(opt_metric, "l2") == 0; }
+
+const char *distance_function() {
+  if (strcmp(opt_metric, "ip") == 0) return "FB_VECTOR_IP";
+  if (strcmp(opt_metric, "cosine") == 0) return "FB_VECTOR_COSINE";
+  return "FB_VECTOR_L2";
+}
+
+/** score of a base vector for a query, the smaller the better */
+float score(const float *v1, const float *v2, size_t dimension) {
+  double l2 = 0, ip = 0, n1 = 0, n2 = 0;
+  for (size_t i = 0; i < dimension; ++i) {
+    l2 += (v1[i] - v2[i]) * (v1[i] - v2[i]);
+    ip += v1[i] * v2[i];
+    n1 += v1[i] * v1[i];
+    n2 += v2[i] * v2[i];
+  }
+  if (is_l2()) return l2;
+  if (strcmp(opt_metric, "ip") == 0) return -ip;
+  return n1 > 0 && n2 > 0 ? -ip / std::sqrt(n1 * n2) : 0;
+}
+
+/** ids of the k best base vectors of every query, spread over the cpus */
+void brute_force(const Vectors &base, const Vectors &queries, size_t k,
+                 std::vector<int32_t> *groundtruth) {
+  groundtruth->assign(queries.size() * k, -1);
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    std::vector<std::pair<float, int32_t>> heap;
+    for (size_t q = next++; q < queries.size(); q = next++) {
+      heap.clear();
+      for (size_t row = 0; row < base.size(); ++row) {
+        const float s = score(queries.at(q), base.at(row), base.dimension);
+        if (heap.size() == k) {
+          if (s >= heap.front().first) continue;
+          std::pop_heap(heap.begin(), heap.end());
+          heap.pop_back();
+        }
+        heap.emplace_back(s, static_cast<int32_t>(row));
+        std::push_heap(heap.begin(), heap.end());
+      }
+      std::sort_heap(heap.begin(), heap.end());
+      for (size_t i = 0; i < heap.size(); ++i)
+        (*groundtruth)[q * k + i] = heap[i].second;
+    }
+  };
+  std::vector<std::thread> threads;
+  for (uint i = 0; i < std::max(1U, std::thread::hardware_concurrency()); ++i)
+    threads.emplace_back(worker);
+  for (auto &thread : threads) thread.join();
+}
+
+std::string json_vector(const float *v, size_t dimension) {
+  std::string json = "[";
+  char buf[32];
+  for (size_t i = 0; i < dimension; ++i) {
+    snprintf(buf, sizeof(buf), "%s%.9g", i ? "," : "", v[i]);
+    json += buf;
+  }
+  json += "]";
+  return json;
+}
+
+MYSQL *connect() {
+  MYSQL *mysql = mysql_init(nullptr);
+  if (mysql == nullptr) return nullptr;
+  if (SSL_SET_OPTIONS(mysql)) {
+    fprintf(stderr, "%s", SSL_SET_OPTIONS_ERROR);
+    mysql_close(mysql);
+    return nullptr;
+  }
+  if (opt_protocol)
+    mysql_options(mysql, MYSQL_OPT_PROTOCOL, (char *)&opt_protocol);
+  mysql_options(mysql, MYSQL_OPT_CONNECT_ATTR_RESET, nullptr);
+  mysql_options4(mysql, MYSQL_OPT_CONNECT_ATTR_ADD, "program_name",
+                 "mysql_vector_bench");
+  set_server_public_key(mysql);
+  set_get_server_public_key_option(mysql);
+  set_password_options(mysql);
+  if (!mysql_real_connect(mysql, host, user, nullptr, opt_database,
+                          opt_mysql_port, opt_mysql_unix_port, 0)) {
+    fprintf(stderr, "%s: %s\n", my_progname, mysql_error(mysql));
+    mysql_close(mysql);
+    return nullptr;
+  }
+  if (ssl_client_check_post_connect_ssl_setup(
+          mysql, [](const char *err) { fprintf(stderr, "%s\n", err); })) {
+    mysql_close(mysql);
+    return nullptr;
+  }
+  return mysql;
+}
+
+bool run_query(MYSQL *mysql, const std::string &query) {
+  if (mysql_real_query(mysql, query.data(), query.length())) {
+    fprintf(stderr, "%s: %s\n", my_progname, mysql_error(mysql));
+    return true;
+  }
+  MYSQL_RES *result = mysql_store_result(mysql);
+  if (result) mysql_free_result(result);
+  return false;
+}
+
+bool load(MYSQL *mysql, const Vectors &base) {
+  std::string ddl = "DROP TABLE IF EXISTS ";
+  ddl += opt_table;
+  if (run_query(mysql, ddl)) return true;
+
+  ddl = "CREATE TABLE ";
+  ddl += opt_table;
+  ddl += " (id BIGINT NOT NULL PRIMARY KEY, emb JSON NOT NULL "
+         "FB_VECTOR_DIMENSION ";
+  ddl += std::to_string(base.dimension);
+  ddl += ", INDEX vector_key(emb) FB_VECTOR_INDEX_TYPE '";
+  ddl += opt_index_type;
+  ddl += "' FB_VECTOR_INDEX_METRIC '";
+  ddl += opt_metric;
+  ddl += "'";
+  if (opt_index_options) {
+    ddl += " ";
+    ddl += opt_index_options;
+  }
+  ddl += ") ENGINE=ROCKSDB";
+  if (run_query(mysql, ddl)) return true;
+
+  for (size_t row = 0; row < base.size(); row += opt_batch_size) {
+    std::string insert = "INSERT INTO ";
+    insert += opt_table;
+    insert += " VALUES ";
+    const size_t end = std::min<size_t>(base.size(), row + opt_batch_size);
+    for (size_t i = row; i < end; ++i) {
+      if (i != row) insert += ",";
+      insert += "(" + std::to_string(i) + ",'";
+      insert += json_vector(base.at(i), base.dimension);
+      insert += "')";
+    }
+    if (run_query(mysql, insert)) return true;
+  }
+  return false;
+}
+
+/**
+  run every query once over run.concurrency connections. groundtruth holds
+  the gt_k best ids of each query
+*/
+bool measure(const Run &run, const Vectors &queries,
+             const std::vector<int32_t> &groundtruth, size_t gt_k,
+             Run_result *result) {
+  std::vector<double> latencies(queries.size(), 0);
+  std::vector<double> recalls(queries.size(), 0);
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> errors{0};
+  std::atomic<bool> failed{false};
+
+  auto client = [&]() {
+    mysql_thread_init();
+    MYSQL *mysql = connect();
+    std::string set = "SET SESSION fb_vector_search_nprobe = " +
+                      std::to_string(run.nprobe) +
+                      ", SESSION fb_vector_search_limit_multiplier = " +
+                      std::to_string(run.limit_multiplier);
+    if (mysql == nullptr || run_query(mysql, set)) {
+      failed = true;
+    } else {
+      for (size_t q = next++; q < queries.size() && !failed; q = next++) {
+        std::string select = "SELECT id FROM ";
+        select += opt_table;
+        select += " ORDER BY ";
+        select += distance_function();
+        select += "(emb, '" + json_vector(queries.at(q), queries.dimension);
+        select += is_l2() ? "') LIMIT " : "') DESC LIMIT ";
+        select += std::to_string(run.k);
+
+        const auto start = std::chrono::steady_clock::now();
+        MYSQL_RES *res = nullptr;
+        if (mysql_real_query(mysql, select.data(), select.length()) ||
+            (res = mysql_store_result(mysql)) == nullptr) {
+          errors++;
+          continue;
+        }
+        latencies[q] = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+
+        std::unordered_set<int32_t> expected(
+            groundtruth.begin() + q * gt_k,
+            groundtruth.begin() + q * gt_k + std::min<size_t>(run.k, gt_k));
+        size_t found = 0;
+        while (MYSQL_ROW row = mysql_fetch_row(res))
+          found += expected.count(atoi(row[0]));
+        mysql_free_result(res);
+        recalls[q] = static_cast<double>(found) / expected.size();
+      }
+    }
+    if (mysql) mysql_close(mysql);
+    mysql_thread_end();
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (uint i = 0; i < run.concurrency; ++i) threads.emplace_back(client);
+  for (auto &thread : threads) thread.join();
+  const double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  if (failed) return true;
+
+  result->errors = errors;
+  const size_t done = queries.size() - errors;
+  result->qps = seconds > 0 ? done / seconds : 0;
+  double recall_sum = 0;
+  for (const double recall : recalls) recall_sum += recall;
+  result->recall = done ? recall_sum / done : 0;
+  std::sort(latencies.begin(), latencies.end());
+  // failed queries left a latency of 0 at the front
+  latencies.erase(latencies.begin(), latencies.begin() + errors);
+  if (!latencies.empty()) {
+    result->p50_ms = latencies[(latencies.size() - 1) / 2];
+    result->p99_ms = latencies[(latencies.size() - 1) * 99 / 100];
+  }
+  return false;
+}
+
+void print_result(const Run &run, const Run_result &result, bool first) {
+  const bool json = strcmp(opt_format, "json") == 0;
+  if (first && !json)
+    printf(
+        "index_type,metric,k,nprobe,limit_multiplier,concurrency,recall,qps,"
+        "p50_ms,p99_ms,errors\n");
+  if (json) {
+    printf(
+        "%s{\"index_type\": \"%s\", \"metric\": \"%s\", \"k\": %u, "
+        "\"nprobe\": %u, \"limit_multiplier\": %u, \"concurrency\": %u, "
+        "\"recall\": %.4f, \"qps\": %.1f, \"p50_ms\": %.3f, "
+        "\"p99_ms\": %.3f, \"errors\": %zu}",
+        first ? "[\n  " : ",\n  ", opt_index_type, opt_metric, run.k,
+        run.nprobe, run.limit_multiplier, run.concurrency, result.recall,
+        result.qps, result.p50_ms, result.p99_ms, result.errors);
+  } else {
+    printf("%s,%s,%u,%u,%u,%u,%.4f,%.1f,%.3f,%.3f,%zu\n", opt_index_type,
+           opt_metric, run.k, run.nprobe, run.limit_multiplier,
+           run.concurrency, result.recall, result.qps, result.p50_ms,
+           result.p99_ms, result.errors);
+  }
+  fflush(stdout);
+}
+
+int bench() {
+  std::vector<uint> ks, nprobes, multipliers, concurrencies;
+  if (parse_list("k", opt_k, &ks) ||
+      parse_list("nprobe", opt_nprobe, &nprobes) ||
+      parse_list("limit-multiplier", opt_limit_multiplier, &multipliers) ||
+      parse_list("concurrency", opt_concurrency, &concurrencies))
+    return 1;
+  if (strcmp(opt_metric, "l2") && strcmp(opt_metric, "ip") &&
+      strcmp(opt_metric, "cosine")) {
+    fprintf(stderr, "%s: unknown --metric %s\n", my_progname, opt_metric);
+    return 1;
+  }
+  if (opt_base == nullptr || opt_queries == nullptr) {
+    fprintf(stderr, "%s: --base and --queries are required\n", my_progname);
+    return 1;
+  }
+
+  Vectors base, queries;
+  if (read_vecs(opt_base, opt_base_rows, &base.dimension, &base.data) ||
+      read_vecs(opt_queries, opt_query_count, &queries.dimension,
+                &queries.data))
+    return 1;
+  if (base.dimension != queries.dimension) {
+    fprintf(stderr, "%s: base and queries differ in dimension\n", my_progname);
+    return 1;
+  }
+
+  // a groundtruth file is for the whole base
+  const size_t max_k = *std::max_element(ks.begin(), ks.end());
+  std::vector<int32_t> groundtruth;
+  size_t gt_k = 0;
+  if (opt_groundtruth && opt_base_rows == 0) {
+    if (read_vecs(opt_groundtruth, queries.size(), &gt_k, &groundtruth))
+      return 1;
+    if (groundtruth.size() != queries.size() * gt_k || gt_k < max_k) {
+      fprintf(stderr, "%s: %s has too few neighbours\n", my_progname,
+              opt_groundtruth);
+      return 1;
+    }
+  } else {
+    gt_k = max_k;
+    brute_force(base, queries, gt_k, &groundtruth);
+  }
+
+  if (opt_load) {
+    MYSQL *mysql = connect();
+    if (mysql == nullptr) return 1;
+    const bool error = load(mysql, base);
+    mysql_close(mysql);
+    if (error) return 1;
+  }
+
+  bool first = true;
+  for (const uint k : ks)
+    for (const uint nprobe : nprobes)
+      for (const uint multiplier : multipliers)
+        for (const uint concurrency : concurrencies) {
+          const Run run{k, nprobe, multiplier, concurrency};
+          Run_result result;
+          if (measure(run, queries, groundtruth, gt_k, &result)) return 1;
+          print_result(run, result, first);
+          first = false;
+        }
+  if (!first && strcmp(opt_format, "json") == 0) printf("\n]\n");
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  MY_INIT(argv[0]);
+
+  my_getopt_use_args_separator = true;
+  MEM_ROOT alloc{PSI_NOT_INSTRUMENTED, 512};
+  if (load_defaults("my", load_default_groups, &argc, &argv, &alloc)) exit(1);
+  my_getopt_use_args_separator = false;
+
+  if (int ho_error =
+          handle_options(&argc, &argv, my_long_options, get_one_option))
+    exit(ho_error);
+
+  if (mysql_library_init(-1, nullptr, nullptr)) {
+    fprintf(stderr, "%s: cannot initialize the client library\n",
+            my_progname);
+    exit(1);
+  }
+  const int error = bench();
+
+  free_passwords();
+  mysql_library_end();
+  my_end(my_end_arg);
+  exit(error);
+}
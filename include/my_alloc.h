@@ -111,6 +111,7 @@ struct MEM_ROOT {
         m_max_capacity(other.m_max_capacity),
         m_allocated_size(other.m_allocated_size),
         m_error_for_capacity_exceeded(other.m_error_for_capacity_exceeded),
+        m_large_pages(other.m_large_pages),
         m_error_handler(other.m_error_handler),
         m_psi_key(other.m_psi_key) {
     other.m_current_block = nullptr;
@@ -269,6 +270,14 @@ struct MEM_ROOT {
     return m_error_for_capacity_exceeded;
   }
 
+  /**
+   * Enable/disable backing the blocks allocated from now on with huge pages,
+   * where they span any (see my_advise_large_pages()).
+   *
+   * @param large_pages     whether to ask for huge pages
+   */
+  void set_large_pages(bool large_pages) { m_large_pages = large_pages; }
+
   /**
    * Set the error handler on memory allocation failure (or nullptr for none).
    * The error handler is called called whenever my_malloc() failed to allocate
@@ -414,6 +423,9 @@ struct MEM_ROOT {
   /** If enabled, exceeding the capacity will lead to a my_error() call. */
   bool m_error_for_capacity_exceeded = false;
 
+  /** If enabled, new blocks are backed with huge pages where possible. */
+  bool m_large_pages = false;
+
   void (*m_error_handler)(void) = nullptr;
 
   PSI_memory_key m_psi_key = 0;
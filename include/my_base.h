@@ -420,7 +420,14 @@ enum ha_extra_function {
   */
   HA_EXTRA_ENABLE_UNIQUE_RECORD_FILTER,
   /* Disable and free unique record filter. */
-  HA_EXTRA_DISABLE_UNIQUE_RECORD_FILTER
+  HA_EXTRA_DISABLE_UNIQUE_RECORD_FILTER,
+  /*
+    The rows written until HA_EXTRA_END_BULK_LOAD come in primary key order
+    and may be written straight to the files of the engine.
+  */
+  HA_EXTRA_BEGIN_BULK_LOAD,
+  /* End of the rows of HA_EXTRA_BEGIN_BULK_LOAD, make them visible. */
+  HA_EXTRA_END_BULK_LOAD
 };
 
 /* Compatible option, to be deleted in 6.0 */
@@ -218,6 +218,10 @@ enum enum_sql_command {
   SQLCOM_SHOW_SHARDBEATER_STAT,
   SQLCOM_DUMP,
   SQLCOM_SYNC,
+  SQLCOM_CREATE_MATERIALIZED_VIEW,
+  SQLCOM_REFRESH_MATERIALIZED_VIEW,
+  SQLCOM_DROP_MATERIALIZED_VIEW,
+  SQLCOM_STOP_SYNC,
   /* This should be the last !!! */
   SQLCOM_END
 };
@@ -189,6 +189,18 @@ struct MEM_ROOT;
 /* defines when allocating data */
 extern void *my_multi_malloc(PSI_memory_key key, myf flags, ...);
 
+/*
+  Routing of my_malloc() allocations for chosen PSI memory keys to another
+  allocator, which the server uses to keep subsystems in their own malloc
+  arenas. Memory it returns must be freeable by free(). It may return NULL
+  to fall back to malloc(). Route 0 means malloc(). Only done when memory
+  instrumentation is compiled in.
+*/
+typedef void *(*my_routed_allocator_func)(unsigned route, size_t size,
+                                          myf flags);
+extern void my_malloc_set_routed_allocator(my_routed_allocator_func func);
+extern void my_malloc_route_key(PSI_memory_key key, unsigned route);
+
 /*
   Switch to my_malloc() if the memory block to be allocated is bigger than
   max_alloca_sz.
@@ -221,8 +233,12 @@ extern DebugSyncCallbackFp debug_sync_C_callback_ptr;
 
 #ifdef HAVE_LINUX_LARGE_PAGES
 extern uint my_get_large_page_size(void);
+extern void my_advise_large_pages(void *ptr, size_t size);
 #else
 #define my_get_large_page_size() (0)
+#define my_advise_large_pages(ptr, size) \
+  do {                                   \
+  } while (0)
 #endif /* HAVE_LINUX_LARGE_PAGES */
 
 #define my_alloca(SZ) alloca((size_t)(SZ))
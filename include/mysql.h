@@ -528,6 +528,17 @@ enum net_async_status STDCALL mysql_select_db_nonblocking(MYSQL *mysql,
                                                           const char *db,
                                                           bool *error);
 int STDCALL mysql_get_socket_descriptor(MYSQL *mysql);
+
+typedef void (*mysql_pipeline_callback)(MYSQL *mysql, void *arg);
+int STDCALL mysql_pipeline_send_query(MYSQL *mysql, const char *q,
+                                      unsigned long length,
+                                      mysql_pipeline_callback callback,
+                                      void *arg);
+unsigned int STDCALL mysql_pipeline_pending(MYSQL *mysql);
+bool STDCALL mysql_pipeline_read_result(MYSQL *mysql);
+enum net_async_status STDCALL
+mysql_pipeline_read_result_nonblocking(MYSQL *mysql);
+
 void STDCALL mysql_get_character_set_info(MYSQL *mysql,
                                           MY_CHARSET_INFO *charset);
 
@@ -718,6 +718,15 @@ enum net_async_status mysql_select_db_nonblocking(MYSQL *mysql,
                                                           const char *db,
                                                           bool *error);
 int mysql_get_socket_descriptor(MYSQL *mysql);
+typedef void (*mysql_pipeline_callback)(MYSQL *mysql, void *arg);
+int mysql_pipeline_send_query(MYSQL *mysql, const char *q,
+                                      unsigned long length,
+                                      mysql_pipeline_callback callback,
+                                      void *arg);
+unsigned int mysql_pipeline_pending(MYSQL *mysql);
+bool mysql_pipeline_read_result(MYSQL *mysql);
+enum net_async_status
+mysql_pipeline_read_result_nonblocking(MYSQL *mysql);
 void mysql_get_character_set_info(MYSQL *mysql,
                                           MY_CHARSET_INFO *charset);
 int mysql_session_track_get_first(MYSQL *mysql,
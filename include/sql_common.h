@@ -100,12 +100,15 @@ struct STATE_INFO {
 
 struct st_mysql_trace_info;
 struct mysql_async_connect;
+struct MYSQL_PIPELINE;
 
 struct MYSQL_EXTENSION {
   struct st_mysql_trace_info *trace_data;
   STATE_INFO state_change;
   /* Struct to track the state of asynchronous operations */
   struct MYSQL_ASYNC *mysql_async_context;
+  /* Queries sent by mysql_pipeline_send_query() and not read yet */
+  struct MYSQL_PIPELINE *pipeline;
 #ifdef MYSQL_SERVER
   // Used by replication to pass around compression context data.
   NET_SERVER *server_extn;
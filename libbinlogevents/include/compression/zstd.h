@@ -25,6 +25,8 @@
 
 #include <zstd.h>
 #include <cstddef>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "base.h"
@@ -33,6 +35,79 @@ namespace binary_log {
 namespace transaction {
 namespace compression {
 
+/**
+  A ZSTD dictionary trained on the transaction payloads of a binary log, so
+  that payloads of a few rows compress about as well as a large one does.
+
+  Frames compressed with it carry its id, and decompressors find it by that
+  id among the dictionaries added to the process with add(), so that the
+  format of the payloads does not change. The writer of a binary log puts
+  the dictionary at the head of the file, and its readers add it when they
+  decode it there.
+ */
+class Zstd_dictionary {
+ private:
+  Zstd_dictionary &operator=(const Zstd_dictionary &rhs) = delete;
+  Zstd_dictionary(const Zstd_dictionary &) = delete;
+
+ public:
+  /**
+    The largest dictionary trained, so that it fits a field of a
+    Metadata_event.
+   */
+  static const std::size_t MAX_SIZE = 32 * 1024;
+
+  /**
+    The most dictionaries added to the process, the oldest are dropped.
+   */
+  static const std::size_t MAX_ADDED = 16;
+
+  Zstd_dictionary(const std::string &content, int compression_level);
+  ~Zstd_dictionary();
+
+  /**
+    Train a dictionary on samples of payloads.
+
+    @param samples the samples, one after the other
+    @param sizes the size of each sample
+    @param compression_level the level frames are compressed with
+
+    @return the dictionary, nullptr if there were too few samples to train
+            one.
+   */
+  static std::shared_ptr<Zstd_dictionary> train(
+      const std::string &samples, const std::vector<std::size_t> &sizes,
+      int compression_level);
+
+  /**
+    Make a dictionary known to the decompressors of the process.
+   */
+  static void add(const std::shared_ptr<Zstd_dictionary> &dictionary);
+
+  /**
+    Find a dictionary added to the process.
+
+    @return the dictionary, nullptr if none was added with this id.
+   */
+  static std::shared_ptr<Zstd_dictionary> find(unsigned int id);
+
+  /**
+    @return false if the content is not a dictionary ZSTD can use.
+   */
+  bool is_valid() const { return m_cdict != nullptr && m_ddict != nullptr; }
+
+  unsigned int id() const { return m_id; }
+  const std::string &content() const { return m_content; }
+  const ZSTD_CDict *cdict() const { return m_cdict; }
+  const ZSTD_DDict *ddict() const { return m_ddict; }
+
+ private:
+  const std::string m_content;
+  unsigned int m_id{0};
+  ZSTD_CDict *m_cdict{nullptr};
+  ZSTD_DDict *m_ddict{nullptr};
+};
+
 /**
   This class implements a ZSTD compressor.
  */
@@ -70,6 +145,11 @@ class Zstd_comp : public Compressor {
    */
   unsigned int m_compression_level_next{DEFAULT_COMPRESSION_LEVEL};
 
+  /**
+    The dictionary the next frames are compressed with, if any.
+   */
+  std::shared_ptr<const Zstd_dictionary> m_dictionary;
+
  public:
   Zstd_comp();
   ~Zstd_comp() override;
@@ -78,6 +158,13 @@ class Zstd_comp : public Compressor {
    */
   void set_compression_level(unsigned int compression_level) override;
 
+  /**
+    Shall set the dictionary to compress with from the next open() on, none
+    if nullptr. Frames are then compressed with the level the dictionary
+    was made for.
+   */
+  void set_dictionary(std::shared_ptr<const Zstd_dictionary> dictionary);
+
   /**
     Shall get the compressor type code.
 
@@ -137,6 +224,17 @@ class Zstd_dec : public Decompressor {
  protected:
   ZSTD_DStream *m_ctx{nullptr};
 
+  /**
+    Whether the frame has not been started since open(), so that its
+    dictionary is still to be found.
+   */
+  bool m_frame_start{true};
+
+  /**
+    The dictionary of the frame, kept while it is decompressed.
+   */
+  std::shared_ptr<Zstd_dictionary> m_dictionary;
+
  public:
   Zstd_dec();
   ~Zstd_dec() override;
@@ -938,6 +938,21 @@ class Metadata_event : public Binary_log_event {
    */
   std::unordered_map<std::string, uint64_t> get_prev_dbtids() const;
 
+  /**
+   * Adds a compression dictionary the transaction payloads of the binlog
+   * file may be compressed with
+   *
+   * @param content - The ZSTD dictionary
+   */
+  void add_compression_dictionary(const std::string &content);
+
+  /**
+   * Get compression dictionaries
+   *
+   * @return the dictionaries, none if not present
+   */
+  const std::vector<std::string> &get_compression_dictionaries() const;
+
   /**
    * The spec for different 'types' supported by this event
    */
@@ -977,6 +992,10 @@ class Metadata_event : public Binary_log_event {
     DBTIDS_TYPE = 13,
     /* Prev DB trx id */
     PREV_DBTIDS_TYPE = 14,
+    /* ZSTD dictionary of transaction payloads, written after
+     * Previous_gtid_log_event in a new binlog file. Readers add it to the
+     * dictionaries known to the process when they decode it */
+    COMPRESSION_DICTIONARY_TYPE = 15,
 
     METADATA_EVENT_TYPE_MAX,
   };
@@ -1077,6 +1096,8 @@ class Metadata_event : public Binary_log_event {
 
   std::unordered_map<std::string, uint64_t> prev_dbtids_;
 
+  std::vector<std::string> compression_dictionaries_;
+
   /* Total size of this event when encoded into the stream */
   size_t size_ = 0;
 
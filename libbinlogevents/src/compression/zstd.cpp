@@ -22,13 +22,76 @@
 
 #include <compression/zstd.h>
 #include <my_byteorder.h>  // TODO: fix this include
+#include <zdict.h>
 #include <algorithm>
+#include <deque>
+#include <mutex>
 #include "wrapper_functions.h"
 
 namespace binary_log {
 namespace transaction {
 namespace compression {
 
+/*
+   ****************************************************************
+   Dictionary
+   ****************************************************************
+ */
+
+namespace {
+/* The dictionaries added to the process, the newest last. */
+std::mutex added_lock;
+std::deque<std::shared_ptr<Zstd_dictionary>> added;
+}  // namespace
+
+Zstd_dictionary::Zstd_dictionary(const std::string &content,
+                                 int compression_level)
+    : m_content(content) {
+  m_id = ZSTD_getDictID_fromDict(m_content.data(), m_content.size());
+  // frames compressed with a dictionary without an id cannot be told apart
+  if (m_id == 0) return;
+  m_cdict = ZSTD_createCDict(m_content.data(), m_content.size(),
+                             compression_level);
+  m_ddict = ZSTD_createDDict(m_content.data(), m_content.size());
+}
+
+Zstd_dictionary::~Zstd_dictionary() {
+  if (m_cdict != nullptr) ZSTD_freeCDict(m_cdict);
+  if (m_ddict != nullptr) ZSTD_freeDDict(m_ddict);
+}
+
+std::shared_ptr<Zstd_dictionary> Zstd_dictionary::train(
+    const std::string &samples, const std::vector<std::size_t> &sizes,
+    int compression_level) {
+  std::string content(MAX_SIZE, '\0');
+  auto ret = ZDICT_trainFromBuffer(&content[0], content.size(),
+                                   samples.data(), sizes.data(),
+                                   static_cast<unsigned>(sizes.size()));
+  // too few or too small samples
+  if (ZDICT_isError(ret)) return nullptr;
+  content.resize(ret);
+
+  auto dictionary =
+      std::make_shared<Zstd_dictionary>(content, compression_level);
+  if (!dictionary->is_valid()) return nullptr;
+  return dictionary;
+}
+
+void Zstd_dictionary::add(const std::shared_ptr<Zstd_dictionary> &dictionary) {
+  std::lock_guard<std::mutex> guard(added_lock);
+  for (const auto &known : added)
+    if (known->id() == dictionary->id()) return;
+  added.push_back(dictionary);
+  if (added.size() > MAX_ADDED) added.pop_front();
+}
+
+std::shared_ptr<Zstd_dictionary> Zstd_dictionary::find(unsigned int id) {
+  std::lock_guard<std::mutex> guard(added_lock);
+  for (const auto &known : added)
+    if (known->id() == id) return known;
+  return nullptr;
+}
+
 /*
    ****************************************************************
    Compressor
@@ -60,6 +123,11 @@ void Zstd_comp::set_compression_level(unsigned int clevel) {
   }
 }
 
+void Zstd_comp::set_dictionary(
+    std::shared_ptr<const Zstd_dictionary> dictionary) {
+  m_dictionary = std::move(dictionary);
+}
+
 Zstd_comp::~Zstd_comp() {
   if (m_ctx != nullptr) {
     ZSTD_freeCStream(m_ctx);
@@ -95,6 +163,11 @@ bool Zstd_comp::open() {
     if (ZSTD_isError(ret)) goto err;
     m_compression_level_current = m_compression_level_next;
   }
+
+  // a reset keeps the dictionary, set it every time as it may have changed
+  ret = ZSTD_CCtx_refCDict(
+      m_ctx, m_dictionary != nullptr ? m_dictionary->cdict() : nullptr);
+  if (ZSTD_isError(ret)) goto err;
 #else
   ret = ZSTD_initCStream(m_ctx, m_compression_level_next);
   if (ZSTD_isError(ret)) goto err;
@@ -209,6 +282,7 @@ bool Zstd_dec::open() {
 #else
   ret = ZSTD_initDStream(m_ctx);
 #endif
+  m_frame_start = true;
 
   return ZSTD_isError(ret);
 }
@@ -225,6 +299,23 @@ std::tuple<std::size_t, bool> Zstd_dec::decompress(const unsigned char *in,
   std::size_t ret{0};
   auto err{false};
 
+#if ZSTD_VERSION_NUMBER >= 10400
+  // the frame header names the dictionary the frame was compressed with
+  if (m_frame_start) {
+    m_frame_start = false;
+    auto id = ZSTD_getDictID_fromFrame(in, in_size);
+    if (id != (m_dictionary != nullptr ? m_dictionary->id() : 0)) {
+      m_dictionary = (id != 0) ? Zstd_dictionary::find(id) : nullptr;
+      // the head of the binary log with the dictionary was not read
+      if (id != 0 && m_dictionary == nullptr)
+        return std::make_tuple(in_size, true);
+      ret = ZSTD_DCtx_refDDict(
+          m_ctx, m_dictionary != nullptr ? m_dictionary->ddict() : nullptr);
+      if (ZSTD_isError(ret)) return std::make_tuple(in_size, true);
+    }
+  }
+#endif
+
   do {
     auto min_buffer_len{ZSTD_DStreamOutSize()};
 
@@ -24,6 +24,7 @@
 #include <sstream>
 #include "codecs/factory.h"
 #include "compression/base.h"
+#include "compression/zstd.h"
 #include "event_reader_macros.h"
 #include "my_dbug.h"
 
@@ -452,6 +453,7 @@ void Metadata_event::set_exist(Metadata_event_types type) {
   assert(index < existing_types_.size());
   assert(type == Metadata_event_types::DBTIDS_TYPE ||
          type == Metadata_event_types::PREV_DBTIDS_TYPE ||
+         type == Metadata_event_types::COMPRESSION_DICTIONARY_TYPE ||
          !existing_types_[index]);
   existing_types_[index] = true;
 }
@@ -640,6 +642,18 @@ std::unordered_map<std::string, uint64_t> Metadata_event::get_prev_dbtids()
   return prev_dbtids_;
 }
 
+void Metadata_event::add_compression_dictionary(const std::string &content) {
+  compression_dictionaries_.push_back(content);
+  set_exist(Metadata_event_types::COMPRESSION_DICTIONARY_TYPE);
+  // Update the size of the event when it gets serialized into the stream.
+  size_ += (ENCODED_TYPE_SIZE + ENCODED_LENGTH_SIZE + content.size());
+}
+
+const std::vector<std::string> &
+Metadata_event::get_compression_dictionaries() const {
+  return compression_dictionaries_;
+}
+
 std::string Metadata_event::get_rotate_tag_string() const {
   switch (raft_rotate_tag_) {
     case RRET_SIMPLE_ROTATE:
@@ -674,6 +688,8 @@ uint Metadata_event::read_type(Metadata_event_types type) {
   uint64_t raft_ingestion_upper_bound = 0;
   const char *ptr_db_name = nullptr;
   uint64_t dbid = 0;
+  const char *ptr_dictionary = nullptr;
+  std::shared_ptr<transaction::compression::Zstd_dictionary> dictionary;
 
   READER_TRY_SET(value_length, read<uint16_t>);
 
@@ -755,6 +771,16 @@ uint Metadata_event::read_type(Metadata_event_types type) {
       ptr_db_name = READER_TRY_CALL(ptr, value_length - sizeof(uint64_t));
       set_prev_dbtid(ptr_db_name, dbid);
       break;
+    case MET::COMPRESSION_DICTIONARY_TYPE:
+      ptr_dictionary = READER_TRY_CALL(ptr, value_length);
+      add_compression_dictionary(std::string(ptr_dictionary, value_length));
+      // the payloads after this event are decompressed with it
+      dictionary = std::make_shared<transaction::compression::Zstd_dictionary>(
+          compression_dictionaries_.back(),
+          transaction::compression::Zstd_comp::DEFAULT_COMPRESSION_LEVEL);
+      if (dictionary->is_valid())
+        transaction::compression::Zstd_dictionary::add(dictionary);
+      break;
 
     default:
       // This is a event which we do not know about. Just skip this
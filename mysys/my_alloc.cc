@@ -91,6 +91,7 @@ MEM_ROOT::Block *MEM_ROOT::AllocBlock(size_t wanted_length,
     return nullptr;
   }
   new_block->end = pointer_cast<char *>(new_block) + bytes_to_alloc;
+  if (m_large_pages) my_advise_large_pages(new_block, bytes_to_alloc);
 
   m_allocated_size += length;
 
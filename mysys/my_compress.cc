@@ -36,6 +36,7 @@
 #include <zlib.h>
 #include <zstd.h>
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 
 #include <mysql_com.h>
@@ -51,12 +52,24 @@
 extern uint net_compression_level;
 extern long zstd_net_compression_level;
 extern long lz4f_net_compression_level;
+extern uint zstd_net_window_log;
+extern double zstd_net_max_entropy;
 #else
 #define net_compression_level 6
 #define zstd_net_compression_level 0
 #define lz4f_net_compression_level 0
+#define zstd_net_window_log 0
+#define zstd_net_max_entropy 8.0
 #endif
 
+/* Bytes of a packet sampled to estimate its entropy. */
+static constexpr size_t ENTROPY_SAMPLE_LENGTH = 4096;
+/*
+  Entropy, in bits per byte, above which a zstd stream starts at level 1:
+  float vectors and such gain little from the slower levels.
+*/
+static constexpr double ZSTD_FAST_ENTROPY = 6.0;
+
 /* Number of times compression context was reset for streaming compression. */
 ulonglong compress_ctx_reset = 0;
 /* Number of in/out bytes for compression. */
@@ -254,12 +267,36 @@ static bool zstd_uncompress(mysql_zstd_compress_context *comp_ctx,
   return false;
 }
 
+/**
+  Estimate the Shannon entropy of a packet from the bytes of a sample of it.
+
+  @return the entropy, in bits per byte
+*/
+
+static double packet_entropy(const uchar *packet, size_t len) {
+  if (len == 0) return 0;
+
+  const size_t step = std::max<size_t>(1, len / ENTROPY_SAMPLE_LENGTH);
+  size_t counts[256] = {0};
+  size_t sampled = 0;
+  for (size_t i = 0; i < len; i += step, sampled++) counts[packet[i]]++;
+
+  double entropy = 0;
+  for (size_t count : counts) {
+    if (count == 0) continue;
+    const double p = static_cast<double>(count) / sampled;
+    entropy -= p * std::log2(p);
+  }
+  return entropy;
+}
+
 uchar *zstd_stream_compress_alloc(mysql_zstd_compress_context *zstd_ctx,
                                   const uchar *packet, size_t *len,
                                   size_t *complen, int compression_level) {
   size_t zstd_len = ZSTD_compressBound(*len);
   uchar *compbuf;
   size_t zstd_res;
+  double entropy = 0;
 
   if (zstd_ctx->compress_buf_len < zstd_len) {
     my_free(zstd_ctx->compress_buf);
@@ -286,6 +323,37 @@ uchar *zstd_stream_compress_alloc(mysql_zstd_compress_context *zstd_ctx,
     if (ZSTD_isError(zstd_res)) {
       goto error;
     }
+    // a window larger than a packet lets the rows of a result set refer to
+    // the rows before them. Decoders accept up to 2^27 by default.
+    if (zstd_net_window_log != 0) {
+      zstd_res = ZSTD_CCtx_setParameter(zstd_ctx->cctx, ZSTD_c_windowLog,
+                                        zstd_net_window_log);
+      if (ZSTD_isError(zstd_res)) {
+        goto error;
+      }
+    }
+    zstd_ctx->reset_cctx = true;
+  }
+
+  if (zstd_ctx->reset_cctx) {
+    // a new frame starts with this packet: pick its level by what it holds.
+    entropy = packet_entropy(packet, *len);
+    if (entropy > zstd_net_max_entropy) {
+      DBUG_PRINT("note", ("Packet entropy %.2f; Not compressed", entropy));
+      *complen = 0;
+      compress_ctx_reset++;
+      return NULL;
+    }
+
+    int level =
+        compression_level ? compression_level : zstd_ctx->compression_level;
+    if (entropy > ZSTD_FAST_ENTROPY) level = std::min(level, 1);
+    zstd_res =
+        ZSTD_CCtx_setParameter(zstd_ctx->cctx, ZSTD_c_compressionLevel, level);
+    if (ZSTD_isError(zstd_res)) {
+      goto error;
+    }
+    zstd_ctx->reset_cctx = false;
   }
 
   zstd_res = ZSTD_compressStream(zstd_ctx->cctx, &outBuf, &inBuf);
@@ -322,6 +390,7 @@ nocompress:
   *complen = 0;
 error:
   ZSTD_CCtx_reset(zstd_ctx->cctx, ZSTD_reset_session_only);
+  zstd_ctx->reset_cctx = true;
   compress_ctx_reset++;
   return NULL;
 }
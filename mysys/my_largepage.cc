@@ -30,7 +30,9 @@
 */
 
 #include <fcntl.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 
 #include "my_dbug.h"
@@ -57,6 +59,26 @@ uint my_get_large_page_size(void) {
   return size;
 }
 
+/*
+  Ask for transparent huge pages to back the large pages that lie entirely
+  within [ptr, ptr + size). Memory allocated with my_malloc() keeps its
+  performance schema accounting, and is freed with my_free() as usual.
+*/
+void my_advise_large_pages(void *ptr, size_t size) {
+#ifdef MADV_HUGEPAGE
+  static const uintptr_t page_size = my_get_large_page_size_int();
+  if (page_size == 0) return;
+  const uintptr_t start = reinterpret_cast<uintptr_t>(ptr);
+  const uintptr_t begin = (start + page_size - 1) & ~(page_size - 1);
+  const uintptr_t end = (start + size) & ~(page_size - 1);
+  if (begin < end)
+    madvise(reinterpret_cast<void *>(begin), end - begin, MADV_HUGEPAGE);
+#else
+  (void)ptr;
+  (void)size;
+#endif
+}
+
 /* Linux-specific function to determine the size of large pages */
 
 uint my_get_large_page_size_int(void) {
@@ -33,6 +33,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <atomic>
 
 #ifdef _WIN32
 #include "jemalloc_win.h"
@@ -49,6 +50,7 @@
 #include "mysql/psi/mysql_memory.h"
 #include "mysql/psi/psi_memory.h"
 #include "mysys_err.h"
+#include "template_utils.h"
 
 struct PSI_thread;
 
@@ -75,6 +77,33 @@ static inline void *std_allocator(size_t size, myf my_flags) {
 
 static inline void std_deallocator(void *ptr) { std::free(ptr); }
 
+/** Allocator for keys with non-zero route, @see my_malloc_route_key(). */
+static std::atomic<my_routed_allocator_func> routed_allocator{nullptr};
+
+/** Route of each PSI memory key, keys past the end are never routed. */
+static std::atomic<unsigned char> key_routes[1024];
+
+void my_malloc_set_routed_allocator(my_routed_allocator_func func) {
+  routed_allocator.store(func);
+}
+
+void my_malloc_route_key(PSI_memory_key key, unsigned route) {
+  if (key != PSI_NOT_INSTRUMENTED && key < array_elements(key_routes))
+    key_routes[key].store(route);
+}
+
+#ifdef USE_MALLOC_WRAPPER
+static inline void *routed_malloc(PSI_memory_key key, size_t size,
+                                  myf flags) {
+  if (key >= array_elements(key_routes)) return nullptr;
+  const unsigned route = key_routes[key].load(std::memory_order_relaxed);
+  if (route == 0) return nullptr;
+  const my_routed_allocator_func func =
+      routed_allocator.load(std::memory_order_relaxed);
+  return func != nullptr ? func(route, size, flags) : nullptr;
+}
+#endif  // USE_MALLOC_WRAPPER
+
 #ifndef USE_MALLOC_WRAPPER
 static inline void *std_realloc(void *ptr, size_t size) {
   return std::realloc(ptr, size);
@@ -369,7 +398,11 @@ void *my_internal_malloc(PSI_memory_key key, size_t size, myf flags) {
                 "We must reserve enough memory to hold the header.");
 
   raw_size = PSI_HEADER_SIZE + size;
-  mh = (my_memory_header *)my_raw_malloc<allocator>(raw_size, flags);
+  mh = nullptr;
+  if (allocator == redirecting_allocator)
+    mh = (my_memory_header *)routed_malloc(key, raw_size, flags);
+  if (mh == nullptr)
+    mh = (my_memory_header *)my_raw_malloc<allocator>(raw_size, flags);
   if (likely(mh != nullptr)) {
     void *user_ptr;
     mh->m_magic = PSI_MEMORY_MAGIC;
@@ -2165,6 +2165,22 @@ static int wait_for_cache(pax_machine **pm, synode_no synode, double timeout);
 static int prop_started = 0;
 static int prop_finished = 0;
 
+/* Longest time a proposer waits for more messages to batch */
+#define MAX_BATCH_WAIT 0.005
+
+/* How long a proposer holding a message should wait for more to batch with
+   it. Only worth it when other proposals are in flight, which means that the
+   message would have to wait for them anyway: a fraction of the median
+   round trip of a proposal is then short enough to not add to the latency
+   of a loaded group, and long enough to fill the batch at high write rates.
+   An idle group proposes at once. */
+static double batch_wait_time() {
+  double wait;
+  if (prop_started - prop_finished <= 1) return 0.0;
+  wait = median_time() / 4;
+  return wait < MAX_BATCH_WAIT ? wait : MAX_BATCH_WAIT;
+}
+
 /* Find a free slot locally.
    Note that we will happily increment past the event horizon.
    The caller is thus responsible for checking the validity of the
@@ -2404,6 +2420,11 @@ static int proposer_task(task_arg arg) {
         !is_view(ep->client_msg->p->a->body.c_t)) {
       ep->size = app_data_size(ep->client_msg->p->a);
       ep->nr_batched_app_data = 1;
+      /* Give the queue some time to fill up under load */
+      if (AUTOBATCH && link_empty(&prop_input_queue.data)) {
+        ep->delay = batch_wait_time();
+        if (ep->delay > 0.0) TASK_DELAY(ep->delay);
+      }
       while (AUTOBATCH && ep->size <= MAX_BATCH_SIZE &&
              ep->nr_batched_app_data <= MAX_BATCH_APP_DATA &&
              !link_empty(&prop_input_queue
@@ -33,6 +33,7 @@
 #include "plugin/x/protocol/encoders/encoding_xrow.h"
 #include "plugin/x/src/admin_cmd_arguments.h"
 #include "plugin/x/src/admin_cmd_index.h"
+#include "plugin/x/src/continuous_query_subscriptions.h"
 #include "plugin/x/src/helper/get_system_variable.h"
 #include "plugin/x/src/helper/sql_commands.h"
 #include "plugin/x/src/helper/string_case.h"
@@ -111,7 +112,13 @@ Admin_command_handler::Command_handler::Command_handler()
           {"list_objects", &Admin_command_handler::list_objects},
           {"enable_notices", &Admin_command_handler::enable_notices},
           {"disable_notices", &Admin_command_handler::disable_notices},
-          {"list_notices", &Admin_command_handler::list_notices}} {}
+          {"list_notices", &Admin_command_handler::list_notices},
+          {"continuous_query_subscribe",
+           &Admin_command_handler::continuous_query_subscribe},
+          {"continuous_query_acknowledge",
+           &Admin_command_handler::continuous_query_acknowledge},
+          {"continuous_query_unsubscribe",
+           &Admin_command_handler::continuous_query_unsubscribe}} {}
 
 ngs::Error_code Admin_command_handler::Command_handler::execute(
     Admin_command_handler *admin, const std::string &command,
@@ -520,6 +527,81 @@ ngs::Error_code Admin_command_handler::list_notices(Command_arguments *args) {
   return ngs::Success();
 }
 
+/* Stmt: continuous_query_subscribe
+ * Required arguments:
+ * - id: bigint - the id of the continuous query, as returned by SYNC
+ * - position: bigint, optional - the last output received, to resume
+ *   after; only the next outputs are sent if not given
+ * - window: bigint, optional - most outputs sent past the last one
+ *   acknowledged; default 64
+ */
+ngs::Error_code Admin_command_handler::continuous_query_subscribe(
+    Command_arguments *args) {
+  DBUG_TRACE;
+  uint64_t id = 0;
+  uint64_t position = Continuous_query_subscriptions::k_next;
+  uint64_t window = 64;
+
+  ngs::Error_code error =
+      args->uint_arg({"id"}, &id, Argument_appearance::k_obligatory)
+          .uint_arg({"position"}, &position, Argument_appearance::k_optional)
+          .uint_arg({"window"}, &window, Argument_appearance::k_optional)
+          .end();
+  if (error) return error;
+
+  error = m_session->get_continuous_query_subscriptions().subscribe(
+      id, position, window);
+  if (error) return error;
+
+  m_session->proto().send_exec_ok();
+  return ngs::Success();
+}
+
+/* Stmt: continuous_query_acknowledge
+ * Required arguments:
+ * - id: bigint - the id of the subscribed continuous query
+ * - position: bigint - the last output processed
+ */
+ngs::Error_code Admin_command_handler::continuous_query_acknowledge(
+    Command_arguments *args) {
+  DBUG_TRACE;
+  uint64_t id = 0;
+  uint64_t position = 0;
+
+  ngs::Error_code error =
+      args->uint_arg({"id"}, &id, Argument_appearance::k_obligatory)
+          .uint_arg({"position"}, &position, Argument_appearance::k_obligatory)
+          .end();
+  if (error) return error;
+
+  error = m_session->get_continuous_query_subscriptions().acknowledge(
+      id, position);
+  if (error) return error;
+
+  m_session->proto().send_exec_ok();
+  return ngs::Success();
+}
+
+/* Stmt: continuous_query_unsubscribe
+ * Required arguments:
+ * - id: bigint - the id of the subscribed continuous query
+ */
+ngs::Error_code Admin_command_handler::continuous_query_unsubscribe(
+    Command_arguments *args) {
+  DBUG_TRACE;
+  uint64_t id = 0;
+
+  ngs::Error_code error =
+      args->uint_arg({"id"}, &id, Argument_appearance::k_obligatory).end();
+  if (error) return error;
+
+  error = m_session->get_continuous_query_subscriptions().unsubscribe(id);
+  if (error) return error;
+
+  m_session->proto().send_exec_ok();
+  return ngs::Success();
+}
+
 namespace {
 ngs::Error_code is_schema_selected_and_exists(iface::Sql_session *da,
                                               const std::string &schema) {
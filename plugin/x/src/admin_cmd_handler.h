@@ -237,6 +237,10 @@ class Admin_command_handler {
   ngs::Error_code disable_notices(Command_arguments *args);
   ngs::Error_code list_notices(Command_arguments *args);
 
+  ngs::Error_code continuous_query_subscribe(Command_arguments *args);
+  ngs::Error_code continuous_query_acknowledge(Command_arguments *args);
+  ngs::Error_code continuous_query_unsubscribe(Command_arguments *args);
+
   using Method_ptr =
       ngs::Error_code (Admin_command_handler::*)(Command_arguments *args);
   static const struct Command_handler
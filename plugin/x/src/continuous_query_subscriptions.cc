@@ -0,0 +1,181 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "plugin/x/src/continuous_query_subscriptions.h"
+
+#include <cinttypes>
+#include <string>
+
+#include "sql/continuous_query.h"
+
+#include "plugin/x/src/helper/multithread/mutex.h"
+#include "plugin/x/src/interface/notice_output_queue.h"
+#include "plugin/x/src/interface/session.h"
+#include "plugin/x/src/ngs/notice_descriptor.h"
+#include "plugin/x/src/notices.h"
+#include "plugin/x/src/xpl_error.h"
+#include "plugin/x/src/xpl_performance_schema.h"
+
+namespace xpl {
+
+/**
+  A subscription, told of the outputs of its query by the workers running
+  continuous queries, which it queues on the session.
+*/
+class Continuous_query_subscriptions::Subscription
+    : public Continuous_query_listener {
+ public:
+  Subscription(iface::Notice_output_queue *queue, const uint64_t position,
+               const uint64_t window)
+      : m_queue(queue),
+        m_started(position != k_next),
+        m_sent(m_started ? position : 0),
+        m_acknowledged(m_sent),
+        m_window(window) {}
+
+  void output(ulonglong id, ulonglong position, const std::string &text,
+              bool replayed) override {
+    MUTEX_LOCK(lock, m_mutex);
+    if (!m_started) {
+      m_started = true;
+      m_sent = m_acknowledged = position - 1;
+    }
+    if (position <= m_sent) return;
+    // the next outputs wait for the skipped ones to be told again
+    if (m_skipped && !replayed) return;
+    if (position > m_acknowledged + m_window) {
+      m_skipped = true;
+      return;
+    }
+    if (position > m_sent + 1)
+      queue(notices::serialize_continuous_query_event(id, position, "lost"));
+    queue(notices::serialize_continuous_query_output(id, position, text));
+    m_sent = position;
+    m_skipped = false;
+  }
+
+  void stopped(ulonglong id) override {
+    MUTEX_LOCK(lock, m_mutex);
+    m_stopped = true;
+    queue(notices::serialize_continuous_query_event(id, m_sent, "stopped"));
+  }
+
+  /**
+    Acknowledge the outputs up to a position.
+    @param[out] replay_after the last output sent, if outputs were skipped
+      and are to be told again; k_next otherwise
+    @return false if the position was not sent
+  */
+  bool acknowledge(const uint64_t position, uint64_t *replay_after) {
+    MUTEX_LOCK(lock, m_mutex);
+    if (position > m_sent) return false;
+    if (position > m_acknowledged) m_acknowledged = position;
+    *replay_after = m_skipped && !m_stopped ? m_sent : k_next;
+    return true;
+  }
+
+ private:
+  void queue(const std::string &payload) {
+    m_queue->emplace(std::make_shared<ngs::Notice_descriptor>(
+        ngs::Notice_type::k_continuous_query, payload));
+  }
+
+  iface::Notice_output_queue *m_queue;
+  Mutex m_mutex{KEY_mutex_x_continuous_query_subscription};
+  // Whether an output was told, or a position to resume from was given.
+  bool m_started;
+  uint64_t m_sent;
+  uint64_t m_acknowledged;
+  const uint64_t m_window;
+  // Outputs were skipped, as the window was full.
+  bool m_skipped{false};
+  bool m_stopped{false};
+};
+
+Continuous_query_subscriptions::Continuous_query_subscriptions(
+    iface::Session *session)
+    : m_session(session) {}
+
+Continuous_query_subscriptions::~Continuous_query_subscriptions() { reset(); }
+
+ngs::Error_code Continuous_query_subscriptions::subscribe(
+    const uint64_t id, const uint64_t position, const uint64_t window) {
+  if (window == 0)
+    return ngs::Error(ER_X_CMD_ARGUMENT_VALUE,
+                      "Invalid value for argument 'window'");
+
+  unsubscribe(id);
+  auto subscription = std::make_unique<Subscription>(
+      &m_session->get_notice_output_queue(), position, window);
+  m_session->get_notice_configuration().set_notice(
+      ngs::Notice_type::k_continuous_query, true);
+
+  const auto &sql = m_session->data_context();
+  if (continuous_query_listen(sql.get_authenticated_user_name(),
+                              sql.get_authenticated_user_host(),
+                              sql.has_authenticated_user_a_super_priv(), id,
+                              position, subscription.get()))
+    return ngs::Error(ER_X_CMD_ARGUMENT_VALUE,
+                      "Unknown continuous query %" PRIu64, id);
+
+  m_subscriptions.emplace(id, std::move(subscription));
+  return ngs::Success();
+}
+
+ngs::Error_code Continuous_query_subscriptions::acknowledge(
+    const uint64_t id, const uint64_t position) {
+  const auto subscription = m_subscriptions.find(id);
+  if (m_subscriptions.end() == subscription)
+    return ngs::Error(ER_X_CMD_ARGUMENT_VALUE,
+                      "Not subscribed to continuous query %" PRIu64, id);
+
+  uint64_t replay_after = k_next;
+  if (!subscription->second->acknowledge(position, &replay_after))
+    return ngs::Error(ER_X_CMD_ARGUMENT_VALUE,
+                      "Position %" PRIu64
+                      " of continuous query %" PRIu64 " was not sent",
+                      position, id);
+
+  // The query may have stopped meanwhile, then it told the subscription.
+  if (replay_after != k_next) {
+    const auto &sql = m_session->data_context();
+    continuous_query_listen(sql.get_authenticated_user_name(),
+                            sql.get_authenticated_user_host(),
+                            sql.has_authenticated_user_a_super_priv(), id,
+                            replay_after, subscription->second.get());
+  }
+  return ngs::Success();
+}
+
+ngs::Error_code Continuous_query_subscriptions::unsubscribe(
+    const uint64_t id) {
+  const auto subscription = m_subscriptions.find(id);
+  if (m_subscriptions.end() == subscription)
+    return ngs::Error(ER_X_CMD_ARGUMENT_VALUE,
+                      "Not subscribed to continuous query %" PRIu64, id);
+
+  continuous_query_unlisten(id, subscription->second.get());
+  m_subscriptions.erase(subscription);
+  return ngs::Success();
+}
+
+void Continuous_query_subscriptions::reset() {
+  for (const auto &subscription : m_subscriptions)
+    continuous_query_unlisten(subscription.first, subscription.second.get());
+  m_subscriptions.clear();
+}
+
+}  // namespace xpl
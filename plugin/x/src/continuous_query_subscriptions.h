@@ -0,0 +1,76 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#ifndef PLUGIN_X_SRC_CONTINUOUS_QUERY_SUBSCRIPTIONS_H_
+#define PLUGIN_X_SRC_CONTINUOUS_QUERY_SUBSCRIPTIONS_H_
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+
+#include "plugin/x/src/ngs/error_code.h"
+
+namespace xpl {
+
+namespace iface {
+class Session;
+}  // namespace iface
+
+/**
+  Subscriptions of a session to continuous queries
+
+  Rather than polling the result of a continuous query, a client subscribes
+  to it, and its outputs, the rows its runs changed and its results, or the
+  rows entering and leaving it, are pushed to the session as
+  "continuous_query" notices, see notices::serialize_continuous_query_output.
+  Subscribing enables the notice.
+
+  The outputs of a query are numbered. A client resumes a subscription, e.g.
+  on another session, from the last position it received, as long as the
+  server still keeps the outputs after it, see continuous_query_history.
+
+  At most a window of outputs is sent past the last position the client
+  acknowledged: the next ones are skipped until it acknowledges more, and
+  then sent from the kept ones. A "lost" event tells the client of outputs
+  it will not receive, as they are no longer kept.
+*/
+class Continuous_query_subscriptions {
+ public:
+  /// Position to subscribe at to receive only the next outputs.
+  static constexpr uint64_t k_next = std::numeric_limits<uint64_t>::max();
+
+  explicit Continuous_query_subscriptions(iface::Session *session);
+  ~Continuous_query_subscriptions();
+
+  ngs::Error_code subscribe(const uint64_t id, const uint64_t position,
+                            const uint64_t window);
+  ngs::Error_code acknowledge(const uint64_t id, const uint64_t position);
+  ngs::Error_code unsubscribe(const uint64_t id);
+
+  /// Drop all subscriptions, e.g. on session reset.
+  void reset();
+
+ private:
+  class Subscription;
+
+  iface::Session *m_session;
+  std::map<uint64_t, std::unique_ptr<Subscription>> m_subscriptions;
+};
+
+}  // namespace xpl
+
+#endif  // PLUGIN_X_SRC_CONTINUOUS_QUERY_SUBSCRIPTIONS_H_
@@ -23,6 +23,7 @@
  */
 
 #include <string>
+#include <vector>
 
 #include "plugin/x/src/crud_cmd_handler.h"
 
@@ -36,6 +37,7 @@
 #include "plugin/x/src/interface/server.h"
 #include "plugin/x/src/ngs/protocol/protocol_protobuf.h"
 #include "plugin/x/src/notices.h"
+#include "plugin/x/src/prepared_statement_builder.h"
 #include "plugin/x/src/session.h"
 #include "plugin/x/src/sql_data_result.h"
 #include "plugin/x/src/update_statement_builder.h"
@@ -91,6 +93,103 @@ inline bool check_message(const std::string &msg, const char *pattern,
                           std::string::size_type *pos) {
   return (*pos = msg.find(pattern)) != std::string::npos;
 }
+
+// each prepared insert holds a statement of the session
+const std::size_t k_max_prepared_inserts = 16;
+// larger inserts are rare enough to be executed as SQL
+const int k_max_prepared_insert_values = 4096;
+
+using Scalar = Mysqlx::Datatypes::Scalar;
+using Scalar_list = std::vector<const Scalar *>;
+
+// literals bound as a parameter to the same value as they are put in SQL
+bool is_bindable(const Scalar &arg, const bool is_relational) {
+  switch (arg.type()) {
+    case Scalar::V_STRING:
+      return !arg.v_string().has_collation();
+
+    case Scalar::V_OCTETS:
+      switch (arg.v_octets().content_type()) {
+        case Expression_generator::CT_PLAIN:
+          return true;
+        case Expression_generator::CT_JSON:
+          return !is_relational;
+        case Expression_generator::CT_FB_VECTOR:
+          return is_relational;
+      }
+      return false;
+
+    case Scalar::V_SINT:
+    case Scalar::V_UINT:
+    case Scalar::V_DOUBLE:
+    case Scalar::V_FLOAT:
+    case Scalar::V_BOOL:
+    case Scalar::V_NULL:
+      return is_relational;
+
+    default:
+      return false;
+  }
+}
+
+// the literals of the rows of an insert, false if a field is an expression
+bool get_literals(const Mysqlx::Crud::Insert &msg, Scalar_list *literals) {
+  const auto is_relational = is_table_data_model(msg);
+  const int fields = msg.row_size() > 0 ? msg.row(0).field_size() : 0;
+  if (fields == 0 || msg.row_size() * fields > k_max_prepared_insert_values)
+    return false;
+
+  literals->reserve(msg.row_size() * fields);
+  for (const auto &row : msg.row()) {
+    if (row.field_size() != fields) return false;
+    for (const auto &field : row.field()) {
+      const Scalar *literal = nullptr;
+      if (field.type() == Mysqlx::Expr::Expr::LITERAL)
+        literal = &field.literal();
+      else if (field.type() == Mysqlx::Expr::Expr::PLACEHOLDER &&
+               field.position() < static_cast<uint32_t>(msg.args_size()))
+        literal = &msg.args(field.position());
+      if (literal == nullptr || !is_bindable(*literal, is_relational))
+        return false;
+      literals->push_back(literal);
+    }
+  }
+  return true;
+}
+
+// inserts of the same shape share a prepared statement
+std::string get_insert_shape(const Mysqlx::Crud::Insert &msg) {
+  std::string shape = msg.collection().schema();
+  shape.append(1, '\0').append(msg.collection().name()).append(1, '\0');
+  for (const auto &column : msg.projection())
+    shape.append(column.name()).append(1, '\0');
+  shape.append(is_table_data_model(msg) ? "T" : "D")
+      .append(msg.upsert() ? "U" : "I")
+      .append(std::to_string(msg.row_size()))
+      .append(1, 'x')
+      .append(std::to_string(msg.row(0).field_size()));
+  return shape;
+}
+
+// the insert of a shape with a placeholder for each field
+Mysqlx::Crud::Insert make_insert_template(const Mysqlx::Crud::Insert &msg) {
+  Mysqlx::Crud::Insert insert;
+  *insert.mutable_collection() = msg.collection();
+  insert.set_data_model(msg.data_model());
+  *insert.mutable_projection() = msg.projection();
+  insert.set_upsert(msg.upsert());
+
+  uint32_t position = 0;
+  for (const auto &row : msg.row()) {
+    auto *template_row = insert.add_row();
+    for (int i = 0; i < row.field_size(); ++i) {
+      auto *field = template_row->add_field();
+      field->set_type(Mysqlx::Expr::Expr::PLACEHOLDER);
+      field->set_position(position++);
+    }
+  }
+  return insert;
+}
 }  // namespace
 
 // -- Insert
@@ -101,6 +200,10 @@ ngs::Error_code Crud_command_handler::execute_crud_insert(
   ngs::Error_code error = id_agg.configue(&m_session->data_context());
   if (error) return error;
 
+  bool executed = false;
+  error = execute_prepared_insert(msg, &executed);
+  if (executed) return error;
+
   const auto is_relational = is_table_data_model(msg);
   Expression_generator gen(&m_qb, msg.args(), msg.collection().schema(),
                            is_relational);
@@ -140,8 +243,14 @@ ngs::Error_code Crud_command_handler::error_handling(
 
 template <>
 void Crud_command_handler::notice_handling(
-    const iface::Resultset::Info &info, const Insert_statement_builder &builder,
+    const iface::Resultset::Info &info,
+    const Insert_statement_builder & /*builder*/,
     const Mysqlx::Crud::Insert &msg) const {
+  notice_handling_insert(info, msg);
+}
+
+void Crud_command_handler::notice_handling_insert(
+    const iface::Resultset::Info &info, const Mysqlx::Crud::Insert &msg) const {
   notice_handling_common(info);
   m_session->proto().send_notice_rows_affected(info.affected_rows);
   if (is_table_data_model(msg)) {
@@ -153,6 +262,62 @@ void Crud_command_handler::notice_handling(
   }
 }
 
+ngs::Error_code Crud_command_handler::execute_prepared_insert(
+    const Mysqlx::Crud::Insert &msg, bool *executed) {
+  *executed = false;
+
+  Scalar_list literals;
+  if (!get_literals(msg, &literals)) return ngs::Success();
+
+  const auto shape = get_insert_shape(msg);
+  auto prepared = m_prepared_inserts.find(shape);
+  if (prepared == m_prepared_inserts.end()) {
+    Prepare_param_handler::Placeholder_list placeholders;
+    Prepared_statement_builder builder(&m_qb, &placeholders);
+    // errors are left for the insert as SQL to report
+    if (builder.build(make_insert_template(msg))) return ngs::Success();
+
+    log_debug("CRUD prepared insert: %s", m_qb.get().c_str());
+    Prepare_resultset prepare_rset;
+    if (m_session->data_context().prepare_prep_stmt(
+            m_qb.get().data(), m_qb.get().length(), &prepare_rset))
+      return ngs::Success();
+
+    if (m_prepared_inserts.size() >= k_max_prepared_inserts) {
+      Empty_resultset rset;
+      m_session->data_context().deallocate_prep_stmt(
+          m_prepared_inserts.begin()->second.m_server_stmt_id, &rset);
+      m_prepared_inserts.erase(m_prepared_inserts.begin());
+    }
+    prepared = m_prepared_inserts
+                   .emplace(shape, Prepared_insert{prepare_rset.get_stmt_id(),
+                                                   std::move(placeholders)})
+                   .first;
+  }
+
+  Prepare_param_handler::Arg_list args;
+  for (const auto *literal : literals) {
+    auto *arg = args.Add();
+    arg->set_type(Mysqlx::Datatypes::Any::SCALAR);
+    *arg->mutable_scalar() = *literal;
+  }
+  Prepare_param_handler param_handler(prepared->second.m_placeholders);
+  ngs::Error_code error = param_handler.prepare_parameters(args);
+  if (error) return ngs::Success();
+
+  *executed = true;
+  m_session->update_status(&ngs::Common_status_variables::m_crud_insert);
+  Empty_resultset rset;
+  error = m_session->data_context().execute_prep_stmt(
+      prepared->second.m_server_stmt_id, false,
+      param_handler.get_params().data(), param_handler.get_params().size(),
+      &rset);
+  if (error) return error_handling(error, msg);
+  notice_handling_insert(rset.get_info(), msg);
+  m_session->proto().send_exec_ok();
+  return ngs::Success();
+}
+
 // -- Update
 ngs::Error_code Crud_command_handler::execute_crud_update(
     const Mysqlx::Crud::Update &msg) {
@@ -25,11 +25,16 @@
 #ifndef PLUGIN_X_SRC_CRUD_CMD_HANDLER_H_
 #define PLUGIN_X_SRC_CRUD_CMD_HANDLER_H_
 
+#include <cstdint>
+#include <map>
+#include <string>
+
 #include "plugin/x/src/interface/resultset.h"
 #include "plugin/x/src/interface/sql_session.h"
 #include "plugin/x/src/ngs/error_code.h"
 #include "plugin/x/src/ngs/protocol_fwd.h"
 #include "plugin/x/src/ngs/session_status_variables.h"
+#include "plugin/x/src/prepare_param_handler.h"
 #include "plugin/x/src/query_string_builder.h"
 #include "plugin/x/src/sql_data_context.h"
 
@@ -49,6 +54,10 @@ class Crud_command_handler {
   ngs::Error_code execute_modify_view(const Mysqlx::Crud::ModifyView &msg);
   ngs::Error_code execute_drop_view(const Mysqlx::Crud::DropView &msg);
 
+  /// Forget the statements prepared for inserts, which a reset of the
+  /// session deallocated.
+  void reset() { m_prepared_inserts.clear(); }
+
  private:
   using Status_variable =
       ngs::Common_status_variables::Variable ngs::Common_status_variables::*;
@@ -69,9 +78,28 @@ class Crud_command_handler {
                        const M &msg) const;
 
   void notice_handling_common(const iface::Resultset::Info &info) const;
+  void notice_handling_insert(const iface::Resultset::Info &info,
+                              const Mysqlx::Crud::Insert &msg) const;
+
+  /**
+    Execute an insert of literal values through a statement prepared for
+    inserts of its shape, to parse it once for all such inserts.
+
+    @param msg the insert
+    @param[out] executed false if the insert is to be executed as SQL
+  */
+  ngs::Error_code execute_prepared_insert(const Mysqlx::Crud::Insert &msg,
+                                          bool *executed);
+
+  struct Prepared_insert {
+    uint32_t m_server_stmt_id;
+    Prepare_param_handler::Placeholder_list m_placeholders;
+  };
 
   iface::Session *m_session;
   Query_string_builder m_qb;
+  /// Statements prepared for inserts, by the shape of the insert.
+  std::map<std::string, Prepared_insert> m_prepared_inserts;
 };
 
 }  // namespace xpl
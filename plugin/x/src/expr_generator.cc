@@ -285,6 +285,10 @@ void Expression_generator::generate(
       m_qb->quote_string(arg.value());
       break;
 
+    case CT_FB_VECTOR:
+      m_qb->put("_binary").quote_string(arg.value());
+      break;
+
     default:
       throw Error(
           ER_X_EXPR_BAD_TYPE_VALUE,
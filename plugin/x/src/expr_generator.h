@@ -57,7 +57,9 @@ class Expression_generator {
     CT_PLAIN = 0x0000,  //   default value; general use of octets
     CT_GEOMETRY = Mysqlx::Resultset::GEOMETRY,
     CT_JSON = Mysqlx::Resultset::JSON,
-    CT_XML = Mysqlx::Resultset::XML
+    CT_XML = Mysqlx::Resultset::XML,
+    // array of float32 in the byte order of the server, bound as binary
+    CT_FB_VECTOR = 0x0100
   };
 
   Expression_generator(Query_string_builder *qb, const Arg_list &args,
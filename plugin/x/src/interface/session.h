@@ -37,6 +37,9 @@
 #include "plugin/x/src/ngs/session_status_variables.h"
 
 namespace xpl {
+
+class Continuous_query_subscriptions;
+
 namespace iface {
 
 class Client;
@@ -100,6 +103,8 @@ class Session {
   virtual void update_status(Common_status_variable variable) = 0;
 
   virtual Document_id_aggregator &get_document_id_aggregator() = 0;
+  virtual Continuous_query_subscriptions &
+  get_continuous_query_subscriptions() = 0;
 };
 
 inline Session::Close_flags operator|(const Session::Close_flags a,
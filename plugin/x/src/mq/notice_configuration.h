@@ -103,6 +103,7 @@ class Notice_configuration : public iface::Notice_configuration {
          Notice_type::k_group_replication_member_role_changed},
         {"group_replication/status/state_change",
          Notice_type::k_group_replication_member_state_changed},
+        {"continuous_query", Notice_type::k_continuous_query},
     };
 
     return notice_name_to_type;
@@ -81,6 +81,8 @@ inline iface::Frame_type get_notice_frame_type(const Notice_type notice_type) {
     case Notice_type::k_group_replication_member_role_changed:
     case Notice_type::k_group_replication_member_state_changed:
       return iface::Frame_type::k_group_replication_state_changed;
+    case Notice_type::k_continuous_query:
+      return iface::Frame_type::k_session_state_changed;
     default: {
       assert(false && "unsupported ngs::Notice_type");
     }
@@ -44,12 +44,13 @@ bool Notice_descriptor::is_dispatchable(const Notice_type notice_type) {
     and placed inside per session queue, which later on will be delivered
     the client.
   */
-  static const std::array<Notice_type, 5> k_dispatchables{{
+  static const std::array<Notice_type, 6> k_dispatchables{{
       Notice_type::k_group_replication_quorum_loss,
       Notice_type::k_group_replication_view_changed,
       Notice_type::k_group_replication_member_role_changed,
       Notice_type::k_group_replication_member_state_changed,
       Notice_type::k_warning,
+      Notice_type::k_continuous_query,
   }};
 
   return std::any_of(
@@ -44,6 +44,7 @@ enum class Notice_type {
   k_group_replication_view_changed,
   k_group_replication_member_role_changed,
   k_group_replication_member_state_changed,
+  k_continuous_query,
   k_last_element
 };
 
@@ -104,8 +104,44 @@ class Warning_resultset : public Process_resultset {
   uint32_t m_num_errors{0u};
 };
 
+Mysqlx::Notice::SessionStateChanged continuous_query_change(
+    const uint64_t id, const uint64_t position) {
+  Mysqlx::Notice::SessionStateChanged change;
+  change.set_param(Mysqlx::Notice::SessionStateChanged::PRODUCED_MESSAGE);
+  for (const auto value : {id, position}) {
+    Mysqlx::Datatypes::Scalar *v = change.mutable_value()->Add();
+    v->set_type(Mysqlx::Datatypes::Scalar::V_UINT);
+    v->set_v_unsigned_int(value);
+  }
+  return change;
+}
+
 }  // namespace
 
+std::string serialize_continuous_query_output(const uint64_t id,
+                                              const uint64_t position,
+                                              const std::string &text) {
+  auto change = continuous_query_change(id, position);
+  Mysqlx::Datatypes::Scalar *v = change.mutable_value()->Add();
+  v->set_type(Mysqlx::Datatypes::Scalar::V_OCTETS);
+  v->mutable_v_octets()->set_value(text);
+  std::string data;
+  change.SerializeToString(&data);
+  return data;
+}
+
+std::string serialize_continuous_query_event(const uint64_t id,
+                                             const uint64_t position,
+                                             const std::string &event) {
+  auto change = continuous_query_change(id, position);
+  Mysqlx::Datatypes::Scalar *v = change.mutable_value()->Add();
+  v->set_type(Mysqlx::Datatypes::Scalar::V_STRING);
+  v->mutable_v_string()->set_value(event);
+  std::string data;
+  change.SerializeToString(&data);
+  return data;
+}
+
 ngs::Error_code send_warnings(iface::Sql_session *da,
                               iface::Protocol_encoder *proto,
                               bool skip_single_error) {
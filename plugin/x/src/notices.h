@@ -42,6 +42,26 @@ std::string serialize_warning(const iface::Warning_level level,
 ngs::Error_code send_warnings(iface::Sql_session *da,
                               iface::Protocol_encoder *proto,
                               bool skip_single_error = false);
+
+/**
+  Serialize an output of a continuous query as a SessionStateChanged
+  notice with the PRODUCED_MESSAGE parameter, and three values: the id of
+  the query, the position of the output, and the output as octets.
+*/
+std::string serialize_continuous_query_output(const uint64_t id,
+                                              const uint64_t position,
+                                              const std::string &text);
+
+/**
+  Serialize an event of a continuous query subscription, as an output but
+  with the name of the event as a string:
+
+  - "lost", the outputs before the position are no longer kept;
+  - "stopped", the query stopped after the position.
+*/
+std::string serialize_continuous_query_event(const uint64_t id,
+                                             const uint64_t position,
+                                             const std::string &event);
 }  //  namespace notices
 }  // namespace xpl
 
@@ -36,27 +36,6 @@
 namespace xpl {
 
 namespace {
-class Prepare_resultset : public Process_resultset {
- public:
-  Prepare_resultset() = default;
-  uint32_t get_stmt_id() const { return m_stmt_id; }
-
- protected:
-  Row *start_row() override {
-    m_row.clear();
-    return &m_row;
-  }
-
-  bool end_row(Row *row) override {
-    if (row->fields.empty()) return false;
-    m_stmt_id = row->fields[0]->value.v_long;
-    return true;
-  }
-
- private:
-  Row m_row;
-  uint32_t m_stmt_id{0};
-};
 
 inline bool is_table_model(const Prepare_command_handler::Prepare &msg) {
   switch (msg.stmt().type()) {
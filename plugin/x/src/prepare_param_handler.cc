@@ -28,6 +28,7 @@
 
 #include <string>
 
+#include "plugin/x/src/expr_generator.h"
 #include "plugin/x/src/ngs/mysqlx/getter_any.h"
 #include "plugin/x/src/xpl_error.h"
 
@@ -58,7 +59,16 @@ class Any_to_param_handler {
                          static_cast<unsigned long>(value.size()), nullptr,
                          0ul});  // NOLINT(runtime/int)
   }
-  void operator()(const std::string &value, const uint32_t) {
+  void operator()(const std::string &value, const uint32_t type) {
+    // vectors bind as BLOB, to reach the vector functions unparsed
+    if (type == Expression_generator::CT_FB_VECTOR) {
+      m_params->push_back(
+          {false, MYSQL_TYPE_BLOB, false,
+           reinterpret_cast<const unsigned char *>(value.data()),
+           static_cast<unsigned long>(value.size()), nullptr,
+           0ul});  // NOLINT(runtime/int)
+      return;
+    }
     operator()(value);
   }
   void operator()(const double value) {
@@ -107,6 +117,10 @@ class Any_to_json_param_handler : protected Any_to_param_handler {
     Any_to_param_handler::operator()(store_svalue("\"" + value + "\""));
   }
   void operator()(const std::string &value, const uint32_t type) {
+    if (type == Expression_generator::CT_FB_VECTOR) {
+      Any_to_param_handler::operator()(value, type);
+      return;
+    }
     Any_to_param_handler::operator()(
         store_svalue(type == Mysqlx::Resultset::JSON ? std::string(value)
                                                      : "\"" + value + "\""));
@@ -379,6 +379,7 @@ void Session::on_reset() {
     return;
   }
   m_dispatcher.reset();
+  m_continuous_query_subscriptions.reset();
   m_encoder->send_ok();
 }
 
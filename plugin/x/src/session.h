@@ -32,6 +32,7 @@
 #include <string>
 #include <vector>
 
+#include "plugin/x/src/continuous_query_subscriptions.h"
 #include "plugin/x/src/document_id_aggregator.h"
 #include "plugin/x/src/interface/authentication.h"
 #include "plugin/x/src/interface/notice_output_queue.h"
@@ -101,6 +102,11 @@ class Session : public iface::Session {
     return m_document_id_aggregator;
   }
 
+  Continuous_query_subscriptions &get_continuous_query_subscriptions()
+      override {
+    return m_continuous_query_subscriptions;
+  }
+
  protected:
   bool handle_auth_message(const ngs::Message_request &command);
   bool handle_ready_message(const ngs::Message_request &command);
@@ -138,6 +144,8 @@ class Session : public iface::Session {
   ngs::Session_status_variables m_status_variables;
   bool m_was_authenticated;
   Document_id_aggregator m_document_id_aggregator;
+  // Destroyed before the notice queue its subscriptions fill.
+  Continuous_query_subscriptions m_continuous_query_subscriptions{this};
 };
 }  // namespace xpl
 
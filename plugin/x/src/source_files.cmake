@@ -38,6 +38,7 @@ SET(XPL_SRC
   capabilities/handler_tls.cc
   challenge_response_verification.cc
   client.cc
+  continuous_query_subscriptions.cc
   crud_cmd_handler.cc
   custom_command_delegates.cc
   delete_statement_builder.cc
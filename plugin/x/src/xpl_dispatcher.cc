@@ -134,5 +134,6 @@ ngs::Error_code Dispatcher::on_expect_close() {
 
 void Dispatcher::reset() {
   m_prepare_handler = Prepare_command_handler{m_session};
+  m_crud_handler.reset();
 }
 }  // namespace xpl
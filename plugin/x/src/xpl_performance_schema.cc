@@ -54,6 +54,7 @@ PSI_mutex_key KEY_mutex_x_listener_unix_socket_sync;
 PSI_mutex_key KEY_mutex_x_broker_context_sync;
 PSI_mutex_key KEY_mutex_x_server_state_sync;
 PSI_mutex_key KEY_mutex_x_socket_acceptors_sync;
+PSI_mutex_key KEY_mutex_x_continuous_query_subscription;
 
 static PSI_mutex_info all_x_mutexes[] = {
     {&KEY_mutex_x_lock_list_access, "lock_list_access", 0, 0, PSI_DOCUMENT_ME},
@@ -84,6 +85,8 @@ static PSI_mutex_info all_x_mutexes[] = {
      PSI_DOCUMENT_ME},
     {&KEY_mutex_x_socket_acceptors_sync, "socket_acceptors_sync", 0, 0,
      PSI_DOCUMENT_ME},
+    {&KEY_mutex_x_continuous_query_subscription,
+     "continuous_query_subscription", 0, 0, PSI_DOCUMENT_ME},
 };
 
 PSI_cond_key KEY_cond_x_scheduler_dynamic_worker_pending;
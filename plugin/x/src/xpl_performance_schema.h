@@ -58,6 +58,7 @@ extern PSI_mutex_key KEY_mutex_x_listener_unix_socket_sync;
 extern PSI_mutex_key KEY_mutex_x_broker_context_sync;
 extern PSI_mutex_key KEY_mutex_x_server_state_sync;
 extern PSI_mutex_key KEY_mutex_x_socket_acceptors_sync;
+extern PSI_mutex_key KEY_mutex_x_continuous_query_subscription;
 
 extern PSI_cond_key KEY_cond_x_scheduler_dynamic_worker_pending;
 extern PSI_cond_key KEY_cond_x_scheduler_dynamic_thread_exit;
@@ -112,6 +112,15 @@ class CONNECTION_POOL_EXPORT PooledConnection {
 
   std::string endpoint() const { return endpoint_; }
 
+  /**
+   * the session which moved the connection to the pool, 0 if none.
+   *
+   * the session may take it back without restoring its state, as long as no
+   * other session used it meanwhile.
+   */
+  uint64_t session_id() const { return session_id_; }
+  void session_id(uint64_t id) { session_id_ = id; }
+
  private:
   /**
    * wait for idle timeout.
@@ -140,6 +149,8 @@ class CONNECTION_POOL_EXPORT PooledConnection {
   bool is_authenticated_{false};
 
   std::string endpoint_;
+
+  uint64_t session_id_{0};
 };
 
 class CONNECTION_POOL_EXPORT PooledClassicConnection : public PooledConnection {
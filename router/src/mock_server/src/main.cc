@@ -55,6 +55,12 @@ struct MysqlServerMockConfig {
   std::string port{"3306"};
   std::string http_port{};
   std::string xport{};
+  bool llm{false};
+  std::string llm_latency{"0"};
+  std::string llm_tokens_per_second{"0"};
+  std::string llm_requests_per_second{"0"};
+  std::string llm_true_ratio{"0.5"};
+  std::string llm_embedding_dimension{"1536"};
   bool verbose{false};
   std::string logging_folder;
 
@@ -143,7 +149,7 @@ class MysqlServerMockFrontend {
     mysql_harness::logging::create_module_loggers(
         registry, log_level,
         {mysql_harness::logging::kMainLogger, "mock_server", "http_server", "",
-         "rest_mock_server"},
+         "rest_mock_server", "rest_mock_llm"},
         mysql_harness::logging::kMainLogger);
     mysql_harness::logging::create_main_log_handler(
         registry, "mock_server", config_.logging_folder, true);
@@ -198,6 +204,16 @@ class MysqlServerMockFrontend {
       http_server_config.set("library", "http_server");
       http_server_config.set("port", config_.http_port);
       http_server_config.set("static_folder", "");
+
+      if (config_.llm) {
+        auto &llm_config = loader_config->add("rest_mock_llm", "");
+        llm_config.set("library", "rest_mock_llm");
+        llm_config.set("latency", config_.llm_latency);
+        llm_config.set("tokens_per_second", config_.llm_tokens_per_second);
+        llm_config.set("requests_per_second", config_.llm_requests_per_second);
+        llm_config.set("true_ratio", config_.llm_true_ratio);
+        llm_config.set("embedding_dimension", config_.llm_embedding_dimension);
+      }
     }
 
     auto &mock_server_config = loader_config->add("mock_server", "classic");
@@ -333,6 +349,47 @@ class MysqlServerMockFrontend {
         "TCP port to listen on for HTTP/REST connections.",
         CmdOptionValueReq::required, "int",
         [this](const std::string &port) { config_.http_port = port; });
+    arg_handler_.add_option(
+        CmdOption::OptionNames({"--llm"}),
+        "serve a mock of the OpenAI chat completions and embeddings API on "
+        "the --http-port, under /v1.",
+        CmdOptionValueReq::none, "", [this](const std::string &) {
+          config_.llm = true;
+        });
+    arg_handler_.add_option(
+        CmdOption::OptionNames({"--llm-latency"}),
+        "seconds the mock model takes to answer (default 0).",
+        CmdOptionValueReq::required, "seconds",
+        [this](const std::string &value) { config_.llm_latency = value; });
+    arg_handler_.add_option(
+        CmdOption::OptionNames({"--llm-tokens-per-second"}),
+        "tokens the mock model produces per second, 0 for no limit "
+        "(default 0).",
+        CmdOptionValueReq::required, "num",
+        [this](const std::string &value) {
+          config_.llm_tokens_per_second = value;
+        });
+    arg_handler_.add_option(
+        CmdOption::OptionNames({"--llm-requests-per-second"}),
+        "requests the mock model serves per second before answering 429, 0 "
+        "for no limit (default 0).",
+        CmdOptionValueReq::required, "num",
+        [this](const std::string &value) {
+          config_.llm_requests_per_second = value;
+        });
+    arg_handler_.add_option(
+        CmdOption::OptionNames({"--llm-true-ratio"}),
+        "share of the yes/no questions the mock model answers \"true\" "
+        "(default 0.5).",
+        CmdOptionValueReq::required, "ratio",
+        [this](const std::string &value) { config_.llm_true_ratio = value; });
+    arg_handler_.add_option(
+        CmdOption::OptionNames({"--llm-embedding-dimension"}),
+        "dimension of the embeddings of the mock model (default 1536).",
+        CmdOptionValueReq::required, "num",
+        [this](const std::string &value) {
+          config_.llm_embedding_dimension = value;
+        });
     arg_handler_.add_option(
         CmdOption::OptionNames({"--module-prefix"}),
         "path prefix for javascript modules (default current directory).",
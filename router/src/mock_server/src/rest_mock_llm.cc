@@ -0,0 +1,505 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+/**
+ * mock of an OpenAI compatible model server.
+ *
+ * Serves /v1/chat/completions and /v1/embeddings on the http_server, for the
+ * semantic operators of the server to be benchmarked without a real model:
+ * point semantic_local_url at it and use the 'local' backend.
+ *
+ * Answers are deterministic, derived from a hash of the prompt:
+ *
+ * - a yes/no question of SEMANTIC_FILTER*() or SEMANTIC_JOIN() is answered
+ *   "true" for a share true_ratio of the prompts
+ * - other prompts get a short answer naming the hash
+ * - an embedding is a unit vector drawn from a generator seeded with the
+ *   hash, so equal texts have equal embeddings
+ *
+ * Each response is delayed by latency, in seconds, plus its tokens at
+ * tokens_per_second, and requests beyond requests_per_second are refused
+ * with 429, like a rate limited api. GET /api/v1/mock_llm/stats counts the
+ * requests served.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef RAPIDJSON_NO_SIZETYPEDEFINE
+#include "my_rapidjson_size_t.h"
+#endif
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "mysql/harness/config_option.h"
+#include "mysql/harness/config_parser.h"
+#include "mysql/harness/logging/logging.h"
+#include "mysql/harness/plugin.h"
+#include "mysql/harness/plugin_config.h"
+
+#include "mysqlrouter/http_server_component.h"
+#include "scope_guard.h"
+
+IMPORT_LOG_FUNCTIONS()
+
+#ifdef _WIN32
+#ifdef GetObject
+#undef GetObject
+#endif
+#endif
+
+static constexpr const char kSectionName[]{"rest_mock_llm"};
+static constexpr const char kChatCompletionsUri[]{"^/v1/chat/completions$"};
+static constexpr const char kEmbeddingsUri[]{"^/v1/embeddings$"};
+static constexpr const char kStatsUri[]{"^/api/v1/mock_llm/stats/?$"};
+
+static constexpr std::array<const char *, 5> supported_options{
+    "latency", "tokens_per_second", "requests_per_second", "true_ratio",
+    "embedding_dimension"};
+
+using JsonDocument =
+    rapidjson::GenericDocument<rapidjson::UTF8<>, rapidjson::CrtAllocator>;
+using JsonValue =
+    rapidjson::GenericValue<rapidjson::UTF8<>, rapidjson::CrtAllocator>;
+
+#define GET_OPTION_CHECKED(option, section, name, value)                    \
+  static_assert(mysql_harness::str_in_collection(supported_options, name)); \
+  option = get_option(section, name, value);
+
+class RestMockLlmPluginConfig : public mysql_harness::BasePluginConfig {
+ public:
+  std::chrono::milliseconds latency;
+  double tokens_per_second;
+  double requests_per_second;
+  double true_ratio;
+  uint32_t embedding_dimension;
+
+  explicit RestMockLlmPluginConfig(const mysql_harness::ConfigSection *section)
+      : mysql_harness::BasePluginConfig(section) {
+    GET_OPTION_CHECKED(latency, section, "latency",
+                       mysql_harness::MilliSecondsOption{});
+    GET_OPTION_CHECKED(tokens_per_second, section, "tokens_per_second",
+                       mysql_harness::DoubleOption{});
+    GET_OPTION_CHECKED(requests_per_second, section, "requests_per_second",
+                       mysql_harness::DoubleOption{});
+    GET_OPTION_CHECKED(true_ratio, section, "true_ratio",
+                       mysql_harness::DoubleOption{0, 1});
+    GET_OPTION_CHECKED(embedding_dimension, section, "embedding_dimension",
+                       mysql_harness::IntOption<uint32_t>{1, 65536});
+  }
+
+  std::string get_default(const std::string &option) const override {
+    const std::map<std::string, std::string> defaults{
+        {"latency", "0"},
+        {"tokens_per_second", "0"},
+        {"requests_per_second", "0"},
+        {"true_ratio", "0.5"},
+        {"embedding_dimension", "1536"},
+    };
+
+    auto it = defaults.find(option);
+    if (it == defaults.end()) {
+      return std::string();
+    }
+    return it->second;
+  }
+
+  bool is_required(const std::string & /* option */) const override {
+    return false;
+  }
+};
+
+// set by init(), read by the request handlers.
+static std::chrono::milliseconds mock_latency{0};
+static double mock_tokens_per_second{0};
+static double mock_requests_per_second{0};
+static double mock_true_ratio{0.5};
+static uint32_t mock_embedding_dimension{1536};
+
+static std::atomic<uint64_t> chat_requests{0};
+static std::atomic<uint64_t> embedding_requests{0};
+static std::atomic<uint64_t> embedding_inputs{0};
+static std::atomic<uint64_t> rejected_requests{0};
+
+static uint64_t fnv1a(const std::string &s) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (const unsigned char c : s) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// words, as a stand-in for the tokens of a real tokenizer.
+static uint64_t count_tokens(const std::string &s) {
+  std::istringstream words(s);
+  uint64_t count = 0;
+  for (std::string word; words >> word;) ++count;
+  return count;
+}
+
+/**
+ * token bucket of requests_per_second, holding at most a second of requests.
+ *
+ * @returns false if the request is over the rate.
+ */
+static bool admit_request() {
+  if (mock_requests_per_second <= 0) return true;
+
+  static std::mutex mtx;
+  static double tokens = 0;
+  static auto last = std::chrono::steady_clock::now();
+
+  std::lock_guard<std::mutex> lk(mtx);
+  const auto now = std::chrono::steady_clock::now();
+  tokens = std::min(std::max(mock_requests_per_second, 1.0),
+                    tokens + mock_requests_per_second *
+                                 std::chrono::duration<double>(now - last)
+                                     .count());
+  last = now;
+  if (tokens < 1) return false;
+  tokens -= 1;
+  return true;
+}
+
+// wait as long as the model would take to produce the response.
+static void simulate_latency(uint64_t tokens) {
+  auto delay = std::chrono::duration<double>(mock_latency);
+  if (mock_tokens_per_second > 0) {
+    delay += std::chrono::duration<double>(tokens / mock_tokens_per_second);
+  }
+  if (delay.count() > 0) std::this_thread::sleep_for(delay);
+}
+
+static std::string answer(const std::string &prompt) {
+  const uint64_t hash = fnv1a(prompt);
+
+  if (prompt.find("\"true\" or \"false\"") != std::string::npos) {
+    return static_cast<double>(hash % 10000) < mock_true_ratio * 10000
+               ? "true"
+               : "false";
+  }
+
+  std::ostringstream oss;
+  oss << std::hex << (hash & 0xffffffff);
+  if (prompt.find("json format") != std::string::npos) {
+    return "{\"entity\": \"" + oss.str() + "\"}";
+  }
+  return "answer " + oss.str();
+}
+
+static void send_json(HttpRequest &req, const JsonDocument &doc) {
+  rapidjson::StringBuffer json_buf;
+  rapidjson::Writer<rapidjson::StringBuffer> json_writer(json_buf);
+  doc.Accept(json_writer);
+
+  auto chunk = req.get_output_buffer();
+  chunk.add(json_buf.GetString(), json_buf.GetSize());
+  req.get_output_headers().add("Content-Type", "application/json");
+  req.send_reply(HttpStatusCode::Ok, "Ok", chunk);
+}
+
+/**
+ * parse the body of a POST request.
+ *
+ * @returns false if a reply was sent already.
+ */
+static bool parse_post(HttpRequest &req, JsonDocument &doc) {
+  if (!(HttpMethod::Post & req.get_method())) {
+    req.get_output_headers().add("Allow", "POST");
+    req.send_reply(HttpStatusCode::MethodNotAllowed);
+    return false;
+  }
+
+  if (!admit_request()) {
+    ++rejected_requests;
+    req.get_output_headers().add("Retry-After", "1");
+    req.send_reply(HttpStatusCode::TooManyRequests);
+    return false;
+  }
+
+  auto body = req.get_input_buffer();
+  auto data = body.pop_front(body.length());
+  const std::string str_data(data.begin(), data.end());
+
+  doc.Parse(str_data.c_str());
+  if (doc.HasParseError() || !doc.IsObject()) {
+    req.send_reply(HttpStatusCode::BadRequest);
+    return false;
+  }
+  return true;
+}
+
+static void add_usage(JsonDocument &doc, uint64_t prompt_tokens,
+                      uint64_t completion_tokens) {
+  auto &allocator = doc.GetAllocator();
+  doc.AddMember("usage",
+                JsonValue(rapidjson::kObjectType)
+                    .AddMember("prompt_tokens", prompt_tokens, allocator)
+                    .AddMember("completion_tokens", completion_tokens,
+                               allocator)
+                    .AddMember("total_tokens",
+                               prompt_tokens + completion_tokens, allocator),
+                allocator);
+}
+
+class RestApiV1MockLlmChatCompletions : public BaseRequestHandler {
+ public:
+  // POST
+  //
+  void handle_request(HttpRequest &req) override {
+    JsonDocument request_doc;
+    if (!parse_post(req, request_doc)) return;
+
+    // the content of the last message is the prompt.
+    std::string prompt;
+    if (request_doc.HasMember("messages") &&
+        request_doc["messages"].IsArray()) {
+      for (const auto &message : request_doc["messages"].GetArray()) {
+        if (message.IsObject() && message.HasMember("content") &&
+            message["content"].IsString()) {
+          prompt = message["content"].GetString();
+        }
+      }
+    }
+    ++chat_requests;
+
+    const std::string content = answer(prompt);
+    const uint64_t prompt_tokens = count_tokens(prompt);
+    const uint64_t completion_tokens = count_tokens(content);
+    simulate_latency(completion_tokens);
+
+    JsonDocument doc;
+    auto &allocator = doc.GetAllocator();
+    doc.SetObject()
+        .AddMember("object", "chat.completion", allocator)
+        .AddMember("model",
+                   request_doc.HasMember("model") &&
+                           request_doc["model"].IsString()
+                       ? JsonValue(request_doc["model"].GetString(), allocator)
+                       : JsonValue("mock", allocator),
+                   allocator);
+
+    JsonValue choices(rapidjson::kArrayType);
+    choices.PushBack(
+        JsonValue(rapidjson::kObjectType)
+            .AddMember("index", 0, allocator)
+            .AddMember("message",
+                       JsonValue(rapidjson::kObjectType)
+                           .AddMember("role", "assistant", allocator)
+                           .AddMember("content",
+                                      JsonValue(content.c_str(),
+                                                content.size(), allocator),
+                                      allocator),
+                       allocator)
+            .AddMember("finish_reason", "stop", allocator),
+        allocator);
+    doc.AddMember("choices", choices, allocator);
+    add_usage(doc, prompt_tokens, completion_tokens);
+
+    send_json(req, doc);
+  }
+};
+
+class RestApiV1MockLlmEmbeddings : public BaseRequestHandler {
+ public:
+  // POST
+  //
+  void handle_request(HttpRequest &req) override {
+    JsonDocument request_doc;
+    if (!parse_post(req, request_doc)) return;
+
+    std::vector<std::string> inputs;
+    if (request_doc.HasMember("input")) {
+      const auto &input = request_doc["input"];
+      if (input.IsString()) {
+        inputs.emplace_back(input.GetString());
+      } else if (input.IsArray()) {
+        for (const auto &text : input.GetArray()) {
+          if (text.IsString()) inputs.emplace_back(text.GetString());
+        }
+      }
+    }
+
+    uint32_t dimension = mock_embedding_dimension;
+    if (request_doc.HasMember("dimensions") &&
+        request_doc["dimensions"].IsUint() &&
+        request_doc["dimensions"].GetUint() > 0) {
+      dimension = request_doc["dimensions"].GetUint();
+    }
+    ++embedding_requests;
+    embedding_inputs += inputs.size();
+
+    uint64_t prompt_tokens = 0;
+    for (const auto &text : inputs) prompt_tokens += count_tokens(text);
+    simulate_latency(0);
+
+    JsonDocument doc;
+    auto &allocator = doc.GetAllocator();
+    doc.SetObject().AddMember("object", "list", allocator);
+
+    JsonValue data(rapidjson::kArrayType);
+    std::vector<double> embedding(dimension);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      std::mt19937_64 gen(fnv1a(inputs[i]));
+      std::normal_distribution<double> dist;
+      double norm = 0;
+      for (auto &element : embedding) {
+        element = dist(gen);
+        norm += element * element;
+      }
+      norm = std::sqrt(norm);
+
+      JsonValue values(rapidjson::kArrayType);
+      values.Reserve(dimension, allocator);
+      for (const auto element : embedding) {
+        values.PushBack(norm > 0 ? element / norm : 0, allocator);
+      }
+      data.PushBack(JsonValue(rapidjson::kObjectType)
+                        .AddMember("object", "embedding", allocator)
+                        .AddMember("index", static_cast<uint64_t>(i),
+                                   allocator)
+                        .AddMember("embedding", values, allocator),
+                    allocator);
+    }
+    doc.AddMember("data", data, allocator);
+    add_usage(doc, prompt_tokens, 0);
+
+    send_json(req, doc);
+  }
+};
+
+class RestApiV1MockLlmStats : public BaseRequestHandler {
+ public:
+  // GET
+  //
+  void handle_request(HttpRequest &req) override {
+    if (!(HttpMethod::Get & req.get_method())) {
+      req.get_output_headers().add("Allow", "GET");
+      req.send_reply(HttpStatusCode::MethodNotAllowed);
+      return;
+    }
+
+    JsonDocument doc;
+    auto &allocator = doc.GetAllocator();
+    doc.SetObject()
+        .AddMember("chatCompletions", chat_requests.load(), allocator)
+        .AddMember("embeddings", embedding_requests.load(), allocator)
+        .AddMember("embeddingInputs", embedding_inputs.load(), allocator)
+        .AddMember("rejected", rejected_requests.load(), allocator);
+
+    send_json(req, doc);
+  }
+};
+
+static void init(mysql_harness::PluginFuncEnv *env) {
+  const mysql_harness::AppInfo *info = get_app_info(env);
+
+  if (nullptr == info->config) {
+    return;
+  }
+
+  try {
+    for (const mysql_harness::ConfigSection *section :
+         info->config->sections()) {
+      if (section->name != kSectionName) {
+        continue;
+      }
+
+      RestMockLlmPluginConfig config{section};
+
+      mock_latency = config.latency;
+      mock_tokens_per_second = config.tokens_per_second;
+      mock_requests_per_second = config.requests_per_second;
+      mock_true_ratio = config.true_ratio;
+      mock_embedding_dimension = config.embedding_dimension;
+    }
+  } catch (const std::invalid_argument &exc) {
+    set_error(env, mysql_harness::kConfigInvalidArgument, "%s", exc.what());
+  } catch (const std::exception &exc) {
+    set_error(env, mysql_harness::kRuntimeError, "%s", exc.what());
+  } catch (...) {
+    set_error(env, mysql_harness::kUndefinedError, "Unexpected exception");
+  }
+}
+
+static void run(mysql_harness::PluginFuncEnv *env) {
+  auto &srv = HttpServerComponent::get_instance();
+
+  srv.add_route(kChatCompletionsUri,
+                std::make_unique<RestApiV1MockLlmChatCompletions>());
+  Scope_guard chat_route_guard(
+      [&srv]() { srv.remove_route(kChatCompletionsUri); });
+
+  srv.add_route(kEmbeddingsUri, std::make_unique<RestApiV1MockLlmEmbeddings>());
+  Scope_guard embeddings_route_guard(
+      [&srv]() { srv.remove_route(kEmbeddingsUri); });
+
+  srv.add_route(kStatsUri, std::make_unique<RestApiV1MockLlmStats>());
+  Scope_guard stats_route_guard([&srv]() { srv.remove_route(kStatsUri); });
+
+  mysql_harness::on_service_ready(env);
+
+  // wait until we are stopped.
+  wait_for_stop(env, 0);
+}
+
+#if defined(_MSC_VER) && defined(rest_mock_llm_EXPORTS)
+/* We are building this library */
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+static const std::array<const char *, 2> plugin_requires = {
+    "logger",
+    "http_server",
+};
+
+extern "C" {
+mysql_harness::Plugin DLLEXPORT harness_plugin_rest_mock_llm = {
+    mysql_harness::PLUGIN_ABI_VERSION,       // abi-version
+    mysql_harness::ARCHITECTURE_DESCRIPTOR,  // arch
+    "REST_MOCK_LLM",                         // name
+    VERSION_NUMBER(0, 0, 1),
+    // requires
+    plugin_requires.size(),
+    plugin_requires.data(),
+    // conflicts
+    0,
+    nullptr,
+    init,     // init
+    nullptr,  // deinit
+    run,      // run
+    nullptr,  // stop
+    true,     // declares_readiness
+    supported_options.size(),
+    supported_options.data(),
+};
+}
@@ -28,7 +28,7 @@
 #include <array>
 #include <string_view>
 
-static constexpr std::array<const char *, 31> routing_supported_options{
+static constexpr std::array<const char *, 33> routing_supported_options{
     "protocol",
     "destinations",
     "bind_port",
@@ -62,6 +62,8 @@ static constexpr std::array<const char *, 31> routing_supported_options{
     "unreachable_destination_refresh_interval",
     "connection_sharing",
     "connection_sharing_delay",
+    "read_only_destinations",
+    "vector_destinations",
 };
 
 #endif /* MYSQLROUTER_ROUTING_SUPPORTED_ROUTING_INCLUDED */
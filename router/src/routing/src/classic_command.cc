@@ -140,13 +140,17 @@ void CommandProcessor::client_idle_timeout() {
     if (auto pool = pools.get(ConnectionPoolComponent::default_pool_name())) {
       auto ssl_mode = server_conn.ssl_mode();
 
-      auto is_full_res = pool->add_if_not_full(make_pooled_connection(
+      auto pooled_conn = make_pooled_connection(
           std::exchange(server_conn,
                         TlsSwitchableConnection{
                             nullptr,   // connection
                             nullptr,   // routing-connection
                             ssl_mode,  //
-                            std::make_unique<ClassicProtocolState>()})));
+                            std::make_unique<ClassicProtocolState>()}));
+      // the session may take it back as is.
+      pooled_conn.session_id(connection()->session_id());
+
+      auto is_full_res = pool->add_if_not_full(std::move(pooled_conn));
 
       if (is_full_res) {
         trace(Tracer::Event().stage("client::idle::pool_full"));
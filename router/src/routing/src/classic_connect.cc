@@ -217,6 +217,8 @@ ConnectProcessor::from_pool() {
   auto *socket_splicer = connection()->socket_splicer();
   auto client_protocol = connection()->client_protocol();
 
+  connection()->server_conn_state_kept(false);
+
   if (!client_protocol->client_greeting()) {
     // taking a connection from the pool requires that the client's greeting
     // must been received already.
@@ -238,19 +240,29 @@ ConnectProcessor::from_pool() {
         .reset(classic_protocol::capabilities::pos::compress)
         .reset(classic_protocol::capabilities::pos::compress_zstd);
 
-    auto pool_res = pool->pop_if(
-        [client_caps, ep = mysqlrouter::to_string(server_endpoint_),
-         requires_tls = connection()->requires_tls()](const auto &pooled_conn) {
-          auto pooled_caps = pooled_conn.shared_capabilities();
+    auto matches = [client_caps, ep = mysqlrouter::to_string(server_endpoint_),
+                    requires_tls = connection()->requires_tls()](
+                       const auto &pooled_conn) {
+      auto pooled_caps = pooled_conn.shared_capabilities();
 
-          pooled_caps.reset(classic_protocol::capabilities::pos::ssl)
-              .reset(classic_protocol::capabilities::pos::compress)
-              .reset(classic_protocol::capabilities::pos::compress_zstd);
+      pooled_caps.reset(classic_protocol::capabilities::pos::ssl)
+          .reset(classic_protocol::capabilities::pos::compress)
+          .reset(classic_protocol::capabilities::pos::compress_zstd);
+
+      return (pooled_conn.endpoint() == ep &&  //
+              client_caps == pooled_caps &&    //
+              (requires_tls == (bool)pooled_conn.ssl()));
+    };
 
-          return (pooled_conn.endpoint() == ep &&  //
-                  client_caps == pooled_caps &&    //
-                  (requires_tls == (bool)pooled_conn.ssl()));
+    // prefer the connection the session left in the pool, its session state
+    // needs no restore.
+    auto pool_res = pool->pop_if(
+        [&matches, session_id = connection()->session_id()](
+            const auto &pooled_conn) {
+          return pooled_conn.session_id() == session_id && matches(pooled_conn);
         });
+    const bool state_kept = pool_res.has_value();
+    if (!pool_res) pool_res = pool->pop_if(matches);
 
     if (pool_res) {
       // check if the socket is closed.
@@ -273,6 +285,8 @@ ConnectProcessor::from_pool() {
         (void)socket_splicer->server_conn().connection()->set_io_context(
             socket_splicer->client_conn().connection()->io_ctx());
 
+        connection()->server_conn_state_kept(state_kept);
+
         stage(Stage::Connected);
         return Result::Again;
       }
@@ -602,11 +616,15 @@ stdx::expected<Processor::Result, std::error_code> ConnectProcessor::error() {
     // don't retry as router may run into an infinite loop.
     ConnectionPoolComponent::get_instance().clear();
   } else if (ec == std::errc::no_such_file_or_directory &&
-             connection()->get_destination_id().empty()) {
+             connection()->get_destination_id().empty() &&
+             connection()->statement_destination() ==
+                 StatementDestination::Primary) {
     // if there are no destinations for a fresh connect, close the
     // acceptor-ports
     //
     // fresh-connect == "destiantion-id is empty"
+    //
+    // replicas of read/write splitting being down leaves the route up.
     trace(Tracer::Event().stage("connect::error::all_down"));
     // all backends are down.
     MySQLRoutingComponent::get_instance()
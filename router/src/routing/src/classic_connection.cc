@@ -24,6 +24,7 @@
 
 #include "classic_connection.h"
 
+#include <atomic>
 #include <chrono>
 #include <cinttypes>  // PRIu64
 #include <iostream>
@@ -39,6 +40,7 @@
 #include "mysql/harness/stdx/expected.h"
 #include "mysql/harness/tls_error.h"
 #include "mysqlrouter/classic_protocol_session_track.h"
+#include "mysqlrouter/connection_pool_component.h"
 #include "processor.h"
 #include "tracer.h"
 
@@ -550,6 +552,10 @@ MysqlRoutingClassicConnection::track_session_changes(
         } else {
           auto gtid = decode_value_res->second;
 
+          // replicas may have to catch up before the next reads.
+          last_gtid_ = gtid.gtid();
+          gtid_waited_ = false;
+
           std::ostringstream oss;
 
           oss << "<< "
@@ -771,6 +777,77 @@ bool MysqlRoutingClassicConnection::connection_sharing_allowed() const {
          !some_state_changed_;
 }
 
+uint64_t MysqlRoutingClassicConnection::next_session_id() {
+  static std::atomic<uint64_t> last_session_id{0};
+
+  return ++last_session_id;
+}
+
+static PooledClassicConnection make_pooled_connection(
+    TlsSwitchableConnection &&other) {
+  auto *classic_protocol_state =
+      dynamic_cast<ClassicProtocolState *>(other.protocol());
+  return {std::move(other.connection()),
+          other.channel()->release_ssl(),
+          classic_protocol_state->server_capabilities(),
+          classic_protocol_state->client_capabilities(),
+          classic_protocol_state->server_greeting(),
+          other.ssl_mode(),
+          classic_protocol_state->username(),
+          classic_protocol_state->schema(),
+          classic_protocol_state->sent_attributes()};
+}
+
+void MysqlRoutingClassicConnection::statement_destination(
+    StatementDestination dest) {
+  RouteDestination *route_destination = route_destination_;
+  switch (dest) {
+    case StatementDestination::Primary:
+      break;
+    case StatementDestination::ReadOnly:
+      route_destination = context_.read_only_destination();
+      break;
+    case StatementDestination::Vector:
+      route_destination = context_.vector_destination();
+      break;
+  }
+
+  if (route_destination == nullptr) {
+    dest = StatementDestination::Primary;
+    route_destination = route_destination_;
+  }
+
+  if (dest == statement_destination_ || route_destination == nullptr) return;
+
+  trace(Tracer::Event().stage("route::statement_destination"));
+
+  // move the connection to the pool, or close it if the pool is full.
+  auto &server_conn = socket_splicer()->server_conn();
+  auto ssl_mode = server_conn.ssl_mode();
+  auto conn = std::exchange(
+      server_conn,
+      TlsSwitchableConnection{nullptr,   // connection
+                              nullptr,   // routing-connection
+                              ssl_mode,  //
+                              std::make_unique<ClassicProtocolState>()});
+  if (conn.is_open()) {
+    auto &pools = ConnectionPoolComponent::get_instance();
+
+    if (auto pool = pools.get(ConnectionPoolComponent::default_pool_name())) {
+      auto pooled_conn = make_pooled_connection(std::move(conn));
+      pooled_conn.session_id(session_id_);
+
+      (void)pool->add_if_not_full(std::move(pooled_conn));
+    }
+  }
+
+  statement_destination_ = dest;
+  destinations_ = route_destination->destinations();
+  // any of the new destinations will do.
+  destination_id_.clear();
+  gtid_waited_ = last_gtid_.empty();
+}
+
 void MysqlRoutingClassicConnection::connection_sharing_allowed_reset() {
   trx_state_.reset();
   trx_characteristics_.reset();
@@ -42,6 +42,15 @@
 #include "sql_exec_context.h"
 #include "tracer.h"
 
+/**
+ * the destinations a statement is routed to with read/write splitting.
+ */
+enum class StatementDestination {
+  Primary,   // the destinations of the route
+  ReadOnly,  // read-only SELECTs
+  Vector,    // SELECTs calling vector or semantic functions
+};
+
 /**
  * protocol state of a classic protocol connection.
  */
@@ -464,10 +473,64 @@ class MysqlRoutingClassicConnection
   RouteDestination *destinations() { return route_destination_; }
   Destinations &current_destinations() { return destinations_; }
 
+  /**
+   * id of the client session, which tags the server connections it moves to
+   * the pool.
+   */
+  uint64_t session_id() const { return session_id_; }
+
+  /**
+   * if the server connection came back from the pool as the session left it.
+   *
+   * Its session state needs no restore.
+   */
+  bool server_conn_state_kept() const { return server_conn_state_kept_; }
+  void server_conn_state_kept(bool v) { server_conn_state_kept_ = v; }
+
+  StatementDestination statement_destination() const {
+    return statement_destination_;
+  }
+
+  /**
+   * route the next statements to other destinations.
+   *
+   * The connection to the server is moved to the pool, the next statement
+   * connects to the new destinations.
+   *
+   * Destinations that aren't configured fall back to the primary.
+   */
+  void statement_destination(StatementDestination dest);
+
+  /**
+   * the last GTID of the session, if the server connected to may not have
+   * applied it yet.
+   *
+   * Replicas commit in the order of the primary, waiting for the last GTID
+   * waits for the ones before too.
+   */
+  std::string gtid_to_wait_for() const {
+    return gtid_waited_ ? std::string{} : last_gtid_;
+  }
+
+  /**
+   * the server connected to applied the last GTID.
+   */
+  void gtid_waited() { gtid_waited_ = true; }
+
  private:
   RouteDestination *route_destination_;
   Destinations destinations_;
 
+  StatementDestination statement_destination_{StatementDestination::Primary};
+
+  static uint64_t next_session_id();
+
+  const uint64_t session_id_{next_session_id()};
+  bool server_conn_state_kept_{false};
+
+  std::string last_gtid_;
+  bool gtid_waited_{true};
+
   std::unique_ptr<ProtocolSplicerBase> socket_splicer_;
 
   std::string destination_id_;
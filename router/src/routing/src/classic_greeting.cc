@@ -41,6 +41,7 @@
 #include "classic_forwarder.h"
 #include "classic_frame.h"
 #include "classic_lazy_connect.h"
+#include "classic_splice_forwarder.h"
 #include "harness_assert.h"
 #include "hexify.h"
 #include "mysql/harness/logging/logging.h"
@@ -1687,6 +1688,8 @@ ServerFirstAuthenticator::process() {
       return tls_forward_init();
     case Stage::TlsForward:
       return tls_forward();
+    case Stage::TlsSplice:
+      return tls_splice();
     case Stage::TlsConnectInit:
       return tls_connect_init();
     case Stage::TlsConnect:
@@ -2093,6 +2096,25 @@ ServerFirstAuthenticator::tls_forward_init() {
     return Result::SendToServer;
   }
 
+  // nothing left to look at: let the kernel move the bytes.
+  if (SpliceForwarder::is_supported() &&
+      src_channel->recv_buffer().empty() &&
+      dst_channel->recv_buffer().empty() &&
+      src_channel->send_buffer().empty()) {
+    stage(Stage::TlsSplice);
+
+    connection()->push_processor(
+        std::make_unique<SpliceForwarder>(connection()));
+    return Result::Again;
+  }
+
+  stage(Stage::TlsForward);
+  return Result::RecvFromBoth;
+}
+
+stdx::expected<Processor::Result, std::error_code>
+ServerFirstAuthenticator::tls_splice() {
+  // splice() failed to start, forward in user-space.
   stage(Stage::TlsForward);
   return Result::RecvFromBoth;
 }
@@ -231,6 +231,7 @@ class ServerFirstAuthenticator : public Processor {
     ClientGreetingFull,
     TlsForwardInit,
     TlsForward,
+    TlsSplice,
     TlsConnectInit,
     TlsConnect,
     ClientGreetingAfterTls,
@@ -254,6 +255,7 @@ class ServerFirstAuthenticator : public Processor {
   stdx::expected<Result, std::error_code> client_greeting_full();
   stdx::expected<Result, std::error_code> tls_forward_init();
   stdx::expected<Result, std::error_code> tls_forward();
+  stdx::expected<Result, std::error_code> tls_splice();
   stdx::expected<Result, std::error_code> tls_connect_init();
   stdx::expected<Result, std::error_code> tls_connect();
   stdx::expected<Result, std::error_code> client_greeting_after_tls();
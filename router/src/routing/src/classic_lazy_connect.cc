@@ -89,6 +89,18 @@ stdx::expected<Processor::Result, std::error_code> LazyConnector::connected() {
     return Result::Again;
   }
 
+  /*
+   * if the connection is the one the session left in the pool, it is ready.
+   */
+  if (!in_handshake_ && connection()->server_conn_state_kept()) {
+    trace(Tracer::Event().stage("connect::state_kept"));
+
+    connection()->client_greeting_sent(true);
+
+    stage(Stage::Done);
+    return Result::Again;
+  }
+
   /*
    * if the connection is from the pool, we need a change user.
    */
@@ -25,6 +25,7 @@
 #include "classic_query.h"
 
 #include <charconv>
+#include <chrono>
 #include <limits>
 #include <memory>
 #include <system_error>
@@ -48,6 +49,10 @@
 
 #undef DEBUG_DUMP_TOKENS
 
+// seconds a replica may take to apply the writes of the session before a
+// read goes to the primary instead.
+static constexpr std::chrono::seconds kWaitForMyWritesTimeout{1};
+
 stdx::expected<Processor::Result, std::error_code> QueryForwarder::process() {
   switch (stage()) {
     case Stage::Command:
@@ -56,6 +61,8 @@ stdx::expected<Processor::Result, std::error_code> QueryForwarder::process() {
       return connect();
     case Stage::Connected:
       return connected();
+    case Stage::MyWritesWaited:
+      return my_writes_waited();
     case Stage::Response:
       return response();
     case Stage::ColumnCount:
@@ -341,6 +348,75 @@ static stdx::flags<StmtClassifier> classify(const std::string &stmt,
   return StmtClassifier::StateChangeOnTracker;
 }
 
+/*
+ * classify statements about the destinations they may run on with
+ * read/write splitting.
+ *
+ * - SELECTs which don't lock rows or change the session state may run on a
+ *   replica,
+ * - those calling FB_VECTOR_* or SEMANTIC_* functions on the vector
+ *   replicas, to keep KNN searches and LLM calls away from the OLTP load.
+ *
+ * Everything else runs on the primary.
+ */
+static StatementDestination classify_destination(
+    const std::string &stmt, stdx::flags<StmtClassifier> classified) {
+  if ((classified & StmtClassifier::StateChangeOnSuccess) ||
+      (classified & StmtClassifier::StateChangeOnError)) {
+    return StatementDestination::Primary;
+  }
+
+  MEM_ROOT mem_root;
+  THD session;
+  session.mem_root = &mem_root;
+
+  Parser_state parser_state;
+  parser_state.init(&session, stmt.data(), stmt.size());
+  session.m_parser_state = &parser_state;
+  SqlLexer lexer(&session);
+
+  auto lexer_it = lexer.begin();
+
+  // ( SELECT ... )
+  while (lexer_it != lexer.end() && (*lexer_it).id == '(') ++lexer_it;
+  if (lexer_it == lexer.end() || (*lexer_it).id != SELECT_SYM) {
+    return StatementDestination::Primary;
+  }
+
+  auto dest = StatementDestination::ReadOnly;
+  auto last = *lexer_it;
+  for (++lexer_it; lexer_it != lexer.end(); ++lexer_it) {
+    auto tkn = *lexer_it;
+
+    // SELECT ... FOR UPDATE|SHARE
+    // SELECT ... LOCK IN SHARE MODE
+    // SELECT ... INTO
+    if ((last.id == FOR_SYM && (tkn.id == UPDATE_SYM || tkn.id == SHARE_SYM)) ||
+        (last.id == LOCK_SYM && tkn.id == IN_SYM) || tkn.id == INTO) {
+      return StatementDestination::Primary;
+    }
+
+    if (tkn.id == '(' && (last.id == IDENT || last.id == IDENT_QUOTED)) {
+      std::string ident;
+      ident.resize(last.text.size());
+
+      // ascii-upper-case
+      std::transform(
+          last.text.begin(), last.text.end(), ident.begin(),
+          [](auto c) { return (c >= 'a' && c <= 'z') ? c - 0x20 : c; });
+
+      if (ident.rfind("FB_VECTOR_", 0) == 0 ||
+          ident.rfind("SEMANTIC_", 0) == 0) {
+        dest = StatementDestination::Vector;
+      }
+    }
+
+    last = tkn;
+  }
+
+  return dest;
+}
+
 static uint64_t get_error_count(MysqlRoutingClassicConnection *connection) {
   uint64_t count{};
   for (auto const &w :
@@ -875,6 +951,14 @@ stdx::expected<Processor::Result, std::error_code> QueryForwarder::command() {
       return Result::SendToClient;
     }
 
+    // pick the destination of the statement while the connection isn't
+    // bound to a server.
+    if (connection()->context().read_write_splitting() &&
+        connection()->connection_sharing_allowed()) {
+      connection()->statement_destination(
+          classify_destination(msg_res->statement(), stmt_classified_));
+    }
+
     // functions are forbidden if the connection can be shared
     // (e.g. config allows sharing and outside a transaction)
     if ((stmt_classified_ & StmtClassifier::ForbiddenFunctionWithConnSharing) &&
@@ -902,8 +986,7 @@ stdx::expected<Processor::Result, std::error_code> QueryForwarder::command() {
     stage(Stage::Connect);
     return Result::Again;
   } else {
-    stage(Stage::Response);
-    return forward_client_to_server();
+    return wait_for_my_writes();
   }
 }
 
@@ -940,8 +1023,69 @@ stdx::expected<Processor::Result, std::error_code> QueryForwarder::connected() {
   }
 
   trace(Tracer::Event().stage("query::connected"));
-  stage(Stage::Response);
-  return forward_client_to_server();
+  return wait_for_my_writes();
+}
+
+class WaitForMyWritesHandler : public QuerySender::Handler {
+ public:
+  explicit WaitForMyWritesHandler(bool &applied) : applied_(applied) {}
+
+  void on_row(const classic_protocol::message::server::Row &row) override {
+    auto it = row.begin();
+
+    // WAIT_FOR_EXECUTED_GTID_SET() returns 0 on success, 1 on timeout.
+    applied_ = it != row.end() && (*it).has_value() && (*it).value() == "0";
+  }
+
+ private:
+  bool &applied_;
+};
+
+/**
+ * make sure a replica applied the writes of the session before it runs
+ * the statement.
+ */
+stdx::expected<Processor::Result, std::error_code>
+QueryForwarder::wait_for_my_writes() {
+  const auto gtid = connection()->gtid_to_wait_for();
+
+  if (connection()->statement_destination() ==
+          StatementDestination::Primary ||
+      gtid.empty()) {
+    stage(Stage::Response);
+    return forward_client_to_server();
+  }
+
+  trace(Tracer::Event().stage("query::wait_for_my_writes: " + gtid));
+
+  my_writes_applied_ = false;
+  stage(Stage::MyWritesWaited);
+
+  connection()->push_processor(std::make_unique<QuerySender>(
+      connection(),
+      "SELECT WAIT_FOR_EXECUTED_GTID_SET('" + gtid + "', " +
+          std::to_string(kWaitForMyWritesTimeout.count()) + ")",
+      std::make_unique<WaitForMyWritesHandler>(my_writes_applied_)));
+
+  return Result::Again;
+}
+
+stdx::expected<Processor::Result, std::error_code>
+QueryForwarder::my_writes_waited() {
+  if (my_writes_applied_) {
+    connection()->gtid_waited();
+
+    stage(Stage::Response);
+    return forward_client_to_server();
+  }
+
+  // the replica lags behind, read from the primary.
+  trace(Tracer::Event().stage("query::my_writes_not_applied"));
+
+  connection()->statement_destination(StatementDestination::Primary);
+
+  stage(Stage::Connect);
+  return Result::Again;
 }
 
 stdx::expected<Processor::Result, std::error_code> QueryForwarder::response() {
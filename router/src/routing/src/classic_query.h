@@ -53,6 +53,7 @@ class QueryForwarder : public Processor {
 
     Connect,
     Connected,
+    MyWritesWaited,
 
     Response,
     ColumnCount,
@@ -80,6 +81,8 @@ class QueryForwarder : public Processor {
   stdx::expected<Result, std::error_code> command();
   stdx::expected<Result, std::error_code> connect();
   stdx::expected<Result, std::error_code> connected();
+  stdx::expected<Result, std::error_code> wait_for_my_writes();
+  stdx::expected<Result, std::error_code> my_writes_waited();
   stdx::expected<Result, std::error_code> response();
   stdx::expected<Result, std::error_code> load_data();
   stdx::expected<Result, std::error_code> data();
@@ -103,6 +106,9 @@ class QueryForwarder : public Processor {
   Stage stage_{Stage::Command};
 
   uint64_t columns_left_{0};
+
+  // if the replica applied the writes of the session.
+  bool my_writes_applied_{false};
 };
 
 class QuerySender : public Processor {
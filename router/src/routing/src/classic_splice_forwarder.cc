@@ -0,0 +1,195 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "classic_splice_forwarder.h"
+
+#ifdef __linux__
+#include <fcntl.h>  // splice
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+
+#include "classic_connection.h"
+#include "harness_assert.h"
+#include "mysql/harness/net_ts/impl/socket_error.h"
+#include "mysqlrouter/connection_base.h"
+
+// bytes moved by one splice() call.
+static constexpr size_t kSpliceSize{64 * 1024};
+
+// splice() rounds before yielding to the other connections of the
+// io-thread.
+static constexpr int kMaxRounds{16};
+
+bool SpliceForwarder::is_supported() {
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif
+}
+
+SpliceForwarder::~SpliceForwarder() {
+#ifdef __linux__
+  for (auto *dir : {&up_, &down_}) {
+    for (auto &fd : dir->pipe_fds) {
+      if (fd != -1) ::close(fd);
+    }
+  }
+#endif
+}
+
+stdx::expected<Processor::Result, std::error_code> SpliceForwarder::process() {
+  switch (stage()) {
+    case Stage::Init:
+      return init();
+    case Stage::Done:
+      return Result::Done;
+  }
+
+  harness_assert_this_should_not_execute();
+}
+
+stdx::expected<Processor::Result, std::error_code> SpliceForwarder::init() {
+  stage(Stage::Done);
+
+#ifdef __linux__
+  auto *socket_splicer = connection()->socket_splicer();
+
+  auto *client_conn = socket_splicer->client_conn().connection().get();
+  auto *server_conn = socket_splicer->server_conn().connection().get();
+  if (client_conn == nullptr || server_conn == nullptr) return Result::Done;
+
+  for (auto *dir : {&up_, &down_}) {
+    if (::pipe2(dir->pipe_fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+      // out of fds, let the caller forward.
+      return Result::Done;
+    }
+  }
+
+  // splice() must not block on the sockets either.
+  for (auto *conn : {client_conn, server_conn}) {
+    const auto fd = conn->native_handle();
+    const auto flags = ::fcntl(fd, F_GETFL);
+    if (flags == -1 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+      return Result::Done;
+    }
+  }
+
+  trace(Tracer::Event().stage("splice::forward"));
+
+  up_.src = client_conn;
+  up_.dst = server_conn;
+  up_.to_server = true;
+
+  down_.src = server_conn;
+  down_.dst = client_conn;
+  down_.to_server = false;
+
+  wait_recv(up_);
+  wait_recv(down_);
+
+  // the waits end the connection.
+  return Result::Suspend;
+#else
+  return Result::Done;
+#endif
+}
+
+void SpliceForwarder::wait_recv(Direction &dir) {
+  ++pending_;
+  dir.src->async_wait_recv([this, &dir](std::error_code ec) {
+    --pending_;
+
+    if (ec) return forwarding_failed(ec);
+
+    transfer(dir);
+  });
+}
+
+void SpliceForwarder::wait_send(Direction &dir) {
+  ++pending_;
+  dir.dst->async_wait_send([this, &dir](std::error_code ec) {
+    --pending_;
+
+    if (ec) return forwarding_failed(ec);
+
+    transfer(dir);
+  });
+}
+
+void SpliceForwarder::transfer(Direction &dir) {
+  if (ec_) return forwarding_failed(ec_);
+
+#ifdef __linux__
+  for (int round = 0; round < kMaxRounds; ++round) {
+    if (dir.in_pipe == 0) {
+      const auto spliced =
+          ::splice(dir.src->native_handle(), nullptr, dir.pipe_fds[1], nullptr,
+                   kSpliceSize, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      if (spliced == 0) {
+        return forwarding_failed(make_error_code(net::stream_errc::eof));
+      }
+      if (spliced < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return wait_recv(dir);
+
+        return forwarding_failed(net::impl::socket::last_error_code());
+      }
+
+      dir.in_pipe = spliced;
+    }
+
+    const auto spliced =
+        ::splice(dir.pipe_fds[0], nullptr, dir.dst->native_handle(), nullptr,
+                 dir.in_pipe, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (spliced < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) return wait_send(dir);
+
+      return forwarding_failed(net::impl::socket::last_error_code());
+    }
+
+    dir.in_pipe -= spliced;
+
+    if (dir.to_server) {
+      connection()->transfered_to_server(spliced);
+    } else {
+      connection()->transfered_to_client(spliced);
+    }
+  }
+
+  // let the other connections of the io-thread run.
+  if (dir.in_pipe == 0) return wait_recv(dir);
+  return wait_send(dir);
+#endif
+}
+
+void SpliceForwarder::forwarding_failed(std::error_code ec) {
+  if (!ec_) {
+    ec_ = ec;
+
+    // wake the wait of the other direction.
+    (void)up_.src->cancel();
+    (void)up_.dst->cancel();
+  }
+
+  if (pending_ > 0) return;
+
+  trace(Tracer::Event().stage("splice::done"));
+
+  // closes both sides and ends the connection, which destroys this.
+  connection()->recv_client_failed(ec_);
+}
@@ -0,0 +1,98 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#ifndef ROUTING_CLASSIC_SPLICE_FORWARDER_INCLUDED
+#define ROUTING_CLASSIC_SPLICE_FORWARDER_INCLUDED
+
+#include <cstddef>
+#include <system_error>
+
+#include "processor.h"
+
+class ConnectionBase;
+
+/**
+ * forwards the bytes between client and server in the kernel.
+ *
+ * Once the router has nothing left to inspect, like after the switch to TLS
+ * of a client_ssl_mode=PASSTHROUGH route, the bytes are moved from one
+ * socket to the other with splice() through a pipe per direction, instead of
+ * being copied through the buffers of the channels.
+ *
+ * Ends the connection once either side closed it. If splice() isn't
+ * available, returns Result::Done right away for the caller to forward the
+ * bytes itself.
+ */
+class SpliceForwarder : public Processor {
+ public:
+  using Processor::Processor;
+
+  ~SpliceForwarder() override;
+
+  enum class Stage {
+    Init,
+    Done,
+  };
+
+  stdx::expected<Result, std::error_code> process() override;
+
+  void stage(Stage stage) { stage_ = stage; }
+  Stage stage() const { return stage_; }
+
+  /**
+   * if splice() is available on this platform.
+   */
+  static bool is_supported();
+
+ private:
+  /**
+   * one direction of the forwarding.
+   */
+  struct Direction {
+    ConnectionBase *src{};
+    ConnectionBase *dst{};
+    bool to_server{};
+
+    int pipe_fds[2]{-1, -1};
+    // bytes in the pipe, not sent to dst yet.
+    size_t in_pipe{};
+  };
+
+  stdx::expected<Result, std::error_code> init();
+
+  void wait_recv(Direction &dir);
+  void wait_send(Direction &dir);
+
+  /**
+   * move bytes from src to dst until either would block.
+   */
+  void transfer(Direction &dir);
+
+  /**
+   * stop forwarding and end the connection once no wait is pending.
+   */
+  void forwarding_failed(std::error_code ec);
+
+  Stage stage_{Stage::Init};
+
+  Direction up_;
+  Direction down_;
+
+  int pending_{0};
+  std::error_code ec_{};
+};
+
+#endif
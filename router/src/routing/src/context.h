@@ -48,6 +48,8 @@
 #include "ssl_mode.h"
 #include "tcp_address.h"
 
+class RouteDestination;
+
 /**
  * @brief MySQLRoutingContext holds data used by MySQLRouting (1 per plugin
  * instances) and MySQLRoutingConnection instances (many instances). It is
@@ -169,6 +171,37 @@ class MySQLRoutingContext {
     return connection_sharing_delay_;
   }
 
+  /**
+   * set the destinations of the statements that may run on a replica.
+   *
+   * @param read_only destinations of read-only SELECTs, the primary ones if
+   * nullptr
+   * @param vector destinations of the SELECTs calling vector or semantic
+   * functions, the read-only ones if nullptr
+   */
+  void statement_destinations(RouteDestination *read_only,
+                              RouteDestination *vector) {
+    read_only_destination_ = read_only;
+    vector_destination_ = vector;
+  }
+
+  RouteDestination *read_only_destination() const {
+    return read_only_destination_;
+  }
+
+  RouteDestination *vector_destination() const {
+    return vector_destination_ != nullptr ? vector_destination_
+                                          : read_only_destination_;
+  }
+
+  /**
+   * if statements are routed to the primary or the replicas one by one.
+   */
+  bool read_write_splitting() const {
+    return connection_sharing_ && (read_only_destination_ != nullptr ||
+                                   vector_destination_ != nullptr);
+  }
+
  private:
   /** protocol type. */
   BaseProtocol::Type protocol_;
@@ -220,6 +253,9 @@ class MySQLRoutingContext {
 
   std::chrono::milliseconds connection_sharing_delay_;
 
+  RouteDestination *read_only_destination_{};
+  RouteDestination *vector_destination_{};
+
  public:
   /** @brief Number of active routes */
   std::atomic<uint16_t> info_active_routes_{0};
@@ -1031,22 +1031,13 @@ std::unique_ptr<RouteDestination> create_standalone_destination(
   throw std::runtime_error("Wrong routing strategy " +
                            std::to_string(static_cast<int>(strategy)));
 }
-}  // namespace
 
-void MySQLRouting::set_destinations_from_csv(const std::string &csv) {
+void add_destinations_from_csv(RouteDestination &destination,
+                               const std::string &csv,
+                               const Protocol::Type protocol) {
   std::stringstream ss(csv);
   std::string part;
 
-  // if no routing_strategy is defined for standalone routing
-  // we set the default based on the mode
-  if (routing_strategy_ == RoutingStrategy::kUndefined) {
-    routing_strategy_ = get_default_routing_strategy(access_mode_);
-  }
-
-  is_destination_standalone_ = true;
-  destination_ = create_standalone_destination(io_ctx_, routing_strategy_,
-                                               context_.get_protocol());
-
   // Fall back to comma separated list of MySQL servers
   while (std::getline(ss, part, ',')) {
     mysql_harness::trim(part);
@@ -1060,15 +1051,30 @@ void MySQLRouting::set_destinations_from_csv(const std::string &csv) {
 
     if (mysql_harness::is_valid_domainname(addr.address())) {
       if (addr.port() == 0) {
-        addr.port(Protocol::get_default_port(context_.get_protocol()));
+        addr.port(Protocol::get_default_port(protocol));
       }
 
-      destination_->add(addr);
+      destination.add(addr);
     } else {
       throw std::runtime_error(
           string_format("Destination address '%s' is invalid", part.c_str()));
     }
   }
+}
+}  // namespace
+
+void MySQLRouting::set_destinations_from_csv(const std::string &csv) {
+  // if no routing_strategy is defined for standalone routing
+  // we set the default based on the mode
+  if (routing_strategy_ == RoutingStrategy::kUndefined) {
+    routing_strategy_ = get_default_routing_strategy(access_mode_);
+  }
+
+  is_destination_standalone_ = true;
+  destination_ = create_standalone_destination(io_ctx_, routing_strategy_,
+                                               context_.get_protocol());
+
+  add_destinations_from_csv(*destination_, csv, context_.get_protocol());
 
   // Check whether bind address is part of list of destinations
   for (auto &it : *(destination_)) {
@@ -1082,6 +1088,26 @@ void MySQLRouting::set_destinations_from_csv(const std::string &csv) {
   }
 }
 
+void MySQLRouting::set_statement_destinations_from_csv(
+    const std::string &read_only_csv, const std::string &vector_csv) {
+  // the replicas share the load of the statements
+  if (!read_only_csv.empty()) {
+    read_only_destination_ =
+        std::make_unique<DestRoundRobin>(io_ctx_, context_.get_protocol());
+    add_destinations_from_csv(*read_only_destination_, read_only_csv,
+                              context_.get_protocol());
+  }
+  if (!vector_csv.empty()) {
+    vector_destination_ =
+        std::make_unique<DestRoundRobin>(io_ctx_, context_.get_protocol());
+    add_destinations_from_csv(*vector_destination_, vector_csv,
+                              context_.get_protocol());
+  }
+
+  context_.statement_destinations(read_only_destination_.get(),
+                                  vector_destination_.get());
+}
+
 void MySQLRouting::validate_destination_connect_timeout(
     std::chrono::milliseconds timeout) {
   if (timeout <= std::chrono::milliseconds::zero()) {
@@ -196,6 +196,19 @@ class ROUTING_EXPORT MySQLRouting : public MySQLRoutingBase {
 
   void set_destinations_from_uri(const mysqlrouter::URI &uri);
 
+  /**
+   * Sets the replicas statements are routed to one by one, apart from the
+   * destinations of the route which take the others.
+   *
+   * Either list may be empty.
+   *
+   * @param read_only_csv destinations of read-only SELECTs
+   * @param vector_csv destinations of the SELECTs calling vector or semantic
+   * functions
+   */
+  void set_statement_destinations_from_csv(const std::string &read_only_csv,
+                                           const std::string &vector_csv);
+
   /** @brief Returns timeout when connecting to destination
    *
    * @return Timeout in seconds as int
@@ -336,6 +349,10 @@ class ROUTING_EXPORT MySQLRouting : public MySQLRoutingBase {
   /** @brief Destination object to use when getting next connection */
   std::unique_ptr<RouteDestination> destination_;
 
+  /** @brief Destinations of the statements that may run on a replica */
+  std::unique_ptr<RouteDestination> read_only_destination_;
+  std::unique_ptr<RouteDestination> vector_destination_;
+
   bool is_destination_standalone_{false};
 
   /** @brief Routing strategy to use when getting next destination */
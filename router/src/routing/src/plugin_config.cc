@@ -494,6 +494,11 @@ RoutingPluginConfig::RoutingPluginConfig(
               get_option(section, "connection_sharing_delay",
                          DoubleOption{0})));
 
+  GET_OPTION_CHECKED(read_only_destinations, section, "read_only_destinations",
+                     StringOption{});
+  GET_OPTION_CHECKED(vector_destinations, section, "vector_destinations",
+                     StringOption{});
+
   using namespace std::string_literals;
 
   // either bind_address or socket needs to be set, or both
@@ -100,6 +100,9 @@ class ROUTING_PLUGIN_EXPORT RoutingPluginConfig
       connection_sharing_delay;  //!< delay before an idling connection is
                                  //!< moved to the pool and connection sharing
                                  //!< is allowed.
+  std::string read_only_destinations;  //!< destinations of read-only SELECTs
+  std::string vector_destinations;     //!< destinations of the SELECTs calling
+                                       //!< vector or semantic functions
 };
 
 #endif  // PLUGIN_CONFIG_ROUTING_INCLUDED
@@ -456,6 +456,20 @@ static void start(mysql_harness::PluginFuncEnv *env) {
     } catch (const URIError &) {
       r->set_destinations_from_csv(config.destinations);
     }
+
+    if (!config.read_only_destinations.empty() ||
+        !config.vector_destinations.empty()) {
+      if (!config.connection_sharing ||
+          config.protocol == Protocol::Type::kXProtocol) {
+        log_warning(
+            "[%s].read_only_destinations and [%s].vector_destinations have "
+            "been ignored, as connection_sharing=0 or protocol=x",
+            name.c_str(), name.c_str());
+      } else {
+        r->set_statement_destinations_from_csv(config.read_only_destinations,
+                                               config.vector_destinations);
+      }
+    }
     MySQLRoutingComponent::get_instance().register_route(section->key, r);
 
     Scope_guard guard{[section_key = section->key]() {
@@ -60,6 +60,7 @@
 #include <stdio.h>
 
 #include <algorithm>
+#include <deque>
 #include <fstream>
 #include <ios>
 #include <iostream>
@@ -3557,6 +3558,7 @@ void mysql_extension_free(MYSQL_EXTENSION *ext) {
     my_free(ext->mysql_async_context);
     ext->mysql_async_context = nullptr;
   }
+  delete ext->pipeline;
 #ifdef MYSQL_SERVER
   if (ext->mcs_extn) my_free(ext->mcs_extn);
 #endif
@@ -8860,6 +8862,179 @@ end:
     return NET_ASYNC_COMPLETE;
 }
 
+/*
+  The queries of a connection sent ahead of the results of the queries
+  before them, in the order the server answers them.
+*/
+struct MYSQL_PIPELINE {
+  struct Entry {
+    mysql_pipeline_callback callback;
+    void *arg;
+  };
+  std::deque<Entry> entries;
+  /* mysql_pipeline_read_result_nonblocking() is reading the first result */
+  bool reading{false};
+};
+
+/**
+  Send a query without waiting for the results of the queries sent before
+  it by this function, so that a round trip is paid once for many queries.
+
+  The results are read, in the order the queries were sent, by
+  mysql_pipeline_read_result() or mysql_pipeline_read_result_nonblocking(),
+  which call the callback of the query once its result is read, for it to
+  store or use the result like after mysql_real_query(). Nothing else may
+  be sent on the connection while results are pending.
+
+  The server answers the queries while the client sends more: a client that
+  never reads may fill the socket buffers of both sides and block. Keep the
+  number of pending queries bounded.
+
+  @param[in]   mysql               connection handle
+  @param[in]   query               query string to be executed
+  @param[in]   length              length of the query
+  @param[in]   callback            called once the result is read, may be
+                                   nullptr
+  @param[in]   arg                 passed to the callback
+
+  @retval 0   the query was sent
+  @retval 1   error, the query was not queued
+*/
+int STDCALL mysql_pipeline_send_query(MYSQL *mysql, const char *query,
+                                      ulong length,
+                                      mysql_pipeline_callback callback,
+                                      void *arg) {
+  DBUG_TRACE;
+  MYSQL_EXTENSION *ext = MYSQL_EXTENSION_PTR(mysql);
+  if (ext->pipeline == nullptr) {
+    ext->pipeline = new (std::nothrow) MYSQL_PIPELINE;
+    if (ext->pipeline == nullptr) {
+      set_mysql_error(mysql, CR_OUT_OF_MEMORY, unknown_sqlstate);
+      return 1;
+    }
+  }
+  MYSQL_PIPELINE *pipeline = ext->pipeline;
+
+  /*
+    Compressed packets are read ahead of the packet asked for, into the
+    buffer the next query is written from.
+  */
+  if (mysql->net.compress) {
+    set_mysql_error(mysql, CR_NOT_IMPLEMENTED, unknown_sqlstate);
+    return 1;
+  }
+  if (pipeline->reading) {
+    set_mysql_error(mysql, CR_COMMANDS_OUT_OF_SYNC, unknown_sqlstate);
+    return 1;
+  }
+  if (pipeline->entries.empty()) {
+    if (mysql_send_query(mysql, query, length)) return 1;
+  } else {
+    /* a reconnect would lose the results pending */
+    if (mysql->net.vio == nullptr) {
+      set_mysql_error(mysql, CR_SERVER_LOST, unknown_sqlstate);
+      return 1;
+    }
+    const bool old_reconnect = mysql->reconnect;
+    mysql->reconnect = false;
+    const int error = mysql_send_query(mysql, query, length);
+    mysql->reconnect = old_reconnect;
+    if (error) return 1;
+  }
+  pipeline->entries.push_back({callback, arg});
+  return 0;
+}
+
+/**
+  The number of queries sent by mysql_pipeline_send_query() whose result
+  was not read yet.
+*/
+unsigned int STDCALL mysql_pipeline_pending(MYSQL *mysql) {
+  const auto *ext = static_cast<MYSQL_EXTENSION *>(mysql->extension);
+  if (ext == nullptr || ext->pipeline == nullptr) return 0;
+  return static_cast<unsigned int>(ext->pipeline->entries.size());
+}
+
+/*
+  Get ready to read the result of the first query pending, as
+  cli_advanced_command() gets ready to read the result of the command it
+  sends.
+*/
+static bool pipeline_start_read(MYSQL *mysql, MYSQL_PIPELINE *pipeline) {
+  if (pipeline == nullptr || pipeline->entries.empty() ||
+      mysql->status != MYSQL_STATUS_READY ||
+      mysql->server_status & SERVER_MORE_RESULTS_EXISTS) {
+    set_mysql_error(mysql, CR_COMMANDS_OUT_OF_SYNC, unknown_sqlstate);
+    return true;
+  }
+  if (mysql->net.vio == nullptr) {
+    pipeline->entries.clear();
+    set_mysql_error(mysql, CR_SERVER_LOST, unknown_sqlstate);
+    return true;
+  }
+  net_clear_error(&mysql->net);
+  mysql->info = nullptr;
+  mysql->affected_rows = ~(my_ulonglong)0;
+  /* the packets of a result are numbered from 1, after the query's 0 */
+  mysql->net.pkt_nr = mysql->net.compress_pkt_nr = 1;
+  return false;
+}
+
+/* Call the callback of the first query pending, whose result was read. */
+static void pipeline_end_read(MYSQL *mysql, MYSQL_PIPELINE *pipeline) {
+  const MYSQL_PIPELINE::Entry entry = pipeline->entries.front();
+  pipeline->entries.pop_front();
+  if (entry.callback != nullptr) entry.callback(mysql, entry.arg);
+}
+
+/**
+  Read the result of the first query pending from
+  mysql_pipeline_send_query(), then call its callback.
+
+  @retval false the result was read
+  @retval true  error, the query failed or nothing is pending
+*/
+bool STDCALL mysql_pipeline_read_result(MYSQL *mysql) {
+  DBUG_TRACE;
+  MYSQL_PIPELINE *pipeline = MYSQL_EXTENSION_PTR(mysql)->pipeline;
+  if ((pipeline != nullptr && pipeline->reading) ||
+      pipeline_start_read(mysql, pipeline))
+    return true;
+
+  if (!vio_is_blocking(mysql->net.vio))
+    vio_set_blocking_flag(mysql->net.vio, true);
+  const bool error = (*mysql->methods->read_query_result)(mysql);
+  pipeline_end_read(mysql, pipeline);
+  return error;
+}
+
+/**
+  mysql_pipeline_read_result() for event loops: returns NET_ASYNC_NOT_READY
+  until the result of the first query pending is read, to be called again
+  once the socket of mysql_get_socket_descriptor() is readable.
+*/
+net_async_status STDCALL mysql_pipeline_read_result_nonblocking(MYSQL *mysql) {
+  DBUG_TRACE;
+  MYSQL_PIPELINE *pipeline = MYSQL_EXTENSION_PTR(mysql)->pipeline;
+  if (pipeline == nullptr || !pipeline->reading) {
+    if (NET_ASYNC_DATA(&mysql->net) == nullptr) {
+      set_mysql_error(mysql, CR_COMMANDS_OUT_OF_SYNC, unknown_sqlstate);
+      return NET_ASYNC_ERROR;
+    }
+    if (pipeline_start_read(mysql, pipeline)) return NET_ASYNC_ERROR;
+    if (vio_is_blocking(mysql->net.vio))
+      vio_set_blocking_flag(mysql->net.vio, false);
+    pipeline->reading = true;
+  }
+
+  const net_async_status status =
+      (*mysql->methods->read_query_result_nonblocking)(mysql);
+  if (status == NET_ASYNC_NOT_READY) return status;
+  pipeline->reading = false;
+  pipeline_end_read(mysql, pipeline);
+  return status;
+}
+
 /**************************************************************************
   Alloc result struct for buffered results. All rows are read to buffer.
   mysql_data_seek may be used.
@@ -1129,6 +1129,44 @@ Value Value::element(size_t pos) const {
   return parse_value(type, m_data + value_offset, m_length - value_offset);
 }
 
+/**
+  Narrow the elements of a JSON array of doubles into a float array.
+
+  Only arrays whose elements are all doubles, stored back to back in
+  element order the way serialize() writes them, are handled. The check
+  reads the value entries without constructing a Value per element, and
+  the conversion is a plain loop over the stored doubles which the
+  compiler turns into packed double to float conversions.
+
+  @param[out] dest  buffer with room for element_count() floats
+  @return false on success, true if the array does not have this layout
+*/
+bool Value::get_float_array(float *dest) const {
+  assert(m_type == ARRAY);
+
+  if (m_element_count == 0) return false;
+
+  const size_t header_size = value_entry_offset(m_element_count);
+  const size_t first =
+      read_offset_or_size(m_data + value_entry_offset(0) + 1, m_large);
+  if (first < header_size || first > m_length ||
+      m_length - first < size_t{m_element_count} * sizeof(double))
+    return true;
+
+  for (uint32 i = 0; i < m_element_count; ++i) {
+    const size_t entry_offset = value_entry_offset(i);
+    if (static_cast<uint8>(m_data[entry_offset]) != JSONB_TYPE_DOUBLE ||
+        read_offset_or_size(m_data + entry_offset + 1, m_large) !=
+            first + i * sizeof(double))
+      return true;
+  }
+
+  const char *values = m_data + first;
+  for (uint32 i = 0; i < m_element_count; ++i)
+    dest[i] = static_cast<float>(float8get(values + i * sizeof(double)));
+  return false;
+}
+
 /**
   Get the key of the member stored at the specified position in a JSON
   object.
@@ -289,6 +289,9 @@ class Value {
   EXPORT_JSON_FUNCTION
   Value element(size_t pos) const;
 
+  EXPORT_JSON_FUNCTION
+  bool get_float_array(float *dest) const;
+
   EXPORT_JSON_FUNCTION
   Value key(size_t pos) const;
 
@@ -21,6 +21,9 @@
    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
 
 #include "sql/basic_ostream.h"
+
+#include <algorithm>
+
 #include "my_inttypes.h"
 #include "mysql/components/services/log_shared.h"
 #include "mysql/psi/mysql_file.h"
@@ -102,8 +105,18 @@ void Compressed_ostream::set_compressor(
   m_compressor = c;
 }
 
+void Compressed_ostream::set_sample(std::string *sample, my_off_t size) {
+  m_sample = sample;
+  m_sample_size = size;
+}
+
 bool Compressed_ostream::write(const unsigned char *buffer, my_off_t length) {
   if (m_compressor == nullptr) return true;
+  if (m_sample != nullptr && m_sample->size() < m_sample_size) {
+    const my_off_t sampled = m_sample_size - m_sample->size();
+    m_sample->append(reinterpret_cast<const char *>(buffer),
+                     std::min(length, sampled));
+  }
   auto res{false};
   auto left{0};
   std::tie(left, res) = m_compressor->compress(buffer, length);
@@ -23,6 +23,7 @@
 #ifndef BASIC_OSTREAM_INCLUDED
 #define BASIC_OSTREAM_INCLUDED
 #include <my_byteorder.h>
+#include <string>
 #include "libbinlogevents/include/compression/base.h"
 #include "my_sys.h"
 #include "sql_string.h"
@@ -184,6 +185,9 @@ class StringBuffer_ostream : public Basic_ostream,
 class Compressed_ostream : public Basic_ostream {
  private:
   binary_log::transaction::compression::Compressor *m_compressor;
+  /* the first bytes written, kept while sampling */
+  std::string *m_sample{nullptr};
+  my_off_t m_sample_size{0};
 
  public:
   Compressed_ostream();
@@ -192,6 +196,13 @@ class Compressed_ostream : public Basic_ostream {
   Compressed_ostream &operator=(const Compressed_ostream &) = delete;
   binary_log::transaction::compression::Compressor *get_compressor();
   void set_compressor(binary_log::transaction::compression::Compressor *);
+  /**
+    Keep the first bytes written to the compressor.
+
+    @param sample  where to append the bytes
+    @param size    the most bytes to keep
+  */
+  void set_sample(std::string *sample, my_off_t size);
   bool write(const unsigned char *buffer, my_off_t length) override;
 };
 
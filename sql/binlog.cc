@@ -89,6 +89,8 @@
 #include "partition_info.h"
 #include "prealloced_array.h"
 #include "scope_guard.h"
+#include "sql/binlog/compression_dictionary.h"
+#include "sql/binlog/event_cache.h"
 #include "sql/binlog/global.h"
 #include "sql/binlog/group_commit/bgc_ticket_manager.h"  // Bgc_ticket_manager
 #include "sql/binlog/recovery.h"  // binlog::Binlog_recovery
@@ -205,6 +207,12 @@ latency_histogram histogram_binlog_fsync;
 counter_histogram histogram_binlog_group_commit;
 latency_histogram histogram_binlog_group_commit_trx;
 latency_histogram histogram_binlog_engine_commit_trx;
+latency_histogram histogram_binlog_engine_prepare_trx;
+latency_histogram histogram_binlog_flush_stage;
+latency_histogram histogram_binlog_sync_stage;
+latency_histogram histogram_binlog_commit_stage;
+counter_histogram histogram_binlog_sync_stage_queue;
+counter_histogram histogram_binlog_commit_stage_queue;
 char *opt_histogram_binlog_commit_time_step_size = nullptr;
 
 MYSQL_BIN_LOG mysql_bin_log(&sync_binlog_period);
@@ -544,11 +552,24 @@ class MYSQL_BIN_LOG::Binlog_ofile : public Basic_ostream {
   }
 
   void close() {
+    binlog::event_cache.close(m_cache_generation);
+    m_cache_generation = 0;
     m_pipeline_head.reset(nullptr);
     m_position = 0;
     m_encrypted_header_size = 0;
   }
 
+  /**
+    Keep what is written to the file from now on in binlog::event_cache for
+    the dump threads.
+
+    @param[in] binlog_name  The name of the file, as in the index
+  */
+  void cache_events(const char *binlog_name) {
+    if (m_encrypted_header_size > 0) return;
+    m_cache_generation = binlog::event_cache.open(binlog_name, m_position);
+  }
+
   /**
      Writes data into storage and maintains binlog position.
 
@@ -563,6 +584,7 @@ class MYSQL_BIN_LOG::Binlog_ofile : public Basic_ostream {
 
     if (m_pipeline_head->write(buffer, length)) return true;
 
+    binlog::event_cache.append(m_cache_generation, buffer, length);
     m_position += length;
     return false;
   }
@@ -580,6 +602,8 @@ class MYSQL_BIN_LOG::Binlog_ofile : public Basic_ostream {
   */
   bool update(const unsigned char *buffer, my_off_t length, my_off_t offset) {
     assert(m_pipeline_head != nullptr);
+    binlog::event_cache.close(m_cache_generation);
+    m_cache_generation = 0;
     return m_pipeline_head->seek(offset) ||
            m_pipeline_head->write(buffer, length);
   }
@@ -596,6 +620,7 @@ class MYSQL_BIN_LOG::Binlog_ofile : public Basic_ostream {
     assert(m_pipeline_head != nullptr);
 
     if (m_pipeline_head->truncate(offset)) return true;
+    binlog::event_cache.truncate(m_cache_generation, offset);
     m_position = offset;
     return false;
   }
@@ -665,6 +690,8 @@ class MYSQL_BIN_LOG::Binlog_ofile : public Basic_ostream {
      @retval true  Error
   */
   bool seek(my_off_t offset) {
+    binlog::event_cache.close(m_cache_generation);
+    m_cache_generation = 0;
     if (m_pipeline_head->seek(offset)) return true;  // error
 
     m_position = 0;
@@ -683,6 +710,8 @@ class MYSQL_BIN_LOG::Binlog_ofile : public Basic_ostream {
   std::unique_ptr<Truncatable_ostream> m_pipeline_head;
   bool m_encrypted = false;
   IO_CACHE *m_io_cache = nullptr;
+  /// The generation of the file in binlog::event_cache, 0 if not cached.
+  uint64_t m_cache_generation = 0;
 };
 
 /**
@@ -1600,6 +1629,18 @@ static int binlog_init(void *p) {
                          opt_histogram_binlog_commit_time_step_size);
   latency_histogram_init(&histogram_binlog_engine_commit_trx,
                          opt_histogram_binlog_commit_time_step_size);
+  latency_histogram_init(&histogram_binlog_engine_prepare_trx,
+                         opt_histogram_binlog_commit_time_step_size);
+  latency_histogram_init(&histogram_binlog_flush_stage,
+                         opt_histogram_binlog_commit_time_step_size);
+  latency_histogram_init(&histogram_binlog_sync_stage,
+                         opt_histogram_binlog_commit_time_step_size);
+  latency_histogram_init(&histogram_binlog_commit_stage,
+                         opt_histogram_binlog_commit_time_step_size);
+  counter_histogram_init(&histogram_binlog_sync_stage_queue,
+                         opt_histogram_step_size_binlog_group_commit);
+  counter_histogram_init(&histogram_binlog_commit_stage_queue,
+                         opt_histogram_step_size_binlog_group_commit);
   return 0;
 }
 
@@ -2379,6 +2420,7 @@ bool binlog_cache_data::compress(THD *thd) {
     Transaction_payload_log_event tple{thd};
     Compressed_ostream stream;
     PSI_stage_info old_stage;
+    std::string sample;
 
     // set the thread stage to compressing transaction
     thd->enter_stage(&stage_binlog_transaction_compress, &old_stage, __func__,
@@ -2401,6 +2443,16 @@ bool binlog_cache_data::compress(THD *thd) {
 
     ctype = compressor->compression_type_code();
 
+    // ZSTD payloads share a dictionary trained on the binary log
+    if (ctype == binary_log::transaction::compression::ALGORITHM_ZSTD) {
+      static_cast<binary_log::transaction::compression::Zstd_comp *>(
+          compressor)
+          ->set_dictionary(binlog::compression_dictionary.current());
+      if (binlog::compression_dictionary.is_sampling())
+        stream.set_sample(&sample,
+                          binlog::Compression_dictionary::MAX_SAMPLE_SIZE);
+    }
+
     compressor->open();
 
     // inject the compressor in the output stream
@@ -2417,6 +2469,10 @@ bool binlog_cache_data::compress(THD *thd) {
 
     compressor->close();
 
+    if (!sample.empty())
+      binlog::compression_dictionary.add_sample(
+          sample, thd->variables.binlog_trx_compression_level_zstd);
+
     if ((error = m_cache.truncate(0))) goto compression_end;
     // Since we deleted all events from the cache, we also need to
     // reset event_counter.
@@ -5142,6 +5198,10 @@ bool MYSQL_BIN_LOG::open(PSI_file_key log_file_key, const char *log_name,
 
   if (ret) goto err;
 
+  // the raft plugin writes the file without m_binlog_file
+  if (!is_relay_log && !enable_raft_plugin)
+    m_binlog_file->cache_events(log_file_name);
+
   atomic_log_state = LOG_OPENED;
   return false;
 
@@ -6794,6 +6854,24 @@ bool MYSQL_BIN_LOG::open_binlog(
         }
         should_write_metadata_event = true;
       }
+
+      // the dictionaries the transaction payloads of the file use
+      if (!is_relay_log) {
+        for (const auto &dictionary :
+             binlog::compression_dictionary.rotate()) {
+          metadata_ev.add_compression_dictionary(dictionary->content());
+          should_write_metadata_event = true;
+        }
+      }
+    }
+
+    // the dictionaries of the relayed file, for an applier starting here
+    if (is_relay_log && !enable_raft_plugin) {
+      for (const auto &content : relay_log_compression_dictionaries) {
+        metadata_ev.add_compression_dictionary(content);
+        should_write_metadata_event = true;
+      }
+      if (should_write_metadata_event) metadata_ev.set_relay_log_event();
     }
 
     if (should_write_metadata_event && write_event_to_binlog(&metadata_ev))
@@ -10695,7 +10773,11 @@ int MYSQL_BIN_LOG::prepare(THD *thd, bool all) {
   thd->durability_property = HA_IGNORE_DURABILITY;
 
   CONDITIONAL_SYNC_POINT_FOR_TIMESTAMP("before_prepare_in_engines");
+  auto prepare_start_time = my_timer_now();
   int error = ha_prepare_low(thd, all);
+  if (ending_trans(thd, all))
+    latency_histogram_increment(&histogram_binlog_engine_prepare_trx,
+                                my_timer_since(prepare_start_time), 1);
 
   CONDITIONAL_SYNC_POINT_FOR_TIMESTAMP("after_ha_prepare_low");
   // Invoke `commit` if we're dealing with `XA PREPARE` in order to use BCG
@@ -12070,6 +12152,14 @@ int ask_server_to_register_with_raft(Raft_Registration_Item item) {
   return err;
 }
 
+/// The sessions in a queue of the group commit.
+static ulonglong queue_length(THD *queue) {
+  ulonglong length = 0;
+  for (THD *head = queue; head != nullptr; head = head->next_to_commit)
+    ++length;
+  return length;
+}
+
 int MYSQL_BIN_LOG::ordered_commit(THD *thd, bool all, bool skip_commit) {
   DBUG_TRACE;
   int flush_error = 0, sync_error = 0;
@@ -12130,6 +12220,8 @@ int MYSQL_BIN_LOG::ordered_commit(THD *thd, bool all, bool skip_commit) {
     check_and_register_log_entities(thd);
   }
 
+  auto stage_start_time = my_timer_now();
+  ulonglong sync_queue_length = 0, sync_usec = 0;
   THD *wait_queue = nullptr, *final_queue = nullptr;
   mysql_mutex_t *leave_mutex_before_commit_stage = nullptr;
   my_off_t flush_end_pos = 0;
@@ -12200,6 +12292,8 @@ int MYSQL_BIN_LOG::ordered_commit(THD *thd, bool all, bool skip_commit) {
             : nullptr);
   }
 
+  latency_histogram_increment(&histogram_binlog_flush_stage,
+                              my_timer_since(stage_start_time), 1);
   DEBUG_SYNC(thd, "bgc_after_flush_stage_before_sync_stage");
 
   /*
@@ -12212,6 +12306,7 @@ int MYSQL_BIN_LOG::ordered_commit(THD *thd, bool all, bool skip_commit) {
                           thd->commit_error));
     return finish_commit(thd);
   }
+  stage_start_time = my_timer_now();
 
   /*
     Shall introduce a delay only if it is going to do sync
@@ -12224,15 +12319,23 @@ int MYSQL_BIN_LOG::ordered_commit(THD *thd, bool all, bool skip_commit) {
   if (!flush_error && (sync_counter + 1 >= get_sync_period()))
     Commit_stage_manager::get_instance().wait_count_or_timeout(
         opt_binlog_group_commit_sync_no_delay_count,
-        opt_binlog_group_commit_sync_delay, Commit_stage_manager::SYNC_STAGE);
+        Commit_stage_manager::get_instance().sync_delay(),
+        Commit_stage_manager::SYNC_STAGE);
 
   final_queue = Commit_stage_manager::get_instance().fetch_queue_acquire_lock(
       Commit_stage_manager::SYNC_STAGE);
+  sync_queue_length = queue_length(final_queue);
+  counter_histogram_increment(&histogram_binlog_sync_stage_queue,
+                              sync_queue_length);
 
   if (flush_error == 0 && total_bytes > 0) {
     DEBUG_SYNC(thd, "before_sync_binlog_file");
+    const auto sync_start_time = my_timer_now();
     std::pair<bool, bool> result = sync_binlog_file(false);
     sync_error = result.first;
+    if (result.second)
+      sync_usec = my_timer_to_microseconds_ulonglong(
+          my_timer_since(sync_start_time));
 
     /*
       If we are going to abort on binlog error, then abort immediately instead
@@ -12267,6 +12370,12 @@ int MYSQL_BIN_LOG::ordered_commit(THD *thd, bool all, bool skip_commit) {
     }
   }
 
+  if (opt_binlog_group_commit_sync_delay_adaptive)
+    Commit_stage_manager::get_instance().update_sync_delay(sync_queue_length,
+                                                           sync_usec);
+
+  latency_histogram_increment(&histogram_binlog_sync_stage,
+                              my_timer_since(stage_start_time), 1);
   DEBUG_SYNC(thd, "bgc_after_sync_stage_before_commit_stage");
 
   leave_mutex_before_commit_stage = &LOCK_sync;
@@ -12297,9 +12406,12 @@ commit_stage:
                             thd->commit_error));
       return finish_commit(thd);
     }
+    stage_start_time = my_timer_now();
     THD *commit_queue =
         Commit_stage_manager::get_instance().fetch_queue_acquire_lock(
             Commit_stage_manager::COMMIT_STAGE);
+    counter_histogram_increment(&histogram_binlog_commit_stage_queue,
+                                queue_length(commit_queue));
     DBUG_EXECUTE_IF("semi_sync_3-way_deadlock",
                     DEBUG_SYNC(thd, "before_process_commit_stage_queue"););
 
@@ -12344,6 +12456,8 @@ commit_stage:
      */
     latency_histogram_increment(&histogram_binlog_engine_commit_trx,
                                 engine_commit_time, 1);
+    latency_histogram_increment(&histogram_binlog_commit_stage,
+                                my_timer_since(stage_start_time), 1);
   } else {
     if (leave_mutex_before_commit_stage)
       mysql_mutex_unlock(leave_mutex_before_commit_stage);
@@ -15315,7 +15429,8 @@ int THD::binlog_write_row(TABLE *table, bool is_trans, uchar const *record,
   const bool row_image_delta_enabled = binlog_row_image_delta_enabled();
 
   size_t const len = pack_row(table, table->write_set, row_data, record,
-                              enum_row_image_type::WRITE_AI, 0,
+                              enum_row_image_type::WRITE_AI,
+                              variables.binlog_row_value_options,
                               row_image_delta_enabled ? &field_sizes : nullptr);
 
   if (row_image_delta_enabled) {
@@ -15365,7 +15480,8 @@ int THD::binlog_update_row(TABLE *table, bool is_trans,
 
   size_t const before_size =
       pack_row(table, table->read_set, before_row, before_record,
-               enum_row_image_type::UPDATE_BI, 0,
+               enum_row_image_type::UPDATE_BI,
+               variables.binlog_row_value_options,
                row_image_delta_enabled ? &before_field_sizes : nullptr);
 
   size_t const after_size = pack_row(
@@ -15448,7 +15564,8 @@ int THD::binlog_delete_row(TABLE *table, bool is_trans, uchar const *record,
   const bool row_image_delta_enabled = binlog_row_image_delta_enabled();
 
   size_t const len = pack_row(table, table->read_set, row_data, record,
-                              enum_row_image_type::DELETE_BI, 0,
+                              enum_row_image_type::DELETE_BI,
+                              variables.binlog_row_value_options,
                               row_image_delta_enabled ? &field_sizes : nullptr);
 
   if (row_image_delta_enabled) {
@@ -15470,6 +15587,15 @@ int THD::binlog_delete_row(TABLE *table, bool is_trans, uchar const *record,
   return error;
 }
 
+/**
+  Whether binlog_row_image=NOBLOB leaves the column out of the row images
+  when it can: BLOB and TEXT columns, and JSON vectors, which are as large.
+*/
+static bool is_noblob_field(const Field *field) {
+  return field->type() == MYSQL_TYPE_BLOB ||
+         (field->type() == MYSQL_TYPE_JSON && field->m_fb_vector_dimension > 0);
+}
+
 void binlog_prepare_row_images(const THD *thd, TABLE *table, bool is_update) {
   DBUG_TRACE;
   /**
@@ -15512,8 +15638,7 @@ void binlog_prepare_row_images(const THD *thd, TABLE *table, bool is_update) {
         bitmap_union(&table->tmp_set, table->read_set);
         for (Field **ptr = table->field; *ptr; ptr++) {
           Field *field = (*ptr);
-          if ((field->type() == MYSQL_TYPE_BLOB) &&
-              !field->is_flag_set(PRI_KEY_FLAG))
+          if (is_noblob_field(field) && !field->is_flag_set(PRI_KEY_FLAG))
             bitmap_clear_bit(&table->tmp_set, field->field_index());
         }
         break;
@@ -15542,7 +15667,7 @@ void binlog_prepare_row_images(const THD *thd, TABLE *table, bool is_update) {
       if (bitmap_is_set(&table->tmp_write_set, field->field_index())) {
         /* When image type is NOBLOB, we prune only BLOB fields */
         if (thd->variables.binlog_row_image == BINLOG_ROW_IMAGE_NOBLOB &&
-            field->type() != MYSQL_TYPE_BLOB)
+            !is_noblob_field(field))
           continue;
 
         /* compare null bit */
@@ -121,6 +121,14 @@ extern latency_histogram histogram_binlog_fsync;
 extern counter_histogram histogram_binlog_group_commit;
 extern latency_histogram histogram_binlog_group_commit_trx;
 extern latency_histogram histogram_binlog_engine_commit_trx;
+extern latency_histogram histogram_binlog_engine_prepare_trx;
+/* The time the leader of each stage of the group commit spends in it */
+extern latency_histogram histogram_binlog_flush_stage;
+extern latency_histogram histogram_binlog_sync_stage;
+extern latency_histogram histogram_binlog_commit_stage;
+/* The transactions the leader of each later stage takes from its queue */
+extern counter_histogram histogram_binlog_sync_stage_queue;
+extern counter_histogram histogram_binlog_commit_stage_queue;
 
 /* The enum defining the server's action when a trx fails inside ordered commit
  * due to an error related to consensus (raft plugin) */
@@ -751,6 +759,13 @@ class MYSQL_BIN_LOG : public TC_LOG {
   */
   binary_log::enum_binlog_checksum_alg relay_log_checksum_alg;
 
+  /*
+    The compression dictionaries of the master's binlog file being relayed.
+    They are written at the head of each relay log file, so that the applier
+    can start reading from any of them. Protected by LOCK_log.
+  */
+  std::vector<std::string> relay_log_compression_dictionaries;
+
   MYSQL_BIN_LOG(uint *sync_period, bool relay_log = false);
   ~MYSQL_BIN_LOG() override;
 
@@ -1830,6 +1845,14 @@ class MYSQL_BIN_LOG : public TC_LOG {
                              opt_histogram_binlog_commit_time_step_size);
       latency_histogram_init(&histogram_binlog_group_commit_trx,
                              opt_histogram_binlog_commit_time_step_size);
+      latency_histogram_init(&histogram_binlog_engine_prepare_trx,
+                             opt_histogram_binlog_commit_time_step_size);
+      latency_histogram_init(&histogram_binlog_flush_stage,
+                             opt_histogram_binlog_commit_time_step_size);
+      latency_histogram_init(&histogram_binlog_sync_stage,
+                             opt_histogram_binlog_commit_time_step_size);
+      latency_histogram_init(&histogram_binlog_commit_stage,
+                             opt_histogram_binlog_commit_time_step_size);
     }
     mysql_mutex_unlock(&LOCK_log);
   }
@@ -1864,6 +1887,10 @@ class MYSQL_BIN_LOG : public TC_LOG {
     mysql_mutex_lock(&LOCK_log);
     counter_histogram_init(&histogram_binlog_group_commit,
                            opt_histogram_step_size_binlog_group_commit);
+    counter_histogram_init(&histogram_binlog_sync_stage_queue,
+                           opt_histogram_step_size_binlog_group_commit);
+    counter_histogram_init(&histogram_binlog_commit_stage_queue,
+                           opt_histogram_step_size_binlog_group_commit);
     mysql_mutex_unlock(&LOCK_log);
   }
 
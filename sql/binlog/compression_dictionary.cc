@@ -0,0 +1,87 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/binlog/compression_dictionary.h"
+
+#include <utility>
+
+bool opt_binlog_trx_compression_dictionary;
+
+namespace binlog {
+
+Compression_dictionary compression_dictionary;
+
+void Compression_dictionary::add_sample(const std::string &sample,
+                                        int compression_level) {
+  std::string samples;
+  std::vector<std::size_t> sample_sizes;
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    if (!m_sampling.load() || sample.empty()) return;
+    m_samples.append(sample);
+    m_sample_sizes.push_back(sample.size());
+    if (m_samples.size() < SAMPLES_SIZE) return;
+    m_sampling = false;
+    samples.swap(m_samples);
+    sample_sizes.swap(m_sample_sizes);
+  }
+
+  // train without the lock, sessions compress meanwhile
+  auto trained =
+      Zstd_dictionary::train(samples, sample_sizes, compression_level);
+
+  std::lock_guard<std::mutex> guard(m_lock);
+  if (trained != nullptr)
+    m_trained = std::move(trained);
+  else
+    m_sampling = true;  // too few distinct samples, sample again
+}
+
+std::vector<std::shared_ptr<Compression_dictionary::Zstd_dictionary>>
+Compression_dictionary::rotate() {
+  std::lock_guard<std::mutex> guard(m_lock);
+  if (!opt_binlog_trx_compression_dictionary) {
+    m_trained.reset();
+    m_current.reset();
+    m_previous.reset();
+    m_samples.clear();
+    m_sample_sizes.clear();
+    m_sampling = true;
+    return {};
+  }
+
+  if (m_trained != nullptr) {
+    m_previous = std::move(m_current);
+    m_current = std::move(m_trained);
+    m_sampling = true;
+    // for the readers of the log in this process
+    Zstd_dictionary::add(m_current);
+  }
+
+  std::vector<std::shared_ptr<Zstd_dictionary>> in_use;
+  if (m_current != nullptr) in_use.push_back(m_current);
+  if (m_previous != nullptr) in_use.push_back(m_previous);
+  return in_use;
+}
+
+std::shared_ptr<const Compression_dictionary::Zstd_dictionary>
+Compression_dictionary::current() {
+  if (!opt_binlog_trx_compression_dictionary) return nullptr;
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_current;
+}
+
+}  // namespace binlog
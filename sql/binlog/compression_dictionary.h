@@ -0,0 +1,98 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "libbinlogevents/include/compression/zstd.h"
+
+/// Whether transaction payloads are compressed with a dictionary trained on
+/// the payloads of the binary log.
+extern bool opt_binlog_trx_compression_dictionary;
+
+namespace binlog {
+
+/**
+  The ZSTD dictionary the transaction payloads of the binary log are
+  compressed with.
+
+  Payloads are sampled as they are compressed, and once enough of them were
+  the session adding the last sample trains a dictionary on them, so that
+  commits are not held while the log is rotated. The next file of the log
+  is compressed with it, and carries it in the Metadata_log_event at its
+  head along with the dictionary of the file before, which payloads
+  compressed before the rotation but written after it use. Sampling then
+  starts again, and a file rotated before the next dictionary is trained
+  keeps the one it has.
+*/
+class Compression_dictionary {
+ public:
+  using Zstd_dictionary = binary_log::transaction::compression::Zstd_dictionary;
+
+  /// The most bytes sampled from one payload.
+  static constexpr std::size_t MAX_SAMPLE_SIZE = 16 * 1024;
+  /// The bytes sampled to train a dictionary on.
+  static constexpr std::size_t SAMPLES_SIZE = 32 * Zstd_dictionary::MAX_SIZE;
+
+  /// Whether payloads are sampled.
+  bool is_sampling() const {
+    return opt_binlog_trx_compression_dictionary && m_sampling.load();
+  }
+
+  /**
+    Keep the sample of a payload, and train a dictionary once there are
+    enough of them.
+
+    @param sample the first bytes of the payload, at most MAX_SAMPLE_SIZE
+    @param compression_level the level the dictionary is made for
+  */
+  void add_sample(const std::string &sample, int compression_level);
+
+  /**
+    Make the dictionary trained since the last rotation the one payloads are
+    compressed with, as a new file of the log is opened.
+
+    @return the dictionaries the head of the new file carries
+  */
+  std::vector<std::shared_ptr<Zstd_dictionary>> rotate();
+
+  /// The dictionary to compress payloads with, nullptr if none.
+  std::shared_ptr<const Zstd_dictionary> current();
+
+ private:
+  std::mutex m_lock;
+  std::atomic<bool> m_sampling{true};
+  /// The samples, one after the other. Guarded by m_lock.
+  std::string m_samples;
+  /// The size of each sample. Guarded by m_lock.
+  std::vector<std::size_t> m_sample_sizes;
+  /// The dictionary trained for the next file. Guarded by m_lock.
+  std::shared_ptr<Zstd_dictionary> m_trained;
+  /// The dictionaries of the current file and the one before it. Guarded
+  /// by m_lock.
+  std::shared_ptr<Zstd_dictionary> m_current;
+  std::shared_ptr<Zstd_dictionary> m_previous;
+};
+
+extern Compression_dictionary compression_dictionary;
+
+}  // namespace binlog
@@ -0,0 +1,131 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/binlog/event_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include "libbinlogevents/include/binlog_event.h"
+#include "my_byteorder.h"
+
+ulonglong opt_binlog_event_cache_size;
+
+namespace binlog {
+
+Event_cache event_cache;
+
+uint64_t Event_cache::open(const char *file_name, my_off_t position) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_generation.store(0);
+  m_file_name.clear();
+  if (opt_binlog_event_cache_size == 0) return 0;
+
+  // the size is read only, the ring is allocated once
+  if (m_ring == nullptr) {
+    m_ring.reset(new (std::nothrow) unsigned char[opt_binlog_event_cache_size]);
+    if (m_ring == nullptr) return 0;
+    m_size = opt_binlog_event_cache_size;
+  }
+
+  m_begin.store(position);
+  m_end.store(position);
+  m_file_name = file_name;
+  m_generation.store(++m_last_generation);
+  return m_last_generation;
+}
+
+void Event_cache::close(uint64_t generation) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  if (generation == 0 || m_generation.load() != generation) return;
+  m_generation.store(0);
+  m_file_name.clear();
+}
+
+void Event_cache::append(uint64_t generation, const unsigned char *data,
+                         my_off_t length) {
+  if (generation == 0 ||
+      m_generation.load(std::memory_order_relaxed) != generation)
+    return;
+
+  const my_off_t end = m_end.load(std::memory_order_relaxed) + length;
+  if (length > m_size) {
+    data += length - m_size;
+    length = m_size;
+  }
+  // the bytes overwritten leave the ring before they are
+  if (end - m_begin.load(std::memory_order_relaxed) > m_size)
+    m_begin.store(end - m_size, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  const my_off_t at = (end - length) % m_size;
+  const my_off_t first = std::min(length, m_size - at);
+  memcpy(m_ring.get() + at, data, first);
+  memcpy(m_ring.get(), data + first, length - first);
+  m_end.store(end, std::memory_order_release);
+}
+
+void Event_cache::truncate(uint64_t generation, my_off_t offset) {
+  if (generation == 0 ||
+      m_generation.load(std::memory_order_relaxed) != generation)
+    return;
+  if (offset < m_begin.load(std::memory_order_relaxed))
+    close(generation);
+  else if (offset < m_end.load(std::memory_order_relaxed))
+    m_end.store(offset, std::memory_order_release);
+}
+
+uint64_t Event_cache::generation(const char *file_name) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_file_name == file_name ? m_generation.load() : 0;
+}
+
+void Event_cache::copy(my_off_t position, my_off_t length,
+                       unsigned char *to) const {
+  const my_off_t at = position % m_size;
+  const my_off_t first = std::min(length, m_size - at);
+  memcpy(to, m_ring.get() + at, first);
+  memcpy(to + first, m_ring.get(), length - first);
+}
+
+bool Event_cache::event_length(uint64_t generation, my_off_t position,
+                               my_off_t end_pos, uint32_t *length) const {
+  if (generation == 0 ||
+      m_generation.load(std::memory_order_acquire) != generation)
+    return true;
+  const my_off_t end =
+      std::min(end_pos, m_end.load(std::memory_order_acquire));
+  if (position < m_begin.load(std::memory_order_acquire) ||
+      end < position + LOG_EVENT_MINIMAL_HEADER_LEN)
+    return true;
+
+  unsigned char header[LOG_EVENT_MINIMAL_HEADER_LEN];
+  copy(position, sizeof(header), header);
+  *length = uint4korr(header + EVENT_LEN_OFFSET);
+  // a header overwritten meanwhile may claim anything
+  return *length < LOG_EVENT_MINIMAL_HEADER_LEN || end - position < *length;
+}
+
+bool Event_cache::read(uint64_t generation, my_off_t position,
+                       uint32_t length, unsigned char *to) const {
+  copy(position, length, to);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return m_generation.load(std::memory_order_relaxed) != generation ||
+         m_begin.load(std::memory_order_relaxed) > position;
+}
+
+}  // namespace binlog
@@ -0,0 +1,119 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "my_inttypes.h"
+
+/// The bytes of the end of the active binary log file kept in memory for
+/// the dump threads, 0 to keep none.
+extern ulonglong opt_binlog_event_cache_size;
+
+namespace binlog {
+
+/**
+  The last bytes written to the active file of the binary log, kept in a
+  ring for the dump threads to read the events replicas are waiting for from
+  memory rather than each of them reading the file again.
+
+  The log appends to the ring as it writes the file, under LOCK_log, and
+  dump threads copy events out of it without a lock: an event is taken only
+  if it is still in the ring once copied, else the dump thread reads it from
+  the file as it does for the events of replicas lagging behind the ring.
+  Each file cached has a generation, so that an event of a file since
+  rotated, or truncated, is never taken.
+
+  Encrypted files are not cached, and neither is the log written by the
+  raft plugin, which writes the file without the log.
+*/
+class Event_cache {
+ public:
+  /**
+    Start caching a file opened for writing, dropping the file cached
+    before.
+
+    @param file_name the name of the file, as in the index
+    @param position the size of the file
+
+    @return the generation of the file, 0 if it is not cached
+  */
+  uint64_t open(const char *file_name, my_off_t position);
+
+  /// Stop caching the file of a generation, if it still is.
+  void close(uint64_t generation);
+
+  /// Append bytes written at the end of the file of a generation.
+  void append(uint64_t generation, const unsigned char *data,
+              my_off_t length);
+
+  /// Drop the bytes from the offset on, as the file of a generation was
+  /// truncated to it.
+  void truncate(uint64_t generation, my_off_t offset);
+
+  /// The generation of a file if it is the one cached, else 0.
+  uint64_t generation(const char *file_name);
+
+  /**
+    The length of the event at a position of the file of a generation, as
+    far as it is in the ring. The length is to be trusted only once read()
+    took the event.
+
+    @param generation the generation of the file
+    @param position the position of the event
+    @param end_pos the end of what the log has flushed of the file
+    @param[out] length the length of the event
+
+    @retval false the event is in the ring
+    @retval true the event is not
+  */
+  bool event_length(uint64_t generation, my_off_t position, my_off_t end_pos,
+                    uint32_t *length) const;
+
+  /**
+    Copy an event out of the ring.
+
+    @retval false the event was copied
+    @retval true it left the ring meanwhile, and what was copied is garbage
+  */
+  bool read(uint64_t generation, my_off_t position, uint32_t length,
+            unsigned char *to) const;
+
+ private:
+  /// Copy bytes from the ring, which holds them at the position.
+  void copy(my_off_t position, my_off_t length, unsigned char *to) const;
+
+  /// Guards the allocation of the ring, m_file_name and m_last_generation.
+  std::mutex m_lock;
+  std::unique_ptr<unsigned char[]> m_ring;
+  my_off_t m_size = 0;
+  std::string m_file_name;
+  uint64_t m_last_generation = 0;
+  /// The generation of the file cached, 0 if none.
+  std::atomic<uint64_t> m_generation{0};
+  /// The positions in the file of the bytes in the ring.
+  std::atomic<my_off_t> m_begin{0};
+  std::atomic<my_off_t> m_end{0};
+};
+
+extern Event_cache event_cache;
+
+}  // namespace binlog
@@ -379,6 +379,9 @@ class Basic_binlog_file_reader {
       Previous_gtid_event
       [Rotate_event]           : In the case rotating relaylog, no Rotate here
       Format_description_event : master's Format_description_event
+
+      Metadata_events of the head are read too, decoding them adds the
+      compression dictionaries the transaction payloads of the file need.
     */
     while (position() < offset) {
       m_event_start_pos = position();
@@ -395,7 +398,8 @@ class Basic_binlog_file_reader {
         binary_log::Log_event_type type = ev->get_type_code();
         delete ev;
         if (type != binary_log::PREVIOUS_GTIDS_LOG_EVENT &&
-            type != binary_log::ROTATE_EVENT)
+            type != binary_log::ROTATE_EVENT &&
+            type != binary_log::METADATA_EVENT)
           break;
       }
     }
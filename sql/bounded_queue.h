@@ -23,6 +23,8 @@
 #ifndef BOUNDED_QUEUE_INCLUDED
 #define BOUNDED_QUEUE_INCLUDED
 
+#include <string.h>
+
 #include "my_base.h"
 #include "my_sys.h"
 #include "mysys_err.h"
@@ -131,6 +133,40 @@ class Bounded_queue {
     }
   }
 
+  /**
+    Whether the queue holds as many elements as it can, so that the next
+    push() replaces top().
+   */
+  bool is_full() const { return m_queue.size() == m_queue.capacity(); }
+
+  /**
+    The element ordered last in the queue.
+   */
+  const Key_type &top() const { return m_queue.top(); }
+
+  /**
+    Replaces top() of a full queue with an element whose key is made already.
+    The first key_length bytes of key are copied to the element, and
+    m_sort_param::make_sortkey_payload() generates the rest of it.
+
+    @param key        The key generated for the element.
+    @param key_length The length of the key.
+    @param opaque     Parameter to send on to make_sortkey_payload().
+   */
+  template <class Opaque>
+  void replace_top(const uchar *key, uint key_length, const Opaque &opaque) {
+    assert(is_full());
+    assert(key_length <= m_element_size);
+    const uint element_size = m_element_size + 1;
+    const Key_type &pq_top = m_queue.top();
+    memcpy(pq_top, key, key_length);
+    [[maybe_unused]] const uint rec_sz = m_sort_param->make_sortkey_payload(
+        pq_top, element_size, key_length, opaque);
+    // UINT_MAX means error, see push().
+    assert(rec_sz <= m_element_size || rec_sz == UINT_MAX);
+    m_queue.update_top();
+  }
+
   /**
     The number of elements in the queue.
    */
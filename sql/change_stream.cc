@@ -0,0 +1,233 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/change_stream.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include "my_bitmap.h"
+#include "mysql/psi/mysql_rwlock.h"
+#include "sql/field.h"
+#include "sql/handler.h"
+#include "sql/sql_class.h"
+#include "sql/table.h"
+#include "sql_string.h"
+
+ulong change_stream_max_rows;
+std::atomic<uint> change_stream_subscriber_count{0};
+
+using Table_key = std::pair<std::string, std::string>;
+
+/// The rows a transaction captured so far, by table.
+struct Change_stream_trans {
+  struct Pending {
+    std::shared_ptr<Change_stream_batch> batch;
+    /// Rows of the batch kept by the statements that ended.
+    size_t stmt_rows = 0;
+  };
+  std::map<Table_key, Pending> tables;
+};
+
+namespace {
+
+/**
+  Taken shared to deliver, exclusively to change the subscriptions, so that
+  a subscriber is never called once it unsubscribed.
+*/
+mysql_rwlock_t LOCK_change_stream;
+bool change_stream_inited = false;
+
+// Guarded by LOCK_change_stream.
+std::map<Table_key, std::vector<Change_stream_subscriber *>> subscribers;
+std::map<Change_stream_subscriber *, std::vector<Table_key>> subscriptions;
+
+std::atomic<ulonglong> registry_version{1};
+
+/// Whether the table is followed, looked up once per version of the
+/// subscriptions.
+bool followed(TABLE *table) {
+  if (table->s->tmp_table != NO_TMP_TABLE) return false;
+  const ulonglong version = registry_version.load();
+  if (table->cs_registry_version == version) return table->cs_followed;
+
+  const Table_key key(table->s->db.str, table->s->table_name.str);
+  mysql_rwlock_rdlock(&LOCK_change_stream);
+  table->cs_followed = subscribers.count(key) != 0;
+  mysql_rwlock_unlock(&LOCK_change_stream);
+  table->cs_registry_version = version;
+  return table->cs_followed;
+}
+
+Change_stream_trans::Pending *pending_rows(THD *thd, const char *db,
+                                           const char *table_name) {
+  if (thd->cs_trans == nullptr) thd->cs_trans = new Change_stream_trans();
+  Change_stream_trans::Pending &pending =
+      thd->cs_trans->tables[Table_key(db, table_name)];
+  if (pending.batch == nullptr) {
+    pending.batch = std::make_shared<Change_stream_batch>();
+    pending.batch->db = db;
+    pending.batch->table_name = table_name;
+  }
+  return &pending;
+}
+
+void decode(TABLE *table, const uchar *record, Change_stream_image *image) {
+  const ptrdiff_t offset = record - table->record[0];
+  String str;
+  for (Field **field_ptr = table->field; *field_ptr != nullptr; field_ptr++) {
+    Field *field = *field_ptr;
+    if (field->is_hidden_by_system()) continue;
+    if (field->is_null(offset)) {
+      image->values.emplace_back();
+      image->nulls.push_back(true);
+      continue;
+    }
+    field->move_field_offset(offset);
+    const String *value = field->val_str(&str);
+    field->move_field_offset(-offset);
+    image->values.emplace_back(value->ptr(), value->length());
+    image->nulls.push_back(false);
+  }
+}
+
+}  // namespace
+
+void change_stream_init() {
+  mysql_rwlock_init(PSI_NOT_INSTRUMENTED, &LOCK_change_stream);
+  change_stream_inited = true;
+}
+
+void change_stream_deinit() {
+  if (!change_stream_inited) return;
+  subscribers.clear();
+  subscriptions.clear();
+  change_stream_subscriber_count = 0;
+  mysql_rwlock_destroy(&LOCK_change_stream);
+  change_stream_inited = false;
+}
+
+void change_stream_subscribe(Change_stream_subscriber *subscriber,
+                             const std::vector<Change_stream_table> &tables) {
+  mysql_rwlock_wrlock(&LOCK_change_stream);
+  std::vector<Table_key> &keys = subscriptions[subscriber];
+  assert(keys.empty());
+  for (const Change_stream_table &table : tables) {
+    Table_key key(table.db, table.table_name);
+    if (std::find(keys.begin(), keys.end(), key) != keys.end()) continue;
+    subscribers[key].push_back(subscriber);
+    keys.push_back(std::move(key));
+  }
+  change_stream_subscriber_count = subscriptions.size();
+  registry_version++;
+  mysql_rwlock_unlock(&LOCK_change_stream);
+}
+
+void change_stream_unsubscribe(Change_stream_subscriber *subscriber) {
+  mysql_rwlock_wrlock(&LOCK_change_stream);
+  auto it = subscriptions.find(subscriber);
+  if (it != subscriptions.end()) {
+    for (const Table_key &key : it->second) {
+      std::vector<Change_stream_subscriber *> &list = subscribers[key];
+      list.erase(std::remove(list.begin(), list.end(), subscriber),
+                 list.end());
+      if (list.empty()) subscribers.erase(key);
+    }
+    subscriptions.erase(it);
+  }
+  change_stream_subscriber_count = subscriptions.size();
+  registry_version++;
+  mysql_rwlock_unlock(&LOCK_change_stream);
+}
+
+void change_stream_capture(TABLE *table, const uchar *before,
+                           const uchar *after) {
+  if (!followed(table)) return;
+  Change_stream_trans::Pending *pending = pending_rows(
+      table->in_use, table->s->db.str, table->s->table_name.str);
+  Change_stream_batch *batch = pending->batch.get();
+  if (batch->columns.empty()) {
+    for (Field **field = table->field; *field != nullptr; field++) {
+      if (!(*field)->is_hidden_by_system())
+        batch->columns.emplace_back((*field)->field_name);
+    }
+  }
+  if (batch->rows.size() >= change_stream_max_rows) {
+    batch->rows_dropped = true;
+    return;
+  }
+
+  Change_stream_row row;
+  row.type = before == nullptr  ? Change_stream_row::Type::INSERT
+             : after == nullptr ? Change_stream_row::Type::DELETE
+                                : Change_stream_row::Type::UPDATE;
+  if (before != nullptr) decode(table, before, &row.before);
+  if (after != nullptr) decode(table, after, &row.after);
+  batch->rows.push_back(std::move(row));
+}
+
+void change_stream_capture_all(THD *thd, const char *db,
+                               const char *table_name) {
+  mysql_rwlock_rdlock(&LOCK_change_stream);
+  const bool found = subscribers.count(Table_key(db, table_name)) != 0;
+  mysql_rwlock_unlock(&LOCK_change_stream);
+  if (found) pending_rows(thd, db, table_name)->batch->emptied = true;
+}
+
+void change_stream_mark_columns(TABLE *table) {
+  if (!followed(table)) return;
+  bitmap_set_all(table->read_set);
+  table->file->column_bitmaps_signal();
+}
+
+void change_stream_end_stmt(THD *thd, bool commit) {
+  Change_stream_trans *trans = thd->cs_trans;
+  if (trans == nullptr) return;
+  for (auto &table_pending : trans->tables) {
+    Change_stream_trans::Pending &pending = table_pending.second;
+    if (commit)
+      pending.stmt_rows = pending.batch->rows.size();
+    else
+      pending.batch->rows.resize(pending.stmt_rows);
+  }
+}
+
+void change_stream_end_trans(THD *thd, bool commit) {
+  Change_stream_trans *trans = thd->cs_trans;
+  if (trans == nullptr) return;
+  thd->cs_trans = nullptr;
+  if (commit && change_streams_exist()) {
+    // the batches of each subscriber, sharing the rows
+    std::map<Change_stream_subscriber *, std::vector<Change_stream_batch_ptr>>
+        deliveries;
+    mysql_rwlock_rdlock(&LOCK_change_stream);
+    for (auto &table_pending : trans->tables) {
+      const Change_stream_batch_ptr batch =
+          std::move(table_pending.second.batch);
+      if (batch->rows.empty() && !batch->rows_dropped && !batch->emptied)
+        continue;
+      auto it = subscribers.find(table_pending.first);
+      if (it == subscribers.end()) continue;
+      for (Change_stream_subscriber *subscriber : it->second)
+        deliveries[subscriber].push_back(batch);
+    }
+    for (auto &subscriber_batches : deliveries)
+      subscriber_batches.first->deliver(subscriber_batches.second);
+    mysql_rwlock_unlock(&LOCK_change_stream);
+  }
+  delete trans;
+}
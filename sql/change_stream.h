@@ -0,0 +1,144 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+/**
+  @file
+  In-process stream of committed row changes.
+
+  A subscriber names the tables it follows and is handed, right after each
+  transaction changing them commits, the rows the transaction inserted,
+  updated and deleted in them, table by table. Nothing is read back from
+  the tables or the binary log: the images of the rows are captured as the
+  handler writes them, the ones of tables nobody follows being skipped at
+  the cost of a version check, and kept with the transaction until it
+  ends. A statement rolled back takes its rows out; a transaction rolled
+  back delivers nothing.
+
+  A row is decoded once, into the text of its column values, however many
+  subscribers follow its table: they share the batches of a transaction.
+  A transaction delivers at most change_stream_max_rows rows of a table;
+  beyond, its batch only tells that more rows changed.
+
+  Subscribers are called in the committing session, right after its
+  transaction went through the commit pipeline, so they must only queue
+  the batches for later.
+*/
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "my_inttypes.h"
+
+class THD;
+struct TABLE;
+
+/// Most rows of a table a transaction delivers to subscribers.
+extern ulong change_stream_max_rows;
+
+/// The values of the columns of a row, as text, in the order of the
+/// columns of its batch.
+struct Change_stream_image {
+  std::vector<std::string> values;
+  std::vector<bool> nulls;
+
+  bool empty() const { return values.empty(); }
+};
+
+struct Change_stream_row {
+  enum class Type { INSERT, UPDATE, DELETE };
+  Type type;
+  /// The row before the change, empty for an INSERT.
+  Change_stream_image before;
+  /// The row after the change, empty for a DELETE.
+  Change_stream_image after;
+};
+
+/// The rows a transaction changed in a table.
+struct Change_stream_batch {
+  std::string db;
+  std::string table_name;
+  /// Visible columns of the table.
+  std::vector<std::string> columns;
+  std::vector<Change_stream_row> rows;
+  /// More rows changed than were captured.
+  bool rows_dropped = false;
+  /// All rows of the table were deleted at once, e.g. by TRUNCATE.
+  bool emptied = false;
+};
+
+using Change_stream_batch_ptr = std::shared_ptr<const Change_stream_batch>;
+
+class Change_stream_subscriber {
+ public:
+  virtual ~Change_stream_subscriber() = default;
+
+  /// The batches of a committed transaction for the tables followed.
+  virtual void deliver(const std::vector<Change_stream_batch_ptr> &batches) = 0;
+};
+
+/// A table followed by a subscriber.
+struct Change_stream_table {
+  std::string db;
+  std::string table_name;
+};
+
+void change_stream_init();
+void change_stream_deinit();
+
+/**
+  Have a subscriber delivered the changes of tables from the next
+  transaction committing on. A subscriber is subscribed once.
+*/
+void change_stream_subscribe(Change_stream_subscriber *subscriber,
+                             const std::vector<Change_stream_table> &tables);
+
+/// Stop delivering to a subscriber, once no delivery to it is running.
+void change_stream_unsubscribe(Change_stream_subscriber *subscriber);
+
+extern std::atomic<uint> change_stream_subscriber_count;
+
+/// Whether any table is followed, before capturing rows.
+inline bool change_streams_exist() {
+  return change_stream_subscriber_count.load(std::memory_order_relaxed) != 0;
+}
+
+/**
+  Capture a row the handler wrote, updated or deleted, if its table is
+  followed.
+  @param before the row before the change, nullptr for an insert
+  @param after the row after the change, nullptr for a delete
+*/
+void change_stream_capture(TABLE *table, const uchar *before,
+                           const uchar *after);
+
+/// Capture that all rows of a table were deleted at once.
+void change_stream_capture_all(THD *thd, const char *db,
+                               const char *table_name);
+
+/// Have all columns of a followed table read along with the rows a
+/// statement updates or deletes, for their images.
+void change_stream_mark_columns(TABLE *table);
+
+/// Keep the rows captured by a statement, or take them out.
+void change_stream_end_stmt(THD *thd, bool commit);
+
+/// Deliver the rows a transaction captured once it committed, or drop
+/// them.
+void change_stream_end_trans(THD *thd, bool commit);
@@ -25,6 +25,7 @@
 #ifndef CONNECTION_HANDLER_IMPL_INCLUDED
 #define CONNECTION_HANDLER_IMPL_INCLUDED
 
+#include <atomic>
 #include <list>
 
 #include "mysql/psi/mysql_cond.h"                 // mysql_cond_t
@@ -118,4 +119,53 @@ class One_thread_connection_handler : public Connection_handler {
   uint get_max_threads() const override { return 1; }
 };
 
+/**
+  This class represents the connection handling functionality of
+  connections sharing a pool of worker threads.
+
+  Connections are spread over groups of workers. A connection waiting for
+  a command is on the epoll set of its group, and a worker of the group
+  waits on the set to queue the connections with a command to run, which
+  the other workers of the group take. A group runs as many commands at
+  once as oversubscribe allows, and workers waiting on a lock or IO make
+  room for others; a timer thread lets a group whose commands make no
+  progress run one more. A commit whose engine defers the sync of its log
+  leaves its OK packet to a completion thread, which syncs once for all
+  the commits queued, and the worker takes the next command meanwhile.
+*/
+class Thread_pool_connection_handler : public Connection_handler {
+  Thread_pool_connection_handler(const Thread_pool_connection_handler &);
+  Thread_pool_connection_handler &operator=(
+      const Thread_pool_connection_handler &);
+
+  Thread_pool_connection_handler() = default;
+
+  static void destroy();
+
+  /// The group of the next connection.
+  std::atomic<uint> m_next_group{0};
+
+ public:
+  // System variables
+  static uint group_count;
+  static uint oversubscribe;
+  /// Milliseconds a group may not take a command before it is stalled.
+  static uint stall_limit;
+  static uint max_threads_per_group;
+
+  /**
+    Create the handler and its groups of workers.
+
+    @return the handler, nullptr on error
+  */
+  static Thread_pool_connection_handler *create();
+
+  ~Thread_pool_connection_handler() override;
+
+ protected:
+  bool add_connection(Channel_info *channel_info) override;
+
+  uint get_max_threads() const override;
+};
+
 #endif  // CONNECTION_HANDLER_IMPL_INCLUDED
@@ -175,6 +175,9 @@ bool Connection_handler_manager::init() {
     case SCHEDULER_NO_THREADS:
       connection_handler = new (std::nothrow) One_thread_connection_handler();
       break;
+    case SCHEDULER_THREAD_POOL:
+      connection_handler = Thread_pool_connection_handler::create();
+      break;
     default:
       assert(false);
   }
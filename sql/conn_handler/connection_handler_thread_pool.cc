@@ -0,0 +1,697 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <deque>
+#include <new>
+#include <unordered_set>
+#include <vector>
+
+#include "my_dbug.h"
+#include "my_systime.h"  // my_micro_time
+#include "my_thread.h"
+#include "mysql/components/services/log_builtins.h"
+#include "mysql/psi/mysql_cond.h"
+#include "mysql/psi/mysql_mutex.h"
+#include "mysql/psi/mysql_socket.h"
+#include "mysql/psi/mysql_thread.h"
+#include "mysqld_error.h"                   // ER_*
+#include "sql/conn_handler/channel_info.h"  // Channel_info
+#include "sql/conn_handler/connection_handler_impl.h"
+#include "sql/conn_handler/connection_handler_manager.h"  // Connection_handler_manager
+#include "sql/mysqld.h"                // connection_attrib
+#include "sql/mysqld_thd_manager.h"    // Global_THD_manager
+#include "sql/protocol_classic.h"
+#include "sql/sql_class.h"             // THD
+#include "sql/sql_connect.h"           // close_connection
+#include "sql/sql_parse.h"             // do_command
+#include "sql/sql_thd_internal_api.h"  // thd_set_thread_stack
+#include "violite.h"
+
+uint Thread_pool_connection_handler::group_count = 16;
+uint Thread_pool_connection_handler::oversubscribe = 3;
+uint Thread_pool_connection_handler::stall_limit = 500;
+uint Thread_pool_connection_handler::max_threads_per_group = 1000;
+
+namespace {
+
+/// Seconds a worker with nothing to do waits before it exits.
+constexpr int WORKER_IDLE_TIMEOUT = 60;
+/// The most events a listener takes from epoll at once.
+constexpr int MAX_EVENTS = 64;
+
+#ifdef HAVE_PSI_INTERFACE
+PSI_mutex_key key_LOCK_thread_group;
+PSI_mutex_key key_LOCK_thread_pool_timer;
+PSI_mutex_key key_LOCK_commit_ack;
+PSI_mutex_info all_thread_pool_mutexes[] = {
+    {&key_LOCK_thread_group, "Thread_group::mutex", 0, 0, PSI_DOCUMENT_ME},
+    {&key_LOCK_thread_pool_timer, "LOCK_thread_pool_timer", PSI_FLAG_SINGLETON,
+     0, PSI_DOCUMENT_ME},
+    {&key_LOCK_commit_ack, "LOCK_commit_ack", PSI_FLAG_SINGLETON, 0,
+     PSI_DOCUMENT_ME}};
+
+PSI_cond_key key_COND_thread_group;
+PSI_cond_key key_COND_thread_pool_timer;
+PSI_cond_key key_COND_commit_ack;
+PSI_cond_info all_thread_pool_conds[] = {
+    {&key_COND_thread_group, "Thread_group::cond", 0, 0, PSI_DOCUMENT_ME},
+    {&key_COND_thread_pool_timer, "COND_thread_pool_timer", PSI_FLAG_SINGLETON,
+     0, PSI_DOCUMENT_ME},
+    {&key_COND_commit_ack, "COND_commit_ack", PSI_FLAG_SINGLETON, 0,
+     PSI_DOCUMENT_ME}};
+#endif
+
+struct Thread_group;
+
+/// A connection of the pool.
+struct Pool_connection {
+  /// The channel of the connection until it is logged in.
+  Channel_info *channel_info = nullptr;
+  THD *thd = nullptr;
+  Thread_group *group = nullptr;
+  bool logged_in = false;
+  /// Whether its socket was added to the epoll set of its group.
+  bool in_epoll = false;
+  /// When it started waiting for a command, 0 while it has one. Protected
+  /// by the mutex of its group.
+  ulonglong idle_since = 0;
+};
+
+/// The connections sharing a set of workers. All members are protected by
+/// mutex.
+struct Thread_group {
+  mysql_mutex_t mutex;
+  mysql_cond_t cond;
+  int epoll_fd = -1;
+  /// The connections with a command to run, those in a transaction in
+  /// high_queue.
+  std::deque<Pool_connection *> high_queue;
+  std::deque<Pool_connection *> queue;
+  std::unordered_set<Pool_connection *> connections;
+  uint thread_count = 0;
+  /// The workers running a command and not waiting on a lock or IO.
+  uint active_count = 0;
+  /// The workers waiting for something to do.
+  uint waiting_count = 0;
+  /// Whether a worker waits on the epoll set.
+  bool has_listener = false;
+  /// The commands taken from the queues, for the timer to tell a stall.
+  ulonglong dequeued = 0;
+  ulonglong dequeued_at_last_check = 0;
+  /// The workers the timer let run over the limit, as the group stalled.
+  uint stall_extra = 0;
+  bool shutdown = false;
+};
+
+Thread_group *thread_groups = nullptr;
+/// The group of the worker running on this thread, if any.
+thread_local Thread_group *current_group = nullptr;
+
+mysql_mutex_t LOCK_thread_pool_timer;
+mysql_cond_t COND_thread_pool_timer;
+bool timer_running = false;
+bool timer_shutdown = false;
+
+/// The connections whose OK packet waits for the sync of their commit, see
+/// THD::m_commit_ack. Protected by LOCK_commit_ack, as are the flags.
+std::vector<Pool_connection *> commit_ack_queue;
+mysql_mutex_t LOCK_commit_ack;
+mysql_cond_t COND_commit_ack;
+bool commit_ack_running = false;
+bool commit_ack_shutdown = false;
+
+uint max_active_count(const Thread_group *group) {
+  return 1 + Thread_pool_connection_handler::oversubscribe +
+         group->stall_extra;
+}
+
+bool has_work(const Thread_group *group) {
+  return !group->high_queue.empty() || !group->queue.empty();
+}
+
+extern "C" void *pool_worker(void *arg);
+
+/**
+  Wake a waiting worker of a group, or start one if none waits.
+  Called with the mutex of the group.
+
+  @param group  the group
+  @param force  start a worker even if the group runs as many as allowed
+*/
+void wake_or_create_worker(Thread_group *group, bool force = false) {
+  mysql_mutex_assert_owner(&group->mutex);
+  if (group->waiting_count > 0) {
+    mysql_cond_signal(&group->cond);
+    return;
+  }
+  if (!force && group->active_count >= max_active_count(group)) return;
+  if (group->thread_count >=
+      Thread_pool_connection_handler::max_threads_per_group)
+    return;
+
+  my_thread_handle id;
+  if (mysql_thread_create(key_thread_pool_worker, &id, &connection_attrib,
+                          pool_worker, group) == 0) {
+    group->thread_count++;
+    Global_THD_manager::get_instance()->inc_thread_created();
+  }
+}
+
+/// Queue a connection with a command to run. Called with the mutex of its
+/// group.
+void enqueue(Pool_connection *connection) {
+  Thread_group *group = connection->group;
+  mysql_mutex_assert_owner(&group->mutex);
+  connection->idle_since = 0;
+  if (connection->thd != nullptr &&
+      connection->thd->in_active_multi_stmt_transaction())
+    group->high_queue.push_back(connection);
+  else
+    group->queue.push_back(connection);
+}
+
+Pool_connection *dequeue(Thread_group *group) {
+  std::deque<Pool_connection *> &queue =
+      group->high_queue.empty() ? group->queue : group->high_queue;
+  if (queue.empty()) return nullptr;
+  Pool_connection *connection = queue.front();
+  queue.pop_front();
+  return connection;
+}
+
+/**
+  Wait for a connection with a command to run, waiting on the epoll set of
+  the group if no other worker does.
+
+  @return the connection, nullptr if the worker is to exit
+*/
+Pool_connection *get_work(Thread_group *group) {
+  mysql_mutex_lock(&group->mutex);
+  for (;;) {
+    if (group->shutdown) break;
+
+    if (group->active_count < max_active_count(group)) {
+      Pool_connection *connection = dequeue(group);
+      if (connection != nullptr) {
+        group->active_count++;
+        group->dequeued++;
+        // the other connections queued need workers too
+        if (has_work(group)) wake_or_create_worker(group);
+        mysql_mutex_unlock(&group->mutex);
+        return connection;
+      }
+    }
+
+    if (!group->has_listener) {
+      group->has_listener = true;
+      mysql_mutex_unlock(&group->mutex);
+      epoll_event events[MAX_EVENTS];
+      const int count =
+          epoll_wait(group->epoll_fd, events, MAX_EVENTS,
+                     Thread_pool_connection_handler::stall_limit);
+      mysql_mutex_lock(&group->mutex);
+      group->has_listener = false;
+      for (int i = 0; i < count; i++)
+        enqueue(static_cast<Pool_connection *>(events[i].data.ptr));
+      continue;
+    }
+
+    group->waiting_count++;
+    struct timespec abstime;
+    set_timespec(&abstime, WORKER_IDLE_TIMEOUT);
+    const int error = mysql_cond_timedwait(&group->cond, &group->mutex,
+                                           &abstime);
+    group->waiting_count--;
+    // keep a worker to listen
+    if (is_timeout(error) && !has_work(group) && group->thread_count > 1)
+      break;
+  }
+  mysql_mutex_unlock(&group->mutex);
+  return nullptr;
+}
+
+/// Make the THD of a connection the one of the current thread.
+void attach_connection(Pool_connection *connection) {
+  THD *thd = connection->thd;
+  thd_set_thread_stack(thd, (char *)&thd);
+  thd->store_globals();
+#ifdef HAVE_PSI_THREAD_INTERFACE
+  PSI_THREAD_CALL(set_thread)(thd->get_psi());
+#endif
+  mysql_socket_set_thread_owner(
+      thd->get_protocol_classic()->get_vio()->mysql_socket);
+}
+
+/**
+  Create the THD of a new connection.
+
+  @retval false  the THD is attached to the current thread
+  @retval true   it could not be created, and the connection is gone
+*/
+bool init_connection(Pool_connection *connection) {
+  Channel_info *channel_info = connection->channel_info;
+  connection->channel_info = nullptr;
+
+  THD *thd = channel_info->create_thd();
+  if (thd == nullptr) {
+    connection_errors_internal++;
+    channel_info->send_error_and_close_channel(ER_OUT_OF_RESOURCES, 0, false);
+    delete channel_info;
+    Connection_handler_manager::get_instance()->inc_aborted_connects();
+    Connection_handler_manager::dec_connection_count();
+
+    Thread_group *group = connection->group;
+    mysql_mutex_lock(&group->mutex);
+    group->connections.erase(connection);
+    mysql_mutex_unlock(&group->mutex);
+    delete connection;
+    return true;
+  }
+  thd->set_new_thread_id();
+  delete channel_info;
+  connection->thd = thd;
+  thd->m_commit_ack.deferrable = true;
+
+  thd_set_thread_stack(thd, (char *)&thd);
+  thd->store_globals();
+#ifdef HAVE_PSI_THREAD_INTERFACE
+  // The instrumentation of the connection moves with it between workers.
+  PSI_thread *psi = PSI_THREAD_CALL(new_thread)(
+      key_thread_one_connection, 0 /* no sequence number */, thd,
+      thd->thread_id());
+  PSI_THREAD_CALL(set_thread_os_id)(psi);
+  PSI_THREAD_CALL(set_thread)(psi);
+  thd->set_psi(psi);
+#endif
+  mysql_thread_set_psi_id(thd->thread_id());
+  mysql_thread_set_psi_THD(thd);
+  mysql_socket_set_thread_owner(
+      thd->get_protocol_classic()->get_vio()->mysql_socket);
+#ifndef __APPLE__
+  thd->set_dscp_on_socket();
+#endif
+
+  Global_THD_manager::get_instance()->add_thd(thd);
+  return false;
+}
+
+/// Take down a connection whose THD is attached to the current thread.
+void close_pool_connection(Pool_connection *connection) {
+  THD *thd = connection->thd;
+  Thread_group *group = connection->group;
+  Vio *vio = thd->get_protocol_classic()->get_vio();
+  // the commit must still be durable once its client is gone
+  thd->complete_commit_ack();
+  if (connection->in_epoll && vio != nullptr)
+    epoll_ctl(group->epoll_fd, EPOLL_CTL_DEL,
+              mysql_socket_getfd(vio->mysql_socket), nullptr);
+
+  if (connection->logged_in) end_connection(thd);
+  close_connection(thd, 0, false, false);
+
+  thd->get_stmt_da()->reset_diagnostics_area();
+  thd->release_resources();
+  Global_THD_manager::get_instance()->remove_thd(thd);
+  Connection_handler_manager::dec_connection_count();
+
+#ifdef HAVE_PSI_THREAD_INTERFACE
+  thd->set_psi(nullptr);
+  mysql_thread_set_psi_THD(nullptr);
+#endif
+  delete thd;
+#ifdef HAVE_PSI_THREAD_INTERFACE
+  PSI_THREAD_CALL(delete_current_thread)();
+#endif
+
+  mysql_mutex_lock(&group->mutex);
+  group->connections.erase(connection);
+  mysql_mutex_unlock(&group->mutex);
+  delete connection;
+}
+
+/// Wait for the next command of a connection on the epoll set of its group.
+void wait_for_command(Pool_connection *connection) {
+  Thread_group *group = connection->group;
+  THD *thd = connection->thd;
+  const int fd =
+      mysql_socket_getfd(thd->get_protocol_classic()->get_vio()->mysql_socket);
+  const int op = connection->in_epoll ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+  connection->in_epoll = true;
+
+  mysql_mutex_lock(&group->mutex);
+  connection->idle_since = my_micro_time();
+  mysql_mutex_unlock(&group->mutex);
+
+  thd->restore_globals();
+
+  epoll_event event;
+  event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+  event.data.ptr = connection;
+  // Once armed, the connection may be taken by another worker at once.
+  if (epoll_ctl(group->epoll_fd, op, fd, &event) != 0) {
+    attach_connection(connection);
+    close_pool_connection(connection);
+  }
+}
+
+/// Log a connection in or run its commands, then leave it to wait for the
+/// next one.
+void process_connection(Pool_connection *connection) {
+  bool ended;
+  if (connection->thd == nullptr) {
+    if (init_connection(connection)) return;
+    ended = thd_prepare_connection(connection->thd);
+    if (ended)
+      Connection_handler_manager::get_instance()->inc_aborted_connects();
+    connection->logged_in = !ended;
+  } else {
+    attach_connection(connection);
+    ended = !thd_connection_alive(connection->thd) ||
+            do_command(connection->thd);
+  }
+
+  // run the commands read ahead, which epoll does not report
+  THD *thd = connection->thd;
+  Vio *vio = thd->get_protocol_classic()->get_vio();
+  while (!ended && vio->has_data != nullptr && vio->has_data(vio)) {
+    // the client sent the command before the last one was acknowledged
+    ended = thd->complete_commit_ack() || !thd_connection_alive(thd) ||
+            do_command(thd);
+  }
+
+  if (ended) {
+    close_pool_connection(connection);
+  } else if (thd->m_commit_ack.deferred) {
+    // the worker takes other commands while the commit is synced
+    thd->restore_globals();
+    mysql_mutex_lock(&LOCK_commit_ack);
+    commit_ack_queue.push_back(connection);
+    mysql_cond_signal(&COND_commit_ack);
+    mysql_mutex_unlock(&LOCK_commit_ack);
+  } else {
+    wait_for_command(connection);
+  }
+}
+
+/**
+  Sync the commits of the connections queued, once for all those queued
+  meanwhile, send their OK packets and leave them to wait for their next
+  command. The connections queued at shutdown are completed before it
+  exits.
+*/
+extern "C" void *pool_commit_ack(void *) {
+  my_thread_init();
+#ifdef HAVE_PSI_THREAD_INTERFACE
+  PSI_thread *psi = PSI_THREAD_CALL(get_thread)();
+#endif
+  std::vector<Pool_connection *> batch;
+  mysql_mutex_lock(&LOCK_commit_ack);
+  for (;;) {
+    while (commit_ack_queue.empty() && !commit_ack_shutdown)
+      mysql_cond_wait(&COND_commit_ack, &LOCK_commit_ack);
+    if (commit_ack_queue.empty()) break;
+    batch.swap(commit_ack_queue);
+    mysql_mutex_unlock(&LOCK_commit_ack);
+
+    // the first sync makes the commits of the others durable too
+    for (Pool_connection *connection : batch) {
+      attach_connection(connection);
+      if (connection->thd->complete_commit_ack())
+        close_pool_connection(connection);
+      else
+        wait_for_command(connection);
+#ifdef HAVE_PSI_THREAD_INTERFACE
+      PSI_THREAD_CALL(set_thread)(psi);
+#endif
+    }
+    batch.clear();
+    mysql_mutex_lock(&LOCK_commit_ack);
+  }
+  commit_ack_running = false;
+  mysql_cond_broadcast(&COND_commit_ack);
+  mysql_mutex_unlock(&LOCK_commit_ack);
+  my_thread_end();
+  my_thread_exit(nullptr);
+  return nullptr;
+}
+
+extern "C" void *pool_worker(void *arg) {
+  Thread_group *group = static_cast<Thread_group *>(arg);
+  if (my_thread_init()) {
+    mysql_mutex_lock(&group->mutex);
+    group->thread_count--;
+    mysql_cond_broadcast(&group->cond);
+    mysql_mutex_unlock(&group->mutex);
+    my_thread_exit(nullptr);
+    return nullptr;
+  }
+#ifdef HAVE_PSI_THREAD_INTERFACE
+  PSI_thread *worker_psi = PSI_THREAD_CALL(get_thread)();
+#endif
+  current_group = group;
+
+  for (;;) {
+    Pool_connection *connection = get_work(group);
+    if (connection == nullptr) break;
+    process_connection(connection);
+#ifdef HAVE_PSI_THREAD_INTERFACE
+    PSI_THREAD_CALL(set_thread)(worker_psi);
+#endif
+
+    mysql_mutex_lock(&group->mutex);
+    group->active_count--;
+    mysql_mutex_unlock(&group->mutex);
+  }
+
+  current_group = nullptr;
+  mysql_mutex_lock(&group->mutex);
+  group->thread_count--;
+  mysql_cond_broadcast(&group->cond);
+  mysql_mutex_unlock(&group->mutex);
+
+  my_thread_end();
+  my_thread_exit(nullptr);
+  return nullptr;
+}
+
+/**
+  Give a stalled group another worker, and close the connections waiting
+  for a command for longer than their wait_timeout.
+*/
+void check_group(Thread_group *group) {
+  const ulonglong now = my_micro_time();
+  mysql_mutex_lock(&group->mutex);
+
+  // No command was taken since the last check while some wait, or no
+  // worker listens as all are busy.
+  if ((has_work(group) || !group->has_listener) &&
+      group->dequeued == group->dequeued_at_last_check &&
+      !group->connections.empty()) {
+    group->stall_extra++;
+    wake_or_create_worker(group, true);
+  } else if (!has_work(group)) {
+    group->stall_extra = 0;
+  }
+  group->dequeued_at_last_check = group->dequeued;
+
+  for (Pool_connection *connection : group->connections) {
+    if (connection->idle_since == 0) continue;
+    THD *thd = connection->thd;
+    if (now - connection->idle_since <
+        thd->variables.net_wait_timeout * 1000000ULL)
+      continue;
+    // the worker taking the connection on the shutdown of its socket ends it
+    connection->idle_since = 0;
+    mysql_mutex_lock(&thd->LOCK_thd_data);
+    thd->awake(THD::KILL_CONNECTION);
+    mysql_mutex_unlock(&thd->LOCK_thd_data);
+  }
+  mysql_mutex_unlock(&group->mutex);
+}
+
+extern "C" void *pool_timer(void *) {
+  my_thread_init();
+  mysql_mutex_lock(&LOCK_thread_pool_timer);
+  while (!timer_shutdown) {
+    struct timespec abstime;
+    set_timespec_nsec(&abstime,
+                      Thread_pool_connection_handler::stall_limit * 1000000ULL);
+    mysql_cond_timedwait(&COND_thread_pool_timer, &LOCK_thread_pool_timer,
+                         &abstime);
+    if (timer_shutdown) break;
+    for (uint i = 0; i < Thread_pool_connection_handler::group_count; i++)
+      check_group(&thread_groups[i]);
+  }
+  timer_running = false;
+  mysql_cond_broadcast(&COND_thread_pool_timer);
+  mysql_mutex_unlock(&LOCK_thread_pool_timer);
+  my_thread_end();
+  my_thread_exit(nullptr);
+  return nullptr;
+}
+
+/*
+  A worker about to wait on a lock or IO lets another one run the commands
+  of its group meanwhile.
+*/
+void pool_wait_begin(THD *thd, int) {
+  Thread_group *group = current_group;
+  if (group == nullptr || thd == nullptr || thd != current_thd) return;
+  mysql_mutex_lock(&group->mutex);
+  group->active_count--;
+  if (has_work(group) || !group->has_listener) wake_or_create_worker(group);
+  mysql_mutex_unlock(&group->mutex);
+}
+
+void pool_wait_end(THD *thd) {
+  Thread_group *group = current_group;
+  if (group == nullptr || thd == nullptr || thd != current_thd) return;
+  mysql_mutex_lock(&group->mutex);
+  group->active_count++;
+  mysql_mutex_unlock(&group->mutex);
+}
+
+THD_event_functions thread_pool_event_functions = {pool_wait_begin,
+                                                   pool_wait_end, nullptr};
+
+}  // namespace
+
+Thread_pool_connection_handler *Thread_pool_connection_handler::create() {
+#ifdef HAVE_PSI_INTERFACE
+  int count = static_cast<int>(array_elements(all_thread_pool_mutexes));
+  mysql_mutex_register("sql", all_thread_pool_mutexes, count);
+  count = static_cast<int>(array_elements(all_thread_pool_conds));
+  mysql_cond_register("sql", all_thread_pool_conds, count);
+#endif
+
+  thread_groups = new (std::nothrow) Thread_group[group_count];
+  if (thread_groups == nullptr) return nullptr;
+  for (uint i = 0; i < group_count; i++) {
+    Thread_group *group = &thread_groups[i];
+    mysql_mutex_init(key_LOCK_thread_group, &group->mutex, MY_MUTEX_INIT_FAST);
+    mysql_cond_init(key_COND_thread_group, &group->cond);
+    group->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  }
+  mysql_mutex_init(key_LOCK_thread_pool_timer, &LOCK_thread_pool_timer,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_thread_pool_timer, &COND_thread_pool_timer);
+  mysql_mutex_init(key_LOCK_commit_ack, &LOCK_commit_ack, MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_commit_ack, &COND_commit_ack);
+
+  Thread_pool_connection_handler *handler =
+      new (std::nothrow) Thread_pool_connection_handler();
+  bool error = handler == nullptr;
+  for (uint i = 0; i < group_count && !error; i++)
+    error = thread_groups[i].epoll_fd < 0;
+
+  my_thread_handle id;
+  if (!error)
+    error = mysql_thread_create(key_thread_pool_timer, &id, &connection_attrib,
+                                pool_timer, nullptr) != 0;
+  if (!error) {
+    timer_running = true;
+    error = mysql_thread_create(key_thread_pool_commit_ack, &id,
+                                &connection_attrib, pool_commit_ack,
+                                nullptr) != 0;
+    commit_ack_running = !error;
+  }
+  if (error) {
+    LogErr(ERROR_LEVEL, ER_CONN_PER_THREAD_NO_THREAD, errno);
+    if (handler != nullptr)
+      delete handler;  // destroys the groups
+    else
+      destroy();
+    return nullptr;
+  }
+
+  Connection_handler_manager::event_functions = &thread_pool_event_functions;
+  return handler;
+}
+
+void Thread_pool_connection_handler::destroy() {
+  if (thread_groups == nullptr) return;
+
+  mysql_mutex_lock(&LOCK_thread_pool_timer);
+  timer_shutdown = true;
+  mysql_cond_broadcast(&COND_thread_pool_timer);
+  while (timer_running)
+    mysql_cond_wait(&COND_thread_pool_timer, &LOCK_thread_pool_timer);
+  mysql_mutex_unlock(&LOCK_thread_pool_timer);
+
+  mysql_mutex_lock(&LOCK_commit_ack);
+  commit_ack_shutdown = true;
+  mysql_cond_broadcast(&COND_commit_ack);
+  while (commit_ack_running)
+    mysql_cond_wait(&COND_commit_ack, &LOCK_commit_ack);
+  mysql_mutex_unlock(&LOCK_commit_ack);
+
+  // The connections are gone, wait for the workers to notice the shutdown.
+  for (uint i = 0; i < group_count; i++) {
+    Thread_group *group = &thread_groups[i];
+    mysql_mutex_lock(&group->mutex);
+    group->shutdown = true;
+    mysql_cond_broadcast(&group->cond);
+    while (group->thread_count > 0)
+      mysql_cond_wait(&group->cond, &group->mutex);
+    mysql_mutex_unlock(&group->mutex);
+    if (group->epoll_fd >= 0) close(group->epoll_fd);
+    mysql_mutex_destroy(&group->mutex);
+    mysql_cond_destroy(&group->cond);
+  }
+  delete[] thread_groups;
+  thread_groups = nullptr;
+  mysql_mutex_destroy(&LOCK_thread_pool_timer);
+  mysql_cond_destroy(&COND_thread_pool_timer);
+  mysql_mutex_destroy(&LOCK_commit_ack);
+  mysql_cond_destroy(&COND_commit_ack);
+
+  if (Connection_handler_manager::event_functions ==
+      &thread_pool_event_functions)
+    Connection_handler_manager::event_functions = nullptr;
+}
+
+Thread_pool_connection_handler::~Thread_pool_connection_handler() {
+  destroy();
+}
+
+bool Thread_pool_connection_handler::add_connection(
+    Channel_info *channel_info) {
+  DBUG_TRACE;
+
+  Pool_connection *connection = new (std::nothrow) Pool_connection();
+  if (connection == nullptr) {
+    connection_errors_internal++;
+    channel_info->send_error_and_close_channel(ER_OUT_OF_RESOURCES, 0, false);
+    Connection_handler_manager::dec_connection_count();
+    return true;
+  }
+  connection->channel_info = channel_info;
+  connection->group = &thread_groups[m_next_group++ % group_count];
+
+  Thread_group *group = connection->group;
+  mysql_mutex_lock(&group->mutex);
+  group->connections.insert(connection);
+  enqueue(connection);
+  wake_or_create_worker(group);
+  mysql_mutex_unlock(&group->mutex);
+  return false;
+}
+
+uint Thread_pool_connection_handler::get_max_threads() const {
+  return group_count * max_threads_per_group;
+}
@@ -0,0 +1,406 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/continuous_geofence.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+#include "m_ctype.h"
+#include "mysql/psi/mysql_mutex.h"
+#include "mysql/psi/mysql_rwlock.h"
+#include "sql/change_stream.h"
+#include "sql/fb_vector_distance.h"
+#include "sql/field.h"
+#include "sql/item.h"
+#include "sql/item_func.h"
+#include "sql/sql_class.h"
+#include "sql/sql_lex.h"
+#include "sql/table.h"
+#include "sql_string.h"
+#include "template_utils.h"
+
+namespace {
+
+namespace bg = boost::geometry;
+namespace bgi = boost::geometry::index;
+
+using Point = Next_spatial_query_geometry::Point;
+using Box_point = bg::model::point<double, 2, bg::cs::cartesian>;
+using Box = bg::model::box<Box_point>;
+
+struct Fence {
+  Continuous_geofence_listener *listener;
+  Continuous_geofence_spec spec;
+  Box box;
+  /// The centre of a geographic radius, measured against once.
+  Fb_spatial_query centre;
+};
+
+using Fence_rtree = bgi::rtree<std::pair<Box, Fence *>, bgi::quadratic<16>>;
+using Table_key = std::pair<std::string, std::string>;
+
+/// The geofences of a table, following its changes once for all of them.
+class Table_fences final : public Change_stream_subscriber {
+ public:
+  void deliver(const std::vector<Change_stream_batch_ptr> &batches) override;
+
+  /// The r-tree of the geofences on each point column, by SRS.
+  std::map<std::pair<std::string, uint32_t>, Fence_rtree> columns;
+  size_t fences = 0;
+};
+
+/// Taken shared to probe the geofences, exclusively to change them.
+mysql_rwlock_t LOCK_geofences;
+/// Serializes following and unfollowing tables.
+mysql_mutex_t LOCK_geofence_tables;
+bool geofences_inited = false;
+
+// Changed with both locks, read with either.
+std::map<Table_key, std::unique_ptr<Table_fences>> tables;
+std::map<Continuous_geofence_listener *, std::unique_ptr<Fence>> fences;
+
+bool is_constant_expression(Item *item) {
+  switch (item->type()) {
+    case Item::STRING_ITEM:
+    case Item::INT_ITEM:
+    case Item::DECIMAL_ITEM:
+    case Item::REAL_ITEM:
+      return true;
+    case Item::FUNC_ITEM: {
+      Item_func *func = down_cast<Item_func *>(item);
+      for (uint i = 0; i < func->argument_count(); i++)
+        if (!is_constant_expression(func->arguments()[i])) return false;
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+/// Evaluate a constant expression of the statement once; return false if
+/// successful.
+bool evaluate(THD *thd, Item *item, String *buffer, const String **value,
+              double *real) {
+  if (!is_constant_expression(item) ||
+      (!item->fixed && item->fix_fields(thd, &item)) || !item->const_item()) {
+    thd->clear_error();
+    return true;
+  }
+  if (value != nullptr) *value = item->val_str(buffer);
+  if (real != nullptr) *real = item->val_real();
+  if (thd->is_error() || item->null_value) {
+    thd->clear_error();
+    return true;
+  }
+  return false;
+}
+
+/// The point of a row, if its column holds one in the SRS of the region.
+bool image_point(const Change_stream_image &image, size_t column,
+                 uint32_t srid, Point *point) {
+  if (image.empty() || image.nulls[column]) return false;
+  Next_spatial_query_geometry geometry;
+  const std::string &value = image.values[column];
+  if (geometry.parse(value.data(), value.size()) ||
+      geometry.type() != Next_spatial_query_geometry::Type::POINT ||
+      geometry.srid() != srid)
+    return false;
+  *point = geometry.points().front();
+  return true;
+}
+
+/// Whether p lies on the segment from a to b.
+bool on_segment(const Point &p, const Point &a, const Point &b) {
+  const double cross = (b.first - a.first) * (p.second - a.second) -
+                       (b.second - a.second) * (p.first - a.first);
+  return cross == 0 && p.first >= std::min(a.first, b.first) &&
+         p.first <= std::max(a.first, b.first) &&
+         p.second >= std::min(a.second, b.second) &&
+         p.second <= std::max(a.second, b.second);
+}
+
+bool in_fence(const Fence &fence, const Point &point) {
+  const Continuous_geofence_spec &spec = fence.spec;
+  if (spec.radius >= 0) {
+    const Point &centre = spec.region.points().front();
+    const double distance =
+        spec.region.srid() == 0
+            ? std::hypot(point.first - centre.first,
+                         point.second - centre.second)
+            : fb_spatial_distance(fence.centre, point.first, point.second);
+    return spec.edge ? distance <= spec.radius : distance < spec.radius;
+  }
+
+  // even-odd over the rings, which are closed
+  bool inside = false;
+  for (const std::vector<Point> &ring : spec.region.rings()) {
+    for (size_t i = 0; i + 1 < ring.size(); i++) {
+      const Point &a = ring[i];
+      const Point &b = ring[i + 1];
+      if (on_segment(point, a, b)) return spec.edge;
+      if ((a.second > point.second) != (b.second > point.second) &&
+          point.first < (b.first - a.first) * (point.second - a.second) /
+                                (b.second - a.second) +
+                            a.first)
+        inside = !inside;
+    }
+  }
+  return inside;
+}
+
+/// A row, as "(value, ...)", its point as POINT(x y).
+std::string row_text(const Change_stream_image &image, size_t column,
+                     const Point &point) {
+  std::string out("(");
+  for (size_t i = 0; i < image.values.size(); i++) {
+    if (i > 0) out.append(", ");
+    if (i == column) {
+      char text[64];
+      snprintf(text, sizeof(text), "POINT(%.15g %.15g)", point.first,
+               point.second);
+      out.append(text);
+    } else {
+      out.append(image.nulls[i] ? std::string("NULL") : image.values[i]);
+    }
+  }
+  return out.append(")");
+}
+
+void Table_fences::deliver(
+    const std::vector<Change_stream_batch_ptr> &batches) {
+  struct Diff {
+    std::string lines;
+    size_t rows = 0;
+    void add(char sign, const std::string &row) {
+      lines.append(1, sign).append(" ").append(row).append("\n");
+      rows++;
+    }
+  };
+  std::map<Continuous_geofence_listener *, Diff> diffs;
+  std::vector<std::pair<Box, Fence *>> hits;
+  std::set<Fence *> probed;
+
+  // listeners are told under the lock, so that none is told once it is
+  // unregistered
+  mysql_rwlock_rdlock(&LOCK_geofences);
+  for (const Change_stream_batch_ptr &batch : batches) {
+    for (const auto &column_fences : columns) {
+      const uint32_t srid = column_fences.first.second;
+      const Fence_rtree &rtree = column_fences.second;
+      auto column = std::find(batch->columns.begin(), batch->columns.end(),
+                              column_fences.first.first);
+      if (column == batch->columns.end() || rtree.empty()) continue;
+      const size_t index = column - batch->columns.begin();
+
+      if (batch->emptied || batch->rows_dropped) {
+        for (const auto &box_fence : rtree)
+          diffs[box_fence.second->listener].add(
+              '!', batch->emptied ? "all rows deleted" : "more rows changed");
+      }
+      for (const Change_stream_row &row : batch->rows) {
+        Point before, after;
+        const bool has_before = image_point(row.before, index, srid, &before);
+        const bool has_after = image_point(row.after, index, srid, &after);
+        hits.clear();
+        probed.clear();
+        if (has_before)
+          rtree.query(bgi::intersects(Box_point(before.first, before.second)),
+                      std::back_inserter(hits));
+        if (has_after)
+          rtree.query(bgi::intersects(Box_point(after.first, after.second)),
+                      std::back_inserter(hits));
+
+        for (const auto &box_fence : hits) {
+          Fence *const fence = box_fence.second;
+          if (!probed.insert(fence).second) continue;
+          const bool in_before = has_before && in_fence(*fence, before);
+          const bool in_after = has_after && in_fence(*fence, after);
+          const bool changed = row.before.values != row.after.values ||
+                               row.before.nulls != row.after.nulls;
+          Diff &diff = diffs[fence->listener];
+          if (in_before && (!in_after || changed))
+            diff.add('-', row_text(row.before, index, before));
+          if (in_after && (!in_before || changed))
+            diff.add('+', row_text(row.after, index, after));
+        }
+      }
+    }
+  }
+  for (auto &listener_diff : diffs) {
+    if (listener_diff.second.rows > 0)
+      listener_diff.first->notify(listener_diff.second.lines,
+                                  listener_diff.second.rows);
+  }
+  mysql_rwlock_unlock(&LOCK_geofences);
+}
+
+}  // namespace
+
+bool continuous_geofence_match(THD *thd, TABLE *table,
+                               Continuous_geofence_spec *spec) {
+  LEX *const lex = thd->lex;
+  Query_block *const block = lex->query_block;
+  if (lex->unit->first_query_block() != block ||
+      block->next_query_block() != nullptr ||
+      block->having_cond() != nullptr || block->group_list.elements != 0 ||
+      block->has_windows() || block->is_distinct() ||
+      block->select_limit != nullptr ||
+      block->where_cond() == nullptr ||
+      block->where_cond()->type() != Item::FUNC_ITEM)
+    return false;
+
+  Item_func *const cond = down_cast<Item_func *>(block->where_cond());
+  Item_field *column = nullptr;
+  Item *geometry = nullptr;
+  Item *radius = nullptr;
+  const char *name = cond->func_name();
+  if (cond->argument_count() == 2 && (strcmp(name, "st_contains") == 0 ||
+                                      strcmp(name, "st_within") == 0 ||
+                                      strcmp(name, "st_intersects") == 0)) {
+    // the column is the contained argument, either for st_intersects
+    Item **args = cond->arguments();
+    const uint at = strcmp(name, "st_contains") == 0  ? 1
+                    : strcmp(name, "st_within") == 0 ? 0
+                    : args[0]->real_item()->type() == Item::FIELD_ITEM ? 0
+                                                                        : 1;
+    if (args[at]->real_item()->type() != Item::FIELD_ITEM) return false;
+    column = down_cast<Item_field *>(args[at]->real_item());
+    geometry = args[1 - at];
+    spec->edge = strcmp(name, "st_intersects") == 0;
+  } else if (get_next_spatial_distance_bound(cond, &column, &geometry,
+                                             &radius)) {
+    spec->edge = cond->functype() == Item_func::LE_FUNC ||
+                 cond->functype() == Item_func::GE_FUNC;
+  } else {
+    return false;
+  }
+
+  Field *field = nullptr;
+  for (Field **f = table->field; *f != nullptr; f++) {
+    if (!(*f)->is_hidden_by_system() &&
+        my_strcasecmp(system_charset_info, (*f)->field_name,
+                      column->field_name) == 0)
+      field = *f;
+  }
+  if (field == nullptr || field->type() != MYSQL_TYPE_GEOMETRY) return false;
+
+  String buffer;
+  const String *value = nullptr;
+  if (evaluate(thd, geometry, &buffer, &value, nullptr) ||
+      spec->region.parse(value->ptr(), value->length()))
+    return false;
+  if (radius != nullptr) {
+    if (spec->region.type() != Next_spatial_query_geometry::Type::POINT ||
+        evaluate(thd, radius, &buffer, nullptr, &spec->radius) ||
+        spec->radius < 0)
+      return false;
+  } else if (spec->region.type() !=
+             Next_spatial_query_geometry::Type::POLYGON) {
+    return false;
+  }
+
+  spec->db = table->s->db.str;
+  spec->table_name = table->s->table_name.str;
+  spec->column = field->field_name;
+  return true;
+}
+
+void continuous_geofence_init() {
+  mysql_rwlock_init(PSI_NOT_INSTRUMENTED, &LOCK_geofences);
+  mysql_mutex_init(PSI_NOT_INSTRUMENTED, &LOCK_geofence_tables,
+                   MY_MUTEX_INIT_FAST);
+  geofences_inited = true;
+}
+
+void continuous_geofence_deinit() {
+  if (!geofences_inited) return;
+  for (auto &key_table : tables)
+    change_stream_unsubscribe(key_table.second.get());
+  tables.clear();
+  fences.clear();
+  mysql_mutex_destroy(&LOCK_geofence_tables);
+  mysql_rwlock_destroy(&LOCK_geofences);
+  geofences_inited = false;
+}
+
+void continuous_geofence_register(Continuous_geofence_listener *listener,
+                                  const Continuous_geofence_spec &spec) {
+  auto fence = std::make_unique<Fence>();
+  fence->listener = listener;
+  fence->spec = spec;
+  const std::vector<double> mbr =
+      spec.region.mbr(std::max(spec.radius, 0.0));
+  fence->box = Box(Box_point(mbr[2], mbr[0]), Box_point(mbr[3], mbr[1]));
+  if (spec.radius >= 0 && spec.region.srid() != 0) {
+    const Point &centre = spec.region.points().front();
+    fence->centre = fb_spatial_query(centre.first, centre.second,
+                                     NEXT_SPATIAL_EARTH_RADIUS);
+  }
+
+  mysql_mutex_lock(&LOCK_geofence_tables);
+  mysql_rwlock_wrlock(&LOCK_geofences);
+  std::unique_ptr<Table_fences> &table =
+      tables[Table_key(spec.db, spec.table_name)];
+  const bool follow = table == nullptr;
+  if (follow) table = std::make_unique<Table_fences>();
+  Table_fences *const followed = table.get();
+  followed->columns[std::make_pair(spec.column, spec.region.srid())].insert(
+      std::make_pair(fence->box, fence.get()));
+  followed->fences++;
+  fences[listener] = std::move(fence);
+  mysql_rwlock_unlock(&LOCK_geofences);
+  // deliveries probe the geofences with the subscriptions locked
+  if (follow)
+    change_stream_subscribe(followed, {{spec.db, spec.table_name}});
+  mysql_mutex_unlock(&LOCK_geofence_tables);
+}
+
+void continuous_geofence_unregister(Continuous_geofence_listener *listener) {
+  std::unique_ptr<Table_fences> unfollowed;
+  mysql_mutex_lock(&LOCK_geofence_tables);
+  mysql_rwlock_wrlock(&LOCK_geofences);
+  auto it = fences.find(listener);
+  if (it != fences.end()) {
+    Fence *const fence = it->second.get();
+    auto table = tables.find(
+        Table_key(fence->spec.db, fence->spec.table_name));
+    const auto column =
+        std::make_pair(fence->spec.column, fence->spec.region.srid());
+    Fence_rtree &rtree = table->second->columns[column];
+    rtree.remove(std::make_pair(fence->box, fence));
+    if (rtree.empty()) table->second->columns.erase(column);
+    if (--table->second->fences == 0) {
+      unfollowed = std::move(table->second);
+      tables.erase(table);
+    }
+    fences.erase(it);
+  }
+  mysql_rwlock_unlock(&LOCK_geofences);
+  // a delivery running on the table ends before it is unfollowed
+  if (unfollowed != nullptr) change_stream_unsubscribe(unfollowed.get());
+  mysql_mutex_unlock(&LOCK_geofence_tables);
+}
@@ -0,0 +1,98 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+/**
+  @file
+  Geofences: ASYNC continuous queries of the rows of a table whose point
+  lies in a constant region, e.g.
+
+    SELECT * FROM vehicles
+      WHERE ST_Contains(ST_GeomFromText('POLYGON((...))', 4326), pos)
+      SYNC ASYNC
+    SELECT * FROM vehicles
+      WHERE ST_Distance(pos, ST_GeomFromText('POINT(...)', 4326)) < 500
+      SYNC ASYNC
+
+  Rather than each geofence following the changes of its table and testing
+  every changed row, the regions of the geofences of a table are kept in an
+  r-tree by their bounding boxes: the table is followed once, and each row
+  inserted, updated or deleted probes the r-tree with its point before and
+  after the change, testing only the geofences whose box holds it. So a
+  transaction costs about the same with thousands of geofences as with one.
+
+  A geofence is told of the rows entering and leaving its region as a diff,
+  a line per row, "+" or "-". Regions of a geographic SRS are tested on the
+  sphere, as by the spatial index, the edges of a polygon being straight in
+  longitude and latitude. Rows whose column holds no point are not in any
+  region.
+*/
+
+#include <string>
+
+#include "sql/next_spatial_base.h"
+
+class THD;
+struct TABLE;
+
+/// A geofence, found in the statement of an ASYNC query.
+struct Continuous_geofence_spec {
+  std::string db;
+  std::string table_name;
+  /// The point column.
+  std::string column;
+  /// A polygon, or the centre of a radius.
+  Next_spatial_query_geometry region;
+  /// The radius around a point, in the unit of ST_Distance; negative for a
+  /// polygon.
+  double radius = -1;
+  /// Whether points on the edge of the region are in it, as for
+  /// ST_Intersects or <=.
+  bool edge = false;
+};
+
+/**
+  Whether the statement of thd selects the rows of a table whose point lies
+  in a constant region, and nothing else, filling spec if so.
+  @param table the only table of the statement, open
+*/
+bool continuous_geofence_match(THD *thd, TABLE *table,
+                               Continuous_geofence_spec *spec);
+
+class Continuous_geofence_listener {
+ public:
+  virtual ~Continuous_geofence_listener() = default;
+
+  /**
+    The rows of a committed transaction entering or leaving the region, a
+    line each. Called in the committing session, the listener must only
+    queue them.
+    @param rows the number of lines
+  */
+  virtual void notify(const std::string &diff, size_t rows) = 0;
+};
+
+void continuous_geofence_init();
+void continuous_geofence_deinit();
+
+/// Have a listener told of the rows entering and leaving a geofence from
+/// the next transaction committing on.
+void continuous_geofence_register(Continuous_geofence_listener *listener,
+                                  const Continuous_geofence_spec &spec);
+
+/// Stop telling a listener, once no transaction is telling it.
+void continuous_geofence_unregister(Continuous_geofence_listener *listener);
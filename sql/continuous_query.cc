@@ -0,0 +1,1231 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/continuous_query.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <chrono>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "lex_string.h"
+#include "m_ctype.h"
+#include "my_dbug.h"
+#include "my_sys.h"
+#include "my_systime.h"
+#include "my_thread.h"
+#include "mysql/psi/mysql_cond.h"
+#include "mysql/psi/mysql_mutex.h"
+#include "mysql/psi/mysql_thread.h"
+#include "mysqld_error.h"
+#include "sql/auth/auth_acls.h"
+#include "sql/auth/sql_security_ctx.h"
+#include "sql/change_stream.h"
+#include "sql/continuous_geofence.h"
+#include "sql/continuous_shared.h"
+#include "sql/continuous_top_k.h"
+#include "sql/continuous_window.h"
+#include "sql/log.h"
+#include "sql/mysqld.h"
+#include "sql/mysqld_thd_manager.h"
+#include "sql/protocol_classic.h"
+#include "sql/sql_class.h"
+#include "sql/sql_prepare.h"
+#include "sql/strfunc.h"
+#include "sql/system_variables.h"
+
+uint continuous_query_threads;
+ulong continuous_query_history;
+
+namespace {
+
+constexpr std::chrono::milliseconds tick_length{100};
+constexpr ulonglong ticks_per_second = 1000 / tick_length.count();
+/// Most times the period of a query is stretched when its runs overrun.
+constexpr ulonglong max_backoff = 64;
+/// Where the results of the queries are appended, from the data directory.
+constexpr const char *sync_log_path = "../sync.log";
+
+struct Query;
+
+/// What the runs of a query cost, times in nanoseconds.
+struct Run_stats {
+  static constexpr uint buckets = 40;
+
+  ulonglong runs = 0;
+  /// When the last run ended, in microseconds since the epoch.
+  ulonglong last_end = 0;
+  /// Rows of changes the runs consumed.
+  ulonglong delta_rows = 0;
+  ulonglong sum_latency = 0;
+  ulonglong max_latency = 0;
+  /// Runs by latency: the i-th bucket counts those of less than 2^(i+1)
+  /// microseconds, and of at least 2^i but for the first.
+  ulonglong latencies[buckets] = {};
+  /// From the first commit, or the tick the run came due, to its end.
+  ulonglong last_lag = 0;
+  ulonglong max_lag = 0;
+  ulonglong sum_lag = 0;
+  ulonglong cpu_time = 0;
+  /// Rows the handlers read.
+  ulonglong rows_read = 0;
+  ulonglong created_tmp_disk_tables = 0;
+
+  void add_latency(ulonglong latency) {
+    sum_latency += latency;
+    max_latency = std::max(max_latency, latency);
+    const ulonglong micros = latency / 1000;
+    const uint bucket = micros < 2 ? 0 : static_cast<uint>(std::log2(micros));
+    latencies[std::min(bucket, buckets - 1)]++;
+  }
+
+  void add_lag(ulonglong lag) {
+    last_lag = lag;
+    max_lag = std::max(max_lag, lag);
+    sum_lag += lag;
+  }
+
+  /// The latency under which a share of the runs ended, rounded up to a
+  /// power of two microseconds.
+  ulonglong quantile(double share) const {
+    const ulonglong rank = std::ceil(share * runs);
+    ulonglong seen = 0;
+    for (uint i = 0; i < buckets; i++) {
+      seen += latencies[i];
+      if (seen >= rank && seen > 0) return 2000ULL << i;
+    }
+    return 0;
+  }
+};
+
+/// Runs an ASYNC query on the committed changes of its tables.
+class Query_subscriber final : public Change_stream_subscriber {
+ public:
+  explicit Query_subscriber(Query *query) : m_query(query) {}
+
+  void deliver(const std::vector<Change_stream_batch_ptr> &batches) override;
+
+ private:
+  Query *m_query;
+};
+
+/**
+  Runs the parameterized ASYNC queries comparing a column of a table on the
+  rows of the committed changes holding their constant. Guarded by
+  LOCK_continuous_queries once started.
+*/
+class Query_group final : public Change_stream_subscriber {
+ public:
+  explicit Query_group(const Continuous_shared_spec &spec)
+      : m_column(spec.column), m_charset(spec.charset) {}
+
+  void deliver(const std::vector<Change_stream_batch_ptr> &batches) override;
+
+  void add(ulonglong value_hash, Query *query) {
+    m_queries.emplace(value_hash, query);
+  }
+  void remove(ulonglong value_hash, Query *query);
+  bool empty() const { return m_queries.empty(); }
+
+ private:
+  /// The rows of a batch holding the constants of the queries, by query.
+  void route(const Change_stream_batch_ptr &batch,
+             std::map<Query *, std::vector<Change_stream_batch_ptr>> *out);
+
+  const std::string m_column;
+  const CHARSET_INFO *const m_charset;
+  /// The queries by the hash of their constant.
+  std::unordered_multimap<ulonglong, Query *> m_queries;
+};
+
+/// Runs a geofence on the rows entering and leaving its region.
+class Query_fence final : public Continuous_geofence_listener {
+ public:
+  explicit Query_fence(Query *query) : m_query(query) {}
+
+  void notify(const std::string &diff, size_t rows) override;
+
+ private:
+  Query *m_query;
+};
+
+/// A continuous query. Guarded by LOCK_continuous_queries once started.
+struct Query {
+  ulonglong id = 0;
+  std::string text;
+  /// The view the query refreshes, empty if it is not a refresh.
+  std::string view;
+  /// The account and environment the query runs in.
+  std::string user;
+  std::string host;
+  std::string db;
+  sql_mode_t sql_mode = 0;
+  const CHARSET_INFO *client_cs = nullptr;
+  const CHARSET_INFO *connection_cl = nullptr;
+
+  /// Ticks between runs, as requested.
+  ulonglong period = 0;
+  /// How many times the period is stretched for runs that overran.
+  ulonglong backoff = 1;
+  /// Tick the query is due at.
+  ulonglong expires = 0;
+  bool stopped = false;
+  /// Since when the changes waiting for the next run, or the run that came
+  /// due, waited; zero if nothing waits.
+  std::chrono::steady_clock::time_point waiting_since;
+  Run_stats stats;
+
+  /// For an ASYNC query, its subscription to the changes of its tables.
+  std::unique_ptr<Query_subscriber> subscriber;
+  /// For a parameterized ASYNC query, its group, as
+  /// group_key(Continuous_shared_spec), and the hash of its constant.
+  std::string group;
+  ulonglong value_hash = 0;
+  /// For a geofence, its registration with the geofences of its table.
+  std::unique_ptr<Query_fence> fence;
+  /// Changes delivered to an ASYNC query since its last run.
+  std::vector<Change_stream_batch_ptr> inbox;
+  /// Rows that entered or left the region of a geofence since its last
+  /// run, a line each.
+  std::string fence_inbox;
+  size_t inbox_rows = 0;
+  /// Rows delivered beyond change_stream_max_rows since the last run.
+  bool inbox_dropped = false;
+  /// An ASYNC query is waiting for a worker or running.
+  bool busy = false;
+  /// For an ASYNC search of the k nearest rows, the rows, only used by the
+  /// worker running the query.
+  std::unique_ptr<Continuous_top_k> top_k;
+  /// For a windowed ASYNC query, the open windows, only used by the worker
+  /// running the query.
+  std::unique_ptr<Continuous_window> window;
+
+  /// The position of the last output.
+  ulonglong position = 0;
+  /// The last outputs, by position, for listeners resuming.
+  std::deque<std::pair<ulonglong, std::string>> history;
+  std::vector<Continuous_query_listener *> listeners;
+};
+
+using Query_ptr = std::shared_ptr<Query>;
+
+/**
+  Hierarchical timer wheel, with four levels of 256 slots. A slot of the
+  first level holds the queries due at a tick, a slot of the next one the
+  queries due in a range of 256 ticks, and so on. As the first level wraps
+  around, the next slot of the second level is spread over it, and so on up
+  the levels, so that timing a query and finding the due ones costs no more
+  than a few moves per query, however many are timed.
+*/
+class Timer_wheel {
+ public:
+  static constexpr uint level_bits = 8;
+  static constexpr uint levels = 4;
+  static constexpr ulonglong slots = 1ULL << level_bits;
+  /// Furthest a query can be timed, about 13 years.
+  static constexpr ulonglong max_delay = (1ULL << (level_bits * levels)) - 1;
+
+  /// The next tick to turn the wheel to.
+  ulonglong now() const { return m_now; }
+
+  /// Time a query at its expires tick, or at the next one if it is past.
+  void add(Query_ptr query) {
+    if (query->expires < m_now) query->expires = m_now;
+    if (query->expires - m_now > max_delay) query->expires = m_now + max_delay;
+    const ulonglong delay = query->expires - m_now;
+    uint level = 0;
+    while (level + 1 < levels && delay >= 1ULL << (level_bits * (level + 1)))
+      level++;
+    const ulonglong slot =
+        (query->expires >> (level_bits * level)) & (slots - 1);
+    m_slots[level][slot].push_back(std::move(query));
+  }
+
+  /// Turn the wheel by a tick, taking the queries due at it.
+  void turn(std::vector<Query_ptr> *due) {
+    const ulonglong slot = m_now & (slots - 1);
+    if (slot == 0) {
+      for (uint level = 1; level < levels; level++) {
+        const ulonglong upper =
+            (m_now >> (level_bits * level)) & (slots - 1);
+        cascade(level, upper);
+        if (upper != 0) break;
+      }
+    }
+    std::vector<Query_ptr> &queries = m_slots[0][slot];
+    due->insert(due->end(), std::make_move_iterator(queries.begin()),
+                std::make_move_iterator(queries.end()));
+    queries.clear();
+    m_now++;
+  }
+
+  void clear() {
+    for (auto &level : m_slots)
+      for (auto &slot : level) slot.clear();
+  }
+
+ private:
+  /// Spread a slot of an upper level over the levels below.
+  void cascade(uint level, ulonglong slot) {
+    std::vector<Query_ptr> queries;
+    queries.swap(m_slots[level][slot]);
+    for (Query_ptr &query : queries) add(std::move(query));
+  }
+
+  ulonglong m_now = 0;
+  std::vector<Query_ptr> m_slots[levels][slots];
+};
+
+mysql_mutex_t LOCK_continuous_queries;
+/// The timer waits for the next tick on it.
+mysql_cond_t COND_continuous_query_timer;
+/// Signaled when a query is due to run.
+mysql_cond_t COND_continuous_query_run;
+/// Serializes appends to the sync log.
+mysql_mutex_t LOCK_sync_log;
+
+// Guarded by LOCK_continuous_queries.
+Timer_wheel wheel;
+std::map<ulonglong, Query_ptr> queries;
+/// Queries due, waiting for a worker.
+std::deque<Query_ptr> run_queue;
+/// Views with a refresh waiting or running.
+std::set<std::string> busy_views;
+/// The groups of parameterized ASYNC queries, kept alive by whoever
+/// unsubscribes them once they are left empty.
+std::map<std::string, std::shared_ptr<Query_group>> groups;
+ulonglong next_id = 0;
+
+std::atomic<ulonglong> runs{0};
+std::atomic<ulonglong> coalesced{0};
+std::atomic<ulonglong> overruns{0};
+std::atomic<ulonglong> top_k_searches{0};
+std::atomic<ulonglong> late_rows{0};
+std::atomic<ulonglong> shared_skips{0};
+
+std::chrono::steady_clock::time_point epoch;
+my_thread_handle timer_thread;
+bool timer_started = false;
+std::vector<my_thread_handle> workers;
+bool continuous_queries_inited = false;
+
+ulonglong current_tick() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - epoch)
+             .count() /
+         tick_length.count();
+}
+
+/// Stop a query, telling its listeners. Called with LOCK_continuous_queries.
+void stop_locked(Query *query) {
+  query->stopped = true;
+  for (Continuous_query_listener *listener : query->listeners)
+    listener->stopped(query->id);
+  query->listeners.clear();
+  query->history.clear();
+}
+
+/// Queue a due query for a worker, unless a refresh of its view is already
+/// queued or running. Called with LOCK_continuous_queries.
+void fire(Query_ptr query) {
+  if (query->stopped) return;
+  if (!query->view.empty() && !busy_views.insert(query->view).second) {
+    coalesced++;
+    query->expires += query->period * query->backoff;
+    wheel.add(std::move(query));
+    return;
+  }
+  if (query->waiting_since == std::chrono::steady_clock::time_point())
+    query->waiting_since = std::chrono::steady_clock::now();
+  run_queue.push_back(std::move(query));
+  mysql_cond_signal(&COND_continuous_query_run);
+}
+
+/**
+  Time a query again once it ran, stretching its period if the run ended
+  later than a period after it came due. Called with
+  LOCK_continuous_queries.
+*/
+void rearm(Query_ptr query, ulonglong finished) {
+  if (!query->view.empty()) busy_views.erase(query->view);
+  if (query->stopped) return;
+  if (finished > query->expires + query->period * query->backoff) {
+    overruns++;
+    query->backoff = std::min(query->backoff * 2, max_backoff);
+    query->expires = finished + query->period * query->backoff;
+  } else {
+    query->backoff = std::max<ulonglong>(query->backoff / 2, 1);
+    query->expires = std::max(
+        query->expires + query->period * query->backoff, finished + 1);
+  }
+  wheel.add(std::move(query));
+}
+
+/// Queue an ASYNC query to run on what was delivered to it, unless it is
+/// already waiting or running. Called with LOCK_continuous_queries.
+void queue_async(Query *query) {
+  if (query->waiting_since == std::chrono::steady_clock::time_point())
+    query->waiting_since = std::chrono::steady_clock::now();
+  if (query->busy) {
+    coalesced++;
+    return;
+  }
+  // the query is kept alive by the registry while it is subscribed
+  query->busy = true;
+  run_queue.push_back(queries.at(query->id));
+  mysql_cond_signal(&COND_continuous_query_run);
+}
+
+/// Add the changes delivered to an ASYNC query to its inbox and queue it.
+/// Called with LOCK_continuous_queries.
+void deliver_locked(Query *query,
+                    const std::vector<Change_stream_batch_ptr> &batches) {
+  if (query->stopped) return;
+  for (const Change_stream_batch_ptr &batch : batches) {
+    // the rows of later transactions wait for the run they trigger
+    if (query->inbox_rows + batch->rows.size() > change_stream_max_rows) {
+      query->inbox_dropped = true;
+      continue;
+    }
+    query->inbox_rows += batch->rows.size();
+    query->inbox.push_back(batch);
+  }
+  queue_async(query);
+}
+
+void Query_subscriber::deliver(
+    const std::vector<Change_stream_batch_ptr> &batches) {
+  mysql_mutex_lock(&LOCK_continuous_queries);
+  deliver_locked(m_query, batches);
+  mysql_mutex_unlock(&LOCK_continuous_queries);
+}
+
+/// The group of the parameterized ASYNC queries comparing a column.
+std::string group_key(const Continuous_shared_spec &spec) {
+  std::string key = spec.db + '\0' + spec.table_name + '\0' + spec.column;
+  if (spec.charset != nullptr)
+    key.append(1, '\0').append(spec.charset->m_coll_name);
+  return key;
+}
+
+void Query_group::route(
+    const Change_stream_batch_ptr &batch,
+    std::map<Query *, std::vector<Change_stream_batch_ptr>> *out) {
+  const auto column = std::find_if(
+      batch->columns.begin(), batch->columns.end(),
+      [this](const std::string &c) {
+        return my_strcasecmp(system_charset_info, c.c_str(),
+                             m_column.c_str()) == 0;
+      });
+  // the rows of the batch are not all known, all queries run
+  if (column == batch->columns.end() || batch->emptied ||
+      batch->rows_dropped) {
+    for (const auto &hash_query : m_queries)
+      (*out)[hash_query.second].push_back(batch);
+    return;
+  }
+
+  const size_t at = column - batch->columns.begin();
+  std::map<Query *, std::shared_ptr<Change_stream_batch>> routed;
+  std::vector<Query *> found;
+  for (const Change_stream_row &row : batch->rows) {
+    // a row leaves the result of the query of its value before the change
+    // and enters that of its value after it
+    found.clear();
+    for (const Change_stream_image *image : {&row.before, &row.after}) {
+      if (image->empty() || image->nulls[at]) continue;
+      const auto range = m_queries.equal_range(
+          continuous_shared_hash(m_charset, image->values[at]));
+      for (auto it = range.first; it != range.second; ++it)
+        found.push_back(it->second);
+    }
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+    for (Query *query : found) {
+      std::shared_ptr<Change_stream_batch> &rows = routed[query];
+      if (rows == nullptr) {
+        rows = std::make_shared<Change_stream_batch>();
+        rows->db = batch->db;
+        rows->table_name = batch->table_name;
+        rows->columns = batch->columns;
+      }
+      rows->rows.push_back(row);
+    }
+  }
+  for (auto &query_rows : routed)
+    (*out)[query_rows.first].push_back(std::move(query_rows.second));
+}
+
+void Query_group::deliver(
+    const std::vector<Change_stream_batch_ptr> &batches) {
+  std::map<Query *, std::vector<Change_stream_batch_ptr>> routed;
+  mysql_mutex_lock(&LOCK_continuous_queries);
+  for (const Change_stream_batch_ptr &batch : batches) route(batch, &routed);
+  // a query is in its group once
+  shared_skips += m_queries.size() - routed.size();
+  for (const auto &query_batches : routed)
+    deliver_locked(query_batches.first, query_batches.second);
+  mysql_mutex_unlock(&LOCK_continuous_queries);
+}
+
+void Query_group::remove(ulonglong value_hash, Query *query) {
+  const auto range = m_queries.equal_range(value_hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second == query) {
+      m_queries.erase(it);
+      return;
+    }
+  }
+}
+
+/**
+  Remove a parameterized ASYNC query from its group.
+  @return the group if it was left empty, to unsubscribe once
+    LOCK_continuous_queries is released; nullptr otherwise
+*/
+std::shared_ptr<Query_group> leave_group(Query *query) {
+  auto it = groups.find(query->group);
+  if (it == groups.end()) return nullptr;
+  it->second->remove(query->value_hash, query);
+  if (!it->second->empty()) return nullptr;
+  std::shared_ptr<Query_group> group = std::move(it->second);
+  groups.erase(it);
+  return group;
+}
+
+void Query_fence::notify(const std::string &diff, size_t rows) {
+  mysql_mutex_lock(&LOCK_continuous_queries);
+  Query *const query = m_query;
+  if (!query->stopped) {
+    if (query->inbox_rows + rows > change_stream_max_rows) {
+      query->inbox_dropped = true;
+    } else {
+      query->inbox_rows += rows;
+      query->fence_inbox.append(diff);
+    }
+    queue_async(query);
+  }
+  mysql_mutex_unlock(&LOCK_continuous_queries);
+}
+
+/// Queue an ASYNC query again once it ran, if changes were delivered
+/// meanwhile. Called with LOCK_continuous_queries.
+void rearm_async(Query_ptr query) {
+  if (query->stopped || (query->inbox.empty() && query->fence_inbox.empty() &&
+                         !query->inbox_dropped)) {
+    query->busy = false;
+    return;
+  }
+  run_queue.push_back(std::move(query));
+  mysql_cond_signal(&COND_continuous_query_run);
+}
+
+void append_image(std::string *out, const Change_stream_image &image) {
+  out->append("(");
+  for (size_t i = 0; i < image.values.size(); i++) {
+    if (i > 0) out->append(", ");
+    out->append(image.nulls[i] ? std::string("NULL") : image.values[i]);
+  }
+  out->append(")");
+}
+
+/// The changes that ran an ASYNC query, a line per row.
+std::string format_changes(const std::vector<Change_stream_batch_ptr> &batches,
+                           bool dropped) {
+  std::string out;
+  for (const Change_stream_batch_ptr &batch : batches) {
+    const std::string table = batch->db + "." + batch->table_name;
+    if (batch->emptied) out.append(table).append(": all rows deleted\n");
+    for (const Change_stream_row &row : batch->rows) {
+      out.append(table);
+      switch (row.type) {
+        case Change_stream_row::Type::INSERT:
+          out.append(": INSERT ");
+          append_image(&out, row.after);
+          break;
+        case Change_stream_row::Type::UPDATE:
+          out.append(": UPDATE ");
+          append_image(&out, row.before);
+          out.append(" -> ");
+          append_image(&out, row.after);
+          break;
+        case Change_stream_row::Type::DELETE:
+          out.append(": DELETE ");
+          append_image(&out, row.before);
+          break;
+      }
+      out.append("\n");
+    }
+    if (batch->rows_dropped) out.append(table).append(": more rows changed\n");
+  }
+  if (dropped) out.append("more changes not shown\n");
+  return out;
+}
+
+std::string format_result(Ed_result_set *rset) {
+  const size_t count = rset->get_field_count();
+  List<Ed_row> &rows = *rset;
+  auto value = [](const Ed_column &column) {
+    return column.str == nullptr ? std::string("NULL")
+                                 : std::string(column.str, column.length);
+  };
+
+  std::vector<size_t> widths(count, 0);
+  for (size_t i = 0; i < count; i++)
+    widths[i] = value((*rset->get_fields())[i]).size();
+  for (const Ed_row &row : rows)
+    for (size_t i = 0; i < count; i++)
+      widths[i] = std::max(widths[i], value(row[i]).size());
+
+  std::string separator("+");
+  for (size_t width : widths) separator.append(width + 2, '-').append("+");
+  separator.append("\n");
+  auto line = [&](const Ed_row &row) {
+    std::string out("|");
+    for (size_t i = 0; i < count; i++) {
+      const std::string v = value(row[i]);
+      out.append(" ").append(v).append(widths[i] - v.size() + 1, ' ');
+      out.append("|");
+    }
+    return out.append("\n");
+  };
+
+  std::string out = separator + line(*rset->get_fields()) + separator;
+  for (const Ed_row &row : rows) out.append(line(row));
+  return out.append(separator);
+}
+
+void log_result(const Query &query, const std::string &result) {
+  const std::time_t now = std::time(nullptr);
+  char stamp[32];
+  struct tm tm_now;
+  localtime_r(&now, &tm_now);
+  strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm_now);
+
+  mysql_mutex_lock(&LOCK_sync_log);
+  std::ofstream log(sync_log_path, std::ios::app);
+  if (log.is_open())
+    log << stamp << " query " << query.id << ": " << query.text << "\n"
+        << result << std::endl;
+  mysql_mutex_unlock(&LOCK_sync_log);
+}
+
+/**
+  Run a statement once as the account of a query, in its environment,
+  handing its result set, if any, to on_result.
+  @return the error of the statement, empty if it succeeded
+*/
+template <class Result_handler>
+std::string execute_as(THD *thd, const Query &query, const std::string &text,
+                       Result_handler on_result) {
+  std::string error;
+  const char *db = query.db.empty() ? nullptr : query.db.c_str();
+  thd->set_db(db == nullptr ? NULL_CSTR : to_lex_cstring(db));
+
+  Security_context sctx;
+  Security_context *backup = nullptr;
+  const LEX_CSTRING user = {query.user.c_str(), query.user.length()};
+  const LEX_CSTRING host = {query.host.c_str(), query.host.length()};
+  if (sctx.change_security_context(thd, user, host, db, &backup)) {
+    error = std::string("ERROR: ") + thd->get_stmt_da()->message_text() + "\n";
+  } else {
+    thd->variables.sql_mode = query.sql_mode;
+    thd->variables.character_set_client = query.client_cs;
+    thd->variables.collation_connection = query.connection_cl;
+    thd->update_charset();
+
+    Ed_connection conn(thd);
+    LEX_STRING statement;
+    lex_string_strmake(thd->mem_root, &statement, text.c_str(), text.length());
+    if (conn.execute_direct(statement))
+      error = "ERROR " + std::to_string(conn.get_last_errno()) + ": " +
+              conn.get_last_error() + "\n";
+    else if (conn.get_result_sets() != nullptr)
+      on_result(conn.get_result_sets());
+    sctx.restore_security_context(thd, backup);
+  }
+
+  thd->clear_error();
+  thd->get_stmt_da()->reset_diagnostics_area();
+  thd->get_stmt_da()->reset_condition_info(thd);
+  thd->set_db(NULL_CSTR);
+  thd->mem_root->ClearForReuse();
+  return error;
+}
+
+/**
+  Run a query once as its account.
+  @return its result set or error, after the changes that ran it if it is
+    an ASYNC query
+*/
+std::string run_query(THD *thd, const Query &query,
+                      const std::string &changes) {
+  std::string result = changes;
+  result += execute_as(thd, query, query.text, [&result](Ed_result_set *rows) {
+    result += format_result(rows);
+  });
+  // refreshes only output their errors
+  return result;
+}
+
+/**
+  Bring the k nearest rows of an ASYNC search up to the changes that ran
+  it, searching them again only if one of them may have changed.
+  @return the rows that entered or left them
+*/
+std::string run_top_k(THD *thd, const Query &query,
+                      const std::vector<Change_stream_batch_ptr> &changes,
+                      bool dropped) {
+  Continuous_top_k *top_k = query.top_k.get();
+  std::string diff;
+  if (!top_k->searched() || top_k->apply(changes, dropped, &diff)) {
+    if (top_k->searched()) top_k_searches++;
+    diff += execute_as(thd, query, top_k->search_text(),
+                       [top_k, &diff](Ed_result_set *rows) {
+                         top_k->reset(rows, &diff);
+                       });
+  }
+  return diff;
+}
+
+/// Log an output of a query and tell its listeners.
+void publish(Query *query, const std::string &text) {
+  log_result(*query, text);
+  mysql_mutex_lock(&LOCK_continuous_queries);
+  if (!query->stopped) {
+    const ulonglong position = ++query->position;
+    query->history.emplace_back(position, text);
+    while (query->history.size() > continuous_query_history)
+      query->history.pop_front();
+    for (Continuous_query_listener *listener : query->listeners)
+      listener->output(query->id, position, text, false);
+  }
+  mysql_mutex_unlock(&LOCK_continuous_queries);
+}
+
+/// The CPU time of the current thread, in nanoseconds.
+ulonglong thread_cpu_time() {
+  struct timespec now;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) != 0) return 0;
+  return static_cast<ulonglong>(now.tv_sec) * 1000000000ULL + now.tv_nsec;
+}
+
+/// The rows the handlers of a thread read.
+ulonglong rows_read(const THD *thd) {
+  const System_status_var &status = thd->status_var;
+  return status.ha_read_first_count + status.ha_read_last_count +
+         status.ha_read_key_count + status.ha_read_next_count +
+         status.ha_read_prev_count + status.ha_read_rnd_count +
+         status.ha_read_rnd_next_count;
+}
+
+/// Set up a background THD for a thread of the scheduler.
+void init_thread_thd(THD *thd) {
+  thd->system_thread = SYSTEM_THREAD_BACKGROUND;
+  thd->get_protocol_classic()->init_net(nullptr);
+  thd->set_new_thread_id();
+  thd->store_globals();
+  Global_THD_manager::get_instance()->add_thd(thd);
+  mysql_thread_set_psi_id(thd->thread_id());
+  thd->set_command(COM_DAEMON);
+}
+
+void end_thread_thd(THD *thd) {
+  thd->get_protocol_classic()->end_net();
+  // Must be called before thd_manager->remove_thd.
+  thd->release_resources();
+  Global_THD_manager::get_instance()->remove_thd(thd);
+}
+
+/// Turn the wheel at every tick, queueing the due queries.
+extern "C" void *continuous_query_timer(void *) {
+  THD new_thd;
+  THD *thd = &new_thd;
+  thd->thread_stack = (char *)&thd;
+  if (my_thread_init()) return nullptr;
+  init_thread_thd(thd);
+  thd->security_context()->skip_grants();
+
+  {
+    DBUG_TRACE;
+    std::vector<Query_ptr> due;
+    mysql_mutex_lock(&LOCK_continuous_queries);
+    PSI_stage_info old_stage;
+    thd->ENTER_COND(&COND_continuous_query_timer, &LOCK_continuous_queries,
+                    &stage_waiting_for_continuous_query_tick, &old_stage);
+    while (!thd->is_killed()) {
+      const ulonglong target = current_tick();
+      while (wheel.now() <= target) wheel.turn(&due);
+      for (Query_ptr &query : due) fire(std::move(query));
+      due.clear();
+
+      struct timespec abstime;
+      set_timespec_nsec(&abstime, std::chrono::duration_cast<
+                                      std::chrono::nanoseconds>(tick_length)
+                                      .count());
+      mysql_cond_timedwait(&COND_continuous_query_timer,
+                           &LOCK_continuous_queries, &abstime);
+    }
+    mysql_mutex_unlock(&LOCK_continuous_queries);
+    thd->EXIT_COND(&old_stage);
+  }
+
+  end_thread_thd(thd);
+  my_thread_end();
+  return nullptr;
+}
+
+/**
+  Wait for a due query and take it, along with the changes delivered to it
+  if it is an ASYNC query, or the rows that entered or left its region if
+  it is a geofence.
+  @param[out] rows the rows of the changes
+  @param[out] since since when the changes, or the due run, waited
+  @return false if the worker was killed
+*/
+bool take_query(THD *thd, Query_ptr *query,
+                std::vector<Change_stream_batch_ptr> *changes,
+                std::string *fence_changes, bool *dropped, size_t *rows,
+                std::chrono::steady_clock::time_point *since) {
+  mysql_mutex_lock(&LOCK_continuous_queries);
+  PSI_stage_info old_stage;
+  thd->ENTER_COND(&COND_continuous_query_run, &LOCK_continuous_queries,
+                  &stage_waiting_for_work_item, &old_stage);
+  while (run_queue.empty() && !thd->is_killed()) {
+    mysql_cond_wait(&COND_continuous_query_run, &LOCK_continuous_queries);
+  }
+  const bool found = !thd->is_killed();
+  if (found) {
+    *query = std::move(run_queue.front());
+    run_queue.pop_front();
+    changes->swap((*query)->inbox);
+    (*query)->inbox.clear();
+    fence_changes->swap((*query)->fence_inbox);
+    (*query)->fence_inbox.clear();
+    *rows = (*query)->inbox_rows;
+    (*query)->inbox_rows = 0;
+    *since = (*query)->waiting_since;
+    (*query)->waiting_since = std::chrono::steady_clock::time_point();
+    *dropped = (*query)->inbox_dropped;
+    (*query)->inbox_dropped = false;
+  }
+  mysql_mutex_unlock(&LOCK_continuous_queries);
+  thd->EXIT_COND(&old_stage);
+  return found;
+}
+
+extern "C" void *continuous_query_worker(void *) {
+  THD new_thd;
+  THD *thd = &new_thd;
+  thd->thread_stack = (char *)&thd;
+  if (my_thread_init()) return nullptr;
+  init_thread_thd(thd);
+
+  {
+    DBUG_TRACE;
+    Query_ptr query;
+    std::vector<Change_stream_batch_ptr> changes;
+    std::string fence_changes;
+    bool dropped = false;
+    size_t rows = 0;
+    std::chrono::steady_clock::time_point since;
+    while (take_query(thd, &query, &changes, &fence_changes, &dropped, &rows,
+                      &since)) {
+      const bool async = query->subscriber != nullptr ||
+                         query->fence != nullptr || !query->group.empty();
+      const auto started = std::chrono::steady_clock::now();
+      const ulonglong cpu_started = thread_cpu_time();
+      const ulonglong read_started = rows_read(thd);
+      const ulonglong tmp_started = thd->status_var.created_tmp_disk_tables;
+      std::string output;
+      if (query->fence != nullptr) {
+        // the geofences of the table already tested the rows
+        if (dropped) fence_changes.append("more changes not shown\n");
+        output.swap(fence_changes);
+      } else if (query->top_k != nullptr) {
+        output = run_top_k(thd, *query, changes, dropped);
+      } else if (query->window != nullptr) {
+        late_rows += query->window->apply(changes, dropped, &output);
+      } else {
+        output = run_query(thd, *query,
+                           async ? format_changes(changes, dropped) : "");
+      }
+      if (!output.empty()) publish(query.get(), output);
+      changes.clear();
+      fence_changes.clear();
+      runs++;
+      const auto ended = std::chrono::steady_clock::now();
+      mysql_mutex_lock(&LOCK_continuous_queries);
+      Run_stats &stats = query->stats;
+      stats.runs++;
+      stats.last_end = my_micro_time();
+      stats.delta_rows += rows;
+      stats.add_latency(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            ended - started)
+                            .count());
+      if (since != std::chrono::steady_clock::time_point())
+        stats.add_lag(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(ended - since)
+                .count());
+      stats.cpu_time += thread_cpu_time() - cpu_started;
+      stats.rows_read += rows_read(thd) - read_started;
+      stats.created_tmp_disk_tables +=
+          thd->status_var.created_tmp_disk_tables - tmp_started;
+      if (async)
+        rearm_async(std::move(query));
+      else
+        rearm(std::move(query), current_tick());
+      mysql_mutex_unlock(&LOCK_continuous_queries);
+    }
+  }
+
+  end_thread_thd(thd);
+  my_thread_end();
+  return nullptr;
+}
+
+/// What a query is, as listed.
+const char *query_kind(const Query &query) {
+  if (!query.view.empty()) return "REFRESH";
+  if (query.fence != nullptr) return "GEOFENCE";
+  if (query.top_k != nullptr) return "TOP_K";
+  if (query.window != nullptr) return "WINDOW";
+  if (!query.group.empty()) return "SHARED";
+  if (query.subscriber != nullptr) return "ASYNC";
+  return "PERIODIC";
+}
+
+/// A query run as the current account, in its environment.
+Query_ptr new_query(THD *thd, const std::string &text) {
+  if (!timer_started || workers.empty()) {
+    my_error(ER_NOT_SUPPORTED_YET, MYF(0),
+             "continuous queries without their background threads");
+    return nullptr;
+  }
+  auto query = std::make_shared<Query>();
+  query->text = text;
+  Security_context *sctx = thd->security_context();
+  query->user.assign(sctx->priv_user().str, sctx->priv_user().length);
+  query->host.assign(sctx->priv_host().str, sctx->priv_host().length);
+  if (thd->db().str != nullptr) query->db.assign(thd->db().str);
+  query->sql_mode = thd->variables.sql_mode;
+  query->client_cs = thd->variables.character_set_client;
+  query->connection_cl = thd->variables.collation_connection;
+  return query;
+}
+
+}  // namespace
+
+void continuous_query_init() {
+  mysql_mutex_init(PSI_NOT_INSTRUMENTED, &LOCK_continuous_queries,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(PSI_NOT_INSTRUMENTED, &COND_continuous_query_timer);
+  mysql_cond_init(PSI_NOT_INSTRUMENTED, &COND_continuous_query_run);
+  mysql_mutex_init(PSI_NOT_INSTRUMENTED, &LOCK_sync_log, MY_MUTEX_INIT_FAST);
+  continuous_geofence_init();
+  epoch = std::chrono::steady_clock::now();
+  continuous_queries_inited = true;
+
+  if (int error = mysql_thread_create(key_thread_continuous_query_timer,
+                                      &timer_thread, &connection_attrib,
+                                      continuous_query_timer, nullptr)) {
+    sql_print_warning("Could not create continuous query timer (errno= %d)",
+                      error);
+    return;
+  }
+  timer_started = true;
+  for (uint i = 0; i < continuous_query_threads; i++) {
+    my_thread_handle handle;
+    if (int error = mysql_thread_create(key_thread_continuous_query_worker,
+                                        &handle, &connection_attrib,
+                                        continuous_query_worker, nullptr)) {
+      sql_print_warning("Could not create continuous query thread (errno= %d)",
+                        error);
+      break;
+    }
+    workers.push_back(handle);
+  }
+}
+
+void continuous_query_deinit() {
+  if (!continuous_queries_inited) return;
+  // The threads have been killed along with all other threads.
+  if (timer_started) my_thread_join(&timer_thread, nullptr);
+  timer_started = false;
+  for (my_thread_handle &handle : workers) {
+    my_thread_join(&handle, nullptr);
+  }
+  workers.clear();
+  for (const auto &id_query : queries) {
+    if (id_query.second->subscriber != nullptr)
+      change_stream_unsubscribe(id_query.second->subscriber.get());
+  }
+  for (const auto &key_group : groups)
+    change_stream_unsubscribe(key_group.second.get());
+  groups.clear();
+  continuous_geofence_deinit();
+  wheel.clear();
+  queries.clear();
+  run_queue.clear();
+  busy_views.clear();
+  mysql_mutex_destroy(&LOCK_sync_log);
+  mysql_cond_destroy(&COND_continuous_query_run);
+  mysql_cond_destroy(&COND_continuous_query_timer);
+  mysql_mutex_destroy(&LOCK_continuous_queries);
+  continuous_queries_inited = false;
+}
+
+bool continuous_query_start(THD *thd, const std::string &text, ulong period,
+                            const std::string &view, ulonglong *id) {
+  if (period == 0) {
+    my_error(ER_WRONG_ARGUMENTS, MYF(0), "SYNC");
+    return true;
+  }
+  const Query_ptr query = new_query(thd, text);
+  if (query == nullptr) return true;
+  query->view = view;
+  query->period = std::min<ulonglong>(ulonglong{period} * ticks_per_second,
+                                      Timer_wheel::max_delay);
+
+  mysql_mutex_lock(&LOCK_continuous_queries);
+  query->id = *id = ++next_id;
+  // spread the first runs of the queries over their period
+  query->expires = wheel.now() + 1 + query->id % query->period;
+  queries.emplace(query->id, query);
+  wheel.add(query);
+  mysql_mutex_unlock(&LOCK_continuous_queries);
+  return false;
+}
+
+bool continuous_query_start_async(
+    THD *thd, const std::string &text,
+    const std::vector<Change_stream_table> &tables,
+    const Continuous_top_k_spec *top_k, const Continuous_window_spec *window,
+    ulonglong *id) {
+  const Query_ptr query = new_query(thd, text);
+  if (query == nullptr) return true;
+  query->subscriber = std::make_unique<Query_subscriber>(query.get());
+  if (top_k != nullptr)
+    query->top_k = std::make_unique<Continuous_top_k>(*top_k);
+  if (window != nullptr)
+    query->window = std::make_unique<Continuous_window>(*window);
+
+  mysql_mutex_lock(&LOCK_continuous_queries);
+  query->id = *id = ++next_id;
+  queries.emplace(query->id, query);
+  mysql_mutex_unlock(&LOCK_continuous_queries);
+  change_stream_subscribe(query->subscriber.get(), tables);
+  return false;
+}
+
+bool continuous_query_start_geofence(THD *thd, const std::string &text,
+                                     const Continuous_geofence_spec &fence,
+                                     ulonglong *id) {
+  const Query_ptr query = new_query(thd, text);
+  if (query == nullptr) return true;
+  query->fence = std::make_unique<Query_fence>(query.get());
+
+  mysql_mutex_lock(&LOCK_continuous_queries);
+  query->id = *id = ++next_id;
+  queries.emplace(query->id, query);
+  mysql_mutex_unlock(&LOCK_continuous_queries);
+  continuous_geofence_register(query->fence.get(), fence);
+  return false;
+}
+
+bool continuous_query_start_shared(THD *thd, const std::string &text,
+                                   const Continuous_shared_spec &shared,
+                                   ulonglong *id) {
+  const Query_ptr query = new_query(thd, text);
+  if (query == nullptr) return true;
+  query->group = group_key(shared);
+  query->value_hash = shared.value_hash;
+
+  std::shared_ptr<Query_group> created;
+  mysql_mutex_lock(&LOCK_continuous_queries);
+  query->id = *id = ++next_id;
+  queries.emplace(query->id, query);
+  std::shared_ptr<Query_group> &group = groups[query->group];
+  if (group == nullptr) group = created = std::make_shared<Query_group>(shared);
+  group->add(shared.value_hash, query.get());
+  mysql_mutex_unlock(&LOCK_continuous_queries);
+  if (created == nullptr) return false;
+
+  change_stream_subscribe(created.get(), {{shared.db, shared.table_name}});
+  // the group may have been left empty, and unsubscribed, meanwhile
+  mysql_mutex_lock(&LOCK_continuous_queries);
+  const auto it = groups.find(query->group);
+  const bool left = it == groups.end() || it->second != created;
+  mysql_mutex_unlock(&LOCK_continuous_queries);
+  if (left) change_stream_unsubscribe(created.get());
+  return false;
+}
+
+bool continuous_query_stop(THD *thd, ulonglong id) {
+  if (!continuous_queries_inited) {
+    my_error(ER_WRONG_ARGUMENTS, MYF(0), "STOP SYNC");
+    return true;
+  }
+  Security_context *sctx = thd->security_context();
+  Query_ptr stopped;
+  std::shared_ptr<Query_group> emptied;
+  mysql_mutex_lock(&LOCK_continuous_queries);
+  auto it = queries.find(id);
+  const bool found = it != queries.end();
+  const bool allowed =
+      found && ((it->second->user == sctx->priv_user().str &&
+                 it->second->host == sctx->priv_host().str) ||
+                sctx->check_access(SUPER_ACL));
+  if (allowed) {
+    // a waiting or running query is not run again
+    stopped = it->second;
+    stop_locked(stopped.get());
+    if (!stopped->group.empty()) emptied = leave_group(stopped.get());
+    queries.erase(it);
+  }
+  mysql_mutex_unlock(&LOCK_continuous_queries);
+  // deliveries wait for LOCK_continuous_queries with the subscriptions
+  // locked
+  if (stopped != nullptr && stopped->subscriber != nullptr)
+    change_stream_unsubscribe(stopped->subscriber.get());
+  if (stopped != nullptr && stopped->fence != nullptr)
+    continuous_geofence_unregister(stopped->fence.get());
+  if (emptied != nullptr) change_stream_unsubscribe(emptied.get());
+
+  if (!found) {
+    my_error(ER_WRONG_ARGUMENTS, MYF(0), "STOP SYNC");
+    return true;
+  }
+  if (!allowed) {
+    my_error(ER_SPECIFIC_ACCESS_DENIED_ERROR, MYF(0), "SUPER");
+    return true;
+  }
+  return false;
+}
+
+void continuous_query_stop_view(const std::string &view) {
+  if (!continuous_queries_inited) return;
+  mysql_mutex_lock(&LOCK_continuous_queries);
+  for (auto it = queries.begin(); it != queries.end();) {
+    if (it->second->view == view) {
+      stop_locked(it->second.get());
+      it = queries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  mysql_mutex_unlock(&LOCK_continuous_queries);
+}
+
+bool continuous_query_listen(const std::string &user, const std::string &host,
+                             bool super, ulonglong id, ulonglong after,
+                             Continuous_query_listener *listener) {
+  if (!continuous_queries_inited) return true;
+  mysql_mutex_lock(&LOCK_continuous_queries);
+  auto it = queries.find(id);
+  const bool allowed =
+      it != queries.end() &&
+      ((it->second->user == user && it->second->host == host) || super);
+  if (allowed) {
+    Query *const query = it->second.get();
+    if (std::find(query->listeners.begin(), query->listeners.end(),
+                  listener) == query->listeners.end())
+      query->listeners.push_back(listener);
+    for (const auto &position_text : query->history) {
+      if (position_text.first > after)
+        listener->output(id, position_text.first, position_text.second, true);
+    }
+  }
+  mysql_mutex_unlock(&LOCK_continuous_queries);
+  return !allowed;
+}
+
+void continuous_query_unlisten(ulonglong id,
+                               Continuous_query_listener *listener) {
+  if (!continuous_queries_inited) return;
+  mysql_mutex_lock(&LOCK_continuous_queries);
+  auto it = queries.find(id);
+  if (it != queries.end()) {
+    std::vector<Continuous_query_listener *> &listeners =
+        it->second->listeners;
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), listener),
+                    listeners.end());
+  }
+  mysql_mutex_unlock(&LOCK_continuous_queries);
+}
+
+std::vector<Continuous_query_info> continuous_query_list() {
+  std::vector<Continuous_query_info> list;
+  if (!continuous_queries_inited) return list;
+  mysql_mutex_lock(&LOCK_continuous_queries);
+  for (const auto &id_query : queries) {
+    const Query &query = *id_query.second;
+    const Run_stats &stats = query.stats;
+    Continuous_query_info info;
+    info.id = query.id;
+    info.user = query.user;
+    info.host = query.host;
+    info.kind = query_kind(query);
+    info.text = query.text;
+    info.period = query.period / ticks_per_second;
+    info.backoff = query.backoff;
+    info.runs = stats.runs;
+    info.outputs = query.position;
+    info.last_refresh = stats.last_end;
+    info.delta_rows = stats.delta_rows;
+    // picoseconds, as the timers of the performance schema
+    info.sum_refresh = stats.sum_latency * 1000;
+    info.max_refresh = stats.max_latency * 1000;
+    info.quantile_95 = stats.quantile(0.95) * 1000;
+    info.quantile_99 = stats.quantile(0.99) * 1000;
+    info.quantile_999 = stats.quantile(0.999) * 1000;
+    info.last_lag = stats.last_lag * 1000;
+    info.max_lag = stats.max_lag * 1000;
+    info.sum_lag = stats.sum_lag * 1000;
+    info.sum_cpu_time = stats.cpu_time * 1000;
+    info.sum_rows_read = stats.rows_read;
+    info.sum_created_tmp_disk_tables = stats.created_tmp_disk_tables;
+    list.push_back(std::move(info));
+  }
+  mysql_mutex_unlock(&LOCK_continuous_queries);
+  return list;
+}
+
+Continuous_query_stats continuous_query_stats() {
+  Continuous_query_stats stats;
+  if (continuous_queries_inited) {
+    mysql_mutex_lock(&LOCK_continuous_queries);
+    stats.queries = queries.size();
+    mysql_mutex_unlock(&LOCK_continuous_queries);
+  } else {
+    stats.queries = 0;
+  }
+  stats.runs = runs;
+  stats.coalesced = coalesced;
+  stats.overruns = overruns;
+  stats.top_k_searches = top_k_searches;
+  stats.late_rows = late_rows;
+  stats.shared_skips = shared_skips;
+  return stats;
+}
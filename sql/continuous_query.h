@@ -0,0 +1,244 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+/**
+  @file
+  Continuous queries, run again and again at a period, e.g.
+
+    SELECT region, SUM(amount) FROM sales GROUP BY region SYNC 1 SECOND
+    REFRESH MATERIALIZED VIEW sales_by_region SYNC 10 SECOND
+
+  or, for ASYNC queries, again and again as the tables they read change:
+
+    SELECT * FROM orders WHERE status = 'flagged' SYNC ASYNC
+
+  The statement returns at once with the id of the query as its last insert
+  id, and the query runs in the background until STOP SYNC <id>. Its
+  results, or its errors, are appended to the sync log, ../sync.log from
+  the data directory. A query runs as the account that started it, in the
+  database, SQL mode and character sets it was started in.
+
+  Queries are scheduled by a hierarchical timer wheel of 100ms ticks, which
+  a single thread turns, and run by continuous_query_threads workers, so
+  that thousands of them cost neither a thread each nor a priority queue
+  walk per run. The first run of a query is spread over its period.
+
+  - A query is timed again once its run ends, so that it never overlaps
+    itself.
+  - Queries refreshing the same materialized view coalesce: one coming due
+    while another refresh of the view is waiting or running is skipped until
+    its next period, as the running refresh already catches the changes up.
+  - A query whose run ends later than its period after it came due, as it
+    ran long or waited for a worker, is delayed: its period doubles, up to 64
+    times the requested one, and halves back with each run ending in time.
+
+  An ASYNC query subscribes to the change stream of its tables, see
+  change_stream.h, so that it runs only after a transaction changing them
+  commits, rather than polling them. The rows the transactions changed are
+  logged before the result of the run. Changes committed while the query
+  waits or runs are batched into its next run. An ASYNC search of the k
+  nearest rows to a vector keeps them instead of searching again, and logs
+  only the rows entering and leaving them, see continuous_top_k.h. An ASYNC
+  query of the rows whose point lies in a region is a geofence, run by the
+  geofences of its table, see continuous_geofence.h. An ASYNC query with a
+  WINDOW clause keeps the counts and sums of its open windows, and logs the
+  windows as they close, see continuous_window.h. ASYNC queries of a table
+  differing only in the constant a column is compared to share a
+  subscription, and run only on the rows holding their constant, see
+  continuous_shared.h.
+
+  Rather than reading the sync log, clients may listen to the outputs of a
+  query, as the X Plugin does for its subscribers. The outputs of a query
+  are numbered from 1 on, and the last continuous_query_history of them are
+  kept, so that a listener can resume after the last one it saw, or, as it
+  falls behind, skip outputs and have them told again once it caught up.
+
+  performance_schema.continuous_queries lists the queries, with the cost
+  and latency of their runs and their lag behind the commits or the ticks
+  that ran them, to find those holding the workers up.
+
+  Queries live in memory: they end when the server stops.
+*/
+
+#include <string>
+#include <vector>
+
+#include "my_inttypes.h"
+
+class THD;
+struct Change_stream_table;
+struct Continuous_geofence_spec;
+struct Continuous_shared_spec;
+struct Continuous_top_k_spec;
+struct Continuous_window_spec;
+
+/// Number of workers running continuous queries, set at server start.
+extern uint continuous_query_threads;
+/// Outputs kept per query for listeners resuming, at least the last one.
+extern ulong continuous_query_history;
+
+/// Start the wheel and the workers at server start.
+void continuous_query_init();
+
+/// Wait for the threads to end at shutdown, once they have been killed.
+void continuous_query_deinit();
+
+/**
+  Start running a statement every period, as the current account.
+  @param text the statement
+  @param period seconds between runs
+  @param view the materialized view the statement refreshes, as
+    "`db`.`name`", to coalesce the refreshes of the view; empty for others
+  @param[out] id the id of the query, for STOP SYNC
+*/
+bool continuous_query_start(THD *thd, const std::string &text, ulong period,
+                            const std::string &view, ulonglong *id);
+
+/**
+  Start running a statement as the current account each time transactions
+  changing tables commit.
+  @param tables the tables the statement reads
+  @param top_k what the statement searches if it is a search of the k
+    nearest rows, nullptr for others
+  @param window what the statement aggregates if it has a WINDOW clause,
+    nullptr for others
+  @param[out] id the id of the query, for STOP SYNC
+*/
+bool continuous_query_start_async(
+    THD *thd, const std::string &text,
+    const std::vector<Change_stream_table> &tables,
+    const Continuous_top_k_spec *top_k, const Continuous_window_spec *window,
+    ulonglong *id);
+
+/**
+  Start a geofence as the current account, logging the rows entering and
+  leaving its region.
+  @param[out] id the id of the query, for STOP SYNC
+*/
+bool continuous_query_start_geofence(THD *thd, const std::string &text,
+                                     const Continuous_geofence_spec &fence,
+                                     ulonglong *id);
+
+/**
+  Start a parameterized ASYNC query as the current account, run each time
+  transactions changing rows holding its constant commit.
+  @param[out] id the id of the query, for STOP SYNC
+*/
+bool continuous_query_start_shared(THD *thd, const std::string &text,
+                                   const Continuous_shared_spec &shared,
+                                   ulonglong *id);
+
+/// Stop a query, which must have been started by the current account or
+/// needs SUPER.
+bool continuous_query_stop(THD *thd, ulonglong id);
+
+/// Stop the queries refreshing a materialized view once it is dropped.
+void continuous_query_stop_view(const std::string &view);
+
+class Continuous_query_listener {
+ public:
+  virtual ~Continuous_query_listener() = default;
+
+  /**
+    An output of a query, its result or the rows that entered or left it,
+    as logged. Called with the queries locked, the listener must only queue
+    it.
+    @param position the number of the output
+    @param replayed the output is kept one told by continuous_query_listen,
+      rather than a new one; between two listens, new outputs are told in
+      order, and replayed ones are too, but the outputs before the first
+      kept one are no longer kept
+  */
+  virtual void output(ulonglong id, ulonglong position,
+                      const std::string &text, bool replayed) = 0;
+
+  /// The query stopped, nothing follows. Called with the queries locked.
+  virtual void stopped(ulonglong id) = 0;
+};
+
+/**
+  Have a listener told of the outputs of a query, which must have been
+  started by the account or needs SUPER. Listening again replays.
+  @param user the account, as priv_user and priv_host
+  @param after the last output the listener saw: the kept outputs after it
+    are told at once
+  @return true if the account has no such query
+*/
+bool continuous_query_listen(const std::string &user, const std::string &host,
+                             bool super, ulonglong id, ulonglong after,
+                             Continuous_query_listener *listener);
+
+/// Stop telling a listener, which is no longer called once this returns.
+void continuous_query_unlisten(ulonglong id,
+                               Continuous_query_listener *listener);
+
+struct Continuous_query_stats {
+  ulonglong queries;
+  ulonglong runs;
+  ulonglong coalesced;
+  ulonglong overruns;
+  /// Searches of the k nearest rows run again, as a row of them changed.
+  ulonglong top_k_searches;
+  /// Rows of windowed queries left out, as their window was closed.
+  ulonglong late_rows;
+  /// Parameterized queries not run on a transaction changing their table,
+  /// as it changed no row holding their constant.
+  ulonglong shared_skips;
+};
+
+Continuous_query_stats continuous_query_stats();
+
+/// A continuous query, as listed by performance_schema.continuous_queries.
+struct Continuous_query_info {
+  ulonglong id;
+  std::string user;
+  std::string host;
+  /// PERIODIC, REFRESH, ASYNC, TOP_K, GEOFENCE, WINDOW or SHARED.
+  const char *kind;
+  std::string text;
+  /// Seconds between runs as requested, 0 for ASYNC queries, and how many
+  /// times it is stretched for runs that overran.
+  ulonglong period;
+  ulonglong backoff;
+  ulonglong runs;
+  ulonglong outputs;
+  /// When the last run ended, in microseconds since the epoch; 0 before
+  /// the first one.
+  ulonglong last_refresh;
+  /// Rows of changes the runs consumed.
+  ulonglong delta_rows;
+  /// Times, in picoseconds. The quantiles are rounded up to a power of two
+  /// microseconds.
+  ulonglong sum_refresh;
+  ulonglong max_refresh;
+  ulonglong quantile_95;
+  ulonglong quantile_99;
+  ulonglong quantile_999;
+  /// From the commit of the first change a run consumed, or the tick it
+  /// came due, to the end of the run.
+  ulonglong last_lag;
+  ulonglong max_lag;
+  ulonglong sum_lag;
+  ulonglong sum_cpu_time;
+  /// Rows the handlers read, and temporary tables created on disk.
+  ulonglong sum_rows_read;
+  ulonglong sum_created_tmp_disk_tables;
+};
+
+/// The running continuous queries, by id.
+std::vector<Continuous_query_info> continuous_query_list();
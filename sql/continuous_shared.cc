@@ -0,0 +1,160 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/continuous_shared.h"
+
+#include <functional>
+
+#include "m_ctype.h"
+#include "sql/field.h"
+#include "sql/item.h"
+#include "sql/item_cmpfunc.h"
+#include "sql/item_func.h"
+#include "sql/sql_class.h"
+#include "sql/sql_lex.h"
+#include "sql/table.h"
+#include "sql_string.h"
+#include "template_utils.h"
+
+namespace {
+
+/**
+  Whether the values of a column compare equal exactly when their text, as
+  captured, does, up to the collation of the column; and whether the
+  constant compared to it must be a string for the comparison to be one of
+  strings.
+*/
+bool comparable_column(const Field *field, bool *string) {
+  switch (field->real_type()) {
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_LONGLONG:
+    case MYSQL_TYPE_YEAR:
+    case MYSQL_TYPE_NEWDECIMAL:
+    case MYSQL_TYPE_NEWDATE:
+    case MYSQL_TYPE_DATE:
+    case MYSQL_TYPE_TIME:
+    case MYSQL_TYPE_TIME2:
+    case MYSQL_TYPE_DATETIME:
+    case MYSQL_TYPE_DATETIME2:
+      *string = false;
+      return true;
+    case MYSQL_TYPE_VARCHAR:
+    case MYSQL_TYPE_VAR_STRING:
+    case MYSQL_TYPE_STRING:
+    case MYSQL_TYPE_BLOB:
+      *string = true;
+      return true;
+    default:
+      // floats compare as doubles, TIMESTAMP in the time zone of the
+      // session, ENUM and SET by their index
+      return false;
+  }
+}
+
+/// The column of a table by name, nullptr if there is none.
+Field *find_column(TABLE *table, const char *name) {
+  for (Field **field = table->field; *field != nullptr; field++) {
+    if (!(*field)->is_hidden_by_system() &&
+        my_strcasecmp(system_charset_info, (*field)->field_name, name) == 0)
+      return *field;
+  }
+  return nullptr;
+}
+
+/**
+  Whether a predicate compares a column of the table to a constant, filling
+  spec with the constant as stored in the column.
+*/
+bool match_predicate(THD *thd, TABLE *table, Item *cond,
+                     Continuous_shared_spec *spec) {
+  if (cond->type() != Item::FUNC_ITEM ||
+      down_cast<Item_func *>(cond)->functype() != Item_func::EQ_FUNC)
+    return false;
+  Item **args = down_cast<Item_func *>(cond)->arguments();
+  const uint at = args[0]->real_item()->type() == Item::FIELD_ITEM ? 0 : 1;
+  Item *const column = args[at]->real_item();
+  Item *value = args[1 - at];
+  if (column->type() != Item::FIELD_ITEM || !value->basic_const_item() ||
+      value->type() == Item::NULL_ITEM ||
+      (!value->fixed && value->fix_fields(thd, &value))) {
+    thd->clear_error();
+    return false;
+  }
+
+  Field *const field =
+      find_column(table, down_cast<Item_field *>(column)->field_name);
+  bool string;
+  if (field == nullptr || !comparable_column(field, &string) ||
+      string != (value->result_type() == STRING_RESULT))
+    return false;
+
+  // the constant is compared as stored in the column, e.g. 42.0 as 42
+  my_bitmap_map *old_map[2];
+  dbug_tmp_use_all_columns(table, old_map, table->read_set, table->write_set);
+  const bool stored =
+      value->save_in_field_no_warnings(field, true) == TYPE_OK &&
+      !field->is_null();
+  String buffer;
+  const String *text = stored ? field->val_str(&buffer) : nullptr;
+  if (text != nullptr) {
+    spec->charset = field->has_charset() ? field->charset() : nullptr;
+    spec->value_hash = continuous_shared_hash(
+        spec->charset, std::string(text->ptr(), text->length()));
+  }
+  dbug_tmp_restore_column_maps(table->read_set, table->write_set, old_map);
+  thd->clear_error();
+  if (text == nullptr) return false;
+
+  spec->db = table->s->db.str;
+  spec->table_name = table->s->table_name.str;
+  spec->column = field->field_name;
+  return true;
+}
+
+}  // namespace
+
+bool continuous_shared_match(THD *thd, TABLE *table,
+                             Continuous_shared_spec *spec) {
+  LEX *const lex = thd->lex;
+  Query_block *const block = lex->query_block;
+  Item *const where = block->where_cond();
+  if (lex->unit->first_query_block() != block ||
+      block->next_query_block() != nullptr || where == nullptr)
+    return false;
+
+  // a row whose column differs from the constant is in no result
+  if (where->type() == Item::COND_ITEM &&
+      down_cast<Item_cond *>(where)->functype() == Item_func::COND_AND_FUNC) {
+    for (Item &conjunct : *down_cast<Item_cond *>(where)->argument_list()) {
+      if (match_predicate(thd, table, &conjunct, spec)) return true;
+    }
+    return false;
+  }
+  return match_predicate(thd, table, where, spec);
+}
+
+ulonglong continuous_shared_hash(const CHARSET_INFO *charset,
+                                 const std::string &value) {
+  if (charset == nullptr) return std::hash<std::string>()(value);
+  uint64 nr1 = 1;
+  uint64 nr2 = 4;
+  charset->coll->hash_sort(charset, pointer_cast<const uchar *>(value.data()),
+                           value.size(), &nr1, &nr2);
+  return nr1;
+}
@@ -0,0 +1,73 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+/**
+  @file
+  Parameterized ASYNC continuous queries, those of a table differing only
+  in the constant a column is compared to, e.g.
+
+    SELECT * FROM orders WHERE user_id = 42 SYNC ASYNC
+    SELECT COUNT(*) FROM orders WHERE user_id = 43 AND status = 'open'
+      SYNC ASYNC
+
+  Only the rows whose column equals its constant, before or after a change,
+  can change the result of such a query. Rather than each query following
+  the changes of its table and running on every transaction, the queries of
+  a table comparing the same column share a subscription, and their
+  constants are kept in a hash table: each changed row is looked up by its
+  value before and after the change, and a query runs only on the rows
+  found for it. So a transaction costs about the same with thousands of
+  such queries as with one, and runs only the queries it concerns.
+
+  The constants are stored in the column to compare them as the statement
+  does, e.g. by its collation; those the column does not hold exactly, and
+  columns whose values do not compare as their text, are not shared.
+*/
+
+#include <string>
+
+#include "my_inttypes.h"
+
+class THD;
+struct CHARSET_INFO;
+struct TABLE;
+
+/// The routing constant of a parameterized ASYNC query.
+struct Continuous_shared_spec {
+  std::string db;
+  std::string table_name;
+  /// The column compared to the constant.
+  std::string column;
+  /// The collation of the column, nullptr if it holds no text.
+  const CHARSET_INFO *charset = nullptr;
+  /// The hash of the constant, see continuous_shared_hash.
+  ulonglong value_hash = 0;
+};
+
+/**
+  Whether the WHERE clause of the statement of thd compares a column of a
+  table to a constant, alone or in a conjunction, filling spec if so.
+  @param table the only table of the statement, open
+*/
+bool continuous_shared_match(THD *thd, TABLE *table,
+                             Continuous_shared_spec *spec);
+
+/// The hash of a value of the column, as captured, equal for the values
+/// the column compares equal.
+ulonglong continuous_shared_hash(const CHARSET_INFO *charset,
+                                 const std::string &value);
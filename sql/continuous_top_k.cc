@@ -0,0 +1,300 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/continuous_top_k.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+#include "m_ctype.h"
+#include "sql/fb_vector_distance.h"
+#include "sql/field.h"
+#include "sql/item.h"
+#include "sql/item_func.h"
+#include "sql/sql_class.h"
+#include "sql/sql_lex.h"
+#include "sql/sql_prepare.h"
+#include "sql/sql_show.h"
+#include "sql/table.h"
+#include "sql_string.h"
+#include "template_utils.h"
+
+namespace {
+
+/// Parse a vector, as floats or as a JSON array of numbers; return false
+/// if successful.
+bool parse_vector(const char *str, size_t length, bool blob,
+                  std::vector<float> *vector) {
+  vector->clear();
+  if (blob) {
+    if (length % sizeof(float) != 0) return true;
+    vector->resize(length / sizeof(float));
+    if (length > 0) memcpy(vector->data(), str, length);
+    return false;
+  }
+
+  const std::string text(str, length);
+  const char *p = text.c_str();
+  auto skip_spaces = [&p]() {
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+  };
+  skip_spaces();
+  if (*p++ != '[') return true;
+  skip_spaces();
+  if (*p == ']') return false;
+  for (;;) {
+    char *end;
+    const double value = strtod(p, &end);
+    if (end == p) return true;
+    vector->push_back(static_cast<float>(value));
+    p = end;
+    skip_spaces();
+    if (*p == ']') break;
+    if (*p++ != ',') return true;
+  }
+  p++;
+  skip_spaces();
+  return *p != '\0';
+}
+
+std::string quoted(const THD *thd, const char *name) {
+  String str;
+  append_identifier(thd, &str, name, strlen(name));
+  return std::string(str.ptr(), str.length());
+}
+
+std::string image_row(const Change_stream_image &image) {
+  std::string out("(");
+  for (size_t i = 0; i < image.values.size(); i++) {
+    if (i > 0) out.append(", ");
+    out.append(image.nulls[i] ? std::string("NULL") : image.values[i]);
+  }
+  return out.append(")");
+}
+
+}  // namespace
+
+bool continuous_top_k_match(THD *thd, TABLE *table,
+                            Continuous_top_k_spec *spec) {
+  LEX *const lex = thd->lex;
+  Query_block *const block = lex->query_block;
+  if (lex->unit->first_query_block() != block ||
+      block->next_query_block() != nullptr || block->where_cond() != nullptr ||
+      block->having_cond() != nullptr || block->group_list.elements != 0 ||
+      block->has_windows() || block->is_distinct() ||
+      block->order_list.elements != 1 || block->offset_limit != nullptr ||
+      block->select_limit == nullptr ||
+      block->select_limit->type() != Item::INT_ITEM)
+    return false;
+  const longlong limit = block->select_limit->val_int();
+  const ORDER *const order = block->order_list.first;
+  if (limit <= 0 || order->direction == ORDER_DESC) return false;
+
+  Item *const item = *order->item;
+  if (item->type() != Item::FUNC_ITEM ||
+      down_cast<Item_func *>(item)->functype() != Item_func::FB_VECTOR_L2)
+    return false;
+  Item **args = down_cast<Item_func *>(item)->arguments();
+  if (args[0]->type() != Item::FIELD_ITEM ||
+      args[1]->type() != Item::STRING_ITEM)
+    return false;
+
+  const char *name = down_cast<Item_field *>(args[0])->field_name;
+  Field *column = nullptr;
+  for (Field **field = table->field; *field != nullptr; field++) {
+    if (!(*field)->is_hidden_by_system() &&
+        my_strcasecmp(system_charset_info, (*field)->field_name, name) == 0)
+      column = *field;
+  }
+  if (column == nullptr) return false;
+  switch (column->type()) {
+    case MYSQL_TYPE_BLOB:
+      spec->blob = true;
+      break;
+    case MYSQL_TYPE_JSON:
+    case MYSQL_TYPE_VARCHAR:
+      spec->blob = false;
+      break;
+    default:
+      return false;
+  }
+
+  String buffer;
+  const String *vector = args[1]->val_str(&buffer);
+  if (vector == nullptr ||
+      parse_vector(vector->ptr(), vector->length(), false,
+                   &spec->query_vector))
+    return false;
+
+  spec->db = table->s->db.str;
+  spec->table_name = table->s->table_name.str;
+  spec->column = column->field_name;
+  spec->limit = limit;
+
+  std::string literal("[");
+  for (size_t i = 0; i < spec->query_vector.size(); i++) {
+    char number[32];
+    snprintf(number, sizeof(number), "%s%.9g", i > 0 ? "," : "",
+             spec->query_vector[i]);
+    literal.append(number);
+  }
+  literal.append("]");
+  const std::string distance =
+      "FB_VECTOR_L2(" + quoted(thd, column->field_name) + ", '" + literal +
+      "')";
+
+  std::string &text = spec->search_text;
+  text = "SELECT ";
+  for (Field **field = table->field; *field != nullptr; field++) {
+    if ((*field)->is_hidden_by_system()) continue;
+    text.append(quoted(thd, (*field)->field_name)).append(", ");
+  }
+  text.append(distance)
+      .append(" FROM ")
+      .append(quoted(thd, spec->db.c_str()))
+      .append(".")
+      .append(quoted(thd, spec->table_name.c_str()))
+      .append(" ORDER BY ")
+      .append(distance)
+      .append(" LIMIT ")
+      .append(std::to_string(spec->limit));
+  return true;
+}
+
+double Continuous_top_k::kth_distance(const std::vector<Entry> &entries) const {
+  return entries.size() < m_spec.limit ? HUGE_VAL : entries.back().distance;
+}
+
+bool Continuous_top_k::distance(const Change_stream_image &image,
+                                size_t column, double *out) const {
+  if (image.nulls[column]) return true;
+  std::vector<float> vector;
+  const std::string &value = image.values[column];
+  if (parse_vector(value.data(), value.size(), m_spec.blob, &vector))
+    return true;
+  // the shorter vector is padded with zeros, as by FB_VECTOR_L2
+  std::vector<float> query = m_spec.query_vector;
+  const size_t dimension = std::max(vector.size(), query.size());
+  vector.resize(dimension, 0.0f);
+  query.resize(dimension, 0.0f);
+  *out = fb_vector_l2sqr(vector.data(), query.data(), dimension);
+  return false;
+}
+
+bool Continuous_top_k::apply(
+    const std::vector<Change_stream_batch_ptr> &batches, bool dropped,
+    std::string *diff) {
+  if (dropped) return true;
+  std::vector<Entry> entries = m_entries;
+  for (const Change_stream_batch_ptr &batch : batches) {
+    if (batch->db != m_spec.db || batch->table_name != m_spec.table_name)
+      continue;
+    if (batch->emptied || batch->rows_dropped) return true;
+    auto column = std::find_if(
+        batch->columns.begin(), batch->columns.end(),
+        [this](const std::string &name) {
+          return my_strcasecmp(system_charset_info, name.c_str(),
+                               m_spec.column.c_str()) == 0;
+        });
+    if (column == batch->columns.end()) return true;
+    const size_t index = column - batch->columns.begin();
+
+    for (const Change_stream_row &row : batch->rows) {
+      double d;
+      // a row as near as the k-th one may be in the result
+      if (!row.before.empty() &&
+          (distance(row.before, index, &d) || d <= kth_distance(entries)))
+        return true;
+      if (row.after.empty()) continue;
+      if (distance(row.after, index, &d)) return true;
+      if (d >= kth_distance(entries)) continue;
+      // the row may already have been found by the last search
+      for (const Entry &entry : entries)
+        if (entry.distance == d) return true;
+      auto at = std::upper_bound(
+          entries.begin(), entries.end(), d,
+          [](double x, const Entry &entry) { return x < entry.distance; });
+      entries.insert(at, Entry{d, image_row(row.after)});
+      if (entries.size() > m_spec.limit) entries.pop_back();
+    }
+  }
+  append_diff(m_entries, entries, diff);
+  m_entries = std::move(entries);
+  return false;
+}
+
+void Continuous_top_k::reset(Ed_result_set *rows, std::string *diff) {
+  std::vector<Entry> entries;
+  const size_t count = rows->get_field_count();
+  List<Ed_row> &list = *rows;
+  for (const Ed_row &row : list) {
+    std::string out("(");
+    for (size_t i = 0; i + 1 < count; i++) {
+      if (i > 0) out.append(", ");
+      out.append(row[i].str == nullptr
+                     ? std::string("NULL")
+                     : std::string(row[i].str, row[i].length));
+    }
+    out.append(")");
+    // a NULL distance sorts first
+    const Ed_column &distance = row[count - 1];
+    const double d =
+        distance.str == nullptr
+            ? -HUGE_VAL
+            : strtod(std::string(distance.str, distance.length).c_str(),
+                     nullptr);
+    entries.push_back(Entry{d, std::move(out)});
+  }
+  append_diff(m_entries, entries, diff);
+  m_entries = std::move(entries);
+  m_searched = true;
+}
+
+void Continuous_top_k::append_diff(const std::vector<Entry> &from,
+                                   const std::vector<Entry> &to,
+                                   std::string *diff) {
+  // rows are told apart by their values, counting duplicates
+  std::map<std::string, int> counts;
+  for (const Entry &entry : from) counts[entry.row]++;
+  for (const Entry &entry : to) counts[entry.row]--;
+  auto line = [diff](char sign, const Entry &entry) {
+    char distance[32];
+    snprintf(distance, sizeof(distance), "%g", entry.distance);
+    diff->append(1, sign)
+        .append(" ")
+        .append(entry.row)
+        .append(" at distance ")
+        .append(distance)
+        .append("\n");
+  };
+  for (const Entry &entry : from) {
+    int &count = counts[entry.row];
+    if (count > 0) {
+      line('-', entry);
+      count--;
+    }
+  }
+  for (const Entry &entry : to) {
+    int &count = counts[entry.row];
+    if (count < 0) {
+      line('+', entry);
+      count++;
+    }
+  }
+}
@@ -0,0 +1,120 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+/**
+  @file
+  Standing results of ASYNC continuous vector searches, e.g.
+
+    SELECT * FROM items ORDER BY FB_VECTOR_L2(emb, '[0.1, 0.7, ...]') LIMIT 10
+      SYNC ASYNC
+
+  Rather than searching the k nearest rows again after every transaction
+  changing the table, the query keeps them and checks the committed changes
+  against the distance of the k-th one:
+
+  - an inserted row nearer than the k-th one takes its place;
+  - a row farther than the k-th one is neither in the result nor enters it
+    when it is deleted, or updated to a farther vector;
+  - a row as near as the k-th one or nearer that is deleted or updated may
+    leave the result, which is then searched again, for k rows only.
+
+  Rows whose distance cannot be told from their images, as their vector is
+  NULL or is not one, and changes not all delivered, e.g. TRUNCATE, also
+  search again. What entered and what left the result is logged as a diff,
+  a line per row, "+" or "-", with its distance.
+*/
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "my_inttypes.h"
+#include "sql/change_stream.h"
+
+class Ed_result_set;
+class THD;
+struct TABLE;
+
+/// What an ASYNC query searches, found in its statement.
+struct Continuous_top_k_spec {
+  std::string db;
+  std::string table_name;
+  /// The vector column, as floats in a BLOB or else as a JSON array.
+  std::string column;
+  bool blob = false;
+  std::vector<float> query_vector;
+  ulonglong limit = 0;
+  /// A statement searching the k nearest rows, selecting the visible
+  /// columns and the distance.
+  std::string search_text;
+};
+
+/**
+  Whether the statement of thd searches the k nearest rows of a table by
+  FB_VECTOR_L2 to a literal vector, and nothing else, filling spec if so.
+  @param table the only table of the statement, open
+*/
+bool continuous_top_k_match(THD *thd, TABLE *table,
+                            Continuous_top_k_spec *spec);
+
+/// The standing k nearest rows of an ASYNC query.
+class Continuous_top_k {
+ public:
+  explicit Continuous_top_k(Continuous_top_k_spec spec)
+      : m_spec(std::move(spec)) {}
+
+  const std::string &search_text() const { return m_spec.search_text; }
+
+  /// Whether the rows were searched once.
+  bool searched() const { return m_searched; }
+
+  /**
+    Enter the inserted rows nearer than the k-th one, appending the diff.
+    @param dropped changes were not all delivered
+    @return true if the rows must be searched again instead, the diff being
+      left out
+  */
+  bool apply(const std::vector<Change_stream_batch_ptr> &batches, bool dropped,
+             std::string *diff);
+
+  /// Take the rows as searched again, by search_text(), appending the diff.
+  void reset(Ed_result_set *rows, std::string *diff);
+
+ private:
+  struct Entry {
+    double distance;
+    /// The row, as "(value, ...)".
+    std::string row;
+  };
+
+  /// The distance of the k-th of entries, infinite while there are fewer.
+  double kth_distance(const std::vector<Entry> &entries) const;
+
+  /// The distance of an image to the query vector, return false if
+  /// successful.
+  bool distance(const Change_stream_image &image, size_t column,
+                double *out) const;
+
+  Continuous_top_k_spec m_spec;
+  /// The k nearest rows, nearest first.
+  std::vector<Entry> m_entries;
+  bool m_searched = false;
+
+  static void append_diff(const std::vector<Entry> &from,
+                          const std::vector<Entry> &to, std::string *diff);
+};
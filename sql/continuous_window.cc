@@ -0,0 +1,326 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/continuous_window.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "m_ctype.h"
+#include "my_time.h"
+#include "mysql_time.h"
+#include "mysqld_error.h"
+#include "sql/field.h"
+#include "sql/item.h"
+#include "sql/item_sum.h"
+#include "sql/sql_class.h"
+#include "sql/sql_lex.h"
+#include "sql/table.h"
+#include "sql/tztime.h"
+#include "template_utils.h"
+
+namespace {
+
+/// Most windows a row falls in, as sliding windows overlap.
+constexpr ulong max_overlap = 1024;
+
+longlong floor_div(longlong a, longlong b) {
+  return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+longlong to_seconds(const MYSQL_TIME &time) {
+  return static_cast<longlong>(calc_daynr(time.year, time.month, time.day)) *
+             86400 +
+         time.hour * 3600 + time.minute * 60 + time.second;
+}
+
+/// The visible column of a table by name, nullptr if there is none.
+Field *find_column(TABLE *table, const char *name) {
+  for (Field **field = table->field; *field != nullptr; field++) {
+    if (!(*field)->is_hidden_by_system() &&
+        my_strcasecmp(system_charset_info, (*field)->field_name, name) == 0)
+      return *field;
+  }
+  return nullptr;
+}
+
+/// The index of a column of a batch, its count if there is none.
+size_t batch_column(const Change_stream_batch &batch, const std::string &name) {
+  auto column = std::find_if(batch.columns.begin(), batch.columns.end(),
+                             [&name](const std::string &c) {
+                               return my_strcasecmp(system_charset_info,
+                                                    c.c_str(),
+                                                    name.c_str()) == 0;
+                             });
+  return column - batch.columns.begin();
+}
+
+}  // namespace
+
+bool continuous_window_prepare(THD *thd, TABLE *table, const char *column,
+                               ulong size, ulong step,
+                               Continuous_window_spec *spec) {
+  if (size == 0 || step == 0) {
+    my_error(ER_WRONG_ARGUMENTS, MYF(0), "WINDOW");
+    return true;
+  }
+  if (size % step != 0 || size / step > max_overlap) {
+    my_error(ER_WRONG_ARGUMENTS, MYF(0), "WINDOW ... BY");
+    return true;
+  }
+
+  LEX *const lex = thd->lex;
+  Query_block *const block = lex->query_block;
+  const bool aggregate_only =
+      lex->unit->first_query_block() == block &&
+      block->next_query_block() == nullptr && block->where_cond() == nullptr &&
+      block->having_cond() == nullptr && block->group_list.elements == 0 &&
+      !block->has_windows() && !block->is_distinct() &&
+      block->order_list.elements == 0 && block->select_limit == nullptr;
+  spec->aggregates.clear();
+  for (Item *item : block->visible_fields()) {
+    if (!aggregate_only || item->type() != Item::SUM_FUNC_ITEM) break;
+    Item_sum *const sum = down_cast<Item_sum *>(item);
+    if (sum->window() != nullptr || sum->argument_count() != 1 ||
+        (sum->sum_func() != Item_sum::COUNT_FUNC &&
+         sum->sum_func() != Item_sum::SUM_FUNC))
+      break;
+    Continuous_window_spec::Aggregate aggregate;
+    aggregate.name = item->item_name.is_set() ? item->item_name.ptr() : "";
+    Item *const arg = sum->get_arg(0);
+    if (sum->sum_func() == Item_sum::COUNT_FUNC &&
+        arg->type() == Item::INT_ITEM) {
+      aggregate.type = Continuous_window_spec::Aggregate::Type::COUNT_ROWS;
+    } else if (arg->type() == Item::FIELD_ITEM) {
+      Field *const field =
+          find_column(table, down_cast<Item_field *>(arg)->field_name);
+      if (field == nullptr) break;
+      if (sum->sum_func() == Item_sum::SUM_FUNC) {
+        const Item_result type = field->result_type();
+        if (type != INT_RESULT && type != REAL_RESULT && type != DECIMAL_RESULT)
+          break;
+        aggregate.type = Continuous_window_spec::Aggregate::Type::SUM;
+      } else {
+        aggregate.type = Continuous_window_spec::Aggregate::Type::COUNT;
+      }
+      aggregate.column = field->field_name;
+    } else {
+      break;
+    }
+    spec->aggregates.push_back(std::move(aggregate));
+  }
+  if (spec->aggregates.empty() ||
+      spec->aggregates.size() != block->num_visible_fields()) {
+    my_error(ER_NOT_SUPPORTED_YET, MYF(0),
+             "WINDOW of statements other than COUNT and SUM of the columns "
+             "of a table");
+    return true;
+  }
+
+  Field *const time = find_column(table, column);
+  if (time == nullptr) {
+    my_error(ER_BAD_FIELD_ERROR, MYF(0), column, "WINDOW");
+    return true;
+  }
+  switch (time->type()) {
+    case MYSQL_TYPE_DATE:
+    case MYSQL_TYPE_DATETIME:
+    case MYSQL_TYPE_TIMESTAMP:
+      spec->temporal = true;
+      break;
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_LONGLONG:
+      spec->temporal = false;
+      break;
+    default:
+      my_error(ER_NOT_SUPPORTED_YET, MYF(0),
+               "WINDOW on columns other than DATETIME, TIMESTAMP or integer");
+      return true;
+  }
+
+  spec->db = table->s->db.str;
+  spec->table_name = table->s->table_name.str;
+  spec->column = time->field_name;
+  spec->size = size;
+  spec->step = step;
+  if (spec->temporal) {
+    MYSQL_TIME now;
+    thd->variables.time_zone->gmt_sec_to_TIME(
+        &now, static_cast<my_time_t>(thd->query_start_in_secs()));
+    spec->started = to_seconds(now);
+  } else {
+    spec->started = thd->query_start_in_secs();
+  }
+  return false;
+}
+
+bool Continuous_window::event_time(const Change_stream_image &image,
+                                   size_t column, longlong *out) const {
+  if (image.nulls[column]) return true;
+  const std::string &value = image.values[column];
+  if (m_spec.temporal) {
+    MYSQL_TIME time;
+    MYSQL_TIME_STATUS status;
+    if (str_to_datetime(value.data(), value.size(), &time, 0, &status))
+      return true;
+    *out = to_seconds(time);
+    return false;
+  }
+  char *end;
+  *out = strtoll(value.c_str(), &end, 10);
+  return end == value.c_str();
+}
+
+bool Continuous_window::add(longlong time, const Change_stream_image &image,
+                            const std::vector<size_t> &columns, int sign) {
+  // the query did not see the rows before it started inserted
+  if (time < m_spec.started) return true;
+  const longlong size = m_spec.size;
+  const longlong step = m_spec.step;
+  bool late = false;
+  for (longlong start = floor_div(time, step) * step; start > time - size;
+       start -= step) {
+    if (start + size <= m_watermark) {
+      late = true;
+      continue;
+    }
+    Partial &window = m_windows[start];
+    if (window.counts.empty()) {
+      window.counts.resize(m_spec.aggregates.size());
+      window.sums.resize(m_spec.aggregates.size());
+    }
+    window.rows += sign;
+    for (size_t i = 0; i < m_spec.aggregates.size(); i++) {
+      if (m_spec.aggregates[i].type ==
+              Continuous_window_spec::Aggregate::Type::COUNT_ROWS ||
+          image.nulls[columns[i]])
+        continue;
+      window.counts[i] += sign;
+      if (m_spec.aggregates[i].type ==
+          Continuous_window_spec::Aggregate::Type::SUM)
+        window.sums[i] +=
+            sign * strtod(image.values[columns[i]].c_str(), nullptr);
+    }
+  }
+  return late;
+}
+
+std::string Continuous_window::format_time(longlong time) const {
+  if (!m_spec.temporal) return std::to_string(time);
+  const longlong days = floor_div(time, 86400);
+  const longlong seconds = time - days * 86400;
+  uint year, month, day;
+  get_date_from_daynr(days, &year, &month, &day);
+  char out[32];
+  snprintf(out, sizeof(out), "%04u-%02u-%02u %02u:%02u:%02u", year, month, day,
+           static_cast<uint>(seconds / 3600),
+           static_cast<uint>(seconds / 60 % 60),
+           static_cast<uint>(seconds % 60));
+  return out;
+}
+
+ulonglong Continuous_window::apply(
+    const std::vector<Change_stream_batch_ptr> &batches, bool dropped,
+    std::string *out) {
+  ulonglong late = 0;
+  bool incomplete = dropped;
+  longlong watermark = m_watermark;
+  for (const Change_stream_batch_ptr &batch : batches) {
+    if (batch->db != m_spec.db || batch->table_name != m_spec.table_name)
+      continue;
+    if (batch->emptied) {
+      for (auto &start_window : m_windows) {
+        Partial &window = start_window.second;
+        window.rows = 0;
+        std::fill(window.counts.begin(), window.counts.end(), 0);
+        std::fill(window.sums.begin(), window.sums.end(), 0.0);
+      }
+    }
+    if (batch->rows_dropped) incomplete = true;
+
+    const size_t time = batch_column(*batch, m_spec.column);
+    std::vector<size_t> columns;
+    for (const Continuous_window_spec::Aggregate &aggregate : m_spec.aggregates)
+      columns.push_back(aggregate.column.empty()
+                            ? 0
+                            : batch_column(*batch, aggregate.column));
+    if (time == batch->columns.size() ||
+        std::find(columns.begin(), columns.end(), batch->columns.size()) !=
+            columns.end()) {
+      incomplete = true;
+      continue;
+    }
+
+    for (const Change_stream_row &row : batch->rows) {
+      longlong t;
+      if (!row.before.empty() && !event_time(row.before, time, &t) &&
+          add(t, row.before, columns, -1))
+        late++;
+      if (!row.after.empty() && !event_time(row.after, time, &t)) {
+        if (add(t, row.after, columns, 1)) late++;
+        watermark = std::max(watermark, t);
+      }
+    }
+  }
+  if (incomplete)
+    for (auto &start_window : m_windows) start_window.second.incomplete = true;
+
+  // the windows all last as long, so they end in the order they start
+  m_watermark = watermark;
+  while (!m_windows.empty() &&
+         m_windows.begin()->first + static_cast<longlong>(m_spec.size) <=
+             m_watermark) {
+    const longlong start = m_windows.begin()->first;
+    const Partial &window = m_windows.begin()->second;
+    out->append("[")
+        .append(format_time(start))
+        .append(", ")
+        .append(format_time(start + m_spec.size))
+        .append("):");
+    for (size_t i = 0; i < m_spec.aggregates.size(); i++) {
+      const Continuous_window_spec::Aggregate &aggregate =
+          m_spec.aggregates[i];
+      std::string value;
+      switch (aggregate.type) {
+        case Continuous_window_spec::Aggregate::Type::COUNT_ROWS:
+          value = std::to_string(window.rows);
+          break;
+        case Continuous_window_spec::Aggregate::Type::COUNT:
+          value = std::to_string(window.counts[i]);
+          break;
+        case Continuous_window_spec::Aggregate::Type::SUM: {
+          char sum[32];
+          snprintf(sum, sizeof(sum), "%.15g", window.sums[i]);
+          value = window.counts[i] == 0 ? "NULL" : sum;
+          break;
+        }
+      }
+      out->append(i > 0 ? ", " : " ")
+          .append(aggregate.name)
+          .append(" = ")
+          .append(value);
+    }
+    if (start < m_spec.started) out->append(" (partial)");
+    if (window.incomplete) out->append(" (incomplete)");
+    out->append("\n");
+    m_windows.erase(m_windows.begin());
+  }
+  return late;
+}
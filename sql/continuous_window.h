@@ -0,0 +1,139 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+/**
+  @file
+  Windowed ASYNC continuous aggregates, e.g.
+
+    SELECT COUNT(*), SUM(amount) FROM sales SYNC ASYNC WINDOW ts 1 MINUTE
+    SELECT COUNT(*), SUM(amount) FROM sales
+      SYNC ASYNC WINDOW ts 5 MINUTE BY 1 MINUTE
+
+  count and sum the rows of a table by windows of the event time in one of
+  its columns, a DATETIME, a TIMESTAMP or a number of seconds: tumbling
+  windows of a length, or, with BY, sliding windows of a length starting
+  every step.
+
+  Rather than scanning the table at each run, the query keeps the partial
+  aggregates of the open windows and brings them up to the committed
+  changes: an inserted row adds to the windows its time falls in, a deleted
+  one subtracts from them. A run costs the rows it was run on, not the
+  table.
+
+  Windows are closed by a watermark, the latest time of the rows inserted
+  or updated until the run: once a window ends at or before it, its
+  aggregates are logged, a line per window, and dropped. Rows changed in a
+  closed window are late, counted by Continuous_query_late_rows and left
+  out, as are the rows of times before the query started, which it did not
+  see inserted; the window the query started in is logged as partial.
+  Windows whose changes were not all delivered, e.g. beyond
+  change_stream_max_rows, are logged as incomplete.
+*/
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "my_inttypes.h"
+#include "sql/change_stream.h"
+
+class THD;
+struct TABLE;
+
+/// A windowed aggregate, found in the statement of an ASYNC query.
+struct Continuous_window_spec {
+  struct Aggregate {
+    enum class Type { COUNT_ROWS, COUNT, SUM };
+    Type type;
+    /// The column counted or summed, empty for COUNT(*).
+    std::string column;
+    /// As in the result, e.g. "SUM(amount)".
+    std::string name;
+  };
+
+  std::string db;
+  std::string table_name;
+  /// The event time column.
+  std::string column;
+  /// Whether the column is a DATETIME or a TIMESTAMP, rather than seconds.
+  bool temporal = false;
+  /// Seconds a window lasts, and between the starts of two windows.
+  ulonglong size = 0;
+  ulonglong step = 0;
+  std::vector<Aggregate> aggregates;
+  /// When the query started, in seconds of the event time.
+  longlong started = 0;
+};
+
+/**
+  Check that the statement of thd counts and sums the rows of a table by
+  windows of a column, filling spec.
+  @param table the only table of the statement, open
+  @param column the event time column, named by WINDOW
+  @param size, step seconds, from WINDOW and BY
+  @return true if the statement is no windowed aggregate, with an error
+*/
+bool continuous_window_prepare(THD *thd, TABLE *table, const char *column,
+                               ulong size, ulong step,
+                               Continuous_window_spec *spec);
+
+/// The open windows of a windowed ASYNC query.
+class Continuous_window {
+ public:
+  explicit Continuous_window(Continuous_window_spec spec)
+      : m_spec(std::move(spec)), m_watermark(m_spec.started) {}
+
+  /**
+    Add the changes to the open windows, advance the watermark and append
+    the windows it closed.
+    @param dropped changes were not all delivered
+    @return the late rows
+  */
+  ulonglong apply(const std::vector<Change_stream_batch_ptr> &batches,
+                  bool dropped, std::string *out);
+
+ private:
+  struct Partial {
+    longlong rows = 0;
+    /// Per aggregate, the values counted, and their sum.
+    std::vector<longlong> counts;
+    std::vector<double> sums;
+    bool incomplete = false;
+  };
+
+  /// The event time of an image, return false if successful.
+  bool event_time(const Change_stream_image &image, size_t column,
+                  longlong *out) const;
+
+  /**
+    Add a row to the open windows its time falls in, or subtract it.
+    @param columns the columns of the aggregates in the image
+    @return whether the row is late
+  */
+  bool add(longlong time, const Change_stream_image &image,
+           const std::vector<size_t> &columns, int sign);
+
+  std::string format_time(longlong time) const;
+
+  Continuous_window_spec m_spec;
+  /// The open windows, by start.
+  std::map<longlong, Partial> m_windows;
+  /// The windows ending at or before it are closed.
+  longlong m_watermark;
+};
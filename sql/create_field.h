@@ -182,6 +182,7 @@ class Create_field {
   LEX_CSTRING m_engine_attribute = EMPTY_CSTR;
   LEX_CSTRING m_secondary_engine_attribute = EMPTY_CSTR;
   uint m_fb_vector_dimension = 0;
+  bool m_fb_vector_multi = false;
 
   Create_field()
       : after(nullptr),
@@ -779,6 +779,14 @@ bool fill_dd_columns_from_create_fields(THD *thd, dd::Abstract_table *tab_obj,
 
     if (field.m_fb_vector_dimension > 0) {
       col_options->set("fb_vector_dimension", field.m_fb_vector_dimension);
+      if (field.m_fb_vector_multi) {
+        col_options->set("fb_vector_multi", true);
+      }
+    }
+
+    // STORED ASYNC generated column
+    if (field.gcol_info && field.gcol_info->is_async()) {
+      col_options->set("gcol_async", true);
     }
   }
 
@@ -1119,6 +1127,11 @@ static void fill_dd_indexes_from_keyinfo(
       if (trained_index_id.length > 0) {
         idx_options->set("fb_vector_trained_index_id", trained_index_id.str);
       }
+      if (key->fb_vector_index_config.metric() !=
+          FB_VECTOR_INDEX_METRIC::NONE) {
+        idx_options->set("fb_vector_index_metric",
+                         (uint)key->fb_vector_index_config.metric());
+      }
     }
 
     // storing next_spatial info
@@ -71,6 +71,7 @@ static const std::set<String_type> default_valid_option_keys = {
     "explicit_tablespace",
     "key_block_size",
     "keys_disabled",
+    "materialized_view",
     "max_rows",
     "min_rows",
     "pack_keys",
@@ -72,7 +72,8 @@ static const std::set<String_type> default_valid_option_keys = {
     "treat_bit_as_char",
     "is_array",
     "gipk" /* generated implicit primary key column */,
-    "fb_vector_dimension"};
+    "fb_vector_dimension",
+    "gcol_async"};
 
 ///////////////////////////////////////////////////////////////////////////
 // Column_impl implementation.
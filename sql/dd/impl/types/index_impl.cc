@@ -71,6 +71,7 @@ static const std::set<String_type> default_valid_option_keys = {
     "fb_vector_dimension",
     "fb_vector_trained_index_table",
     "fb_vector_trained_index_id",
+    "fb_vector_index_metric",
     "next_spatial_index_type"
   };
 
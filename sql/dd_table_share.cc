@@ -1139,6 +1139,14 @@ static bool fill_column_from_dd(THD *thd, TABLE_SHARE *share,
     FB_vector_dimension dim = 0;
     column_options->get("fb_vector_dimension", &dim);
     reg_field->m_fb_vector_dimension = dim;
+    reg_field->m_fb_vector_multi = column_options->exists("fb_vector_multi");
+  }
+
+  // STORED ASYNC generated column
+  if (reg_field->gcol_info && column_options->exists("gcol_async")) {
+    bool async = false;
+    column_options->get("gcol_async", &async);
+    reg_field->gcol_info->set_async(async);
   }
 
   // Field is prepared. Store it in 'share'
@@ -1340,9 +1348,17 @@ static void fill_fb_vector_index_from_dd(MEM_ROOT *mem_root,
       }
     }
 
+    uint fb_vector_index_metric = (uint)FB_VECTOR_INDEX_METRIC::NONE;
+    if (idx_options.exists("fb_vector_index_metric")) {
+      if (idx_options.get("fb_vector_index_metric", &fb_vector_index_metric)) {
+        assert(false);
+      }
+    }
+
     keyinfo->fb_vector_index_config = FB_vector_index_config(
         (FB_VECTOR_INDEX_TYPE)fb_vector_index_type, vector_dimension,
-        trained_index_table, trained_index_id);
+        trained_index_table, trained_index_id,
+        (FB_VECTOR_INDEX_METRIC)fb_vector_index_metric);
   }
 }
 
@@ -15,6 +15,7 @@
    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
 
 #include "sql/fb_vector_base.h"
+#include <algorithm>
 #include <cassert>
 #include <map>
 #include <string_view>
@@ -28,7 +29,11 @@ static const std::map<std::string_view, FB_VECTOR_INDEX_TYPE>
     fb_vector_index_types{{"flat", FB_VECTOR_INDEX_TYPE::FLAT},
                           {"ivfflat", FB_VECTOR_INDEX_TYPE::IVFFLAT},
                           {"ivfpq", FB_VECTOR_INDEX_TYPE::IVFPQ},
-                          {"lsmidx", FB_VECTOR_INDEX_TYPE::LSMIDX}};
+                          {"lsmidx", FB_VECTOR_INDEX_TYPE::LSMIDX},
+                          {"ivfsq8", FB_VECTOR_INDEX_TYPE::IVFSQ8},
+                          {"ivffp16", FB_VECTOR_INDEX_TYPE::IVFFP16},
+                          {"graph", FB_VECTOR_INDEX_TYPE::GRAPH},
+                          {"sparse", FB_VECTOR_INDEX_TYPE::SPARSE}};
 
 /**
     return true on error
@@ -57,7 +62,8 @@ std::string_view fb_vector_index_type_to_string(FB_VECTOR_INDEX_TYPE val) {
 static const std::map<std::string_view, FB_VECTOR_INDEX_METRIC>
     fb_vector_index_metrics{{"l2", FB_VECTOR_INDEX_METRIC::L2},
                             {"ip", FB_VECTOR_INDEX_METRIC::IP},
-                            {"cosine", FB_VECTOR_INDEX_METRIC::COSINE}};
+                            {"cosine", FB_VECTOR_INDEX_METRIC::COSINE},
+                            {"maxsim", FB_VECTOR_INDEX_METRIC::MAXSIM}};
 
 /**
     return true on error
@@ -95,6 +101,21 @@ bool parse_fb_vector_from_blob(Field *field, Fb_vector &data) {
   return false;
 }
 
+bool parse_fb_vector_from_binary(const String *str, bool copy,
+                                 Fb_vector &data) {
+  if (str->length() == 0 || str->length() % sizeof(float)) {
+    return true;
+  }
+  if (copy) {
+    auto &floats = data.get_data_ref();
+    floats.resize(str->length() / sizeof(float));
+    memcpy(floats.data(), str->ptr(), str->length());
+    return false;
+  }
+  data.set_data_view(pointer_cast<const uchar *>(str->ptr()), str->length());
+  return false;
+}
+
 bool parse_fb_vector_from_json(Json_wrapper &wrapper,
                                std::vector<float> &data) {
   if (wrapper.type() != enum_json_type::J_ARRAY) {
@@ -107,7 +128,12 @@ bool parse_fb_vector_from_json(Json_wrapper &wrapper,
   if (!wrapper.is_dom()) {
     bool revert_to_dom = false;
     auto json_binary = wrapper.get_binary_value();
-    data.reserve(json_binary.element_count());
+    // arrays of doubles, as vectors are usually stored, convert in bulk
+    data.resize(json_binary.element_count());
+    if (!json_binary.get_float_array(data.data())) {
+      return false;
+    }
+    data.clear();
     for (uint32_t i = 0; i < json_binary.element_count(); i++) {
       const auto ele = json_binary.element(i);
       const auto ele_type = ele.type();
@@ -185,13 +211,120 @@ bool parse_fb_vector_from_json(Json_wrapper &wrapper,
   return false;
 }
 
-bool ensure_fb_vector(const Json_dom *dom, FB_vector_dimension dimension) {
+bool parse_fb_vector_from_json_text(const char *text, size_t length,
+                                    std::vector<float> &data) {
+  // the caller reports the value as an invalid vector
+  Json_dom_ptr dom =
+      Json_dom::parse(text, length, [](const char *, size_t) {}, [] {});
+  if (dom == nullptr) {
+    return true;
+  }
+  Json_wrapper wrapper(std::move(dom));
+  return parse_fb_vector_from_json(wrapper, data);
+}
+
+bool parse_fb_multi_vector_from_json_text(const char *text, size_t length,
+                                          FB_vector_dimension dimension,
+                                          std::vector<float> &data) {
+  Json_dom_ptr dom =
+      Json_dom::parse(text, length, [](const char *, size_t) {}, [] {});
+  if (dom == nullptr) {
+    return true;
+  }
+  Json_wrapper wrapper(std::move(dom));
+  return parse_fb_multi_vector_from_json(wrapper, dimension, data);
+}
+
+bool parse_fb_sparse_vector_from_json(const Json_wrapper &wrapper,
+                                      Fb_sparse_vector &data) {
+  if (wrapper.type() != enum_json_type::J_OBJECT) {
+    return true;
+  }
+  data.clear();
+  data.reserve(wrapper.length());
+  for (const auto &member : Json_object_wrapper(wrapper)) {
+    const MYSQL_LEX_CSTRING &key = member.first;
+    // indexes are unsigned 32 bit decimals
+    if (key.length == 0 || key.length > 10) {
+      return true;
+    }
+    uint64 index = 0;
+    for (size_t i = 0; i < key.length; i++) {
+      if (key.str[i] < '0' || key.str[i] > '9') {
+        return true;
+      }
+      index = index * 10 + (key.str[i] - '0');
+    }
+    if (index > UINT_MAX32) {
+      return true;
+    }
+    double value = 0;
+    switch (member.second.type()) {
+      case enum_json_type::J_INT:
+        value = member.second.get_int();
+        break;
+      case enum_json_type::J_UINT:
+        value = member.second.get_uint();
+        break;
+      case enum_json_type::J_DOUBLE:
+        value = member.second.get_double();
+        break;
+      default:
+        return true;
+    }
+    if (value != 0) {
+      data.emplace_back(static_cast<uint32>(index), static_cast<float>(value));
+    }
+  }
+  // object members are sorted by key length first
+  std::sort(data.begin(), data.end());
+  for (size_t i = 1; i < data.size(); i++) {
+    if (data[i].first == data[i - 1].first) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool parse_fb_multi_vector_from_json(Json_wrapper &wrapper,
+                                     FB_vector_dimension dimension,
+                                     std::vector<float> &data) {
+  if (wrapper.type() != enum_json_type::J_ARRAY || wrapper.length() == 0) {
+    return true;
+  }
+  data.clear();
+  data.reserve(wrapper.length() * dimension);
+  std::vector<float> vector;
+  for (size_t i = 0; i < wrapper.length(); i++) {
+    Json_wrapper element = wrapper[i];
+    if (parse_fb_vector_from_json(element, vector) ||
+        vector.size() != dimension) {
+      return true;
+    }
+    data.insert(data.end(), vector.begin(), vector.end());
+  }
+  return false;
+}
+
+bool ensure_fb_vector(const Json_dom *dom, FB_vector_dimension dimension,
+                      bool multi) {
   assert(dom);
   if (dom->json_type() != enum_json_type::J_ARRAY) {
     return true;
   }
 
   auto *arr = down_cast<const Json_array *>(dom);
+  if (multi) {
+    if (arr->size() == 0) {
+      return true;
+    }
+    for (auto it = arr->begin(); it != arr->end(); ++it) {
+      if (ensure_fb_vector((*it).get(), dimension)) {
+        return true;
+      }
+    }
+    return false;
+  }
   if (arr->size() != dimension) {
     return true;
   }
@@ -221,6 +354,10 @@ std::string ToString(FB_VECTOR_INDEX_TYPE v)
            case FB_VECTOR_INDEX_TYPE::IVFFLAT: return "ivfflat";
            case FB_VECTOR_INDEX_TYPE::IVFPQ: return "ivfpq";
            case FB_VECTOR_INDEX_TYPE::LSMIDX: return "lsmidx";
+           case FB_VECTOR_INDEX_TYPE::IVFSQ8: return "ivfsq8";
+           case FB_VECTOR_INDEX_TYPE::IVFFP16: return "ivffp16";
+           case FB_VECTOR_INDEX_TYPE::GRAPH: return "graph";
+           case FB_VECTOR_INDEX_TYPE::SPARSE: return "sparse";
            default:      return "[Unknown index_type]";
        }
    }
\ No newline at end of file
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "lex_string.h"
+#include "my_byteorder.h"
 #include "sql-common/json_dom.h"
 #include "sql_const.h"
 
@@ -69,6 +70,7 @@ class Fb_vector {
     assert(len % sizeof(float) == 0);
     assert(data != nullptr);
     size_t num_floats = len / sizeof(float);
+    m_data.clear();
     m_data_view = reinterpret_cast<const float *>(data);
     m_data_view_len = num_floats;
     m_own_data = false;
@@ -92,11 +94,27 @@ class Fb_vector {
 
 class Field;
 
-enum class FB_VECTOR_INDEX_TYPE { NONE, FLAT, IVFFLAT, IVFPQ, LSMIDX };
+// values are persisted in the data dictionary, only append new types
+enum class FB_VECTOR_INDEX_TYPE {
+  NONE,
+  FLAT,
+  IVFFLAT,
+  IVFPQ,
+  LSMIDX,
+  IVFSQ8,
+  IVFFP16,
+  GRAPH,
+  SPARSE
+};
 
 std::string ToString(FB_VECTOR_INDEX_TYPE v);
 
-enum class FB_VECTOR_INDEX_METRIC { NONE, L2, IP, COSINE };
+/**
+  MAXSIM indexes a multi-vector column, the rows are ranked by the sum over
+  the vectors of the query of their largest inner product with the vectors
+  of the row.
+*/
+enum class FB_VECTOR_INDEX_METRIC { NONE, L2, IP, COSINE, MAXSIM };
 
 using FB_vector_dimension = uint;
 
@@ -107,21 +125,41 @@ class FB_vector_index_config {
   FB_vector_index_config(FB_VECTOR_INDEX_TYPE type,
                          FB_vector_dimension dimension,
                          LEX_CSTRING trained_index_table,
-                         LEX_CSTRING trained_index_id)
+                         LEX_CSTRING trained_index_id,
+                         FB_VECTOR_INDEX_METRIC metric)
       : m_type(type),
         m_dimension(dimension),
         m_trained_index_table(trained_index_table),
-        m_trained_index_id(trained_index_id) {}
+        m_trained_index_id(trained_index_id),
+        m_metric(metric) {}
   FB_VECTOR_INDEX_TYPE type() const { return m_type; }
   FB_vector_dimension dimension() const { return m_dimension; }
   LEX_CSTRING trained_index_table() const { return m_trained_index_table; }
   LEX_CSTRING trained_index_id() const { return m_trained_index_id; }
+  /**
+    COSINE means vectors are stored l2 normalized, so the index only serves
+    cosine searches. NONE keeps the raw vectors for l2 and ip.
+  */
+  FB_VECTOR_INDEX_METRIC metric() const { return m_metric; }
+  bool normalized() const { return m_metric == FB_VECTOR_INDEX_METRIC::COSINE; }
+  bool multi() const { return m_metric == FB_VECTOR_INDEX_METRIC::MAXSIM; }
+  /**
+    SPARSE indexes a JSON column of sparse vectors, see Fb_sparse_vector,
+    as posting lists of their indexes for FB_VECTOR_IP.
+  */
+  bool sparse() const { return m_type == FB_VECTOR_INDEX_TYPE::SPARSE; }
+  /**
+    Multi-vector and sparse indexes only find the k best rows, they cannot
+    stream all of them in order of distance.
+  */
+  bool supports_index_scan() const { return !multi() && !sparse(); }
 
  private:
   FB_VECTOR_INDEX_TYPE m_type = FB_VECTOR_INDEX_TYPE::NONE;
   FB_vector_dimension m_dimension;
   LEX_CSTRING m_trained_index_table;
   LEX_CSTRING m_trained_index_id;
+  FB_VECTOR_INDEX_METRIC m_metric = FB_VECTOR_INDEX_METRIC::NONE;
 };
 
 /**
@@ -144,4 +182,99 @@ bool parse_fb_vector_from_blob(Field *field, Fb_vector &data);
 // Parse json values into data
 bool parse_fb_vector_from_json(Json_wrapper &wrapper, std::vector<float> &data);
 
-bool ensure_fb_vector(const Json_dom *dom, FB_vector_dimension dimension);
+/**
+  Parse a JSON array given as text, like a string stored into a vector
+  column, into data.
+
+  return true on error
+*/
+bool parse_fb_vector_from_json_text(const char *text, size_t length,
+                                    std::vector<float> &data);
+
+/**
+  A sparse vector, e.g. a learned sparse embedding, the index and value of
+  each non-zero element by ascending index. In JSON it is an object of
+  index to value, {"17": 0.4, "2048": 1.3}.
+*/
+using Fb_sparse_vector = std::vector<std::pair<uint32, float>>;
+
+/**
+  Parse a JSON object of a sparse vector into data, zero values are left
+  out.
+
+  return true on error
+*/
+bool parse_fb_sparse_vector_from_json(const Json_wrapper &wrapper,
+                                      Fb_sparse_vector &data);
+
+/**
+  Same for a multi-vector column, see parse_fb_multi_vector_from_json.
+
+  return true on error
+*/
+bool parse_fb_multi_vector_from_json_text(const char *text, size_t length,
+                                          FB_vector_dimension dimension,
+                                          std::vector<float> &data);
+
+/**
+  Parse a binary string holding a float array, in the byte order of the
+  server like the blobs of vector columns, into data_view in data. The
+  string must outlive data unless copy is set.
+
+  return true on error
+*/
+bool parse_fb_vector_from_binary(const String *str, bool copy,
+                                 Fb_vector &data);
+
+/**
+  Parse json values of a multi-vector column, an array of vectors of
+  dimension, into data one vector after the other.
+
+  return true on error
+*/
+bool parse_fb_multi_vector_from_json(Json_wrapper &wrapper,
+                                     FB_vector_dimension dimension,
+                                     std::vector<float> &data);
+
+/**
+  return true if dom is not a vector of dimension, or with multi not a
+  non-empty array of them
+*/
+bool ensure_fb_vector(const Json_dom *dom, FB_vector_dimension dimension,
+                      bool multi = false);
+
+/**
+  return true if length bytes of a vector blob are not a vector of
+  dimension, or with multi not one or more of them
+*/
+inline bool ensure_fb_vector_length(size_t length,
+                                    FB_vector_dimension dimension,
+                                    bool multi = false) {
+  const size_t vector_length = dimension * sizeof(float);
+  if (multi) return length == 0 || length % vector_length != 0;
+  return length != vector_length;
+}
+
+/**
+  The first byte of a JSON vector packed in a row image of the binary log
+  with binlog_row_value_options=PACKED_VECTOR, where no binary JSON document
+  starts with it. The elements follow as 4-byte floats, which hold them
+  exactly.
+*/
+constexpr uchar FB_VECTOR_PACKED_JSON = 0xff;
+
+/**
+  Read a JSON vector packed in a row image into an array of doubles.
+  return true if the data is not a packed vector
+*/
+inline bool fb_vector_unpack_json(const uchar *data, size_t length,
+                                  Json_array *array) {
+  if (length == 0 || data[0] != FB_VECTOR_PACKED_JSON ||
+      (length - 1) % sizeof(float) != 0)
+    return true;
+  for (size_t pos = 1; pos < length; pos += sizeof(float)) {
+    const double element = float4get(data + pos);
+    if (array->append_alias(create_dom_ptr<Json_double>(element))) return true;
+  }
+  return false;
+}
@@ -0,0 +1,521 @@
+/*
+   Copyright (c) 2023, Facebook, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/fb_vector_distance.h"
+#include <algorithm>
+#include <cmath>
+#include "my_compiler.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define FB_VECTOR_HAVE_X86_KERNELS
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define FB_VECTOR_HAVE_NEON_KERNELS
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+float cosine_from_parts(float dot, float norm1, float norm2) {
+  if (norm1 == 0 || norm2 == 0) return 0;
+  return dot / (std::sqrt(norm1) * std::sqrt(norm2));
+}
+
+float l2sqr_scalar(const float *v1, const float *v2, size_t dimension) {
+  float sum = 0;
+  for (size_t i = 0; i < dimension; i++) {
+    const float diff = v1[i] - v2[i];
+    sum += diff * diff;
+  }
+  return sum;
+}
+
+float inner_product_scalar(const float *v1, const float *v2,
+                           size_t dimension) {
+  float sum = 0;
+  for (size_t i = 0; i < dimension; i++) {
+    sum += v1[i] * v2[i];
+  }
+  return sum;
+}
+
+float cosine_scalar(const float *v1, const float *v2, size_t dimension) {
+  float dot = 0;
+  float norm1 = 0;
+  float norm2 = 0;
+  for (size_t i = 0; i < dimension; i++) {
+    dot += v1[i] * v2[i];
+    norm1 += v1[i] * v1[i];
+    norm2 += v2[i] * v2[i];
+  }
+  return cosine_from_parts(dot, norm1, norm2);
+}
+
+template <float (*inner_product)(const float *, const float *, size_t)>
+void normalize_l2(float *v, size_t dimension) {
+  const float norm = inner_product(v, v, dimension);
+  if (norm == 0) return;
+  const float scale = 1.0f / std::sqrt(norm);
+  for (size_t i = 0; i < dimension; i++) {
+    v[i] *= scale;
+  }
+}
+
+/*
+  The haversine kernels avoid libm: sin and cos are Taylor polynomials of
+  degree 19 and 18, exact to 1e-15 on [-pi/2, pi/2], and asin is a Taylor
+  polynomial of degree 31 on [0, 1/2], with asin(x) = pi/2 - 2 asin(sqrt((1 -
+  x) / 2)) above. On the earth the distances stay within 0.1 mm of the libm
+  haversine.
+*/
+constexpr double FB_SPATIAL_SIN_COEFFS[] = {
+    1.0,
+    -1.0 / 6,
+    1.0 / 120,
+    -1.0 / 5040,
+    1.0 / 362880,
+    -1.0 / 39916800,
+    1.0 / 6227020800,
+    -1.0 / 1307674368000,
+    1.0 / 355687428096000,
+    -1.0 / 121645100408832000};
+constexpr double FB_SPATIAL_COS_COEFFS[] = {
+    1.0,
+    -1.0 / 2,
+    1.0 / 24,
+    -1.0 / 720,
+    1.0 / 40320,
+    -1.0 / 3628800,
+    1.0 / 479001600,
+    -1.0 / 87178291200,
+    1.0 / 20922789888000,
+    -1.0 / 6402373705728000};
+constexpr double FB_SPATIAL_ASIN_COEFFS[] = {
+    1.0,
+    1.0 / 6,
+    3.0 / 40,
+    5.0 / 112,
+    35.0 / 1152,
+    63.0 / 2816,
+    231.0 / 13312,
+    143.0 / 10240,
+    6435.0 / 557056,
+    12155.0 / 1245184,
+    46189.0 / 5505024,
+    88179.0 / 12058624,
+    676039.0 / 104857600,
+    1300075.0 / 226492416,
+    5014575.0 / 973078528,
+    9694845.0 / 2080374784};
+constexpr double FB_SPATIAL_DEG_TO_RAD = M_PI / 180;
+
+/** polynomial in x2 with the given coefficients, lowest order first */
+template <size_t N>
+double horner_scalar(const double (&coeffs)[N], double x2) {
+  double r = coeffs[N - 1];
+  for (size_t i = N - 1; i > 0; i--) {
+    r = r * x2 + coeffs[i - 1];
+  }
+  return r;
+}
+
+double sin_scalar(double x) {
+  return x * horner_scalar(FB_SPATIAL_SIN_COEFFS, x * x);
+}
+
+double cos_scalar(double x) {
+  return horner_scalar(FB_SPATIAL_COS_COEFFS, x * x);
+}
+
+/** central angle from the haversine a, clamped to [0, 1] */
+double central_angle_scalar(double a) {
+  a = std::min(std::max(a, 0.0), 1.0);
+  const double x = std::sqrt(a);
+  const bool reduce = x > 0.5;
+  const double z = reduce ? std::sqrt((1 - x) / 2) : x;
+  const double asin_z = z * horner_scalar(FB_SPATIAL_ASIN_COEFFS, z * z);
+  return 2 * (reduce ? M_PI / 2 - 2 * asin_z : asin_z);
+}
+
+double haversine_one(const Fb_spatial_query &query, double lon, double lat) {
+  const double lat_rad = lat * FB_SPATIAL_DEG_TO_RAD;
+  double dlon = lon * FB_SPATIAL_DEG_TO_RAD - query.lon;
+  if (dlon > M_PI) {
+    dlon -= 2 * M_PI;
+  } else if (dlon < -M_PI) {
+    dlon += 2 * M_PI;
+  }
+  const double sin_dlat = sin_scalar((lat_rad - query.lat) / 2);
+  const double sin_dlon = sin_scalar(dlon / 2);
+  const double a = sin_dlat * sin_dlat +
+                   query.cos_lat * cos_scalar(lat_rad) * sin_dlon * sin_dlon;
+  return query.radius * central_angle_scalar(a);
+}
+
+void haversine_scalar(const Fb_spatial_query &query, const double *lon,
+                      const double *lat, size_t n, double *distances) {
+  for (size_t i = 0; i < n; i++) {
+    distances[i] = haversine_one(query, lon[i], lat[i]);
+  }
+}
+
+const Fb_vector_distance_kernels scalar_kernels = {
+    "scalar", l2sqr_scalar, inner_product_scalar, cosine_scalar,
+    normalize_l2<inner_product_scalar>, haversine_scalar};
+
+#ifdef FB_VECTOR_HAVE_X86_KERNELS
+
+MY_ATTRIBUTE((target("avx2,fma")))
+float hsum_sse(__m128 v) {
+  const __m128 shuf = _mm_movehdup_ps(v);
+  const __m128 sums = _mm_add_ps(v, shuf);
+  return _mm_cvtss_f32(_mm_add_ss(sums, _mm_movehl_ps(shuf, sums)));
+}
+
+MY_ATTRIBUTE((target("avx2,fma")))
+float hsum_avx2(__m256 v) {
+  return hsum_sse(
+      _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+MY_ATTRIBUTE((target("avx2,fma")))
+float l2sqr_avx2(const float *v1, const float *v2, size_t dimension) {
+  __m256 acc = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 8 <= dimension; i += 8) {
+    const __m256 diff =
+        _mm256_sub_ps(_mm256_loadu_ps(v1 + i), _mm256_loadu_ps(v2 + i));
+    acc = _mm256_fmadd_ps(diff, diff, acc);
+  }
+  return hsum_avx2(acc) + l2sqr_scalar(v1 + i, v2 + i, dimension - i);
+}
+
+MY_ATTRIBUTE((target("avx2,fma")))
+float inner_product_avx2(const float *v1, const float *v2, size_t dimension) {
+  __m256 acc = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 8 <= dimension; i += 8) {
+    acc = _mm256_fmadd_ps(_mm256_loadu_ps(v1 + i), _mm256_loadu_ps(v2 + i),
+                          acc);
+  }
+  return hsum_avx2(acc) +
+         inner_product_scalar(v1 + i, v2 + i, dimension - i);
+}
+
+MY_ATTRIBUTE((target("avx2,fma")))
+float cosine_avx2(const float *v1, const float *v2, size_t dimension) {
+  __m256 dot = _mm256_setzero_ps();
+  __m256 norm1 = _mm256_setzero_ps();
+  __m256 norm2 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 8 <= dimension; i += 8) {
+    const __m256 a = _mm256_loadu_ps(v1 + i);
+    const __m256 b = _mm256_loadu_ps(v2 + i);
+    dot = _mm256_fmadd_ps(a, b, dot);
+    norm1 = _mm256_fmadd_ps(a, a, norm1);
+    norm2 = _mm256_fmadd_ps(b, b, norm2);
+  }
+  float dot_sum = hsum_avx2(dot);
+  float norm1_sum = hsum_avx2(norm1);
+  float norm2_sum = hsum_avx2(norm2);
+  for (; i < dimension; i++) {
+    dot_sum += v1[i] * v2[i];
+    norm1_sum += v1[i] * v1[i];
+    norm2_sum += v2[i] * v2[i];
+  }
+  return cosine_from_parts(dot_sum, norm1_sum, norm2_sum);
+}
+
+template <size_t N>
+MY_ATTRIBUTE((target("avx2,fma")))
+__m256d horner_avx2(const double (&coeffs)[N], __m256d x2) {
+  __m256d r = _mm256_set1_pd(coeffs[N - 1]);
+  for (size_t i = N - 1; i > 0; i--) {
+    r = _mm256_fmadd_pd(r, x2, _mm256_set1_pd(coeffs[i - 1]));
+  }
+  return r;
+}
+
+MY_ATTRIBUTE((target("avx2,fma")))
+__m256d sin_avx2(__m256d x) {
+  return _mm256_mul_pd(
+      x, horner_avx2(FB_SPATIAL_SIN_COEFFS, _mm256_mul_pd(x, x)));
+}
+
+MY_ATTRIBUTE((target("avx2,fma")))
+void haversine_avx2(const Fb_spatial_query &query, const double *lon,
+                    const double *lat, size_t n, double *distances) {
+  const __m256d deg_to_rad = _mm256_set1_pd(FB_SPATIAL_DEG_TO_RAD);
+  const __m256d half = _mm256_set1_pd(0.5);
+  const __m256d one = _mm256_set1_pd(1);
+  const __m256d pi = _mm256_set1_pd(M_PI);
+  const __m256d minus_pi = _mm256_set1_pd(-M_PI);
+  const __m256d two_pi = _mm256_set1_pd(2 * M_PI);
+  const __m256d query_lon = _mm256_set1_pd(query.lon);
+  const __m256d query_lat = _mm256_set1_pd(query.lat);
+  const __m256d query_cos_lat = _mm256_set1_pd(query.cos_lat);
+  const __m256d diameter = _mm256_set1_pd(2 * query.radius);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256d lat_rad = _mm256_mul_pd(_mm256_loadu_pd(lat + i), deg_to_rad);
+    __m256d dlon = _mm256_fmsub_pd(_mm256_loadu_pd(lon + i), deg_to_rad,
+                                   query_lon);
+    // wrap the longitude difference into [-pi, pi]
+    dlon = _mm256_sub_pd(
+        dlon, _mm256_and_pd(_mm256_cmp_pd(dlon, pi, _CMP_GT_OQ), two_pi));
+    dlon = _mm256_add_pd(
+        dlon, _mm256_and_pd(_mm256_cmp_pd(dlon, minus_pi, _CMP_LT_OQ), two_pi));
+    const __m256d sin_dlat =
+        sin_avx2(_mm256_mul_pd(_mm256_sub_pd(lat_rad, query_lat), half));
+    const __m256d sin_dlon = sin_avx2(_mm256_mul_pd(dlon, half));
+    const __m256d cos_lat = horner_avx2(FB_SPATIAL_COS_COEFFS,
+                                        _mm256_mul_pd(lat_rad, lat_rad));
+    __m256d a = _mm256_mul_pd(_mm256_mul_pd(query_cos_lat, cos_lat),
+                              _mm256_mul_pd(sin_dlon, sin_dlon));
+    a = _mm256_fmadd_pd(sin_dlat, sin_dlat, a);
+    a = _mm256_min_pd(_mm256_max_pd(a, _mm256_setzero_pd()), one);
+
+    // asin(sqrt(a)), reduced to [0, 1/2] as in central_angle_scalar()
+    const __m256d x = _mm256_sqrt_pd(a);
+    const __m256d reduce = _mm256_cmp_pd(x, half, _CMP_GT_OQ);
+    const __m256d z = _mm256_blendv_pd(
+        x, _mm256_sqrt_pd(_mm256_mul_pd(_mm256_sub_pd(one, x), half)), reduce);
+    const __m256d asin_z = _mm256_mul_pd(
+        z, horner_avx2(FB_SPATIAL_ASIN_COEFFS, _mm256_mul_pd(z, z)));
+    const __m256d angle = _mm256_blendv_pd(
+        asin_z,
+        _mm256_fnmadd_pd(_mm256_set1_pd(2), asin_z,
+                         _mm256_mul_pd(pi, half)),
+        reduce);
+    _mm256_storeu_pd(distances + i, _mm256_mul_pd(diameter, angle));
+  }
+  haversine_scalar(query, lon + i, lat + i, n - i, distances + i);
+}
+
+const Fb_vector_distance_kernels avx2_kernels = {
+    "avx2", l2sqr_avx2, inner_product_avx2, cosine_avx2,
+    normalize_l2<inner_product_avx2>, haversine_avx2};
+
+// spills the lanes instead of using _mm512_reduce_add_ps or lane shuffles,
+// which trip -Wuninitialized on gcc 12 (gcc bug 105593)
+MY_ATTRIBUTE((target("avx512f")))
+float hsum_avx512(__m512 v) {
+  alignas(64) float lanes[16];
+  _mm512_store_ps(lanes, v);
+  float sum = 0;
+  for (const float lane : lanes) {
+    sum += lane;
+  }
+  return sum;
+}
+
+MY_ATTRIBUTE((target("avx512f")))
+float l2sqr_avx512(const float *v1, const float *v2, size_t dimension) {
+  __m512 acc = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= dimension; i += 16) {
+    const __m512 diff =
+        _mm512_sub_ps(_mm512_loadu_ps(v1 + i), _mm512_loadu_ps(v2 + i));
+    acc = _mm512_fmadd_ps(diff, diff, acc);
+  }
+  return hsum_avx512(acc) +
+         l2sqr_scalar(v1 + i, v2 + i, dimension - i);
+}
+
+MY_ATTRIBUTE((target("avx512f")))
+float inner_product_avx512(const float *v1, const float *v2,
+                           size_t dimension) {
+  __m512 acc = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= dimension; i += 16) {
+    acc = _mm512_fmadd_ps(_mm512_loadu_ps(v1 + i), _mm512_loadu_ps(v2 + i),
+                          acc);
+  }
+  return hsum_avx512(acc) +
+         inner_product_scalar(v1 + i, v2 + i, dimension - i);
+}
+
+MY_ATTRIBUTE((target("avx512f")))
+float cosine_avx512(const float *v1, const float *v2, size_t dimension) {
+  __m512 dot = _mm512_setzero_ps();
+  __m512 norm1 = _mm512_setzero_ps();
+  __m512 norm2 = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= dimension; i += 16) {
+    const __m512 a = _mm512_loadu_ps(v1 + i);
+    const __m512 b = _mm512_loadu_ps(v2 + i);
+    dot = _mm512_fmadd_ps(a, b, dot);
+    norm1 = _mm512_fmadd_ps(a, a, norm1);
+    norm2 = _mm512_fmadd_ps(b, b, norm2);
+  }
+  float dot_sum = hsum_avx512(dot);
+  float norm1_sum = hsum_avx512(norm1);
+  float norm2_sum = hsum_avx512(norm2);
+  for (; i < dimension; i++) {
+    dot_sum += v1[i] * v2[i];
+    norm1_sum += v1[i] * v1[i];
+    norm2_sum += v2[i] * v2[i];
+  }
+  return cosine_from_parts(dot_sum, norm1_sum, norm2_sum);
+}
+
+// four lanes of doubles already keep the haversine out of libm, every
+// avx512 cpu has avx2 and fma as well
+const Fb_vector_distance_kernels avx512_kernels = {
+    "avx512", l2sqr_avx512, inner_product_avx512, cosine_avx512,
+    normalize_l2<inner_product_avx512>, haversine_avx2};
+
+#endif  // FB_VECTOR_HAVE_X86_KERNELS
+
+#ifdef FB_VECTOR_HAVE_NEON_KERNELS
+
+float l2sqr_neon(const float *v1, const float *v2, size_t dimension) {
+  float32x4_t acc = vdupq_n_f32(0);
+  size_t i = 0;
+  for (; i + 4 <= dimension; i += 4) {
+    const float32x4_t diff = vsubq_f32(vld1q_f32(v1 + i), vld1q_f32(v2 + i));
+    acc = vfmaq_f32(acc, diff, diff);
+  }
+  return vaddvq_f32(acc) + l2sqr_scalar(v1 + i, v2 + i, dimension - i);
+}
+
+float inner_product_neon(const float *v1, const float *v2, size_t dimension) {
+  float32x4_t acc = vdupq_n_f32(0);
+  size_t i = 0;
+  for (; i + 4 <= dimension; i += 4) {
+    acc = vfmaq_f32(acc, vld1q_f32(v1 + i), vld1q_f32(v2 + i));
+  }
+  return vaddvq_f32(acc) +
+         inner_product_scalar(v1 + i, v2 + i, dimension - i);
+}
+
+float cosine_neon(const float *v1, const float *v2, size_t dimension) {
+  float32x4_t dot = vdupq_n_f32(0);
+  float32x4_t norm1 = vdupq_n_f32(0);
+  float32x4_t norm2 = vdupq_n_f32(0);
+  size_t i = 0;
+  for (; i + 4 <= dimension; i += 4) {
+    const float32x4_t a = vld1q_f32(v1 + i);
+    const float32x4_t b = vld1q_f32(v2 + i);
+    dot = vfmaq_f32(dot, a, b);
+    norm1 = vfmaq_f32(norm1, a, a);
+    norm2 = vfmaq_f32(norm2, b, b);
+  }
+  float dot_sum = vaddvq_f32(dot);
+  float norm1_sum = vaddvq_f32(norm1);
+  float norm2_sum = vaddvq_f32(norm2);
+  for (; i < dimension; i++) {
+    dot_sum += v1[i] * v2[i];
+    norm1_sum += v1[i] * v1[i];
+    norm2_sum += v2[i] * v2[i];
+  }
+  return cosine_from_parts(dot_sum, norm1_sum, norm2_sum);
+}
+
+template <size_t N>
+float64x2_t horner_neon(const double (&coeffs)[N], float64x2_t x2) {
+  float64x2_t r = vdupq_n_f64(coeffs[N - 1]);
+  for (size_t i = N - 1; i > 0; i--) {
+    r = vfmaq_f64(vdupq_n_f64(coeffs[i - 1]), r, x2);
+  }
+  return r;
+}
+
+float64x2_t sin_neon(float64x2_t x) {
+  return vmulq_f64(x, horner_neon(FB_SPATIAL_SIN_COEFFS, vmulq_f64(x, x)));
+}
+
+void haversine_neon(const Fb_spatial_query &query, const double *lon,
+                    const double *lat, size_t n, double *distances) {
+  const float64x2_t deg_to_rad = vdupq_n_f64(FB_SPATIAL_DEG_TO_RAD);
+  const float64x2_t half = vdupq_n_f64(0.5);
+  const float64x2_t one = vdupq_n_f64(1);
+  const float64x2_t pi = vdupq_n_f64(M_PI);
+  const float64x2_t two_pi = vdupq_n_f64(2 * M_PI);
+  const float64x2_t query_lon = vdupq_n_f64(query.lon);
+  const float64x2_t query_lat = vdupq_n_f64(query.lat);
+  const float64x2_t query_cos_lat = vdupq_n_f64(query.cos_lat);
+  const float64x2_t diameter = vdupq_n_f64(2 * query.radius);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    const float64x2_t lat_rad = vmulq_f64(vld1q_f64(lat + i), deg_to_rad);
+    float64x2_t dlon =
+        vsubq_f64(vmulq_f64(vld1q_f64(lon + i), deg_to_rad), query_lon);
+    // wrap the longitude difference into [-pi, pi]
+    dlon = vbslq_f64(vcgtq_f64(dlon, pi), vsubq_f64(dlon, two_pi), dlon);
+    dlon = vbslq_f64(vcltq_f64(dlon, vnegq_f64(pi)), vaddq_f64(dlon, two_pi),
+                     dlon);
+    const float64x2_t sin_dlat =
+        sin_neon(vmulq_f64(vsubq_f64(lat_rad, query_lat), half));
+    const float64x2_t sin_dlon = sin_neon(vmulq_f64(dlon, half));
+    const float64x2_t cos_lat =
+        horner_neon(FB_SPATIAL_COS_COEFFS, vmulq_f64(lat_rad, lat_rad));
+    float64x2_t a = vmulq_f64(vmulq_f64(query_cos_lat, cos_lat),
+                              vmulq_f64(sin_dlon, sin_dlon));
+    a = vfmaq_f64(a, sin_dlat, sin_dlat);
+    a = vminq_f64(vmaxq_f64(a, vdupq_n_f64(0)), one);
+
+    // asin(sqrt(a)), reduced to [0, 1/2] as in central_angle_scalar()
+    const float64x2_t x = vsqrtq_f64(a);
+    const uint64x2_t reduce = vcgtq_f64(x, half);
+    const float64x2_t z = vbslq_f64(
+        reduce, vsqrtq_f64(vmulq_f64(vsubq_f64(one, x), half)), x);
+    const float64x2_t asin_z =
+        vmulq_f64(z, horner_neon(FB_SPATIAL_ASIN_COEFFS, vmulq_f64(z, z)));
+    const float64x2_t angle = vbslq_f64(
+        reduce, vfmsq_f64(vmulq_f64(pi, half), vdupq_n_f64(2), asin_z),
+        asin_z);
+    vst1q_f64(distances + i, vmulq_f64(diameter, angle));
+  }
+  haversine_scalar(query, lon + i, lat + i, n - i, distances + i);
+}
+
+const Fb_vector_distance_kernels neon_kernels = {
+    "neon", l2sqr_neon, inner_product_neon, cosine_neon,
+    normalize_l2<inner_product_neon>, haversine_neon};
+
+#endif  // FB_VECTOR_HAVE_NEON_KERNELS
+
+const Fb_vector_distance_kernels &select_kernels() {
+#if defined(FB_VECTOR_HAVE_X86_KERNELS)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return avx512_kernels;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return avx2_kernels;
+  }
+  return scalar_kernels;
+#elif defined(FB_VECTOR_HAVE_NEON_KERNELS)
+  // advanced simd is mandatory on aarch64
+  return neon_kernels;
+#else
+  return scalar_kernels;
+#endif
+}
+
+}  // namespace
+
+const Fb_vector_distance_kernels &fb_vector_distance_kernels() {
+  static const Fb_vector_distance_kernels &kernels = select_kernels();
+  return kernels;
+}
+
+Fb_spatial_query fb_spatial_query(double lon_deg, double lat_deg,
+                                  double radius) {
+  const double lat = lat_deg * FB_SPATIAL_DEG_TO_RAD;
+  return {lon_deg * FB_SPATIAL_DEG_TO_RAD, lat, cos_scalar(lat), radius};
+}
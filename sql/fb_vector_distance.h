@@ -0,0 +1,147 @@
+/*
+   Copyright (c) 2023, Facebook, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/**
+  query side of a great circle distance, with the trig of the query latitude
+  done once for all the points measured against it. see fb_spatial_query().
+*/
+struct Fb_spatial_query {
+  /** query longitude and latitude in radians */
+  double lon;
+  double lat;
+  /** cosine of lat */
+  double cos_lat;
+  /** sphere radius, distances come out in its unit */
+  double radius;
+};
+
+/**
+  distance kernels for float vectors. the implementation is picked once from
+  the instruction sets the cpu reports at runtime, so the server binary does
+  not need to be compiled for the host it runs on.
+*/
+struct Fb_vector_distance_kernels {
+  /** instruction set the kernels were compiled for, e.g. "avx2" */
+  const char *name;
+  /** squared l2 distance */
+  float (*l2sqr)(const float *v1, const float *v2, size_t dimension);
+  /** inner product */
+  float (*inner_product)(const float *v1, const float *v2, size_t dimension);
+  /** cosine similarity, 0 when either vector is all zero */
+  float (*cosine)(const float *v1, const float *v2, size_t dimension);
+  /** scale vector to unit l2 norm in place, zero vectors are left alone */
+  void (*normalize_l2)(float *v, size_t dimension);
+  /**
+    great circle distances from the query to n points with longitudes and
+    latitudes in degrees. within 0.1 mm of the libm haversine on the earth.
+  */
+  void (*haversine)(const Fb_spatial_query &query, const double *lon,
+                    const double *lat, size_t n, double *distances);
+};
+
+/**
+  kernels selected for this cpu
+*/
+const Fb_vector_distance_kernels &fb_vector_distance_kernels();
+
+inline float fb_vector_l2sqr(const float *v1, const float *v2,
+                             size_t dimension) {
+  return fb_vector_distance_kernels().l2sqr(v1, v2, dimension);
+}
+
+inline float fb_vector_inner_product(const float *v1, const float *v2,
+                                     size_t dimension) {
+  return fb_vector_distance_kernels().inner_product(v1, v2, dimension);
+}
+
+inline float fb_vector_cosine(const float *v1, const float *v2,
+                              size_t dimension) {
+  return fb_vector_distance_kernels().cosine(v1, v2, dimension);
+}
+
+inline void fb_vector_normalize_l2(float *v, size_t dimension) {
+  fb_vector_distance_kernels().normalize_l2(v, dimension);
+}
+
+/**
+  late interaction score of nquery query vectors against ndoc vectors of a
+  document: the sum over the query vectors of their largest inner product
+  with a document vector
+*/
+inline float fb_vector_maxsim(const float *query, size_t nquery,
+                              const float *doc, size_t ndoc,
+                              size_t dimension) {
+  const auto inner_product = fb_vector_distance_kernels().inner_product;
+  float score = 0;
+  for (size_t q = 0; q < nquery; q++, query += dimension) {
+    float best = inner_product(query, doc, dimension);
+    for (size_t d = 1; d < ndoc; d++) {
+      best = std::max(best, inner_product(query, doc + d * dimension,
+                                          dimension));
+    }
+    score += best;
+  }
+  return score;
+}
+
+/**
+  inner product of two sparse vectors, their non-zero elements as index and
+  value by ascending index, see Fb_sparse_vector
+*/
+inline float fb_vector_sparse_inner_product(
+    const std::pair<uint32_t, float> *v1, size_t n1,
+    const std::pair<uint32_t, float> *v2, size_t n2) {
+  float score = 0;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < n1 && j < n2) {
+    if (v1[i].first < v2[j].first) {
+      i++;
+    } else if (v2[j].first < v1[i].first) {
+      j++;
+    } else {
+      score += v1[i++].second * v2[j++].second;
+    }
+  }
+  return score;
+}
+
+/**
+  query of a great circle distance around lon_deg, lat_deg on a sphere of
+  the given radius
+*/
+Fb_spatial_query fb_spatial_query(double lon_deg, double lat_deg,
+                                  double radius);
+
+inline void fb_spatial_distances(const Fb_spatial_query &query,
+                                 const double *lon, const double *lat,
+                                 size_t n, double *distances) {
+  fb_vector_distance_kernels().haversine(query, lon, lat, n, distances);
+}
+
+inline double fb_spatial_distance(const Fb_spatial_query &query, double lon,
+                                  double lat) {
+  double distance;
+  fb_spatial_distances(query, &lon, &lat, 1, &distance);
+  return distance;
+}
@@ -7006,7 +7006,8 @@ type_conversion_status Field_blob::store_to_mem(const char *from, size_t length,
   assert(length <= max_data_length());
   // for vector blob storage, make sure each element in the vector is 4 bytes
   if (m_fb_vector_dimension > 0 && type() == MYSQL_TYPE_BLOB &&
-      m_fb_vector_dimension * sizeof(float) != length) {
+      ensure_fb_vector_length(length, m_fb_vector_dimension,
+                              m_fb_vector_multi)) {
     my_error(ER_INVALID_VECTOR, MYF(0));
     return TYPE_ERR_BAD_VALUE;
   }
@@ -7029,9 +7030,26 @@ type_conversion_status Field_blob::store_to_mem(const char *from, size_t length,
 type_conversion_status Field_blob::store_internal(const char *from,
                                                   size_t length,
                                                   const CHARSET_INFO *cs) {
+  std::vector<float> vector;
+  if (m_fb_vector_dimension > 0 && type() == MYSQL_TYPE_BLOB &&
+      cs != &my_charset_bin) {
+    // cast JSON arrays given as text to the float array stored
+    if (m_fb_vector_multi
+            ? parse_fb_multi_vector_from_json_text(from, length,
+                                                   m_fb_vector_dimension,
+                                                   vector)
+            : parse_fb_vector_from_json_text(from, length, vector)) {
+      my_error(ER_INVALID_VECTOR, MYF(0));
+      return TYPE_ERR_BAD_VALUE;
+    }
+    from = reinterpret_cast<const char *>(vector.data());
+    length = vector.size() * sizeof(float);
+    cs = &my_charset_bin;
+  }
   // for vector blob storage, make sure each element in the vector is 4 bytes
   if (m_fb_vector_dimension > 0 && type() == MYSQL_TYPE_BLOB &&
-      m_fb_vector_dimension * sizeof(float) != length) {
+      ensure_fb_vector_length(length, m_fb_vector_dimension,
+                              m_fb_vector_multi)) {
     my_error(ER_INVALID_VECTOR, MYF(0));
     return TYPE_ERR_BAD_VALUE;
   }
@@ -7680,7 +7698,7 @@ type_conversion_status Field_json::store(const char *from, size_t length,
     return TYPE_ERR_BAD_VALUE;
 
   if (m_fb_vector_dimension > 0 &&
-      ensure_fb_vector(dom.get(), m_fb_vector_dimension)) {
+      ensure_fb_vector(dom.get(), m_fb_vector_dimension, m_fb_vector_multi)) {
     my_error(ER_INVALID_VECTOR, MYF(0));
     return TYPE_ERR_BAD_VALUE;
   }
@@ -7760,7 +7778,7 @@ type_conversion_status Field_json::store_json(const Json_wrapper *json) {
 
   if (m_fb_vector_dimension > 0 &&
       ensure_fb_vector(const_cast<Json_wrapper *>(json)->to_dom(),
-                       m_fb_vector_dimension)) {
+                       m_fb_vector_dimension, m_fb_vector_multi)) {
     my_error(ER_INVALID_VECTOR, MYF(0));
     return TYPE_ERR_BAD_VALUE;
   }
@@ -8034,6 +8052,57 @@ bool Field_json::unpack_diff(const uchar **from) {
   return false;
 }
 
+bool Field_json::pack_vector(uchar **to, ptrdiff_t row_offset) const {
+  if (m_fb_vector_dimension == 0 || m_fb_vector_multi) return true;
+
+  const uint32 length = get_length(row_offset);
+  const uchar *data = get_blob_data(ptr + packlength + row_offset);
+  const json_binary::Value value =
+      json_binary::parse_binary(pointer_cast<const char *>(data), length);
+  if (value.type() != json_binary::Value::ARRAY ||
+      value.element_count() != m_fb_vector_dimension)
+    return true;
+  for (size_t i = 0; i < value.element_count(); i++) {
+    const json_binary::Value element = value.element(i);
+    if (element.type() != json_binary::Value::DOUBLE ||
+        static_cast<float>(element.get_double()) != element.get_double())
+      return true;
+  }
+
+  const uint32 packed_length = 1 + m_fb_vector_dimension * sizeof(float);
+  if (packed_length >= length) return true;
+
+  assert(packlength == 4);
+  uchar *pos = *to;
+  int4store(pos, packed_length);
+  pos += 4;
+  *pos++ = FB_VECTOR_PACKED_JSON;
+  for (size_t i = 0; i < value.element_count(); i++) {
+    float4store(pos, static_cast<float>(value.element(i).get_double()));
+    pos += sizeof(float);
+  }
+  *to = pos;
+  return false;
+}
+
+bool Field_json::is_packed_vector(const uchar *from, uint param_data) {
+  return get_length(from, param_data) > 0 &&
+         from[param_data] == FB_VECTOR_PACKED_JSON;
+}
+
+bool Field_json::unpack_vector(const uchar **from, uint param_data) {
+  const uint32 length = get_length(*from, param_data);
+  Json_array array;
+  if (fb_vector_unpack_json(*from + param_data, length, &array)) {
+    my_error(ER_SLAVE_CORRUPT_EVENT, MYF(0));
+    return true;
+  }
+  Json_wrapper wrapper(&array, true);
+  if (store_json(&wrapper) != TYPE_OK) return true;
+  *from += param_data + length;
+  return false;
+}
+
 bool Field_json::get_date(MYSQL_TIME *ltime, my_time_flags_t) const {
   ASSERT_COLUMN_MARKED_FOR_READ;
 
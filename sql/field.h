@@ -537,6 +537,12 @@ class Value_generator {
 
   bool get_field_stored() const { return stored_in_db; }
   void set_field_stored(bool stored) { stored_in_db = stored; }
+  /**
+    Whether the stored column is filled in the background after the row is
+    written (STORED ASYNC), see semantic_materializer.h.
+  */
+  bool is_async() const { return async; }
+  void set_async(bool value) { async = value; }
   bool register_base_columns(TABLE *table);
   /**
     Get the number of non virtual base columns that this generated
@@ -571,6 +577,8 @@ class Value_generator {
   enum_field_types field_type{MYSQL_TYPE_INVALID};
   /// Indicates if the field is physically stored in the database
   bool stored_in_db{false};
+  /// Indicates if the field is filled in the background, see is_async()
+  bool async{false};
   /// How many non-virtual base columns in base_columns_map
   uint num_non_virtual_base_cols{0};
 };
@@ -785,6 +793,8 @@ class Field {
   LEX_CSTRING m_engine_attribute = EMPTY_CSTR;
   LEX_CSTRING m_secondary_engine_attribute = EMPTY_CSTR;
   FB_vector_dimension m_fb_vector_dimension = 0;
+  /// The column holds one or more vectors of m_fb_vector_dimension.
+  bool m_fb_vector_multi = false;
 
  private:
   enum enum_pushed_warnings {
@@ -4020,6 +4030,40 @@ class Field_json : public Field_blob {
   */
   bool unpack_diff(const uchar **from);
 
+  /**
+    Write a vector in the packed form of
+    binlog_row_value_options=PACKED_VECTOR, if its elements are all doubles
+    a float holds exactly, so that the document read back is the same.
+
+    @param[in,out] to Pointer to buffer where the value is written.
+    @param row_offset The offset of the record the value is read from.
+
+    @retval false The value was written.
+    @retval true The value is not a vector that can be packed, and nothing
+    was written.
+  */
+  bool pack_vector(uchar **to, ptrdiff_t row_offset) const;
+
+  /**
+    Whether the value of a row image at from is a packed vector.
+
+    @param from Pointer to the length of the value.
+    @param param_data The number of bytes of the length.
+  */
+  static bool is_packed_vector(const uchar *from, uint param_data);
+
+  /**
+    Read a packed vector from a row image into this field.
+
+    @param[in,out] from Pointer to the length of the value. This will be
+    changed to point to the next byte after the field.
+    @param param_data The number of bytes of the length.
+
+    @retval false Success
+    @retval true Error. The error has been reported through my_error.
+  */
+  bool unpack_vector(const uchar **from, uint param_data);
+
   /**
     Retrieve the field's value as a JSON wrapper. It
     there is an error, wr is not modified and we return
@@ -565,6 +565,24 @@ static type_conversion_status do_field_fb_vector(Copy_field *copy_field,
   }
   // check from_field could be converted to a fb_vector or not
   const auto from_field_type = from_field->type();
+  if (from_field_type == MYSQL_TYPE_JSON &&
+      to_field->type() == MYSQL_TYPE_BLOB) {
+    // cast the JSON array to the float array of the vector blob
+    const Field_json *from_json = down_cast<const Field_json *>(from_field);
+    Json_wrapper wr;
+    std::vector<float> vector;
+    if (from_json->val_json(&wr) ||
+        (to_field->m_fb_vector_multi
+             ? parse_fb_multi_vector_from_json(
+                   wr, to_field->m_fb_vector_dimension, vector)
+             : parse_fb_vector_from_json(wr, vector) ||
+                   vector.size() != to_field->m_fb_vector_dimension)) {
+      my_error(ER_INVALID_VECTOR, MYF(0));
+      return TYPE_ERR_BAD_VALUE;
+    }
+    return to_field->store(reinterpret_cast<const char *>(vector.data()),
+                           vector.size() * sizeof(float), &my_charset_bin);
+  }
   if ((to_field->type() != from_field->type()) ||
       (from_field_type != MYSQL_TYPE_JSON &&
        from_field_type != MYSQL_TYPE_BLOB)) {
@@ -578,14 +596,16 @@ static type_conversion_status do_field_fb_vector(Copy_field *copy_field,
       my_error(ER_INVALID_VECTOR, MYF(0));
       return TYPE_ERR_BAD_VALUE;
     }
-    if (ensure_fb_vector(wr.to_dom(), to_field->m_fb_vector_dimension)) {
+    if (ensure_fb_vector(wr.to_dom(), to_field->m_fb_vector_dimension,
+                         to_field->m_fb_vector_multi)) {
       my_error(ER_INVALID_VECTOR, MYF(0));
       return TYPE_ERR_BAD_VALUE;
     }
   } else {
     const Field_blob *from_blob = down_cast<const Field_blob *>(from_field);
-    if (to_field->m_fb_vector_dimension * sizeof(float) !=
-        from_blob->get_length()) {
+    if (ensure_fb_vector_length(from_blob->get_length(),
+                                to_field->m_fb_vector_dimension,
+                                to_field->m_fb_vector_multi)) {
       my_error(ER_INVALID_VECTOR, MYF(0));
       return TYPE_ERR_BAD_VALUE;
     }
@@ -648,8 +668,9 @@ Copy_field::Copy_func *Copy_field::get_copy_func() {
 
   // if we are copying to a vector column and the dimensions are different
   if (m_to_field->m_fb_vector_dimension > 0 &&
-      m_to_field->m_fb_vector_dimension !=
-          m_from_field->m_fb_vector_dimension) {
+      (m_to_field->m_fb_vector_dimension !=
+           m_from_field->m_fb_vector_dimension ||
+       m_to_field->m_fb_vector_multi != m_from_field->m_fb_vector_multi)) {
     return do_field_fb_vector;
   }
 
@@ -135,6 +135,19 @@ struct Mem_compare_queue_key {
   Sort_param *m_param;
 };
 
+/**
+  Whether key, made by Sort_param::make_sortkey_key(), orders after the
+  sort key of record. Row IDs are not compared, so a key equal to the one
+  of the record does not order after it.
+*/
+bool key_sorts_after(const Sort_param *param, const uchar *record,
+                     const uchar *key, uint key_length) {
+  if (param->using_varlen_keys())
+    return cmp_varlen_keys(param->local_sortorder, param->use_hash, record,
+                           key);
+  return memcmp(record, key, key_length) < 0;
+}
+
 }  // namespace
 
 /* functions defined in this file */
@@ -477,6 +490,7 @@ bool filesort(THD *thd, Filesort *filesort, RowIterator *source_iterator,
 #endif /* NDEBUG */
 
   thd->inc_status_sort_scan();
+  fs_info->set_large_pages(thd->variables.large_page_query_buffers);
 
   Bounded_queue<uchar *, uchar *, Sort_param, Mem_compare_queue_key> pq(
       param->max_record_length(),
@@ -990,6 +1004,10 @@ static ha_rows read_all_rows(
   size_t longest_key_so_far = 0;
   size_t longest_addon_so_far = 0;
 
+  // The sort key of a row, made before it is known to enter the queue.
+  std::vector<uchar> pq_key;
+  if (pq != nullptr) pq_key.resize(param->max_record_length() + 1);
+
   // NOTE(sgunders): When we sort row IDs, our read sets are a bit larger
   // than required by read_all_rows(); in particular, columns that we
   // don't sort on will still be read. (In particular, this makes us read
@@ -1050,7 +1068,20 @@ static ha_rows read_all_rows(
 
     ++(*found_rows);
     num_total_records++;
-    if (pq)
+    if (pq && pq->is_full()) {
+      /*
+        Make the sort key alone first. A row ordered after the top of the
+        queue cannot be among the first max_rows, so its addon fields or
+        row ID are not made. For ORDER BY <expression> LIMIT k over many
+        rows, nearly all rows are dropped this way.
+      */
+      const uint key_length = param->make_sortkey_key(
+          Bounds_checked_array<uchar>(pq_key.data(), pq_key.size()));
+      if (key_length == UINT_MAX)
+        pq->push(tables);
+      else if (!key_sorts_after(param, pq->top(), pq_key.data(), key_length))
+        pq->replace_top(pq_key.data(), key_length, tables);
+    } else if (pq)
       pq->push(tables);
     else {
       size_t key_length;
@@ -1445,6 +1476,16 @@ size_t make_sortkey_from_item(Item *item, Item_result result_type,
 uint Sort_param::make_sortkey(Bounds_checked_array<uchar> dst,
                               const Mem_root_array<TABLE *> &tables,
                               size_t *longest_addon_so_far) {
+  const uint key_length = make_sortkey_key(dst);
+  if (key_length == UINT_MAX) return UINT_MAX;
+  const uint payload_length =
+      make_sortkey_payload(dst.array() + key_length, dst.array() + dst.size(),
+                           tables, longest_addon_so_far);
+  if (payload_length == UINT_MAX) return UINT_MAX;
+  return key_length + payload_length;
+}
+
+uint Sort_param::make_sortkey_key(Bounds_checked_array<uchar> dst) {
   uchar *to = dst.array();
   uchar *to_end = dst.array() + dst.size();
   uchar *orig_to = to;
@@ -1521,6 +1562,13 @@ uint Sort_param::make_sortkey(Bounds_checked_array<uchar> dst,
     Sort_param::store_varlen_key_length(orig_to,
                                         static_cast<uint>(to - orig_to));
   }
+  return to - orig_to;
+}
+
+uint Sort_param::make_sortkey_payload(uchar *to, uchar *to_end,
+                                      const Mem_root_array<TABLE *> &tables,
+                                      size_t *longest_addon_so_far) {
+  uchar *orig_to = to;
 
   if (using_addon_fields()) {
     /*
@@ -24,12 +24,14 @@
 
 #include <string.h>
 #include <algorithm>
+#include <array>
 #include <cmath>
 
 #include "add_with_saturate.h"
 #include "my_dbug.h"
 #include "my_io.h"
 #include "my_pointer_arithmetic.h"
+#include "my_sys.h"
 #include "sql/cmp_varlen_keys.h"
 #include "sql/opt_costmodel.h"
 #include "sql/sort_param.h"
@@ -111,6 +113,49 @@ class Mem_compare_varlen_key {
   bool use_hash;
 };
 
+/*
+  Fixed-length keys up to this long, in at least this many rows, are sorted
+  with radix_sort(). It makes at most one pass over the rows per key byte,
+  where std::stable_sort() makes O(log n) passes each comparing keys.
+*/
+constexpr size_t RADIX_SORT_MAX_KEY_LENGTH = 16;
+constexpr size_t RADIX_SORT_MIN_ROWS = 1000;
+
+/*
+  A stable LSD radix sort of keys of key_len bytes, ordering them as
+  Mem_compare does. The bytes of all keys are counted in a single pass
+  first, so that the passes for bytes that are equal in every key are
+  skipped. Like std::stable_sort(), it needs a buffer of as many pointers.
+*/
+void radix_sort(uchar **first, uchar **last, size_t key_len) {
+  const size_t num_rows = last - first;
+  vector<std::array<size_t, 256>> counts(key_len);
+  for (uchar **it = first; it != last; ++it) {
+    const uchar *key = *it;
+    for (size_t i = 0; i < key_len; ++i) ++counts[i][key[i]];
+  }
+
+  vector<uchar *> buffer(num_rows);
+  uchar **from = first;
+  uchar **to = buffer.data();
+  for (size_t i = key_len; i-- > 0;) {
+    std::array<size_t, 256> &offsets = counts[i];
+    if (offsets[from[0][i]] == num_rows) continue;
+
+    size_t offset = 0;
+    for (size_t &count : offsets) {
+      const size_t num_keys = count;
+      count = offset;
+      offset += num_keys;
+    }
+    for (uchar **it = from; it != from + num_rows; ++it) {
+      to[offsets[(*it)[i]]++] = *it;
+    }
+    std::swap(from, to);
+  }
+  if (from != first) std::copy(from, from + num_rows, first);
+}
+
 template <class Comp>
 class Equality_from_less {
  public:
@@ -214,14 +259,22 @@ size_t Filesort_buffer::sort_buffer(Sort_param *param, size_t num_input_rows,
   }
 
   param->m_sort_algorithm = Sort_param::FILESORT_ALG_STD_STABLE;
-  // Heuristics here: avoid function overhead call for short keys.
-  if (key_len < 10) {
+  // Heuristics here: radix sort many short keys, and avoid function
+  // overhead call for short keys.
+  if (key_len <= RADIX_SORT_MAX_KEY_LENGTH) {
     if (prefilter_nth_element) {
       nth_element(it_begin, it_begin + max_output_rows - 1, it_end,
                   Mem_compare(key_len));
       it_end = it_begin + max_output_rows;
     }
-    stable_sort(it_begin, it_end, Mem_compare(key_len));
+    if (static_cast<size_t>(it_end - it_begin) >= RADIX_SORT_MIN_ROWS) {
+      param->m_sort_algorithm = Sort_param::FILESORT_ALG_RADIX;
+      radix_sort(&*it_begin, &*it_begin + (it_end - it_begin), key_len);
+    } else if (key_len < 10) {
+      stable_sort(it_begin, it_end, Mem_compare(key_len));
+    } else {
+      stable_sort(it_begin, it_end, Mem_compare_longkey(key_len));
+    }
     if (param->m_remove_duplicates) {
       num_input_rows =
           unique(it_begin, it_end,
@@ -401,6 +454,7 @@ bool Filesort_buffer::allocate_sized_block(size_t block_size) {
   if (new_block == nullptr) {
     return true;
   }
+  if (m_large_pages) my_advise_large_pages(new_block.get(), block_size);
 
   m_space_used_other_blocks += m_current_block_size;
   m_current_block_size = block_size;
@@ -143,6 +143,9 @@ class Filesort_buffer {
 
   size_t max_size_in_bytes() const { return m_max_size_in_bytes; }
 
+  /// Whether to back the blocks allocated from now on with huge pages.
+  void set_large_pages(bool large_pages) { m_large_pages = large_pages; }
+
   /**
     How much memory has been allocated (counting both the sort buffer and the
     record pointers) at most since last call to clear_peak_memory_used().
@@ -267,6 +270,9 @@ class Filesort_buffer {
   */
   size_t m_space_used_other_blocks;
 
+  /// Whether new blocks are backed with huge pages where possible.
+  bool m_large_pages{false};
+
   /**
     The largest amount of total memory we've been using since last call to
     clear_peak_memory_used(). This is updated lazily so that we don't need
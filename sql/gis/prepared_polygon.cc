@@ -0,0 +1,128 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+
+/// @file
+///
+/// Implements point location in prepared polygons.
+
+#include "sql/gis/prepared_polygon.h"
+
+#include <algorithm>  // std::min, std::max
+#include <cmath>      // std::abs, std::hypot
+
+namespace bgi = boost::geometry::index;
+
+namespace gis {
+
+/// Tolerance relative to the extent of the polygon. Far above the error of
+/// the crossing computations, far below any distance that matters.
+static constexpr double kRelativeTolerance = 1e-9;
+
+std::unique_ptr<Prepared_polygon> Prepared_polygon::create(const Geometry &g) {
+  if (g.coordinate_system() != Coordinate_system::kCartesian || g.is_empty())
+    return nullptr;
+
+  std::unique_ptr<Prepared_polygon> prepared(new Prepared_polygon());
+  switch (g.type()) {
+    case Geometry_type::kPolygon: {
+      const auto &py = static_cast<const Cartesian_polygon &>(g);
+      prepared->add_ring(py.cartesian_exterior_ring());
+      for (const auto &ring : py.const_interior_rings())
+        prepared->add_ring(ring);
+      break;
+    }
+    case Geometry_type::kMultipolygon:
+      for (const auto &py : static_cast<const Cartesian_multipolygon &>(g)) {
+        prepared->add_ring(py.cartesian_exterior_ring());
+        for (const auto &ring : py.const_interior_rings())
+          prepared->add_ring(ring);
+      }
+      break;
+    default:
+      return nullptr;
+  }
+  if (prepared->m_edges.empty()) return nullptr;
+
+  // Bulk loading packs the R-tree better than inserting the edges one by one.
+  std::vector<std::pair<Box, std::size_t>> entries;
+  entries.reserve(prepared->m_edges.size());
+  double min_x = prepared->m_edges[0].first->x();
+  double min_y = prepared->m_edges[0].first->y();
+  double max_x = min_x;
+  double max_y = min_y;
+  for (std::size_t i = 0; i < prepared->m_edges.size(); ++i) {
+    const Cartesian_point &a = *prepared->m_edges[i].first;
+    const Cartesian_point &b = *prepared->m_edges[i].second;
+    Box box(Box_point(std::min(a.x(), b.x()), std::min(a.y(), b.y())),
+            Box_point(std::max(a.x(), b.x()), std::max(a.y(), b.y())));
+    min_x = std::min(min_x, box.min_corner().get<0>());
+    min_y = std::min(min_y, box.min_corner().get<1>());
+    max_x = std::max(max_x, box.max_corner().get<0>());
+    max_y = std::max(max_y, box.max_corner().get<1>());
+    entries.emplace_back(box, i);
+  }
+  prepared->m_rtree = decltype(prepared->m_rtree)(entries.begin(),
+                                                  entries.end());
+  prepared->m_max_x = max_x;
+  prepared->m_tolerance =
+      kRelativeTolerance *
+      std::max({max_x - min_x, max_y - min_y, std::abs(min_x), std::abs(min_y),
+                std::abs(max_x), std::abs(max_y), 1.0});
+  return prepared;
+}
+
+void Prepared_polygon::add_ring(const Cartesian_linearring &ring) {
+  // Rings are closed, the last point repeats the first.
+  for (std::size_t i = 1; i < ring.size(); ++i)
+    m_edges.emplace_back(&ring[i - 1], &ring[i]);
+}
+
+Point_location Prepared_polygon::locate(const Cartesian_point &pt) const {
+  const double x = pt.x();
+  const double y = pt.y();
+
+  // The edges a ray from the point to the right can cross, or that are near
+  // the point.
+  Box ray(Box_point(x - m_tolerance, y - m_tolerance),
+          Box_point(std::max(x, m_max_x) + m_tolerance, y + m_tolerance));
+
+  bool inside = false;
+  for (auto it = m_rtree.qbegin(bgi::intersects(ray)); it != m_rtree.qend();
+       ++it) {
+    const Cartesian_point &a = *m_edges[it->second].first;
+    const Cartesian_point &b = *m_edges[it->second].second;
+    const double dx = b.x() - a.x();
+    const double dy = b.y() - a.y();
+
+    // Distance from the point to the edge.
+    double t = 0.0;
+    const double length2 = dx * dx + dy * dy;
+    if (length2 > 0.0)
+      t = std::min(1.0, std::max(0.0, ((x - a.x()) * dx + (y - a.y()) * dy) /
+                                          length2));
+    if (std::hypot(a.x() + t * dx - x, a.y() + t * dy - y) <= m_tolerance)
+      return Point_location::kUnknown;
+
+    // Edges are half open in y, so a ray through a vertex shared by two
+    // edges crosses at most one of them.
+    if ((a.y() > y) != (b.y() > y) && a.x() + (y - a.y()) * dx / dy > x)
+      inside = !inside;
+  }
+  return inside ? Point_location::kInterior : Point_location::kExterior;
+}
+
+}  // namespace gis
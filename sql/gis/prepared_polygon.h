@@ -0,0 +1,86 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+
+/// @file
+///
+/// Point location in a Cartesian polygon or multipolygon that is tested
+/// against many points, e.g., the constant argument of ST_Contains.
+
+#ifndef SQL_GIS_PREPARED_POLYGON_H_INCLUDED
+#define SQL_GIS_PREPARED_POLYGON_H_INCLUDED
+
+#include <boost/geometry/geometries/box.hpp>
+#include <boost/geometry/geometries/point.hpp>
+#include <boost/geometry/index/rtree.hpp>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "sql/gis/geometries.h"     // gis::Geometry
+#include "sql/gis/geometries_cs.h"  // gis::Cartesian_point
+
+namespace gis {
+
+/// Where a point is relative to a polygon.
+enum class Point_location { kInterior, kExterior, kUnknown };
+
+/// A Cartesian polygon or multipolygon with an R-tree over the edges of its
+/// rings. A point is located by counting the edges a ray from it crosses,
+/// which the R-tree finds in logarithmic time instead of testing them all.
+///
+/// Points that are not clearly off the boundary, within a tolerance relative
+/// to the size of the polygon, are kUnknown and left to Boost.Geometry, so
+/// the result never differs from that of the exact predicates.
+class Prepared_polygon {
+ public:
+  /// Prepares a geometry.
+  ///
+  /// @param[in] g The geometry, which must stay alive while prepared.
+  ///
+  /// @return The prepared polygon, or nullptr if g is not a non-empty
+  /// Cartesian polygon or multipolygon.
+  static std::unique_ptr<Prepared_polygon> create(const Geometry &g);
+
+  /// Locates a point.
+  ///
+  /// @param[in] pt The point.
+  ///
+  /// @return Where the point is, kUnknown if close to the boundary.
+  Point_location locate(const Cartesian_point &pt) const;
+
+ private:
+  using Box_point = boost::geometry::model::point<
+      double, 2, boost::geometry::cs::cartesian>;
+  using Box = boost::geometry::model::box<Box_point>;
+  using Edge = std::pair<const Cartesian_point *, const Cartesian_point *>;
+
+  Prepared_polygon() = default;
+  void add_ring(const Cartesian_linearring &ring);
+
+  std::vector<Edge> m_edges;
+  boost::geometry::index::rtree<std::pair<Box, std::size_t>,
+                                boost::geometry::index::quadratic<16>>
+      m_rtree;
+  double m_max_x = 0.0;
+  /// Distance to the boundary below which points are kUnknown.
+  double m_tolerance = 0.0;
+};
+
+}  // namespace gis
+
+#endif  // include guard
@@ -76,6 +76,7 @@
 #include "prealloced_array.h"
 #include "sql/auth/auth_common.h"  // check_readonly() and SUPER_ACL
 #include "sql/binlog.h"            // mysql_bin_log
+#include "sql/change_stream.h"  // change_stream_capture
 #include "sql/check_stack.h"
 #include "sql/clone_handler.h"
 #include "sql/current_thd.h"
@@ -92,6 +93,7 @@
 #include "sql/lock.h"  // MYSQL_LOCK
 #include "sql/log.h"
 #include "sql/log_event.h"  // Write_rows_log_event
+#include "sql/materialized_view.h"  // materialized_view_capture
 #include "sql/mdl.h"
 #include "sql/mysqld.h"                 // global_system_variables heap_hton ..
 #include "sql/next_spatial_base.h"
@@ -109,6 +111,7 @@
 #include "sql/rpl_rli.h"                // is_atomic_ddl_commit_on_slave
 #include "sql/rpl_write_set_handler.h"  // add_pke
 #include "sql/sdi_utils.h"              // import_serialized_meta_data
+#include "sql/semantic_materializer.h"  // semantic_materializer_enqueue
 #include "sql/session_tracker.h"
 #include "sql/sql_base.h"  // free_io_cache
 #include "sql/sql_bitmap.h"
@@ -927,6 +930,23 @@ void ha_kill_connection(THD *thd) {
   plugin_foreach(thd, kill_handlerton, MYSQL_STORAGE_ENGINE_PLUGIN, nullptr);
 }
 
+/**
+  Read the counters of the engines taking part in the statement of thd.
+
+  @param       thd       Current thread
+  @param[out]  counters  Sum of the counters of the engines
+*/
+void ha_get_engine_counters(THD *thd, ha_engine_counters *counters) {
+  *counters = ha_engine_counters();
+  auto ha_list = thd->get_transaction()->ha_trx_info(Transaction_ctx::STMT);
+  if (ha_list) {
+    for (auto &ha_info : ha_list) {
+      const handlerton *ht = ha_info.ht();
+      if (ht->add_engine_counters) ht->add_engine_counters(thd, counters);
+    }
+  }
+}
+
 /** Invoke handlerton::pre_dd_shutdown() on a plugin.
 @param plugin	storage engine plugin
 @retval false (always) */
@@ -1760,6 +1780,8 @@ end:
   if (is_real_trans) {
     trn_ctx->cleanup();
     thd->tx_priority = 0;
+    if (thd->mv_deltas != nullptr) materialized_view_end_trans(thd, !error);
+    if (thd->cs_trans != nullptr) change_stream_end_trans(thd, !error);
   }
 
   if (need_clear_owned_gtid) {
@@ -2075,6 +2097,8 @@ int ha_rollback_trans(THD *thd, bool all) {
   if (is_real_trans) {
     trn_ctx->cleanup();
     thd->tx_priority = 0;
+    if (thd->mv_deltas != nullptr) materialized_view_end_trans(thd, false);
+    if (thd->cs_trans != nullptr) change_stream_end_trans(thd, false);
   }
 
   if (all) thd->transaction_rollback_request = false;
@@ -3089,6 +3113,7 @@ int handler::ha_index_end() {
   inited = NONE;
   end_range = nullptr;
   m_record_buffer = nullptr;
+  m_runtime_filter = nullptr;
   if (m_unique) m_unique->reset(false);
   return index_end();
 }
@@ -3137,6 +3162,7 @@ int handler::ha_rnd_end() {
   inited = NONE;
   end_range = nullptr;
   m_record_buffer = nullptr;
+  m_runtime_filter = nullptr;
   return rnd_end();
 }
 
@@ -5059,6 +5085,12 @@ int handler::ha_delete_all_rows() {
   assert(table_share->tmp_table != NO_TMP_TABLE || m_lock_type == F_WRLCK);
   mark_trx_read_write();
 
+  if (materialized_views_exist())
+    materialized_view_capture_all(table->in_use, table_share->db.str,
+                                  table_share->table_name.str);
+  if (change_streams_exist())
+    change_stream_capture_all(table->in_use, table_share->db.str,
+                              table_share->table_name.str);
   return delete_all_rows();
 }
 
@@ -8287,8 +8319,9 @@ int handler::ha_reset() {
   pushed_cond = nullptr;
   /* Reset information about pushed index conditions */
   cancel_pushed_idx_cond();
-  // Forget the record buffer.
+  // Forget the record buffer and the runtime filter.
   m_record_buffer = nullptr;
+  m_runtime_filter = nullptr;
   m_unique = nullptr;
 
   const int retval = reset();
@@ -8337,6 +8370,13 @@ int handler::ha_write_row(uchar *buf) {
   if (unlikely((error = binlog_log_row(table, nullptr, buf, log_func))))
     return error; /* purecov: inspected */
 
+  if (table->async_gcols_pending) {
+    table->async_gcols_pending = false;
+    semantic_materializer_enqueue(table, buf);
+  }
+  if (materialized_views_exist()) materialized_view_capture(table, buf);
+  if (change_streams_exist()) change_stream_capture(table, nullptr, buf);
+
   DEBUG_SYNC_C("ha_write_row_end");
   return 0;
 }
@@ -8383,6 +8423,16 @@ int handler::ha_update_row(const uchar *old_data, uchar *new_data) {
 
   if (unlikely((error = binlog_log_row(table, old_data, new_data, log_func))))
     return error;
+
+  if (table->async_gcols_pending) {
+    table->async_gcols_pending = false;
+    semantic_materializer_enqueue(table, new_data);
+  }
+  if (materialized_views_exist()) {
+    materialized_view_capture(table, old_data);
+    materialized_view_capture(table, new_data);
+  }
+  if (change_streams_exist()) change_stream_capture(table, old_data, new_data);
   return 0;
 }
 
@@ -8422,6 +8472,8 @@ int handler::ha_delete_row(const uchar *buf) {
 
   if (unlikely((error = binlog_log_row(table, buf, nullptr, log_func))))
     return error;
+  if (materialized_views_exist()) materialized_view_capture(table, buf);
+  if (change_streams_exist()) change_stream_capture(table, buf, nullptr);
   return 0;
 }
 
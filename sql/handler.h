@@ -88,6 +88,7 @@ class Partition_handler;
 class Plugin_table;
 class Plugin_tablespace;
 class Record_buffer;
+class Runtime_filter;
 class SE_cost_constants;  // see opt_costconstants.h
 class String;
 class THD;
@@ -2468,6 +2469,25 @@ typedef bool (*handle_single_table_select_t)(THD *thd, Query_block *select_lex);
 typedef bypass_rpc_exception (*bypass_select_by_key_t)(
     THD *thd, myrocks_columns *columns, const myrocks_select_from_rpc &str);
 
+/**
+  Work a storage engine did on behalf of a thread, summed since the engine
+  last reset its counters. EXPLAIN ANALYZE reads them around every call to
+  an iterator and charges the difference to it.
+*/
+struct ha_engine_counters {
+  ulonglong block_reads{0};
+  ulonglong block_read_bytes{0};
+  ulonglong block_cache_hits{0};
+  ulonglong bloom_checks{0};
+  ulonglong seeks{0};
+  ulonglong nexts{0};
+  /** time spent decoding rows from the storage format */
+  ulonglong decode_ns{0};
+};
+
+/* Add the counters of the thread in the engine to *counters */
+typedef void (*add_engine_counters_t)(THD *thd, ha_engine_counters *counters);
+
 /**
   Prepare the secondary engine for executing a statement. This function is
   called right after the secondary engine TABLE objects have been opened by
@@ -2820,6 +2840,7 @@ struct handlerton {
   is_reserved_db_name_t is_reserved_db_name;
   handle_single_table_select_t handle_single_table_select;
   bypass_select_by_key_t bypass_select_by_key;
+  add_engine_counters_t add_engine_counters;
 
   /** Global handler flags. */
   uint32 flags{0};
@@ -3042,6 +3063,11 @@ constexpr const decltype(
  * secondary. */
 #define HTON_SECONDARY_ENGINE_SUPPORTS_DDL (1 << 19)
 
+/** Engine calls query_result_cache_invalidate() for the tables a transaction
+ * changed once it commits, so the query result cache may keep results read
+ * from its tables. */
+#define HTON_SUPPORTS_RESULT_CACHE (1 << 20)
+
 inline bool secondary_engine_supports_ddl(const handlerton *hton) {
   assert(hton->flags & HTON_IS_SECONDARY_ENGINE);
 
@@ -4602,6 +4628,7 @@ class handler {
 
  private:
   Record_buffer *m_record_buffer = nullptr;  ///< Buffer for multi-row reads.
+  Runtime_filter *m_runtime_filter = nullptr;  ///< Filter of the current scan.
   /*
     Storage space for the end range value. Should only be accessed using
     the end_range pointer. The content is invalid when end_range is NULL.
@@ -4858,6 +4885,23 @@ class handler {
   */
   Record_buffer *ha_get_record_buffer() const { return m_record_buffer; }
 
+  /**
+    Set a filter on the rows of the scan just started, which the storage
+    engine may apply before it returns them. See Runtime_filter.
+
+    @param filter the filter, kept until the scan ends
+  */
+  void ha_set_runtime_filter(Runtime_filter *filter) {
+    m_runtime_filter = filter;
+  }
+
+  /**
+    Get the filter that was set with ha_set_runtime_filter().
+
+    @return the filter of the current scan, or nullptr if there is none
+  */
+  Runtime_filter *ha_get_runtime_filter() const { return m_runtime_filter; }
+
   /**
     Does this handler want to get a Record_buffer for multi-row reads
     via the ha_set_record_buffer() function? And if so, what is the
@@ -6071,6 +6115,26 @@ class handler {
 
   virtual bool primary_key_is_clustered() const { return false; }
 
+  /**
+    Images of the index entries of a row that rows with another primary key
+    share, such as the inverted list of a vector index or the cell of a
+    spatial index, for the engines that need the transactions writing them
+    to be applied in order on a replica. Each image is prefixed with the
+    name of its index. They are added to the write set of the transaction
+    and to the keys of dependency replication.
+
+    @param       record  the row, in record[0] or record[1]
+    @param[out]  images  the images are appended here
+
+    @retval  false  Success.
+    @retval  true   Error.
+  */
+  virtual bool shared_index_entries(const uchar *record [[maybe_unused]],
+                                    std::vector<std::string> *images
+                                    [[maybe_unused]]) {
+    return false;
+  }
+
   /**
     Compare two positions.
 
@@ -7221,6 +7285,22 @@ class handler {
     return false;
   }
 
+  /**
+    Estimate the cost of reading the first rows of a vector index in
+    distance order, from the statistics the engine keeps for the index.
+    @param keyno       the vector index
+    @param rows        number of rows wanted, HA_POS_ERROR for all of them
+    @param[out] cost   the estimate
+    @return false if an estimate was made
+            true if the engine has none, the caller then falls back to
+            fb_vector_index_cost_factor
+    */
+  virtual bool vector_index_scan_cost(uint keyno [[maybe_unused]],
+                                      ha_rows rows [[maybe_unused]],
+                                      Cost_estimate *cost [[maybe_unused]]) {
+    return true;
+  }
+
   /**
     Initialize vector index related params in the storage engine.
     Currently this includes the vector dist function being used in the
@@ -7232,7 +7312,36 @@ class handler {
     return HA_ERR_WRONG_COMMAND;
   }
 
+  /**
+    Run the knn searches of a batch of upcoming vector index scans at once,
+    e.g. for the outer rows buffered by a KNN join. A later scan of the index
+    with one of these query vectors returns the prefetched rows.
+    vector_index_init() must have been called for the index.
+    @return 0 on success, or an error code.
+            HA_ERR_WRONG_COMMAND if the engine does not batch searches, each
+            scan then runs its own search.
+    */
+  virtual int vector_index_prefetch(
+      uint keyno [[maybe_unused]],
+      std::vector<std::vector<float>> *query_vectors [[maybe_unused]]) {
+    return HA_ERR_WRONG_COMMAND;
+  }
+
   /* Next spatial index related */
+  /**
+    Does this storage engine support a nearest neighbour scan on a spatial
+    index, returning rows in the ascending ST_DISTANCE order of the given
+    ORDER and index id.
+    If idx value is -1, then it is not checked in table
+    @return false by default
+            true if the storage engine supports this, and if additional
+            conditions are met by checking the given ORDER
+    */
+  virtual bool index_supports_spatial_knn_scan(ORDER *order [[maybe_unused]],
+                                               int idx [[maybe_unused]]) {
+    return false;
+  }
+
   /**
     Initialize next spatial index related params in the storage engine.
     Currently this includes the vector dist function being used in the
@@ -7243,6 +7352,15 @@ class handler {
     virtual int next_spatial_index_init(Item *distance_func [[maybe_unused]]) {
       return HA_ERR_WRONG_COMMAND;
     }
+
+  /**
+    Hand the condition of a range scan over the next spatial index keyno to
+    the storage engine, so rows its spatial predicates rule out are dropped
+    before they are returned. The condition stays with the server, which
+    still checks it on every row.
+  */
+  virtual void next_spatial_cond_push(uint keyno [[maybe_unused]],
+                                      Item *cond [[maybe_unused]]) {}
   
 
  protected:
@@ -7460,6 +7578,7 @@ TYPELIB *ha_known_exts();
 int ha_panic(enum ha_panic_function flag);
 void ha_close_connection(THD *thd);
 void ha_kill_connection(THD *thd);
+void ha_get_engine_counters(THD *thd, ha_engine_counters *counters);
 /** Invoke handlerton::pre_dd_shutdown() on every storage engine plugin. */
 void ha_pre_dd_shutdown(void);
 
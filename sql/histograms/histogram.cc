@@ -29,6 +29,7 @@
 
 #include <sys/types.h>
 #include <algorithm>
+#include <atomic>
 #include <map>
 #include <memory>  // std::unique_ptr
 #include <new>
@@ -95,6 +96,10 @@ namespace histograms {
 // Same as MAX_NUMBER_OF_HISTOGRAM_BUCKETS defined in sql_yacc.yy
 static constexpr int MAX_NUMBER_OF_HISTOGRAM_BUCKETS = 1024;
 
+static std::atomic<ulonglong> g_statistics_version{0};
+
+ulonglong statistics_version() { return g_statistics_version; }
+
 /*
   This type represents a instrumented map of value maps, indexed by field
   number.
@@ -1593,6 +1598,7 @@ bool drop_histograms(THD *thd, Table_ref &table, const columns_set &columns,
     }
 
     results.emplace(column_name, Message::HISTOGRAM_DELETED);
+    ++g_statistics_version;
   }
 
   return false;
@@ -1655,6 +1661,7 @@ bool Histogram::store_histogram(THD *thd) const {
     }
   }
 
+  ++g_statistics_version;
   return false;
 }
 
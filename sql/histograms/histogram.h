@@ -757,6 +757,12 @@ bool find_histogram(THD *thd, const std::string &schema_name,
                     const std::string &table_name,
                     const std::string &column_name,
                     const Histogram **histogram);
+
+/**
+  A counter bumped whenever a histogram is stored or dropped, so that what
+  is cached from plans built with the histograms goes stale with them.
+*/
+ulonglong statistics_version();
 }  // namespace histograms
 
 #endif
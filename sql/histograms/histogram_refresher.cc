@@ -0,0 +1,229 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/histograms/histogram_refresher.h"
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "lex_string.h"
+#include "my_dbug.h"
+#include "my_thread.h"
+#include "mysql/psi/mysql_cond.h"
+#include "mysql/psi/mysql_mutex.h"
+#include "mysql/psi/mysql_thread.h"
+#include "sql/auth/auth_common.h"  // check_readonly
+#include "sql/dd/cache/dictionary_client.h"
+#include "sql/field.h"
+#include "sql/histograms/histogram.h"
+#include "sql/log.h"
+#include "sql/mysqld.h"
+#include "sql/mysqld_thd_manager.h"
+#include "sql/protocol_classic.h"
+#include "sql/rpl_channel_service_interface.h"  // is_any_slave_channel_running
+#include "sql/sql_backup_lock.h"  // acquire_shared_backup_lock_nsec
+#include "sql/sql_base.h"         // tdc_remove_table
+#include "sql/sql_class.h"
+#include "sql/sql_lex.h"
+#include "sql/table.h"
+
+bool opt_histogram_auto_refresh = false;
+
+namespace {
+
+/// Buckets of a histogram built without WITH N BUCKETS.
+constexpr int DEFAULT_HISTOGRAM_BUCKETS = 100;
+
+/// A table to refresh the histograms of.
+struct Refresh_request {
+  std::string db;
+  std::string table_name;
+  /// The columns with a histogram, by the number of buckets it was built
+  /// with, as one refresh builds all its histograms with the same number.
+  std::map<int, std::vector<std::string>> columns;
+};
+
+mysql_mutex_t LOCK_refresher;
+mysql_cond_t COND_refresher;
+
+/// Tables to refresh, oldest first. Guarded by LOCK_refresher.
+std::deque<Refresh_request> pending;
+/// The db and name of the tables in pending. Guarded by LOCK_refresher.
+std::set<std::pair<std::string, std::string>> pending_names;
+
+my_thread_handle refresher;
+bool refresher_inited = false;
+bool refresher_started = false;
+
+/**
+  Wait for a table to refresh and take it.
+  @return false if the thread was killed
+*/
+bool take_request(THD *thd, Refresh_request *request) {
+  mysql_mutex_lock(&LOCK_refresher);
+  PSI_stage_info old_stage;
+  thd->ENTER_COND(&COND_refresher, &LOCK_refresher,
+                  &stage_waiting_for_work_item, &old_stage);
+  while (pending.empty() && !thd->is_killed()) {
+    mysql_cond_wait(&COND_refresher, &LOCK_refresher);
+  }
+  const bool found = !thd->is_killed();
+  if (found) {
+    *request = std::move(pending.front());
+    pending.pop_front();
+    pending_names.erase({request->db, request->table_name});
+  }
+  mysql_mutex_unlock(&LOCK_refresher);
+  thd->EXIT_COND(&old_stage);
+  return found;
+}
+
+/**
+  Build the histograms of a table again, one pass over a sample of its rows
+  per number of buckets. A table since dropped, or columns since dropped,
+  are skipped, and so are all tables while the server replicates.
+*/
+void refresh_histograms(THD *thd, const Refresh_request &request) {
+  // update_histogram() writes the dictionary
+  if (check_readonly(thd, false)) return;
+  // a replica takes its histograms from the ANALYZE TABLE of its source
+  if (is_any_slave_channel_running(CHANNEL_RECEIVER_THREAD |
+                                   CHANNEL_APPLIER_THREAD))
+    return;
+
+  for (const auto &group : request.columns) {
+    if (thd->is_killed()) return;
+    lex_start(thd);
+    thd->set_query_id(next_query_id());
+    thd->set_time();
+
+    Table_ref table(request.db.c_str(), request.db.length(),
+                    request.table_name.c_str(), request.table_name.length(),
+                    request.table_name.c_str(), TL_READ);
+    const histograms::columns_set columns(group.second.begin(),
+                                          group.second.end());
+    histograms::results_map results;
+    bool failed;
+    {
+      dd::cache::Dictionary_client::Auto_releaser releaser(thd->dd_client());
+      failed = acquire_shared_backup_lock_nsec(
+                   thd, thd->variables.lock_wait_timeout_nsec) ||
+               histograms::update_histogram(thd, &table, columns, group.first,
+                                            {nullptr, 0}, results);
+    }
+    thd->mdl_context.release_transactional_locks();
+    lex_end(thd->lex);
+
+    if (!failed) {
+      // the histograms are cached in the TABLE_SHARE, as ANALYZE TABLE does
+      tdc_remove_table(thd, TDC_RT_REMOVE_UNUSED, request.db.c_str(),
+                       request.table_name.c_str(), false);
+    } else if (thd->is_error() && !thd->is_killed()) {
+      sql_print_warning("Refreshing the histograms of %s.%s failed: %s",
+                        request.db.c_str(), request.table_name.c_str(),
+                        thd->get_stmt_da()->message_text());
+    }
+    thd->clear_error();
+    thd->mem_root->ClearForReuse();
+  }
+}
+
+extern "C" void *histogram_refresh_thread(void *) {
+  THD new_thd;
+  THD *thd = &new_thd;
+  Global_THD_manager *thd_manager = Global_THD_manager::get_instance();
+
+  thd->system_thread = SYSTEM_THREAD_BACKGROUND;
+  thd->thread_stack = (char *)&thd;
+  if (my_thread_init()) return nullptr;
+  thd->get_protocol_classic()->init_net(nullptr);
+  thd->set_new_thread_id();
+  thd->store_globals();
+  thd_manager->add_thd(thd);
+  mysql_thread_set_psi_id(thd->thread_id());
+  thd->set_command(COM_DAEMON);
+  thd->security_context()->skip_grants();
+
+  {
+    DBUG_TRACE;
+    Refresh_request request;
+    while (take_request(thd, &request)) {
+      DBUG_PRINT("info", ("refreshing the histograms of %s.%s",
+                          request.db.c_str(), request.table_name.c_str()));
+      refresh_histograms(thd, request);
+    }
+  }
+
+  thd->get_protocol_classic()->end_net();
+  // Must be called before thd_manager->remove_thd.
+  thd->release_resources();
+  thd_manager->remove_thd(thd);
+  my_thread_end();
+  return nullptr;
+}
+
+}  // namespace
+
+void histogram_refresher_init() {
+  mysql_mutex_init(PSI_NOT_INSTRUMENTED, &LOCK_refresher, MY_MUTEX_INIT_FAST);
+  mysql_cond_init(PSI_NOT_INSTRUMENTED, &COND_refresher);
+  refresher_inited = true;
+
+  if (int error = mysql_thread_create(key_thread_histogram_refresher,
+                                      &refresher, &connection_attrib,
+                                      histogram_refresh_thread, nullptr)) {
+    sql_print_warning("Could not create histogram refresh thread (errno= %d)",
+                      error);
+    return;
+  }
+  refresher_started = true;
+}
+
+void histogram_refresher_deinit() {
+  if (!refresher_inited) return;
+  // The thread has been killed along with all other threads.
+  if (refresher_started) my_thread_join(&refresher, nullptr);
+  refresher_started = false;
+  pending.clear();
+  pending_names.clear();
+  mysql_cond_destroy(&COND_refresher);
+  mysql_mutex_destroy(&LOCK_refresher);
+  refresher_inited = false;
+}
+
+void histogram_refresher_enqueue(const TABLE_SHARE &share) {
+  if (!refresher_started || !opt_histogram_auto_refresh ||
+      share.m_histograms == nullptr || share.m_histograms->empty() ||
+      share.tmp_table != NO_TMP_TABLE)
+    return;
+
+  Refresh_request request{share.db.str, share.table_name.str, {}};
+  mysql_mutex_lock(&LOCK_refresher);
+  if (pending_names.emplace(request.db, request.table_name).second) {
+    for (const auto &histogram : *share.m_histograms) {
+      const int buckets =
+          static_cast<int>(histogram.second->get_num_buckets_specified());
+      request.columns[buckets > 0 ? buckets : DEFAULT_HISTOGRAM_BUCKETS]
+          .emplace_back(share.field[histogram.first]->field_name);
+    }
+    pending.push_back(std::move(request));
+    mysql_cond_signal(&COND_refresher);
+  }
+  mysql_mutex_unlock(&LOCK_refresher);
+}
@@ -0,0 +1,54 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+/**
+  @file
+  Background refresh of the histograms of tables whose rows changed.
+
+  A storage engine counting the rows changed in a table queues the table
+  once enough of them changed, as it does for its own index statistics. A
+  background thread then builds the histograms the table already has again,
+  with the number of buckets they were built with, the way ANALYZE TABLE ...
+  UPDATE HISTOGRAM does. The rows are sampled with plain reads, so writers
+  are not blocked, and no session waits for the scan.
+
+  Only columns with a histogram are refreshed: which columns are worth one
+  is left to ANALYZE TABLE. The refresh is local to the server: it is not
+  written to the binary log, and it does not run while a replication
+  channel is running, so a replica keeps the histograms its source built
+  with ANALYZE TABLE and the refreshed histograms of a source never reach
+  its replicas. It is off unless histogram_auto_refresh is set.
+*/
+
+struct TABLE_SHARE;
+
+/// Whether tables queued by the storage engines have their histograms
+/// built again.
+extern bool opt_histogram_auto_refresh;
+
+/// Start the refresh thread at server start.
+void histogram_refresher_init();
+
+/// Wait for the refresh thread to end at shutdown, once it has been killed.
+void histogram_refresher_deinit();
+
+/**
+  Queue a table whose rows changed enough to have its histograms built again.
+  A table without histograms, or already queued, is not queued.
+*/
+void histogram_refresher_enqueue(const TABLE_SHARE &share);
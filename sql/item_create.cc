@@ -1799,6 +1799,8 @@ static const std::pair<const char *, Create_func *> func_array[] = {
     // vector db functions
     {"FB_VECTOR_L2", SQL_FN_V_LIST_THD(Item_func_fb_vector_l2, 2, 2)},
     {"FB_VECTOR_IP", SQL_FN_V_LIST_THD(Item_func_fb_vector_ip, 2, 2)},
+    {"FB_VECTOR_COSINE", SQL_FN_V_LIST_THD(Item_func_fb_vector_cosine, 2, 2)},
+    {"FB_VECTOR_MAXSIM", SQL_FN_V_LIST_THD(Item_func_fb_vector_maxsim, 2, 2)},
     {"FB_VECTOR_NORMALIZE_L2",
      SQL_FN_V_LIST_THD(Item_func_fb_vector_normalize_l2, 1, 1)},
     {"FB_VECTOR_BLOB_TO_JSON",
@@ -1807,8 +1809,11 @@ static const std::pair<const char *, Create_func *> func_array[] = {
      SQL_FN_LIST(Item_func_fb_vector_json_to_blob, 1)},
     // semantic db functions
     {"SEMANTIC_RANK", SQL_FN_V_LIST_THD(Item_func_semantic_rank, 2, 2)},
+    {"SEMANTIC_EMBED", SQL_FN_V_LIST_THD(Item_func_semantic_embed, 1, 1)},
+    {"SEMANTIC_EMBED_IMAGE",
+     SQL_FN_V_LIST_THD(Item_func_semantic_embed_image, 1, 1)},
     {"SEMANTIC_FILTER_SINGLE_COL", 
-    SQL_FN_V_LIST_THD(Item_func_semantic_filter_single_col, 2, 2)},
+    SQL_FN_V_LIST_THD(Item_func_semantic_filter_single_col, 2, 3)},
     {"SEMANTIC_FILTER_TWO_COL", 
     SQL_FN_V_LIST_THD(Item_func_semantic_filter_two_col, 3, 3)},
     {"SEMANTIC_MAP", 
@@ -1816,7 +1821,7 @@ static const std::pair<const char *, Create_func *> func_array[] = {
     {"SEMANTIC_EXTRACT", 
     SQL_FN_V_LIST_THD(Item_func_semantic_extract, 2, 3)},
     {"SEMANTIC_JOIN", 
-    SQL_FN_V_LIST_THD(Item_func_semantic_filter_two_col, 3, 3)},
+    SQL_FN_V_LIST_THD(Item_func_semantic_join, 3, 5)},
     };
 
 using Native_functions_hash = std::unordered_map<std::string, Create_func *>;
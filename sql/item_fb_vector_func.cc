@@ -15,23 +15,72 @@
    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
 
 #include "sql/item_fb_vector_func.h"
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include "sql/fb_vector_base.h"
-#ifdef WITH_FB_VECTORDB
-#include <faiss/utils/distances.h>
-#endif
+#include "sql/fb_vector_distance.h"
 #include "sql-common/json_dom.h"
+#include "sql/item_cmpfunc.h"
 #include "sql/item_json_func.h"
+#include "sql/sql_class.h"
 #include "sql/sql_exception_handler.h"
+#include "sql/sql_lex.h"
 #include "sql/semantic_base.h"
+#include "sql/table.h"
+#include "sql/thd_raii.h"
 
 #define FB_VECTORDB_DISABLED_ERR                                            \
   do {                                                                      \
     my_error(ER_FEATURE_DISABLED, MYF(0), "vector db", "WITH_FB_VECTORDB"); \
   } while (0)
 
+/**
+  if the item holds a float array as raw bytes, like a BLOB bound to a
+  parameter of a prepared statement, which needs no parsing.
+*/
+static bool is_fb_vector_binary(const Item *item) {
+  if (item->type() == Item::PARAM_ITEM) {
+    const auto *param = down_cast<const Item_param *>(item);
+    return is_string_type(param->data_type_actual()) &&
+           param->data_type_actual() != MYSQL_TYPE_JSON &&
+           param->collation_actual() == &my_charset_bin;
+  }
+  switch (item->data_type()) {
+    case MYSQL_TYPE_VARCHAR:
+    case MYSQL_TYPE_STRING:
+    case MYSQL_TYPE_BLOB:
+      return item->collation.collation == &my_charset_bin;
+    default:
+      return false;
+  }
+}
+
 bool parse_fb_vector_from_item(Item **args, uint arg_idx, String &str,
                                const char *func_name, Fb_vector &vector) {
+  if (args[arg_idx]->data_type() == MYSQL_TYPE_BLOB &&
+      args[arg_idx]->type() == Item::FIELD_ITEM) {
+    const Item_field *fi = down_cast<const Item_field *>(args[arg_idx]);
+    if (parse_fb_vector_from_blob(fi->field, vector)) {
+      my_error(ER_INCORRECT_TYPE, MYF(0), std::to_string(arg_idx).c_str(),
+               func_name);
+      return true;
+    }
+    return false;
+  }
+
+  if (is_fb_vector_binary(args[arg_idx])) {
+    const String *res = args[arg_idx]->val_str(&str);
+    // str is reused for the other arguments, the item's own buffer is not
+    if (res == nullptr || parse_fb_vector_from_binary(res, res == &str,
+                                                      vector)) {
+      my_error(ER_INCORRECT_TYPE, MYF(0), std::to_string(arg_idx).c_str(),
+               func_name);
+      return true;
+    }
+    return false;
+  }
+
   if (args[arg_idx]->data_type() == MYSQL_TYPE_VARCHAR ||
       args[arg_idx]->data_type() == MYSQL_TYPE_JSON) {
     Json_wrapper wrapper;
@@ -47,20 +96,275 @@ bool parse_fb_vector_from_item(Item **args, uint arg_idx, String &str,
     return false;
   }
 
-  if (args[arg_idx]->data_type() == MYSQL_TYPE_BLOB &&
-      args[arg_idx]->type() == Item::FIELD_ITEM) {
-    const Item_field *fi = down_cast<const Item_field *>(args[arg_idx]);
-    if (parse_fb_vector_from_blob(fi->field, vector)) {
+  return true;
+}
+
+/**
+  parse a multi-vector argument, a JSON array of vectors or the floats of
+  the vectors one after the other, into vector. the vectors of a JSON array
+  or of a multi-vector column set dimension, which must match the one
+  already set.
+*/
+static bool parse_fb_multi_vector_from_item(Item **args, uint arg_idx,
+                                            String &str,
+                                            const char *func_name,
+                                            Fb_vector &vector,
+                                            size_t *dimension) {
+  Item *arg = args[arg_idx];
+  size_t arg_dimension = 0;
+  if (arg->type() == Item::FIELD_ITEM &&
+      down_cast<Item_field *>(arg)->field->m_fb_vector_multi) {
+    arg_dimension = down_cast<Item_field *>(arg)->field->m_fb_vector_dimension;
+  }
+  if (arg->data_type() == MYSQL_TYPE_JSON ||
+      (arg->data_type() == MYSQL_TYPE_VARCHAR && !is_fb_vector_binary(arg))) {
+    Json_wrapper wrapper;
+    if (get_json_wrapper(args, arg_idx, &str, func_name, &wrapper)) {
+      return true;
+    }
+    if (arg_dimension == 0 && wrapper.type() == enum_json_type::J_ARRAY &&
+        wrapper.length() > 0 &&
+        wrapper[0].type() == enum_json_type::J_ARRAY) {
+      arg_dimension = wrapper[0].length();
+    }
+    if (arg_dimension == 0 ||
+        parse_fb_multi_vector_from_json(wrapper, arg_dimension,
+                                        vector.get_data_ref())) {
       my_error(ER_INCORRECT_TYPE, MYF(0), std::to_string(arg_idx).c_str(),
                func_name);
       return true;
     }
+  } else if (parse_fb_vector_from_item(args, arg_idx, str, func_name,
+                                       vector)) {
+    return true;
+  }
+  if (arg_dimension != 0) {
+    if (*dimension != 0 && *dimension != arg_dimension) {
+      my_error(ER_INCORRECT_TYPE, MYF(0), std::to_string(arg_idx).c_str(),
+               func_name);
+      return true;
+    }
+    *dimension = arg_dimension;
+  }
+  return false;
+}
+
+/**
+  parse a sparse vector argument, a JSON object, into vector. sparse is set
+  to whether the argument is one, the others are left to
+  parse_fb_vector_from_item.
+*/
+static bool parse_fb_sparse_vector_from_item(Item **args, uint arg_idx,
+                                             String &str,
+                                             const char *func_name,
+                                             Fb_sparse_vector &vector,
+                                             bool *sparse) {
+  Item *arg = args[arg_idx];
+  *sparse = false;
+  if ((arg->data_type() != MYSQL_TYPE_JSON &&
+       arg->data_type() != MYSQL_TYPE_VARCHAR) ||
+      is_fb_vector_binary(arg)) {
+    return false;
+  }
+  Json_wrapper wrapper;
+  if (get_json_wrapper(args, arg_idx, &str, func_name, &wrapper)) {
+    return true;
+  }
+  if (wrapper.type() != enum_json_type::J_OBJECT) {
+    return false;
+  }
+  *sparse = true;
+  if (parse_fb_sparse_vector_from_json(wrapper, vector)) {
+    my_error(ER_INCORRECT_TYPE, MYF(0), std::to_string(arg_idx).c_str(),
+             func_name);
+    return true;
+  }
+  return false;
+}
+
+namespace {
+
+bool is_numeric_literal(const Item *item) {
+  return item->type() == Item::DECIMAL_ITEM ||
+         item->type() == Item::REAL_ITEM || item->type() == Item::INT_ITEM;
+}
+
+// add weight * item to score, return true if item is not a supported term
+bool add_hybrid_score_term(Item *item, double weight, Fb_hybrid_score *score) {
+  item = item->real_item();
+  // constants shift every score by the same amount
+  if (is_numeric_literal(item)) return false;
+  if (item->type() != Item::FUNC_ITEM) return true;
+
+  auto *func = down_cast<Item_func *>(item);
+  Item **args = func->arguments();
+  switch (func->functype()) {
+    case Item_func::PLUS_FUNC:
+      return add_hybrid_score_term(args[0], weight, score) ||
+             add_hybrid_score_term(args[1], weight, score);
+    case Item_func::MINUS_FUNC:
+      return add_hybrid_score_term(args[0], weight, score) ||
+             add_hybrid_score_term(args[1], -weight, score);
+    case Item_func::NEG_FUNC:
+      return add_hybrid_score_term(args[0], -weight, score);
+    case Item_func::MUL_FUNC: {
+      Item *lhs = args[0]->real_item();
+      Item *rhs = args[1]->real_item();
+      if (is_numeric_literal(lhs)) {
+        return add_hybrid_score_term(rhs, weight * lhs->val_real(), score);
+      }
+      if (is_numeric_literal(rhs)) {
+        return add_hybrid_score_term(lhs, weight * rhs->val_real(), score);
+      }
+      return true;
+    }
+    case Item_func::FB_VECTOR_L2:
+    case Item_func::FB_VECTOR_IP:
+    case Item_func::FB_VECTOR_COSINE:
+    case Item_func::FB_VECTOR_MAXSIM: {
+      auto *distance = down_cast<Item_func_fb_vector_distance *>(func);
+      if (score->m_vector_distance &&
+          !score->m_vector_distance->eq(distance, false)) {
+        return true;
+      }
+      score->m_vector_distance = distance;
+      score->m_vector_weight += weight;
+      return false;
+    }
+    case Item_func::FT_FUNC: {
+      auto *match = down_cast<Item_func_match *>(func);
+      if (match->flags & (FT_BOOL | FT_EXPAND) ||
+          (score->m_text_relevance &&
+           !score->m_text_relevance->eq(match, false))) {
+        return true;
+      }
+      score->m_text_relevance = match;
+      score->m_text_weight += weight;
+      return false;
+    }
+    default:
+      break;
+  }
+
+  if (strcmp(func->func_name(), "st_distance") == 0 &&
+      func->argument_count() == 2 && args[0]->type() == Item::FIELD_ITEM &&
+      args[1]->const_item()) {
+    if (score->m_spatial_distance &&
+        !score->m_spatial_distance->eq(func, false)) {
+      return true;
+    }
+    score->m_spatial_distance = func;
+    score->m_spatial_weight += weight;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+bool fb_parse_hybrid_score(Item *item, Fb_hybrid_score *score) {
+  *score = Fb_hybrid_score();
+  if (add_hybrid_score_term(item, 1, score)) return true;
+  // a negative weight would flip the order the index returns rows in
+  if (!score->m_vector_distance || score->m_vector_weight <= 0) return true;
+  if (score->m_spatial_distance) {
+    // the hybrid scan adds metres to squared l2 distances and expects both
+    // to grow as rows get worse
+    if (score->m_vector_distance->functype() != Item_func::FB_VECTOR_L2 ||
+        score->m_spatial_weight < 0) {
+      return true;
+    }
+  }
+  if (score->m_text_relevance) {
+    // a higher relevance ranks a row better: it lowers an l2 distance and
+    // raises a similarity
+    const bool is_l2 =
+        score->m_vector_distance->functype() == Item_func::FB_VECTOR_L2;
+    if (score->m_spatial_distance ||
+        (is_l2 ? score->m_text_weight >= 0 : score->m_text_weight <= 0)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool fb_parse_hybrid_score(ORDER *order, Fb_hybrid_score *score) {
+  Item *item = *order->item;
+  if (order->hybrid_score != nullptr && order->hybrid_score_item == item) {
+    *score = *order->hybrid_score;
+    return score->m_vector_distance == nullptr;
+  }
+
+  const bool unsupported = fb_parse_hybrid_score(item, score);
+  if (order->hybrid_score == nullptr) {
+    // the ORDER lives as long as the statement, so does its score
+    THD *thd = current_thd;
+    Prepared_stmt_arena_holder ps_arena_holder(thd);
+    order->hybrid_score = new (thd->mem_root) Fb_hybrid_score;
+    if (order->hybrid_score == nullptr) return unsupported;
+  }
+  *order->hybrid_score = unsupported ? Fb_hybrid_score() : *score;
+  order->hybrid_score_item = item;
+  return unsupported;
+}
+
+// tighten bound if cond is a bound on distance, return false if it is not
+static bool add_distance_bound(Item *cond,
+                               const Item_func_fb_vector_distance *distance,
+                               std::optional<double> *bound) {
+  if (cond->type() != Item::FUNC_ITEM) return false;
+  auto *func = down_cast<Item_func *>(cond);
+  const auto functype = func->functype();
+  if (functype != Item_func::LT_FUNC && functype != Item_func::LE_FUNC &&
+      functype != Item_func::GT_FUNC && functype != Item_func::GE_FUNC) {
     return false;
   }
 
+  Item *lhs = func->arguments()[0]->real_item();
+  Item *rhs = func->arguments()[1]->real_item();
+  Item *value = nullptr;
+  bool upper = functype == Item_func::LT_FUNC || functype == Item_func::LE_FUNC;
+  if (lhs->eq(distance, false)) {
+    value = rhs;
+  } else if (rhs->eq(distance, false)) {
+    value = lhs;
+    upper = !upper;
+  } else {
+    return false;
+  }
+  // l2 ranks rows by ascending distance, the similarities by descending
+  if (upper != (distance->functype() == Item_func::FB_VECTOR_L2)) return false;
+  if (!value->const_for_execution() || value->has_subquery() ||
+      value->has_stored_program()) {
+    return false;
+  }
+
+  const double limit = value->val_real();
+  if (value->null_value) return false;
+  if (!bound->has_value()) {
+    *bound = limit;
+  } else if (upper) {
+    *bound = std::min(**bound, limit);
+  } else {
+    *bound = std::max(**bound, limit);
+  }
   return true;
 }
 
+bool fb_vector_distance_bound(Item *cond,
+                              const Item_func_fb_vector_distance *distance,
+                              std::optional<double> *bound) {
+  if (cond->type() == Item::COND_ITEM &&
+      down_cast<Item_cond *>(cond)->functype() == Item_func::COND_AND_FUNC) {
+    bool only_bounds = true;
+    for (Item &item : *down_cast<Item_cond *>(cond)->argument_list()) {
+      if (!add_distance_bound(&item, distance, bound)) only_bounds = false;
+    }
+    return only_bounds;
+  }
+  return add_distance_bound(cond, distance, bound);
+}
+
 Item_func_fb_vector_distance::Item_func_fb_vector_distance(THD * /* thd */,
                                                            const POS &pos,
                                                            PT_item_list *a)
@@ -89,6 +393,14 @@ Item_func_fb_vector_distance::can_cache_json_arg(Item *arg) {
   return arg == args[0] || arg == args[1] ? CACHE_JSON_VALUE : CACHE_NONE;
 }
 
+void Item_func_fb_vector_distance::cleanup() {
+  // a parameter binds another vector at the next execution
+  m_input_vector = Fb_vector();
+  m_input_sparse_vector.clear();
+  m_input_sparse = false;
+  Item_real_func::cleanup();
+}
+
 bool Item_func_fb_vector_distance::get_input_vector(
     std::vector<float> &result) {
   if (fix_input_vector()) {
@@ -102,10 +414,23 @@ bool Item_func_fb_vector_distance::get_input_vector(
   return false;
 }
 
+bool Item_func_fb_vector_distance::get_input_sparse_vector(
+    Fb_sparse_vector &result) {
+  if (fix_input_vector()) {
+    return true;
+  }
+  result.clear();
+  if (m_input_sparse) {
+    result = m_input_sparse_vector;
+  }
+  return false;
+}
+
 bool Item_func_fb_vector_distance::fix_input_vector() {
-  // the second arg is the input vector, it is a constant,
-  // only need to parse it once.
-  if (m_input_vector.get_dimension() == 0) {
+  // the second arg is the input vector. a constant only needs to be parsed
+  // once, an outer reference changes with every outer row.
+  if (m_input_vector.get_dimension() == 0 ||
+      !args[1]->const_for_execution()) {
     if (parse_fb_vector_from_item(args, 1, m_value, func_name(),
                                   m_input_vector)) {
       return true;
@@ -123,22 +448,7 @@ double Item_func_fb_vector_distance::val_real() {
     if (fix_input_vector()) {
       return error_real();
     }
-
-    Fb_vector vector1;
-    if (parse_fb_vector_from_item(args, 0, m_value, func_name(), vector1)) {
-      return error_real();
-    }
-    const size_t dimension =
-        std::max(vector1.get_dimension(), m_input_vector.get_dimension());
-    if (vector1.set_dimension(dimension) ||
-        m_input_vector.set_dimension(dimension)) {
-      assert(false);
-      // should never happen
-      my_error(ER_INVALID_CAST, MYF(0), "a smaller dimension");
-      return error_real();
-    }
-    return compute_distance(vector1.get_data_view(),
-                            m_input_vector.get_data_view(), dimension);
+    return dense_distance();
   } catch (...) {
     handle_std_exception(func_name());
     return error_real();
@@ -147,6 +457,24 @@ double Item_func_fb_vector_distance::val_real() {
   return 0.0;
 }
 
+double Item_func_fb_vector_distance::dense_distance() {
+  Fb_vector vector1;
+  if (parse_fb_vector_from_item(args, 0, m_value, func_name(), vector1)) {
+    return error_real();
+  }
+  const size_t dimension =
+      std::max(vector1.get_dimension(), m_input_vector.get_dimension());
+  if (vector1.set_dimension(dimension) ||
+      m_input_vector.set_dimension(dimension)) {
+    assert(false);
+    // should never happen
+    my_error(ER_INVALID_CAST, MYF(0), "a smaller dimension");
+    return error_real();
+  }
+  return compute_distance(vector1.get_data_view(),
+                          m_input_vector.get_data_view(), dimension);
+}
+
 Item_func_fb_vector_l2::Item_func_fb_vector_l2(THD *thd, const POS &pos,
                                                PT_item_list *a)
     : Item_func_fb_vector_distance(thd, pos, a) {}
@@ -167,9 +495,67 @@ enum Item_func::Functype Item_func_fb_vector_ip::functype() const {
   return FB_VECTOR_IP;
 }
 
+bool Item_func_fb_vector_ip::fix_input_vector() {
+  if ((m_input_vector.get_dimension() == 0 && !m_input_sparse) ||
+      !args[1]->const_for_execution()) {
+    if (parse_fb_sparse_vector_from_item(args, 1, m_value, func_name(),
+                                         m_input_sparse_vector,
+                                         &m_input_sparse)) {
+      return true;
+    }
+    if (!m_input_sparse) {
+      return parse_fb_vector_from_item(args, 1, m_value, func_name(),
+                                       m_input_vector);
+    }
+    m_input_vector = Fb_vector();
+  }
+  return false;
+}
+
+Item_func_fb_vector_cosine::Item_func_fb_vector_cosine(THD *thd,
+                                                       const POS &pos,
+                                                       PT_item_list *a)
+    : Item_func_fb_vector_distance(thd, pos, a) {}
+
+const char *Item_func_fb_vector_cosine::func_name() const {
+  return "fb_vector_cosine";
+}
+
+enum Item_func::Functype Item_func_fb_vector_cosine::functype() const {
+  return FB_VECTOR_COSINE;
+}
+
+Item_func_fb_vector_maxsim::Item_func_fb_vector_maxsim(THD *thd,
+                                                       const POS &pos,
+                                                       PT_item_list *a)
+    : Item_func_fb_vector_distance(thd, pos, a) {}
+
+const char *Item_func_fb_vector_maxsim::func_name() const {
+  return "fb_vector_maxsim";
+}
+
+enum Item_func::Functype Item_func_fb_vector_maxsim::functype() const {
+  return FB_VECTOR_MAXSIM;
+}
+
+bool Item_func_fb_vector_maxsim::fix_input_vector() {
+  if (m_input_vector.get_dimension() == 0 ||
+      !args[1]->const_for_execution()) {
+    m_query_dimension = 0;
+    if (parse_fb_multi_vector_from_item(args, 1, m_value, func_name(),
+                                        m_input_vector, &m_query_dimension)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 Item_func_semantic_rank::Item_func_semantic_rank(THD *thd, const POS &pos,
                                                    PT_item_list *a)
-    : Item_func_fb_vector_distance(thd, pos, a) {}
+    : Item_func_fb_vector_distance(thd, pos, a) {
+  // embeddings of the model may change
+  thd->lex->safe_to_cache_query = false;
+}
 
 const char *Item_func_semantic_rank::func_name() const { return "semantic_rank"; }
 
@@ -203,7 +589,12 @@ double Item_func_semantic_rank::val_real() {
     }
 
     // Check if we've already embedded this text
-    if (!m_text_embedding_cached || m_text_cache.length() != text_str->length() ||
+    std::vector<float> prefetched;
+    if (take_prefetched_embedding(&prefetched)) {
+      m_text_cache.copy(*text_str);
+      m_input_vector.get_data_ref() = std::move(prefetched);
+      m_text_embedding_cached = true;
+    } else if (!m_text_embedding_cached || m_text_cache.length() != text_str->length() ||
         memcmp(m_text_cache.ptr(), text_str->ptr(), text_str->length()) != 0) {
 
       // Cache the text and get its embedding
@@ -255,6 +646,133 @@ bool Item_func_semantic_rank::embed_text_to_vector(const String *text_str, Fb_ve
 #endif
 }
 
+// An embedding as a json array of doubles.
+static bool embedding_to_json(const std::vector<float> &embedding,
+                              Json_wrapper *wr) {
+  Json_array_ptr array = create_dom_ptr<Json_array>();
+  for (float value : embedding) {
+    Json_double d(value);
+    if (array->append_clone(&d)) {
+      return true;
+    }
+  }
+  *wr = Json_wrapper(std::move(array));
+  return false;
+}
+
+Item_func_semantic_embed::Item_func_semantic_embed(THD *thd, const POS &pos,
+                                                   PT_item_list *a)
+    : Item_json_func(thd, pos, a) {
+  // embeddings of the model may change
+  thd->lex->safe_to_cache_query = false;
+}
+
+const char *Item_func_semantic_embed::func_name() const {
+  return "semantic_embed";
+}
+
+enum Item_func::Functype Item_func_semantic_embed::functype() const {
+  return SEMANTIC_EMBED;
+}
+
+bool Item_func_semantic_embed::resolve_type(THD *thd) {
+  if (param_type_is_default(thd, 0, 1, MYSQL_TYPE_VARCHAR)) return true;
+  set_nullable(true);
+  return false;
+}
+
+bool Item_func_semantic_embed::val_json(Json_wrapper *wr) {
+  try {
+    String *text_str = args[0]->val_str(&m_value);
+    if (!text_str || args[0]->null_value) {
+      return error_json();
+    }
+
+    std::vector<float> embedding;
+    if (!take_prefetched_embedding(&embedding)) {
+#ifdef WITH_SEMANTICDB
+      std::string text(text_str->ptr(), text_str->length());
+      if (semantic_embed_openai(text, &embedding)) {
+        my_error(ER_SIGNAL_EXCEPTION, MYF(0),
+                 "Failed to embed text with OpenAI API", func_name());
+        return error_json();
+      }
+#else
+      my_error(ER_FEATURE_DISABLED, MYF(0), "semantic db", "WITH_SEMANTICDB");
+      return error_json();
+#endif
+    }
+
+    if (embedding_to_json(embedding, wr)) {
+      return error_json();
+    }
+    null_value = false;
+  } catch (...) {
+    handle_std_exception(func_name());
+    return error_json();
+  }
+  return false;
+}
+
+Item_func_semantic_embed_image::Item_func_semantic_embed_image(
+    THD *thd, const POS &pos, PT_item_list *a)
+    : Item_json_func(thd, pos, a) {
+  // embeddings of the model may change
+  thd->lex->safe_to_cache_query = false;
+}
+
+const char *Item_func_semantic_embed_image::func_name() const {
+  return "semantic_embed_image";
+}
+
+enum Item_func::Functype Item_func_semantic_embed_image::functype() const {
+  return SEMANTIC_EMBED_IMAGE;
+}
+
+bool Item_func_semantic_embed_image::resolve_type(THD *thd) {
+  if (param_type_is_default(thd, 0, 1, MYSQL_TYPE_BLOB)) return true;
+  set_nullable(true);
+  return false;
+}
+
+bool Item_func_semantic_embed_image::val_json(Json_wrapper *wr) {
+  try {
+    String *image_str = args[0]->val_str(&m_value);
+    if (!image_str || args[0]->null_value) {
+      return error_json();
+    }
+
+    std::vector<float> embedding;
+    if (!take_prefetched_embedding(&embedding)) {
+#ifdef WITH_SEMANTICDB
+      std::vector<std::vector<float>> embeddings;
+      if (semantic_embed_image_batch(
+              {std::string(image_str->ptr(), image_str->length())},
+              &embeddings) ||
+          embeddings[0].empty()) {
+        my_error(ER_SIGNAL_EXCEPTION, MYF(0),
+                 "Failed to embed image with semantic_embed_image_model",
+                 func_name());
+        return error_json();
+      }
+      embedding = std::move(embeddings[0]);
+#else
+      my_error(ER_FEATURE_DISABLED, MYF(0), "semantic db", "WITH_SEMANTICDB");
+      return error_json();
+#endif
+    }
+
+    if (embedding_to_json(embedding, wr)) {
+      return error_json();
+    }
+    null_value = false;
+  } catch (...) {
+    handle_std_exception(func_name());
+    return error_json();
+  }
+  return false;
+}
+
 Item_func_fb_vector_normalize_l2::Item_func_fb_vector_normalize_l2(
     THD *thd, const POS &pos, PT_item_list *a)
     : Item_json_func(thd, pos, a) {}
@@ -386,17 +904,94 @@ bool Item_func_fb_vector_blob_to_json::val_json(Json_wrapper *wr) {
 #ifdef WITH_FB_VECTORDB
 float Item_func_fb_vector_l2::compute_distance(const float *v1, const float *v2,
                                                size_t dimension) {
-  return faiss::fvec_L2sqr(v1, v2, dimension);
+  return fb_vector_l2sqr(v1, v2, dimension);
 }
 
 float Item_func_fb_vector_ip::compute_distance(const float *v1, const float *v2,
                                                size_t dimension) {
-  return faiss::fvec_inner_product(v1, v2, dimension);
+  return fb_vector_inner_product(v1, v2, dimension);
+}
+
+float Item_func_fb_vector_cosine::compute_distance(const float *v1,
+                                                   const float *v2,
+                                                   size_t dimension) {
+  return fb_vector_cosine(v1, v2, dimension);
 }
 
 float Item_func_semantic_rank::compute_distance(const float *v1, const float *v2,
                                                  size_t dimension) {
-  return faiss::fvec_L2sqr(v1, v2, dimension);
+  return fb_vector_l2sqr(v1, v2, dimension);
+}
+
+float Item_func_fb_vector_maxsim::compute_distance(const float *v1,
+                                                   const float *v2,
+                                                   size_t dimension) {
+  return fb_vector_inner_product(v1, v2, dimension);
+}
+
+double Item_func_fb_vector_ip::val_real() {
+  if (args[0]->null_value || args[1]->null_value) {
+    return error_real();
+  }
+
+  try {
+    if (fix_input_vector()) {
+      return error_real();
+    }
+    if (!m_input_sparse) {
+      return dense_distance();
+    }
+
+    // a sparse query only scores sparse vectors
+    Fb_sparse_vector vector1;
+    bool sparse = false;
+    if (parse_fb_sparse_vector_from_item(args, 0, m_value, func_name(),
+                                         vector1, &sparse)) {
+      return error_real();
+    }
+    if (!sparse) {
+      my_error(ER_INCORRECT_TYPE, MYF(0), "0", func_name());
+      return error_real();
+    }
+    return fb_vector_sparse_inner_product(
+        vector1.data(), vector1.size(), m_input_sparse_vector.data(),
+        m_input_sparse_vector.size());
+  } catch (...) {
+    handle_std_exception(func_name());
+    return error_real();
+  }
+}
+
+double Item_func_fb_vector_maxsim::val_real() {
+  if (args[0]->null_value || args[1]->null_value) {
+    return error_real();
+  }
+
+  try {
+    if (fix_input_vector()) {
+      return error_real();
+    }
+
+    Fb_vector doc;
+    size_t dimension = m_query_dimension;
+    if (parse_fb_multi_vector_from_item(args, 0, m_value, func_name(), doc,
+                                        &dimension)) {
+      return error_real();
+    }
+    const size_t query_size = m_input_vector.get_dimension();
+    const size_t doc_size = doc.get_dimension();
+    if (dimension == 0 || query_size % dimension || doc_size % dimension ||
+        doc_size == 0) {
+      my_error(ER_WRONG_ARGUMENTS, MYF(0), func_name());
+      return error_real();
+    }
+    return fb_vector_maxsim(m_input_vector.get_data_view(),
+                            query_size / dimension, doc.get_data_view(),
+                            doc_size / dimension, dimension);
+  } catch (...) {
+    handle_std_exception(func_name());
+    return error_real();
+  }
 }
 
 bool Item_func_fb_vector_normalize_l2::val_json(Json_wrapper *wr) {
@@ -409,7 +1004,7 @@ bool Item_func_fb_vector_normalize_l2::val_json(Json_wrapper *wr) {
       return error_json();
     }
     float *data = vector1.get_data();
-    faiss::fvec_renorm_L2(vector1.get_dimension(), 1, data);
+    fb_vector_normalize_l2(data, vector1.get_dimension());
     Json_array_ptr array(new (std::nothrow) Json_array());
     for (size_t i = 0; i < vector1.get_dimension(); ++i) {
       Json_double d(data[i]);
@@ -446,6 +1041,30 @@ float Item_func_fb_vector_ip::compute_distance(const float *v1 [[maybe_unused]],
   return error_real();
 }
 
+double Item_func_fb_vector_ip::val_real() {
+  FB_VECTORDB_DISABLED_ERR;
+  return error_real();
+}
+
+float Item_func_fb_vector_cosine::compute_distance(
+    const float *v1 [[maybe_unused]], const float *v2 [[maybe_unused]],
+    size_t dimension [[maybe_unused]]) {
+  FB_VECTORDB_DISABLED_ERR;
+  return error_real();
+}
+
+float Item_func_fb_vector_maxsim::compute_distance(
+    const float *v1 [[maybe_unused]], const float *v2 [[maybe_unused]],
+    size_t dimension [[maybe_unused]]) {
+  FB_VECTORDB_DISABLED_ERR;
+  return error_real();
+}
+
+double Item_func_fb_vector_maxsim::val_real() {
+  FB_VECTORDB_DISABLED_ERR;
+  return error_real();
+}
+
 float Item_func_semantic_rank::compute_distance(const float *v1 [[maybe_unused]],
                                                  const float *v2 [[maybe_unused]],
                                                  size_t dimension
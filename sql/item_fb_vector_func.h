@@ -16,16 +16,23 @@
 
 #pragma once
 
+#include <optional>
+
 #include "sql/item_func.h"
 #include "sql/item_json_func.h"
+#include "sql/next_spatial_base.h"
 #include "sql/system_variables.h"
 
+struct ORDER;
+
 /**
   parent class of vector distance functions
 */
 class Item_func_fb_vector_distance : public Item_real_func {
  public:
   Item_func_fb_vector_distance(THD *thd, const POS &pos, PT_item_list *a);
+  /// For distances built by the optimizer, e.g. for a semantic join.
+  Item_func_fb_vector_distance(Item *a, Item *b) : Item_real_func(a, b) {}
 
   bool resolve_type(THD *thd) override;
 
@@ -33,23 +40,45 @@ class Item_func_fb_vector_distance : public Item_real_func {
 
   double val_real() override;
 
+  void cleanup() override;
+
   // get the input vector, return false if successful
   bool get_input_vector(std::vector<float> &input_vector);
 
+  // get the input vector if it is sparse, see Item_func_fb_vector_ip.
+  // return false if successful, a dense one leaves input_vector empty
+  bool get_input_sparse_vector(Fb_sparse_vector &input_vector);
+
   // hints passed to storage engine
   ha_rows m_limit = 0;
   enum_fb_vector_search_type m_search_type = FB_VECTOR_SEARCH_KNN_FIRST;
   uint m_nprobe = 0;
+  uint m_threads = 1;
+  uint m_target_candidates = 0;
+  // the WHERE condition drops the rows ranked beyond this distance, or below
+  // this similarity, which a knn search does not need to return
+  std::optional<double> m_distance_bound;
   float m_weight = 0.0f;
-  std::string m_query_coordinate;
+  // query geometry of the spatial term of a hybrid search, a constant one is
+  // parsed once and reused by later executions of a prepared statement
+  Next_spatial_query_geometry m_query_geometry;
+  // MATCH ... AGAINST term of a hybrid search, with its weight relative to
+  // the distance. the engine fuses the knn results with the fulltext matches
+  Item_func_match *m_text_relevance = nullptr;
+  float m_text_weight = 0.0f;
 
  protected:
   /// String used when reading JSON binary values or JSON text values.
   String m_value;
   Fb_vector m_input_vector;
+  /// The input vector when it is sparse, m_input_vector is then empty.
+  Fb_sparse_vector m_input_sparse_vector;
+  bool m_input_sparse = false;
   virtual float compute_distance(const float *v1, const float *v2,
                                  size_t dimension) = 0;
-  bool fix_input_vector();
+  virtual bool fix_input_vector();
+  /// compute_distance() of the first argument and the input vector
+  double dense_distance();
 };
 
 /**
@@ -58,6 +87,8 @@ class Item_func_fb_vector_distance : public Item_real_func {
 class Item_func_fb_vector_l2 final : public Item_func_fb_vector_distance {
  public:
   Item_func_fb_vector_l2(THD *thd, const POS &pos, PT_item_list *a);
+  Item_func_fb_vector_l2(Item *a, Item *b)
+      : Item_func_fb_vector_distance(a, b) {}
 
   const char *func_name() const override;
   enum Functype functype() const override;
@@ -68,24 +99,107 @@ class Item_func_fb_vector_l2 final : public Item_func_fb_vector_distance {
 };
 
 /**
-  Represents the function FB_VECTOR_IP()
+  Represents the function FB_VECTOR_IP(). Both arguments can also be sparse
+  vectors, JSON objects of index to value, see Fb_sparse_vector.
 */
 class Item_func_fb_vector_ip final : public Item_func_fb_vector_distance {
  public:
   Item_func_fb_vector_ip(THD *thd, const POS &pos, PT_item_list *a);
+  Item_func_fb_vector_ip(Item *a, Item *b)
+      : Item_func_fb_vector_distance(a, b) {}
+
+  const char *func_name() const override;
+  enum Functype functype() const override;
+  double val_real() override;
+
+ protected:
+  float compute_distance(const float *v1, const float *v2,
+                         size_t dimension) override;
+  bool fix_input_vector() override;
+};
+
+/**
+  Represents the function FB_VECTOR_COSINE(), the cosine similarity
+*/
+class Item_func_fb_vector_cosine final : public Item_func_fb_vector_distance {
+ public:
+  Item_func_fb_vector_cosine(THD *thd, const POS &pos, PT_item_list *a);
+  Item_func_fb_vector_cosine(Item *a, Item *b)
+      : Item_func_fb_vector_distance(a, b) {}
+
+  const char *func_name() const override;
+  enum Functype functype() const override;
+
+ protected:
+  float compute_distance(const float *v1, const float *v2,
+                         size_t dimension) override;
+};
+
+/**
+  Represents the function FB_VECTOR_MAXSIM(), the late interaction score of
+  a multi-vector column: the sum over the vectors of the query of their
+  largest inner product with the vectors of the row. Both arguments are
+  JSON arrays of vectors, or the floats of the vectors one after the other.
+*/
+class Item_func_fb_vector_maxsim final : public Item_func_fb_vector_distance {
+ public:
+  Item_func_fb_vector_maxsim(THD *thd, const POS &pos, PT_item_list *a);
 
   const char *func_name() const override;
   enum Functype functype() const override;
+  double val_real() override;
 
  protected:
   float compute_distance(const float *v1, const float *v2,
                          size_t dimension) override;
+  /// The query vectors, one after the other, in m_input_vector.
+  bool fix_input_vector() override;
+
+ private:
+  /// Dimension of the query vectors, 0 if given as floats.
+  size_t m_query_dimension = 0;
+};
+
+/**
+  A function embedding a text argument on each row. SemanticFilterIterator
+  reads rows ahead and embeds their texts in one request, handing each row
+  its embedding before the row is evaluated. The semantic materializer does
+  the same for the rows of STORED ASYNC columns, images included.
+*/
+class Semantic_text_embedder {
+ public:
+  /// The argument holding the text to embed.
+  virtual Item *embedded_text() const = 0;
+
+  /// Whether the argument is the bytes of an image file rather than a text.
+  virtual bool embeds_images() const { return false; }
+
+  /// Hand in the embedding of the text of the current row, used once by the
+  /// next evaluation. An empty one means none.
+  void set_prefetched_embedding(std::vector<float> embedding) {
+    m_prefetched_embedding = std::move(embedding);
+  }
+
+ protected:
+  ~Semantic_text_embedder() = default;
+
+  /// Take the prefetched embedding, return false if there is none.
+  bool take_prefetched_embedding(std::vector<float> *embedding) {
+    if (m_prefetched_embedding.empty()) return false;
+    *embedding = std::move(m_prefetched_embedding);
+    m_prefetched_embedding.clear();
+    return true;
+  }
+
+ private:
+  std::vector<float> m_prefetched_embedding;
 };
 
 /**
   Represents the function SEMANTIC_RANK()
 */
-class Item_func_semantic_rank final : public Item_func_fb_vector_distance {
+class Item_func_semantic_rank final : public Item_func_fb_vector_distance,
+                                      public Semantic_text_embedder {
  public:
   Item_func_semantic_rank(THD *thd, const POS &pos, PT_item_list *a);
 
@@ -95,6 +209,8 @@ class Item_func_semantic_rank final : public Item_func_fb_vector_distance {
   bool resolve_type(THD *thd) override;
   double val_real() override;
 
+  Item *embedded_text() const override { return args[1]; }
+
  protected:
   float compute_distance(const float *v1, const float *v2,
                          size_t dimension) override;
@@ -105,6 +221,52 @@ class Item_func_semantic_rank final : public Item_func_fb_vector_distance {
   bool m_text_embedding_cached = false;
 };
 
+/**
+  Represents the function SEMANTIC_EMBED(), the embedding of a text as a
+  json vector, e.g. to store in a vector column:
+
+    UPDATE docs SET embedding = SEMANTIC_EMBED(body)
+*/
+class Item_func_semantic_embed final : public Item_json_func,
+                                       public Semantic_text_embedder {
+ public:
+  Item_func_semantic_embed(THD *thd, const POS &pos, PT_item_list *a);
+
+  const char *func_name() const override;
+  enum Functype functype() const override;
+
+  bool resolve_type(THD *thd) override;
+
+  bool val_json(Json_wrapper *wr) override;
+
+  Item *embedded_text() const override { return args[0]; }
+};
+
+/**
+  Represents the function SEMANTIC_EMBED_IMAGE(), the embedding of an image
+  file by semantic_embed_image_model as a json vector. Embedding one row at
+  a time is slow, so a vector column is best filled in batches by the
+  semantic materializer, as INSERT ... SELECT and LOAD DATA write its rows:
+
+    ALTER TABLE photos ADD COLUMN embedding JSON
+      GENERATED ALWAYS AS (SEMANTIC_EMBED_IMAGE(image)) STORED ASYNC
+*/
+class Item_func_semantic_embed_image final : public Item_json_func,
+                                             public Semantic_text_embedder {
+ public:
+  Item_func_semantic_embed_image(THD *thd, const POS &pos, PT_item_list *a);
+
+  const char *func_name() const override;
+  enum Functype functype() const override;
+
+  bool resolve_type(THD *thd) override;
+
+  bool val_json(Json_wrapper *wr) override;
+
+  Item *embedded_text() const override { return args[0]; }
+  bool embeds_images() const override { return true; }
+};
+
 /**
   Represents the function FB_VECTOR_NORMALIZE_L2()
 */
@@ -153,3 +315,64 @@ class Item_func_fb_vector_json_to_blob final : public Item_str_func {
 
 bool parse_fb_vector_from_item(Item **args, uint arg_idx, String &str,
                                const char *func_name, Fb_vector &vector);
+
+/**
+  an ORDER BY expression that ranks rows by a weighted sum of one vector
+  distance and st_distance() terms, e.g.
+  0.7 * FB_VECTOR_L2(v, q) + 0.3 * ST_DISTANCE(p, POINT(x, y)) + 1, or of
+  one vector distance and one fulltext relevance, e.g.
+  FB_VECTOR_L2(v, q) - 0.5 * MATCH(body) AGAINST('text').
+  weights of repeated terms are added up and constant terms are dropped, as
+  neither changes the order of the rows.
+*/
+struct Fb_hybrid_score {
+  Item_func_fb_vector_distance *m_vector_distance = nullptr;
+  double m_vector_weight = 0;
+  // st_distance() between a column and a constant point, or nullptr
+  Item_func *m_spatial_distance = nullptr;
+  double m_spatial_weight = 0;
+  // natural language MATCH ... AGAINST, or nullptr
+  Item_func_match *m_text_relevance = nullptr;
+  double m_text_weight = 0;
+
+  /** spatial weight once the vector distance is scaled to a weight of 1 */
+  double relative_spatial_weight() const {
+    return m_spatial_weight / m_vector_weight;
+  }
+
+  /** text weight once the vector distance is scaled to a weight of 1 */
+  double relative_text_weight() const {
+    return m_text_weight / m_vector_weight;
+  }
+};
+
+/**
+  decompose an ORDER BY expression into a Fb_hybrid_score. return false on
+  success, true when some term cannot be ranked by a vector, spatial or
+  fulltext index (a plain column, a second distinct distance...), in which
+  case the caller should fall back to a filesort.
+*/
+bool fb_parse_hybrid_score(Item *item, Fb_hybrid_score *score);
+
+/**
+  fb_parse_hybrid_score() of an ORDER BY element, parsed once for all the
+  executions of a prepared statement.
+*/
+bool fb_parse_hybrid_score(ORDER *order, Fb_hybrid_score *score);
+
+/**
+  the tightest bound the conjuncts of a condition put on the distance of a
+  knn search, like FB_VECTOR_L2(v, q) < 0.8, or FB_VECTOR_IP(v, q) >= 0.5 for
+  the similarities that rank rows in descending order.
+
+  @param cond the condition
+  @param distance the distance the rows are ordered by
+  @param[out] bound the bound, left as is when no conjunct bounds the
+  distance
+
+  @return true if cond is only made of such bounds, so that it drops no row
+  of the k nearest but the ones beyond the bound
+*/
+bool fb_vector_distance_bound(Item *cond,
+                              const Item_func_fb_vector_distance *distance,
+                              std::optional<double> *bound);
@@ -301,6 +301,8 @@ class Item_func : public Item_result_field {
     // vector db functions
     FB_VECTOR_L2,
     FB_VECTOR_IP,
+    FB_VECTOR_COSINE,
+    FB_VECTOR_MAXSIM,
     FB_VECTOR_NORMALIZE_L2,
     FB_VECTOR_BLOB_TO_JSON,
     FB_VECTOR_JSON_TO_BLOB,
@@ -310,7 +312,9 @@ class Item_func : public Item_result_field {
     SEMANTIC_FILTER_TWO_COL,
     SEMANTIC_MAP,
     SEMANTIC_EXTRACT,
-    SEMANTIC_JOIN
+    SEMANTIC_JOIN,
+    SEMANTIC_EMBED,
+    SEMANTIC_EMBED_IMAGE
   };
   enum optimize_type {
     OPTIMIZE_NONE,
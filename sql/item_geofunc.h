@@ -27,6 +27,7 @@
 #include <sys/types.h>
 
 #include <cstddef>
+#include <memory>
 #include <vector>
 
 #include "field_types.h"  // MYSQL_TYPE_BLOB
@@ -70,6 +71,8 @@ class Spatial_reference_system;
 namespace gis {
 class Geometry;
 class Point;
+class Prepared_polygon;
+enum class Point_location;
 }  // namespace gis
 
 /**
@@ -970,6 +973,7 @@ class Item_func_spatial_relation : public Item_bool_func2 {
  public:
   Item_func_spatial_relation(const POS &pos, Item *a, Item *b)
       : Item_bool_func2(pos, a, b) {}
+  ~Item_func_spatial_relation() override;
   bool resolve_type(THD *thd) override {
     if (param_type_is_default(thd, 0, -1, MYSQL_TYPE_GEOMETRY)) return true;
     // Spatial relation functions may return NULL if either parameter is NULL or
@@ -992,6 +996,7 @@ class Item_func_spatial_relation : public Item_bool_func2 {
     val_int();
     return null_value;
   }
+  void cleanup() override;
 
   /**
     Evaluate the spatial relation function.
@@ -1008,6 +1013,32 @@ class Item_func_spatial_relation : public Item_bool_func2 {
   virtual bool eval(const dd::Spatial_reference_system *srs,
                     const gis::Geometry *g1, const gis::Geometry *g2,
                     bool *result, bool *null) = 0;
+
+  /**
+    Evaluate the spatial relation function between a point and a Cartesian
+    polygon or multipolygon from where the point is.
+
+    @param[in] polygon_arg The argument that is the polygon, 0 or 1.
+    @param[in] location Where the point is, kInterior or kExterior.
+    @param[out] result Result of the relational operation.
+
+    @retval true The relation cannot be told from the location.
+    @retval false Success.
+  */
+  virtual bool point_relation(int polygon_arg [[maybe_unused]],
+                              gis::Point_location location [[maybe_unused]],
+                              bool *result [[maybe_unused]]) const {
+    return true;
+  }
+
+ private:
+  /// Parsed values of the arguments that are constant during execution, so
+  /// that they are parsed once instead of for every row.
+  std::unique_ptr<gis::Geometry> m_const_geometry[2];
+  gis::srid_t m_const_srid[2]{0, 0};
+  /// A constant polygon argument prepared for locating points.
+  std::unique_ptr<gis::Prepared_polygon> m_prepared;
+  int m_prepared_arg{-1};
 };
 
 class Item_func_st_contains final : public Item_func_spatial_relation {
@@ -1019,6 +1050,8 @@ class Item_func_st_contains final : public Item_func_spatial_relation {
   const char *func_name() const override { return "st_contains"; }
   bool eval(const dd::Spatial_reference_system *srs, const gis::Geometry *g1,
             const gis::Geometry *g2, bool *result, bool *null) override;
+  bool point_relation(int polygon_arg, gis::Point_location location,
+                      bool *result) const override;
 };
 
 class Item_func_st_crosses final : public Item_func_spatial_relation {
@@ -1041,6 +1074,8 @@ class Item_func_st_disjoint final : public Item_func_spatial_relation {
   const char *func_name() const override { return "st_disjoint"; }
   bool eval(const dd::Spatial_reference_system *srs, const gis::Geometry *g1,
             const gis::Geometry *g2, bool *result, bool *null) override;
+  bool point_relation(int polygon_arg, gis::Point_location location,
+                      bool *result) const override;
 };
 
 class Item_func_st_equals final : public Item_func_spatial_relation {
@@ -1063,6 +1098,8 @@ class Item_func_st_intersects final : public Item_func_spatial_relation {
   const char *func_name() const override { return "st_intersects"; }
   bool eval(const dd::Spatial_reference_system *srs, const gis::Geometry *g1,
             const gis::Geometry *g2, bool *result, bool *null) override;
+  bool point_relation(int polygon_arg, gis::Point_location location,
+                      bool *result) const override;
 };
 
 class Item_func_mbrcontains final : public Item_func_spatial_relation {
@@ -1195,6 +1232,8 @@ class Item_func_st_within final : public Item_func_spatial_relation {
   const char *func_name() const override { return "st_within"; }
   bool eval(const dd::Spatial_reference_system *srs, const gis::Geometry *g1,
             const gis::Geometry *g2, bool *result, bool *null) override;
+  bool point_relation(int polygon_arg, gis::Point_location location,
+                      bool *result) const override;
 };
 
 /**
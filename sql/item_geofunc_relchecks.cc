@@ -41,6 +41,8 @@
 #include "sql/dd/types/spatial_reference_system.h"
 #include "sql/derror.h"  // ER_THD
 #include "sql/gis/geometries.h"
+#include "sql/gis/geometries_cs.h"
+#include "sql/gis/prepared_polygon.h"
 #include "sql/gis/relops.h"
 #include "sql/gis/srid.h"
 #include "sql/gis/wkb.h"
@@ -55,6 +57,7 @@
 #include "sql/sql_exception_handler.h"
 #include "sql/srs_fetcher.h"
 #include "sql_string.h"
+#include "template_utils.h"  // down_cast
 
 namespace boost {
 namespace geometry {
@@ -64,48 +67,90 @@ struct cartesian;
 }  // namespace geometry
 }  // namespace boost
 
+Item_func_spatial_relation::~Item_func_spatial_relation() = default;
+
+void Item_func_spatial_relation::cleanup() {
+  Item_bool_func2::cleanup();
+  m_const_geometry[0].reset();
+  m_const_geometry[1].reset();
+  m_prepared.reset();
+  m_prepared_arg = -1;
+}
+
 longlong Item_func_spatial_relation::val_int() {
   DBUG_TRACE;
   assert(fixed);
 
-  String tmp_value1;
-  String tmp_value2;
-  String *res1 = args[0]->val_str(&tmp_value1);
-  String *res2 = args[1]->val_str(&tmp_value2);
-
-  if ((null_value =
-           (!res1 || args[0]->null_value || !res2 || args[1]->null_value))) {
-    assert(is_nullable());
-    return 0;
-  }
-
-  if (res1 == nullptr || res2 == nullptr) {
-    assert(false);
-    my_error(ER_GIS_INVALID_DATA, MYF(0), func_name());
-    return error_int();
+  THD *thd = current_thd;
+  String tmp_value[2];
+  String *res[2] = {nullptr, nullptr};
+  for (int i = 0; i < 2; ++i) {
+    // A constant geometry that is parsed is not NULL.
+    if (m_const_geometry[i] != nullptr) continue;
+    res[i] = args[i]->val_str(&tmp_value[i]);
+    if ((null_value = (!res[i] || args[i]->null_value))) {
+      assert(is_nullable());
+      return 0;
+    }
   }
 
-  const dd::Spatial_reference_system *srs1 = nullptr;
-  const dd::Spatial_reference_system *srs2 = nullptr;
-  std::unique_ptr<gis::Geometry> g1;
-  std::unique_ptr<gis::Geometry> g2;
+  const dd::Spatial_reference_system *srs[2] = {nullptr, nullptr};
+  std::unique_ptr<gis::Geometry> parsed[2];
+  const gis::Geometry *g[2];
   std::unique_ptr<dd::cache::Dictionary_client::Auto_releaser> releaser(
-      new dd::cache::Dictionary_client::Auto_releaser(
-          current_thd->dd_client()));
-  if (gis::parse_geometry(current_thd, func_name(), res1, &srs1, &g1) ||
-      gis::parse_geometry(current_thd, func_name(), res2, &srs2, &g2)) {
-    return error_int();
+      new dd::cache::Dictionary_client::Auto_releaser(thd->dd_client()));
+  for (int i = 0; i < 2; ++i) {
+    if (m_const_geometry[i] != nullptr) {
+      // Only the SRS is looked up again, the dictionary releases it after
+      // every row.
+      if (m_const_srid[i] != 0 &&
+          Srs_fetcher(thd).acquire(m_const_srid[i], &srs[i]))
+        return error_int();
+      g[i] = m_const_geometry[i].get();
+      continue;
+    }
+    if (gis::parse_geometry(thd, func_name(), res[i], &srs[i], &parsed[i]))
+      return error_int();
+    g[i] = parsed[i].get();
+    if (args[i]->const_for_execution()) {
+      m_const_srid[i] = srs[i] == nullptr ? 0 : srs[i]->id();
+      m_const_geometry[i] = std::move(parsed[i]);
+      // Prepare the polygon only if the relation can use it.
+      bool result;
+      if (m_prepared == nullptr &&
+          !point_relation(i, gis::Point_location::kExterior, &result)) {
+        m_prepared = gis::Prepared_polygon::create(*m_const_geometry[i]);
+        if (m_prepared != nullptr) m_prepared_arg = i;
+      }
+    }
   }
 
-  gis::srid_t srid1 = srs1 == nullptr ? 0 : srs1->id();
-  gis::srid_t srid2 = srs2 == nullptr ? 0 : srs2->id();
+  gis::srid_t srid1 = srs[0] == nullptr ? 0 : srs[0]->id();
+  gis::srid_t srid2 = srs[1] == nullptr ? 0 : srs[1]->id();
   if (srid1 != srid2) {
     my_error(ER_GIS_DIFFERENT_SRIDS, MYF(0), func_name(), srid1, srid2);
     return error_int();
   }
 
   bool result;
-  bool error = eval(srs1, g1.get(), g2.get(), &result, &null_value);
+  /*
+    A point against the prepared polygon is located with its R-tree of
+    edges. Points close to the boundary are left to eval().
+  */
+  if (m_prepared != nullptr) {
+    const gis::Geometry *other = g[1 - m_prepared_arg];
+    if (other->type() == gis::Geometry_type::kPoint && !other->is_empty()) {
+      gis::Point_location location = m_prepared->locate(
+          *down_cast<const gis::Cartesian_point *>(other));
+      if (location != gis::Point_location::kUnknown &&
+          !point_relation(m_prepared_arg, location, &result)) {
+        null_value = false;
+        return result;
+      }
+    }
+  }
+
+  bool error = eval(srs[0], g[0], g[1], &result, &null_value);
 
   if (error) return error_int();
 
@@ -124,6 +169,14 @@ bool Item_func_st_contains::eval(const dd::Spatial_reference_system *srs,
   return gis::within(srs, g2, g1, func_name(), result, null);
 }
 
+bool Item_func_st_contains::point_relation(int polygon_arg,
+                                           gis::Point_location location,
+                                           bool *result) const {
+  if (polygon_arg != 0) return true;
+  *result = location == gis::Point_location::kInterior;
+  return false;
+}
+
 bool Item_func_st_crosses::eval(const dd::Spatial_reference_system *srs,
                                 const gis::Geometry *g1,
                                 const gis::Geometry *g2, bool *result,
@@ -138,6 +191,12 @@ bool Item_func_st_disjoint::eval(const dd::Spatial_reference_system *srs,
   return gis::disjoint(srs, g1, g2, func_name(), result, null);
 }
 
+bool Item_func_st_disjoint::point_relation(int, gis::Point_location location,
+                                           bool *result) const {
+  *result = location == gis::Point_location::kExterior;
+  return false;
+}
+
 bool Item_func_st_equals::eval(const dd::Spatial_reference_system *srs,
                                const gis::Geometry *g1, const gis::Geometry *g2,
                                bool *result, bool *null) {
@@ -151,6 +210,12 @@ bool Item_func_st_intersects::eval(const dd::Spatial_reference_system *srs,
   return gis::intersects(srs, g1, g2, func_name(), result, null);
 }
 
+bool Item_func_st_intersects::point_relation(int, gis::Point_location location,
+                                             bool *result) const {
+  *result = location != gis::Point_location::kExterior;
+  return false;
+}
+
 bool Item_func_mbrcontains::eval(const dd::Spatial_reference_system *srs,
                                  const gis::Geometry *g1,
                                  const gis::Geometry *g2, bool *result,
@@ -230,3 +295,11 @@ bool Item_func_st_within::eval(const dd::Spatial_reference_system *srs,
                                bool *result, bool *null) {
   return gis::within(srs, g1, g2, func_name(), result, null);
 }
+
+bool Item_func_st_within::point_relation(int polygon_arg,
+                                         gis::Point_location location,
+                                         bool *result) const {
+  if (polygon_arg != 1) return true;
+  *result = location == gis::Point_location::kInterior;
+  return false;
+}
@@ -16,12 +16,19 @@
 
 #include "sql/item_semantic_func.h"
 #include <stdexcept>
+#include <utility>
 // #ifdef WITH_SEMANTICDB
 // #endif
 #include "sql-common/json_dom.h"
+#include "sql/fb_vector_base.h"
+#include "sql/fb_vector_distance.h"
+#include "sql/item_fb_vector_func.h"
 #include "sql/item_json_func.h"
+#include "sql/sql_class.h"
 #include "sql/sql_exception_handler.h"
+#include "sql/sql_lex.h"
 #include "sql/semantic_base.h"
+#include "sql/semantic_stats.h"
 
 namespace {
 #define SEMANTICDB_DISABLED_ERR                                            \
@@ -61,10 +68,13 @@ bool parse_string_from_item(Item **args, uint arg_idx, String &str,
   return true;
 }
 
-Item_func_semantic_filter::Item_func_semantic_filter(THD * /* thd */,
+Item_func_semantic_filter::Item_func_semantic_filter(THD *thd,
                                                            const POS &pos,
                                                            PT_item_list *a)
-    : Item_int_func(pos, a) {}
+    : Item_int_func(pos, a) {
+  // the model may answer differently next time
+  thd->lex->safe_to_cache_query = false;
+}
 
 bool Item_func_semantic_filter::resolve_type(THD *thd) {
   if (args[1]->data_type() != MYSQL_TYPE_BLOB) {
@@ -123,43 +133,196 @@ bool Item_func_semantic_filter::resolve_type(THD *thd) {
 //   return 0.0;
 // }
 
-longlong Item_func_semantic_filter::val_int() {
+bool Item_func_semantic_filter::read_arguments(
+    std::string *prompt, std::map<std::string, std::string> *value_dict) {
   if (args[0]->null_value || args[1]->null_value) {
-    return error_real();
+    return true;
   }
-
-  try {
-    std::string prompt;
-    std::string value1;
-    std::string field_name1;
-    if (parse_string_from_item(args, 0, m_value, func_name(), prompt, nullptr) ||
-        parse_string_from_item(args, 1, m_value, func_name(), value1, &field_name1)) {
-      return error_bool();
+  std::string value1;
+  std::string field_name1;
+  if (parse_string_from_item(args, 0, m_value, func_name(), *prompt, nullptr) ||
+      parse_string_from_item(args, 1, m_value, func_name(), value1, &field_name1)) {
+    return true;
+  }
+  if (m_stats_prompt.empty() && args[0]->const_for_execution()) {
+    m_stats_prompt = *prompt;
+  }
+  if (!field_name1.empty()) {
+    (*value_dict)[field_name1] = value1;
+  }
+  else {
+    (*value_dict)["value1"] = value1;
+  }
+  if (value_count() == 2) {
+    if (args[2]->null_value) {
+      return true;
     }
-    std::map<std::string, std::string> value_dict;
-    if (!field_name1.empty()) {
-      value_dict[field_name1] = value1;
+    std::string value2;
+    std::string field_name2;
+    if (parse_string_from_item(args, 2, m_value, func_name(), value2, &field_name2)) {
+      return true;
+    }
+    if (!field_name2.empty()) {
+      (*value_dict)[field_name2] = value2;
     }
     else {
-      value_dict["value1"] = value1;
+      (*value_dict)["value2"] = value2;
     }
-    if (arg_count == 3) {
-      if (args[2]->null_value) {
-        return error_real();
-      }
-      std::string value2;
-      std::string field_name2;
-      if (parse_string_from_item(args, 2, m_value, func_name(), value2, &field_name2)) {
-        return error_bool();
-      }
-      if (!field_name2.empty()) {
-        value_dict[field_name2] = value2;
-      }
-      else {
-        value_dict["value2"] = value2;
+  }
+  return false;
+}
+
+static std::string semantic_context(const std::map<std::string, std::string> &value_dict,
+                                    const std::string &prompt) {
+  std::string context="";
+  context += (prompt + "\n");
+  for (const auto& pair : value_dict) {
+    context += (pair.first + ": " + pair.second + "\n");
+  }
+  return context;
+}
+
+bool Item_func_semantic_filter::get_context(std::string *context) {
+  std::string prompt;
+  std::map<std::string, std::string> value_dict;
+  if (read_arguments(&prompt, &value_dict)) {
+    return true;
+  }
+  *context = semantic_context(value_dict, prompt);
+  return false;
+}
+
+void Item_func_semantic_filter::cleanup() {
+  if (!m_stats_prompt.empty()) {
+    semantic_stats_record_outcomes(m_stats_prompt, m_evaluated, m_passed);
+  }
+  // the prompt may be a parameter that changes between executions
+  m_stats_prompt.clear();
+  m_evaluated = m_passed = 0;
+  m_prompt_embedding.clear();
+  m_prompt_embedded = false;
+  Item_int_func::cleanup();
+}
+
+float Item_func_semantic_filter::get_filtering_effect(
+    THD *, table_map filter_for_table, table_map read_tables,
+    const MY_BITMAP *, double) {
+  // only counted for the last of the tables it reads
+  const table_map tables = used_tables() & ~PSEUDO_TABLE_BITS;
+  if (!(tables & filter_for_table) ||
+      (tables & ~(read_tables | filter_for_table)) != 0) {
+    return COND_FILTER_ALLPASS;
+  }
+  if (!args[0]->const_item()) return SEMANTIC_DEFAULT_PASS_RATE;
+  String *prompt = args[0]->val_str(&m_value);
+  if (prompt == nullptr || args[0]->null_value) return COND_FILTER_ALLPASS;
+  return semantic_stats_pass_rate(std::string(prompt->ptr(), prompt->length()));
+}
+
+bool Item_func_semantic_filter::cascade_enabled() const {
+  return current_thd->variables.semantic_filter_cascade &&
+         args[0]->const_for_execution();
+}
+
+bool Item_func_semantic_filter::get_cascade_input(
+    std::string *text, std::vector<float> *embedding) {
+  if (arg_count > value_count() + 1) {
+    Item *column = args[value_count() + 1];
+    Fb_vector vector;
+    // a NULL embedding falls back to embedding the value
+    if (!column->is_null() &&
+        !parse_fb_vector_from_item(args, value_count() + 1, m_value,
+                                   func_name(), vector)) {
+      const float *data = vector.get_data_view();
+      embedding->assign(data, data + vector.get_dimension());
+      return false;
+    }
+    if (current_thd->is_error()) return true;
+  }
+
+  std::string prompt;
+  std::map<std::string, std::string> value_dict;
+  if (read_arguments(&prompt, &value_dict)) {
+    return true;
+  }
+  text->clear();
+  for (const auto &pair : value_dict) {
+    if (!text->empty()) *text += "\n";
+    *text += pair.second;
+  }
+  return false;
+}
+
+int Item_func_semantic_filter::cascade_decision(
+    const std::vector<float> &embedding) {
+  if (embedding.empty()) return -1;
+#ifdef WITH_SEMANTICDB
+  if (!m_prompt_embedded) {
+    // embedded once per statement; a failure leaves every row to the model
+    m_prompt_embedded = true;
+    String *prompt = args[0]->val_str(&m_value);
+    if (prompt != nullptr && !args[0]->null_value &&
+        semantic_embed_openai(std::string(prompt->ptr(), prompt->length()),
+                              &m_prompt_embedding)) {
+      m_prompt_embedding.clear();
+    }
+  }
+#endif
+  if (m_prompt_embedding.size() != embedding.size()) return -1;
+
+  const double similarity = fb_vector_cosine(
+      m_prompt_embedding.data(), embedding.data(), embedding.size());
+  const System_variables &variables = current_thd->variables;
+  if (similarity < variables.semantic_filter_cascade_low) return 0;
+  if (similarity > variables.semantic_filter_cascade_high) return 1;
+  return -1;
+}
+
+int Item_func_semantic_filter::cascade_row() {
+  std::string text;
+  std::vector<float> embedding;
+  if (get_cascade_input(&text, &embedding)) return -1;
+#ifdef WITH_SEMANTICDB
+  if (embedding.empty() && semantic_embed_openai(text, &embedding)) {
+    embedding.clear();
+  }
+#endif
+  return cascade_decision(embedding);
+}
+
+longlong Item_func_semantic_filter::val_int() {
+  const longlong result = evaluate();
+  if (!null_value && !current_thd->is_error()) {
+    m_evaluated++;
+    if (result) m_passed++;
+  }
+  return result;
+}
+
+longlong Item_func_semantic_filter::evaluate() {
+  null_value = false;
+  if (m_prefetched_result != -1) {
+    const int result = m_prefetched_result;
+    m_prefetched_result = -1;
+    null_value = false;
+    return result;
+  }
+
+  try {
+    if (cascade_enabled()) {
+      const int result = cascade_row();
+      if (current_thd->is_error()) return error_bool();
+      if (result != -1) {
+        null_value = false;
+        return result;
       }
     }
 
+    std::string prompt;
+    std::map<std::string, std::string> value_dict;
+    if (read_arguments(&prompt, &value_dict)) {
+      return error_bool();
+    }
     return compute_result(value_dict, prompt);
   } catch (...) {
     handle_std_exception(func_name());
@@ -179,6 +342,14 @@ enum Item_func::Functype Item_func_semantic_filter_single_col::functype() const
   return SEMANTIC_FILTER_SINGLE_COL;
 }
 
+bool Item_func_semantic_filter_single_col::resolve_type(THD *thd) {
+  if (Item_func_semantic_filter::resolve_type(thd)) return true;
+  if (arg_count == 3 && param_type_is_default(thd, 2, 3, MYSQL_TYPE_JSON)) {
+    return true;
+  }
+  return false;
+}
+
 Item_func_semantic_filter_two_col::Item_func_semantic_filter_two_col(THD *thd, const POS &pos,
                                                PT_item_list *a)
     : Item_func_semantic_filter(thd, pos, a) {}
@@ -189,10 +360,36 @@ enum Item_func::Functype Item_func_semantic_filter_two_col::functype() const {
   return SEMANTIC_FILTER_TWO_COL;
 }
 
-Item_func_semantic_map::Item_func_semantic_map(THD * /* thd */,
+Item_func_semantic_join::Item_func_semantic_join(THD *thd, const POS &pos,
+                                                 PT_item_list *a)
+    : Item_func_semantic_filter_two_col(thd, pos, a) {}
+
+const char *Item_func_semantic_join::func_name() const { return "semantic_join"; }
+
+enum Item_func::Functype Item_func_semantic_join::functype() const {
+  return SEMANTIC_JOIN;
+}
+
+bool Item_func_semantic_join::resolve_type(THD *thd) {
+  // the embeddings come in pairs
+  if (arg_count == 4) {
+    my_error(ER_WRONG_PARAMCOUNT_TO_NATIVE_FCT, MYF(0), func_name());
+    return true;
+  }
+  if (Item_func_semantic_filter::resolve_type(thd)) return true;
+  if (arg_count == 5 && param_type_is_default(thd, 3, 5, MYSQL_TYPE_JSON)) {
+    return true;
+  }
+  return false;
+}
+
+Item_func_semantic_map::Item_func_semantic_map(THD *thd,
                                                            const POS &pos,
                                                            PT_item_list *a)
-    : Item_str_func(pos, a) {}
+    : Item_str_func(pos, a) {
+  // the model may answer differently next time
+  thd->lex->safe_to_cache_query = false;
+}
 
 bool Item_func_semantic_map::resolve_type(THD *thd) {
   if (args[1]->data_type() != MYSQL_TYPE_BLOB) {
@@ -205,44 +402,58 @@ bool Item_func_semantic_map::resolve_type(THD *thd) {
   return false;
 }
 
+bool Item_func_semantic_map::get_context(std::string *context) {
+  std::string prompt;
+  std::string value1;
+  std::string field_name1;
+  if (parse_string_from_item(args, 0, m_value, func_name(), prompt, nullptr) ||
+      parse_string_from_item(args, 1, m_value, func_name(), value1, &field_name1)) {
+    return true;
+  }
+  std::map<std::string, std::string> value_dict;
+  if (!field_name1.empty()) {
+    value_dict[field_name1] = value1;
+  }
+  else {
+    value_dict["value1"] = value1;
+  }
+  if (arg_count == 3) {
+    if (args[2]->null_value) {
+      return true;
+    }
+    std::string value2;
+    std::string field_name2;
+    if (parse_string_from_item(args, 2, m_value, func_name(), value2, &field_name2)) {
+      return true;
+    }
+    if (!field_name2.empty()) {
+      value_dict[field_name2] = value2;
+    }
+    else {
+      value_dict["value2"] = value2;
+    }
+  }
+  *context = semantic_context(value_dict, prompt);
+  return false;
+}
+
 String *Item_func_semantic_map::val_str(String *str) {
   if (args[0]->null_value || args[1]->null_value) {
     return error_str();
   }
 
   try {
-    std::string prompt;
-    std::string value1;
-    std::string field_name1;
-    if (parse_string_from_item(args, 0, m_value, func_name(), prompt, nullptr) ||
-        parse_string_from_item(args, 1, m_value, func_name(), value1, &field_name1)) {
-      return error_str();
-    }
-    std::map<std::string, std::string> value_dict;
-    if (!field_name1.empty()) {
-      value_dict[field_name1] = value1;
-    }
-    else {
-      value_dict["value1"] = value1;
-    }
-    if (arg_count == 3) {
-      if (args[2]->null_value) {
-        return error_str();
-      }
-      std::string value2;
-      std::string field_name2;
-      if (parse_string_from_item(args, 2, m_value, func_name(), value2, &field_name2)) {
+    std::string result;
+    if (m_has_prefetched_result) {
+      result = std::move(m_prefetched_result);
+      clear_prefetched_result();
+    } else {
+      std::string context;
+      if (get_context(&context)) {
         return error_str();
       }
-      if (!field_name2.empty()) {
-        value_dict[field_name2] = value2;
-      }
-      else {
-        value_dict["value2"] = value2;
-      }
+      result = dedup_result(context);
     }
-
-    std::string result = compute_result(value_dict, prompt);
     if (!str) return error_str();  
     const CHARSET_INFO* cs = &my_charset_utf8mb4_bin;
     str->set_charset(cs);
@@ -255,6 +466,34 @@ String *Item_func_semantic_map::val_str(String *str) {
 
 }
 
+std::string Item_func_semantic_map::dedup_result(const std::string &context) {
+  std::vector<float> embedding;
+#ifdef WITH_SEMANTICDB
+  const double threshold = current_thd->variables.semantic_dedup_threshold;
+  // contexts only are near duplicates when they share the prompt
+  if (threshold > 0 && args[0]->const_for_execution() &&
+      !semantic_embed_openai(context, &embedding)) {
+    const size_t group =
+        semantic_dedup_find(m_dedup_embeddings, embedding, threshold);
+    if (group < m_dedup_embeddings.size()) return m_dedup_answers[group];
+  }
+#endif
+  std::string result = compute_result(context);
+  if (!embedding.empty() && !result.empty() && !current_thd->is_error() &&
+      m_dedup_embeddings.size() < SEMANTIC_DEDUP_MAX_REPRESENTATIVES) {
+    m_dedup_embeddings.push_back(std::move(embedding));
+    m_dedup_answers.push_back(result);
+  }
+  return result;
+}
+
+void Item_func_semantic_map::cleanup() {
+  m_dedup_embeddings.clear();
+  m_dedup_answers.clear();
+  clear_prefetched_result();
+  Item_str_func::cleanup();
+}
+
 const char *Item_func_semantic_map::func_name() const { return "semantic_map"; }
 
 enum Item_func::Functype Item_func_semantic_map::functype() const {
@@ -275,11 +514,7 @@ enum Item_func::Functype Item_func_semantic_extract::functype() const {
 
 #ifdef WITH_SEMANTICDB
 bool Item_func_semantic_filter_single_col::compute_result(std::map<std::string, std::string> &value_dict, std::string &prompt) {
-  std::string context="";
-  context += (prompt + "\n");
-  for (const auto& pair : value_dict) {
-    context += (pair.first + ": " + pair.second + "\n");
-  }
+  std::string context = semantic_context(value_dict, prompt);
   bool result;
   if (semantic_filter_openai(context, &result)) {
     return error_real();
@@ -288,11 +523,7 @@ bool Item_func_semantic_filter_single_col::compute_result(std::map<std::string,
 }
 
 bool Item_func_semantic_filter_two_col::compute_result(std::map<std::string, std::string> &value_dict, std::string &prompt) {
-  std::string context="";
-  context += (prompt + "\n");
-  for (const auto& pair : value_dict) {
-    context += (pair.first + ": " + pair.second + "\n");
-  }
+  std::string context = semantic_context(value_dict, prompt);
   bool result;
   if (semantic_filter_openai(context, &result)) {
     return error_real();
@@ -300,12 +531,7 @@ bool Item_func_semantic_filter_two_col::compute_result(std::map<std::string, std
   return result;
 }
 
-std::string Item_func_semantic_map::compute_result(std::map<std::string, std::string> &value_dict, std::string &prompt) {
-  std::string context="";
-  context += (prompt + "\n");
-  for (const auto& pair : value_dict) {
-    context += (pair.first + ": " + pair.second + "\n");
-  }
+std::string Item_func_semantic_map::compute_result(const std::string &context) {
   std::string result;
   if (semantic_map_openai(context, &result)) {
     return "";
@@ -313,12 +539,7 @@ std::string Item_func_semantic_map::compute_result(std::map<std::string, std::st
   return result;
 }
 
-std::string Item_func_semantic_extract::compute_result(std::map<std::string, std::string> &value_dict, std::string &prompt) {
-  std::string context="";
-  context += (prompt + "\n");
-  for (const auto& pair : value_dict) {
-    context += (pair.first + ": " + pair.second + "\n");
-  }
+std::string Item_func_semantic_extract::compute_result(const std::string &context) {
   std::string result;
   if (semantic_extract_openai(context, &result)) {
     return "";
@@ -340,13 +561,11 @@ bool Item_func_semantic_filter_two_col::compute_result(std::map<std::string, std
   SEMANTICDB_DISABLED_ERR;
 }
 
-std::string Item_func_semantic_map::compute_result(std::map<std::string, std::string> &value_dict [[maybe_unused]],
-                                               std::string &prompt [[maybe_unused]]) {
+std::string Item_func_semantic_map::compute_result(const std::string &context [[maybe_unused]]) {
   SEMANTICDB_DISABLED_ERR;
 }
 
-std::string Item_func_semantic_extract::compute_result(std::map<std::string, std::string> &value_dict [[maybe_unused]],
-                                               std::string &prompt [[maybe_unused]]) {
+std::string Item_func_semantic_extract::compute_result(const std::string &context [[maybe_unused]]) {
   SEMANTICDB_DISABLED_ERR;
 }
 #endif
\ No newline at end of file
@@ -16,6 +16,10 @@
 
 #pragma once
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "sql/item_func.h"
 #include "sql/item_strfunc.h"
 #include "sql/system_variables.h"
@@ -33,15 +37,89 @@ class Item_func_semantic_filter : public Item_int_func {
 
   longlong val_int() override;
 
+  void cleanup() override;
+
+  /// Each row costs a call to the model, so evaluate it as late as possible.
+  bool is_expensive() override { return true; }
+  bool is_expensive_processor(uchar *) override { return true; }
+
+  /// The pass rate observed for the prompt so far, see semantic_stats.h.
+  float get_filtering_effect(THD *thd, table_map filter_for_table,
+                             table_map read_tables,
+                             const MY_BITMAP *fields_to_ignore,
+                             double rows_in_table) override;
+
+  /**
+    Build the context sent to the model for the current row.
+    @return true if the arguments are NULL or cannot be read
+  */
+  bool get_context(std::string *context);
+
+  /**
+    Hand in the answer for the current row, fetched ahead of time by
+    SemanticFilterIterator. The next val_int() returns it instead of calling
+    the model; -1 means no answer, so the model is called as usual.
+  */
+  void set_prefetched_result(int result) { m_prefetched_result = result; }
+
+  /**
+    Whether the current row is first scored by embedding similarity, see
+    semantic_filter_cascade. Needs a prompt that is the same on every row.
+  */
+  virtual bool cascade_enabled() const;
+
+  /**
+    Read what the cascade scores the current row by: the embedding column
+    given as third argument of SEMANTIC_FILTER_SINGLE_COL() if it is not
+    NULL, else the text to embed.
+    @return true if the arguments are NULL or cannot be read
+  */
+  bool get_cascade_input(std::string *text, std::vector<float> *embedding);
+
+  /**
+    Decide the current row from the embedding of its values.
+    @return 1 or 0 if the similarity to the prompt is outside the uncertain
+    band, -1 if the model has to decide
+  */
+  int cascade_decision(const std::vector<float> &embedding);
+
  protected:
   /// String used when reading JSON binary values or JSON text values.
   String m_value;
 
+  /// See set_prefetched_result().
+  int m_prefetched_result = -1;
+
+  /// Embedding of the prompt, computed by the first cascade_decision().
+  std::vector<float> m_prompt_embedding;
+  bool m_prompt_embedded = false;
+
+  /// The constant prompt, and the rows it was answered on and passed this
+  /// execution, handed to semantic_stats_record_outcomes() by cleanup().
+  std::string m_stats_prompt;
+  ulonglong m_evaluated = 0;
+  ulonglong m_passed = 0;
+
+  /// Number of arguments after the prompt holding the values to judge.
+  virtual uint value_count() const = 0;
+
+  /// Read the prompt and the column values of the current row.
+  bool read_arguments(std::string *prompt,
+                      std::map<std::string, std::string> *value_dict);
+
+  /// Decide the current row with the cascade, without reading rows ahead.
+  int cascade_row();
+
+  /// The answer for the current row, without counting it.
+  longlong evaluate();
+
   virtual bool compute_result(std::map<std::string, std::string> &value_dict, std::string &prompt) = 0;
 };
 
 /**
-  Represents the function SEMANTIC_FILTER_SINGLE_COL()
+  Represents the function SEMANTIC_FILTER_SINGLE_COL(). An optional third
+  argument holds the embedding of the value, e.g. a vector column, which
+  semantic_filter_cascade then uses instead of embedding the value.
 */
 class Item_func_semantic_filter_single_col final : public Item_func_semantic_filter {
  public:
@@ -50,14 +128,18 @@ class Item_func_semantic_filter_single_col final : public Item_func_semantic_fil
   const char *func_name() const override;
   enum Functype functype() const override;
 
+  bool resolve_type(THD *thd) override;
+
  protected:
+  uint value_count() const override { return 1; }
+
   bool compute_result(std::map<std::string, std::string> &value_dict, std::string &prompt) override;
 };
 
 /**
   Represents the function SEMANTIC_FILTER_TWO_COL()
 */
-class Item_func_semantic_filter_two_col final : public Item_func_semantic_filter {
+class Item_func_semantic_filter_two_col : public Item_func_semantic_filter {
  public:
   Item_func_semantic_filter_two_col(THD *thd, const POS &pos, PT_item_list *a);
 
@@ -65,9 +147,37 @@ class Item_func_semantic_filter_two_col final : public Item_func_semantic_filter
   enum Functype functype() const override;
 
  protected:
+  uint value_count() const override { return 2; }
+
   bool compute_result(std::map<std::string, std::string> &value_dict, std::string &prompt) override;
 };
 
+/**
+  Represents the function SEMANTIC_JOIN(prompt, text1, text2 [, vector1,
+  vector2]), a SEMANTIC_FILTER_TWO_COL() meant for join conditions. The
+  optional embeddings of the two texts let the optimizer block the join: a
+  semantic join only asks the model about the pairs where vector2 is among
+  the semantic_join_neighbors nearest neighbours of vector1 in a vector
+  index, see SemanticJoinIterator.
+*/
+class Item_func_semantic_join final : public Item_func_semantic_filter_two_col {
+ public:
+  Item_func_semantic_join(THD *thd, const POS &pos, PT_item_list *a);
+
+  const char *func_name() const override;
+  enum Functype functype() const override;
+
+  bool resolve_type(THD *thd) override;
+
+  /// The embeddings are of the texts, not of an answer to the prompt.
+  bool cascade_enabled() const override { return false; }
+
+  /// The embedding of text1 or text2, nullptr if not given.
+  Item *embedding(uint side) const {
+    return arg_count == 5 ? args[3 + side] : nullptr;
+  }
+};
+
 /**
   class of semantic map functions
 */
@@ -84,11 +194,50 @@ class Item_func_semantic_map : public Item_str_func {
   const char *func_name() const override;
   enum Functype functype() const override;
 
+  void cleanup() override;
+
+  bool is_expensive() override { return true; }
+  bool is_expensive_processor(uchar *) override { return true; }
+
+  /**
+    Build the context sent to the model for the current row.
+    @return true if the arguments are NULL or cannot be read
+  */
+  bool get_context(std::string *context);
+
+  /**
+    Hand in the answer for the current row, fetched ahead of time together
+    with those of other rows. The next val_str() returns it instead of
+    calling the model.
+  */
+  void set_prefetched_result(std::string result) {
+    m_prefetched_result = std::move(result);
+    m_has_prefetched_result = true;
+  }
+
+  /// Drop an answer handed in but not consumed.
+  void clear_prefetched_result() {
+    m_prefetched_result.clear();
+    m_has_prefetched_result = false;
+  }
+
  protected:
   /// String used when reading JSON binary values or JSON text values.
   String m_value;
 
-  virtual std::string compute_result(std::map<std::string, std::string> &value_dict, std::string &prompt);
+  /// See set_prefetched_result().
+  std::string m_prefetched_result;
+  bool m_has_prefetched_result = false;
+
+  /// Embeddings of the contexts answered by the model this execution, and
+  /// their answers, see semantic_dedup_threshold.
+  std::vector<std::vector<float>> m_dedup_embeddings;
+  std::vector<std::string> m_dedup_answers;
+
+  /// The answer to the context, or to an earlier near duplicate of it.
+  std::string dedup_result(const std::string &context);
+
+  virtual std::string compute_result(const std::string &context);
 };
 
 /**
@@ -102,7 +251,7 @@ class Item_func_semantic_extract final : public Item_func_semantic_map {
   enum Functype functype() const override;
 
  protected:
-  std::string compute_result(std::map<std::string, std::string> &value_dict, std::string &prompt) override;
+  std::string compute_result(const std::string &context) override;
 };
 
 bool parse_string_from_item(Item **args, uint arg_idx, String &str,
@@ -2770,6 +2770,9 @@ void Item_sum_hybrid::clear() {
   null_value = true;
   m_cnt = 0;
   m_saved_last_value_at = 0;
+  m_sliding_values.clear();
+  m_sliding_added = 0;
+  m_sliding_removed = 0;
 }
 
 void Item_sum_hybrid::update_after_wf_arguments_changed(THD *) {
@@ -2805,8 +2808,14 @@ bool Item_sum_hybrid::check_wf_semantics1(THD *thd, Query_block *select,
     }
   }
   if (!m_optimize) {
-    r->row_optimizable = false;
-    r->range_optimizable = false;
+    if (r->needs_buffer &&
+        (hybrid_type == INT_RESULT || hybrid_type == REAL_RESULT)) {
+      // inversion is cheap with a monotonic deque, see add_sliding()
+      m_sliding = true;
+    } else {
+      r->row_optimizable = false;
+      r->range_optimizable = false;
+    }
   }
   return result;
 }
@@ -3106,7 +3115,62 @@ static bool min_max_best_so_far(int comparison_result, bool is_min) {
   return is_min ? comparison_result < 0 : comparison_result > 0;
 }
 
+bool Item_sum_hybrid::add_sliding() {
+  if (m_window->do_inverse()) {
+    if (!m_sliding_values.empty() &&
+        m_sliding_values.front().rowno == m_sliding_removed)
+      m_sliding_values.pop_front();
+    m_sliding_removed++;
+  } else {
+    arg_cache->cache_value();
+    if (current_thd->is_error()) return true;
+    const int64 rowno = m_sliding_added++;
+    if (!arg_cache->null_value) {
+      Sliding_value entry{rowno, 0, 0.0};
+      if (hybrid_type == INT_RESULT)
+        entry.int_value = arg_cache->val_int();
+      else
+        entry.real_value = arg_cache->val_real();
+      // Drop the values this one beats or equals, it leaves the frame later.
+      const bool is_unsigned = arg_cache->unsigned_flag;
+      while (!m_sliding_values.empty()) {
+        const Sliding_value &last = m_sliding_values.back();
+        int cmp_result;
+        if (hybrid_type == REAL_RESULT) {
+          cmp_result = (entry.real_value > last.real_value) -
+                       (entry.real_value < last.real_value);
+        } else if (is_unsigned) {
+          const ulonglong a = entry.int_value, b = last.int_value;
+          cmp_result = (a > b) - (a < b);
+        } else {
+          cmp_result = (entry.int_value > last.int_value) -
+                       (entry.int_value < last.int_value);
+        }
+        if (cmp_result != 0 && !min_max_best_so_far(cmp_result, m_is_min))
+          break;
+        m_sliding_values.pop_back();
+      }
+      m_sliding_values.push_back(entry);
+    }
+  }
+
+  null_value = m_sliding_values.empty();
+  if (!null_value) {
+    const Sliding_value &best = m_sliding_values.front();
+    if (hybrid_type == INT_RESULT)
+      down_cast<Item_cache_int *>(value)->store_value(arg_cache,
+                                                      best.int_value);
+    else
+      down_cast<Item_cache_real *>(value)->store_value(arg_cache,
+                                                       best.real_value);
+    // the NULLness of the current row is not that of the min/max
+    value->null_value = false;
+  }
+  return false;
+}
+
 bool Item_sum_hybrid::add() {
+  if (m_sliding) return add_sliding();
   arg_cache->cache_value();
   if (current_thd->is_error()) {
     return true;
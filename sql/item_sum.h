@@ -31,6 +31,7 @@
 #include <climits>
 #include <cmath>
 #include <cstdio>
+#include <deque>
 #include <map>
 #include <memory>
 #include <optional>
@@ -1575,6 +1576,32 @@ class Item_sum_hybrid : public Item_sum {
   */
   int64 m_saved_last_value_at;
 
+  /**
+    Set to true when the min/max of an INT or REAL argument over a frame that
+    is not ordered by it is maintained as rows enter and leave the frame, so
+    the frame need not be read again for each row.
+  */
+  bool m_sliding{false};
+
+  /// A non-NULL value of the frame, with its position among the rows added.
+  struct Sliding_value {
+    int64 rowno;
+    longlong int_value;
+    double real_value;
+  };
+
+  /**
+    Execution state when m_sliding: the values of the frame that no later
+    value beats, the min/max first. Rows leave the frame in the order they
+    entered it, counted by m_sliding_added and m_sliding_removed.
+  */
+  std::deque<Sliding_value> m_sliding_values;
+  int64 m_sliding_added{0};
+  int64 m_sliding_removed{0};
+
+  /// Add the row to, or with inversion remove it from, m_sliding_values.
+  bool add_sliding();
+
   /**
     This function implements the optimized version of retrieving min/max
     value. When we have "ordered ASC" results in a window, min will always
@@ -42,6 +42,7 @@
 #include "sql/debug_sync.h"
 #include "sql/handler.h"
 #include "sql/iterators/row_iterator.h"
+#include "sql/mysqld.h"  // innodb_hton
 #include "sql/mem_root_array.h"
 #include "sql/sql_bitmap.h"
 #include "sql/sql_class.h"  // THD
@@ -378,6 +379,7 @@ bool FollowTailIterator::Init() {
 
     // The first seen record will start a new iteration.
     m_read_rows = 0;
+    m_cursor_rows = 0;
     m_recursive_iteration_count = 0;
     m_end_of_current_iteration = 0;
   } else {
@@ -446,13 +448,21 @@ int FollowTailIterator::Read() {
 #endif
   }
 
-  // Read the actual row.
-  //
-  // We can never have MyISAM here, so we don't need the checks
-  // for HA_ERR_RECORD_DELETED that TableScanIterator has.
-  int err = table()->file->ha_rnd_next(m_record);
-  if (err) {
-    return HandleError(err);
+  if (m_row_buffer != nullptr && m_read_rows < m_row_buffer->rows) {
+    // Copy the row kept in memory, bypassing the handler.
+    m_row_buffer->read(m_read_rows, m_record);
+  } else {
+    if (m_cursor_rows != m_read_rows && PositionCursor()) return 1;
+
+    // Read the actual row.
+    //
+    // We can never have MyISAM here, so we don't need the checks
+    // for HA_ERR_RECORD_DELETED that TableScanIterator has.
+    int err = table()->file->ha_rnd_next(m_record);
+    if (err) {
+      return HandleError(err);
+    }
+    ++m_cursor_rows;
   }
 
   ++m_read_rows;
@@ -463,7 +473,38 @@ int FollowTailIterator::Read() {
   return 0;
 }
 
+bool FollowTailIterator::PositionCursor() {
+  handler *const file = table()->file;
+  if (file->inited) file->ha_rnd_end();
+  if (m_read_rows > 0 && (table()->s->db_type() == innodb_hton ||
+                          table()->s->db_type() == rocksdb_hton)) {
+    if (reposition_innodb_cursor(table(), m_read_rows)) return true;
+  } else {
+    // Rows of in-memory tables are read in insertion order, skip those read.
+    int error = file->ha_rnd_init(true);
+    for (ha_rows row = 0; error == 0 && row < m_read_rows; row++)
+      error = file->ha_rnd_next(m_record);
+    if (error) {
+      PrintError(error);
+      return true;
+    }
+  }
+  m_cursor_rows = m_read_rows;
+  return false;
+}
+
 bool FollowTailIterator::RepositionCursorAfterSpillToDisk() {
+  if (m_row_buffer != nullptr && m_inited) {
+    // Keep the new handler initialized, see Init(); the cursor is moved
+    // past the rows read when rows are first read from the table.
+    const int error = table()->file->ha_rnd_init(true);
+    if (error) {
+      PrintError(error);
+      return true;
+    }
+    m_cursor_rows = 0;
+    return false;
+  }
   if (!m_inited) {
     // Spill-to-disk happened before we got to read a single row,
     // so the table has not been initialized yet. It will start
@@ -31,6 +31,8 @@
 
 #include <assert.h>
 #include <sys/types.h>
+#include <string.h>
+#include <vector>
 
 #include "mem_root_deque.h"
 #include "my_base.h"
@@ -436,6 +438,43 @@ class ZeroRowsAggregatedIterator final : public RowIterator {
   user-set limit, it raises an error to stop runaway queries with infinite
   recursion.
  */
+/**
+  The rows written to the table of a WITH RECURSIVE materialization, also
+  kept in memory as their record images so that FollowTailIterator can copy
+  them into the record instead of reading them through the handler, for
+  tables without BLOBs. Rows are only appended; once a row does not fit in
+  max_bytes no more rows are kept, and the rows after those kept are read
+  from the table.
+ */
+struct Recursive_row_buffer {
+  Recursive_row_buffer(size_t row_length_arg, size_t max_bytes_arg)
+      : row_length(row_length_arg), max_bytes(max_bytes_arg) {}
+
+  /// Keep the record image of the row just written to the table.
+  void append(const uchar *record) {
+    if (full) return;
+    if (data.size() + row_length > max_bytes) {
+      full = true;
+      return;
+    }
+    data.insert(data.end(), record, record + row_length);
+    rows++;
+  }
+
+  /// Copy the row kept at position row into record.
+  void read(ha_rows row, uchar *record) const {
+    assert(row < rows);
+    memcpy(record, data.data() + row * row_length, row_length);
+  }
+
+  const size_t row_length;
+  const size_t max_bytes;
+  /// Number of rows kept, the first ones of the table.
+  ha_rows rows{0};
+  bool full{false};
+  std::vector<uchar> data;
+};
+
 class FollowTailIterator final : public TableRowIterator {
  public:
   // "examined_rows", if not nullptr, is incremented for each successful Read().
@@ -457,6 +496,15 @@ class FollowTailIterator final : public TableRowIterator {
     m_stored_rows = stored_rows;
   }
 
+  /**
+    Signal where the rows of this materialization are also kept in memory,
+    nullptr if they are not. Like set_stored_rows_pointer(), this must be
+    called before Init() runs.
+   */
+  void set_row_buffer(const Recursive_row_buffer *row_buffer) {
+    m_row_buffer = row_buffer;
+  }
+
   /**
     Signal to the iterator that the underlying table was closed and replaced
     with an InnoDB table with the same data, due to a spill-to-disk
@@ -467,6 +515,9 @@ class FollowTailIterator final : public TableRowIterator {
   bool RepositionCursorAfterSpillToDisk();
 
  private:
+  /// Move the cursor of the table past the m_read_rows rows read so far.
+  bool PositionCursor();
+
   bool m_inited = false;
   uchar *const m_record;
   const double m_expected_rows;
@@ -477,6 +528,11 @@ class FollowTailIterator final : public TableRowIterator {
 
   // Points into MaterializeIterator's data; set by BeginMaterialization() only.
   ha_rows *m_stored_rows = nullptr;
+
+  // Likewise, the rows kept in memory, if any.
+  const Recursive_row_buffer *m_row_buffer = nullptr;
+  /// Rows the cursor of the table is past.
+  ha_rows m_cursor_rows{0};
 };
 
 /**
@@ -0,0 +1,449 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/iterators/compiled_condition.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "my_byteorder.h"
+#include "my_config.h"
+#include "sql/field.h"
+#include "sql/item.h"
+#include "sql/item_cmpfunc.h"
+#include "sql/item_func.h"
+#include "sql/mysqld.h"  // log_10
+#include "sql/sql_class.h"
+#include "sql/sql_list.h"
+#include "sql/table.h"
+#include "template_utils.h"
+
+bool CompiledCondition::Compile(Item *condition) {
+  m_program.clear();
+  m_operands.clear();
+  m_compiled_leaves = 0;
+  CompileItem(condition);
+  return m_compiled_leaves == 0;
+}
+
+void CompiledCondition::CompileItem(Item *item) {
+  if (item->type() == Item::COND_ITEM) {
+    Item_cond *cond = down_cast<Item_cond *>(item);
+    const Item_func::Functype functype = cond->functype();
+    if ((functype == Item_func::COND_AND_FUNC ||
+         functype == Item_func::COND_OR_FUNC) &&
+        !cond->argument_list()->is_empty()) {
+      const Opcode jump = functype == Item_func::COND_AND_FUNC
+                              ? OP_JUMP_IF_FALSE
+                              : OP_JUMP_IF_TRUE;
+      std::vector<size_t> jumps;
+      bool first = true;
+      for (Item &arg : *cond->argument_list()) {
+        if (!first) {
+          jumps.push_back(m_program.size());
+          m_program.push_back(Instruction{jump, CMP_EQ, 0, 0, {}, nullptr});
+        }
+        first = false;
+        CompileItem(&arg);
+      }
+      // Short-circuiting leaves the result of the whole AND or OR.
+      for (const size_t pc : jumps)
+        m_program[pc].jump = static_cast<uint>(m_program.size());
+      return;
+    }
+  } else if (item->type() == Item::FUNC_ITEM) {
+    switch (down_cast<Item_func *>(item)->functype()) {
+      case Item_func::EQ_FUNC:
+      case Item_func::NE_FUNC:
+      case Item_func::LT_FUNC:
+      case Item_func::LE_FUNC:
+      case Item_func::GT_FUNC:
+      case Item_func::GE_FUNC:
+        if (!CompileCompare(item)) return;
+        break;
+      case Item_func::BETWEEN:
+        if (!CompileBetween(item)) return;
+        break;
+      case Item_func::IN_FUNC:
+        if (!CompileIn(item)) return;
+        break;
+      case Item_func::ISNULL_FUNC:
+        if (!CompileNullTest(item, true)) return;
+        break;
+      case Item_func::ISNOTNULL_FUNC:
+        if (!CompileNullTest(item, false)) return;
+        break;
+      default:
+        break;
+    }
+  }
+  AddItem(item);
+}
+
+bool CompiledCondition::CompileCompare(Item *item) {
+  Item **args = down_cast<Item_func *>(item)->arguments();
+  const Item_result cmp_type =
+      item_cmp_type(args[0]->result_type(), args[1]->result_type());
+  if (cmp_type != INT_RESULT && cmp_type != REAL_RESULT) return true;
+  const Value_type type = cmp_type == INT_RESULT ? VALUE_INT : VALUE_REAL;
+
+  const uint operand = m_operands.size();
+  if (AddOperand(args[0], type) || AddOperand(args[1], type)) {
+    m_operands.resize(operand);
+    return true;
+  }
+
+  Compare compare = CMP_EQ;
+  switch (down_cast<Item_func *>(item)->functype()) {
+    case Item_func::NE_FUNC:
+      compare = CMP_NE;
+      break;
+    case Item_func::LT_FUNC:
+      compare = CMP_LT;
+      break;
+    case Item_func::LE_FUNC:
+      compare = CMP_LE;
+      break;
+    case Item_func::GT_FUNC:
+      compare = CMP_GT;
+      break;
+    case Item_func::GE_FUNC:
+      compare = CMP_GE;
+      break;
+    default:
+      break;
+  }
+  m_program.push_back(
+      Instruction{OP_COMPARE, compare, operand, 0, {}, nullptr});
+  // Arg_comparator compares reals of fixed decimals up to their precision.
+  if (type == VALUE_REAL && args[0]->decimals < DECIMAL_NOT_SPECIFIED &&
+      args[1]->decimals < DECIMAL_NOT_SPECIFIED)
+    m_program.back().precision =
+        5 / log_10[std::max(args[0]->decimals, args[1]->decimals) + 1];
+  ++m_compiled_leaves;
+  return false;
+}
+
+bool CompiledCondition::CompileBetween(Item *item) {
+  Item_func_between *between = down_cast<Item_func_between *>(item);
+  if (between->negated || between->compare_as_dates_with_strings ||
+      between->compare_as_temporal_dates || between->compare_as_temporal_times)
+    return true;
+  if (between->cmp_type != INT_RESULT && between->cmp_type != REAL_RESULT)
+    return true;
+  const Value_type type =
+      between->cmp_type == INT_RESULT ? VALUE_INT : VALUE_REAL;
+
+  // Unlike Arg_comparator, Item_func_between compares reals exactly.
+  Item **args = between->arguments();
+  const uint operand = m_operands.size();
+  if (AddOperand(args[0], type) || AddOperand(args[1], type) ||
+      AddOperand(args[2], type)) {
+    m_operands.resize(operand);
+    return true;
+  }
+  m_program.push_back(
+      Instruction{OP_BETWEEN, CMP_EQ, operand, 0, {}, nullptr});
+  ++m_compiled_leaves;
+  return false;
+}
+
+bool CompiledCondition::CompileIn(Item *item) {
+  Item_func_in *in = down_cast<Item_func_in *>(item);
+  if (in->negated) return true;
+  Item **args = in->arguments();
+  for (uint i = 0; i < in->argument_count(); ++i) {
+    if (args[i]->result_type() != INT_RESULT) return true;
+    if (i > 0 && (!args[i]->const_for_execution() ||
+                  args[i]->has_subquery() || args[i]->has_stored_program() ||
+                  args[i]->is_temporal()))
+      return true;
+  }
+
+  const uint operand = m_operands.size();
+  if (args[0]->type() != Item::FIELD_ITEM || AddOperand(args[0], VALUE_INT)) {
+    m_operands.resize(operand);
+    return true;
+  }
+  m_program.push_back(Instruction{OP_IN, CMP_EQ, operand, 0, {}, item});
+  ++m_compiled_leaves;
+  return false;
+}
+
+bool CompiledCondition::CompileNullTest(Item *item, bool is_null) {
+  Item *arg = down_cast<Item_func *>(item)->arguments()[0];
+  // Item_func_isnull answers for a column that cannot be NULL by itself.
+  if (is_null && !arg->is_nullable()) return true;
+  const uint operand = m_operands.size();
+  if (arg->type() != Item::FIELD_ITEM || AddOperand(arg, VALUE_REAL)) {
+    m_operands.resize(operand);
+    return true;
+  }
+  m_program.push_back(Instruction{is_null ? OP_IS_NULL : OP_IS_NOT_NULL,
+                                  CMP_EQ, operand, 0, {}, nullptr});
+  ++m_compiled_leaves;
+  return false;
+}
+
+bool CompiledCondition::AddOperand(Item *item, Value_type type) {
+  if (item->type() == Item::FIELD_ITEM && item->real_item() == item) {
+    Field *field = down_cast<Item_field *>(item)->field;
+    Source source;
+    switch (field->real_type()) {
+      case MYSQL_TYPE_TINY:
+        source = SOURCE_TINY;
+        break;
+      case MYSQL_TYPE_SHORT:
+        source = SOURCE_SHORT;
+        break;
+      case MYSQL_TYPE_INT24:
+        source = SOURCE_INT24;
+        break;
+      case MYSQL_TYPE_LONG:
+        source = SOURCE_LONG;
+        break;
+      case MYSQL_TYPE_LONGLONG:
+        source = SOURCE_LONGLONG;
+        break;
+      case MYSQL_TYPE_FLOAT:
+        source = SOURCE_FLOAT;
+        break;
+      case MYSQL_TYPE_DOUBLE:
+        source = SOURCE_DOUBLE;
+        break;
+      default:
+        return true;
+    }
+    if (type == VALUE_INT &&
+        (source == SOURCE_FLOAT || source == SOURCE_DOUBLE))
+      return true;
+#ifdef WORDS_BIGENDIAN
+    if (!field->table->s->db_low_byte_first) return true;
+#endif
+    m_operands.push_back(
+        Operand{source, type, field->is_unsigned(), field, item, {}});
+    return false;
+  }
+
+  // Constants are read once per execution, which must have no side effects.
+  if (!item->const_for_execution() || item->has_subquery() ||
+      item->has_stored_program() || item->is_temporal())
+    return true;
+  const Item_result result_type = item->result_type();
+  if (type == VALUE_INT ? result_type != INT_RESULT
+                        : result_type != INT_RESULT &&
+                              result_type != REAL_RESULT &&
+                              result_type != DECIMAL_RESULT)
+    return true;
+  m_operands.push_back(Operand{SOURCE_CONSTANT, type, item->unsigned_flag,
+                               nullptr, item, {}});
+  return false;
+}
+
+void CompiledCondition::AddItem(Item *item) {
+  m_program.push_back(Instruction{OP_ITEM, CMP_EQ, 0, 0, {}, item});
+}
+
+bool CompiledCondition::Bind(THD *thd) {
+  for (Operand &operand : m_operands) {
+    if (operand.source != SOURCE_CONSTANT) continue;
+    Value &value = operand.constant;
+    if (operand.type == VALUE_INT)
+      value.int_value = operand.item->val_int();
+    else
+      value.real_value = operand.item->val_real();
+    value.is_unsigned = operand.item->unsigned_flag;
+    value.is_null = operand.item->null_value;
+    if (thd->is_error()) return true;
+  }
+
+  for (Instruction &instruction : m_program) {
+    if (instruction.op != OP_IN) continue;
+    Item_func_in *in = down_cast<Item_func_in *>(instruction.item);
+    instruction.in_list.clear();
+    for (uint i = 1; i < in->argument_count(); ++i) {
+      Item *arg = in->arguments()[i];
+      Value value;
+      value.int_value = arg->val_int();
+      value.is_unsigned = arg->unsigned_flag;
+      value.is_null = arg->null_value;
+      if (thd->is_error()) return true;
+      // A NULL in the list can only make a miss unknown, i.e. false.
+      if (!value.is_null) instruction.in_list.push_back(value);
+    }
+    std::sort(instruction.in_list.begin(), instruction.in_list.end(),
+              [](const Value &a, const Value &b) {
+                return CompareValues(a, b, VALUE_INT) < 0;
+              });
+  }
+  return false;
+}
+
+CompiledCondition::Value CompiledCondition::Read(
+    const Operand &operand) const {
+  if (operand.source == SOURCE_CONSTANT) return operand.constant;
+
+  Value value;
+  value.is_unsigned = operand.is_unsigned;
+  value.is_null = operand.field->is_null();
+  if (value.is_null) return value;
+
+  const uchar *ptr = operand.field->field_ptr();
+  longlong int_value = 0;
+  switch (operand.source) {
+    case SOURCE_TINY:
+      int_value = operand.is_unsigned ? longlong{ptr[0]}
+                                      : longlong{static_cast<int8>(ptr[0])};
+      break;
+    case SOURCE_SHORT:
+      int_value = operand.is_unsigned ? longlong{uint2korr(ptr)}
+                                      : longlong{sint2korr(ptr)};
+      break;
+    case SOURCE_INT24:
+      int_value = operand.is_unsigned ? longlong{uint3korr(ptr)}
+                                      : longlong{sint3korr(ptr)};
+      break;
+    case SOURCE_LONG:
+      int_value = operand.is_unsigned ? longlong{uint4korr(ptr)}
+                                      : longlong{sint4korr(ptr)};
+      break;
+    case SOURCE_LONGLONG:
+      int_value = sint8korr(ptr);
+      break;
+    case SOURCE_FLOAT:
+      value.real_value = double{float4get(ptr)};
+      return value;
+    case SOURCE_DOUBLE:
+      value.real_value = float8get(ptr);
+      return value;
+    case SOURCE_CONSTANT:
+      break;
+  }
+  if (operand.type == VALUE_INT)
+    value.int_value = int_value;
+  else if (operand.is_unsigned)
+    value.real_value = static_cast<double>(static_cast<ulonglong>(int_value));
+  else
+    value.real_value = static_cast<double>(int_value);
+  return value;
+}
+
+int CompiledCondition::CompareValues(const Value &a, const Value &b,
+                                     Value_type type) {
+  if (type == VALUE_REAL) {
+    if (a.real_value < b.real_value) return -1;
+    return a.real_value == b.real_value ? 0 : 1;
+  }
+  // A negative signed value is less than any unsigned one.
+  if (a.is_unsigned != b.is_unsigned) {
+    if (!a.is_unsigned && a.int_value < 0) return -1;
+    if (!b.is_unsigned && b.int_value < 0) return 1;
+  }
+  if (a.is_unsigned || b.is_unsigned) {
+    const ulonglong x = static_cast<ulonglong>(a.int_value);
+    const ulonglong y = static_cast<ulonglong>(b.int_value);
+    return x < y ? -1 : (x == y ? 0 : 1);
+  }
+  return a.int_value < b.int_value ? -1
+                                   : (a.int_value == b.int_value ? 0 : 1);
+}
+
+bool CompiledCondition::Evaluate() const {
+  bool result = false;
+  const size_t size = m_program.size();
+  for (size_t pc = 0; pc < size;) {
+    const Instruction &instruction = m_program[pc];
+    switch (instruction.op) {
+      case OP_JUMP_IF_FALSE:
+        pc = result ? pc + 1 : instruction.jump;
+        continue;
+      case OP_JUMP_IF_TRUE:
+        pc = result ? instruction.jump : pc + 1;
+        continue;
+      case OP_ITEM:
+        result = instruction.item->val_int() != 0;
+        break;
+      case OP_COMPARE: {
+        const Operand &left = m_operands[instruction.operand];
+        const Value a = Read(left);
+        const Value b = Read(m_operands[instruction.operand + 1]);
+        if (a.is_null || b.is_null) {
+          result = false;
+          break;
+        }
+        int cmp = CompareValues(a, b, left.type);
+        if (instruction.precision > 0 &&
+            std::fabs(a.real_value - b.real_value) < instruction.precision)
+          cmp = 0;
+        switch (instruction.compare) {
+          case CMP_EQ:
+            result = cmp == 0;
+            break;
+          case CMP_NE:
+            result = cmp != 0;
+            break;
+          case CMP_LT:
+            result = cmp < 0;
+            break;
+          case CMP_LE:
+            result = cmp <= 0;
+            break;
+          case CMP_GT:
+            result = cmp > 0;
+            break;
+          case CMP_GE:
+            result = cmp >= 0;
+            break;
+        }
+        break;
+      }
+      case OP_BETWEEN: {
+        const Operand &operand = m_operands[instruction.operand];
+        const Value value = Read(operand);
+        Value low = Read(m_operands[instruction.operand + 1]);
+        Value high = Read(m_operands[instruction.operand + 2]);
+        if (value.is_null || low.is_null || high.is_null) {
+          result = false;
+          break;
+        }
+        // Item_func_between takes the bounds with the signedness of the value.
+        low.is_unsigned = high.is_unsigned = value.is_unsigned;
+        result = CompareValues(low, value, operand.type) <= 0 &&
+                 CompareValues(value, high, operand.type) <= 0;
+        break;
+      }
+      case OP_IN: {
+        const Value value = Read(m_operands[instruction.operand]);
+        result = !value.is_null &&
+                 std::binary_search(instruction.in_list.begin(),
+                                    instruction.in_list.end(), value,
+                                    [](const Value &a, const Value &b) {
+                                      return CompareValues(a, b, VALUE_INT) <
+                                             0;
+                                    });
+        break;
+      }
+      case OP_IS_NULL:
+        result = m_operands[instruction.operand].field->is_null();
+        break;
+      case OP_IS_NOT_NULL:
+        result = !m_operands[instruction.operand].field->is_null();
+        break;
+    }
+    ++pc;
+  }
+  return result;
+}
@@ -0,0 +1,155 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#ifndef SQL_ITERATORS_COMPILED_CONDITION_H_
+#define SQL_ITERATORS_COMPILED_CONDITION_H_
+
+/**
+  @file
+  A filter condition lowered to a flat program, so that FilterIterator
+  does not walk the Item tree with virtual calls for every row.
+
+  The common simple predicates are compiled: comparisons, BETWEEN and IN
+  lists over integer and floating point columns and constants, and IS
+  [NOT] NULL of such columns, joined by AND and OR. Columns are read
+  straight from the record buffer. Anything else in the condition, e.g.
+  string comparisons or functions, stays an Item and is evaluated with
+  val_int() from the program, so any condition can be compiled, and it is
+  only worth it when some of it is not left to val_int().
+
+  AND and OR short-circuit by jumping over the rest of their arguments.
+  NOT is never compiled, only left to val_int(), so an unknown result
+  can be taken as false everywhere in the program, as a filter does.
+*/
+
+#include <vector>
+
+#include "my_inttypes.h"
+
+class Field;
+class Item;
+class THD;
+
+class CompiledCondition {
+ public:
+  /**
+    Compile a condition. Constant operands are not read until Bind().
+    @return true if it is not worth evaluating the program instead of
+      the condition
+  */
+  bool Compile(Item *condition);
+
+  /**
+    Evaluate the constant operands of the program, e.g. for the current
+    values of the parameters of a prepared statement.
+    @return true on error
+  */
+  bool Bind(THD *thd);
+
+  /// Whether the current row passes the condition.
+  bool Evaluate() const;
+
+ private:
+  enum Opcode : uchar {
+    /// The condition is the Item, evaluated with val_int().
+    OP_ITEM,
+    /// Compare two operands with compare.
+    OP_COMPARE,
+    /// The first operand lies between the second and third.
+    OP_BETWEEN,
+    /// The first operand is one of in_list.
+    OP_IN,
+    OP_IS_NULL,
+    OP_IS_NOT_NULL,
+    /// Jump to jump if the result so far is false, e.g. in an AND.
+    OP_JUMP_IF_FALSE,
+    /// Jump to jump if the result so far is true, e.g. in an OR.
+    OP_JUMP_IF_TRUE
+  };
+
+  enum Compare : uchar { CMP_EQ, CMP_NE, CMP_LT, CMP_LE, CMP_GT, CMP_GE };
+
+  /// How the value of an operand is compared.
+  enum Value_type : uchar { VALUE_INT, VALUE_REAL };
+
+  /// Where an operand is read from.
+  enum Source : uchar {
+    SOURCE_CONSTANT,
+    SOURCE_TINY,
+    SOURCE_SHORT,
+    SOURCE_INT24,
+    SOURCE_LONG,
+    SOURCE_LONGLONG,
+    SOURCE_FLOAT,
+    SOURCE_DOUBLE
+  };
+
+  struct Value {
+    union {
+      longlong int_value;
+      double real_value;
+    };
+    bool is_unsigned;
+    bool is_null;
+  };
+
+  /// A column or constant, read as type.
+  struct Operand {
+    Source source;
+    Value_type type;
+    bool is_unsigned;
+    /// The column, or nullptr for a constant.
+    Field *field;
+    /// The constant, or the column's Item.
+    Item *item;
+    /// Value of a constant, set by Bind().
+    Value constant;
+  };
+
+  struct Instruction {
+    Opcode op;
+    Compare compare;
+    /// Index of the first operand in m_operands.
+    uint operand;
+    /// Target of a jump, index into m_program.
+    uint jump;
+    /// Sorted constants of OP_IN, set by Bind().
+    std::vector<Value> in_list;
+    /// Item of OP_ITEM, Item_func_in of OP_IN.
+    Item *item;
+    /// Real values of OP_COMPARE this close are equal, see
+    /// Arg_comparator::compare_real_fixed().
+    double precision{0};
+  };
+
+  void CompileItem(Item *item);
+  bool CompileCompare(Item *item);
+  bool CompileBetween(Item *item);
+  bool CompileIn(Item *item);
+  bool CompileNullTest(Item *item, bool is_null);
+  bool AddOperand(Item *item, Value_type type);
+  void AddItem(Item *item);
+
+  Value Read(const Operand &operand) const;
+  static int CompareValues(const Value &a, const Value &b, Value_type type);
+
+  std::vector<Instruction> m_program;
+  std::vector<Operand> m_operands;
+  /// Number of instructions that are not OP_ITEM or jumps.
+  uint m_compiled_leaves{0};
+};
+
+#endif  // SQL_ITERATORS_COMPILED_CONDITION_H_
@@ -26,6 +26,7 @@
 #include <string.h>
 #include <atomic>
 #include <list>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -71,12 +72,27 @@ using std::string;
 using std::swap;
 using std::vector;
 
+FilterIterator::FilterIterator(THD *thd,
+                               unique_ptr_destroy_only<RowIterator> source,
+                               Item *condition)
+    : RowIterator(thd), m_source(std::move(source)), m_condition(condition) {
+  m_compiled = thd->variables.compile_filter_conditions &&
+               !m_compiled_condition.Compile(condition);
+}
+
+bool FilterIterator::Init() {
+  // Parameters and other constants may differ between executions.
+  if (m_compiled && m_compiled_condition.Bind(thd())) return true;
+  return m_source->Init();
+}
+
 int FilterIterator::Read() {
   for (;;) {
     int err = m_source->Read();
     if (err != 0) return err;
 
-    bool matched = m_condition->val_int();
+    bool matched = m_compiled ? m_compiled_condition.Evaluate()
+                              : m_condition->val_int();
 
     if (thd()->killed) {
       thd()->send_kill_message();
@@ -687,6 +703,10 @@ class MaterializeIterator final : public TableRowIterator {
   /// avoiding duplicate work.
   Common_table_expr *m_cte;
 
+  /// While materializing a recursive query expression, the rows written
+  /// kept in memory for the recursive references, if any.
+  Recursive_row_buffer *m_row_buffer{nullptr};
+
   /// The query expression we are materializing. For derived tables,
   /// we materialize the entire query expression; for materialization within
   /// a query expression (e.g. for sorting or for windowing functions),
@@ -1058,12 +1078,25 @@ bool MaterializeIterator<Profiler>::MaterializeRecursive() {
 
   ha_rows stored_rows = 0;
 
+  // Keep the rows in memory as well, so that the recursive references do not
+  // read them back through the handler, up to the size the table may have
+  // in memory. Pointers to BLOB data would not outlive the next write.
+  std::optional<Recursive_row_buffer> row_buffer;
+  if (table()->s->blob_fields == 0 &&
+      table()->s->reclength <= thd()->variables.tmp_table_size)
+    row_buffer.emplace(table()->s->reclength,
+                       thd()->variables.tmp_table_size);
+  m_row_buffer = row_buffer.has_value() ? &*row_buffer : nullptr;
+  auto row_buffer_cleanup =
+      create_scope_guard([this] { m_row_buffer = nullptr; });
+
   // Give each recursive iterator access to the stored number of rows
   // (see FollowTailIterator::Read() for details).
   for (const materialize_iterator::QueryBlock &query_block :
        m_query_blocks_to_materialize) {
     if (query_block.is_recursive_reference) {
       query_block.recursive_reader->set_stored_rows_pointer(&stored_rows);
+      query_block.recursive_reader->set_row_buffer(m_row_buffer);
     }
   }
 
@@ -1075,6 +1108,7 @@ bool MaterializeIterator<Profiler>::MaterializeRecursive() {
          m_query_blocks_to_materialize) {
       if (query_block.is_recursive_reference) {
         query_block.recursive_reader->set_stored_rows_pointer(nullptr);
+        query_block.recursive_reader->set_row_buffer(nullptr);
       }
     }
   });
@@ -1394,6 +1428,7 @@ bool MaterializeIterator<Profiler>::MaterializeQueryBlock(
     error = t->file->ha_write_row(t->record[0]);
     if (error == 0) {
       ++*stored_rows;
+      if (m_row_buffer != nullptr) m_row_buffer->append(t->record[0]);
       continue;
     }
     // create_ondisk_from_heap will generate error if needed.
@@ -1406,8 +1441,10 @@ bool MaterializeIterator<Profiler>::MaterializeQueryBlock(
       // Table's engine changed; index is not initialized anymore.
       if (t->hash_field) t->file->ha_index_init(0, false);
       if (!is_duplicate &&
-          (t->is_union_or_table() || query_block.m_operand_idx == 0))
+          (t->is_union_or_table() || query_block.m_operand_idx == 0)) {
         ++*stored_rows;
+        if (m_row_buffer != nullptr) m_row_buffer->append(t->record[0]);
+      }
 
       // Inform each reader that the table has changed under their feet,
       // so they'll need to reposition themselves.
@@ -50,6 +50,7 @@
 #include "my_base.h"
 #include "my_inttypes.h"
 #include "my_table_map.h"
+#include "sql/iterators/compiled_condition.h"
 #include "sql/iterators/row_iterator.h"
 #include "sql/join_type.h"
 #include "sql/mem_root_array.h"
@@ -73,14 +74,16 @@ class Temp_table_param;
   An iterator that takes in a stream of rows and passes through only those that
   meet some criteria (i.e., a condition evaluates to true). This is typically
   used for WHERE/HAVING.
+
+  With compile_filter_conditions, the condition is evaluated as a
+  CompiledCondition where any of it can be compiled.
  */
 class FilterIterator final : public RowIterator {
  public:
   FilterIterator(THD *thd, unique_ptr_destroy_only<RowIterator> source,
-                 Item *condition)
-      : RowIterator(thd), m_source(std::move(source)), m_condition(condition) {}
+                 Item *condition);
 
-  bool Init() override { return m_source->Init(); }
+  bool Init() override;
 
   int Read() override;
 
@@ -97,6 +100,9 @@ class FilterIterator final : public RowIterator {
  private:
   unique_ptr_destroy_only<RowIterator> m_source;
   Item *m_condition;
+  CompiledCondition m_compiled_condition;
+  /// Whether rows are filtered by m_compiled_condition.
+  bool m_compiled{false};
 };
 
 /**
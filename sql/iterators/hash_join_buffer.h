@@ -166,6 +166,11 @@ class HashJoinRowBuffer {
                     std::vector<HashJoinCondition> join_conditions,
                     size_t max_mem_available_bytes);
 
+  // Back the rows stored from now on with huge pages where possible.
+  void set_large_pages(bool large_pages) {
+    m_mem_root.set_large_pages(large_pages);
+  }
+
   // Initialize the HashJoinRowBuffer so it is ready to store rows. This
   // function can be called multiple times; subsequent calls will only clear the
   // buffer for existing rows.
@@ -23,11 +23,14 @@
 #include "sql/iterators/hash_join_chunk.h"
 
 #include <stddef.h>
+#include <string.h>
+#include <algorithm>
 #include <new>
 #include <utility>
 
 #include "my_inttypes.h"
 #include "my_sys.h"
+#include "mysql/psi/mysql_thread.h"
 #include "mysqld_error.h"
 #include "sql/iterators/hash_join_buffer.h"
 #include "sql/mysqld.h"
@@ -42,7 +45,9 @@ HashJoinChunk::HashJoinChunk(HashJoinChunk &&other)
     : m_tables(std::move(other.m_tables)),
       m_num_rows(other.m_num_rows),
       m_file(other.m_file),
-      m_uses_match_flags(other.m_uses_match_flags) {
+      m_uses_match_flags(other.m_uses_match_flags),
+      m_num_bytes(other.m_num_bytes) {
+  assert(!other.m_prefetching);
   setup_io_cache(&m_file);
   // Reset the IO_CACHE structure so that the destructor doesn't close/clear the
   // file contents and it's buffers.
@@ -50,9 +55,15 @@ HashJoinChunk::HashJoinChunk(HashJoinChunk &&other)
 }
 
 HashJoinChunk &HashJoinChunk::operator=(HashJoinChunk &&other) {
+  assert(!other.m_prefetching);
+  WaitForPrefetch();
   m_tables = std::move(other.m_tables);
   m_num_rows = other.m_num_rows;
   m_uses_match_flags = other.m_uses_match_flags;
+  m_num_bytes = other.m_num_bytes;
+  m_prefetched.clear();
+  m_prefetched_pos = 0;
+  m_prefetch_failed = false;
 
   // Since the file we are replacing will become unreachable, free all resources
   // used by it.
@@ -66,12 +77,20 @@ HashJoinChunk &HashJoinChunk::operator=(HashJoinChunk &&other) {
   return *this;
 }
 
-HashJoinChunk::~HashJoinChunk() { close_cached_file(&m_file); }
+HashJoinChunk::~HashJoinChunk() {
+  WaitForPrefetch();
+  close_cached_file(&m_file);
+}
 
 bool HashJoinChunk::Init(const TableCollection &tables, bool uses_match_flags) {
   m_tables = tables;
+  WaitForPrefetch();
   m_file.file_key = key_file_hash_join;
   m_num_rows = 0;
+  m_num_bytes = 0;
+  m_prefetched.clear();
+  m_prefetched_pos = 0;
+  m_prefetch_failed = false;
   m_uses_match_flags = uses_match_flags;
   close_cached_file(&m_file);
   return open_cached_file(&m_file, mysql_tmpdir, TEMP_PREFIX, DISK_BUFFER_SIZE,
@@ -79,6 +98,12 @@ bool HashJoinChunk::Init(const TableCollection &tables, bool uses_match_flags) {
 }
 
 bool HashJoinChunk::Rewind() {
+  // Whatever was read ahead is read again from the start of the file.
+  WaitForPrefetch();
+  m_prefetched.clear();
+  m_prefetched_pos = 0;
+  m_prefetch_failed = false;
+
   if (my_b_flush_io_cache(&m_file, /*need_append_buffer_lock=*/0) == -1 ||
       reinit_io_cache(&m_file, READ_CACHE, 0, false, false)) {
     my_error(ER_TEMP_FILE_WRITE_FAILURE, MYF(0));
@@ -118,13 +143,72 @@ bool HashJoinChunk::WriteRowToChunk(String *buffer, bool matched) {
     return true;
   }
   m_num_rows++;
+  m_num_bytes += (m_uses_match_flags ? sizeof(matched) : 0) +
+                 sizeof(data_length) + data_length;
   return false;
 }
 
+void HashJoinChunk::StartPrefetch(size_t max_bytes) {
+  assert(!m_prefetching);
+  m_prefetched.clear();
+  m_prefetched_pos = 0;
+  m_prefetch_failed = false;
+  m_prefetch_bytes = std::min(max_bytes, m_num_bytes);
+  if (m_prefetch_bytes == 0) return;
+
+  // Without a thread, the rows are simply read from the file when loaded.
+  m_prefetching =
+      mysql_thread_create(key_thread_hash_join_prefetch, &m_prefetch_thread,
+                          &connection_attrib, PrefetchThread, this) == 0;
+}
+
+void *HashJoinChunk::PrefetchThread(void *arg) {
+  my_thread_init();
+  HashJoinChunk *chunk = static_cast<HashJoinChunk *>(arg);
+  try {
+    chunk->m_prefetched.resize(chunk->m_prefetch_bytes);
+  } catch (const std::bad_alloc &) {
+    // Leave the file where it is, for the rows to be read from there.
+    chunk->m_prefetched.clear();
+  }
+  if (!chunk->m_prefetched.empty() &&
+      my_b_read(&chunk->m_file, pointer_cast<uchar *>(&chunk->m_prefetched[0]),
+                chunk->m_prefetched.size()) != 0) {
+    chunk->m_prefetch_failed = true;
+  }
+  my_thread_end();
+  return nullptr;
+}
+
+void HashJoinChunk::WaitForPrefetch() {
+  if (m_prefetching) {
+    my_thread_join(&m_prefetch_thread, nullptr);
+    m_prefetching = false;
+  }
+}
+
+bool HashJoinChunk::ReadFromChunk(uchar *data, size_t length) {
+  WaitForPrefetch();
+  if (m_prefetch_failed) return true;
+
+  const size_t from_memory =
+      std::min(length, m_prefetched.size() - m_prefetched_pos);
+  if (from_memory > 0) {
+    memcpy(data, m_prefetched.data() + m_prefetched_pos, from_memory);
+    m_prefetched_pos += from_memory;
+    if (m_prefetched_pos == m_prefetched.size()) {
+      // Free the memory as soon as it is consumed.
+      std::string().swap(m_prefetched);
+      m_prefetched_pos = 0;
+    }
+  }
+  if (from_memory == length) return false;
+  return my_b_read(&m_file, data + from_memory, length - from_memory) != 0;
+}
+
 bool HashJoinChunk::LoadRowFromChunk(String *buffer, bool *matched) {
   if (m_uses_match_flags) {
-    if (my_b_read(&m_file, pointer_cast<uchar *>(matched), sizeof(*matched)) !=
-        0) {
+    if (ReadFromChunk(pointer_cast<uchar *>(matched), sizeof(*matched))) {
       my_error(ER_TEMP_FILE_WRITE_FAILURE, MYF(0));
       return true;
     }
@@ -132,8 +216,7 @@ bool HashJoinChunk::LoadRowFromChunk(String *buffer, bool *matched) {
 
   // Read the length of the row.
   size_t row_length;
-  if (my_b_read(&m_file, pointer_cast<uchar *>(&row_length),
-                sizeof(row_length)) != 0) {
+  if (ReadFromChunk(pointer_cast<uchar *>(&row_length), sizeof(row_length))) {
     my_error(ER_TEMP_FILE_WRITE_FAILURE, MYF(0));
     return true;
   }
@@ -145,8 +228,7 @@ bool HashJoinChunk::LoadRowFromChunk(String *buffer, bool *matched) {
   }
 
   buffer->length(row_length);
-  if (my_b_read(&m_file, pointer_cast<uchar *>(buffer->ptr()), row_length) !=
-      0) {
+  if (ReadFromChunk(pointer_cast<uchar *>(buffer->ptr()), row_length)) {
     my_error(ER_TEMP_FILE_WRITE_FAILURE, MYF(0));
     return true;
   }
@@ -23,8 +23,11 @@
    along with this program; if not, write to the Free Software
    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
 
+#include <string>
+
 #include "my_base.h"
 #include "my_sys.h"
+#include "my_thread.h"
 #include "sql/pack_rows.h"
 
 class String;
@@ -125,7 +128,22 @@ class HashJoinChunk {
   /// @retval true on error
   bool Rewind();
 
+  /// Start reading the beginning of the chunk file into memory on another
+  /// thread, so that the file I/O overlaps with whatever the caller does
+  /// until it loads the first row. Reads at most max_bytes; the rest of the
+  /// rows are read from the file as usual. The chunk must have been rewound.
+  void StartPrefetch(size_t max_bytes);
+
  private:
+  static void *PrefetchThread(void *arg);
+
+  // Wait for the prefetch thread, if any, to be done with the file.
+  void WaitForPrefetch();
+
+  // Read length bytes from the prefetched data, then from the file.
+  // @retval true on error
+  bool ReadFromChunk(uchar *data, size_t length);
+
   // A collection of which tables the chunk file holds data from. Used to
   // determine where to read data from, and where to put the data back.
   pack_rows::TableCollection m_tables;
@@ -138,6 +156,19 @@ class HashJoinChunk {
 
   // Whether every row is prefixed with a match flag.
   bool m_uses_match_flags{false};
+
+  // The number of bytes written to the chunk file.
+  size_t m_num_bytes{0};
+
+  // The prefetch thread, which owns m_file while m_prefetching is set.
+  my_thread_handle m_prefetch_thread;
+  bool m_prefetching{false};
+  size_t m_prefetch_bytes{0};
+  bool m_prefetch_failed{false};
+
+  // The bytes read ahead from the file, and how many of them are consumed.
+  std::string m_prefetched;
+  size_t m_prefetched_pos{0};
 };
 
 #endif  // SQL_ITERATORS_HASH_JOIN_CHUNK_H_
@@ -88,10 +88,13 @@ HashJoinIterator::HashJoinIterator(
       m_estimated_build_rows(estimated_build_rows),
       m_probe_input_batch_mode(probe_input_batch_mode),
       m_allow_spill_to_disk(allow_spill_to_disk),
-      m_join_type(join_type) {
+      m_join_type(join_type),
+      m_runtime_filter(thd, m_join_conditions) {
   assert(m_build_input != nullptr);
   assert(m_probe_input != nullptr);
 
+  m_row_buffer.set_large_pages(thd->variables.large_page_query_buffers);
+
   // If there are multiple extra conditions, merge them into a single AND-ed
   // condition, so evaluation of the item is a bit easier.
   if (extra_conditions.size() == 1) {
@@ -139,6 +142,10 @@ bool HashJoinIterator::InitProbeIterator() {
     return true;
   }
 
+  if (m_runtime_filter_table != nullptr) {
+    m_runtime_filter_table->file->ha_set_runtime_filter(&m_runtime_filter);
+  }
+
   if (m_probe_input_batch_mode) {
     m_probe_input->StartPSIBatchMode();
   }
@@ -177,6 +184,7 @@ bool HashJoinIterator::Init() {
   }
 
   // Prepare to read the build input into the hash map.
+  m_runtime_filter_table = nullptr;
   PrepareForRequestRowId(m_build_input_tables.tables(),
                          m_tables_to_get_rowid_for);
   if (m_build_input->Init()) {
@@ -260,6 +268,7 @@ bool HashJoinIterator::Init() {
     return false;
   }
 
+  BuildRuntimeFilter();
   return InitProbeIterator();
 }
 
@@ -282,6 +291,102 @@ static bool ConstructJoinKey(
   return false;
 }
 
+// The most keys a runtime filter is built for. A larger build input is hardly
+// a small dimension table, and the filter would reject few probe rows.
+static constexpr size_t kRuntimeFilterMaxKeys = size_t{1} << 20;
+
+// Bits of the runtime filter per key, and bits set per key. About one in two
+// hundred probe rows whose key is not in the hash table passes.
+static constexpr size_t kRuntimeFilterBitsPerKey = 16;
+static constexpr int kRuntimeFilterProbes = 3;
+
+HashJoinRuntimeFilter::~HashJoinRuntimeFilter() { bitmap_free(&m_fields); }
+
+bool HashJoinRuntimeFilter::Build(
+    const hash_join_buffer::HashJoinRowBuffer &row_buffer, TABLE *table,
+    table_map probe_tables) {
+  if (row_buffer.size() > kRuntimeFilterMaxKeys) return false;
+  if (m_fields.bitmap == nullptr &&
+      bitmap_init(&m_fields, nullptr, table->s->fields))
+    return false;
+
+  bitmap_clear_all(&m_fields);
+  for (const HashJoinCondition &condition : m_join_conditions) {
+    for (Item *side :
+         {condition.left_extractor(), condition.right_extractor()}) {
+      WalkItem(side, enum_walk::PREFIX, [this, table](Item *item) {
+        if (item->type() == Item::FIELD_ITEM) {
+          const Field *field = down_cast<Item_field *>(item)->field;
+          if (field->table == table)
+            bitmap_set_bit(&m_fields, field->field_index());
+        }
+        return false;
+      });
+    }
+  }
+  m_probe_tables = probe_tables;
+
+  size_t num_bits = 64;
+  while (num_bits < row_buffer.size() * kRuntimeFilterBitsPerKey) {
+    num_bits <<= 1;
+  }
+  m_bits.assign(num_bits / 64, 0);
+  const uint64_t mask = num_bits - 1;
+  const hash_join_buffer::KeyHasher hasher;
+  for (auto it = row_buffer.begin(); it != row_buffer.end(); ++it) {
+    const uint64_t hash = hasher(it->first);
+    const uint64_t step = (hash >> 32) | 1;
+    for (int i = 0; i < kRuntimeFilterProbes; ++i) {
+      const uint64_t bit = (hash + i * step) & mask;
+      m_bits[bit / 64] |= uint64_t{1} << (bit % 64);
+    }
+  }
+  return true;
+}
+
+bool HashJoinRuntimeFilter::MayContain(uint64_t hash) const {
+  const uint64_t mask = m_bits.size() * 64 - 1;
+  const uint64_t step = (hash >> 32) | 1;
+  for (int i = 0; i < kRuntimeFilterProbes; ++i) {
+    const uint64_t bit = (hash + i * step) & mask;
+    if ((m_bits[bit / 64] & (uint64_t{1} << (bit % 64))) == 0) return false;
+  }
+  return true;
+}
+
+bool HashJoinRuntimeFilter::may_match() {
+  // A NULL key matches nothing. An error is left for the join to report, when
+  // it evaluates the key again.
+  if (ConstructJoinKey(m_thd, m_join_conditions, m_probe_tables,
+                       &m_join_key)) {
+    return m_thd->is_error();
+  }
+  return MayContain(hash_join_buffer::KeyHasher()(
+      hash_join_buffer::Key(m_join_key.ptr(), m_join_key.length())));
+}
+
+void HashJoinIterator::BuildRuntimeFilter() {
+  m_runtime_filter_table = nullptr;
+  // The filter only drops probe rows that produce no output: the whole build
+  // input must be in the hash table, and a probe row without a match must be
+  // discarded. A NULL-safe equality could match the NULL key an outer join
+  // below produces for a row the filter dropped, so it gets no filter.
+  if (!thd()->variables.hash_join_runtime_filter ||
+      (m_join_type != JoinType::INNER && m_join_type != JoinType::SEMI) ||
+      m_join_conditions.empty() || m_build_iterator_has_more_rows ||
+      m_probe_input_tables.tables().size() != 1)
+    return;
+  for (const HashJoinCondition &condition : m_join_conditions) {
+    if (condition.null_equals_null()) return;
+  }
+
+  TABLE *table = m_probe_input_tables.tables()[0].table;
+  if (m_runtime_filter.Build(m_row_buffer, table,
+                             m_probe_input_tables.tables_bitmap())) {
+    m_runtime_filter_table = table;
+  }
+}
+
 // Write a single row to a HashJoinChunk. The row must lie in the record buffer
 // (record[0]) for each involved table. The row is put into one of the chunks in
 // the input vector "chunks"; which chunk to use is decided by the hash value of
@@ -603,6 +708,13 @@ bool HashJoinIterator::ReadNextHashJoinChunk() {
     return false;
   }
 
+  // Read the next build chunk from disk while this chunk pair is joined.
+  if (move_to_next_chunk &&
+      m_current_chunk + 1 < static_cast<int>(m_chunk_files_on_disk.size())) {
+    m_chunk_files_on_disk[m_current_chunk + 1].build_chunk.StartPrefetch(
+        thd()->variables.join_buff_size);
+  }
+
   if (InitRowBuffer()) {
     return true;
   }
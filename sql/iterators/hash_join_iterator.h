@@ -40,11 +40,13 @@
 #include "sql/join_type.h"
 #include "sql/mem_root_array.h"
 #include "sql/pack_rows.h"
+#include "sql/runtime_filter.h"
 #include "sql_string.h"
 
 class Item;
 class JOIN;
 class THD;
+struct TABLE;
 
 struct ChunkPair {
   HashJoinChunk probe_chunk;
@@ -250,6 +252,39 @@ struct ChunkPair {
 /// a lookup structure using a row ID as the key. Due to this, we will
 /// reconsider this if the hash join type IN_MEMORY_WITH_HASH_TABLE_REFILL goes
 /// away.
+/// A bloom filter over the join keys in the hash table of a hash join, given
+/// to the scan of its probe input when that reads a single table. The storage
+/// engine can then drop the probe rows whose join key cannot be in the hash
+/// table before it decodes the rest of them, as the join would drop them.
+class HashJoinRuntimeFilter final : public Runtime_filter {
+ public:
+  HashJoinRuntimeFilter(
+      THD *thd, const Prealloced_array<HashJoinCondition, 4> &join_conditions)
+      : m_thd(thd), m_join_conditions(join_conditions) {}
+  ~HashJoinRuntimeFilter() override;
+
+  /// Fill the filter with the keys of a hash table, for the probe rows read
+  /// from a table.
+  ///
+  /// @retval false if the hash table has too many keys for the filter to be
+  ///         worth it
+  bool Build(const hash_join_buffer::HashJoinRowBuffer &row_buffer,
+             TABLE *table, table_map probe_tables);
+
+  const MY_BITMAP &fields() const override { return m_fields; }
+  bool may_match() override;
+
+ private:
+  bool MayContain(uint64_t hash) const;
+
+  THD *const m_thd;
+  const Prealloced_array<HashJoinCondition, 4> &m_join_conditions;
+  table_map m_probe_tables{0};
+  MY_BITMAP m_fields{};
+  std::vector<uint64_t> m_bits;
+  String m_join_key;
+};
+
 class HashJoinIterator final : public RowIterator {
  public:
   /// Construct a HashJoinIterator.
@@ -447,6 +482,11 @@ class HashJoinIterator final : public RowIterator {
   /// @retval true in case of error. my_error has been called.
   bool InitProbeIterator();
 
+  /// Fill m_runtime_filter from the hash table if it holds the entire build
+  /// input and the probe input reads a single table, and set
+  /// m_runtime_filter_table to that table.
+  void BuildRuntimeFilter();
+
   /// Mark that probe row saving is enabled, and prepare the probe row saving
   /// file for writing.
   /// @see m_write_to_probe_row_saving
@@ -654,6 +694,12 @@ class HashJoinIterator final : public RowIterator {
   // row, causing any local match flag to lose the match flag info from the last
   // probe row read.
   bool m_probe_row_match_flag{false};
+
+  // The join keys of the hash table, for the scan of the probe input, and the
+  // table it is given to each time the probe input is initialized, or nullptr
+  // if it is not.
+  HashJoinRuntimeFilter m_runtime_filter;
+  TABLE *m_runtime_filter_table{nullptr};
 };
 
 #endif  // SQL_ITERATORS_HASH_JOIN_ITERATOR_H_
@@ -0,0 +1,227 @@
+/*
+   Copyright (c) 2023, Facebook, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/iterators/knn_join_iterator.h"
+
+#include <assert.h>
+#include <string.h>
+#include <new>
+#include <utility>
+
+#include "my_base.h"
+#include "my_sys.h"
+#include "mysqld_error.h"
+#include "sql/handler.h"
+#include "sql/item_fb_vector_func.h"
+#include "sql/psi_memory_key.h"
+#include "sql/sql_class.h"
+#include "sql/sql_executor.h"
+#include "sql/table.h"
+
+using hash_join_buffer::BufferRow;
+using hash_join_buffer::LoadBufferRowIntoTableBuffers;
+
+/** most outer rows searched together, bounds the memory the batched search
+    needs for its results */
+static constexpr size_t KNN_JOIN_MAX_BATCH_ROWS = 1024;
+
+KnnJoinIterator::KnnJoinIterator(
+    THD *thd, unique_ptr_destroy_only<RowIterator> outer_input,
+    const Prealloced_array<TABLE *, 4> &outer_input_tables,
+    unique_ptr_destroy_only<RowIterator> inner_input, TABLE *table,
+    unsigned idx, Item_func_fb_vector_distance *distance_func,
+    size_t max_memory_available, bool store_rowids,
+    table_map tables_to_get_rowid_for)
+    : RowIterator(thd),
+      m_outer_input(std::move(outer_input)),
+      m_inner_input(std::move(inner_input)),
+      m_mem_root(key_memory_hash_join, 16384 /* 16 kB */),
+      m_rows(&m_mem_root),
+      m_outer_input_tables(outer_input_tables, store_rowids,
+                           tables_to_get_rowid_for,
+                           /*tables_to_store_contents_of_null_rows_for=*/0),
+      m_max_memory_available(max_memory_available),
+      m_table(table),
+      m_idx(idx),
+      m_distance_func(distance_func) {
+  assert(m_outer_input != nullptr);
+  assert(m_inner_input != nullptr);
+  assert(m_distance_func != nullptr);
+}
+
+bool KnnJoinIterator::Init() {
+  if (!m_outer_input_tables.has_blob_column()) {
+    size_t upper_row_size =
+        pack_rows::ComputeRowSizeUpperBound(m_outer_input_tables);
+    if (m_outer_row_buffer.reserve(upper_row_size)) {
+      my_error(ER_OUTOFMEMORY, MYF(0), upper_row_size);
+      return true;
+    }
+  }
+  PrepareForRequestRowId(m_outer_input_tables.tables(),
+                         m_outer_input_tables.tables_to_get_rowid_for());
+
+  BeginNewBatch();
+  m_end_of_outer_rows = false;
+  m_has_row_from_previous_batch = false;
+
+  return m_outer_input->Init();
+}
+
+void KnnJoinIterator::BeginNewBatch() {
+  m_mem_root.ClearForReuse();
+  new (&m_rows) Mem_root_array<BufferRow>(&m_mem_root);
+  m_query_vectors.clear();
+  m_bytes_used = 0;
+  m_current_row = nullptr;
+  m_state = State::NEED_OUTER_ROWS;
+}
+
+int KnnJoinIterator::ReadOuterRows() {
+  while (!m_end_of_outer_rows && m_rows.size() < KNN_JOIN_MAX_BATCH_ROWS) {
+    thd()->check_yield();
+    if (m_has_row_from_previous_batch) {
+      // The outer row will be in m_outer_row_buffer already, and its tables
+      // have been overwritten by the rows replayed since. Load it back so
+      // that its query vector can be evaluated.
+      m_has_row_from_previous_batch = false;
+      LoadBufferRowIntoTableBuffers(
+          m_outer_input_tables,
+          hash_join_buffer::Key(m_outer_row_buffer.ptr(),
+                                m_outer_row_buffer.length()));
+    } else {
+      int result = m_outer_input->Read();
+      if (result == 1) {
+        // Error.
+        return 1;
+      }
+      if (result == -1) {
+        // EOF.
+        m_end_of_outer_rows = true;
+        break;
+      }
+      RequestRowId(m_outer_input_tables.tables(),
+                   m_outer_input_tables.tables_to_get_rowid_for());
+
+      // Save the contents of all columns marked for reading.
+      if (StoreFromTableBuffers(m_outer_input_tables, &m_outer_row_buffer)) {
+        return 1;
+      }
+    }
+
+    // See if we have room for this row and its query vector without going
+    // over our total RAM budget. (We ignore the budget if the buffer is
+    // empty; at least a single row must be allowed at all times.)
+    const size_t row_size = m_outer_row_buffer.length();
+    const size_t total_bytes_needed_after_this_row =
+        m_bytes_used + row_size + sizeof(m_rows[0]) * (m_rows.size() + 1);
+    if (!m_rows.empty() &&
+        total_bytes_needed_after_this_row > m_max_memory_available) {
+      // Out of memory, so end the batch and send it.
+      // This row will be dealt with in the next batch.
+      m_has_row_from_previous_batch = true;
+      break;
+    }
+
+    // a row whose query vector does not parse is still joined; its own
+    // search gets to report the problem
+    std::vector<float> query_vector;
+    if (m_distance_func->get_input_vector(query_vector)) {
+      if (thd()->is_error()) return 1;
+    } else {
+      m_bytes_used += query_vector.size() * sizeof(float);
+      m_query_vectors.push_back(std::move(query_vector));
+    }
+
+    char *row = m_mem_root.ArrayAlloc<char>(row_size);
+    if (row == nullptr) {
+      return 1;
+    }
+    memcpy(row, m_outer_row_buffer.ptr(), row_size);
+
+    m_rows.push_back(BufferRow(row, row_size));
+    m_bytes_used += row_size;
+  }
+
+  // If we had no rows at all, we're done.
+  if (m_rows.empty()) {
+    assert(!m_has_row_from_previous_batch);
+    m_state = State::END_OF_ROWS;
+    return -1;
+  }
+
+  // Search for the whole batch at once. Engines that cannot batch leave
+  // each inner scan to run its own search.
+  const int error =
+      m_table->file->vector_index_prefetch(m_idx, &m_query_vectors);
+  if (error != 0 && error != HA_ERR_WRONG_COMMAND) {
+    m_table->file->print_error(error, MYF(0));
+    return 1;
+  }
+
+  m_current_row = m_rows.begin();
+  m_state = State::NEXT_OUTER_ROW;
+  return 0;
+}
+
+int KnnJoinIterator::Read() {
+  for (;;) {  // Termination condition within loop.
+    switch (m_state) {
+      case State::END_OF_ROWS:
+        return -1;
+      case State::NEED_OUTER_ROWS: {
+        int err = ReadOuterRows();
+        if (err != 0) {
+          return err;
+        }
+        break;
+      }
+      case State::NEXT_OUTER_ROW: {
+        if (m_current_row == m_rows.end()) {
+          // Batch done; read more outer rows unless there are none left.
+          const bool more_rows =
+              !m_end_of_outer_rows || m_has_row_from_previous_batch;
+          BeginNewBatch();
+          if (!more_rows) {
+            m_state = State::END_OF_ROWS;
+          }
+          break;
+        }
+
+        // The tables the inner side depends on are not read by the outer
+        // iterator now, so tell their cache invalidators that the outer row
+        // changed; otherwise a lateral derived table is not rematerialized.
+        m_outer_input->SetNullRowFlag(false);
+        LoadBufferRowIntoTableBuffers(m_outer_input_tables, *m_current_row);
+        ++m_current_row;
+        if (m_inner_input->Init()) {
+          return 1;
+        }
+        m_state = State::READING_INNER_ROWS;
+      }
+        [[fallthrough]];
+      case State::READING_INNER_ROWS: {
+        int err = m_inner_input->Read();
+        if (err != -1) {
+          // A row or an error; pass it through.
+          return err;
+        }
+        m_state = State::NEXT_OUTER_ROW;
+        break;
+      }
+    }
+  }
+}
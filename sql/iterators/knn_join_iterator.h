@@ -0,0 +1,167 @@
+/*
+   Copyright (c) 2023, Facebook, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#ifndef SQL_ITERATORS_KNN_JOIN_ITERATOR_H_
+#define SQL_ITERATORS_KNN_JOIN_ITERATOR_H_
+
+/**
+  @file
+  An iterator joining each outer row to its k nearest neighbours in a vector
+  index, e.g. for
+
+    SELECT ... FROM a, LATERAL (SELECT ... FROM b
+                                ORDER BY FB_VECTOR_L2(b.v, a.v) LIMIT 10) nn
+
+  A nested loop join would run one knn search per outer row. The KNN join
+  instead reads a batch of outer rows into a buffer, hands all of their
+  query vectors to the storage engine as one batched search, and then runs
+  the inner side once per buffered row; the vector index scan in there picks
+  up the prefetched neighbours instead of searching again. Rows come out in
+  the same order as from a nested loop join.
+ */
+
+#include <stddef.h>
+#include <vector>
+
+#include "my_alloc.h"
+#include "my_table_map.h"
+#include "sql/iterators/hash_join_buffer.h"
+#include "sql/iterators/row_iterator.h"
+#include "sql/mem_root_array.h"
+#include "sql/pack_rows.h"
+#include "sql_string.h"
+
+class Item_func_fb_vector_distance;
+class THD;
+struct TABLE;
+
+class KnnJoinIterator final : public RowIterator {
+ public:
+  /**
+    @param thd Thread handle.
+    @param outer_input The iterator to read the outer rows from.
+    @param outer_input_tables Each outer table involved.
+      Used to know which fields we are to read into our buffer.
+    @param inner_input The iterator to read the inner rows from. Runs a knn
+      search on the vector index table.idx for the current outer row.
+    @param table The table holding the vector index.
+    @param idx The vector index.
+    @param distance_func The ORDER BY distance of the inner scan. Its query
+      vector is evaluated on each buffered outer row.
+    @param max_memory_available Number of bytes available for outer rows.
+    @param store_rowids Whether we need to make sure all tables below us have
+      row IDs available, after Read() has been called. Used only if
+      we are below a weedout operation.
+    @param tables_to_get_rowid_for A map of which tables KnnJoinIterator needs
+      to call position() for itself.
+   */
+  KnnJoinIterator(THD *thd, unique_ptr_destroy_only<RowIterator> outer_input,
+                  const Prealloced_array<TABLE *, 4> &outer_input_tables,
+                  unique_ptr_destroy_only<RowIterator> inner_input,
+                  TABLE *table, unsigned idx,
+                  Item_func_fb_vector_distance *distance_func,
+                  size_t max_memory_available, bool store_rowids,
+                  table_map tables_to_get_rowid_for);
+
+  bool Init() override;
+
+  int Read() override;
+
+  void SetNullRowFlag(bool is_null_row) override {
+    m_outer_input->SetNullRowFlag(is_null_row);
+    m_inner_input->SetNullRowFlag(is_null_row);
+  }
+
+  void UnlockRow() override {
+    // Since we don't know which condition that caused the row to be rejected,
+    // we can't know whether we could also unlock the outer row
+    // (it may still be used as parts of other joined rows).
+    if (m_state == State::READING_INNER_ROWS) {
+      m_inner_input->UnlockRow();
+    }
+  }
+
+  void EndPSIBatchModeIfStarted() override {
+    m_outer_input->EndPSIBatchModeIfStarted();
+    m_inner_input->EndPSIBatchModeIfStarted();
+  }
+
+ private:
+  /// Clear out the MEM_ROOT and prepare for reading rows anew.
+  void BeginNewBatch();
+
+  /// Read a batch of outer rows and prefetch their knn searches. Returns -1
+  /// for no outer rows found (sets state to END_OF_ROWS), 0 for OK (sets
+  /// state to NEXT_OUTER_ROW) or 1 for error.
+  int ReadOuterRows();
+
+  enum class State {
+    /// We are about to read a batch of outer rows into our buffer.
+    NEED_OUTER_ROWS,
+    /// We are about to load the next buffered outer row and start the inner
+    /// side for it.
+    NEXT_OUTER_ROW,
+    /// We are returning the neighbours of the current outer row.
+    READING_INNER_ROWS,
+    /// Both the outer and inner side are out of rows.
+    END_OF_ROWS
+  };
+
+  State m_state;
+
+  const unique_ptr_destroy_only<RowIterator> m_outer_input;
+  const unique_ptr_destroy_only<RowIterator> m_inner_input;
+
+  /// The MEM_ROOT we are storing the outer rows on.
+  MEM_ROOT m_mem_root;
+
+  /// Buffered outer rows.
+  Mem_root_array<hash_join_buffer::BufferRow> m_rows;
+
+  /// Query vectors of the buffered outer rows, handed to the engine.
+  std::vector<std::vector<float>> m_query_vectors;
+
+  /// Tables and columns needed for each outer row.
+  pack_rows::TableCollection m_outer_input_tables;
+
+  /// Used for serializing the row we read from the outer table(s), before it
+  /// is stored into the MEM_ROOT and put into m_rows. Should there not be
+  /// room in the batch for the row, it will stay in this variable until we
+  /// start reading the next batch of outer rows.
+  String m_outer_row_buffer;
+
+  /// Whether we have a row in m_outer_row_buffer from the previous batch of
+  /// rows that we haven't stored in m_rows yet.
+  bool m_has_row_from_previous_batch = false;
+
+  /// Whether we've seen EOF from the outer iterator.
+  bool m_end_of_outer_rows = false;
+
+  /// Estimated number of bytes used on m_mem_root so far.
+  size_t m_bytes_used = 0;
+
+  /// See max_memory_available in the constructor.
+  const size_t m_max_memory_available;
+
+  TABLE *const m_table;
+  const unsigned m_idx;
+  Item_func_fb_vector_distance *const m_distance_func;
+
+  /// The next buffered outer row to run the inner side for.
+  hash_join_buffer::BufferRow *m_current_row = nullptr;
+};
+
+#endif  // SQL_ITERATORS_KNN_JOIN_ITERATOR_H_
@@ -30,6 +30,7 @@ class Item;
 class JOIN;
 class THD;
 struct TABLE;
+struct ha_engine_counters;
 
 /**
    Profiling data for an iterator, needed by 'EXPLAIN ANALYZE'.
@@ -50,6 +51,13 @@ class IteratorProfiler {
 
   /** The number of rows fetched. (Sum for all loops.)*/
   virtual uint64_t GetNumRows() const = 0;
+
+  /**
+    The work of the storage engines done by this iterator itself, not by the
+    iterators it reads from. (Sum for all loops.)
+    @return false if it was not measured.
+  */
+  virtual bool GetEngineCounters(ha_engine_counters *) const { return false; }
   virtual ~IteratorProfiler() = default;
 };
 
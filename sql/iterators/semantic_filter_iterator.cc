@@ -0,0 +1,404 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/iterators/semantic_filter_iterator.h"
+
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+
+#include "my_sys.h"
+#include "mysqld_error.h"
+#include "sql/iterators/hash_join_buffer.h"
+#include "sql/item.h"
+#include "sql/item_fb_vector_func.h"
+#include "sql/item_func.h"
+#include "sql/item_semantic_func.h"
+#include "sql/mem_root_array.h"
+#include "sql/psi_memory_key.h"
+#include "sql/semantic_base.h"
+#include "sql/sql_class.h"
+#include "sql/sql_executor.h"
+
+using hash_join_buffer::BufferRow;
+using hash_join_buffer::LoadBufferRowIntoTableBuffers;
+
+/// Rows read from the source together, and what the model had for them.
+struct SemanticFilterIterator::Batch {
+  Batch()
+      : mem_root(key_memory_hash_join, 16384 /* 16 kB */), rows(&mem_root) {}
+
+  /// The MEM_ROOT we are storing the buffered rows on.
+  MEM_ROOT mem_root;
+
+  /// Buffered rows of the batch.
+  Mem_root_array<BufferRow> rows;
+
+  /// Estimated number of bytes used on mem_root so far.
+  size_t bytes_used = 0;
+
+  /// Answer of each semantic filter on each buffered row, row-major.
+  /// -1 where the row's own evaluation has to ask the model.
+  std::vector<int> results;
+
+  /// Embedding of each embedded text on each buffered row, row-major.
+  /// Empty where the row's own evaluation has to embed it.
+  std::vector<std::vector<float>> embeddings;
+
+  /// Prompts to send, and the slot in results each answer goes to.
+  std::vector<std::string> contexts;
+  std::vector<size_t> slots;
+
+  /// Texts to embed, and the slot in embeddings each embedding goes to.
+  std::vector<std::string> texts;
+  std::vector<size_t> text_slots;
+
+  /// Has the answers of a batch read ahead.
+  Semantic_filter_prefetch prefetch;
+};
+
+SemanticFilterIterator::SemanticFilterIterator(
+    THD *thd, unique_ptr_destroy_only<RowIterator> source,
+    const Prealloced_array<TABLE *, 4> &tables, Item *condition,
+    size_t batch_size, size_t concurrency, size_t read_ahead,
+    size_t max_memory_available, table_map tables_to_get_rowid_for,
+    ha_rows rows_needed)
+    : RowIterator(thd),
+      m_source(std::move(source)),
+      m_condition(condition),
+      m_batch_size(batch_size),
+      m_concurrency(concurrency),
+      m_read_ahead(read_ahead),
+      m_current(std::make_unique<Batch>()),
+      m_tables(tables, /*store_rowids=*/true, tables_to_get_rowid_for,
+               /*tables_to_store_contents_of_null_rows_for=*/0),
+      m_max_memory_available(max_memory_available / (read_ahead + 1)),
+      m_rows_needed(rows_needed) {
+  assert(m_source != nullptr);
+  assert(m_batch_size > 0);
+  WalkItem(m_condition, enum_walk::PREFIX, [this](Item *item) {
+    if (item->type() == Item::FUNC_ITEM) {
+      const Item_func::Functype type =
+          down_cast<Item_func *>(item)->functype();
+      if (type == Item_func::SEMANTIC_FILTER_SINGLE_COL ||
+          type == Item_func::SEMANTIC_FILTER_TWO_COL ||
+          type == Item_func::SEMANTIC_JOIN) {
+        m_filters.push_back(down_cast<Item_func_semantic_filter *>(item));
+      } else if (type == Item_func::SEMANTIC_RANK ||
+                 type == Item_func::SEMANTIC_EMBED) {
+        Semantic_text_embedder *embedder =
+            type == Item_func::SEMANTIC_RANK
+                ? static_cast<Semantic_text_embedder *>(
+                      down_cast<Item_func_semantic_rank *>(item))
+                : down_cast<Item_func_semantic_embed *>(item);
+        // a constant text is embedded once by the function itself
+        if (!embedder->embedded_text()->const_for_execution()) {
+          m_embedders.push_back(embedder);
+        }
+      }
+    }
+    return false;
+  });
+}
+
+bool SemanticFilterIterator::Init() {
+  if (!m_tables.has_blob_column()) {
+    size_t upper_row_size = pack_rows::ComputeRowSizeUpperBound(m_tables);
+    if (m_row_buffer.reserve(upper_row_size)) {
+      my_error(ER_OUTOFMEMORY, MYF(0), upper_row_size);
+      return true;
+    }
+  }
+  PrepareForRequestRowId(m_tables.tables(), m_tables.tables_to_get_rowid_for());
+
+  // Batches still read ahead from before are waited for and dropped.
+  m_ahead.clear();
+  BeginNewBatch(m_current.get());
+  m_next_row = 0;
+  m_end_of_rows = false;
+  m_has_row_from_previous_batch = false;
+  m_rows_returned = 0;
+
+  return m_source->Init();
+}
+
+SemanticFilterIterator::~SemanticFilterIterator() = default;
+
+void SemanticFilterIterator::BeginNewBatch(Batch *batch) {
+  batch->mem_root.ClearForReuse();
+  new (&batch->rows) Mem_root_array<BufferRow>(&batch->mem_root);
+  batch->bytes_used = 0;
+  batch->results.clear();
+  batch->embeddings.clear();
+  batch->contexts.clear();
+  batch->slots.clear();
+  batch->texts.clear();
+  batch->text_slots.clear();
+}
+
+size_t SemanticFilterIterator::NextBatchSize() const {
+  if (m_rows_needed == HA_POS_ERROR) return m_batch_size;
+  // Every row of the batch could pass, so don't read more than can still
+  // be returned.
+  ha_rows rows_buffered = m_rows_returned;
+  for (const std::unique_ptr<Batch> &batch : m_ahead) {
+    rows_buffered += batch->rows.size();
+  }
+  if (rows_buffered >= m_rows_needed) return m_ahead.empty() ? 1 : 0;
+  return std::min<ha_rows>(m_batch_size, m_rows_needed - rows_buffered);
+}
+
+int SemanticFilterIterator::ReadBatch(Batch *batch, size_t batch_size) {
+  BeginNewBatch(batch);
+
+  // Prompts the cascade may answer first, see semantic_filter_cascade, and
+  // the texts among their inputs still to embed.
+  struct Cascade_prompt {
+    Item_func_semantic_filter *filter;
+    size_t slot;
+    std::string context;
+    std::vector<float> embedding;
+  };
+  std::vector<Cascade_prompt> cascade_prompts;
+  std::vector<std::string> cascade_texts;
+  std::vector<size_t> cascade_text_prompts;
+  String text_buffer;
+
+  while (!m_end_of_rows && batch->rows.size() < batch_size) {
+    if (m_has_row_from_previous_batch) {
+      // The row is in m_row_buffer already, but the tables have been
+      // overwritten by the rows replayed since. Load it back so that the
+      // prompts can be built.
+      m_has_row_from_previous_batch = false;
+      LoadBufferRowIntoTableBuffers(
+          m_tables,
+          hash_join_buffer::Key(m_row_buffer.ptr(), m_row_buffer.length()));
+    } else {
+      int result = m_source->Read();
+      if (result == 1) {
+        // Error.
+        return 1;
+      }
+      if (result == -1) {
+        // EOF.
+        m_end_of_rows = true;
+        break;
+      }
+      RequestRowId(m_tables.tables(), m_tables.tables_to_get_rowid_for());
+
+      // Save the contents of all columns marked for reading.
+      if (StoreFromTableBuffers(m_tables, &m_row_buffer)) {
+        return 1;
+      }
+    }
+
+    // See if we have room for this row without going over our total RAM
+    // budget. (We ignore the budget if the buffer is empty; at least a
+    // single row must be allowed at all times.)
+    const size_t row_size = m_row_buffer.length();
+    const size_t total_bytes_needed_after_this_row =
+        batch->bytes_used + row_size +
+        sizeof(batch->rows[0]) * (batch->rows.size() + 1);
+    if (!batch->rows.empty() &&
+        total_bytes_needed_after_this_row > m_max_memory_available) {
+      // Out of memory, so end the batch. This row will be dealt with in the
+      // next batch.
+      m_has_row_from_previous_batch = true;
+      break;
+    }
+
+    // A semantic filter whose arguments cannot be read gets no prompt; its
+    // own evaluation on the row reports the problem.
+    for (Item_func_semantic_filter *filter : m_filters) {
+      std::string context;
+      std::string text;
+      std::vector<float> embedding;
+      if (filter->get_context(&context)) {
+        if (thd()->is_error()) return 1;
+      } else if (filter->cascade_enabled() &&
+                 !filter->get_cascade_input(&text, &embedding)) {
+        if (embedding.empty()) {
+          cascade_text_prompts.push_back(cascade_prompts.size());
+          cascade_texts.push_back(std::move(text));
+        }
+        cascade_prompts.push_back({filter, batch->results.size(),
+                                   std::move(context), std::move(embedding)});
+      } else if (thd()->is_error()) {
+        return 1;
+      } else {
+        batch->slots.push_back(batch->results.size());
+        batch->contexts.push_back(std::move(context));
+      }
+      batch->results.push_back(-1);
+    }
+    for (Semantic_text_embedder *embedder : m_embedders) {
+      String *text = embedder->embedded_text()->val_str(&text_buffer);
+      if (thd()->is_error()) return 1;
+      if (text != nullptr && !embedder->embedded_text()->null_value) {
+        batch->text_slots.push_back(batch->embeddings.size());
+        batch->texts.emplace_back(text->ptr(), text->length());
+      }
+      batch->embeddings.emplace_back();
+    }
+
+    char *row = batch->mem_root.ArrayAlloc<char>(row_size);
+    if (row == nullptr) {
+      return 1;
+    }
+    memcpy(row, m_row_buffer.ptr(), row_size);
+
+    batch->rows.push_back(BufferRow(row, row_size));
+    batch->bytes_used += row_size;
+  }
+
+  // If we had no rows at all, we're done.
+  if (batch->rows.empty()) {
+    assert(!m_has_row_from_previous_batch);
+    return -1;
+  }
+
+  // Only the rows the similarity leaves uncertain go to the model.
+  if (!cascade_texts.empty()) {
+    std::vector<std::vector<float>> embeddings;
+    semantic_embed_openai_batch(cascade_texts, &embeddings);
+    for (size_t i = 0; i < embeddings.size(); ++i) {
+      cascade_prompts[cascade_text_prompts[i]].embedding =
+          std::move(embeddings[i]);
+    }
+  }
+  for (Cascade_prompt &prompt : cascade_prompts) {
+    const int decision = prompt.filter->cascade_decision(prompt.embedding);
+    if (decision != -1) {
+      batch->results[prompt.slot] = decision;
+    } else {
+      batch->slots.push_back(prompt.slot);
+      batch->contexts.push_back(std::move(prompt.context));
+    }
+  }
+  return 0;
+}
+
+void SemanticFilterIterator::StoreAnswers(
+    Batch *batch, const std::vector<int> &answers,
+    std::vector<std::vector<float>> *embeddings) {
+  // Rows whose answers are missing ask the model again one by one when they
+  // are replayed, which also reports why.
+  for (size_t i = 0; i < answers.size(); ++i) {
+    batch->results[batch->slots[i]] = answers[i];
+  }
+  for (size_t i = 0; i < embeddings->size(); ++i) {
+    batch->embeddings[batch->text_slots[i]] = std::move((*embeddings)[i]);
+  }
+}
+
+int SemanticFilterIterator::NextBatch() {
+  std::vector<int> answers;
+  std::vector<std::vector<float>> embeddings;
+  if (m_read_ahead == 0) {
+    if (!HasMoreRows()) return -1;
+    const int err = ReadBatch(m_current.get(), NextBatchSize());
+    if (err != 0) return err;
+    if (!m_current->contexts.empty()) {
+      semantic_filter_openai_batch(m_current->contexts, m_concurrency,
+                                   &answers);
+    }
+    if (!m_current->texts.empty()) {
+      semantic_embed_openai_batch(m_current->texts, &embeddings);
+    }
+  } else {
+    // Fill the window: the batches are read while the model answers the
+    // ones before them, the first of which is returned next.
+    while (m_ahead.size() <= m_read_ahead && HasMoreRows()) {
+      const size_t batch_size = NextBatchSize();
+      if (batch_size == 0) break;
+      std::unique_ptr<Batch> batch = std::make_unique<Batch>();
+      const int err = ReadBatch(batch.get(), batch_size);
+      if (err == 1) return 1;
+      if (err == -1) break;
+      batch->prefetch.start(thd(), std::move(batch->contexts), m_concurrency,
+                            std::move(batch->texts));
+      m_ahead.push_back(std::move(batch));
+    }
+    if (m_ahead.empty()) return -1;
+    m_current = std::move(m_ahead.front());
+    m_ahead.pop_front();
+    m_current->prefetch.wait(&answers, &embeddings);
+  }
+  StoreAnswers(m_current.get(), answers, &embeddings);
+  m_next_row = 0;
+
+  if (thd()->killed) {
+    thd()->send_kill_message();
+    return 1;
+  }
+  return 0;
+}
+
+int SemanticFilterIterator::Read() {
+  for (;;) {
+    if (m_next_row == m_current->rows.size()) {
+      int err = NextBatch();
+      if (err != 0) {
+        return err;
+      }
+    }
+
+    LoadBufferRowIntoTableBuffers(m_tables, m_current->rows[m_next_row]);
+    const int *results = &m_current->results[m_next_row * m_filters.size()];
+    for (size_t i = 0; i < m_filters.size(); ++i) {
+      m_filters[i]->set_prefetched_result(results[i]);
+    }
+    std::vector<float> *embeddings =
+        &m_current->embeddings[m_next_row * m_embedders.size()];
+    for (size_t i = 0; i < m_embedders.size(); ++i) {
+      m_embedders[i]->set_prefetched_embedding(std::move(embeddings[i]));
+    }
+    ++m_next_row;
+
+    bool matched = m_condition->val_int();
+
+    // Answers not consumed, e.g. behind a false AND operand, must not leak
+    // into later evaluations.
+    for (Item_func_semantic_filter *filter : m_filters) {
+      filter->set_prefetched_result(-1);
+    }
+    for (Semantic_text_embedder *embedder : m_embedders) {
+      embedder->set_prefetched_embedding({});
+    }
+
+    if (thd()->killed) {
+      thd()->send_kill_message();
+      return 1;
+    }
+
+    thd()->check_yield();
+
+    /* check for errors evaluating the condition */
+    if (thd()->is_error()) return 1;
+
+    if (!matched) {
+      continue;
+    }
+
+    // Successful row.
+    ++m_rows_returned;
+    return 0;
+  }
+}
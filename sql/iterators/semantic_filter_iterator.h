@@ -0,0 +1,181 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#ifndef SQL_ITERATORS_SEMANTIC_FILTER_ITERATOR_H_
+#define SQL_ITERATORS_SEMANTIC_FILTER_ITERATOR_H_
+
+/**
+  @file
+  A filter whose condition holds SEMANTIC_FILTER functions, e.g.
+
+    SELECT ... FROM reviews
+    WHERE SEMANTIC_FILTER_SINGLE_COL('Is the review positive?', body)
+
+  A FilterIterator would make one blocking request to the model per row.
+  This iterator instead reads a batch of rows into a buffer, builds the
+  prompts of all semantic filters for each of them, and sends those
+  concurrently. With semantic_filter_cascade, the rows are first scored
+  by embedding similarity, embedded together, and only those the score
+  leaves uncertain are sent. Texts that SEMANTIC_RANK() embeds per row are
+  embedded together as well. It then replays the rows in their original order,
+  handing each function its answer or embedding before the condition is
+  evaluated.
+
+  With semantic_filter_read_ahead, the prompts of a batch are sent from a
+  thread of their own, and the following batches are read from the source
+  while the model answers them, so that scanning overlaps waiting for the
+  model. Their answers are still consumed in the order of the rows.
+ */
+
+#include <stddef.h>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "my_alloc.h"
+#include "my_base.h"
+#include "my_table_map.h"
+#include "sql/iterators/row_iterator.h"
+#include "sql/pack_rows.h"
+#include "sql_string.h"
+
+class Item;
+class Item_func_semantic_filter;
+class Semantic_text_embedder;
+class THD;
+struct TABLE;
+
+class SemanticFilterIterator final : public RowIterator {
+ public:
+  /**
+    @param thd Thread handle.
+    @param source The iterator to read rows from.
+    @param tables Each table read by source. Used to know which fields we
+      are to read into our buffer.
+    @param condition The filter condition.
+    @param batch_size Most rows read ahead.
+    @param concurrency Most requests to the model in flight at once.
+    @param read_ahead Number of batches read ahead while the model answers
+      the ones before them, 0 for none.
+    @param max_memory_available Number of bytes available for buffered rows,
+      shared by the batches read ahead.
+    @param tables_to_get_rowid_for A map of which tables
+      SemanticFilterIterator needs to call position() for itself, so that
+      the row IDs of the replayed rows are available to those above us.
+    @param rows_needed Most rows that will be read from us, e.g. by a LIMIT
+      right above, or HA_POS_ERROR. Batches are kept small enough not to
+      ask the model about rows that would never be read.
+   */
+  SemanticFilterIterator(THD *thd, unique_ptr_destroy_only<RowIterator> source,
+                         const Prealloced_array<TABLE *, 4> &tables,
+                         Item *condition, size_t batch_size,
+                         size_t concurrency, size_t read_ahead,
+                         size_t max_memory_available,
+                         table_map tables_to_get_rowid_for, ha_rows rows_needed);
+
+  ~SemanticFilterIterator() override;
+
+  bool Init() override;
+
+  int Read() override;
+
+  void SetNullRowFlag(bool is_null_row) override {
+    m_source->SetNullRowFlag(is_null_row);
+  }
+
+  void StartPSIBatchMode() override { m_source->StartPSIBatchMode(); }
+  void EndPSIBatchModeIfStarted() override {
+    m_source->EndPSIBatchModeIfStarted();
+  }
+
+  void UnlockRow() override {
+    // The source has moved past the buffered rows, so their locks are not
+    // ours to release.
+  }
+
+ private:
+  struct Batch;
+
+  /// Clear out a batch and prepare for reading rows into it anew.
+  static void BeginNewBatch(Batch *batch);
+
+  /// Whether the source may have rows that are not in a batch yet.
+  bool HasMoreRows() const {
+    return !m_end_of_rows || m_has_row_from_previous_batch;
+  }
+
+  /// Most rows worth reading into the next batch, as every buffered row
+  /// could pass. 0 if the batches read ahead hold all that can be returned.
+  size_t NextBatchSize() const;
+
+  /// Read a batch of rows and build the prompts of their semantic filters
+  /// and the texts to embed.
+  /// Returns -1 for no rows found, 0 for OK or 1 for error.
+  int ReadBatch(Batch *batch, size_t batch_size);
+
+  /// Hand the answers and embeddings had for a batch to its slots.
+  static void StoreAnswers(Batch *batch, const std::vector<int> &answers,
+                           std::vector<std::vector<float>> *embeddings);
+
+  /// Make m_current the next batch of rows, with the answers of their
+  /// semantic filters and the embeddings of their texts.
+  /// Returns -1 for no rows left, 0 for OK or 1 for error.
+  int NextBatch();
+
+  const unique_ptr_destroy_only<RowIterator> m_source;
+  Item *const m_condition;
+
+  /// The semantic filters of m_condition.
+  std::vector<Item_func_semantic_filter *> m_filters;
+
+  /// The functions of m_condition embedding a text that changes per row.
+  std::vector<Semantic_text_embedder *> m_embedders;
+
+  const size_t m_batch_size;
+  const size_t m_concurrency;
+  const size_t m_read_ahead;
+
+  /// The batch whose rows are being returned.
+  std::unique_ptr<Batch> m_current;
+
+  /// The batches read ahead, whose answers are being had, in order.
+  std::deque<std::unique_ptr<Batch>> m_ahead;
+
+  /// The next row of m_current to return.
+  size_t m_next_row = 0;
+
+  pack_rows::TableCollection m_tables;
+
+  /// Holds the row that did not fit into the previous batch.
+  String m_row_buffer;
+
+  /// Whether we have a row in m_row_buffer from the previous batch.
+  bool m_has_row_from_previous_batch = false;
+
+  /// Whether the source has been read to the end.
+  bool m_end_of_rows = false;
+
+  /// Number of bytes available for the rows of each batch.
+  const size_t m_max_memory_available;
+
+  /// See rows_needed in the constructor.
+  const ha_rows m_rows_needed;
+
+  /// Rows returned since Init().
+  ha_rows m_rows_returned = 0;
+};
+
+#endif  // SQL_ITERATORS_SEMANTIC_FILTER_ITERATOR_H_
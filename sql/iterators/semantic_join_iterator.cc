@@ -0,0 +1,376 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/iterators/semantic_join_iterator.h"
+
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+#include <new>
+#include <string>
+#include <utility>
+
+#include "my_base.h"
+#include "my_sys.h"
+#include "mysqld_error.h"
+#include "sql/handler.h"
+#include "sql/item.h"
+#include "sql/item_fb_vector_func.h"
+#include "sql/item_func.h"
+#include "sql/item_semantic_func.h"
+#include "sql/psi_memory_key.h"
+#include "sql/semantic_base.h"
+#include "sql/sql_class.h"
+#include "sql/sql_executor.h"
+#include "sql/table.h"
+
+using hash_join_buffer::BufferRow;
+using hash_join_buffer::LoadBufferRowIntoTableBuffers;
+
+/** most candidate pairs sent to the model together, bounds the outer rows
+    of a batch by the number of neighbours of each */
+static constexpr size_t SEMANTIC_JOIN_MAX_BATCH_PAIRS = 4096;
+
+SemanticJoinIterator::SemanticJoinIterator(
+    THD *thd, unique_ptr_destroy_only<RowIterator> outer_input,
+    const Prealloced_array<TABLE *, 4> &outer_input_tables,
+    const Prealloced_array<TABLE *, 4> &inner_input_tables,
+    const Mem_root_array<Item *> &join_conditions, TABLE *table, unsigned idx,
+    Item_func_fb_vector_distance *distance_func, size_t concurrency,
+    size_t max_memory_available, bool store_rowids,
+    table_map tables_to_get_rowid_for)
+    : RowIterator(thd),
+      m_outer_input(std::move(outer_input)),
+      m_join_conditions(join_conditions.begin(), join_conditions.end()),
+      m_table(table),
+      m_idx(idx),
+      m_distance_func(distance_func),
+      m_concurrency(concurrency),
+      m_mem_root(key_memory_hash_join, 16384 /* 16 kB */),
+      m_outer_rows(&m_mem_root),
+      m_outer_input_tables(outer_input_tables, store_rowids,
+                           tables_to_get_rowid_for,
+                           /*tables_to_store_contents_of_null_rows_for=*/0),
+      m_inner_input_tables(inner_input_tables, store_rowids,
+                           tables_to_get_rowid_for,
+                           /*tables_to_store_contents_of_null_rows_for=*/0),
+      m_max_memory_available(max_memory_available) {
+  assert(m_outer_input != nullptr);
+  assert(m_distance_func != nullptr);
+  assert(m_distance_func->m_limit > 0);
+  for (Item *cond : m_join_conditions) {
+    WalkItem(cond, enum_walk::PREFIX, [this](Item *item) {
+      if (item->type() == Item::FUNC_ITEM) {
+        const Item_func::Functype type =
+            down_cast<Item_func *>(item)->functype();
+        if (type == Item_func::SEMANTIC_FILTER_SINGLE_COL ||
+            type == Item_func::SEMANTIC_FILTER_TWO_COL ||
+            type == Item_func::SEMANTIC_JOIN) {
+          m_filters.push_back(down_cast<Item_func_semantic_filter *>(item));
+        }
+      }
+      return false;
+    });
+  }
+}
+
+bool SemanticJoinIterator::Init() {
+  if (!m_outer_input_tables.has_blob_column()) {
+    size_t upper_row_size =
+        pack_rows::ComputeRowSizeUpperBound(m_outer_input_tables);
+    if (m_row_buffer.reserve(upper_row_size)) {
+      my_error(ER_OUTOFMEMORY, MYF(0), upper_row_size);
+      return true;
+    }
+  }
+  if (!m_inner_input_tables.has_blob_column()) {
+    size_t upper_row_size =
+        pack_rows::ComputeRowSizeUpperBound(m_inner_input_tables);
+    if (m_inner_row_buffer.reserve(upper_row_size)) {
+      my_error(ER_OUTOFMEMORY, MYF(0), upper_row_size);
+      return true;
+    }
+  }
+  PrepareForRequestRowId(m_outer_input_tables.tables(),
+                         m_outer_input_tables.tables_to_get_rowid_for());
+  PrepareForRequestRowId(m_inner_input_tables.tables(),
+                         m_inner_input_tables.tables_to_get_rowid_for());
+
+  BeginNewBatch();
+  m_end_of_outer_rows = false;
+  m_has_row_from_previous_batch = false;
+
+  return m_outer_input->Init();
+}
+
+void SemanticJoinIterator::SetNullRowFlag(bool is_null_row) {
+  m_outer_input->SetNullRowFlag(is_null_row);
+  if (is_null_row) {
+    m_table->set_null_row();
+  } else {
+    m_table->reset_null_row();
+  }
+}
+
+void SemanticJoinIterator::EndPSIBatchModeIfStarted() {
+  m_outer_input->EndPSIBatchModeIfStarted();
+  m_table->file->end_psi_batch_mode_if_started();
+}
+
+void SemanticJoinIterator::BeginNewBatch() {
+  m_mem_root.ClearForReuse();
+  new (&m_outer_rows) Mem_root_array<BufferRow>(&m_mem_root);
+  m_query_vectors.clear();
+  m_candidates.clear();
+  m_next_candidate = 0;
+  m_results.clear();
+  m_bytes_used = 0;
+}
+
+bool SemanticJoinIterator::InitIndex() {
+  handler *const file = m_table->file;
+  if (file->inited != handler::INDEX || file->active_index != m_idx) {
+    if (file->inited != handler::NONE) {
+      file->ha_index_or_rnd_end();
+    }
+    const int error = file->ha_index_init(m_idx, /*sorted=*/true);
+    if (error) {
+      file->print_error(error, MYF(0));
+      return true;
+    }
+  }
+  const int error = file->vector_index_init(m_distance_func);
+  if (error) {
+    file->print_error(error, MYF(0));
+    return true;
+  }
+  return false;
+}
+
+int SemanticJoinIterator::ReadNeighbours(uint32_t outer_row,
+                                         std::vector<std::string> *contexts,
+                                         std::vector<size_t> *slots) {
+  handler *const file = m_table->file;
+  for (ha_rows neighbour = 0; neighbour < m_distance_func->m_limit;
+       ++neighbour) {
+    const int error = neighbour == 0 ? file->ha_index_first(m_table->record[0])
+                                     : file->ha_index_next(m_table->record[0]);
+    if (thd()->killed) {
+      thd()->send_kill_message();
+      return 1;
+    }
+    if (error == HA_ERR_END_OF_FILE || error == HA_ERR_KEY_NOT_FOUND) {
+      m_table->set_no_row();
+      return 0;
+    }
+    if (error != 0) {
+      file->print_error(error, MYF(0));
+      return 1;
+    }
+    RequestRowId(m_inner_input_tables.tables(),
+                 m_inner_input_tables.tables_to_get_rowid_for());
+
+    // Save the contents of all columns marked for reading.
+    if (StoreFromTableBuffers(m_inner_input_tables, &m_inner_row_buffer)) {
+      return 1;
+    }
+    const size_t row_size = m_inner_row_buffer.length();
+    char *row = m_mem_root.ArrayAlloc<char>(row_size);
+    if (row == nullptr) {
+      return 1;
+    }
+    memcpy(row, m_inner_row_buffer.ptr(), row_size);
+    m_candidates.push_back({outer_row, BufferRow(row, row_size)});
+    m_bytes_used += row_size;
+
+    // A semantic filter whose arguments cannot be read gets no prompt; its
+    // own evaluation on the pair reports the problem.
+    for (Item_func_semantic_filter *filter : m_filters) {
+      std::string context;
+      if (!filter->get_context(&context)) {
+        slots->push_back(m_results.size());
+        contexts->push_back(std::move(context));
+      } else if (thd()->is_error()) {
+        return 1;
+      }
+      m_results.push_back(-1);
+    }
+  }
+  return 0;
+}
+
+int SemanticJoinIterator::ReadBatch() {
+  BeginNewBatch();
+
+  const size_t max_rows = std::max<size_t>(
+      SEMANTIC_JOIN_MAX_BATCH_PAIRS / m_distance_func->m_limit, 1);
+  Item *const query = m_distance_func->arguments()[1];
+  while (!m_end_of_outer_rows && m_outer_rows.size() < max_rows) {
+    thd()->check_yield();
+    if (m_has_row_from_previous_batch) {
+      // The outer row is in m_row_buffer already, and its tables have been
+      // overwritten by the rows replayed since. Load it back so that its
+      // query vector can be evaluated.
+      m_has_row_from_previous_batch = false;
+      LoadBufferRowIntoTableBuffers(
+          m_outer_input_tables,
+          hash_join_buffer::Key(m_row_buffer.ptr(), m_row_buffer.length()));
+    } else {
+      int result = m_outer_input->Read();
+      if (result == 1) {
+        // Error.
+        return 1;
+      }
+      if (result == -1) {
+        // EOF.
+        m_end_of_outer_rows = true;
+        break;
+      }
+      RequestRowId(m_outer_input_tables.tables(),
+                   m_outer_input_tables.tables_to_get_rowid_for());
+
+      // Save the contents of all columns marked for reading.
+      if (StoreFromTableBuffers(m_outer_input_tables, &m_row_buffer)) {
+        return 1;
+      }
+    }
+
+    // See if we have room for this row and its query vector without going
+    // over our total RAM budget. (We ignore the budget if the buffer is
+    // empty; at least a single row must be allowed at all times.)
+    const size_t row_size = m_row_buffer.length();
+    const size_t total_bytes_needed_after_this_row =
+        m_bytes_used + row_size +
+        sizeof(m_outer_rows[0]) * (m_outer_rows.size() + 1);
+    if (!m_outer_rows.empty() &&
+        total_bytes_needed_after_this_row > m_max_memory_available) {
+      // This row will be dealt with in the next batch.
+      m_has_row_from_previous_batch = true;
+      break;
+    }
+
+    // an outer row without an embedding has no neighbours
+    std::vector<float> query_vector;
+    if (query->is_null() || m_distance_func->get_input_vector(query_vector)) {
+      if (thd()->is_error()) return 1;
+      continue;
+    }
+    m_bytes_used += query_vector.size() * sizeof(float);
+    m_query_vectors.push_back(std::move(query_vector));
+
+    char *row = m_mem_root.ArrayAlloc<char>(row_size);
+    if (row == nullptr) {
+      return 1;
+    }
+    memcpy(row, m_row_buffer.ptr(), row_size);
+    m_outer_rows.push_back(BufferRow(row, row_size));
+    m_bytes_used += row_size;
+  }
+
+  // If we had no rows at all, we're done.
+  if (m_outer_rows.empty()) {
+    return m_end_of_outer_rows && !m_has_row_from_previous_batch ? -1 : 0;
+  }
+
+  // The engine reads the query vector of the outer row in the table buffers
+  // when the index is set up.
+  LoadBufferRowIntoTableBuffers(m_outer_input_tables, m_outer_rows[0]);
+  if (InitIndex()) return 1;
+
+  // Search for the whole batch at once. Engines that cannot batch run one
+  // search per outer row below.
+  const int error =
+      m_table->file->vector_index_prefetch(m_idx, &m_query_vectors);
+  if (error != 0 && error != HA_ERR_WRONG_COMMAND) {
+    m_table->file->print_error(error, MYF(0));
+    return 1;
+  }
+
+  // Prompts to send, and the slot in m_results each answer goes to.
+  std::vector<std::string> contexts;
+  std::vector<size_t> slots;
+  for (uint32_t i = 0; i < m_outer_rows.size(); ++i) {
+    LoadBufferRowIntoTableBuffers(m_outer_input_tables, m_outer_rows[i]);
+    if (ReadNeighbours(i, &contexts, &slots)) return 1;
+  }
+
+  // Pairs whose answers are missing ask the model again one by one when
+  // they are replayed, which also reports why.
+  if (!contexts.empty()) {
+    std::vector<int> answers;
+    semantic_filter_openai_batch(contexts, m_concurrency, &answers);
+    for (size_t i = 0; i < answers.size(); ++i) {
+      m_results[slots[i]] = answers[i];
+    }
+  }
+
+  if (thd()->killed) {
+    thd()->send_kill_message();
+    return 1;
+  }
+  return 0;
+}
+
+int SemanticJoinIterator::Read() {
+  for (;;) {
+    if (m_next_candidate == m_candidates.size()) {
+      if (m_end_of_outer_rows && !m_has_row_from_previous_batch) {
+        return -1;
+      }
+      int err = ReadBatch();
+      if (err != 0) {
+        return err;
+      }
+      continue;
+    }
+
+    const Candidate &candidate = m_candidates[m_next_candidate];
+    LoadBufferRowIntoTableBuffers(m_outer_input_tables,
+                                  m_outer_rows[candidate.outer_row]);
+    LoadBufferRowIntoTableBuffers(m_inner_input_tables, candidate.inner_row);
+    const int *results = &m_results[m_next_candidate * m_filters.size()];
+    for (size_t i = 0; i < m_filters.size(); ++i) {
+      m_filters[i]->set_prefetched_result(results[i]);
+    }
+    ++m_next_candidate;
+
+    bool matched = true;
+    for (Item *cond : m_join_conditions) {
+      if (cond->val_int() == 0 || thd()->is_error()) {
+        matched = false;
+        break;
+      }
+    }
+
+    // Answers not consumed, e.g. behind a false condition, must not leak
+    // into later evaluations.
+    for (Item_func_semantic_filter *filter : m_filters) {
+      filter->set_prefetched_result(-1);
+    }
+
+    if (thd()->killed) {
+      thd()->send_kill_message();
+      return 1;
+    }
+
+    /* check for errors evaluating the conditions */
+    if (thd()->is_error()) return 1;
+
+    if (matched) {
+      return 0;
+    }
+  }
+}
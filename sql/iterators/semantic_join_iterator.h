@@ -0,0 +1,185 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#ifndef SQL_ITERATORS_SEMANTIC_JOIN_ITERATOR_H_
+#define SQL_ITERATORS_SEMANTIC_JOIN_ITERATOR_H_
+
+/**
+  @file
+  An iterator for inner joins on a SEMANTIC_JOIN() with embeddings, e.g.
+
+    SELECT ... FROM products p JOIN listings l
+      ON SEMANTIC_JOIN('Is the listing selling the product?',
+                       p.description, l.title, p.embedding, l.embedding)
+
+  Asking the model about every pair of rows is out of reach beyond small
+  tables. The embeddings block the join instead: only the pairs where the
+  inner row is among the semantic_join_neighbors nearest neighbours of the
+  outer row in the vector index on l.embedding are candidates.
+
+  A batch of outer rows is read into a buffer, and their knn searches are
+  handed to the storage engine as one batched search. The neighbours of
+  each outer row are read into the buffer as well, and the prompts of all
+  candidate pairs are sent to the model concurrently. The pairs are then
+  replayed, each semantic filter of the join conditions getting its answer
+  before the conditions are evaluated.
+
+  Outer rows without an embedding have no candidates. Rows come out grouped
+  by outer row, in the order of the outer input.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "my_alloc.h"
+#include "my_table_map.h"
+#include "sql/iterators/hash_join_buffer.h"
+#include "sql/iterators/row_iterator.h"
+#include "sql/mem_root_array.h"
+#include "sql/pack_rows.h"
+#include "sql_string.h"
+
+class Item;
+class Item_func_fb_vector_distance;
+class Item_func_semantic_filter;
+class THD;
+struct TABLE;
+
+class SemanticJoinIterator final : public RowIterator {
+ public:
+  /**
+    @param thd Thread handle.
+    @param outer_input The iterator to read the outer rows from.
+    @param outer_input_tables Each outer table involved.
+      Used to know which fields we are to read into our buffer.
+    @param inner_input_tables The inner table, read through the vector index.
+    @param join_conditions The join conditions, evaluated on each candidate
+      pair.
+    @param table The inner table.
+    @param idx The vector index on the embedding of the inner rows.
+    @param distance_func The distance between the embeddings. Its query
+      vector is evaluated on each buffered outer row, and its limit is the
+      number of neighbours read for each.
+    @param concurrency Most requests to the model in flight at once.
+    @param max_memory_available Number of bytes available for outer rows.
+    @param store_rowids Whether we need to make sure all tables below us have
+      row IDs available, after Read() has been called. Used only if
+      we are below a weedout operation.
+    @param tables_to_get_rowid_for A map of which tables SemanticJoinIterator
+      needs to call position() for itself.
+   */
+  SemanticJoinIterator(THD *thd,
+                       unique_ptr_destroy_only<RowIterator> outer_input,
+                       const Prealloced_array<TABLE *, 4> &outer_input_tables,
+                       const Prealloced_array<TABLE *, 4> &inner_input_tables,
+                       const Mem_root_array<Item *> &join_conditions,
+                       TABLE *table, unsigned idx,
+                       Item_func_fb_vector_distance *distance_func,
+                       size_t concurrency, size_t max_memory_available,
+                       bool store_rowids, table_map tables_to_get_rowid_for);
+
+  bool Init() override;
+
+  int Read() override;
+
+  void SetNullRowFlag(bool is_null_row) override;
+
+  void UnlockRow() override {
+    // Rows are buffered on both sides, so we cannot know whether their locks
+    // are still needed for other joined rows.
+  }
+
+  void EndPSIBatchModeIfStarted() override;
+
+ private:
+  /// An inner row among the neighbours of a buffered outer row.
+  struct Candidate {
+    uint32_t outer_row;
+    hash_join_buffer::BufferRow inner_row;
+  };
+
+  /// Clear out the buffers and prepare for reading rows anew.
+  void BeginNewBatch();
+
+  /// Read a batch of outer rows, collect the neighbours of each and get the
+  /// answers of the semantic filters on all candidate pairs. Returns -1 for
+  /// no outer rows found, 0 for OK or 1 for error.
+  int ReadBatch();
+
+  /// Read the neighbours of the outer row in the table buffers into the
+  /// buffer, along with the prompts of the candidate pairs. Returns 0 for OK
+  /// or 1 for error.
+  int ReadNeighbours(uint32_t outer_row, std::vector<std::string> *contexts,
+                     std::vector<size_t> *slots);
+
+  /// Make sure the inner table reads m_idx, searching for the query vector
+  /// of the outer row in the table buffers.
+  bool InitIndex();
+
+  const unique_ptr_destroy_only<RowIterator> m_outer_input;
+  std::vector<Item *> m_join_conditions;
+
+  /// The semantic filters of m_join_conditions.
+  std::vector<Item_func_semantic_filter *> m_filters;
+
+  TABLE *const m_table;
+  const unsigned m_idx;
+  Item_func_fb_vector_distance *const m_distance_func;
+  const size_t m_concurrency;
+
+  /// The MEM_ROOT we are storing the buffered rows on.
+  MEM_ROOT m_mem_root;
+
+  /// Buffered outer rows.
+  Mem_root_array<hash_join_buffer::BufferRow> m_outer_rows;
+
+  /// Query vectors of the buffered outer rows, handed to the engine.
+  std::vector<std::vector<float>> m_query_vectors;
+
+  /// Candidate pairs of the current batch, grouped by outer row.
+  std::vector<Candidate> m_candidates;
+  size_t m_next_candidate = 0;
+
+  /// Answer of each semantic filter on each candidate pair, pair-major.
+  /// -1 where the pair's own evaluation has to ask the model.
+  std::vector<int> m_results;
+
+  pack_rows::TableCollection m_outer_input_tables;
+  pack_rows::TableCollection m_inner_input_tables;
+
+  /// Holds the outer row that did not fit into the previous batch.
+  String m_row_buffer;
+
+  /// Used for serializing the neighbours before they are stored into the
+  /// MEM_ROOT.
+  String m_inner_row_buffer;
+
+  /// Whether we have a row in m_row_buffer from the previous batch.
+  bool m_has_row_from_previous_batch = false;
+
+  /// Whether the outer input has been read to the end.
+  bool m_end_of_outer_rows = false;
+
+  /// Estimated number of bytes used on m_mem_root so far.
+  size_t m_bytes_used = 0;
+
+  /// See max_memory_available in the constructor.
+  const size_t m_max_memory_available;
+};
+
+#endif  // SQL_ITERATORS_SEMANTIC_JOIN_ITERATOR_H_
@@ -0,0 +1,572 @@
+/*
+   Copyright (c) 2025, Jingyi Yang
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/iterators/spatial_join_iterator.h"
+
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <new>
+#include <utility>
+
+#include "my_base.h"
+#include "my_byteorder.h"
+#include "my_sys.h"
+#include "mysqld_error.h"
+#include "sql/handler.h"
+#include "sql/item.h"
+#include "sql/key.h"
+#include "sql/next_spatial_base.h"
+#include "sql/psi_memory_key.h"
+#include "sql/sql_class.h"
+#include "sql/sql_executor.h"
+#include "sql/table.h"
+
+using hash_join_buffer::BufferRow;
+using hash_join_buffer::LoadBufferRowIntoTableBuffers;
+
+/** most outer rows sorted and probed together in index nested loop mode */
+static constexpr size_t SPATIAL_JOIN_MAX_BATCH_ROWS = 1024;
+/** inner rows aimed for in each grid cell in partition mode */
+static constexpr size_t SPATIAL_JOIN_ROWS_PER_CELL = 8;
+/** most grid cells along each axis */
+static constexpr size_t SPATIAL_JOIN_MAX_GRID_SIZE = 1024;
+/** an inner row overlapping more cells is tested against every outer row */
+static constexpr size_t SPATIAL_JOIN_MAX_CELLS_PER_ROW = 64;
+
+template <class Mbr>
+static bool MbrsIntersect(const Mbr &a, const Mbr &b) {
+  return a[0] <= b[1] && b[0] <= a[1] && a[2] <= b[3] && b[2] <= a[3];
+}
+
+/** position of a box on a Z-order curve over the globe, 16 bits per axis */
+template <class Mbr>
+static uint32_t MbrZOrder(const Mbr &mbr) {
+  const auto scale = [](double value, double low, double high) {
+    const double unit = std::min(std::max((value - low) / (high - low), 0.0),
+                                 1.0);  // nan is 0
+    return static_cast<uint32_t>(unit * 0xffff);
+  };
+  const uint32_t y = scale((mbr[0] + mbr[1]) / 2, -90, 90);
+  const uint32_t x = scale((mbr[2] + mbr[3]) / 2, -180, 180);
+  uint32_t code = 0;
+  for (uint bit = 0; bit < 16; bit++) {
+    code |= ((x >> bit) & 1U) << (2 * bit);
+    code |= ((y >> bit) & 1U) << (2 * bit + 1);
+  }
+  return code;
+}
+
+SpatialJoinIterator::SpatialJoinIterator(
+    THD *thd, unique_ptr_destroy_only<RowIterator> outer_input,
+    const Prealloced_array<TABLE *, 4> &outer_input_tables,
+    unique_ptr_destroy_only<RowIterator> inner_input,
+    const Prealloced_array<TABLE *, 4> &inner_input_tables,
+    Item *outer_geometry, Item *inner_geometry, Item *radius,
+    const Mem_root_array<Item *> &join_conditions, TABLE *table, unsigned idx,
+    size_t max_memory_available, bool store_rowids,
+    table_map tables_to_get_rowid_for)
+    : RowIterator(thd),
+      m_outer_input(std::move(outer_input)),
+      m_inner_input(std::move(inner_input)),
+      m_outer_geometry(outer_geometry),
+      m_inner_geometry(inner_geometry),
+      m_radius(radius),
+      m_join_conditions(join_conditions.begin(), join_conditions.end()),
+      m_table(table),
+      m_idx(idx),
+      m_mem_root(key_memory_hash_join, 16384 /* 16 kB */),
+      m_rows(&m_mem_root),
+      m_outer_input_tables(outer_input_tables, store_rowids,
+                           tables_to_get_rowid_for,
+                           /*tables_to_store_contents_of_null_rows_for=*/0),
+      m_inner_input_tables(inner_input_tables, store_rowids,
+                           tables_to_get_rowid_for,
+                           /*tables_to_store_contents_of_null_rows_for=*/0),
+      m_max_memory_available(max_memory_available) {
+  assert(m_outer_input != nullptr);
+  assert((m_inner_input == nullptr) != (m_table == nullptr));
+  assert(m_outer_geometry != nullptr);
+  assert(m_inner_geometry != nullptr);
+  if (m_table != nullptr) {
+    // key images of geometries are their mbr, behind a null byte if the
+    // column is nullable
+    const KEY_PART_INFO &key_part = m_table->key_info[m_idx].key_part[0];
+    m_key.resize((key_part.null_bit ? 1 : 0) + 4 * sizeof(double), 0);
+  }
+}
+
+bool SpatialJoinIterator::Init() {
+  m_radius_value = 0;
+  if (m_radius != nullptr) {
+    const double radius = m_radius->val_real();
+    if (thd()->is_error()) return true;
+    if (m_radius->null_value) {
+      // the distance is never below NULL
+      m_state = State::END_OF_ROWS;
+      return false;
+    }
+    // leave room for the geodesic distance the server checks against
+    m_radius_value =
+        std::max(radius, 0.0) * (1 + NEXT_SPATIAL_DISTANCE_SLACK);
+  }
+
+  // we buffer the inner rows when partitioning, the outer ones otherwise
+  const pack_rows::TableCollection &buffered_tables =
+      m_table == nullptr ? m_inner_input_tables : m_outer_input_tables;
+  if (!buffered_tables.has_blob_column()) {
+    const size_t upper_row_size =
+        pack_rows::ComputeRowSizeUpperBound(buffered_tables);
+    if (m_row_buffer.reserve(upper_row_size)) {
+      my_error(ER_OUTOFMEMORY, MYF(0), upper_row_size);
+      return true;
+    }
+  }
+  PrepareForRequestRowId(m_outer_input_tables.tables(),
+                         m_outer_input_tables.tables_to_get_rowid_for());
+  PrepareForRequestRowId(m_inner_input_tables.tables(),
+                         m_inner_input_tables.tables_to_get_rowid_for());
+
+  BeginNewBatch();
+  m_has_row_from_previous_batch = false;
+  m_end_of_buffered_input = false;
+
+  if (m_table != nullptr) {
+    if (InitIndex()) return true;
+    m_state = State::READING_OUTER_BATCH;
+    return m_outer_input->Init();
+  }
+  m_state = State::READING_INNER_ROWS;
+  return m_inner_input->Init();
+}
+
+void SpatialJoinIterator::SetNullRowFlag(bool is_null_row) {
+  m_outer_input->SetNullRowFlag(is_null_row);
+  if (m_inner_input != nullptr) {
+    m_inner_input->SetNullRowFlag(is_null_row);
+  } else if (is_null_row) {
+    m_table->set_null_row();
+  } else {
+    m_table->reset_null_row();
+  }
+}
+
+void SpatialJoinIterator::EndPSIBatchModeIfStarted() {
+  m_outer_input->EndPSIBatchModeIfStarted();
+  if (m_inner_input != nullptr) {
+    m_inner_input->EndPSIBatchModeIfStarted();
+  } else {
+    m_table->file->end_psi_batch_mode_if_started();
+  }
+}
+
+void SpatialJoinIterator::BeginNewBatch() {
+  m_mem_root.ClearForReuse();
+  new (&m_rows) Mem_root_array<BufferRow>(&m_mem_root);
+  m_mbrs.clear();
+  m_has_mbr.clear();
+  m_bytes_used = 0;
+  m_grid_size = 0;
+  m_cells.clear();
+  m_wide_rows.clear();
+  m_candidates.clear();
+  m_next_candidate = 0;
+  m_probe_order.clear();
+  m_next_probe = 0;
+}
+
+int SpatialJoinIterator::ComputeMbr(Item *geometry, double radius, Mbr *mbr) {
+  String buffer;
+  const String *wkb = geometry->val_str(&buffer);
+  if (thd()->is_error()) return 2;
+  if (wkb == nullptr) return -1;
+  // only points, multipoints and polygons are parsed; any other geometry
+  // is compared with every row of the other side
+  Next_spatial_query_geometry parsed;
+  if (parsed.parse(wkb->ptr(), wkb->length())) return 1;
+  const std::vector<double> box = parsed.mbr(radius);
+  std::copy(box.begin(), box.end(), mbr->begin());
+  return 0;
+}
+
+int SpatialJoinIterator::ConditionsHold() {
+  for (Item *cond : m_join_conditions) {
+    const bool matched = cond->val_int() != 0;
+    if (thd()->is_error()) return -1;
+    if (!matched) return 0;
+  }
+  return 1;
+}
+
+int SpatialJoinIterator::ReadRowsIntoBuffer(
+    RowIterator *input, const pack_rows::TableCollection &tables,
+    Item *geometry, double radius, size_t max_rows) {
+  while (!m_end_of_buffered_input && m_rows.size() < max_rows) {
+    thd()->check_yield();
+    if (m_has_row_from_previous_batch) {
+      // The row is in m_row_buffer already, but the table buffers have been
+      // overwritten since. Load it back so its geometry can be evaluated.
+      m_has_row_from_previous_batch = false;
+      LoadBufferRowIntoTableBuffers(
+          tables,
+          hash_join_buffer::Key(m_row_buffer.ptr(), m_row_buffer.length()));
+    } else {
+      const int result = input->Read();
+      if (result == 1) {
+        // Error.
+        return 1;
+      }
+      if (result == -1) {
+        // EOF.
+        m_end_of_buffered_input = true;
+        break;
+      }
+      RequestRowId(tables.tables(), tables.tables_to_get_rowid_for());
+
+      // Save the contents of all columns marked for reading.
+      if (StoreFromTableBuffers(tables, &m_row_buffer)) {
+        return 1;
+      }
+    }
+
+    // See if we have room for this row without going over our total RAM
+    // budget. (We ignore the budget if the buffer is empty; at least a
+    // single row must be allowed at all times.)
+    const size_t row_size = m_row_buffer.length();
+    const size_t bytes_per_row = sizeof(BufferRow) + sizeof(Mbr) + 1;
+    if (!m_rows.empty() &&
+        m_bytes_used + row_size + bytes_per_row > m_max_memory_available) {
+      // This row will be dealt with in the next chunk or batch.
+      m_has_row_from_previous_batch = true;
+      break;
+    }
+
+    Mbr mbr{};
+    const int mbr_result = ComputeMbr(geometry, radius, &mbr);
+    if (mbr_result == 2) return 1;
+    // a NULL geometry matches nothing in an inner join
+    if (mbr_result == -1) continue;
+
+    char *row = m_mem_root.ArrayAlloc<char>(row_size);
+    if (row == nullptr) {
+      return 1;
+    }
+    memcpy(row, m_row_buffer.ptr(), row_size);
+    m_rows.push_back(BufferRow(row, row_size));
+    m_mbrs.push_back(mbr);
+    m_has_mbr.push_back(mbr_result == 0);
+    m_bytes_used += row_size + bytes_per_row;
+  }
+  return m_rows.empty() ? -1 : 0;
+}
+
+size_t SpatialJoinIterator::GridIndex(double value, double low,
+                                      double high) const {
+  if (!(high > low)) return 0;
+  const double index =
+      std::floor((value - low) / (high - low) * static_cast<double>(m_grid_size));
+  if (!(index > 0)) return 0;
+  return std::min(static_cast<size_t>(index), m_grid_size - 1);
+}
+
+size_t SpatialJoinIterator::CellOf(double y, double x) const {
+  return GridIndex(y, m_grid_bounds[0], m_grid_bounds[1]) * m_grid_size +
+         GridIndex(x, m_grid_bounds[2], m_grid_bounds[3]);
+}
+
+int SpatialJoinIterator::ReadInnerRows() {
+  BeginNewBatch();
+  const int result =
+      ReadRowsIntoBuffer(m_inner_input.get(), m_inner_input_tables,
+                         m_inner_geometry, /*radius=*/0,
+                         std::numeric_limits<uint32_t>::max());
+  if (result != 0) {
+    return result;
+  }
+
+  bool has_bounds = false;
+  for (size_t i = 0; i < m_rows.size(); i++) {
+    if (!m_has_mbr[i]) continue;
+    const Mbr &mbr = m_mbrs[i];
+    if (!has_bounds) {
+      m_grid_bounds = mbr;
+      has_bounds = true;
+      continue;
+    }
+    m_grid_bounds[0] = std::min(m_grid_bounds[0], mbr[0]);
+    m_grid_bounds[1] = std::max(m_grid_bounds[1], mbr[1]);
+    m_grid_bounds[2] = std::min(m_grid_bounds[2], mbr[2]);
+    m_grid_bounds[3] = std::max(m_grid_bounds[3], mbr[3]);
+  }
+
+  if (has_bounds) {
+    const double cells_per_axis =
+        std::ceil(std::sqrt(static_cast<double>(m_rows.size()) /
+                            SPATIAL_JOIN_ROWS_PER_CELL));
+    m_grid_size = std::min(
+        std::max(static_cast<size_t>(cells_per_axis), size_t{1}),
+        SPATIAL_JOIN_MAX_GRID_SIZE);
+    m_cells.resize(m_grid_size * m_grid_size);
+  }
+  for (uint32_t i = 0; i < m_rows.size(); i++) {
+    if (!m_has_mbr[i]) {
+      m_wide_rows.push_back(i);
+      continue;
+    }
+    const Mbr &mbr = m_mbrs[i];
+    const size_t y_first = GridIndex(mbr[0], m_grid_bounds[0], m_grid_bounds[1]);
+    const size_t y_last = GridIndex(mbr[1], m_grid_bounds[0], m_grid_bounds[1]);
+    const size_t x_first = GridIndex(mbr[2], m_grid_bounds[2], m_grid_bounds[3]);
+    const size_t x_last = GridIndex(mbr[3], m_grid_bounds[2], m_grid_bounds[3]);
+    if ((y_last - y_first + 1) * (x_last - x_first + 1) >
+        SPATIAL_JOIN_MAX_CELLS_PER_ROW) {
+      m_wide_rows.push_back(i);
+      continue;
+    }
+    for (size_t y = y_first; y <= y_last; y++) {
+      for (size_t x = x_first; x <= x_last; x++) {
+        m_cells[y * m_grid_size + x].push_back(i);
+      }
+    }
+  }
+
+  // every chunk of inner rows is joined with all of the outer rows
+  if (m_outer_input->Init()) {
+    return 1;
+  }
+  return 0;
+}
+
+void SpatialJoinIterator::CollectCandidates(int mbr_result, const Mbr &mbr) {
+  m_candidates.clear();
+  m_next_candidate = 0;
+  if (mbr_result != 0) {
+    for (uint32_t i = 0; i < m_rows.size(); i++) {
+      m_candidates.push_back(i);
+    }
+    return;
+  }
+
+  for (uint32_t i : m_wide_rows) {
+    if (!m_has_mbr[i] || MbrsIntersect(mbr, m_mbrs[i])) {
+      m_candidates.push_back(i);
+    }
+  }
+  if (m_grid_size == 0 || !MbrsIntersect(mbr, m_grid_bounds)) return;
+
+  const size_t y_first = GridIndex(mbr[0], m_grid_bounds[0], m_grid_bounds[1]);
+  const size_t y_last = GridIndex(mbr[1], m_grid_bounds[0], m_grid_bounds[1]);
+  const size_t x_first = GridIndex(mbr[2], m_grid_bounds[2], m_grid_bounds[3]);
+  const size_t x_last = GridIndex(mbr[3], m_grid_bounds[2], m_grid_bounds[3]);
+  for (size_t y = y_first; y <= y_last; y++) {
+    for (size_t x = x_first; x <= x_last; x++) {
+      const size_t cell = y * m_grid_size + x;
+      for (uint32_t i : m_cells[cell]) {
+        const Mbr &inner_mbr = m_mbrs[i];
+        if (!MbrsIntersect(mbr, inner_mbr)) continue;
+        // a pair sharing several cells is taken in one of them only, the
+        // one holding the lower corner of the intersection of its boxes
+        if (CellOf(std::max(mbr[0], inner_mbr[0]),
+                   std::max(mbr[2], inner_mbr[2])) != cell) {
+          continue;
+        }
+        m_candidates.push_back(i);
+      }
+    }
+  }
+}
+
+bool SpatialJoinIterator::InitIndex() {
+  handler *const file = m_table->file;
+  if (file->inited == handler::INDEX && file->active_index == m_idx) {
+    return false;
+  }
+  if (file->inited != handler::NONE) {
+    file->ha_index_or_rnd_end();
+  }
+  const int error = file->ha_index_init(m_idx, /*sorted=*/false);
+  if (error) {
+    file->print_error(error, MYF(0));
+    return true;
+  }
+  return false;
+}
+
+int SpatialJoinIterator::ReadOuterBatch() {
+  BeginNewBatch();
+  const int result = ReadRowsIntoBuffer(m_outer_input.get(),
+                                        m_outer_input_tables, m_outer_geometry,
+                                        m_radius_value,
+                                        SPATIAL_JOIN_MAX_BATCH_ROWS);
+  if (result != 0) {
+    return result;
+  }
+
+  // probe neighbouring boxes one after the other, they read nearby key
+  // ranges of the index
+  std::vector<std::pair<uint32_t, uint32_t>> codes;
+  codes.reserve(m_rows.size());
+  for (uint32_t i = 0; i < m_rows.size(); i++) {
+    codes.emplace_back(m_has_mbr[i] ? MbrZOrder(m_mbrs[i]) : 0, i);
+  }
+  std::sort(codes.begin(), codes.end());
+  for (const auto &code : codes) {
+    m_probe_order.push_back(code.second);
+  }
+  return 0;
+}
+
+int SpatialJoinIterator::ProbeIndex(bool first) {
+  handler *const file = m_table->file;
+  int error;
+  if (first) {
+    const uint32_t row = m_probe_order[m_next_probe - 1];
+    // a geometry without a box can be anywhere on the globe
+    const Mbr box = m_has_mbr[row] ? m_mbrs[row] : Mbr{-90, 90, -180, 180};
+    // key images of geometries are their mbr: longitude range, then
+    // latitude range
+    uchar *const key = m_key.data() + m_key.size() - 4 * sizeof(double);
+    float8store(key, box[2]);
+    float8store(key + 8, box[3]);
+    float8store(key + 16, box[0]);
+    float8store(key + 24, box[1]);
+    error = file->ha_index_read_map(m_table->record[0], m_key.data(),
+                                    HA_WHOLE_KEY, HA_READ_MBR_INTERSECT);
+  } else {
+    error = file->ha_index_next(m_table->record[0]);
+  }
+  if (error == 0) {
+    RequestRowId(m_inner_input_tables.tables(),
+                 m_inner_input_tables.tables_to_get_rowid_for());
+    return 0;
+  }
+
+  if (thd()->killed) {
+    thd()->send_kill_message();
+    return 1;
+  }
+  if (error == HA_ERR_END_OF_FILE || error == HA_ERR_KEY_NOT_FOUND) {
+    m_table->set_no_row();
+    return -1;
+  }
+  file->print_error(error, MYF(0));
+  return 1;
+}
+
+int SpatialJoinIterator::Read() {
+  for (;;) {  // Termination condition within loop.
+    switch (m_state) {
+      case State::END_OF_ROWS:
+        return -1;
+      case State::READING_INNER_ROWS: {
+        const int err = ReadInnerRows();
+        if (err == 1) {
+          return 1;
+        }
+        if (err == -1) {
+          m_state = State::END_OF_ROWS;
+          return -1;
+        }
+        m_state = State::READING_OUTER_ROW;
+        break;
+      }
+      case State::READING_OUTER_ROW: {
+        const int result = m_outer_input->Read();
+        if (result == 1) {
+          return 1;
+        }
+        if (result == -1) {
+          // Done with this chunk of inner rows; join the next one, if any.
+          m_state = (!m_end_of_buffered_input || m_has_row_from_previous_batch)
+                        ? State::READING_INNER_ROWS
+                        : State::END_OF_ROWS;
+          break;
+        }
+        RequestRowId(m_outer_input_tables.tables(),
+                     m_outer_input_tables.tables_to_get_rowid_for());
+        Mbr mbr{};
+        const int mbr_result =
+            ComputeMbr(m_outer_geometry, m_radius_value, &mbr);
+        if (mbr_result == 2) {
+          return 1;
+        }
+        if (mbr_result == -1) {
+          break;
+        }
+        CollectCandidates(mbr_result, mbr);
+        m_state = State::READING_CANDIDATES;
+        break;
+      }
+      case State::READING_CANDIDATES: {
+        while (m_next_candidate < m_candidates.size()) {
+          const uint32_t i = m_candidates[m_next_candidate++];
+          LoadBufferRowIntoTableBuffers(m_inner_input_tables, m_rows[i]);
+          const int hold = ConditionsHold();
+          if (hold != 0) {
+            return hold == 1 ? 0 : 1;
+          }
+        }
+        m_state = State::READING_OUTER_ROW;
+        break;
+      }
+      case State::READING_OUTER_BATCH: {
+        const int err = ReadOuterBatch();
+        if (err == 1) {
+          return 1;
+        }
+        if (err == -1) {
+          m_state = State::END_OF_ROWS;
+          return -1;
+        }
+        m_state = State::PROBING_OUTER_ROW;
+        break;
+      }
+      case State::PROBING_OUTER_ROW: {
+        if (m_next_probe == m_probe_order.size()) {
+          // Batch done; read more outer rows unless there are none left.
+          m_state = (!m_end_of_buffered_input || m_has_row_from_previous_batch)
+                        ? State::READING_OUTER_BATCH
+                        : State::END_OF_ROWS;
+          break;
+        }
+        m_outer_input->SetNullRowFlag(false);
+        LoadBufferRowIntoTableBuffers(m_outer_input_tables,
+                                      m_rows[m_probe_order[m_next_probe++]]);
+        m_probe_started = false;
+        m_state = State::READING_INDEX_ROWS;
+        break;
+      }
+      case State::READING_INDEX_ROWS: {
+        const int err = ProbeIndex(!m_probe_started);
+        m_probe_started = true;
+        if (err == 1) {
+          return 1;
+        }
+        if (err == -1) {
+          m_state = State::PROBING_OUTER_ROW;
+          break;
+        }
+        const int hold = ConditionsHold();
+        if (hold != 0) {
+          return hold == 1 ? 0 : 1;
+        }
+        break;
+      }
+    }
+  }
+}
@@ -0,0 +1,257 @@
+/*
+   Copyright (c) 2025, Jingyi Yang
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#ifndef SQL_ITERATORS_SPATIAL_JOIN_ITERATOR_H_
+#define SQL_ITERATORS_SPATIAL_JOIN_ITERATOR_H_
+
+/**
+  @file
+  An iterator for inner joins on a spatial predicate, e.g.
+
+    SELECT ... FROM pois p JOIN regions r ON ST_Intersects(p.g, r.g)
+    SELECT ... FROM a JOIN b ON ST_Distance(a.g, b.g) < 100
+
+  Both predicates only hold where the bounding boxes of the two geometries,
+  one of them widened by the distance bound, meet. The iterator uses that to
+  avoid comparing every pair of rows, in one of two modes:
+
+  - Index nested loop: the inner table has a next spatial index on its
+    geometry. A batch of outer rows is read into a buffer and sorted along a
+    Z-order curve of their boxes, so that consecutive probes of the index
+    read nearby key ranges. Each outer row then reads the index entries in
+    its box.
+
+  - Partition: neither side is indexed. The inner rows are read into a
+    buffer and spread over a grid laid over their boxes. Each outer row only
+    meets the inner rows of the grid cells its box overlaps. A pair of boxes
+    sharing several cells is only reported in the cell holding the lower
+    corner of their intersection. If the inner rows do not fit in memory,
+    they are processed in chunks, and the outer input is read once for each
+    chunk.
+
+  The join conditions are evaluated on every candidate pair, so the result
+  is exact. Rows come out in no particular order.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <vector>
+
+#include "my_alloc.h"
+#include "my_table_map.h"
+#include "sql/iterators/hash_join_buffer.h"
+#include "sql/iterators/row_iterator.h"
+#include "sql/mem_root_array.h"
+#include "sql/pack_rows.h"
+#include "sql_string.h"
+
+class Item;
+class THD;
+struct TABLE;
+
+class SpatialJoinIterator final : public RowIterator {
+ public:
+  /**
+    @param thd Thread handle.
+    @param outer_input The iterator to read the outer rows from.
+    @param outer_input_tables Each outer table involved.
+      Used to know which fields we are to read into our buffer.
+    @param inner_input The iterator to read the inner rows from, used in
+      partition mode only. nullptr in index nested loop mode.
+    @param inner_input_tables Each inner table involved.
+    @param outer_geometry The geometry of the spatial predicate that is
+      evaluated on the outer rows.
+    @param inner_geometry The geometry of the spatial predicate that is
+      evaluated on the inner rows.
+    @param radius The upper bound on the distance between the geometries,
+      or nullptr if the geometries must intersect.
+    @param join_conditions The join conditions, evaluated on each pair of
+      rows whose boxes meet.
+    @param table In index nested loop mode, the inner table. nullptr in
+      partition mode.
+    @param idx In index nested loop mode, the next spatial index on
+      inner_geometry.
+    @param max_memory_available Number of bytes available for buffered rows.
+    @param store_rowids Whether we need to make sure all tables below us have
+      row IDs available, after Read() has been called. Used only if
+      we are below a weedout operation.
+    @param tables_to_get_rowid_for A map of which tables SpatialJoinIterator
+      needs to call position() for itself.
+   */
+  SpatialJoinIterator(THD *thd,
+                      unique_ptr_destroy_only<RowIterator> outer_input,
+                      const Prealloced_array<TABLE *, 4> &outer_input_tables,
+                      unique_ptr_destroy_only<RowIterator> inner_input,
+                      const Prealloced_array<TABLE *, 4> &inner_input_tables,
+                      Item *outer_geometry, Item *inner_geometry, Item *radius,
+                      const Mem_root_array<Item *> &join_conditions,
+                      TABLE *table, unsigned idx, size_t max_memory_available,
+                      bool store_rowids, table_map tables_to_get_rowid_for);
+
+  bool Init() override;
+
+  int Read() override;
+
+  void SetNullRowFlag(bool is_null_row) override;
+
+  void UnlockRow() override {
+    // Rows are buffered on at least one side, so we cannot know whether
+    // their locks are still needed for other joined rows.
+  }
+
+  void EndPSIBatchModeIfStarted() override;
+
+ private:
+  // Bounding box of a geometry: latitude (y) range, then longitude (x) range.
+  using Mbr = std::array<double, 4>;
+
+  enum class State {
+    /// Read the next chunk of inner rows into the grid (partition mode).
+    READING_INNER_ROWS,
+    /// Read the next outer row and collect its candidates (partition mode).
+    READING_OUTER_ROW,
+    /// Read the next batch of outer rows into the buffer (index mode).
+    READING_OUTER_BATCH,
+    /// Load the next buffered outer row and probe the index (index mode).
+    PROBING_OUTER_ROW,
+    /// Test the index entries in the box of the current outer row (index
+    /// mode).
+    READING_INDEX_ROWS,
+    /// Test the candidates of the current outer row (partition mode).
+    READING_CANDIDATES,
+    END_OF_ROWS
+  };
+
+  /**
+    Box of the geometry of the current row, widened by the distance bound.
+    @retval 0 the geometry has a box
+    @retval -1 the geometry is NULL, the row cannot match
+    @retval 1 the box is not known, the row can match anything
+    @retval 2 error
+   */
+  int ComputeMbr(Item *geometry, double radius, Mbr *mbr);
+
+  /// Evaluate the join conditions on the current pair of rows.
+  /// @returns 1 if they hold, 0 if not, -1 on error.
+  int ConditionsHold();
+
+  /// Read rows from input into the buffer along with the boxes of their
+  /// geometries, until max_rows or the memory budget is reached. Returns -1
+  /// if no row was buffered, 0 for OK or 1 for error.
+  int ReadRowsIntoBuffer(RowIterator *input,
+                         const pack_rows::TableCollection &tables,
+                         Item *geometry, double radius, size_t max_rows);
+
+  /// Read the next chunk of inner rows and spread them over the grid.
+  /// Returns -1 if there are no inner rows left, 0 for OK, 1 for error.
+  int ReadInnerRows();
+
+  /// Collect the inner rows whose boxes meet the box of the outer row.
+  void CollectCandidates(int mbr_result, const Mbr &mbr);
+
+  /// Row or column of the grid holding a coordinate, clamped to the grid.
+  size_t GridIndex(double value, double low, double high) const;
+
+  /// The grid cell of a point, clamped to the grid.
+  size_t CellOf(double y, double x) const;
+
+  /// Clear out the outer row buffer and prepare for reading rows anew.
+  void BeginNewBatch();
+
+  /// Read a batch of outer rows, index mode. Returns -1 for no outer rows
+  /// found, 0 for OK or 1 for error.
+  int ReadOuterBatch();
+
+  /// Read the first index entry in the box of the current outer row, or the
+  /// next one. Returns -1 when there are no more, 0 for OK or 1 for error.
+  int ProbeIndex(bool first);
+
+  /// Make sure the inner table reads m_idx.
+  bool InitIndex();
+
+  State m_state;
+
+  const unique_ptr_destroy_only<RowIterator> m_outer_input;
+  const unique_ptr_destroy_only<RowIterator> m_inner_input;
+
+  Item *const m_outer_geometry;
+  Item *const m_inner_geometry;
+  Item *const m_radius;
+  std::vector<Item *> m_join_conditions;
+
+  TABLE *const m_table;
+  const unsigned m_idx;
+
+  /// The distance bound, evaluated once per Init().
+  double m_radius_value = 0;
+
+  /// The MEM_ROOT we are storing the buffered rows on.
+  MEM_ROOT m_mem_root;
+
+  /// Buffered rows, inner rows in partition mode and outer rows in index
+  /// mode.
+  Mem_root_array<hash_join_buffer::BufferRow> m_rows;
+
+  /// Box of each buffered row.
+  std::vector<Mbr> m_mbrs;
+
+  /// Whether each buffered row has a box.
+  std::vector<bool> m_has_mbr;
+
+  pack_rows::TableCollection m_outer_input_tables;
+  pack_rows::TableCollection m_inner_input_tables;
+
+  /// Holds the row that did not fit into the previous chunk or batch.
+  String m_row_buffer;
+
+  /// Whether we have a row in m_row_buffer from the previous chunk or batch.
+  bool m_has_row_from_previous_batch = false;
+
+  /// Whether the input we buffer from has been read to the end.
+  bool m_end_of_buffered_input = false;
+
+  /// Estimated number of bytes used on m_mem_root so far.
+  size_t m_bytes_used = 0;
+
+  /// See max_memory_available in the constructor.
+  const size_t m_max_memory_available;
+
+  /// Grid over the boxes of the inner rows, partition mode.
+  size_t m_grid_size = 0;
+  Mbr m_grid_bounds{};
+  std::vector<std::vector<uint32_t>> m_cells;
+
+  /// Inner rows without a box or spanning too many cells, tested against
+  /// every outer row.
+  std::vector<uint32_t> m_wide_rows;
+
+  /// Inner rows to test against the current outer row.
+  std::vector<uint32_t> m_candidates;
+  size_t m_next_candidate = 0;
+
+  /// Buffered outer rows in probe order, index mode.
+  std::vector<uint32_t> m_probe_order;
+  size_t m_next_probe = 0;
+
+  /// Whether the index has been positioned for the current outer row.
+  bool m_probe_started = false;
+
+  /// Key image of the box probed in the index.
+  std::vector<uchar> m_key;
+};
+
+#endif  // SQL_ITERATORS_SPATIAL_JOIN_ITERATOR_H_
@@ -28,6 +28,7 @@
 #include <chrono>
 
 #include "my_alloc.h"
+#include "sql/handler.h"
 #include "sql/iterators/row_iterator.h"
 #include "sql/sql_class.h"
 #include "sql/sql_lex.h"
@@ -68,6 +69,48 @@ class IteratorProfilerImpl final : public IteratorProfiler {
   uint64_t GetNumInitCalls() const override { return m_num_init_calls; }
   uint64_t GetNumRows() const override { return m_num_rows; }
 
+  bool GetEngineCounters(ha_engine_counters *counters) const override {
+    if (!m_engine_measured) return false;
+    for (const auto counter : kEngineCounters) {
+      counters->*counter =
+          m_engine_total.*counter >= m_engine_children.*counter
+              ? m_engine_total.*counter - m_engine_children.*counter
+              : 0;
+    }
+    return true;
+  }
+
+  /**
+     Charges the work the storage engines did during one call to Init() or
+     Read() to a profiler. The same work is taken off the profiler of the
+     iterator making the call, so that each iterator shows its own work.
+  */
+  class EngineScope {
+   public:
+    EngineScope(THD *thd, IteratorProfilerImpl *profiler)
+        : m_thd(thd), m_profiler(profiler), m_caller(s_running) {
+      ha_get_engine_counters(thd, &m_start);
+      s_running = profiler;
+    }
+
+    ~EngineScope() {
+      ha_engine_counters end;
+      ha_get_engine_counters(m_thd, &end);
+      m_profiler->m_engine_measured = true;
+      AddDifference(m_start, end, &m_profiler->m_engine_total);
+      if (m_caller != nullptr) {
+        AddDifference(m_start, end, &m_caller->m_engine_children);
+      }
+      s_running = m_caller;
+    }
+
+   private:
+    THD *const m_thd;
+    IteratorProfilerImpl *const m_profiler;
+    IteratorProfilerImpl *const m_caller;
+    ha_engine_counters m_start;
+  };
+
   /** Mark the end of an iterator->Init() call.*/
   void StopInit(TimeStamp start_time) {
     m_elapsed_first_row += Now() - start_time;
@@ -106,6 +149,32 @@ class IteratorProfilerImpl final : public IteratorProfiler {
     return std::chrono::duration<double>(dur).count() * 1e3;
   }
 
+  static constexpr ulonglong ha_engine_counters::*kEngineCounters[] = {
+      &ha_engine_counters::block_reads,
+      &ha_engine_counters::block_read_bytes,
+      &ha_engine_counters::block_cache_hits,
+      &ha_engine_counters::bloom_checks,
+      &ha_engine_counters::seeks,
+      &ha_engine_counters::nexts,
+      &ha_engine_counters::decode_ns};
+
+  /**
+     Add end - start to *sum. An engine may reset its counters between two
+     readings, such a difference is dropped.
+  */
+  static void AddDifference(const ha_engine_counters &start,
+                            const ha_engine_counters &end,
+                            ha_engine_counters *sum) {
+    for (const auto counter : kEngineCounters) {
+      if (end.*counter >= start.*counter) {
+        sum->*counter += end.*counter - start.*counter;
+      }
+    }
+  }
+
+  /** The profiler whose Init() or Read() is running on this thread.*/
+  static inline thread_local IteratorProfilerImpl *s_running = nullptr;
+
   /** The number of loops.*/
   uint64_t m_num_init_calls{0};
 
@@ -126,6 +195,15 @@ class IteratorProfilerImpl final : public IteratorProfiler {
       row.
   */
   duration m_elapsed_other_rows{0};
+
+  /** True if the work of the storage engines was measured.*/
+  bool m_engine_measured{false};
+
+  /** Work of the storage engines during Init() and Read() (all loops).*/
+  ha_engine_counters m_engine_total;
+
+  /** The part of m_engine_total done by the iterators read from.*/
+  ha_engine_counters m_engine_children;
 };
 
 /**
@@ -164,6 +242,7 @@ class TimingIterator final : public RowIterator {
   bool Init() override {
     const IteratorProfilerImpl::TimeStamp start_time =
         IteratorProfilerImpl::Now();
+    const IteratorProfilerImpl::EngineScope engine_scope(thd(), &m_profiler);
     bool err = m_iterator.Init();
     m_profiler.StopInit(start_time);
     return err;
@@ -172,6 +251,7 @@ class TimingIterator final : public RowIterator {
   int Read() override {
     const IteratorProfilerImpl::TimeStamp start_time =
         IteratorProfilerImpl::Now();
+    const IteratorProfilerImpl::EngineScope engine_scope(thd(), &m_profiler);
     int err = m_iterator.Read();
     m_profiler.StopRead(start_time, err == 0);
     return err;
@@ -32,8 +32,12 @@
 #include "sql/iterators/composite_iterators.h"
 #include "sql/iterators/delete_rows_iterator.h"
 #include "sql/iterators/hash_join_iterator.h"
+#include "sql/iterators/knn_join_iterator.h"
 #include "sql/iterators/ref_row_iterators.h"
+#include "sql/iterators/semantic_filter_iterator.h"
+#include "sql/iterators/semantic_join_iterator.h"
 #include "sql/iterators/sorting_iterator.h"
+#include "sql/iterators/spatial_join_iterator.h"
 #include "sql/iterators/timing_iterator.h"
 #include "sql/iterators/window_iterators.h"
 #include "sql/join_optimizer/bit_utils.h"
@@ -54,6 +58,7 @@
 #include "sql/range_optimizer/range_optimizer.h"
 #include "sql/range_optimizer/reverse_index_range_scan.h"
 #include "sql/range_optimizer/rowid_ordered_retrieval.h"
+#include "sql/semantic_base.h"
 #include "sql/sql_optimizer.h"
 #include "sql/sql_update.h"
 #include "sql/table.h"
@@ -305,6 +310,50 @@ bool ShouldEnableBatchMode(AccessPath *path) {
   }
 }
 
+/**
+  Whether a filter should read rows ahead to send the requests of its
+  semantic functions together, see SemanticFilterIterator. Only plain
+  SELECTs do; updates and deletes need the handler positioned on the
+  filtered row.
+ */
+/**
+  Most rows a LIMIT right above the given filter reads from it, or
+  HA_POS_ERROR if there is no such LIMIT.
+ */
+static ha_rows RowsNeededByLimit(const JOIN *join, const AccessPath *filter) {
+  if (join == nullptr) return HA_POS_ERROR;
+  const AccessPath *root = join->root_access_path();
+  if (root == nullptr || root->type != AccessPath::LIMIT_OFFSET ||
+      root->limit_offset().child != filter ||
+      root->limit_offset().count_all_rows) {
+    return HA_POS_ERROR;
+  }
+  return root->limit_offset().limit;
+}
+
+static bool UseSemanticFilterIterator(THD *thd, Item *condition) {
+  if (!SEMANTICDB_ENABLED || thd->variables.semantic_filter_batch_size <= 1 ||
+      thd->lex->sql_command != SQLCOM_SELECT) {
+    return false;
+  }
+  return WalkItem(condition, enum_walk::PREFIX, [](Item *item) {
+    if (item->type() != Item::FUNC_ITEM) return false;
+    const Item_func *func = down_cast<Item_func *>(item);
+    switch (func->functype()) {
+      case Item_func::SEMANTIC_FILTER_SINGLE_COL:
+      case Item_func::SEMANTIC_FILTER_TWO_COL:
+      case Item_func::SEMANTIC_JOIN:
+        return true;
+      case Item_func::SEMANTIC_RANK:
+        return !func->arguments()[1]->const_for_execution();
+      case Item_func::SEMANTIC_EMBED:
+        return !func->arguments()[0]->const_for_execution();
+      default:
+        return false;
+    }
+  });
+}
+
 bool FinalizeMaterializedSubqueries(THD *thd, JOIN *join, AccessPath *path) {
   if (path->type != AccessPath::FILTER ||
       !path->filter().materialize_subqueries) {
@@ -756,6 +805,22 @@ unique_ptr_destroy_only<RowIterator> CreateIteratorFromAccessPath(
             param.tables_to_get_rowid_for, mrr_iterator, param.join_type);
         break;
       }
+      case AccessPath::KNN_JOIN: {
+        const auto &param = path->knn_join();
+        if (job.children.is_null()) {
+          SetupJobsForChildren(mem_root, param.outer, param.inner, join,
+                               /*inner_eligible_for_batch_mode=*/false, &job,
+                               &todo);
+          continue;
+        }
+        iterator = NewIterator<KnnJoinIterator>(
+            thd, mem_root, std::move(job.children[0]),
+            GetUsedTables(param.outer, /*include_pruned_tables=*/true),
+            std::move(job.children[1]), param.table, param.idx,
+            param.distance_func, thd->variables.join_buff_size,
+            param.store_rowids, param.tables_to_get_rowid_for);
+        break;
+      }
       case AccessPath::HASH_JOIN: {
         const auto &param = path->hash_join();
         if (job.children.is_null()) {
@@ -837,6 +902,56 @@ unique_ptr_destroy_only<RowIterator> CreateIteratorFromAccessPath(
             hash_table_generation);
         break;
       }
+      case AccessPath::SPATIAL_JOIN: {
+        const auto &param = path->spatial_join();
+        const SpatialJoinParameters &spatial = *param.param;
+        if (job.children.is_null()) {
+          // probing an index reads the inner table itself
+          if (spatial.table != nullptr) {
+            SetupJobsForChildren(mem_root, param.outer, join,
+                                 /*eligible_for_batch_mode=*/false, &job,
+                                 &todo);
+          } else {
+            SetupJobsForChildren(mem_root, param.outer, param.inner, join,
+                                 /*inner_eligible_for_batch_mode=*/false,
+                                 &job, &todo);
+          }
+          continue;
+        }
+        unique_ptr_destroy_only<RowIterator> inner;
+        if (spatial.table == nullptr) {
+          inner = std::move(job.children[1]);
+        }
+        iterator = NewIterator<SpatialJoinIterator>(
+            thd, mem_root, std::move(job.children[0]),
+            GetUsedTables(param.outer, /*include_pruned_tables=*/true),
+            std::move(inner),
+            GetUsedTables(param.inner, /*include_pruned_tables=*/true),
+            spatial.outer_geometry, spatial.inner_geometry, spatial.radius,
+            param.join_predicate->expr->join_conditions, spatial.table,
+            spatial.idx, thd->variables.join_buff_size, param.store_rowids,
+            param.tables_to_get_rowid_for);
+        break;
+      }
+      case AccessPath::SEMANTIC_JOIN: {
+        const auto &param = path->semantic_join();
+        if (job.children.is_null()) {
+          // the vector index reads the inner table itself
+          SetupJobsForChildren(mem_root, param.outer, join,
+                               /*eligible_for_batch_mode=*/false, &job, &todo);
+          continue;
+        }
+        iterator = NewIterator<SemanticJoinIterator>(
+            thd, mem_root, std::move(job.children[0]),
+            GetUsedTables(param.outer, /*include_pruned_tables=*/true),
+            GetUsedTables(param.inner, /*include_pruned_tables=*/true),
+            param.join_predicate->expr->join_conditions, param.param->table,
+            param.param->idx, param.param->distance_func,
+            thd->variables.semantic_filter_concurrency,
+            thd->variables.join_buff_size, param.store_rowids,
+            param.tables_to_get_rowid_for);
+        break;
+      }
       case AccessPath::FILTER: {
         const auto &param = path->filter();
         if (job.children.is_null()) {
@@ -847,6 +962,18 @@ unique_ptr_destroy_only<RowIterator> CreateIteratorFromAccessPath(
         if (FinalizeMaterializedSubqueries(thd, join, path)) {
           return nullptr;
         }
+        if (UseSemanticFilterIterator(thd, param.condition)) {
+          iterator = NewIterator<SemanticFilterIterator>(
+              thd, mem_root, std::move(job.children[0]),
+              GetUsedTables(param.child, /*include_pruned_tables=*/true),
+              param.condition, thd->variables.semantic_filter_batch_size,
+              thd->variables.semantic_filter_concurrency,
+              thd->variables.semantic_filter_read_ahead,
+              thd->variables.join_buff_size,
+              GetUsedTableMap(param.child, /*include_pruned_tables=*/true),
+              RowsNeededByLimit(join, path));
+          break;
+        }
         iterator = NewIterator<FilterIterator>(
             thd, mem_root, std::move(job.children[0]), param.condition);
         break;
@@ -1209,6 +1336,8 @@ void FindTablesToGetRowidFor(AccessPath *path) {
     if (path == subpath) return false;  // Skip ourselves.
     switch (subpath->type) {
       case AccessPath::HASH_JOIN:
+      case AccessPath::SPATIAL_JOIN:
+      case AccessPath::SEMANTIC_JOIN:
         handled_by_others |=
             GetUsedTableMap(subpath, /*include_pruned_tables=*/true);
         FindTablesToGetRowidFor(subpath);
@@ -1218,6 +1347,11 @@ void FindTablesToGetRowidFor(AccessPath *path) {
                                              /*include_pruned_tables=*/true);
         FindTablesToGetRowidFor(subpath);
         return true;  // Don't double-traverse.
+      case AccessPath::KNN_JOIN:
+        handled_by_others |= GetUsedTableMap(subpath->knn_join().outer,
+                                             /*include_pruned_tables=*/true);
+        FindTablesToGetRowidFor(subpath);
+        return true;  // Don't double-traverse.
       case AccessPath::STREAM: {
         subpath->stream().provide_rowid = true;
         TABLE *table = subpath->stream().table;
@@ -1257,6 +1391,36 @@ void FindTablesToGetRowidFor(AccessPath *path) {
                           /*include_pruned_tables=*/true) &
           ~handled_by_others;
       break;
+    case AccessPath::KNN_JOIN:
+      WalkAccessPaths(path->knn_join().outer, /*join=*/nullptr,
+                      WalkAccessPathPolicy::STOP_AT_MATERIALIZATION,
+                      add_tables_handled_by_others);
+      path->knn_join().store_rowids = true;
+      path->knn_join().tables_to_get_rowid_for =
+          GetUsedTableMap(path->knn_join().outer,
+                          /*include_pruned_tables=*/true) &
+          ~handled_by_others;
+      break;
+    case AccessPath::SPATIAL_JOIN:
+      // both sides may be buffered, see HASH_JOIN
+      WalkAccessPaths(path, /*join=*/nullptr,
+                      WalkAccessPathPolicy::STOP_AT_MATERIALIZATION,
+                      add_tables_handled_by_others);
+      path->spatial_join().store_rowids = true;
+      path->spatial_join().tables_to_get_rowid_for =
+          GetUsedTableMap(path, /*include_pruned_tables=*/true) &
+          ~handled_by_others;
+      break;
+    case AccessPath::SEMANTIC_JOIN:
+      // both sides are buffered, see HASH_JOIN
+      WalkAccessPaths(path, /*join=*/nullptr,
+                      WalkAccessPathPolicy::STOP_AT_MATERIALIZATION,
+                      add_tables_handled_by_others);
+      path->semantic_join().store_rowids = true;
+      path->semantic_join().tables_to_get_rowid_for =
+          GetUsedTableMap(path, /*include_pruned_tables=*/true) &
+          ~handled_by_others;
+      break;
     case AccessPath::WEEDOUT:
       WalkAccessPaths(path, /*join=*/nullptr,
                       WalkAccessPathPolicy::STOP_AT_MATERIALIZATION,
@@ -1483,7 +1647,9 @@ table_map GetHashJoinTables(AccessPath *path) {
   WalkAccessPaths(
       path, /*join=*/nullptr, WalkAccessPathPolicy::STOP_AT_MATERIALIZATION,
       [&tables](AccessPath *subpath, const JOIN *) {
-        if (subpath->type == AccessPath::HASH_JOIN) {
+        if (subpath->type == AccessPath::HASH_JOIN ||
+            subpath->type == AccessPath::SPATIAL_JOIN ||
+            subpath->type == AccessPath::SEMANTIC_JOIN) {
           tables |= GetUsedTableMap(subpath, /*include_pruned_tables=*/true);
           return true;
         }
@@ -47,6 +47,7 @@ class Bounds_checked_array;
 class Common_table_expr;
 class Filesort;
 class Item;
+class Item_func_fb_vector_distance;
 class Item_func_match;
 class JOIN;
 class KEY;
@@ -157,6 +158,10 @@ struct Predicate {
   // The optimizer uses this to add their materialized/non-materialized
   // costs when evaluating filters.
   Mem_root_array<ContainedSubquery> contained_subqueries;
+
+  // Cost of the model calls of the semantic functions in this predicate,
+  // per row evaluated. See EstimateSemanticCost().
+  double semantic_cost = 0.0;
 };
 
 struct AppendPathParameters {
@@ -164,6 +169,28 @@ struct AppendPathParameters {
   JOIN *join;
 };
 
+/// The spatial predicate of a SPATIAL_JOIN, and the index it probes.
+struct SpatialJoinParameters {
+  // The geometries of the spatial predicate in the join condition, one per
+  // side, and the bound on their distance, or nullptr if they must
+  // intersect.
+  Item *outer_geometry, *inner_geometry, *radius;
+  // The next spatial index on inner_geometry that is probed for each outer
+  // row, or nullptr if both sides are partitioned on a grid.
+  TABLE *table;
+  unsigned idx;
+};
+
+/// The vector index a SEMANTIC_JOIN searches.
+struct SemanticJoinParameters {
+  // The distance between the embeddings of the SEMANTIC_JOIN() in the join
+  // condition; the nearest neighbours of the outer row in the vector index
+  // table.idx are its candidate inner rows.
+  Item_func_fb_vector_distance *distance_func;
+  TABLE *table;
+  unsigned idx;
+};
+
 /**
   Access paths are a query planning structure that correspond 1:1 to iterators,
   in that an access path contains pretty much exactly the information
@@ -236,6 +263,9 @@ struct AccessPath {
     NESTED_LOOP_SEMIJOIN_WITH_DUPLICATE_REMOVAL,
     BKA_JOIN,
     HASH_JOIN,
+    KNN_JOIN,
+    SPATIAL_JOIN,
+    SEMANTIC_JOIN,
 
     // Composite access paths.
     FILTER,
@@ -686,6 +716,30 @@ struct AccessPath {
     assert(type == BKA_JOIN);
     return u.bka_join;
   }
+  auto &knn_join() {
+    assert(type == KNN_JOIN);
+    return u.knn_join;
+  }
+  const auto &knn_join() const {
+    assert(type == KNN_JOIN);
+    return u.knn_join;
+  }
+  auto &spatial_join() {
+    assert(type == SPATIAL_JOIN);
+    return u.spatial_join;
+  }
+  const auto &spatial_join() const {
+    assert(type == SPATIAL_JOIN);
+    return u.spatial_join;
+  }
+  auto &semantic_join() {
+    assert(type == SEMANTIC_JOIN);
+    return u.semantic_join;
+  }
+  const auto &semantic_join() const {
+    assert(type == SEMANTIC_JOIN);
+    return u.semantic_join;
+  }
   auto &nested_loop_join() {
     assert(type == NESTED_LOOP_JOIN);
     return u.nested_loop_join;
@@ -1058,6 +1112,33 @@ struct AccessPath {
       bool store_rowids;  // Whether we are below a weedout or not.
       table_map tables_to_get_rowid_for;
     } bka_join;
+    struct {
+      AccessPath *outer, *inner;
+      // The vector index scan inside inner, searched once per outer row.
+      TABLE *table;
+      // The ORDER BY distance of that scan, its query vector is read from
+      // the outer row.
+      Item_func_fb_vector_distance *distance_func;
+      table_map tables_to_get_rowid_for;
+      unsigned idx;
+      bool store_rowids;  // Whether we are below a weedout or not.
+    } knn_join;
+    struct {
+      AccessPath *outer, *inner;
+      const JoinPredicate *join_predicate;
+      const SpatialJoinParameters *param;
+      bool store_rowids;  // Whether we are below a weedout or not.
+      table_map tables_to_get_rowid_for;
+    } spatial_join;
+    struct {
+      // inner is the scan of param->table that the vector index stands in
+      // for; it is not read, and is kept for EXPLAIN only.
+      AccessPath *outer, *inner;
+      const JoinPredicate *join_predicate;
+      const SemanticJoinParameters *param;
+      bool store_rowids;  // Whether we are below a weedout or not.
+      table_map tables_to_get_rowid_for;
+    } semantic_join;
     struct {
       AccessPath *outer, *inner;
       JoinType join_type;  // Somewhat redundant wrt. join_predicate.
@@ -1788,7 +1869,7 @@ void ExpandSingleFilterAccessPath(THD *thd, AccessPath *path, const JOIN *join,
                                   const Mem_root_array<Predicate> &predicates,
                                   unsigned num_where_predicates);
 
-/// Returns the tables that are part of a hash join.
+/// Returns the tables that are part of a hash join or a spatial join.
 table_map GetHashJoinTables(AccessPath *path);
 
 #endif  // SQL_JOIN_OPTIMIZER_ACCESS_PATH_H
@@ -43,6 +43,7 @@
 #include "sql/mysqld.h"
 #include "sql/opt_costmodel.h"
 #include "sql/opt_trace.h"
+#include "sql/semantic_stats.h"
 #include "sql/sql_class.h"
 #include "sql/sql_const.h"
 #include "sql/sql_lex.h"
@@ -160,11 +161,34 @@ void AddCost(THD *thd, const ContainedSubquery &subquery, double num_rows,
   }
 }
 
+double EstimateSemanticCost(Item *condition) {
+  int num_calls = 0;
+  WalkItem(condition, enum_walk::PREFIX, [&num_calls](Item *item) {
+    if (item->type() == Item::FUNC_ITEM) {
+      switch (down_cast<Item_func *>(item)->functype()) {
+        case Item_func::SEMANTIC_FILTER_SINGLE_COL:
+        case Item_func::SEMANTIC_FILTER_TWO_COL:
+        case Item_func::SEMANTIC_JOIN:
+        case Item_func::SEMANTIC_MAP:
+        case Item_func::SEMANTIC_EXTRACT:
+          ++num_calls;
+          break;
+        default:
+          break;
+      }
+    }
+    return false;
+  });
+  if (num_calls == 0) return 0.0;
+  return num_calls * semantic_stats_latency_ms() * kSemanticOneMsCost;
+}
+
 FilterCost EstimateFilterCost(THD *thd, double num_rows, Item *condition,
                               const Query_block *outer_query_block) {
   FilterCost cost;
-  cost.cost_if_not_materialized = num_rows * kApplyOneFilterCost;
-  cost.cost_if_materialized = num_rows * kApplyOneFilterCost;
+  cost.cost_if_not_materialized =
+      num_rows * (kApplyOneFilterCost + EstimateSemanticCost(condition));
+  cost.cost_if_materialized = cost.cost_if_not_materialized;
   FindContainedSubqueries(
       condition, outer_query_block,
       [thd, num_rows, &cost](const ContainedSubquery &subquery) {
@@ -52,9 +52,15 @@ constexpr double kSortOneRowCost = 0.1;
 constexpr double kHashBuildOneRowCost = 0.1;
 constexpr double kHashProbeOneRowCost = 0.1;
 constexpr double kHashReturnOneRowCost = 0.07;
+constexpr double kSpatialIndexProbeCost = 1.0;
+constexpr double kVectorIndexProbeCost = 1.0;
 constexpr double kMaterializeOneRowCost = 0.1;
 constexpr double kWindowOneRowCost = 0.1;
 
+/// Cost of waiting one millisecond on the model for a semantic function.
+/// Rough; it makes a call cost as much as reading tens of thousands of rows.
+constexpr double kSemanticOneMsCost = 100.0;
+
 /// See EstimateFilterCost.
 struct FilterCost {
   /// Cost of evaluating the filter for all rows if subqueries are not
@@ -82,10 +88,17 @@ struct FilterCost {
 void AddCost(THD *thd, const ContainedSubquery &subquery, double num_rows,
              FilterCost *cost);
 
+/**
+  Estimate the cost of the model calls the semantic functions in
+  “condition” make for one row, from the latency observed so far.
+ */
+double EstimateSemanticCost(Item *condition);
+
 /**
   Estimate the cost of evaluating “condition”, “num_rows” times.
   This is a fairly rudimentary estimation, _but_ it includes the cost
-  of any subqueries that may be present and that need evaluation.
+  of any subqueries that may be present and that need evaluation,
+  and of the model calls of any semantic functions.
  */
 FilterCost EstimateFilterCost(THD *thd, double num_rows, Item *condition,
                               const Query_block *outer_query_block);
@@ -94,14 +107,17 @@ FilterCost EstimateFilterCost(THD *thd, double num_rows, Item *condition,
   A cheaper overload of EstimateFilterCost() that assumes that all
   contained subqueries have already been extracted (ie., it skips the
   walking, which can be fairly expensive). This data is typically
-  computed by FindContainedSubqueries().
+  computed by FindContainedSubqueries(), and semantic_cost by
+  EstimateSemanticCost().
  */
 inline FilterCost EstimateFilterCost(
     THD *thd, double num_rows,
-    const Mem_root_array<ContainedSubquery> &contained_subqueries) {
+    const Mem_root_array<ContainedSubquery> &contained_subqueries,
+    double semantic_cost) {
   FilterCost cost;
-  cost.cost_if_not_materialized = num_rows * kApplyOneFilterCost;
-  cost.cost_if_materialized = num_rows * kApplyOneFilterCost;
+  cost.cost_if_not_materialized =
+      num_rows * (kApplyOneFilterCost + semantic_cost);
+  cost.cost_if_materialized = cost.cost_if_not_materialized;
 
   for (const ContainedSubquery &subquery : contained_subqueries) {
     AddCost(thd, subquery, num_rows, &cost);
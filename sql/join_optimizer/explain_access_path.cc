@@ -107,6 +107,36 @@ static std::unique_ptr<Json_object> AssignParentPath(
 inline static double GetJSONDouble(const Json_object *obj, const char *key) {
   return down_cast<const Json_double *>(obj->get(key))->value();
 }
+inline static ulonglong GetJSONUint(const Json_object *obj, const char *key) {
+  return down_cast<const Json_uint *>(obj->get(key))->value();
+}
+
+/**
+  Add the work the storage engines did for an iterator, if they did any.
+  @returns true iff there was an error.
+*/
+static bool AddEngineCounters(const ha_engine_counters &counters,
+                              Json_object *obj) {
+  if (counters.block_reads == 0 && counters.block_cache_hits == 0 &&
+      counters.bloom_checks == 0 && counters.seeks == 0 &&
+      counters.nexts == 0 && counters.decode_ns == 0) {
+    return false;
+  }
+  bool error = false;
+  error |= AddMemberToObject<Json_uint>(obj, "actual_block_reads",
+                                        counters.block_reads);
+  error |= AddMemberToObject<Json_uint>(obj, "actual_block_read_bytes",
+                                        counters.block_read_bytes);
+  error |= AddMemberToObject<Json_uint>(obj, "actual_block_cache_hits",
+                                        counters.block_cache_hits);
+  error |= AddMemberToObject<Json_uint>(obj, "actual_bloom_checks",
+                                        counters.bloom_checks);
+  error |= AddMemberToObject<Json_uint>(obj, "actual_seeks", counters.seeks);
+  error |= AddMemberToObject<Json_uint>(obj, "actual_nexts", counters.nexts);
+  error |= AddMemberToObject<Json_double>(obj, "actual_decode_ms",
+                                          counters.decode_ns / 1e6);
+  return error;
+}
 
 /*
   The index information is displayed like this :
@@ -907,6 +937,10 @@ static bool AddPathCosts(const AccessPath *path,
             static_cast<double>(profiler->GetNumRows()) / num_init_calls);
         error |=
             AddMemberToObject<Json_int>(obj, "actual_loops", num_init_calls);
+        ha_engine_counters counters;
+        if (profiler->GetEngineCounters(&counters)) {
+          error |= AddEngineCounters(counters, obj);
+        }
       }
     }
 
@@ -994,6 +1028,8 @@ static std::unique_ptr<Json_object> SetObjectMembers(
                       ? "Vector"
                       : "Ordered vector";
         prefix_ptr = prefix.c_str();
+      } else if (key->is_next_spatial_index()) {
+        prefix_ptr = "Nearest spatial";
       }
 
       assert(table->file->pushed_idx_cond == nullptr ||
@@ -1250,6 +1286,89 @@ static std::unique_ptr<Json_object> SetObjectMembers(
       children->push_back({path->bka_join().inner});
       break;
     }
+    case AccessPath::KNN_JOIN: {
+      const auto &param = path->knn_join();
+      error |= AddMemberToObject<Json_string>(obj, "access_type", "join");
+      error |= AddMemberToObject<Json_string>(obj, "join_type", "inner join");
+      error |= AddMemberToObject<Json_string>(obj, "join_algorithm", "knn");
+      error |= AddMemberToObject<Json_string>(
+          obj, "index_name", param.table->key_info[param.idx].name);
+      error |= AddMemberToObject<Json_int>(obj, "limit",
+                                           param.distance_func->m_limit);
+      description = string("KNN join using ") +
+                    param.table->key_info[param.idx].name + " (k=" +
+                    std::to_string(param.distance_func->m_limit) + ")";
+      children->push_back({param.outer, "Batch input rows"});
+      children->push_back({param.inner});
+      break;
+    }
+    case AccessPath::SPATIAL_JOIN: {
+      const auto &param = path->spatial_join();
+      const SpatialJoinParameters &spatial = *param.param;
+      error |= AddMemberToObject<Json_string>(obj, "access_type", "join");
+      error |= AddMemberToObject<Json_string>(obj, "join_type", "inner join");
+      error |= AddMemberToObject<Json_string>(obj, "join_algorithm",
+                                              "spatial");
+      description = "Spatial join";
+      if (spatial.table != nullptr) {
+        error |= AddMemberToObject<Json_string>(
+            obj, "index_name", spatial.table->key_info[spatial.idx].name);
+        description += string(" using ") +
+                       spatial.table->key_info[spatial.idx].name;
+      } else {
+        description += " (partitioned)";
+      }
+      std::unique_ptr<Json_array> spatial_condition(new (std::nothrow)
+                                                        Json_array());
+      if (spatial_condition == nullptr) return nullptr;
+      for (Item *cond : param.join_predicate->expr->join_conditions) {
+        if (cond != param.join_predicate->expr->join_conditions[0]) {
+          description.push_back(',');
+        }
+        const string condition_str = ItemToString(cond);
+        error |= AddElementToArray<Json_string>(spatial_condition,
+                                                condition_str);
+        description.append(" " + condition_str);
+      }
+      error |= obj->add_alias("spatial_condition",
+                              std::move(spatial_condition));
+      children->push_back({param.outer});
+      children->push_back({param.inner});
+      break;
+    }
+    case AccessPath::SEMANTIC_JOIN: {
+      const auto &param = path->semantic_join();
+      const SemanticJoinParameters &semantic = *param.param;
+      error |= AddMemberToObject<Json_string>(obj, "access_type", "join");
+      error |= AddMemberToObject<Json_string>(obj, "join_type", "inner join");
+      error |= AddMemberToObject<Json_string>(obj, "join_algorithm",
+                                              "semantic");
+      error |= AddMemberToObject<Json_string>(
+          obj, "index_name", semantic.table->key_info[semantic.idx].name);
+      error |= AddMemberToObject<Json_int>(obj, "neighbors",
+                                           semantic.distance_func->m_limit);
+      description = string("Semantic join using ") +
+                    semantic.table->key_info[semantic.idx].name +
+                    " (neighbors=" +
+                    std::to_string(semantic.distance_func->m_limit) + ")";
+      std::unique_ptr<Json_array> semantic_condition(new (std::nothrow)
+                                                         Json_array());
+      if (semantic_condition == nullptr) return nullptr;
+      for (Item *cond : param.join_predicate->expr->join_conditions) {
+        if (cond != param.join_predicate->expr->join_conditions[0]) {
+          description.push_back(',');
+        }
+        const string condition_str = ItemToString(cond);
+        error |= AddElementToArray<Json_string>(semantic_condition,
+                                                condition_str);
+        description.append(" " + condition_str);
+      }
+      error |= obj->add_alias("semantic_condition",
+                              std::move(semantic_condition));
+      children->push_back({param.outer, "Batch input rows"});
+      children->push_back({param.inner});
+      break;
+    }
     case AccessPath::HASH_JOIN: {
       const JoinPredicate *predicate = path->hash_join().join_predicate;
       RelationalExpression::Type type = path->hash_join().rewrite_semi_to_inner
@@ -1984,6 +2103,22 @@ void Explain_format_tree::ExplainPrintCosts(const Json_object *obj,
                actual_first_row_ms, actual_last_row_ms,
                llrintf(static_cast<double>(actual_rows)), actual_loops);
       *explain += str;
+
+      // Work of the storage engines, summed over all loops.
+      if (obj->get("actual_seeks") != nullptr) {
+        snprintf(str, sizeof(str),
+                 " (engine seeks=%llu nexts=%llu cache_hits=%llu "
+                 "block_reads=%llu read_bytes=%llu bloom_checks=%llu "
+                 "decode=%.3f)",
+                 GetJSONUint(obj, "actual_seeks"),
+                 GetJSONUint(obj, "actual_nexts"),
+                 GetJSONUint(obj, "actual_block_cache_hits"),
+                 GetJSONUint(obj, "actual_block_reads"),
+                 GetJSONUint(obj, "actual_block_read_bytes"),
+                 GetJSONUint(obj, "actual_bloom_checks"),
+                 GetJSONDouble(obj, "actual_decode_ms"));
+        *explain += str;
+      }
     }
   }
   *explain += "\n";
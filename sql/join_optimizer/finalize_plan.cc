@@ -602,6 +602,24 @@ static Item *AddCachesAroundConstantConditions(Item *item) {
         }
       }
       return false;
+    case AccessPath::SPATIAL_JOIN:
+      for (Item *&item :
+           path->spatial_join().join_predicate->expr->join_conditions) {
+        item = AddCachesAroundConstantConditions(item);
+        if (item == nullptr) {
+          return true;
+        }
+      }
+      return false;
+    case AccessPath::SEMANTIC_JOIN:
+      for (Item *&item :
+           path->semantic_join().join_predicate->expr->join_conditions) {
+        item = AddCachesAroundConstantConditions(item);
+        if (item == nullptr) {
+          return true;
+        }
+      }
+      return false;
     default:
       return false;
   }
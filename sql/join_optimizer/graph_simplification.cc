@@ -912,9 +912,11 @@ void GraphSimplifier::UndoSimplificationStep() {
   Once we find the border between too complicated and just simple enough,
   we set the graph to the latter, and the actual query planning will start
   afresh.
+
+  Returns the number of simplification steps applied.
  */
-void SimplifyQueryGraph(THD *thd, int subgraph_pair_limit,
-                        JoinHypergraph *graph, string *trace) {
+int SimplifyQueryGraph(THD *thd, int subgraph_pair_limit,
+                       JoinHypergraph *graph, string *trace) {
   if (trace != nullptr) {
     *trace +=
         "\nQuery became too complicated, doing heuristic graph "
@@ -942,7 +944,7 @@ void SimplifyQueryGraph(THD *thd, int subgraph_pair_limit,
                 "Cannot do any more simplification steps, just running "
                 "the query as-is.\n";
           }
-          return;
+          return simplifier.num_steps_done();
         }
 
         upper_bound = simplifier.num_steps_done();
@@ -999,4 +1001,28 @@ void SimplifyQueryGraph(THD *thd, int subgraph_pair_limit,
         "subgraph pairs, which is below the limit.\n",
         upper_bound, num_subgraph_pairs_upper);
   }
+  return upper_bound;
+}
+
+/**
+  Apply the first “num_steps” simplifications SimplifyQueryGraph() would to
+  the given hypergraph, or as many as there are, without counting any
+  subgraph pairs. This is for a graph known to need that many steps, from an
+  earlier optimization of the same query block.
+ */
+void ReplayQueryGraphSimplification(THD *thd, int num_steps,
+                                    JoinHypergraph *graph, string *trace) {
+  GraphSimplifier simplifier(graph, thd->mem_root);
+  while (simplifier.num_steps_done() < num_steps) {
+    if (simplifier.DoSimplificationStep() ==
+        GraphSimplifier::NO_SIMPLIFICATION_POSSIBLE) {
+      break;
+    }
+  }
+
+  if (trace != nullptr) {
+    *trace += StringPrintf(
+        "\nReplayed %d cached simplification steps of the query graph.\n",
+        simplifier.num_steps_done());
+  }
 }
@@ -291,7 +291,12 @@ class GraphSimplifier {
 };
 
 // See comment in .cc file.
-void SimplifyQueryGraph(THD *thd, int subgraph_pair_limit,
-                        JoinHypergraph *graph, std::string *trace);
+int SimplifyQueryGraph(THD *thd, int subgraph_pair_limit,
+                       JoinHypergraph *graph, std::string *trace);
+
+// See comment in .cc file.
+void ReplayQueryGraphSimplification(THD *thd, int num_steps,
+                                    JoinHypergraph *graph,
+                                    std::string *trace);
 
 #endif  // SQL_JOIN_OPTIMIZER_GRAPH_SIMPLIFICATION_H_
@@ -60,9 +60,12 @@
 #include "sql/field.h"
 #include "sql/filesort.h"
 #include "sql/handler.h"
+#include "sql/histograms/histogram.h"
 #include "sql/item.h"
 #include "sql/item_cmpfunc.h"
+#include "sql/item_fb_vector_func.h"
 #include "sql/item_func.h"
+#include "sql/item_semantic_func.h"
 #include "sql/item_sum.h"
 #include "sql/join_optimizer/access_path.h"
 #include "sql/join_optimizer/bit_utils.h"
@@ -88,6 +91,7 @@
 #include "sql/key.h"
 #include "sql/key_spec.h"
 #include "sql/mem_root_array.h"
+#include "sql/next_spatial_base.h"
 #include "sql/opt_costmodel.h"
 #include "sql/parse_tree_node_base.h"
 #include "sql/partition_info.h"
@@ -537,6 +541,16 @@ class CostingReceiver {
                        FunctionalDependencySet new_fd_set,
                        OrderingSet new_obsolete_orderings,
                        bool rewrite_semi_to_inner, bool *wrote_trace);
+  void ProposeSpatialJoin(NodeMap left, NodeMap right, AccessPath *left_path,
+                          AccessPath *right_path, const JoinPredicate *edge,
+                          FunctionalDependencySet new_fd_set,
+                          OrderingSet new_obsolete_orderings,
+                          bool *wrote_trace);
+  void ProposeSemanticJoin(NodeMap left, NodeMap right, AccessPath *left_path,
+                           AccessPath *right_path, const JoinPredicate *edge,
+                           FunctionalDependencySet new_fd_set,
+                           OrderingSet new_obsolete_orderings,
+                           bool *wrote_trace);
   void ApplyPredicatesForBaseTable(int node_idx,
                                    OverflowBitset applied_predicates,
                                    OverflowBitset subsumed_predicates,
@@ -2382,6 +2396,8 @@ bool CostingReceiver::ProposeIndexScan(
 
   double num_output_rows = table->file->stats.records;
   double cost;
+  double init_cost = 0.0;
+  Cost_estimate knn_cost;
 
   // If a table scan and a primary key scan is the very same thing,
   // they should also have the same cost. However, read_cost()
@@ -2398,6 +2414,19 @@ bool CostingReceiver::ProposeIndexScan(
   if (table->s->primary_key == key_idx &&
       table->file->primary_key_is_clustered()) {
     cost = table->file->table_scan_cost().total_cost() * 1.001;
+  } else if (table->key_info[key_idx].is_fb_vector_index() &&
+             !table->file->vector_index_scan_cost(key_idx, HA_POS_ERROR,
+                                                  &knn_cost)) {
+    // A knn search does most of its work before returning the first row,
+    // so charge the rows the query asks for up front; a LIMIT then only
+    // scales down the cost of the remaining rows.
+    cost = knn_cost.total_cost();
+    const ha_rows limit =
+        m_query_block->join->query_expression()->select_limit_cnt;
+    if (limit != HA_POS_ERROR &&
+        !table->file->vector_index_scan_cost(key_idx, limit, &knn_cost)) {
+      init_cost = std::min(knn_cost.total_cost(), cost);
+    }
   } else if (table->covering_keys.is_set(key_idx)) {
     // The index is covering, so we can do an index-only scan.
     cost =
@@ -2409,7 +2438,8 @@ bool CostingReceiver::ProposeIndexScan(
   }
 
   path.num_output_rows_before_filter = num_output_rows;
-  path.init_cost = path.init_once_cost = 0.0;
+  path.init_cost = init_cost;
+  path.init_once_cost = 0.0;
   path.cost_before_filter = path.cost = cost;
   if (IsBitSet(node_idx, m_immediate_update_delete_candidates)) {
     path.immediate_update_delete_table = node_idx;
@@ -2784,7 +2814,8 @@ void CostingReceiver::ApplyPredicatesForBaseTable(
       filter_predicates.SetBit(i);
       FilterCost cost =
           EstimateFilterCost(m_thd, path->num_output_rows(),
-                             m_graph->predicates[i].contained_subqueries);
+                             m_graph->predicates[i].contained_subqueries,
+                             m_graph->predicates[i].semantic_cost);
       if (materialize_subqueries) {
         path->cost += cost.cost_if_materialized;
         materialize_cost += cost.cost_to_materialize;
@@ -3221,6 +3252,20 @@ bool CostingReceiver::FoundSubgraphPair(NodeMap left, NodeMap right,
             /*rewrite_semi_to_inner=*/can_rewrite_semi_to_inner, new_fd_set,
             new_obsolete_orderings, &wrote_trace);
       }
+
+      ProposeSpatialJoin(left, right, left_path, right_path, edge, new_fd_set,
+                         new_obsolete_orderings, &wrote_trace);
+      if (is_commutative) {
+        ProposeSpatialJoin(right, left, right_path, left_path, edge,
+                           new_fd_set, new_obsolete_orderings, &wrote_trace);
+      }
+
+      ProposeSemanticJoin(left, right, left_path, right_path, edge, new_fd_set,
+                          new_obsolete_orderings, &wrote_trace);
+      if (is_commutative) {
+        ProposeSemanticJoin(right, left, right_path, left_path, edge,
+                            new_fd_set, new_obsolete_orderings, &wrote_trace);
+      }
       m_overflow_bitset_mem_root.ClearForReuse();
     }
   }
@@ -3293,6 +3338,76 @@ string CostingReceiver::PrintSubgraphHeader(const JoinPredicate *edge,
   return ret;
 }
 
+/**
+  Find a join condition of an inner join that can be served by a spatial
+  join, i.e., a spatial relation or a bound on ST_Distance() between a
+  geometry from each side. See get_next_spatial_join_predicate().
+ */
+static bool FindSpatialJoinPredicate(const JoinPredicate *edge,
+                                     const AccessPath *left_path,
+                                     const AccessPath *right_path,
+                                     Item **outer_geometry,
+                                     Item **inner_geometry, Item **radius) {
+  if (edge->expr->type != RelationalExpression::INNER_JOIN &&
+      edge->expr->type != RelationalExpression::STRAIGHT_INNER_JOIN) {
+    return false;
+  }
+  const table_map outer_tables =
+      GetUsedTableMap(left_path, /*include_pruned_tables=*/true);
+  const table_map inner_tables =
+      GetUsedTableMap(right_path, /*include_pruned_tables=*/true);
+  for (Item *condition : edge->expr->join_conditions) {
+    if (get_next_spatial_join_predicate(condition, outer_tables, inner_tables,
+                                        outer_geometry, inner_geometry,
+                                        radius)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+  Find a SEMANTIC_JOIN() with embeddings among the join conditions of an
+  inner join, and which of its embeddings is read from each side.
+ */
+static bool FindSemanticJoinPredicate(const JoinPredicate *edge,
+                                      const AccessPath *left_path,
+                                      const AccessPath *right_path,
+                                      Item **outer_embedding,
+                                      Item **inner_embedding) {
+  if (edge->expr->type != RelationalExpression::INNER_JOIN &&
+      edge->expr->type != RelationalExpression::STRAIGHT_INNER_JOIN) {
+    return false;
+  }
+  const table_map outer_tables =
+      GetUsedTableMap(left_path, /*include_pruned_tables=*/true);
+  const table_map inner_tables =
+      GetUsedTableMap(right_path, /*include_pruned_tables=*/true);
+  const auto reads_only = [](Item *item, table_map tables) {
+    const table_map used = item->used_tables() & ~PSEUDO_TABLE_BITS;
+    return used != 0 && IsSubset(used, tables);
+  };
+  for (Item *condition : edge->expr->join_conditions) {
+    if (condition->type() != Item::FUNC_ITEM ||
+        down_cast<Item_func *>(condition)->functype() !=
+            Item_func::SEMANTIC_JOIN) {
+      continue;
+    }
+    auto *func = down_cast<Item_func_semantic_join *>(condition);
+    if (func->embedding(0) == nullptr) continue;
+    for (uint outer_side : {0, 1}) {
+      Item *outer = func->embedding(outer_side);
+      Item *inner = func->embedding(1 - outer_side);
+      if (reads_only(outer, outer_tables) && reads_only(inner, inner_tables)) {
+        *outer_embedding = outer;
+        *inner_embedding = inner;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 void CostingReceiver::ProposeHashJoin(
     NodeMap left, NodeMap right, AccessPath *left_path, AccessPath *right_path,
     const JoinPredicate *edge, FunctionalDependencySet new_fd_set,
@@ -3472,6 +3587,38 @@ void CostingReceiver::ProposeHashJoin(
   cost += num_output_rows * edge->expr->join_conditions.size() *
           kApplyOneFilterCost;
 
+  // Without equijoin conditions, every pair of rows lands in the same bucket
+  // and has its join conditions evaluated. That is usually a cost we cannot
+  // avoid anyway, but a spatial predicate can be served by a spatial join
+  // (see ProposeSpatialJoin()), which only tests pairs whose boxes meet, so
+  // charge the hash join for the full cross product in that case.
+  if (edge->expr->equijoin_conditions.empty()) {
+    Item *outer_geometry, *inner_geometry, *radius;
+    if (FindSpatialJoinPredicate(edge, left_path, right_path, &outer_geometry,
+                                 &inner_geometry, &radius)) {
+      cost += (left_path->num_output_rows() * right_path->num_output_rows() -
+               num_output_rows) *
+              edge->expr->join_conditions.size() * kApplyOneFilterCost;
+    }
+  }
+
+  // A semantic join condition asks the model about every pair it is
+  // evaluated on, which without equijoin conditions is every pair of rows.
+  // A semantic join (see ProposeSemanticJoin()) only asks about the nearest
+  // neighbours.
+  double semantic_cost = 0.0;
+  for (const CachedPropertiesForPredicate &properties :
+       edge->expr->properties_for_join_conditions) {
+    semantic_cost += properties.semantic_cost;
+  }
+  if (semantic_cost > 0.0) {
+    const double pairs =
+        edge->expr->equijoin_conditions.empty()
+            ? left_path->num_output_rows() * right_path->num_output_rows()
+            : num_output_rows;
+    cost += pairs * semantic_cost;
+  }
+
   join_path.num_output_rows_before_filter = num_output_rows;
   join_path.cost_before_filter = cost;
   join_path.set_num_output_rows(num_output_rows);
@@ -3558,6 +3705,335 @@ void CostingReceiver::ProposeHashJoin(
   }
 }
 
+/**
+  Propose joining left_path and right_path with a SpatialJoinIterator, if
+  the edge is an inner join on a spatial predicate between them. If the
+  right side is a plain scan of a table with a next spatial index on its
+  geometry, we propose probing the index for each outer row, and in any case
+  we propose partitioning the right side on a grid; cost decides between
+  those and the hash join.
+ */
+void CostingReceiver::ProposeSpatialJoin(
+    NodeMap left, NodeMap right, AccessPath *left_path, AccessPath *right_path,
+    const JoinPredicate *edge, FunctionalDependencySet new_fd_set,
+    OrderingSet new_obsolete_orderings, bool *wrote_trace) {
+  if (SecondaryEngineHandlerton(m_thd) != nullptr) return;
+
+  // Equijoin conditions are better served by hashing.
+  if (!edge->expr->equijoin_conditions.empty()) return;
+
+  // Both sides are read in full, like for hash join; parameterizations
+  // must be resolved by nested loop.
+  if (Overlaps(left_path->parameter_tables, right) ||
+      Overlaps(right_path->parameter_tables, left | RAND_TABLE_BIT)) {
+    return;
+  }
+
+  // Rows come out in a different order from that of the underlying scans;
+  // see ProposeHashJoin().
+  if (Overlaps(left | right, m_fulltext_tables)) return;
+
+  Item *outer_geometry, *inner_geometry, *radius;
+  if (!FindSpatialJoinPredicate(edge, left_path, right_path, &outer_geometry,
+                                &inner_geometry, &radius)) {
+    return;
+  }
+
+  assert(BitsetsAreCommitted(left_path));
+  assert(BitsetsAreCommitted(right_path));
+
+  double num_output_rows;
+  {
+    const double right_path_already_applied_selectivity =
+        FindAlreadyAppliedSelectivity(edge, left_path, right_path, left, right);
+    if (right_path_already_applied_selectivity < 0.0) {
+      return;
+    }
+    num_output_rows = FindOutputRowsForJoin(
+        left_path->num_output_rows(),
+        right_path->num_output_rows() / right_path_already_applied_selectivity,
+        edge);
+  }
+  const double filter_cost = num_output_rows *
+                             edge->expr->join_conditions.size() *
+                             kApplyOneFilterCost;
+
+  // The index can stand in for the right side if that is a scan of the
+  // table holding the inner geometry, with no filters of its own.
+  TABLE *index_table = nullptr;
+  unsigned index_idx = 0;
+  if (right_path->type == AccessPath::TABLE_SCAN &&
+      IsEmpty(right_path->filter_predicates) &&
+      inner_geometry->real_item()->type() == Item::FIELD_ITEM) {
+    TABLE *table = right_path->table_scan().table;
+    const Field *field =
+        down_cast<Item_field *>(inner_geometry->real_item())->field;
+    if (field->table == table) {
+      for (uint key = 0; key < table->s->keys; key++) {
+        if (field->key_start.is_set(key) &&
+            table->key_info[key].is_next_spatial_index() &&
+            table->keys_in_use_for_query.is_set(key)) {
+          index_table = table;
+          index_idx = key;
+          break;
+        }
+      }
+    }
+  }
+
+  for (bool use_index : {false, true}) {
+    if (use_index && index_table == nullptr) break;
+
+    SpatialJoinParameters *param =
+        new (m_thd->mem_root) SpatialJoinParameters;
+    if (param == nullptr) return;
+    param->outer_geometry = outer_geometry;
+    param->inner_geometry = inner_geometry;
+    param->radius = radius;
+    param->table = use_index ? index_table : nullptr;
+    param->idx = index_idx;
+
+    AccessPath join_path;
+    join_path.type = AccessPath::SPATIAL_JOIN;
+    join_path.parameter_tables =
+        (left_path->parameter_tables | right_path->parameter_tables) &
+        ~(left | right);
+    join_path.spatial_join().outer = left_path;
+    join_path.spatial_join().inner = right_path;
+    join_path.spatial_join().join_predicate = edge;
+    join_path.spatial_join().param = param;
+    join_path.spatial_join().store_rowids = false;
+    join_path.spatial_join().tables_to_get_rowid_for = 0;
+
+    // Rows are buffered on either side, so we need row IDs for any
+    // update/delete target tables, like for hash join.
+    if (Overlaps(m_update_delete_target_nodes, left | right)) {
+      FindTablesToGetRowidFor(&join_path);
+    }
+
+    double cost;
+    if (use_index) {
+      // One probe per outer row, then the matching inner rows are read at
+      // about the per-row cost of the scan they replace.
+      const double read_one_row_cost =
+          right_path->num_output_rows() > 0.0
+              ? right_path->cost / right_path->num_output_rows()
+              : 0.0;
+      cost = left_path->cost +
+             left_path->num_output_rows() * kSpatialIndexProbeCost +
+             num_output_rows * (read_one_row_cost + kHashReturnOneRowCost);
+      join_path.init_cost = left_path->init_cost;
+      join_path.init_once_cost = left_path->init_once_cost;
+    } else {
+      const double build_cost =
+          right_path->cost +
+          right_path->num_output_rows() * kHashBuildOneRowCost;
+      cost = left_path->cost + build_cost +
+             left_path->num_output_rows() * kHashProbeOneRowCost +
+             num_output_rows * kHashReturnOneRowCost;
+      join_path.init_cost = build_cost + left_path->init_cost;
+      join_path.init_once_cost =
+          left_path->init_once_cost + right_path->init_once_cost;
+    }
+    cost += filter_cost;
+
+    join_path.num_output_rows_before_filter = num_output_rows;
+    join_path.cost_before_filter = cost;
+    join_path.set_num_output_rows(num_output_rows);
+    join_path.cost = cost;
+
+    // Each side is read once per chunk of inner rows.
+    join_path.safe_for_rowid =
+        std::max(left_path->safe_for_rowid, right_path->safe_for_rowid);
+
+    if (m_trace != nullptr && !*wrote_trace) {
+      *m_trace += PrintSubgraphHeader(edge, join_path, left, right);
+      *wrote_trace = true;
+    }
+
+    for (bool materialize_subqueries : {false, true}) {
+      AccessPath new_path = join_path;
+      FunctionalDependencySet filter_fd_set;
+      ApplyDelayedPredicatesAfterJoin(
+          left, right, left_path, right_path, edge->expr->join_predicate_first,
+          edge->expr->join_predicate_last, materialize_subqueries, &new_path,
+          &filter_fd_set);
+      // Rows come out in no particular order.
+      new_path.ordering_state = m_orderings->ApplyFDs(
+          m_orderings->SetOrder(0), new_fd_set | filter_fd_set);
+      ProposeAccessPathWithOrderings(
+          left | right, new_fd_set | filter_fd_set, new_obsolete_orderings,
+          &new_path, materialize_subqueries ? "mat. subq." : "");
+
+      if (!Overlaps(new_path.filter_predicates,
+                    m_graph->materializable_predicates)) {
+        break;
+      }
+    }
+  }
+}
+
+/**
+  Propose joining left_path and right_path with a SemanticJoinIterator, if
+  the edge is an inner join on a SEMANTIC_JOIN() with embeddings, and the
+  right side is a plain scan of a table with a vector index on its
+  embedding. Each outer row is then only paired with the
+  semantic_join_neighbors nearest inner rows, which the embeddings given to
+  SEMANTIC_JOIN() ask for; all other plans evaluate the full cross product.
+ */
+void CostingReceiver::ProposeSemanticJoin(
+    NodeMap left, NodeMap right, AccessPath *left_path, AccessPath *right_path,
+    const JoinPredicate *edge, FunctionalDependencySet new_fd_set,
+    OrderingSet new_obsolete_orderings, bool *wrote_trace) {
+  if (SecondaryEngineHandlerton(m_thd) != nullptr) return;
+
+  // Equijoin conditions are better served by hashing.
+  if (!edge->expr->equijoin_conditions.empty()) return;
+
+  // The outer side is read in full; parameterizations must be resolved by
+  // nested loop.
+  if (Overlaps(left_path->parameter_tables, right) ||
+      Overlaps(right_path->parameter_tables, left | RAND_TABLE_BIT)) {
+    return;
+  }
+
+  // Rows come out in a different order from that of the underlying scans;
+  // see ProposeHashJoin().
+  if (Overlaps(left | right, m_fulltext_tables)) return;
+
+  Item *outer_embedding, *inner_embedding;
+  if (!FindSemanticJoinPredicate(edge, left_path, right_path, &outer_embedding,
+                                 &inner_embedding)) {
+    return;
+  }
+
+  // The index stands in for the right side, which must be a scan of the
+  // table holding the inner embedding, with no filters of its own.
+  if (right_path->type != AccessPath::TABLE_SCAN ||
+      !IsEmpty(right_path->filter_predicates) ||
+      inner_embedding->real_item()->type() != Item::FIELD_ITEM) {
+    return;
+  }
+  TABLE *table = right_path->table_scan().table;
+  Item_field *inner_field =
+      down_cast<Item_field *>(inner_embedding->real_item());
+  if (inner_field->field->table != table) return;
+  int index_idx = -1;
+  for (uint key = 0; key < table->s->keys; key++) {
+    if (inner_field->field->key_start.is_set(key) &&
+        table->key_info[key].is_fb_vector_index() &&
+        table->keys_in_use_for_query.is_set(key)) {
+      index_idx = key;
+      break;
+    }
+  }
+  if (index_idx == -1) return;
+
+  assert(BitsetsAreCommitted(left_path));
+  assert(BitsetsAreCommitted(right_path));
+
+  // An index of normalized vectors only serves cosine searches; l2 ranks
+  // raw vectors, and embeddings of unit length the same way as cosine.
+  Item_func_fb_vector_distance *distance_func;
+  if (table->key_info[index_idx].fb_vector_index_config.normalized()) {
+    distance_func = new (m_thd->mem_root)
+        Item_func_fb_vector_cosine(inner_field, outer_embedding);
+  } else {
+    distance_func = new (m_thd->mem_root)
+        Item_func_fb_vector_l2(inner_field, outer_embedding);
+  }
+  if (distance_func == nullptr || distance_func->resolve_type(m_thd)) return;
+  distance_func->quick_fix_field();
+  distance_func->update_used_tables();
+  distance_func->m_limit = m_thd->variables.semantic_join_neighbors;
+
+  // Each outer row is paired with its neighbours, and the join conditions
+  // are evaluated on those pairs only.
+  const double candidates =
+      left_path->num_output_rows() *
+      std::min(static_cast<double>(distance_func->m_limit),
+               right_path->num_output_rows());
+  double num_output_rows = candidates;
+  double filter_cost = 0.0;
+  for (const CachedPropertiesForPredicate &properties :
+       edge->expr->properties_for_join_conditions) {
+    filter_cost += EstimateFilterCost(m_thd, candidates,
+                                      properties.contained_subqueries,
+                                      properties.semantic_cost)
+                       .cost_if_not_materialized;
+    num_output_rows *= properties.selectivity;
+  }
+
+  SemanticJoinParameters *param = new (m_thd->mem_root) SemanticJoinParameters;
+  if (param == nullptr) return;
+  param->distance_func = distance_func;
+  param->table = table;
+  param->idx = index_idx;
+
+  AccessPath join_path;
+  join_path.type = AccessPath::SEMANTIC_JOIN;
+  join_path.parameter_tables =
+      (left_path->parameter_tables | right_path->parameter_tables) &
+      ~(left | right);
+  join_path.semantic_join().outer = left_path;
+  join_path.semantic_join().inner = right_path;
+  join_path.semantic_join().join_predicate = edge;
+  join_path.semantic_join().param = param;
+  join_path.semantic_join().store_rowids = false;
+  join_path.semantic_join().tables_to_get_rowid_for = 0;
+
+  // Rows are buffered on both sides, so we need row IDs for any
+  // update/delete target tables, like for hash join.
+  if (Overlaps(m_update_delete_target_nodes, left | right)) {
+    FindTablesToGetRowidFor(&join_path);
+  }
+
+  // One search per outer row, then the neighbours are read at about the
+  // per-row cost of the scan they replace.
+  const double read_one_row_cost =
+      right_path->num_output_rows() > 0.0
+          ? right_path->cost / right_path->num_output_rows()
+          : 0.0;
+  const double cost =
+      left_path->cost +
+      left_path->num_output_rows() * kVectorIndexProbeCost +
+      candidates * (read_one_row_cost + kHashReturnOneRowCost) + filter_cost;
+
+  join_path.num_output_rows_before_filter = num_output_rows;
+  join_path.cost_before_filter = cost;
+  join_path.set_num_output_rows(num_output_rows);
+  join_path.cost = cost;
+  join_path.init_cost = left_path->init_cost;
+  join_path.init_once_cost = left_path->init_once_cost;
+  join_path.safe_for_rowid =
+      std::max(left_path->safe_for_rowid, right_path->safe_for_rowid);
+
+  if (m_trace != nullptr && !*wrote_trace) {
+    *m_trace += PrintSubgraphHeader(edge, join_path, left, right);
+    *wrote_trace = true;
+  }
+
+  for (bool materialize_subqueries : {false, true}) {
+    AccessPath new_path = join_path;
+    FunctionalDependencySet filter_fd_set;
+    ApplyDelayedPredicatesAfterJoin(
+        left, right, left_path, right_path, edge->expr->join_predicate_first,
+        edge->expr->join_predicate_last, materialize_subqueries, &new_path,
+        &filter_fd_set);
+    // Rows come out in no particular order.
+    new_path.ordering_state = m_orderings->ApplyFDs(
+        m_orderings->SetOrder(0), new_fd_set | filter_fd_set);
+    ProposeAccessPathWithOrderings(
+        left | right, new_fd_set | filter_fd_set, new_obsolete_orderings,
+        &new_path, materialize_subqueries ? "mat. subq." : "");
+
+    if (!Overlaps(new_path.filter_predicates,
+                  m_graph->materializable_predicates)) {
+      break;
+    }
+  }
+}
+
 // Of all delayed predicates, see which ones we can apply now, and which
 // ones that need to be delayed further.
 void CostingReceiver::ApplyDelayedPredicatesAfterJoin(
@@ -3646,8 +4122,9 @@ void CostingReceiver::ApplyDelayedPredicatesAfterJoin(
           !IsBitSet(pred.source_multiple_equality_idx,
                     multiple_equality_bitmap)) {
         if (!subsumed) {
-          FilterCost cost = EstimateFilterCost(
-              m_thd, join_path->num_output_rows(), pred.contained_subqueries);
+          FilterCost cost =
+              EstimateFilterCost(m_thd, join_path->num_output_rows(),
+                                 pred.contained_subqueries, pred.semantic_cost);
           if (materialize_subqueries) {
             join_path->cost += cost.cost_if_materialized;
             materialize_cost += cost.cost_to_materialize;
@@ -3962,16 +4439,19 @@ void CostingReceiver::ProposeNestedLoopJoin(
       MY_COMPILER_DIAGNOSTIC_POP()
       if (!subsumed) {
         equijoin_predicates.SetBit(join_cond_idx);
-        inner_rescan_cost += EstimateFilterCost(m_thd, rows_after_filtering,
-                                                properties.contained_subqueries)
-                                 .cost_if_not_materialized;
+        inner_rescan_cost +=
+            EstimateFilterCost(m_thd, rows_after_filtering,
+                               properties.contained_subqueries,
+                               properties.semantic_cost)
+                .cost_if_not_materialized;
         rows_after_filtering *= properties.selectivity;
       }
     }
     for (const CachedPropertiesForPredicate &properties :
          edge->expr->properties_for_join_conditions) {
       inner_rescan_cost += EstimateFilterCost(m_thd, rows_after_filtering,
-                                              properties.contained_subqueries)
+                                              properties.contained_subqueries,
+                                              properties.semantic_cost)
                                .cost_if_not_materialized;
       rows_after_filtering *= properties.selectivity;
     }
@@ -4333,6 +4813,18 @@ string PrintAccessPath(const AccessPath &path, const JoinHypergraph &graph,
       str += "BKA_JOIN";
       PrintJoinOrder(&path, &join_order);
       break;
+    case AccessPath::KNN_JOIN:
+      str += "KNN_JOIN";
+      PrintJoinOrder(&path, &join_order);
+      break;
+    case AccessPath::SPATIAL_JOIN:
+      str += "SPATIAL_JOIN";
+      PrintJoinOrder(&path, &join_order);
+      break;
+    case AccessPath::SEMANTIC_JOIN:
+      str += "SEMANTIC_JOIN";
+      PrintJoinOrder(&path, &join_order);
+      break;
     case AccessPath::HASH_JOIN:
       str += "HASH_JOIN";
       PrintJoinOrder(&path, &join_order);
@@ -4469,6 +4961,18 @@ void PrintJoinOrder(const AccessPath *path, string *join_order) {
         outer = subpath->bka_join().outer;
         inner = subpath->bka_join().inner;
         break;
+      case AccessPath::KNN_JOIN:
+        outer = subpath->knn_join().outer;
+        inner = subpath->knn_join().inner;
+        break;
+      case AccessPath::SPATIAL_JOIN:
+        outer = subpath->spatial_join().outer;
+        inner = subpath->spatial_join().inner;
+        break;
+      case AccessPath::SEMANTIC_JOIN:
+        outer = subpath->semantic_join().outer;
+        inner = subpath->semantic_join().inner;
+        break;
       case AccessPath::NESTED_LOOP_SEMIJOIN_WITH_DUPLICATE_REMOVAL:
         outer = subpath->nested_loop_semijoin_with_duplicate_removal().outer;
         inner = subpath->nested_loop_semijoin_with_duplicate_removal().inner;
@@ -6298,6 +6802,7 @@ static void CacheCostInfoForJoinConditions(THD *thd,
           cond, query_block, [&properties](const ContainedSubquery &subquery) {
             properties.contained_subqueries.push_back(subquery);
           });
+      properties.semantic_cost = EstimateSemanticCost(cond);
 
       // Cache information about what sargable conditions this join condition
       // would be redundant against, for RedundantThroughSargable().
@@ -6324,6 +6829,7 @@ static void CacheCostInfoForJoinConditions(THD *thd,
           cond, query_block, [&properties](const ContainedSubquery &subquery) {
             properties.contained_subqueries.push_back(subquery);
           });
+      properties.semantic_cost = EstimateSemanticCost(cond);
       edge.expr->properties_for_join_conditions.push_back(
           std::move(properties));
     }
@@ -6491,13 +6997,27 @@ AccessPath *FindBestQueryPlan(THD *thd, Query_block *query_block,
   }
   const secondary_engine_modify_access_path_cost_t secondary_engine_cost_hook =
       SecondaryEngineCostHook(thd);
+
+  // A prepared statement executed again needs the same simplification as
+  // before, so skip enumerating up to the limit and searching for it.
+  Query_block::Cached_graph_simplification &cached_simplification =
+      query_block->cached_graph_simplification;
+  const int subgraph_pair_limit = thd->variables.optimizer_max_subgraph_pairs;
+  const bool replay_simplification =
+      cached_simplification.steps > 0 && !graph.edges.empty() &&
+      cached_simplification.subgraph_pair_limit == subgraph_pair_limit &&
+      cached_simplification.statistics_version ==
+          histograms::statistics_version();
+  if (replay_simplification) {
+    ReplayQueryGraphSimplification(thd, cached_simplification.steps, &graph,
+                                   trace);
+  }
   CostingReceiver receiver(
       thd, query_block, graph, &orderings, &sort_ahead_orderings,
       &active_indexes, &fulltext_searches, fulltext_tables,
       sargable_fulltext_predicates, update_delete_target_tables,
       immediate_update_delete_candidates, need_rowid, EngineFlags(thd),
-      thd->variables.optimizer_max_subgraph_pairs, secondary_engine_cost_hook,
-      trace);
+      subgraph_pair_limit, secondary_engine_cost_hook, trace);
   if (graph.edges.empty()) {
     // Fast path for single-table queries. No need to run the join enumeration
     // when there is no join. Just visit the only node directly.
@@ -6507,8 +7027,13 @@ AccessPath *FindBestQueryPlan(THD *thd, Query_block *query_block,
     }
   } else if (EnumerateAllConnectedPartitions(graph.graph, &receiver) &&
              !thd->is_error() && join->zero_result_cause == nullptr) {
-    SimplifyQueryGraph(thd, thd->variables.optimizer_max_subgraph_pairs, &graph,
-                       trace);
+    // on top of the replayed steps, if the graph still was too large
+    cached_simplification.steps =
+        (replay_simplification ? cached_simplification.steps : 0) +
+        SimplifyQueryGraph(thd, subgraph_pair_limit, &graph, trace);
+    cached_simplification.subgraph_pair_limit = subgraph_pair_limit;
+    cached_simplification.statistics_version =
+        histograms::statistics_version();
 
     // Reset the receiver and run the query again, this time with
     // the simplified hypergraph (and no query limit, in case the
@@ -6646,7 +7171,8 @@ AccessPath *FindBestQueryPlan(THD *thd, Query_block *query_block,
             filter_predicates.SetBit(i);
             FilterCost cost =
                 EstimateFilterCost(thd, root_path->num_output_rows(),
-                                   graph.predicates[i].contained_subqueries);
+                                   graph.predicates[i].contained_subqueries,
+                                   graph.predicates[i].semantic_cost);
             if (materialize_subqueries) {
               path.cost += cost.cost_if_materialized;
               init_once_cost += cost.cost_to_materialize;
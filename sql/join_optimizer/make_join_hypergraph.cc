@@ -2791,6 +2791,13 @@ void SortPredicates(Predicate *begin, Predicate *end) {
   std::stable_partition(begin, end, [](const Predicate &pred) {
     return !pred.condition->is_expensive();
   });
+
+  // Semantic functions wait on the model for every row, which dwarfs any
+  // other predicate. Evaluate them after all others, on as few rows as
+  // possible.
+  std::stable_partition(begin, end, [](const Predicate &pred) {
+    return pred.semantic_cost == 0.0;
+  });
 }
 
 /**
@@ -2813,9 +2820,18 @@ int AddPredicate(THD *thd, Item *condition, bool was_join_condition,
   pred.used_nodes =
       GetNodeMapFromTableMap(used_tables, graph->table_num_to_node_num);
 
+  pred.semantic_cost = EstimateSemanticCost(condition);
+
   table_map total_eligibility_set;
   if (was_join_condition) {
     total_eligibility_set = used_tables;
+  } else if (pred.semantic_cost > 0.0) {
+    // A WHERE predicate calling the model is held back until all tables are
+    // joined, so that it only sees rows that passed every other predicate
+    // and join condition. Joins that repeat its input values are cheap, as
+    // repeated requests are served by the semantic cache.
+    total_eligibility_set =
+        root->tables_in_subtree & ~(INNER_TABLE_BIT | OUTER_REF_TABLE_BIT);
   } else {
     total_eligibility_set = FindTESForCondition(used_tables, root) &
                             ~(INNER_TABLE_BIT | OUTER_REF_TABLE_BIT);
@@ -3639,6 +3655,7 @@ bool MakeJoinHypergraph(THD *thd, string *trace, JoinHypergraph *graph,
         graph->table_num_to_node_num);
     assert(IsSingleBitSet(pred.total_eligibility_set));
     pred.selectivity = EstimateSelectivity(thd, condition, trace);
+    pred.semantic_cost = EstimateSemanticCost(condition);
     pred.functional_dependencies_idx.init(thd->mem_root);
     graph->predicates.push_back(std::move(pred));
   }
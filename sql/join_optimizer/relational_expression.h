@@ -42,6 +42,8 @@ class Item_eq_base;
 struct CachedPropertiesForPredicate {
   Mem_root_array<ContainedSubquery> contained_subqueries;
   double selectivity;
+  // See Predicate::semantic_cost.
+  double semantic_cost = 0.0;
 
   // For equijoins only: A bitmap of which sargable predicates
   // are part of the same multi-equality as this one (except the
@@ -121,6 +121,24 @@ void WalkAccessPaths(AccessPathPtr path, JoinPtr join,
       WalkAccessPaths(path->bka_join().inner, join, cross_query_blocks,
                       std::forward<Func &&>(func), post_order_traversal);
       break;
+    case AccessPath::KNN_JOIN:
+      WalkAccessPaths(path->knn_join().outer, join, cross_query_blocks,
+                      std::forward<Func &&>(func), post_order_traversal);
+      WalkAccessPaths(path->knn_join().inner, join, cross_query_blocks,
+                      std::forward<Func &&>(func), post_order_traversal);
+      break;
+    case AccessPath::SPATIAL_JOIN:
+      WalkAccessPaths(path->spatial_join().outer, join, cross_query_blocks,
+                      std::forward<Func &&>(func), post_order_traversal);
+      WalkAccessPaths(path->spatial_join().inner, join, cross_query_blocks,
+                      std::forward<Func &&>(func), post_order_traversal);
+      break;
+    case AccessPath::SEMANTIC_JOIN:
+      WalkAccessPaths(path->semantic_join().outer, join, cross_query_blocks,
+                      std::forward<Func &&>(func), post_order_traversal);
+      WalkAccessPaths(path->semantic_join().inner, join, cross_query_blocks,
+                      std::forward<Func &&>(func), post_order_traversal);
+      break;
     case AccessPath::HASH_JOIN:
       WalkAccessPaths(path->hash_join().outer, join, cross_query_blocks,
                       std::forward<Func &&>(func), post_order_traversal);
@@ -320,6 +338,9 @@ void WalkTablesUnderAccessPath(AccessPath *root_path, Func &&func,
           case AccessPath::FAKE_SINGLE_ROW:
           case AccessPath::FILTER:
           case AccessPath::HASH_JOIN:
+          case AccessPath::KNN_JOIN:
+          case AccessPath::SPATIAL_JOIN:
+          case AccessPath::SEMANTIC_JOIN:
           case AccessPath::LIMIT_OFFSET:
           case AccessPath::MATERIALIZE_INFORMATION_SCHEMA_TABLE:
           case AccessPath::NESTED_LOOP_JOIN:
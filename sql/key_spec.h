@@ -85,6 +85,7 @@ class KEY_CREATE_INFO {
   LEX_CSTRING m_fb_vector_index_type = EMPTY_CSTR;
   LEX_CSTRING m_fb_vector_trained_index_id = EMPTY_CSTR;
   LEX_CSTRING m_fb_vector_trained_index_table = EMPTY_CSTR;
+  LEX_CSTRING m_fb_vector_index_metric = EMPTY_CSTR;
   LEX_CSTRING m_next_spatial_index_type = EMPTY_CSTR;
 };
 
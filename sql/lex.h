@@ -93,6 +93,7 @@ static const SYMBOL symbols[] = {
     {SYM("ASC", ASC)},
     {SYM("ASCII", ASCII_SYM)},
     {SYM("ASENSITIVE", ASENSITIVE_SYM)},
+    {SYM("ASYNC", ASYNC_SYM)},
     {SYM("AT", AT_SYM)},
     {SYM("ATTRIBUTE", ATTRIBUTE_SYM)},
     {SYM("ATTACH", ATTACH_SYM)},
@@ -265,6 +266,7 @@ static const SYMBOL symbols[] = {
     {SYM("FAST", FAST_SYM)},
     {SYM("FAULTS", FAULTS_SYM)},
     {SYM("FB_VECTOR_DIMENSION", FB_VECTOR_DIMENSION_SYM)},
+    {SYM("FB_VECTOR_INDEX_METRIC", FB_VECTOR_INDEX_METRIC_SYM)},
     {SYM("FB_VECTOR_INDEX_TYPE", FB_VECTOR_INDEX_TYPE_SYM)},
     {SYM("FB_VECTOR_TRAINED_INDEX_ID", FB_VECTOR_TRAINED_INDEX_ID_SYM)},
     {SYM("FB_VECTOR_TRAINED_INDEX_TABLE", FB_VECTOR_TRAINED_INDEX_TABLE_SYM)},
@@ -334,6 +336,7 @@ static const SYMBOL symbols[] = {
     {SYM("IMPORT", IMPORT)},
     {SYM("IN", IN_SYM)},
     {SYM("INACTIVE", INACTIVE_SYM)},
+    {SYM("INCREMENTAL", INCREMENTAL_SYM)},
     {SYM("INDEX", INDEX_SYM)},
     {SYM("INDEXES", INDEXES)},
     {SYM("INFILE", INFILE_SYM)},
@@ -437,6 +440,7 @@ static const SYMBOL symbols[] = {
     {SYM("MASTER_USER", MASTER_USER_SYM)},
     {SYM("MASTER_ZSTD_COMPRESSION_LEVEL", MASTER_ZSTD_COMPRESSION_LEVEL_SYM)},
     {SYM("MATCH", MATCH)},
+    {SYM("MATERIALIZED", MATERIALIZED_SYM)},
     {SYM("MAX_CONNECTIONS_PER_HOUR", MAX_CONNECTIONS_PER_HOUR)},
     {SYM("MAX_QUERIES_PER_HOUR", MAX_QUERIES_PER_HOUR)},
     {SYM("MAX_ROWS", MAX_ROWS)},
@@ -579,6 +583,7 @@ static const SYMBOL symbols[] = {
     {SYM("REDUNDANT", REDUNDANT_SYM)},
     {SYM("REFERENCE", REFERENCE_SYM)},
     {SYM("REFERENCES", REFERENCES)},
+    {SYM("REFRESH", REFRESH_SYM)},
     {SYM("REGEXP", REGEXP)},
     {SYM("REGISTRATION", REGISTRATION_SYM)},
     {SYM("RELAY", RELAY)},
@@ -829,6 +834,7 @@ static const SYMBOL symbols[] = {
     {SYM("WHILE", WHILE_SYM)},
     {SYM("WINDOW", WINDOW_SYM)},
     {SYM("VCPU", VCPU_SYM)},
+    {SYM("VECTOR", VECTOR_SYM)},
     {SYM("VIEW", VIEW_SYM)},
     {SYM("VIRTUAL", VIRTUAL_SYM)},
     {SYM("VISIBLE", VISIBLE_SYM)},
@@ -944,6 +950,8 @@ static const SYMBOL symbols[] = {
     {SYM_H("GROUP_BY_LIS", GROUP_BY_LIS_HINT)},
     {SYM_H("NO_GROUP_BY_LIS", NO_GROUP_BY_LIS_HINT)},
     {SYM_H("RANGE_JOIN", RANGE_JOIN_HINT)},
-    {SYM_H("NO_RANGE_JOIN", NO_RANGE_JOIN_HINT)}};
+    {SYM_H("NO_RANGE_JOIN", NO_RANGE_JOIN_HINT)},
+    {SYM_H("RESULT_CACHE", RESULT_CACHE_HINT)},
+    {SYM_H("NO_RESULT_CACHE", NO_RESULT_CACHE_HINT)}};
 
 #endif /* LEX_INCLUDED */
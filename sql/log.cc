@@ -1105,6 +1105,11 @@ bool File_query_log::write_slow(THD *thd, ulonglong current_utime,
       goto err;
   }
 
+  if (!thd->engine_perf_context.empty() &&
+      my_b_printf(&log_file, "# Perf_context: %s\n",
+                  thd->engine_perf_context.c_str()) == (uint)-1)
+    goto err;
+
   if (thd->db().str && strcmp(thd->db().str, db)) {  // Database changed
     if (my_b_printf(&log_file, "use %s;\n", thd->db().str) == (uint)-1)
       goto err;
@@ -92,6 +92,7 @@
 #include "client/mysqlbinlog.h"
 #include "sql-common/json_binary.h"
 #include "sql-common/json_dom.h"  // Json_wrapper
+#include "sql/fb_vector_base.h"   // fb_vector_unpack_json
 #include "sql/json_diff.h"        // enum_json_diff_operation
 #endif
 
@@ -142,6 +143,7 @@
 #include "sql/rpl_reporting.h"
 #include "sql/rpl_rli.h"      // Relay_log_info
 #include "sql/rpl_rli_pdb.h"  // Slave_job_group
+#include "sql/rpl_shardbeats.h"  // update_shard_apply_time
 #include "sql/sp_head.h"      // sp_name
 #include "sql/sql_base.h"     // close_thread_tables
 #include "sql/sql_bitmap.h"
@@ -2270,6 +2272,14 @@ static size_t log_event_print_value(IO_CACHE *file, const uchar *ptr, uint type,
         const char *error = print_json_diff(file, ptr, length, col_name);
         if (error != nullptr)
           my_b_printf(file, "Error %s while printing JSON diff\n", error);
+      } else if (length > 0 && ptr[0] == FB_VECTOR_PACKED_JSON) {
+        Json_array array;
+        Json_wrapper wrapper(&array, true);
+        StringBuffer<STRING_BUFFER_USUAL_SIZE> s;
+        if (fb_vector_unpack_json(ptr, length, &array))
+          my_b_printf(file, "Invalid packed vector\n");
+        else if (json_wrapper_to_string(file, &s, &wrapper, true))
+          my_b_printf(file, "Failed to format JSON object as string.\n");
       } else {
         json_binary::Value value =
             json_binary::parse_binary((const char *)ptr, length);
@@ -10881,6 +10891,11 @@ int Rows_log_event::do_apply_event(Relay_log_info const *rli) {
     */
     thd->set_time(&(common_header->when));
 
+    if (write_throttle_shard_lag && thd->slave_thread)
+      update_shard_apply_time(table->s->db.str,
+                              common_header->when.tv_sec * 1000ULL +
+                                  common_header->when.tv_usec / 1000);
+
     thd->binlog_row_event_extra_data = m_extra_row_info.get_ndb_info();
 
     /*
@@ -13791,7 +13806,7 @@ binary_log::Log_event_type Update_rows_log_event::get_update_rows_event_type(
     const THD *thd_arg) {
   DBUG_TRACE;
   binary_log::Log_event_type type =
-      (thd_arg->variables.binlog_row_value_options != 0
+      ((thd_arg->variables.binlog_row_value_options & PARTIAL_JSON_UPDATES)
            ? binary_log::PARTIAL_UPDATE_ROWS_EVENT
            : (log_bin_use_v1_row_events ? binary_log::UPDATE_ROWS_EVENT_V1
                                         : binary_log::UPDATE_ROWS_EVENT));
@@ -15144,6 +15159,8 @@ bool Metadata_log_event::write_data_body(Basic_ostream *ostream) {
 
   if (write_prev_dbtids(ostream)) DBUG_RETURN(1);
 
+  if (write_compression_dictionaries(ostream)) DBUG_RETURN(1);
+
   DBUG_RETURN(0);
 }
 
@@ -15504,6 +15521,23 @@ bool Metadata_log_event::write_prev_dbtids(Basic_ostream *ostream) {
   DBUG_RETURN(error);
 }
 
+bool Metadata_log_event::write_compression_dictionaries(
+    Basic_ostream *ostream) {
+  DBUG_ENTER("Metadata_log_event::write_compression_dictionaries");
+
+  for (const auto &content : compression_dictionaries_) {
+    if (write_type_and_length(ostream,
+                              Metadata_event_types::COMPRESSION_DICTIONARY_TYPE,
+                              content.size()) ||
+        wrapper_my_b_safe_write(ostream, (const uchar *)content.data(),
+                                content.size())) {
+      DBUG_RETURN(true);
+    }
+  }
+
+  DBUG_RETURN(false);
+}
+
 bool Metadata_log_event::write_type_and_length(Basic_ostream *ostream,
                                                Metadata_event_types type,
                                                uint16_t length) {
@@ -15630,6 +15664,12 @@ int Metadata_log_event::pack_info(Protocol *protocol) {
     field_added = true;
   }
 
+  for (const auto &content : compression_dictionaries_) {
+    buffer.append("\tCompression dictionary: " +
+                  std::to_string(content.size()) + " bytes");
+    field_added = true;
+  }
+
   if (buffer.length() > 0)
     protocol->store_string(buffer.c_str(), buffer.length(), &my_charset_bin);
 
@@ -15709,6 +15749,10 @@ void Metadata_log_event::print(FILE * /* file */,
       }
     }
 
+    for (const auto &content : compression_dictionaries_)
+      buffer.append("\tCompression dictionary: " +
+                    std::to_string(content.size()) + " bytes");
+
     print_header(head, print_event_info, false);
     my_b_printf(head, "%s\n", buffer.c_str());
     print_base64(body, print_event_info, false);
@@ -15775,7 +15819,8 @@ Log_event::enum_skip_reason Metadata_log_event::do_shall_skip(
       does_exist(Metadata_event_types::RAFT_PREV_OPID_TYPE) ||
       does_exist(Metadata_event_types::RAFT_INGESTION_PREV_CHECKPOINT_TYPE) ||
       does_exist(Metadata_event_types::RAFT_INGESTION_PREV_UPPER_BOUND_TYPE) ||
-      does_exist(Metadata_event_types::PREV_DBTIDS_TYPE))
+      does_exist(Metadata_event_types::PREV_DBTIDS_TYPE) ||
+      does_exist(Metadata_event_types::COMPRESSION_DICTIONARY_TYPE))
     return Log_event::EVENT_SKIP_IGNORE;
 
   return Log_event::EVENT_SKIP_NOT;
@@ -16863,6 +16908,35 @@ bool Rows_log_event::parse_keys(Relay_log_info *rli, TABLE *table,
       curr_key.key_buffer = tmp;
       keys.push_back(curr_key);
     }
+
+    // Index entries other rows share, see handler::shared_index_entries()
+    std::vector<std::string> shared_entries;
+    if (table->file->shared_index_entries(table->record[0], &shared_entries)) {
+      sql_print_error(
+          "Unable to read the shared index entries of a row at %s:%llu, "
+          "syncing group",
+          rli->get_rpl_log_name(), common_header->log_pos);
+      clear_all_errors(rli->info_thd, rli);
+      DBUG_RETURN(false);
+    }
+    for (const std::string &entry : shared_entries) {
+      Dependency_key curr_key;
+      curr_key.table_id = m_table_name;
+      curr_key.key_length = entry.size();
+      key_buf = (uchar *)my_malloc(key_memory_log_event, curr_key.key_length,
+                                   MYF(MY_WME));
+      if (!key_buf) {
+        sql_print_error(
+            "Unable to allocate memory for dependency key at "
+            "%s:%llu, syncing group",
+            rli->get_rpl_log_name(), common_header->log_pos);
+        clear_all_errors(rli->info_thd, rli);
+        DBUG_RETURN(false);
+      }
+      memcpy(key_buf, entry.data(), curr_key.key_length);
+      curr_key.key_buffer = std::shared_ptr<uchar>(key_buf, key_dealloc_cb);
+      keys.push_back(curr_key);
+    }
   }
   // dbug case: either all BIs and AIs will have keys, or only all BIs will have
   // keys
@@ -2843,6 +2843,9 @@ class Rows_log_event : public virtual binary_log::Rows_event, public Log_event {
   MY_BITMAP const *get_cols_ai() const { return &m_cols_ai; }
   size_t get_width() const { return m_width; }
   const Table_id &get_table_id() const { return m_table_id; }
+  /// The packed rows of the event, up to get_rows_end().
+  const uchar *get_rows_buf() const { return m_rows_buf; }
+  const uchar *get_rows_end() const { return m_rows_cur; }
 
 #if defined(MYSQL_SERVER)
   /**
@@ -4224,6 +4227,15 @@ class Metadata_log_event : public binary_log::Metadata_event, public Log_event {
    */
   bool write_prev_dbtids(Basic_ostream *ostream);
 
+  /**
+   * Write compression dictionaries
+   *
+   * @param ostream - stream to write to
+   *
+   * @returns - 0 on success, 1 on false
+   */
+  bool write_compression_dictionaries(Basic_ostream *ostream);
+
   /**
    * Write type and length to file
    *
@@ -0,0 +1,147 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/malloc_arena.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include "my_config.h"
+#include "my_sys.h"
+#include "sql/psi_memory_key.h"
+
+#ifdef HAVE_JEMALLOC
+#include <jemalloc/jemalloc.h>
+#endif
+
+bool malloc_subsystem_arenas;
+long malloc_arena_dirty_decay_ms;
+long malloc_arena_muzzy_decay_ms;
+
+#ifdef HAVE_JEMALLOC
+namespace {
+
+/** jemalloc index of each arena, 0 until created */
+std::atomic<unsigned> arena_index[MALLOC_ARENA_END];
+
+/** serializes malloc_arenas_update() */
+std::mutex arena_update_mutex;
+
+/** allocator mysys calls for routed keys, @see my_malloc_route_key() */
+void *arena_malloc(unsigned route, size_t size, myf flags) {
+  if (route >= MALLOC_ARENA_END) return nullptr;
+  const unsigned index = arena_index[route].load(std::memory_order_relaxed);
+  if (index == 0) return nullptr;
+  /* A thread cache would hand the blocks to other arenas' callers. */
+  int mallocx_flags = MALLOCX_ARENA(index) | MALLOCX_TCACHE_NONE;
+  if (flags & MY_ZEROFILL) mallocx_flags |= MALLOCX_ZERO;
+  return mallocx(size, mallocx_flags);
+}
+
+bool set_arena_decay(unsigned index, const char *name, long value) {
+  const std::string ctl =
+      "arena." + std::to_string(index) + "." + std::string(name);
+  ssize_t decay_ms = value;
+  return mallctl(ctl.c_str(), nullptr, nullptr, &decay_ms,
+                 sizeof(decay_ms)) != 0;
+}
+
+bool read_arena_stat(unsigned index, const char *name, size_t *value) {
+  const std::string ctl =
+      "stats.arenas." + std::to_string(index) + "." + std::string(name);
+  size_t len = sizeof(*value);
+  return mallctl(ctl.c_str(), value, &len, nullptr, 0) != 0;
+}
+
+}  // namespace
+#endif  // HAVE_JEMALLOC
+
+bool malloc_arenas_update() {
+#ifdef HAVE_JEMALLOC
+  std::lock_guard<std::mutex> guard(arena_update_mutex);
+  if (!malloc_subsystem_arenas) {
+    /* Routed blocks already handed out stay valid, free() finds them. */
+    my_malloc_route_key(key_memory_hash_join, MALLOC_ARENA_NONE);
+    return false;
+  }
+
+  bool error = false;
+  for (unsigned arena = MALLOC_ARENA_NONE + 1; arena < MALLOC_ARENA_END;
+       ++arena) {
+    unsigned index = arena_index[arena].load();
+    if (index == 0) {
+      size_t len = sizeof(index);
+      if (mallctl("arenas.create", &index, &len, nullptr, 0) != 0) {
+        error = true;
+        continue;
+      }
+      arena_index[arena].store(index);
+    }
+    error |= set_arena_decay(index, "dirty_decay_ms",
+                             malloc_arena_dirty_decay_ms);
+    error |= set_arena_decay(index, "muzzy_decay_ms",
+                             malloc_arena_muzzy_decay_ms);
+  }
+
+  my_malloc_set_routed_allocator(arena_malloc);
+  my_malloc_route_key(key_memory_hash_join, MALLOC_ARENA_HASH_JOIN);
+  return error;
+#else
+  return false;
+#endif
+}
+
+bool malloc_arena_stats(enum_malloc_arena arena [[maybe_unused]],
+                        ulonglong *resident, ulonglong *dirty) {
+  *resident = 0;
+  *dirty = 0;
+#ifdef HAVE_JEMALLOC
+  const unsigned index = arena_index[arena].load();
+  if (index == 0) return false;
+
+  size_t value = 0;
+  if (!read_arena_stat(index, "resident", &value)) *resident = value;
+  size_t page = 0;
+  size_t len = sizeof(page);
+  if (!read_arena_stat(index, "pdirty", &value) &&
+      mallctl("arenas.page", &page, &len, nullptr, 0) == 0)
+    *dirty = value * page;
+  return true;
+#else
+  return false;
+#endif
+}
+
+Malloc_arena_scope::Malloc_arena_scope(enum_malloc_arena arena
+                                       [[maybe_unused]]) {
+#ifdef HAVE_JEMALLOC
+  if (!malloc_subsystem_arenas) return;
+  unsigned index = arena_index[arena].load(std::memory_order_relaxed);
+  if (index == 0) return;
+  size_t len = sizeof(m_saved_arena);
+  m_moved = mallctl("thread.arena", &m_saved_arena, &len, &index,
+                    sizeof(index)) == 0;
+#endif
+}
+
+Malloc_arena_scope::~Malloc_arena_scope() {
+#ifdef HAVE_JEMALLOC
+  if (m_moved)
+    mallctl("thread.arena", nullptr, nullptr, &m_saved_arena,
+            sizeof(m_saved_arena));
+#endif
+}
@@ -0,0 +1,86 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+/**
+  @file
+  Dedicated jemalloc arenas for the subsystems whose allocations come and go
+  in bursts, so that the pages they leave behind do not fragment the arenas
+  the rest of the server allocates from.
+
+  Hash joins allocate through my_malloc() with key_memory_hash_join, which
+  mysys routes to the hash join arena, @see my_malloc_route_key(). Vector
+  searches and model calls allocate mostly through std containers, so they
+  are routed by binding the thread to their arena for the duration of the
+  call, @see Malloc_arena_scope. The MyRocks block cache already has an
+  arena of its own.
+
+  Each arena purges dirty and muzzy pages after malloc_arena_dirty_decay_ms
+  and malloc_arena_muzzy_decay_ms. Without jemalloc all of this is a no-op.
+*/
+
+#include "my_inttypes.h"
+
+enum enum_malloc_arena {
+  MALLOC_ARENA_NONE = 0,
+  MALLOC_ARENA_HASH_JOIN,
+  MALLOC_ARENA_VECTOR,
+  MALLOC_ARENA_SEMANTIC,
+  MALLOC_ARENA_END
+};
+
+/// Whether the subsystems allocate from their own arenas.
+extern bool malloc_subsystem_arenas;
+
+/// Milliseconds before unused dirty pages of the arenas are purged.
+extern long malloc_arena_dirty_decay_ms;
+
+/// Milliseconds before unused muzzy pages of the arenas are released.
+extern long malloc_arena_muzzy_decay_ms;
+
+/**
+  Create the arenas and apply the settings above, or stop routing to the
+  arenas when malloc_subsystem_arenas is off. Called at startup and when
+  one of the settings changes.
+  @return true if jemalloc refused a setting
+*/
+bool malloc_arenas_update();
+
+/**
+  Resident bytes and dirty bytes of an arena.
+  @return false if the arena was not created
+*/
+bool malloc_arena_stats(enum_malloc_arena arena, ulonglong *resident,
+                        ulonglong *dirty);
+
+/**
+  Binds the calling thread to the arena of a subsystem, and back to the
+  arena it had when the scope ends.
+*/
+class Malloc_arena_scope {
+ public:
+  explicit Malloc_arena_scope(enum_malloc_arena arena);
+  ~Malloc_arena_scope();
+
+  Malloc_arena_scope(const Malloc_arena_scope &) = delete;
+  Malloc_arena_scope &operator=(const Malloc_arena_scope &) = delete;
+
+ private:
+  /// Arena index to go back to.
+  unsigned m_saved_arena{0};
+  bool m_moved{false};
+};
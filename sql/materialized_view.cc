@@ -0,0 +1,1397 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/materialized_view.h"
+
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lex_string.h"
+#include "m_ctype.h"
+#include "my_bitmap.h"
+#include "my_dbug.h"
+#include "my_sys.h"
+#include "mysql/psi/mysql_cond.h"
+#include "mysql/psi/mysql_file.h"
+#include "mysql/psi/mysql_mutex.h"
+#include "mysqld_error.h"
+#include "sql/binlog.h"
+#include "sql/binlog_reader.h"
+#include "sql/dd/cache/dictionary_client.h"
+#include "sql/dd/properties.h"
+#include "sql/dd/string_type.h"
+#include "sql/dd/types/abstract_table.h"
+#include "sql/dd/types/table.h"
+#include "sql/field.h"
+#include "sql/field_common_properties.h"
+#include "sql/handler.h"
+#include "sql/log.h"
+#include "sql/log_event.h"
+#include "sql/mdl.h"
+#include "sql/mysqld.h"
+#include "sql/rpl_utility.h"
+#include "sql/sql_base.h"
+#include "sql/sql_class.h"
+#include "sql/sql_error.h"
+#include "sql/sql_prepare.h"
+#include "sql/strfunc.h"
+#include "sql/table.h"
+#include "sql/transaction.h"
+#include "sql_string.h"
+#include "template_utils.h"
+
+ulong materialized_view_max_delta_rows;
+std::atomic<uint> materialized_view_count{0};
+
+/// The views a table is a source of.
+struct Materialized_view_watch {
+  struct Entry {
+    ulonglong view_id;
+    size_t source;
+    /// The key columns of the source, nullptr if some are missing from the
+    /// table, when any change has the view recomputed in full.
+    Field **key_fields;
+    size_t key_count;
+  };
+  Entry *entries;
+  size_t count;
+};
+
+namespace {
+
+/// Option of the table of a view holding its packed definition.
+const char *const DEFINITION_KEY = "materialized_view";
+
+/// Version of the packed definition.
+const ulonglong DEFINITION_VERSION = 1;
+
+/// Most changed rows a refresh statement deletes or derives again.
+const size_t KEYS_PER_STATEMENT = 1000;
+
+/// File of the data directory holding the checkpoints of the views.
+const char *const CHECKPOINT_FILE = "#materialized_views";
+
+/// Version of the checkpoint file.
+const ulonglong CHECKPOINT_VERSION = 1;
+
+/// The key of a changed row, as a literal per key column.
+using Mv_key = std::vector<std::string>;
+
+/// The rows of the sources of a view changed since its last refresh.
+struct Changes {
+  /// Keys of the changed rows, by source.
+  std::vector<std::set<Mv_key>> keys;
+  size_t key_count = 0;
+  /// Whether the view is to be recomputed in full.
+  bool full = false;
+
+  bool empty() const { return !full && key_count == 0; }
+
+  void set_full() {
+    keys.clear();
+    key_count = 0;
+    full = true;
+  }
+
+  void add(size_t source, Mv_key key) {
+    if (full) return;
+    if (keys.size() <= source) keys.resize(source + 1);
+    if (keys[source].insert(std::move(key)).second &&
+        ++key_count > materialized_view_max_delta_rows)
+      set_full();
+  }
+
+  void merge(Changes &&other) {
+    if (other.full) set_full();
+    for (size_t source = 0; !full && source < other.keys.size(); source++) {
+      std::set<Mv_key> &other_keys = other.keys[source];
+      while (!full && !other_keys.empty()) {
+        add(source, std::move(other_keys.extract(other_keys.begin()).value()));
+      }
+    }
+    other = Changes();
+  }
+};
+
+/// A position in the binary log, by the base name of its file.
+struct Binlog_position {
+  std::string file;
+  ulonglong pos = 0;
+
+  bool empty() const { return file.empty(); }
+
+  bool operator<(const Binlog_position &other) const {
+    // the number of a file may outgrow its zero padding
+    if (file.length() != other.file.length())
+      return file.length() < other.file.length();
+    return file != other.file ? file < other.file : pos < other.pos;
+  }
+  bool operator!=(const Binlog_position &other) const {
+    return file != other.file || pos != other.pos;
+  }
+};
+
+/// A view maintained since it was created or first refreshed.
+struct View {
+  ulonglong id;
+  std::string db;
+  std::string name;
+  std::string packed;
+  Materialized_view_definition def;
+  /// Guarded by LOCK_materialized_views.
+  Changes changes;
+  /// Whether a refresh is running. Guarded by LOCK_materialized_views.
+  bool refreshing = false;
+  /// Where the first refresh is to read the changes made while the server
+  /// was down from, empty if it has nothing to read. Guarded by
+  /// LOCK_materialized_views.
+  Binlog_position recover_from;
+  /// Whether a source was written without binary logging, when the view
+  /// is no longer checkpointed. Guarded by LOCK_materialized_views.
+  bool unlogged = false;
+};
+
+/// Where the binary log holds the changes a view does not reflect from.
+struct Checkpoint {
+  /// The definition of the view checkpointed.
+  std::string packed;
+  Binlog_position position;
+};
+
+mysql_mutex_t LOCK_materialized_views;
+/// Signalled when a refresh ends.
+mysql_cond_t COND_materialized_views;
+
+/// Maintained views by id. Guarded by LOCK_materialized_views.
+std::map<ulonglong, std::shared_ptr<View>> views;
+ulonglong next_view_id = 1;
+
+/// Where the binary log ended when each logged transaction with changes
+/// of views first wrote a source. Guarded by LOCK_materialized_views.
+std::multiset<Binlog_position> in_flight;
+
+/// Taken before LOCK_materialized_views.
+mysql_mutex_t LOCK_materialized_view_checkpoints;
+
+/// The checkpoints by database and view, read from their file on first
+/// use. Guarded by LOCK_materialized_view_checkpoints.
+std::map<std::pair<std::string, std::string>, Checkpoint> checkpoints;
+bool checkpoints_loaded = false;
+
+/// Bumped whenever views are added or removed, so that tables look up
+/// their views again.
+std::atomic<ulonglong> registry_version{1};
+
+}  // namespace
+
+/// The changes a transaction made so far, by view id.
+struct Materialized_view_deltas {
+  std::map<ulonglong, Changes> views;
+  /// Where the binary log ended when the transaction first wrote a source,
+  /// empty if the transaction is not logged.
+  Binlog_position start;
+};
+
+namespace {
+
+void pack_field(std::string *out, const std::string &value) {
+  out->append(std::to_string(value.length())).append(1, ':').append(value);
+}
+
+bool unpack_field(const std::string &packed, size_t *pos, std::string *value) {
+  const size_t colon = packed.find(':', *pos);
+  if (colon == std::string::npos || colon == *pos || colon - *pos > 19)
+    return true;
+  size_t length = 0;
+  for (size_t i = *pos; i < colon; i++) {
+    if (packed[i] < '0' || packed[i] > '9') return true;
+    length = length * 10 + (packed[i] - '0');
+  }
+  if (length > packed.length() - colon - 1) return true;
+  value->assign(packed, colon + 1, length);
+  *pos = colon + 1 + length;
+  return false;
+}
+
+bool unpack_number(const std::string &packed, size_t *pos, ulonglong *value) {
+  std::string digits;
+  if (unpack_field(packed, pos, &digits) || digits.empty() ||
+      digits.length() > 20)
+    return true;
+  *value = 0;
+  for (char digit : digits) {
+    if (digit < '0' || digit > '9') return true;
+    *value = *value * 10 + (digit - '0');
+  }
+  return false;
+}
+
+/// Where the binary log ends, empty if it is not open.
+Binlog_position binlog_end() {
+  Binlog_position end;
+  if (!mysql_bin_log.is_open()) return end;
+  LOG_INFO info;
+  mysql_bin_log.lock_binlog_end_pos();
+  mysql_bin_log.get_current_log_without_lock_log(&info);
+  mysql_bin_log.unlock_binlog_end_pos();
+  end.file = info.log_file_name + dirname_length(info.log_file_name);
+  end.pos = info.pos;
+  return end;
+}
+
+std::string checkpoint_path() {
+  char path[FN_REFLEN];
+  fn_format(path, CHECKPOINT_FILE, mysql_real_data_home, "",
+            MY_UNPACK_FILENAME);
+  return path;
+}
+
+/// Read the checkpoints from their file, once. Caller holds the lock.
+void load_checkpoints() {
+  mysql_mutex_assert_owner(&LOCK_materialized_view_checkpoints);
+  if (checkpoints_loaded) return;
+  checkpoints_loaded = true;
+  const File file = mysql_file_open(key_file_misc, checkpoint_path().c_str(),
+                                    O_RDONLY, MYF(0));
+  if (file < 0) return;
+  std::string packed;
+  uchar buffer[4096];
+  size_t length;
+  while ((length = mysql_file_read(file, buffer, sizeof(buffer), MYF(0))) !=
+             0 &&
+         length != MY_FILE_ERROR)
+    packed.append(pointer_cast<const char *>(buffer), length);
+  mysql_file_close(file, MYF(0));
+
+  size_t pos = 0;
+  ulonglong version = 0;
+  ulonglong count = 0;
+  bool error = length != 0 || unpack_number(packed, &pos, &version) ||
+               version != CHECKPOINT_VERSION ||
+               unpack_number(packed, &pos, &count);
+  for (ulonglong i = 0; !error && i < count; i++) {
+    std::pair<std::string, std::string> view;
+    Checkpoint checkpoint;
+    error = unpack_field(packed, &pos, &view.first) ||
+            unpack_field(packed, &pos, &view.second) ||
+            unpack_field(packed, &pos, &checkpoint.packed) ||
+            unpack_field(packed, &pos, &checkpoint.position.file) ||
+            unpack_number(packed, &pos, &checkpoint.position.pos);
+    if (!error) checkpoints[view] = std::move(checkpoint);
+  }
+  if (error || pos != packed.length()) {
+    // the views are recomputed in full
+    checkpoints.clear();
+    sql_print_warning("Ignoring the corrupt materialized view checkpoints %s",
+                      checkpoint_path().c_str());
+  }
+}
+
+/**
+  Write the checkpoints to their file, replacing it at once, so that a
+  crash leaves either version. Caller holds the lock.
+*/
+void write_checkpoints() {
+  mysql_mutex_assert_owner(&LOCK_materialized_view_checkpoints);
+  std::string out;
+  pack_field(&out, std::to_string(CHECKPOINT_VERSION));
+  pack_field(&out, std::to_string(checkpoints.size()));
+  for (const auto &view_checkpoint : checkpoints) {
+    pack_field(&out, view_checkpoint.first.first);
+    pack_field(&out, view_checkpoint.first.second);
+    pack_field(&out, view_checkpoint.second.packed);
+    pack_field(&out, view_checkpoint.second.position.file);
+    pack_field(&out, std::to_string(view_checkpoint.second.position.pos));
+  }
+
+  const std::string path = checkpoint_path();
+  const std::string temp = path + ".tmp";
+  const File file = mysql_file_create(key_file_misc, temp.c_str(), 0640,
+                                      O_WRONLY | O_TRUNC, MYF(0));
+  bool error = file < 0 ||
+               mysql_file_write(file, pointer_cast<const uchar *>(out.data()),
+                                out.length(), MYF(MY_NABP)) != 0 ||
+               mysql_file_sync(file, MYF(0)) != 0;
+  if (file >= 0 && mysql_file_close(file, MYF(0)) != 0) error = true;
+  if (error ||
+      mysql_file_rename(key_file_misc, temp.c_str(), path.c_str(), MYF(0)))
+    sql_print_warning(
+        "Could not write the materialized view checkpoints %s (errno= %d)",
+        path.c_str(), my_errno());
+}
+
+/**
+  The checkpoint of a view, empty if it has none or it was taken of
+  another definition.
+*/
+Binlog_position checkpoint_of(const std::string &db, const std::string &name,
+                              const std::string &packed) {
+  Binlog_position position;
+  mysql_mutex_lock(&LOCK_materialized_view_checkpoints);
+  load_checkpoints();
+  const auto it = checkpoints.find({db, name});
+  if (it != checkpoints.end() && it->second.packed == packed)
+    position = it->second.position;
+  mysql_mutex_unlock(&LOCK_materialized_view_checkpoints);
+  return position;
+}
+
+/// Drop the checkpoint of a view, if any.
+void erase_checkpoint(const std::string &db, const std::string &name) {
+  mysql_mutex_lock(&LOCK_materialized_view_checkpoints);
+  load_checkpoints();
+  if (checkpoints.erase({db, name}) != 0) write_checkpoints();
+  mysql_mutex_unlock(&LOCK_materialized_view_checkpoints);
+}
+
+/// Append a name quoted as an identifier.
+void append_name(std::string *out, const std::string &name) {
+  out->append(1, '`');
+  for (char c : name) {
+    if (c == '`') out->append(1, '`');
+    out->append(1, c);
+  }
+  out->append(1, '`');
+}
+
+std::string quoted_table_name(const std::string &db, const std::string &name) {
+  std::string out;
+  append_name(&out, db);
+  out.append(1, '.');
+  append_name(&out, name);
+  return out;
+}
+
+/**
+  Append the value of a field as a literal comparing equal to it, whatever
+  the character set of the statement.
+*/
+void append_literal(std::string *out, Field *field) {
+  if (field->is_null()) {
+    out->append("NULL");
+    return;
+  }
+  const bool temporal = is_temporal_type(field->type());
+  if (!temporal && field->result_type() == INT_RESULT) {
+    const longlong value = field->val_int();
+    out->append(field->is_unsigned()
+                    ? std::to_string(static_cast<ulonglong>(value))
+                    : std::to_string(value));
+    return;
+  }
+  String buffer;
+  const String *value = field->val_str(&buffer);
+  if (temporal || field->result_type() == DECIMAL_RESULT) {
+    if (temporal) out->append(1, '\'');
+    out->append(value->ptr(), value->length());
+    if (temporal) out->append(1, '\'');
+    return;
+  }
+  static const char hex[] = "0123456789ABCDEF";
+  const CHARSET_INFO *cs = field->charset();
+  out->append(1, '_').append(cs->csname).append(" X'");
+  for (size_t i = 0; i < value->length(); i++) {
+    const uchar c = static_cast<uchar>((*value)[i]);
+    out->append(1, hex[c >> 4]).append(1, hex[c & 0xF]);
+  }
+  out->append(1, '\'');
+  if (cs != &my_charset_bin) out->append(" COLLATE ").append(cs->m_coll_name);
+}
+
+/// Condition matching the rows with a key, on columns qualified by prefix.
+void append_key_condition(std::string *out, const std::string &prefix,
+                          const std::vector<std::string> &columns,
+                          const Mv_key &key) {
+  if (key.empty()) {
+    out->append("true");
+    return;
+  }
+  for (size_t i = 0; i < key.size(); i++) {
+    if (i > 0) out->append(" and ");
+    out->append(prefix);
+    append_name(out, columns[i]);
+    out->append(" <=> ").append(key[i]);
+  }
+}
+
+/// Add a view, replacing any of the same name. Caller holds the lock.
+std::shared_ptr<View> register_view(const std::string &db,
+                                    const std::string &name,
+                                    const std::string &packed,
+                                    Materialized_view_definition &&def,
+                                    bool full) {
+  mysql_mutex_assert_owner(&LOCK_materialized_views);
+  for (auto it = views.begin(); it != views.end();) {
+    if (it->second->db == db && it->second->name == name)
+      it = views.erase(it);
+    else
+      ++it;
+  }
+  auto view = std::make_shared<View>();
+  view->id = next_view_id++;
+  view->db = db;
+  view->name = name;
+  view->packed = packed;
+  view->def = std::move(def);
+  if (full) view->changes.set_full();
+  views.emplace(view->id, view);
+  materialized_view_count = views.size();
+  registry_version++;
+  return view;
+}
+
+/// Remove the view of a name, if any. Caller holds the lock.
+void unregister_view(const std::string &db, const std::string &name) {
+  mysql_mutex_assert_owner(&LOCK_materialized_views);
+  for (auto it = views.begin(); it != views.end(); ++it) {
+    if (it->second->db == db && it->second->name == name) {
+      views.erase(it);
+      materialized_view_count = views.size();
+      registry_version++;
+      return;
+    }
+  }
+}
+
+/// Remove a view unless it was replaced already.
+void unregister_view_id(ulonglong id) {
+  mysql_mutex_lock(&LOCK_materialized_views);
+  if (views.erase(id) != 0) {
+    materialized_view_count = views.size();
+    registry_version++;
+  }
+  mysql_mutex_unlock(&LOCK_materialized_views);
+}
+
+/**
+  The views a table is a source of, looked up again whenever views were
+  added or removed since. Kept on the mem_root of the table.
+*/
+const Materialized_view_watch *resolve_watch(TABLE *table) {
+  const ulonglong version = registry_version.load();
+  if (table->mv_registry_version == version) return table->mv_watch;
+
+  const char *db = table->s->db.str;
+  const char *table_name = table->s->table_name.str;
+  // the views and the sources of each that are this table
+  std::vector<std::pair<std::shared_ptr<View>, size_t>> found;
+  mysql_mutex_lock(&LOCK_materialized_views);
+  for (const auto &id_view : views) {
+    const std::vector<Materialized_view_source> &sources =
+        id_view.second->def.sources;
+    for (size_t s = 0; s < sources.size(); s++) {
+      if (sources[s].db == db && sources[s].table_name == table_name)
+        found.emplace_back(id_view.second, s);
+    }
+  }
+  mysql_mutex_unlock(&LOCK_materialized_views);
+
+  auto *watch = new (&table->mem_root) Materialized_view_watch();
+  auto *entries =
+      table->mem_root.ArrayAlloc<Materialized_view_watch::Entry>(found.size());
+  if (watch == nullptr || (entries == nullptr && !found.empty()))
+    return nullptr;
+  watch->entries = entries;
+  watch->count = found.size();
+  for (size_t i = 0; i < found.size(); i++) {
+    const Materialized_view_source &source =
+        found[i].first->def.sources[found[i].second];
+    Materialized_view_watch::Entry &entry = entries[i];
+    entry.view_id = found[i].first->id;
+    entry.source = found[i].second;
+    entry.key_count = source.key_columns.size();
+    entry.key_fields = table->mem_root.ArrayAlloc<Field *>(entry.key_count);
+    for (size_t k = 0; entry.key_fields != nullptr && k < entry.key_count;
+         k++) {
+      Field *key_field = nullptr;
+      for (Field **field = table->field; *field != nullptr; field++) {
+        if (my_strcasecmp(system_charset_info, (*field)->field_name,
+                          source.key_columns[k].c_str()) == 0) {
+          key_field = *field;
+          break;
+        }
+      }
+      entry.key_fields[k] = key_field;
+      if (key_field == nullptr) entry.key_fields = nullptr;
+    }
+  }
+  table->mv_watch = watch;
+  table->mv_registry_version = version;
+  return watch;
+}
+
+/**
+  Checkpoint a view once a refresh committed, unless a source was written
+  without binary logging since the server started.
+*/
+void store_checkpoint(const View &view, const Binlog_position &position) {
+  mysql_mutex_lock(&LOCK_materialized_view_checkpoints);
+  load_checkpoints();
+  mysql_mutex_lock(&LOCK_materialized_views);
+  const bool unlogged = view.unlogged;
+  mysql_mutex_unlock(&LOCK_materialized_views);
+  Checkpoint &checkpoint = checkpoints[{view.db, view.name}];
+  if (!unlogged && (checkpoint.packed != view.packed ||
+                    checkpoint.position != position)) {
+    checkpoint.packed = view.packed;
+    checkpoint.position = position;
+    write_checkpoints();
+  }
+  mysql_mutex_unlock(&LOCK_materialized_view_checkpoints);
+}
+
+/**
+  Stop checkpointing a view a transaction writes a source of without
+  binary logging, the log not holding its changes.
+*/
+void mark_unlogged(ulonglong view_id) {
+  std::string db;
+  std::string name;
+  mysql_mutex_lock(&LOCK_materialized_views);
+  const auto it = views.find(view_id);
+  if (it != views.end() && !it->second->unlogged) {
+    it->second->unlogged = true;
+    db = it->second->db;
+    name = it->second->name;
+  }
+  mysql_mutex_unlock(&LOCK_materialized_views);
+  if (!name.empty()) erase_checkpoint(db, name);
+}
+
+/// The changes of a transaction, in flight from where the binary log ends
+/// if the transaction is logged.
+Materialized_view_deltas *begin_deltas(THD *thd) {
+  auto *deltas = new Materialized_view_deltas;
+  if (thd->is_current_stmt_binlog_disabled()) return deltas;
+  mysql_mutex_lock(&LOCK_materialized_views);
+  deltas->start = binlog_end();
+  if (!deltas->start.empty()) in_flight.insert(deltas->start);
+  mysql_mutex_unlock(&LOCK_materialized_views);
+  return deltas;
+}
+
+Changes *transaction_changes(THD *thd, ulonglong view_id) {
+  if (thd->mv_deltas == nullptr) thd->mv_deltas = begin_deltas(thd);
+  std::map<ulonglong, Changes> &deltas = thd->mv_deltas->views;
+  auto it = deltas.find(view_id);
+  if (it == deltas.end()) {
+    if (thd->mv_deltas->start.empty()) mark_unlogged(view_id);
+    it = deltas.emplace(view_id, Changes()).first;
+  }
+  return &it->second;
+}
+
+/**
+  Look up the table of a view.
+  @param[out] exists whether the table exists
+  @param[out] packed the definition stored with the table, empty if it is
+    not a materialized view
+*/
+bool lookup_view(THD *thd, const std::string &db, const std::string &name,
+                 bool *exists, std::string *packed) {
+  MDL_request mdl_request;
+  MDL_REQUEST_INIT(&mdl_request, MDL_key::TABLE, db.c_str(), name.c_str(),
+                   MDL_SHARED, MDL_EXPLICIT);
+  if (thd->mdl_context.acquire_lock_nsec(
+          &mdl_request, thd->variables.lock_wait_timeout_nsec))
+    return true;
+  bool error;
+  {
+    dd::cache::Dictionary_client::Auto_releaser releaser(thd->dd_client());
+    const dd::Abstract_table *table = nullptr;
+    error = thd->dd_client()->acquire(db.c_str(), name.c_str(), &table);
+    *exists = !error && table != nullptr;
+    packed->clear();
+    dd::String_type value;
+    if (*exists && table->type() == dd::enum_table_type::BASE_TABLE &&
+        table->options().exists(DEFINITION_KEY) &&
+        !table->options().get(DEFINITION_KEY, &value))
+      packed->assign(value.c_str(), value.length());
+  }
+  thd->mdl_context.release_lock(mdl_request.ticket);
+  return error;
+}
+
+/// Store the packed definition of a view with its table.
+bool store_definition(THD *thd, const std::string &db, const std::string &name,
+                      const std::string &packed) {
+  Table_ref table(db.c_str(), db.length(), name.c_str(), name.length(),
+                  TL_IGNORE, MDL_EXCLUSIVE);
+  bool error = lock_table_names_nsec(thd, &table, nullptr,
+                                     thd->variables.lock_wait_timeout_nsec, 0);
+  if (!error) {
+    tdc_remove_table(thd, TDC_RT_REMOVE_ALL, db.c_str(), name.c_str(), false);
+    dd::cache::Dictionary_client::Auto_releaser releaser(thd->dd_client());
+    dd::Table *table_def = nullptr;
+    error = thd->dd_client()->acquire_for_modification(db.c_str(),
+                                                       name.c_str(), &table_def);
+    if (!error && table_def == nullptr) {
+      my_error(ER_NO_SUCH_TABLE, MYF(0), db.c_str(), name.c_str());
+      error = true;
+    }
+    error = error ||
+            table_def->options().set(
+                DEFINITION_KEY, dd::String_type(packed.c_str(), packed.length())) ||
+            thd->dd_client()->update(table_def) || trans_commit_stmt(thd) ||
+            trans_commit(thd);
+    if (error) {
+      trans_rollback_stmt(thd);
+      trans_rollback(thd);
+    }
+  }
+  thd->mdl_context.release_transactional_locks();
+  return error;
+}
+
+/**
+  Run statements on a view in the environment its query was printed in,
+  in a transaction of their own if asked to.
+*/
+bool run_statements(THD *thd, const Materialized_view_definition &def,
+                    const std::vector<std::string> &statements,
+                    bool transactional) {
+  const CHARSET_INFO *client_cs = get_charset_by_csname(
+      def.client_cs_name.c_str(), MY_CS_PRIMARY, MYF(0));
+  const CHARSET_INFO *connection_cl =
+      get_charset_by_name(def.connection_cl_name.c_str(), MYF(0));
+  if (client_cs == nullptr || connection_cl == nullptr) {
+    my_error(ER_UNKNOWN_CHARACTER_SET, MYF(0),
+             client_cs == nullptr ? def.client_cs_name.c_str()
+                                  : def.connection_cl_name.c_str());
+    return true;
+  }
+
+  const sql_mode_t saved_sql_mode = thd->variables.sql_mode;
+  const CHARSET_INFO *saved_client_cs = thd->variables.character_set_client;
+  const CHARSET_INFO *saved_connection_cl =
+      thd->variables.collation_connection;
+  const ulonglong saved_option_bits = thd->variables.option_bits;
+  thd->variables.sql_mode = def.sql_mode;
+  thd->variables.character_set_client = client_cs;
+  thd->variables.collation_connection = connection_cl;
+  thd->variables.option_bits &= ~OPTION_SAFE_UPDATES;
+  thd->update_charset();
+
+  bool error =
+      transactional && trans_begin(thd, MYSQL_START_TRANS_OPT_READ_WRITE);
+  for (size_t i = 0; !error && i < statements.size(); i++) {
+    Ed_connection conn(thd);
+    LEX_STRING text;
+    lex_string_strmake(thd->mem_root, &text, statements[i].c_str(),
+                       statements[i].length());
+    if (conn.execute_direct(text)) {
+      my_message(conn.get_last_errno(), conn.get_last_error(), MYF(0));
+      error = true;
+    }
+  }
+  if (transactional) {
+    if (error)
+      trans_rollback(thd);
+    else
+      error = trans_commit(thd);
+    thd->mdl_context.release_transactional_locks();
+  }
+
+  thd->variables.sql_mode = saved_sql_mode;
+  thd->variables.character_set_client = saved_client_cs;
+  thd->variables.collation_connection = saved_connection_cl;
+  thd->variables.option_bits = saved_option_bits;
+  thd->update_charset();
+  return error;
+}
+
+/// Statement deriving the rows of a view from the rows of its sources
+/// matching a condition, from all of them if it is empty.
+std::string derive_statement(const std::string &table,
+                             const Materialized_view_definition &def,
+                             const std::string &cond) {
+  std::string statement = "INSERT INTO " + table + " (" + def.columns +
+                          ") SELECT " + def.select_list + def.from_clause;
+  if (!def.where_cond.empty() || !cond.empty()) statement.append(" where ");
+  if (!def.where_cond.empty()) {
+    statement.append("(").append(def.where_cond).append(")");
+    if (!cond.empty()) statement.append(" and ");
+  }
+  if (!cond.empty()) statement.append("(").append(cond).append(")");
+  statement.append(def.group_by);
+  return statement;
+}
+
+/**
+  Delete the rows of a view built from the changed rows and derive them
+  again from those rows, KEYS_PER_STATEMENT keys at a time.
+*/
+void refresh_statements(const View &view, const Changes &changes,
+                        std::vector<std::string> *statements) {
+  const Materialized_view_definition &def = view.def;
+  const std::string table = quoted_table_name(view.db, view.name);
+  std::vector<std::string> derives;
+  for (size_t s = 0; s < changes.keys.size() && s < def.sources.size(); s++) {
+    const Materialized_view_source &source = def.sources[s];
+    std::vector<std::string> view_columns;
+    for (const std::string &column : source.key_columns)
+      view_columns.push_back(
+          Materialized_view_definition::key_column(s, column));
+    std::string view_cond;
+    std::string source_cond;
+    size_t count = 0;
+    for (auto it = changes.keys[s].begin(); it != changes.keys[s].end();) {
+      if (count > 0) {
+        view_cond.append(" or ");
+        source_cond.append(" or ");
+      }
+      view_cond.append("(");
+      append_key_condition(&view_cond, "", view_columns, *it);
+      view_cond.append(")");
+      source_cond.append("(");
+      append_key_condition(&source_cond, source.qualifier + ".",
+                           source.key_columns, *it);
+      source_cond.append(")");
+      ++it;
+      if (++count == KEYS_PER_STATEMENT || it == changes.keys[s].end()) {
+        statements->push_back("DELETE FROM " + table + " WHERE " + view_cond);
+        derives.push_back(derive_statement(table, def, source_cond));
+        view_cond.clear();
+        source_cond.clear();
+        count = 0;
+      }
+    }
+  }
+  std::move(derives.begin(), derives.end(), std::back_inserter(*statements));
+}
+
+/// The key columns of a source of a view, in a table replayed.
+struct Replay_key {
+  size_t source;
+  /// Indexes of the key columns.
+  std::vector<uint> columns;
+  /// Whether the table has all the key columns.
+  bool complete;
+};
+
+/// A source table of a view, opened to decode its rows.
+struct Replay_table {
+  TABLE *table;
+  std::vector<Replay_key> keys;
+};
+
+/// A table id of the binary log mapped to a source table.
+struct Replay_map {
+  const Replay_table *table;
+  std::unique_ptr<table_def> def;
+};
+
+/**
+  Unpack the wanted columns of a row image into the fields of the table.
+  @param[out] present the columns the image holds
+  @return the end of the image, nullptr if it is malformed
+*/
+const uchar *unpack_image(const uchar *ptr, const uchar *end,
+                          const MY_BITMAP *cols, const table_def &def,
+                          TABLE *table, const std::vector<bool> &wanted,
+                          std::vector<bool> *present) {
+  const uchar *const null_bits = ptr;
+  ptr += (bitmap_bits_set(cols) + 7) / 8;
+  uint null_bit = 0;
+  for (uint column = 0; ptr <= end && column < def.size(); column++) {
+    if (!bitmap_is_set(cols, column)) continue;
+    (*present)[column] = true;
+    Field *const field = table->field[column];
+    const bool null = null_bits[null_bit / 8] & (1U << (null_bit % 8));
+    null_bit++;
+    if (null) {
+      if (!wanted[column]) continue;
+      if (!field->is_nullable()) return nullptr;
+      field->set_null();
+      continue;
+    }
+    if (ptr == end) return nullptr;
+    const uint32 length = def.calc_field_size(column, ptr);
+    if (length > static_cast<size_t>(end - ptr)) return nullptr;
+    if (wanted[column]) {
+      field->set_notnull();
+      field->unpack(field->field_ptr(), ptr, def.field_metadata(column));
+    }
+    ptr += length;
+  }
+  return ptr <= end ? ptr : nullptr;
+}
+
+/**
+  Log the keys of the rows of an event, as captured before and after the
+  change.
+  @return true if some cannot be told
+*/
+bool replay_rows(Rows_log_event *rows, const Replay_map &map,
+                 Changes *changes) {
+  const table_def &def = *map.def;
+  TABLE *const table = map.table->table;
+  if (rows->get_width() != def.size()) return true;
+  const bool update =
+      rows->get_general_type_code() == binary_log::UPDATE_ROWS_EVENT;
+  std::vector<bool> wanted(def.size());
+  for (const Replay_key &key : map.table->keys) {
+    for (uint column : key.columns) wanted[column] = true;
+  }
+
+  my_bitmap_map *old_map[2];
+  dbug_tmp_use_all_columns(table, old_map, table->read_set, table->write_set);
+  bool error = false;
+  std::vector<bool> present;
+  const uchar *ptr = rows->get_rows_buf();
+  const uchar *const end = rows->get_rows_end();
+  for (bool after = false; !error && ptr < end; after = update && !after) {
+    present.assign(def.size(), false);
+    ptr = unpack_image(ptr, end, after ? rows->get_cols_ai() : rows->get_cols(),
+                       def, table, wanted, &present);
+    error = ptr == nullptr;
+    for (size_t i = 0; !error && i < map.table->keys.size(); i++) {
+      const Replay_key &key = map.table->keys[i];
+      Mv_key values(key.columns.size());
+      error = !key.complete;
+      for (size_t k = 0; !error && k < key.columns.size(); k++) {
+        // e.g. the before image of binlog_row_image=MINIMAL
+        error = !present[key.columns[k]];
+        if (!error) append_literal(&values[k], table->field[key.columns[k]]);
+      }
+      if (!error) changes->add(key.source, std::move(values));
+    }
+  }
+  dbug_tmp_restore_column_maps(table->read_set, table->write_set, old_map);
+  return error;
+}
+
+/**
+  Log the keys an event of the binary log changed.
+  @return true if they cannot be told
+*/
+bool replay_event(Log_event *event, const std::vector<Replay_table> &tables,
+                  std::map<ulonglong, Replay_map> *maps, Changes *changes) {
+  switch (event->get_type_code()) {
+    case binary_log::TABLE_MAP_EVENT: {
+      auto *map = down_cast<Table_map_log_event *>(event);
+      maps->erase(map->get_table_id().id());
+      for (const Replay_table &replayed : tables) {
+        TABLE *const table = replayed.table;
+        if (strcmp(table->s->db.str, map->get_db_name()) != 0 ||
+            strcmp(table->s->table_name.str, map->get_table_name()) != 0)
+          continue;
+        // the table changed since it was logged
+        if (map->m_colcnt != table->s->fields) return true;
+        std::unique_ptr<table_def> def(new table_def(
+            map->m_coltype, map->m_colcnt, map->m_field_metadata,
+            map->m_field_metadata_size, map->m_null_bits, map->m_flags,
+            map->m_column_names, map->m_column_names_size, map->m_sign_bits));
+        for (const Replay_key &key : replayed.keys) {
+          for (uint column : key.columns) {
+            if (table->field[column]->binlog_type() !=
+                def->binlog_type(column))
+              return true;
+          }
+        }
+        (*maps)[map->get_table_id().id()] = {&replayed, std::move(def)};
+        break;
+      }
+      return false;
+    }
+    case binary_log::WRITE_ROWS_EVENT:
+    case binary_log::UPDATE_ROWS_EVENT:
+    case binary_log::DELETE_ROWS_EVENT:
+    case binary_log::WRITE_ROWS_EVENT_V1:
+    case binary_log::UPDATE_ROWS_EVENT_V1:
+    case binary_log::DELETE_ROWS_EVENT_V1:
+    case binary_log::PARTIAL_UPDATE_ROWS_EVENT: {
+      auto *rows = down_cast<Rows_log_event *>(event);
+      const auto it = maps->find(rows->get_table_id().id());
+      if (it == maps->end()) return false;
+      // the after image of a partial update only holds the JSON diffs
+      return event->get_type_code() == binary_log::PARTIAL_UPDATE_ROWS_EVENT ||
+             replay_rows(rows, it->second, changes);
+    }
+    case binary_log::QUERY_EVENT:
+      // any statement but BEGIN, COMMIT and the like may change a source
+      return down_cast<Query_log_event *>(event)->is_sbr_logging_format();
+    case binary_log::FORMAT_DESCRIPTION_EVENT:
+    case binary_log::ROTATE_EVENT:
+    case binary_log::STOP_EVENT:
+    case binary_log::PREVIOUS_GTIDS_LOG_EVENT:
+    case binary_log::GTID_LOG_EVENT:
+    case binary_log::ANONYMOUS_GTID_LOG_EVENT:
+    case binary_log::XID_EVENT:
+    case binary_log::XA_PREPARE_LOG_EVENT:
+    case binary_log::ROWS_QUERY_LOG_EVENT:
+    case binary_log::TRANSACTION_CONTEXT_EVENT:
+    case binary_log::VIEW_CHANGE_EVENT:
+    case binary_log::METADATA_EVENT:
+    case binary_log::IGNORABLE_LOG_EVENT:
+      return false;
+    default:
+      // e.g. the compressed transactions of TRANSACTION_PAYLOAD_EVENT
+      return true;
+  }
+}
+
+/**
+  Log for a view the keys of the rows the binary log holds changes of from
+  a checkpoint on, those made while the server was down.
+  @return true if the log cannot tell them, when the view is to be
+    recomputed in full
+*/
+bool replay_binlog(THD *thd, const View &view, const Binlog_position &from,
+                   Changes *changes) {
+  const Binlog_position end = binlog_end();
+  if (end.empty() || end < from) return true;
+  const std::pair<int, std::list<std::string>> index =
+      mysql_bin_log.get_log_index(true);
+  if (index.first != LOG_INFO_EOF) return true;
+
+  // the source tables, opened for their fields to decode the rows into
+  Table_ref *tables = nullptr;
+  Table_ref **last = &tables;
+  for (const Materialized_view_source &source : view.def.sources) {
+    bool listed = false;
+    for (Table_ref *table = tables; table != nullptr && !listed;
+         table = table->next_global)
+      listed = source.db == table->db && source.table_name == table->table_name;
+    if (listed) continue;
+    *last = new (thd->mem_root) Table_ref(
+        source.db.c_str(), source.db.length(), source.table_name.c_str(),
+        source.table_name.length(), source.table_name.c_str(), TL_READ);
+    if (*last == nullptr) return true;
+    last = &(*last)->next_global;
+  }
+  uint counter = 0;
+  if (open_tables(thd, &tables, &counter, 0)) {
+    thd->clear_error();
+    close_thread_tables(thd);
+    return true;
+  }
+  std::vector<Replay_table> replayed;
+  for (Table_ref *table = tables; table != nullptr;
+       table = table->next_global) {
+    Replay_table entry{table->table, {}};
+    const std::vector<Materialized_view_source> &sources = view.def.sources;
+    for (size_t s = 0; s < sources.size(); s++) {
+      if (sources[s].db != table->db ||
+          sources[s].table_name != table->table_name)
+        continue;
+      Replay_key key{s, {}, true};
+      for (const std::string &column : sources[s].key_columns) {
+        Field **field = table->table->field;
+        while (*field != nullptr &&
+               my_strcasecmp(system_charset_info, (*field)->field_name,
+                             column.c_str()) != 0)
+          field++;
+        if (*field == nullptr)
+          key.complete = false;
+        else
+          key.columns.push_back((*field)->field_index());
+      }
+      entry.keys.push_back(std::move(key));
+    }
+    replayed.push_back(std::move(entry));
+  }
+
+  bool found = false;
+  bool error = false;
+  std::map<ulonglong, Replay_map> maps;
+  for (const std::string &path : index.second) {
+    const char *const file = path.c_str() + dirname_length(path.c_str());
+    const bool first = !found && from.file == file;
+    if (!found && !first) continue;
+    found = true;
+    Binlog_file_reader reader(opt_source_verify_checksum);
+    if (reader.open(path.c_str(), first ? from.pos : 0)) {
+      error = true;
+      break;
+    }
+    const bool active = end.file == file;
+    // events end before the end of the active file, as it was flushed
+    while (!error && !(active && reader.position() >= end.pos)) {
+      std::unique_ptr<Log_event> event(reader.read_event_object());
+      if (event == nullptr) break;
+      error = replay_event(event.get(), replayed, &maps, changes);
+    }
+    error = error || reader.has_fatal_error();
+    if (error || active) break;
+  }
+  close_thread_tables(thd);
+  // the checkpoint was purged
+  return error || !found;
+}
+
+/**
+  Find the view of a table, registering it anew when it is not maintained
+  yet or its definition changed, to be recomputed in full unless it was
+  checkpointed.
+*/
+std::shared_ptr<View> find_view(THD *thd, const std::string &db,
+                                const std::string &name) {
+  bool exists = false;
+  std::string packed;
+  if (lookup_view(thd, db, name, &exists, &packed)) return nullptr;
+  const Binlog_position checkpoint = checkpoint_of(db, name, packed);
+  Materialized_view_definition def;
+  if (!exists || packed.empty() || def.unpack(packed)) {
+    mysql_mutex_lock(&LOCK_materialized_views);
+    unregister_view(db, name);
+    mysql_mutex_unlock(&LOCK_materialized_views);
+    if (!exists)
+      my_error(ER_NO_SUCH_TABLE, MYF(0), db.c_str(), name.c_str());
+    else
+      my_error(ER_WRONG_OBJECT, MYF(0), db.c_str(), name.c_str(),
+               "MATERIALIZED VIEW");
+    return nullptr;
+  }
+
+  std::shared_ptr<View> view;
+  mysql_mutex_lock(&LOCK_materialized_views);
+  for (const auto &id_view : views) {
+    if (id_view.second->db == db && id_view.second->name == name &&
+        id_view.second->packed == packed)
+      view = id_view.second;
+  }
+  if (view == nullptr) {
+    view = register_view(db, name, packed, std::move(def), checkpoint.empty());
+    view->recover_from = checkpoint;
+  }
+  mysql_mutex_unlock(&LOCK_materialized_views);
+  return view;
+}
+
+/**
+  Wait for the running refresh of a view to end, and take its changes.
+  @param[out] checkpoint where the binary log holds the changes not taken
+    from, empty if it is not open
+  @param[out] recover_from where to read the changes made while the server
+    was down from, empty if none are to be read
+  @return true if killed while waiting
+*/
+bool claim_refresh(THD *thd, View *view, Changes *changes,
+                   Binlog_position *checkpoint,
+                   Binlog_position *recover_from) {
+  mysql_mutex_lock(&LOCK_materialized_views);
+  PSI_stage_info old_stage;
+  thd->ENTER_COND(&COND_materialized_views, &LOCK_materialized_views,
+                  &stage_waiting_for_materialized_view_refresh, &old_stage);
+  while (view->refreshing && !thd->is_killed()) {
+    mysql_cond_wait(&COND_materialized_views, &LOCK_materialized_views);
+  }
+  const bool killed = thd->is_killed();
+  if (!killed) {
+    view->refreshing = true;
+    *changes = std::move(view->changes);
+    view->changes = Changes();
+    // the changes of transactions in flight are logged after they started
+    *checkpoint = binlog_end();
+    if (!in_flight.empty() && *in_flight.begin() < *checkpoint)
+      *checkpoint = *in_flight.begin();
+    *recover_from = std::move(view->recover_from);
+    view->recover_from = Binlog_position();
+  }
+  mysql_mutex_unlock(&LOCK_materialized_views);
+  thd->EXIT_COND(&old_stage);
+  if (killed) thd->send_kill_message();
+  return killed;
+}
+
+/// End a refresh, giving back the changes it could not apply.
+void release_refresh(View *view, Changes *unapplied) {
+  mysql_mutex_lock(&LOCK_materialized_views);
+  if (unapplied != nullptr) view->changes.merge(std::move(*unapplied));
+  view->refreshing = false;
+  mysql_cond_broadcast(&COND_materialized_views);
+  mysql_mutex_unlock(&LOCK_materialized_views);
+}
+
+}  // namespace
+
+std::string Materialized_view_definition::pack() const {
+  std::string out;
+  pack_field(&out, std::to_string(DEFINITION_VERSION));
+  pack_field(&out, select_list);
+  pack_field(&out, from_clause);
+  pack_field(&out, where_cond);
+  pack_field(&out, group_by);
+  pack_field(&out, columns);
+  pack_field(&out, std::to_string(sql_mode));
+  pack_field(&out, client_cs_name);
+  pack_field(&out, connection_cl_name);
+  pack_field(&out, std::to_string(sources.size()));
+  for (const Materialized_view_source &source : sources) {
+    pack_field(&out, source.db);
+    pack_field(&out, source.table_name);
+    pack_field(&out, source.qualifier);
+    pack_field(&out, std::to_string(source.key_columns.size()));
+    for (const std::string &column : source.key_columns)
+      pack_field(&out, column);
+  }
+  return out;
+}
+
+bool Materialized_view_definition::unpack(const std::string &packed) {
+  size_t pos = 0;
+  ulonglong version = 0;
+  ulonglong mode = 0;
+  ulonglong source_count = 0;
+  if (unpack_number(packed, &pos, &version) || version != DEFINITION_VERSION ||
+      unpack_field(packed, &pos, &select_list) ||
+      unpack_field(packed, &pos, &from_clause) ||
+      unpack_field(packed, &pos, &where_cond) ||
+      unpack_field(packed, &pos, &group_by) ||
+      unpack_field(packed, &pos, &columns) ||
+      unpack_number(packed, &pos, &mode) ||
+      unpack_field(packed, &pos, &client_cs_name) ||
+      unpack_field(packed, &pos, &connection_cl_name) ||
+      unpack_number(packed, &pos, &source_count) ||
+      source_count > packed.length())
+    return true;
+  sql_mode = mode;
+  sources.assign(source_count, Materialized_view_source());
+  for (Materialized_view_source &source : sources) {
+    ulonglong key_count = 0;
+    if (unpack_field(packed, &pos, &source.db) ||
+        unpack_field(packed, &pos, &source.table_name) ||
+        unpack_field(packed, &pos, &source.qualifier) ||
+        unpack_number(packed, &pos, &key_count) ||
+        key_count > packed.length())
+      return true;
+    source.key_columns.assign(key_count, std::string());
+    for (std::string &column : source.key_columns) {
+      if (unpack_field(packed, &pos, &column)) return true;
+    }
+  }
+  return pos != packed.length();
+}
+
+std::string Materialized_view_definition::key_column(
+    size_t source, const std::string &column) {
+  return "mv$" + std::to_string(source) + "$" + column;
+}
+
+bool materialized_view_key_supported(const Field *field) {
+  switch (field->type()) {
+    // Floating point values do not print exactly, and timestamps print in
+    // the time zone of the session.
+    case MYSQL_TYPE_FLOAT:
+    case MYSQL_TYPE_DOUBLE:
+    case MYSQL_TYPE_TIMESTAMP:
+    case MYSQL_TYPE_JSON:
+    case MYSQL_TYPE_GEOMETRY:
+      return false;
+    default:
+      return true;
+  }
+}
+
+void materialized_view_init() {
+  mysql_mutex_init(PSI_NOT_INSTRUMENTED, &LOCK_materialized_views,
+                   MY_MUTEX_INIT_FAST);
+  mysql_mutex_init(PSI_NOT_INSTRUMENTED, &LOCK_materialized_view_checkpoints,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(PSI_NOT_INSTRUMENTED, &COND_materialized_views);
+}
+
+void materialized_view_deinit() {
+  views.clear();
+  materialized_view_count = 0;
+  in_flight.clear();
+  checkpoints.clear();
+  checkpoints_loaded = false;
+  mysql_mutex_destroy(&LOCK_materialized_view_checkpoints);
+  mysql_cond_destroy(&COND_materialized_views);
+  mysql_mutex_destroy(&LOCK_materialized_views);
+}
+
+void materialized_view_capture(TABLE *table, const uchar *record) {
+  if (table->s->tmp_table != NO_TMP_TABLE) return;
+  const Materialized_view_watch *watch = resolve_watch(table);
+  if (watch == nullptr || watch->count == 0) return;
+
+  THD *thd = table->in_use;
+  const ptrdiff_t offset = record - table->record[0];
+  for (size_t i = 0; i < watch->count; i++) {
+    const Materialized_view_watch::Entry &entry = watch->entries[i];
+    Changes *changes = transaction_changes(thd, entry.view_id);
+    if (entry.key_fields == nullptr) {
+      changes->set_full();
+      continue;
+    }
+    Mv_key key(entry.key_count);
+    for (size_t k = 0; k < entry.key_count; k++) {
+      Field *field = entry.key_fields[k];
+      field->move_field_offset(offset);
+      append_literal(&key[k], field);
+      field->move_field_offset(-offset);
+    }
+    changes->add(entry.source, std::move(key));
+  }
+}
+
+void materialized_view_mark_columns(TABLE *table) {
+  if (table->s->tmp_table != NO_TMP_TABLE) return;
+  const Materialized_view_watch *watch = resolve_watch(table);
+  if (watch == nullptr || watch->count == 0) return;
+  for (size_t i = 0; i < watch->count; i++) {
+    const Materialized_view_watch::Entry &entry = watch->entries[i];
+    for (size_t k = 0; entry.key_fields != nullptr && k < entry.key_count;
+         k++)
+      bitmap_set_bit(table->read_set, entry.key_fields[k]->field_index());
+  }
+  table->file->column_bitmaps_signal();
+}
+
+void materialized_view_capture_all(THD *thd, const char *db,
+                                   const char *table_name) {
+  std::vector<ulonglong> view_ids;
+  mysql_mutex_lock(&LOCK_materialized_views);
+  for (const auto &id_view : views) {
+    for (const Materialized_view_source &source : id_view.second->def.sources) {
+      if (source.db == db && source.table_name == table_name) {
+        view_ids.push_back(id_view.first);
+        break;
+      }
+    }
+  }
+  mysql_mutex_unlock(&LOCK_materialized_views);
+  for (ulonglong view_id : view_ids)
+    transaction_changes(thd, view_id)->set_full();
+}
+
+void materialized_view_end_trans(THD *thd, bool commit) {
+  Materialized_view_deltas *deltas = thd->mv_deltas;
+  if (deltas == nullptr) return;
+  thd->mv_deltas = nullptr;
+  if (commit || !deltas->start.empty()) {
+    mysql_mutex_lock(&LOCK_materialized_views);
+    if (!deltas->start.empty()) in_flight.erase(in_flight.find(deltas->start));
+    for (auto &id_changes : deltas->views) {
+      auto it = views.find(id_changes.first);
+      if (commit && it != views.end())
+        it->second->changes.merge(std::move(id_changes.second));
+    }
+    mysql_mutex_unlock(&LOCK_materialized_views);
+  }
+  delete deltas;
+}
+
+bool materialized_view_create(THD *thd, const std::string &db,
+                              const std::string &name,
+                              const Materialized_view_definition &def,
+                              const std::string &index) {
+  bool exists = false;
+  std::string packed;
+  if (lookup_view(thd, db, name, &exists, &packed)) return true;
+  if (exists) {
+    my_error(ER_TABLE_EXISTS_ERROR, MYF(0), name.c_str());
+    return true;
+  }
+
+  // Changes are logged from before the table is filled, so that none made
+  // while it is filled are missed.
+  erase_checkpoint(db, name);
+  packed = def.pack();
+  Materialized_view_definition registered = def;
+  mysql_mutex_lock(&LOCK_materialized_views);
+  const ulonglong id =
+      register_view(db, name, packed, std::move(registered), false)->id;
+  mysql_mutex_unlock(&LOCK_materialized_views);
+
+  const std::string table = quoted_table_name(db, name);
+  std::string create = "CREATE TABLE " + table;
+  if (!index.empty()) create.append(" (").append(index).append(")");
+  create.append(" AS SELECT ")
+      .append(def.select_list)
+      .append(def.from_clause);
+  if (!def.where_cond.empty()) create.append(" where ").append(def.where_cond);
+  create.append(def.group_by);
+
+  std::string hide;
+  for (size_t s = 0; s < def.sources.size(); s++) {
+    for (const std::string &column : def.sources[s].key_columns) {
+      hide.append(hide.empty() ? "ALTER TABLE " + table + " " : ", ");
+      hide.append("ALTER COLUMN ");
+      append_name(&hide, Materialized_view_definition::key_column(s, column));
+      hide.append(" SET INVISIBLE");
+    }
+  }
+
+  if (run_statements(thd, def, {create}, false)) {
+    unregister_view_id(id);
+    return true;
+  }
+  if ((!hide.empty() && run_statements(thd, def, {hide}, false)) ||
+      store_definition(thd, db, name, packed)) {
+    unregister_view_id(id);
+    // keep the error of the failed step
+    Diagnostics_area da(false);
+    thd->push_diagnostics_area(&da);
+    run_statements(thd, def, {"DROP TABLE " + table}, false);
+    thd->pop_diagnostics_area();
+    return true;
+  }
+  return false;
+}
+
+bool materialized_view_refresh(THD *thd, const std::string &db,
+                               const std::string &name) {
+  const std::shared_ptr<View> view = find_view(thd, db, name);
+  if (view == nullptr) return true;
+
+  Changes changes;
+  Binlog_position checkpoint;
+  Binlog_position recover_from;
+  if (claim_refresh(thd, view.get(), &changes, &checkpoint, &recover_from))
+    return true;
+  if (!recover_from.empty() && !changes.full &&
+      replay_binlog(thd, *view, recover_from, &changes))
+    changes.set_full();
+
+  const std::string table = quoted_table_name(db, name);
+  std::vector<std::string> statements;
+  if (changes.full) {
+    DBUG_PRINT("info", ("recomputing %s in full", table.c_str()));
+    statements.push_back("DELETE FROM " + table);
+    statements.push_back(derive_statement(table, view->def, ""));
+  } else {
+    DBUG_PRINT("info", ("refreshing %zu changed rows of %s",
+                        changes.key_count, table.c_str()));
+    refresh_statements(*view, changes, &statements);
+  }
+  const bool error =
+      !statements.empty() && run_statements(thd, view->def, statements, true);
+  if (!error && !checkpoint.empty()) store_checkpoint(*view, checkpoint);
+  release_refresh(view.get(), error ? &changes : nullptr);
+  return error;
+}
+
+bool materialized_view_drop(THD *thd, const std::string &db,
+                            const std::string &name) {
+  const std::shared_ptr<View> view = find_view(thd, db, name);
+  if (view == nullptr) return true;
+  mysql_mutex_lock(&LOCK_materialized_views);
+  unregister_view(db, name);
+  mysql_mutex_unlock(&LOCK_materialized_views);
+  erase_checkpoint(db, name);
+  return run_statements(thd, view->def,
+                        {"DROP TABLE " + quoted_table_name(db, name)}, false);
+}
@@ -0,0 +1,167 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+/**
+  @file
+  Incrementally refreshed materialized views, e.g.
+
+    CREATE MATERIALIZED VIEW sales_by_region REFRESH INCREMENTAL AS
+      SELECT region, SUM(amount) AS total, COUNT(*) AS orders
+      FROM sales WHERE status = 'paid' GROUP BY region
+
+  The view is a table holding the result of its query, which REFRESH
+  MATERIALIZED VIEW brings up to date without running the whole query
+  again. Two shapes of query are maintained incrementally:
+
+  - joins of tables, each with a primary key. The view table also holds
+    the primary key of the row each table contributed to a view row, in
+    invisible columns. A refresh deletes the view rows built from base rows
+    changed since the last refresh and derives them again from those rows.
+  - grouped queries over a single table, the GROUP BY list made of columns.
+    The view table also holds the group columns. A refresh deletes the
+    groups with rows changed since the last refresh and derives them again
+    from the rows of those groups, whatever the aggregates, MIN() and MAX()
+    included.
+
+  Either way the view query only reads the changed rows and their groups,
+  through the indexes of the base tables.
+
+  What changed is logged per view as the keys of the changed rows: their
+  primary key or their group. The keys of the rows a transaction writes
+  are captured as the handler writes them, and enter the log of each view
+  on their tables once the transaction commits. A view whose log outgrows
+  materialized_view_max_delta_rows, or whose table is truncated, is
+  recomputed in full by its next refresh.
+
+  The log is kept in memory. Each refresh checkpoints the view, in a file
+  of the data directory, with a position of the binary log no transaction
+  the refresh did not apply was logged before. The first refresh after a
+  restart reads the binary log from the checkpoint on and derives again
+  the rows of the changed keys found there, the rows events of the sources
+  decoded as the handler would have captured them. It recomputes the view
+  in full instead when the log cannot tell those keys: the checkpoint is
+  missing or purged, a source was written without binary logging, or the
+  log holds statements, compressed transactions or row images missing key
+  columns.
+
+  The definition of the view is stored with its table. Dropping that table
+  drops the view.
+*/
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "my_inttypes.h"
+#include "sql/system_variables.h"
+
+class Field;
+class THD;
+struct TABLE;
+
+/// Most changed rows logged for a view before it is recomputed in full.
+extern ulong materialized_view_max_delta_rows;
+
+/// A table read by the query of a materialized view.
+struct Materialized_view_source {
+  std::string db;
+  std::string table_name;
+  /// How the query qualifies the columns of the table, e.g. "`db`.`t`".
+  std::string qualifier;
+  /// Columns whose values key the changes of the table: its primary key,
+  /// or the group columns of a grouped view.
+  std::vector<std::string> key_columns;
+};
+
+/// What a materialized view stores with its table to maintain it.
+struct Materialized_view_definition {
+  /// The select list of the view query, followed by the key columns of
+  /// each source.
+  std::string select_list;
+  /// " from ..." of the view query.
+  std::string from_clause;
+  /// WHERE condition of the view query, empty if it has none.
+  std::string where_cond;
+  /// " group by ... having ..." of the view query, empty if not grouped.
+  std::string group_by;
+  /// Columns of the view table, in the order of the select list.
+  std::string columns;
+  /// Environment the view query was printed in, to run it in.
+  sql_mode_t sql_mode = 0;
+  std::string client_cs_name;
+  std::string connection_cl_name;
+  std::vector<Materialized_view_source> sources;
+
+  std::string pack() const;
+  /// @return true if the string is not a packed definition
+  bool unpack(const std::string &packed);
+
+  /// Column of the view table holding a key column of a source.
+  static std::string key_column(size_t source, const std::string &column);
+};
+
+/// Whether values of the column can key the changes of a table.
+bool materialized_view_key_supported(const Field *field);
+
+void materialized_view_init();
+void materialized_view_deinit();
+
+extern std::atomic<uint> materialized_view_count;
+
+/// Whether any materialized view is maintained, before capturing rows.
+inline bool materialized_views_exist() {
+  return materialized_view_count.load(std::memory_order_relaxed) != 0;
+}
+
+/**
+  Log a row the handler wrote, or the image of a row it deleted, for the
+  views on its table. The key of the row is kept with the transaction until
+  it ends.
+*/
+void materialized_view_capture(TABLE *table, const uchar *record);
+
+/// Have the key columns of the views on a table read along with the rows
+/// a statement updates or deletes.
+void materialized_view_mark_columns(TABLE *table);
+
+/// Have the views on a table recomputed in full, when its rows are all
+/// deleted at once.
+void materialized_view_capture_all(THD *thd, const char *db,
+                                   const char *table_name);
+
+/// Log the keys a transaction captured once it committed, or drop them.
+void materialized_view_end_trans(THD *thd, bool commit);
+
+/**
+  Create the table of a view, filled with the result of its query, and
+  store the definition with it.
+  @param index the index of the view table on the key columns, e.g.
+    "PRIMARY KEY (...)", empty for none
+*/
+bool materialized_view_create(THD *thd, const std::string &db,
+                              const std::string &name,
+                              const Materialized_view_definition &def,
+                              const std::string &index);
+
+/// Bring a view up to date with the changes logged for it.
+bool materialized_view_refresh(THD *thd, const std::string &db,
+                               const std::string &name);
+
+/// Drop a view along with its table.
+bool materialized_view_drop(THD *thd, const std::string &db,
+                            const std::string &name);
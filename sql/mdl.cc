@@ -23,6 +23,9 @@
 #include "sql/mdl.h"
 
 #include <time.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
 #include <algorithm>
 #include <atomic>
 #include <functional>
@@ -306,6 +309,11 @@ class MDL_map {
 int32 mdl_locks_unused_locks_low_water =
     MDL_LOCKS_UNUSED_LOCKS_LOW_WATER_DEFAULT;
 
+ulong mdl_max_sharded_locks = 0;
+
+/** Number of MDL_lock objects with per-cpu "fast path" counters attached. */
+static std::atomic<ulong> mdl_sharded_locks{0};
+
 /**
   A context of the recursive traversal through all contexts
   in all sessions in search for deadlock.
@@ -834,7 +842,14 @@ class MDL_lock {
 
   inline void reinit(const MDL_key *mdl_key);
 
-  ~MDL_lock() { mysql_prlock_destroy(&m_rwlock); }
+  ~MDL_lock() {
+    Fast_path_shard *shards = m_fast_path_shards.load();
+    if (shards != nullptr) {
+      delete[] shards;
+      --mdl_sharded_locks;
+    }
+    mysql_prlock_destroy(&m_rwlock);
+  }
 
   inline static MDL_lock *create(const MDL_key *key);
   inline static void destroy(MDL_lock *lock);
@@ -915,6 +930,13 @@ class MDL_lock {
     synchronized with contents of MDL_lock::m_granted/m_waiting lists.
   */
   static const fast_path_state_t HAS_SLOW_PATH = 1ULL << 60;
+  /**
+    Flag in MDL_lock::m_fast_path_state that indicates that per-cpu
+    counters were attached to this object (@sa m_fast_path_shards).
+    Never cleared, so such object is never considered unused.
+    Set under protection of MDL_lock::m_rwlock lock.
+  */
+  static const fast_path_state_t HAS_SHARDS = 1ULL << 63;
   /**
     Combination of IS_DESTROYED/HAS_OBTRUSIVE/HAS_SLOW_PATH flags and packed
     counters of specific types of "unobtrusive" locks which were granted using
@@ -975,8 +997,17 @@ class MDL_lock {
     */
     assert(!(*old_state & IS_DESTROYED));
 
-    return atomic_compare_exchange_strong(&m_fast_path_state, old_state,
-                                          new_state);
+    if (!atomic_compare_exchange_strong(&m_fast_path_state, old_state,
+                                        new_state))
+      return false;
+
+    /*
+      Per-cpu counters follow HAS_OBTRUSIVE flag, so that "fast path"
+      requests which use them back off as well.
+    */
+    if ((*old_state ^ new_state) & HAS_OBTRUSIVE)
+      fast_path_shards_drain(new_state & HAS_OBTRUSIVE);
+    return true;
   }
 
   /**
@@ -1011,6 +1042,93 @@ class MDL_lock {
     m_fast_path_state.store(0);
   }
 
+  /** Number of per-cpu counters in m_fast_path_shards. */
+  static const uint FAST_PATH_SHARDS = 32;
+
+  /**
+    Number of failed compare-and-swaps on m_fast_path_state by requests
+    for MDL_SHARED_READ locks after which m_fast_path_shards is attached.
+  */
+  static const uint FAST_PATH_SHARDING_THRESHOLD = 1000;
+
+  /**
+    Flag in Fast_path_shard::m_count which makes requests for locks fall
+    back to m_fast_path_state. Set while HAS_OBTRUSIVE flag is set.
+  */
+  static const uint64 SHARD_DRAINED = 1ULL << 63;
+
+  /**
+    Counter of MDL_SHARED_READ locks granted using "fast path" on one cpu,
+    kept on its own cache line.
+  */
+  struct alignas(64) Fast_path_shard {
+    std::atomic<uint64> m_count{0};
+  };
+
+  /**
+    Per-cpu counters of MDL_SHARED_READ locks granted using "fast path".
+    Attached to table locks on which m_fast_path_state proved contended,
+    so that concurrent readers of a hot table don't bounce one cache line
+    between cpus. Limited by mdl_max_sharded_locks.
+
+    @note Locks accounted for here are included into bitmap returned by
+          fast_path_granted_bitmap(). Counters are marked as SHARD_DRAINED
+          atomically with setting HAS_OBTRUSIVE flag, so no new locks can
+          be granted using them once "obtrusive" lock is about to be
+          checked for compatibility.
+  */
+  std::atomic<Fast_path_shard *> m_fast_path_shards{nullptr};
+
+  /** Failed compare-and-swaps counted towards sharding this object. */
+  std::atomic<uint> m_fast_path_contention{0};
+
+  void note_fast_path_contention(uint failures);
+
+  /**
+    Try to account for MDL_SHARED_READ lock in the given per-cpu counter.
+
+    @retval true   Lock granted.
+    @retval false  Counter is drained, "slow path" has to be used.
+  */
+  bool fast_path_shard_acquire(uint shard) {
+    std::atomic<uint64> &count = m_fast_path_shards.load()[shard].m_count;
+    uint64 old_count = count.load(std::memory_order_relaxed);
+    do {
+      if (old_count & SHARD_DRAINED) return false;
+    } while (!count.compare_exchange_weak(old_count, old_count + 1));
+    return true;
+  }
+
+  /**
+    Remove MDL_SHARED_READ lock from the given per-cpu counter.
+
+    @returns true if counter is drained, so there might be waiters for
+             this lock to go away.
+  */
+  bool fast_path_shard_release(uint shard) {
+    return m_fast_path_shards.load()[shard].m_count.fetch_sub(1) &
+           SHARD_DRAINED;
+  }
+
+  void fast_path_shards_drain(bool drain) {
+    Fast_path_shard *shards = m_fast_path_shards.load();
+    if (shards == nullptr) return;
+    for (uint i = 0; i < FAST_PATH_SHARDS; i++) {
+      if (drain)
+        shards[i].m_count.fetch_or(SHARD_DRAINED);
+      else
+        shards[i].m_count.fetch_and(~SHARD_DRAINED);
+    }
+  }
+
+  bool fast_path_shards_granted() const {
+    const Fast_path_shard *shards = m_fast_path_shards.load();
+    if (shards == nullptr) return false;
+    for (uint i = 0; i < FAST_PATH_SHARDS; i++)
+      if (shards[i].m_count.load() & ~SHARD_DRAINED) return true;
+    return false;
+  }
+
   /**
     Pointer to strategy object which defines how different types of lock
     requests should be handled for the namespace to which this lock belongs.
@@ -1060,7 +1178,8 @@ class MDL_lock {
     bitmap_t result = 0;
     fast_path_state_t fps = lock.m_fast_path_state;
     if (fps & 0xFFFFFULL) result |= MDL_BIT(MDL_SHARED);
-    if (fps & (0xFFFFFULL << 20)) result |= MDL_BIT(MDL_SHARED_READ);
+    if ((fps & (0xFFFFFULL << 20)) || lock.fast_path_shards_granted())
+      result |= MDL_BIT(MDL_SHARED_READ);
     if (fps & (0xFFFFFULL << 40)) result |= MDL_BIT(MDL_SHARED_WRITE);
     return result;
   }
@@ -1477,6 +1596,7 @@ void MDL_map::remove_random_unused(MDL_context *ctx, LF_PINS *pins,
 MDL_context::MDL_context()
     : m_owner(nullptr),
       m_needs_thr_lock_abort(false),
+      m_sharded_fast_path_locks(0),
       m_force_dml_deadlock_weight(false),
       m_waiting_for(nullptr),
       m_pins(nullptr),
@@ -1657,6 +1777,9 @@ inline void MDL_lock::reinit(const MDL_key *mdl_key) {
   m_piglet_lock_count = 0;
   m_current_waiting_incompatible_idx = 0;
   m_fast_path_state = 0;
+  m_fast_path_contention = 0;
+  /* Objects with per-cpu counters are never unused, so never reused. */
+  assert(m_fast_path_shards.load() == nullptr);
   /*
     Check that we have clean "m_granted" and "m_waiting" sets/lists in both
     cases when we have fresh and re-used object.
@@ -1666,6 +1789,49 @@ inline void MDL_lock::reinit(const MDL_key *mdl_key) {
   assert(m_obtrusive_locks_granted_waiting_count == 0);
 }
 
+/**
+  Account for failed attempts to increment m_fast_path_state by request
+  for MDL_SHARED_READ lock and attach per-cpu counters for such requests
+  once the object proves to be contended.
+
+  @note Caller holds MDL_SHARED_READ lock on this object acquired using
+        "fast path", so it can't become unused meanwhile.
+*/
+
+void MDL_lock::note_fast_path_contention(uint failures) {
+  if (m_fast_path_shards.load() != nullptr ||
+      m_fast_path_contention.fetch_add(failures) + failures <
+          FAST_PATH_SHARDING_THRESHOLD)
+    return;
+
+  mysql_prlock_wrlock(&m_rwlock);
+  if (m_fast_path_shards.load() == nullptr) {
+    Fast_path_shard *shards = nullptr;
+    if (mdl_sharded_locks.fetch_add(1) < mdl_max_sharded_locks)
+      shards = new (std::nothrow) Fast_path_shard[FAST_PATH_SHARDS];
+
+    if (shards == nullptr) {
+      /* Over the limit. Check again after as many failures. */
+      --mdl_sharded_locks;
+      m_fast_path_contention = 0;
+    } else {
+      /*
+        HAS_OBTRUSIVE flag can't change while we hold m_rwlock, so
+        counters start drained iff it is set.
+      */
+      fast_path_state_t old_state = m_fast_path_state;
+      while (!fast_path_state_cas(&old_state, old_state | HAS_SHARDS)) {
+      }
+      if (old_state & HAS_OBTRUSIVE) {
+        for (uint i = 0; i < FAST_PATH_SHARDS; i++)
+          shards[i].m_count = SHARD_DRAINED;
+      }
+      m_fast_path_shards.store(shards);
+    }
+  }
+  mysql_prlock_unlock(&m_rwlock);
+}
+
 /**
   @returns "Fast path" increment for request for "unobtrusive" type
             of lock, 0 - if it is request for "obtrusive" type of
@@ -2800,32 +2966,63 @@ bool MDL_context::try_acquire_lock(MDL_request *mdl_request) {
   return false;
 }
 
+/**
+  Pick per-cpu counter in MDL_lock::m_fast_path_shards to be used by
+  the context. Falls back to spreading contexts over counters on
+  platforms where current cpu is not known.
+*/
+
+static uint mdl_fast_path_shard_index(const MDL_context *ctx) {
+#ifdef __linux__
+  const int cpu = sched_getcpu();
+  if (cpu >= 0) return cpu % MDL_lock::FAST_PATH_SHARDS;
+#endif
+  return (reinterpret_cast<uintptr_t>(ctx) >> 6) % MDL_lock::FAST_PATH_SHARDS;
+}
+
 /**
   "Materialize" requests for locks which were satisfied using
   "fast path" by properly including them into corresponding
   MDL_lock::m_granted bitmaps/lists and removing it from
   packed counter in MDL_lock::m_fast_path_state.
 
+  @param keep_sharded  Leave tickets accounted for in per-cpu counters
+                      of MDL_lock::m_fast_path_shards alone.
+
   @note In future we might optimize this method if necessary,
         for example, by keeping pointer to first "fast path"
         ticket.
 */
 
-void MDL_context::materialize_fast_path_locks() {
+void MDL_context::materialize_fast_path_locks(bool keep_sharded) {
   int i;
 
   for (i = 0; i < MDL_DURATION_END; i++) {
     MDL_ticket_store::List_iterator it = m_ticket_store.list_iterator(i);
 
-    MDL_ticket *matf = m_ticket_store.materialized_front(i);
+    /*
+      Sharded tickets might be older than the materialized front, as they
+      are kept by the calls done after each "fast path" acquisition.
+    */
+    MDL_ticket *matf = (m_sharded_fast_path_locks && !keep_sharded)
+                           ? nullptr
+                           : m_ticket_store.materialized_front(i);
     for (MDL_ticket *ticket = it++; ticket != matf; ticket = it++) {
       if (ticket->m_is_fast_path) {
+        const bool sharded = ticket->m_fast_path_shard >= 0;
+        if (sharded && keep_sharded) continue;
         MDL_lock *lock = ticket->m_lock;
         MDL_lock::fast_path_state_t unobtrusive_lock_increment =
-            lock->get_unobtrusive_lock_increment(ticket->get_type());
+            sharded ? 0
+                    : lock->get_unobtrusive_lock_increment(ticket->get_type());
         ticket->m_is_fast_path = false;
         mysql_prlock_wrlock(&lock->m_rwlock);
         lock->m_granted.add_ticket(ticket);
+        if (sharded) {
+          lock->fast_path_shard_release(ticket->m_fast_path_shard);
+          ticket->m_fast_path_shard = -1;
+          --m_sharded_fast_path_locks;
+        }
         /*
           Atomically decrement counter in MDL_lock::m_fast_path_state.
           This needs to happen under protection of MDL_lock::m_rwlock to make
@@ -3020,10 +3217,33 @@ retry:
       In practice, it won't return values which are too out-of-date as the
       above call to MDL_map::find_or_insert() contains memory barrier.
     */
+    if (mdl_request->type == MDL_SHARED_READ &&
+        lock->m_fast_path_shards.load() != nullptr) {
+      /*
+        Hot table with per-cpu counters attached. Objects having them are
+        never destroyed, so there is no need to check IS_DESTROYED flag.
+      */
+      const uint shard = mdl_fast_path_shard_index(this);
+      if (lock->fast_path_shard_acquire(shard)) {
+        if (pinned) lf_hash_search_unpin(m_pins);
+        ticket->m_lock = lock;
+        ticket->m_is_fast_path = true;
+        ticket->m_fast_path_shard = shard;
+        ++m_sharded_fast_path_locks;
+        m_ticket_store.push_front(mdl_request->duration, ticket);
+        mdl_request->ticket = ticket;
+
+        mysql_mdl_set_status(ticket->m_psi, MDL_ticket::GRANTED);
+        return false;
+      }
+    }
+
     MDL_lock::fast_path_state_t old_state = lock->m_fast_path_state;
     bool first_use;
+    uint attempts = 0;
 
     do {
+      ++attempts;
       /*
         Check if hash look-up returned object marked as destroyed or
         it was marked as such while it was pinned by us. If yes we
@@ -3079,6 +3299,14 @@ retry:
     */
     if (first_use && pinned) mdl_locks.lock_object_used();
 
+    if (mdl_request->type == MDL_SHARED_READ && mdl_max_sharded_locks &&
+        key->mdl_namespace() == MDL_key::TABLE) {
+      uint failures = attempts - 1;
+      DBUG_EXECUTE_IF("mdl_shard_fast_path_locks",
+                      failures = MDL_lock::FAST_PATH_SHARDING_THRESHOLD;);
+      if (failures) lock->note_fast_path_contention(failures);
+    }
+
     /*
       Since this MDL_ticket is not visible to any threads other than
       the current one, we can set MDL_ticket::m_lock member without
@@ -3092,7 +3320,7 @@ retry:
     mdl_request->ticket = ticket;
 
     mysql_mdl_set_status(ticket->m_psi, MDL_ticket::GRANTED);
-    materialize_fast_path_locks();
+    materialize_fast_path_locks(true);
     return false;
   }
 
@@ -4315,7 +4543,20 @@ void MDL_context::release_lock(enum_mdl_duration duration, MDL_ticket *ticket) {
   */
   if (ticket->m_hton_notified) key_for_hton.mdl_key_init(&lock->key);
 
-  if (ticket->m_is_fast_path) {
+  if (ticket->m_is_fast_path && ticket->m_fast_path_shard >= 0) {
+    /*
+      Lock accounted for in per-cpu counter. Such MDL_lock objects never
+      become unused. If the counter is drained there might be requests
+      for "obtrusive" locks waiting for our lock to go away.
+    */
+    --m_sharded_fast_path_locks;
+    if (lock->fast_path_shard_release(ticket->m_fast_path_shard)) {
+      mysql_prlock_wrlock(&lock->m_rwlock);
+      if (lock->m_obtrusive_locks_granted_waiting_count)
+        lock->reschedule_waiters();
+      mysql_prlock_unlock(&lock->m_rwlock);
+    }
+  } else if (ticket->m_is_fast_path) {
     /*
       We are releasing ticket which represents lock request which was
       satisfied using "fast path". We can use "fast path" release
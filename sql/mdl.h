@@ -1071,6 +1071,7 @@ class MDL_ticket : public MDL_wait_for_subgraph {
         m_ctx(ctx_arg),
         m_lock(nullptr),
         m_is_fast_path(false),
+        m_fast_path_shard(-1),
         m_hton_notified(false),
         m_psi(nullptr) {
   }
@@ -1113,6 +1114,13 @@ class MDL_ticket : public MDL_wait_for_subgraph {
   */
   bool m_is_fast_path;
 
+  /**
+    For "fast path" tickets of MDL_SHARED_READ locks on hot tables, index
+    of the per-cpu counter in MDL_lock::m_fast_path_shards accounting for
+    them instead of MDL_lock::m_fast_path_state. -1 otherwise.
+  */
+  int m_fast_path_shard;
+
   /**
     Indicates that ticket corresponds to lock request which required
     storage engine notification during its acquisition and requires
@@ -1648,6 +1656,13 @@ class MDL_context {
   */
   bool m_needs_thr_lock_abort;
 
+  /**
+    Number of tickets in this context which are accounted for in per-cpu
+    counters of MDL_lock::m_fast_path_shards. Lets
+    materialize_fast_path_locks() skip looking for them when zero.
+  */
+  uint m_sharded_fast_path_locks;
+
   /**
     Indicates that we need to use DEADLOCK_WEIGHT_DML deadlock
     weight for this context and ignore the deadlock weight provided
@@ -1702,7 +1717,7 @@ class MDL_context {
                                    MDL_ticket *sentinel);
   void release_lock(enum_mdl_duration duration, MDL_ticket *ticket);
   bool try_acquire_lock_impl(MDL_request *mdl_request, MDL_ticket **out_ticket);
-  void materialize_fast_path_locks();
+  void materialize_fast_path_locks(bool keep_sharded = false);
 
   friend bool mdl_unittest::test_drive_fix_pins(MDL_context *);
   bool fix_pins();
@@ -1763,6 +1778,12 @@ extern mysql_mutex_t LOCK_open;
 */
 extern ulong max_write_lock_count;
 
+/*
+  Maximum number of contended table locks which get per-cpu counters for
+  MDL_SHARED_READ requests on "fast path". 0 disables them.
+*/
+extern ulong mdl_max_sharded_locks;
+
 extern int32 mdl_locks_unused_locks_low_water;
 
 /**
@@ -776,11 +776,13 @@ MySQL clients support the protocol:
 #include "sql/auto_thd.h"   // Auto_THD
 #include "sql/binlog.h"     // mysql_bin_log
 #include "sql/bootstrap.h"  // bootstrap
+#include "sql/change_stream.h"
 #include "sql/check_stack.h"
 #include "sql/conn_handler/connection_acceptor.h"  // Connection_acceptor
 #include "sql/conn_handler/connection_handler_impl.h"  // Per_thread_connection_handler
 #include "sql/conn_handler/connection_handler_manager.h"  // Connection_handler_manager
 #include "sql/conn_handler/socket_connection.h"  // stmt_info_new_packet
+#include "sql/continuous_query.h"
 #include "sql/current_thd.h"                     // current_thd
 #include "sql/dd/cache/dictionary_client.h"
 #include "sql/debug_sync.h"  // debug_sync_end
@@ -788,6 +790,7 @@ MySQL clients support the protocol:
 #include "sql/event_data_objects.h"  // init_scheduler_psi_keys
 #include "sql/events.h"              // Events
 #include "sql/handler.h"
+#include "sql/histograms/histogram_refresher.h"
 #include "sql/hostname_cache.h"  // hostname_cache_init
 #include "sql/init.h"            // unireg_init
 #include "sql/item.h"
@@ -799,6 +802,8 @@ MySQL clients support the protocol:
 #include "sql/log.h"
 #include "sql/log_event.h"  // Rows_log_event
 #include "sql/log_resource.h"
+#include "sql/malloc_arena.h"
+#include "sql/materialized_view.h"
 #include "sql/mdl.h"
 #include "sql/mdl_context_backup.h"  // mdl_context_backup_manager
 #include "sql/my_decimal.h"
@@ -813,6 +818,7 @@ MySQL clients support the protocol:
 #include "sql/protocol.h"
 #include "sql/psi_memory_key.h"  // key_memory_MYSQL_RELAY_LOG_index
 #include "sql/query_options.h"
+#include "sql/query_result_cache.h"
 #include "sql/replication.h"                        // thd_enter_cond
 #include "sql/resourcegroups/resource_group_mgr.h"  // init, post_init
 #ifdef _WIN32
@@ -837,6 +843,9 @@ MySQL clients support the protocol:
 #include "sql/rpl_shardbeats.h"  // Shardbeats_manager
 #include "sql/rpl_trx_tracking.h"
 #include "sql/sd_notify.h"  // sd_notify_connect
+#include "sql/semantic_base.h"
+#include "sql/semantic_cache.h"
+#include "sql/semantic_materializer.h"
 #include "sql/session_tracker.h"
 #include "sql/set_var.h"
 #include "sql/sp_head.h"    // init_sp_psi_keys
@@ -1352,6 +1361,8 @@ uint net_compression_level = 6;
 /* 0 is means default for zstd/lz4. */
 long zstd_net_compression_level = ZSTD_CLEVEL_DEFAULT;
 long lz4f_net_compression_level = 0;
+uint zstd_net_window_log = 0;
+double zstd_net_max_entropy = 7.9;
 extern ulonglong compress_ctx_reset;
 extern ulonglong compress_input_bytes;
 extern ulonglong compress_output_bytes;
@@ -1551,6 +1562,8 @@ ulong binlog_stmt_cache_size = 0;
 int32 opt_binlog_max_flush_queue_time = 0;
 long opt_binlog_group_commit_sync_delay = 0;
 ulong opt_binlog_group_commit_sync_no_delay_count = 0;
+bool opt_binlog_group_commit_sync_delay_adaptive = false;
+long opt_binlog_group_commit_target_latency = 0;
 ulonglong max_binlog_stmt_cache_size = 0;
 bool slave_skip_max_binlog_cache_size_check = false;
 ulong refresh_version; /* Increments on each reload */
@@ -1651,6 +1664,9 @@ ulong write_auto_throttle_frequency;
 /* Determines the step by which throttle rate probability is incremented or
 decremented */
 uint write_throttle_rate_step;
+/* Throttle the writes of each shard from the replication lag replicas report
+ * on it, measured with shardbeats */
+bool write_throttle_shard_lag;
 /* Controls collecting column statistics for every SQL statement */
 ulong column_stats_control;
 /* Controls collecting index statistics for every SQL statement */
@@ -2050,6 +2066,22 @@ ulonglong histogram_group_commit_trx_values[NUMBER_OF_HISTOGRAM_BINS];
 SHOW_VAR latency_histogram_engine_commit_trx[NUMBER_OF_HISTOGRAM_BINS + 1];
 ulonglong histogram_engine_commit_trx_values[NUMBER_OF_HISTOGRAM_BINS];
 
+/* status variables for engine prepare trx times */
+SHOW_VAR latency_histogram_engine_prepare_trx[NUMBER_OF_HISTOGRAM_BINS + 1];
+ulonglong histogram_engine_prepare_trx_values[NUMBER_OF_HISTOGRAM_BINS];
+
+/* status variables for the stages of the binlog group commit */
+SHOW_VAR latency_histogram_binlog_flush_stage[NUMBER_OF_HISTOGRAM_BINS + 1];
+ulonglong histogram_binlog_flush_stage_values[NUMBER_OF_HISTOGRAM_BINS];
+SHOW_VAR latency_histogram_binlog_sync_stage[NUMBER_OF_HISTOGRAM_BINS + 1];
+ulonglong histogram_binlog_sync_stage_values[NUMBER_OF_HISTOGRAM_BINS];
+SHOW_VAR latency_histogram_binlog_commit_stage[NUMBER_OF_HISTOGRAM_BINS + 1];
+ulonglong histogram_binlog_commit_stage_values[NUMBER_OF_HISTOGRAM_BINS];
+SHOW_VAR histogram_binlog_sync_stage_queue_var[NUMBER_OF_HISTOGRAM_BINS + 1];
+ulonglong histogram_binlog_sync_stage_queue_values[NUMBER_OF_HISTOGRAM_BINS];
+SHOW_VAR histogram_binlog_commit_stage_queue_var[NUMBER_OF_HISTOGRAM_BINS + 1];
+ulonglong histogram_binlog_commit_stage_queue_values[NUMBER_OF_HISTOGRAM_BINS];
+
 /*
   True if expire_logs_days and binlog_expire_logs_seconds are set
   explicitly.
@@ -3047,6 +3079,12 @@ static void clean_up(bool print_message) {
   stop_handle_manager();
 
   memcached_shutdown();
+  semantic_materializer_deinit();
+  histogram_refresher_deinit();
+  continuous_query_deinit();
+  change_stream_deinit();
+  materialized_view_deinit();
+  semantic_client_deinit();
 
   release_keyring_handles();
   keyring_lockable_deinit();
@@ -3054,6 +3092,12 @@ static void clean_up(bool print_message) {
   free_latency_histogram_sysvars(latency_histogram_raft_trx_wait);
   free_latency_histogram_sysvars(latency_histogram_group_commit_trx);
   free_latency_histogram_sysvars(latency_histogram_engine_commit_trx);
+  free_latency_histogram_sysvars(latency_histogram_engine_prepare_trx);
+  free_latency_histogram_sysvars(latency_histogram_binlog_flush_stage);
+  free_latency_histogram_sysvars(latency_histogram_binlog_sync_stage);
+  free_latency_histogram_sysvars(latency_histogram_binlog_commit_stage);
+  free_latency_histogram_sysvars(histogram_binlog_sync_stage_queue_var);
+  free_latency_histogram_sysvars(histogram_binlog_commit_stage_queue_var);
 
   free_latency_histogram_sysvars(latency_histogram_binlog_fsync);
   free_latency_histogram_sysvars(histogram_binlog_group_commit_var);
@@ -4939,6 +4983,10 @@ SHOW_VAR com_status_vars[] = {
     {"create_view",
      (char *)offsetof(System_status_var, com_stat[(uint)SQLCOM_CREATE_VIEW]),
      SHOW_LONG_STATUS, SHOW_SCOPE_ALL},
+    {"create_materialized_view",
+     (char *)offsetof(System_status_var,
+                      com_stat[(uint)SQLCOM_CREATE_MATERIALIZED_VIEW]),
+     SHOW_LONG_STATUS, SHOW_SCOPE_ALL},
     {"create_spatial_reference_system",
      (char *)offsetof(System_status_var, com_stat[(uint)SQLCOM_CREATE_SRS]),
      SHOW_LONG_STATUS, SHOW_SCOPE_ALL},
@@ -4994,6 +5042,10 @@ SHOW_VAR com_status_vars[] = {
     {"drop_view",
      (char *)offsetof(System_status_var, com_stat[(uint)SQLCOM_DROP_VIEW]),
      SHOW_LONG_STATUS, SHOW_SCOPE_ALL},
+    {"drop_materialized_view",
+     (char *)offsetof(System_status_var,
+                      com_stat[(uint)SQLCOM_DROP_MATERIALIZED_VIEW]),
+     SHOW_LONG_STATUS, SHOW_SCOPE_ALL},
     {"empty_query",
      (char *)offsetof(System_status_var, com_stat[(uint)SQLCOM_EMPTY_QUERY]),
      SHOW_LONG_STATUS, SHOW_SCOPE_ALL},
@@ -5088,6 +5140,10 @@ SHOW_VAR com_status_vars[] = {
     {"rename_user",
      (char *)offsetof(System_status_var, com_stat[(uint)SQLCOM_RENAME_USER]),
      SHOW_LONG_STATUS, SHOW_SCOPE_ALL},
+    {"refresh_materialized_view",
+     (char *)offsetof(System_status_var,
+                      com_stat[(uint)SQLCOM_REFRESH_MATERIALIZED_VIEW]),
+     SHOW_LONG_STATUS, SHOW_SCOPE_ALL},
     {"repair",
      (char *)offsetof(System_status_var, com_stat[(uint)SQLCOM_REPAIR]),
      SHOW_LONG_STATUS, SHOW_SCOPE_ALL},
@@ -5343,6 +5399,11 @@ SHOW_VAR com_status_vars[] = {
     {"stmt_send_long_data",
      (char *)offsetof(System_status_var, com_stmt_send_long_data),
      SHOW_LONG_STATUS, SHOW_SCOPE_ALL},
+    {"stop_sync",
+     (char *)offsetof(System_status_var, com_stat[(uint)SQLCOM_STOP_SYNC]),
+     SHOW_LONG_STATUS, SHOW_SCOPE_ALL},
+    {"sync", (char *)offsetof(System_status_var, com_stat[(uint)SQLCOM_SYNC]),
+     SHOW_LONG_STATUS, SHOW_SCOPE_ALL},
     {"truncate",
      (char *)offsetof(System_status_var, com_stat[(uint)SQLCOM_TRUNCATE]),
      SHOW_LONG_STATUS, SHOW_SCOPE_ALL},
@@ -7179,6 +7240,14 @@ static int init_server_components() {
   randominit(&sql_rand, (ulong)server_start_time, (ulong)server_start_time / 2);
   setup_fpu();
 
+  // Set up curl while we are still single threaded.
+  if (SEMANTICDB_ENABLED && !is_help_or_validate_option())
+    semantic_client_init();
+
+  if (!is_help_or_validate_option() && malloc_arenas_update())
+    LogErr(WARNING_LEVEL, ER_LOG_PRINTF_MSG,
+           "Could not set up all subsystem malloc arenas");
+
   setup_error_log();  // opens the log if needed
 
   // Mysys THD hooks.
@@ -9361,6 +9430,11 @@ int mysqld_main(int argc, char **argv)
   }
 
   start_handle_manager();
+  semantic_materializer_init();
+  histogram_refresher_init();
+  materialized_view_init();
+  change_stream_init();
+  continuous_query_init();
 
   // initialize write throttling dimensions at server start
   if (latest_write_throttle_permissible_dimensions_in_order != nullptr) {
@@ -10596,6 +10670,33 @@ static int show_jemalloc_tcache_bytes(THD *thd, SHOW_VAR *var, char *buff) {
       thd, var, buff,
       "stats.arenas." JEMALLOC_STRINGIFY(MALLCTL_ARENAS_ALL) ".tcache_bytes");
 }
+
+/* Resident and dirty bytes of each subsystem arena, see malloc_arena.h. */
+static ulonglong malloc_arena_values[MALLOC_ARENA_END][2];
+
+#define MALLOC_ARENA_STATUS_VAR(name, arena, stat)                 \
+  {name, (char *)&malloc_arena_values[arena][stat], SHOW_LONGLONG, \
+   SHOW_SCOPE_GLOBAL}
+#define MALLOC_ARENA_STATUS_VARS(name, arena)       \
+  MALLOC_ARENA_STATUS_VAR(name "_dirty", arena, 1), \
+      MALLOC_ARENA_STATUS_VAR(name "_resident", arena, 0)
+
+static SHOW_VAR malloc_arena_status_vars[] = {
+    MALLOC_ARENA_STATUS_VARS("hash_join", MALLOC_ARENA_HASH_JOIN),
+    MALLOC_ARENA_STATUS_VARS("semantic", MALLOC_ARENA_SEMANTIC),
+    MALLOC_ARENA_STATUS_VARS("vector", MALLOC_ARENA_VECTOR),
+    {NullS, NullS, SHOW_LONG, SHOW_SCOPE_ALL}};
+
+static int show_jemalloc_arena(THD *, SHOW_VAR *var, char *) {
+  update_malloc_status();
+  for (int arena = MALLOC_ARENA_NONE + 1; arena < MALLOC_ARENA_END; ++arena)
+    malloc_arena_stats(static_cast<enum_malloc_arena>(arena),
+                       &malloc_arena_values[arena][0],
+                       &malloc_arena_values[arena][1]);
+  var->type = SHOW_ARRAY;
+  var->value = (char *)&malloc_arena_status_vars;
+  return 0;
+}
 #endif /* HAVE_JEMALLOC */
 
 static int show_latency_histogram_raft_trx_wait(THD * /*thd*/, SHOW_VAR *var,
@@ -10651,6 +10752,150 @@ static int show_queries(THD *thd, SHOW_VAR *var, char *) {
   return 0;
 }
 
+static int show_query_result_cache_hits(THD *, SHOW_VAR *var, char *buff) {
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  *((ulonglong *)buff) = query_result_cache_stats().hits;
+  return 0;
+}
+
+static int show_query_result_cache_misses(THD *, SHOW_VAR *var, char *buff) {
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  *((ulonglong *)buff) = query_result_cache_stats().misses;
+  return 0;
+}
+
+static int show_query_result_cache_inserts(THD *, SHOW_VAR *var, char *buff) {
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  *((ulonglong *)buff) = query_result_cache_stats().inserts;
+  return 0;
+}
+
+static int show_query_result_cache_invalidated(THD *, SHOW_VAR *var,
+                                               char *buff) {
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  *((ulonglong *)buff) = query_result_cache_stats().invalidated;
+  return 0;
+}
+
+static int show_semantic_cache_hits(THD *, SHOW_VAR *var, char *buff) {
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  *((ulonglong *)buff) = semantic_cache_stats().hits;
+  return 0;
+}
+
+static int show_semantic_cache_misses(THD *, SHOW_VAR *var, char *buff) {
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  *((ulonglong *)buff) = semantic_cache_stats().misses;
+  return 0;
+}
+
+static int show_semantic_cache_saved_tokens(THD *, SHOW_VAR *var, char *buff) {
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  *((ulonglong *)buff) = semantic_cache_stats().saved_tokens;
+  return 0;
+}
+
+static int show_semantic_materialize_pending(THD *, SHOW_VAR *var,
+                                             char *buff) {
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  *((ulonglong *)buff) = semantic_materializer_pending();
+  return 0;
+}
+
+/* Counters of one semantic operator, see System_status_var. */
+#define SEMANTIC_STATUS_VAR(name, member)                                   \
+  {name, (char *)offsetof(System_status_var, member), SHOW_LONGLONG_STATUS, \
+   SHOW_SCOPE_ALL}
+#define SEMANTIC_STATUS_VARS(op)                                              \
+  {SEMANTIC_STATUS_VAR("cache_hits", semantic_cache_hits[op]),                \
+   SEMANTIC_STATUS_VAR("calls", semantic_calls[op]),                          \
+   SEMANTIC_STATUS_VAR("failures", semantic_failures[op]),                    \
+   SEMANTIC_STATUS_VAR("queue_time", semantic_queue_time[op]),                \
+   SEMANTIC_STATUS_VAR("request_time", semantic_request_time[op]),            \
+   SEMANTIC_STATUS_VAR("requests", semantic_requests[op]),                    \
+   SEMANTIC_STATUS_VAR("requests_under_10ms",                                 \
+                       semantic_request_latency[op][0]),                      \
+   SEMANTIC_STATUS_VAR("requests_under_100ms",                                \
+                       semantic_request_latency[op][1]),                      \
+   SEMANTIC_STATUS_VAR("requests_under_1s", semantic_request_latency[op][2]), \
+   SEMANTIC_STATUS_VAR("requests_under_10s",                                  \
+                       semantic_request_latency[op][3]),                      \
+   SEMANTIC_STATUS_VAR("requests_over_10s", semantic_request_latency[op][4]), \
+   SEMANTIC_STATUS_VAR("tokens_in", semantic_tokens_in[op]),                  \
+   SEMANTIC_STATUS_VAR("tokens_out", semantic_tokens_out[op]),                \
+   {NullS, NullS, SHOW_LONG, SHOW_SCOPE_ALL}}
+
+static_assert(SEMANTIC_LATENCY_BUCKETS == 5,
+              "a status variable for every latency bucket");
+
+static SHOW_VAR semantic_filter_status_vars[] =
+    SEMANTIC_STATUS_VARS(SEMANTIC_OP_FILTER);
+static SHOW_VAR semantic_map_status_vars[] =
+    SEMANTIC_STATUS_VARS(SEMANTIC_OP_MAP);
+static SHOW_VAR semantic_extract_status_vars[] =
+    SEMANTIC_STATUS_VARS(SEMANTIC_OP_EXTRACT);
+static SHOW_VAR semantic_embed_status_vars[] =
+    SEMANTIC_STATUS_VARS(SEMANTIC_OP_EMBED);
+
+static int show_continuous_queries(THD *, SHOW_VAR *var, char *buff) {
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  *((ulonglong *)buff) = continuous_query_stats().queries;
+  return 0;
+}
+
+static int show_continuous_query_runs(THD *, SHOW_VAR *var, char *buff) {
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  *((ulonglong *)buff) = continuous_query_stats().runs;
+  return 0;
+}
+
+static int show_continuous_query_coalesced(THD *, SHOW_VAR *var, char *buff) {
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  *((ulonglong *)buff) = continuous_query_stats().coalesced;
+  return 0;
+}
+
+static int show_continuous_query_overruns(THD *, SHOW_VAR *var, char *buff) {
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  *((ulonglong *)buff) = continuous_query_stats().overruns;
+  return 0;
+}
+
+static int show_continuous_query_top_k_searches(THD *, SHOW_VAR *var,
+                                                char *buff) {
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  *((ulonglong *)buff) = continuous_query_stats().top_k_searches;
+  return 0;
+}
+
+static int show_continuous_query_late_rows(THD *, SHOW_VAR *var, char *buff) {
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  *((ulonglong *)buff) = continuous_query_stats().late_rows;
+  return 0;
+}
+
+static int show_continuous_query_shared_skips(THD *, SHOW_VAR *var,
+                                              char *buff) {
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  *((ulonglong *)buff) = continuous_query_stats().shared_skips;
+  return 0;
+}
+
 static int show_net_compression(THD *thd, SHOW_VAR *var, char *buff) {
   var->type = SHOW_MY_BOOL;
   var->value = buff;
@@ -10899,6 +11144,22 @@ static int get_db_ac_total_rejected_connections(THD *thd MY_ATTRIBUTE((unused)),
   return 0;
 }
 
+static int get_db_ac_total_semantic_waits(THD *thd MY_ATTRIBUTE((unused)),
+                                          SHOW_VAR *var, char *buff) {
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  *((longlong *)buff) = db_ac->get_total_semantic_waits();
+  return 0;
+}
+
+static int get_db_ac_total_semantic_throttles(THD *thd MY_ATTRIBUTE((unused)),
+                                              SHOW_VAR *var, char *buff) {
+  var->type = SHOW_LONGLONG;
+  var->value = buff;
+  *((longlong *)buff) = db_ac->get_total_semantic_throttles();
+  return 0;
+}
+
 #ifdef ENABLED_PROFILING
 static int show_flushstatustime(THD *thd, SHOW_VAR *var, char *buff) {
   var->type = SHOW_LONGLONG;
@@ -11364,6 +11625,71 @@ static int show_latency_histogram_engine_commit_trx(THD * /*thd*/,
       latency_histogram_engine_commit_trx, &histogram_binlog_engine_commit_trx);
 }
 
+static int show_latency_histogram_engine_prepare_trx(THD * /*thd*/,
+                                                     SHOW_VAR *var,
+                                                     char * /*buf*/) {
+  return show_latency_histogram_commit_trx_helper(
+      var, histogram_engine_prepare_trx_values,
+      latency_histogram_engine_prepare_trx,
+      &histogram_binlog_engine_prepare_trx);
+}
+
+static int show_latency_histogram_binlog_flush_stage(THD * /*thd*/,
+                                                     SHOW_VAR *var,
+                                                     char * /*buf*/) {
+  return show_latency_histogram_commit_trx_helper(
+      var, histogram_binlog_flush_stage_values,
+      latency_histogram_binlog_flush_stage, &histogram_binlog_flush_stage);
+}
+
+static int show_latency_histogram_binlog_sync_stage(THD * /*thd*/,
+                                                    SHOW_VAR *var,
+                                                    char * /*buf*/) {
+  return show_latency_histogram_commit_trx_helper(
+      var, histogram_binlog_sync_stage_values,
+      latency_histogram_binlog_sync_stage, &histogram_binlog_sync_stage);
+}
+
+static int show_latency_histogram_binlog_commit_stage(THD * /*thd*/,
+                                                      SHOW_VAR *var,
+                                                      char * /*buf*/) {
+  return show_latency_histogram_commit_trx_helper(
+      var, histogram_binlog_commit_stage_values,
+      latency_histogram_binlog_commit_stage, &histogram_binlog_commit_stage);
+}
+
+static int show_counter_histogram_stage_queue_helper(
+    SHOW_VAR *var, ulonglong queue_values[], SHOW_VAR *show_var_queue,
+    counter_histogram *histogram) {
+  for (int i = 0; i < NUMBER_OF_HISTOGRAM_BINS; ++i) {
+    queue_values[i] = (histogram->count_per_bin)[i];
+  }
+
+  prepare_counter_histogram_vars(histogram, show_var_queue, queue_values);
+  var->type = SHOW_ARRAY;
+  var->value = (char *)show_var_queue;
+
+  return 0;
+}
+
+static int show_histogram_binlog_sync_stage_queue(THD * /*thd*/,
+                                                  SHOW_VAR *var,
+                                                  char * /*buf*/) {
+  return show_counter_histogram_stage_queue_helper(
+      var, histogram_binlog_sync_stage_queue_values,
+      histogram_binlog_sync_stage_queue_var,
+      &histogram_binlog_sync_stage_queue);
+}
+
+static int show_histogram_binlog_commit_stage_queue(THD * /*thd*/,
+                                                    SHOW_VAR *var,
+                                                    char * /*buf*/) {
+  return show_counter_histogram_stage_queue_helper(
+      var, histogram_binlog_commit_stage_queue_values,
+      histogram_binlog_commit_stage_queue_var,
+      &histogram_binlog_commit_stage_queue);
+}
+
 static int show_sql_plans_stmts_seen(THD *, SHOW_VAR *var, char *buf) {
   var->type = SHOW_LONGLONG;
   var->value = buf;
@@ -11412,6 +11738,15 @@ SHOW_VAR status_vars[] = {
      SHOW_SCOPE_GLOBAL},
     {"Binlog_cache_use", (char *)&binlog_cache_use, SHOW_LONG,
      SHOW_SCOPE_GLOBAL},
+    {"Binlog_group_commit_arrival_rate",
+     (char *)&binlog_group_commit_arrival_rate, SHOW_LONGLONG,
+     SHOW_SCOPE_GLOBAL},
+    {"Binlog_group_commit_sync_delay",
+     (char *)&binlog_group_commit_adaptive_sync_delay, SHOW_LONGLONG,
+     SHOW_SCOPE_GLOBAL},
+    {"Binlog_group_commit_sync_latency",
+     (char *)&binlog_group_commit_sync_latency, SHOW_LONGLONG,
+     SHOW_SCOPE_GLOBAL},
     {"Binlog_stmt_cache_disk_use", (char *)&binlog_stmt_cache_disk_use,
      SHOW_LONG, SHOW_SCOPE_GLOBAL},
     {"Binlog_stmt_cache_use", (char *)&binlog_stmt_cache_use, SHOW_LONG,
@@ -11479,6 +11814,22 @@ SHOW_VAR status_vars[] = {
      SHOW_FUNC, SHOW_SCOPE_GLOBAL},
     {"Connection_errors_tcpwrap", (char *)&show_connection_errors_tcpwrap,
      SHOW_FUNC, SHOW_SCOPE_GLOBAL},
+    {"Continuous_queries", (char *)&show_continuous_queries, SHOW_FUNC,
+     SHOW_SCOPE_GLOBAL},
+    {"Continuous_query_coalesced", (char *)&show_continuous_query_coalesced,
+     SHOW_FUNC, SHOW_SCOPE_GLOBAL},
+    {"Continuous_query_late_rows", (char *)&show_continuous_query_late_rows,
+     SHOW_FUNC, SHOW_SCOPE_GLOBAL},
+    {"Continuous_query_overruns", (char *)&show_continuous_query_overruns,
+     SHOW_FUNC, SHOW_SCOPE_GLOBAL},
+    {"Continuous_query_runs", (char *)&show_continuous_query_runs, SHOW_FUNC,
+     SHOW_SCOPE_GLOBAL},
+    {"Continuous_query_shared_skips",
+     (char *)&show_continuous_query_shared_skips, SHOW_FUNC,
+     SHOW_SCOPE_GLOBAL},
+    {"Continuous_query_top_k_searches",
+     (char *)&show_continuous_query_top_k_searches, SHOW_FUNC,
+     SHOW_SCOPE_GLOBAL},
     {"Created_tmp_disk_tables",
      (char *)offsetof(System_status_var, created_tmp_disk_tables),
      SHOW_LONGLONG_STATUS, SHOW_SCOPE_ALL},
@@ -11494,6 +11845,10 @@ SHOW_VAR status_vars[] = {
      SHOW_SCOPE_GLOBAL},
     {"Database_admission_control_running_queries",
      (char *)&get_db_ac_total_running_queries, SHOW_FUNC, SHOW_SCOPE_GLOBAL},
+    {"Database_admission_control_semantic_throttles",
+     (char *)&get_db_ac_total_semantic_throttles, SHOW_FUNC, SHOW_SCOPE_GLOBAL},
+    {"Database_admission_control_semantic_waits",
+     (char *)&get_db_ac_total_semantic_waits, SHOW_FUNC, SHOW_SCOPE_GLOBAL},
     {"Database_admission_control_timeout_queries",
      (char *)&get_db_ac_total_timeout_queries, SHOW_FUNC, SHOW_SCOPE_GLOBAL},
     {"Database_admission_control_waiting_queries",
@@ -11577,6 +11932,8 @@ SHOW_VAR status_vars[] = {
     {"Handler_write", (char *)offsetof(System_status_var, ha_write_count),
      SHOW_LONGLONG_STATUS, SHOW_SCOPE_ALL},
 #ifdef HAVE_JEMALLOC
+    {"Jemalloc_arena", (char *)&show_jemalloc_arena, SHOW_FUNC,
+     SHOW_SCOPE_GLOBAL},
     {"Jemalloc_arenas_narenas", (char *)&show_jemalloc_arenas_narenas,
      SHOW_FUNC, SHOW_SCOPE_ALL},
     {"Jemalloc_opt_narenas", (char *)&show_jemalloc_opt_narenas, SHOW_FUNC,
@@ -11663,6 +12020,15 @@ SHOW_VAR status_vars[] = {
      SHOW_SCOPE_GLOBAL},
 #endif
     {"Queries", (char *)&show_queries, SHOW_FUNC, SHOW_SCOPE_ALL},
+    {"Query_result_cache_hits", (char *)&show_query_result_cache_hits,
+     SHOW_FUNC, SHOW_SCOPE_GLOBAL},
+    {"Query_result_cache_inserts", (char *)&show_query_result_cache_inserts,
+     SHOW_FUNC, SHOW_SCOPE_GLOBAL},
+    {"Query_result_cache_invalidated",
+     (char *)&show_query_result_cache_invalidated, SHOW_FUNC,
+     SHOW_SCOPE_GLOBAL},
+    {"Query_result_cache_misses", (char *)&show_query_result_cache_misses,
+     SHOW_FUNC, SHOW_SCOPE_GLOBAL},
     {"Questions", (char *)offsetof(System_status_var, questions),
      SHOW_LONGLONG_STATUS, SHOW_SCOPE_ALL},
     {"Rbr_unsafe_queries", (char *)&rbr_unsafe_queries, SHOW_LONGLONG,
@@ -11701,6 +12067,22 @@ SHOW_VAR status_vars[] = {
      SHOW_LONGLONG_STATUS, SHOW_SCOPE_ALL},
     {"Select_scan", (char *)offsetof(System_status_var, select_scan_count),
      SHOW_LONGLONG_STATUS, SHOW_SCOPE_ALL},
+    {"Semantic_cache_hits", (char *)&show_semantic_cache_hits, SHOW_FUNC,
+     SHOW_SCOPE_GLOBAL},
+    {"Semantic_embed", (char *)semantic_embed_status_vars, SHOW_ARRAY,
+     SHOW_SCOPE_ALL},
+    {"Semantic_extract", (char *)semantic_extract_status_vars, SHOW_ARRAY,
+     SHOW_SCOPE_ALL},
+    {"Semantic_filter", (char *)semantic_filter_status_vars, SHOW_ARRAY,
+     SHOW_SCOPE_ALL},
+    {"Semantic_map", (char *)semantic_map_status_vars, SHOW_ARRAY,
+     SHOW_SCOPE_ALL},
+    {"Semantic_cache_misses", (char *)&show_semantic_cache_misses, SHOW_FUNC,
+     SHOW_SCOPE_GLOBAL},
+    {"Semantic_cache_saved_tokens", (char *)&show_semantic_cache_saved_tokens,
+     SHOW_FUNC, SHOW_SCOPE_GLOBAL},
+    {"Semantic_materialize_pending", (char *)&show_semantic_materialize_pending,
+     SHOW_FUNC, SHOW_SCOPE_GLOBAL},
     {"Slave_commit_order_deadlocks", (char *)&show_slave_commit_order_deadlocks,
      SHOW_FUNC, SHOW_SCOPE_GLOBAL},
     {"Slave_open_temp_tables", (char *)&show_replica_open_temp_tables,
@@ -11913,6 +12295,24 @@ SHOW_VAR status_vars[] = {
     {"engine_commit_trx_histogram",
      (char *)&show_latency_histogram_engine_commit_trx, SHOW_FUNC,
      SHOW_SCOPE_GLOBAL},
+    {"engine_prepare_trx_histogram",
+     (char *)&show_latency_histogram_engine_prepare_trx, SHOW_FUNC,
+     SHOW_SCOPE_GLOBAL},
+    {"Latency_histogram_binlog_flush_stage",
+     (char *)&show_latency_histogram_binlog_flush_stage, SHOW_FUNC,
+     SHOW_SCOPE_GLOBAL},
+    {"Latency_histogram_binlog_sync_stage",
+     (char *)&show_latency_histogram_binlog_sync_stage, SHOW_FUNC,
+     SHOW_SCOPE_GLOBAL},
+    {"Latency_histogram_binlog_commit_stage",
+     (char *)&show_latency_histogram_binlog_commit_stage, SHOW_FUNC,
+     SHOW_SCOPE_GLOBAL},
+    {"histogram_binlog_sync_stage_queue",
+     (char *)&show_histogram_binlog_sync_stage_queue, SHOW_FUNC,
+     SHOW_SCOPE_GLOBAL},
+    {"histogram_binlog_commit_stage_queue",
+     (char *)&show_histogram_binlog_commit_stage_queue, SHOW_FUNC,
+     SHOW_SCOPE_GLOBAL},
     {NullS, NullS, SHOW_LONG, SHOW_SCOPE_ALL}};
 
 void add_terminator(vector<my_option> *options) {
@@ -14113,6 +14513,17 @@ PSI_thread_key key_thread_compress_gtid_table;
 PSI_thread_key key_thread_parser_service;
 PSI_thread_key key_thread_handle_con_admin_sockets;
 PSI_thread_key key_thread_dump_worker;
+PSI_thread_key key_thread_load_worker;
+PSI_thread_key key_thread_semantic_materializer;
+PSI_thread_key key_thread_continuous_query_timer;
+PSI_thread_key key_thread_continuous_query_worker;
+PSI_thread_key key_thread_hash_join_prefetch;
+PSI_thread_key key_thread_semantic_prefetch;
+PSI_thread_key key_thread_histogram_refresher;
+PSI_thread_key key_thread_replica_decoder;
+PSI_thread_key key_thread_pool_worker;
+PSI_thread_key key_thread_pool_timer;
+PSI_thread_key key_thread_pool_commit_ack;
 
 /* clang-format off */
 static PSI_thread_info all_server_threads[]=
@@ -14134,6 +14545,17 @@ PSI_FLAG_USER | PSI_FLAG_NO_SEQNUM, 0, PSI_DOCUMENT_ME},
   { &key_thread_parser_service, "parser_service", "parser_srv", PSI_FLAG_SINGLETON, 0, PSI_DOCUMENT_ME},
   { &key_thread_handle_con_admin_sockets, "admin_interface", "con_admin", PSI_FLAG_USER, 0, PSI_DOCUMENT_ME},
   { &key_thread_dump_worker, "dump_worker", "dump", PSI_FLAG_THREAD_SYSTEM, 0, PSI_DOCUMENT_ME},
+  { &key_thread_load_worker, "load_worker", "load", PSI_FLAG_THREAD_SYSTEM, 0, PSI_DOCUMENT_ME},
+  { &key_thread_semantic_materializer, "semantic_materializer", "sem_mat", PSI_FLAG_THREAD_SYSTEM, 0, PSI_DOCUMENT_ME},
+  { &key_thread_continuous_query_timer, "continuous_query_timer", "cq_timer", PSI_FLAG_SINGLETON | PSI_FLAG_THREAD_SYSTEM, 0, PSI_DOCUMENT_ME},
+  { &key_thread_continuous_query_worker, "continuous_query_worker", "cq_worker", PSI_FLAG_THREAD_SYSTEM, 0, PSI_DOCUMENT_ME},
+  { &key_thread_hash_join_prefetch, "hash_join_prefetch", "hj_prefetch", PSI_FLAG_THREAD_SYSTEM, 0, PSI_DOCUMENT_ME},
+  { &key_thread_semantic_prefetch, "semantic_prefetch", "sem_prefetch", PSI_FLAG_THREAD_SYSTEM, 0, PSI_DOCUMENT_ME},
+  { &key_thread_histogram_refresher, "histogram_refresher", "hist_refresh", PSI_FLAG_SINGLETON | PSI_FLAG_THREAD_SYSTEM, 0, PSI_DOCUMENT_ME},
+  { &key_thread_replica_decoder, "replica_decoder", "rpl_decode", PSI_FLAG_THREAD_SYSTEM, 0, PSI_DOCUMENT_ME},
+  { &key_thread_pool_worker, "thread_pool_worker", "tp_worker", PSI_FLAG_THREAD_SYSTEM, 0, PSI_DOCUMENT_ME},
+  { &key_thread_pool_timer, "thread_pool_timer", "tp_timer", PSI_FLAG_SINGLETON | PSI_FLAG_THREAD_SYSTEM, 0, PSI_DOCUMENT_ME},
+  { &key_thread_pool_commit_ack, "thread_pool_commit_ack", "tp_commit_ack", PSI_FLAG_SINGLETON | PSI_FLAG_THREAD_SYSTEM, 0, PSI_DOCUMENT_ME},
 };
 /* clang-format on */
 
@@ -14303,6 +14725,10 @@ PSI_stage_info stage_waiting_for_hlc= { 0, "Waiting for database applied HLC", 0
 PSI_stage_info stage_waiting_for_work_item= { 0, "Waiting for work item", 0, PSI_DOCUMENT_ME};
 PSI_stage_info stage_dumping_table= { 0, "Dumping table", 0, PSI_DOCUMENT_ME};
 PSI_stage_info stage_dumping_chunk= { 0, "Dumping table chunk", 0, PSI_DOCUMENT_ME};
+PSI_stage_info stage_loading_chunk= { 0, "Loading table chunk", 0, PSI_DOCUMENT_ME};
+PSI_stage_info stage_waiting_for_materialized_view_refresh= { 0, "Waiting for materialized view refresh", 0, PSI_DOCUMENT_ME};
+PSI_stage_info stage_waiting_for_continuous_query_tick= { 0, "Waiting for next continuous query tick", 0, PSI_DOCUMENT_ME};
+PSI_stage_info stage_waiting_for_semantic_model= { 0, "Waiting for semantic model", 0, PSI_DOCUMENT_ME};
 /* clang-format on */
 
 extern PSI_stage_info stage_waiting_for_disk_space;
@@ -14387,6 +14813,7 @@ PSI_stage_info *all_server_stages[] = {
     &stage_verifying_table,
     &stage_waiting_for_admission,
     &stage_waiting_for_readmission,
+    &stage_waiting_for_semantic_admission,
     &stage_waiting_for_gtid_to_be_committed,
     &stage_waiting_for_handler_commit,
     &stage_waiting_for_source_to_send_event,
@@ -14416,7 +14843,11 @@ PSI_stage_info *all_server_stages[] = {
     &stage_waiting_for_work_item,
     &stage_communication_delegation,
     &stage_dumping_table,
-    &stage_dumping_chunk};
+    &stage_dumping_chunk,
+    &stage_loading_chunk,
+    &stage_waiting_for_materialized_view_refresh,
+    &stage_waiting_for_continuous_query_tick,
+    &stage_waiting_for_semantic_model};
 
 PSI_socket_key key_socket_tcpip;
 PSI_socket_key key_socket_unix;
@@ -410,6 +410,8 @@ extern bool slave_skip_max_binlog_cache_size_check;
 extern int32 opt_binlog_max_flush_queue_time;
 extern long opt_binlog_group_commit_sync_delay;
 extern ulong opt_binlog_group_commit_sync_no_delay_count;
+extern bool opt_binlog_group_commit_sync_delay_adaptive;
+extern long opt_binlog_group_commit_target_latency;
 extern ulong max_binlog_size, max_relay_log_size;
 extern ulong replica_max_allowed_packet;
 extern ulonglong opt_binlog_rows_event_max_rows;
@@ -530,6 +532,8 @@ extern char *optimizer_force_index_rewrite;
 extern uint net_compression_level;
 extern long zstd_net_compression_level;
 extern long lz4f_net_compression_level;
+extern uint zstd_net_window_log;
+extern double zstd_net_max_entropy;
 extern bool enable_blind_replace;
 extern bool set_read_only_on_shutdown;
 extern bool show_binlogs_encryption;
@@ -622,6 +626,7 @@ extern uint write_throttle_monitor_cycles;
 extern uint write_throttle_lag_pct_min_secondaries;
 extern ulong write_auto_throttle_frequency;
 extern uint write_throttle_rate_step;
+extern bool write_throttle_shard_lag;
 /* Controls collecting MySQL findings (aka SQL conditions) */
 extern ulong sql_findings_control;
 /* The maximum size of the memory to store SQL findings */
@@ -918,6 +923,17 @@ extern PSI_thread_key key_thread_compress_gtid_table;
 extern PSI_thread_key key_thread_parser_service;
 extern PSI_thread_key key_thread_handle_con_admin_sockets;
 extern PSI_thread_key key_thread_dump_worker;
+extern PSI_thread_key key_thread_load_worker;
+extern PSI_thread_key key_thread_semantic_materializer;
+extern PSI_thread_key key_thread_continuous_query_timer;
+extern PSI_thread_key key_thread_continuous_query_worker;
+extern PSI_thread_key key_thread_hash_join_prefetch;
+extern PSI_thread_key key_thread_semantic_prefetch;
+extern PSI_thread_key key_thread_histogram_refresher;
+extern PSI_thread_key key_thread_replica_decoder;
+extern PSI_thread_key key_thread_pool_worker;
+extern PSI_thread_key key_thread_pool_timer;
+extern PSI_thread_key key_thread_pool_commit_ack;
 extern PSI_cond_key key_monitor_info_run_cond;
 
 extern PSI_file_key key_file_binlog;
@@ -1064,6 +1080,10 @@ extern PSI_stage_info stage_waiting_for_hlc;
 extern PSI_stage_info stage_waiting_for_work_item;
 extern PSI_stage_info stage_dumping_table;
 extern PSI_stage_info stage_dumping_chunk;
+extern PSI_stage_info stage_loading_chunk;
+extern PSI_stage_info stage_waiting_for_materialized_view_refresh;
+extern PSI_stage_info stage_waiting_for_continuous_query_tick;
+extern PSI_stage_info stage_waiting_for_semantic_model;
 #ifdef HAVE_PSI_STATEMENT_INTERFACE
 /**
   Statement instrumentation keys (sql).
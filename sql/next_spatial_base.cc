@@ -3,7 +3,10 @@
 */
 
    #include "sql/next_spatial_base.h"
+   #include <algorithm>
    #include <cassert>
+   #include <cmath>
+   #include <cstring>
    #include <map>
    #include <string_view>
    #include <iostream>
@@ -17,7 +20,8 @@
    
    static const std::map<std::string_view, NEXT_SPATIAL_INDEX_TYPE>
        next_spatial_index_types{{"nogobal", NEXT_SPATIAL_INDEX_TYPE::NO_GLOBAL_INDEX},
-                             {"global", NEXT_SPATIAL_INDEX_TYPE::GLOBAL_INDEX}};
+                             {"global", NEXT_SPATIAL_INDEX_TYPE::GLOBAL_INDEX},
+                             {"hilbert", NEXT_SPATIAL_INDEX_TYPE::HILBERT_INDEX}};
    
    /**
        return true on error
@@ -50,8 +54,319 @@
            case NEXT_SPATIAL_INDEX_TYPE::NONE:   return "none";
            case NEXT_SPATIAL_INDEX_TYPE::NO_GLOBAL_INDEX:   return "noglobal";
            case NEXT_SPATIAL_INDEX_TYPE::GLOBAL_INDEX: return "global";
+           case NEXT_SPATIAL_INDEX_TYPE::HILBERT_INDEX: return "hilbert";
            default:      return "[Unknown index_type]";
        }
    }
-   
-   
\ No newline at end of file
+
+   std::vector<double> next_spatial_radius_mbr(double lon, double lat,
+                                               double radius) {
+     const double angle = radius / NEXT_SPATIAL_EARTH_RADIUS;
+     if (angle >= M_PI) {
+       return {-90, 90, -180, 180};
+     }
+     const double delta_lat = angle * 180 / M_PI;
+     const double lat_min = lat - delta_lat;
+     const double lat_max = lat + delta_lat;
+     if (lat_min <= -90 || lat_max >= 90) {
+       return {std::max(lat_min, -90.0), std::min(lat_max, 90.0), -180, 180};
+     }
+     const double delta_lon =
+         std::asin(std::sin(angle) / std::cos(lat * M_PI / 180)) * 180 / M_PI;
+     if (lon - delta_lon < -180 || lon + delta_lon > 180) {
+       return {lat_min, lat_max, -180, 180};
+     }
+     return {lat_min, lat_max, lon - delta_lon, lon + delta_lon};
+   }
+
+   bool get_next_spatial_distance_bound(Item_func *cond, Item_field **field,
+                                        Item **geometry, Item **radius) {
+     if (cond->argument_count() != 2) return false;
+     Item *distance;
+     switch (cond->functype()) {
+       case Item_func::LT_FUNC:
+       case Item_func::LE_FUNC:
+         distance = cond->arguments()[0]->real_item();
+         *radius = cond->arguments()[1];
+         break;
+       case Item_func::GT_FUNC:
+       case Item_func::GE_FUNC:
+         distance = cond->arguments()[1]->real_item();
+         *radius = cond->arguments()[0];
+         break;
+       default:
+         return false;
+     }
+     if (distance->type() != Item::FUNC_ITEM) return false;
+     Item_func *distance_func = down_cast<Item_func *>(distance);
+     if (strcmp(distance_func->func_name(), "st_distance") != 0 ||
+         distance_func->argument_count() != 2) {
+       return false;
+     }
+     for (uint i = 0; i < 2; i++) {
+       Item *column = distance_func->arguments()[i]->real_item();
+       // a bound between two columns is no range over the index
+       if (column->type() == Item::FIELD_ITEM &&
+           distance_func->arguments()[1 - i]->real_item()->type() !=
+               Item::FIELD_ITEM) {
+         *field = down_cast<Item_field *>(column);
+         *geometry = distance_func->arguments()[1 - i];
+         return true;
+       }
+     }
+     return false;
+   }
+
+   bool get_next_spatial_join_predicate(Item *cond, table_map outer_tables,
+                                        table_map inner_tables,
+                                        Item **outer_geometry,
+                                        Item **inner_geometry, Item **radius) {
+     if (cond->type() != Item::FUNC_ITEM) return false;
+     Item_func *func = down_cast<Item_func *>(cond);
+     if (func->argument_count() != 2) return false;
+     Item *const *geometries = func->arguments();
+     *radius = nullptr;
+     switch (func->functype()) {
+       case Item_func::SP_EQUALS_FUNC:
+       case Item_func::SP_INTERSECTS_FUNC:
+       case Item_func::SP_TOUCHES_FUNC:
+       case Item_func::SP_CROSSES_FUNC:
+       case Item_func::SP_WITHIN_FUNC:
+       case Item_func::SP_CONTAINS_FUNC:
+       case Item_func::SP_COVEREDBY_FUNC:
+       case Item_func::SP_COVERS_FUNC:
+       case Item_func::SP_OVERLAPS_FUNC:
+         break;
+       case Item_func::LT_FUNC:
+       case Item_func::LE_FUNC:
+       case Item_func::GT_FUNC:
+       case Item_func::GE_FUNC: {
+         const bool upper = func->functype() == Item_func::LT_FUNC ||
+                            func->functype() == Item_func::LE_FUNC;
+         Item *distance = geometries[upper ? 0 : 1]->real_item();
+         *radius = geometries[upper ? 1 : 0];
+         if (distance->type() != Item::FUNC_ITEM ||
+             strcmp(down_cast<Item_func *>(distance)->func_name(),
+                    "st_distance") != 0 ||
+             down_cast<Item_func *>(distance)->argument_count() != 2 ||
+             !(*radius)->const_for_execution()) {
+           return false;
+         }
+         geometries = down_cast<Item_func *>(distance)->arguments();
+         break;
+       }
+       default:
+         return false;
+     }
+     for (uint i = 0; i < 2; i++) {
+       const table_map outer_used = geometries[i]->used_tables();
+       const table_map inner_used = geometries[1 - i]->used_tables();
+       if (outer_used != 0 && inner_used != 0 &&
+           (outer_used & ~(outer_tables | PSEUDO_TABLE_BITS)) == 0 &&
+           (inner_used & ~(inner_tables | PSEUDO_TABLE_BITS)) == 0) {
+         *outer_geometry = geometries[i];
+         *inner_geometry = geometries[1 - i];
+         return true;
+       }
+     }
+     return false;
+   }
+
+   namespace {
+
+   // an edge is not followed closer to a pole than this when its bulge is
+   // estimated
+   constexpr double NEXT_SPATIAL_MARGIN_MAX_LAT = 89;
+
+   void next_spatial_extend_mbr(std::vector<double> &mbr,
+                                const std::vector<double> &box) {
+     if (mbr.empty()) {
+       mbr = box;
+       return;
+     }
+     mbr[0] = std::min(mbr[0], box[0]);
+     mbr[1] = std::max(mbr[1], box[1]);
+     mbr[2] = std::min(mbr[2], box[2]);
+     mbr[3] = std::max(mbr[3], box[3]);
+   }
+
+   /** angle in radians between two lon/lat points on the sphere */
+   double next_spatial_angle(const Next_spatial_query_geometry::Point &a,
+                             const Next_spatial_query_geometry::Point &b) {
+     const double lat1 = a.second * M_PI / 180;
+     const double lat2 = b.second * M_PI / 180;
+     const double sin_dlat = std::sin((lat2 - lat1) / 2);
+     const double sin_dlon = std::sin((b.first - a.first) * M_PI / 360);
+     const double h = sin_dlat * sin_dlat +
+                      std::cos(lat1) * std::cos(lat2) * sin_dlon * sin_dlon;
+     return 2 * std::asin(std::min(std::sqrt(h), 1.0));
+   }
+
+   }  // namespace
+
+   std::vector<double> Next_spatial_query_geometry::mbr(double radius) const {
+     assert(!empty());
+     radius = std::max(radius, 0.0);
+     std::vector<double> box;
+     if (m_srid == 0) {
+       for (const auto &ring : m_rings) {
+         for (const auto &point : ring) {
+           next_spatial_extend_mbr(
+               box, {point.second - radius, point.second + radius,
+                     point.first - radius, point.first + radius});
+         }
+       }
+       return box;
+     }
+
+     if (m_type == Type::POLYGON) {
+       // an arc of angle t strays about t^2 / 8 radians from the straight
+       // lon/lat segment, more towards the poles; twice that bounds it
+       double margin = 0;
+       for (const auto &ring : m_rings) {
+         for (std::size_t i = 0; i + 1 < ring.size(); ++i) {
+           const double angle = next_spatial_angle(ring[i], ring[i + 1]);
+           const double lat = std::min(
+               std::max(std::fabs(ring[i].second), std::fabs(ring[i + 1].second)),
+               NEXT_SPATIAL_MARGIN_MAX_LAT);
+           margin = std::max(margin, NEXT_SPATIAL_EARTH_RADIUS * angle * angle *
+                                         (1 + std::tan(lat * M_PI / 180)) / 4);
+         }
+       }
+       radius += margin;
+     }
+     for (const auto &ring : m_rings) {
+       for (const auto &point : ring) {
+         next_spatial_extend_mbr(
+             box, next_spatial_radius_mbr(point.first, point.second, radius));
+       }
+     }
+     return box;
+   }
+
+   namespace {
+
+   // wkb geometry types, see Geometry::wkbType
+   constexpr uint32_t NEXT_SPATIAL_WKB_POINT = 1;
+   constexpr uint32_t NEXT_SPATIAL_WKB_POLYGON = 3;
+   constexpr uint32_t NEXT_SPATIAL_WKB_MULTIPOINT = 4;
+   // byte order and type of a wkb geometry
+   constexpr std::size_t NEXT_SPATIAL_WKB_HEADER_SIZE = 5;
+   constexpr std::size_t NEXT_SPATIAL_WKB_POINT_SIZE =
+       NEXT_SPATIAL_WKB_HEADER_SIZE + 2 * sizeof(double);
+
+   /** sequential reader of little endian wkb */
+   class Wkb_reader {
+    public:
+     Wkb_reader(const char *data, std::size_t length)
+         : m_data(data), m_length(length) {}
+
+     bool read_uint32(uint32_t *value) { return read(value, sizeof(*value)); }
+
+     bool read_point(Next_spatial_query_geometry::Point *point) {
+       return read(&point->first, sizeof(double)) ||
+              read(&point->second, sizeof(double));
+     }
+
+     /** byte order and type, only little endian is supported */
+     bool read_header(uint32_t *wkb_type) {
+       if (m_length < 1 || m_data[0] != 1) return true;
+       m_data++;
+       m_length--;
+       return read_uint32(wkb_type);
+     }
+
+     std::size_t remaining() const { return m_length; }
+
+    private:
+     bool read(void *value, std::size_t size) {
+       if (m_length < size) return true;
+       memcpy(value, m_data, size);
+       m_data += size;
+       m_length -= size;
+       return false;
+     }
+
+     const char *m_data;
+     std::size_t m_length;
+   };
+
+   }  // namespace
+
+   bool Next_spatial_query_geometry::parse(const char *geometry,
+                                           std::size_t length) {
+     clear();
+     if (geometry == nullptr) return true;
+     Wkb_reader reader(geometry, length);
+     uint32_t srid = 0;
+     uint32_t wkb_type = 0;
+     if (reader.read_uint32(&srid) || reader.read_header(&wkb_type)) {
+       return true;
+     }
+
+     std::vector<std::vector<Point>> rings;
+     Type type = Type::NONE;
+     switch (wkb_type) {
+       case NEXT_SPATIAL_WKB_POINT: {
+         Point point;
+         if (reader.read_point(&point)) return true;
+         rings.push_back({point});
+         type = Type::POINT;
+         break;
+       }
+       case NEXT_SPATIAL_WKB_MULTIPOINT: {
+         uint32_t count = 0;
+         if (reader.read_uint32(&count) || count == 0 ||
+             count > reader.remaining() / NEXT_SPATIAL_WKB_POINT_SIZE) {
+           return true;
+         }
+         rings.emplace_back();
+         rings.back().reserve(count);
+         for (uint32_t i = 0; i < count; ++i) {
+           uint32_t point_type = 0;
+           Point point;
+           if (reader.read_header(&point_type) ||
+               point_type != NEXT_SPATIAL_WKB_POINT ||
+               reader.read_point(&point)) {
+             return true;
+           }
+           rings.back().push_back(point);
+         }
+         type = Type::MULTIPOINT;
+         break;
+       }
+       case NEXT_SPATIAL_WKB_POLYGON: {
+         uint32_t ring_count = 0;
+         if (reader.read_uint32(&ring_count) || ring_count == 0 ||
+             ring_count > reader.remaining() / sizeof(uint32_t)) {
+           return true;
+         }
+         rings.reserve(ring_count);
+         for (uint32_t i = 0; i < ring_count; ++i) {
+           uint32_t count = 0;
+           // a closed ring repeats its first point
+           if (reader.read_uint32(&count) || count < 4 ||
+               count > reader.remaining() / (2 * sizeof(double))) {
+             return true;
+           }
+           rings.emplace_back();
+           rings.back().reserve(count);
+           for (uint32_t j = 0; j < count; ++j) {
+             Point point;
+             if (reader.read_point(&point)) return true;
+             rings.back().push_back(point);
+           }
+         }
+         type = Type::POLYGON;
+         break;
+       }
+       default:
+         return true;
+     }
+     if (reader.remaining() != 0) return true;
+
+     m_type = type;
+     m_srid = srid;
+     m_rings = std::move(rings);
+     return false;
+   }
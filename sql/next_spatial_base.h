@@ -4,7 +4,13 @@
 
    #pragma once
 
+   #include <cstddef>
+   #include <cstdint>
+   #include <utility>
+   #include <vector>
+
    #include "lex_string.h"
+   #include "my_table_map.h"
    #include "sql-common/json_dom.h"
    #include "sql_const.h"
    
@@ -15,8 +21,21 @@
    #endif
    
    class Field;
+   class Item;
+   class Item_field;
+   class Item_func;
+
+   // mean earth radius in metres
+   constexpr double NEXT_SPATIAL_EARTH_RADIUS = 6'371'008.8;
+   // relative error of a spherical distance against the geodesic one
+   constexpr double NEXT_SPATIAL_DISTANCE_SLACK = 0.01;
    
-   enum class NEXT_SPATIAL_INDEX_TYPE { NONE, NO_GLOBAL_INDEX, GLOBAL_INDEX};
+   /**
+     GLOBAL_INDEX keeps the rows in an r-tree, HILBERT_INDEX keys each point by
+     its cell on a hilbert curve so a window is read as a few key ranges
+   */
+   enum class NEXT_SPATIAL_INDEX_TYPE { NONE, NO_GLOBAL_INDEX, GLOBAL_INDEX,
+                                        HILBERT_INDEX };
 
    std::string ToString(NEXT_SPATIAL_INDEX_TYPE v);
    
@@ -40,5 +59,80 @@
    
    std::string_view next_spatial_index_type_to_string(NEXT_SPATIAL_INDEX_TYPE val);
 
-    
-   
\ No newline at end of file
+   /**
+     bounding box of the points within radius metres of a lon/lat point on
+     the sphere: latitude range then longitude range. a box reaching a pole
+     or the antimeridian spans every longitude.
+   */
+   std::vector<double> next_spatial_radius_mbr(double lon, double lat,
+                                               double radius);
+
+   /**
+     match an upper bound on a spatial distance, st_distance(col, g) < r or
+     r > st_distance(col, g), with <= and >= too and either argument of
+     st_distance the column.
+     @return false if cond is not such a bound
+   */
+   bool get_next_spatial_distance_bound(Item_func *cond, Item_field **field,
+                                        Item **geometry, Item **radius);
+
+   /**
+     match a spatial predicate joining two sides: a relation other than
+     st_disjoint, e.g. st_intersects(a, b), or an upper bound on
+     st_distance(a, b). both hold only where the boxes of a and b, one
+     widened by the bound, meet.
+     @param[out] outer_geometry the argument reading only outer_tables
+     @param[out] inner_geometry the argument reading only inner_tables
+     @param[out] radius the bound on the distance, nullptr for a relation
+     @return false if cond is not such a predicate
+   */
+   bool get_next_spatial_join_predicate(Item *cond, table_map outer_tables,
+                                        table_map inner_tables,
+                                        Item **outer_geometry,
+                                        Item **inner_geometry, Item **radius);
+
+   /**
+     query geometry of a spatial distance, parsed once from the internal
+     geometry format (srid followed by little endian wkb) so the storage
+     engine gets typed coordinates instead of raw bytes. points are lon/lat.
+   */
+   class Next_spatial_query_geometry {
+    public:
+     enum class Type { NONE, POINT, MULTIPOINT, POLYGON };
+     using Point = std::pair<double, double>;
+
+     /**
+       return true on error, the geometry is left empty then
+     */
+     bool parse(const char *geometry, std::size_t length);
+
+     void clear() {
+       m_type = Type::NONE;
+       m_srid = 0;
+       m_rings.clear();
+     }
+
+     Type type() const { return m_type; }
+     bool empty() const { return m_type == Type::NONE; }
+     uint32_t srid() const { return m_srid; }
+
+     /** the points of a point or multipoint */
+     const std::vector<Point> &points() const { return m_rings.front(); }
+
+     /** rings of a polygon, the outer ring first, each closed */
+     const std::vector<std::vector<Point>> &rings() const { return m_rings; }
+
+     /**
+       bounding box of the points within radius of the geometry, laid out
+       like next_spatial_radius_mbr. a geographic geometry is measured in
+       metres on the sphere and the box of a polygon also holds the bulge of
+       its geodesic edges, a cartesian one in its own units.
+     */
+     std::vector<double> mbr(double radius) const;
+
+    private:
+     Type m_type = Type::NONE;
+     uint32_t m_srid = 0;
+     // a single ring holds the points of a point or multipoint
+     std::vector<std::vector<Point>> m_rings;
+   };
@@ -87,6 +87,7 @@ struct st_opt_hint_info opt_hint_info[] = {
     {"ORDER_INDEX", false, false, false},
     {"DERIVED_CONDITION_PUSHDOWN", true, true, false},
     {"RANGE_JOIN", true, true, false},
+    {"RESULT_CACHE", false, true, false},
     {nullptr, false, false, false}};
 
 /**
@@ -86,6 +86,7 @@ enum opt_hints_enum {
   ORDER_INDEX_HINT_ENUM,
   DERIVED_CONDITION_PUSHDOWN_HINT_ENUM,
   RANGE_JOIN_HINT_ENUM,
+  RESULT_CACHE_HINT_ENUM,
   MAX_HINT_ENUM
 };
 
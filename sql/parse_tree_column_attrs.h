@@ -1011,8 +1011,10 @@ class PT_generated_field_def : public PT_field_def_base {
     gcol_info = new (pc.mem_root) Value_generator;
     if (gcol_info == nullptr) return true;  // OOM
     gcol_info->expr_item = expr;
-    if (virtual_or_stored == Virtual_or_stored::STORED)
+    if (virtual_or_stored != Virtual_or_stored::VIRTUAL)
       gcol_info->set_field_stored(true);
+    if (virtual_or_stored == Virtual_or_stored::STORED_ASYNC)
+      gcol_info->set_async(true);
     gcol_info->set_field_type(type);
 
     return false;
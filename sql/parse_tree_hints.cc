@@ -520,6 +520,24 @@ bool PT_hint_max_execution_time::contextualize(Parse_context *pc) {
   return false;
 }
 
+bool PT_hint_result_cache::contextualize(Parse_context *pc) {
+  if (super::contextualize(pc)) return true;
+
+  // only the outermost SELECT is cached
+  if (pc->select != pc->thd->lex->query_block) return false;
+
+  Opt_hints_global *global_hint = get_global_hints(pc);
+  if (global_hint->is_specified(type())) {
+    // Hint duplication: /*+ RESULT_CACHE() ... NO_RESULT_CACHE() */
+    print_warn(pc->thd, ER_WARN_CONFLICTING_HINT, nullptr, nullptr, nullptr,
+               this);
+    return false;
+  }
+
+  global_hint->set_switch(switch_on(), type(), false);
+  return false;
+}
+
 bool PT_hint_sys_var::contextualize(Parse_context *pc) {
   if (!sys_var_value) {
     // No warning here, warning is issued by parser.
@@ -286,6 +286,22 @@ class PT_hint_max_execution_time : public PT_hint {
   }
 };
 
+/**
+  Parse tree hint object for RESULT_CACHE and NO_RESULT_CACHE hints, which
+  have a SELECT cached even though it calls functions whose result varies,
+  or never cached, see query_result_cache.h.
+*/
+
+class PT_hint_result_cache : public PT_hint {
+  typedef PT_hint super;
+
+ public:
+  explicit PT_hint_result_cache(bool switch_state_arg)
+      : PT_hint(RESULT_CACHE_HINT_ENUM, switch_state_arg) {}
+
+  bool contextualize(Parse_context *pc) override;
+};
+
 class PT_hint_sys_var : public PT_hint {
   const LEX_CSTRING sys_var_name;
   Item *sys_var_value;
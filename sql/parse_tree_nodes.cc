@@ -705,24 +705,18 @@ bool PT_select_sp_var::contextualize(Parse_context *pc) {
 }
 
 Sql_cmd *PT_sync_stmt::make_cmd(THD *thd) {
-    // TODO: 实现具体逻辑
-    // std::ofstream file;
-    // file.open("../mysql_sync_test.txt", std::ios::out | std::ios::app);
-    // if (file.is_open()) {
-    //     file << "SYNC time interval: " << m_interval << " seconds\n";
-    //     file.close();
-    // }
-
-    Sql_cmd_dml* orig_cmd = nullptr;
-    if (m_stmt) {
-      orig_cmd = (Sql_cmd_dml*) m_stmt->make_cmd(thd); // 转换原始语句为 Sql_cmd
-    }
-
-    Sql_cmd_sync* cmdSync = new (thd->mem_root) Sql_cmd_sync(orig_cmd, m_interval);
-
-    return cmdSync;
+  // the statement is checked here, and run again by the scheduler
+  Sql_cmd *const cmd = m_stmt->make_cmd(thd);
+  if (cmd == nullptr) return nullptr;
+  thd->lex->sql_command = SQLCOM_SYNC;
+  return new (thd->mem_root)
+      Sql_cmd_sync(cmd, m_interval, m_text, m_async, m_window);
 }
 
+Sql_cmd *PT_stop_sync::make_cmd(THD *thd) {
+  thd->lex->sql_command = SQLCOM_STOP_SYNC;
+  return &m_cmd;
+}
 
 Sql_cmd *PT_select_stmt::make_cmd(THD *thd) {
   Parse_context pc(thd, thd->lex->current_query_block());
@@ -3698,6 +3692,13 @@ Sql_cmd *PT_dump_table::make_cmd(THD *thd) {
   m_cmd.set_chunk_size(m_opts.chunk_size);
   m_cmd.set_chunk_unit(m_opts.chunk_unit);
   m_cmd.set_consistent(m_opts.consistent);
+  if (m_opts.compression != Dump_compression::UNSET &&
+      m_opts.format != Dump_format::PARQUET) {
+    my_error(ER_WRONG_ARGUMENTS, MYF(0), "COMPRESSION");
+    return nullptr;
+  }
+  m_cmd.set_format(m_opts.format,
+                   m_opts.compression != Dump_compression::NONE);
 
   Query_block *const query_block = lex->current_query_block();
   Parse_context pc(thd, query_block);
@@ -3710,6 +3711,29 @@ Sql_cmd *PT_dump_table::make_cmd(THD *thd) {
   return &m_cmd;
 }
 
+Sql_cmd *PT_create_materialized_view::make_cmd(THD *thd) {
+  LEX *const lex = thd->lex;
+  lex->sql_command = SQLCOM_CREATE_MATERIALIZED_VIEW;
+  lex->parsing_options.allows_variable = false;
+  lex->parsing_options.allows_select_into = false;
+
+  Parse_context pc(thd, lex->current_query_block());
+  if (m_query_expression->contextualize(&pc) ||
+      pc.finalize_query_expression())
+    return nullptr;
+  return &m_cmd;
+}
+
+Sql_cmd *PT_refresh_materialized_view::make_cmd(THD *thd) {
+  thd->lex->sql_command = SQLCOM_REFRESH_MATERIALIZED_VIEW;
+  return &m_cmd;
+}
+
+Sql_cmd *PT_drop_materialized_view::make_cmd(THD *thd) {
+  thd->lex->sql_command = SQLCOM_DROP_MATERIALIZED_VIEW;
+  return &m_cmd;
+}
+
 Sql_cmd *PT_checksum_tables::make_cmd(THD *thd) {
   LEX *const lex = thd->lex;
   lex->sql_command = SQLCOM_CHECKSUM;
@@ -4962,6 +4986,23 @@ PT_base_index_option *make_fb_vector_trained_index_table_attribute(
       });
 }
 
+/**
+   create a fb_vector index metric attribute
+
+   @param mem_root Memory arena.
+   @param attr     Attribute value from parser.
+
+   @return PT_base_index_option* to PT_attribute object.
+ */
+PT_base_index_option *make_fb_vector_index_metric_attribute(MEM_ROOT *mem_root,
+                                                            LEX_CSTRING attr) {
+  return new (mem_root) PT_attribute<LEX_CSTRING, PT_base_index_option>(
+      attr, +[](LEX_CSTRING a, Table_ddl_parse_context *pc) {
+        pc->key_create_info->m_fb_vector_index_metric = a;
+        return false;
+      });
+}
+
 PT_column_attr_base *make_column_fb_vector_dimension_attribute(
     MEM_ROOT *mem_root, ulong attr) {
   return new (mem_root) PT_attribute<ulong, PT_column_attr_base>(
@@ -4980,6 +5021,20 @@ PT_column_attr_base *make_column_fb_vector_dimension_attribute(
       });
 }
 
+PT_column_attr_base *make_column_fb_vector_multi_attribute(MEM_ROOT *mem_root,
+                                                           ulong attr) {
+  return new (mem_root) PT_attribute<ulong, PT_column_attr_base>(
+      attr, +[](ulong a, Column_parse_context *pc) {
+        // see make_column_fb_vector_dimension_attribute
+        pc->cf_appliers.emplace_back([=](Create_field *cf, Alter_info *) {
+          cf->m_fb_vector_dimension = a;
+          cf->m_fb_vector_multi = true;
+          return false;
+        });
+        return false;
+      });
+}
+
 /**
    create a next spatial index type attribute
 
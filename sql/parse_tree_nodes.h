@@ -65,8 +65,10 @@
 #include "sql/sql_lex.h"  // LEX
 #include "sql/sql_list.h"
 #include "sql/sql_load.h"  // Sql_cmd_load_table
+#include "sql/sql_materialized_view.h"  // Sql_cmd_create_materialized_view
 #include "sql/sql_partition_admin.h"
 #include "sql/sql_restart_server.h"  // Sql_cmd_restart_server
+#include "sql/sql_sync.h"            // Sql_cmd_stop_sync
 #include "sql/sql_tablespace.h"      // Tablespace_options
 #include "sql/sql_truncate.h"        // Sql_cmd_truncate_table
 #include "sql/table.h"               // Common_table_expr
@@ -1703,23 +1705,42 @@ class PT_intersect : public PT_set_operation {
   bool contextualize(Parse_context *pc) override;
 };
 
-class PT_sync_stmt : public Parse_tree_root {
-public:
-    /**
-     * @param stmt 要定时执行的SQL语句的节点
-     * @param interval 执行间隔，以秒为单位
-     */
-    PT_sync_stmt(Parse_tree_root *stmt, long interval)
-        : m_stmt(stmt), m_interval(interval) {}
+/// <statement> SYNC <period>, see continuous_query.h.
+class PT_sync_stmt final : public Parse_tree_root {
+ public:
+  /**
+    @param stmt a SELECT or a REFRESH MATERIALIZED VIEW
+    @param interval seconds between runs
+    @param text the text of stmt
+    @param async run stmt as the tables it reads change, for SYNC ASYNC
+    @param window the WINDOW clause of SYNC ASYNC
+  */
+  PT_sync_stmt(Parse_tree_root *stmt, ulong interval, LEX_CSTRING text,
+               bool async, const Sync_window &window = Sync_window())
+      : m_stmt(stmt),
+        m_interval(interval),
+        m_text(text),
+        m_async(async),
+        m_window(window) {}
 
-    /**
-     * 注意: 实现这个函数处理定时执行
-     */
-    Sql_cmd *make_cmd(THD *thd) override;
+  Sql_cmd *make_cmd(THD *thd) override;
 
-private:
-    Parse_tree_root *m_stmt;  // 指向SQL语句节点的指针
-    long m_interval;          // 定时执行的间隔，以秒为单位
+ private:
+  Parse_tree_root *m_stmt;
+  ulong m_interval;
+  LEX_CSTRING m_text;
+  bool m_async;
+  Sync_window m_window;
+};
+
+class PT_stop_sync final : public Parse_tree_root {
+ public:
+  explicit PT_stop_sync(ulonglong id) : m_cmd(id) {}
+
+  Sql_cmd *make_cmd(THD *thd) override;
+
+ private:
+  Sql_cmd_stop_sync m_cmd;
 };
 
 class PT_select_stmt : public Parse_tree_root {
@@ -5276,7 +5297,8 @@ class PT_load_table final : public Parse_tree_root {
  public:
   PT_load_table(enum_filetype filetype, thr_lock_type lock_type,
                 bool is_local_file, enum_source_type, const LEX_STRING filename,
-                ulong, bool, On_duplicate on_duplicate, Table_ident *table,
+                ulong source_count, bool in_key_order,
+                On_duplicate on_duplicate, Table_ident *table,
                 bool opt_compressed, List<String> *opt_partitions,
                 const CHARSET_INFO *opt_charset,
                 String *opt_xml_rows_identified_by,
@@ -5284,7 +5306,7 @@ class PT_load_table final : public Parse_tree_root {
                 const Line_separators &opt_line_separators,
                 ulong opt_ignore_lines, PT_item_list *opt_fields_or_vars,
                 PT_item_list *opt_set_fields, PT_item_list *opt_set_exprs,
-                List<String> *opt_set_expr_strings, bool)
+                List<String> *opt_set_expr_strings, bool bulk)
       : m_cmd(filetype, is_local_file, filename, on_duplicate, table,
               opt_compressed, opt_partitions, opt_charset,
               opt_xml_rows_identified_by, opt_field_separators,
@@ -5297,6 +5319,7 @@ class PT_load_table final : public Parse_tree_root {
     assert((opt_set_fields == nullptr) ^ (opt_set_exprs != nullptr));
     assert(opt_set_fields == nullptr ||
            opt_set_fields->value.size() == opt_set_exprs->value.size());
+    if (bulk) m_cmd.set_bulk(source_count, in_key_order);
   }
 
   Sql_cmd *make_cmd(THD *thd) override;
@@ -5323,6 +5346,39 @@ class PT_dump_table final : public Parse_tree_root {
   PT_item_list *m_item_list;
 };
 
+class PT_create_materialized_view final : public Parse_tree_root {
+ public:
+  PT_create_materialized_view(Table_ident *table,
+                              PT_query_expression_body *query_expression)
+      : m_cmd(table), m_query_expression(query_expression) {}
+
+  Sql_cmd *make_cmd(THD *thd) override;
+
+ private:
+  Sql_cmd_create_materialized_view m_cmd;
+  PT_query_expression_body *m_query_expression;
+};
+
+class PT_refresh_materialized_view final : public Parse_tree_root {
+ public:
+  explicit PT_refresh_materialized_view(Table_ident *table) : m_cmd(table) {}
+
+  Sql_cmd *make_cmd(THD *thd) override;
+
+ private:
+  Sql_cmd_refresh_materialized_view m_cmd;
+};
+
+class PT_drop_materialized_view final : public Parse_tree_root {
+ public:
+  explicit PT_drop_materialized_view(Table_ident *table) : m_cmd(table) {}
+
+  Sql_cmd *make_cmd(THD *thd) override;
+
+ private:
+  Sql_cmd_drop_materialized_view m_cmd;
+};
+
 class PT_checksum_tables final : public Parse_tree_root {
  public:
   PT_checksum_tables(PT_item_list *item_list) : m_item_list(item_list) {}
@@ -5369,9 +5425,12 @@ PT_base_index_option *make_fb_vector_trained_index_id_attribute(MEM_ROOT *,
                                                                 LEX_CSTRING);
 PT_base_index_option *make_fb_vector_trained_index_table_attribute(MEM_ROOT *,
                                                                    LEX_CSTRING);
+PT_base_index_option *make_fb_vector_index_metric_attribute(MEM_ROOT *,
+                                                            LEX_CSTRING);
 
 PT_column_attr_base *make_column_fb_vector_dimension_attribute(MEM_ROOT *,
                                                                ulong);
+PT_column_attr_base *make_column_fb_vector_multi_attribute(MEM_ROOT *, ulong);
 
 PT_base_index_option *make_next_spatial_index_type_attribute(MEM_ROOT *,
                                                           LEX_CSTRING);
@@ -241,7 +241,7 @@ enum class Ternary_option { DEFAULT, ON, OFF };
 
 enum class On_duplicate { ERROR, IGNORE_DUP, REPLACE_DUP };
 
-enum class Virtual_or_stored { VIRTUAL, STORED };
+enum class Virtual_or_stored { VIRTUAL, STORED, STORED_ASYNC };
 
 enum class Int_type : ulong {
   INT = MYSQL_TYPE_LONG,
@@ -343,6 +343,22 @@ enum class Chunk_unit {
   LAST,
 };
 
+/**
+  Output format of DUMP TABLE.
+*/
+enum class Dump_format {
+  UNSET,
+  /// Delimited text, as SELECT ... INTO OUTFILE.
+  CSV,
+  /// A Parquet file per chunk, see Dump_parquet_writer.
+  PARQUET,
+};
+
+/**
+  Compression of the Parquet output of DUMP TABLE.
+*/
+enum class Dump_compression { UNSET, NONE, ZSTD };
+
 /**
   Options struct for PT_dump_table root node.
 */
@@ -371,6 +387,16 @@ struct Dump_table_opts {
   */
   bool consistent;
 
+  /**
+    Output format.
+  */
+  Dump_format format;
+
+  /**
+    Compression of Parquet output, zstd if not given.
+  */
+  Dump_compression compression;
+
   void merge(const Dump_table_opts &other) {
     if (other.nthreads) {
       nthreads = other.nthreads;
@@ -384,6 +410,12 @@ struct Dump_table_opts {
     if (other.chunk_unit != Chunk_unit::UNSET) {
       chunk_unit = other.chunk_unit;
     }
+    if (other.format != Dump_format::UNSET) {
+      format = other.format;
+    }
+    if (other.compression != Dump_compression::UNSET) {
+      compression = other.compression;
+    }
   }
 
   /**
@@ -394,6 +426,8 @@ struct Dump_table_opts {
     chunk_size = 0;
     consistent = false;
     chunk_unit = Chunk_unit::UNSET;
+    format = Dump_format::UNSET;
+    compression = Dump_compression::UNSET;
   }
 
   /**
@@ -410,6 +444,9 @@ struct Dump_table_opts {
     if (chunk_unit == Chunk_unit::UNSET) {
       chunk_unit = DEFAULT_CHUNK_UNIT;
     }
+    if (format == Dump_format::UNSET) {
+      format = Dump_format::CSV;
+    }
   }
 };
 
@@ -455,6 +455,7 @@
 #include "sql/item_func.h"  // Item_func_set_user_var
 #include "sql/my_decimal.h"
 #include "sql/mysqld.h"  // global_system_variables
+#include "sql/query_result_cache.h"
 #include "sql/session_tracker.h"
 #include "sql/sql_class.h"  // THD
 #include "sql/sql_error.h"
@@ -964,7 +965,8 @@ static bool net_send_ok(THD *thd, uint server_status, uint statement_warn_count,
     return true;
   }
   error = my_net_write(net, start, (size_t)(pos - start));
-  if (!error) error = net_flush(net);
+  // a deferred commit acknowledgement is flushed once the commit is durable
+  if (!error && !thd->m_commit_ack.deferred) error = net_flush(net);
 
   thd->get_stmt_da()->set_overwrite_status(false);
   DBUG_PRINT("info", ("OK sent, so no more error sending allowed"));
@@ -3145,6 +3147,8 @@ bool Protocol_classic::start_result_metadata(uint num_cols_arg, uint flags,
     }
 
     my_net_write(&m_thd->net, (uchar *)&tmp, (size_t)(pos - (uchar *)&tmp));
+    if (m_thd->m_result_cache != nullptr)
+      query_result_cache_capture(m_thd, tmp, pos - tmp);
   }
   DBUG_EXECUTE_IF("send_large_column_count_in_metadata",
                   num_cols = num_cols_arg;);
@@ -3445,6 +3449,8 @@ bool Protocol_classic::end_row() {
   if (should_record_checksum)
     checksum = crc32(checksum, (uchar *)packet->ptr(), packet->length());
 
+  if (m_thd->m_result_cache != nullptr)
+    query_result_cache_capture(m_thd, packet->ptr(), packet->length());
   return my_net_write(&m_thd->net, pointer_cast<uchar *>(packet->ptr()),
                       packet->length());
 }
@@ -0,0 +1,346 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/query_result_cache.h"
+
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+#include "my_byteorder.h"
+#include "mysql_com.h"
+#include "sql/auth/auth_acls.h"
+#include "sql/auth/auth_common.h"  // check_table_access
+#include "sql/handler.h"
+#include "sql/opt_hints.h"
+#include "sql/protocol_classic.h"
+#include "sql/sql_cmd.h"
+#include "sql/sql_class.h"
+#include "sql/sql_lex.h"
+#include "sql/sql_locale.h"
+#include "sql/system_variables.h"
+#include "sql/table.h"
+#include "sql/tztime.h"
+#include "thr_lock.h"
+
+ulonglong query_result_cache_size;
+ulonglong query_result_cache_limit;
+
+namespace {
+
+constexpr size_t QUERY_RESULT_CACHE_SHARDS = 16;
+
+/// Slots of the clock the tables are hashed to.
+constexpr size_t QUERY_RESULT_CACHE_SLOTS = 4096;
+
+/** rough bookkeeping cost of an entry besides its strings */
+constexpr size_t QUERY_RESULT_CACHE_ENTRY_OVERHEAD = 256;
+
+struct Query_result_cache_entry {
+  std::string key;
+  ulonglong start;
+  /// Shared with the hits sending it, outside of the lock.
+  std::shared_ptr<const std::string> result;
+  ulonglong rows;
+  std::vector<std::pair<std::string, std::string>> tables;
+  std::vector<uint> slots;
+
+  size_t bytes() const {
+    size_t bytes =
+        key.size() + result->size() + QUERY_RESULT_CACHE_ENTRY_OVERHEAD;
+    for (const auto &table : tables)
+      bytes += table.first.size() + table.second.size();
+    return bytes;
+  }
+};
+
+struct Query_result_cache_shard {
+  std::mutex mutex;
+  /// most recently used first
+  std::list<Query_result_cache_entry> lru;
+  /// keys point into the entries of lru
+  std::unordered_map<std::string_view,
+                     std::list<Query_result_cache_entry>::iterator>
+      index;
+  size_t bytes = 0;
+
+  void erase(std::list<Query_result_cache_entry>::iterator it) {
+    bytes -= it->bytes();
+    index.erase(it->key);
+    lru.erase(it);
+  }
+};
+
+Query_result_cache_shard shards[QUERY_RESULT_CACHE_SHARDS];
+
+/// The clock, and the tick each slot last moved to.
+std::atomic<ulonglong> clock_ticks{0};
+std::atomic<ulonglong> slot_ticks[QUERY_RESULT_CACHE_SLOTS];
+
+std::atomic<ulonglong> cache_hits{0};
+std::atomic<ulonglong> cache_misses{0};
+std::atomic<ulonglong> cache_inserts{0};
+std::atomic<ulonglong> cache_invalidated{0};
+
+Query_result_cache_shard &shard_of(const std::string &key) {
+  return shards[std::hash<std::string>()(key) % QUERY_RESULT_CACHE_SHARDS];
+}
+
+bool changed_since(const std::vector<uint> &slots, ulonglong start) {
+  for (uint slot : slots)
+    if (slot_ticks[slot].load(std::memory_order_acquire) > start) return true;
+  return false;
+}
+
+void append_number(std::string *key, ulonglong number) {
+  char buf[8];
+  int8store(buf, number);
+  key->append(buf, sizeof(buf));
+}
+
+/// The statement text and the settings its result depends on.
+void make_key(THD *thd, std::string *key) {
+  const System_variables &vars = thd->variables;
+  key->assign(thd->query().str, thd->query().length);
+  key->push_back('\0');
+  key->append(thd->db().str != nullptr ? thd->db().str : "");
+  key->push_back('\0');
+  const String *tz = vars.time_zone->get_name();
+  key->append(tz->ptr(), tz->length());
+  key->push_back('\0');
+  append_number(key, thd->get_protocol()->get_client_capabilities());
+  append_number(key, vars.sql_mode);
+  append_number(key, vars.character_set_client->number);
+  append_number(key, vars.character_set_results != nullptr
+                         ? vars.character_set_results->number
+                         : 0);
+  append_number(key, vars.collation_connection->number);
+  append_number(key, vars.lc_time_names->number);
+  append_number(key, vars.select_limit);
+  append_number(key, vars.div_precincrement);
+  append_number(key, vars.default_week_format);
+  append_number(key, vars.group_concat_max_len);
+  append_number(key, vars.max_sort_length);
+  append_number(key, vars.resultset_metadata);
+}
+
+/**
+  Whether the user of thd may read the tables of an entry. Column level
+  privileges are not checked, entries reading a table the user only has
+  those for are not served.
+*/
+bool check_access(
+    THD *thd, const std::vector<std::pair<std::string, std::string>> &tables) {
+  for (const auto &table : tables) {
+    Table_ref ref(table.first.c_str(), table.first.size(),
+                  table.second.c_str(), table.second.size(),
+                  table.second.c_str(), TL_READ);
+    if (check_table_access(thd, SELECT_ACL, &ref, false, 1, true) ||
+        (ref.grant.privilege & SELECT_ACL) == 0)
+      return false;
+  }
+  return true;
+}
+
+/**
+  Send an entry found as the result of the statement. A failed write
+  leaves the connection broken, as for any result set.
+*/
+void send_result(THD *thd, const std::string &result, ulonglong rows) {
+  Protocol_classic *protocol = thd->get_protocol_classic();
+  const uchar *pos = pointer_cast<const uchar *>(result.data());
+  const uchar *end = pos + result.size();
+  while (pos < end) {
+    const size_t length = uint4korr(pos);
+    if (protocol->write(pos + 4, length)) return;
+    pos += 4 + length;
+  }
+  thd->current_found_rows = rows;
+  thd->update_previous_found_rows();
+  thd->set_sent_row_count(rows);
+  my_eof(thd);
+}
+
+}  // namespace
+
+bool query_result_cache_begin(THD *thd, Query_result_cache_statement *stmt) {
+  if (query_result_cache_size == 0) return false;
+
+  LEX *lex = thd->lex;
+  if (lex->sql_command != SQLCOM_SELECT || lex->is_explain() ||
+      lex->result != nullptr || thd->get_command() != COM_QUERY ||
+      !thd->is_classic_protocol() ||
+      !thd->get_protocol()->has_client_capability(CLIENT_DEPRECATE_EOF) ||
+      thd->in_multi_stmt_transaction_mode() ||
+      thd->in_active_multi_stmt_transaction() || thd->in_sub_stmt ||
+      thd->temporary_tables != nullptr || !thd->query_attrs_list.empty() ||
+      (thd->server_status & SERVER_MORE_RESULTS_EXISTS) ||
+      thd->rewritten_query().length() != 0)
+    return false;
+
+  const Opt_hints_global *hints = lex->opt_hints_global;
+  if (hints != nullptr && hints->is_specified(RESULT_CACHE_HINT_ENUM)) {
+    if (!hints->get_switch(RESULT_CACHE_HINT_ENUM)) return false;
+  } else if (!lex->safe_to_cache_query) {
+    return false;
+  }
+
+  make_key(thd, &stmt->key);
+  Query_result_cache_shard &shard = shard_of(stmt->key);
+  std::shared_ptr<const std::string> result;
+  ulonglong rows = 0;
+  std::vector<std::pair<std::string, std::string>> tables;
+  {
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    auto found = shard.index.find(stmt->key);
+    if (found != shard.index.end()) {
+      auto it = found->second;
+      if (changed_since(it->slots, it->start)) {
+        shard.erase(it);
+        cache_invalidated++;
+      } else {
+        shard.lru.splice(shard.lru.begin(), shard.lru, it);
+        result = it->result;
+        rows = it->rows;
+        tables = it->tables;
+      }
+    }
+  }
+
+  if (result != nullptr && check_access(thd, tables)) {
+    cache_hits++;
+    send_result(thd, *result, rows);
+    return true;
+  }
+
+  cache_misses++;
+  // before the statement takes its snapshot
+  stmt->start = clock_ticks.load(std::memory_order_acquire);
+  thd->m_result_cache = stmt;
+  return false;
+}
+
+void query_result_cache_end(THD *thd, Query_result_cache_statement *stmt) {
+  if (thd->m_result_cache != stmt) return;
+  thd->m_result_cache = nullptr;
+
+  const Diagnostics_area *da = thd->get_stmt_da();
+  if (stmt->disallowed || stmt->tables.empty() || thd->is_error() ||
+      thd->killed || da->status() != Diagnostics_area::DA_EOF ||
+      da->current_statement_cond_count() != 0)
+    return;
+  // the secondary engine may not have caught up with the commits yet
+  if (thd->lex->m_sql_cmd != nullptr &&
+      thd->lex->m_sql_cmd->using_secondary_storage_engine())
+    return;
+
+  const size_t shard_budget =
+      query_result_cache_size / QUERY_RESULT_CACHE_SHARDS;
+  Query_result_cache_entry entry{
+      std::move(stmt->key),
+      stmt->start,
+      std::make_shared<const std::string>(std::move(stmt->result)),
+      thd->get_sent_row_count(),
+      std::move(stmt->tables),
+      {}};
+  for (const auto &table : entry.tables)
+    entry.slots.push_back(
+        query_result_cache_slot(table.first.c_str(), table.second.c_str()));
+  if (entry.bytes() > shard_budget || changed_since(entry.slots, entry.start))
+    return;
+
+  Query_result_cache_shard &shard = shard_of(entry.key);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  auto found = shard.index.find(entry.key);
+  if (found != shard.index.end()) shard.erase(found->second);
+
+  shard.bytes += entry.bytes();
+  shard.lru.push_front(std::move(entry));
+  shard.index.emplace(shard.lru.front().key, shard.lru.begin());
+  cache_inserts++;
+
+  // also catches up after query_result_cache_size was lowered
+  while (shard.bytes > shard_budget) shard.erase(std::prev(shard.lru.end()));
+}
+
+void query_result_cache_check_tables(THD *thd, Table_ref *tables) {
+  Query_result_cache_statement *stmt = thd->m_result_cache;
+  if (stmt == nullptr || stmt->disallowed) return;
+
+  for (Table_ref *tr = tables; tr != nullptr; tr = tr->next_global) {
+    // their rows come from the tables checked
+    if (tr->is_derived() || tr->is_table_function() ||
+        tr->is_recursive_reference())
+      continue;
+    const thr_lock_type lock_type = tr->lock_descriptor().type;
+    if (tr->is_view() || tr->schema_table != nullptr || tr->table == nullptr ||
+        tr->table->s->tmp_table != NO_TMP_TABLE ||
+        tr->table->s->is_secondary_engine() ||
+        (tr->table->s->db_type()->flags & HTON_SUPPORTS_RESULT_CACHE) == 0 ||
+        lock_type == TL_READ_WITH_SHARED_LOCKS ||
+        lock_type >= TL_READ_NO_INSERT) {
+      stmt->disallowed = true;
+      return;
+    }
+    const TABLE_SHARE *share = tr->table->s;
+    stmt->tables.emplace_back(
+        std::string(share->db.str, share->db.length),
+        std::string(share->table_name.str, share->table_name.length));
+  }
+}
+
+void query_result_cache_capture(THD *thd, const void *packet, size_t length) {
+  Query_result_cache_statement *stmt = thd->m_result_cache;
+  if (stmt->disallowed) return;
+  if (stmt->result.size() + 4 + length > query_result_cache_limit) {
+    stmt->disallowed = true;
+    std::string().swap(stmt->result);
+    return;
+  }
+  char buf[4];
+  int4store(buf, static_cast<uint32>(length));
+  stmt->result.append(buf, sizeof(buf));
+  stmt->result.append(static_cast<const char *>(packet), length);
+}
+
+void query_result_cache_disallow(THD *thd) {
+  if (thd->m_result_cache != nullptr) thd->m_result_cache->disallowed = true;
+}
+
+uint query_result_cache_slot(const char *db, const char *table_name) {
+  const size_t hash = std::hash<std::string_view>()(db) * 31 +
+                      std::hash<std::string_view>()(table_name);
+  return hash % QUERY_RESULT_CACHE_SLOTS;
+}
+
+void query_result_cache_invalidate_slot(uint slot) {
+  const ulonglong tick = ++clock_ticks;
+  ulonglong current = slot_ticks[slot].load(std::memory_order_relaxed);
+  while (current < tick &&
+         !slot_ticks[slot].compare_exchange_weak(current, tick,
+                                                 std::memory_order_release)) {
+  }
+}
+
+Query_result_cache_stats query_result_cache_stats() {
+  return {cache_hits.load(), cache_misses.load(), cache_inserts.load(),
+          cache_invalidated.load()};
+}
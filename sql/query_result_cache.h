@@ -0,0 +1,115 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+/**
+  @file
+  Server wide cache of the result sets of SELECT statements, so that a
+  dashboard sending the same heavy query again is answered from the
+  packets sent the first time.
+
+  Entries are keyed by the statement text, which holds its literals, and
+  the settings that change its result or how it is sent: the current
+  database, the character sets, sql_mode, time_zone and the like. Only
+  autocommit SELECTs run outside of a transaction over COM_QUERY are
+  cached, reading base tables of engines with HTON_SUPPORTS_RESULT_CACHE
+  only, and not when they call functions whose result varies, see
+  LEX::safe_to_cache_query, e.g. NOW(), RAND() or the semantic operators,
+  unless hinted with RESULT_CACHE. NO_RESULT_CACHE keeps a statement out.
+
+  Engines call query_result_cache_invalidate() once a transaction that
+  changed a table committed, and DDL does so for the tables it changes.
+  This moves the table to the current tick of a clock; an entry remembers
+  the tick when its statement started, before it took its snapshot, and is
+  served while none of its tables moved past it. Tables are mapped to the
+  clock by a hash of their names, so tables sharing a slot invalidate the
+  entries of each other, which costs hits only.
+
+  The cache is split into shards by key hash, each with its own lock and
+  LRU list, and the byte budget query_result_cache_size is divided evenly
+  between them. A hit checks the privileges of the user on the tables of
+  the entry first.
+*/
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "my_inttypes.h"
+
+class THD;
+class Table_ref;
+
+/// Bytes the cached result sets may take, 0 turns the cache off.
+extern ulonglong query_result_cache_size;
+
+/// Largest result set cached, in bytes.
+extern ulonglong query_result_cache_limit;
+
+/// A statement looked up in the cache, and captured if it is not found.
+struct Query_result_cache_statement {
+  std::string key;
+  /// The tick of the clock when the statement started.
+  ulonglong start{0};
+  /// The packets sent, each after its length.
+  std::string result;
+  ulonglong rows{0};
+  /// Database and name of the tables read.
+  std::vector<std::pair<std::string, std::string>> tables;
+  /// Not cached after all, e.g. it reads a view, or its result is large.
+  bool disallowed{false};
+};
+
+/**
+  Send the cached result of the statement of thd, if any, or have the
+  result captured for the cache.
+  @return true if the result was sent, the statement is not executed then
+*/
+bool query_result_cache_begin(THD *thd, Query_result_cache_statement *stmt);
+
+/// Cache the result captured, if the statement succeeded.
+void query_result_cache_end(THD *thd, Query_result_cache_statement *stmt);
+
+/// Remember the tables of the statement captured, once they are open, or
+/// have it not cached if one cannot be.
+void query_result_cache_check_tables(THD *thd, Table_ref *tables);
+
+/// Add a packet sent by the statement captured.
+void query_result_cache_capture(THD *thd, const void *packet, size_t length);
+
+/// Have the statement captured not cached, e.g. it read an older snapshot.
+void query_result_cache_disallow(THD *thd);
+
+/// The slot of the clock of a table.
+uint query_result_cache_slot(const char *db, const char *table_name);
+
+/// A table changed, the entries reading it are not served anymore.
+void query_result_cache_invalidate_slot(uint slot);
+
+inline void query_result_cache_invalidate(const char *db,
+                                          const char *table_name) {
+  query_result_cache_invalidate_slot(query_result_cache_slot(db, table_name));
+}
+
+struct Query_result_cache_stats {
+  ulonglong hits;
+  ulonglong misses;
+  ulonglong inserts;
+  ulonglong invalidated;
+};
+
+Query_result_cache_stats query_result_cache_stats();
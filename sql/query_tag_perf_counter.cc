@@ -1,14 +1,36 @@
 // Copyright 2004-present Facebook. All Rights Reserved.
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
 #include <deque>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <tuple>
 #include <unordered_map>
+#include <vector>
+
+#include "my_config.h"
+
+#if defined(__linux__) && defined(HAVE_BACKTRACE)
+#define HAVE_QUERY_SAMPLE_PROFILER
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #include "field.h"
 #include "query_tag_perf_counter.h"
+#include "sql/sql_digest.h"
+#include "sql/sql_digest_stream.h"
 #include "sql_class.h"
 #include "sql_show.h"
+#include "sql_string.h"
 #include "table.h"
 
 namespace qutils {
@@ -20,7 +42,7 @@ static std::mutex stats_mutex;
 static std::unordered_map<std::string, cpu_and_num_queries> stats;
 
 query_tag_perf_counter::query_tag_perf_counter(THD *_thd)
-    : started(false), thd(_thd) {
+    : started(false), thd(_thd), profiler(_thd) {
   if (!thd->query_type.empty() && thd->num_queries > 0) {
     this->started =
         clock_gettime(CLOCK_THREAD_CPUTIME_ID, &this->starttime) == 0;
@@ -85,4 +107,302 @@ static int64_t timespec_diff(const timespec &start, const timespec &stop) {
   const int64_t diff = sec * 1000000000LL + nsec;
   return diff;
 }
+
+uint query_sample_frequency = 0;
+uint query_sample_max_stacks = 10000;
+
+// (digest, stack) pairs and their sample counts, stacks are outermost first
+using profile_key = std::tuple<std::string, std::vector<void *>>;
+static std::mutex profile_mutex;
+static std::map<profile_key, uint64_t> profile;
+static std::unordered_map<std::string, std::string> profile_digest_texts;
+static uint64_t profile_dropped = 0;
+
+static const size_t digest_text_length = 1024;
+
+void reset_query_sample_profile() {
+  std::lock_guard<std::mutex> lock(profile_mutex);
+  profile.clear();
+  profile_digest_texts.clear();
+  profile_dropped = 0;
+}
+
+#ifdef HAVE_QUERY_SAMPLE_PROFILER
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+static const int sample_max_frames = 48;
+// samples a thread keeps until its statement ends, later ones are dropped
+static const uint sample_max_pending = 128;
+// the signal handler and the signal trampoline
+static const int sample_skip_frames = 2;
+
+// Samples of one thread. Only that thread writes them, either from the
+// signal handler while enabled or from end_statement() while not.
+struct sample_thread {
+  std::atomic<bool> enabled{false};
+  std::atomic<uint> pending{0};
+  std::atomic<uint> dropped{0};
+  int depth[sample_max_pending];
+  void *frames[sample_max_pending][sample_max_frames];
+  timer_t timer;
+  bool has_timer = false;
+
+  ~sample_thread() {
+    if (has_timer) timer_delete(timer);
+  }
+};
+
+// the handler only reads the plain pointer, which needs no tls constructor
+static thread_local std::unique_ptr<sample_thread> sample_thread_owner;
+static thread_local sample_thread *current_sample_thread = nullptr;
+
+static std::once_flag sample_handler_once;
+static bool sample_handler_installed = false;
+
+static void sample_handler(int) {
+  const int saved_errno = errno;
+  sample_thread *st = current_sample_thread;
+  if (st != nullptr && st->enabled.load(std::memory_order_relaxed)) {
+    const uint slot = st->pending.load(std::memory_order_relaxed);
+    if (slot < sample_max_pending) {
+      st->depth[slot] = backtrace(st->frames[slot], sample_max_frames);
+      st->pending.store(slot + 1, std::memory_order_relaxed);
+    } else {
+      st->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  errno = saved_errno;
+}
+
+static void install_sample_handler() {
+  // backtrace() loads the unwinder on first use, which is not signal safe
+  void *frame;
+  backtrace(&frame, 1);
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = sample_handler;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  sample_handler_installed = sigaction(SIGPROF, &action, nullptr) == 0;
+}
+
+// Timer of the calling thread raising SIGPROF on its cpu time.
+static sample_thread *get_sample_thread() {
+  if (sample_thread_owner) return sample_thread_owner.get();
+
+  std::unique_ptr<sample_thread> st(new (std::nothrow) sample_thread);
+  if (!st) return nullptr;
+  struct sigevent event;
+  memset(&event, 0, sizeof(event));
+  event.sigev_notify = SIGEV_THREAD_ID;
+  event.sigev_signo = SIGPROF;
+  event.sigev_notify_thread_id = syscall(SYS_gettid);
+  if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &st->timer) != 0) {
+    return nullptr;
+  }
+  st->has_timer = true;
+  sample_thread_owner = std::move(st);
+  current_sample_thread = sample_thread_owner.get();
+  return current_sample_thread;
+}
+
+query_sample_profiler::query_sample_profiler(THD *_thd)
+    : thd(_thd), started(false) {
+  const uint frequency = query_sample_frequency;
+  if (frequency == 0) return;
+
+  std::call_once(sample_handler_once, install_sample_handler);
+  if (!sample_handler_installed) return;
+  sample_thread *st = get_sample_thread();
+  if (st == nullptr) return;
+
+  const long interval_ns = 1000000000L / frequency;
+  struct itimerspec spec;
+  spec.it_interval.tv_sec = interval_ns / 1000000000L;
+  spec.it_interval.tv_nsec = interval_ns % 1000000000L;
+  spec.it_value = spec.it_interval;
+  st->enabled.store(true, std::memory_order_relaxed);
+  started = timer_settime(st->timer, 0, &spec, nullptr) == 0;
+  if (!started) st->enabled.store(false, std::memory_order_relaxed);
+}
+
+query_sample_profiler::~query_sample_profiler() {
+  if (!started) return;
+  end_statement();
+
+  sample_thread *st = current_sample_thread;
+  st->enabled.store(false, std::memory_order_relaxed);
+  struct itimerspec disarm;
+  memset(&disarm, 0, sizeof(disarm));
+  timer_settime(st->timer, 0, &disarm, nullptr);
+}
+
+void query_sample_profiler::end_statement() {
+  if (!started) return;
+  sample_thread *st = current_sample_thread;
+
+  // keep the handler off the buffer while it is read
+  st->enabled.store(false, std::memory_order_relaxed);
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+
+  const uint pending = st->pending.load(std::memory_order_relaxed);
+  const uint dropped = st->dropped.exchange(0, std::memory_order_relaxed);
+  if (pending > 0 || dropped > 0) {
+    std::string digest;
+    std::string digest_text;
+    if (thd->m_digest != nullptr && !thd->m_digest->is_empty()) {
+      const sql_digest_storage *storage = &thd->m_digest->m_digest_storage;
+      unsigned char hash[DIGEST_HASH_SIZE];
+      compute_digest_hash(storage, hash);
+      char hash_string[DIGEST_HASH_TO_STRING_LENGTH + 1];
+      DIGEST_HASH_TO_STRING(hash, hash_string);
+      digest = hash_string;
+
+      String text;
+      compute_digest_text(storage, &text);
+      digest_text.assign(text.ptr(),
+                         std::min<size_t>(text.length(), digest_text_length));
+    }
+
+    std::lock_guard<std::mutex> lock(profile_mutex);
+    if (!digest.empty()) profile_digest_texts.emplace(digest, digest_text);
+    profile_dropped += dropped;
+    for (uint i = 0; i < pending; i++) {
+      const int depth = st->depth[i];
+      std::vector<void *> frames;
+      for (int frame = depth - 1; frame >= sample_skip_frames; frame--) {
+        frames.push_back(st->frames[i][frame]);
+      }
+      profile_key key(digest, std::move(frames));
+      auto it = profile.find(key);
+      if (it != profile.end()) {
+        it->second++;
+      } else if (profile.size() < query_sample_max_stacks) {
+        profile.emplace(std::move(key), 1);
+      } else {
+        profile_dropped++;
+      }
+    }
+  }
+
+  st->pending.store(0, std::memory_order_relaxed);
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+  st->enabled.store(true, std::memory_order_relaxed);
+}
+
+// Name of the function at a return address, without its parameter list.
+static std::string frame_name(void *address) {
+  Dl_info info;
+  if (dladdr(address, &info) == 0 || info.dli_sname == nullptr) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%p", address);
+    return buf;
+  }
+  int status;
+  char *demangled =
+      abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+  std::string name =
+      status == 0 && demangled != nullptr ? demangled : info.dli_sname;
+  free(demangled);
+
+  // strip the parameter list, which is the last parenthesized group
+  if (!name.empty() && name.back() == ')') {
+    int depth = 0;
+    for (size_t i = name.size(); i-- > 0;) {
+      if (name[i] == ')') depth++;
+      if (name[i] == '(' && --depth == 0) {
+        name.resize(i);
+        break;
+      }
+    }
+  }
+  // ';' separates the frames of a folded stack
+  std::replace(name.begin(), name.end(), ';', ':');
+  return name;
+}
+
+#else
+
+query_sample_profiler::query_sample_profiler(THD *_thd)
+    : thd(_thd), started(false) {}
+
+query_sample_profiler::~query_sample_profiler() {}
+
+void query_sample_profiler::end_statement() {}
+
+static std::string frame_name(void *address) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%p", address);
+  return buf;
+}
+
+#endif  // HAVE_QUERY_SAMPLE_PROFILER
+
+int fill_query_sample_profile(THD *thd, Table_ref *tables, Item *) {
+  DBUG_ENTER("fill_query_sample_profile");
+
+  std::map<profile_key, uint64_t> rows;
+  std::unordered_map<std::string, std::string> digest_texts;
+  uint64_t dropped;
+  {
+    std::lock_guard<std::mutex> lock(profile_mutex);
+    rows = profile;
+    digest_texts = profile_digest_texts;
+    dropped = profile_dropped;
+  }
+
+  // stacks share most of their frames, resolve each address once
+  std::unordered_map<void *, std::string> names;
+  TABLE *table = tables->table;
+  auto store_row = [&](const std::string &digest, const std::string &stack,
+                       uint64_t samples) {
+    restore_record(table, s->default_values);
+    Field **field = table->field;
+    if (!digest.empty()) {
+      const std::string &digest_text = digest_texts[digest];
+      field[0]->set_notnull();
+      field[0]->store(digest.c_str(), digest.length(), system_charset_info);
+      field[1]->set_notnull();
+      field[1]->store(digest_text.c_str(), digest_text.length(),
+                      system_charset_info);
+    }
+    field[2]->store(stack.c_str(), stack.length(), system_charset_info);
+    field[3]->store(samples, true);
+    return schema_table_store_record(thd, table);
+  };
+
+  for (const auto &row : rows) {
+    std::string stack;
+    for (void *address : std::get<1>(row.first)) {
+      auto it = names.find(address);
+      if (it == names.end()) {
+        it = names.emplace(address, frame_name(address)).first;
+      }
+      if (!stack.empty()) stack += ';';
+      stack += it->second;
+    }
+    if (store_row(std::get<0>(row.first), stack, row.second)) {
+      DBUG_RETURN(-1);
+    }
+  }
+  if (dropped > 0 && store_row("", "[dropped]", dropped)) {
+    DBUG_RETURN(-1);
+  }
+  DBUG_RETURN(0);
+}
+
+const uint stack_field_length = 65535;
+
+ST_FIELD_INFO query_sample_profile_fields_info[] = {
+    {"DIGEST", DIGEST_HASH_TO_STRING_LENGTH, MYSQL_TYPE_STRING, 0,
+     MY_I_S_MAYBE_NULL, 0, 0},
+    {"DIGEST_TEXT", digest_text_length, MYSQL_TYPE_STRING, 0,
+     MY_I_S_MAYBE_NULL, 0, 0},
+    {"STACK", stack_field_length, MYSQL_TYPE_STRING, 0, 0, 0, 0},
+    {"SAMPLES", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+    {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, 0}};
 }  // namespace qutils
@@ -6,6 +6,8 @@
 #include <ctime>
 #include <string>
 
+#include "my_inttypes.h"
+
 class Item;
 class THD;
 class Table_ref;
@@ -17,15 +19,50 @@ extern ST_FIELD_INFO query_tag_perf_fields_info[];
 extern int fill_query_tag_perf_counter(THD *thd, Table_ref *tables,
                                        Item *cond);
 
+// Stack samples per second of cpu time of a statement, 0 turns sampling off.
+extern uint query_sample_frequency;
+// Most distinct (digest, stack) pairs kept, later ones are counted as dropped.
+extern uint query_sample_max_stacks;
+
+extern ST_FIELD_INFO query_sample_profile_fields_info[];
+extern int fill_query_sample_profile(THD *thd, Table_ref *tables, Item *cond);
+
+// Forget the samples aggregated so far.
+void reset_query_sample_profile();
+
+/*
+  Samples the stack of the thread while it runs statements, from a signal
+  raised every 1 / query_sample_frequency seconds of its cpu time, and adds
+  the samples to the profile of the statement digest. Samples are kept in a
+  per thread buffer by the signal handler and aggregated when a statement
+  ends.
+*/
+class query_sample_profiler {
+ public:
+  query_sample_profiler(THD *thd);
+  ~query_sample_profiler();
+
+  // Aggregate the samples taken so far under the digest of the statement.
+  void end_statement();
+
+ private:
+  THD *thd;      // reference to outer THD
+  bool started;  // the sampling timer is armed
+};
+
 class query_tag_perf_counter {
  public:
   query_tag_perf_counter(THD *thd);
   ~query_tag_perf_counter();
 
+  // Called between the statements of a multi statement query.
+  void end_statement() { profiler.end_statement(); }
+
  private:
   struct timespec starttime;  // query start timestamp
   bool started;               // query_info attribute detected
   THD *thd;                   // reference to outer THD
+  query_sample_profiler profiler;
 };
 
 }  // namespace qutils
@@ -50,6 +50,7 @@
 #include "sql/item_row.h"
 #include "sql/key.h"
 #include "sql/mem_root_array.h"
+#include "sql/next_spatial_base.h"
 #include "sql/opt_trace.h"
 #include "sql/opt_trace_context.h"
 #include "sql/query_options.h"
@@ -533,6 +534,99 @@ static SEL_TREE *get_func_mm_tree_from_json_overlaps_contains(
   return nullptr;
 }
 
+/**
+  Build a SEL_TREE for an upper bound on the distance to a geographic point,
+  ST_DISTANCE(geometry_field, point) < radius, over the next spatial indexes
+  on the field. Their ranges are boxes, so the range is the box holding every
+  point within the radius; the predicate itself is still checked on each row.
+
+  @param param      Information on 'just about everything'.
+  @param prev_tables See test_quick_select()
+  @param read_tables See test_quick_select()
+  @param cond_func  The comparison bounding the distance.
+
+  @returns
+    non-NULL constructed SEL_TREE
+    NULL     if the predicate is no such bound, or in case of any error
+*/
+
+static SEL_TREE *get_mm_tree_from_spatial_distance(THD *thd,
+                                                   RANGE_OPT_PARAM *param,
+                                                   table_map prev_tables,
+                                                   table_map read_tables,
+                                                   Item_func *cond_func) {
+  if (param->has_errors() || !param->using_real_indexes) return nullptr;
+
+  Item_field *field_item;
+  Item *point;
+  Item *radius;
+  if (!get_next_spatial_distance_bound(cond_func, &field_item, &point,
+                                       &radius))
+    return nullptr;
+  Field *field = field_item->field;
+  if (field->table != param->table || field_item->is_outer_reference())
+    return nullptr;
+  if (point->used_tables() & ~(prev_tables | read_tables) ||
+      radius->used_tables() & ~(prev_tables | read_tables) ||
+      !point->const_item() || !radius->const_item() ||
+      point->is_expensive() || radius->is_expensive())
+    return nullptr;
+
+  const double distance = radius->val_real();
+  if (radius->null_value || thd->is_error()) return nullptr;
+  String buffer;
+  const String *wkb = point->val_str(&buffer);
+  Next_spatial_query_geometry geometry;
+  // srid 0 is cartesian, the index ranges are in degrees
+  if (wkb == nullptr || geometry.parse(wkb->ptr(), wkb->length()) ||
+      geometry.type() != Next_spatial_query_geometry::Type::POINT ||
+      geometry.srid() == 0)
+    return nullptr;
+
+  // a negative distance matches nothing, the point alone is read then
+  const auto &lon_lat = geometry.points().front();
+  const std::vector<double> mbr = next_spatial_radius_mbr(
+      lon_lat.first, lon_lat.second,
+      std::max(distance, 0.0) * (1 + NEXT_SPATIAL_DISTANCE_SLACK));
+
+  SEL_TREE *tree = nullptr;
+  MEM_ROOT *const alloc = param->temp_mem_root;
+  for (KEY_PART *key_part = param->key_parts; key_part != param->key_parts_end;
+       key_part++) {
+    if (!field->eq(key_part->field) || key_part->image_type != Field::itMBR ||
+        !param->table->key_info[param->real_keynr[key_part->key]]
+             .is_next_spatial_index())
+      continue;
+    if (!tree && !(tree = new (alloc) SEL_TREE(alloc, param->keys)))
+      return nullptr;  // OOM
+
+    // key images of geometries are their mbr: longitude range, then
+    // latitude range
+    const size_t null_bytes = field->is_nullable() ? 1 : 0;
+    uchar *str =
+        static_cast<uchar *>(alloc->Alloc(key_part->store_length + 1));
+    if (!str) return nullptr;  // OOM
+    if (null_bytes) *str = 0;
+    float8store(str + null_bytes, mbr[2]);
+    float8store(str + null_bytes + 8, mbr[3]);
+    float8store(str + null_bytes + 16, mbr[0]);
+    float8store(str + null_bytes + 24, mbr[1]);
+
+    SEL_ARG *root = new (alloc)
+        SEL_ARG(field, str, str, !(key_part->flag & HA_REVERSE_SORT));
+    SEL_ROOT *sel_root;
+    if (!root || !(sel_root = new (alloc) SEL_ROOT(root)))
+      return nullptr;  // OOM
+    sel_root->root->set_gis_index_read_function(HA_READ_MBR_INTERSECT);
+    sel_root->root->part = (uchar)key_part->part;
+    tree->inexact = true;
+    tree->set_key(key_part->key,
+                  sel_add(tree->release_key(key_part->key), sel_root));
+    tree->keys_map.set_bit(key_part->key);
+  }
+  return tree;
+}
+
 /**
   Build a SEL_TREE for a simple predicate.
 
@@ -991,6 +1085,9 @@ SEL_TREE *get_mm_tree(THD *thd, RANGE_OPT_PARAM *param, table_map prev_tables,
       Item *const arg_left = cond_func->arguments()[0];
 
       assert(!ftree);
+      ftree = get_mm_tree_from_spatial_distance(thd, param, prev_tables,
+                                                read_tables, cond_func);
+      if (ftree) break;
       if (!arg_left->is_outer_reference() &&
           arg_left->real_item()->type() == Item::FIELD_ITEM) {
         Item_field *field_item = down_cast<Item_field *>(arg_left->real_item());
@@ -21,8 +21,15 @@
    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
 
 #include "sql/rpl_applier_reader.h"
+#include <deque>
+#include <utility>
+#include <vector>
 #include "include/mutex_lock.h"
+#include "my_thread.h"
 #include "mysql/components/services/log_builtins.h"
+#include "mysql/psi/mysql_cond.h"
+#include "mysql/psi/mysql_mutex.h"
+#include "mysql/psi/mysql_thread.h"
 #include "sql/log.h"
 #include "sql/mysqld.h"
 #include "sql/rpl_replica.h"
@@ -80,6 +87,157 @@ class Rpl_applier_reader::Stage_controller {
   enum State m_state = INACTIVE;
 };
 
+uint opt_replica_decode_threads;
+
+/**
+   The pool of threads decoding the events read ahead. Only the coordinator
+   adds and takes the events, which it takes in the order it added them,
+   each once it is decoded.
+*/
+class Rpl_applier_reader::Event_decoder {
+ public:
+  /// An event read ahead.
+  struct Event {
+    ~Event() {
+      // the event owns the data once decoded
+      if (event != nullptr)
+        delete event;
+      else
+        my_free(data);
+    }
+
+    unsigned char *data = nullptr;
+    unsigned int length = 0;
+    my_off_t start_pos = 0;
+    my_off_t end_pos = 0;
+    std::shared_ptr<const Format_description_event> fde;
+    /// Set when decoded, along with error.
+    Log_event *event = nullptr;
+    Binlog_read_error::Error_type error = Binlog_read_error::SUCCESS;
+    /// Guarded by m_lock once added.
+    bool decoded = false;
+  };
+
+  /// The events, and the bytes of them, read ahead at most.
+  static constexpr size_t MAX_EVENTS = 1024;
+  static constexpr my_off_t MAX_BYTES = 32 * 1024 * 1024;
+
+  explicit Event_decoder(bool verify_checksum)
+      : m_verify_checksum(verify_checksum) {
+    mysql_mutex_init(PSI_NOT_INSTRUMENTED, &m_lock, MY_MUTEX_INIT_FAST);
+    mysql_cond_init(PSI_NOT_INSTRUMENTED, &m_work_cond);
+    mysql_cond_init(PSI_NOT_INSTRUMENTED, &m_done_cond);
+  }
+
+  ~Event_decoder() {
+    mysql_mutex_lock(&m_lock);
+    m_stopping = true;
+    mysql_cond_broadcast(&m_work_cond);
+    mysql_mutex_unlock(&m_lock);
+    for (auto &thread : m_threads) my_thread_join(&thread, nullptr);
+    m_events.clear();
+    mysql_cond_destroy(&m_done_cond);
+    mysql_cond_destroy(&m_work_cond);
+    mysql_mutex_destroy(&m_lock);
+  }
+
+  /**
+     Start the threads.
+
+     @retval false Success
+     @retval true  None could be started
+  */
+  bool start(uint threads) {
+    for (uint i = 0; i < threads; i++) {
+      my_thread_handle thread;
+      if (mysql_thread_create(key_thread_replica_decoder, &thread,
+                              &connection_attrib, decode_thread, this))
+        break;
+      m_threads.push_back(thread);
+    }
+    return m_threads.empty();
+  }
+
+  /// Decode an event, and verify its checksum if asked to.
+  static void decode(Event *event, bool verify_checksum) {
+    Log_event *ev = nullptr;
+    event->error = binlog_event_deserialize(
+        event->data, event->length, event->fde.get(), verify_checksum, &ev);
+    if (event->error != Binlog_read_error::SUCCESS) return;
+    ev->register_temp_buf(reinterpret_cast<char *>(event->data),
+                          Default_binlog_event_allocator::
+                              DELEGATE_MEMORY_TO_EVENT_OBJECT);
+    event->event = ev;
+  }
+
+  bool is_empty() const { return m_events.empty(); }
+  bool is_full() const {
+    return m_events.size() >= MAX_EVENTS || m_bytes >= MAX_BYTES;
+  }
+
+  /// Add an event read ahead, to be decoded unless it already is.
+  void add(std::unique_ptr<Event> event) {
+    Event *to_decode = event->decoded ? nullptr : event.get();
+    m_bytes += event->length;
+    m_events.push_back(std::move(event));
+    if (to_decode == nullptr) return;
+    mysql_mutex_lock(&m_lock);
+    m_pending.push_back(to_decode);
+    mysql_cond_signal(&m_work_cond);
+    mysql_mutex_unlock(&m_lock);
+  }
+
+  /// Take the first event read ahead, once it is decoded.
+  std::unique_ptr<Event> take() {
+    std::unique_ptr<Event> event = std::move(m_events.front());
+    m_events.pop_front();
+    m_bytes -= event->length;
+    mysql_mutex_lock(&m_lock);
+    while (!event->decoded) mysql_cond_wait(&m_done_cond, &m_lock);
+    mysql_mutex_unlock(&m_lock);
+    return event;
+  }
+
+ private:
+  static void *decode_thread(void *arg) {
+    my_thread_init();
+    auto *decoder = static_cast<Event_decoder *>(arg);
+    mysql_mutex_lock(&decoder->m_lock);
+    while (true) {
+      while (decoder->m_pending.empty() && !decoder->m_stopping)
+        mysql_cond_wait(&decoder->m_work_cond, &decoder->m_lock);
+      if (decoder->m_stopping) break;
+      Event *event = decoder->m_pending.front();
+      decoder->m_pending.pop_front();
+      mysql_mutex_unlock(&decoder->m_lock);
+
+      decode(event, decoder->m_verify_checksum);
+
+      mysql_mutex_lock(&decoder->m_lock);
+      event->decoded = true;
+      mysql_cond_broadcast(&decoder->m_done_cond);
+    }
+    mysql_mutex_unlock(&decoder->m_lock);
+    my_thread_end();
+    return nullptr;
+  }
+
+  const bool m_verify_checksum;
+  mysql_mutex_t m_lock;
+  /// Signaled as there are events to decode, and as the threads are to stop.
+  mysql_cond_t m_work_cond;
+  /// Signaled as events are decoded.
+  mysql_cond_t m_done_cond;
+  /// The events read ahead, in the order of the file.
+  std::deque<std::unique_ptr<Event>> m_events;
+  my_off_t m_bytes = 0;
+  /// The events to decode. Guarded by m_lock.
+  std::deque<Event *> m_pending;
+  /// Guarded by m_lock.
+  bool m_stopping = false;
+  std::vector<my_thread_handle> m_threads;
+};
+
 Rpl_applier_reader::Rpl_applier_reader(Relay_log_info *rli)
     : m_relaylog_file_reader(
           opt_replica_sql_verify_checksum,
@@ -133,6 +291,12 @@ bool Rpl_applier_reader::open(const char **errmsg) {
   m_reading_active_log = m_rli->relay_log.is_active(m_linfo.log_file_name);
   ret = false;
 
+  if (opt_replica_decode_threads > 0 && m_rli->is_parallel_exec()) {
+    m_decoder.reset(new Event_decoder(opt_replica_sql_verify_checksum));
+    // the coordinator decodes the events without threads
+    if (m_decoder->start(opt_replica_decode_threads)) m_decoder.reset();
+  }
+
 #ifndef NDEBUG
   debug_print_next_event_positions();
 #endif
@@ -142,6 +306,9 @@ err:
 }
 
 void Rpl_applier_reader::close() {
+  m_decoder.reset();
+  m_decoder_fde.reset();
+  m_read_ahead_stopped = false;
   m_relaylog_file_reader.close();
   m_reading_active_log = true;
   m_log_end_pos = 0;
@@ -168,7 +335,8 @@ Log_event *Rpl_applier_reader::read_next_event() {
   DBUG_EXECUTE_IF("force_sql_thread_error", return nullptr;);
 
   if (m_reading_active_log &&
-      m_relaylog_file_reader.position() >= m_log_end_pos) {
+      m_relaylog_file_reader.position() >= m_log_end_pos &&
+      (m_decoder == nullptr || m_decoder->is_empty())) {
     while (true) {
       if (sql_slave_killed(m_rli->info_thd, m_rli)) return nullptr;
 
@@ -228,6 +396,8 @@ Log_event *Rpl_applier_reader::read_next_event() {
     }
   }
 
+  if (m_decoder != nullptr) return read_decoded_event();
+
   m_rli->set_event_start_pos(m_relaylog_file_reader.position());
   ev = m_relaylog_file_reader.read_event_object(&read_length);
   if (ev != nullptr) {
@@ -252,6 +422,82 @@ Log_event *Rpl_applier_reader::read_next_event() {
   return nullptr;
 }
 
+void Rpl_applier_reader::read_ahead() {
+  auto &reader = m_relaylog_file_reader;
+  // what the receiver is writing of the active file is left to it
+  while (!m_decoder->is_full() &&
+         (!m_reading_active_log || reader.position() < m_log_end_pos)) {
+    if (m_decoder_fde == nullptr)
+      m_decoder_fde = std::make_shared<const Format_description_event>(
+          *reader.format_description_event());
+
+    auto event = std::make_unique<Event_decoder::Event>();
+    event->start_pos = reader.position();
+    event->fde = m_decoder_fde;
+    // the checksum is verified as the event is decoded
+    if (reader.event_data_istream()->read_event_data(
+            &event->data, &event->length, reader.allocator(), false,
+            m_decoder_fde->footer()->checksum_alg)) {
+      m_read_ahead_stopped = true;
+      return;
+    }
+    event->end_pos = reader.position();
+
+    // the events after it are decoded with it
+    if (event->data[EVENT_TYPE_OFFSET] ==
+        binary_log::FORMAT_DESCRIPTION_EVENT) {
+      Event_decoder::decode(event.get(), opt_replica_sql_verify_checksum);
+      event->decoded = true;
+      if (event->event == nullptr) {
+        m_read_ahead_stopped = true;
+        m_decoder->add(std::move(event));
+        return;
+      }
+      reader.set_format_description_event(
+          dynamic_cast<Format_description_event &>(*event->event));
+      m_decoder_fde.reset();
+    }
+    m_decoder->add(std::move(event));
+  }
+}
+
+Log_event *Rpl_applier_reader::read_decoded_event() {
+  if (!m_read_ahead_stopped) read_ahead();
+
+  if (!m_decoder->is_empty()) {
+    std::unique_ptr<Event_decoder::Event> event = m_decoder->take();
+    if (event->error != Binlog_read_error::SUCCESS) {
+      LogErr(ERROR_LEVEL, ER_RPL_SLAVE_ERROR_READING_RELAY_LOG_EVENTS,
+             m_rli->get_for_channel_str(),
+             Binlog_read_error(event->error).get_str());
+      return nullptr;
+    }
+    Log_event *ev = std::exchange(event->event, nullptr);
+    event->data = nullptr;
+
+    m_rli->set_event_start_pos(event->start_pos);
+    m_rli->set_future_event_relay_log_pos(event->end_pos);
+    ev->future_event_relay_log_pos = m_rli->get_future_event_relay_log_pos();
+    ev->relay_log_coords = {m_rli->get_event_relay_log_name(),
+                            event->end_pos};
+    relay_sql_events++;
+    relay_sql_bytes += event->length;
+    return ev;
+  }
+
+  // all the events read ahead were returned
+  m_read_ahead_stopped = false;
+  if (m_relaylog_file_reader.get_error_type() == Binlog_read_error::READ_EOF &&
+      !m_reading_active_log) {
+    if (!move_to_next_log()) return read_next_event();
+  }
+
+  LogErr(ERROR_LEVEL, ER_RPL_SLAVE_ERROR_READING_RELAY_LOG_EVENTS,
+         m_rli->get_for_channel_str(),
+         m_errmsg ? m_errmsg : m_relaylog_file_reader.get_error_str());
+  return nullptr;
+}
+
 bool Rpl_applier_reader::read_active_log_end_pos() {
   m_log_end_pos = m_rli->relay_log.get_binlog_end_pos();
   m_reading_active_log = m_rli->relay_log.is_active(m_linfo.log_file_name);
@@ -346,6 +592,7 @@ bool Rpl_applier_reader::reopen_log_reader_if_needed() {
 
     my_off_t pos = m_relaylog_file_reader.position();
     m_relaylog_file_reader.close();
+    m_decoder_fde.reset();
     if (m_relaylog_file_reader.open(m_linfo.log_file_name) ||
         m_relaylog_file_reader.seek(pos))
       return true;
@@ -416,6 +663,7 @@ bool Rpl_applier_reader::move_to_next_log() {
   // will handle this gracefully.
   m_reading_active_log = m_rli->relay_log.is_active(m_linfo.log_file_name);
   m_log_end_pos = m_relaylog_file_reader.position();
+  m_decoder_fde.reset();
   return m_relaylog_file_reader.open(m_linfo.log_file_name);
 }
 
@@ -552,7 +800,7 @@ void Rpl_applier_reader::debug_print_next_event_positions() {
   assert(m_relaylog_file_reader.position() >= BIN_LOG_HEADER_SIZE);
   assert(m_relaylog_file_reader.position() ==
              m_rli->get_event_relay_log_pos() ||
-         (m_rli->is_parallel_exec() ||
+         (m_rli->is_parallel_exec() || m_decoder != nullptr ||
           // TODO: double check that this is safe:
           (m_rli->info_thd != nullptr &&
            m_rli->info_thd->variables.binlog_trx_compression)));
@@ -23,12 +23,18 @@
 #ifndef RPL_APPLIER_READER_INCLUDED
 #define RPL_APPLIER_READER_INCLUDED
 
+#include <memory>
+
 #include "mysqld.h"
 #include "sql/binlog.h"
 #include "sql/binlog_reader.h"
 
 class Relay_log_info;
 
+/// The threads decoding the events a multi-threaded applier reads ahead, 0
+/// to have the coordinator decode them.
+extern uint opt_replica_decode_threads;
+
 /**
    This class provides the feature to read events from relay log files.
 
@@ -45,6 +51,12 @@ class Relay_log_info;
 
    - When reaching the end of active relay log file, it will wait for new events
      coming and make MTS checkpoints accordingly while waiting for events.
+
+   - With a multi-threaded applier and opt_replica_decode_threads, it reads
+     the events of the relay log file ahead of those returned, and a pool of
+     threads decodes them and verifies their checksums meanwhile. Then the
+     coordinator only reads the event data, and schedules the events, which
+     are returned in the order of the file.
 */
 class Rpl_applier_reader {
  public:
@@ -113,6 +125,18 @@ class Rpl_applier_reader {
   LOG_INFO m_linfo;
   bool m_relay_log_purge = relay_log_purge;
 
+  class Event_decoder;
+  /// Decodes the events read ahead, nullptr if they are not read ahead.
+  std::unique_ptr<Event_decoder> m_decoder;
+  /// The Format_description_event the events read ahead are decoded with,
+  /// nullptr until the next one is read ahead.
+  std::shared_ptr<const Format_description_event> m_decoder_fde;
+  /**
+     Whether reading ahead stopped at the end of the file or at an error,
+     which is handled once the events read before are returned.
+  */
+  bool m_read_ahead_stopped = false;
+
   class Stage_controller;
   /**
      When reaching the end of current relay log file, close it and open next
@@ -168,6 +192,21 @@ class Rpl_applier_reader {
   */
   bool reopen_log_reader_if_needed();
 
+  /**
+     Read the events of the file ahead, up to the end of what the receiver
+     has written of the active file, and hand them to m_decoder.
+  */
+  void read_ahead();
+  /**
+     Return the next event read ahead once it is decoded, or handle the end
+     of the file when all of them were returned. The caller must hold
+     m_rli->data_lock.
+
+     @retval     Log_event*     A valid Log_event object.
+     @retval     nullptr        Error happened or sql thread was killed.
+  */
+  Log_event *read_decoded_event();
+
   /* reset seconds_behind_master when starting to wait for events coming */
   void reset_seconds_behind_master();
   /* relay_log_space_limit should be disabled temporarily in some cases. */
@@ -51,6 +51,7 @@
 #include "mysql/psi/mysql_socket.h"
 #include "scope_guard.h"
 #include "sql/binlog.h"
+#include "sql/binlog/event_cache.h"
 #include "sql/binlog_reader.h"
 #include "sql/debug_sync.h"         // debug_sync_set_action
 #include "sql/derror.h"             // ER_THD
@@ -663,12 +664,17 @@ int Binlog_sender::send_binlog(File_reader &reader, my_off_t start_pos) {
     if (!has_prev_gtid_ev) return 0;
   }
 
+  if (unlikely(send_compression_dictionaries(reader, start_pos))) return 1;
+
   /*
     Slave is requesting a position which is in the middle of a file,
     so seek to the correct position.
   */
   if (reader.position() != start_pos && reader.seek(start_pos)) return 1;
 
+  m_event_cache_generation =
+      binlog::event_cache.generation(m_linfo.log_file_name);
+
   while (!m_thd->killed) {
     auto [end_pos, code] = get_binlog_end_pos(reader);
 
@@ -754,6 +760,8 @@ int Binlog_sender::send_events(File_reader &reader, my_off_t end_pos) {
   my_off_t log_pos = reader.position();
   my_off_t exclude_group_end_pos = 0;
   bool in_exclude_group = false;
+  // the reader is left behind while events are read from the cache
+  bool reader_behind = false;
 
   while (likely(log_pos < end_pos) || end_pos == 0) {
     uchar *event_ptr = nullptr;
@@ -761,7 +769,16 @@ int Binlog_sender::send_events(File_reader &reader, my_off_t end_pos) {
 
     if (unlikely(thd->killed)) return 1;
 
-    if (unlikely(read_event(reader, &event_ptr, &event_len))) return 1;
+    if (read_cached_event(log_pos, end_pos, &event_ptr, &event_len)) {
+      reader_behind = true;
+    } else {
+      if (reader_behind && reader.seek(log_pos)) {
+        set_fatal_error(log_read_error_msg(reader.get_error_type()));
+        return 1;
+      }
+      reader_behind = false;
+      if (unlikely(read_event(reader, &event_ptr, &event_len))) return 1;
+    }
 
     if (event_ptr == nullptr) {
       if (end_pos == 0) return 0;  // Arrive the end of inactive file
@@ -796,7 +813,7 @@ int Binlog_sender::send_events(File_reader &reader, my_off_t end_pos) {
 
     Sender_context_guard ctx_guard(*this, event_type);
 
-    log_pos = reader.position();
+    log_pos = reader_behind ? log_pos + event_len : reader.position();
 
     processlist_slave_offset(log_file, log_pos);
 
@@ -869,6 +886,12 @@ int Binlog_sender::send_events(File_reader &reader, my_off_t end_pos) {
     }
   }
 
+  // get_binlog_end_pos() waits from the position of the reader
+  if (reader_behind && reader.seek(log_pos)) {
+    set_fatal_error(log_read_error_msg(reader.get_error_type()));
+    return 1;
+  }
+
   /*
     A heartbeat is needed before waiting for more events, if some
     events are skipped. This is needed so that the slave can increase
@@ -1435,6 +1458,46 @@ int Binlog_sender::send_format_description_event(File_reader &reader,
   return send_packet();
 }
 
+int Binlog_sender::send_compression_dictionaries(File_reader &reader,
+                                                 my_off_t start_pos) {
+  DBUG_TRACE;
+  uchar *event_ptr = nullptr;
+  uint32 event_len = 0;
+
+  // the head of the file is Previous_gtids and Metadata events
+  while (reader.position() < start_pos) {
+    if (read_event(reader, &event_ptr, &event_len)) return 1;
+    if (event_ptr == nullptr) return 0;
+
+    Log_event_type type = (Log_event_type)event_ptr[EVENT_TYPE_OFFSET];
+    if (type == binary_log::PREVIOUS_GTIDS_LOG_EVENT) continue;
+    if (type != binary_log::METADATA_EVENT) return 0;
+
+    Log_event *ev = nullptr;
+    Binlog_read_error binlog_read_error = binlog_event_deserialize(
+        event_ptr, event_len, reader.format_description_event(), false, &ev);
+    if (binlog_read_error.has_error()) {
+      set_fatal_error(binlog_read_error.get_str());
+      return 1;
+    }
+    bool has_dictionaries = static_cast<Metadata_log_event *>(ev)->does_exist(
+        Metadata_log_event::Metadata_event_types::COMPRESSION_DICTIONARY_TYPE);
+    delete ev;
+    if (!has_dictionaries) continue;
+
+    /*
+      The other fields of a head Metadata_log_event are the previous-file
+      ones, which the slave ignores. log_pos=0 so that the slave does not
+      increment master's binlog position, as for the
+      Format_description_log_event.
+    */
+    int4store(event_ptr + LOG_POS_OFFSET, 0);
+    if (event_checksum_on()) calc_event_checksum(event_ptr, event_len);
+    if (send_packet()) return 1;
+  }
+  return 0;
+}
+
 int Binlog_sender::has_previous_gtid_log_event(File_reader &reader,
                                                bool *found) {
   uchar *event = nullptr;
@@ -1515,6 +1578,34 @@ inline int Binlog_sender::read_event(File_reader &reader, uchar **event_ptr,
   return 0;
 }
 
+bool Binlog_sender::read_cached_event(my_off_t log_pos, my_off_t end_pos,
+                                      uchar **event_ptr, uint32 *event_len) {
+  DBUG_TRACE;
+  // only the active file is cached, an inactive one is read to its end
+  if (end_pos == 0 || m_event_cache_generation == 0) return false;
+
+  uint32_t length;
+  if (binlog::event_cache.event_length(m_event_cache_generation, log_pos,
+                                       end_pos, &length) ||
+      reset_transmit_packet(0, length))
+    return false;
+
+  const size_t event_offset = m_packet.length();
+  uchar *to = reinterpret_cast<uchar *>(m_packet.ptr()) + event_offset;
+  // overwritten meanwhile, the dump thread is behind the cache
+  if (binlog::event_cache.read(m_event_cache_generation, log_pos, length, to))
+    return false;
+  m_packet.length(event_offset + length);
+
+  *event_ptr = to;
+  *event_len = length;
+  set_last_pos(log_pos + length);
+  DBUG_PRINT("info", ("Read cached event %s",
+                      Log_event::get_type_str(
+                          Log_event_type(to[EVENT_TYPE_OFFSET]))));
+  return true;
+}
+
 int Binlog_sender::send_heartbeat_event_v1(my_off_t log_pos,
                                            bool send_timestamp) {
   DBUG_TRACE;
@@ -125,6 +125,9 @@ class Binlog_sender {
   char m_last_file_buf[FN_REFLEN];
   const char *m_last_file;
   my_off_t m_last_pos;
+  /// The generation of the file being sent in binlog::event_cache, 0 if it
+  /// is not cached.
+  uint64_t m_event_cache_generation = 0;
 
   /*
     Needed to be able to evaluate if buffer needs to be resized (shrunk).
@@ -312,6 +315,20 @@ class Binlog_sender {
      @return It returns 0 if succeeds, otherwise 1 is returned.
   */
   int send_format_description_event(File_reader &reader, my_off_t start_pos);
+
+  /**
+     If the requested position is after the head of the binlog file, the
+     Metadata_log_events of the head carrying compression dictionaries are
+     sent after Format_description_log_event, with their log_pos set to 0
+     too. Otherwise the slave could not decompress the transaction payloads
+     of the file compressed with them.
+
+     @param[in] reader    File_reader of the binlog will be dumpped
+     @param[in] start_pos Position requested by the slave's IO thread.
+
+     @return It returns 0 if succeeds, otherwise 1 is returned.
+  */
+  int send_compression_dictionaries(File_reader &reader, my_off_t start_pos);
   /**
      It sends a heartbeat to the client.
 
@@ -352,6 +369,21 @@ class Binlog_sender {
      @retval 1 Fail
   */
   int read_event(File_reader &reader, uchar **event_ptr, uint32 *event_len);
+  /**
+     It reads the event at a position of the active binlog file from
+     binlog::event_cache, rather than from the file.
+
+     @param[in] log_pos       The position of the event.
+     @param[in] end_pos       The end of what was flushed of the file.
+     @param[out] event_ptr    The buffer used to store the event.
+     @param[out] event_len    Length of the event.
+
+     @retval true  The event was read.
+     @retval false The event is not in the cache, and is to be read from the
+                   file.
+  */
+  bool read_cached_event(my_off_t log_pos, my_off_t end_pos, uchar **event_ptr,
+                         uint32 *event_len);
   /**
     Check if it is allowed to send this event type.
 
@@ -22,6 +22,7 @@
 
 #include <algorithm>
 
+#include "my_systime.h"    // my_micro_time
 #include "mutex_lock.h"  // MUTEX_LOCK
 #include "sql/binlog.h"
 #include "sql/binlog/group_commit/bgc_ticket_manager.h"  // Bgc_ticket_manager
@@ -472,6 +473,50 @@ void Commit_stage_manager::wait_count_or_timeout(ulong count, long usec,
   }
 }
 
+ulonglong binlog_group_commit_adaptive_sync_delay = 0;
+ulonglong binlog_group_commit_arrival_rate = 0;
+ulonglong binlog_group_commit_sync_latency = 0;
+
+long Commit_stage_manager::sync_delay() const {
+  if (!opt_binlog_group_commit_sync_delay_adaptive)
+    return opt_binlog_group_commit_sync_delay;
+  return m_adaptive_sync_delay.load(std::memory_order_relaxed);
+}
+
+void Commit_stage_manager::update_sync_delay(ulonglong sessions,
+                                             ulonglong sync_usec) {
+  /* The weight of the last group in the moving averages */
+  constexpr double WEIGHT = 0.125;
+  const ulonglong now = my_micro_time();
+
+  if (m_last_sync_group_time != 0 && now > m_last_sync_group_time) {
+    const double rate =
+        sessions * 1000000.0 / (now - m_last_sync_group_time);
+    binlog_group_commit_arrival_rate = static_cast<ulonglong>(
+        binlog_group_commit_arrival_rate +
+        WEIGHT * (rate - binlog_group_commit_arrival_rate));
+  }
+  m_last_sync_group_time = now;
+  if (sync_usec > 0) {
+    binlog_group_commit_sync_latency = static_cast<ulonglong>(
+        binlog_group_commit_sync_latency +
+        WEIGHT * (static_cast<double>(sync_usec) -
+                  binlog_group_commit_sync_latency));
+  }
+
+  long delay = 0;
+  const long target = opt_binlog_group_commit_target_latency;
+  if (target > static_cast<long>(binlog_group_commit_sync_latency)) {
+    delay = target - static_cast<long>(binlog_group_commit_sync_latency);
+    if (opt_binlog_group_commit_sync_delay > 0)
+      delay = std::min(delay, opt_binlog_group_commit_sync_delay);
+    // no other transaction is expected meanwhile
+    if (binlog_group_commit_arrival_rate * delay < 1000000) delay = 0;
+  }
+  m_adaptive_sync_delay.store(delay, std::memory_order_relaxed);
+  binlog_group_commit_adaptive_sync_delay = delay;
+}
+
 THD *Commit_stage_manager::fetch_queue_acquire_lock(StageID stage) {
   DBUG_PRINT("debug", ("Fetching queue for stage %d", stage));
   return m_queue[stage].fetch_and_empty_acquire_lock();
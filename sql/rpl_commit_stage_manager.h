@@ -326,6 +326,29 @@ class Commit_stage_manager {
    */
   void wait_count_or_timeout(ulong count, long usec, StageID stage);
 
+  /**
+    The microseconds the leader of the sync stage waits for its queue to
+    fill.
+
+    With binlog_group_commit_sync_delay_adaptive, the delay is what is left
+    of binlog_group_commit_target_latency once the binary log is synced, as
+    far as binlog_group_commit_sync_delay allows if set, so that the groups
+    are as large as the target allows. It is 0 while too few transactions
+    arrive for one to join the group meanwhile, as waiting then only adds
+    latency. Otherwise it is binlog_group_commit_sync_delay.
+  */
+  long sync_delay() const;
+
+  /**
+    Account a group of the sync stage in the arrival rate and the sync
+    latency the adaptive delay is chosen from, and choose the delay of the
+    next group. Called by the leader of the sync stage.
+
+    @param sessions   the sessions of the group
+    @param sync_usec  the microseconds the sync took, 0 if none was done
+  */
+  void update_sync_delay(ulonglong sessions, ulonglong sync_usec);
+
   /**
     The function is called after follower thread are processed by leader,
     to unblock follower threads.
@@ -462,6 +485,16 @@ class Commit_stage_manager {
   mysql_cond_t m_cond_wait_for_ticket_turn;
   /** Mutex to protect the wait for a given ticket to become active. */
   mysql_mutex_t m_lock_wait_for_ticket_turn;
+
+  /** When the last group of the sync stage was accounted, in microseconds. */
+  ulonglong m_last_sync_group_time{0};
+  /** The adaptive delay of the sync stage, in microseconds. */
+  std::atomic<long> m_adaptive_sync_delay{0};
 };
 
+/* The state of the adaptive delay of the sync stage, for SHOW STATUS */
+extern ulonglong binlog_group_commit_adaptive_sync_delay;
+extern ulonglong binlog_group_commit_arrival_rate;
+extern ulonglong binlog_group_commit_sync_latency;
+
 #endif /*RPL_COMMIT_STAGE_MANAGER*/
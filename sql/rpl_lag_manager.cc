@@ -630,6 +630,96 @@ std::pair<std::string, std::string> get_top_two_entities(
   return std::make_pair(first_entity, second_entity);
 }
 
+/*
+  get_shard_throttle_rate
+    The rate a shard lagging by lag milliseconds is throttled at, proportional
+  to how far its lag is above write_stop_throttle_lag_milliseconds, and 100
+  once that is write_start_throttle_lag_milliseconds.
+
+  @retval rate in [1, 100]
+*/
+static uint get_shard_throttle_rate(ulong lag) {
+  if (lag <= write_stop_throttle_lag_milliseconds) return 1;
+  const ulonglong rate = 100ULL * (lag - write_stop_throttle_lag_milliseconds) /
+                         write_start_throttle_lag_milliseconds;
+  return std::max(1U, (uint)std::min(100ULL, rate));
+}
+
+/*
+  check_shard_lag_and_throttle
+    Auto throttling with write_throttle_shard_lag. The writes of a shard are
+  throttled once replicas lag by more than
+  write_start_throttle_lag_milliseconds on it, at a rate set from its lag on
+  each check, and released once its lag falls below
+  write_stop_throttle_lag_milliseconds. The writes of other shards are left
+  alone.
+*/
+static void check_shard_lag_and_throttle() {
+  const std::unordered_map<std::string, int> shard_lags =
+      get_current_shard_replication_lags();
+
+  // Protect access to global_write_throttling_rules and
+  // currently_throttled_entities.
+  MUTEX_LOCK(guard, &LOCK_global_write_throttling_rules);
+  auto &rules_map = global_write_throttling_rules[WTR_DIM_SHARD];
+  const char *dim = WRITE_STATS_TYPE_STRING[WTR_DIM_SHARD].c_str();
+
+  // Update the rate of the shards throttled, or release them
+  for (auto it = currently_throttled_entities.begin();
+       it != currently_throttled_entities.end();) {
+    if (it->second != WTR_DIM_SHARD) {
+      ++it;
+      continue;
+    }
+    const std::string &name = it->first;
+    auto iter = rules_map.find(name);
+    if (iter == rules_map.end() || iter->second.mode == WTR_MANUAL) {
+      it = currently_throttled_entities.erase(it);
+      continue;
+    }
+
+    const auto lag_iter = shard_lags.find(name);
+    const ulong lag = lag_iter == shard_lags.end() ? 0 : lag_iter->second;
+    if (lag < write_stop_throttle_lag_milliseconds) {
+      sql_print_information("[Write Throttling]Rule removed. dim:%s, name:%s",
+                            dim, name.c_str());
+      rules_map.erase(iter);
+      it = currently_throttled_entities.erase(it);
+      continue;
+    }
+
+    const uint rate = get_shard_throttle_rate(lag);
+    if (iter->second.throttle_rate != rate) {
+      iter->second.throttle_rate = rate;
+      sql_print_information(
+          "[Write Throttling]Rule updated. dim:%s, name:%s, rate:%d, lag:%lu",
+          dim, name.c_str(), rate, lag);
+    }
+    ++it;
+  }
+
+  // Throttle the shards starting to lag
+  for (const auto &shard_lag : shard_lags) {
+    const ulong lag = shard_lag.second;
+    if (shard_lag.first.empty() ||
+        lag <= write_start_throttle_lag_milliseconds ||
+        rules_map.find(shard_lag.first) != rules_map.end())
+      continue;
+
+    WRITE_THROTTLING_RULE rule;
+    rule.mode = WTR_AUTO;
+    rule.create_time = time(0);
+    rule.throttle_rate = get_shard_throttle_rate(lag);
+    sql_print_information(
+        "[Write Throttling]New rule created. dim:%s, name:%s, rate:%d, "
+        "lag:%lu",
+        dim, shard_lag.first.c_str(), rule.throttle_rate, lag);
+    rules_map.insert(std::make_pair(shard_lag.first, rule));
+    currently_throttled_entities.push_back(
+        std::make_pair(shard_lag.first, WTR_DIM_SHARD));
+  }
+}
+
 /*
   check_lag_and_throttle
     Main method responsible for auto throttling to avoid replication lag.
@@ -645,6 +735,11 @@ void check_lag_and_throttle(time_t time_now) {
   last_write_throttle_lag_ms = lag;
   update_peak(&write_throttle_lag_ms_period_peak, lag);
 
+  if (write_throttle_shard_lag) {
+    check_shard_lag_and_throttle();
+    return;
+  }
+
   if (lag < write_stop_throttle_lag_milliseconds) {
     if (are_replicas_lagging) {
       are_replicas_lagging = false;
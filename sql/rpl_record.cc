@@ -137,6 +137,13 @@ static void pack_field(uchar **pack_ptr, Field *field, size_t rec_offset,
     }
     DBUG_PRINT("info", ("stored in full format"));
   }
+  if ((value_options & PACKED_VECTOR_VALUES) != 0 &&
+      field->type() == MYSQL_TYPE_JSON &&
+      !down_cast<Field_json *>(field)->pack_vector(
+          pack_ptr, static_cast<ptrdiff_t>(rec_offset))) {
+    DBUG_PRINT("info", ("stored as a packed vector"));
+    return;
+  }
   *pack_ptr = field->pack_with_metadata_bytes(
       *pack_ptr, field->field_ptr() + rec_offset, field->max_data_length());
 }
@@ -225,6 +232,10 @@ static bool unpack_field(const uchar **pack_ptr, Field *field, uint metadata,
         table->disable_logical_diffs_for_current_row(field);
     }
 
+    if (field->type() == MYSQL_TYPE_JSON &&
+        Field_json::is_packed_vector(*pack_ptr, metadata))
+      return down_cast<Field_json *>(field)->unpack_vector(pack_ptr, metadata);
+
     *pack_ptr = field->unpack(field->field_ptr(), *pack_ptr, metadata);
   }
 
@@ -328,8 +339,8 @@ size_t pack_row(TABLE *table, MY_BITMAP const *columns_in_image,
         }
       }
     }
-    pack_ptr =
-        net_store_length(pack_ptr, has_any_json_diff ? value_options : 0);
+    pack_ptr = net_store_length(
+        pack_ptr, has_any_json_diff ? value_options & PARTIAL_JSON_UPDATES : 0);
     partial_bits.set_ptr(pack_ptr);
     if (has_any_json_diff) pack_ptr += (json_column_count + 7) / 8;
   }
@@ -151,6 +151,7 @@
 #include "sql/rpl_reporting.h"
 #include "sql/rpl_rli.h"      // Relay_log_info
 #include "sql/rpl_rli_pdb.h"  // Slave_worker
+#include "sql/rpl_source.h"   // SLAVE_STATS
 #include "sql/rpl_trx_boundary_parser.h"
 #include "sql/rpl_utility.h"
 #include "sql/slave_stats_daemon.h"  // stop_handle_slave_stats_daemon, start_handle_slave_stats_daemon
@@ -3836,12 +3837,14 @@ std::pair<longlong, longlong> get_time_lag_behind_master(Master_info *mi) {
 }
 
 /**
-  Send milli_second_behind_master statistic to primary using
-  COM_SEND_REPLICA_STATISTICS
+  Send milli_second_behind_master statistic, and the lag of the shards
+  lagging the most, to primary using COM_SEND_REPLICA_STATISTICS
 */
-int send_replica_statistics_to_master(MYSQL *mysql,
-                                      int milli_sec_behind_master) {
-  uchar buf[1024];
+int send_replica_statistics_to_master(
+    MYSQL *mysql, int milli_sec_behind_master,
+    const std::vector<std::pair<std::string, int>> &shard_lags) {
+  uchar buf[SLAVE_STATS::PACKET_LENGTH +
+            SLAVE_STATS::MAX_SHARD_LAGS * (1 + NAME_LEN + 4)];
   uchar *pos = buf;
   DBUG_ENTER("send_replica_statistics_to_master");
 
@@ -3854,6 +3857,18 @@ int send_replica_statistics_to_master(MYSQL *mysql,
   int4store(pos, milli_sec_behind_master);
   pos += 4;
 
+  size_t shards = 0;
+  for (const auto &shard_lag : shard_lags) {
+    const std::string &name = shard_lag.first;
+    if (shards++ == SLAVE_STATS::MAX_SHARD_LAGS) break;
+    if (name.length() > NAME_LEN) continue;
+    *pos++ = (uchar)name.length();
+    memcpy(pos, name.data(), name.length());
+    pos += name.length();
+    int4store(pos, shard_lag.second);
+    pos += 4;
+  }
+
   if (simple_command(mysql, COM_SEND_REPLICA_STATISTICS, buf,
                      (size_t)(pos - buf), 0)) {
     DBUG_RETURN(1);
@@ -6704,6 +6719,9 @@ static void *handle_slave_worker(void *arg) {
 
   mysql_mutex_lock(&w->jobs_lock);
 
+  // the Coordinator may be enqueueing after it saw this Worker running
+  while (w->jobs.producing) my_sleep(1);
+
   while (w->jobs.de_queue(job_item)) {
     purge_cnt++;
     purge_size += job_item->data->common_header->data_written;
@@ -8727,6 +8745,25 @@ QUEUE_EVENT_RESULT queue_event(Master_info *mi, const char *buf,
       goto end;
     } break;
 
+    case binary_log::METADATA_EVENT: {
+      Metadata_log_event metadata_ev(buf, mi->get_mi_description_event());
+      /*
+        Keep the dictionaries of the master's binlog file, so that the relay
+        log files opened while it is relayed have them at their head.
+      */
+      if (metadata_ev.does_exist(Metadata_log_event::Metadata_event_types::
+                                     COMPRESSION_DICTIONARY_TYPE))
+        rli->relay_log.relay_log_compression_dictionaries =
+            metadata_ev.get_compression_dictionaries();
+      /*
+        The master sends the dictionaries of the head of its binlog file with
+        log_pos=0 when the slave starts in the middle of it, like the
+        Format_description_log_event.
+      */
+      inc_pos = uint4korr(buf + LOG_POS_OFFSET) ? event_len : 0;
+      break;
+    }
+
     case binary_log::TRANSACTION_PAYLOAD_EVENT: {
       binary_log::Transaction_payload_event tpe(buf,
                                                 mi->get_mi_description_event());
@@ -30,6 +30,8 @@
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "m_string.h"
 #include "my_bitmap.h"
@@ -540,8 +542,9 @@ int flush_master_info(Master_info *mi, bool force, bool need_lock = true,
 void add_replica_skip_errors(const char *arg);
 void set_replica_skip_errors(char **replica_skip_errors_ptr);
 void configure_master_connection_options(MYSQL *mysql, Master_info *mi);
-int send_replica_statistics_to_master(MYSQL *mysql,
-                                      int milli_sec_behind_master);
+int send_replica_statistics_to_master(
+    MYSQL *mysql, int milli_sec_behind_master,
+    const std::vector<std::pair<std::string, int>> &shard_lags);
 std::pair<longlong, longlong> get_time_lag_behind_master(Master_info *mi);
 int add_new_channel(Master_info **mi, const char *channel);
 /**
@@ -362,10 +362,9 @@ int Slave_worker::init_worker(Relay_log_info *rli, ulong i) {
   gaq_index = last_group_done_index = c_rli->gaq->capacity;  // out of range
   last_groups_assigned_index = 0;
   assert(!jobs.inited_queue);
-  jobs.avail = 0;
-  jobs.entry = 0;
-  jobs.len = 0;
+  jobs.clear();
   jobs.overfill = false;  //  todo: move into Slave_jobs_queue constructor
+  jobs.consumer_waiting = false;
   jobs.waited_overfill = 0;
   jobs.capacity = c_rli->mts_slave_worker_queue_len_max;
   jobs.inited_queue = true;
@@ -2352,30 +2351,49 @@ bool append_item_to_jobs(slave_job_item *job_item, Slave_worker *worker,
     rli->mts_wq_no_underrun_cnt++;
   }
 
-  mysql_mutex_lock(&worker->jobs_lock);
-
-  // possible WQ overfill
-  while (worker->running_status == Slave_worker::RUNNING && !thd->killed &&
-         (ret = worker->jobs.en_queue(job_item)) ==
-             Slave_jobs_queue::error_result) {
-    thd->ENTER_COND(&worker->jobs_cond, &worker->jobs_lock,
-                    &stage_replica_waiting_worker_queue, &old_stage);
-    worker->jobs.overfill = true;
-    worker->jobs.waited_overfill++;
-    rli->mts_wq_overfill_cnt++;
-    mysql_cond_wait(&worker->jobs_cond, &worker->jobs_lock);
-    mysql_mutex_unlock(&worker->jobs_lock);
-    thd->EXIT_COND(&old_stage);
+  // counted before the Worker can take the item
+  worker->curr_jobs++;
+  /*
+    The Worker changes its state before it waits for producing to drop and
+    purges the queue. So the item is either purged by it, or not enqueued.
+  */
+  worker->jobs.producing = true;
+  if (worker->running_status == Slave_worker::RUNNING && !thd->killed)
+    ret = worker->jobs.en_queue(job_item);
+  worker->jobs.producing = false;
 
+  if (ret == Slave_jobs_queue::error_result) {
     mysql_mutex_lock(&worker->jobs_lock);
-  }
-  if (ret != Slave_jobs_queue::error_result) {
-    worker->curr_jobs++;
-    if (worker->jobs.get_length() == 1) mysql_cond_signal(&worker->jobs_cond);
+    // possible WQ overfill
+    while (worker->running_status == Slave_worker::RUNNING && !thd->killed) {
+      // raised before the last check, see remove_item_from_jobs()
+      worker->jobs.overfill = true;
+      ret = worker->jobs.en_queue(job_item);
+      if (ret != Slave_jobs_queue::error_result) break;
 
+      thd->ENTER_COND(&worker->jobs_cond, &worker->jobs_lock,
+                      &stage_replica_waiting_worker_queue, &old_stage);
+      worker->jobs.waited_overfill++;
+      rli->mts_wq_overfill_cnt++;
+      mysql_cond_wait(&worker->jobs_cond, &worker->jobs_lock);
+      mysql_mutex_unlock(&worker->jobs_lock);
+      thd->EXIT_COND(&old_stage);
+
+      mysql_mutex_lock(&worker->jobs_lock);
+    }
+    worker->jobs.overfill = false;
     mysql_mutex_unlock(&worker->jobs_lock);
+  }
+
+  if (ret != Slave_jobs_queue::error_result) {
+    // the Worker raised the flag before it last found the queue empty
+    if (worker->jobs.consumer_waiting) {
+      mysql_mutex_lock(&worker->jobs_lock);
+      mysql_cond_signal(&worker->jobs_cond);
+      mysql_mutex_unlock(&worker->jobs_lock);
+    }
   } else {
-    mysql_mutex_unlock(&worker->jobs_lock);
+    worker->curr_jobs--;
 
     mysql_mutex_lock(&rli->pending_jobs_lock);
     rli->pending_jobs--;  // roll back of the prev incr
@@ -2398,16 +2416,15 @@ static void remove_item_from_jobs(slave_job_item *job_item,
                                   Slave_worker *worker, Relay_log_info *rli) {
   Log_event *ev = job_item->data;
 
-  mysql_mutex_lock(&worker->jobs_lock);
   worker->jobs.de_queue(job_item);
-  /* possible overfill */
-  if (worker->jobs.get_length() == worker->jobs.capacity - 1 &&
-      worker->jobs.overfill == true) {
+  /* possible overfill, the flag is raised before the last check */
+  if (worker->jobs.overfill) {
+    mysql_mutex_lock(&worker->jobs_lock);
     worker->jobs.overfill = false;
     // todo: worker->hungry_cnt++;
     mysql_cond_signal(&worker->jobs_cond);
+    mysql_mutex_unlock(&worker->jobs_lock);
   }
-  mysql_mutex_unlock(&worker->jobs_lock);
 
   /* statistics */
 
@@ -2492,14 +2509,27 @@ static struct slave_job_item *pop_jobs_item(Slave_worker *worker,
                                             Slave_job_item *job_item) {
   THD *thd = worker->info_thd;
 
+  job_item->data = nullptr;
+  // A queued item is taken without jobs_lock while the Worker is running
+  if (worker->running_status == Slave_worker::RUNNING && !thd->killed) {
+    const auto head = worker->jobs.head_queue();
+    if (head != nullptr) {
+      *job_item = *head;
+      worker->curr_jobs--;
+      thd_proc_info(worker->info_thd, "Executing event");
+      return job_item;
+    }
+  }
+
   mysql_mutex_lock(&worker->jobs_lock);
 
-  job_item->data = nullptr;
   while (!job_item->data && !thd->killed &&
          (worker->running_status == Slave_worker::RUNNING ||
           worker->running_status == Slave_worker::STOP)) {
     PSI_stage_info old_stage;
 
+    // raised before the last check, see append_item_to_jobs()
+    worker->jobs.consumer_waiting = true;
     if (set_max_updated_index_on_stop(worker, job_item)) break;
     if (job_item->data == nullptr) {
       worker->wq_empty_waits++;
@@ -2512,6 +2542,7 @@ static struct slave_job_item *pop_jobs_item(Slave_worker *worker,
       mysql_mutex_lock(&worker->jobs_lock);
     }
   }
+  worker->jobs.consumer_waiting = false;
   if (job_item->data) worker->curr_jobs--;
 
   mysql_mutex_unlock(&worker->jobs_lock);
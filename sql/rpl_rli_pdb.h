@@ -514,15 +514,85 @@ bool circular_buffer_queue<Element_type>::de_tail(Element_type *item) {
   return true;
 }
 
+/**
+  The assignment queue of a Worker. The Coordinator is its only producer and
+  the Worker its only consumer, so items are handed over without jobs_lock:
+  the Coordinator publishes an item by incrementing `len` after storing it,
+  and the Worker frees the slot by decrementing `len` after copying the item
+  out. Each side only moves its own end of the queue, `m_tail` and `m_head`
+  counting the items ever enqueued and dequeued.
+
+  jobs_lock and jobs_cond are left to sleeping on an empty or a full queue.
+  The sleeper raises `consumer_waiting` or `overfill` before it checks the
+  queue a last time, and the other side only takes jobs_lock to wake it when
+  it sees the flag, so a busy Worker is not signalled per event.
+*/
 class Slave_jobs_queue : public circular_buffer_queue<Slave_job_item> {
  public:
   Slave_jobs_queue() : circular_buffer_queue<Slave_job_item>() {}
+
+  /**
+    Enqueue at the tail, by the Coordinator.
+
+    @return the index of the item or `error_result` if the queue is full.
+  */
+  size_t en_queue(Slave_job_item *item) {
+    if (full()) return error_result;
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t ret = tail % capacity;
+    m_Q[ret] = *item;
+    m_tail.store(tail + 1, std::memory_order_relaxed);
+    len++;
+    return ret;
+  }
+
+  /**
+    Dequeue from the head, by the Worker or once the Worker is gone.
+
+    @return true if an element was returned, false if the queue was empty.
+  */
+  bool de_queue(Slave_job_item *item) {
+    if (empty()) return false;
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    *item = m_Q[head % capacity];
+    m_head.store(head + 1, std::memory_order_relaxed);
+    len--;
+    return true;
+  }
+
+  Slave_job_item *head_queue() {
+    if (empty()) return nullptr;
+    return &m_Q[m_head.load(std::memory_order_relaxed) % capacity];
+  }
+
+  /* Unlike the base class, ordered with the flags of the sleeping side */
+  bool empty() const { return len.load() == 0; }
+  bool full() const { return len.load() == capacity; }
+
+  void clear() {
+    m_head = 0;
+    m_tail = 0;
+    len = 0;
+  }
+
   /*
      Coordinator marks with true, Worker signals back at queue back to
      available
   */
-  bool overfill;
+  std::atomic<bool> overfill;
+  /* Worker marks with true before it sleeps on an empty queue */
+  std::atomic<bool> consumer_waiting{false};
+  /*
+    Coordinator marks with true while it checks the Worker is running and
+    enqueues without jobs_lock, the leaving Worker waits for false before
+    it purges the queue
+  */
+  std::atomic<bool> producing{false};
   ulonglong waited_overfill;
+
+ private:
+  std::atomic<size_t> m_head{0};
+  std::atomic<size_t> m_tail{0};
 };
 
 class Slave_worker : public Relay_log_info {
@@ -569,7 +639,7 @@ class Slave_worker : public Relay_log_info {
   ulong wq_empty_waits;            // how many times got idle
   ulong events_done;               // how many events (statements) processed
   ulong groups_done;               // how many groups (transactions) processed
-  volatile int curr_jobs;          // number of active  assignments
+  std::atomic<int> curr_jobs;      // number of active  assignments
   // number of partitions allocated to the worker at point in time
   long usage_partition;
   // symmetric to rli->mts_end_group_sets_max_dbs
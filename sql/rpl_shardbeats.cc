@@ -26,6 +26,8 @@
 #include "sql/sql_profile.h"
 #include "sql/sys_vars.h"
 
+#include <chrono>
+#include <mutex>
 #include <utility>
 
 #ifdef HAVE_PSI_INTERFACE
@@ -1037,6 +1039,46 @@ void Shardbeats_manager::init_mutexes() {
   mysql_cond_init(key_COND_shardbeater_run_cond, &COND_shardbeater_run_cond);
 }
 
+// The source time of the last event applied on each shard,
+// protected by LOCK_shard_apply_times
+static std::mutex LOCK_shard_apply_times;
+static std::unordered_map<std::string, unsigned long long> shard_apply_times;
+
+void update_shard_apply_time(const char *db,
+                             unsigned long long source_time_ms) {
+  std::lock_guard<std::mutex> guard(LOCK_shard_apply_times);
+  auto &apply_time = shard_apply_times[db];
+  apply_time = std::max(apply_time, source_time_ms);
+}
+
+std::vector<std::pair<std::string, int>> get_lagging_shards(
+    size_t count, long long clock_diff_ms, int lag_ms) {
+  std::vector<std::pair<std::string, int>> shards;
+  if (count == 0 || lag_ms <= 0) return shards;
+
+  const long long now_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count() -
+      clock_diff_ms;
+  {
+    std::lock_guard<std::mutex> guard(LOCK_shard_apply_times);
+    for (const auto &shard : shard_apply_times) {
+      const long long behind = now_ms - (long long)shard.second;
+      if (behind > 0)
+        shards.emplace_back(shard.first,
+                            (int)std::min<long long>(behind, lag_ms));
+    }
+  }
+
+  count = std::min(count, shards.size());
+  std::partial_sort(
+      shards.begin(), shards.begin() + count, shards.end(),
+      [](const auto &a, const auto &b) { return a.second > b.second; });
+  shards.resize(count);
+  return shards;
+}
+
 // Make a copy of the map from db -> last_trx_time
 // for the shardbeater, so that LOCK_log does not need
 // to be held for long.
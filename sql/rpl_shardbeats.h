@@ -6,6 +6,7 @@
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 #include "mysql/psi/mysql_cond.h"
 #include "mysql/psi/mysql_mutex.h"
@@ -23,6 +24,19 @@ extern uint shardbeat_interval_ms;
 // killswitch for the shardbeater.
 extern bool enable_shardbeater;
 
+// Note that a replication applier applied an event of a shard that was
+// written on the source at source_time_ms. Used by replicas to report
+// the lag of each shard with write_throttle_shard_lag.
+void update_shard_apply_time(const char *db, unsigned long long source_time_ms);
+
+// The count shards whose last event applied is the oldest, with how many
+// milliseconds they are behind the source, at most lag_ms as the whole
+// replica is no further behind. As shardbeats write each shard at least
+// every shardbeat_interval_ms, a silent shard caught up is no further
+// behind than that.
+std::vector<std::pair<std::string, int>> get_lagging_shards(
+    size_t count, long long clock_diff_ms, int lag_ms);
+
 /**
  * This class contains the functionality for Shardbeats.
  * Shardbeats inject simple INSERTs/heartbeats for each user facing database.
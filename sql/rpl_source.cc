@@ -268,7 +268,8 @@ int register_raft_followers(
   return error;
 }
 
-SLAVE_STATS::SLAVE_STATS(uchar *packet) {
+SLAVE_STATS::SLAVE_STATS(uchar *packet, uint packet_length) {
+  uchar *packet_end = packet + packet_length;
   /* 4 bytes for the server id */
   /* 4 bytes timestamp */
   /* 4 bytes for milli_second_behind_master */
@@ -277,6 +278,20 @@ SLAVE_STATS::SLAVE_STATS(uchar *packet) {
   timestamp = uint4korr(packet);
   packet += 4;
   milli_sec_behind_master = uint4korr(packet);
+  packet += 4;
+
+  /*
+    Then, from replicas reporting it, for each shard
+    1 byte for the length of the name, the name, 4 bytes for the lag
+  */
+  while (packet < packet_end && shard_lags.size() < MAX_SHARD_LAGS) {
+    const uint name_length = *packet++;
+    if (packet + name_length + 4 > packet_end) break;
+    std::string name(pointer_cast<const char *>(packet), name_length);
+    packet += name_length;
+    shard_lags.emplace_back(std::move(name), (int)uint4korr(packet));
+    packet += 4;
+  }
 }
 
 /**
@@ -291,12 +306,12 @@ SLAVE_STATS::SLAVE_STATS(uchar *packet) {
 int store_replica_stats(THD *thd, uchar *packet, uint packet_length) {
   if (check_access(thd, REPL_SLAVE_ACL, any_db, nullptr, nullptr, 0, 0))
     return 1;
-  if (sizeof(SLAVE_STATS) > packet_length) {
+  if (SLAVE_STATS::PACKET_LENGTH > packet_length) {
     my_error(ER_MALFORMED_PACKET, MYF(0));
     return 1;
   }
 
-  SLAVE_STATS stats(packet);
+  SLAVE_STATS stats(packet, packet_length);
 
   mysql_mutex_lock(&LOCK_replica_list);
   auto it = slave_list.find(stats.server_id);
@@ -310,7 +325,7 @@ int store_replica_stats(THD *thd, uchar *packet, uint packet_length) {
     }
 
     if (write_stats_count > 0) {
-      si->slave_stats.push_front(stats);
+      si->slave_stats.push_front(std::move(stats));
     }
   }
   mysql_mutex_unlock(&LOCK_replica_list);
@@ -444,6 +459,49 @@ int get_current_replication_lag() {
   return final_lag;
 }
 
+/**
+  Scans through the replication lag of each shard reported by individual
+  secondaries, and returns the lag of each shard for the entire topology,
+  defined as for get_current_replication_lag(). A secondary not reporting a
+  shard is not lagging on it.
+
+  @retval shard -> replication_lag
+*/
+std::unordered_map<std::string, int> get_current_shard_replication_lags() {
+  std::unordered_map<std::string, int> shard_lags;
+  if (write_throttle_lag_pct_min_secondaries == 0) return shard_lags;
+
+  std::unordered_map<std::string, std::vector<int>> replica_lags;
+  size_t num_replicas_with_stats = 0;
+
+  mysql_mutex_lock(&LOCK_replica_list);
+  for (const auto &key_and_value : slave_list) {
+    REPLICA_INFO *si = key_and_value.second.get();
+    if (!si->slave_stats.empty()) {
+      ++num_replicas_with_stats;
+      // collect the most recent (front) lags by this secondary
+      for (const auto &shard_lag : si->slave_stats.front().shard_lags)
+        replica_lags[shard_lag.first].push_back(shard_lag.second);
+    }
+  }
+  mysql_mutex_unlock(&LOCK_replica_list);
+
+  const size_t min_secondaries_to_lag =
+      ceil(num_replicas_with_stats *
+           (double)write_throttle_lag_pct_min_secondaries / 100);
+  if (min_secondaries_to_lag == 0) return shard_lags;
+
+  for (auto &shard : replica_lags) {
+    std::vector<int> &lags = shard.second;
+    if (lags.size() < min_secondaries_to_lag) continue;
+    // the kth largest lag where k = min_secondaries_to_lag
+    std::nth_element(lags.begin(), lags.begin() + min_secondaries_to_lag - 1,
+                     lags.end(), std::greater<int>());
+    shard_lags.emplace(shard.first, lags[min_secondaries_to_lag - 1]);
+  }
+  return shard_lags;
+}
+
 void unregister_replica(THD *thd, bool only_mine, bool need_lock_slave_list) {
   if (thd->server_id) {
     if (need_lock_slave_list)
@@ -26,6 +26,8 @@
 #include <stddef.h>
 #include <list>
 #include <string>  // std::string
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "libbinlogevents/include/uuid.h"  // UUID
@@ -54,11 +56,18 @@ extern bool opt_show_replica_auth_info;
  * master
  */
 struct SLAVE_STATS {
+  /* The length of the statistics every replica sends */
+  static constexpr uint PACKET_LENGTH = 12;
+  /* The most shards a replica reports the lag of */
+  static constexpr size_t MAX_SHARD_LAGS = 8;
+
   int server_id;
   int timestamp;
   int milli_sec_behind_master;
+  /* The shards the replica lags the most behind on, with their lag in ms */
+  std::vector<std::pair<std::string, int>> shard_lags;
 
-  explicit SLAVE_STATS(uchar *packet);
+  SLAVE_STATS(uchar *packet, uint packet_length);
 };
 
 struct REPLICA_INFO {
@@ -158,6 +167,7 @@ bool reset_master(THD *thd, bool unlock_read_lock, bool force = false);
 
 std::vector<replica_statistics_row> get_all_replica_statistics();
 int get_current_replication_lag();
+std::unordered_map<std::string, int> get_current_shard_replication_lags();
 
 class user_var_entry;
 /**
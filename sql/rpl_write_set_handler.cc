@@ -719,6 +719,26 @@ bool add_pke(TABLE *table, THD *thd, const uchar *record) {
       }
     }
 
+    /*
+      Index entries other rows share, e.g. the inverted list of a vector
+      index, conflict like a unique key does.
+    */
+    std::vector<std::string> shared_entries;
+    if (table->file->shared_index_entries(record, &shared_entries))
+      return true;
+    for (const std::string &entry : shared_entries) {
+      pke.assign(entry);
+      pke.append(pke_schema_table);
+      if (generate_hash_pke(pke, thd
+#ifndef NDEBUG
+                            ,
+                            write_sets, hash_list
+#endif
+                            ))
+        return true;
+      writeset_hashes_added = true;
+    }
+
     /*
       Foreign keys handling.
 
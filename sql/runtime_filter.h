@@ -0,0 +1,40 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+#include "my_bitmap.h"
+
+/**
+  A filter the executor gives the storage engine through
+  handler::ha_set_runtime_filter() for the scan it has just started, so that
+  the engine can drop the rows the executor would discard anyway before it
+  does the rest of the work of returning them. The hash join gives the scan
+  of its probe input the join keys of its build input.
+
+  The filter may let rows through that the executor then discards, so an
+  engine is free to ignore it. It is dropped when the scan ends.
+*/
+class Runtime_filter {
+ public:
+  virtual ~Runtime_filter() = default;
+
+  /// The fields of the table the filter reads from record[0].
+  virtual const MY_BITMAP &fields() const = 0;
+
+  /// Whether the row in record[0], with at least fields() read, may pass.
+  virtual bool may_match() = 0;
+};
@@ -0,0 +1,151 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+/**
+  @file
+  The services answering the semantic operators. Each operator has its own
+  model, named "<backend>:<model>" by semantic_filter_model,
+  semantic_map_model, semantic_extract_model, semantic_embed_model and
+  semantic_embed_image_model, so that e.g. filters go to a small local model
+  while maps go to a large hosted one. A model name without a backend is one
+  of "openai".
+
+  Two backends are built in, both speaking the OpenAI chat completions and
+  embeddings API:
+
+  - "openai", the OpenAI API, authenticated by the OPENAI_API_KEY
+    environment variable;
+  - "local", an OpenAI compatible server such as vLLM or llama.cpp at
+    semantic_local_url, reached over the unix socket semantic_local_socket
+    if one is set.
+
+  Each has its own limit on the requests in flight server wide, see
+  semantic_openai_max_requests and semantic_local_max_requests, and their
+  requests are paced by admission control, see
+  multi_tenancy_admit_semantic_request(). A request the server turns away
+  with 429 Too Many Requests is queued again after a backoff. Other
+  backends, e.g. one embedding texts in process, are added with
+  semantic_backend_register().
+
+  Images are embedded by posting them as base64 data URLs to the embeddings
+  API with "modality": "image", as served by e.g. infinity for CLIP models,
+  so that a GPU server next to the database embeds a whole batch at once.
+*/
+
+#include <string>
+#include <vector>
+
+#include "my_inttypes.h"
+
+/// Model of each semantic operator, as "<backend>:<model>".
+extern char *semantic_filter_model;
+extern char *semantic_map_model;
+extern char *semantic_extract_model;
+extern char *semantic_embed_model;
+extern char *semantic_embed_image_model;
+
+/// Base URL of the API of the "local" backend, e.g. http://localhost:8000/v1.
+extern char *semantic_local_url;
+
+/// Unix socket of the "local" backend, empty to connect over tcp.
+extern char *semantic_local_socket;
+
+/// Most requests in flight server wide on each backend, 0 for no limit.
+extern uint semantic_openai_max_requests;
+extern uint semantic_local_max_requests;
+
+/// What answering one prompt or text cost, 0 where unknown.
+struct Semantic_usage {
+  ulonglong tokens_in = 0;
+  ulonglong tokens_out = 0;
+  /// Http requests made for it, retries included; a request answering
+  /// several texts is counted on the first of them.
+  ulonglong requests = 0;
+  /// Wall time of those requests, in microseconds.
+  ulonglong request_time = 0;
+  /// Time it waited for admission and a free request slot, in microseconds.
+  ulonglong queue_time = 0;
+
+  ulonglong tokens() const { return tokens_in + tokens_out; }
+};
+
+class Semantic_backend {
+ public:
+  virtual ~Semantic_backend() = default;
+
+  /**
+    Have the model complete each prompt, keeping up to concurrency requests
+    in flight at a time.
+    @param[out] answers the answer to each prompt, left empty where none
+      could be had
+    @param[out] usage what each prompt cost
+    @return true if no request could be made at all
+  */
+  virtual bool complete(const std::string &model,
+                        const std::vector<std::string> &prompts,
+                        size_t concurrency, std::vector<std::string> *answers,
+                        std::vector<Semantic_usage> *usage) = 0;
+
+  /**
+    Embed each text with the model.
+    @param[out] embeddings the embedding of each text, left empty where none
+      could be had
+    @param[out] usage what each text cost
+    @return true if no request could be made at all
+  */
+  virtual bool embed(const std::string &model,
+                     const std::vector<std::string> &texts,
+                     std::vector<std::vector<float>> *embeddings,
+                     std::vector<Semantic_usage> *usage) = 0;
+
+  /**
+    Embed each image, given as the bytes of its file, with the model. A
+    backend that cannot embed images makes no request.
+    @param[out] embeddings the embedding of each image, left empty where
+      none could be had
+    @param[out] usage what each image cost
+    @return true if no request could be made at all
+  */
+  virtual bool embed_images(const std::string & /* model */,
+                            const std::vector<std::string> &images,
+                            std::vector<std::vector<float>> *embeddings,
+                            std::vector<Semantic_usage> *usage) {
+    embeddings->assign(images.size(), std::vector<float>());
+    usage->assign(images.size(), Semantic_usage());
+    return true;
+  }
+};
+
+/**
+  Make a backend available to the semantic operators under a name. The
+  backend must outlive its registration.
+  @return true if the name is taken
+*/
+bool semantic_backend_register(const std::string &name,
+                               Semantic_backend *backend);
+
+/// Withdraw a backend. No request may be using it any more.
+void semantic_backend_unregister(const std::string &name);
+
+/**
+  The backend and the model a "<backend>:<model>" name refers to.
+  @param[out] model the model name within the backend
+  @return nullptr if the backend is not registered
+*/
+Semantic_backend *semantic_backend_find(const std::string &name,
+                                        std::string *model);
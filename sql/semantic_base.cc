@@ -20,18 +20,32 @@
 #include <sstream>
 #include <iostream>
 #include "sql/semantic_base.h"
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <string_view>
+#include "base64.h"
 #include "field.h"
 #include "item.h"
 #include "item_func.h"
+#include "mysql/psi/mysql_rwlock.h"
+#include "mysql/psi/mysql_thread.h"
+#include "sql/current_thd.h"
 #include "sql/error_handler.h"
+#include "sql/fb_vector_distance.h"
+#include "sql/malloc_arena.h"
+#include "sql/mysqld.h"
 #include "sql/next_spatial_base.h"
-
-std::string get_openai_api_key();
-
-std::string call_openai_api(const std::string& prompt, const std::string& api_key);
+#include "sql/semantic_backend.h"
+#include "sql/semantic_cache.h"
+#include "sql/semantic_stats.h"
+#include "sql/sql_admission_control.h"
+#include "sql/sql_class.h"
 
 bool parse_string_from_blob(Field *field, std::string &data) {
   const Field_blob *field_blob = down_cast<const Field_blob *>(field);
@@ -43,15 +57,12 @@ bool parse_string_from_blob(Field *field, std::string &data) {
 
 using json = nlohmann::json;
 
-bool semantic_filter_openai(std::string &context, bool* result) {
-  std::string api_key = get_openai_api_key();
-  if (api_key.empty()) {
-    std::cerr << "Error: OPENAI_API_KEY environment variable is not set.\n";
-    return 1;
-  }
-  std::string prompt = "Answer the following question with only one word: \"true\" or \"false\".\nQuestion: " + context + "\nAnswer:";
-  std::string api_result = call_openai_api(prompt, api_key);
-  // Convert the result to lowercase for comparison
+static std::string semantic_filter_prompt(const std::string &context) {
+  return "Answer the following question with only one word: \"true\" or \"false\".\nQuestion: " + context + "\nAnswer:";
+}
+
+// Read a "true" or "false" answer, in any case.
+static bool parse_semantic_filter_answer(std::string api_result, bool* result) {
   std::transform(api_result.begin(), api_result.end(), api_result.begin(),
                    [](unsigned char c) { return std::tolower(c); });
   if (api_result == "true") {
@@ -62,159 +73,1129 @@ bool semantic_filter_openai(std::string &context, bool* result) {
     std::cerr << "Error: " << api_result << "\n";
     return 1;
   }
-
   return 0;
 }
 
-bool semantic_map_openai(std::string &context, std::string* result) {
-  std::string api_key = get_openai_api_key();
-  if (api_key.empty()) {
-    std::cerr << "Error: OPENAI_API_KEY environment variable is not set.\n";
-    return 1;
+
+char *semantic_filter_model;
+char *semantic_map_model;
+char *semantic_extract_model;
+char *semantic_embed_model;
+char *semantic_embed_image_model;
+char *semantic_local_url;
+char *semantic_local_socket;
+uint semantic_openai_max_requests;
+uint semantic_local_max_requests;
+
+// Copy of a string system variable, which SET GLOBAL may replace meanwhile.
+static std::string read_sysvar(char *const *var) {
+  mysql_rwlock_rdlock(&LOCK_global_system_variables);
+  std::string value = *var != nullptr ? *var : "";
+  mysql_rwlock_unlock(&LOCK_global_system_variables);
+  return value;
+}
+
+static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
+    ((std::string*)userp)->append((char*)contents, size * nmemb);
+    return size * nmemb;
+}
+
+/// What a call of an operator cost, kept by a helper thread of a session
+/// until the session's own thread charges it, see Semantic_filter_prefetch.
+struct Semantic_charge {
+  enum_semantic_op op;
+  size_t calls;
+  size_t cache_hits;
+  size_t failures;
+  std::vector<Semantic_usage> usage;
+};
+
+namespace {
+
+/** most idle easy handles kept for reuse */
+constexpr size_t SEMANTIC_CLIENT_MAX_IDLE_HANDLES = 64;
+
+/** most texts embedded by one request */
+constexpr size_t SEMANTIC_EMBED_MAX_BATCH = 256;
+
+/** most images embedded by one request, each is sent whole */
+constexpr size_t SEMANTIC_EMBED_IMAGE_MAX_BATCH = 32;
+
+/** most times a request turned away by 429 Too Many Requests is retried */
+constexpr int SEMANTIC_MAX_RETRIES = 6;
+
+// How long to hold off all requests after the attempt-th 429, doubling from
+// a second.
+ulonglong retry_backoff_us(int attempt) {
+  return 1000000ULL << std::min(attempt, 5);
+}
+
+// Whether the server turned the request away for the rate limit.
+bool too_many_requests(CURL* curl) {
+  long code = 0;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
+  return code == 429;
+}
+
+/**
+  Process wide http client of the backends. curl is set up and the api key
+  read once. Easy handles are pooled, and connections, dns lookups and tls
+  sessions are shared across them, so that a request reuses an open
+  keep-alive connection (http/2 where the server offers it) instead of
+  doing a new tls handshake.
+*/
+class Semantic_client {
+ public:
+  bool init() {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (m_initialized) return false;
+    if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK) return true;
+
+    m_share = curl_share_init();
+    if (m_share != nullptr) {
+      curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, lock_share);
+      curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, unlock_share);
+      curl_share_setopt(m_share, CURLSHOPT_USERDATA, this);
+      curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+      curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+      curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+
+    const char* key = std::getenv("OPENAI_API_KEY");
+    m_api_key = key ? std::string(key) : "";
+    m_initialized = true;
+    return false;
   }
-  std::string prompt = "Answer the following question. Provide only the answer directly and concisely.\nQuestion: " + context + "\nAnswer:";
-  std::string api_result = call_openai_api(prompt, api_key);
-  if (!api_result.empty()) {
-    *result = api_result;
-  } else {
-    std::cerr << "Error: " << api_result << "\n";
-    return 1;
+
+  void deinit() {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (!m_initialized) return;
+    for (CURL* curl : m_idle) curl_easy_cleanup(curl);
+    m_idle.clear();
+    if (m_share != nullptr) curl_share_cleanup(m_share);
+    m_share = nullptr;
+    curl_global_cleanup();
+    m_initialized = false;
   }
 
-  return 0;
+  const std::string& api_key() const { return m_api_key; }
+
+  /**
+    Get a handle set up to post to url and append the reply to response,
+    from the pool if one is idle.
+    @param headers the request headers, kept until the handle is released
+    @param unix_socket the socket to connect over, empty for tcp
+    @return nullptr if no handle could be had
+  */
+  CURL* acquire(const std::string& url, struct curl_slist* headers,
+                const std::string& unix_socket, std::string* response) {
+    CURL* curl = nullptr;
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      if (!m_idle.empty()) {
+        curl = m_idle.back();
+        m_idle.pop_back();
+      }
+    }
+    if (curl != nullptr) {
+      // keeps the live connections and the share
+      curl_easy_reset(curl);
+    } else {
+      curl = curl_easy_init();
+      if (curl == nullptr) return nullptr;
+    }
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    if (!unix_socket.empty()) {
+      curl_easy_setopt(curl, CURLOPT_UNIX_SOCKET_PATH, unix_socket.c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    if (m_share != nullptr) curl_easy_setopt(curl, CURLOPT_SHARE, m_share);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
+    return curl;
+  }
+
+  /// Give a handle back to the pool.
+  void release(CURL* curl) {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      if (m_initialized && m_idle.size() < SEMANTIC_CLIENT_MAX_IDLE_HANDLES) {
+        m_idle.push_back(curl);
+        return;
+      }
+    }
+    curl_easy_cleanup(curl);
+  }
+
+ private:
+  static void lock_share(CURL*, curl_lock_data data, curl_lock_access,
+                         void* client) {
+    static_cast<Semantic_client*>(client)->m_share_mutexes[data].lock();
+  }
+
+  static void unlock_share(CURL*, curl_lock_data data, void* client) {
+    static_cast<Semantic_client*>(client)->m_share_mutexes[data].unlock();
+  }
+
+  std::mutex m_mutex;
+  bool m_initialized = false;
+  std::string m_api_key;
+  CURLSH* m_share = nullptr;
+  std::mutex m_share_mutexes[CURL_LOCK_DATA_LAST];
+  std::vector<CURL*> m_idle;
+};
+
+Semantic_client semantic_client;
+
+/// The client, set up on first use if the server did not do it at start.
+Semantic_client* get_semantic_client() {
+  if (semantic_client.init()) return nullptr;
+  return &semantic_client;
 }
 
-bool semantic_extract_openai(std::string &context, std::string* result) {
-  std::string api_key = get_openai_api_key();
-  if (api_key.empty()) {
-    std::cerr << "Error: OPENAI_API_KEY environment variable is not set.\n";
-    return 1;
+/**
+  The requests in flight on a backend, server wide, bounded by a system
+  variable so that many concurrent queries do not flood a small server.
+*/
+class Semantic_request_slots {
+ public:
+  explicit Semantic_request_slots(const uint* limit) : m_limit(limit) {}
+
+  /// Take a slot if one is free.
+  bool try_acquire() {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (!free()) return false;
+    m_in_flight++;
+    return true;
   }
-  std::string prompt = "Extract the relevant entity/entities according to the given question. Output only the answer in json format, output \"{}\" if no relevant entity found.\nQuestion: " + context + "\nAnswer:";
-  std::string api_result = call_openai_api(prompt, api_key);
-  if (!api_result.empty()) {
-    *result = api_result;
-  } else {
-    std::cerr << "Error: " << api_result << "\n";
-    return 1;
+
+  /// Take a slot, waiting for one to be freed. Returns true if killed
+  /// while waiting.
+  bool acquire(THD* thd) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!free()) {
+      if (thd != nullptr && thd->killed) return true;
+      m_freed.wait_for(lock, std::chrono::milliseconds(100));
+    }
+    m_in_flight++;
+    return false;
   }
 
-  return 0;
+  void release() {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_in_flight--;
+    }
+    m_freed.notify_one();
+  }
+
+ private:
+  bool free() const { return *m_limit == 0 || m_in_flight < *m_limit; }
+
+  const uint* const m_limit;
+  std::mutex m_mutex;
+  std::condition_variable m_freed;
+  size_t m_in_flight = 0;
+};
+
+// Tokens the model read and wrote for a request, 0 if not reported.
+void response_tokens(const json& response_json, ulonglong* tokens_in,
+                     ulonglong* tokens_out) {
+  *tokens_in = 0;
+  *tokens_out = 0;
+  auto usage = response_json.find("usage");
+  if (usage == response_json.end()) return;
+  if (usage->contains("prompt_tokens")) {
+    *tokens_in = (*usage)["prompt_tokens"].get<ulonglong>();
+  }
+  if (usage->contains("completion_tokens")) {
+    *tokens_out = (*usage)["completion_tokens"].get<ulonglong>();
+  } else if (usage->contains("total_tokens")) {
+    const ulonglong total = (*usage)["total_tokens"].get<ulonglong>();
+    *tokens_out = total > *tokens_in ? total - *tokens_in : 0;
+  }
 }
 
-static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
-    ((std::string*)userp)->append((char*)contents, size * nmemb);
-    return size * nmemb;
+// Wall time of a finished request, in microseconds.
+ulonglong request_time(CURL* curl) {
+  curl_off_t microseconds;
+  if (curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &microseconds) !=
+      CURLE_OK) {
+    return 0;
+  }
+  return microseconds;
 }
 
-std::string call_openai_api(const std::string& prompt, const std::string& api_key) {
-    CURL* curl;
-    CURLcode res;
-    std::string readBuffer;
+/**
+  A backend speaking the OpenAI chat completions and embeddings API over
+  http.
+*/
+class Semantic_http_backend : public Semantic_backend {
+ public:
+  explicit Semantic_http_backend(const uint* max_requests)
+      : m_slots(max_requests) {}
+
+  bool complete(const std::string& model,
+                const std::vector<std::string>& prompts, size_t concurrency,
+                std::vector<std::string>* answers,
+                std::vector<Semantic_usage>* usage) override;
+
+  bool embed(const std::string& model, const std::vector<std::string>& texts,
+             std::vector<std::vector<float>>* embeddings,
+             std::vector<Semantic_usage>* usage) override;
+
+  bool embed_images(const std::string& model,
+                    const std::vector<std::string>& images,
+                    std::vector<std::vector<float>>* embeddings,
+                    std::vector<Semantic_usage>* usage) override;
+
+ protected:
+  /// Base URL of the API, e.g. https://api.openai.com/v1.
+  virtual std::string base_url() const = 0;
+
+  /// The unix socket to connect over, empty for tcp.
+  virtual std::string unix_socket() const { return ""; }
+
+  /// The api key to send, empty for none.
+  virtual std::string api_key(Semantic_client*) const { return ""; }
 
+  /// Report why no request can be sent, if so.
+  virtual bool unavailable(Semantic_client*) const { return false; }
+
+ private:
+  /// Headers of a request; the caller frees them.
+  struct curl_slist* headers(Semantic_client* client) const {
+    const std::string key = api_key(client);
+    struct curl_slist* list =
+        curl_slist_append(nullptr, "Content-Type: application/json");
+    if (!key.empty()) {
+      list = curl_slist_append(list, ("Authorization: Bearer " + key).c_str());
+    }
+    return list;
+  }
+
+  /**
+    Post inputs to the embeddings API, max_batch to a request. modality is
+    sent along unless it is nullptr.
+  */
+  bool post_embeddings(const std::string& model,
+                       const std::vector<std::string>& inputs,
+                       const char* modality, size_t max_batch,
+                       std::vector<std::vector<float>>* embeddings,
+                       std::vector<Semantic_usage>* usage);
+
+  Semantic_request_slots m_slots;
+};
+
+bool Semantic_http_backend::complete(const std::string& model,
+                                     const std::vector<std::string>& prompts,
+                                     size_t concurrency,
+                                     std::vector<std::string>* answers,
+                                     std::vector<Semantic_usage>* usage) {
+  answers->assign(prompts.size(), std::string());
+  usage->assign(prompts.size(), Semantic_usage());
+  Semantic_client* client = get_semantic_client();
+  if (client == nullptr || unavailable(client)) return true;
+  if (concurrency == 0) concurrency = 1;
+  THD* thd = current_thd;
+
+  struct Request {
+    CURL* curl = nullptr;
+    std::string payload;
+    std::string response;
+    int attempts = 0;
+    // since when it waits to be sent
+    ulonglong queued_at = 0;
+  };
+  std::vector<Request> requests(prompts.size());
+  const ulonglong begin = my_micro_time();
+  for (Request &request : requests) request.queued_at = begin;
+
+  CURLM* multi = curl_multi_init();
+  if (multi == nullptr) return true;
+  curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+  struct curl_slist* request_headers = headers(client);
+  const std::string url = base_url() + "/chat/completions";
+  const std::string socket = unix_socket();
+
+  // start the request for prompts[i] in a slot taken for it; its answer is
+  // left empty if that fails
+  size_t in_flight = 0;
+  auto start = [&](size_t i) {
+    Request &request = requests[i];
+    request.response.clear();
+    (*usage)[i].queue_time += my_micro_time() - request.queued_at;
+    CURL* curl = client->acquire(url, request_headers, socket, &request.response);
+    if (curl == nullptr) {
+      m_slots.release();
+      return;
+    }
     json payload = {
-        {"model", "gpt-4"},
+        {"model", model},
         {"messages", {
-            {{"role", "user"}, {"content", prompt}}
+            {{"role", "user"}, {"content", prompts[i]}}
         }}
     };
+    request.payload = payload.dump();
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request.payload.c_str());
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, reinterpret_cast<char*>(i));
+    if (curl_multi_add_handle(multi, curl) != CURLM_OK) {
+      client->release(curl);
+      m_slots.release();
+      return;
+    }
+    request.curl = curl;
+    in_flight++;
+  };
 
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
-    if (curl) {
-        struct curl_slist* headers = NULL;
-        headers = curl_slist_append(headers, ("Authorization: Bearer " + api_key).c_str());
-        headers = curl_slist_append(headers, "Content-Type: application/json");
-
-        curl_easy_setopt(curl, CURLOPT_URL, "https://api.openai.com/v1/chat/completions");
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+  // keep the pipe full, as far as admission control and the backend's slots
+  // allow; with nothing in flight, wait for both
+  std::deque<size_t> pending;
+  for (size_t i = 0; i < prompts.size(); i++) pending.push_back(i);
+  bool killed = false;
+  long wait_ms = 1000;
+  const char *prev_proc_info = thd ? thd->proc_info() : nullptr;
+  auto start_more = [&] {
+    wait_ms = 1000;
+    while (!pending.empty() && in_flight < concurrency) {
+      if (in_flight == 0) {
+        if (multi_tenancy_admit_semantic_request(thd) || m_slots.acquire(thd)) {
+          killed = true;
+          break;
+        }
+        if (thd) THD_STAGE_INFO(thd, stage_waiting_for_semantic_model);
+      } else {
+        if (!m_slots.try_acquire()) break;
+        const ulonglong wait_us = multi_tenancy_try_semantic_request(thd);
+        if (wait_us != 0) {
+          m_slots.release();
+          wait_ms = std::min<long>(wait_ms, wait_us / 1000 + 1);
+          break;
+        }
+      }
+      start(pending.front());
+      pending.pop_front();
+    }
+  };
+  start_more();
 
-        std::string payload_str = payload.dump();
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload_str.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+  while (in_flight > 0 && !killed) {
+    int running;
+    if (curl_multi_perform(multi, &running) != CURLM_OK) break;
 
-        res = curl_easy_perform(curl);
-        if (res != CURLE_OK) {
-            std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << "\n";
+    int queued;
+    while (CURLMsg* msg = curl_multi_info_read(multi, &queued)) {
+      if (msg->msg != CURLMSG_DONE) continue;
+      CURL* curl = msg->easy_handle;
+      char* private_data;
+      curl_easy_getinfo(curl, CURLINFO_PRIVATE, &private_data);
+      const size_t i = reinterpret_cast<size_t>(private_data);
+      Request &request = requests[i];
+      const ulonglong microseconds = request_time(curl);
+      (*usage)[i].requests++;
+      (*usage)[i].request_time += microseconds;
+      if (msg->data.result != CURLE_OK) {
+        std::cerr << "curl request failed: " << curl_easy_strerror(msg->data.result) << "\n";
+      } else if (too_many_requests(curl) &&
+                 request.attempts < SEMANTIC_MAX_RETRIES) {
+        // queue it again, and have everyone hold off for a while
+        multi_tenancy_throttle_semantic_requests(
+            retry_backoff_us(request.attempts++));
+        request.queued_at = my_micro_time();
+        pending.push_back(i);
+      } else {
+        // feed the wall time of the chat completion to the optimizer
+        semantic_stats_record_latency(microseconds / 1000.0);
+        try {
+          auto response_json = json::parse(request.response);
+          (*answers)[i] = response_json["choices"][0]["message"]["content"];
+          response_tokens(response_json, &(*usage)[i].tokens_in,
+                          &(*usage)[i].tokens_out);
+        } catch (...) {
+          std::cerr << "Failed to parse response.\n";
         }
+      }
+      curl_multi_remove_handle(multi, curl);
+      client->release(curl);
+      m_slots.release();
+      request.curl = nullptr;
+      in_flight--;
+      start_more();
+    }
 
-        curl_easy_cleanup(curl);
-        curl_slist_free_all(headers);
+    if (thd != nullptr && thd->killed) break;
+    if (in_flight > 0 &&
+        curl_multi_wait(multi, nullptr, 0, wait_ms, nullptr) != CURLM_OK) {
+      break;
     }
-    curl_global_cleanup();
+    start_more();
+  }
+
+  // only left over if the multi handle failed or the query was killed
+  for (Request &request : requests) {
+    if (request.curl == nullptr) continue;
+    curl_multi_remove_handle(multi, request.curl);
+    client->release(request.curl);
+    m_slots.release();
+  }
+  curl_multi_cleanup(multi);
+  curl_slist_free_all(request_headers);
+  if (thd) thd->set_proc_info(prev_proc_info);
+  return false;
+}
+
+bool Semantic_http_backend::embed(const std::string& model,
+                                  const std::vector<std::string>& texts,
+                                  std::vector<std::vector<float>>* embeddings,
+                                  std::vector<Semantic_usage>* usage) {
+  return post_embeddings(model, texts, nullptr, SEMANTIC_EMBED_MAX_BATCH,
+                         embeddings, usage);
+}
+
+// The media type of an image file, by its magic number.
+const char* image_media_type(const std::string& image) {
+  if (image.compare(0, 8, "\x89PNG\r\n\x1a\n") == 0) return "image/png";
+  if (image.compare(0, 3, "\xff\xd8\xff") == 0) return "image/jpeg";
+  if (image.compare(0, 4, "GIF8") == 0) return "image/gif";
+  if (image.size() >= 12 && image.compare(0, 4, "RIFF") == 0 &&
+      image.compare(8, 4, "WEBP") == 0) {
+    return "image/webp";
+  }
+  return "application/octet-stream";
+}
+
+bool Semantic_http_backend::embed_images(
+    const std::string& model, const std::vector<std::string>& images,
+    std::vector<std::vector<float>>* embeddings,
+    std::vector<Semantic_usage>* usage) {
+  std::vector<std::string> urls;
+  urls.reserve(images.size());
+  for (const std::string& image : images) {
+    std::string url = "data:";
+    url += image_media_type(image);
+    url += ";base64,";
+    const size_t prefix = url.size();
+    // the encoded length counts a terminating 0, and base64_encode() wraps
+    // its lines at 76 characters, which a data url must not have
+    url.resize(prefix + base64_needed_encoded_length(image.size()));
+    base64_encode(image.data(), image.size(), &url[prefix]);
+    url.erase(std::remove(url.begin() + prefix, url.end(), '\n'), url.end());
+    url.pop_back();
+    urls.push_back(std::move(url));
+  }
+  return post_embeddings(model, urls, "image", SEMANTIC_EMBED_IMAGE_MAX_BATCH,
+                         embeddings, usage);
+}
+
+bool Semantic_http_backend::post_embeddings(
+    const std::string& model, const std::vector<std::string>& texts,
+    const char* modality, size_t max_batch,
+    std::vector<std::vector<float>>* embeddings,
+    std::vector<Semantic_usage>* usage) {
+  embeddings->assign(texts.size(), std::vector<float>());
+  usage->assign(texts.size(), Semantic_usage());
+  Semantic_client* client = get_semantic_client();
+  if (client == nullptr || unavailable(client)) return true;
+  THD* thd = current_thd;
+  const char *prev_proc_info = thd ? thd->proc_info() : nullptr;
 
-    // Parse response
-    auto response_json = json::parse(readBuffer);
+  struct curl_slist* request_headers = headers(client);
+  const std::string url = base_url() + "/embeddings";
+  const std::string socket = unix_socket();
+
+  for (size_t first = 0; first < texts.size(); first += max_batch) {
+    const size_t count = std::min(max_batch, texts.size() - first);
+    json input = json::array();
+    for (size_t j = 0; j < count; j++) input.push_back(texts[first + j]);
+    json payload = {
+        {"model", model},
+        {"input", input}
+    };
+    if (modality != nullptr) payload["modality"] = modality;
+    std::string payload_str = payload.dump();
+
+    std::string readBuffer;
+    CURLcode res = CURLE_FAILED_INIT;
+    // the batch is accounted to its first text
+    Semantic_usage &batch_usage = (*usage)[first];
+    for (int attempt = 0;; attempt++) {
+      const ulonglong queued_at = my_micro_time();
+      if (multi_tenancy_admit_semantic_request(thd) || m_slots.acquire(thd)) {
+        // killed; the embeddings of the rest are left empty
+        curl_slist_free_all(request_headers);
+        if (thd) thd->set_proc_info(prev_proc_info);
+        return false;
+      }
+      batch_usage.queue_time += my_micro_time() - queued_at;
+      if (thd) THD_STAGE_INFO(thd, stage_waiting_for_semantic_model);
+      readBuffer.clear();
+      CURL* curl = client->acquire(url, request_headers, socket, &readBuffer);
+      if (curl == nullptr) {
+        m_slots.release();
+        break;
+      }
+      curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload_str.c_str());
+      res = curl_easy_perform(curl);
+      batch_usage.requests++;
+      batch_usage.request_time += request_time(curl);
+      const bool retry = res == CURLE_OK && too_many_requests(curl) &&
+                         attempt < SEMANTIC_MAX_RETRIES;
+      client->release(curl);
+      m_slots.release();
+      if (!retry) break;
+      multi_tenancy_throttle_semantic_requests(retry_backoff_us(attempt));
+    }
+    if (res != CURLE_OK) {
+      std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << "\n";
+      continue;
+    }
+
+    // Parse response; each embedding says which input it belongs to
     try {
-        return response_json["choices"][0]["message"]["content"];
+      auto response_json = json::parse(readBuffer);
+      ulonglong tokens_in;
+      ulonglong tokens_out;
+      response_tokens(response_json, &tokens_in, &tokens_out);
+      for (const auto& data : response_json["data"]) {
+        const size_t j = data["index"].get<size_t>();
+        if (j >= count) continue;
+        std::vector<float>& embedding = (*embeddings)[first + j];
+        embedding.clear();
+        embedding.reserve(data["embedding"].size());
+        for (const auto& val : data["embedding"]) {
+          embedding.push_back(val.get<float>());
+        }
+        (*usage)[first + j].tokens_in = tokens_in / count;
+        (*usage)[first + j].tokens_out = tokens_out / count;
+      }
     } catch (...) {
-        return "Failed to parse response.";
+      std::cerr << "Failed to parse embedding response.\n";
     }
+  }
+  curl_slist_free_all(request_headers);
+  if (thd) thd->set_proc_info(prev_proc_info);
+  return false;
 }
 
-bool semantic_embed_openai(const std::string &text, std::vector<float>* result) {
-  std::string api_key = get_openai_api_key();
-  if (api_key.empty()) {
+/** The OpenAI API. */
+class Semantic_openai_backend final : public Semantic_http_backend {
+ public:
+  Semantic_openai_backend()
+      : Semantic_http_backend(&semantic_openai_max_requests) {}
+
+ protected:
+  std::string base_url() const override { return "https://api.openai.com/v1"; }
+
+  std::string api_key(Semantic_client* client) const override {
+    return client->api_key();
+  }
+
+  bool unavailable(Semantic_client* client) const override {
+    if (!client->api_key().empty()) return false;
     std::cerr << "Error: OPENAI_API_KEY environment variable is not set.\n";
     return true;
   }
+};
 
-  CURL* curl;
-  CURLcode res;
-  std::string readBuffer;
+/** An OpenAI compatible server run next to the database, e.g. vLLM. */
+class Semantic_local_backend final : public Semantic_http_backend {
+ public:
+  Semantic_local_backend()
+      : Semantic_http_backend(&semantic_local_max_requests) {}
 
-  json payload = {
-      {"model", "text-embedding-3-small"},
-      {"input", text}
-  };
+ protected:
+  std::string base_url() const override {
+    std::string url = read_sysvar(&semantic_local_url);
+    while (!url.empty() && url.back() == '/') url.pop_back();
+    return url;
+  }
 
-  curl_global_init(CURL_GLOBAL_DEFAULT);
-  curl = curl_easy_init();
-  if (curl) {
-      struct curl_slist* headers = NULL;
-      headers = curl_slist_append(headers, ("Authorization: Bearer " + api_key).c_str());
-      headers = curl_slist_append(headers, "Content-Type: application/json");
+  std::string unix_socket() const override {
+    return read_sysvar(&semantic_local_socket);
+  }
+};
 
-      curl_easy_setopt(curl, CURLOPT_URL, "https://api.openai.com/v1/embeddings");
-      curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+Semantic_openai_backend openai_backend;
+Semantic_local_backend local_backend;
 
-      std::string payload_str = payload.dump();
-      curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload_str.c_str());
-      curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-      curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+std::mutex backends_mutex;
+std::map<std::string, Semantic_backend*, std::less<>> backends = {
+    {"openai", &openai_backend}, {"local", &local_backend}};
 
-      res = curl_easy_perform(curl);
-      if (res != CURLE_OK) {
-          std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << "\n";
-          curl_easy_cleanup(curl);
-          curl_slist_free_all(headers);
-          curl_global_cleanup();
-          return true;
-      }
+/// A model of the semantic operators, as resolved from its system variable.
+struct Semantic_model {
+  Semantic_backend* backend;
+  /// The full "<backend>:<model>" name, telling cached responses apart.
+  std::string name;
+  /// The model name within the backend.
+  std::string model;
+};
 
-      curl_easy_cleanup(curl);
-      curl_slist_free_all(headers);
+// Resolve the model a system variable names.
+bool semantic_model(char *const *var, Semantic_model* model) {
+  model->name = read_sysvar(var);
+  model->backend = semantic_backend_find(model->name, &model->model);
+  if (model->backend == nullptr) {
+    std::cerr << "Error: unknown semantic backend of model " << model->name << "\n";
+    return true;
   }
-  curl_global_cleanup();
+  return false;
+}
+
+/// Names of the operators, which also tell their cached responses apart.
+const char *const semantic_op_names[SEMANTIC_OP_END] = {
+    "semantic_filter", "semantic_map", "semantic_extract", "semantic_embed"};
 
-  // Parse response
-  try {
-    auto response_json = json::parse(readBuffer);
-    auto embedding = response_json["data"][0]["embedding"];
-    result->clear();
-    result->reserve(embedding.size());
-    for (const auto& val : embedding) {
-      result->push_back(val.get<float>());
+// Where a helper thread keeps what its calls cost, as the status of its
+// session is only updated by the session's own thread.
+thread_local std::vector<Semantic_charge> *deferred_charges = nullptr;
+
+// Charge what answering calls values of an operator cost to the session,
+// whose status variables add up per user and server wide.
+void account(enum_semantic_op op, size_t calls, size_t cache_hits,
+             size_t failures, const std::vector<Semantic_usage>& usage) {
+  if (deferred_charges != nullptr) {
+    deferred_charges->push_back({op, calls, cache_hits, failures, usage});
+    return;
+  }
+  THD* thd = current_thd;
+  if (thd == nullptr) return;
+  System_status_var &status = thd->status_var;
+  status.semantic_calls[op] += calls;
+  status.semantic_cache_hits[op] += cache_hits;
+  status.semantic_failures[op] += failures;
+  for (const Semantic_usage& cost : usage) {
+    status.semantic_tokens_in[op] += cost.tokens_in;
+    status.semantic_tokens_out[op] += cost.tokens_out;
+    status.semantic_queue_time[op] += cost.queue_time;
+    if (cost.requests == 0) continue;
+    status.semantic_requests[op] += cost.requests;
+    status.semantic_request_time[op] += cost.request_time;
+    // retries of a value are binned by their average
+    status.semantic_request_latency[op][semantic_latency_bucket(
+        cost.request_time / cost.requests)] += cost.requests;
+  }
+}
+
+// Have a model complete prompts, from the cache where it answered before,
+// keeping up to concurrency requests in flight. (*answers)[i] is left empty
+// where no answer could be had. Returns true if no request could be made at
+// all.
+bool complete_prompts(enum_semantic_op op, char *const *model_var,
+                      const std::vector<std::string>& prompts,
+                      size_t concurrency, std::vector<std::string>* answers) {
+  const Malloc_arena_scope arena_scope(MALLOC_ARENA_SEMANTIC);
+  answers->assign(prompts.size(), std::string());
+  Semantic_model model;
+  if (semantic_model(model_var, &model)) {
+    account(op, prompts.size(), 0, prompts.size(), {});
+    return true;
+  }
+
+  // answer what we can from the cache, and only send the rest
+  const char *op_name = semantic_op_names[op];
+  std::vector<size_t> to_send;
+  std::vector<std::string> to_complete;
+  for (size_t i = 0; i < prompts.size(); i++) {
+    if (!semantic_cache_lookup(op_name, model.name, prompts[i],
+                               &(*answers)[i])) {
+      to_send.push_back(i);
+      to_complete.push_back(prompts[i]);
     }
+  }
+  const size_t cache_hits = prompts.size() - to_send.size();
+  if (to_send.empty()) {
+    account(op, prompts.size(), cache_hits, 0, {});
     return false;
-  } catch (...) {
-    std::cerr << "Failed to parse embedding response.\n";
+  }
+
+  std::vector<std::string> sent_answers;
+  std::vector<Semantic_usage> usage;
+  if (model.backend->complete(model.model, to_complete, concurrency,
+                              &sent_answers, &usage)) {
+    account(op, prompts.size(), cache_hits, to_send.size(), usage);
     return true;
   }
+  size_t failures = 0;
+  for (size_t j = 0; j < to_send.size(); j++) {
+    if (sent_answers[j].empty()) {
+      failures++;
+      continue;
+    }
+    semantic_cache_store(op_name, model.name, to_complete[j], sent_answers[j],
+                         usage[j].tokens());
+    (*answers)[to_send[j]] = std::move(sent_answers[j]);
+  }
+  account(op, prompts.size(), cache_hits, failures, usage);
+  return false;
 }
 
-std::string get_openai_api_key() {
-    const char* key = std::getenv("OPENAI_API_KEY");
-    return key ? std::string(key) : "";
-}
\ No newline at end of file
+// Have a model complete one prompt, from the cache if it answered before.
+// The answer is empty if none could be had.
+std::string complete_prompt(enum_semantic_op op, char *const *model_var,
+                            const std::string& prompt) {
+  std::vector<std::string> answers;
+  if (complete_prompts(op, model_var, {prompt}, 1, &answers)) return "";
+  return answers[0];
+}
+
+std::string semantic_map_prompt(const std::string &context) {
+  return "Answer the following question. Provide only the answer directly and concisely.\nQuestion: " + context + "\nAnswer:";
+}
+
+std::string semantic_extract_prompt(const std::string &context) {
+  return "Extract the relevant entity/entities according to the given question. Output only the answer in json format, output \"{}\" if no relevant entity found.\nQuestion: " + context + "\nAnswer:";
+}
+
+// Answer many map or extract contexts with the prompt built by make_prompt.
+bool complete_contexts(enum_semantic_op op, char *const *model_var,
+                       std::string (*make_prompt)(const std::string &),
+                       const std::vector<std::string> &contexts,
+                       size_t concurrency, std::vector<std::string> *results) {
+  std::vector<std::string> prompts;
+  prompts.reserve(contexts.size());
+  for (const std::string &context : contexts) {
+    prompts.push_back(make_prompt(context));
+  }
+  return complete_prompts(op, model_var, prompts, concurrency, results);
+}
+
+}  // namespace
+
+bool semantic_backend_register(const std::string &name,
+                               Semantic_backend *backend) {
+  std::lock_guard<std::mutex> guard(backends_mutex);
+  return !backends.emplace(name, backend).second;
+}
+
+void semantic_backend_unregister(const std::string &name) {
+  std::lock_guard<std::mutex> guard(backends_mutex);
+  backends.erase(name);
+}
+
+Semantic_backend *semantic_backend_find(const std::string &name,
+                                        std::string *model) {
+  std::string_view backend_name = "openai";
+  const size_t colon = name.find(':');
+  if (colon != std::string::npos) {
+    backend_name = std::string_view(name).substr(0, colon);
+    *model = name.substr(colon + 1);
+  } else {
+    *model = name;
+  }
+  std::lock_guard<std::mutex> guard(backends_mutex);
+  auto it = backends.find(backend_name);
+  return it != backends.end() ? it->second : nullptr;
+}
+
+void semantic_client_init() { semantic_client.init(); }
+
+void semantic_client_deinit() { semantic_client.deinit(); }
+
+bool semantic_filter_openai(std::string &context, bool* result) {
+  std::string prompt = semantic_filter_prompt(context);
+  std::string api_result =
+      complete_prompt(SEMANTIC_OP_FILTER, &semantic_filter_model, prompt);
+  return parse_semantic_filter_answer(api_result, result);
+}
+
+bool semantic_map_openai(const std::string &context, std::string* result) {
+  std::string prompt = semantic_map_prompt(context);
+  std::string api_result =
+      complete_prompt(SEMANTIC_OP_MAP, &semantic_map_model, prompt);
+  if (!api_result.empty()) {
+    *result = api_result;
+  } else {
+    std::cerr << "Error: no answer to semantic_map\n";
+    return 1;
+  }
+
+  return 0;
+}
+
+bool semantic_extract_openai(const std::string &context, std::string* result) {
+  std::string prompt = semantic_extract_prompt(context);
+  std::string api_result =
+      complete_prompt(SEMANTIC_OP_EXTRACT, &semantic_extract_model, prompt);
+  if (!api_result.empty()) {
+    *result = api_result;
+  } else {
+    std::cerr << "Error: no answer to semantic_extract\n";
+    return 1;
+  }
+
+  return 0;
+}
+
+bool semantic_map_openai_batch(const std::vector<std::string> &contexts,
+                               size_t concurrency,
+                               std::vector<std::string> *results) {
+  return complete_contexts(SEMANTIC_OP_MAP, &semantic_map_model,
+                           semantic_map_prompt, contexts, concurrency, results);
+}
+
+bool semantic_extract_openai_batch(const std::vector<std::string> &contexts,
+                                   size_t concurrency,
+                                   std::vector<std::string> *results) {
+  return complete_contexts(SEMANTIC_OP_EXTRACT, &semantic_extract_model,
+                           semantic_extract_prompt, contexts, concurrency,
+                           results);
+}
+
+bool semantic_filter_openai_batch(const std::vector<std::string> &contexts,
+                                  size_t concurrency,
+                                  std::vector<int> *results) {
+  results->assign(contexts.size(), -1);
+  Semantic_model model;
+  if (semantic_model(&semantic_filter_model, &model)) {
+    account(SEMANTIC_OP_FILTER, contexts.size(), 0, contexts.size(), {});
+    return 1;
+  }
+
+  // answer what we can from the cache, and only send the rest
+  const char *op_name = semantic_op_names[SEMANTIC_OP_FILTER];
+  std::vector<size_t> to_send;
+  std::vector<std::string> prompts;
+  for (size_t i = 0; i < contexts.size(); i++) {
+    std::string prompt = semantic_filter_prompt(contexts[i]);
+    std::string answer;
+    bool result;
+    if (semantic_cache_lookup(op_name, model.name, prompt, &answer) &&
+        !parse_semantic_filter_answer(answer, &result)) {
+      (*results)[i] = result ? 1 : 0;
+    } else {
+      to_send.push_back(i);
+      prompts.push_back(std::move(prompt));
+    }
+  }
+  const size_t cache_hits = contexts.size() - to_send.size();
+  if (to_send.empty()) {
+    account(SEMANTIC_OP_FILTER, contexts.size(), cache_hits, 0, {});
+    return 0;
+  }
+
+  std::vector<std::string> answers;
+  std::vector<Semantic_usage> usage;
+  if (model.backend->complete(model.model, prompts, concurrency, &answers,
+                              &usage)) {
+    account(SEMANTIC_OP_FILTER, contexts.size(), cache_hits, to_send.size(),
+            usage);
+    return 1;
+  }
+  size_t failures = 0;
+  for (size_t j = 0; j < to_send.size(); j++) {
+    bool result;
+    if (answers[j].empty() || parse_semantic_filter_answer(answers[j], &result)) {
+      failures++;
+      continue;
+    }
+    (*results)[to_send[j]] = result ? 1 : 0;
+    semantic_cache_store(op_name, model.name, prompts[j], answers[j],
+                         usage[j].tokens());
+  }
+  account(SEMANTIC_OP_FILTER, contexts.size(), cache_hits, failures, usage);
+  return 0;
+}
+
+// Embeddings are cached as their raw floats.
+static std::string embedding_to_string(const std::vector<float>& embedding) {
+  return std::string(reinterpret_cast<const char*>(embedding.data()),
+                     embedding.size() * sizeof(float));
+}
+
+static void embedding_from_string(const std::string& str, std::vector<float>* embedding) {
+  embedding->resize(str.size() / sizeof(float));
+  memcpy(embedding->data(), str.data(), embedding->size() * sizeof(float));
+}
+
+bool semantic_embed_openai(const std::string &text, std::vector<float>* result) {
+  std::vector<std::vector<float>> results;
+  if (semantic_embed_openai_batch({text}, &results) || results[0].empty()) {
+    return true;
+  }
+  *result = std::move(results[0]);
+  return false;
+}
+
+bool semantic_embed_openai_batch(const std::vector<std::string> &texts,
+                                 std::vector<std::vector<float>> *results) {
+  const Malloc_arena_scope arena_scope(MALLOC_ARENA_SEMANTIC);
+  results->assign(texts.size(), std::vector<float>());
+  Semantic_model model;
+  if (semantic_model(&semantic_embed_model, &model)) {
+    account(SEMANTIC_OP_EMBED, texts.size(), 0, texts.size(), {});
+    return true;
+  }
+
+  // answer what we can from the cache, and only send the rest
+  const char *op_name = semantic_op_names[SEMANTIC_OP_EMBED];
+  std::vector<size_t> to_send;
+  std::vector<std::string> to_embed;
+  for (size_t i = 0; i < texts.size(); i++) {
+    std::string cached;
+    if (semantic_cache_lookup(op_name, model.name, texts[i], &cached)) {
+      embedding_from_string(cached, &(*results)[i]);
+    } else {
+      to_send.push_back(i);
+      to_embed.push_back(texts[i]);
+    }
+  }
+  const size_t cache_hits = texts.size() - to_send.size();
+  if (to_send.empty()) {
+    account(SEMANTIC_OP_EMBED, texts.size(), cache_hits, 0, {});
+    return false;
+  }
+
+  std::vector<std::vector<float>> embeddings;
+  std::vector<Semantic_usage> usage;
+  if (model.backend->embed(model.model, to_embed, &embeddings, &usage)) {
+    account(SEMANTIC_OP_EMBED, texts.size(), cache_hits, to_send.size(),
+            usage);
+    return true;
+  }
+  size_t failures = 0;
+  for (size_t j = 0; j < to_send.size(); j++) {
+    if (embeddings[j].empty()) {
+      failures++;
+      continue;
+    }
+    semantic_cache_store(op_name, model.name, to_embed[j],
+                         embedding_to_string(embeddings[j]),
+                         usage[j].tokens());
+    (*results)[to_send[j]] = std::move(embeddings[j]);
+  }
+  account(SEMANTIC_OP_EMBED, texts.size(), cache_hits, failures, usage);
+  return false;
+}
+
+Semantic_filter_prefetch::Semantic_filter_prefetch() = default;
+
+Semantic_filter_prefetch::~Semantic_filter_prefetch() { join(); }
+
+void Semantic_filter_prefetch::start(THD *thd,
+                                     std::vector<std::string> contexts,
+                                     size_t concurrency,
+                                     std::vector<std::string> texts) {
+  assert(!m_threaded);
+  m_thd = thd;
+  m_contexts = std::move(contexts);
+  m_concurrency = concurrency;
+  m_texts = std::move(texts);
+  m_answers.clear();
+  m_embeddings.clear();
+  if (m_contexts.empty() && m_texts.empty()) return;
+  m_threaded = mysql_thread_create(key_thread_semantic_prefetch, &m_thread,
+                                   &connection_attrib, run, this) == 0;
+}
+
+void *Semantic_filter_prefetch::run(void *arg) {
+  my_thread_init();
+  Semantic_filter_prefetch *prefetch =
+      static_cast<Semantic_filter_prefetch *>(arg);
+  // the backends look for the session to admit and to stop when killed
+  current_thd = prefetch->m_thd;
+  deferred_charges = &prefetch->m_charges;
+  prefetch->ask();
+  deferred_charges = nullptr;
+  current_thd = nullptr;
+  my_thread_end();
+  return nullptr;
+}
+
+void Semantic_filter_prefetch::ask() {
+  if (!m_contexts.empty()) {
+    semantic_filter_openai_batch(m_contexts, m_concurrency, &m_answers);
+  }
+  if (!m_texts.empty()) semantic_embed_openai_batch(m_texts, &m_embeddings);
+  m_contexts.clear();
+  m_texts.clear();
+}
+
+void Semantic_filter_prefetch::join() {
+  if (!m_threaded) return;
+  my_thread_join(&m_thread, nullptr);
+  m_threaded = false;
+  for (const Semantic_charge &charge : m_charges) {
+    account(charge.op, charge.calls, charge.cache_hits, charge.failures,
+            charge.usage);
+  }
+  m_charges.clear();
+}
+
+void Semantic_filter_prefetch::wait(
+    std::vector<int> *answers, std::vector<std::vector<float>> *embeddings) {
+  if (m_threaded) {
+    join();
+  } else {
+    ask();
+  }
+  *answers = std::move(m_answers);
+  *embeddings = std::move(m_embeddings);
+  m_answers.clear();
+  m_embeddings.clear();
+}
+
+size_t semantic_dedup_find(
+    const std::vector<std::vector<float>> &representatives,
+    const std::vector<float> &embedding, double threshold) {
+  for (size_t i = 0; i < representatives.size(); i++) {
+    if (representatives[i].size() == embedding.size() &&
+        fb_vector_cosine(representatives[i].data(), embedding.data(),
+                         embedding.size()) >= threshold) {
+      return i;
+    }
+  }
+  return representatives.size();
+}
+
+void semantic_dedup(const std::vector<std::string> &texts, double threshold,
+                    std::vector<size_t> *representatives) {
+  representatives->resize(texts.size());
+  for (size_t i = 0; i < texts.size(); i++) (*representatives)[i] = i;
+  std::vector<std::vector<float>> embeddings;
+  if (texts.size() < 2 || semantic_embed_openai_batch(texts, &embeddings)) {
+    return;
+  }
+
+  std::vector<std::vector<float>> groups;
+  std::vector<size_t> group_text;
+  for (size_t i = 0; i < texts.size(); i++) {
+    if (embeddings[i].empty()) continue;
+    const size_t group = semantic_dedup_find(groups, embeddings[i], threshold);
+    if (group < groups.size()) {
+      (*representatives)[i] = group_text[group];
+    } else if (groups.size() < SEMANTIC_DEDUP_MAX_REPRESENTATIVES) {
+      groups.push_back(std::move(embeddings[i]));
+      group_text.push_back(i);
+    }
+  }
+}
+
+bool semantic_embed_image_batch(const std::vector<std::string> &images,
+                                std::vector<std::vector<float>> *results) {
+  const Malloc_arena_scope arena_scope(MALLOC_ARENA_SEMANTIC);
+  results->assign(images.size(), std::vector<float>());
+  Semantic_model model;
+  if (semantic_model(&semantic_embed_image_model, &model)) {
+    account(SEMANTIC_OP_EMBED, images.size(), 0, images.size(), {});
+    return true;
+  }
+
+  // images are not cached, a cache key would hold the whole image
+  std::vector<Semantic_usage> usage;
+  if (model.backend->embed_images(model.model, images, results, &usage)) {
+    std::cerr << "Error: semantic backend of model " << model.name
+              << " cannot embed images\n";
+    account(SEMANTIC_OP_EMBED, images.size(), 0, images.size(), usage);
+    return true;
+  }
+  const size_t failures =
+      std::count_if(results->begin(), results->end(),
+                    [](const std::vector<float> &e) { return e.empty(); });
+  account(SEMANTIC_OP_EMBED, images.size(), 0, failures, usage);
+  return false;
+}
@@ -19,6 +19,7 @@
 #include <string>
 #include <vector>
 #include "lex_string.h"
+#include "my_thread.h"
 #include "sql-common/json_dom.h"
 #include "sql_const.h"
 
@@ -29,14 +30,113 @@ constexpr bool SEMANTICDB_ENABLED = false;
 #endif
 
 class Field;
+class THD;
+struct Semantic_charge;
+
+// Set up the process wide client of the model service at server start, and
+// tear it down at shutdown. Without semantic_client_init() the client is set
+// up by the first request.
+void semantic_client_init();
+void semantic_client_deinit();
 
 // Parse field containing blob values into data_view in data
 bool parse_string_from_blob(Field *field, std::string &data);
 
 bool semantic_filter_openai(std::string &context, bool* result);
 
-bool semantic_map_openai(std::string &context, std::string* result);
+// Answer many semantic filter contexts, keeping up to concurrency requests
+// in flight at a time. (*results)[i] is 1 or 0 for the answer to
+// contexts[i], or -1 if none could be had. Returns true if no request could
+// be made at all.
+bool semantic_filter_openai_batch(const std::vector<std::string> &contexts,
+                                  size_t concurrency,
+                                  std::vector<int> *results);
+
+bool semantic_map_openai(const std::string &context, std::string* result);
+
+bool semantic_extract_openai(const std::string &context, std::string* result);
+
+// Answer many semantic map or extract contexts, keeping up to concurrency
+// requests in flight at a time. (*results)[i] is left empty where no answer
+// to contexts[i] could be had. Returns true if no request could be made at
+// all.
+bool semantic_map_openai_batch(const std::vector<std::string> &contexts,
+                               size_t concurrency,
+                               std::vector<std::string> *results);
+bool semantic_extract_openai_batch(const std::vector<std::string> &contexts,
+                                   size_t concurrency,
+                                   std::vector<std::string> *results);
+
+bool semantic_embed_openai(const std::string &text, std::vector<float>* result);
+
+// Embed many texts with as few requests as possible. (*results)[i] is left
+// empty where texts[i] could not be embedded. Returns true if no request
+// could be made at all.
+bool semantic_embed_openai_batch(const std::vector<std::string> &texts,
+                                 std::vector<std::vector<float>> *results);
+
+// Answer a batch of semantic filter contexts and embed a batch of texts on a
+// thread of their own, so that the session goes on meanwhile, e.g. reading
+// the rows of its next batch. The requests are admitted and killed as the
+// session's, and charged to it once waited for.
+class Semantic_filter_prefetch {
+ public:
+  Semantic_filter_prefetch();
+  ~Semantic_filter_prefetch();
+
+  Semantic_filter_prefetch(const Semantic_filter_prefetch &) = delete;
+  Semantic_filter_prefetch &operator=(const Semantic_filter_prefetch &) =
+      delete;
+
+  // Start asking for thd. Without a thread, the model is asked by wait().
+  void start(THD *thd, std::vector<std::string> contexts, size_t concurrency,
+             std::vector<std::string> texts);
+
+  // Wait for the answers and embeddings, as semantic_filter_openai_batch()
+  // and semantic_embed_openai_batch() give them; empty for what was not
+  // asked.
+  void wait(std::vector<int> *answers,
+            std::vector<std::vector<float>> *embeddings);
+
+ private:
+  static void *run(void *arg);
+  void ask();
+  void join();
+
+  THD *m_thd = nullptr;
+  std::vector<std::string> m_contexts;
+  size_t m_concurrency = 1;
+  std::vector<std::string> m_texts;
+  std::vector<int> m_answers;
+  std::vector<std::vector<float>> m_embeddings;
+  // What the thread's requests cost, charged to the session by join().
+  std::vector<Semantic_charge> m_charges;
+  my_thread_handle m_thread;
+  bool m_threaded = false;
+};
+
+// Most near duplicate groups a statement keeps the answers of, see
+// semantic_dedup_threshold. Later inputs unlike all of them are each sent
+// to the model.
+constexpr size_t SEMANTIC_DEDUP_MAX_REPRESENTATIVES = 4096;
+
+// Index of the first of representatives whose cosine similarity to
+// embedding is at least threshold, or representatives.size() if none is.
+size_t semantic_dedup_find(
+    const std::vector<std::vector<float>> &representatives,
+    const std::vector<float> &embedding, double threshold);
 
-bool semantic_extract_openai(std::string &context, std::string* result);
+// Group near duplicate texts by the cosine similarity of their embeddings,
+// so that the model is asked about one text of each group: in order, each
+// text joins the first representative at least threshold similar to it, or
+// becomes one. (*representatives)[i] is the index of the representative of
+// texts[i], i itself for representatives and texts that could not be
+// embedded.
+void semantic_dedup(const std::vector<std::string> &texts, double threshold,
+                    std::vector<size_t> *representatives);
 
-bool semantic_embed_openai(const std::string &text, std::vector<float>* result);
\ No newline at end of file
+// Embed many images, the bytes of their files, with semantic_embed_image_model
+// in as few requests as possible. (*results)[i] is left empty where images[i]
+// could not be embedded. Returns true if no request could be made at all.
+bool semantic_embed_image_batch(const std::vector<std::string> &images,
+                                std::vector<std::vector<float>> *results);
\ No newline at end of file
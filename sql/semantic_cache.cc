@@ -0,0 +1,143 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/semantic_cache.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+ulonglong semantic_cache_size;
+uint semantic_cache_ttl;
+
+namespace {
+
+constexpr size_t SEMANTIC_CACHE_SHARDS = 16;
+
+/** rough bookkeeping cost of an entry besides its strings */
+constexpr size_t SEMANTIC_CACHE_ENTRY_OVERHEAD = 128;
+
+using Clock = std::chrono::steady_clock;
+
+struct Semantic_cache_entry {
+  std::string key;
+  std::string response;
+  ulonglong tokens;
+  Clock::time_point created;
+
+  size_t bytes() const {
+    return key.size() + response.size() + SEMANTIC_CACHE_ENTRY_OVERHEAD;
+  }
+};
+
+struct Semantic_cache_shard {
+  std::mutex mutex;
+  /// most recently used first
+  std::list<Semantic_cache_entry> lru;
+  /// keys point into the entries of lru
+  std::unordered_map<std::string_view, std::list<Semantic_cache_entry>::iterator>
+      index;
+  size_t bytes = 0;
+
+  void erase(std::list<Semantic_cache_entry>::iterator it) {
+    bytes -= it->bytes();
+    index.erase(it->key);
+    lru.erase(it);
+  }
+};
+
+Semantic_cache_shard shards[SEMANTIC_CACHE_SHARDS];
+
+std::atomic<ulonglong> cache_hits{0};
+std::atomic<ulonglong> cache_misses{0};
+std::atomic<ulonglong> cache_saved_tokens{0};
+
+std::string make_key(const char *op, const std::string &model,
+                     const std::string &request) {
+  std::string key(op);
+  key += '\0';
+  key += model;
+  key += '\0';
+  key += request;
+  return key;
+}
+
+Semantic_cache_shard &shard_of(const std::string &key) {
+  return shards[std::hash<std::string>()(key) % SEMANTIC_CACHE_SHARDS];
+}
+
+bool expired(const Semantic_cache_entry &entry, uint ttl) {
+  return ttl != 0 && Clock::now() - entry.created > std::chrono::seconds(ttl);
+}
+
+}  // namespace
+
+bool semantic_cache_lookup(const char *op, const std::string &model,
+                           const std::string &request, std::string *response) {
+  if (semantic_cache_size == 0) return false;
+
+  const std::string key = make_key(op, model, request);
+  Semantic_cache_shard &shard = shard_of(key);
+  {
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    auto found = shard.index.find(key);
+    if (found != shard.index.end()) {
+      auto it = found->second;
+      if (!expired(*it, semantic_cache_ttl)) {
+        shard.lru.splice(shard.lru.begin(), shard.lru, it);
+        *response = it->response;
+        cache_hits++;
+        cache_saved_tokens += it->tokens;
+        return true;
+      }
+      shard.erase(it);
+    }
+  }
+  cache_misses++;
+  return false;
+}
+
+void semantic_cache_store(const char *op, const std::string &model,
+                          const std::string &request,
+                          const std::string &response, ulonglong tokens) {
+  const size_t shard_budget = semantic_cache_size / SEMANTIC_CACHE_SHARDS;
+  if (shard_budget == 0) return;
+
+  Semantic_cache_entry entry{make_key(op, model, request), response, tokens,
+                             Clock::now()};
+  if (entry.bytes() > shard_budget) return;
+
+  Semantic_cache_shard &shard = shard_of(entry.key);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  auto found = shard.index.find(entry.key);
+  if (found != shard.index.end()) shard.erase(found->second);
+
+  shard.bytes += entry.bytes();
+  shard.lru.push_front(std::move(entry));
+  shard.index.emplace(shard.lru.front().key, shard.lru.begin());
+
+  // also catches up after semantic_cache_size was lowered
+  while (shard.bytes > shard_budget) shard.erase(std::prev(shard.lru.end()));
+}
+
+Semantic_cache_stats semantic_cache_stats() {
+  return {cache_hits.load(), cache_misses.load(), cache_saved_tokens.load()};
+}
@@ -0,0 +1,67 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+/**
+  @file
+  Server wide cache of model responses for the semantic operators, so that
+  the same (prompt, value) pairs sent again, e.g. by a refreshing dashboard,
+  are answered without going back to the model.
+
+  Entries are keyed by the operator, the model and the full request text,
+  which holds both the prompt and the input values. The cache is split into
+  shards by key hash, each with its own lock and LRU list, and the byte
+  budget semantic_cache_size is divided evenly between them. Entries older
+  than semantic_cache_ttl seconds are not served.
+*/
+
+#include <string>
+
+#include "my_inttypes.h"
+
+/// Bytes the cached keys and responses may take, 0 turns the cache off.
+extern ulonglong semantic_cache_size;
+
+/// Seconds an entry is served for, 0 for no limit.
+extern uint semantic_cache_ttl;
+
+/**
+  Find the cached response to a request.
+  @param op the semantic operator, e.g. "semantic_filter"
+  @param model the model the request is for
+  @param request the full request text
+  @param[out] response the cached response
+  @return true if found
+*/
+bool semantic_cache_lookup(const char *op, const std::string &model,
+                           const std::string &request, std::string *response);
+
+/**
+  Remember the response to a request.
+  @param tokens tokens the model spent on it, counted as saved by each hit
+*/
+void semantic_cache_store(const char *op, const std::string &model,
+                          const std::string &request,
+                          const std::string &response, ulonglong tokens);
+
+struct Semantic_cache_stats {
+  ulonglong hits;
+  ulonglong misses;
+  ulonglong saved_tokens;
+};
+
+Semantic_cache_stats semantic_cache_stats();
@@ -0,0 +1,615 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/semantic_materializer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "my_dbug.h"
+#include "my_thread.h"
+#include "mysql/psi/mysql_cond.h"
+#include "mysql/psi/mysql_mutex.h"
+#include "mysql/psi/mysql_thread.h"
+#include "sql/field.h"
+#include "sql/handler.h"
+#include "sql/item.h"
+#include "sql/item_fb_vector_func.h"
+#include "sql/item_func.h"
+#include "sql/item_semantic_func.h"
+#include "sql/key.h"
+#include "sql/log.h"
+#include "sql/mysqld.h"
+#include "sql/mysqld_thd_manager.h"
+#include "sql/protocol_classic.h"
+#include "sql/semantic_base.h"
+#include "sql/sql_base.h"
+#include "sql/sql_class.h"
+#include "sql/sql_lex.h"
+#include "sql/system_variables.h"
+#include "sql/table.h"
+#include "sql/transaction.h"
+#include "template_utils.h"
+
+uint semantic_materialize_threads;
+uint semantic_materialize_batch_size;
+
+namespace {
+
+/// Rows of a table waiting to be filled, by their primary keys.
+struct Pending_rows {
+  std::string db;
+  std::string table_name;
+  std::vector<std::string> keys;
+};
+
+mysql_mutex_t LOCK_materializer;
+mysql_cond_t COND_materializer;
+
+/// Tables with rows to fill, oldest first. Guarded by LOCK_materializer.
+std::deque<Pending_rows> pending;
+std::atomic<ulonglong> pending_rows{0};
+
+std::vector<my_thread_handle> workers;
+bool materializer_inited = false;
+
+/// The STORED ASYNC columns of a table and the semantic maps and embeddings
+/// computing them.
+struct Async_columns {
+  std::vector<Field *> fields;
+  std::vector<Item_func_semantic_map *> maps;
+  std::vector<Semantic_text_embedder *> embedders;
+};
+
+void find_async_columns(TABLE *table, Async_columns *columns) {
+  for (Field **vfield = table->vfield; vfield != nullptr && *vfield != nullptr;
+       ++vfield) {
+    Field *field = *vfield;
+    if (!field->gcol_info->is_async()) continue;
+    columns->fields.push_back(field);
+    WalkItem(field->gcol_info->expr_item, enum_walk::PREFIX,
+             [columns](Item *item) {
+               if (item->type() == Item::FUNC_ITEM) {
+                 const Item_func::Functype type =
+                     down_cast<Item_func *>(item)->functype();
+                 if (type == Item_func::SEMANTIC_MAP ||
+                     type == Item_func::SEMANTIC_EXTRACT) {
+                   columns->maps.push_back(
+                       down_cast<Item_func_semantic_map *>(item));
+                 } else if (type == Item_func::SEMANTIC_EMBED) {
+                   columns->embedders.push_back(
+                       down_cast<Item_func_semantic_embed *>(item));
+                 } else if (type == Item_func::SEMANTIC_EMBED_IMAGE) {
+                   columns->embedders.push_back(
+                       down_cast<Item_func_semantic_embed_image *>(item));
+                 }
+               }
+               return false;
+             });
+  }
+}
+
+/**
+  Wait for rows to fill and take a batch of them.
+  @return false if the worker was killed
+*/
+bool take_rows(THD *thd, Pending_rows *rows) {
+  mysql_mutex_lock(&LOCK_materializer);
+  PSI_stage_info old_stage;
+  thd->ENTER_COND(&COND_materializer, &LOCK_materializer,
+                  &stage_waiting_for_work_item, &old_stage);
+  while (pending.empty() && !thd->is_killed()) {
+    mysql_cond_wait(&COND_materializer, &LOCK_materializer);
+  }
+  const bool found = !thd->is_killed();
+  if (found) {
+    Pending_rows &front = pending.front();
+    const size_t count = std::min<size_t>(
+        front.keys.size(), std::max(semantic_materialize_batch_size, 1U));
+    rows->db = front.db;
+    rows->table_name = front.table_name;
+    rows->keys.assign(std::make_move_iterator(front.keys.begin()),
+                      std::make_move_iterator(front.keys.begin() + count));
+    front.keys.erase(front.keys.begin(), front.keys.begin() + count);
+    if (front.keys.empty()) pending.pop_front();
+    pending_rows -= count;
+  }
+  mysql_mutex_unlock(&LOCK_materializer);
+  thd->EXIT_COND(&old_stage);
+  return found;
+}
+
+/**
+  Open the table of the rows in a new transaction, its rows to be read with
+  the locks tables asks for, and position it on its primary key.
+  @return nullptr if it cannot be opened, e.g. when it was dropped
+*/
+TABLE *begin_pass(THD *thd, const Pending_rows &rows, Table_ref *tables) {
+  lex_start(thd);
+  thd->set_query_id(next_query_id());
+  thd->set_time();
+  if (open_and_lock_tables(thd, tables, 0)) return nullptr;
+  TABLE *table = tables->table;
+  if (table->s->primary_key == MAX_KEY) {
+    my_error(ER_REQUIRES_PRIMARY_KEY, MYF(0));
+    return nullptr;
+  }
+  table->use_all_columns();
+  if (int error = table->file->ha_index_init(table->s->primary_key, false)) {
+    table->file->print_error(error, MYF(0));
+    return nullptr;
+  }
+  DBUG_PRINT("info", ("filling %zu rows of %s.%s", rows.keys.size(),
+                      rows.db.c_str(), rows.table_name.c_str()));
+  return table;
+}
+
+/**
+  Close the table of a pass and end its transaction, committing it unless
+  failed.
+  @return true if the pass failed
+*/
+bool end_pass(THD *thd, TABLE *table, bool failed) {
+  if (table != nullptr && table->file->inited) table->file->ha_index_end();
+  failed = failed || thd->is_error() || trans_commit_stmt(thd) ||
+           trans_commit(thd);
+  if (failed) {
+    trans_rollback_stmt(thd);
+    trans_rollback(thd);
+  }
+  close_thread_tables(thd);
+  thd->mdl_context.release_transactional_locks();
+  lex_end(thd->lex);
+  thd->mem_root->ClearForReuse();
+  return failed;
+}
+
+/**
+  Read the row with a primary key into record[0].
+  @return 0, HA_ERR_KEY_NOT_FOUND if the row is gone, or another handler
+    error
+*/
+int read_row(TABLE *table, const std::string &key) {
+  int error = table->file->ha_index_read_map(
+      table->record[0], pointer_cast<const uchar *>(key.data()), HA_WHOLE_KEY,
+      HA_READ_KEY_EXACT);
+  return error == HA_ERR_END_OF_FILE ? HA_ERR_KEY_NOT_FOUND : error;
+}
+
+/**
+  Build the prompts of the semantic maps on the current row.
+  @param[out] contexts the context of each map, empty where it has none,
+    e.g. on NULL input, which gets no request
+*/
+void get_contexts(THD *thd, const Async_columns &columns,
+                  std::vector<std::string> *contexts) {
+  contexts->assign(columns.maps.size(), std::string());
+  for (size_t m = 0; m < columns.maps.size(); m++) {
+    if (columns.maps[m]->get_context(&(*contexts)[m])) {
+      (*contexts)[m].clear();
+      thd->clear_error();
+    }
+  }
+}
+
+/**
+  Read the texts and images the embeddings embed on the current row.
+  @param[out] inputs the input of each embedding, empty on NULL or empty
+    input, which gets no request
+*/
+void get_embedded(THD *thd, const Async_columns &columns,
+                  std::vector<std::string> *inputs) {
+  inputs->assign(columns.embedders.size(), std::string());
+  String buffer;
+  for (size_t e = 0; e < columns.embedders.size(); e++) {
+    Item *input = columns.embedders[e]->embedded_text();
+    const String *value = input->val_str(&buffer);
+    if (value != nullptr && !input->null_value) {
+      (*inputs)[e].assign(value->ptr(), value->length());
+    }
+  }
+  thd->clear_error();
+}
+
+/// What the first pass read of a batch of rows.
+struct Batch_prompts {
+  /// Whether each row was found.
+  std::vector<bool> found;
+  /// Whether each semantic map is a SEMANTIC_EXTRACT().
+  std::vector<bool> extracts;
+  /// Context of each semantic map on each row, row-major, empty where the
+  /// map has none.
+  std::vector<std::string> contexts;
+  /// Whether each embedding embeds images.
+  std::vector<bool> images;
+  /// Input of each embedding on each row, row-major, empty where the
+  /// embedding has none.
+  std::vector<std::string> inputs;
+};
+
+/**
+  Read a batch of rows with shared locks, waiting for their writers to end,
+  and build their prompts.
+  @return a handler error, or -1 if the table could not be read
+*/
+int read_prompts(THD *thd, const Pending_rows &rows, Batch_prompts *prompts) {
+  Table_ref tables(rows.db.c_str(), rows.db.length(), rows.table_name.c_str(),
+                   rows.table_name.length(), rows.table_name.c_str(),
+                   TL_READ_WITH_SHARED_LOCKS);
+  TABLE *table = begin_pass(thd, rows, &tables);
+  int error = table == nullptr ? -1 : 0;
+  if (table != nullptr) {
+    Async_columns columns;
+    find_async_columns(table, &columns);
+    for (Item_func_semantic_map *map : columns.maps) {
+      prompts->extracts.push_back(map->functype() ==
+                                  Item_func::SEMANTIC_EXTRACT);
+    }
+    for (Semantic_text_embedder *embedder : columns.embedders) {
+      prompts->images.push_back(embedder->embeds_images());
+    }
+    const size_t map_count = columns.maps.size();
+    const size_t embedder_count = columns.embedders.size();
+    prompts->found.assign(rows.keys.size(), false);
+    prompts->contexts.resize(rows.keys.size() * map_count);
+    prompts->inputs.resize(rows.keys.size() * embedder_count);
+    std::vector<std::string> row_contexts;
+    std::vector<std::string> row_inputs;
+    for (size_t r = 0; r < rows.keys.size(); r++) {
+      error = read_row(table, rows.keys[r]);
+      if (error == HA_ERR_KEY_NOT_FOUND) {
+        error = 0;
+        continue;
+      }
+      if (error) {
+        table->file->print_error(error, MYF(0));
+        break;
+      }
+      prompts->found[r] = true;
+      get_contexts(thd, columns, &row_contexts);
+      std::move(row_contexts.begin(), row_contexts.end(),
+                prompts->contexts.begin() + r * map_count);
+      get_embedded(thd, columns, &row_inputs);
+      std::move(row_inputs.begin(), row_inputs.end(),
+                prompts->inputs.begin() + r * embedder_count);
+    }
+  }
+  if (end_pass(thd, table, error != 0) && error == 0) error = -1;
+  return error;
+}
+
+/// Have the models answer the prompts of a batch, each map's concurrently,
+/// and embed its inputs, each embedding's in as few requests as possible.
+void ask_model(THD *thd, const Batch_prompts &prompts,
+               std::vector<std::string> *answers,
+               std::vector<std::vector<float>> *embeddings) {
+  const size_t map_count = prompts.extracts.size();
+  answers->assign(prompts.contexts.size(), std::string());
+  for (size_t m = 0; m < map_count; m++) {
+    std::vector<std::string> contexts;
+    std::vector<size_t> slots;
+    for (size_t slot = m; slot < prompts.contexts.size(); slot += map_count) {
+      if (!prompts.contexts[slot].empty()) {
+        slots.push_back(slot);
+        contexts.push_back(prompts.contexts[slot]);
+      }
+    }
+    if (contexts.empty()) continue;
+
+    // near duplicate contexts take the answer of the first of them
+    std::vector<size_t> representatives;
+    const std::vector<size_t> context_slots = slots;
+    const double threshold = thd->variables.semantic_dedup_threshold;
+    if (threshold > 0) {
+      semantic_dedup(contexts, threshold, &representatives);
+      std::vector<std::string> asked;
+      slots.clear();
+      for (size_t i = 0; i < contexts.size(); i++) {
+        if (representatives[i] != i) continue;
+        asked.push_back(std::move(contexts[i]));
+        slots.push_back(context_slots[i]);
+      }
+      contexts = std::move(asked);
+    }
+
+    std::vector<std::string> results;
+    const size_t concurrency = thd->variables.semantic_filter_concurrency;
+    if (prompts.extracts[m]) {
+      semantic_extract_openai_batch(contexts, concurrency, &results);
+    } else {
+      semantic_map_openai_batch(contexts, concurrency, &results);
+    }
+    for (size_t i = 0; i < results.size(); i++) {
+      (*answers)[slots[i]] = std::move(results[i]);
+    }
+    for (size_t i = 0; i < representatives.size(); i++) {
+      if (representatives[i] != i) {
+        (*answers)[context_slots[i]] =
+            (*answers)[context_slots[representatives[i]]];
+      }
+    }
+  }
+
+  const size_t embedder_count = prompts.images.size();
+  embeddings->assign(prompts.inputs.size(), std::vector<float>());
+  for (size_t e = 0; e < embedder_count; e++) {
+    std::vector<std::string> inputs;
+    std::vector<size_t> slots;
+    for (size_t slot = e; slot < prompts.inputs.size();
+         slot += embedder_count) {
+      if (!prompts.inputs[slot].empty()) {
+        slots.push_back(slot);
+        inputs.push_back(prompts.inputs[slot]);
+      }
+    }
+    if (inputs.empty()) continue;
+    std::vector<std::vector<float>> results;
+    if (prompts.images[e]) {
+      semantic_embed_image_batch(inputs, &results);
+    } else {
+      semantic_embed_openai_batch(inputs, &results);
+    }
+    for (size_t i = 0; i < results.size(); i++) {
+      (*embeddings)[slots[i]] = std::move(results[i]);
+    }
+  }
+}
+
+/**
+  Lock a batch of rows again and store the answers into those whose prompts
+  are still the same. A row written again since is queued again by that
+  write.
+  @param[out] unanswered rows left NULL as the model gave no answer for them
+  @return a handler error, or -1 if the table could not be written
+*/
+int store_answers(THD *thd, const Pending_rows &rows,
+                  const Batch_prompts &prompts,
+                  std::vector<std::string> *answers,
+                  std::vector<std::vector<float>> *embeddings,
+                  size_t *unanswered) {
+  Table_ref tables(rows.db.c_str(), rows.db.length(), rows.table_name.c_str(),
+                   rows.table_name.length(), rows.table_name.c_str(),
+                   TL_WRITE);
+  TABLE *table = begin_pass(thd, rows, &tables);
+  int error = table == nullptr ? -1 : 0;
+  Async_columns columns;
+  if (table != nullptr) find_async_columns(table, &columns);
+  const size_t map_count = columns.maps.size();
+  const size_t embedder_count = columns.embedders.size();
+  // The columns changed since, and ALTER TABLE computed them as it copied
+  // the rows.
+  if (table != nullptr && (map_count != prompts.extracts.size() ||
+                           embedder_count != prompts.images.size())) {
+    table = nullptr;
+  }
+
+  std::vector<std::string> row_contexts;
+  std::vector<std::string> row_inputs;
+  for (size_t r = 0; table != nullptr && r < rows.keys.size() && !error &&
+                     !thd->is_killed();
+       r++) {
+    if (!prompts.found[r]) continue;
+    error = read_row(table, rows.keys[r]);
+    if (error == HA_ERR_KEY_NOT_FOUND) {
+      error = 0;
+      continue;
+    }
+    if (error) {
+      table->file->print_error(error, MYF(0));
+      break;
+    }
+    get_contexts(thd, columns, &row_contexts);
+    bool same = true;
+    bool answered = true;
+    for (size_t m = 0; m < map_count; m++) {
+      const size_t slot = r * map_count + m;
+      same = same && row_contexts[m] == prompts.contexts[slot];
+      answered = answered &&
+                 (prompts.contexts[slot].empty() || !(*answers)[slot].empty());
+    }
+    get_embedded(thd, columns, &row_inputs);
+    for (size_t e = 0; e < embedder_count; e++) {
+      const size_t slot = r * embedder_count + e;
+      same = same && row_inputs[e] == prompts.inputs[slot];
+      answered = answered && (prompts.inputs[slot].empty() ||
+                              !(*embeddings)[slot].empty());
+    }
+    if (!same) continue;
+    if (!answered) {
+      (*unanswered)++;
+      continue;
+    }
+
+    store_record(table, record[1]);
+    for (size_t m = 0; m < map_count; m++) {
+      const size_t slot = r * map_count + m;
+      if (!prompts.contexts[slot].empty()) {
+        columns.maps[m]->set_prefetched_result(std::move((*answers)[slot]));
+      }
+    }
+    for (size_t e = 0; e < embedder_count; e++) {
+      const size_t slot = r * embedder_count + e;
+      columns.embedders[e]->set_prefetched_embedding(
+          std::move((*embeddings)[slot]));
+    }
+    for (Field *field : columns.fields) {
+      field->gcol_info->expr_item->save_in_field(field, false);
+    }
+    // answers not consumed must not leak into later evaluations
+    for (Item_func_semantic_map *map : columns.maps) {
+      map->clear_prefetched_result();
+    }
+    for (Semantic_text_embedder *embedder : columns.embedders) {
+      embedder->set_prefetched_embedding(std::vector<float>());
+    }
+    if (thd->is_error()) {
+      // the value does not fit the column, so it stays NULL
+      thd->clear_error();
+      continue;
+    }
+    error = table->file->ha_update_row(table->record[1], table->record[0]);
+    if (error == HA_ERR_RECORD_IS_THE_SAME) {
+      error = 0;
+    } else if (error) {
+      table->file->print_error(error, MYF(0));
+    }
+  }
+  if (end_pass(thd, tables.table, error != 0 || thd->is_killed()) &&
+      error == 0) {
+    error = -1;
+  }
+  return error;
+}
+
+/**
+  Fill the STORED ASYNC columns of a batch of rows. The model is asked
+  between the two passes over the rows, while no lock is held.
+*/
+void materialize_rows(THD *thd, const Pending_rows &rows) {
+  Batch_prompts prompts;
+  std::vector<std::string> answers;
+  std::vector<std::vector<float>> embeddings;
+  size_t unanswered = 0;
+  int error = read_prompts(thd, rows, &prompts);
+  if (error == 0) {
+    ask_model(thd, prompts, &answers, &embeddings);
+    error = store_answers(thd, rows, prompts, &answers, &embeddings,
+                          &unanswered);
+  }
+  if (thd->is_killed()) return;
+
+  if (error != 0) {
+    sql_print_warning(
+        "Semantic materialization of %zu rows of %s.%s failed: %s",
+        rows.keys.size(), rows.db.c_str(), rows.table_name.c_str(),
+        thd->is_error() ? thd->get_stmt_da()->message_text() : "");
+    thd->clear_error();
+    // rows locked by a writer for too long are tried again later
+    if (error == HA_ERR_LOCK_WAIT_TIMEOUT || error == HA_ERR_LOCK_DEADLOCK) {
+      mysql_mutex_lock(&LOCK_materializer);
+      pending.push_back(rows);
+      pending_rows += rows.keys.size();
+      mysql_cond_signal(&COND_materializer);
+      mysql_mutex_unlock(&LOCK_materializer);
+    }
+  } else if (unanswered > 0) {
+    sql_print_warning(
+        "Semantic materialization of %s.%s had no answer for %zu rows, "
+        "which stay NULL until they are written again.",
+        rows.db.c_str(), rows.table_name.c_str(), unanswered);
+  }
+}
+
+extern "C" void *semantic_materialize_worker(void *) {
+  THD new_thd;
+  THD *thd = &new_thd;
+  Global_THD_manager *thd_manager = Global_THD_manager::get_instance();
+
+  thd->system_thread = SYSTEM_THREAD_BACKGROUND;
+  thd->thread_stack = (char *)&thd;
+  if (my_thread_init()) return nullptr;
+  thd->get_protocol_classic()->init_net(nullptr);
+  thd->set_new_thread_id();
+  thd->store_globals();
+  thd_manager->add_thd(thd);
+  mysql_thread_set_psi_id(thd->thread_id());
+  thd->set_command(COM_DAEMON);
+  thd->security_context()->skip_grants();
+  // The filled values reach replicas as row events, so that they do not ask
+  // the model again.
+  thd->variables.binlog_format = BINLOG_FORMAT_ROW;
+
+  {
+    DBUG_TRACE;
+    Pending_rows rows;
+    while (take_rows(thd, &rows)) {
+      materialize_rows(thd, rows);
+    }
+  }
+
+  thd->get_protocol_classic()->end_net();
+  // Must be called before thd_manager->remove_thd.
+  thd->release_resources();
+  thd_manager->remove_thd(thd);
+  my_thread_end();
+  return nullptr;
+}
+
+}  // namespace
+
+void semantic_materializer_init() {
+  mysql_mutex_init(PSI_NOT_INSTRUMENTED, &LOCK_materializer,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(PSI_NOT_INSTRUMENTED, &COND_materializer);
+  materializer_inited = true;
+
+  for (uint i = 0; i < semantic_materialize_threads; i++) {
+    my_thread_handle handle;
+    if (int error = mysql_thread_create(key_thread_semantic_materializer,
+                                        &handle, &connection_attrib,
+                                        semantic_materialize_worker, nullptr)) {
+      sql_print_warning(
+          "Could not create semantic materialization thread (errno= %d)",
+          error);
+      break;
+    }
+    workers.push_back(handle);
+  }
+}
+
+void semantic_materializer_deinit() {
+  if (!materializer_inited) return;
+  // The workers have been killed along with all other threads.
+  for (my_thread_handle &handle : workers) {
+    my_thread_join(&handle, nullptr);
+  }
+  workers.clear();
+  pending.clear();
+  pending_rows = 0;
+  mysql_cond_destroy(&COND_materializer);
+  mysql_mutex_destroy(&LOCK_materializer);
+  materializer_inited = false;
+}
+
+void semantic_materializer_enqueue(TABLE *table, const uchar *record) {
+  if (!materializer_inited) return;
+  const KEY *key_info = &table->key_info[table->s->primary_key];
+  std::string key(key_info->key_length, '\0');
+  key_copy(pointer_cast<uchar *>(key.data()), record, key_info,
+           key_info->key_length);
+
+  mysql_mutex_lock(&LOCK_materializer);
+  // rows of the same table are batched together
+  auto it = std::find_if(pending.begin(), pending.end(),
+                         [table](const Pending_rows &rows) {
+                           return rows.db == table->s->db.str &&
+                                  rows.table_name == table->s->table_name.str;
+                         });
+  if (it == pending.end()) {
+    pending.push_back({table->s->db.str, table->s->table_name.str, {}});
+    it = std::prev(pending.end());
+  }
+  it->keys.push_back(std::move(key));
+  pending_rows++;
+  mysql_cond_signal(&COND_materializer);
+  mysql_mutex_unlock(&LOCK_materializer);
+}
+
+ulonglong semantic_materializer_pending() { return pending_rows; }
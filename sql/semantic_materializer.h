@@ -0,0 +1,73 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+/**
+  @file
+  Background fill of STORED ASYNC generated columns, e.g.
+
+    ALTER TABLE docs ADD COLUMN entities JSON
+      GENERATED ALWAYS AS (SEMANTIC_EXTRACT('Which companies?', body))
+      STORED ASYNC
+
+  Queries read such a column like any stored one, so the model is asked once
+  per row change rather than once per query. Writing a row does not wait for
+  the model though: its STORED ASYNC columns are stored as NULL and the
+  primary key of the row is queued. semantic_materialize_threads workers take
+  the queued rows of a table in batches of semantic_materialize_batch_size,
+  send the SEMANTIC_MAP() and SEMANTIC_EXTRACT() prompts of the whole batch
+  concurrently, embed its SEMANTIC_EMBED() texts and SEMANTIC_EMBED_IMAGE()
+  images in as few requests as possible, and store the answers into the
+  rows. Bulk loads by INSERT ... SELECT or LOAD DATA thus embed their rows
+  in batches, e.g. on a GPU model server, rather than one request per row.
+
+  The rows are read with locking reads, so a row is only filled once the
+  transaction that wrote it has ended, and the model is asked while no lock
+  is held. A row whose prompts changed in the meantime is left to the write
+  that changed it, which queued it again.
+
+  The queue lives in memory: rows still queued when the server stops stay
+  NULL until they are written again. Tables without a primary key, and rows
+  copied by ALTER TABLE, have their STORED ASYNC columns computed as the row
+  is written, like STORED ones.
+*/
+
+#include "my_inttypes.h"
+
+struct TABLE;
+
+/// Number of background workers, set at server start.
+extern uint semantic_materialize_threads;
+
+/// Most rows a worker fills at once.
+extern uint semantic_materialize_batch_size;
+
+/// Start the workers at server start.
+void semantic_materializer_init();
+
+/// Wait for the workers to end at shutdown, once they have been killed.
+void semantic_materializer_deinit();
+
+/**
+  Queue a row just written to have its STORED ASYNC columns filled.
+  @param table the table of the row, with a primary key
+  @param record the row as written
+*/
+void semantic_materializer_enqueue(TABLE *table, const uchar *record);
+
+/// Rows queued and not yet filled.
+ulonglong semantic_materializer_pending();
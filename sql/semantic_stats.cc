@@ -0,0 +1,89 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/semantic_stats.h"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+/** weight of the newest call in the latency average */
+constexpr double SEMANTIC_LATENCY_DECAY = 0.05;
+
+/** most prompts whose pass rates are kept; all are dropped past that */
+constexpr size_t SEMANTIC_MAX_PROMPTS = 4096;
+
+/** rows a prompt must have been tried on before its pass rate is used */
+constexpr ulonglong SEMANTIC_MIN_EVALUATED = 10;
+
+struct Semantic_outcomes {
+  ulonglong evaluated = 0;
+  ulonglong passed = 0;
+};
+
+std::mutex stats_mutex;
+double latency_ms = 0;
+bool latency_measured = false;
+std::unordered_map<std::string, Semantic_outcomes> outcomes;
+
+}  // namespace
+
+size_t semantic_latency_bucket(ulonglong microseconds) {
+  size_t bucket = 0;
+  for (ulonglong bound = 10000;
+       bucket + 1 < SEMANTIC_LATENCY_BUCKETS && microseconds >= bound;
+       bound *= 10) {
+    bucket++;
+  }
+  return bucket;
+}
+
+void semantic_stats_record_latency(double milliseconds) {
+  std::lock_guard<std::mutex> guard(stats_mutex);
+  if (!latency_measured) {
+    latency_ms = milliseconds;
+    latency_measured = true;
+  } else {
+    latency_ms += SEMANTIC_LATENCY_DECAY * (milliseconds - latency_ms);
+  }
+}
+
+double semantic_stats_latency_ms() {
+  std::lock_guard<std::mutex> guard(stats_mutex);
+  return latency_measured ? latency_ms : SEMANTIC_DEFAULT_LATENCY_MS;
+}
+
+void semantic_stats_record_outcomes(const std::string &prompt,
+                                    ulonglong evaluated, ulonglong passed) {
+  if (evaluated == 0) return;
+  std::lock_guard<std::mutex> guard(stats_mutex);
+  if (outcomes.size() >= SEMANTIC_MAX_PROMPTS && !outcomes.count(prompt)) {
+    outcomes.clear();
+  }
+  Semantic_outcomes &entry = outcomes[prompt];
+  entry.evaluated += evaluated;
+  entry.passed += passed;
+}
+
+double semantic_stats_pass_rate(const std::string &prompt) {
+  std::lock_guard<std::mutex> guard(stats_mutex);
+  auto it = outcomes.find(prompt);
+  if (it == outcomes.end() || it->second.evaluated < SEMANTIC_MIN_EVALUATED) {
+    return SEMANTIC_DEFAULT_PASS_RATE;
+  }
+  return static_cast<double>(it->second.passed) / it->second.evaluated;
+}
@@ -0,0 +1,65 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+/**
+  @file
+  Server wide observations of the semantic operators that the optimizer
+  turns into cost and selectivity estimates: how long a call to the model
+  takes, and how many rows each semantic filter prompt lets through.
+*/
+
+#include <cstddef>
+#include <string>
+
+#include "my_inttypes.h"
+
+/// The semantic operators, which keep separate counters.
+enum enum_semantic_op {
+  SEMANTIC_OP_FILTER,
+  SEMANTIC_OP_MAP,
+  SEMANTIC_OP_EXTRACT,
+  SEMANTIC_OP_EMBED,
+  SEMANTIC_OP_END
+};
+
+/// Buckets of the request latency histograms, see
+/// semantic_latency_bucket().
+constexpr size_t SEMANTIC_LATENCY_BUCKETS = 5;
+
+/// Histogram bucket of a request taking microseconds: under 10ms, 100ms,
+/// 1s, 10s, or longer.
+size_t semantic_latency_bucket(ulonglong microseconds);
+
+/// Latency of a model call assumed before any has been measured.
+constexpr double SEMANTIC_DEFAULT_LATENCY_MS = 500.0;
+
+/// Pass rate of a semantic filter whose prompt has not been seen yet.
+constexpr double SEMANTIC_DEFAULT_PASS_RATE = 0.5;
+
+/// Record the wall time of a call to the model.
+void semantic_stats_record_latency(double milliseconds);
+
+/// Moving average of the wall time of recent model calls.
+double semantic_stats_latency_ms();
+
+/// Record how many rows a semantic filter with this prompt saw and passed.
+void semantic_stats_record_outcomes(const std::string &prompt,
+                                    ulonglong evaluated, ulonglong passed);
+
+/// Fraction of rows semantic filters with this prompt passed so far.
+double semantic_stats_pass_rate(const std::string &prompt);
@@ -33,6 +33,8 @@
 #include "sql/rpl_mi.h"
 #include "sql/rpl_msr.h"  // Multisource_info
 #include "sql/rpl_replica.h"
+#include "sql/rpl_shardbeats.h"
+#include "sql/rpl_source.h"
 #include "sql/slave_stats_daemon.h"
 #include "sql/sql_base.h"
 #include "sql/sql_show.h"
@@ -198,8 +200,14 @@ static void *handle_slave_stats_daemon(void *arg MY_ATTRIBUTE((unused))) {
                 write_send_replica_statistics_wait_time_seconds ||
             (ulong)milli_sec_behind_master <
                 write_stop_throttle_lag_milliseconds) {
-          if (send_replica_statistics_to_master(mysql,
-                                                milli_sec_behind_master)) {
+          std::vector<std::pair<std::string, int>> shard_lags;
+          if (write_throttle_shard_lag)
+            shard_lags = get_lagging_shards(
+                SLAVE_STATS::MAX_SHARD_LAGS,
+                active_mi->clock_diff_with_master * 1000LL,
+                milli_sec_behind_master);
+          if (send_replica_statistics_to_master(mysql, milli_sec_behind_master,
+                                                shard_lags)) {
             DBUG_PRINT("info", ("Slave Stats Daemon: Failed to send lag "
                                 "statistics, resetting connection, (Error: %s)",
                                 mysql_error(mysql)));
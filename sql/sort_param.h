@@ -409,6 +409,31 @@ class Sort_param {
                         &longest_addons);
   }
 
+  /**
+    Stores only the key fields in *dst, as the first part of make_sortkey().
+    @returns Number of bytes stored, or UINT_MAX if they did not fit.
+   */
+  uint make_sortkey_key(Bounds_checked_array<uchar> dst);
+
+  /**
+    Appends the @<rowid@> or the "addon fields" at to, after a key stored
+    with make_sortkey_key().
+    @returns Number of bytes stored, or UINT_MAX if they did not fit.
+   */
+  uint make_sortkey_payload(uchar *to, uchar *to_end,
+                            const Mem_root_array<TABLE *> &tables,
+                            size_t *longest_addons);
+
+  // Adapter for Bounded_queue::replace_top().
+  uint make_sortkey_payload(uchar *dst, size_t dst_len, uint key_length,
+                            const Mem_root_array<TABLE *> &tables) {
+    size_t longest_addons = 0;  // Unused.
+    const uint payload_length = make_sortkey_payload(
+        dst + key_length, dst + dst_len, tables, &longest_addons);
+    if (payload_length == UINT_MAX) return UINT_MAX;
+    return key_length + payload_length;
+  }
+
   /// Stores the length of a variable-sized key.
   static void store_varlen_key_length(uchar *p, uint sz) { int4store(p, sz); }
 
@@ -456,7 +481,8 @@ class Sort_param {
   enum enum_sort_algorithm {
     FILESORT_ALG_NONE,
     FILESORT_ALG_STD_SORT,
-    FILESORT_ALG_STD_STABLE
+    FILESORT_ALG_STD_STABLE,
+    FILESORT_ALG_RADIX
   };
   enum_sort_algorithm m_sort_algorithm{FILESORT_ALG_NONE};
 
@@ -16,6 +16,7 @@
 
 #include "sql/sql_admission_control.h"
 #include <my_stacktrace.h>
+#include <algorithm>
 #include "debug_sync.h"
 #include "sql/auth/auth_acls.h"
 #include "sql/log.h"
@@ -34,6 +35,9 @@ ulonglong admission_control_wait_events;
 ulonglong admission_control_yield_freq;
 bool admission_control_multiquery_filter;
 ulong admission_control_errors_size;
+ulong admission_control_waits_size;
+ulong admission_control_semantic_rate;
+ulong admission_control_semantic_entity_rate;
 
 AC *db_ac;
 #ifdef HAVE_PSI_INTERFACE
@@ -45,6 +49,8 @@ PSI_stage_info stage_waiting_for_admission = {0, "waiting for admission", 0,
                                               PSI_DOCUMENT_ME};
 PSI_stage_info stage_waiting_for_readmission = {0, "waiting for readmission", 0,
                                                 PSI_DOCUMENT_ME};
+PSI_stage_info stage_waiting_for_semantic_admission = {
+    0, "waiting for semantic admission", 0, PSI_DOCUMENT_ME};
 #endif
 
 /**
@@ -294,6 +300,44 @@ int multi_tenancy_exit_query(THD *thd) {
   return 0;
 }
 
+/**
+ * Admit a request of the semantic operators to their model, without
+ * waiting. Requests are paced by a server wide token bucket filled at
+ * admission_control_semantic_rate, and by one per admission control entity
+ * filled at admission_control_semantic_entity_rate, so that a single query
+ * cannot use up the rate limit of the model's provider for all others.
+ *
+ * @param thd THD structure, or nullptr for a background thread
+ *
+ * @return 0 if admitted, otherwise microseconds until the request may be
+ */
+ulonglong multi_tenancy_try_semantic_request(THD *thd) {
+  return db_ac->semantic_request_try(thd);
+}
+
+/**
+ * Admit a request of the semantic operators to their model, waiting until
+ * the token buckets allow it.
+ *
+ * @param thd THD structure, or nullptr for a background thread
+ *
+ * @return 0 if admitted, 1 if killed while waiting
+ */
+int multi_tenancy_admit_semantic_request(THD *thd) {
+  return db_ac->semantic_request_enter(thd) == Ac_result::AC_ADMITTED ? 0 : 1;
+}
+
+/**
+ * Hold off all requests of the semantic operators, e.g. after the model
+ * answered 429 Too Many Requests. Requests wait their turn meanwhile
+ * instead of failing.
+ *
+ * @param wait_us how long to hold off, in microseconds
+ */
+void multi_tenancy_throttle_semantic_requests(ulonglong wait_us) {
+  db_ac->semantic_request_throttle(wait_us);
+}
+
 /*
  * A wrapper around std::stoul that catches any exceptions to return an error
  * code instead. On success, val is populated with the output.
@@ -484,6 +528,7 @@ Ac_result AC::admission_control_enter(
       // We are below the max running limit.
       ++ac_info->running_queries;
       ++ac_info->queues[thd->ac_node->queue].running_queries;
+      ++ac_info->queues[thd->ac_node->queue].wait_histogram[0];
       assert(!thd->ac_node->running);
       thd->ac_node->running = true;
     } else if (max_waiting_queries &&
@@ -495,6 +540,9 @@ Ac_result AC::admission_control_enter(
       res = Ac_result::AC_ABORTED;
     } else {
       bool timeout;
+      const ulong queue_length =
+          ac_info->queues[thd->ac_node->queue].waiting_queries();
+      const ulonglong enqueue_time_us = my_micro_time();
       enqueue(thd, ac_info, mode);
       /**
         Inserting or deleting in std::map will not invalidate existing
@@ -544,9 +592,16 @@ Ac_result AC::admission_control_enter(
           ++ac_info->timeout_queries;
           res = Ac_result::AC_TIMEOUT;
         } else {
+          ++ac_info->queues[thd->ac_node->queue].killed_queries;
           res = Ac_result::AC_KILLED;
         }
       }
+
+      const ulonglong now_us = my_micro_time();
+      ac_info->log_wait(
+          thd, res, thd->ac_node->queue,
+          now_us > enqueue_time_us ? now_us - enqueue_time_us : 0,
+          queue_length, mode);
     }
 
     if (res != Ac_result::AC_ADMITTED) {
@@ -973,6 +1028,77 @@ ulong AC::get_total_waiting_queries() const {
   return res;
 }
 
+/**
+  Admit a semantic request if both the entity's and the server wide token
+  bucket hold a token. The entity's is asked first, so that an entity over
+  its quota does not use up the tokens of the others.
+
+  @return 0 if admitted, otherwise microseconds to wait before trying again
+*/
+ulonglong AC::semantic_request_try(THD *thd) {
+  if (thd && thd->ac_node && thd->ac_node->ac_info) {
+    ulonglong wait_us = thd->ac_node->ac_info->semantic_bucket.try_take(
+        admission_control_semantic_entity_rate);
+    if (wait_us) return wait_us;
+  }
+  return semantic_bucket.try_take(admission_control_semantic_rate);
+}
+
+/**
+  Wait until a semantic request is admitted. The wait is slept in short
+  slices, so that a KILL is noticed.
+
+  @return AC_ADMITTED - Admitted
+          AC_KILLED   - Killed while waiting for admission
+*/
+Ac_result AC::semantic_request_enter(THD *thd) {
+  ulonglong wait_us = semantic_request_try(thd);
+  if (!wait_us) return Ac_result::AC_ADMITTED;
+
+  ++total_semantic_waits;
+  Ac_result res = Ac_result::AC_ADMITTED;
+  const char *prev_proc_info = thd ? thd->proc_info() : nullptr;
+  if (thd) THD_STAGE_INFO(thd, stage_waiting_for_semantic_admission);
+  for (; wait_us; wait_us = semantic_request_try(thd)) {
+    if (thd && thd->killed) {
+      res = Ac_result::AC_KILLED;
+      break;
+    }
+    my_sleep(std::min<ulonglong>(wait_us, 100000));
+  }
+  if (thd) thd->set_proc_info(prev_proc_info);
+  return res;
+}
+
+void AC::semantic_request_throttle(ulonglong wait_us) {
+  ++total_semantic_throttles;
+  semantic_bucket.pause(wait_us);
+}
+
+ulonglong Ac_token_bucket::try_take(ulong rate) {
+  std::lock_guard<std::mutex> guard(lock);
+  const ulonglong now = my_micro_time();
+  if (paused_until_us > now) return paused_until_us - now;
+  if (!rate) return 0;
+
+  // A bucket starts out full.
+  tokens = last_refill_us
+               ? tokens + (double)(now - last_refill_us) * rate / 1000000
+               : rate;
+  tokens = std::min(tokens, (double)rate);
+  last_refill_us = now;
+  if (tokens >= 1) {
+    tokens -= 1;
+    return 0;
+  }
+  return (ulonglong)((1 - tokens) * 1000000 / rate) + 1;
+}
+
+void Ac_token_bucket::pause(ulonglong wait_us) {
+  std::lock_guard<std::mutex> guard(lock);
+  paused_until_us = std::max(paused_until_us, my_micro_time() + wait_us);
+}
+
 /**
   Struct to hold AC queue stats. "full" is added to differentiate from
   Ac_error_record::Ac_queue_stats which only holds a subset of stats.
@@ -1118,6 +1244,21 @@ int fill_ac_entities(THD *thd, Table_ref *tables, Item *) {
   DBUG_RETURN(result);
 }
 
+// Names of Ac_result and enum_admission_control_request_mode values.
+static const std::array<std::string, 4> ac_result_names = {
+    "UNKNOWN", "ABORTED", "TIMEOUT", "KILLED"};
+static const std::array<std::string, 4> ac_mode_names = {
+    "UNKNOWN", "QUERY", "LOW_PRI", "HIGH_PRI"};
+
+template <typename T, size_t N>
+static const std::string &ac_name(const std::array<std::string, N> &names,
+                                  T value) {
+  assert(static_cast<ulong>(value) < names.size());
+  return names[static_cast<ulong>(value) < names.size()
+                   ? static_cast<ulong>(value)
+                   : 0];
+}
+
 /**
  * @brief Populate admission_control_errors table.
  * @param thd THD
@@ -1155,21 +1296,11 @@ int fill_ac_errors(THD *thd, Table_ref *tables, Item *) {
       table->field[f++]->store(r.thread_id, true);
 
       // ERROR
-      static std::array<std::string, 4> errors = {"UNKNOWN", "ABORTED",
-                                                  "TIMEOUT", "KILLED"};
-      assert(static_cast<ulong>(r.res) < errors.size());
-      const auto &e = errors[static_cast<ulong>(r.res) < errors.size()
-                                 ? static_cast<ulong>(r.res)
-                                 : 0];
+      const auto &e = ac_name(ac_result_names, r.res);
       table->field[f++]->store(e.c_str(), e.size(), system_charset_info);
 
       // MODE
-      static std::array<std::string, 4> modes = {"UNKNOWN", "QUERY", "LOW_PRI",
-                                                 "HIGH_PRI"};
-      assert(static_cast<ulong>(r.mode) < modes.size());
-      const auto &m = modes[static_cast<ulong>(r.mode) < modes.size()
-                                ? static_cast<ulong>(r.mode)
-                                : 0];
+      const auto &m = ac_name(ac_mode_names, r.mode);
       table->field[f++]->store(m.c_str(), m.size(), system_charset_info);
 
       // LAST_EXIT_TIME
@@ -1236,6 +1367,184 @@ int fill_ac_errors(THD *thd, Table_ref *tables, Item *) {
   DBUG_RETURN(error);
 }
 
+/**
+ * @brief Populate admission_control_waits table.
+ * @param thd THD
+ * @param tables contains the TABLE struct to populate
+ * @retval 0 on success
+ * @retval 1 on failure
+ */
+int fill_ac_waits(THD *thd, Table_ref *tables, Item *) {
+  DBUG_ENTER("fill_ac_waits");
+  TABLE *table = tables->table;
+  int error = 0;
+
+  mysql_rwlock_rdlock(&db_ac->LOCK_ac);
+  for (const auto &pair : db_ac->ac_map) {
+    const std::string &db = pair.first;
+    const auto &ac_info = pair.second;
+
+    mysql_mutex_lock(&ac_info->lock);
+    auto recorder = ac_info->wait_recorder;
+    mysql_mutex_unlock(&ac_info->lock);
+
+    auto iter = recorder.get_iter();
+    while (iter.move()) {
+      const auto &r = iter.get();
+
+      int f = 0;
+
+      // SCHEMA_NAME
+      table->field[f++]->store(db.c_str(), db.size(), system_charset_info);
+
+      // TIME
+      table->field[f++]->store((double)r.timestamp_us / 1000000);
+
+      // THREAD_ID
+      table->field[f++]->store(r.thread_id, true);
+
+      // RESULT, an admitted query has no error
+      const auto &e = r.res == Ac_result::AC_ADMITTED
+                          ? std::string("ADMITTED")
+                          : ac_name(ac_result_names, r.res);
+      table->field[f++]->store(e.c_str(), e.size(), system_charset_info);
+
+      // MODE
+      const auto &m = ac_name(ac_mode_names, r.mode);
+      table->field[f++]->store(m.c_str(), m.size(), system_charset_info);
+
+      // QUEUE
+      table->field[f++]->store(r.queue, true);
+
+      // QUEUE_LENGTH
+      table->field[f++]->store(r.queue_length, true);
+
+      // WAIT_TIME
+      table->field[f++]->store((double)r.wait_us / 1000000);
+
+      // SQL_ID
+      std::array<char, DIGEST_HASH_TO_STRING_LENGTH> sql_id_string;
+      array_to_hex(sql_id_string.data(), r.sql_id.data(), r.sql_id.size());
+      table->field[f++]->store(sql_id_string.data(), sql_id_string.size(),
+                               system_charset_info);
+
+      if (schema_table_store_record(thd, table)) {
+        error = 1;
+        break;
+      }
+    }
+
+    if (error) {
+      break;
+    }
+  }
+
+  mysql_rwlock_unlock(&db_ac->LOCK_ac);
+
+  DBUG_RETURN(error);
+}
+
+struct Ac_queue_wait_stats {
+  ulong timeout;
+  ulong aborted;
+  ulonglong killed;
+  std::array<ulonglong, AC_WAIT_BUCKETS> wait_histogram;
+  ulonglong wait_time_us;
+  ulonglong max_wait_time_us;
+};
+
+/**
+ * @brief Populate admission_control_wait_histogram table.
+ * @param thd THD
+ * @param tables contains the TABLE struct to populate
+ * @retval 0 on success
+ * @retval 1 on failure
+ */
+int fill_ac_wait_histogram(THD *thd, Table_ref *tables, Item *) {
+  DBUG_ENTER("fill_ac_wait_histogram");
+  TABLE *table = tables->table;
+  int result = 0;
+  std::array<Ac_queue_wait_stats, MAX_AC_QUEUES> queue_stats;
+
+  mysql_rwlock_rdlock(&db_ac->LOCK_ac);
+  for (const auto &pair : db_ac->ac_map) {
+    const std::string &db = pair.first;
+    const auto &ac_info = pair.second;
+
+    // Copy the counters, see fill_ac_queue.
+    mysql_mutex_lock(&ac_info->lock);
+    for (ulong i = 0; i < MAX_AC_QUEUES; i++) {
+      const auto &q = ac_info->queues[i];
+      auto &qs = queue_stats[i];
+
+      qs.aborted = q.aborted_queries;
+      qs.timeout = q.timeout_queries;
+      qs.killed = q.killed_queries;
+      qs.wait_histogram = q.wait_histogram;
+      qs.wait_time_us = q.wait_time_us;
+      qs.max_wait_time_us = q.max_wait_time_us;
+    }
+    mysql_mutex_unlock(&ac_info->lock);
+
+    for (ulong i = 0; i < MAX_AC_QUEUES; i++) {
+      const auto &qs = queue_stats[i];
+
+      ulonglong admissions = 0;
+      for (const auto count : qs.wait_histogram) admissions += count;
+
+      // Skip queues that were never used.
+      if (admissions == 0 && qs.aborted == 0 && qs.timeout == 0 &&
+          qs.killed == 0) {
+        continue;
+      }
+
+      int f = 0;
+
+      // SCHEMA_NAME
+      table->field[f++]->store(db.c_str(), db.size(), system_charset_info);
+
+      // QUEUE_ID
+      table->field[f++]->store((ulonglong)i, true);
+
+      // ADMISSIONS
+      table->field[f++]->store(admissions, true);
+
+      // WAITS_UNDER_1MS .. WAITS_OVER_10S
+      for (const auto count : qs.wait_histogram) {
+        table->field[f++]->store(count, true);
+      }
+
+      // WAIT_TIME
+      table->field[f++]->store((double)qs.wait_time_us / 1000000);
+
+      // MAX_WAIT_TIME
+      table->field[f++]->store((double)qs.max_wait_time_us / 1000000);
+
+      // ABORTED_QUERIES
+      table->field[f++]->store((ulonglong)qs.aborted, true);
+
+      // TIMEOUT_QUERIES
+      table->field[f++]->store((ulonglong)qs.timeout, true);
+
+      // KILLED_QUERIES
+      table->field[f++]->store(qs.killed, true);
+
+      if (schema_table_store_record(thd, table)) {
+        result = 1;
+        break;
+      }
+    }
+
+    if (result) {
+      break;
+    }
+  }
+
+  mysql_rwlock_unlock(&db_ac->LOCK_ac);
+
+  DBUG_RETURN(result);
+}
+
 st_ac_node::st_ac_node(THD *thd_arg)
     : running(false), queued(false), queue(0), thd(thd_arg) {
   mysql_mutex_init(key_LOCK_ac_node, &lock, MY_MUTEX_INIT_FAST);
@@ -1248,7 +1557,9 @@ st_ac_node::~st_ac_node() {
 }
 
 Ac_info::Ac_info(const std::string &_entity)
-    : entity(_entity), error_recorder(admission_control_errors_size) {
+    : entity(_entity),
+      error_recorder(admission_control_errors_size),
+      wait_recorder(admission_control_waits_size) {
   mysql_mutex_init(key_LOCK_ac_info, &lock, MY_MUTEX_INIT_FAST);
 }
 
@@ -1297,6 +1608,49 @@ void Ac_info::log_error(THD *thd, Ac_result res, ulong queue,
   error_recorder.insert(r);
 }
 
+/**
+  Account the wait of a query that was queued, and record it into the wait
+  flight recorder.
+
+  @param res Result of admission.
+  @param wait_us Time spent in the queue.
+  @param queue_length Queries waiting in the queue when it was enqueued.
+  @param mode Readmission mode.
+*/
+void Ac_info::log_wait(THD *thd, Ac_result res, ulong queue, ulonglong wait_us,
+                       ulong queue_length,
+                       enum_admission_control_request_mode mode) {
+  mysql_mutex_assert_owner(&lock);
+
+  // Only admitted queries go to the histogram, the others are counted as
+  // aborted, timed out or killed.
+  auto &q = queues[queue];
+  if (res == Ac_result::AC_ADMITTED) {
+    const auto bound =
+        std::upper_bound(ac_wait_bucket_bounds_us.begin(),
+                         ac_wait_bucket_bounds_us.end(), wait_us);
+    ++q.wait_histogram[bound - ac_wait_bucket_bounds_us.begin()];
+  }
+  q.wait_time_us += wait_us;
+  q.max_wait_time_us = std::max(q.max_wait_time_us, wait_us);
+
+  Ac_wait_record r;
+  r.thread_id = thd->thread_id();
+  r.res = res;
+  r.mode = mode;
+  r.queue = queue;
+  r.wait_us = wait_us;
+  r.queue_length = queue_length;
+
+  if (thd->mt_key_is_set(THD::SQL_ID)) {
+    r.sql_id = thd->mt_key_value(THD::SQL_ID);
+  } else {
+    r.sql_id.fill(0);
+  }
+
+  wait_recorder.insert(r);
+}
+
 AC::AC() { mysql_rwlock_init(key_rwlock_LOCK_ac, &LOCK_ac); }
 
 AC::~AC() { mysql_rwlock_destroy(&LOCK_ac); }
@@ -49,6 +49,7 @@
 #include <atomic>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -67,6 +68,9 @@ extern ulonglong admission_control_wait_events;
 extern ulonglong admission_control_yield_freq;
 extern bool admission_control_multiquery_filter;
 extern ulong admission_control_errors_size;
+extern ulong admission_control_waits_size;
+extern ulong admission_control_semantic_rate;
+extern ulong admission_control_semantic_entity_rate;
 
 class AC;
 class THD;
@@ -80,6 +84,7 @@ extern PSI_stage_info stage_admission_control_enter;
 extern PSI_stage_info stage_admission_control_exit;
 extern PSI_stage_info stage_waiting_for_admission;
 extern PSI_stage_info stage_waiting_for_readmission;
+extern PSI_stage_info stage_waiting_for_semantic_admission;
 #endif
 
 // The contents here must match entries in admission_control_filter_names array
@@ -128,7 +133,12 @@ int multi_tenancy_exit_query(THD *);
 int fill_ac_queue(THD *thd, Table_ref *tables, Item *cond);
 int fill_ac_entities(THD *thd, Table_ref *tables, Item *cond);
 int fill_ac_errors(THD *thd, Table_ref *tables, Item *cond);
+int fill_ac_waits(THD *thd, Table_ref *tables, Item *cond);
+int fill_ac_wait_histogram(THD *thd, Table_ref *tables, Item *cond);
 bool filter_command(enum_sql_command sql_command);
+ulonglong multi_tenancy_try_semantic_request(THD *);
+int multi_tenancy_admit_semantic_request(THD *);
+void multi_tenancy_throttle_semantic_requests(ulonglong wait_us);
 
 /**
   Flight recorder base record all other records should be derived from.
@@ -220,6 +230,32 @@ class Flight_recorder {
   friend class Iter;
 };
 
+/**
+  Token bucket pacing the requests semantic operators send to their model,
+  refilled at a rate of tokens per second up to a burst of one second.
+*/
+class Ac_token_bucket {
+ public:
+  /**
+    Take a token if there is one.
+
+    @param rate tokens per second, 0 for no limit
+
+    @return 0 if a token was taken, otherwise microseconds until there
+            will be one
+  */
+  ulonglong try_take(ulong rate);
+
+  // Hold off all requests for a while, e.g. when the model is overloaded.
+  void pause(ulonglong wait_us);
+
+ private:
+  std::mutex lock;
+  double tokens = 0;
+  ulonglong last_refill_us = 0;
+  ulonglong paused_until_us = 0;
+};
+
 /**
   Per-thread information used in admission control.
 */
@@ -247,6 +283,15 @@ struct st_ac_node {
 using st_ac_node_ptr = std::shared_ptr<st_ac_node>;
 
 const ulong MAX_AC_QUEUES = 10;
+
+/**
+  Upper bounds of the admission wait histogram buckets, in microseconds.
+  The last bucket holds the longer waits.
+*/
+constexpr std::array<ulonglong, 5> ac_wait_bucket_bounds_us = {
+    1000, 10000, 100000, 1000000, 10000000};
+const ulong AC_WAIT_BUCKETS = ac_wait_bucket_bounds_us.size() + 1;
+
 /**
   Represents a queue, and its associated stats.
 */
@@ -264,6 +309,13 @@ struct Ac_queue {
   ulonglong high_pri_enqueues = 0;
   // Track number of low priority enqueues.
   ulonglong low_pri_enqueues = 0;
+  // Track number of queries killed while waiting.
+  ulonglong killed_queries = 0;
+  // Admissions by how long they waited, immediate ones in the first bucket.
+  std::array<ulonglong, AC_WAIT_BUCKETS> wait_histogram{};
+  // Total and longest time queries waited in this queue.
+  ulonglong wait_time_us = 0;
+  ulonglong max_wait_time_us = 0;
 };
 
 enum class Ac_result {
@@ -305,6 +357,26 @@ struct Ac_error_record : public Fr_record {
   digest_key sql_id;
 };
 
+/**
+  Admission control entity flight record for queries that waited in a queue.
+*/
+struct Ac_wait_record : public Fr_record {
+  // THD ID of the query.
+  my_thread_id thread_id;
+  // Admission control result after the wait.
+  Ac_result res;
+  // Admission control enqueue mode.
+  enum_admission_control_request_mode mode;
+  // Queue id of this query.
+  ulong queue;
+  // Time spent waiting in the queue.
+  ulonglong wait_us;
+  // Queries waiting in the queue when this query was enqueued.
+  ulong queue_length;
+  // SQL ID of the query.
+  digest_key sql_id;
+};
+
 /**
   Class used in admission control.
 
@@ -317,6 +389,8 @@ class Ac_info {
   friend int fill_ac_queue(THD *thd, Table_ref *tables, Item *cond);
   friend int fill_ac_entities(THD *thd, Table_ref *tables, Item *cond);
   friend int fill_ac_errors(THD *thd, Table_ref *tables, Item *cond);
+  friend int fill_ac_waits(THD *thd, Table_ref *tables, Item *cond);
+  friend int fill_ac_wait_histogram(THD *thd, Table_ref *tables, Item *cond);
 
   // Queues
   std::array<Ac_queue, MAX_AC_QUEUES> queues{};
@@ -344,6 +418,9 @@ class Ac_info {
   // Flight recorder for errors.
   Flight_recorder<Ac_error_record> error_recorder;
 
+  // Flight recorder for queue waits.
+  Flight_recorder<Ac_wait_record> wait_recorder;
+
   // Track number of high priority enqueues.
   ulonglong high_pri_enqueues = 0;
   // Track number of low priority enqueues.
@@ -353,6 +430,9 @@ class Ac_info {
   // Timestamp of the last admission control exit.
   ulonglong last_exit_timestamp_us = 0;
 
+  // Paces the semantic requests of this entity.
+  Ac_token_bucket semantic_bucket;
+
  public:
   Ac_info(const std::string &);
   ~Ac_info();
@@ -367,6 +447,10 @@ class Ac_info {
   void log_error(THD *thd, Ac_result res, ulong queue, ulonglong prev_high_pri,
                  ulonglong prev_exits,
                  enum_admission_control_request_mode mode);
+
+  // Account the wait of a query that was queued, and record it.
+  void log_wait(THD *thd, Ac_result res, ulong queue, ulonglong wait_us,
+                ulong queue_length, enum_admission_control_request_mode mode);
 };
 
 using Ac_info_ptr = std::shared_ptr<Ac_info>;
@@ -378,6 +462,8 @@ class AC {
   friend int fill_ac_queue(THD *thd, Table_ref *tables, Item *cond);
   friend int fill_ac_entities(THD *thd, Table_ref *tables, Item *cond);
   friend int fill_ac_errors(THD *thd, Table_ref *tables, Item *cond);
+  friend int fill_ac_waits(THD *thd, Table_ref *tables, Item *cond);
+  friend int fill_ac_wait_histogram(THD *thd, Table_ref *tables, Item *cond);
 
   // This map is protected by the rwlock LOCK_ac.
   using Ac_info_ptr_container = std::unordered_map<std::string, Ac_info_ptr>;
@@ -401,6 +487,11 @@ class AC {
   std::atomic_ullong total_timeout_queries{0};
   std::atomic_ullong total_rejected_connections{0};
 
+  // Paces the semantic requests of all entities.
+  Ac_token_bucket semantic_bucket;
+  std::atomic_ullong total_semantic_waits{0};
+  std::atomic_ullong total_semantic_throttles{0};
+
  public:
   AC();
   ~AC();
@@ -453,6 +544,14 @@ class AC {
   ulong get_total_running_queries() const;
 
   ulong get_total_waiting_queries() const;
+
+  ulonglong semantic_request_try(THD *);
+  Ac_result semantic_request_enter(THD *);
+  void semantic_request_throttle(ulonglong wait_us);
+  ulonglong get_total_semantic_waits() const { return total_semantic_waits; }
+  ulonglong get_total_semantic_throttles() const {
+    return total_semantic_throttles;
+  }
 };
 
 /**
@@ -114,6 +114,7 @@
 #include "sql/partitioning/partition_handler.h"
 #include "sql/psi_memory_key.h"  // key_memory_TABLE
 #include "sql/query_options.h"
+#include "sql/query_result_cache.h"  // query_result_cache_invalidate
 #include "sql/rpl_gtid.h"
 #include "sql/rpl_handler.h"                       // RUN_HOOK
 #include "sql/rpl_replica_commit_order_manager.h"  // has_commit_order_manager
@@ -10491,6 +10492,9 @@ void tdc_remove_table(THD *thd, enum_tdc_remove_table_type remove_type,
          thd->mdl_context.owns_equal_or_stronger_lock(
              MDL_key::TABLE, db, table_name, MDL_EXCLUSIVE));
 
+  // The table is changed or dropped, cached results read from it are stale.
+  query_result_cache_invalidate(db, table_name);
+
   key_length = create_table_def_key(db, table_name, key);
 
   auto it = table_def_cache->find(string(key, key_length));
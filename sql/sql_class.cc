@@ -70,6 +70,7 @@
 #include "sql/auth/auth_acls.h"
 #include "sql/auth/sql_security_ctx.h"
 #include "sql/binlog.h"
+#include "sql/change_stream.h"  // change_stream_end_trans
 #include "sql/check_stack.h"
 #include "sql/conn_handler/connection_handler_manager.h"  // Connection_handler_manager
 #include "sql/current_thd.h"
@@ -87,6 +88,7 @@
 #include "sql/lock.h"             // mysql_lock_abort_for_thread
 #include "sql/locking_service.h"  // release_all_locking_service_locks
 #include "sql/log_event.h"
+#include "sql/materialized_view.h"   // materialized_view_end_trans
 #include "sql/mdl_context_backup.h"  // MDL context backup for XA
 #include "sql/mysqld.h"              // global_system_variables ...
 #include "sql/mysqld_thd_manager.h"  // Global_THD_manager
@@ -1646,6 +1648,9 @@ void THD::release_resources() {
 
   stmt_map.reset(); /* close all prepared statements */
   if (!is_cleanup_done()) cleanup();
+  /* keys left by a transaction that never ended, e.g. a prepared XA one */
+  materialized_view_end_trans(this, false);
+  change_stream_end_trans(this, false);
 
   ha_close_connection(this);
 
@@ -3676,6 +3681,33 @@ bool THD::fillMetadata(struct st_ok_metadata &metadata) {
   return hasMetadata;
 }
 
+bool THD::can_defer_commit_ack() const {
+  return m_commit_ack.deferrable && !in_sub_stmt && !slave_thread &&
+         system_thread == NON_SYSTEM_THREAD;
+}
+
+void THD::defer_commit_ack(Commit_ack_waiter *waiter, ulonglong ticket) {
+  assert(can_defer_commit_ack());
+  // a commit in another engine earlier in the statement
+  if (m_commit_ack.waiter != nullptr && m_commit_ack.waiter != waiter) {
+    m_commit_ack.waiter->sync(m_commit_ack.ticket);
+    m_commit_ack.ticket = 0;
+  }
+  m_commit_ack.waiter = waiter;
+  m_commit_ack.ticket = std::max(m_commit_ack.ticket, ticket);
+}
+
+bool THD::complete_commit_ack() {
+  bool error = m_commit_ack.waiter != nullptr &&
+               m_commit_ack.waiter->sync(m_commit_ack.ticket);
+  if (m_commit_ack.deferred && !error)
+    error = net_flush(get_protocol_classic()->get_net());
+  m_commit_ack.waiter = nullptr;
+  m_commit_ack.ticket = 0;
+  m_commit_ack.deferred = false;
+  return error;
+}
+
 void THD::send_statement_status() {
   DBUG_TRACE;
   assert(!get_stmt_da()->is_sent());
@@ -3685,6 +3717,16 @@ void THD::send_statement_status() {
   /* Can not be true, but do not take chances in production. */
   if (da->is_sent()) return;
 
+  if (m_commit_ack.waiter != nullptr) {
+    // the OK packet of the last statement of the command waits for the
+    // sync, any other status is sent once it is done
+    if (m_commit_ack.deferrable && da->status() == Diagnostics_area::DA_OK &&
+        !(server_status & SERVER_MORE_RESULTS_EXISTS))
+      m_commit_ack.deferred = true;
+    else
+      complete_commit_ack();
+  }
+
   struct st_ok_metadata meta;
   bool sendMetadata = fillMetadata(meta);
   switch (da->status()) {
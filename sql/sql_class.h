@@ -196,6 +196,9 @@ class Time_zone;
 class sp_cache;
 struct Binlog_user_var_event;
 struct LOG_INFO;
+struct Change_stream_trans;
+struct Materialized_view_deltas;
+struct Query_result_cache_statement;
 
 typedef struct user_conn USER_CONN;
 struct MYSQL_LOCK;
@@ -904,6 +907,21 @@ class Transactional_ddl_context {
 
 struct PS_PARAM;
 
+/**
+  The durability of commits acknowledged after their engine returned, before
+  its log was synced, see THD::defer_commit_ack(). Implemented by engines.
+*/
+class Commit_ack_waiter {
+ public:
+  virtual ~Commit_ack_waiter() = default;
+
+  /**
+    Make the commits up to ticket durable, e.g. by syncing the log.
+    @return true on error
+  */
+  virtual bool sync(ulonglong ticket) = 0;
+};
+
 /**
   @class THD
   For each client connection we create a separate thread with THD serving as
@@ -1053,6 +1071,43 @@ class THD : public MDL_context_owner,
   /* Is transaction commit still pending */
   bool tx_commit_pending;
 
+  /**
+    A commit of the statement whose log its engine did not sync. The OK
+    packet of the statement is left in the network buffer for the connection
+    handler to send once waiter synced it, if the handler is deferrable,
+    otherwise the log is synced before the status is sent.
+  */
+  struct Commit_ack {
+    Commit_ack_waiter *waiter{nullptr};
+    ulonglong ticket{0};
+    /// The connection handler completes deferred acknowledgements.
+    bool deferrable{false};
+    /// The OK packet waits in the network buffer.
+    bool deferred{false};
+  } m_commit_ack;
+
+  /**
+    Whether an engine may commit without syncing its log, and leave it to
+    defer_commit_ack(). Not in sub-statements, nor for system threads.
+  */
+  bool can_defer_commit_ack() const;
+
+  /**
+    Have the acknowledgement of the commit just done wait for waiter to
+    make ticket durable.
+  */
+  void defer_commit_ack(Commit_ack_waiter *waiter, ulonglong ticket);
+
+  /**
+    Sync the commit acknowledged last, and send its OK packet if it was
+    deferred.
+    @return true on error, the OK packet is not sent then
+  */
+  bool complete_commit_ack();
+
+  /// The statement whose result is captured for the query result cache.
+  Query_result_cache_statement *m_result_cache{nullptr};
+
   /* Column usage statistics for the SQL statements */
   std::set<ColumnUsageInfo> column_usage_info;
 
@@ -4997,6 +5052,8 @@ class THD : public MDL_context_owner,
   std::string trace_id;
   uint64_t pc_val;
   std::shared_ptr<utils::PerfCounter> query_perf;
+  // engine counters of a sampled statement, written to the slow log
+  std::string engine_perf_context;
 
  private:
   /** The current internal error handler for this thread, or NULL. */
@@ -5314,6 +5371,14 @@ class THD : public MDL_context_owner,
   ulonglong readmission_count = 0;
   std::function<bool()> yield_cond;
 
+  /* keys of the rows the transaction changed in the base tables of
+     materialized views, logged for the views once it commits */
+  Materialized_view_deltas *mv_deltas = nullptr;
+
+  /* images of the rows the transaction changed in tables followed by
+     change stream subscribers, delivered once it commits */
+  Change_stream_trans *cs_trans = nullptr;
+
   /**
     Default yield predicate that always returns true.
   */
@@ -24,6 +24,8 @@
 
 #include "sql/sql_dump.h"
 
+#include <memory>
+
 #include "auth/auth_acls.h"
 #include "mysql/components/services/log_builtins.h"
 #include "sql/debug_sync.h"
@@ -37,6 +39,7 @@
 #include "sql/snapshot.h"
 #include "sql/sql_base.h"
 #include "sql/sql_class.h"
+#include "sql/sql_dump_parquet.h"
 #include "sql/sql_error.h"
 #include "sql/table.h"
 #include "sql/transaction.h"
@@ -66,6 +69,7 @@ bool Sql_cmd_dump_table::dump_chunk(Table_ref *tr, mem_root_deque<Item *> *list,
   uchar *rowbuf = table->record[0];
   int numrows = 0;
   char filename[FN_REFLEN];
+  std::unique_ptr<Dump_parquet_writer> parquet;
 
 #ifdef HAVE_PSI_THREAD_INTERFACE
   // Set in pfs threads table / SHOW PROCESSLIST /
@@ -78,22 +82,32 @@ bool Sql_cmd_dump_table::dump_chunk(Table_ref *tr, mem_root_deque<Item *> *list,
 #endif
 
   // Create a filename with the chunk suffix.
-  snprintf(filename, sizeof(filename), "%s.%" PRId64, m_filename.str,
-           work->chunk_id);
+  snprintf(filename, sizeof(filename),
+           m_format == Dump_format::PARQUET ? "%s.%" PRId64 ".parquet"
+                                            : "%s.%" PRId64,
+           m_filename.str, work->chunk_id);
   sql_exchange exchange(filename, false /* dumpfile */, FILETYPE_CSV);
 
   // Create a result_export with the filename above and default escape options.
   // TODO: add grammar to customize field/line sep options.
   Query_result_export result(&exchange);
 
-  if (result.prepare(thd, *list, nullptr /* query expression */)) {
-    is_err = true;
-    goto exit;
-  }
+  if (m_format == Dump_format::PARQUET) {
+    parquet = std::make_unique<Dump_parquet_writer>(*list, m_compress);
+    if (parquet->open(thd, filename)) {
+      is_err = true;
+      goto exit;
+    }
+  } else {
+    if (result.prepare(thd, *list, nullptr /* query expression */)) {
+      is_err = true;
+      goto exit;
+    }
 
-  if (result.start_execution(thd)) {
-    is_err = true;
-    goto exit;
+    if (result.start_execution(thd)) {
+      is_err = true;
+      goto exit;
+    }
   }
 
   // Start a scan from the range given.
@@ -130,7 +144,14 @@ bool Sql_cmd_dump_table::dump_chunk(Table_ref *tr, mem_root_deque<Item *> *list,
                ("read row %d in chunk %" PRId64, numrows, work->chunk_id));
 
     // send rowbuf to result (which will be the chunk file).
-    result.send_data(thd, *list);
+    if (parquet) {
+      if (parquet->write_row()) {
+        is_err = true;
+        goto exit;
+      }
+    } else {
+      result.send_data(thd, *list);
+    }
 
     // See if we've dumped all the rows for this chunk.
     if (numrows == work->nrows) {
@@ -157,6 +178,9 @@ bool Sql_cmd_dump_table::dump_chunk(Table_ref *tr, mem_root_deque<Item *> *list,
     }
   }
 
+  // Row groups are only readable once the footer is written.
+  if (parquet && parquet->close()) is_err = true;
+
 exit:
   result.cleanup();
 
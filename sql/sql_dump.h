@@ -66,6 +66,16 @@ class Sql_cmd_dump_table final : public Sql_cmd {
 
   void set_consistent(bool consistent) { m_consistent = consistent; }
 
+  /**
+    @param format    output format of the chunks
+    @param compress  whether Parquet output is compressed with zstd
+  */
+  void set_format(Dump_format format, bool compress) {
+    assert(format != Dump_format::UNSET);
+    m_format = format;
+    m_compress = compress;
+  }
+
  private:
   struct Dump_work_item {
     /**
@@ -173,4 +183,10 @@ class Sql_cmd_dump_table final : public Sql_cmd {
 
   // Should a consistent snapshot be used? Not all storage engines support it.
   bool m_consistent{false};
+
+  // Output format of the chunks.
+  Dump_format m_format{Dump_format::CSV};
+
+  // Compress Parquet output with zstd.
+  bool m_compress{true};
 };
@@ -0,0 +1,704 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/sql_dump_parquet.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <zstd.h>
+
+#include "decimal.h"
+#include "m_ctype.h"
+#include "my_byteorder.h"
+#include "my_dir.h"
+#include "my_systime.h"
+#include "my_time.h"
+#include "mysql/psi/mysql_file.h"
+#include "mysqld_error.h"
+#include "sql/fb_vector_base.h"
+#include "sql/field.h"
+#include "sql/item.h"
+#include "sql/key.h"
+#include "sql/my_decimal.h"
+#include "sql/mysqld.h"
+#include "sql/sql_class.h"
+#include "sql/table.h"
+#include "sql_string.h"
+#include "template_utils.h"
+
+namespace {
+
+/// Buffered rows are written as a row group when they reach this size.
+constexpr uint64 ROW_GROUP_SIZE = 64 * 1024 * 1024;
+
+// Values of the enums of parquet.thrift.
+constexpr int TYPE_INT32 = 1;
+constexpr int TYPE_INT64 = 2;
+constexpr int TYPE_FLOAT = 4;
+constexpr int TYPE_DOUBLE = 5;
+constexpr int TYPE_BYTE_ARRAY = 6;
+
+constexpr int CONVERTED_UTF8 = 0;
+constexpr int CONVERTED_LIST = 3;
+constexpr int CONVERTED_DECIMAL = 5;
+constexpr int CONVERTED_DATE = 6;
+constexpr int CONVERTED_TIME_MICROS = 8;
+constexpr int CONVERTED_TIMESTAMP_MICROS = 10;
+constexpr int CONVERTED_UINT_64 = 14;
+constexpr int CONVERTED_INT_64 = 18;
+
+constexpr int REQUIRED = 0;
+constexpr int OPTIONAL = 1;
+constexpr int REPEATED = 2;
+
+constexpr int ENCODING_PLAIN = 0;
+constexpr int ENCODING_RLE = 3;
+constexpr int CODEC_UNCOMPRESSED = 0;
+constexpr int CODEC_ZSTD = 6;
+constexpr int PAGE_DATA = 0;
+
+const char PARQUET_MAGIC[] = "PAR1";
+
+void put_varint(std::string *out, uint64 value) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void put_int32(std::string *out, int32 value) {
+  char buf[4];
+  int4store(buf, static_cast<uint32>(value));
+  out->append(buf, sizeof(buf));
+}
+
+/**
+  Writes structs in the Thrift compact protocol, the encoding of the page
+  headers and the footer of Parquet files.
+*/
+class Thrift_writer {
+ public:
+  enum Type : uchar { I32 = 5, I64 = 6, BINARY = 8, LIST = 9, STRUCT = 12 };
+
+  std::string out;
+
+  void i32(int16 id, int32 value) {
+    field(id, I32);
+    put_varint(&out, zigzag(value));
+  }
+  void i64(int16 id, int64 value) {
+    field(id, I64);
+    put_varint(&out, zigzag(value));
+  }
+  void binary(int16 id, const std::string &value) {
+    field(id, BINARY);
+    binary_element(value);
+  }
+  void list(int16 id, Type element_type, size_t size) {
+    field(id, LIST);
+    if (size < 15) {
+      out.push_back(static_cast<char>(size << 4 | element_type));
+    } else {
+      out.push_back(static_cast<char>(0xf0 | element_type));
+      put_varint(&out, size);
+    }
+  }
+  void i32_element(int32 value) { put_varint(&out, zigzag(value)); }
+  void binary_element(const std::string &value) {
+    put_varint(&out, value.size());
+    out.append(value);
+  }
+
+  /// A struct field, or a struct element of a list if id is 0.
+  void begin_struct(int16 id = 0) {
+    if (id != 0) field(id, STRUCT);
+    m_last_ids.push_back(m_last_id);
+    m_last_id = 0;
+  }
+  void end_struct() {
+    out.push_back(0);
+    m_last_id = m_last_ids.back();
+    m_last_ids.pop_back();
+  }
+
+ private:
+  static uint64 zigzag(int64 value) {
+    return (static_cast<uint64>(value) << 1) ^ static_cast<uint64>(value >> 63);
+  }
+
+  void field(int16 id, Type type) {
+    const int delta = id - m_last_id;
+    if (delta > 0 && delta <= 15) {
+      out.push_back(static_cast<char>(delta << 4 | type));
+    } else {
+      out.push_back(static_cast<char>(type));
+      put_varint(&out, zigzag(id));
+    }
+    m_last_id = id;
+  }
+
+  int16 m_last_id{0};
+  std::vector<int16> m_last_ids;
+};
+
+/// The column of a vector index on the field, nullptr if there is none.
+Field *vector_index_field(Item *item) {
+  if (item->real_item()->type() != Item::FIELD_ITEM) return nullptr;
+  Field *field = down_cast<Item_field *>(item->real_item())->field;
+  const TABLE *table = field->table;
+  for (uint i = 0; i < table->s->keys; i++) {
+    const KEY &key = table->key_info[i];
+    const FB_vector_index_config &config = key.fb_vector_index_config;
+    if (key.is_fb_vector_index() && !config.multi() && !config.sparse() &&
+        key.key_part[0].field != nullptr &&
+        key.key_part[0].field->field_index() == field->field_index())
+      return field;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+void Dump_parquet_writer::Levels::add(uint level) {
+  if (m_count > 0 && level == m_level) {
+    m_count++;
+    return;
+  }
+  flush();
+  m_level = level;
+  m_count = 1;
+}
+
+void Dump_parquet_writer::Levels::flush() {
+  if (m_count == 0) return;
+  // A run of the hybrid encoding, the levels fit in a byte.
+  put_varint(&m_runs, m_count << 1);
+  m_runs.push_back(static_cast<char>(m_level));
+  m_count = 0;
+}
+
+void Dump_parquet_writer::Levels::finish(std::string *out) {
+  flush();
+  put_int32(out, static_cast<int32>(m_runs.size()));
+  out->append(m_runs);
+  m_runs.clear();
+}
+
+Dump_parquet_writer::Dump_parquet_writer(const mem_root_deque<Item *> &items,
+                                         bool compress)
+    : m_compress(compress) {
+  m_path[0] = '\0';
+  for (Item *item : items) {
+    Column column;
+    column.item = item;
+    column.vector_field = vector_index_field(item);
+    switch (item->data_type()) {
+      case MYSQL_TYPE_TINY:
+      case MYSQL_TYPE_SHORT:
+      case MYSQL_TYPE_INT24:
+      case MYSQL_TYPE_LONG:
+      case MYSQL_TYPE_LONGLONG:
+      case MYSQL_TYPE_YEAR:
+        column.kind = item->unsigned_flag ? Kind::UINT64 : Kind::INT64;
+        break;
+      case MYSQL_TYPE_BIT:
+        column.kind = Kind::UINT64;
+        break;
+      case MYSQL_TYPE_FLOAT:
+        column.kind = Kind::FLOAT;
+        break;
+      case MYSQL_TYPE_DOUBLE:
+        column.kind = Kind::DOUBLE;
+        break;
+      case MYSQL_TYPE_DECIMAL:
+      case MYSQL_TYPE_NEWDECIMAL:
+        // Wider decimals would need FIXED_LEN_BYTE_ARRAY, they are strings.
+        column.precision = item->decimal_precision();
+        column.scale = item->decimals;
+        column.kind = column.precision <= 18 ? Kind::DECIMAL : Kind::STRING;
+        break;
+      case MYSQL_TYPE_DATE:
+      case MYSQL_TYPE_NEWDATE:
+        column.kind = Kind::DATE;
+        break;
+      case MYSQL_TYPE_DATETIME:
+      case MYSQL_TYPE_DATETIME2:
+        column.kind = Kind::DATETIME;
+        break;
+      case MYSQL_TYPE_TIMESTAMP:
+      case MYSQL_TYPE_TIMESTAMP2:
+        column.kind = Kind::TIMESTAMP;
+        break;
+      case MYSQL_TYPE_TIME:
+      case MYSQL_TYPE_TIME2:
+        column.kind = Kind::TIME;
+        break;
+      default:
+        column.kind = item->collation.collation == &my_charset_bin
+                          ? Kind::BINARY
+                          : Kind::STRING;
+        break;
+    }
+    if (column.vector_field != nullptr) column.kind = Kind::VECTOR;
+    m_columns.push_back(std::move(column));
+  }
+}
+
+Dump_parquet_writer::~Dump_parquet_writer() {
+  if (m_file >= 0) {
+    end_io_cache(&m_cache);
+    mysql_file_close(m_file, MYF(0));
+  }
+}
+
+bool Dump_parquet_writer::open(THD *thd, const char *file_name) {
+  if (!dirname_length(file_name)) {
+    strxnmov(m_path, FN_REFLEN - 1, mysql_real_data_home,
+             thd->db().str ? thd->db().str : "", NullS);
+    (void)fn_format(m_path, file_name, m_path, "",
+                    MY_UNPACK_FILENAME | MY_RELATIVE_PATH);
+  } else {
+    (void)fn_format(m_path, file_name, mysql_real_data_home, "",
+                    MY_UNPACK_FILENAME | MY_RELATIVE_PATH);
+  }
+
+  if (!is_secure_file_path(m_path)) {
+    my_error(ER_OPTION_PREVENTS_STATEMENT, MYF(0), "--secure-file-priv", "");
+    return true;
+  }
+  if (!my_access(m_path, F_OK)) {
+    my_error(ER_FILE_EXISTS_ERROR, MYF(0), file_name);
+    return true;
+  }
+
+  m_file = mysql_file_create(key_select_to_file, m_path,
+                             S_IRUSR | S_IWUSR | S_IRGRP, O_WRONLY | O_EXCL,
+                             MYF(MY_WME));
+  if (m_file < 0) return true;
+  if (init_io_cache(&m_cache, m_file, thd->variables.select_into_buffer_size,
+                    WRITE_CACHE, 0L, true, MYF(MY_WME))) {
+    mysql_file_close(m_file, MYF(0));
+    m_file = -1;
+    return true;
+  }
+  return write(std::string(PARQUET_MAGIC, 4));
+}
+
+bool Dump_parquet_writer::add_value(Column *column) {
+  Item *item = column->item;
+  char buf[8];
+
+  switch (column->kind) {
+    case Kind::INT64:
+    case Kind::UINT64: {
+      const longlong value = item->val_int();
+      if (item->null_value) break;
+      int8store(buf, static_cast<ulonglong>(value));
+      column->values.append(buf, 8);
+      column->def_levels.add(1);
+      return false;
+    }
+    case Kind::FLOAT:
+    case Kind::DOUBLE: {
+      const double value = item->val_real();
+      if (item->null_value) break;
+      if (column->kind == Kind::FLOAT) {
+        float4store(buf, static_cast<float>(value));
+        column->values.append(buf, 4);
+      } else {
+        float8store(buf, value);
+        column->values.append(buf, 8);
+      }
+      column->def_levels.add(1);
+      return false;
+    }
+    case Kind::DECIMAL: {
+      my_decimal value_buf;
+      const my_decimal *value = item->val_decimal(&value_buf);
+      if (value == nullptr || item->null_value) break;
+      // The unscaled value, e.g. 12345 for 123.45 of DECIMAL(5, 2).
+      my_decimal unscaled = *value;
+      longlong number = 0;
+      if (decimal_shift(&unscaled, column->scale) != E_DEC_OK ||
+          decimal2longlong(&unscaled, &number) != E_DEC_OK) {
+        my_error(ER_DATA_OUT_OF_RANGE, MYF(0), "DECIMAL", item->full_name());
+        return true;
+      }
+      int8store(buf, static_cast<ulonglong>(number));
+      column->values.append(buf, 8);
+      column->def_levels.add(1);
+      return false;
+    }
+    case Kind::DATE:
+    case Kind::DATETIME: {
+      MYSQL_TIME ltime;
+      if (item->get_date(&ltime, TIME_FUZZY_DATE) || ltime.month == 0 ||
+          ltime.day == 0)
+        break;
+      const longlong days = calc_daynr(ltime.year, ltime.month, ltime.day) -
+                            calc_daynr(1970, 1, 1);
+      if (column->kind == Kind::DATE) {
+        int4store(buf, static_cast<uint32>(days));
+        column->values.append(buf, 4);
+      } else {
+        // Wall clock time, not adjusted to UTC.
+        const longlong micros =
+            ((days * 24 + ltime.hour) * 60 + ltime.minute) * 60 * 1000000LL +
+            ltime.second * 1000000LL + ltime.second_part;
+        int8store(buf, static_cast<ulonglong>(micros));
+        column->values.append(buf, 8);
+      }
+      column->def_levels.add(1);
+      return false;
+    }
+    case Kind::TIMESTAMP: {
+      my_timeval tm;
+      int warnings = 0;
+      if (item->get_timeval(&tm, &warnings)) break;
+      int8store(buf, static_cast<ulonglong>(tm.m_tv_sec * 1000000LL +
+                                            tm.m_tv_usec));
+      column->values.append(buf, 8);
+      column->def_levels.add(1);
+      return false;
+    }
+    case Kind::TIME: {
+      MYSQL_TIME ltime;
+      if (item->get_time(&ltime)) break;
+      longlong micros =
+          ((ltime.hour * 60LL + ltime.minute) * 60 + ltime.second) * 1000000LL +
+          ltime.second_part;
+      if (ltime.neg) micros = -micros;
+      int8store(buf, static_cast<ulonglong>(micros));
+      column->values.append(buf, 8);
+      column->def_levels.add(1);
+      return false;
+    }
+    case Kind::STRING:
+    case Kind::BINARY: {
+      StringBuffer<MAX_FIELD_WIDTH> value_buf;
+      const String *value = item->val_str(&value_buf);
+      if (value == nullptr || item->null_value) break;
+      String converted;
+      const CHARSET_INFO *cs = value->charset();
+      if (column->kind == Kind::STRING && cs != &my_charset_bin &&
+          !my_charset_same(cs, &my_charset_utf8mb4_bin)) {
+        uint errors;
+        if (converted.copy(value->ptr(), value->length(), cs,
+                           &my_charset_utf8mb4_bin, &errors))
+          return true;
+        value = &converted;
+      }
+      put_int32(&column->values, static_cast<int32>(value->length()));
+      column->values.append(value->ptr(), value->length());
+      column->def_levels.add(1);
+      return false;
+    }
+    case Kind::VECTOR: {
+      Field *field = column->vector_field;
+      if (field->is_null()) break;
+      Fb_vector blob_vector;
+      std::vector<float> json_vector;
+      const float *data;
+      size_t dimension;
+      if (field->type() == MYSQL_TYPE_JSON) {
+        Json_wrapper wrapper;
+        if (down_cast<Field_json *>(field)->val_json(&wrapper) ||
+            parse_fb_vector_from_json(wrapper, json_vector)) {
+          my_error(ER_INCORRECT_TYPE, MYF(0), field->field_name,
+                   "DUMP TABLE");
+          return true;
+        }
+        data = json_vector.data();
+        dimension = json_vector.size();
+      } else {
+        if (parse_fb_vector_from_blob(field, blob_vector)) {
+          my_error(ER_INCORRECT_TYPE, MYF(0), field->field_name,
+                   "DUMP TABLE");
+          return true;
+        }
+        data = blob_vector.get_data_view();
+        dimension = blob_vector.get_dimension();
+      }
+      // An empty list is defined up to the list, the elements are required.
+      if (dimension == 0) {
+        column->rep_levels.add(0);
+        column->def_levels.add(1);
+        column->num_values++;
+        return false;
+      }
+      for (size_t i = 0; i < dimension; i++) {
+        float4store(buf, data[i]);
+        column->values.append(buf, 4);
+        column->rep_levels.add(i == 0 ? 0 : 1);
+        column->def_levels.add(2);
+      }
+      column->num_values += dimension;
+      return false;
+    }
+  }
+
+  // NULL, the levels of non-vector columns are counted by write_row()
+  if (column->kind == Kind::VECTOR) {
+    column->rep_levels.add(0);
+    column->num_values++;
+  }
+  column->def_levels.add(0);
+  return false;
+}
+
+bool Dump_parquet_writer::write_row() {
+  for (Column &column : m_columns) {
+    const size_t size = column.values.size();
+    if (column.kind != Kind::VECTOR) column.num_values++;
+    if (add_value(&column)) return true;
+    m_buffered += column.values.size() - size;
+  }
+  m_rows++;
+  if (m_buffered >= ROW_GROUP_SIZE) return write_row_group();
+  return false;
+}
+
+bool Dump_parquet_writer::write(const std::string &bytes) {
+  if (my_b_write(&m_cache, pointer_cast<const uchar *>(bytes.data()),
+                 bytes.size())) {
+    my_error(ER_ERROR_ON_WRITE, MYF(0), m_path, my_errno());
+    return true;
+  }
+  return false;
+}
+
+bool Dump_parquet_writer::write_column_chunk(Column *column,
+                                             Chunk_meta *meta) {
+  std::string page;
+  if (column->kind == Kind::VECTOR) column->rep_levels.finish(&page);
+  column->def_levels.finish(&page);
+  page.append(column->values);
+  column->values.clear();
+  column->values.shrink_to_fit();
+
+  std::string compressed;
+  if (m_compress) {
+    compressed.resize(ZSTD_compressBound(page.size()));
+    const size_t size = ZSTD_compress(&compressed[0], compressed.size(),
+                                      page.data(), page.size(),
+                                      ZSTD_CLEVEL_DEFAULT);
+    if (ZSTD_isError(size)) {
+      my_error(ER_ERROR_ON_WRITE, MYF(0), m_path, 0);
+      return true;
+    }
+    compressed.resize(size);
+  }
+  const std::string &data = m_compress ? compressed : page;
+
+  Thrift_writer header;
+  header.i32(1, PAGE_DATA);
+  header.i32(2, static_cast<int32>(page.size()));
+  header.i32(3, static_cast<int32>(data.size()));
+  header.begin_struct(5);
+  header.i32(1, static_cast<int32>(column->num_values));
+  header.i32(2, ENCODING_PLAIN);
+  header.i32(3, ENCODING_RLE);
+  header.i32(4, ENCODING_RLE);
+  header.end_struct();
+  header.out.push_back(0);
+
+  meta->offset = my_b_tell(&m_cache);
+  meta->num_values = column->num_values;
+  meta->uncompressed_size = header.out.size() + page.size();
+  meta->compressed_size = header.out.size() + data.size();
+  column->num_values = 0;
+  return write(header.out) || write(data);
+}
+
+bool Dump_parquet_writer::write_row_group() {
+  Row_group_meta row_group;
+  row_group.num_rows = m_rows;
+  row_group.total_size = 0;
+  for (Column &column : m_columns) {
+    Chunk_meta meta;
+    if (write_column_chunk(&column, &meta)) return true;
+    row_group.total_size += meta.uncompressed_size;
+    row_group.chunks.push_back(meta);
+  }
+  m_row_groups.push_back(std::move(row_group));
+  m_total_rows += m_rows;
+  m_rows = 0;
+  m_buffered = 0;
+  return false;
+}
+
+std::string Dump_parquet_writer::footer() const {
+  Thrift_writer meta;
+  meta.i32(1, 1);  // version
+
+  size_t schema_size = 1;
+  for (const Column &column : m_columns)
+    schema_size += column.kind == Kind::VECTOR ? 3 : 1;
+  meta.list(2, Thrift_writer::STRUCT, schema_size);
+  meta.begin_struct();
+  meta.binary(4, "schema");
+  meta.i32(5, static_cast<int32>(m_columns.size()));
+  meta.end_struct();
+  for (const Column &column : m_columns) {
+    const std::string name = column.item->item_name.ptr();
+    int type = TYPE_INT64;
+    int converted = -1;
+    switch (column.kind) {
+      case Kind::INT64:
+        converted = CONVERTED_INT_64;
+        break;
+      case Kind::UINT64:
+        converted = CONVERTED_UINT_64;
+        break;
+      case Kind::FLOAT:
+        type = TYPE_FLOAT;
+        break;
+      case Kind::DOUBLE:
+        type = TYPE_DOUBLE;
+        break;
+      case Kind::DECIMAL:
+        converted = CONVERTED_DECIMAL;
+        break;
+      case Kind::DATE:
+        type = TYPE_INT32;
+        converted = CONVERTED_DATE;
+        break;
+      case Kind::DATETIME:
+      case Kind::TIMESTAMP:
+        converted = CONVERTED_TIMESTAMP_MICROS;
+        break;
+      case Kind::TIME:
+        converted = CONVERTED_TIME_MICROS;
+        break;
+      case Kind::STRING:
+        type = TYPE_BYTE_ARRAY;
+        converted = CONVERTED_UTF8;
+        break;
+      case Kind::BINARY:
+        type = TYPE_BYTE_ARRAY;
+        break;
+      case Kind::VECTOR:
+        // optional group name (LIST) { repeated group list {
+        //   required float element; } }
+        meta.begin_struct();
+        meta.i32(3, OPTIONAL);
+        meta.binary(4, name);
+        meta.i32(5, 1);
+        meta.i32(6, CONVERTED_LIST);
+        meta.end_struct();
+        meta.begin_struct();
+        meta.i32(3, REPEATED);
+        meta.binary(4, "list");
+        meta.i32(5, 1);
+        meta.end_struct();
+        meta.begin_struct();
+        meta.i32(1, TYPE_FLOAT);
+        meta.i32(3, REQUIRED);
+        meta.binary(4, "element");
+        meta.end_struct();
+        continue;
+    }
+    meta.begin_struct();
+    meta.i32(1, type);
+    meta.i32(3, OPTIONAL);
+    meta.binary(4, name);
+    if (converted >= 0) meta.i32(6, converted);
+    if (column.kind == Kind::DECIMAL) {
+      meta.i32(7, static_cast<int32>(column.scale));
+      meta.i32(8, static_cast<int32>(column.precision));
+    }
+    meta.end_struct();
+  }
+
+  meta.i64(3, static_cast<int64>(m_total_rows));
+  meta.list(4, Thrift_writer::STRUCT, m_row_groups.size());
+  for (const Row_group_meta &row_group : m_row_groups) {
+    meta.begin_struct();
+    meta.list(1, Thrift_writer::STRUCT, m_columns.size());
+    for (size_t i = 0; i < m_columns.size(); i++) {
+      const Column &column = m_columns[i];
+      const Chunk_meta &chunk = row_group.chunks[i];
+      int type = TYPE_INT64;
+      switch (column.kind) {
+        case Kind::DATE:
+          type = TYPE_INT32;
+          break;
+        case Kind::FLOAT:
+        case Kind::VECTOR:
+          type = TYPE_FLOAT;
+          break;
+        case Kind::DOUBLE:
+          type = TYPE_DOUBLE;
+          break;
+        case Kind::STRING:
+        case Kind::BINARY:
+          type = TYPE_BYTE_ARRAY;
+          break;
+        default:
+          break;
+      }
+      meta.begin_struct();
+      meta.i64(2, static_cast<int64>(chunk.offset));
+      meta.begin_struct(3);
+      meta.i32(1, type);
+      meta.list(2, Thrift_writer::I32, 2);
+      meta.i32_element(ENCODING_PLAIN);
+      meta.i32_element(ENCODING_RLE);
+      const std::string name = column.item->item_name.ptr();
+      if (column.kind == Kind::VECTOR) {
+        meta.list(3, Thrift_writer::BINARY, 3);
+        meta.binary_element(name);
+        meta.binary_element("list");
+        meta.binary_element("element");
+      } else {
+        meta.list(3, Thrift_writer::BINARY, 1);
+        meta.binary_element(name);
+      }
+      meta.i32(4, m_compress ? CODEC_ZSTD : CODEC_UNCOMPRESSED);
+      meta.i64(5, static_cast<int64>(chunk.num_values));
+      meta.i64(6, static_cast<int64>(chunk.uncompressed_size));
+      meta.i64(7, static_cast<int64>(chunk.compressed_size));
+      meta.i64(9, static_cast<int64>(chunk.offset));
+      meta.end_struct();
+      meta.end_struct();
+    }
+    meta.i64(2, static_cast<int64>(row_group.total_size));
+    meta.i64(3, static_cast<int64>(row_group.num_rows));
+    meta.end_struct();
+  }
+  meta.binary(6, "MySQL DUMP TABLE");
+  meta.out.push_back(0);
+  return meta.out;
+}
+
+bool Dump_parquet_writer::close() {
+  if (m_rows > 0 && write_row_group()) return true;
+
+  std::string tail = footer();
+  put_int32(&tail, static_cast<int32>(tail.size()));
+  tail.append(PARQUET_MAGIC, 4);
+  if (write(tail)) return true;
+
+  const int error = end_io_cache(&m_cache);
+  const File file = m_file;
+  m_file = -1;
+  if (mysql_file_close(file, MYF(MY_WME)) || error) {
+    if (error) my_error(ER_ERROR_ON_WRITE, MYF(0), m_path, my_errno());
+    return true;
+  }
+  return false;
+}
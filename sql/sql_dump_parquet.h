@@ -0,0 +1,151 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+/**
+  @file
+  Parquet output of DUMP TABLE ... WITH (FORMAT = PARQUET).
+
+  Every chunk is a Parquet file of its own, written by the worker thread
+  that reads the chunk, with a row group for each 64MB of data. Columns
+  are typed: integers are INT64, floating point FLOAT or DOUBLE, decimals
+  of up to 18 digits DECIMAL INT64, temporal values DATE, TIMESTAMP_MICROS
+  and TIME_MICROS, the columns of vector indexes lists of FLOAT, and
+  anything else a UTF8 or binary BYTE_ARRAY. All columns are optional.
+
+  Values are PLAIN encoded, levels RLE encoded, and every column chunk is a
+  single data page, compressed with zstd unless COMPRESSION = 'none'.
+*/
+
+#include <string>
+#include <vector>
+
+#include "my_inttypes.h"
+#include "my_io.h"
+#include "my_sys.h"
+
+class Field;
+class Item;
+class THD;
+template <class T>
+class mem_root_deque;
+
+class Dump_parquet_writer {
+ public:
+  Dump_parquet_writer(const mem_root_deque<Item *> &items, bool compress);
+  ~Dump_parquet_writer();
+
+  Dump_parquet_writer(const Dump_parquet_writer &) = delete;
+  Dump_parquet_writer &operator=(const Dump_parquet_writer &) = delete;
+
+  /**
+    Create the file, which must not exist, as SELECT ... INTO OUTFILE does.
+    @return true on error
+  */
+  bool open(THD *thd, const char *file_name);
+
+  /**
+    Add the current values of the items as a row.
+    @return true on error
+  */
+  bool write_row();
+
+  /**
+    Write the rows left and the footer, and close the file.
+    @return true on error
+  */
+  bool close();
+
+ private:
+  enum class Kind {
+    INT64,
+    UINT64,
+    FLOAT,
+    DOUBLE,
+    DECIMAL,
+    DATE,
+    DATETIME,
+    TIMESTAMP,
+    TIME,
+    STRING,
+    BINARY,
+    VECTOR
+  };
+
+  /** Repetition or definition levels, run length encoded. */
+  class Levels {
+   public:
+    void add(uint level);
+    /// The encoded levels, prefixed with their length as in a data page.
+    void finish(std::string *out);
+
+   private:
+    void flush();
+
+    std::string m_runs;
+    uint m_level{0};
+    uint64 m_count{0};
+  };
+
+  struct Column {
+    Item *item;
+    /// The column of a vector index, read as a list of floats.
+    Field *vector_field{nullptr};
+    Kind kind;
+    uint precision{0};
+    uint scale{0};
+
+    /// Number of levels, values and nulls, of the buffered rows.
+    uint64 num_values{0};
+    Levels rep_levels;
+    Levels def_levels;
+    std::string values;
+  };
+
+  /** Where a column chunk of a written row group is. */
+  struct Chunk_meta {
+    my_off_t offset;
+    uint64 num_values;
+    uint64 uncompressed_size;
+    uint64 compressed_size;
+  };
+
+  struct Row_group_meta {
+    std::vector<Chunk_meta> chunks;
+    uint64 num_rows;
+    uint64 total_size;
+  };
+
+  bool add_value(Column *column);
+  bool write_row_group();
+  bool write_column_chunk(Column *column, Chunk_meta *meta);
+  bool write(const std::string &bytes);
+  std::string footer() const;
+
+  std::vector<Column> m_columns;
+  const bool m_compress;
+
+  File m_file{-1};
+  IO_CACHE m_cache;
+  char m_path[FN_REFLEN];
+
+  /// Rows and bytes buffered for the next row group.
+  uint64 m_rows{0};
+  uint64 m_buffered{0};
+  uint64 m_total_rows{0};
+  std::vector<Row_group_meta> m_row_groups;
+};
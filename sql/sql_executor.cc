@@ -69,6 +69,7 @@
 #include "sql/handler.h"
 #include "sql/item.h"
 #include "sql/item_cmpfunc.h"
+#include "sql/item_fb_vector_func.h"
 #include "sql/item_func.h"
 #include "sql/item_sum.h"  // Item_sum
 #include "sql/iterators/sorting_iterator.h"
@@ -884,6 +885,79 @@ AccessPath *CreateBKAAccessPath(THD *thd, JOIN *join, AccessPath *outer_path,
   return path;
 }
 
+/**
+  Find out whether a lateral derived table is a knn search on a vector index
+  with a query vector taken from the outer query, e.g.
+
+    LATERAL (SELECT ... FROM b ORDER BY FB_VECTOR_L2(b.v, a.v) LIMIT 10)
+
+  If so, return the table and index the search runs on, and its distance
+  function, so that the searches for many outer rows can be batched.
+ */
+static bool FindLateralKnnScan(QEP_TAB *qep_tab, TABLE **table, unsigned *idx,
+                               Item_func_fb_vector_distance **distance_func) {
+  if (qep_tab->materialize_table != QEP_TAB::MATERIALIZE_DERIVED) return false;
+  Table_ref *table_ref = qep_tab->table_ref;
+  if (!table_ref->is_derived()) return false;
+  Query_expression *query_expression = table_ref->derived_query_expression();
+  if (query_expression->m_lateral_deps == 0 || !query_expression->is_simple() ||
+      query_expression->root_access_path() == nullptr) {
+    return false;
+  }
+  JOIN *subjoin = query_expression->first_query_block()->join;
+  if (subjoin == nullptr || subjoin->order.order == nullptr) return false;
+
+  AccessPath *scan = nullptr;
+  WalkAccessPaths(query_expression->root_access_path(), subjoin,
+                  WalkAccessPathPolicy::STOP_AT_MATERIALIZATION,
+                  [&scan](AccessPath *path, const JOIN *) {
+                    if (path->type == AccessPath::INDEX_SCAN) {
+                      const auto &param = path->index_scan();
+                      if (param.table->key_info[param.idx]
+                              .is_fb_vector_index()) {
+                        scan = path;
+                      }
+                    }
+                    return scan != nullptr;
+                  });
+  if (scan == nullptr) return false;
+
+  // only a plain knn search with the query vector from the outer row
+  Fb_hybrid_score score;
+  if (fb_parse_hybrid_score(subjoin->order.order, &score) ||
+      score.m_spatial_distance != nullptr ||
+      score.m_text_relevance != nullptr ||
+      score.m_vector_distance->m_search_type != FB_VECTOR_SEARCH_KNN_FIRST ||
+      score.m_vector_distance->arguments()[1]->used_tables() !=
+          OUTER_REF_TABLE_BIT) {
+    return false;
+  }
+
+  *table = scan->index_scan().table;
+  *idx = scan->index_scan().idx;
+  *distance_func = score.m_vector_distance;
+  return true;
+}
+
+static AccessPath *NewKnnJoinAccessPath(THD *thd, AccessPath *outer,
+                                        AccessPath *inner, TABLE *table,
+                                        unsigned idx,
+                                        Item_func_fb_vector_distance *func) {
+  AccessPath *path = new (thd->mem_root) AccessPath;
+  path->type = AccessPath::KNN_JOIN;
+  path->knn_join().outer = outer;
+  path->knn_join().inner = inner;
+  path->knn_join().table = table;
+  path->knn_join().idx = idx;
+  path->knn_join().distance_func = func;
+
+  // Will be set later if we get a weedout access path as parent.
+  path->knn_join().store_rowids = false;
+  path->knn_join().tables_to_get_rowid_for = 0;
+
+  return path;
+}
+
 static AccessPath *PossiblyAttachFilter(
     AccessPath *path, const vector<PendingCondition> &conditions, THD *thd,
     table_map *conditions_depend_on_outer_tables) {
@@ -2895,11 +2969,24 @@ AccessPath *ConnectJoins(plan_idx upper_first_idx, plan_idx first_idx,
         path = PossiblyAttachFilter(path, join_conditions, thd,
                                     conditions_depend_on_outer_tables);
       } else {
+        AccessPath *outer_path = path;
         path = CreateNestedLoopAccessPath(
             thd, path, table_path, JoinType::INNER,
             qep_tab->pfs_batch_update(qep_tab->join()));
         SetCostOnNestedLoopAccessPath(*thd->cost_model(), qep_tab->position(),
                                       path);
+
+        // A knn search per outer row can be batched into one search for
+        // many outer rows; the rows still come out as from the nested loop.
+        TABLE *knn_table;
+        unsigned knn_idx;
+        Item_func_fb_vector_distance *knn_func;
+        if (FindLateralKnnScan(qep_tab, &knn_table, &knn_idx, &knn_func)) {
+          AccessPath *knn_path = NewKnnJoinAccessPath(
+              thd, outer_path, table_path, knn_table, knn_idx, knn_func);
+          CopyBasicProperties(*path, knn_path);
+          path = knn_path;
+        }
       }
     }
     ++i;
@@ -136,6 +136,8 @@ static bool parse_int(longlong *to, const char *from, size_t from_length)
 %token NO_GROUP_BY_LIS_HINT 1051
 %token RANGE_JOIN_HINT 1052
 %token NO_RANGE_JOIN_HINT 1053
+%token RESULT_CACHE_HINT 1054
+%token NO_RESULT_CACHE_HINT 1055
 
 /*
   YYUNDEF in internal to Bison. Please don't change its number, or change
@@ -165,6 +167,7 @@ static bool parse_int(longlong *to, const char *from, size_t from_length)
   qb_name_hint
   set_var_hint
   resource_group_hint
+  result_cache_hint
 
 %type <hint_list> hint_list
 
@@ -238,6 +241,7 @@ hint:
         | max_execution_time_hint
         | set_var_hint
         | resource_group_hint
+        | result_cache_hint
         ;
 
 
@@ -661,6 +665,21 @@ resource_group_hint:
          }
        ;
 
+result_cache_hint:
+          RESULT_CACHE_HINT '(' ')'
+          {
+            $$= NEW_PTN PT_hint_result_cache(true);
+            if ($$ == NULL)
+              YYABORT; // OOM
+          }
+        | NO_RESULT_CACHE_HINT '(' ')'
+          {
+            $$= NEW_PTN PT_hint_result_cache(false);
+            if ($$ == NULL)
+              YYABORT; // OOM
+          }
+        ;
+
 set_var_ident:
           HINT_ARG_IDENT
         | MAX_EXECUTION_TIME_HINT
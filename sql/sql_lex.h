@@ -2189,6 +2189,18 @@ class Query_block : public Query_term {
   /// @note that using this means we modify resolved data during optimization
   uint hidden_items_from_optimization{0};
 
+  /**
+    The number of hypergraph simplification steps an earlier optimization of
+    this query block needed to get below the subgraph pair limit, which later
+    executions of a prepared statement replay while the limit and the
+    statistics are the same. See FindBestQueryPlan().
+  */
+  struct Cached_graph_simplification {
+    int steps{-1};  ///< -1 if nothing is cached
+    int subgraph_pair_limit{0};
+    ulonglong statistics_version{0};
+  } cached_graph_simplification;
+
  private:
   friend class Query_expression;
   friend class Condition_context;
@@ -230,6 +230,8 @@ void Hint_scanner::add_hint_token_digest() {
           case NO_DERIVED_CONDITION_PUSHDOWN_HINT:
           case RANGE_JOIN_HINT:
           case NO_RANGE_JOIN_HINT:
+          case RESULT_CACHE_HINT:
+          case NO_RESULT_CACHE_HINT:
             break;
           default:
             assert(false);
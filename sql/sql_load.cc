@@ -36,7 +36,10 @@
 #include <algorithm>
 #include <atomic>
 #include <limits>
+#include <string>
+#include <vector>
 
+#include "include/work_queue.h"
 #include "libbinlogevents/include/load_data_events.h"
 #include "m_ctype.h"
 #include "m_string.h"
@@ -49,6 +52,7 @@
 #include "my_loglevel.h"
 #include "my_macros.h"
 #include "my_sys.h"
+#include "my_thread.h"
 #include "my_thread_local.h"
 #include "mysql/components/services/log_builtins.h"
 #include "mysql/psi/mysql_file.h"
@@ -69,6 +73,7 @@
 #include "sql/log.h"
 #include "sql/log_event.h"  // Delete_file_log_event,
 #include "sql/mysqld.h"     // mysql_real_data_home
+#include "sql/mysqld_thd_manager.h"
 #include "sql/protocol.h"
 #include "sql/protocol_classic.h"
 #include "sql/psi_memory_key.h"
@@ -87,6 +92,7 @@
 #include "sql/table.h"
 #include "sql/table_trigger_dispatcher.h"  // Table_trigger_dispatcher
 #include "sql/thr_malloc.h"
+#include "sql/transaction.h"
 #include "sql/transaction_info.h"
 #include "sql/trigger_def.h"
 #include "sql_string.h"
@@ -188,6 +194,18 @@ class READ_INFO {
     while (GET != my_b_EOF)
       ;
   }
+
+  /**
+    Read only the bytes from start to end of the file, a chunk of
+    LOAD DATA ... ALGORITHM = BULK.
+
+    @returns true if error
+  */
+  bool set_range(my_off_t start, my_off_t end) {
+    if (reinit_io_cache(&cache, READ_CACHE, start, false, true)) return true;
+    cache.end_of_file = end;
+    return false;
+  }
 };
 
 /**
@@ -465,6 +483,9 @@ bool Sql_cmd_load_table::execute_inner(THD *thd,
     return true;
   }
 
+  if (m_bulk)
+    return execute_bulk(thd, table_list, tdb, escape_char, handle_duplicates);
+
   if (m_is_local_file) {
     (void)net_request_file(thd->get_protocol_classic()->get_net(),
                            m_exchange.file_name);
@@ -582,8 +603,9 @@ bool Sql_cmd_load_table::execute_inner(THD *thd,
       error =
           read_fixed_length(thd, info, insert_table_ref, read_info, skip_lines);
     else
-      error = read_sep_field(thd, info, insert_table_ref, read_info, *enclosed,
-                             skip_lines);
+      error = read_sep_field(thd, info, insert_table_ref, read_info,
+                             m_opt_fields_or_vars, m_opt_set_fields,
+                             m_opt_set_exprs, *enclosed, skip_lines);
     if (thd->locked_tables_mode <= LTM_LOCK_TABLES &&
         table->file->ha_end_bulk_insert() && !error) {
       table->file->print_error(my_errno(), MYF(0));
@@ -935,17 +957,21 @@ class Field_tmp_nullability_guard {
   @param info        Pointer to COPY_INFO object
   @param table_list  Pointer to Table_ref object
   @param read_info   Pointer to READ_INFO object
+  @param fields_or_vars  Columns and user variables the fields are read into
+  @param set_fields  Columns of the SET clause
+  @param set_exprs   Expressions of the SET clause
   @param enclosed    ENCLOSED BY character
   @param skip_lines  Number of ignored lines
                      at the start of the file.
 
   @returns true if error
 */
-bool Sql_cmd_load_table::read_sep_field(THD *thd, COPY_INFO &info,
-                                        Table_ref *table_list,
-                                        READ_INFO &read_info,
-                                        const String &enclosed,
-                                        ulong skip_lines) {
+bool Sql_cmd_load_table::read_sep_field(
+    THD *thd, COPY_INFO &info, Table_ref *table_list, READ_INFO &read_info,
+    const mem_root_deque<Item *> &fields_or_vars,
+    const mem_root_deque<Item *> &set_fields,
+    const mem_root_deque<Item *> &set_exprs, const String &enclosed,
+    ulong skip_lines) {
   TABLE *table = table_list->table;
   size_t enclosed_length;
   bool err;
@@ -971,8 +997,8 @@ bool Sql_cmd_load_table::read_sep_field(THD *thd, COPY_INFO &info,
 
     Autoinc_field_has_explicit_non_null_value_reset_guard after_each_row(table);
 
-    auto it = m_opt_fields_or_vars.begin();
-    for (; it != m_opt_fields_or_vars.end(); ++it) {
+    auto it = fields_or_vars.begin();
+    for (; it != fields_or_vars.end(); ++it) {
       Item *item = *it;
       uint length;
       uchar *pos;
@@ -1044,11 +1070,11 @@ bool Sql_cmd_load_table::read_sep_field(THD *thd, COPY_INFO &info,
       skip_lines--;
       continue;
     }
-    if (it != m_opt_fields_or_vars.end()) {
+    if (it != fields_or_vars.end()) {
       /* Have not read any field, thus input file is simply ended */
-      if (it == m_opt_fields_or_vars.begin()) break;
+      if (it == fields_or_vars.begin()) break;
 
-      for (; it != m_opt_fields_or_vars.end(); ++it) {
+      for (; it != fields_or_vars.end(); ++it) {
         Item *item = *it;
         Item *real_item = item->real_item();
         if (real_item->type() == Item::FIELD_ITEM) {
@@ -1085,7 +1111,7 @@ bool Sql_cmd_load_table::read_sep_field(THD *thd, COPY_INFO &info,
     }
 
     if (thd->killed || fill_record_n_invoke_before_triggers(
-                           thd, &info, m_opt_set_fields, m_opt_set_exprs, table,
+                           thd, &info, set_fields, set_exprs, table,
                            TRG_EVENT_INSERT, table->s->fields, true, nullptr))
       return true;
 
@@ -1099,7 +1125,7 @@ bool Sql_cmd_load_table::read_sep_field(THD *thd, COPY_INFO &info,
         fill_record_n_invoke_before_triggers() after all trigger instructions
         has been executed.
       */
-      for (Item *item : m_opt_fields_or_vars) {
+      for (Item *item : fields_or_vars) {
         Item *real_item = item->real_item();
         if (real_item->type() == Item::FIELD_ITEM)
           ((Item_field *)real_item)
@@ -2137,6 +2163,471 @@ found_eof:
   return true;
 }
 
+/**
+  A byte range of an input file of LOAD DATA ... ALGORITHM = BULK, from the
+  start of a line to just after a line terminator.
+*/
+struct Sql_cmd_load_table::Bulk_chunk {
+  const char *file_name;
+  my_off_t start;
+  my_off_t end;
+  /// Lines of IGNORE n LINES to skip, only in the first chunk of a file.
+  ulong skip_lines;
+};
+
+/** What a worker thread of LOAD DATA ... ALGORITHM = BULK loads, and how. */
+struct Sql_cmd_load_table::Bulk_worker {
+  Sql_cmd_load_table *cmd;
+  THD *main_thd;
+  Work_queue<Bulk_chunk> *queue;
+  const char *db;
+  const char *table_name;
+  /// Columns the fields of a line are read into, in order.
+  const std::vector<const char *> *columns;
+  const CHARSET_INFO *cs;
+  int escape_char;
+  enum enum_duplicates duplicates;
+
+  bool created{false};
+  bool is_err{false};
+  uint err_errno{0};
+  char err_message[MYSQL_ERRMSG_SIZE]{};
+
+  ulonglong records{0};
+  ulonglong deleted{0};
+  ulonglong copied{0};
+  ulonglong warnings{0};
+};
+
+/**
+  Find the end of the line that contains offset from.
+
+  @returns offset just after the first line terminator at or after from that
+           is not escaped, size if there is none, MY_FILEPOS_ERROR on error
+*/
+static my_off_t end_of_line(File file, my_off_t from, my_off_t size,
+                            const String &line_term, int escape_char) {
+  const size_t term_length = line_term.length();
+  std::vector<uchar> block(std::max<size_t>(IO_SIZE * 16, term_length * 2));
+  for (my_off_t offset = from; offset + term_length <= size;) {
+    const size_t length =
+        static_cast<size_t>(std::min<my_off_t>(block.size(), size - offset));
+    if (mysql_file_pread(file, block.data(), length, offset, MYF(MY_NABP)))
+      return MY_FILEPOS_ERROR;
+    for (size_t i = 0; i + term_length <= length; i++) {
+      if (memcmp(&block[i], line_term.ptr(), term_length) != 0) continue;
+      // A terminator after an odd number of escape characters is data.
+      size_t escapes = 0;
+      for (my_off_t pos = offset + i; escape_char != INT_MAX && pos > 0;
+           pos--, escapes++) {
+        uchar chr;
+        if (pos > offset)
+          chr = block[pos - 1 - offset];
+        else if (mysql_file_pread(file, &chr, 1, pos - 1, MYF(MY_NABP)))
+          return MY_FILEPOS_ERROR;
+        if (chr != escape_char) break;
+      }
+      if (escapes % 2 == 0) return offset + i + term_length;
+    }
+    if (offset + length == size) break;
+    // A terminator may start in the last bytes of the block.
+    offset += length - term_length + 1;
+  }
+  return size;
+}
+
+/**
+  Why the load cannot be split into chunks loaded by threads of their own,
+  in the wording of ER_NOT_SUPPORTED_YET.
+
+  @returns nullptr if it can
+*/
+const char *Sql_cmd_load_table::bulk_unsupported(
+    THD *thd, Table_ref *table_list) const {
+  const String *field_term = m_exchange.field.field_term;
+  const String *line_term = m_exchange.line.line_term;
+
+  if (m_is_local_file) return "ALGORITHM = BULK with LOCAL";
+  if (m_exchange.filetype == FILETYPE_XML) return "ALGORITHM = BULK with XML";
+  if (m_exchange.load_compressed) return "ALGORITHM = BULK with COMPRESSED";
+  if (thd->slave_thread) return "ALGORITHM = BULK in a replica";
+  if (thd->variables.enable_sql_wsenv && sql_wsenv_uri_prefix != nullptr &&
+      strncmp(m_exchange.file_name, sql_wsenv_uri_prefix,
+              strlen(sql_wsenv_uri_prefix)) == 0)
+    return "ALGORITHM = BULK from a wsenv file";
+  // Lines must be found without parsing the fields.
+  if (field_term->is_empty()) return "ALGORITHM = BULK with fixed-size rows";
+  if (!m_exchange.field.enclosed->is_empty())
+    return "ALGORITHM = BULK with ENCLOSED BY";
+  if (line_term->is_empty() || !stringcmp(line_term, field_term))
+    return "ALGORITHM = BULK without LINES TERMINATED BY";
+  if (!m_opt_set_fields.empty()) return "ALGORITHM = BULK with SET";
+  for (Item *item : m_opt_fields_or_vars)
+    if (item->real_item()->type() != Item::FIELD_ITEM)
+      return "ALGORITHM = BULK with user variables";
+  if (table_list->is_view()) return "ALGORITHM = BULK into a view";
+  if (m_opt_partitions != nullptr) return "ALGORITHM = BULK with PARTITION";
+  TABLE *const table = table_list->table;
+  if (table->triggers != nullptr)
+    return "ALGORITHM = BULK into a table with triggers";
+  // Every chunk is committed on its own.
+  if (!table->file->has_transactions())
+    return "ALGORITHM = BULK into a non-transactional table";
+  if (thd->locked_tables_mode) return "ALGORITHM = BULK under LOCK TABLES";
+  if (thd->in_multi_stmt_transaction_mode())
+    return "ALGORITHM = BULK in a transaction";
+  if (mysql_bin_log.is_open() && (thd->variables.option_bits & OPTION_BIN_LOG))
+    return "ALGORITHM = BULK with binary logging";
+  return nullptr;
+}
+
+/**
+  Load the input in chunks with worker threads. The chunks loaded stay
+  loaded when another fails.
+
+  @param thd                 Current thread.
+  @param table_list          Table to load, opened and resolved.
+  @param tdb                 Database of a file name without a directory.
+  @param escape_char         ESCAPED BY character, INT_MAX for none.
+  @param handle_duplicates   Indicates whenever we should emit error or
+                             replace row if we will meet duplicates.
+
+  @returns true if error
+*/
+bool Sql_cmd_load_table::execute_bulk(THD *thd, Table_ref *table_list,
+                                      const char *tdb, int escape_char,
+                                      enum enum_duplicates handle_duplicates) {
+  DBUG_TRACE;
+  if (const char *reason = bulk_unsupported(thd, table_list)) {
+    my_error(ER_NOT_SUPPORTED_YET, MYF(0), reason);
+    return true;
+  }
+
+  char name[FN_REFLEN];
+  if (!dirname_length(m_exchange.file_name)) {
+    strxnmov(name, FN_REFLEN - 1, mysql_real_data_home, tdb, NullS);
+    (void)fn_format(name, m_exchange.file_name, name, "",
+                    MY_RELATIVE_PATH | MY_UNPACK_FILENAME);
+  } else {
+    (void)fn_format(
+        name, m_exchange.file_name, mysql_real_data_home, "",
+        MY_RELATIVE_PATH | MY_UNPACK_FILENAME | MY_RETURN_REAL_PATH);
+  }
+
+  // COUNT n reads the chunk files of DUMP TABLE.
+  std::vector<std::string> files;
+  if (m_source_count == 0) files.emplace_back(name);
+  for (ulong i = 0; i < m_source_count; i++)
+    files.push_back(std::string(name) + "." + std::to_string(i));
+
+  std::vector<Bulk_chunk> chunks;
+  for (const std::string &file_name : files) {
+    if (!is_secure_file_path(file_name.c_str())) {
+      my_error(ER_OPTION_PREVENTS_STATEMENT, MYF(0), "--secure-file-priv", "");
+      return true;
+    }
+    MY_STAT stat_info;
+    if (!my_stat(file_name.c_str(), &stat_info, MYF(MY_WME))) return true;
+    if ((stat_info.st_mode & S_IFMT) == S_IFIFO) {
+      my_error(ER_NOT_SUPPORTED_YET, MYF(0), "ALGORITHM = BULK from a pipe");
+      return true;
+    }
+    if ((stat_info.st_mode & S_IFMT) != S_IFREG) {
+      my_error(ER_TEXTFILE_NOT_READABLE, MYF(0), file_name.c_str());
+      return true;
+    }
+
+    const File file = mysql_file_open(key_file_load, file_name.c_str(),
+                                      O_RDONLY, MYF(MY_WME));
+    if (file < 0) return true;
+    const my_off_t size = stat_info.st_size;
+    const my_off_t chunk_size = thd->variables.load_data_bulk_chunk_size;
+    for (my_off_t start = 0; start < size;) {
+      const my_off_t end =
+          size - start <= chunk_size
+              ? size
+              : end_of_line(file, start + chunk_size, size,
+                            *m_exchange.line.line_term, escape_char);
+      if (end == MY_FILEPOS_ERROR) {
+        my_error(ER_ERROR_ON_READ, MYF(0), file_name.c_str(), my_errno());
+        mysql_file_close(file, MYF(0));
+        return true;
+      }
+      chunks.push_back({file_name.c_str(), start, end,
+                        start == 0 ? m_exchange.skip_lines : 0});
+      start = end;
+    }
+    mysql_file_close(file, MYF(0));
+  }
+
+  std::vector<const char *> columns;
+  for (Item *item : m_opt_fields_or_vars)
+    columns.push_back(down_cast<Item_field *>(item->real_item())->field_name);
+
+  // All the work is queued before the workers start.
+  Work_queue<Bulk_chunk> queue;
+  for (Bulk_chunk &chunk : chunks) queue.enqueue(&chunk);
+  queue.shutdown();
+
+  const size_t nthreads = std::max<size_t>(
+      1, std::min<size_t>(thd->variables.load_data_bulk_threads,
+                          chunks.size()));
+  std::vector<Bulk_worker> workers(nthreads);
+  std::vector<my_thread_handle> handles(nthreads);
+  my_thread_attr_t thr_attr;
+  my_thread_attr_init(&thr_attr);
+  my_thread_attr_setdetachstate(&thr_attr, MY_THREAD_CREATE_JOINABLE);
+
+  bool error = false;
+  for (size_t i = 0; i < nthreads && !chunks.empty(); i++) {
+    Bulk_worker *worker = &workers[i];
+    worker->cmd = this;
+    worker->main_thd = thd;
+    worker->queue = &queue;
+    worker->db = table_list->db;
+    worker->table_name = table_list->table_name;
+    worker->columns = &columns;
+    worker->cs =
+        m_exchange.cs ? m_exchange.cs : thd->variables.collation_database;
+    worker->escape_char = escape_char;
+    worker->duplicates = handle_duplicates;
+    const int rc = mysql_thread_create_seq(key_thread_load_worker, i,
+                                           &handles[i], &thr_attr,
+                                           bulk_worker, worker);
+    if (rc) {
+      my_error(ER_CANT_CREATE_THREAD, MYF(0), rc);
+      error = true;
+      break;
+    }
+    worker->created = true;
+  }
+  my_thread_attr_destroy(&thr_attr);
+
+  ulonglong records = 0, deleted = 0, copied = 0, warnings = 0;
+  for (size_t i = 0; i < nthreads; i++) {
+    Bulk_worker *worker = &workers[i];
+    if (!worker->created) continue;
+    my_thread_join(&handles[i], nullptr);
+    records += worker->records;
+    deleted += worker->deleted;
+    copied += worker->copied;
+    warnings += worker->warnings;
+    if (worker->is_err && !error) {
+      if (worker->err_errno)
+        my_message(worker->err_errno, worker->err_message, MYF(0));
+      else
+        my_error(ER_UNKNOWN_ERROR, MYF(0));
+      error = true;
+    }
+  }
+  if (!error && thd->is_killed()) {
+    thd->send_kill_message();
+    error = true;
+  }
+  if (error) return true;
+
+  snprintf(name, sizeof(name), ER_THD(thd, ER_LOAD_INFO), (long)records,
+           (long)deleted, (long)(records - copied), (long)warnings);
+  my_ok(thd, copied + deleted, 0L, name);
+  return false;
+}
+
+/**
+  Worker thread of LOAD DATA ... ALGORITHM = BULK, loads chunks from the
+  queue until it is empty.
+*/
+/* static */ void *Sql_cmd_load_table::bulk_worker(void *arg) {
+  THD new_thd;
+  THD *thd = &new_thd;
+  Bulk_worker *worker = static_cast<Bulk_worker *>(arg);
+  THD *main_thd = worker->main_thd;
+  Global_THD_manager *thd_manager = Global_THD_manager::get_instance();
+
+  thd->system_thread = SYSTEM_THREAD_BACKGROUND;
+  thd->thread_stack = (char *)&thd;
+  if (my_thread_init()) {
+    worker->is_err = true;
+    return nullptr;
+  }
+  thd->get_protocol_classic()->init_net(nullptr);
+  thd->set_new_thread_id();
+  thd->store_globals();
+  thd->set_db(main_thd->db());
+  thd_manager->add_thd(thd);
+  mysql_thread_set_psi_id(thd->thread_id());
+  thd->set_command(COM_DAEMON);
+  thd->security_context()->set_host_or_ip_ptr(my_localhost,
+                                              strlen(my_localhost));
+  DBUG_ENTER("bulk_worker");
+  THD_STAGE_INFO(thd, stage_loading_chunk);
+
+  lex_start(thd);
+  thd->lex->sql_command = SQLCOM_LOAD;
+  thd->lex->duplicates = worker->duplicates;
+  thd->lex->set_ignore(main_thd->lex->is_ignore());
+
+  // Rows are converted and checked as in the loading session, and are not
+  // binlogged, see bulk_unsupported().
+  thd->variables.sql_mode = main_thd->variables.sql_mode;
+  thd->variables.time_zone = main_thd->variables.time_zone;
+  thd->variables.load_data_infile_buffer_size =
+      main_thd->variables.load_data_infile_buffer_size;
+  thd->variables.option_bits &= ~OPTION_BIN_LOG;
+
+  Ignore_error_handler ignore_handler;
+  Strict_error_handler strict_handler;
+  if (thd->lex->is_ignore())
+    thd->push_internal_handler(&ignore_handler);
+  else if (thd->install_strict_handler())
+    thd->push_internal_handler(&strict_handler);
+
+  while (!thd->is_killed() && !main_thd->is_killed()) {
+    Bulk_chunk *chunk = worker->queue->dequeue(thd);
+    if (chunk == nullptr) break;
+    if (worker->cmd->load_chunk(thd, worker, *chunk)) {
+      worker->is_err = true;
+      break;
+    }
+  }
+
+  if (thd->is_error()) {
+    Diagnostics_area *da = thd->get_stmt_da();
+    worker->err_errno = da->mysql_errno();
+    snprintf(worker->err_message, sizeof(worker->err_message), "%s",
+             da->message_text());
+  }
+
+  if (thd->lex->is_ignore() || thd->install_strict_handler())
+    thd->pop_internal_handler();
+
+  lex_end(thd->lex);
+  thd->get_protocol_classic()->end_net();
+  thd->release_resources();
+  thd_manager->remove_thd(thd);
+  my_thread_end();
+  DBUG_RETURN(nullptr);
+}
+
+/**
+  Load a chunk in a transaction of its own.
+
+  @returns true if error
+*/
+bool Sql_cmd_load_table::load_chunk(THD *thd, Bulk_worker *worker,
+                                    const Bulk_chunk &chunk) {
+  DBUG_TRACE;
+  Table_ref table_list(worker->db, strlen(worker->db), worker->table_name,
+                       strlen(worker->table_name), worker->table_name,
+                       TL_WRITE);
+  if (open_and_lock_tables(thd, &table_list, 0)) return true;
+  TABLE *const table = table_list.table;
+
+  mem_root_deque<Item *> fields(thd->mem_root);
+  const mem_root_deque<Item *> set_fields(thd->mem_root);
+  const mem_root_deque<Item *> set_exprs(thd->mem_root);
+  bool error = false;
+  for (const char *column : *worker->columns) {
+    Field *field = find_field_in_table_sef(table, column);
+    if (field == nullptr) {
+      my_error(ER_BAD_FIELD_ERROR, MYF(0), column, worker->table_name);
+      error = true;
+      break;
+    }
+    bitmap_set_bit(table->write_set, field->field_index());
+    bitmap_set_bit(table->fields_set_during_insert, field->field_index());
+    fields.push_back(new (thd->mem_root) Item_field(field));
+  }
+
+  COPY_INFO info(COPY_INFO::INSERT_OPERATION, &fields, nullptr, true,
+                 worker->duplicates, worker->escape_char);
+  if (!error)
+    error = info.add_function_default_columns(table, table->write_set);
+
+  File file = -1;
+  if (!error) {
+    table->mark_columns_needed_for_insert(thd);
+    file = mysql_file_open(key_file_load, chunk.file_name, O_RDONLY,
+                           MYF(MY_WME));
+    error = file < 0;
+  }
+
+  if (!error) {
+    size_t tot_length = 0;
+    for (Item *item : fields) {
+      const Field *field = down_cast<Item_field *>(item)->field;
+      tot_length += field->is_flag_set(BLOB_FLAG) ? 4096 : field->field_length;
+    }
+    READ_INFO read_info(file, tot_length, worker->cs,
+                        *m_exchange.field.field_term,
+                        *m_exchange.line.line_start, *m_exchange.line.line_term,
+                        *m_exchange.field.enclosed, worker->escape_char, false,
+                        false, false,
+                        thd->variables.load_data_infile_buffer_size);
+    error = read_info.error || read_info.set_range(chunk.start, chunk.end);
+
+    thd->check_for_truncated_fields = CHECK_FIELD_WARN;
+    thd->num_truncated_fields = 0L;
+    for (ulong skip_lines = chunk.skip_lines; !error && skip_lines > 0;
+         skip_lines--)
+      if (read_info.next_line()) break;
+
+    if (!error) {
+      table->next_number_field = table->found_next_number_field;
+      if (thd->lex->is_ignore() || worker->duplicates == DUP_REPLACE)
+        table->file->ha_extra(HA_EXTRA_IGNORE_DUP_KEY);
+      if (worker->duplicates == DUP_REPLACE)
+        table->file->ha_extra(HA_EXTRA_WRITE_CAN_REPLACE);
+      if (m_in_key_order) table->file->ha_extra(HA_EXTRA_BEGIN_BULK_LOAD);
+      table->file->ha_start_bulk_insert((ha_rows)0);
+      table->copy_blobs = true;
+
+      error = read_sep_field(thd, info, &table_list, read_info, fields,
+                             set_fields, set_exprs, *m_exchange.field.enclosed,
+                             0);
+
+      if (table->file->ha_end_bulk_insert() && !error) {
+        table->file->print_error(my_errno(), MYF(0));
+        error = true;
+      }
+      if (m_in_key_order) {
+        const int rc = table->file->ha_extra(HA_EXTRA_END_BULK_LOAD);
+        if (rc && !error) {
+          if (!thd->is_error()) table->file->print_error(rc, MYF(0));
+          error = true;
+        }
+      }
+      table->next_number_field = nullptr;
+    }
+    mysql_file_close(file, MYF(0));
+    free_blobs(table);
+    table->copy_blobs = false;
+    thd->check_for_truncated_fields = CHECK_FIELD_IGNORE;
+    table->file->ha_release_auto_increment();
+  }
+
+  if (error)
+    trans_rollback_stmt(thd);
+  else
+    error = trans_commit_stmt(thd);
+  close_thread_tables(thd);
+  if (error)
+    trans_rollback(thd);
+  else
+    error = trans_commit(thd);
+  thd->mdl_context.release_transactional_locks();
+
+  if (!error) {
+    worker->records += info.stats.records;
+    worker->deleted += info.stats.deleted;
+    worker->copied += info.stats.copied;
+    Diagnostics_area *da = thd->get_stmt_da();
+    worker->warnings += da->current_statement_cond_count();
+    da->reset_condition_info(thd);
+    da->reset_statement_cond_count();
+  }
+  return error;
+}
+
 bool Sql_cmd_load_table::execute(THD *thd) {
   LEX *const lex = thd->lex;
 
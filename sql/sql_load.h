@@ -90,6 +90,22 @@ class Sql_cmd_load_table final : public Sql_cmd {
 
   bool execute(THD *thd) override;
 
+  /**
+    Load with ALGORITHM = BULK: the input is split into chunks at line
+    boundaries, which load_data_bulk_threads threads parse and write, each
+    chunk in a transaction of its own.
+
+    @param source_count  read the files <file>.0 to <file>.<source_count - 1>
+                         written by DUMP TABLE, 0 for the one file
+    @param in_key_order  the rows of every chunk come in primary key order,
+                         so the engine may write them straight to its files
+  */
+  void set_bulk(ulong source_count, bool in_key_order) {
+    m_bulk = true;
+    m_source_count = source_count;
+    m_in_key_order = in_key_order;
+  }
+
  public:
   sql_exchange m_exchange;
   const bool m_is_local_file;
@@ -109,14 +125,26 @@ class Sql_cmd_load_table final : public Sql_cmd {
   List<String> *const m_opt_set_expr_strings;
 
  private:
+  struct Bulk_chunk;
+  struct Bulk_worker;
+
   bool execute_inner(THD *thd, enum enum_duplicates handle_duplicates);
 
+  const char *bulk_unsupported(THD *thd, Table_ref *table_list) const;
+  bool execute_bulk(THD *thd, Table_ref *table_list, const char *tdb,
+                    int escape_char, enum enum_duplicates handle_duplicates);
+  static void *bulk_worker(void *arg);
+  bool load_chunk(THD *thd, Bulk_worker *worker, const Bulk_chunk &chunk);
+
   bool read_fixed_length(THD *thd, COPY_INFO &info, Table_ref *table_list,
                          READ_INFO &read_info, ulong skip_lines);
 
   bool read_sep_field(THD *thd, COPY_INFO &info, Table_ref *table_list,
-                      READ_INFO &read_info, const String &enclosed,
-                      ulong skip_lines);
+                      READ_INFO &read_info,
+                      const mem_root_deque<Item *> &fields_or_vars,
+                      const mem_root_deque<Item *> &set_fields,
+                      const mem_root_deque<Item *> &set_exprs,
+                      const String &enclosed, ulong skip_lines);
 
   bool read_xml_field(THD *thd, COPY_INFO &info, Table_ref *table_list,
                       READ_INFO &read_info, ulong skip_lines);
@@ -127,6 +155,10 @@ class Sql_cmd_load_table final : public Sql_cmd {
                                           enum enum_duplicates duplicates,
                                           bool transactional_table,
                                           int errocode, bool compressed);
+
+  bool m_bulk{false};
+  ulong m_source_count{0};
+  bool m_in_key_order{false};
 };
 
 #endif /* SQL_LOAD_INCLUDED */
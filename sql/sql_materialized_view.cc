@@ -0,0 +1,304 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "sql/sql_materialized_view.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "m_ctype.h"
+#include "my_sys.h"
+#include "mysqld_error.h"
+#include "sql/auth/auth_acls.h"
+#include "sql/auth/auth_common.h"
+#include "sql/continuous_query.h"
+#include "sql/field.h"
+#include "sql/item.h"
+#include "sql/key.h"
+#include "sql/materialized_view.h"
+#include "sql/mysqld.h"
+#include "sql/sql_base.h"
+#include "sql/sql_class.h"
+#include "sql/sql_lex.h"
+#include "sql/table.h"
+#include "sql/thd_raii.h"
+#include "sql_string.h"
+#include "template_utils.h"
+
+namespace {
+
+/// Resolve the name of a view against the current database.
+bool view_name(THD *thd, const Table_ident *table, std::string *db,
+               std::string *name) {
+  if (table->db.str != nullptr) {
+    db->assign(table->db.str, table->db.length);
+  } else if (thd->db().str != nullptr) {
+    db->assign(thd->db().str, thd->db().length);
+  } else {
+    my_error(ER_NO_DB_ERROR, MYF(0));
+    return true;
+  }
+  name->assign(table->table.str, table->table.length);
+  if (check_table_name(name->c_str(), name->length()) !=
+      Ident_name_check::OK) {
+    my_error(ER_WRONG_TABLE_NAME, MYF(0), name->c_str());
+    return true;
+  }
+  if (lower_case_table_names == 1) {
+    std::vector<char> buffer(db->begin(), db->end());
+    buffer.push_back('\0');
+    my_casedn_str(files_charset_info, buffer.data());
+    db->assign(buffer.data());
+    buffer.assign(name->begin(), name->end());
+    buffer.push_back('\0');
+    my_casedn_str(files_charset_info, buffer.data());
+    name->assign(buffer.data());
+  }
+  return false;
+}
+
+bool not_supported(const char *what) {
+  my_error(ER_NOT_SUPPORTED_YET, MYF(0), what);
+  return true;
+}
+
+void append_name(std::string *out, const char *name) {
+  out->append(1, '`');
+  for (const char *c = name; *c != '\0'; c++) {
+    if (*c == '`') out->append(1, '`');
+    out->append(1, *c);
+  }
+  out->append(1, '`');
+}
+
+std::string quoted_view_name(const std::string &db, const std::string &name) {
+  std::string quoted;
+  append_name(&quoted, db.c_str());
+  quoted.append(1, '.');
+  append_name(&quoted, name.c_str());
+  return quoted;
+}
+
+/**
+  Check that the prepared query of a view can be maintained incrementally,
+  and print its parts.
+  @param[out] index the index of the view table on the key columns
+*/
+bool build_definition(THD *thd, LEX *lex, Materialized_view_definition *def,
+                      std::string *index) {
+  Query_block *const block = lex->query_block;
+  if (!lex->unit->is_simple() ||
+      block->first_inner_query_expression() != nullptr)
+    return not_supported("set operations and subqueries in materialized views");
+  if (block->is_distinct() || block->has_limit() || block->has_windows() ||
+      block->olap != UNSPECIFIED_OLAP_TYPE)
+    return not_supported(
+        "DISTINCT, LIMIT, window functions and ROLLUP in materialized views");
+  if (block->uncacheable & (UNCACHEABLE_RAND | UNCACHEABLE_SIDEEFFECT))
+    return not_supported("non-deterministic materialized views");
+  for (Table_ref *tl = block->get_table_list(); tl != nullptr;
+       tl = tl->next_local) {
+    if (tl->is_view_or_derived() || tl->is_table_function() ||
+        tl->schema_table != nullptr)
+      return not_supported(
+          "views, derived tables and table functions in materialized views");
+  }
+  if (block->leaf_tables == nullptr)
+    return not_supported("materialized views without tables");
+
+  const bool grouped = block->is_grouped();
+  std::vector<std::vector<Field *>> key_fields;
+  for (Table_ref *tl = block->leaf_tables; tl != nullptr; tl = tl->next_leaf) {
+    TABLE *const table = tl->table;
+    if (table->s->tmp_table != NO_TMP_TABLE)
+      return not_supported("temporary tables in materialized views");
+    if (tl->outer_join)
+      return not_supported("outer joins in materialized views");
+
+    Materialized_view_source source;
+    source.db = table->s->db.str;
+    source.table_name = table->s->table_name.str;
+    if (!table->alias_name_used) {
+      append_name(&source.qualifier, tl->db);
+      source.qualifier.append(1, '.');
+    }
+    append_name(&source.qualifier, tl->alias);
+
+    std::vector<Field *> fields;
+    if (grouped) {
+      if (block->leaf_table_count > 1)
+        return not_supported("grouped materialized views over joins");
+      for (ORDER *order = block->group_list.first; order != nullptr;
+           order = order->next) {
+        Item *const item = (*order->item)->real_item();
+        if (item->type() != Item::FIELD_ITEM)
+          return not_supported(
+              "GROUP BY on expressions in materialized views");
+        Field *const field = down_cast<Item_field *>(item)->field;
+        if (std::find(fields.begin(), fields.end(), field) == fields.end())
+          fields.push_back(field);
+      }
+    } else {
+      if (table->s->primary_key == MAX_KEY)
+        return not_supported(
+            "materialized views over tables without a primary key");
+      const KEY &key = table->key_info[table->s->primary_key];
+      for (uint k = 0; k < key.user_defined_key_parts; k++) {
+        Field *const field = key.key_part[k].field;
+        // the lineage of the view rows is their primary key
+        if (field->is_flag_set(BLOB_FLAG))
+          return not_supported(
+              "materialized views over tables with a BLOB primary key");
+        fields.push_back(field);
+      }
+    }
+    for (Field *field : fields) {
+      if (!materialized_view_key_supported(field))
+        return not_supported(
+            "materialized views keyed by FLOAT, DOUBLE, TIMESTAMP, JSON or "
+            "GEOMETRY columns");
+      source.key_columns.push_back(field->field_name);
+    }
+    key_fields.push_back(std::move(fields));
+    def->sources.push_back(std::move(source));
+  }
+
+  Sql_mode_parse_guard parse_guard(thd);
+  const enum_query_type query_type =
+      enum_query_type(QT_TO_ARGUMENT_CHARSET | QT_HIDE_ROLLUP_FUNCTIONS);
+  String str;
+  block->print_item_list(thd, &str, query_type);
+  def->select_list.assign(str.ptr(), str.length());
+  for (const Item *item : block->visible_fields()) {
+    if (!def->columns.empty()) def->columns.append(",");
+    append_name(&def->columns, item->item_name.ptr());
+  }
+  std::string keys;
+  bool blob_key = false;
+  for (size_t s = 0; s < def->sources.size(); s++) {
+    const Materialized_view_source &source = def->sources[s];
+    for (size_t k = 0; k < source.key_columns.size(); k++) {
+      const std::string column = Materialized_view_definition::key_column(
+          s, source.key_columns[k]);
+      def->select_list.append(",").append(source.qualifier).append(".");
+      append_name(&def->select_list, source.key_columns[k].c_str());
+      def->select_list.append(" AS ");
+      append_name(&def->select_list, column.c_str());
+      def->columns.append(",");
+      append_name(&def->columns, column.c_str());
+      if (!keys.empty()) keys.append(",");
+      append_name(&keys, column.c_str());
+      blob_key = blob_key || key_fields[s][k]->is_flag_set(BLOB_FLAG);
+    }
+  }
+
+  str.length(0);
+  block->print_from_clause(thd, &str, query_type);
+  def->from_clause.assign(str.ptr(), str.length());
+  str.length(0);
+  if (block->where_cond() != nullptr)
+    block->where_cond()->print(thd, &str, query_type);
+  else if (block->cond_value == Item::COND_FALSE)
+    str.append(STRING_WITH_LEN("false"));
+  def->where_cond.assign(str.ptr(), str.length());
+  str.length(0);
+  block->print_group_by(thd, &str, query_type);
+  block->print_having(thd, &str, query_type);
+  def->group_by.assign(str.ptr(), str.length());
+
+  def->sql_mode = thd->variables.sql_mode;
+  def->client_cs_name = thd->variables.character_set_client->csname;
+  def->connection_cl_name = thd->variables.collation_connection->m_coll_name;
+
+  // Rows of a grouped view are found by their group, of others by their
+  // lineage, which is unique.
+  if (keys.empty() || blob_key)
+    index->clear();
+  else
+    *index = (grouped ? "KEY (" : "PRIMARY KEY (") + keys + ")";
+  return false;
+}
+
+}  // namespace
+
+bool Sql_cmd_create_materialized_view::execute(THD *thd) {
+  LEX *const lex = thd->lex;
+  std::string db;
+  std::string name;
+  if (view_name(thd, m_table, &db, &name)) return true;
+  if (thd->locked_tables_mode) {
+    my_error(ER_LOCK_OR_ACTIVE_TRANSACTION, MYF(0));
+    return true;
+  }
+
+  if (lex->query_tables == nullptr)
+    return not_supported("materialized views without tables");
+  if (check_table_access(thd, SELECT_ACL, lex->query_tables, false, UINT_MAX,
+                         false) ||
+      open_tables_for_query(thd, lex->query_tables, 0))
+    return true;
+  bool error;
+  {
+    Prepared_stmt_arena_holder ps_arena_holder(thd);
+    error = lex->unit->prepare(thd, nullptr, nullptr, 0, 0);
+  }
+  Materialized_view_definition def;
+  std::string index;
+  error = error || build_definition(thd, lex, &def, &index);
+  // the view is filled by statements of its own
+  close_thread_tables(thd);
+  if (error || materialized_view_create(thd, db, name, def, index))
+    return true;
+  my_ok(thd);
+  return false;
+}
+
+bool Sql_cmd_refresh_materialized_view::execute(THD *thd) {
+  std::string db;
+  std::string name;
+  if (view_name(thd, m_table, &db, &name)) return true;
+  if (thd->locked_tables_mode) {
+    my_error(ER_LOCK_OR_ACTIVE_TRANSACTION, MYF(0));
+    return true;
+  }
+  if (materialized_view_refresh(thd, db, name)) return true;
+  my_ok(thd);
+  return false;
+}
+
+bool Sql_cmd_refresh_materialized_view::quoted_name(THD *thd,
+                                                    std::string *name) const {
+  std::string db;
+  std::string table_name;
+  if (view_name(thd, m_table, &db, &table_name)) return true;
+  *name = quoted_view_name(db, table_name);
+  return false;
+}
+
+bool Sql_cmd_drop_materialized_view::execute(THD *thd) {
+  std::string db;
+  std::string name;
+  if (view_name(thd, m_table, &db, &name)) return true;
+  if (thd->locked_tables_mode) {
+    my_error(ER_LOCK_OR_ACTIVE_TRANSACTION, MYF(0));
+    return true;
+  }
+  if (materialized_view_drop(thd, db, name)) return true;
+  continuous_query_stop_view(quoted_view_name(db, name));
+  my_ok(thd);
+  return false;
+}
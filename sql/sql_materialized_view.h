@@ -0,0 +1,81 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+/**
+  @file
+  CREATE MATERIALIZED VIEW ... REFRESH INCREMENTAL AS ..., REFRESH
+  MATERIALIZED VIEW and DROP MATERIALIZED VIEW, see materialized_view.h.
+*/
+
+#include <string>
+
+#include "my_sqlcommand.h"
+#include "sql/sql_cmd.h"
+
+class THD;
+class Table_ident;
+
+class Sql_cmd_create_materialized_view final : public Sql_cmd {
+ public:
+  explicit Sql_cmd_create_materialized_view(Table_ident *table)
+      : m_table(table) {}
+
+  enum_sql_command sql_command_code() const override {
+    return SQLCOM_CREATE_MATERIALIZED_VIEW;
+  }
+
+  /// Check the query of the view in lex, which is prepared to have its
+  /// parts printed, then create the view.
+  bool execute(THD *thd) override;
+
+ private:
+  Table_ident *m_table;
+};
+
+class Sql_cmd_refresh_materialized_view final : public Sql_cmd {
+ public:
+  explicit Sql_cmd_refresh_materialized_view(Table_ident *table)
+      : m_table(table) {}
+
+  enum_sql_command sql_command_code() const override {
+    return SQLCOM_REFRESH_MATERIALIZED_VIEW;
+  }
+
+  bool execute(THD *thd) override;
+
+  /// The name of the view as "`db`.`name`", for continuous refreshes.
+  bool quoted_name(THD *thd, std::string *name) const;
+
+ private:
+  Table_ident *m_table;
+};
+
+class Sql_cmd_drop_materialized_view final : public Sql_cmd {
+ public:
+  explicit Sql_cmd_drop_materialized_view(Table_ident *table)
+      : m_table(table) {}
+
+  enum_sql_command sql_command_code() const override {
+    return SQLCOM_DROP_MATERIALIZED_VIEW;
+  }
+
+  bool execute(THD *thd) override;
+
+ private:
+  Table_ident *m_table;
+};
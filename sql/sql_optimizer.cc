@@ -86,6 +86,7 @@
 #include "sql/lock.h"    // mysql_unlock_some_tables
 #include "sql/mysqld.h"  // stage_optimizing
 #include "sql/nested_join.h"
+#include "sql/next_spatial_base.h"
 #include "sql/opt_costmodel.h"
 #include "sql/opt_explain.h"  // join_type_str
 #include "sql/opt_hints.h"    // hint_table_state
@@ -1780,6 +1781,44 @@ void JOIN::test_skip_sort() {
     NULL otherwise
 */
 
+/**
+  The multiplier of the LIMIT of a vector search when
+  fb_vector_search_limit_multiplier is 0: the inverse of the estimated
+  filtering effect of the WHERE condition on the table, which the histograms
+  of its columns refine, at most 1000.
+*/
+static uint vector_search_auto_multiplier(THD *thd, TABLE *table) {
+  const JOIN_TAB *tab = table->reginfo.join_tab;
+  if (tab == nullptr || tab->table_ref == nullptr ||
+      tab->join()->where_cond == nullptr)
+    return 1;
+
+  MY_BITMAP fields_to_ignore;
+  if (bitmap_init(&fields_to_ignore, nullptr, table->s->fields)) return 1;
+  const float filter = tab->join()->where_cond->get_filtering_effect(
+      thd, tab->table_ref->map(), /*read_tables=*/0, &fields_to_ignore,
+      static_cast<double>(table->file->stats.records));
+  bitmap_free(&fields_to_ignore);
+
+  if (filter * 1000.0f <= 1.0f) return 1000;
+  return std::max(1U, static_cast<uint>(std::ceil(1.0f / filter)));
+}
+
+/**
+  Whether the results of a KNN search for limit rows could hold more than
+  fb_vector_search_memory_limit. Some vector indexes return the rows along
+  with their keys, so a result is taken to be a record and a row reference,
+  in two strings.
+*/
+static bool vector_search_over_memory_limit(THD *thd, TABLE *table,
+                                            ha_rows limit) {
+  const ulonglong memory_limit = thd->variables.fb_vector_search_memory_limit;
+  if (memory_limit == 0) return false;
+  const ulonglong row_bytes = 2 * sizeof(std::string) +
+                              table->file->ref_length + table->s->reclength;
+  return limit > memory_limit / row_bytes;
+}
+
 static Item_func_match *test_if_ft_index_order(ORDER *order) {
   if (order && order->next == nullptr && order->direction == ORDER_DESC &&
       is_function_of_type(*order->item, Item_func::FT_FUNC))
@@ -1869,46 +1908,53 @@ int test_if_order_by_key(THD *thd, ORDER_with_src *order_src, TABLE *table,
     Item_func_fb_vector_distance *item_func;
 
     if (table->file->index_supports_vector_scan(order, idx)) {
-      auto search_type= FB_VECTOR_SEARCH_KNN_FIRST;
-      Item_func *func = (Item_func *)*(order->item);
-      if ((strcmp(func->func_name(), "+") == 0)) {
+      auto search_type = FB_VECTOR_SEARCH_KNN_FIRST;
+      Fb_hybrid_score score;
+      // index_supports_vector_scan() already accepted the expression
+      fb_parse_hybrid_score(order, &score);
+      item_func = score.m_vector_distance;
+      item_func->m_text_relevance = score.m_text_relevance;
+      item_func->m_text_weight =
+          score.m_text_relevance
+              ? static_cast<float>(score.relative_text_weight())
+              : 0.0f;
+      if (score.m_spatial_distance) {
         search_type = FB_VECTOR_SEARCH_KNN_HYBRID;
-        Item *arg0 = (Item *)func->arguments()[0];
-        arg0 = arg0->real_item();
-        item_func =
-              down_cast<Item_func_fb_vector_distance *>((Item_func *)arg0);
-
-        // parsing the weight
-        Item *arg1_item = (Item *)func->arguments()[1];
-        arg1_item = arg1_item->real_item();
-        Item_func *arg1 = (Item_func *)arg1_item;
-        if ((strcmp(arg1->func_name(), "*") == 0)) {
-          float weight;
-          Item *arg1_weight = (Item *)arg1->arguments()[0];
-          if (arg1_weight->type() == Item::DECIMAL_ITEM || arg1_weight->type() == Item::REAL_ITEM || arg1_weight->type() == Item::INT_ITEM) {
-              weight = arg1_weight->val_real();  // Extract the numeric value
-              item_func->m_weight = weight;
-          } 
-          Item *arg1_dis = (Item *)arg1->arguments()[1];
-          arg1_dis = arg1_dis->real_item();
-          Item_func *arg1_dis_func = (Item_func *)arg1_dis;
-          if (arg1_dis_func->func_name() == std::string("st_distance")) {
-            String backing_arg_wkb1;
-            String *arg_wkb1 = arg1_dis_func->arguments()[1]->val_str(&backing_arg_wkb1);
-            item_func->m_query_coordinate = std::string(arg_wkb1->ptr(), arg_wkb1->length());
+        item_func->m_weight =
+            static_cast<float>(score.relative_spatial_weight());
+        Item *query_point = score.m_spatial_distance->arguments()[1];
+        if (!query_point->const_item() ||
+            item_func->m_query_geometry.empty()) {
+          String backing_arg_wkb1;
+          String *arg_wkb1 = query_point->val_str(&backing_arg_wkb1);
+          // an unparsable geometry leaves it empty, the engine rejects that
+          if (arg_wkb1 == nullptr ||
+              item_func->m_query_geometry.parse(arg_wkb1->ptr(),
+                                                arg_wkb1->length())) {
+            item_func->m_query_geometry.clear();
           }
         }
-      } else {
-        item_func =
-            down_cast<Item_func_fb_vector_distance *>(func);
       }
       real_itm = (Item *)(item_func->arguments()[0]);
 
+      // a WHERE condition bounding the distance lets the search drop the
+      // rows beyond the bound, and filters out none of the k nearest within
+      item_func->m_distance_bound.reset();
+      bool only_distance_bound = false;
+      const JOIN_TAB *tab = table->reginfo.join_tab;
+      if (!score.m_spatial_distance && !score.m_text_relevance &&
+          tab != nullptr && tab->join()->where_cond != nullptr) {
+        only_distance_bound = fb_vector_distance_bound(
+            tab->join()->where_cond, item_func, &item_func->m_distance_bound);
+      }
+
       // initialize hint for vector search
       ha_rows limit = select_limit;
       const bool using_limit = limit != HA_POS_ERROR;
       if (using_limit && thd->variables.fb_vector_search_limit_multiplier > 0) {
         limit *= thd->variables.fb_vector_search_limit_multiplier;
+      } else if (using_limit && !only_distance_bound) {
+        limit *= vector_search_auto_multiplier(thd, table);
       }
 
       //             std::to_string(thd->variables.fb_vector_search_limit_multiplier) +
@@ -1923,8 +1969,9 @@ int test_if_order_by_key(THD *thd, ORDER_with_src *order_src, TABLE *table,
            choice, as a large K case may not be handled well in FAISS and
            can lead in the direction of OOM, so we switch to INDEX_SCAN.
            This overrides the user's explicit preference to use KNN_FIRST
-        3. ELSE: If the user has provided preference for ITERATOR, then we
-           switch to ITERATOR
+        3. ELSE: If the user has provided preference for ITERATOR, or the
+           KNN results could exceed fb_vector_search_memory_limit, then we
+           switch to ITERATOR, which streams the rows to a filesort
 
         Above 3 points are implemented below. 4 is implemented in
         make_join_readinfo() during ICP related decision-making
@@ -1935,15 +1982,36 @@ int test_if_order_by_key(THD *thd, ORDER_with_src *order_src, TABLE *table,
       */
 
       if ((!using_limit ||
-          thd->variables.fb_vector_search_type == FB_VECTOR_SEARCH_INDEX_SCAN) && (search_type != FB_VECTOR_SEARCH_KNN_HYBRID)) {
+          thd->variables.fb_vector_search_type == FB_VECTOR_SEARCH_INDEX_SCAN ||
+          vector_search_over_memory_limit(thd, table, limit)) &&
+          (search_type != FB_VECTOR_SEARCH_KNN_HYBRID)) {
         search_type = FB_VECTOR_SEARCH_INDEX_SCAN;
       }
+      // the lists of a multi-vector index hold a row once per list its
+      // vectors fall into, and a sparse index holds it once per index of
+      // its vector, only knn searches aggregate them
+      if (search_type == FB_VECTOR_SEARCH_INDEX_SCAN &&
+          !table->key_info[idx].fb_vector_index_config.supports_index_scan()) {
+        return 0;
+      }
       // always pass a limit value for knn search
       assert((search_type != FB_VECTOR_SEARCH_KNN_FIRST && search_type != FB_VECTOR_SEARCH_KNN_HYBRID) || using_limit);
       item_func->m_limit = limit;
       item_func->m_search_type = search_type;
       item_func->m_nprobe = thd->variables.fb_vector_search_nprobe;
+      item_func->m_threads = thd->variables.fb_vector_search_threads;
+      item_func->m_target_candidates =
+          thd->variables.fb_vector_search_target_candidates;
 
+    } else if (table->key_info[idx].is_next_spatial_index()) {
+      /*
+        A spatial index only gives the ST_DISTANCE order of a nearest
+        neighbour scan, which needs a LIMIT to stop early enough to pay off.
+      */
+      if (select_limit == HA_POS_ERROR ||
+          !table->file->index_supports_spatial_knn_scan(order, idx))
+        return 0;
+      real_itm = down_cast<Item_func *>(*order->item)->arguments()[0];
     }
 
     if (real_itm->type() != Item::FIELD_ITEM) return 0;
@@ -2412,13 +2480,11 @@ static bool test_if_skip_sort_order(JOIN_TAB *tab, ORDER_with_src &order,
     const Item *item = (*tmp_order->item)->real_item();
 
     if (table->file->index_supports_vector_scan(tmp_order, -1)) {
-      Item_func *item_func = (Item_func *)*(tmp_order->item);
-      if ((strcmp(item_func->func_name(), "+") == 0)) {
-        Item *arg0 = (Item *)item_func->arguments()[0];
-        Item *real_arg0 = arg0->real_item();
-        item_func = (Item_func *)real_arg0;
-      }
-      item = (Item *)(item_func->arguments()[0]);
+      Fb_hybrid_score score;
+      fb_parse_hybrid_score(tmp_order, &score);
+      item = score.m_vector_distance->arguments()[0];
+    } else if (table->file->index_supports_spatial_knn_scan(tmp_order, -1)) {
+      item = down_cast<Item_func *>(*tmp_order->item)->arguments()[0];
     }
 
     if (item->type() != Item::FIELD_ITEM) {
@@ -2452,6 +2518,10 @@ static bool test_if_skip_sort_order(JOIN_TAB *tab, ORDER_with_src &order,
       return false;
     ref_key = used_index(tab->range_scan());
     ref_key_parts = get_used_key_parts(tab->range_scan());
+    // an mbr range on a spatial index comes back in no particular order
+    if (ref_key < (int)MAX_KEY &&
+        table->key_info[ref_key].is_next_spatial_index())
+      usable_keys.clear_bit(ref_key);
   } else if (tab->type() == JT_INDEX_SCAN) {
     // The optimizer has decided to use an index scan.
     ref_key = tab->index();
@@ -7875,6 +7945,31 @@ bool add_key_fields(THD *thd, JOIN *join, Key_field **key_fields,
         }
       }
 
+      /*
+        ST_DISTANCE(col, point) < radius is a range over a next spatial
+        index on col, see get_mm_tree_from_spatial_distance(). Mark the
+        indexes as available for the range optimizer.
+      */
+      Item_field *distance_field;
+      Item *geometry;
+      Item *radius;
+      if (get_next_spatial_distance_bound(cond_func, &distance_field,
+                                          &geometry, &radius) &&
+          is_local_field(distance_field) && geometry->const_item() &&
+          radius->const_item()) {
+        const Field *field = distance_field->field;
+        JOIN_TAB *tab = field->table->reginfo.join_tab;
+        Key_map possible_keys;
+        for (uint key = 0; key < field->table->s->keys; key++) {
+          if (field->key_start.is_set(key) &&
+              field->table->key_info[key].is_next_spatial_index())
+            possible_keys.set_bit(key);
+        }
+        possible_keys.intersect(field->table->keys_in_use_for_query);
+        tab->keys().merge(possible_keys);
+        tab->const_keys.merge(possible_keys);
+      }
+
       break;
     }
     case Item_func::OPTIMIZE_NULL:
@@ -11913,6 +12008,36 @@ double EstimateRowAccesses(const AccessPath *path, double num_evaluations,
             rows += EstimateRowAccesses(param.inner, num_evaluations, kNoLimit);
             return true;
           }
+          case AccessPath::KNN_JOIN: {
+            // KNN join reruns the inner side for each outer row, like a
+            // nested loop join.
+            rows += EstimateRowAccessesInNestedLoopJoin(
+                subpath, subpath->knn_join().outer, subpath->knn_join().inner,
+                num_evaluations, limit);
+            return true;
+          }
+          case AccessPath::SEMANTIC_JOIN: {
+            // Each outer row reads its nearest neighbours from the index.
+            const auto &param = subpath->semantic_join();
+            rows += EstimateRowAccessesInNestedLoopJoin(
+                subpath, param.outer, param.inner, num_evaluations, limit);
+            return true;
+          }
+          case AccessPath::SPATIAL_JOIN: {
+            const auto &param = subpath->spatial_join();
+            if (param.param->table != nullptr) {
+              // Probing the index of the inner table for each outer row is
+              // a nested loop join.
+              rows += EstimateRowAccessesInNestedLoopJoin(
+                  subpath, param.outer, param.inner, num_evaluations, limit);
+              return true;
+            }
+            // Partitioning reads the inner side once, and the outer side
+            // once for each chunk of inner rows.
+            rows += EstimateRowAccesses(param.outer, num_evaluations, kNoLimit);
+            rows += EstimateRowAccesses(param.inner, num_evaluations, kNoLimit);
+            return true;
+          }
           case AccessPath::HASH_JOIN: {
             // Hash join reads each side once. If there is a LIMIT clause, it
             // might not need to read all rows from the outer table.
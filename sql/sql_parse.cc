@@ -130,6 +130,7 @@
 #include "sql/psi_memory_key.h"
 #include "sql/query_options.h"
 #include "sql/query_result.h"
+#include "sql/query_result_cache.h"
 #include "sql/resourcegroups/resource_group_basic_types.h"
 #include "sql/resourcegroups/resource_group_mgr.h"  // Resource_group_mgr::instance
 #include "sql/rpl_context.h"
@@ -796,6 +797,12 @@ void init_sql_command_flags() {
   sql_command_flags[SQLCOM_CREATE_VIEW] =
       CF_CHANGES_DATA | CF_REEXECUTION_FRAGILE | CF_AUTO_COMMIT_TRANS;
   sql_command_flags[SQLCOM_DROP_VIEW] = CF_CHANGES_DATA | CF_AUTO_COMMIT_TRANS;
+  sql_command_flags[SQLCOM_CREATE_MATERIALIZED_VIEW] =
+      CF_CHANGES_DATA | CF_AUTO_COMMIT_TRANS;
+  sql_command_flags[SQLCOM_REFRESH_MATERIALIZED_VIEW] =
+      CF_CHANGES_DATA | CF_AUTO_COMMIT_TRANS;
+  sql_command_flags[SQLCOM_DROP_MATERIALIZED_VIEW] =
+      CF_CHANGES_DATA | CF_AUTO_COMMIT_TRANS;
   sql_command_flags[SQLCOM_CREATE_TRIGGER] =
       CF_CHANGES_DATA | CF_AUTO_COMMIT_TRANS;
   sql_command_flags[SQLCOM_DROP_TRIGGER] =
@@ -2632,6 +2639,8 @@ bool dispatch_command(THD *thd, const COM_DATA *com_data,
           length--;
         }
 
+        counter.end_statement();
+
         /* PSI end */
         MYSQL_END_STATEMENT(thd->m_statement_psi, thd->get_stmt_da());
 
@@ -5490,7 +5499,12 @@ int mysql_execute_command(THD *thd, bool first_level, ulonglong *last_timer) {
     case SQLCOM_EXPLAIN_OTHER:
     case SQLCOM_RESTART_SERVER:
     case SQLCOM_CREATE_SRS:
-    case SQLCOM_DROP_SRS: {
+    case SQLCOM_DROP_SRS:
+    case SQLCOM_CREATE_MATERIALIZED_VIEW:
+    case SQLCOM_REFRESH_MATERIALIZED_VIEW:
+    case SQLCOM_DROP_MATERIALIZED_VIEW:
+    case SQLCOM_SYNC:
+    case SQLCOM_STOP_SYNC: {
       assert(lex->m_sql_cmd != nullptr);
 
       /* The appropriate sql_cmd will set thd->pre_exec_time */
@@ -6004,6 +6018,7 @@ void THD::reset_for_next_command() {
   thd->durability_property = HA_REGULAR_DURABILITY;
   thd->set_trans_pos(nullptr, 0);
   thd->m_gap_lock_log_written = false;
+  thd->engine_perf_context.clear();
   thd->derived_tables_processing = false;
   thd->parsing_system_view = false;
 
@@ -6279,10 +6294,15 @@ void dispatch_sql_command(THD *thd, Parser_state *parser_state,
           bool switched = mgr_ptr->switch_resource_group_if_needed(
               thd, &src_res_grp, &dest_res_grp, &ticket, &cur_ticket);
 
-          if (thd->admit_query()) {
+          Query_result_cache_statement result_cache;
+          if (query_result_cache_begin(thd, &result_cache)) {
+            error = 0;
+          } else if (thd->admit_query()) {
             error = 1;
+            query_result_cache_end(thd, &result_cache);
           } else {
             error = mysql_execute_command(thd, true, last_timer);
+            query_result_cache_end(thd, &result_cache);
           }
 
           if (switched)
@@ -99,6 +99,7 @@
 #include "sql/parse_tree_node_base.h"
 #include "sql/query_options.h"
 #include "sql/query_result.h"
+#include "sql/query_result_cache.h"
 #include "sql/range_optimizer/path_helpers.h"
 #include "sql/range_optimizer/range_optimizer.h"
 #include "sql/set_var.h"
@@ -608,6 +609,9 @@ bool Sql_cmd_dml::execute(THD *thd) {
     }
   }
 
+  if (thd->m_result_cache != nullptr)
+    query_result_cache_check_tables(thd, lex->query_tables);
+
   thd->pre_exec_time = my_timer_now();
 
   // Perform statement-specific execution
@@ -3285,8 +3289,15 @@ bool make_join_readinfo(JOIN *join, uint no_jbuf_after) {
               The previous 3 points related to changing the vector index access
               access method are implemented in test_if_order_by_key()
             */
+            // bounds on the distance drop none of the k nearest within them
+            std::optional<double> bound;
+            // multi-vector and sparse indexes have no index scan, their
+            // knn searches are expanded until enough rows pass the condition
             if (join->thd->variables.fb_vector_search_type !=
-                FB_VECTOR_SEARCH_KNN_FIRST) {
+                    FB_VECTOR_SEARCH_KNN_FIRST &&
+                table->key_info[keynr]
+                    .fb_vector_index_config.supports_index_scan() &&
+                !fb_vector_distance_bound(row_cond, item_func, &bound)) {
               /*
                  We have a condition that cannot be pushed to the storage
                  engine. This will cause wrong results if we rely on the
@@ -3357,6 +3368,12 @@ bool make_join_readinfo(JOIN *join, uint no_jbuf_after) {
           if (!table->key_read)
             qep_tab->push_index_cond(tab, used_index(qep_tab->range_scan()),
                                      &trace_refine_table);
+          const uint range_index = used_index(qep_tab->range_scan());
+          if (range_index != MAX_KEY &&
+              table->key_info[range_index].is_next_spatial_index() &&
+              qep_tab->condition())
+            table->file->next_spatial_cond_push(range_index,
+                                                qep_tab->condition());
         }
         if (tab->position()->filter_effect != COND_FILTER_STALE_NO_CONST) {
           double rows_w_const_cond = qep_tab->position()->rows_fetched;
@@ -5258,14 +5275,22 @@ bool test_if_cheaper_ordering(const JOIN_TAB *tab, ORDER_with_src *order,
                         table_scan_time.total_cost());
 
         /*
-          Vector search through FAISS will be orders of magnitude faster
-          than doing a filesort. In order to make the optimizer prefer
-          the vector index, we add this as a factor by decreasing the
-          index scan time
+          A knn search reads the vectors close to the query instead of
+          walking the index in key order, so ask the engine to cost it from
+          its index statistics. Without an estimate, fall back to making
+          the vector index fb_vector_index_cost_factor times cheaper than the
+          index scan, as vector search through FAISS is orders of magnitude
+          faster than doing a filesort.
         */
         if (is_vector_index) {
-          index_scan_time /=
-              table->in_use->variables.fb_vector_index_cost_factor;
+          Cost_estimate vector_cost;
+          if (!table->file->vector_index_scan_cost(nr, select_limit,
+                                                   &vector_cost)) {
+            index_scan_time = vector_cost.total_cost();
+          } else {
+            index_scan_time /=
+                table->in_use->variables.fb_vector_index_cost_factor;
+          }
         }
 
         /*
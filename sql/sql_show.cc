@@ -2204,7 +2204,9 @@ bool store_create_info(THD *thd, Table_ref *table_list, String *packet,
       field->gcol_info->print_expr(thd, &s);
       packet->append(s);
       packet->append(STRING_WITH_LEN(")"));
-      if (field->stored_in_db)
+      if (field->stored_in_db && field->gcol_info->is_async())
+        packet->append(STRING_WITH_LEN(" STORED ASYNC"));
+      else if (field->stored_in_db)
         packet->append(STRING_WITH_LEN(" STORED"));
       else
         packet->append(STRING_WITH_LEN(" VIRTUAL"));
@@ -2296,6 +2298,9 @@ bool store_create_info(THD *thd, Table_ref *table_list, String *packet,
       packet->append(STRING_WITH_LEN(" FB_VECTOR_DIMENSION "));
       auto dimension_str = std::to_string(field->m_fb_vector_dimension);
       packet->append(dimension_str);
+      if (field->m_fb_vector_multi) {
+        packet->append(STRING_WITH_LEN(" ARRAY"));
+      }
     }
   }
 
@@ -2725,6 +2730,11 @@ static void store_fb_vector_index_options(String *packet, KEY *key_info) {
     packet->append(trained_index_id);
     packet->append("'");
   }
+  if (vector_index_info.metric() != FB_VECTOR_INDEX_METRIC::NONE) {
+    packet->append(" FB_VECTOR_INDEX_METRIC '");
+    packet->append(fb_vector_index_metric_to_string(vector_index_info.metric()));
+    packet->append("'");
+  }
 }
 /**
   show next spatial index options
@@ -6078,6 +6088,36 @@ ST_FIELD_INFO admission_control_errors_fields_info[] = {
     {"INFO", 256, MYSQL_TYPE_STRING, 0, MY_I_S_UNSIGNED, 0, 0},
     {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, 0}};
 
+ST_FIELD_INFO admission_control_waits_fields_info[] = {
+    {"SCHEMA_NAME", NAME_LEN, MYSQL_TYPE_STRING, 0, 0, 0, 0},
+    {"TIME", MAX_DOUBLE_STR_LENGTH, MYSQL_TYPE_DOUBLE, 0, 0, 0, 0},
+    {"THREAD_ID", 10, MYSQL_TYPE_LONG, 0, MY_I_S_UNSIGNED, 0, 0},
+    {"RESULT", 20, MYSQL_TYPE_STRING, 0, 0, 0, 0},
+    {"MODE", 20, MYSQL_TYPE_STRING, 0, 0, 0, 0},
+    {"QUEUE", 10, MYSQL_TYPE_LONG, 0, MY_I_S_UNSIGNED, 0, 0},
+    {"QUEUE_LENGTH", 10, MYSQL_TYPE_LONG, 0, MY_I_S_UNSIGNED, 0, 0},
+    {"WAIT_TIME", MAX_DOUBLE_STR_LENGTH, MYSQL_TYPE_DOUBLE, 0, 0, 0, 0},
+    {"SQL_ID", DIGEST_HASH_TO_STRING_LENGTH, MYSQL_TYPE_STRING, 0, 0, 0, 0},
+    {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, 0}};
+
+// The WAITS_* columns follow ac_wait_bucket_bounds_us.
+ST_FIELD_INFO admission_control_wait_histogram_fields_info[] = {
+    {"SCHEMA_NAME", NAME_LEN, MYSQL_TYPE_STRING, 0, 0, 0, 0},
+    {"QUEUE_ID", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, 0},
+    {"ADMISSIONS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, 0},
+    {"WAITS_UNDER_1MS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, 0},
+    {"WAITS_UNDER_10MS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, 0},
+    {"WAITS_UNDER_100MS", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, 0},
+    {"WAITS_UNDER_1S", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, 0},
+    {"WAITS_UNDER_10S", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, 0},
+    {"WAITS_OVER_10S", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, 0},
+    {"WAIT_TIME", MAX_DOUBLE_STR_LENGTH, MYSQL_TYPE_DOUBLE, 0, 0, 0, 0},
+    {"MAX_WAIT_TIME", MAX_DOUBLE_STR_LENGTH, MYSQL_TYPE_DOUBLE, 0, 0, 0, 0},
+    {"ABORTED_QUERIES", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, 0},
+    {"TIMEOUT_QUERIES", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, 0},
+    {"KILLED_QUERIES", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, 0},
+    {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, 0}};
+
 /** For creating fields of information_schema.OPTIMIZER_TRACE */
 extern ST_FIELD_INFO optimizer_trace_info[];
 
@@ -6136,8 +6176,15 @@ ST_SCHEMA_TABLE schema_tables[] = {
      fill_ac_errors, nullptr, nullptr, false},
     {"ADMISSION_CONTROL_QUEUE", admission_control_queue_fields_info,
      fill_ac_queue, nullptr, nullptr, false},
+    {"ADMISSION_CONTROL_WAITS", admission_control_waits_fields_info,
+     fill_ac_waits, nullptr, nullptr, false},
+    {"ADMISSION_CONTROL_WAIT_HISTOGRAM",
+     admission_control_wait_histogram_fields_info, fill_ac_wait_histogram,
+     nullptr, nullptr, false},
     {"FAILURE_INJECTION_POINTS", failure_injection_points_fields_info,
      fill_failure_injection_points, nullptr, nullptr, false},
+    {"QUERY_SAMPLE_PROFILE", qutils::query_sample_profile_fields_info,
+     qutils::fill_query_sample_profile, nullptr, nullptr, false},
     {nullptr, nullptr, nullptr, nullptr, nullptr, false}};
 
 int initialize_schema_table(st_plugin_int *plugin) {
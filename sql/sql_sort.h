@@ -261,6 +261,10 @@ class Filesort_info {
     filesort_buffer.set_max_size(max_size, record_length);
   }
 
+  void set_large_pages(bool large_pages) {
+    filesort_buffer.set_large_pages(large_pages);
+  }
+
   void free_sort_buffer() { filesort_buffer.free_sort_buffer(); }
 
   bool preallocate_records(size_t num_records) {
@@ -1,206 +1,139 @@
 #include "sql/sql_sync.h"
-#include "mysqld.h"     // 主服务器定义和全局变量
-#include "sql_parse.h"  // SQL解析器相关函数
-#include "handler.h"    // 表处理器接口
 
-
-#include <fstream>
-#include <iostream> 
-#include <chrono>
-#include <ctime>
-#include <chrono>
-#include <thread>
-
-#include <sstream>
-#include <iomanip>    // For std::setw and std::left
+#include <string>
 #include <vector>
-#include "sql_class.h"  // THD, Item
-#include "query_result.h"
-#include "sql_lex.h"
-#include "lock.h"
-
-
-class Query_result; 
-
-class Query_result_logger : public Query_result {
-public:
-    std::ostringstream result_stream;
-    std::vector<std::string> column_names;
-    std::vector<size_t> column_widths;
-
-    bool send_result_set_metadata(THD *thd, const mem_root_deque<Item *> &list, uint flags) override {
-        (void) thd;
-        (void) flags;
-        result_stream << "+";
-        for (Item *col : list) {
-            std::string name = col->item_name.ptr();  // 获取列名
-            size_t width = std::max(name.size(), size_t(10));  // 保持最小宽度为10
-            column_names.push_back(name);
-            column_widths.push_back(width);
-            result_stream << std::string(width + 2, '-') << "+";  // 创建表头分隔符
-        }
-        result_stream << "\n|";
-
-        for (size_t i = 0; i < column_names.size(); ++i) {
-            result_stream << " " << std::setw(column_widths[i]) << std::left << column_names[i] << " |";  // 格式化表头
-        }
-        result_stream << "\n+";
-        for (size_t width : column_widths) {
-            result_stream << std::string(width + 2, '-') << "+";  // 再次添加分隔符
-        }
-        result_stream << "\n";
-        return false;
-    }
-
-    bool send_data(THD *thd, const mem_root_deque<Item *> &items) override {
-        (void) thd;
-        // result_stream << "|";
-        // for (size_t i = 0; i < items.size(); ++i) {
-        //     char buff[1024];
-        //     String str(buff, sizeof(buff), &my_charset_bin);
-        //     if (items[i]->val_str(&str)) {
-        //         result_stream << " " << std::setw(column_widths[i]) << std::left << str.c_ptr_safe() << " |";
-        //     } else {
-        //         result_stream << " " << std::setw(column_widths[i]) << std::left << "NULL" << " |";
-        //     }
-        // }
-        // result_stream << "\n";
-        // return false;
-        result_stream << "|";
-        int i = 0;
-        for (auto col : VisibleFields(items)) {
-            char buff[1024];
-            String str(buff, sizeof(buff), &my_charset_utf8mb4_general_ci);
-            String* vstr = col->val_str(&str);
-            if(str.length()==1024){
-                bool cvstr = col->custom_val_str(&str);
-            }                 
-            result_stream << " " << std::setw(column_widths[i]) << std::left << str.c_ptr_safe() << " |";
-            i++;
-        }
-        result_stream << "\n";
-        return false;
-    }
-
-    bool send_eof(THD *thd) override {
-        (void) thd;
-        result_stream << "+";
-        for (size_t width : column_widths) {
-            result_stream << std::string(width + 2, '-') << "+";  // 末尾的分隔符
-        }
-        result_stream << "\n";
-        return false;
-    }
-
-    void log_reset() {
-        result_stream.str("");  // 清空ostringstream
-        result_stream.clear();  // 清除任何错误标志
-        column_names.clear();   // 清空列名
-        column_widths.clear();  // 清空列宽记录
-    }
 
-    std::string fetch_results() {
-        return result_stream.str();
+#include "mysqld_error.h"
+#include "sql/auth/auth_acls.h"
+#include "sql/auth/auth_common.h"
+#include "sql/change_stream.h"
+#include "sql/continuous_geofence.h"
+#include "sql/continuous_query.h"
+#include "sql/continuous_shared.h"
+#include "sql/continuous_top_k.h"
+#include "sql/continuous_window.h"
+#include "sql/sql_base.h"
+#include "sql/sql_class.h"
+#include "sql/sql_lex.h"
+#include "sql/sql_materialized_view.h"
+#include "sql/table.h"
+#include "template_utils.h"
+
+namespace {
+
+/// What an ASYNC query is, beyond a statement run again.
+enum class Async_kind { QUERY, TOP_K, GEOFENCE, WINDOW, SHARED };
+
+/**
+  The base tables an ASYNC query reads, those of its views included, and
+  what it searches if it searches the k nearest rows of its only table or
+  the rows of it in a region, or the constant it compares a column of it
+  to, or what it aggregates if it has a WINDOW clause.
+*/
+bool async_tables(THD *thd, const Sync_window &window,
+                  std::vector<Change_stream_table> *tables,
+                  Continuous_top_k_spec *top_k,
+                  Continuous_geofence_spec *fence,
+                  Continuous_shared_spec *shared,
+                  Continuous_window_spec *windowed, Async_kind *kind) {
+  LEX *const lex = thd->lex;
+  if (lex->query_tables == nullptr) {
+    my_error(ER_NOT_SUPPORTED_YET, MYF(0),
+             "ASYNC continuous queries without tables");
+    return true;
+  }
+  if (check_table_access(thd, SELECT_ACL, lex->query_tables, false, UINT_MAX,
+                         false) ||
+      open_tables_for_query(thd, lex->query_tables, 0))
+    return true;
+  for (Table_ref *tl = lex->query_tables; tl != nullptr; tl = tl->next_global) {
+    if (tl->is_view_or_derived() || tl->is_table_function() ||
+        tl->schema_table != nullptr || tl->table == nullptr ||
+        tl->table->s->tmp_table != NO_TMP_TABLE)
+      continue;
+    tables->push_back({tl->table->s->db.str, tl->table->s->table_name.str});
+  }
+  *kind = Async_kind::QUERY;
+  if (window.column != nullptr) {
+    if (lex->query_tables->next_global != nullptr || tables->size() != 1) {
+      close_thread_tables(thd);
+      my_error(ER_NOT_SUPPORTED_YET, MYF(0),
+               "WINDOW over other than a base table");
+      return true;
     }
-};
-
-
-void log_query_result(const std::string& result, const std::string& log_file_path) {
-    // 获取当前系统时间
-    auto now = std::chrono::system_clock::now();
-    std::time_t end_time = std::chrono::system_clock::to_time_t(now);
-    
-    // 打开日志文件
-    std::ofstream log_file(log_file_path, std::ios::app);
-    if (log_file.is_open()) {
-        // 写入时间戳和查询结果
-        log_file << std::ctime(&end_time) << result << std::endl;
-        log_file.close();
-    } else {
-        std::cerr << "Unable to open log file." << std::endl;
+    if (continuous_window_prepare(thd, lex->query_tables->table,
+                                  window.column, window.size, window.step,
+                                  windowed)) {
+      close_thread_tables(thd);
+      return true;
     }
+    *kind = Async_kind::WINDOW;
+  } else if (lex->query_tables->next_global == nullptr &&
+             tables->size() == 1) {
+    TABLE *const table = lex->query_tables->table;
+    if (continuous_top_k_match(thd, table, top_k))
+      *kind = Async_kind::TOP_K;
+    else if (continuous_geofence_match(thd, table, fence))
+      *kind = Async_kind::GEOFENCE;
+    else if (continuous_shared_match(thd, table, shared))
+      *kind = Async_kind::SHARED;
+  }
+  close_thread_tables(thd);
+  if (tables->empty()) {
+    my_error(ER_NOT_SUPPORTED_YET, MYF(0),
+             "ASYNC continuous queries without base tables");
+    return true;
+  }
+  return false;
 }
 
-
-// std::string fetch_results(Query_result *result) {
-//     return "test";
-// }
-// bool Sql_cmd_sync::execute(THD *thd) { 
-//     if (m_orig_cmd) {
-//         bool execution_result = m_orig_cmd->execute(thd);
-//         std::string s_result = fetch_results(result);       
-//         log_query_result(s_result, "../sync.log");
-//         return execution_result;
-//     }
-//     return true;
-// }
-
-
-// bool Sql_cmd_sync::execute(THD *thd) {
-
-//     if (!m_orig_cmd) return true;
-
-//     Query_result_logger logger;
-//     Query_result *old_result = thd->lex->result;  // 备份旧的结果处理器
-//     thd->lex->result = &logger;  // 设置新的结果处理器
-
-//     for (int i = 0; i < 3; ++i) {
-//         logger.log_reset();
-
-//         bool execution_result = m_orig_cmd->execute(thd);
-        
-//         // std::string s_result = fetch_results(result);  
-
-//         std::string s_result = logger.fetch_results();
-
-//         log_query_result(s_result, "../sync.log");
-
-//         if (execution_result) return true;
-
-//         std::this_thread::sleep_for(std::chrono::seconds(m_interval));
-
-//     }
-    
-//     thd->lex->result = old_result;  // 恢复旧的结果处理器
-
-//     return false;
-
-// }
-
+}  // namespace
 
 bool Sql_cmd_sync::execute(THD *thd) {
-
-    if (!m_orig_cmd) return true; 
-
-    Query_result_logger logger;
-    thd->lex->result = &logger;
-
-    for (int i = 0; i < 5; ++i) {
-        
-        logger.log_reset();
-        thd->lex->unit->clear_execution();
-
-        m_orig_cmd->update_bypassed(false); 
-        m_orig_cmd->update_prepared(false);
-
-        bool execution_result = m_orig_cmd->execute(thd);
-        
-        std::string s_result = logger.fetch_results();
-
-        log_query_result(s_result, "../sync.log");
-
-        if (execution_result) return true;
-
-        if (thd->locked_tables_mode) {
-            mysql_unlock_tables(thd, thd->lock);
-            thd->locked_tables_mode = LTM_NONE;
-        }
-
-        std::this_thread::sleep_for(std::chrono::seconds(m_interval));
-
-    }
-    
+  std::string text(m_text.str, m_text.length);
+  ulonglong id;
+  if (m_async) {
+    std::vector<Change_stream_table> tables;
+    Continuous_top_k_spec top_k;
+    Continuous_geofence_spec fence;
+    Continuous_shared_spec shared;
+    Continuous_window_spec windowed;
+    Async_kind kind;
+    if (async_tables(thd, m_window, &tables, &top_k, &fence, &shared,
+                     &windowed, &kind))
+      return true;
+    if (kind == Async_kind::GEOFENCE
+            ? continuous_query_start_geofence(thd, text, fence, &id)
+        : kind == Async_kind::SHARED
+            ? continuous_query_start_shared(thd, text, shared, &id)
+            : continuous_query_start_async(
+                  thd, text, tables,
+                  kind == Async_kind::TOP_K ? &top_k : nullptr,
+                  kind == Async_kind::WINDOW ? &windowed : nullptr, &id))
+      return true;
+    char message[64];
+    snprintf(message, sizeof(message), "Continuous query id: %llu", id);
+    my_ok(thd, 0, id, message);
     return false;
-
+  }
+
+  std::string view;
+  if (m_cmd->sql_command_code() == SQLCOM_REFRESH_MATERIALIZED_VIEW) {
+    if (down_cast<Sql_cmd_refresh_materialized_view *>(m_cmd)->quoted_name(
+            thd, &view))
+      return true;
+    text = "REFRESH MATERIALIZED VIEW " + view;
+  }
+
+  if (continuous_query_start(thd, text, m_interval, view, &id)) return true;
+  char message[64];
+  snprintf(message, sizeof(message), "Continuous query id: %llu", id);
+  my_ok(thd, 0, id, message);
+  return false;
 }
 
+bool Sql_cmd_stop_sync::execute(THD *thd) {
+  if (continuous_query_stop(thd, m_id)) return true;
+  my_ok(thd);
+  return false;
+}
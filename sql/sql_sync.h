@@ -1,38 +1,71 @@
 #ifndef SQL_SYNC_INCLUDED
 #define SQL_SYNC_INCLUDED
 
-#include "sql/sql_select.h"
+/**
+  @file
+  <statement> SYNC <period> and STOP SYNC <id>, see continuous_query.h.
+*/
 
-class Sql_cmd_sync : public Sql_cmd_dml {
+#include "lex_string.h"
+#include "my_inttypes.h"
+#include "my_sqlcommand.h"
+#include "sql/sql_cmd.h"
+
+class THD;
+
+/// The WINDOW clause of SYNC ASYNC, see continuous_window.h.
+struct Sync_window {
+  /// The event time column, nullptr without a WINDOW clause.
+  const char *column = nullptr;
+  /// Seconds a window lasts, and between the starts of two windows.
+  ulong size = 0;
+  ulong step = 0;
+};
+
+class Sql_cmd_sync final : public Sql_cmd {
  public:
-  // 构造函数
-  Sql_cmd_sync(Sql_cmd_dml* orig_cmd, ulong interval) 
-      : m_orig_cmd(orig_cmd), m_interval(interval) {}
-
-  // 重写 execute 方法
-  virtual bool execute(THD *thd) override;
-  bool precheck(THD *thd) {
-    (void) thd;
-    return false; 
-  }
-  bool check_privileges(THD *thd) {
-    (void) thd;
-    return false; 
-  }
-  bool prepare_inner(THD *thd) {
-    (void) thd;
-    return false; 
-  }
-  enum_sql_command sql_command_code() const { return SQLCOM_SYNC; }
+  /**
+    @param cmd the statement to run continuously, a SELECT or a REFRESH
+      MATERIALIZED VIEW
+    @param interval seconds between runs
+    @param text the text of a SELECT
+    @param async run a SELECT as the tables it reads change, rather than
+      every interval
+    @param window the windows an ASYNC SELECT aggregates
+  */
+  Sql_cmd_sync(Sql_cmd *cmd, ulong interval, LEX_CSTRING text, bool async,
+               const Sync_window &window = Sync_window())
+      : m_cmd(cmd),
+        m_interval(interval),
+        m_text(text),
+        m_async(async),
+        m_window(window) {}
+
+  enum_sql_command sql_command_code() const override { return SQLCOM_SYNC; }
 
+  /// Start the continuous query, sending its id as the last insert id.
+  bool execute(THD *thd) override;
 
  private:
-  Sql_cmd_dml* m_orig_cmd; // 原始 SQL 命令
-  ulong m_interval;    // 间隔时间，单位：秒
+  Sql_cmd *m_cmd;
+  ulong m_interval;
+  LEX_CSTRING m_text;
+  bool m_async;
+  Sync_window m_window;
 };
 
+class Sql_cmd_stop_sync final : public Sql_cmd {
+ public:
+  explicit Sql_cmd_stop_sync(ulonglong id) : m_id(id) {}
 
+  enum_sql_command sql_command_code() const override {
+    return SQLCOM_STOP_SYNC;
+  }
 
+  bool execute(THD *thd) override;
 
+ private:
+  ulonglong m_id;
+};
 
-#endif /* SQL_SYNC_INCLUDED */
\ No newline at end of file
+#endif /* SQL_SYNC_INCLUDED */
@@ -4614,6 +4614,13 @@ bool prepare_create_field(THD *thd, const char *error_schema_name,
     return true;
   }
 
+  // A STORED ASYNC column is NULL until it is filled in the background.
+  if (sql_field->gcol_info && sql_field->gcol_info->is_async() &&
+      (sql_field->flags & NOT_NULL_FLAG)) {
+    my_error(ER_WRONG_USAGE, MYF(0), "STORED ASYNC", "NOT NULL column");
+    return true;
+  }
+
   // Validate field comment string
   std::string invalid_sub_str;
   if (is_invalid_string(
@@ -4948,8 +4955,18 @@ static bool prepare_key_column(THD *thd, HA_CREATE_INFO *create_info,
   }
 
   // fb_vector index only support type `json not null fb_vector_dimension`
-  // or `blob not null fb_vector_dimension`
-  if (key_info->is_fb_vector_index()) {
+  // or `blob not null fb_vector_dimension`, sparse vectors carry their
+  // indexes in a plain json column
+  if (key_info->is_fb_vector_index() &&
+      key_info->fb_vector_index_config.sparse()) {
+    if (sql_field->sql_type != MYSQL_TYPE_JSON ||
+        sql_field->m_fb_vector_dimension > 0) {
+      my_error(ER_WRONG_ARGUMENTS, MYF(0),
+               "fb_vector sparse index only support json type without "
+               "dimension");
+      return true;
+    }
+  } else if (key_info->is_fb_vector_index()) {
     if (sql_field->sql_type != MYSQL_TYPE_JSON &&
         sql_field->sql_type != MYSQL_TYPE_BLOB) {
       my_error(ER_WRONG_ARGUMENTS, MYF(0),
@@ -4966,12 +4983,29 @@ static bool prepare_key_column(THD *thd, HA_CREATE_INFO *create_info,
                "fb_vector index column should not be nullable");
       return true;
     }
+    if (sql_field->m_fb_vector_multi !=
+        key_info->fb_vector_index_config.multi()) {
+      my_error(ER_WRONG_ARGUMENTS, MYF(0),
+               "fb_vector index metric maxsim is only and always for "
+               "multi-vector columns");
+      return true;
+    }
+    if (sql_field->m_fb_vector_multi &&
+        key_info->fb_vector_index_config.type() !=
+            FB_VECTOR_INDEX_TYPE::FLAT &&
+        key_info->fb_vector_index_config.type() !=
+            FB_VECTOR_INDEX_TYPE::IVFFLAT) {
+      my_error(ER_WRONG_ARGUMENTS, MYF(0),
+               "fb_vector index on a multi-vector column should be flat or "
+               "ivfflat");
+      return true;
+    }
     // use column's vector dimension here
     auto old_vector_config = key_info->fb_vector_index_config;
     key_info->fb_vector_index_config = FB_vector_index_config(
         old_vector_config.type(), sql_field->m_fb_vector_dimension,
         old_vector_config.trained_index_table(),
-        old_vector_config.trained_index_id());
+        old_vector_config.trained_index_id(), old_vector_config.metric());
   }
 
   // JSON columns cannot be used as keys.
@@ -7281,7 +7315,9 @@ static bool prepare_fb_vector_index(const Key_spec *key, KEY *key_info) {
   }
 
   if (fb_vector_index_type == FB_VECTOR_INDEX_TYPE::IVFFLAT ||
-      fb_vector_index_type == FB_VECTOR_INDEX_TYPE::IVFPQ) {
+      fb_vector_index_type == FB_VECTOR_INDEX_TYPE::IVFPQ ||
+      fb_vector_index_type == FB_VECTOR_INDEX_TYPE::IVFSQ8 ||
+      fb_vector_index_type == FB_VECTOR_INDEX_TYPE::IVFFP16) {
     if (key->key_create_info.m_fb_vector_trained_index_id.length == 0 ||
         key->key_create_info.m_fb_vector_trained_index_table.length == 0) {
       my_error(ER_WRONG_ARGUMENTS, MYF(0), "missing trained index options");
@@ -7295,12 +7331,29 @@ static bool prepare_fb_vector_index(const Key_spec *key, KEY *key_info) {
     }
   }
 
+  FB_VECTOR_INDEX_METRIC fb_vector_index_metric = FB_VECTOR_INDEX_METRIC::NONE;
+  if (key->key_create_info.m_fb_vector_index_metric.length > 0 &&
+      parse_fb_vector_index_metric(
+          key->key_create_info.m_fb_vector_index_metric,
+          fb_vector_index_metric)) {
+    my_error(ER_WRONG_ARGUMENTS, MYF(0), "invalid fb_vector_index_metric");
+    return true;
+  }
+  if (fb_vector_index_type == FB_VECTOR_INDEX_TYPE::SPARSE &&
+      fb_vector_index_metric != FB_VECTOR_INDEX_METRIC::NONE &&
+      fb_vector_index_metric != FB_VECTOR_INDEX_METRIC::IP) {
+    my_error(ER_WRONG_ARGUMENTS, MYF(0),
+             "fb_vector sparse index only support metric ip");
+    return true;
+  }
+
   // dimension will be populated in prepare_key_column
   constexpr FB_vector_dimension dummy_dimension = 0;
   key_info->fb_vector_index_config = FB_vector_index_config(
       fb_vector_index_type, dummy_dimension,
       key->key_create_info.m_fb_vector_trained_index_table,
-      key->key_create_info.m_fb_vector_trained_index_id);
+      key->key_create_info.m_fb_vector_trained_index_id,
+      fb_vector_index_metric);
   return false;
 }
 
@@ -11696,9 +11749,8 @@ bool Sql_cmd_secondary_load_unload::mysql_secondary_load_or_unload(
   assert(table_list->table->s->tmp_table == NO_TMP_TABLE);
 
   handlerton *hton = table_list->table->s->db_type();
-  assert(hton->flags & HTON_SUPPORTS_ATOMIC_DDL &&
-         hton->flags & HTON_SUPPORTS_SECONDARY_ENGINE &&
-         hton->post_ddl != nullptr);
+  // Primary engines without atomic DDL, e.g. MyRocks, have no post_ddl.
+  assert(hton->flags & HTON_SUPPORTS_SECONDARY_ENGINE);
 
   dd::cache::Dictionary_client::Auto_releaser releaser(thd->dd_client());
   dd::Table *table_def = nullptr;
@@ -11721,7 +11773,7 @@ bool Sql_cmd_secondary_load_unload::mysql_secondary_load_or_unload(
 
   // Cleanup that must be done regardless of commit or rollback.
   auto cleanup = [thd, hton]() {
-    hton->post_ddl(thd);
+    if (hton->post_ddl != nullptr) hton->post_ddl(thd);
     return thd->locked_tables_mode &&
            thd->locked_tables_list.reopen_tables(thd);
   };
@@ -12948,7 +13000,9 @@ static bool is_inplace_alter_impossible(TABLE *table,
     if (new_field_def.field != nullptr &&
         new_field_def.m_fb_vector_dimension > 0) {
       if (new_field_def.field->m_fb_vector_dimension !=
-          new_field_def.m_fb_vector_dimension)
+              new_field_def.m_fb_vector_dimension ||
+          new_field_def.field->m_fb_vector_multi !=
+              new_field_def.m_fb_vector_multi)
         return true;
     }
   }
@@ -14751,6 +14805,14 @@ static void prepare_fb_vector_key(KEY *key_info,
     key_create_info.m_fb_vector_trained_index_table =
         key_info->fb_vector_index_config.trained_index_table();
   }
+  if (key_info->fb_vector_index_config.metric() !=
+      FB_VECTOR_INDEX_METRIC::NONE) {
+    std::string_view vector_index_metric = fb_vector_index_metric_to_string(
+        key_info->fb_vector_index_config.metric());
+    key_create_info.m_fb_vector_index_metric =
+        LEX_CSTRING{.str = vector_index_metric.data(),
+                    .length = vector_index_metric.length()};
+  }
 }
 
 // prepare next_spatial key for alter and upgrade
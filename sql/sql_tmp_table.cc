@@ -537,6 +537,17 @@ static void setup_tmp_table_column_bitmaps(TABLE *table, uchar *bitmaps) {
   asking the storage engines for the values properties.
 */
 
+/**
+  Whether internal temporary tables are stored on disk in RocksDB: when
+  enable_rocksdb_intrinsic_tmp_table asks for it, and when InnoDB is not
+  enabled, as with a RocksDB data dictionary and --skip-innodb.
+*/
+static bool rocksdb_is_tmp_disk_engine() {
+  return enable_rocksdb_intrinsic_tmp_table ||
+         (!ha_storage_engine_is_enabled(innodb_hton) &&
+          ha_storage_engine_is_enabled(rocksdb_hton));
+}
+
 class Cache_temp_engine_properties {
  public:
   static uint HEAP_MAX_KEY_LENGTH;
@@ -578,26 +589,28 @@ void Cache_temp_engine_properties::init(THD *thd) {
   destroy(handler);
   plugin_unlock(nullptr, db_plugin);
   // Cache INNODB engine's
-  db_plugin = ha_lock_engine(nullptr, innodb_hton);
-  handler = get_new_handler((TABLE_SHARE *)nullptr, false, thd->mem_root,
-                            innodb_hton);
-  INNODB_MAX_KEY_LENGTH = handler->max_key_length();
-  /*
-    For ha_innobase::max_supported_key_part_length(), the returned value
-    is constant. However, in innodb itself, the limitation
-    on key_part length is up to the ROW_FORMAT. In current trunk, internal
-    temp table's ROW_FORMAT is DYNAMIC. In order to keep the consistence
-    between server and innodb, here we hard-coded 3072 as the maximum of
-    key_part length supported by innodb until bug#20629014 is fixed.
-
-    TODO: Remove the hard-code here after bug#20629014 is fixed.
-  */
-  INNODB_MAX_KEY_PART_LENGTH = 3072;
-  INNODB_MAX_KEY_PARTS = handler->max_key_parts();
-  destroy(handler);
-  plugin_unlock(nullptr, db_plugin);
+  if (ha_storage_engine_is_enabled(innodb_hton)) {
+    db_plugin = ha_lock_engine(nullptr, innodb_hton);
+    handler = get_new_handler((TABLE_SHARE *)nullptr, false, thd->mem_root,
+                              innodb_hton);
+    INNODB_MAX_KEY_LENGTH = handler->max_key_length();
+    /*
+      For ha_innobase::max_supported_key_part_length(), the returned value
+      is constant. However, in innodb itself, the limitation
+      on key_part length is up to the ROW_FORMAT. In current trunk, internal
+      temp table's ROW_FORMAT is DYNAMIC. In order to keep the consistence
+      between server and innodb, here we hard-coded 3072 as the maximum of
+      key_part length supported by innodb until bug#20629014 is fixed.
+
+      TODO: Remove the hard-code here after bug#20629014 is fixed.
+    */
+    INNODB_MAX_KEY_PART_LENGTH = 3072;
+    INNODB_MAX_KEY_PARTS = handler->max_key_parts();
+    destroy(handler);
+    plugin_unlock(nullptr, db_plugin);
+  }
   // Cache ROCKSDB engine's
-  if (enable_rocksdb_intrinsic_tmp_table) {
+  if (rocksdb_is_tmp_disk_engine()) {
     db_plugin = ha_lock_engine(nullptr, rocksdb_hton);
     handler = get_new_handler((TABLE_SHARE *)nullptr, false, thd->mem_root,
                               rocksdb_hton);
@@ -651,29 +664,26 @@ void get_max_key_and_part_length(uint *max_key_length,
                                  uint *max_key_parts) {
   // Make sure these cached properties are initialized.
   assert(Cache_temp_engine_properties::HEAP_MAX_KEY_LENGTH);
-  if (enable_rocksdb_intrinsic_tmp_table) {
-    *max_key_length =
-        std::min({Cache_temp_engine_properties::HEAP_MAX_KEY_LENGTH,
-                  Cache_temp_engine_properties::INNODB_MAX_KEY_LENGTH,
-                  Cache_temp_engine_properties::ROCKSDB_MAX_KEY_LENGTH});
+  *max_key_length = Cache_temp_engine_properties::HEAP_MAX_KEY_LENGTH;
+  *max_key_part_length = Cache_temp_engine_properties::HEAP_MAX_KEY_PART_LENGTH;
+  *max_key_parts = Cache_temp_engine_properties::HEAP_MAX_KEY_PARTS;
+  if (ha_storage_engine_is_enabled(innodb_hton)) {
+    *max_key_length = std::min(
+        *max_key_length, Cache_temp_engine_properties::INNODB_MAX_KEY_LENGTH);
     *max_key_part_length =
-        std::min({Cache_temp_engine_properties::HEAP_MAX_KEY_PART_LENGTH,
-                  Cache_temp_engine_properties::INNODB_MAX_KEY_PART_LENGTH,
-                  Cache_temp_engine_properties::ROCKSDB_MAX_KEY_PART_LENGTH});
-    *max_key_parts =
-        std::min({Cache_temp_engine_properties::HEAP_MAX_KEY_PARTS,
-                  Cache_temp_engine_properties::INNODB_MAX_KEY_PARTS,
-                  Cache_temp_engine_properties::ROCKSDB_MAX_KEY_PARTS});
-  } else {
-    *max_key_length =
-        std::min(Cache_temp_engine_properties::HEAP_MAX_KEY_LENGTH,
-                 Cache_temp_engine_properties::INNODB_MAX_KEY_LENGTH);
-    *max_key_part_length =
-        std::min(Cache_temp_engine_properties::HEAP_MAX_KEY_PART_LENGTH,
+        std::min(*max_key_part_length,
                  Cache_temp_engine_properties::INNODB_MAX_KEY_PART_LENGTH);
-    *max_key_parts =
-        std::min(Cache_temp_engine_properties::HEAP_MAX_KEY_PARTS,
-                 Cache_temp_engine_properties::INNODB_MAX_KEY_PARTS);
+    *max_key_parts = std::min(
+        *max_key_parts, Cache_temp_engine_properties::INNODB_MAX_KEY_PARTS);
+  }
+  if (rocksdb_is_tmp_disk_engine()) {
+    *max_key_length = std::min(
+        *max_key_length, Cache_temp_engine_properties::ROCKSDB_MAX_KEY_LENGTH);
+    *max_key_part_length =
+        std::min(*max_key_part_length,
+                 Cache_temp_engine_properties::ROCKSDB_MAX_KEY_PART_LENGTH);
+    *max_key_parts = std::min(
+        *max_key_parts, Cache_temp_engine_properties::ROCKSDB_MAX_KEY_PARTS);
   }
 }
 
@@ -2979,7 +2989,7 @@ bool reposition_innodb_cursor(TABLE *table, ha_rows row_num) {
   disabled for that duration.
 */
 static bool should_use_rockdb_tmp_table(const THD *thd) {
-  return !opt_initialize && enable_rocksdb_intrinsic_tmp_table &&
+  return !opt_initialize && rocksdb_is_tmp_disk_engine() &&
          thd->system_thread != SYSTEM_THREAD_DD_INITIALIZE;
 }
 
@@ -38,6 +38,7 @@
 #include "scope_guard.h"  // create_scope_guard
 #include "sql/auth/auth_acls.h"
 #include "sql/auth/auth_common.h"            // DROP_ACL
+#include "sql/change_stream.h"               // change_stream_capture_all
 #include "sql/dd/cache/dictionary_client.h"  // dd::cache::Dictionary_client
 #include "sql/dd/dd_schema.h"                // dd::Schema_MDL_locker
 #include "sql/dd/dd_table.h"                 // dd::table_storage_engine
@@ -48,6 +49,7 @@
 #include "sql/debug_sync.h"                  // DEBUG_SYNC
 #include "sql/handler.h"
 #include "sql/lock.h"  // MYSQL_OPEN_* flags
+#include "sql/materialized_view.h"  // materialized_view_capture_all
 #include "sql/mdl.h"
 #include "sql/query_options.h"
 #include "sql/sql_audit.h"        // mysql_audit_table_access_notify
@@ -761,10 +763,16 @@ bool Sql_cmd_truncate_table::execute(THD *thd) {
   Table_ref *first_table = thd->lex->query_block->get_table_list();
   if (check_one_table_access(thd, DROP_ACL, first_table)) return true;
 
-  if (is_temporary_table(first_table))
+  if (is_temporary_table(first_table)) {
     truncate_temporary(thd, first_table);
-  else
+  } else {
+    if (materialized_views_exist())
+      materialized_view_capture_all(thd, first_table->db,
+                                    first_table->table_name);
+    if (change_streams_exist())
+      change_stream_capture_all(thd, first_table->db, first_table->table_name);
     truncate_base(thd, first_table);
+  }
 
   if (!m_error) my_ok(thd);
 
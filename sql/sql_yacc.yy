@@ -1449,6 +1449,12 @@ void warn_about_deprecated_binary(THD *thd)
 %token<lexer.keyword> GB_SYM 10022              /* FB MYSQL */
 %token<lexer.keyword> OPID_SYM 10023              /* FB MYSQL */
 %token<lexer.keyword> NEXT_SPATIAL_INDEX_TYPE_SYM 10024    /* ARCADE MYSQL */
+%token<lexer.keyword> FB_VECTOR_INDEX_METRIC_SYM 10025     /* ARCADE MYSQL */
+%token<lexer.keyword> ASYNC_SYM 10026                      /* ARCADE MYSQL */
+%token<lexer.keyword> MATERIALIZED_SYM 10027               /* ARCADE MYSQL */
+%token<lexer.keyword> REFRESH_SYM 10028                    /* ARCADE MYSQL */
+%token<lexer.keyword> INCREMENTAL_SYM 10029                /* ARCADE MYSQL */
+%token<lexer.keyword> VECTOR_SYM 10030                     /* ARCADE MYSQL */
 
 /*
   Resolve column attribute ambiguity -- force precedence of "UNIQUE KEY" against
@@ -1917,6 +1923,7 @@ void warn_about_deprecated_binary(THD *thd)
         check_table_stmt
         checksum
         create_index_stmt
+        create_materialized_view_stmt
         create_resource_group_stmt
         create_role_stmt
         create_srs_stmt
@@ -1925,6 +1932,7 @@ void warn_about_deprecated_binary(THD *thd)
         describe_stmt
         do_stmt
         drop_index_stmt
+        drop_materialized_view_stmt
         drop_resource_group_stmt
         drop_role_stmt
         drop_srs_stmt
@@ -1937,6 +1945,7 @@ void warn_about_deprecated_binary(THD *thd)
         load_stmt
         optimize_table_stmt
         preload_stmt
+        refresh_materialized_view_stmt
         repair_table_stmt
         replace_stmt
         restart_server_stmt
@@ -1999,9 +2008,10 @@ void warn_about_deprecated_binary(THD *thd)
         truncate_stmt
         update_stmt
         sync_statement
+        stop_sync_stmt
         any_sql_stmt
 
-%type <num> time_units time_unit
+%type <num> time_units time_unit opt_sync_window_step
 
 %type <table_ident> table_ident_opt_wild
 
@@ -2396,6 +2406,7 @@ simple_statement:
         | commit                        { $$= nullptr; }
         | create                        { $$= nullptr; }
         | create_index_stmt
+        | create_materialized_view_stmt
         | create_resource_group_stmt
         | create_role_stmt
         | create_srs_stmt
@@ -2408,6 +2419,7 @@ simple_statement:
         | drop_event_stmt               { $$= nullptr; }
         | drop_function_stmt            { $$= nullptr; }
         | drop_index_stmt
+        | drop_materialized_view_stmt
         | drop_logfile_stmt             { $$= nullptr; }
         | drop_procedure_stmt           { $$= nullptr; }
         | drop_resource_group_stmt
@@ -2442,6 +2454,7 @@ simple_statement:
         | preload_stmt
         | prepare                       { $$= nullptr; }
         | purge                         { $$= nullptr; }
+        | refresh_materialized_view_stmt
         | release                       { $$= nullptr; }
         | rename                        { $$= nullptr; }
         | repair_table_stmt
@@ -2517,16 +2530,55 @@ simple_statement:
         | update_stmt
         | use                           { $$= nullptr; }
         | xa                            { $$= nullptr; }
+        | stop_sync_stmt
         | sync_statement /* add sync */
         ;
 
 sync_statement:
           any_sql_stmt SYNC_SYM time_units
           {
-            $$ = new PT_sync_stmt($1, $3);
+            const LEX_CSTRING text= {
+              YYTHD->strmake(@1.cpp.start, @1.cpp.end - @1.cpp.start),
+              static_cast<size_t>(@1.cpp.end - @1.cpp.start)};
+            $$= NEW_PTN PT_sync_stmt($1, $3, text, false);
+          }
+        | any_sql_stmt SYNC_SYM ASYNC_SYM
+          {
+            const LEX_CSTRING text= {
+              YYTHD->strmake(@1.cpp.start, @1.cpp.end - @1.cpp.start),
+              static_cast<size_t>(@1.cpp.end - @1.cpp.start)};
+            $$= NEW_PTN PT_sync_stmt($1, 0, text, true);
+          }
+        | any_sql_stmt SYNC_SYM ASYNC_SYM WINDOW_SYM ident time_units
+          opt_sync_window_step
+          {
+            const LEX_CSTRING text= {
+              YYTHD->strmake(@1.cpp.start, @1.cpp.end - @1.cpp.start),
+              static_cast<size_t>(@1.cpp.end - @1.cpp.start)};
+            Sync_window window;
+            window.column= $5.str;
+            window.size= $6;
+            window.step= $7 == 0 ? $6 : $7;
+            $$= NEW_PTN PT_sync_stmt($1, 0, text, true, window);
+          }
+        | refresh_materialized_view_stmt SYNC_SYM time_units
+          {
+            $$= NEW_PTN PT_sync_stmt($1, $3, NULL_CSTR, false);
           }
         ;
 
+stop_sync_stmt:
+          STOP_SYM SYNC_SYM ulonglong_num
+          {
+            $$= NEW_PTN PT_stop_sync($3);
+          }
+        ;
+
+opt_sync_window_step:
+          /* empty */          { $$ = 0; }
+        | BY time_units        { $$ = $2; }
+        ;
+
 time_units:
           time_unit
           {
@@ -7229,6 +7281,46 @@ field_def:
             }
             $$= NEW_PTN PT_generated_field_def($1, $6, $8, opt_attrs);
           }
+        | VECTOR_SYM '(' ulong_num opt_vector_element_type ')'
+          opt_column_attribute_list
+          {
+            /*
+              VECTOR(N) is a binary BLOB holding N floats, the storage of
+              a FB_VECTOR_DIMENSION=N blob column.
+            */
+            auto *opt_attrs= $6;
+            if (opt_attrs == NULL)
+            {
+              opt_attrs= NEW_PTN
+                Mem_root_array<PT_column_attr_base *>(YYMEM_ROOT);
+            }
+            auto *dimension=
+              make_column_fb_vector_dimension_attribute(YYMEM_ROOT, $3);
+            auto *blob_type= NEW_PTN PT_blob_type(nullptr);
+            if (opt_attrs == nullptr || dimension == nullptr ||
+                blob_type == nullptr || opt_attrs->push_back(dimension))
+              MYSQL_YYABORT; // OOM
+            $$= NEW_PTN PT_field_def(blob_type, opt_attrs);
+          }
+        ;
+
+opt_vector_element_type:
+          /* empty */
+        | ',' ident
+          {
+            if (my_strcasecmp(system_charset_info, $2.str, "FLOAT32") != 0)
+            {
+              my_error(ER_NOT_SUPPORTED_YET, MYF(0),
+                       "VECTOR element types other than FLOAT32");
+              MYSQL_YYABORT;
+            }
+          }
+        | ',' int_type
+          {
+            my_error(ER_NOT_SUPPORTED_YET, MYF(0),
+                     "VECTOR element types other than FLOAT32");
+            MYSQL_YYABORT;
+          }
         ;
 
 opt_generated_always:
@@ -7240,6 +7332,7 @@ opt_stored_attribute:
           /* empty */ { $$= Virtual_or_stored::VIRTUAL; }
         | VIRTUAL_SYM { $$= Virtual_or_stored::VIRTUAL; }
         | STORED_SYM  { $$= Virtual_or_stored::STORED; }
+        | STORED_SYM ASYNC_SYM { $$= Virtual_or_stored::STORED_ASYNC; }
         ;
 
 type:
@@ -7742,6 +7835,11 @@ column_attribute:
           {
             $$ = make_column_fb_vector_dimension_attribute(YYMEM_ROOT, $3);
           }
+        | FB_VECTOR_DIMENSION_SYM opt_equal ulong_num ARRAY_SYM
+          {
+            /* a multi-vector column, one or more vectors of N floats */
+            $$ = make_column_fb_vector_multi_attribute(YYMEM_ROOT, $3);
+          }
         ;
 
 column_format:
@@ -8168,6 +8266,10 @@ common_index_option:
           {
             $$ = make_fb_vector_trained_index_table_attribute(YYMEM_ROOT, to_lex_cstring($3));
           }
+        | FB_VECTOR_INDEX_METRIC_SYM opt_equal TEXT_STRING_sys
+          {
+            $$ = make_fb_vector_index_metric_attribute(YYMEM_ROOT, to_lex_cstring($3));
+          }
         | NEXT_SPATIAL_INDEX_TYPE_SYM opt_equal TEXT_STRING_sys
           {
             $$ = make_next_spatial_index_type_attribute(YYMEM_ROOT, to_lex_cstring($3));
@@ -15054,6 +15156,29 @@ dump_stmt:
           }
         ;
 
+create_materialized_view_stmt:
+          CREATE MATERIALIZED_SYM VIEW_SYM table_ident
+          REFRESH_SYM INCREMENTAL_SYM
+          AS query_expression_with_opt_locking_clauses
+          {
+            $$= NEW_PTN PT_create_materialized_view($4, $8);
+          }
+        ;
+
+refresh_materialized_view_stmt:
+          REFRESH_SYM MATERIALIZED_SYM VIEW_SYM table_ident
+          {
+            $$= NEW_PTN PT_refresh_materialized_view($4);
+          }
+        ;
+
+drop_materialized_view_stmt:
+          DROP MATERIALIZED_SYM VIEW_SYM table_ident
+          {
+            $$= NEW_PTN PT_drop_materialized_view($4);
+          }
+        ;
+
 opt_dump_columns:
   /* empty */
   {
@@ -15117,6 +15242,32 @@ opt_dump_option:
     $$.consistent = true;
   }
 
+  | FORMAT_SYM EQ ident
+  {
+    $$.clear();
+    if (!my_strcasecmp(system_charset_info, $3.str, "csv"))
+      $$.format = Dump_format::CSV;
+    else if (!my_strcasecmp(system_charset_info, $3.str, "parquet"))
+      $$.format = Dump_format::PARQUET;
+    else {
+      my_error(ER_WRONG_ARGUMENTS, MYF(0), "FORMAT");
+      MYSQL_YYABORT;
+    }
+  }
+
+  | COMPRESSION_SYM EQ TEXT_STRING_sys
+  {
+    $$.clear();
+    if (!my_strcasecmp(system_charset_info, $3.str, "none"))
+      $$.compression = Dump_compression::NONE;
+    else if (!my_strcasecmp(system_charset_info, $3.str, "zstd"))
+      $$.compression = Dump_compression::ZSTD;
+    else {
+      my_error(ER_WRONG_ARGUMENTS, MYF(0), "COMPRESSION");
+      MYSQL_YYABORT;
+    }
+  }
+
   ;
 
 chunk_unit_spec:
@@ -15722,6 +15873,7 @@ ident_keywords_ambiguous_2_labels:
         | NO_SYM
         | PRECEDES_SYM
         | PREPARE_SYM
+        | REFRESH_SYM
         | REPAIR
         | RESET_SYM
         | ROLLBACK_SYM
@@ -15785,6 +15937,7 @@ ident_keywords_unambiguous:
         | ALWAYS_SYM
         | ANY_SYM
         | ARRAY_SYM
+        | ASYNC_SYM
         | AT_SYM
         | ATTRIBUTE_SYM
         | ATTACH_SYM
@@ -15916,6 +16069,7 @@ ident_keywords_unambiguous:
         | IDENTIFIED_SYM
         | IGNORE_SERVER_IDS_SYM
         | INACTIVE_SYM
+        | INCREMENTAL_SYM
         | INDEXES
         | INITIAL_SIZE_SYM
         | INITIAL_SYM
@@ -15969,6 +16123,7 @@ ident_keywords_unambiguous:
         | MASTER_TLS_VERSION_SYM
         | MASTER_USER_SYM
         | MASTER_ZSTD_COMPRESSION_LEVEL_SYM
+        | MATERIALIZED_SYM
         | MAX_CONNECTIONS_PER_HOUR
         | MAX_QUERIES_PER_HOUR
         | MAX_ROWS
@@ -16206,6 +16361,7 @@ ident_keywords_unambiguous:
         | VALUE_SYM
         | VARIABLES
         | VCPU_SYM
+        | VECTOR_SYM
         | VIEW_SYM
         | VISIBLE_SYM
         | WAIT_SYM
@@ -94,20 +94,27 @@
 #include "sql/auth/auth_acls.h"
 #include "sql/auth/auth_common.h"  // validate_user_plugins
 #include "sql/binlog.h"            // mysql_bin_log
+#include "sql/binlog/compression_dictionary.h"
+#include "sql/binlog/event_cache.h"
+#include "sql/change_stream.h"  // change_stream_max_rows
 #include "sql/changestreams/apply/replication_thread_status.h"
 #include "sql/clone_handler.h"
 #include "sql/column_statistics.h"
 #include "sql/conn_handler/connection_handler_impl.h"  // Per_thread_connection_handler
 #include "sql/conn_handler/connection_handler_manager.h"  // Connection_handler_manager
 #include "sql/conn_handler/socket_connection.h"  // MY_BIND_ALL_ADDRESSES
+#include "sql/continuous_query.h"             // continuous_query_threads
 #include "sql/derror.h"                          // read_texts
 #include "sql/discrete_interval.h"
 #include "sql/events.h"             // Events
 #include "sql/failure_injection.h"  // Failure injection framework
+#include "sql/histograms/histogram_refresher.h"  // opt_histogram_auto_refresh
 #include "sql/hostname_cache.h"     // host_cache_resize
 #include "sql/index_statistics.h"
 #include "sql/log.h"
 #include "sql/log_event.h"  // MAX_MAX_ALLOWED_PACKET
+#include "sql/malloc_arena.h"
+#include "sql/materialized_view.h"  // materialized_view_max_delta_rows
 #include "sql/mdl.h"
 #include "sql/my_decimal.h"
 #include "sql/opt_trace_context.h"
@@ -115,6 +122,9 @@
 #include "sql/protocol_classic.h"
 #include "sql/psi_memory_key.h"
 #include "sql/query_options.h"
+#include "sql/query_result_cache.h"  // query_result_cache_size
+#include "sql/query_tag_perf_counter.h"  // qutils::query_sample_frequency
+#include "sql/rpl_applier_reader.h"  // opt_replica_decode_threads
 #include "sql/rpl_binlog_sender.h"
 #include "sql/rpl_group_replication.h"  // is_group_replication_running
 #include "sql/rpl_handler.h"            // delegates_update_lock_type
@@ -127,6 +137,9 @@
 #include "sql/rpl_replica.h"            // SLAVE_THD_TYPE
 #include "sql/rpl_rli.h"                // Relay_log_info
 #include "sql/rpl_write_set_handler.h"  // transaction_write_set_hashing_algorithms
+#include "sql/semantic_backend.h"         // semantic_filter_model
+#include "sql/semantic_cache.h"           // semantic_cache_size
+#include "sql/semantic_materializer.h"    // semantic_materialize_threads
 #include "sql/server_component/log_builtins_filter_imp.h"  // until we have pluggable variables
 #include "sql/server_component/log_builtins_imp.h"
 #include "sql/session_tracker.h"
@@ -1303,6 +1316,27 @@ static Sys_var_ulong Sys_binlog_group_commit_sync_no_delay_count(
     CMD_LINE(REQUIRED_ARG), VALID_RANGE(0, 100000 /* max connections */),
     DEFAULT(0), BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG);
 
+static Sys_var_bool Sys_binlog_group_commit_sync_delay_adaptive(
+    "binlog_group_commit_sync_delay_adaptive",
+    "Choose the delay of the binary log group commit sync queue from the "
+    "rate transactions commit at and the time the binary log takes to sync, "
+    "so that a transaction waits at most "
+    "binlog_group_commit_target_latency microseconds for the delay and the "
+    "sync together. binlog_group_commit_sync_delay, if set, is then the "
+    "longest delay.",
+    GLOBAL_VAR(opt_binlog_group_commit_sync_delay_adaptive), CMD_LINE(OPT_ARG),
+    DEFAULT(false), NO_MUTEX_GUARD, NOT_IN_BINLOG);
+
+static Sys_var_long Sys_binlog_group_commit_target_latency(
+    "binlog_group_commit_target_latency",
+    "The number of microseconds a transaction may wait for the binary log "
+    "group commit sync queue to fill and the binary log to sync, with "
+    "binlog_group_commit_sync_delay_adaptive. Default: 0. Min: 0. "
+    "Max: 1000000.",
+    GLOBAL_VAR(opt_binlog_group_commit_target_latency), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(0, 1000000 /* max 1 sec */), DEFAULT(0), BLOCK_SIZE(1),
+    NO_MUTEX_GUARD, NOT_IN_BINLOG);
+
 static Sys_var_ulonglong Sys_binlog_rows_event_max_rows(
     "binlog_rows_event_max_rows", "Max number of rows in a single rows event",
     GLOBAL_VAR(opt_binlog_rows_event_max_rows), CMD_LINE(OPT_ARG),
@@ -1620,6 +1654,18 @@ static Sys_var_uint Sys_binlog_transaction_compression_level_zstd(
     BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG,
     ON_CHECK(check_binlog_trx_compression), ON_UPDATE(nullptr));
 
+static Sys_var_bool Sys_binlog_trx_compression_dictionary(
+    "binlog_transaction_compression_dictionary",
+    "Whether ZSTD transaction payloads are compressed with a dictionary "
+    "trained on the payloads of the binary log. A new dictionary is used "
+    "from the first binary log file opened once it is trained, and is "
+    "written at the head of each file using it, where replicas and "
+    "mysqlbinlog read it. Payloads compressed with a dictionary are "
+    "compressed with the level it was trained for.",
+    GLOBAL_VAR(opt_binlog_trx_compression_dictionary), CMD_LINE(OPT_ARG),
+    DEFAULT(false), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(nullptr),
+    ON_UPDATE(nullptr));
+
 static bool on_session_track_gtids_update(sys_var *, THD *thd, enum_var_type) {
   thd->session_tracker.get_tracker(SESSION_GTIDS_TRACKER)->update(thd);
   return false;
@@ -1918,6 +1964,22 @@ static Sys_var_ulong Sys_load_data_infile_bbuffer_size(
     CMD_LINE(OPT_ARG), VALID_RANGE(0, INT_MAX32), DEFAULT(0), BLOCK_SIZE(1),
     NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(check_session_admin_no_super));
 
+static Sys_var_uint Sys_load_data_bulk_threads(
+    "load_data_bulk_threads",
+    "Number of threads that parse and write the chunks of the input of "
+    "LOAD DATA ... ALGORITHM = BULK",
+    HINT_UPDATEABLE SESSION_VAR(load_data_bulk_threads), CMD_LINE(OPT_ARG),
+    VALID_RANGE(1, 256), DEFAULT(4), BLOCK_SIZE(1));
+
+static Sys_var_ulonglong Sys_load_data_bulk_chunk_size(
+    "load_data_bulk_chunk_size",
+    "Size in bytes of the chunks the input of LOAD DATA ... ALGORITHM = BULK "
+    "is split into at line boundaries, each loaded in a transaction of its "
+    "own",
+    HINT_UPDATEABLE SESSION_VAR(load_data_bulk_chunk_size), CMD_LINE(OPT_ARG),
+    VALID_RANGE(1024 * 1024, ULLONG_MAX), DEFAULT(64 * 1024 * 1024),
+    BLOCK_SIZE(1024));
+
 static bool check_not_null(sys_var *, THD *, set_var *var) {
   return var->value && var->value->is_null();
 }
@@ -1936,7 +1998,8 @@ static bool update_histogram_step_size_for_commit(
 static Sys_var_charptr Sys_histogram_step_size_binlog_commit_time(
     "histogram_step_size_binlog_commit_time",
     "Step size of the Histogram which "
-    "is used to track binlog group/engine commit latencies.",
+    "is used to track binlog group commit, group commit stage and engine "
+    "prepare/commit latencies.",
     GLOBAL_VAR(opt_histogram_binlog_commit_time_step_size), CMD_LINE(OPT_ARG),
     IN_FS_CHARSET, DEFAULT("125us"), NO_MUTEX_GUARD, NOT_IN_BINLOG,
     ON_CHECK(check_histogram_step_size_syntax),
@@ -3374,6 +3437,30 @@ static Sys_var_ulong Sys_admission_control_errors_size(
     VALID_RANGE(128, 1048576), DEFAULT(128), BLOCK_SIZE(1), NO_MUTEX_GUARD,
     NOT_IN_BINLOG, ON_CHECK(check_admission_control_errors_size));
 
+static Sys_var_ulong Sys_admission_control_waits_size(
+    "admission_control_waits_size",
+    "Size of the preallocated flight recorder of queries that waited for "
+    "admission, per entity",
+    GLOBAL_VAR(admission_control_waits_size), CMD_LINE(OPT_ARG),
+    VALID_RANGE(128, 1048576), DEFAULT(256), BLOCK_SIZE(1), NO_MUTEX_GUARD,
+    NOT_IN_BINLOG, ON_CHECK(check_admission_control_errors_size));
+
+static Sys_var_ulong Sys_admission_control_semantic_rate(
+    "admission_control_semantic_rate",
+    "Requests per second the semantic operators may send to their models, "
+    "server wide. Requests over the rate wait for their turn. "
+    "0 means no limit.",
+    GLOBAL_VAR(admission_control_semantic_rate), CMD_LINE(OPT_ARG),
+    VALID_RANGE(0, ULONG_MAX), DEFAULT(0), BLOCK_SIZE(1));
+
+static Sys_var_ulong Sys_admission_control_semantic_entity_rate(
+    "admission_control_semantic_entity_rate",
+    "Requests per second the semantic operators may send to their models "
+    "for each admission control entity. Requests over the rate wait for "
+    "their turn. 0 means no limit.",
+    GLOBAL_VAR(admission_control_semantic_entity_rate), CMD_LINE(OPT_ARG),
+    VALID_RANGE(0, ULONG_MAX), DEFAULT(0), BLOCK_SIZE(1));
+
 static bool check_admission_control_low_pri_sql_ids(sys_var *, THD *,
                                                     set_var *var) {
   return db_ac->update_queue_low_pri_sql_ids(var->save_result.string_value.str);
@@ -3566,6 +3653,16 @@ static Sys_var_ulong Sys_max_write_lock_count(
     GLOBAL_VAR(max_write_lock_count), CMD_LINE(REQUIRED_ARG),
     VALID_RANGE(1, ULONG_MAX), DEFAULT(ULONG_MAX), BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_metadata_locks_max_sharded(
+    "metadata_locks_max_sharded",
+    "Maximum number of contended table metadata locks which get per-cpu "
+    "counters for shared read locks, so that concurrent readers of a hot "
+    "table don't serialize on a single counter. Such locks are not seen "
+    "by high priority DDL killing conflicting connections, which waits "
+    "for them instead. 0 disables them",
+    GLOBAL_VAR(mdl_max_sharded_locks), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(0, 65536), DEFAULT(0), BLOCK_SIZE(1));
+
 static Sys_var_ulong Sys_min_examined_row_limit(
     "min_examined_row_limit",
     "Don't write queries to slow log that examine fewer rows "
@@ -3580,6 +3677,29 @@ static Sys_var_ulong Sys_min_examined_row_limit_sql_stats(
     SESSION_VAR(min_examined_row_limit_sql_stats), CMD_LINE(OPT_ARG),
     VALID_RANGE(0, ULONG_MAX), DEFAULT(0), BLOCK_SIZE(1));
 
+static bool update_query_sample_frequency(sys_var *, THD *, enum_var_type) {
+  qutils::reset_query_sample_profile();
+  return false;
+}
+
+static Sys_var_uint Sys_query_sample_frequency(
+    "query_sample_frequency",
+    "Stack samples taken per second of cpu time of statements, aggregated "
+    "per statement digest in INFORMATION_SCHEMA.QUERY_SAMPLE_PROFILE. "
+    "Changing it starts a new profile. 0 turns sampling off.",
+    GLOBAL_VAR(qutils::query_sample_frequency), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(0, 1000), DEFAULT(0), BLOCK_SIZE(1), NO_MUTEX_GUARD,
+    NOT_IN_BINLOG, ON_CHECK(nullptr),
+    ON_UPDATE(update_query_sample_frequency));
+
+static Sys_var_uint Sys_query_sample_max_stacks(
+    "query_sample_max_stacks",
+    "Maximum number of distinct (digest, stack) pairs kept in "
+    "INFORMATION_SCHEMA.QUERY_SAMPLE_PROFILE, samples of other stacks "
+    "are counted as dropped.",
+    GLOBAL_VAR(qutils::query_sample_max_stacks), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(1, UINT_MAX), DEFAULT(10000), BLOCK_SIZE(1));
+
 #ifdef _WIN32
 static Sys_var_bool Sys_named_pipe("named_pipe", "Enable the named pipe (NT)",
                                    READ_ONLY NON_PERSIST
@@ -3885,6 +4005,16 @@ static Sys_var_ulonglong Sys_histogram_generation_max_mem_size(
     NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(check_session_admin),
     ON_UPDATE(nullptr));
 
+static Sys_var_bool Sys_histogram_auto_refresh(
+    "histogram_auto_refresh",
+    "Build the histograms of a table again in the background once the "
+    "storage engine finds enough of its rows changed, with the number of "
+    "buckets they were built with. The refresh is local: it is not written "
+    "to the binary log, and it is skipped while a replication channel is "
+    "running, so replicas keep the histograms of ANALYZE TABLE.",
+    GLOBAL_VAR(opt_histogram_auto_refresh), CMD_LINE(OPT_ARG), DEFAULT(false),
+    NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(nullptr), ON_UPDATE(nullptr));
+
 static Sys_var_charptr Sys_histogram_step_size_binlog_fsync(
     "histogram_step_size_binlog_fsync",
     "Step size of the Histogram which "
@@ -3902,7 +4032,7 @@ static bool update_binlog_group_commit_step(sys_var * /*self*/, THD * /*thd*/,
 static Sys_var_uint Sys_histogram_step_size_binlog_group_commit(
     "histogram_step_size_binlog_group_commit",
     "Step size of the histogram used in tracking number of threads "
-    "involved in the binlog group commit",
+    "involved in the binlog group commit, and in each of its stages",
     GLOBAL_VAR(opt_histogram_step_size_binlog_group_commit),
     CMD_LINE(REQUIRED_ARG), VALID_RANGE(1, 1024), DEFAULT(1), BLOCK_SIZE(1),
     NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
@@ -4643,14 +4773,44 @@ static Sys_var_ulong Sys_trans_prealloc_size(
     ON_UPDATE(nullptr), DEPRECATED_VAR(""));
 
 static const char *thread_handling_names[] = {
-    "one-thread-per-connection", "no-threads", "loaded-dynamically", nullptr};
+    "one-thread-per-connection", "no-threads", "thread-pool",
+    "loaded-dynamically", nullptr};
 static Sys_var_enum Sys_thread_handling(
     "thread_handling",
     "Define threads usage for handling queries, one of "
-    "one-thread-per-connection, no-threads, loaded-dynamically",
+    "one-thread-per-connection, no-threads, thread-pool, loaded-dynamically",
     READ_ONLY GLOBAL_VAR(Connection_handler_manager::thread_handling),
     CMD_LINE(REQUIRED_ARG), thread_handling_names, DEFAULT(0));
 
+static Sys_var_uint Sys_thread_pool_size(
+    "thread_pool_size",
+    "The groups of workers connections are spread over with "
+    "thread_handling=thread-pool",
+    READ_ONLY GLOBAL_VAR(Thread_pool_connection_handler::group_count),
+    CMD_LINE(REQUIRED_ARG), VALID_RANGE(1, 1024), DEFAULT(16), BLOCK_SIZE(1));
+
+static Sys_var_uint Sys_thread_pool_oversubscribe(
+    "thread_pool_oversubscribe",
+    "The commands a group of the thread pool runs at once besides the first "
+    "one",
+    GLOBAL_VAR(Thread_pool_connection_handler::oversubscribe),
+    CMD_LINE(REQUIRED_ARG), VALID_RANGE(0, 1000), DEFAULT(3), BLOCK_SIZE(1));
+
+static Sys_var_uint Sys_thread_pool_stall_limit(
+    "thread_pool_stall_limit",
+    "Milliseconds a group of the thread pool may not take a command before "
+    "it runs one more at once",
+    GLOBAL_VAR(Thread_pool_connection_handler::stall_limit),
+    CMD_LINE(REQUIRED_ARG), VALID_RANGE(10, 60000), DEFAULT(500),
+    BLOCK_SIZE(1));
+
+static Sys_var_uint Sys_thread_pool_max_threads(
+    "thread_pool_max_threads",
+    "The most workers of a group of the thread pool",
+    GLOBAL_VAR(Thread_pool_connection_handler::max_threads_per_group),
+    CMD_LINE(REQUIRED_ARG), VALID_RANGE(1, 65536), DEFAULT(1000),
+    BLOCK_SIZE(1));
+
 static bool check_allow_noncurrent_db_rw(sys_var * /* self */, THD *thd,
                                          set_var *var) {
   // allow_noncurrent_db_rw != OFF is only safe under the current implementation
@@ -5629,6 +5789,23 @@ static Sys_var_long Sys_zstd_net_compression_level(
     GLOBAL_VAR(zstd_net_compression_level), CMD_LINE(OPT_ARG),
     VALID_RANGE(LONG_MIN, 22), DEFAULT(ZSTD_CLEVEL_DEFAULT), BLOCK_SIZE(1));
 
+static Sys_var_uint Sys_zstd_net_window_log(
+    "zstd_net_window_log",
+    "Log2 of the window of the compressed protocol when zstd_stream is"
+    " selected, for the packets of a result set to refer to the ones before"
+    " them. 0 leaves it to the compression level. Clients accept up to 27."
+    " Applies to the connections compressing afterwards.",
+    GLOBAL_VAR(zstd_net_window_log), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(0, 27), DEFAULT(0), BLOCK_SIZE(1));
+
+static Sys_var_double Sys_zstd_net_max_entropy(
+    "zstd_net_max_entropy",
+    "Entropy, in bits per byte, of a packet above which zstd_stream sends it"
+    " uncompressed rather than starting a stream on it. Streams starting on"
+    " a packet above 6 use level 1. 8 compresses every packet.",
+    GLOBAL_VAR(zstd_net_max_entropy), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(0, 8), DEFAULT(7.9));
+
 static Sys_var_ulong Sys_sort_buffer(
     "sort_buffer_size",
     "Each thread that needs to do a sort allocates a buffer of this size",
@@ -6378,6 +6555,24 @@ static Sys_var_bool Sys_big_tables(
     "temporary sets on file (Solves most 'table full' errors)",
     HINT_UPDATEABLE SESSION_VAR(big_tables), CMD_LINE(OPT_ARG), DEFAULT(false));
 
+static Sys_var_bool Sys_large_page_query_buffers(
+    "large_page_query_buffers",
+    "Back the hash join and sort buffers of queries with transparent huge "
+    "pages, where a buffer spans any. Their memory is still accounted in "
+    "performance_schema.memory_summary_* under memory/sql/hash_join and "
+    "memory/sql/Filesort_buffer::sort_keys",
+    HINT_UPDATEABLE SESSION_VAR(large_page_query_buffers), CMD_LINE(OPT_ARG),
+    DEFAULT(false));
+
+static Sys_var_bool Sys_hash_join_runtime_filter(
+    "hash_join_runtime_filter",
+    "Give the scan of the probe input of an inner or semi hash join, when it "
+    "reads a single table, a bloom filter over the join keys of the build "
+    "input, so that storage engines supporting it drop the rows that cannot "
+    "match before decoding them",
+    HINT_UPDATEABLE SESSION_VAR(hash_join_runtime_filter), CMD_LINE(OPT_ARG),
+    DEFAULT(true));
+
 static Sys_var_bit Sys_big_selects("sql_big_selects", "sql_big_selects",
                                    HINT_UPDATEABLE SESSION_VAR(option_bits),
                                    NO_CMD_LINE, OPTION_BIG_SELECTS,
@@ -7404,6 +7599,17 @@ static Sys_var_uint Sys_rpl_send_buffer_size(
     GLOBAL_VAR(rpl_send_buffer_size), CMD_LINE(REQUIRED_ARG),
     VALID_RANGE(1024, UINT_MAX), DEFAULT(2 * 1024 * 1024), BLOCK_SIZE(1024));
 
+static Sys_var_ulonglong Sys_binlog_event_cache_size(
+    "binlog_event_cache_size",
+    "The size of the ring the last events written to the active binary log "
+    "file are kept in for the dump threads, which send the events in it "
+    "from memory rather than each reading them from the file. Dump threads "
+    "further behind read the file. Encrypted binary log files are not "
+    "cached. 0 disables the cache.",
+    READ_ONLY GLOBAL_VAR(opt_binlog_event_cache_size), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(0, 1024ULL * 1024 * 1024 * 1024), DEFAULT(0),
+    BLOCK_SIZE(1024));
+
 static Sys_var_deprecated_alias Sys_slave_checkpoint_group(
     "slave_checkpoint_group", Sys_replica_checkpoint_group);
 
@@ -7465,6 +7671,15 @@ static Sys_var_ulong Sys_replica_parallel_workers(
 static Sys_var_deprecated_alias Sys_slave_parallel_workers(
     "slave_parallel_workers", Sys_replica_parallel_workers);
 
+static Sys_var_uint Sys_replica_decode_threads(
+    "replica_decode_threads",
+    "Number of threads decoding the events of the relay log, and verifying "
+    "their checksums, ahead of the coordinator of a multi-threaded applier, "
+    "which then only reads and schedules them. 0 has the coordinator decode "
+    "them. Takes effect when the applier starts.",
+    GLOBAL_VAR(opt_replica_decode_threads), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(0, 64), DEFAULT(0), BLOCK_SIZE(1));
+
 static Sys_var_bool Sys_mts_dynamic_rebalance(
     "mts_dynamic_rebalance",
     "Shuffle DB's within workers periodically for load balancing",
@@ -8231,7 +8446,8 @@ static bool check_binlog_row_value_options(sys_var *self, THD *thd,
       else if (log_bin_use_v1_row_events) {
         msg = "binlog_row_value_options=PARTIAL_JSON";
         code = ER_WARN_BINLOG_V1_ROW_EVENTS_DISABLED;
-      } else if (thd->variables.binlog_row_image == BINLOG_ROW_IMAGE_FULL) {
+      } else if ((var->save_result.ulonglong_value & PARTIAL_JSON_UPDATES) &&
+                 thd->variables.binlog_row_image == BINLOG_ROW_IMAGE_FULL) {
         msg = "binlog_row_image=FULL";
         code = ER_WARN_BINLOG_PARTIAL_UPDATES_SUGGESTS_PARTIAL_IMAGES;
       }
@@ -8241,8 +8457,9 @@ static bool check_binlog_row_value_options(sys_var *self, THD *thd,
       else if (log_bin_use_v1_row_events) {
         msg = "binlog_row_value_options=PARTIAL_JSON";
         code = ER_WARN_BINLOG_V1_ROW_EVENTS_DISABLED;
-      } else if (global_system_variables.binlog_row_image ==
-                 BINLOG_ROW_IMAGE_FULL) {
+      } else if ((var->save_result.ulonglong_value & PARTIAL_JSON_UPDATES) &&
+                 global_system_variables.binlog_row_image ==
+                     BINLOG_ROW_IMAGE_FULL) {
         msg = "binlog_row_image=FULL";
         code = ER_WARN_BINLOG_PARTIAL_UPDATES_SUGGESTS_PARTIAL_IMAGES;
       }
@@ -8276,7 +8493,8 @@ static bool check_binlog_row_value_options(sys_var *self, THD *thd,
   return false;
 }
 
-const char *binlog_row_value_options_names[] = {"PARTIAL_JSON", nullptr};
+const char *binlog_row_value_options_names[] = {"PARTIAL_JSON",
+                                                "PACKED_VECTOR", nullptr};
 static Sys_var_set Sys_binlog_row_value_options(
     "binlog_row_value_options",
     "When set to PARTIAL_JSON, this option enables a space-efficient "
@@ -8284,7 +8502,11 @@ static Sys_var_set Sys_binlog_row_value_options(
     "JSON value using only the functions JSON_SET, JSON_REPLACE, and "
     "JSON_REMOVE. For such updates, only the modified parts of the "
     "JSON document are included in the binary log, so small changes of "
-    "big documents may need significantly less space.",
+    "big documents may need significantly less space. When set to "
+    "PACKED_VECTOR, JSON vector columns whose elements are all floats are "
+    "stored as 4-byte floats in all row images, which replicas and "
+    "mysqlbinlog read back as the same document; replicas must support "
+    "it before it is set.",
     SESSION_VAR(binlog_row_value_options), CMD_LINE(REQUIRED_ARG),
     binlog_row_value_options_names, DEFAULT(0), NO_MUTEX_GUARD, NOT_IN_BINLOG,
     ON_CHECK(check_binlog_row_value_options));
@@ -8924,6 +9146,35 @@ static Sys_var_enum Sys_enable_jemalloc_hpp(
     DEFAULT(JEMALLOC_OFF), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(nullptr),
     ON_UPDATE(enable_jemalloc_heap_profiling));
 
+static bool update_malloc_arenas(sys_var *, THD *, enum_var_type) {
+  return malloc_arenas_update();
+}
+
+static Sys_var_bool Sys_malloc_subsystem_arenas(
+    "malloc_subsystem_arenas",
+    "Allocate for hash joins, vector searches and model calls from jemalloc "
+    "arenas of their own, so that the pages they free do not fragment the "
+    "memory of the rest of the server. Default: OFF",
+    GLOBAL_VAR(malloc_subsystem_arenas), CMD_LINE(OPT_ARG), DEFAULT(false),
+    NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(nullptr),
+    ON_UPDATE(update_malloc_arenas));
+
+static Sys_var_long Sys_malloc_arena_dirty_decay_ms(
+    "malloc_arena_dirty_decay_ms",
+    "Milliseconds before the unused dirty pages of the subsystem arenas are "
+    "purged, -1 to never purge them. Default: 10000",
+    GLOBAL_VAR(malloc_arena_dirty_decay_ms), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(-1, LONG_MAX), DEFAULT(10000), BLOCK_SIZE(1), NO_MUTEX_GUARD,
+    NOT_IN_BINLOG, ON_CHECK(nullptr), ON_UPDATE(update_malloc_arenas));
+
+static Sys_var_long Sys_malloc_arena_muzzy_decay_ms(
+    "malloc_arena_muzzy_decay_ms",
+    "Milliseconds before the unused muzzy pages of the subsystem arenas are "
+    "returned to the system, -1 to never return them. Default: 0",
+    GLOBAL_VAR(malloc_arena_muzzy_decay_ms), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(-1, LONG_MAX), DEFAULT(0), BLOCK_SIZE(1), NO_MUTEX_GUARD,
+    NOT_IN_BINLOG, ON_CHECK(nullptr), ON_UPDATE(update_malloc_arenas));
+
 #endif
 
 static Sys_var_bool Sys_improved_dup_key_error(
@@ -9878,6 +10129,17 @@ static Sys_var_uint Sys_write_throttle_rate_step(
     VALID_RANGE(0, 100), DEFAULT(100), BLOCK_SIZE(1), NO_MUTEX_GUARD,
     NOT_IN_BINLOG, ON_CHECK(nullptr), ON_UPDATE(nullptr));
 
+static Sys_var_bool Sys_write_throttle_shard_lag(
+    "write_throttle_shard_lag",
+    "On a replica, report the replication lag of the shards lagging the most "
+    "to the primary, from the source time of the last event applied on each "
+    "shard, which shardbeats keep recent on silent shards. On a primary, "
+    "auto throttle only the writes of the shards lagging by more than "
+    "write_start_throttle_lag_milliseconds, at a rate proportional to their "
+    "lag, until it falls below write_stop_throttle_lag_milliseconds.",
+    GLOBAL_VAR(write_throttle_shard_lag), CMD_LINE(OPT_ARG), DEFAULT(false),
+    NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(nullptr), ON_UPDATE(nullptr));
+
 static Sys_var_charptr Sys_sql_wsenv_tenant(
     "sql_wsenv_tenant", "warm storage environment tenant",
     READ_ONLY NON_PERSIST GLOBAL_VAR(sql_wsenv_tenant), CMD_LINE(REQUIRED_ARG),
@@ -10462,12 +10724,37 @@ static Sys_var_uint Sys_fb_vector_search_nprobe(
     HINT_UPDATEABLE SESSION_VAR(fb_vector_search_nprobe), CMD_LINE(OPT_ARG),
     VALID_RANGE(1, 10000), DEFAULT(16), BLOCK_SIZE(1));
 
+static Sys_var_uint Sys_fb_vector_search_threads(
+    "fb_vector_search_threads",
+    "Maximum number of threads a single vector search may use. "
+    "Candidates read from the nprobe closest lists are split across "
+    "this many workers, each keeping its own top k, and the results are "
+    "merged at the end. The storage engine caps it to the number of cores. "
+    "This session default can be superceded by a query level override: "
+    "'SELECT /*+ SET_VAR(fb_vector_search_threads = 8) */ ... '. Default: 1",
+    HINT_UPDATEABLE SESSION_VAR(fb_vector_search_threads), CMD_LINE(OPT_ARG),
+    VALID_RANGE(1, 256), DEFAULT(1), BLOCK_SIZE(1));
+
+static Sys_var_uint Sys_fb_vector_search_target_candidates(
+    "fb_vector_search_target_candidates",
+    "When non zero, ivf vector indexes ignore fb_vector_search_nprobe and "
+    "probe the closest lists in centroid distance order until the list "
+    "sizes tracked by the index add up to this many candidates. This keeps "
+    "the work per query stable when list sizes are skewed. "
+    "This session default can be superceded by a query level override: "
+    "'SELECT /*+ SET_VAR(fb_vector_search_target_candidates = 5000) */ ... '. "
+    "Default: 0",
+    HINT_UPDATEABLE SESSION_VAR(fb_vector_search_target_candidates),
+    CMD_LINE(OPT_ARG), VALID_RANGE(0, 100000000), DEFAULT(0), BLOCK_SIZE(1));
+
 static Sys_var_uint Sys_fb_vector_index_cost_factor(
     "fb_vector_index_cost_factor",
     "A table scan plus filesort will be prohibitively expensive "
     "for vector searches. This sysvar parameterizes the preference for "
     "the vector index, reduces the vector index cost by this factor, thereby "
     "making the optimizer prefer the vector index for vector search. "
+    "Only used when the storage engine cannot estimate the cost of a "
+    "vector index scan from its index statistics. "
     "Default: 1000",
     SESSION_VAR(fb_vector_index_cost_factor), CMD_LINE(OPT_ARG),
     VALID_RANGE(1, 100000), DEFAULT(1000), BLOCK_SIZE(1),
@@ -10478,12 +10765,29 @@ static Sys_var_uint Sys_fb_vector_search_limit_multiplier(
     "This parameter indicates to the storage engine the filtering effect "
     "of a SQL query due to WHERE and HAVING clauses. This is used to "
     "fetch more nearest neighbours from FAISS so that the LIMIT can still "
-    "be satisfied. This applies to all vector index types."
+    "be satisfied. This applies to all vector index types. "
+    "0 chooses the multiplier per query from the estimated selectivity of "
+    "the WHERE clause on the table, which histograms on its columns, "
+    "including generated columns extracting JSON paths, refine. "
     "This session default can be superceded by a query level override: "
     "'SELECT /*+ SET_VAR(fb_vector_search_limit_multiplier = 3) */ ... '. "
     "Default: 10",
     HINT_UPDATEABLE SESSION_VAR(fb_vector_search_limit_multiplier), CMD_LINE(OPT_ARG),
-    VALID_RANGE(1, 1000), DEFAULT(10), BLOCK_SIZE(1));
+    VALID_RANGE(0, 1000), DEFAULT(10), BLOCK_SIZE(1));
+
+static Sys_var_ulonglong Sys_fb_vector_search_memory_limit(
+    "fb_vector_search_memory_limit",
+    "The most memory in bytes the results of a vector or spatial index "
+    "search may hold for one statement. A KNN search whose LIMIT, times "
+    "fb_vector_search_limit_multiplier, would exceed it is planned as an "
+    "index scan followed by a sort instead, re-rank candidates of quantized "
+    "indexes are cut down to fit it, and spatial range searches read "
+    "smaller batches. 0 means no limit. The result buffers count against "
+    "the connection memory of the session. "
+    "Default: 268435456",
+    HINT_UPDATEABLE SESSION_VAR(fb_vector_search_memory_limit),
+    CMD_LINE(OPT_ARG), VALID_RANGE(0, ULLONG_MAX), DEFAULT(256 * 1024 * 1024),
+    BLOCK_SIZE(1));
 
 static Sys_var_bool Sys_fb_vector_index_cond_pushdown(
     "fb_vector_index_cond_pushdown",
@@ -10513,6 +10817,244 @@ static Sys_var_enum Sys_fb_vector_search_type(
     fb_vector_search_type_names, DEFAULT(FB_VECTOR_SEARCH_NO_PREF),
     NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(nullptr), ON_UPDATE(nullptr));
 
+static Sys_var_uint Sys_semantic_filter_batch_size(
+    "semantic_filter_batch_size",
+    "Number of rows a filter holding SEMANTIC_FILTER functions reads ahead "
+    "before asking the model about them. The prompts of a batch are sent "
+    "concurrently, and the rows are then returned in their original order. "
+    "1 sends one prompt per row as it is read. "
+    "This session default can be superceded by a query level override: "
+    "'SELECT /*+ SET_VAR(semantic_filter_batch_size = 64) */ ... '. "
+    "Default: 32",
+    HINT_UPDATEABLE SESSION_VAR(semantic_filter_batch_size), CMD_LINE(OPT_ARG),
+    VALID_RANGE(1, 4096), DEFAULT(32), BLOCK_SIZE(1));
+
+static Sys_var_uint Sys_semantic_filter_concurrency(
+    "semantic_filter_concurrency",
+    "Maximum number of SEMANTIC_FILTER requests of a batch in flight at the "
+    "same time. "
+    "This session default can be superceded by a query level override: "
+    "'SELECT /*+ SET_VAR(semantic_filter_concurrency = 16) */ ... '. "
+    "Default: 8",
+    HINT_UPDATEABLE SESSION_VAR(semantic_filter_concurrency), CMD_LINE(OPT_ARG),
+    VALID_RANGE(1, 256), DEFAULT(8), BLOCK_SIZE(1));
+
+static Sys_var_uint Sys_semantic_filter_read_ahead(
+    "semantic_filter_read_ahead",
+    "Number of batches of semantic_filter_batch_size rows a filter holding "
+    "SEMANTIC_FILTER functions reads ahead while the model answers the "
+    "batches before them, so that scanning the table overlaps waiting for "
+    "the model. The prompts of each batch are sent from a thread of its "
+    "own. 0 reads the next batch only once the rows of the current one "
+    "have been returned. "
+    "This session default can be superceded by a query level override: "
+    "'SELECT /*+ SET_VAR(semantic_filter_read_ahead = 2) */ ... '. "
+    "Default: 0",
+    HINT_UPDATEABLE SESSION_VAR(semantic_filter_read_ahead),
+    CMD_LINE(OPT_ARG), VALID_RANGE(0, 16), DEFAULT(0), BLOCK_SIZE(1));
+
+static Sys_var_bool Sys_compile_filter_conditions(
+    "compile_filter_conditions",
+    "Evaluate the comparisons, BETWEEN, IN lists and IS [NOT] NULL tests "
+    "on numeric columns of WHERE and HAVING conditions from a compiled "
+    "program that reads the columns from the row buffer, instead of "
+    "walking the expression tree for every row. Default: ON",
+    HINT_UPDATEABLE SESSION_VAR(compile_filter_conditions), CMD_LINE(OPT_ARG),
+    DEFAULT(true));
+
+static Sys_var_bool Sys_semantic_filter_cascade(
+    "semantic_filter_cascade",
+    "Score each row of SEMANTIC_FILTER_SINGLE_COL() and "
+    "SEMANTIC_FILTER_TWO_COL() by the cosine similarity between the "
+    "embeddings of the prompt and of the row first. Rows scoring below "
+    "semantic_filter_cascade_low are rejected and rows scoring above "
+    "semantic_filter_cascade_high accepted without asking the model. "
+    "Only takes effect for constant prompts. Default: OFF",
+    HINT_UPDATEABLE SESSION_VAR(semantic_filter_cascade), CMD_LINE(OPT_ARG),
+    DEFAULT(false));
+
+static Sys_var_double Sys_semantic_filter_cascade_low(
+    "semantic_filter_cascade_low",
+    "Similarity below which semantic_filter_cascade rejects a row. "
+    "Default: 0.2",
+    HINT_UPDATEABLE SESSION_VAR(semantic_filter_cascade_low),
+    CMD_LINE(OPT_ARG), VALID_RANGE(-1, 1), DEFAULT(0.2));
+
+static Sys_var_double Sys_semantic_filter_cascade_high(
+    "semantic_filter_cascade_high",
+    "Similarity above which semantic_filter_cascade accepts a row. "
+    "Default: 0.6",
+    HINT_UPDATEABLE SESSION_VAR(semantic_filter_cascade_high),
+    CMD_LINE(OPT_ARG), VALID_RANGE(-1, 1), DEFAULT(0.6));
+
+static Sys_var_double Sys_semantic_dedup_threshold(
+    "semantic_dedup_threshold",
+    "Embed the inputs of SEMANTIC_MAP() and SEMANTIC_EXTRACT() and ask the "
+    "model once per group of near duplicates, e.g. templated emails or log "
+    "lines: an input whose cosine similarity to an earlier one is at least "
+    "this takes its answer. Only takes effect for constant prompts, and for "
+    "the batches of STORED ASYNC columns. Can be set per query, e.g. "
+    "'SELECT /*+ SET_VAR(semantic_dedup_threshold = 0.95) */ ... '. "
+    "0 disables it. Default: 0",
+    HINT_UPDATEABLE SESSION_VAR(semantic_dedup_threshold),
+    CMD_LINE(OPT_ARG), VALID_RANGE(0, 1), DEFAULT(0));
+
+static Sys_var_uint Sys_semantic_join_neighbors(
+    "semantic_join_neighbors",
+    "Number of nearest neighbours in a vector index each outer row of a "
+    "SEMANTIC_JOIN() with embeddings is paired with. Only those pairs are "
+    "sent to the model, instead of the full cross product. "
+    "This session default can be superceded by a query level override: "
+    "'SELECT /*+ SET_VAR(semantic_join_neighbors = 20) */ ... '. "
+    "Default: 10",
+    HINT_UPDATEABLE SESSION_VAR(semantic_join_neighbors), CMD_LINE(OPT_ARG),
+    VALID_RANGE(1, 1000), DEFAULT(10), BLOCK_SIZE(1));
+
+static Sys_var_ulonglong Sys_query_result_cache_size(
+    "query_result_cache_size",
+    "Bytes of result sets of SELECT statements kept, server wide, to answer "
+    "the same statement again without executing it while the tables it "
+    "read did not change. Least recently used results are dropped first. "
+    "0 turns the cache off. Default: 0",
+    GLOBAL_VAR(query_result_cache_size), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(0, ULLONG_MAX), DEFAULT(0), BLOCK_SIZE(1));
+
+static Sys_var_ulonglong Sys_query_result_cache_limit(
+    "query_result_cache_limit",
+    "Largest result set, in bytes, the query result cache keeps. "
+    "Default: 1M",
+    GLOBAL_VAR(query_result_cache_limit), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(0, ULLONG_MAX), DEFAULT(1024 * 1024), BLOCK_SIZE(1));
+
+static Sys_var_ulonglong Sys_semantic_cache_size(
+    "semantic_cache_size",
+    "Bytes of model responses the semantic operators keep, server wide, to "
+    "answer repeated requests with the same prompt and values without "
+    "calling the model again. Least recently used responses are dropped "
+    "first. 0 turns the cache off. Default: 64M",
+    GLOBAL_VAR(semantic_cache_size), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(0, ULLONG_MAX), DEFAULT(64 * 1024 * 1024), BLOCK_SIZE(1));
+
+static Sys_var_uint Sys_semantic_cache_ttl(
+    "semantic_cache_ttl",
+    "Seconds a cached model response is used for before the model is asked "
+    "again. 0 means no limit. Default: 86400",
+    GLOBAL_VAR(semantic_cache_ttl), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(0, UINT_MAX), DEFAULT(86400), BLOCK_SIZE(1));
+
+static Sys_var_charptr Sys_semantic_filter_model(
+    "semantic_filter_model",
+    "Model answering SEMANTIC_FILTER() and SEMANTIC_JOIN(), as "
+    "'<backend>:<model>'. The backends are 'openai' and 'local', an OpenAI "
+    "compatible server at semantic_local_url. Default: openai:gpt-4",
+    GLOBAL_VAR(semantic_filter_model), CMD_LINE(REQUIRED_ARG),
+    IN_SYSTEM_CHARSET, DEFAULT("openai:gpt-4"), NO_MUTEX_GUARD, NOT_IN_BINLOG);
+
+static Sys_var_charptr Sys_semantic_map_model(
+    "semantic_map_model",
+    "Model answering SEMANTIC_MAP(), as '<backend>:<model>'. "
+    "Default: openai:gpt-4",
+    GLOBAL_VAR(semantic_map_model), CMD_LINE(REQUIRED_ARG), IN_SYSTEM_CHARSET,
+    DEFAULT("openai:gpt-4"), NO_MUTEX_GUARD, NOT_IN_BINLOG);
+
+static Sys_var_charptr Sys_semantic_extract_model(
+    "semantic_extract_model",
+    "Model answering SEMANTIC_EXTRACT(), as '<backend>:<model>'. "
+    "Default: openai:gpt-4",
+    GLOBAL_VAR(semantic_extract_model), CMD_LINE(REQUIRED_ARG),
+    IN_SYSTEM_CHARSET, DEFAULT("openai:gpt-4"), NO_MUTEX_GUARD, NOT_IN_BINLOG);
+
+static Sys_var_charptr Sys_semantic_embed_model(
+    "semantic_embed_model",
+    "Model embedding texts for the semantic operators, as "
+    "'<backend>:<model>'. Embeddings stored in tables must come from the "
+    "same model. Default: openai:text-embedding-3-small",
+    GLOBAL_VAR(semantic_embed_model), CMD_LINE(REQUIRED_ARG),
+    IN_SYSTEM_CHARSET, DEFAULT("openai:text-embedding-3-small"),
+    NO_MUTEX_GUARD, NOT_IN_BINLOG);
+
+static Sys_var_charptr Sys_semantic_embed_image_model(
+    "semantic_embed_image_model",
+    "Model embedding images for SEMANTIC_EMBED_IMAGE(), as "
+    "'<backend>:<model>', e.g. a CLIP model served on a GPU next to the "
+    "database by the 'local' backend. Default: local:clip",
+    GLOBAL_VAR(semantic_embed_image_model), CMD_LINE(REQUIRED_ARG),
+    IN_SYSTEM_CHARSET, DEFAULT("local:clip"), NO_MUTEX_GUARD, NOT_IN_BINLOG);
+
+static Sys_var_charptr Sys_semantic_local_url(
+    "semantic_local_url",
+    "Base URL of the OpenAI compatible API of the 'local' semantic backend, "
+    "e.g. a vLLM or llama.cpp server. Default: http://localhost:8000/v1",
+    GLOBAL_VAR(semantic_local_url), CMD_LINE(REQUIRED_ARG), IN_SYSTEM_CHARSET,
+    DEFAULT("http://localhost:8000/v1"), NO_MUTEX_GUARD, NOT_IN_BINLOG);
+
+static Sys_var_charptr Sys_semantic_local_socket(
+    "semantic_local_socket",
+    "Unix socket the 'local' semantic backend is reached over, instead of "
+    "the host and port of semantic_local_url. Empty for tcp. Default: ''",
+    GLOBAL_VAR(semantic_local_socket), CMD_LINE(REQUIRED_ARG), IN_FS_CHARSET,
+    DEFAULT(""), NO_MUTEX_GUARD, NOT_IN_BINLOG);
+
+static Sys_var_uint Sys_semantic_openai_max_requests(
+    "semantic_openai_max_requests",
+    "Most requests to the 'openai' semantic backend in flight at once, "
+    "server wide. 0 means no limit. Default: 0",
+    GLOBAL_VAR(semantic_openai_max_requests), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(0, UINT_MAX), DEFAULT(0), BLOCK_SIZE(1));
+
+static Sys_var_uint Sys_semantic_local_max_requests(
+    "semantic_local_max_requests",
+    "Most requests to the 'local' semantic backend in flight at once, "
+    "server wide, e.g. the batch size the local server serves well. "
+    "0 means no limit. Default: 16",
+    GLOBAL_VAR(semantic_local_max_requests), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(0, UINT_MAX), DEFAULT(16), BLOCK_SIZE(1));
+
+static Sys_var_uint Sys_semantic_materialize_threads(
+    "semantic_materialize_threads",
+    "Number of background threads filling STORED ASYNC generated columns. "
+    "Default: 4",
+    READ_ONLY GLOBAL_VAR(semantic_materialize_threads), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(1, 64), DEFAULT(4), BLOCK_SIZE(1));
+
+static Sys_var_uint Sys_semantic_materialize_batch_size(
+    "semantic_materialize_batch_size",
+    "Most rows a background thread fills at once. The prompts of a batch "
+    "are sent to the model concurrently, up to semantic_filter_concurrency "
+    "at a time. Default: 64",
+    GLOBAL_VAR(semantic_materialize_batch_size), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(1, 100000), DEFAULT(64), BLOCK_SIZE(1));
+
+static Sys_var_ulong Sys_materialized_view_max_delta_rows(
+    "materialized_view_max_delta_rows",
+    "Most changed rows logged for a materialized view between refreshes. A "
+    "view with more is recomputed in full by its next refresh, rather than "
+    "derived again from the changed rows. Default: 100000",
+    GLOBAL_VAR(materialized_view_max_delta_rows), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(1, ULONG_MAX), DEFAULT(100000), BLOCK_SIZE(1));
+
+static Sys_var_ulong Sys_change_stream_max_rows(
+    "change_stream_max_rows",
+    "Most rows of a table a transaction delivers to change stream "
+    "subscribers, such as ASYNC continuous queries. Beyond, they are only "
+    "told that more rows changed. Default: 10000",
+    GLOBAL_VAR(change_stream_max_rows), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(0, ULONG_MAX), DEFAULT(10000), BLOCK_SIZE(1));
+
+static Sys_var_uint Sys_continuous_query_threads(
+    "continuous_query_threads",
+    "Number of background threads running the queries started with SYNC. "
+    "Default: 4",
+    READ_ONLY GLOBAL_VAR(continuous_query_threads), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(1, 256), DEFAULT(4), BLOCK_SIZE(1));
+
+static Sys_var_ulong Sys_continuous_query_history(
+    "continuous_query_history",
+    "Number of the last outputs of each continuous query kept for the "
+    "clients listening to it to resume from. Default: 1000",
+    GLOBAL_VAR(continuous_query_history), CMD_LINE(REQUIRED_ARG),
+    VALID_RANGE(1, 1000000), DEFAULT(1000), BLOCK_SIZE(1));
+
 std::string applied_opid_set;
 static Sys_var_applied_opid_set Sys_applied_opid_set(
     "applied_opid_set", "Force update applied OPID set",
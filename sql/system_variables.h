@@ -32,6 +32,7 @@
 #include "my_sqlcommand.h"
 #include "my_thread_local.h"     // my_thread_id
 #include "sql/rpl_gtid.h"        // Gitd_specification
+#include "sql/semantic_stats.h"    // SEMANTIC_OP_END
 #include "sql/sql_plugin_ref.h"  // plugin_ref
 
 class MY_LOCALE;
@@ -79,7 +80,9 @@ enum enum_binlog_row_image {
 // Bits for binlog_row_value_options sysvar
 enum enum_binlog_row_value_options {
   /// Store JSON updates in partial form
-  PARTIAL_JSON_UPDATES = 1
+  PARTIAL_JSON_UPDATES = 1,
+  /// Store JSON vectors as 4-byte floats when they hold them exactly
+  PACKED_VECTOR_VALUES = 2
 };
 
 // Values for binlog_row_metadata sysvar
@@ -362,6 +365,8 @@ struct System_variables {
 
   bool old_alter_table;
   bool big_tables;
+  bool large_page_query_buffers;
+  bool hash_join_runtime_filter;
 
   plugin_ref table_plugin;
   plugin_ref temp_table_plugin;
@@ -627,6 +632,8 @@ struct System_variables {
   bool clean_parser_memory_per_statement;
 
   ulong load_data_infile_buffer_size;
+  uint load_data_bulk_threads;
+  ulonglong load_data_bulk_chunk_size;
 
   long thread_priority;
 
@@ -672,6 +679,19 @@ struct System_variables {
   */
   uint fb_vector_search_nprobe;
 
+  /**
+    Maximum number of threads a single vector search may use to score
+    the candidates of the probed lists in parallel.
+  */
+  uint fb_vector_search_threads;
+
+  /**
+    When non zero, ivf searches probe lists in centroid distance order
+    until their known sizes add up to this many candidates, instead of
+    probing a fixed fb_vector_search_nprobe lists.
+  */
+  uint fb_vector_search_target_candidates;
+
   /**
     This parameter makes the optimizer prefer the vector index over
     a table scan followed by filesort, by reducing the cost of vector search
@@ -686,6 +706,13 @@ struct System_variables {
   */
   uint fb_vector_search_limit_multiplier;
 
+  /**
+    Bytes the results of a vector or spatial index search may hold for one
+    statement, 0 for no limit. Searches over it degrade instead of failing,
+    e.g. a KNN search is planned as an index scan.
+  */
+  ulonglong fb_vector_search_memory_limit;
+
   /**
     This flag can be used to turn on/off pre-filtering of vector
     embeddings based on PK or SK index conditions before vector
@@ -699,6 +726,52 @@ struct System_variables {
   */
   ulong fb_vector_search_type;
 
+  /**
+    Number of rows whose semantic filters are sent to the model together
+    before any of them is returned. 1 sends one row at a time.
+  */
+  uint semantic_filter_batch_size;
+
+  /**
+    Maximum number of semantic filter requests of a batch in flight at once.
+  */
+  uint semantic_filter_concurrency;
+
+  /**
+    Number of batches of rows a semantic filter reads ahead while the model
+    answers the batches before them, 0 to read the next batch only once
+    the rows of the current one are returned.
+  */
+  uint semantic_filter_read_ahead;
+
+  /**
+    Whether SEMANTIC_FILTER first scores a row by the similarity of its
+    embedding to the prompt's, and only asks the model about rows scoring
+    between semantic_filter_cascade_low and semantic_filter_cascade_high.
+  */
+  bool semantic_filter_cascade;
+  double semantic_filter_cascade_low;
+  double semantic_filter_cascade_high;
+
+  /**
+    Cosine similarity of their embeddings at which the inputs of SEMANTIC_MAP
+    and SEMANTIC_EXTRACT take the answer of an earlier near duplicate
+    instead of asking the model, 0 to always ask.
+  */
+  double semantic_dedup_threshold;
+
+  /**
+    Number of nearest neighbours by embedding each outer row of a semantic
+    join is paired with before asking the model.
+  */
+  uint semantic_join_neighbors;
+
+  /**
+    Whether FilterIterator evaluates simple numeric predicates of its
+    condition from a compiled program, see CompiledCondition.
+  */
+  bool compile_filter_conditions;
+
   /**
     This session var can be used to control whether index conditions are pushed
     down to the storage engine (ICP) for ORDER BY ... DESC statements that end
@@ -788,6 +861,18 @@ struct System_status_var {
   /* Number of statements sent from the client. */
   ulonglong questions;
 
+  /* Semantic operators, indexed by enum_semantic_op. */
+  ulonglong semantic_calls[SEMANTIC_OP_END];       /* values sent to them */
+  ulonglong semantic_cache_hits[SEMANTIC_OP_END];  /* answered by the cache */
+  ulonglong semantic_failures[SEMANTIC_OP_END];    /* left without answer */
+  ulonglong semantic_tokens_in[SEMANTIC_OP_END];
+  ulonglong semantic_tokens_out[SEMANTIC_OP_END];
+  ulonglong semantic_requests[SEMANTIC_OP_END];     /* http requests */
+  ulonglong semantic_queue_time[SEMANTIC_OP_END];   /* microseconds */
+  ulonglong semantic_request_time[SEMANTIC_OP_END]; /* microseconds */
+  ulonglong semantic_request_latency[SEMANTIC_OP_END]
+                                    [SEMANTIC_LATENCY_BUCKETS];
+
   /// How many queries have been executed on a secondary storage engine.
   ulonglong secondary_engine_execution_count;
 
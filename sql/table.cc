@@ -70,6 +70,7 @@
 #include "sql/auth/auth_common.h"  // acl_getroot
 #include "sql/auth/sql_security_ctx.h"
 #include "sql/binlog.h"                      // mysql_bin_log
+#include "sql/change_stream.h"  // change_stream_mark_columns
 #include "sql/dd/cache/dictionary_client.h"  // dd::cache_Dictionary_client
 #include "sql/dd/dd.h"                       // dd::get_dictionary
 #include "sql/dd/dictionary.h"               // dd::Dictionary
@@ -89,6 +90,7 @@
 #include "sql/json_diff.h"  // Json_diff_vector
 #include "sql/key.h"        // find_ref_key
 #include "sql/log.h"
+#include "sql/materialized_view.h"  // materialized_view_mark_columns
 #include "sql/my_decimal.h"
 #include "sql/mysqld.h"  // reg_ext key_file_frm ...
 #include "sql/nested_join.h"
@@ -761,9 +763,11 @@ void setup_key_part_field(TABLE_SHARE *share, handler *handler_file,
     use vector index if configured as a sort key for ORDER BY, preventing
     recource to filesort. We bypass the full_length_key_part check
     as the key length for vector index doesn't not follow usual key length
-    semantics
+    semantics. The same holds for a next spatial index, which can return
+    rows ordered by ST_DISTANCE to a point.
    */
-  if ((full_length_key_part || keyinfo->is_fb_vector_index()) &&
+  if ((full_length_key_part || keyinfo->is_fb_vector_index() ||
+       keyinfo->is_next_spatial_index()) &&
       (handler_file->index_flags(key_n, key_part_n, true) & HA_READ_ORDER))
     field->part_of_sortkey.set_bit(key_n);
 
@@ -2698,10 +2702,14 @@ bool unpack_value_generator(THD *thd, TABLE *table,
   parser_state.init(thd, gcol_expr_str, str_len);
   if (parse_sql(thd, &parser_state, nullptr)) return true;
 
+  // The text of the expression does not tell STORED ASYNC apart.
+  const bool async = (*val_generator)->is_async();
+
   // From now on use val_generator generated by the parser in expr_item
   *val_generator = parser_state.result;
   assert((*val_generator)->expr_item != nullptr &&
          (*val_generator)->expr_str.str == nullptr);
+  (*val_generator)->set_async(async);
 
   thd->lex->expr_allows_subselect = save_allow_subselects;
 
@@ -5633,6 +5641,10 @@ void TABLE::mark_columns_needed_for_delete(THD *thd) {
 
     file->column_bitmaps_signal();
   }
+  /* The keys of deleted rows are logged for the materialized views */
+  if (materialized_views_exist()) materialized_view_mark_columns(this);
+  /* and the images of the deleted rows for their change streams */
+  if (change_streams_exist()) change_stream_mark_columns(this);
   if (vfield) {
     /*
       InnoDB's delete_row may need to log pre-image of the index entries to
@@ -5711,6 +5723,10 @@ void TABLE::mark_columns_needed_for_update(THD *thd, bool mark_binlog_columns) {
 
     file->column_bitmaps_signal();
   }
+  /* The keys of updated rows are logged for the materialized views */
+  if (materialized_views_exist()) materialized_view_mark_columns(this);
+  /* and the images of the updated rows for their change streams */
+  if (change_streams_exist()) change_stream_mark_columns(this);
   /* Mark dependent generated columns as writable */
   if (vfield) mark_generated_columns(true);
   /* Mark columns needed for check constraints evaluation */
@@ -7167,6 +7183,21 @@ static bool update_generated_columns(TABLE *table, const MY_BITMAP *columns,
     // table->read_set or table->write_set).
     if (!bitmap_is_set(columns, field->field_index())) continue;
 
+    // A STORED ASYNC column is left NULL and filled in the background once
+    // the row is written, see semantic_materializer.h. The background fill
+    // finds the row by its primary key, so without one, and in the
+    // temporary copy of ALTER TABLE, it is computed right away.
+    if (!virtual_only && field->gcol_info->is_async() &&
+        table->s->primary_key != MAX_KEY &&
+        table->s->tmp_table == NO_TMP_TABLE) {
+      field->set_null();
+      table->async_gcols_pending = true;
+      if (updated_columns != nullptr) {
+        bitmap_set_bit(updated_columns, field->field_index());
+      }
+      continue;
+    }
+
     // For a virtual generated column of blob type, we have to keep the current
     // blob value since it might be needed by the storage engine during updates.
     // All arrays are BLOB fields.
@@ -103,8 +103,10 @@ enum enum_stats_auto_recalc : int;
 enum Value_generator_source : short;
 enum row_type : int;
 struct AccessPath;
+struct Fb_hybrid_score;
 struct HA_CREATE_INFO;
 struct LEX;
+struct Materialized_view_watch;
 struct NESTED_JOIN;
 struct Partial_update_info;
 struct TABLE;
@@ -324,6 +326,13 @@ struct ORDER {
   char *buff{nullptr}; /* If tmp-table group */
   table_map used{0}, depend_map{0};
   bool is_explicit{false}; /* Whether ASC/DESC is explicitly specified */
+  /**
+    *item decomposed by fb_parse_hybrid_score(), kept for the next executions
+    of a prepared statement while *item is still hybrid_score_item. No
+    distance in it if *item cannot be ranked by a vector index.
+  */
+  Item *hybrid_score_item{nullptr};
+  Fb_hybrid_score *hybrid_score{nullptr};
 };
 
 /**
@@ -1770,6 +1779,28 @@ struct TABLE {
           by handler::write_row().
   */
   bool autoinc_field_has_explicit_non_null_value{false};
+  /**
+    True if the record being written has STORED ASYNC generated columns left
+    NULL, to be filled in the background once it is written.
+    @note Set by update_generated_write_fields() and consumed by
+          handler::ha_write_row() and handler::ha_update_row().
+  */
+  bool async_gcols_pending{false};
+  /**
+    The materialized views whose changes are logged from this table, as of
+    version mv_registry_version of the set of views; 0 if not looked up yet.
+    @note Kept by materialized_view_capture().
+  */
+  Materialized_view_watch *mv_watch{nullptr};
+  ulonglong mv_registry_version{0};
+  /**
+    Whether the changes of this table are followed by change stream
+    subscribers, as of version cs_registry_version of the subscriptions; 0
+    if not looked up yet.
+    @note Kept by change_stream_capture().
+  */
+  bool cs_followed{false};
+  ulonglong cs_registry_version{0};
   bool alias_name_used{false};         /* true if table_name is alias */
   bool get_fields_in_item_tree{false}; /* Signal to fix_field */
 
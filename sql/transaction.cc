@@ -37,6 +37,7 @@
 #include "mysql_com.h"
 #include "mysqld_error.h"
 #include "sql/auth/auth_common.h"
+#include "sql/change_stream.h"  // change_stream_end_stmt
 #include "sql/dd/cache/dictionary_client.h"
 #include "sql/debug_sync.h"  // DEBUG_SYNC
 #include "sql/handler.h"
@@ -556,6 +557,8 @@ bool trans_commit_stmt(THD *thd, bool ignore_global_read_lock) {
       trans_reset_one_shot_chistics(thd);
   } else if (tc_log)
     res = tc_log->commit(thd, false);
+  // rows captured by the statement stay with the transaction
+  if (thd->cs_trans != nullptr) change_stream_end_stmt(thd, true);
   if (res == false && !thd->in_active_multi_stmt_transaction())
     if (thd->rpl_thd_ctx.session_gtids_ctx().notify_after_transaction_commit(
             thd))
@@ -602,6 +605,7 @@ bool trans_rollback_stmt(THD *thd) {
       trans_reset_one_shot_chistics(thd);
   } else if (tc_log)
     tc_log->rollback(thd, false);
+  if (thd->cs_trans != nullptr) change_stream_end_stmt(thd, false);
 
   if (!thd->owned_gtid_is_empty() && !thd->in_active_multi_stmt_transaction()) {
     /*
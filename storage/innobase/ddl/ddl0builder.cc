@@ -667,7 +667,8 @@ dberr_t Builder::init(Cursor &cursor, size_t n_threads) noexcept {
 
     if (is_spatial_index()) {
       thread_ctx->m_rtree_inserter = ut::new_withkey<RTree_inserter>(
-          ut::make_psi_memory_key(mem_key_ddl), m_ctx, index);
+          ut::make_psi_memory_key(mem_key_ddl), m_ctx, index,
+          buffer_size.first);
 
       if (thread_ctx->m_rtree_inserter == nullptr ||
           !thread_ctx->m_rtree_inserter->is_initialized()) {
@@ -1169,14 +1170,14 @@ dberr_t Builder::append(ddl::file_t &file, IO_buffer io_buffer) noexcept {
   }
 }
 
-dberr_t Builder::batch_insert(size_t thread_id,
-                              Latch_release &&latch_release) noexcept {
+dberr_t Builder::batch_insert(size_t thread_id, Latch_release &&latch_release,
+                              bool flush) noexcept {
   ut_a(is_spatial_index());
 
   auto rtree_inserter = m_thread_ctxs[thread_id]->m_rtree_inserter;
   const auto trx_id = m_ctx.m_trx->id;
 
-  return rtree_inserter->batch_insert(trx_id, std::move(latch_release));
+  return rtree_inserter->batch_insert(trx_id, std::move(latch_release), flush);
 }
 
 void Builder::batch_insert_deep_copy_tuples(size_t thread_id) noexcept {
@@ -196,19 +196,22 @@ dberr_t Parallel_cursor::scan(Builders &builders) noexcept {
     /* End of page scan. */
     for (auto builder : batch_insert) {
       /* Do a batch insert of the cached rows, instead of one by one. */
-      err = builder->batch_insert(thread_id, [&]() {
-        if (!latches_released) {
-          /* We are going to commit the mini-transaction, this will release
-          the latches and so we must do a deep copy of the rows before we
-          can commit the mini-transaction. */
-          for (size_t j = i + 1; j < batch_insert.size(); ++j) {
-            batch_insert[j]->batch_insert_deep_copy_tuples(thread_id);
-          }
-          thread_ctx->savepoint();
-          latches_released = true;
-        }
-        return DB_SUCCESS;
-      });
+      err = builder->batch_insert(
+          thread_id,
+          [&]() {
+            if (!latches_released) {
+              /* We are going to commit the mini-transaction, this will
+              release the latches and so we must do a deep copy of the rows
+              before we can commit the mini-transaction. */
+              for (size_t j = i + 1; j < batch_insert.size(); ++j) {
+                batch_insert[j]->batch_insert_deep_copy_tuples(thread_id);
+              }
+              thread_ctx->savepoint();
+              latches_released = true;
+            }
+            return DB_SUCCESS;
+          },
+          false);
 
       if (err != DB_SUCCESS && err != DB_END_OF_INDEX) {
         return err;
@@ -301,6 +304,17 @@ dberr_t Parallel_cursor::scan(Builders &builders) noexcept {
       case Parallel_reader::State::THREAD: {
         ut_a(n_rows[thread_id] == 0);
 
+        /* Insert the spatial index rows still cached. No latches are held
+        and the cached rows are deep copies. */
+        for (auto builder : batch_insert) {
+          err = builder->batch_insert(
+              thread_id, []() { return DB_SUCCESS; }, true);
+
+          if (err != DB_SUCCESS) {
+            return err;
+          }
+        }
+
         /* End of index scan. */
         auto &row = rows[thread_id];
 
@@ -28,17 +28,25 @@ this program; if not, write to the Free Software Foundation, Inc.,
  DDL cluster index scan implementation.
  Created 2020-11-01 by Sunny Bains. */
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+
 #include "btr0load.h"
 #include "ddl0impl-cursor.h"
 #include "ddl0impl-rtree.h"
+#include "gis0rtree.h"
 #include "log0chkp.h"
 #include "row0vers.h"
 
 namespace ddl {
 
-RTree_inserter::RTree_inserter(Context &ctx, dict_index_t *index) noexcept
+RTree_inserter::RTree_inserter(Context &ctx, dict_index_t *index,
+                               size_t max_cache_size) noexcept
     : m_dtuples(ut::new_withkey<Tuples>(ut::make_psi_memory_key(mem_key_ddl))),
       m_index(index),
+      m_max_cache_size(max_cache_size),
       m_ctx(ctx) {
   m_dml_heap = mem_heap_create(512, UT_LOCATION_HERE);
   m_dtuple_heap = mem_heap_create(512, UT_LOCATION_HERE);
@@ -78,8 +86,100 @@ void RTree_inserter::add_to_batch(const dtuple_t *row,
   m_dtuples->push_back(dtuple);
 }
 
+/** Position of a point on the Hilbert curve filling a 2^16 x 2^16 grid.
+@param[in]      x               Column, less than 2^16
+@param[in]      y               Row, less than 2^16
+@return the distance of the point from the start of the curve */
+static uint32_t hilbert_value(uint32_t x, uint32_t y) noexcept {
+  uint32_t d{};
+
+  for (uint32_t s = 1U << 15; s > 0; s >>= 1) {
+    const uint32_t rx = (x & s) > 0;
+    const uint32_t ry = (y & s) > 0;
+
+    d += s * s * ((3 * rx) ^ ry);
+
+    /* Rotate the quadrant so that the curve in it starts and ends at the
+    right corners. */
+    if (ry == 0) {
+      if (rx == 1) {
+        x = s - 1 - (x & (s - 1));
+        y = s - 1 - (y & (s - 1));
+      }
+      std::swap(x, y);
+    }
+  }
+
+  return d;
+}
+
+void RTree_inserter::sort_tuples() noexcept {
+  using Centre = std::pair<double, double>;
+  std::vector<Centre, ut::allocator<Centre>> centres;
+
+  centres.reserve(m_dtuples->size());
+
+  double xmin{DBL_MAX};
+  double ymin{DBL_MAX};
+  double xmax{-DBL_MAX};
+  double ymax{-DBL_MAX};
+
+  for (auto dtuple : *m_dtuples) {
+    rtr_mbr_t mbr;
+
+    rtr_get_mbr_from_tuple(dtuple, &mbr);
+
+    const Centre centre{(mbr.xmin + mbr.xmax) / 2, (mbr.ymin + mbr.ymax) / 2};
+
+    /* MBRs of empty geometries have no centre. */
+    if (std::isfinite(centre.first) && std::isfinite(centre.second)) {
+      xmin = std::min(xmin, centre.first);
+      xmax = std::max(xmax, centre.first);
+      ymin = std::min(ymin, centre.second);
+      ymax = std::max(ymax, centre.second);
+    }
+
+    centres.push_back(centre);
+  }
+
+  if (xmin > xmax) {
+    return;
+  }
+
+  const double x_scale = xmax > xmin ? 65535.0 / (xmax - xmin) : 0.0;
+  const double y_scale = ymax > ymin ? 65535.0 / (ymax - ymin) : 0.0;
+
+  using Key = std::pair<uint32_t, dtuple_t *>;
+  std::vector<Key, ut::allocator<Key>> keys;
+
+  keys.reserve(m_dtuples->size());
+
+  for (size_t i = 0; i < m_dtuples->size(); ++i) {
+    const auto &centre = centres[i];
+    uint32_t value{};
+
+    if (std::isfinite(centre.first) && std::isfinite(centre.second)) {
+      value = hilbert_value(
+          static_cast<uint32_t>((centre.first - xmin) * x_scale),
+          static_cast<uint32_t>((centre.second - ymin) * y_scale));
+    }
+
+    keys.emplace_back(value, (*m_dtuples)[i]);
+  }
+
+  std::stable_sort(keys.begin(), keys.end(),
+                   [](const Key &lhs, const Key &rhs) {
+                     return lhs.first < rhs.first;
+                   });
+
+  for (size_t i = 0; i < keys.size(); ++i) {
+    (*m_dtuples)[i] = keys[i].second;
+  }
+}
+
 dberr_t RTree_inserter::batch_insert(trx_id_t trx_id,
-                                     Latch_release &&latch_release) noexcept {
+                                     Latch_release &&latch_release,
+                                     bool flush) noexcept {
   rec_t *rec{};
   btr_cur_t cursor;
   ulint *offsets{};
@@ -94,6 +194,16 @@ dberr_t RTree_inserter::batch_insert(trx_id_t trx_id,
 
   ut_a(dict_index_is_spatial(m_index));
 
+  /* The rows of the page must outlive the mini-transaction of the scan,
+  whether they are cached for later or sorted among the cached rows. */
+  deep_copy_tuples();
+
+  if (!flush && mem_heap_get_size(m_dtuple_heap) < m_max_cache_size) {
+    return DB_SUCCESS;
+  }
+
+  sort_tuples();
+
   IF_ENABLED("ddl_instrument_log_check_flush", force_log_free_check = true;)
 
   mtr_t mtr;
@@ -107,8 +217,6 @@ dberr_t RTree_inserter::batch_insert(trx_id_t trx_id,
 
     if (log_free_check_is_required() IF_DEBUG(|| force_log_free_check)) {
       if (!latches_released) {
-        deep_copy_tuples(it);
-
         err = latch_release();
 
         if (err != DB_SUCCESS) {
@@ -201,6 +309,7 @@ dberr_t RTree_inserter::batch_insert(trx_id_t trx_id,
   }
 
   m_dtuples->clear();
+  m_n_copied = 0;
 
   mem_heap_empty(m_dml_heap);
   mem_heap_empty(m_dtuple_heap);
@@ -200,12 +200,14 @@ struct Builder {
   /** @return the path for temporary files. */
   const char *tmpdir() const noexcept { return m_tmpdir; }
 
-  /** Insert cached rows.
+  /** Insert cached rows, once enough of them are cached.
   @param[in] thread_id          Insert cached rows for this thread ID.
   @param[in,out] latch_release  Called when a log free check is required.
+  @param[in] flush              Insert all cached rows, at the end of the scan.
   @return DB_SUCCESS or error number */
   [[nodiscard]] dberr_t batch_insert(size_t thread_id,
-                                     Latch_release &&latch_release) noexcept;
+                                     Latch_release &&latch_release,
+                                     bool flush) noexcept;
 
   /** Note that the latches are going to be released. Do a deep copy of the
   tuples that are being inserted in batches by batch_insert
@@ -38,14 +38,19 @@ this program; if not, write to the Free Software Foundation, Inc.,
 
 namespace ddl {
 
-/** Class that caches RTree index tuples made from a single cluster
-index page scan, and then insert into corresponding index tree. */
+/** Class that caches RTree index tuples made from cluster index page scans,
+and then insert into corresponding index tree. The tuples of many pages are
+cached and inserted in the order of the Hilbert values of the centres of
+their MBRs, so that neighbouring tuples end up in the same pages of the
+tree. */
 class RTree_inserter {
  public:
   /** Constructor.
   @param[in,out] ctx            DDL context.
-  @param[in]    index               Index to be created */
-  RTree_inserter(Context &ctx, dict_index_t *index) noexcept;
+  @param[in]    index               Index to be created
+  @param[in]    max_cache_size      Memory the cached tuples may use */
+  RTree_inserter(Context &ctx, dict_index_t *index,
+                 size_t max_cache_size) noexcept;
 
   /** Destructor */
   ~RTree_inserter() noexcept;
@@ -65,15 +70,21 @@ class RTree_inserter {
   prefixes, or nullptr */
   void add_to_batch(const dtuple_t *row, const row_ext_t *ext) noexcept;
 
-  /** Insert the rows cached in the batch (m_dtuples).
+  /** Insert the rows cached in the batch (m_dtuples), once they use
+  max_cache_size or on flush. Until then the rows are deep copied.
   @param[in]    trx_id                  Transaction id.
   @param[in,out] latch_release  Called when a log free check is required.
+  @param[in]    flush                   Insert the cached rows in any case.
   @return DB_SUCCESS if successful, else error number */
   [[nodiscard]] dberr_t batch_insert(trx_id_t trx_id,
-                                     Latch_release &&latch_release) noexcept;
+                                     Latch_release &&latch_release,
+                                     bool flush) noexcept;
 
   /** Deep copy the fields pointing to the clustered index record. */
-  void deep_copy_tuples() noexcept { deep_copy_tuples(m_dtuples->begin()); }
+  void deep_copy_tuples() noexcept {
+    deep_copy_tuples(m_dtuples->begin() + m_n_copied);
+    m_n_copied = m_dtuples->size();
+  }
 
  private:
   /** Cache index rows made from a cluster index scan. Usually
@@ -84,6 +95,10 @@ class RTree_inserter {
   @param[in] it                 Deep copy from this tuple onwards. */
   void deep_copy_tuples(Tuples::iterator it) noexcept;
 
+  /** Sort the cached tuples by the Hilbert values of the centres of their
+  MBRs, within the MBR of all of them. */
+  void sort_tuples() noexcept;
+
  private:
   /** vector used to cache index rows made from cluster index scan */
   Tuples *m_dtuples{};
@@ -100,6 +115,12 @@ class RTree_inserter {
   /** Iterator to process m_dtuples */
   Tuples::iterator m_iter{};
 
+  /** Number of tuples at the start of m_dtuples that are deep copies. */
+  size_t m_n_copied{};
+
+  /** Memory the cached tuples may use before they are inserted. */
+  const size_t m_max_cache_size{};
+
   /** DDL context. */
   Context &m_ctx;
 };
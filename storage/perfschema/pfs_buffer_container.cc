@@ -27,7 +27,10 @@
 
 #include "storage/perfschema/pfs_buffer_container.h"
 
+#include <atomic>
+
 #include "my_compiler.h"
+#include "my_systime.h"
 #include "storage/perfschema/pfs_account.h"
 #include "storage/perfschema/pfs_builtin_memory.h"
 #include "storage/perfschema/pfs_error.h"
@@ -1086,3 +1089,38 @@ void PFS_user_allocator::free_array(PFS_user_array *array) {
 
 PFS_user_allocator user_allocator;
 PFS_user_container global_user_container(&user_allocator);
+
+/** Microseconds between two shrinks of the buffers. */
+static const ulonglong shrink_interval = 10 * 1000 * 1000;
+static std::atomic<ulonglong> last_shrink{0};
+
+void shrink_buffer_containers() {
+  ulonglong now = my_micro_time();
+  ulonglong last = last_shrink.load();
+
+  if (now < last + shrink_interval ||
+      !last_shrink.compare_exchange_strong(last, now)) {
+    return;
+  }
+
+  global_mutex_container.shrink();
+  global_rwlock_container.shrink();
+  global_cond_container.shrink();
+  global_file_container.shrink();
+  global_socket_container.shrink();
+  global_mdl_container.shrink();
+  global_table_container.shrink();
+  global_table_io_stat_container.shrink();
+  global_table_share_container.shrink();
+  global_table_share_index_container.shrink();
+  global_table_share_lock_container.shrink();
+  global_table_share_query_container.shrink();
+  global_program_container.shrink();
+  global_prepared_stmt_container.shrink();
+  global_client_attrs_container.shrink();
+  global_sql_text_container.shrink();
+  global_thread_container.shrink();
+  global_account_container.shrink();
+  global_host_container.shrink();
+  global_user_container.shrink();
+}
@@ -225,6 +225,9 @@ class PFS_buffer_container {
 
   size_t get_memory() const { return get_row_count() * get_row_size(); }
 
+  /** A fixed size buffer never shrinks. */
+  uint shrink() { return 0; }
+
   value_type *allocate(pfs_dirty_state *dirty_state) {
     value_type *pfs;
 
@@ -403,6 +406,7 @@ class PFS_buffer_scalable_container {
     m_lost = 0;
     m_monotonic.m_size_t.store(0);
     m_max_page_index.m_size_t.store(0);
+    m_retired_count = 0;
 
     for (i = 0; i < PFS_PAGE_COUNT; i++) {
       m_pages[i] = nullptr;
@@ -456,6 +460,7 @@ class PFS_buffer_scalable_container {
         m_pages[i] = nullptr;
       }
     }
+    free_retired_pages();
     native_mutex_unlock(&m_critical_section);
 
     native_mutex_destroy(&m_critical_section);
@@ -478,6 +483,47 @@ class PFS_buffer_scalable_container {
 
   size_t get_memory() { return get_row_count() * get_row_size(); }
 
+  /**
+    Give back the memory of the empty pages at the end of the buffer,
+    keeping the first page, and one empty page to absorb the next spike.
+    A page is retired once all its records are claimed, so that nothing
+    allocates in it any more, and is only freed by the next call, when
+    the readers that found it before it was retired are long gone:
+    calls must be far enough apart, see shrink_buffer_containers().
+    @return the number of pages retired
+  */
+  uint shrink() {
+    uint retired = 0;
+    size_t page_count;
+    array_type *page;
+
+    if (!m_initialized) {
+      return 0;
+    }
+
+    native_mutex_lock(&m_critical_section);
+
+    free_retired_pages();
+
+    page_count = m_max_page_index.m_size_t.load();
+    while (page_count > 2 && is_page_empty(m_pages[page_count - 2]) &&
+           claim_page(m_pages[page_count - 1])) {
+      page = m_pages[page_count - 1];
+      m_pages[page_count - 1].store(nullptr);
+      --m_max_page_index.m_size_t;
+      m_retired_pages[m_retired_count++] = page;
+      page_count--;
+      retired++;
+    }
+
+    if (retired != 0) {
+      m_full = false;
+    }
+
+    native_mutex_unlock(&m_critical_section);
+    return retired;
+  }
+
   value_type *allocate(pfs_dirty_state *dirty_state) {
     if (m_full) {
       m_lost++;
@@ -595,6 +641,14 @@ class PFS_buffer_scalable_container {
 
         array = m_pages[current_page_count].load();
 
+        if (array == nullptr &&
+            current_page_count > m_max_page_index.m_size_t.load()) {
+          /* The buffer shrunk meanwhile, add the page at its end instead */
+          current_page_count = m_max_page_index.m_size_t.load();
+          native_mutex_unlock(&m_critical_section);
+          continue;
+        }
+
         if (array == nullptr) {
           /* (2-c) Found no page, allocate a new one */
           array = new array_type();
@@ -863,6 +917,60 @@ class PFS_buffer_scalable_container {
     return m_last_page_size;
   }
 
+  static bool is_page_empty(array_type *page) {
+    value_type *pfs = page->get_first();
+    value_type *pfs_last = page->get_last();
+
+    while (pfs < pfs_last) {
+      if (!pfs->m_lock.is_free()) {
+        return false;
+      }
+      pfs++;
+    }
+    return true;
+  }
+
+  /**
+    Mark all the records of a page dirty, if they are all free.
+    @return true if the page is claimed
+  */
+  static bool claim_page(array_type *page) {
+    pfs_dirty_state dirty_state;
+    value_type *pfs_first = page->get_first();
+    value_type *pfs = pfs_first;
+    value_type *pfs_last = page->get_last();
+
+    while (pfs < pfs_last) {
+      if (!pfs->m_lock.free_to_dirty(&dirty_state)) {
+        break;
+      }
+      pfs++;
+    }
+
+    if (pfs == pfs_last) {
+      return true;
+    }
+
+    /* Give back the records claimed so far. */
+    while (pfs > pfs_first) {
+      pfs--;
+      dirty_state.m_version_state = pfs->m_lock.copy_version_state();
+      pfs->m_lock.dirty_to_free(&dirty_state);
+    }
+    page->m_full = false;
+    return false;
+  }
+
+  /** Free the pages retired by the previous shrink(). */
+  void free_retired_pages() {
+    for (uint i = 0; i < m_retired_count; i++) {
+      m_allocator->free_array(m_retired_pages[i]);
+      delete m_retired_pages[i];
+      builtin_memory_scalable_buffer.count_free(sizeof(array_type));
+    }
+    m_retired_count = 0;
+  }
+
   value_type *scan_next(uint &index, uint *found_index) {
     assert(index <= m_max);
 
@@ -912,6 +1020,9 @@ class PFS_buffer_scalable_container {
   size_t m_max_page_count;
   size_t m_last_page_size;
   std::atomic<array_type *> m_pages[PFS_PAGE_COUNT];
+  /** Pages retired by shrink(), not yet freed. */
+  array_type *m_retired_pages[PFS_PAGE_COUNT];
+  uint m_retired_count;
   allocator_type *m_allocator;
   native_mutex_t m_critical_section;
 };
@@ -1037,6 +1148,16 @@ class PFS_partitioned_buffer_scalable_container {
     return sum;
   }
 
+  uint shrink() {
+    uint sum = 0;
+
+    for (int i = 0; i < PFS_PARTITION_COUNT; i++) {
+      sum += m_partitions[i]->shrink();
+    }
+
+    return sum;
+  }
+
   long get_lost_counter() {
     long sum = 0;
 
@@ -1512,4 +1633,11 @@ typedef PFS_buffer_container<PFS_user, PFS_user_array, PFS_user_allocator>
 typedef PFS_user_container::iterator_type PFS_user_iterator;
 extern PFS_user_container global_user_container;
 
+/**
+  Shrink the instance buffers back to what they currently use.
+  Cheap when called often: it does the work at most once every
+  10 seconds, which is the grace period of the pages it retires.
+*/
+void shrink_buffer_containers();
+
 #endif
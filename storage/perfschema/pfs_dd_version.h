@@ -336,10 +336,13 @@
   80032-026:
   - Add DB_NAME columns to P_S.memory_summary_by_thread_by_event_name.
 
+  80032-027:
+  - Add CONTINUOUS_QUERIES table
+
   The last three digits reprents Facebook specific MySQL Schema changes.
-  Version published is now 80032-026. i.e. 8.0.32 Facebook schema change no. 26.
+  Version published is now 80032-027. i.e. 8.0.32 Facebook schema change no. 27.
 */
 
-static const uint PFS_DD_VERSION = 80032026;
+static const uint PFS_DD_VERSION = 80032027;
 
 #endif /* PFS_DD_VERSION_H */
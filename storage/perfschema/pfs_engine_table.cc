@@ -56,6 +56,7 @@
 #include "storage/perfschema/table_accounts.h"
 #include "storage/perfschema/table_binary_log_transaction_compression_stats.h"
 #include "storage/perfschema/table_column_statistics.h"
+#include "storage/perfschema/table_continuous_queries.h"
 #include "storage/perfschema/table_data_lock_waits.h"
 #include "storage/perfschema/table_data_locks.h"
 #include "storage/perfschema/table_ees_by_account_by_error.h"
@@ -584,6 +585,7 @@ static PFS_engine_table_share *all_shares[] = {
     &table_write_throttling_log::m_share,
     &table_sql_findings::m_share,
     &table_sql_plans::m_share,
+    &table_continuous_queries::m_share,
 
     &table_keyring_keys::s_share,
 
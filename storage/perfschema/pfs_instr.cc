@@ -1004,6 +1004,9 @@ void destroy_thread(PFS_thread *pfs) {
     pfs->m_sql_text_hash_pins = NULL;
   }
   global_thread_container.deallocate(pfs);
+
+  /* Disconnects are when the load drops */
+  shrink_buffer_containers();
 }
 
 /**
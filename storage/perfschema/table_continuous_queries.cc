@@ -0,0 +1,249 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+/**
+  @file storage/perfschema/table_continuous_queries.cc
+  Performance schema continuous_queries table.
+*/
+
+#include "storage/perfschema/table_continuous_queries.h"
+
+#include "sql/field.h"
+#include "sql/plugin_table.h"
+#include "sql/table.h"
+#include "storage/perfschema/table_helper.h"
+
+THR_LOCK table_continuous_queries::m_table_lock;
+std::atomic<int> table_continuous_queries::m_most_recent_size(0);
+
+Plugin_table table_continuous_queries::m_table_def(
+    /* Schema name */
+    "performance_schema",
+    /* Name */
+    "continuous_queries",
+    /* Definition */
+    "  ID BIGINT unsigned NOT NULL,\n"
+    "  USER CHAR(32) collate utf8mb4_bin default null,\n"
+    "  HOST CHAR(255) CHARACTER SET ASCII default null,\n"
+    "  KIND VARCHAR(16) NOT NULL\n"
+    "    COMMENT \"PERIODIC, REFRESH, ASYNC, TOP_K, GEOFENCE, WINDOW or "
+    "SHARED.\",\n"
+    "  QUERY_TEXT LONGTEXT,\n"
+    "  PERIOD BIGINT unsigned\n"
+    "    COMMENT \"Seconds between runs, NULL for ASYNC queries.\",\n"
+    "  BACKOFF BIGINT unsigned NOT NULL\n"
+    "    COMMENT \"Times the period is stretched for runs that overran.\",\n"
+    "  RUNS BIGINT unsigned NOT NULL,\n"
+    "  OUTPUTS BIGINT unsigned NOT NULL,\n"
+    "  LAST_REFRESH TIMESTAMP(6)\n"
+    "    COMMENT \"When the last run ended.\",\n"
+    "  DELTA_ROWS BIGINT unsigned NOT NULL\n"
+    "    COMMENT \"Rows of changes the runs consumed.\",\n"
+    "  SUM_TIMER_REFRESH BIGINT unsigned NOT NULL,\n"
+    "  MAX_TIMER_REFRESH BIGINT unsigned NOT NULL,\n"
+    "  QUANTILE_95 BIGINT unsigned NOT NULL,\n"
+    "  QUANTILE_99 BIGINT unsigned NOT NULL,\n"
+    "  QUANTILE_999 BIGINT unsigned NOT NULL,\n"
+    "  LAST_LAG BIGINT unsigned NOT NULL\n"
+    "    COMMENT \"From the commit of the first change the last run "
+    "consumed, or the tick it came due, to its end.\",\n"
+    "  MAX_LAG BIGINT unsigned NOT NULL,\n"
+    "  SUM_LAG BIGINT unsigned NOT NULL,\n"
+    "  SUM_CPU_TIME BIGINT unsigned NOT NULL,\n"
+    "  SUM_ROWS_READ BIGINT unsigned NOT NULL,\n"
+    "  SUM_CREATED_TMP_DISK_TABLES BIGINT unsigned NOT NULL\n",
+    /* Options */
+    " ENGINE=PERFORMANCE_SCHEMA",
+    /* Tablespace */
+    nullptr);
+
+PFS_engine_table_share table_continuous_queries::m_share = {
+    &pfs_readonly_acl,
+    table_continuous_queries::create,
+    NULL, /* write_row */
+    NULL, /* delete_all_rows */
+    table_continuous_queries::get_row_count,
+    sizeof(PFS_simple_index),
+    &table_continuous_queries::m_table_lock,
+    &table_continuous_queries::m_table_def,
+    false, /* perpetual */
+    PFS_engine_table_proxy(),
+    {0},
+    false /* m_in_purgatory */
+};
+
+enum continuous_queries_field_offset {
+  FO_ID,
+  FO_USER,
+  FO_HOST,
+  FO_KIND,
+  FO_QUERY_TEXT,
+  FO_PERIOD,
+  FO_BACKOFF,
+  FO_RUNS,
+  FO_OUTPUTS,
+  FO_LAST_REFRESH,
+  FO_DELTA_ROWS,
+  FO_SUM_TIMER_REFRESH,
+  FO_MAX_TIMER_REFRESH,
+  FO_QUANTILE_95,
+  FO_QUANTILE_99,
+  FO_QUANTILE_999,
+  FO_LAST_LAG,
+  FO_MAX_LAG,
+  FO_SUM_LAG,
+  FO_SUM_CPU_TIME,
+  FO_SUM_ROWS_READ,
+  FO_SUM_CREATED_TMP_DISK_TABLES
+};
+
+table_continuous_queries::table_continuous_queries()
+    : PFS_engine_table(&m_share, &m_pos), m_pos(0) {
+  m_all_rows = continuous_query_list();
+  table_continuous_queries::m_most_recent_size = m_all_rows.size();
+  m_current_row = nullptr;
+}
+
+PFS_engine_table *table_continuous_queries::create(PFS_engine_table_share *) {
+  return new table_continuous_queries();
+}
+
+ha_rows table_continuous_queries::get_row_count(void) {
+  /*
+    To hint the optimizer we return the most recent size of
+    the table when we last loaded the stats
+  */
+  return m_most_recent_size;
+}
+
+void table_continuous_queries::reset_position(void) { m_pos.set_at(0u); }
+
+int table_continuous_queries::rnd_next(void) {
+  if (m_pos.m_index >= m_all_rows.size()) {
+    m_current_row = nullptr;
+    return HA_ERR_END_OF_FILE;
+  }
+  m_current_row = &m_all_rows[m_pos.m_index];
+  m_pos.next();
+  return 0;
+}
+
+int table_continuous_queries::rnd_pos(const void *pos) {
+  set_position(pos);
+  if (m_pos.m_index >= m_all_rows.size()) {
+    m_current_row = nullptr;
+    return HA_ERR_RECORD_DELETED;
+  }
+  m_current_row = &m_all_rows[m_pos.m_index];
+  return 0;
+}
+
+int table_continuous_queries::read_row_values(TABLE *table,
+                                              unsigned char *buf,
+                                              Field **fields, bool read_all) {
+  Field *f;
+  const auto &curr_row = *m_current_row;
+
+  /* Set the null bits */
+  assert(table->s->null_bytes == 1);
+  buf[0] = 0;
+
+  for (; (f = *fields); fields++) {
+    if (read_all || bitmap_is_set(table->read_set, f->field_index())) {
+      switch (f->field_index()) {
+        case FO_ID:
+          set_field_ulonglong(f, curr_row.id);
+          break;
+        case FO_USER:
+          set_field_char_utf8mb4(f, curr_row.user.c_str(),
+                                 curr_row.user.length());
+          break;
+        case FO_HOST:
+          set_field_char_utf8mb4(f, curr_row.host.c_str(),
+                                 curr_row.host.length());
+          break;
+        case FO_KIND:
+          set_field_varchar_utf8mb4(f, curr_row.kind);
+          break;
+        case FO_QUERY_TEXT:
+          set_field_longtext_utf8mb4(f, curr_row.text.c_str(),
+                                     curr_row.text.length());
+          break;
+        case FO_PERIOD:
+          if (curr_row.period != 0)
+            set_field_ulonglong(f, curr_row.period);
+          else
+            f->set_null();
+          break;
+        case FO_BACKOFF:
+          set_field_ulonglong(f, curr_row.backoff);
+          break;
+        case FO_RUNS:
+          set_field_ulonglong(f, curr_row.runs);
+          break;
+        case FO_OUTPUTS:
+          set_field_ulonglong(f, curr_row.outputs);
+          break;
+        case FO_LAST_REFRESH:
+          if (curr_row.last_refresh != 0)
+            set_field_timestamp(f, curr_row.last_refresh);
+          else
+            f->set_null();
+          break;
+        case FO_DELTA_ROWS:
+          set_field_ulonglong(f, curr_row.delta_rows);
+          break;
+        case FO_SUM_TIMER_REFRESH:
+          set_field_ulonglong(f, curr_row.sum_refresh);
+          break;
+        case FO_MAX_TIMER_REFRESH:
+          set_field_ulonglong(f, curr_row.max_refresh);
+          break;
+        case FO_QUANTILE_95:
+          set_field_ulonglong(f, curr_row.quantile_95);
+          break;
+        case FO_QUANTILE_99:
+          set_field_ulonglong(f, curr_row.quantile_99);
+          break;
+        case FO_QUANTILE_999:
+          set_field_ulonglong(f, curr_row.quantile_999);
+          break;
+        case FO_LAST_LAG:
+          set_field_ulonglong(f, curr_row.last_lag);
+          break;
+        case FO_MAX_LAG:
+          set_field_ulonglong(f, curr_row.max_lag);
+          break;
+        case FO_SUM_LAG:
+          set_field_ulonglong(f, curr_row.sum_lag);
+          break;
+        case FO_SUM_CPU_TIME:
+          set_field_ulonglong(f, curr_row.sum_cpu_time);
+          break;
+        case FO_SUM_ROWS_READ:
+          set_field_ulonglong(f, curr_row.sum_rows_read);
+          break;
+        case FO_SUM_CREATED_TMP_DISK_TABLES:
+          set_field_ulonglong(f, curr_row.sum_created_tmp_disk_tables);
+          break;
+        default:
+          assert(false);
+      }
+    }
+  }
+
+  return 0;
+}
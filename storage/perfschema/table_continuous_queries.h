@@ -0,0 +1,67 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+/**
+  @file storage/perfschema/table_continuous_queries.h
+  Performance schema continuous_queries table.
+*/
+
+#ifndef TABLE_CONTINUOUS_QUERIES_H
+#define TABLE_CONTINUOUS_QUERIES_H
+
+#include <atomic>
+#include <vector>
+
+#include "sql/continuous_query.h"
+#include "storage/perfschema/pfs_engine_table.h"
+
+class table_continuous_queries : public PFS_engine_table {
+ public:
+  /** Table share */
+  static PFS_engine_table_share m_share;
+  static PFS_engine_table *create(PFS_engine_table_share *);
+  static ha_rows get_row_count();
+
+  void reset_position(void) override;
+  int rnd_next() override;
+  int rnd_pos(const void *pos) override;
+
+  /** Captures the most recent size of table in static context.
+   * To be used as the estimated return value for get_row_count **/
+  static std::atomic<int> m_most_recent_size;
+
+ protected:
+  int read_row_values(TABLE *table, unsigned char *buf, Field **fields,
+                      bool read_all) override;
+
+ private:
+  table_continuous_queries();
+
+ private:
+  /** Current position. */
+  PFS_simple_index m_pos;
+
+  std::vector<Continuous_query_info> m_all_rows;
+  const Continuous_query_info *m_current_row;
+
+  /** Table share lock. */
+  static THR_LOCK m_table_lock;
+
+  /** Table definition. */
+  static Plugin_table m_table_def;
+};
+
+#endif
@@ -494,6 +494,42 @@ static void test_with_instances() {
   cleanup_instruments();
 }
 
+static void test_shrink() {
+  PFS_buffer_default_allocator<PFS_cond> allocator(&builtin_memory_cond);
+  PFS_buffer_scalable_container<PFS_cond, 4, 8> container(&allocator);
+  pfs_dirty_state dirty_state;
+  PFS_cond *conds[12];
+  int i;
+
+  container.init(-1);
+  for (i = 0; i < 12; i++) {
+    conds[i] = container.allocate(&dirty_state);
+    conds[i]->m_lock.dirty_to_allocated(&dirty_state);
+  }
+  ok(container.get_row_count() == 12, "3 pages");
+
+  ok(container.shrink() == 0, "full pages kept");
+  container.deallocate(conds[11]);
+  container.deallocate(conds[10]);
+  ok(container.shrink() == 0, "used pages kept");
+
+  for (i = 0; i < 10; i++) {
+    container.deallocate(conds[i]);
+  }
+  ok(container.shrink() == 1, "empty page retired");
+  ok(container.get_row_count() == 8, "2 pages");
+  ok(container.shrink() == 0, "first pages kept");
+
+  for (i = 0; i < 12; i++) {
+    conds[i] = container.allocate(&dirty_state);
+    ok(conds[i] != nullptr, "allocated after shrink");
+    conds[i]->m_lock.dirty_to_allocated(&dirty_state);
+  }
+  ok(container.get_row_count() == 12, "3 pages again");
+
+  container.cleanup();
+}
+
 static void do_all_tests() {
   flag_global_instrumentation = true;
   flag_thread_instrumentation = true;
@@ -501,10 +537,11 @@ static void do_all_tests() {
   test_no_instruments();
   test_no_instances();
   test_with_instances();
+  test_shrink();
 }
 
 int main(int, char **) {
-  plan(103);
+  plan(122);
   MY_INIT("pfs_instr-t");
   do_all_tests();
   my_end(0);
@@ -22,6 +22,7 @@
 #include <string_view>
 #include <unordered_map>
 
+#include "my_checksum.h"
 #include "my_compiler.h"
 #include "mysql/psi/mysql_file.h"
 #include "mysqld_error.h"
@@ -191,7 +192,8 @@ class [[nodiscard]] client_chunk_metadata final
   [[nodiscard]] static auto deserialize(
       myrocks::Rdb_string_reader &buf,
       const myrocks::clone::metadata_header &header) {
-    assert(header.get_type() == myrocks::clone::metadata_type::FILE_CHUNK_V1);
+    assert(header.get_type() == myrocks::clone::metadata_type::FILE_CHUNK_V1 ||
+           header.get_type() == myrocks::clone::metadata_type::FILE_CHUNK_V2);
 
     const auto payload_start_pos = buf.get_current_ptr();
 
@@ -199,12 +201,21 @@ class [[nodiscard]] client_chunk_metadata final
     if (buf.read_uint64(&read_file_id)) return invalid();
     std::uint64_t read_size;
     if (buf.read_uint64(&read_size)) return invalid();
+    const auto with_checksum =
+        header.get_type() == myrocks::clone::metadata_type::FILE_CHUNK_V2;
+    std::uint32_t read_checksum = 0;
+    if (with_checksum && buf.read_uint32(&read_checksum)) return invalid();
 
     const auto payload_end_pos = buf.get_current_ptr();
     if (!metadata_buf_valid(payload_start_pos, payload_end_pos, header))
       return invalid();
 
-    client_chunk_metadata result{read_file_id, static_cast<uint>(read_size)};
+    client_chunk_metadata result =
+        with_checksum
+            ? client_chunk_metadata{read_file_id, static_cast<uint>(read_size),
+                                    read_checksum}
+            : client_chunk_metadata{read_file_id,
+                                    static_cast<uint>(read_size)};
     assert(result.is_valid());
     return result;
   }
@@ -310,6 +321,12 @@ class [[nodiscard]] client final : public myrocks::clone::session {
 
   [[nodiscard]] myrocks::clone::locator make_restart_locator() const;
 
+  // Check the checksum of a FILE_CHUNK_V2 chunk and write it. Returns MySQL
+  // error code.
+  [[nodiscard]] int apply_checksummed_chunk(const client_chunk_metadata &chunk,
+                                            Ha_clone_cbk &cbk,
+                                            const file_in_progress &file);
+
   [[nodiscard]] std::string make_in_progress_marker_path() const {
     return myrocks::rdb_concat_paths(m_rdb_data_dir,
                                      myrocks::clone::in_progress_marker_file);
@@ -581,7 +598,9 @@ int client::apply_chunk(client_chunk_metadata &&chunk, Ha_clone_cbk &cbk,
 
   const auto file_handle = file_in_progress.get_file();
 
-  auto err = cbk.apply_file_cbk(file_handle);
+  auto err = chunk.has_checksum()
+                 ? apply_checksummed_chunk(chunk, cbk, file_in_progress)
+                 : cbk.apply_file_cbk(file_handle);
 
   DBUG_EXECUTE_IF("myrocks_clone_apply_fail", {
     err = ER_ERROR_ON_WRITE;
@@ -618,6 +637,48 @@ int client::apply_chunk(client_chunk_metadata &&chunk, Ha_clone_cbk &cbk,
   return HA_EXIT_SUCCESS;
 }
 
+int client::apply_checksummed_chunk(const client_chunk_metadata &chunk,
+                                    Ha_clone_cbk &cbk,
+                                    const file_in_progress &file) {
+  uchar *data;
+  uint len;
+  auto err = cbk.apply_buffer_cbk(data, len);
+  if (err != 0) return err;
+
+  if (len != chunk.get_size() ||
+      my_checksum(0, data, len) != chunk.get_checksum()) {
+    char msgbuf[MYSYS_ERRMSG_SIZE];
+    snprintf(msgbuf, sizeof(msgbuf),
+             "Checksum mismatch in the chunk of file %.*s at offset %" PRIu64
+             " received from the donor",
+             static_cast<int>(file.get_name().length()),
+             file.get_name().data(),
+             static_cast<std::uint64_t>(file.get_applied_offset()));
+    return myrocks::clone::return_error(ER_CLONE_PROTOCOL, msgbuf);
+  }
+
+  const auto fd = file.get_file().file_desc;
+  if (!file.get_file().o_direct_uneven_file_size) {
+    return mysql_file_write(fd, data, len, MYF(MY_WME | MY_NABP)) == 0
+               ? 0
+               : ER_ERROR_ON_WRITE;
+  }
+
+  // O_DIRECT writes whole blocks from an aligned buffer: the last chunk of
+  // the file is padded and the padding is cut off again
+  const auto padded_len = myrocks::clone::pad_for_direct_io(len);
+  auto *const buf = myrocks::clone::thread_io_buffer(padded_len);
+  if (buf == nullptr) return ER_OUTOFMEMORY;
+  memcpy(buf, data, len);
+  memset(buf + len, 0, padded_len - len);
+  if (mysql_file_write(fd, buf, padded_len, MYF(MY_WME | MY_NABP)) != 0)
+    return ER_ERROR_ON_WRITE;
+  if (padded_len != len &&
+      my_chsize(fd, file.get_applied_offset() + len, 0, MYF(MY_WME)) != 0)
+    return ER_ERROR_ON_WRITE;
+  return 0;
+}
+
 client::client() {
 #ifdef HAVE_PSI_INTERFACE
   mysql_rwlock_init(myrocks::key_rwlock_clone_client_files, &m_files_lock);
@@ -745,6 +806,8 @@ int rocksdb_clone_apply_begin(handlerton *, THD *, const uchar *&loc,
 // - FILE_CHUNK_V1: use the clone callback to apply the next file chunk to the
 //   target file. Check if the target size has been reached, in that case close
 //   it and move it to the completed file set.
+// - FILE_CHUNK_V2: as FILE_CHUNK_V1, checking the checksum of the chunk before
+//   writing it to the target file.
 // - ADD_ESTIMATE_V1: pass through the MyRocks clone data size to the plugin.
 int rocksdb_clone_apply(handlerton *, THD *thd, const uchar *loc, uint loc_len,
                         uint task_id, int in_err, Ha_clone_cbk *cbk) {
@@ -807,7 +870,8 @@ int rocksdb_clone_apply(handlerton *, THD *thd, const uchar *loc, uint loc_len,
       }
       return client::instance().register_file(std::move(file_metadata), thd);
     }
-    case clone::metadata_type::FILE_CHUNK_V1: {
+    case clone::metadata_type::FILE_CHUNK_V1:
+    case clone::metadata_type::FILE_CHUNK_V2: {
       auto file_chunk = client_chunk_metadata::deserialize(buf, header);
       if (!file_chunk.is_valid()) {
         return client::instance().save_and_return_error(
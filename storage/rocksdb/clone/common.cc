@@ -18,6 +18,8 @@
 
 #include <atomic>
 #include <cstdint>
+#include <cstdlib>
+#include <memory>
 #include <string_view>
 
 #include "my_compiler.h"
@@ -289,6 +291,22 @@ void fixup_on_startup() {
   return (da != nullptr && da->is_error()) ? da->message_text() : "";
 }
 
+[[nodiscard]] uchar *thread_io_buffer(std::size_t size) {
+  struct aligned_free {
+    void operator()(uchar *p) const noexcept { std::free(p); }
+  };
+  thread_local std::unique_ptr<uchar, aligned_free> buffer;
+  thread_local std::size_t buffer_size = 0;
+
+  size = pad_for_direct_io(size);
+  if (size > buffer_size) {
+    buffer.reset(
+        static_cast<uchar *>(std::aligned_alloc(direct_io_align, size)));
+    buffer_size = buffer ? size : 0;
+  }
+  return buffer.get();
+}
+
 [[nodiscard]] bool should_use_direct_io(std::string_view file_name,
                                         enum mode_for_direct_io mode) {
   const auto is_sst = has_file_extension(file_name, ".sst"sv);
@@ -69,12 +69,24 @@ enum class mode_for_direct_io { DONOR, CLIENT };
 [[nodiscard]] bool should_use_direct_io(std::string_view file_name,
                                         enum mode_for_direct_io mode);
 
+// The alignment and size granularity of O_DIRECT reads and writes
+constexpr std::size_t direct_io_align = 4096;
+
+[[nodiscard]] constexpr std::size_t pad_for_direct_io(std::size_t len) {
+  return (len + direct_io_align - 1) & ~(direct_io_align - 1);
+}
+
+// A buffer of this thread aligned for O_DIRECT, of at least size bytes. It is
+// kept for the next call, to be reused by the chunks of the next files.
+[[nodiscard]] uchar *thread_io_buffer(std::size_t size);
+
 enum class metadata_type : std::uint32_t {
   LOCATOR_V1,
   FILE_NAME_MAP_V1,
   FILE_CHUNK_V1,
   ADD_ESTIMATE_V1,
-  MAX_VALID_TYPE = ADD_ESTIMATE_V1,
+  FILE_CHUNK_V2,
+  MAX_VALID_TYPE = FILE_CHUNK_V2,
   INVALID
 };
 
@@ -428,11 +440,22 @@ class [[nodiscard]] file_metadata {
 // uint64_t     id              file id as established in a FILE_NAME_MAP_V1
 //                              packet
 // uint64_t     chunk_length    file data in the associated data packet length.
+//
+// FILE_CHUNK_V2: as FILE_CHUNK_V1, followed by
+// uint32_t     checksum        CRC32 of the file data in the associated data
+//                              packet, checked by the client before writing it.
 class [[nodiscard]] chunk_metadata {
  public:
   constexpr chunk_metadata(std::uint64_t file_id, uint chunk_size) noexcept
       : m_file_id{file_id}, m_size{chunk_size} {}
 
+  constexpr chunk_metadata(std::uint64_t file_id, uint chunk_size,
+                           std::uint32_t checksum) noexcept
+      : m_file_id{file_id},
+        m_size{chunk_size},
+        m_checksum{checksum},
+        m_has_checksum{true} {}
+
  public:
   [[nodiscard]] constexpr auto get_file_id() const noexcept {
     assert(is_valid());
@@ -444,6 +467,16 @@ class [[nodiscard]] chunk_metadata {
     return m_size;
   }
 
+  [[nodiscard]] constexpr bool has_checksum() const noexcept {
+    assert(is_valid());
+    return m_has_checksum;
+  }
+
+  [[nodiscard]] constexpr auto get_checksum() const noexcept {
+    assert(has_checksum());
+    return m_checksum;
+  }
+
   [[nodiscard]] constexpr bool is_valid() const noexcept {
     return m_file_id != invalid_file_id && m_size != m_invalid_size;
   }
@@ -454,6 +487,8 @@ class [[nodiscard]] chunk_metadata {
  private:
   const std::uint64_t m_file_id;
   const my_off_t m_size;
+  const std::uint32_t m_checksum{0};
+  const bool m_has_checksum{false};
 };
 
 // ADD_ESTIMATE_V1: send the estimate of MyRocks clone data size total. Format:
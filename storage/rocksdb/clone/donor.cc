@@ -20,9 +20,13 @@
 #include <chrono>
 #include <cstdbool>
 #include <cstdint>
+#include <functional>
+#include <set>
 #include <string>
 #include <unordered_map>
+#include <utility>
 
+#include "my_checksum.h"
 #include "my_dbug.h"
 #include "my_io.h"
 #include "mysql/psi/mysql_file.h"
@@ -232,13 +236,17 @@ class [[nodiscard]] donor_chunk_metadata final
     assert(is_valid());
     assert(buf.is_empty());
 
-    static constexpr std::uint32_t payload_length =
-        myrocks::clone::metadata_header::m_length + 16;
-    constexpr myrocks::clone::metadata_header header{
-        payload_length, myrocks::clone::metadata_type::FILE_CHUNK_V1};
+    const std::uint32_t payload_length =
+        myrocks::clone::metadata_header::m_length + 16 +
+        (has_checksum() ? 4 : 0);
+    const myrocks::clone::metadata_header header{
+        payload_length, has_checksum()
+                            ? myrocks::clone::metadata_type::FILE_CHUNK_V2
+                            : myrocks::clone::metadata_type::FILE_CHUNK_V1};
     header.serialize(buf);
     buf.write_uint64(get_file_id());
     buf.write_uint64(get_size());
+    if (has_checksum()) buf.write_uint32(get_checksum());
 
     assert(buf.get_current_pos() == payload_length);
   }
@@ -453,6 +461,13 @@ class [[nodiscard]] donor final : public myrocks::clone::session {
 
   id_metadata_map m_not_started_files;
   id_metadata_map m_in_progress_files;
+
+  // The not started files by the bytes left to send, largest first. The
+  // threads copying in parallel take the largest files first, so that they
+  // end at about the same time instead of one thread being left with a large
+  // file at the end.
+  std::set<std::pair<my_off_t, std::uint64_t>, std::greater<>>
+      m_not_started_by_size;
   id_metadata_map m_completed_files;
 
   std::size_t last_reported_file_count{0};
@@ -523,8 +538,25 @@ class [[nodiscard]] donor final : public myrocks::clone::session {
             std::piecewise_construct, std::forward_as_tuple(id),
             std::forward_as_tuple(id, std::move(name), size));
     assert(not_started_files_res.second);
+    m_not_started_by_size.emplace(size, id);
+  }
+
+  void index_not_started_files() {
+    mysql_mutex_assert_owner(&m_donor_mutex);
+
+    m_not_started_by_size.clear();
+    for (const auto &file : m_not_started_files) {
+      m_not_started_by_size.emplace(
+          file.second.get_size() - file.second.get_sent_offset(), file.first);
+    }
   }
 
+  // Send one chunk read into a buffer of this thread, with its checksum.
+  // Returns MySQL error code.
+  [[nodiscard]] int send_checksummed_chunk(File fd, bool use_direct_io,
+                                           const donor_file_metadata &metadata,
+                                           uint chunk_size, Ha_clone_cbk &cbk);
+
   [[nodiscard]] int add_checkpoint_files(bool final,
                                          std::size_t &total_new_size);
 
@@ -777,8 +809,8 @@ int donor::copy(const THD *thd, uint task_id, Ha_clone_cbk &cbk) {
   while (true) {
     mysql_mutex_lock(&m_donor_mutex);
     assert(m_checkpoint_count > 0);
-    auto not_started_files_itr = m_not_started_files.begin();
-    if (not_started_files_itr == m_not_started_files.end()
+    assert(m_not_started_by_size.size() == m_not_started_files.size());
+    if (m_not_started_by_size.empty()
         // Stop copying the rolling checkpoint if it became final
         ||
         (!final_copy && (m_state == donor_state::FINAL_CHECKPOINT ||
@@ -787,6 +819,11 @@ int donor::copy(const THD *thd, uint task_id, Ha_clone_cbk &cbk) {
       return 0;
     }
 
+    const auto largest_id = m_not_started_by_size.begin()->second;
+    m_not_started_by_size.erase(m_not_started_by_size.begin());
+    auto not_started_files_itr = m_not_started_files.find(largest_id);
+    assert(not_started_files_itr != m_not_started_files.end());
+
     auto &metadata = not_started_files_itr->second;
     move_file_metadata(m_not_started_files, m_in_progress_files,
                        std::move(not_started_files_itr));
@@ -871,6 +908,10 @@ int donor::copy(const THD *thd, uint task_id, Ha_clone_cbk &cbk) {
 
     auto buf_size = cbk.get_client_buffer_size();
     const auto remote_clone = buf_size == 0;
+    // A local clone copies with sendfile() within this host, a remote one
+    // reads the chunks anyway to send them, and checksums them on the way.
+    const auto send_checksums =
+        remote_clone && myrocks::rocksdb_clone_checksums;
 
     cbk.clear_flags();
     if (!use_direct_io) cbk.set_os_buffer_cache();
@@ -891,13 +932,26 @@ int donor::copy(const THD *thd, uint task_id, Ha_clone_cbk &cbk) {
       }
 
       const auto chunk_size = metadata.chunk_size(buf_size);
+
+      DBUG_EXECUTE_IF("myrocks_clone_donor_copy_file_crash", DBUG_SUICIDE(););
+
+      if (send_checksums) {
+        err = send_checksummed_chunk(fd, use_direct_io, metadata, chunk_size,
+                                     cbk);
+        if (err != 0) {
+          save_error(err, donor_file_path, my_errno());
+          mysql_file_close(fd, MYF(MY_WME));
+          return err;
+        }
+        metadata.advance(chunk_size);
+        continue;
+      }
+
       donor_chunk_metadata chunk{metadata.get_id(), chunk_size};
       myrocks::Rdb_string_writer buf;
       chunk.serialize(buf);
       cbk.set_data_desc(buf.ptr(), buf.get_current_pos());
 
-      DBUG_EXECUTE_IF("myrocks_clone_donor_copy_file_crash", DBUG_SUICIDE(););
-
       err = cbk.file_cbk(clone_file, chunk_size);
       if (err != 0) {
         save_error(err, donor_file_path, my_errno());
@@ -954,6 +1008,35 @@ int donor::copy(const THD *thd, uint task_id, Ha_clone_cbk &cbk) {
   }
 }
 
+int donor::send_checksummed_chunk(File fd, bool use_direct_io,
+                                  const donor_file_metadata &metadata,
+                                  uint chunk_size, Ha_clone_cbk &cbk) {
+  auto *const buf = myrocks::clone::thread_io_buffer(chunk_size);
+  if (buf == nullptr) return ER_OUTOFMEMORY;
+
+  // O_DIRECT reads whole blocks, the read of the last block of the file
+  // stopping short at its end
+  uint read_size = 0;
+  while (read_size < chunk_size) {
+    const auto request = use_direct_io
+                             ? myrocks::clone::pad_for_direct_io(
+                                   chunk_size - read_size)
+                             : chunk_size - read_size;
+    const auto ret =
+        mysql_file_read(fd, buf + read_size, request, MYF(MY_WME));
+    if (ret == MY_FILE_ERROR || ret == 0) return ER_ERROR_ON_READ;
+    read_size += static_cast<uint>(ret);
+  }
+  if (read_size != chunk_size) return ER_ERROR_ON_READ;
+
+  const donor_chunk_metadata chunk{metadata.get_id(), chunk_size,
+                                   my_checksum(0, buf, chunk_size)};
+  myrocks::Rdb_string_writer desc;
+  chunk.serialize(desc);
+  cbk.set_data_desc(desc.ptr(), desc.get_current_pos());
+  return cbk.buffer_cbk(buf, chunk_size);
+}
+
 bool donor::restart(const myrocks::clone::locator &restart_locator) {
   mysql_mutex_lock(&m_donor_mutex);
   mysql_cond_signal(&m_reconnection_signal);
@@ -982,6 +1065,7 @@ bool donor::restart(const myrocks::clone::locator &restart_locator) {
       // an obsolete SST from a rolled checkpoint. We don't have enough
       // information to fully confirm this, but do at least some sanity checking
       if (new_file_metadata.get_id() >= m_next_file_id) {
+        index_not_started_files();
         mysql_mutex_unlock(&m_donor_mutex);
         return false;
       }
@@ -996,6 +1080,7 @@ bool donor::restart(const myrocks::clone::locator &restart_locator) {
     auto &file_metadata = itr->second;
 
     if (!file_metadata.reset_state(new_file_metadata)) {
+      index_not_started_files();
       mysql_mutex_unlock(&m_donor_mutex);
       return false;
     }
@@ -1004,6 +1089,7 @@ bool donor::restart(const myrocks::clone::locator &restart_locator) {
       move_file_metadata(m_not_started_files, m_completed_files,
                          std::move(itr));
   }
+  index_not_started_files();
   mysql_mutex_unlock(&m_donor_mutex);
 
   reset_error();
@@ -120,4 +120,9 @@ void Rdb_event_listener::OnBackgroundError(
     rdb_handle_io_error(*status, RDB_IO_ERROR_BG_THREAD);
   }
 }
+
+void Rdb_event_listener::OnStallConditionsChanged(
+    const rocksdb::WriteStallInfo &info) {
+  cf_write_throttle.set_condition(info.cf_name, info.condition.cur);
+}
 }  // namespace myrocks
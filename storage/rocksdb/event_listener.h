@@ -47,6 +47,8 @@ class Rdb_event_listener : public rocksdb::EventListener {
   void OnBackgroundError(rocksdb::BackgroundErrorReason reason,
                          rocksdb::Status *status) override;
 
+  void OnStallConditionsChanged(const rocksdb::WriteStallInfo &info) override;
+
  private:
   Rdb_ddl_manager *m_ddl_manager;
 
@@ -37,12 +37,15 @@
 /* C++ standard header files */
 #include <inttypes.h>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <deque>
 #include <limits>
 #include <map>
 #include <set>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 /* MySQL includes */
@@ -57,8 +60,15 @@
 #include "sql/dd/dd.h"                       //  dd::get_dictionary
 #include "sql/dd/dictionary.h"               // dd::Dictionary
 #include "sql/debug_sync.h"
+#include "sql/histograms/histogram_refresher.h"
+#include "sql/item_cmpfunc.h"
+#include "sql/key.h"
+#include "sql/mysqld.h"  // get_server_state
+#include "sql/query_result_cache.h"
 #include "sql-common/json_dom.h"
+#include "sql/record_buffer.h"
 #include "sql/rpl_rli.h"
+#include "sql/runtime_filter.h"
 #include "sql/sql_audit.h"
 #include "sql/sql_class.h"
 #include "sql/sql_lex.h"
@@ -67,6 +77,7 @@
 #include "sql/sql_thd_internal_api.h"
 #include "sql/strfunc.h"
 #include "sql/next_spatial_base.h"
+#include "sql/resourcegroups/resource_group.h"
 
 /* RocksDB includes */
 #include "monitoring/histogram.h"
@@ -74,6 +85,7 @@
 #include "rocksdb/convenience.h"
 #include "rocksdb/env.h"
 #include "rocksdb/memory_allocator.h"
+#include "rocksdb/perf_context.h"
 #include "rocksdb/perf_level.h"
 #include "rocksdb/persistent_cache.h"
 #include "rocksdb/rate_limiter.h"
@@ -105,18 +117,24 @@
 #include "./rdb_cmd_srv_helper.h"
 #include "./rdb_converter.h"
 #include "./rdb_datadic.h"
+#include "./rdb_fulltext.h"
 #include "./rdb_i_s.h"
 #include "./rdb_index_merge.h"
+#include "./rdb_io_latency.h"
 #include "./rdb_iterator.h"
 #include "./rdb_mutex_wrapper.h"
 #include "./rdb_native_dd.h"
+#include "./rdb_parallel_scan.h"
 #include "./rdb_psi.h"
 #include "./rdb_sst_partitioner_factory.h"
 #include "./rdb_threads.h"
+#include "./rdb_tiered_fs.h"
 #include "./sql_dd.h"
 #include "my_rapidjson_size_t.h"
 
+#include <rapidjson/document.h>
 #include <fstream>
+#include <sstream>
 
 using namespace std::string_view_literals;
 
@@ -126,6 +144,7 @@ static REQUIRES_SERVICE_PLACEHOLDER(mysql_command_query) = nullptr;
 static REQUIRES_SERVICE_PLACEHOLDER(mysql_command_query_result) = nullptr;
 static REQUIRES_SERVICE_PLACEHOLDER(mysql_command_field_info) = nullptr;
 static REQUIRES_SERVICE_PLACEHOLDER(mysql_command_error_info) = nullptr;
+static REQUIRES_SERVICE_PLACEHOLDER(mysql_command_thread) = nullptr;
 static SERVICE_TYPE(registry) *reg_srv = nullptr;
 #ifdef MYSQL_DYNAMIC_PLUGIN
 // MySQL 8.0 logger service interface
@@ -140,6 +159,8 @@ static st_export_stats export_stats;
 static st_memory_stats memory_stats;
 static st_io_stall_stats io_stall_stats;
 Rdb_compaction_stats compaction_stats;
+Rdb_cf_write_throttle cf_write_throttle;
+Rdb_key_access_sampler key_access_sampler;
 
 const std::string DEFAULT_CF_NAME("default");
 const std::string DEFAULT_SYSTEM_CF_NAME("__system__");
@@ -228,6 +249,45 @@ ulonglong Rdb_explicit_snapshot::explicit_snapshot_counter = 0;
 std::unordered_map<ulonglong, std::weak_ptr<Rdb_explicit_snapshot>>
     Rdb_explicit_snapshot::explicit_snapshots;
 
+/**
+  The snapshot shared by the autocommit SELECTs of the sessions that set
+  rocksdb_shared_snapshot_refresh_ms, taken again once older than that, so
+  that they do not each take and release one under the mutex of the DB.
+  It is also taken again when it misses a commit of the session asking,
+  which then reads its own writes.
+*/
+class Rdb_shared_snapshot {
+ public:
+  static std::shared_ptr<rocksdb::ManagedSnapshot> get(
+      rocksdb::DB *db, uint refresh_ms, rocksdb::SequenceNumber min_seq) {
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (snapshot == nullptr ||
+        now - taken >= std::chrono::milliseconds(refresh_ms) ||
+        snapshot->snapshot()->GetSequenceNumber() < min_seq) {
+      // statements still reading the old one keep it alive
+      snapshot = std::make_shared<rocksdb::ManagedSnapshot>(db);
+      taken = now;
+    }
+    return snapshot;
+  }
+
+  /// Drop the reference kept, before the DB is closed.
+  static void release() {
+    std::lock_guard<std::mutex> lock(mutex);
+    snapshot.reset();
+  }
+
+ private:
+  static std::mutex mutex;
+  static std::shared_ptr<rocksdb::ManagedSnapshot> snapshot;
+  static std::chrono::steady_clock::time_point taken;
+};
+
+std::mutex Rdb_shared_snapshot::mutex;
+std::shared_ptr<rocksdb::ManagedSnapshot> Rdb_shared_snapshot::snapshot;
+std::chrono::steady_clock::time_point Rdb_shared_snapshot::taken;
+
 /**
   Updates row counters based on the table type and operation type.
 */
@@ -290,6 +350,9 @@ static rocksdb::HistogramImpl *commit_latency_stats = nullptr;
 
 static std::shared_ptr<rocksdb::Statistics> rocksdb_stats;
 static std::unique_ptr<rocksdb::Env> flashcache_aware_env;
+static std::shared_ptr<Rdb_io_latency_fs> io_latency_fs;
+/* the default Env with the file system wrapped for tiering and timing */
+static std::unique_ptr<rocksdb::Env> wrapped_fs_env;
 static std::shared_ptr<Rdb_tbl_prop_coll_factory> properties_collector_factory;
 
 static Rdb_dict_manager_selector dict_manager;
@@ -314,6 +377,10 @@ static Rdb_manual_compaction_thread rdb_mc_thread;
 
 static Rdb_drop_index_thread rdb_drop_idx_thread;
 
+static Rdb_partial_index_thread rdb_pi_thread;
+
+static Rdb_index_setup_thread rdb_setup_thread;
+
 static std::unique_ptr<Rdb_cmd_srv_helper> cmd_srv_helper;
 
 static const char *rdb_get_error_message(int nr);
@@ -365,6 +432,7 @@ static int rocksdb_delete_column_family(THD *const /* thd */,
   }
 
   if (ret == HA_EXIT_SUCCESS) {
+    rdb_invalidate_table_info(cf_name);
     rdb_drop_idx_thread.signal();
   } else {
     my_error(ER_CANT_DROP_CF, MYF(0), cf);
@@ -446,6 +514,242 @@ int rocksdb_create_checkpoint(std::string_view checkpoint_dir_raw) {
   return HA_EXIT_FAILURE;
 }
 
+/* The last backup checkpoint, the base of the next incremental one */
+static std::mutex rdb_backup_checkpoint_mutex;
+static std::string rdb_backup_checkpoint_dir;
+static ulonglong rdb_backup_checkpoint_id = 0;
+static std::set<std::string> rdb_backup_checkpoint_ssts;
+
+/**
+  Whether the chain of backup checkpoints ending with the checkpoint id in
+  dir is whole: the checkpoint_info.json of each one has the id its
+  successor recorded, and every file of ssts is in one of them. An
+  incremental checkpoint over a broken chain could not be restored.
+*/
+static bool rdb_backup_checkpoint_chain_is_whole(std::string dir,
+                                                 ulonglong id,
+                                                 std::set<std::string> ssts) {
+  for (;;) {
+    const std::string info_path =
+        rdb_concat_paths(dir, "checkpoint_info.json");
+    std::string content;
+    if (!rocksdb::ReadFileToString(rocksdb::Env::Default(), info_path,
+                                   &content)
+             .ok()) {
+      return false;
+    }
+    rapidjson::Document info;
+    info.Parse(content.c_str());
+    if (info.HasParseError() || !info.IsObject()) return false;
+    const auto info_id = info.FindMember("checkpoint_id");
+    if (info_id == info.MemberEnd() || !info_id->value.IsUint64() ||
+        info_id->value.GetUint64() != id) {
+      return false;
+    }
+
+    if (!for_each_in_dir(dir, 0, [&](const fileinfo &f_info) {
+          ssts.erase(f_info.name);
+          return true;
+        })) {
+      return false;
+    }
+
+    const auto base = info.FindMember("base_checkpoint");
+    if (base == info.MemberEnd()) break;
+    const auto base_id = info.FindMember("base_checkpoint_id");
+    // ids grow, so a chain pointing back into itself is broken too
+    if (!base->value.IsString() || base_id == info.MemberEnd() ||
+        !base_id->value.IsUint64() || base_id->value.GetUint64() >= id) {
+      return false;
+    }
+    dir = base->value.GetString();
+    id = base_id->value.GetUint64();
+  }
+  return ssts.empty();
+}
+
+/* Sync the entries of a directory, the files created in it */
+static rocksdb::Status rdb_fsync_dir(const std::string &dir_path) {
+  std::unique_ptr<rocksdb::Directory> dir;
+  const rocksdb::Status s =
+      rocksdb::Env::Default()->NewDirectory(dir_path, &dir);
+  return s.ok() ? dir->Fsync() : s;
+}
+
+/**
+  Read the binlog position the checkpoint is consistent with from its own
+  data dictionary, opening its default and system column families read only.
+*/
+static bool rdb_read_checkpoint_binlog_pos(const std::string &checkpoint_dir,
+                                           char *const binlog_name,
+                                           my_off_t *const binlog_pos,
+                                           char *const binlog_gtid) {
+  auto *const system_cf =
+      dict_manager.get_dict_manager_selector_const(false /*is_tmp_table*/)
+          ->get_system_cf();
+  const std::vector<rocksdb::ColumnFamilyDescriptor> cf_descs{
+      {rocksdb::kDefaultColumnFamilyName,
+       rdb->GetOptions(rdb->DefaultColumnFamily())},
+      {system_cf->GetName(), rdb->GetOptions(system_cf)}};
+
+  rocksdb::DBOptions db_options = rdb->GetDBOptions();
+  db_options.wal_dir = checkpoint_dir;
+  db_options.listeners.clear();
+  db_options.sst_file_manager.reset();
+
+  std::vector<rocksdb::ColumnFamilyHandle *> cf_handles;
+  rocksdb::DB *db = nullptr;
+  const rocksdb::Status s = rocksdb::DB::OpenForReadOnly(
+      db_options, checkpoint_dir, cf_descs, &cf_handles, &db);
+  if (!s.ok()) {
+    rdb_log_status_error(s, "Failed to open checkpoint for binlog position");
+    return false;
+  }
+
+  const bool found = binlog_manager.read(db, cf_handles[1], binlog_name,
+                                         binlog_pos, binlog_gtid);
+  for (auto *const cf_handle : cf_handles) {
+    db->DestroyColumnFamilyHandle(cf_handle);
+  }
+  delete db;
+  return found;
+}
+
+/**
+  Create a checkpoint for a backup. Besides the RocksDB checkpoint it holds
+  the table_options files get_table_info() reads and checkpoint_info.json,
+  with the binlog position and GTID the checkpoint is consistent with. The
+  info file is synced with its directory, so a checkpoint that has one is
+  complete.
+
+  An incremental checkpoint leaves out the SST files of the previous backup
+  checkpoint, all of them immutable: it is restored over the previous one.
+  Its info file names the previous one and its checkpoint_id, so that a
+  restore can refuse a chain with a missing or replaced link. It is refused
+  here when the chain is already broken.
+*/
+static int rdb_create_backup_checkpoint(std::string_view checkpoint_dir_raw,
+                                        bool incremental) {
+  const auto checkpoint_dir =
+      std::string{rdb_normalize_dir(checkpoint_dir_raw)};
+  std::lock_guard<std::mutex> lock(rdb_backup_checkpoint_mutex);
+
+  if (incremental && rdb_backup_checkpoint_dir.empty()) {
+    my_printf_error(ER_UNKNOWN_ERROR,
+                    "No previous checkpoint for an incremental checkpoint",
+                    MYF(0));
+    return HA_EXIT_FAILURE;
+  }
+  if (incremental &&
+      !rdb_backup_checkpoint_chain_is_whole(rdb_backup_checkpoint_dir,
+                                            rdb_backup_checkpoint_id,
+                                            rdb_backup_checkpoint_ssts)) {
+    my_printf_error(ER_UNKNOWN_ERROR,
+                    "The checkpoints an incremental checkpoint would be "
+                    "restored over, from %s on, are missing files or were "
+                    "replaced. Create a full checkpoint.",
+                    MYF(0), rdb_backup_checkpoint_dir.c_str());
+    return HA_EXIT_FAILURE;
+  }
+  const ulonglong checkpoint_id =
+      std::max<ulonglong>(my_micro_time(), rdb_backup_checkpoint_id + 1);
+
+  if (rocksdb_create_checkpoint(checkpoint_dir) != HA_EXIT_SUCCESS) {
+    return HA_EXIT_FAILURE;
+  }
+
+  const std::string table_options_dir =
+      rdb_concat_paths(rocksdb_datadir, "table_options");
+  if (my_access(table_options_dir.c_str(), F_OK) == 0) {
+    const std::string to_dir =
+        rdb_concat_paths(checkpoint_dir, "table_options");
+    if (my_mkdir(to_dir.c_str(), 0777, MYF(MY_WME)) != 0 ||
+        !for_each_in_dir(table_options_dir, 0, [&](const fileinfo &f_info) {
+          const std::string_view fn{f_info.name};
+          if (!has_file_extension(fn, ".json")) return true;
+          return my_copy(rdb_concat_paths(table_options_dir, fn).c_str(),
+                         rdb_concat_paths(to_dir, fn).c_str(),
+                         MYF(MY_WME | MY_SYNC)) == 0;
+        })) {
+      return HA_EXIT_FAILURE;
+    }
+    const rocksdb::Status s = rdb_fsync_dir(to_dir);
+    if (!s.ok()) {
+      rdb_log_status_error(s, "Failed to sync the checkpoint table_options");
+      my_error(ER_ERROR_ON_WRITE, MYF(0), to_dir.c_str(), errno);
+      return HA_EXIT_FAILURE;
+    }
+  }
+
+  char binlog_name[FN_REFLEN + 1] = {0};
+  my_off_t binlog_pos = 0;
+  char binlog_gtid[FN_REFLEN + 1] = {0};
+  const bool has_binlog_pos = rdb_read_checkpoint_binlog_pos(
+      checkpoint_dir, binlog_name, &binlog_pos, binlog_gtid);
+
+  std::set<std::string> ssts;
+  std::vector<std::string> base_ssts;
+  if (!for_each_in_dir(checkpoint_dir, 0, [&](const fileinfo &f_info) {
+        std::string fn{f_info.name};
+        if (!has_file_extension(fn, ".sst")) return true;
+        if (incremental && rdb_backup_checkpoint_ssts.count(fn) != 0) {
+          if (my_delete(rdb_concat_paths(checkpoint_dir, fn).c_str(),
+                        MYF(MY_WME)) != 0)
+            return false;
+          base_ssts.push_back(fn);
+        }
+        ssts.insert(std::move(fn));
+        return true;
+      })) {
+    return HA_EXIT_FAILURE;
+  }
+
+  std::ostringstream info_file;
+  info_file << "{\n";
+  info_file << "  \"checkpoint_id\": " << checkpoint_id << ",\n";
+  if (has_binlog_pos) {
+    info_file << "  \"binlog_file\": \"" << binlog_name << "\",\n";
+    info_file << "  \"binlog_pos\": " << binlog_pos << ",\n";
+    info_file << "  \"gtid\": \"" << binlog_gtid << "\",\n";
+  }
+  if (incremental) {
+    info_file << "  \"base_checkpoint\": \"" << rdb_backup_checkpoint_dir
+              << "\",\n";
+    info_file << "  \"base_checkpoint_id\": " << rdb_backup_checkpoint_id
+              << ",\n";
+    info_file << "  \"base_files\": [";
+    for (size_t i = 0; i < base_ssts.size(); i++) {
+      info_file << (i > 0 ? ", " : "") << "\"" << base_ssts[i] << "\"";
+    }
+    info_file << "],\n";
+  }
+  info_file << "  \"incremental\": " << (incremental ? "true" : "false")
+            << "\n";
+  info_file << "}\n";
+
+  const std::string info_path =
+      rdb_concat_paths(checkpoint_dir, "checkpoint_info.json");
+  rocksdb::Status s = rocksdb::WriteStringToFile(
+      rocksdb::Env::Default(), info_file.str(), info_path, true);
+  if (s.ok()) s = rdb_fsync_dir(checkpoint_dir);
+  if (!s.ok()) {
+    rdb_log_status_error(s, "Failed to write the checkpoint info");
+    my_error(ER_ERROR_ON_WRITE, MYF(0), info_path.c_str(), errno);
+    return HA_EXIT_FAILURE;
+  }
+
+  rdb_backup_checkpoint_dir = checkpoint_dir;
+  rdb_backup_checkpoint_id = checkpoint_id;
+  rdb_backup_checkpoint_ssts = std::move(ssts);
+
+  LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
+                  "created %s backup checkpoint in directory: %s, binlog "
+                  "position %s:%llu\n",
+                  incremental ? "incremental" : "full", checkpoint_dir.c_str(),
+                  binlog_name, static_cast<ulonglong>(binlog_pos));
+  return HA_EXIT_SUCCESS;
+}
+
 static int rocksdb_create_checkpoint_validate(
     THD *const thd MY_ATTRIBUTE((__unused__)),
     struct SYS_VAR *const var MY_ATTRIBUTE((__unused__)),
@@ -455,7 +759,21 @@ static int rocksdb_create_checkpoint_validate(
   int len = sizeof(buf);
   const char *const checkpoint_dir_raw = value->val_str(value, buf, &len);
   if (checkpoint_dir_raw) {
-    return rocksdb_create_checkpoint(checkpoint_dir_raw);
+    return rdb_create_backup_checkpoint(checkpoint_dir_raw, false);
+  }
+  return HA_EXIT_FAILURE;
+}
+
+static int rocksdb_create_incremental_checkpoint_validate(
+    THD *const thd MY_ATTRIBUTE((__unused__)),
+    struct SYS_VAR *const var MY_ATTRIBUTE((__unused__)),
+    void *const save MY_ATTRIBUTE((__unused__)),
+    struct st_mysql_value *const value) {
+  char buf[FN_REFLEN];
+  int len = sizeof(buf);
+  const char *const checkpoint_dir_raw = value->val_str(value, buf, &len);
+  if (checkpoint_dir_raw) {
+    return rdb_create_backup_checkpoint(checkpoint_dir_raw, true);
   }
   return HA_EXIT_FAILURE;
 }
@@ -488,6 +806,14 @@ static void rocksdb_select_bypass_rejected_query_history_size_update(
     my_core::THD *const thd, my_core::SYS_VAR *const /* unused */,
     void *const var_ptr, const void *const save);
 
+static void rocksdb_vector_value_cache_size_update(
+    my_core::THD *const thd, my_core::SYS_VAR *const /* unused */,
+    void *const var_ptr, const void *const save);
+
+static void rocksdb_vector_list_cache_size_update(
+    my_core::THD *const thd, my_core::SYS_VAR *const /* unused */,
+    void *const var_ptr, const void *const save);
+
 static int delete_range(const std::unordered_set<GL_INDEX_ID> &indices);
 
 static int rocksdb_force_flush_memtable_now(
@@ -801,6 +1127,7 @@ static unsigned long long  // NOLINT(runtime/int)
 static unsigned long long  // NOLINT(runtime/int)
     rocksdb_sst_mgr_rate_bytes_per_sec;
 static uint32_t rocksdb_max_latest_deadlocks;
+static uint32_t rocksdb_lock_stripes;
 static unsigned long  // NOLINT(runtime/int)
     rocksdb_persistent_cache_size_mb;
 static ulong rocksdb_info_log_level;
@@ -809,6 +1136,7 @@ static char *rocksdb_persistent_cache_path;
 static char *rocksdb_wsenv_path;
 static char *rocksdb_wsenv_tenant;
 static char *rocksdb_wsenv_oncall;
+static char *rocksdb_cold_data_dir;
 static bool rocksdb_use_io_uring;
 static ulong rocksdb_index_type;
 static uint32_t rocksdb_flush_log_at_trx_commit;
@@ -821,8 +1149,10 @@ static uint32_t rocksdb_wal_recovery_mode;
 static bool rocksdb_track_and_verify_wals_in_manifest;
 static uint32_t rocksdb_stats_level;
 static char *rocksdb_compact_cf_name;
+static char *rocksdb_vector_index_retrain_name;
 static char *rocksdb_delete_cf_name;
 static char *rocksdb_checkpoint_name;
+static char *rocksdb_incremental_checkpoint_name;
 static char *rocksdb_block_cache_trace_options_str;
 static char *rocksdb_trace_options_str;
 static bool rocksdb_signal_drop_index_thread;
@@ -850,6 +1180,11 @@ static uint64_t rocksdb_compaction_sequential_deletes = 0;
 static uint64_t rocksdb_compaction_sequential_deletes_window = 0;
 static long long rocksdb_compaction_sequential_deletes_file_size = 0LL;
 static uint32_t rocksdb_validate_tables = 1;
+static bool rocksdb_ddl_snapshot = true;
+static uint32_t rocksdb_perf_context_sample_rate = 0;
+static uint32_t rocksdb_perf_context_sample_level =
+    rocksdb::PerfLevel::kEnableTimeExceptForMutex;
+static char *rocksdb_perf_context_sample_statements = nullptr;
 char *rocksdb_datadir;
 static int rocksdb_max_bottom_pri_background_compactions = 0;
 static int rocksdb_block_cache_numshardbits = -1;
@@ -891,6 +1226,10 @@ static bool rocksdb_enable_insert_with_update_caching = true;
 /* Use unsigned long long instead of uint64_t because of MySQL compatibility */
 static unsigned long long  // NOLINT(runtime/int)
     rocksdb_max_compaction_history = 0;
+static unsigned long long  // NOLINT(runtime/int)
+    rocksdb_vector_value_cache_size = 0;
+static unsigned long long  // NOLINT(runtime/int)
+    rocksdb_vector_list_cache_size = 0;
 static ulong rocksdb_select_bypass_policy =
     select_bypass_policy_type::default_value;
 static bool rocksdb_select_bypass_fail_unsupported = true;
@@ -909,6 +1248,8 @@ static bool rocksdb_alter_column_default_inplace = false;
 static bool rocksdb_alter_table_comment_inplace = false;
 static bool rocksdb_partial_index_blind_delete = true;
 bool rocksdb_partial_index_ignore_killed = true;
+bool rocksdb_partial_index_materialize_in_background = false;
+static ulong rocksdb_partial_index_materialize_rate = 0;
 bool rocksdb_disable_instant_ddl = false;
 bool rocksdb_enable_instant_ddl = false;
 bool rocksdb_enable_instant_ddl_for_append_column = false;
@@ -918,10 +1259,27 @@ bool rocksdb_enable_instant_ddl_for_drop_index_changes = false;
 bool rocksdb_enable_instant_ddl_for_update_index_visibility = false;
 bool rocksdb_enable_tmp_table = false;
 bool rocksdb_enable_delete_range_for_drop_index = false;
+uint rocksdb_vector_rerank_factor = 4;
+uint rocksdb_vector_result_cache_entries = 0;
+static unsigned long long rocksdb_vector_list_partition_size = 16 << 20;
+static uint rocksdb_vector_index_setup_threads = 0;
+static uint rocksdb_ft_min_token_size = 3;
+static uint rocksdb_ft_max_token_size = 84;
+static bool rocksdb_cf_write_throttle = false;
+static uint rocksdb_cf_write_throttle_delay_us = 100;
+static uint rocksdb_cf_write_throttle_max_wait_ms = 1000;
+static uint rocksdb_key_access_sample_rate = 0;
 uint rocksdb_clone_checkpoint_max_age;
 uint rocksdb_clone_checkpoint_max_count;
+bool rocksdb_clone_checksums = true;
 unsigned long long rocksdb_converter_record_cached_length = 0;
+static unsigned long long rocksdb_write_batch_cached_length = 4 * 1024 * 1024;
 static bool rocksdb_debug_skip_bloom_filter_check_on_iterator_bounds = 0;
+static bool rocksdb_skip_unwritten_index_merge = false;
+static bool rocksdb_write_set_shared_index_entries = true;
+static uint rocksdb_scan_batch_rows = 1024;
+static bool rocksdb_io_latency_histograms = true;
+unsigned long long rocksdb_slow_io_threshold_us = 100000;
 bool rocksdb_enable_autoinc_compact_mode = false;
 char max_timestamp_uint64[ROCKSDB_SIZEOF_TTL_RECORD];
 
@@ -958,6 +1316,8 @@ std::atomic<uint64_t> rocksdb_partial_index_groups_sorted(0);
 std::atomic<uint64_t> rocksdb_partial_index_groups_materialized(0);
 std::atomic<uint64_t> rocksdb_partial_index_rows_sorted(0);
 std::atomic<uint64_t> rocksdb_partial_index_rows_materialized(0);
+std::atomic<uint64_t> rocksdb_partial_index_groups_queued(0);
+std::atomic<uint64_t> rocksdb_partial_index_groups_stale(0);
 
 // RocksDB contracts
 extern "C" {
@@ -1211,6 +1571,15 @@ static TYPELIB bottommost_level_compaction_typelib = {
     "bottommost_level_compaction_typelib", bottommost_level_compaction_names,
     nullptr};
 
+/* How the rankings of a hybrid vector and fulltext ORDER BY are fused */
+enum vector_text_fusion_type : ulong { VECTOR_TEXT_WEIGHTED, VECTOR_TEXT_RRF };
+
+static const char *vector_text_fusion_names[] = {"WEIGHTED", "RRF", NullS};
+
+static TYPELIB vector_text_fusion_typelib = {
+    array_elements(vector_text_fusion_names) - 1, "vector_text_fusion_typelib",
+    vector_text_fusion_names, nullptr};
+
 /* This enum needs to be kept up to date with corrupt_data_action */
 static const char *corrupt_data_action_names[] = {"ERROR", "ABORT_SERVER",
                                                   "WARNING", NullS};
@@ -1380,6 +1749,13 @@ static int rocksdb_compact_column_family(THD *const thd,
                                          void *const var_ptr,
                                          struct st_mysql_value *const value);
 
+static int rocksdb_retrain_vector_index(THD *const thd,
+                                        struct SYS_VAR *const var,
+                                        void *const var_ptr,
+                                        struct st_mysql_value *const value);
+
+static bool rdb_has_vector_list_writes(THD *const thd, Index_id index_id);
+
 static const char *index_type_names[] = {"kBinarySearch", "kHashSearch", NullS};
 
 static TYPELIB index_type_typelib = {array_elements(index_type_names) - 1,
@@ -1393,6 +1769,10 @@ static constexpr ulong RDB_DEFAULT_BULK_LOAD_SIZE = 1000;
 static constexpr ulong RDB_MAX_BULK_LOAD_SIZE = 1024 * 1024 * 1024;
 static constexpr size_t RDB_DEFAULT_MERGE_BUF_SIZE = 64 * 1024 * 1024;
 static constexpr size_t RDB_MIN_MERGE_BUF_SIZE = 100;
+// rows whose vectors are assigned together when a vector index is built
+static constexpr size_t RDB_VECTOR_POPULATE_BATCH_SIZE = 4096;
+// rows of a bulk insert whose vectors are assigned together
+static constexpr size_t RDB_VECTOR_INSERT_BATCH_SIZE = 1024;
 static constexpr size_t RDB_DEFAULT_MERGE_COMBINE_READ_SIZE =
     1024 * 1024 * 1024;
 static constexpr size_t RDB_MIN_MERGE_COMBINE_READ_SIZE = 100;
@@ -1404,6 +1784,7 @@ static constexpr int RDB_MAX_CHECKSUMS_PCT = 100;
 static constexpr ulong RDB_DEADLOCK_DETECT_DEPTH = 50;
 static constexpr ulonglong RDB_DEFAULT_MAX_COMPACTION_HISTORY = 64;
 static constexpr ulong ROCKSDB_MAX_MRR_BATCH_SIZE = 1000;
+static constexpr ulong ROCKSDB_MAX_PARALLEL_SCAN_THREADS = 256;
 static constexpr int ROCKSDB_MAX_BOTTOM_PRI_BACKGROUND_COMPACTIONS = 64;
 
 // TODO: 0 means don't wait at all, and we don't support it yet?
@@ -1814,6 +2195,13 @@ static MYSQL_SYSVAR_UINT(max_latest_deadlocks, rocksdb_max_latest_deadlocks,
                          nullptr, rocksdb_set_max_latest_deadlocks,
                          rocksdb::kInitialMaxDeadlocks, 0, UINT32_MAX, 0);
 
+static MYSQL_SYSVAR_UINT(
+    lock_stripes, rocksdb_lock_stripes,
+    PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+    "TransactionDBOptions::num_stripes, the stripes of the row lock map of "
+    "each column family. 0 sizes it from the number of CPUs",
+    nullptr, nullptr, 0, /* min */ 0, /* max */ 1 << 16, 0);
+
 static MYSQL_SYSVAR_ENUM(
     info_log_level, rocksdb_info_log_level, PLUGIN_VAR_RQCMDARG,
     "Filter level for info logs to be written mysqld error log. "
@@ -1830,6 +2218,40 @@ static MYSQL_THDVAR_INT(
     /* min */ rocksdb::PerfLevel::kUninitialized,
     /* max */ rocksdb::PerfLevel::kOutOfBounds - 1, 0);
 
+static MYSQL_SYSVAR_UINT(
+    perf_context_sample_rate, rocksdb_perf_context_sample_rate,
+    PLUGIN_VAR_RQCMDARG,
+    "Collect the perf context of one in this many statements at "
+    "rocksdb_perf_context_sample_level. 0 samples no statements by rate.",
+    nullptr, nullptr, /* default */ 0, /* min */ 0, /* max */ UINT_MAX, 0);
+
+static MYSQL_SYSVAR_UINT(
+    perf_context_sample_level, rocksdb_perf_context_sample_level,
+    PLUGIN_VAR_RQCMDARG,
+    "Perf Context Level of the statements sampled by "
+    "rocksdb_perf_context_sample_rate and "
+    "rocksdb_perf_context_sample_statements",
+    nullptr, nullptr,
+    /* default */ rocksdb::PerfLevel::kEnableTimeExceptForMutex,
+    /* min */ rocksdb::PerfLevel::kDisable,
+    /* max */ rocksdb::PerfLevel::kOutOfBounds - 1, 0);
+
+static void rocksdb_set_perf_context_sample_statements(
+    THD *const thd MY_ATTRIBUTE((__unused__)),
+    struct SYS_VAR *const var MY_ATTRIBUTE((__unused__)),
+    void *const var_ptr, const void *const save) {
+  const auto list = *static_cast<char *const *>(save);
+  rdb_set_perf_context_sample_statements(list);
+  *static_cast<char **>(var_ptr) = list;
+}
+
+static MYSQL_SYSVAR_STR(
+    perf_context_sample_statements, rocksdb_perf_context_sample_statements,
+    PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_MEMALLOC,
+    "Comma separated statement digests and query_info query types whose "
+    "perf context is collected at rocksdb_perf_context_sample_level",
+    nullptr, rocksdb_set_perf_context_sample_statements, "");
+
 static MYSQL_SYSVAR_UINT(
     wal_recovery_mode, rocksdb_wal_recovery_mode, PLUGIN_VAR_RQCMDARG,
     "DBOptions::wal_recovery_mode for RocksDB. Default is kPointInTimeRecovery",
@@ -1869,6 +2291,16 @@ static MYSQL_SYSVAR_BOOL(
     "DBOptions::allow_concurrent_memtable_write for RocksDB", nullptr, nullptr,
     false);
 
+static MYSQL_SYSVAR_BOOL(
+    enable_pipelined_write,
+    *reinterpret_cast<bool *>(&rocksdb_db_options->enable_pipelined_write),
+    PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+    "DBOptions::enable_pipelined_write for RocksDB. Pipelined writes do "
+    "not work with rocksdb_two_write_queues: with rocksdb_write_policy "
+    "WRITE_COMMITTED, rocksdb_two_write_queues is turned off, otherwise "
+    "pipelined writes are. Either is logged as a warning",
+    nullptr, nullptr, rocksdb_db_options->enable_pipelined_write);
+
 static MYSQL_SYSVAR_BOOL(
     enable_write_thread_adaptive_yield,
     *reinterpret_cast<bool *>(
@@ -1936,6 +2368,15 @@ static MYSQL_SYSVAR_STR(wsenv_oncall, rocksdb_wsenv_oncall,
                         PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
                         "Oncall for RocksDB WSEnv", nullptr, nullptr, "");
 
+static MYSQL_SYSVAR_STR(
+    cold_data_dir, rocksdb_cold_data_dir,
+    PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+    "Absolute path of the directory for the SST files of a cold temperature, "
+    "linked from the data directory. A column family sends its last level "
+    "there with last_level_temperature=kCold in rocksdb_override_cf_options. "
+    "Empty keeps all files in the data directory.",
+    nullptr, nullptr, "");
+
 static MYSQL_SYSVAR_UINT64_T(
     delete_obsolete_files_period_micros,
     rocksdb_db_options->delete_obsolete_files_period_micros,
@@ -2311,6 +2752,14 @@ static MYSQL_THDVAR_BOOL(write_disable_wal, PLUGIN_VAR_RQCMDARG,
                          "WriteOptions::disableWAL for RocksDB", nullptr,
                          nullptr, rocksdb::WriteOptions().disableWAL);
 
+static MYSQL_THDVAR_BOOL(
+    async_commit, PLUGIN_VAR_RQCMDARG,
+    "Commit without syncing the WAL when the connection handler can defer "
+    "the OK packet, which is sent once a WAL sync shared by the commits "
+    "meanwhile makes the commit durable. Other sessions may read the rows "
+    "of the commit before that",
+    nullptr, nullptr, false);
+
 static MYSQL_THDVAR_BOOL(
     write_ignore_missing_column_families, PLUGIN_VAR_RQCMDARG,
     "WriteOptions::ignore_missing_column_families for RocksDB", nullptr,
@@ -2325,6 +2774,24 @@ static MYSQL_THDVAR_BOOL(skip_fill_cache, PLUGIN_VAR_RQCMDARG,
                          "Skip filling block cache on read requests", nullptr,
                          nullptr, false);
 
+static MYSQL_THDVAR_ULONGLONG(
+    large_scan_rows, PLUGIN_VAR_RQCMDARG,
+    "Scans the optimizer expects to read at least this many rows use "
+    "rocksdb_large_scan_readahead_size and async prefetching, and skip the "
+    "block cache with rocksdb_large_scan_skip_fill_cache. 0 disables it",
+    nullptr, nullptr, /* default */ 0, /* min */ 0, /* max */ ULLONG_MAX, 0);
+
+static MYSQL_THDVAR_ULONG(large_scan_readahead_size, PLUGIN_VAR_RQCMDARG,
+                          "ReadOptions::readahead_size of large scans, see "
+                          "rocksdb_large_scan_rows",
+                          nullptr, nullptr, /* default */ 2 * 1024 * 1024,
+                          /* min */ 0, /* max */ 1024 * 1024 * 1024, 0);
+
+static MYSQL_THDVAR_BOOL(large_scan_skip_fill_cache, PLUGIN_VAR_RQCMDARG,
+                         "Skip filling block cache on large scans, see "
+                         "rocksdb_large_scan_rows",
+                         nullptr, nullptr, true);
+
 static MYSQL_THDVAR_BOOL(
     unsafe_for_binlog, PLUGIN_VAR_RQCMDARG,
     "Allowing statement based binary logging which may break consistency",
@@ -2342,6 +2809,14 @@ static MYSQL_THDVAR_UINT(force_index_records_in_range, PLUGIN_VAR_RQCMDARG,
                          nullptr, nullptr, 0,
                          /* min */ 0, /* max */ INT_MAX, 0);
 
+static MYSQL_THDVAR_UINT(
+    shared_snapshot_refresh_ms, PLUGIN_VAR_RQCMDARG,
+    "Autocommit SELECTs without locking reads read from a snapshot shared "
+    "by the sessions, taken again once older than this many milliseconds, "
+    "rather than taking one of their own. They may then miss the changes "
+    "committed since. 0 disables",
+    nullptr, nullptr, 0, /* min */ 0, /* max */ 1000, 0);
+
 static MYSQL_SYSVAR_UINT(
     debug_optimizer_n_rows, rocksdb_debug_optimizer_n_rows,
     PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY | PLUGIN_VAR_NOSYSVAR,
@@ -2379,6 +2854,13 @@ static MYSQL_SYSVAR_STR(compact_cf, rocksdb_compact_cf_name,
                         rocksdb_compact_column_family,
                         rocksdb_rw_sysvar_update_noop, "");
 
+static MYSQL_SYSVAR_STR(vector_index_retrain,
+                        rocksdb_vector_index_retrain_name, PLUGIN_VAR_RQCMDARG,
+                        "Retrain the centroids of an ivfflat vector index "
+                        "online. The index is given as db.table.index",
+                        rocksdb_retrain_vector_index,
+                        rocksdb_rw_sysvar_update_noop, "");
+
 static MYSQL_SYSVAR_STR(delete_cf, rocksdb_delete_cf_name, PLUGIN_VAR_RQCMDARG,
                         "Delete column family", rocksdb_delete_column_family,
                         rocksdb_rw_sysvar_update_noop, "");
@@ -2388,6 +2870,13 @@ static MYSQL_SYSVAR_STR(create_checkpoint, rocksdb_checkpoint_name,
                         rocksdb_create_checkpoint_validate,
                         rocksdb_rw_sysvar_update_noop, "");
 
+static MYSQL_SYSVAR_STR(
+    create_incremental_checkpoint, rocksdb_incremental_checkpoint_name,
+    PLUGIN_VAR_RQCMDARG,
+    "Checkpoint directory, without the SST files of the previous checkpoint",
+    rocksdb_create_incremental_checkpoint_validate,
+    rocksdb_rw_sysvar_update_noop, "");
+
 static MYSQL_THDVAR_STR(create_temporary_checkpoint,
                         PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_MEMALLOC |
                             PLUGIN_VAR_NOCMDOPT,
@@ -2630,6 +3119,13 @@ static MYSQL_SYSVAR_UINT(
     nullptr, nullptr, 1 /* default value */, 0 /* min value */,
     2 /* max value */, 0);
 
+static MYSQL_SYSVAR_BOOL(
+    ddl_snapshot, rocksdb_ddl_snapshot,
+    PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+    "Write the table definitions to a snapshot at clean shutdown and load "
+    "them from it at startup when nothing changed since",
+    nullptr, nullptr, true);
+
 static MYSQL_SYSVAR_STR(datadir, rocksdb_datadir,
                         PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
                         "RocksDB data directory", nullptr, nullptr,
@@ -2846,6 +3342,36 @@ static MYSQL_THDVAR_ULONG(mrr_batch_size, PLUGIN_VAR_RQCMDARG,
                           nullptr, nullptr, /* default */ 100, /* min */ 0,
                           /* max */ ROCKSDB_MAX_MRR_BATCH_SIZE, 0);
 
+static MYSQL_THDVAR_BOOL(
+    mrr_async_io, PLUGIN_VAR_RQCMDARG,
+    "Read the next batch of MRR rows with an async MultiGet while the "
+    "current batch is returned, for non-locking SELECTs",
+    nullptr, nullptr, false);
+
+static MYSQL_THDVAR_ULONG(
+    parallel_scan_threads, PLUGIN_VAR_RQCMDARG,
+    "Number of threads non-locking COUNT(*) and parallel scans read an index "
+    "with, in pieces split at the SST file boundaries of the index",
+    nullptr, nullptr, /* default */ 1, /* min */ 1,
+    /* max */ ROCKSDB_MAX_PARALLEL_SCAN_THREADS, 0);
+
+static MYSQL_THDVAR_ULONG(
+    index_build_threads, PLUGIN_VAR_RQCMDARG,
+    "Number of threads inplace secondary index creation scans the primary "
+    "key, sorts the entries and writes the SST files with. Each thread "
+    "allocates its own sort buffers of rocksdb_merge_buf_size",
+    nullptr, nullptr, /* default */ 1, /* min */ 1,
+    /* max */ ROCKSDB_MAX_PARALLEL_SCAN_THREADS, 0);
+
+static MYSQL_THDVAR_ULONG(
+    bulk_load_threads, PLUGIN_VAR_RQCMDARG,
+    "Number of threads the end of a bulk load writes the SST files of each "
+    "index it sorted with, i.e. of the primary key with "
+    "rocksdb_bulk_load_allow_unsorted and of the secondary, vector and "
+    "spatial indexes with rocksdb_bulk_load_allow_sk",
+    nullptr, nullptr, /* default */ 1, /* min */ 1,
+    /* max */ ROCKSDB_MAX_PARALLEL_SCAN_THREADS, 0);
+
 static MYSQL_SYSVAR_BOOL(skip_locks_if_skip_unique_check,
                          rocksdb_skip_locks_if_skip_unique_check,
                          PLUGIN_VAR_RQCMDARG,
@@ -2882,6 +3408,22 @@ static MYSQL_SYSVAR_BOOL(
     "problem.",
     nullptr, nullptr, true);
 
+static MYSQL_SYSVAR_BOOL(
+    partial_index_materialize_in_background,
+    rocksdb_partial_index_materialize_in_background, PLUGIN_VAR_RQCMDARG,
+    "If ON, a group of a partial index over the threshold is queued for a "
+    "background thread to materialize, and the reader goes on with the rows "
+    "it sorted instead of materializing the group itself. Tables with TTL "
+    "are always materialized by the reader.",
+    nullptr, nullptr, false);
+
+static MYSQL_SYSVAR_ULONG(
+    partial_index_materialize_rate, rocksdb_partial_index_materialize_rate,
+    PLUGIN_VAR_RQCMDARG,
+    "Rows per second the background thread materializes partial index groups "
+    "at most. 0 means no limit.",
+    nullptr, nullptr, /* default */ 0, /* min */ 0, /* max */ ULONG_MAX, 0);
+
 static MYSQL_SYSVAR_BOOL(
     disable_instant_ddl, rocksdb_disable_instant_ddl, PLUGIN_VAR_RQCMDARG,
     "Disable instant ddl during alter table, This variable is deprecated",
@@ -2968,6 +3510,12 @@ static MYSQL_SYSVAR_UINT(clone_checkpoint_max_count,
                          "clone operation. If 0, the number is unlimited.",
                          nullptr, nullptr, 90, 0, UINT_MAX, 0);
 
+static MYSQL_SYSVAR_BOOL(
+    clone_checksums, rocksdb_clone_checksums, PLUGIN_VAR_RQCMDARG,
+    "Send a checksum with each file chunk of a remote clone, checked by the "
+    "recipient as it writes the chunk",
+    nullptr, nullptr, true);
+
 static MYSQL_SYSVAR_ULONGLONG(
     converter_record_cached_length, rocksdb_converter_record_cached_length,
     PLUGIN_VAR_RQCMDARG,
@@ -2976,6 +3524,31 @@ static MYSQL_SYSVAR_ULONGLONG(
     nullptr, nullptr, /* default */ rocksdb_converter_record_cached_length,
     /* min */ 0, /* max */ UINT64_MAX, 0);
 
+static MYSQL_SYSVAR_ULONGLONG(
+    write_batch_cached_length, rocksdb_write_batch_cached_length,
+    PLUGIN_VAR_RQCMDARG,
+    "Maximum size in bytes of a write batch a connection keeps for its next "
+    "transaction. Larger ones are freed at commit or rollback. 0 means no "
+    "limit.",
+    nullptr, nullptr, /* default */ rocksdb_write_batch_cached_length,
+    /* min */ 0, /* max */ UINT64_MAX, 0);
+
+static MYSQL_SYSVAR_BOOL(
+    io_latency_histograms, rocksdb_io_latency_histograms,
+    PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+    "Time the reads, writes and syncs of the RocksDB files into latency "
+    "histograms per device, shown in "
+    "information_schema.rocksdb_io_latency",
+    nullptr, nullptr, true);
+
+static MYSQL_SYSVAR_ULONGLONG(
+    slow_io_threshold_us, rocksdb_slow_io_threshold_us, PLUGIN_VAR_RQCMDARG,
+    "I/O to a RocksDB file taking at least this many microseconds is counted "
+    "as slow and its file shown in information_schema.rocksdb_slow_io. 0 "
+    "turns this off.",
+    nullptr, nullptr, /* default */ rocksdb_slow_io_threshold_us,
+    /* min */ 0, /* max */ UINT64_MAX, 0);
+
 static MYSQL_SYSVAR_ENUM(
     file_checksums, rocksdb_file_checksums,
     PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
@@ -2994,16 +3567,166 @@ static MYSQL_SYSVAR_BOOL(
     "conditions would otherwise allow bloom filters to be used.",
     nullptr, nullptr, false);
 
+static MYSQL_SYSVAR_BOOL(
+    skip_unwritten_index_merge, rocksdb_skip_unwritten_index_merge,
+    PLUGIN_VAR_RQCMDARG,
+    "Read the indexes a transaction has not written from its snapshot alone, "
+    "without merging the reads with its write batch.",
+    nullptr, nullptr, false);
+
+static MYSQL_SYSVAR_BOOL(
+    write_set_shared_index_entries, rocksdb_write_set_shared_index_entries,
+    PLUGIN_VAR_RQCMDARG,
+    "Add the ivf list of the vector indexes and the cell of the hilbert next "
+    "spatial indexes of the rows a transaction changes to its write set and "
+    "to its dependency replication keys, so that replicas apply the "
+    "transactions sharing them in order.",
+    nullptr, nullptr, true);
+
+static MYSQL_SYSVAR_UINT(
+    scan_batch_rows, rocksdb_scan_batch_rows, PLUGIN_VAR_RQCMDARG,
+    "Maximum number of rows an unlocked full table scan decodes per batch "
+    "into the record buffer of the server. 0 reads one row at a time.",
+    nullptr, nullptr, /* default */ rocksdb_scan_batch_rows, /* min */ 0,
+    /* max */ 65536, 0);
+
 static MYSQL_THDVAR_BOOL(
     enable_autoinc_compat_mode, PLUGIN_VAR_RQCMDARG,
     "if enabled, allow simple inserts generate consecutive autoinc values, "
     "similar to behavior as innodb_autoinc_lock_mode = 2",
     nullptr, nullptr, false);
 
+static MYSQL_SYSVAR_ULONGLONG(
+    vector_value_cache_size, rocksdb_vector_value_cache_size,
+    PLUGIN_VAR_OPCMDARG,
+    "Memory budget in bytes for caching decoded vectors read by LSM vector "
+    "index scans. 0 disables the cache.",
+    nullptr, rocksdb_vector_value_cache_size_update, 0ULL /* default */,
+    0ULL /* min */, UINT64_MAX /* max */, 0 /* blk */);
+
+static MYSQL_SYSVAR_ULONGLONG(
+    vector_list_cache_size, rocksdb_vector_list_cache_size,
+    PLUGIN_VAR_OPCMDARG,
+    "Memory budget in bytes for caching the codes and keys of frequently "
+    "probed IVF vector index lists, so that KNN searches scan them without "
+    "reading RocksDB. 0 disables the cache.",
+    nullptr, rocksdb_vector_list_cache_size_update, 0ULL /* default */,
+    0ULL /* min */, UINT64_MAX /* max */, 0 /* blk */);
+
+static MYSQL_SYSVAR_UINT(
+    vector_rerank_factor, rocksdb_vector_rerank_factor, PLUGIN_VAR_RQCMDARG,
+    "KNN searches on product and scalar quantized vector indexes fetch this "
+    "many times LIMIT candidates and re-rank them with the exact distance of "
+    "the full vectors. 1 disables the re-rank.",
+    nullptr, nullptr, 4 /* default */, 1 /* min */, 64 /* max */, 0);
+
+static MYSQL_SYSVAR_UINT(
+    vector_result_cache_entries, rocksdb_vector_result_cache_entries,
+    PLUGIN_VAR_RQCMDARG,
+    "Number of KNN search results cached per vector index, so that repeated "
+    "query vectors skip the index search until the index is written. 0 "
+    "disables the cache.",
+    nullptr, nullptr, 0 /* default */, 0 /* min */, 1024 * 1024 /* max */, 0);
+
+static MYSQL_THDVAR_ENUM(
+    vector_text_fusion, PLUGIN_VAR_RQCMDARG,
+    "How an ORDER BY of a vector distance and a MATCH ... AGAINST relevance "
+    "ranks the union of the knn results and the fulltext matches. WEIGHTED "
+    "scores a row by the ORDER BY expression, RRF by reciprocal rank fusion "
+    "of the two rankings.",
+    nullptr, nullptr, VECTOR_TEXT_WEIGHTED, &vector_text_fusion_typelib);
+
+static MYSQL_THDVAR_ULONG(vector_text_rrf_k, PLUGIN_VAR_RQCMDARG,
+                          "Rank offset k of reciprocal rank fusion, a row "
+                          "scores 1 / (k + rank) in each ranking",
+                          nullptr, nullptr, /* default */ 60, /* min */ 1,
+                          /* max */ 1000000, 0);
+
+static MYSQL_THDVAR_ULONG(
+    vector_prefix_exact_rows, PLUGIN_VAR_RQCMDARG,
+    "Vector index searches whose condition fixes the leading primary key "
+    "columns read only the entries of that prefix. A prefix of at most this "
+    "many rows is searched in every list, an exact search. 0 always probes.",
+    nullptr, nullptr, /* default */ 10000, /* min */ 0,
+    /* max */ ULONG_MAX, 0);
+
+static MYSQL_SYSVAR_ULONGLONG(
+    vector_list_partition_size, rocksdb_vector_list_partition_size,
+    PLUGIN_VAR_RQCMDARG,
+    "Compactions end an SST file at the next boundary between two ivf lists "
+    "of a vector index once it holds this many bytes, so that probing a list "
+    "reads few files. 0 disables the split.",
+    nullptr, nullptr, 16ULL << 20 /* default */, 0ULL /* min */,
+    UINT64_MAX /* max */, 0 /* blk */);
+
+static MYSQL_SYSVAR_UINT(
+    vector_index_setup_threads, rocksdb_vector_index_setup_threads,
+    PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+    "Threads opening the tables with secondary indexes once the server has "
+    "started, which loads the trained data of their vector and spatial "
+    "indexes ahead of the first query. 0 sets each index up on the first "
+    "open of its table.",
+    nullptr, nullptr, 0 /* default */, 0 /* min */, 256 /* max */, 0);
+
+static MYSQL_SYSVAR_UINT(
+    ft_min_token_size, rocksdb_ft_min_token_size,
+    PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+    "Minimum length in characters of the words stored in FULLTEXT indexes.",
+    nullptr, nullptr, 3 /* default */, 1 /* min */, 16 /* max */, 0);
+
+static MYSQL_SYSVAR_UINT(
+    ft_max_token_size, rocksdb_ft_max_token_size,
+    PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+    "Maximum length in characters of the words stored in FULLTEXT indexes.",
+    nullptr, nullptr, 84 /* default */, 10 /* min */, 252 /* max */, 0);
+
+static MYSQL_SYSVAR_BOOL(
+    cf_write_throttle, rocksdb_cf_write_throttle, PLUGIN_VAR_RQCMDARG,
+    "Delay the row writes to a column family RocksDB reports as delayed, and "
+    "shed those of low priority resource groups once it is stopped. Writes "
+    "to other column families are not held up.",
+    nullptr, nullptr, false);
+
+static MYSQL_SYSVAR_UINT(
+    cf_write_throttle_delay_us, rocksdb_cf_write_throttle_delay_us,
+    PLUGIN_VAR_RQCMDARG,
+    "Microseconds each row write to a delayed column family waits, when "
+    "rocksdb_cf_write_throttle is on. Resource groups with a higher priority "
+    "than the default do not wait.",
+    nullptr, nullptr, 100 /* default */, 0 /* min */, 1000000 /* max */, 0);
+
+static MYSQL_SYSVAR_UINT(
+    cf_write_throttle_max_wait_ms, rocksdb_cf_write_throttle_max_wait_ms,
+    PLUGIN_VAR_RQCMDARG,
+    "Milliseconds a row write to a stopped column family waits for the stop "
+    "to clear before it goes on to RocksDB, when rocksdb_cf_write_throttle is "
+    "on. Writes of resource groups with a lower priority than the default "
+    "fail instead.",
+    nullptr, nullptr, 1000 /* default */, 0 /* min */, 3600000 /* max */, 0);
+
+static void rocksdb_set_key_access_sample_rate(
+    THD *const thd MY_ATTRIBUTE((__unused__)),
+    struct SYS_VAR *const var MY_ATTRIBUTE((__unused__)), void *const var_ptr,
+    const void *const save) {
+  *static_cast<uint *>(var_ptr) = *static_cast<const uint *>(save);
+  key_access_sampler.clear();
+}
+
+static MYSQL_SYSVAR_UINT(
+    key_access_sample_rate, rocksdb_key_access_sample_rate,
+    PLUGIN_VAR_RQCMDARG,
+    "Sample one of every this many seeks and point reads of each thread for "
+    "the prefix extractor and bloom filter recommendations of "
+    "INFORMATION_SCHEMA.ROCKSDB_KEY_ACCESS_RECOMMENDATIONS. 0 disables the "
+    "sampling. Setting it clears the samples.",
+    nullptr, rocksdb_set_key_access_sample_rate, 0 /* default */, 0 /* min */,
+    UINT_MAX /* max */, 0);
+
 static const int ROCKSDB_ASSUMED_KEY_VALUE_DISK_SIZE = 100;
 
 static struct SYS_VAR *rocksdb_system_variables[] = {
     MYSQL_SYSVAR(lock_wait_timeout),
+    MYSQL_SYSVAR(shared_snapshot_refresh_ms),
     MYSQL_SYSVAR(deadlock_detect),
     MYSQL_SYSVAR(deadlock_detect_depth),
     MYSQL_SYSVAR(commit_time_batch_for_recovery),
@@ -3049,6 +3772,7 @@ static struct SYS_VAR *rocksdb_system_variables[] = {
     MYSQL_SYSVAR(max_trash_db_ratio_pct),
     MYSQL_SYSVAR(delayed_write_rate),
     MYSQL_SYSVAR(max_latest_deadlocks),
+    MYSQL_SYSVAR(lock_stripes),
     MYSQL_SYSVAR(info_log_level),
     MYSQL_SYSVAR(max_open_files),
     MYSQL_SYSVAR(max_file_opening_threads),
@@ -3060,6 +3784,7 @@ static struct SYS_VAR *rocksdb_system_variables[] = {
     MYSQL_SYSVAR(wsenv_path),
     MYSQL_SYSVAR(wsenv_tenant),
     MYSQL_SYSVAR(wsenv_oncall),
+    MYSQL_SYSVAR(cold_data_dir),
     MYSQL_SYSVAR(delete_obsolete_files_period_micros),
     MYSQL_SYSVAR(max_background_jobs),
     MYSQL_SYSVAR(max_background_flushes),
@@ -3088,11 +3813,15 @@ static struct SYS_VAR *rocksdb_system_variables[] = {
     MYSQL_SYSVAR(wal_bytes_per_sync),
     MYSQL_SYSVAR(enable_thread_tracking),
     MYSQL_SYSVAR(perf_context_level),
+    MYSQL_SYSVAR(perf_context_sample_rate),
+    MYSQL_SYSVAR(perf_context_sample_level),
+    MYSQL_SYSVAR(perf_context_sample_statements),
     MYSQL_SYSVAR(wal_recovery_mode),
     MYSQL_SYSVAR(track_and_verify_wals_in_manifest),
     MYSQL_SYSVAR(stats_level),
     MYSQL_SYSVAR(compaction_readahead_size),
     MYSQL_SYSVAR(allow_concurrent_memtable_write),
+    MYSQL_SYSVAR(enable_pipelined_write),
     MYSQL_SYSVAR(enable_write_thread_adaptive_yield),
 
     MYSQL_SYSVAR(block_cache_size),
@@ -3120,10 +3849,14 @@ static struct SYS_VAR *rocksdb_system_variables[] = {
 
     MYSQL_SYSVAR(flush_log_at_trx_commit),
     MYSQL_SYSVAR(write_disable_wal),
+    MYSQL_SYSVAR(async_commit),
     MYSQL_SYSVAR(write_ignore_missing_column_families),
     MYSQL_SYSVAR(protection_bytes_per_key),
 
     MYSQL_SYSVAR(skip_fill_cache),
+    MYSQL_SYSVAR(large_scan_rows),
+    MYSQL_SYSVAR(large_scan_readahead_size),
+    MYSQL_SYSVAR(large_scan_skip_fill_cache),
     MYSQL_SYSVAR(unsafe_for_binlog),
 
     MYSQL_SYSVAR(records_in_range),
@@ -3135,6 +3868,7 @@ static struct SYS_VAR *rocksdb_system_variables[] = {
     MYSQL_SYSVAR(debug_cardinality_multiplier),
 
     MYSQL_SYSVAR(compact_cf),
+    MYSQL_SYSVAR(vector_index_retrain),
     MYSQL_SYSVAR(delete_cf),
     MYSQL_SYSVAR(signal_drop_index_thread),
     MYSQL_SYSVAR(pause_background_work),
@@ -3167,6 +3901,7 @@ static struct SYS_VAR *rocksdb_system_variables[] = {
 
     MYSQL_SYSVAR(datadir),
     MYSQL_SYSVAR(create_checkpoint),
+    MYSQL_SYSVAR(create_incremental_checkpoint),
     MYSQL_SYSVAR(create_temporary_checkpoint),
     MYSQL_SYSVAR(disable_file_deletions),
 
@@ -3176,6 +3911,7 @@ static struct SYS_VAR *rocksdb_system_variables[] = {
     MYSQL_SYSVAR(master_skip_tx_api),
 
     MYSQL_SYSVAR(validate_tables),
+    MYSQL_SYSVAR(ddl_snapshot),
     MYSQL_SYSVAR(table_stats_sampling_pct),
     MYSQL_SYSVAR(table_stats_recalc_threshold_pct),
     MYSQL_SYSVAR(table_stats_recalc_threshold_count),
@@ -3197,6 +3933,10 @@ static struct SYS_VAR *rocksdb_system_variables[] = {
     MYSQL_SYSVAR(trace_queries),
     MYSQL_SYSVAR(max_compaction_history),
     MYSQL_SYSVAR(mrr_batch_size),
+    MYSQL_SYSVAR(mrr_async_io),
+    MYSQL_SYSVAR(parallel_scan_threads),
+    MYSQL_SYSVAR(index_build_threads),
+    MYSQL_SYSVAR(bulk_load_threads),
 
     MYSQL_SYSVAR(select_bypass_policy),
     MYSQL_SYSVAR(select_bypass_fail_unsupported),
@@ -3214,6 +3954,8 @@ static struct SYS_VAR *rocksdb_system_variables[] = {
     MYSQL_SYSVAR(partial_index_sort_max_mem),
     MYSQL_SYSVAR(partial_index_blind_delete),
     MYSQL_SYSVAR(partial_index_ignore_killed),
+    MYSQL_SYSVAR(partial_index_materialize_in_background),
+    MYSQL_SYSVAR(partial_index_materialize_rate),
     MYSQL_SYSVAR(disable_instant_ddl),
     MYSQL_SYSVAR(enable_instant_ddl),
     MYSQL_SYSVAR(enable_instant_ddl_for_append_column),
@@ -3231,10 +3973,32 @@ static struct SYS_VAR *rocksdb_system_variables[] = {
     MYSQL_SYSVAR(io_error_action),
     MYSQL_SYSVAR(clone_checkpoint_max_age),
     MYSQL_SYSVAR(clone_checkpoint_max_count),
+    MYSQL_SYSVAR(clone_checksums),
     MYSQL_SYSVAR(converter_record_cached_length),
+    MYSQL_SYSVAR(write_batch_cached_length),
+    MYSQL_SYSVAR(io_latency_histograms),
+    MYSQL_SYSVAR(slow_io_threshold_us),
     MYSQL_SYSVAR(file_checksums),
     MYSQL_SYSVAR(debug_skip_bloom_filter_check_on_iterator_bounds),
+    MYSQL_SYSVAR(skip_unwritten_index_merge),
+    MYSQL_SYSVAR(write_set_shared_index_entries),
+    MYSQL_SYSVAR(scan_batch_rows),
     MYSQL_SYSVAR(enable_autoinc_compat_mode),
+    MYSQL_SYSVAR(vector_value_cache_size),
+    MYSQL_SYSVAR(vector_list_cache_size),
+    MYSQL_SYSVAR(vector_rerank_factor),
+    MYSQL_SYSVAR(vector_result_cache_entries),
+    MYSQL_SYSVAR(vector_text_fusion),
+    MYSQL_SYSVAR(vector_text_rrf_k),
+    MYSQL_SYSVAR(vector_prefix_exact_rows),
+    MYSQL_SYSVAR(vector_list_partition_size),
+    MYSQL_SYSVAR(vector_index_setup_threads),
+    MYSQL_SYSVAR(ft_min_token_size),
+    MYSQL_SYSVAR(ft_max_token_size),
+    MYSQL_SYSVAR(cf_write_throttle),
+    MYSQL_SYSVAR(cf_write_throttle_delay_us),
+    MYSQL_SYSVAR(cf_write_throttle_max_wait_ms),
+    MYSQL_SYSVAR(key_access_sample_rate),
     nullptr};
 
 static bool is_tmp_table(const std::string &tablename) {
@@ -3334,33 +4098,108 @@ static int rocksdb_compact_column_family(
   return HA_EXIT_SUCCESS;
 }
 
-/*
- * Serializes an xid to a string so that it can
- * be used as a rocksdb transaction name
- */
-static std::string rdb_xid_to_string(const XID &src) {
-  assert(src.get_gtrid_length() >= 0 && src.get_gtrid_length() <= MAXGTRIDSIZE);
-  assert(src.get_bqual_length() >= 0 && src.get_bqual_length() <= MAXBQUALSIZE);
+static int rocksdb_retrain_vector_index(
+    THD *const thd, struct SYS_VAR *const var MY_ATTRIBUTE((__unused__)),
+    void *const var_ptr MY_ATTRIBUTE((__unused__)),
+    struct st_mysql_value *const value) {
+  char buff[STRING_BUFFER_USUAL_SIZE];
+  int len = sizeof(buff);
 
-  std::string buf;
-  buf.reserve(RDB_XIDHDR_LEN + src.get_gtrid_length() + src.get_bqual_length());
+  assert(value != nullptr);
 
-  /*
-   * expand formatID to fill 8 bytes if it doesn't already
-   * then reinterpret bit pattern as unsigned and store in network order
-   */
-  uchar fidbuf[RDB_FORMATID_SZ];
-  int64 signed_fid8 = src.get_format_id();
-  const uint64 raw_fid8 = *reinterpret_cast<uint64 *>(&signed_fid8);
-  rdb_netbuf_store_uint64(fidbuf, raw_fid8);
-  buf.append(reinterpret_cast<const char *>(fidbuf), RDB_FORMATID_SZ);
+  const char *const name = value->val_str(value, buff, &len);
+  if (name == nullptr || *name == '\0') {
+    return HA_EXIT_SUCCESS;
+  }
 
-  buf.push_back(src.get_gtrid_length());
-  buf.push_back(src.get_bqual_length());
-  buf.append(src.get_data(),
-             (src.get_gtrid_length()) + (src.get_bqual_length()));
-  return buf;
-}
+  // db.table.index, the index name is after the last dot
+  const std::string full_name(name);
+  const auto pos = full_name.rfind('.');
+  if (pos == std::string::npos) {
+    my_error(ER_WRONG_ARGUMENTS, MYF(0), "rocksdb_vector_index_retrain");
+    return HA_EXIT_FAILURE;
+  }
+  const std::string table_name = full_name.substr(0, pos);
+  const std::string index_name = full_name.substr(pos + 1);
+
+  std::shared_ptr<const Rdb_key_def> kd;
+  {
+    const Rdb_tbl_def *const tbl_def = ddl_manager.find(table_name);
+    if (tbl_def != nullptr) {
+      for (uint i = 0; i < tbl_def->m_key_count; i++) {
+        const auto &key_descr = tbl_def->m_key_descr_arr[i];
+        if (key_descr->is_vector_index() &&
+            key_descr->get_name() == index_name) {
+          kd = ddl_manager.safe_find(key_descr->get_gl_index_id());
+          break;
+        }
+      }
+    }
+  }
+  if (kd == nullptr) {
+    my_error(ER_WRONG_ARGUMENTS, MYF(0), "rocksdb_vector_index_retrain");
+    return HA_EXIT_FAILURE;
+  }
+
+  // the retrain waits for the transactions writing to the index to end
+  if (rdb_has_vector_list_writes(thd, kd->get_index_number())) {
+    my_error(ER_INTERNAL_ERROR, MYF(0),
+             "Commit or roll back the writes of the current transaction to "
+             "the vector index before retraining it.");
+    return HA_EXIT_FAILURE;
+  }
+
+  // NO_LINT_DEBUG
+  LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
+                  "RocksDB: Retraining vector index %s", name);
+  const uint rc = kd->get_vector_index()->retrain(thd);
+  // entries moved to other lists, searches may find other neighbours now
+  kd->get_vector_index()->note_write();
+  if (rc == HA_ERR_UNSUPPORTED) {
+    my_error(ER_INTERNAL_ERROR, MYF(0),
+             "Only ivfflat vector indexes can be retrained.");
+    return HA_EXIT_FAILURE;
+  }
+  if (rc == HA_ERR_LOCK_WAIT_TIMEOUT) {
+    my_error(ER_LOCK_WAIT_TIMEOUT, MYF(0));
+    return HA_EXIT_FAILURE;
+  }
+  if (rc) {
+    my_error(ER_INTERNAL_ERROR, MYF(0),
+             thd->killed ? "Vector index retrain was interrupted."
+                         : "Vector index retrain failed, see the error log.");
+    return HA_EXIT_FAILURE;
+  }
+  return HA_EXIT_SUCCESS;
+}
+
+/*
+ * Serializes an xid to a string so that it can
+ * be used as a rocksdb transaction name
+ */
+static std::string rdb_xid_to_string(const XID &src) {
+  assert(src.get_gtrid_length() >= 0 && src.get_gtrid_length() <= MAXGTRIDSIZE);
+  assert(src.get_bqual_length() >= 0 && src.get_bqual_length() <= MAXBQUALSIZE);
+
+  std::string buf;
+  buf.reserve(RDB_XIDHDR_LEN + src.get_gtrid_length() + src.get_bqual_length());
+
+  /*
+   * expand formatID to fill 8 bytes if it doesn't already
+   * then reinterpret bit pattern as unsigned and store in network order
+   */
+  uchar fidbuf[RDB_FORMATID_SZ];
+  int64 signed_fid8 = src.get_format_id();
+  const uint64 raw_fid8 = *reinterpret_cast<uint64 *>(&signed_fid8);
+  rdb_netbuf_store_uint64(fidbuf, raw_fid8);
+  buf.append(reinterpret_cast<const char *>(fidbuf), RDB_FORMATID_SZ);
+
+  buf.push_back(src.get_gtrid_length());
+  buf.push_back(src.get_bqual_length());
+  buf.append(src.get_data(),
+             (src.get_gtrid_length()) + (src.get_bqual_length()));
+  return buf;
+}
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 
@@ -3377,9 +4216,7 @@ static void rocksdb_drop_index_wakeup_thread(
   }
 }
 
-uint32_t rocksdb_perf_context_level(THD *const thd) {
-  assert(thd != nullptr);
-
+static uint32_t rocksdb_configured_perf_context_level(THD *const thd) {
   const int session_perf_context_level = THDVAR(thd, perf_context_level);
   if (session_perf_context_level > rocksdb::PerfLevel::kUninitialized) {
     return session_perf_context_level;
@@ -3398,6 +4235,51 @@ uint32_t rocksdb_perf_context_level(THD *const thd) {
   return rocksdb::PerfLevel::kDisable;
 }
 
+uint32_t rocksdb_perf_context_level(THD *const thd) {
+  assert(thd != nullptr);
+
+  const uint32_t perf_context_level =
+      rocksdb_configured_perf_context_level(thd);
+
+  // sampled statements collect at least the sample level
+  if (rdb_perf_context_sample(thd, rocksdb_perf_context_sample_rate) &&
+      perf_context_level < rocksdb_perf_context_sample_level) {
+    return rocksdb_perf_context_sample_level;
+  }
+  return perf_context_level;
+}
+
+/*
+  EXPLAIN ANALYZE needs at least the perf_context counts to show the work of
+  each iterator.
+*/
+static uint32_t rocksdb_stmt_perf_context_level(THD *const thd) {
+  const uint32_t perf_context_level = rocksdb_perf_context_level(thd);
+  if (thd->lex->is_explain_analyze &&
+      perf_context_level < rocksdb::PerfLevel::kEnableCount) {
+    return rocksdb::PerfLevel::kEnableCount;
+  }
+  return perf_context_level;
+}
+
+// nanoseconds this thread spent decoding rows under EXPLAIN ANALYZE
+static thread_local ulonglong rdb_explain_decode_ns = 0;
+
+static void rocksdb_add_engine_counters(THD *, ha_engine_counters *counters) {
+  const rocksdb::PerfContext *const perf_context = rocksdb::get_perf_context();
+  counters->block_reads += perf_context->block_read_count;
+  counters->block_read_bytes += perf_context->block_read_byte;
+  counters->block_cache_hits += perf_context->block_cache_hit_count;
+  counters->bloom_checks +=
+      perf_context->bloom_memtable_hit_count +
+      perf_context->bloom_memtable_miss_count +
+      perf_context->bloom_sst_hit_count + perf_context->bloom_sst_miss_count;
+  counters->seeks += perf_context->iter_seek_count;
+  counters->nexts +=
+      perf_context->iter_next_count + perf_context->iter_prev_count;
+  counters->decode_ns += rdb_explain_decode_ns;
+}
+
 rocksdb::IngestExternalFileOptions
 rocksdb_bulk_load_ingest_external_file_options(THD *const thd) {
   rocksdb::IngestExternalFileOptions opts;
@@ -3554,6 +4436,8 @@ class Rdb_transaction {
 
  private:
   std::unordered_set<Rdb_tbl_def *> modified_tables;
+  // ivf lists written, by index id and list id
+  std::set<std::pair<Index_id, uint64>> m_vector_list_writes;
 
   /*
     Number of write operations this transaction had when we took the last
@@ -3564,6 +4448,8 @@ class Rdb_transaction {
 
   bool m_bulk_index_transaction = false;
   bool m_dd_transaction = false;
+  // the statement locks rows it reads, or writes
+  bool m_locking_stmt = false;
 
  protected:
   THD *m_thd = nullptr;
@@ -3611,6 +4497,7 @@ class Rdb_transaction {
   void reset_flags() {
     m_bulk_index_transaction = false;
     m_dd_transaction = false;
+    m_locking_stmt = false;
   }
 
  protected:
@@ -3630,6 +4517,10 @@ class Rdb_transaction {
   String m_detailed_error;
   int64_t m_snapshot_timestamp = 0;
   std::shared_ptr<Rdb_explicit_snapshot> m_explicit_snapshot;
+  std::shared_ptr<rocksdb::ManagedSnapshot> m_shared_snapshot;
+  // sequence number at or after the last commit of the session that wrote,
+  // a shared snapshot older than that would miss its own writes
+  rocksdb::SequenceNumber m_last_write_commit_seq = 0;
   bool should_refresh_iterator_after_first_write = false;
 
   /*
@@ -3722,7 +4613,7 @@ class Rdb_transaction {
       gather stats during commit/rollback is needed.
     */
     if (m_tbl_io_perf == nullptr &&
-        io_perf->start(rocksdb_perf_context_level(m_thd))) {
+        io_perf->start(rocksdb_stmt_perf_context_level(m_thd))) {
       m_tbl_io_perf = io_perf;
     }
   }
@@ -3784,6 +4675,19 @@ class Rdb_transaction {
 
   [[nodiscard]] bool is_dd_transaction() const { return m_dd_transaction; }
 
+  void set_locking_stmt() { m_locking_stmt = true; }
+
+  /*
+    An autocommit SELECT without locking reads can read from the shared
+    snapshot, see Rdb_shared_snapshot. Locking reads validate against the
+    snapshot and would fail on changes committed since it was taken.
+  */
+  [[nodiscard]] bool can_use_shared_snapshot() const {
+    return THDVAR(m_thd, shared_snapshot_refresh_ms) > 0 && !m_locking_stmt &&
+           is_autocommit(*m_thd) && m_thd->lex->sql_command == SQLCOM_SELECT &&
+           get_write_count() == 0;
+  }
+
   virtual void set_lock_timeout(int timeout_sec_arg, TABLE_TYPE table_type) = 0;
 
   ulonglong get_write_count(
@@ -3845,6 +4749,8 @@ class Rdb_transaction {
 
   virtual void set_sync(bool sync) = 0;
 
+  virtual bool is_sync() const = 0;
+
   virtual void release_lock(const Rdb_key_def &key_descr,
                             const std::string &rowkey, bool force = false) = 0;
 
@@ -3916,6 +4822,17 @@ class Rdb_transaction {
     return m_read_opts[table_type].snapshot != nullptr;
   }
 
+  /*
+    Options to read the snapshot with, e.g. on other threads. The reads do
+    not see the writes of the transaction.
+  */
+  rocksdb::ReadOptions get_snapshot_read_options(TABLE_TYPE table_type) {
+    acquire_snapshot(true, table_type);
+    rocksdb::ReadOptions options = m_read_opts[table_type];
+    options.fill_cache = !THDVAR(get_thd(), skip_fill_cache);
+    return options;
+  }
+
  private:
   // The Rdb_sst_info structures we are currently loading.  In a partitioned
   // table this can have more than one entry
@@ -4062,6 +4979,8 @@ class Rdb_transaction {
     int rc2 = 0;
     std::vector<Rdb_sst_info::Rdb_sst_commit_info> sst_commit_list;
     sst_commit_list.reserve(m_curr_bulk_load.size());
+    // vector indexes whose entries bypassed on_entry_update
+    std::vector<std::shared_ptr<const Rdb_key_def>> vector_indexes;
 
     for (auto &sst_info : m_curr_bulk_load) {
       Rdb_sst_info::Rdb_sst_commit_info commit_info;
@@ -4117,6 +5036,10 @@ class Rdb_transaction {
         GL_INDEX_ID index_id = it->first;
         std::shared_ptr<const Rdb_key_def> keydef =
             ddl_manager.safe_find(index_id);
+        if (keydef != nullptr && keydef->is_vector_index() &&
+            table_arg == nullptr) {
+          vector_indexes.push_back(keydef);
+        }
         std::string table_name;
         if (table_name_arg) {
           table_name = table_name_arg;
@@ -4302,6 +5225,20 @@ class Rdb_transaction {
               "finish_bulk_load: key name: %s, check_unique_index: %d",
               keydef->get_name().c_str(), check_unique_index);
 
+          // Index builds and bulk loads write the merged entries on several
+          // threads
+          const uint writer_threads = table_arg
+                                          ? THDVAR(m_thd, index_build_threads)
+                                          : THDVAR(m_thd, bulk_load_threads);
+          std::unique_ptr<Rdb_sst_parallel_writer> sst_writer;
+          if (writer_threads > 1) {
+            sst_writer = std::make_unique<Rdb_sst_parallel_writer>(
+                rdb, table_name, index_name, rdb_merge.get_cf(),
+                *rocksdb_db_options, THDVAR(get_thd(), trace_sst_api),
+                THDVAR(get_thd(), bulk_load_compression_parallel_threads),
+                writer_threads);
+          }
+
           struct unique_sk_buf_info sk_info;
           if (check_unique_index) {
             uint max_packed_sk_len = keydef->max_storage_fmt_length();
@@ -4347,13 +5284,23 @@ class Rdb_transaction {
             /*
               Insert key and slice to SST via SSTFileWriter API.
             */
-            if ((rc2 = sst_info->put(merge_key, merge_val)) != 0) {
+            rc2 = sst_writer ? sst_writer->put(merge_key, merge_val)
+                             : sst_info->put(merge_key, merge_val);
+            if (rc2 != 0) {
               rc = rc2;
 
               // Don't return yet - make sure we finish the sst_info
               break;
             }
           }
+
+          if (sst_writer) {
+            // The SST files of the writer are removed if the load fails
+            const int writer_rc = sst_writer->finish(&sst_commit_list);
+            if (writer_rc != 0 && rc == 0) {
+              rc = writer_rc;
+            }
+          }
         }
 
         // -1 => no more items
@@ -4464,6 +5411,24 @@ class Rdb_transaction {
       commit_info.commit();
     }
 
+    // Index builds populate their vector index themselves, a bulk load
+    // links the ingested entries as the alter would
+    for (const auto &keydef : vector_indexes) {
+      Rdb_vector_index *const vector_index = keydef->get_vector_index();
+      vector_index->note_write();
+      rdb_get_vector_list_cache().drop_index(keydef->get_index_number());
+      rc2 = vector_index->populate(m_thd);
+      if (rc2) {
+        // NO_LINT_DEBUG
+        LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                        "Error populating vector index %s after bulk load.",
+                        keydef->get_name().c_str());
+        if (rc == 0) {
+          rc = rc2;
+        }
+      }
+    }
+
     if (THDVAR(m_thd, trace_sst_api)) {
       // NO_LINT_DEBUG
       LogPluginErrMsg(
@@ -4655,6 +5620,10 @@ class Rdb_transaction {
   [[nodiscard]] virtual std::unique_ptr<rocksdb::Iterator> get_iterator(
       const rocksdb::ReadOptions &options,
       rocksdb::ColumnFamilyHandle &column_family, TABLE_TYPE table_type) = 0;
+
+  /* Whether the write batch holds keys of the index kd */
+  [[nodiscard]] virtual bool has_index_writes(const Rdb_key_def &kd,
+                                              TABLE_TYPE table_type) const = 0;
   
   [[nodiscard]] virtual std::unique_ptr<rocksdb::Iterator> get_iterator_next_spatial(
     const rocksdb::ReadOptions &options,
@@ -4664,17 +5633,30 @@ class Rdb_transaction {
     const rocksdb::ReadOptions &options,
     rocksdb::ColumnFamilyHandle &column_family, TABLE_TYPE table_type) = 0;
 
+  /*
+    async_io reads the keys of a level in parallel, when RocksDB is built
+    with coroutines; otherwise it is ignored.
+  */
   virtual void multi_get(rocksdb::ColumnFamilyHandle &column_family,
                          size_t num_keys, const rocksdb::Slice *keys,
                          rocksdb::PinnableSlice *values, TABLE_TYPE table_type,
-                         rocksdb::Status *statuses,
-                         bool sorted_input) const = 0;
+                         rocksdb::Status *statuses, bool sorted_input,
+                         bool async_io = false) const = 0;
+
+  static rocksdb::ReadOptions multi_get_options(
+      const rocksdb::ReadOptions &options, bool async_io) {
+    rocksdb::ReadOptions multi_get_options = options;
+    multi_get_options.async_io = async_io;
+    multi_get_options.optimize_multiget_for_io = async_io;
+    return multi_get_options;
+  }
 
   [[nodiscard]] std::unique_ptr<rocksdb::Iterator> get_iterator(
       rocksdb::ColumnFamilyHandle &column_family, bool skip_bloom_filter,
       const rocksdb::Slice &eq_cond_lower_bound,
       const rocksdb::Slice &eq_cond_upper_bound, TABLE_TYPE table_type,
-      bool read_current = false, bool create_snapshot = true) {
+      bool read_current = false, bool create_snapshot = true,
+      ha_rows scan_rows = 0, bool merge_batch = true) {
     // Make sure we are not doing both read_current (which implies we don't
     // want a snapshot) and create_snapshot which makes sure we create
     // a snapshot
@@ -4683,7 +5665,24 @@ class Rdb_transaction {
     if (create_snapshot) acquire_snapshot(true, table_type);
 
     rocksdb::ReadOptions options = m_read_opts[table_type];
-    const bool fill_cache = !THDVAR(get_thd(), skip_fill_cache);
+    bool fill_cache = !THDVAR(get_thd(), skip_fill_cache);
+
+    const ulonglong large_scan_rows = THDVAR(get_thd(), large_scan_rows);
+    if (large_scan_rows > 0 && scan_rows >= large_scan_rows &&
+        table_type == TABLE_TYPE::USER_TABLE) {
+      /*
+        Read ahead a lot from the first block on instead of ramping up, with
+        the next blocks prefetched asynchronously while the current ones are
+        returned, and keep the blocks of the scan out of the block cache.
+      */
+      options.readahead_size = THDVAR(get_thd(), large_scan_readahead_size);
+      options.adaptive_readahead = true;
+      options.async_io = true;
+      if (THDVAR(get_thd(), large_scan_skip_fill_cache)) fill_cache = false;
+
+      rdb_large_scan_stats.m_scans++;
+      if (m_tbl_io_perf != nullptr) m_tbl_io_perf->record_large_scan();
+    }
 
     if (skip_bloom_filter) {
       options.total_order_seek = true;
@@ -4708,6 +5707,17 @@ class Rdb_transaction {
     if (read_current) {
       options.snapshot = nullptr;
     }
+    if (!merge_batch) {
+      /*
+        The write batch has nothing for the index read, so read the snapshot
+        alone rather than merging it with an empty delta.
+      */
+      if (table_type == USER_TABLE) {
+        global_stats.queries[QUERIES_RANGE].inc();
+      }
+      return std::unique_ptr<rocksdb::Iterator>(
+          rdb->NewIterator(options, &column_family));
+    }
     return get_iterator(options, column_family, table_type);
   }
 
@@ -4760,6 +5770,8 @@ class Rdb_transaction {
     options.num_returns = k;
     options.is_ivf_vector_index_scan = true;
     options.async_io = true;
+    // let vector scans keep candidate slices instead of copying them
+    options.pin_data = true;
 
     options.fill_cache = fill_cache;
     if (read_current) {
@@ -4785,14 +5797,33 @@ class Rdb_transaction {
     tm = time(nullptr);
     for (auto &it : modified_tables) {
       it->m_update_time = tm;
+      // the cache knows tables by their names, not their file names
+      char db_sys[NAME_LEN + 1];
+      char tablename_sys[NAME_LEN + 1];
+      my_core::filename_to_tablename(it->base_dbname().c_str(), db_sys,
+                                     sizeof(db_sys));
+      my_core::filename_to_tablename(it->base_tablename().c_str(),
+                                     tablename_sys, sizeof(tablename_sys));
+      query_result_cache_invalidate(db_sys, tablename_sys);
+      // results cached while the writes were pending miss them
+      for (uint i = 0; i < it->m_key_count; i++) {
+        const Rdb_key_def &kd = *it->m_key_descr_arr[i];
+        if (kd.is_vector_index() && kd.get_vector_index()) {
+          kd.get_vector_index()->note_write();
+        }
+      }
     }
+    const rocksdb::SequenceNumber commit_seq = rdb->GetLatestSequenceNumber();
+    if (!modified_tables.empty()) m_last_write_commit_seq = commit_seq;
     modified_tables.clear();
+    end_vector_list_writes(commit_seq);
 
     m_binlog_ttl_read_filtering_ts = m_thd->binlog_ttl_read_filtering_ts = 0;
   }
 
   void on_rollback() {
     modified_tables.clear();
+    end_vector_list_writes(0);
     m_binlog_ttl_read_filtering_ts = m_thd->binlog_ttl_read_filtering_ts = 0;
   }
 
@@ -4800,6 +5831,28 @@ class Rdb_transaction {
   std::atomic<uint64_t> m_binlog_ttl_read_filtering_ts{0};
 
  public:
+  void log_vector_list_write(Index_id index_id, uint64 list_id) {
+    if (m_vector_list_writes.emplace(index_id, list_id).second) {
+      rdb_get_vector_list_cache().begin_write(index_id, list_id);
+    }
+  }
+
+  bool has_vector_list_writes(Index_id index_id) const {
+    const auto it = m_vector_list_writes.lower_bound({index_id, 0});
+    return it != m_vector_list_writes.end() && it->first == index_id;
+  }
+
+  /*
+    commit_seq is a sequence number at or after the commit, 0 on rollback
+  */
+  void end_vector_list_writes(rocksdb::SequenceNumber commit_seq) {
+    for (const auto &list : m_vector_list_writes) {
+      rdb_get_vector_list_cache().end_write(list.first, list.second,
+                                            commit_seq);
+    }
+    m_vector_list_writes.clear();
+  }
+
   void log_table_write_op(Rdb_tbl_def *tbl) {
     assert(!is_ac_nl_ro_rc_transaction());
 
@@ -4964,6 +6017,20 @@ static void dbug_change_status_to_incomplete(rocksdb::Status *status) {
 }
 #endif
 
+/*
+  Whether a write batch holds a key of the index kd. The keys of an index
+  start with its number.
+*/
+static bool rdb_batch_has_index_writes(rocksdb::WriteBatchWithIndex *wb,
+                                       const Rdb_key_def &kd) {
+  uchar index_number[Rdb_key_def::INDEX_NUMBER_SIZE];
+  uint size;
+  kd.get_infimum_key(index_number, &size);
+  const rocksdb::Slice prefix(reinterpret_cast<const char *>(index_number),
+                              size);
+  return rdb_batch_has_prefix(wb, &kd.get_cf(), prefix, kd.m_is_reverse_cf);
+}
+
 /*
   This is a rocksdb transaction. Its members represent the current transaction,
   which consists of:
@@ -4976,6 +6043,8 @@ static void dbug_change_status_to_incomplete(rocksdb::Status *status) {
 class Rdb_transaction_impl : public Rdb_transaction {
   std::vector<rocksdb::Transaction *> m_rocksdb_tx{nullptr, nullptr};
   std::vector<rocksdb::Transaction *> m_rocksdb_reuse_tx{nullptr, nullptr};
+  /* bytes in the user table write batch at commit or rollback */
+  size_t m_batch_size = 0;
 
  public:
   void set_lock_timeout(int timeout_sec_arg, TABLE_TYPE table_type) override {
@@ -4991,6 +6060,11 @@ class Rdb_transaction_impl : public Rdb_transaction {
     m_rocksdb_tx[TABLE_TYPE::USER_TABLE]->GetWriteOptions()->sync = sync;
   }
 
+  bool is_sync() const override {
+    return m_rocksdb_tx[TABLE_TYPE::USER_TABLE] != nullptr &&
+           m_rocksdb_tx[TABLE_TYPE::USER_TABLE]->GetWriteOptions()->sync;
+  }
+
   void release_lock(const Rdb_key_def &key_descr, const std::string &rowkey,
                     bool force) override {
     assert(!is_ac_nl_ro_rc_transaction());
@@ -5011,13 +6085,31 @@ class Rdb_transaction_impl : public Rdb_transaction {
   bool is_writebatch_trx() const override { return false; }
 
  private:
+  /*
+    Remember how large the write batch of the user table transaction got,
+    before Commit() or Rollback() clear it: clearing keeps its buffer.
+  */
+  void note_batch_size() {
+    m_batch_size = m_rocksdb_tx[TABLE_TYPE::USER_TABLE]
+                       ->GetWriteBatch()
+                       ->GetWriteBatch()
+                       ->GetDataSize();
+  }
+
   void release_tx(void) {
     // We are done with the current active transaction object.  Preserve it
-    // for later reuse.
+    // for later reuse, unless its write batch grew past
+    // @@rocksdb_write_batch_cached_length.
     assert(m_rocksdb_reuse_tx[TABLE_TYPE::USER_TABLE] == nullptr);
-    m_rocksdb_reuse_tx[TABLE_TYPE::USER_TABLE] =
-        m_rocksdb_tx[TABLE_TYPE::USER_TABLE];
+    if (rocksdb_write_batch_cached_length &&
+        m_batch_size > rocksdb_write_batch_cached_length) {
+      delete m_rocksdb_tx[TABLE_TYPE::USER_TABLE];
+    } else {
+      m_rocksdb_reuse_tx[TABLE_TYPE::USER_TABLE] =
+          m_rocksdb_tx[TABLE_TYPE::USER_TABLE];
+    }
     m_rocksdb_tx[TABLE_TYPE::USER_TABLE] = nullptr;
+    m_batch_size = 0;
     if (m_rocksdb_tx[INTRINSIC_TMP] != nullptr) {
       assert(m_rocksdb_reuse_tx[INTRINSIC_TMP] == nullptr);
       m_rocksdb_reuse_tx[INTRINSIC_TMP] = m_rocksdb_tx[INTRINSIC_TMP];
@@ -5060,6 +6152,7 @@ class Rdb_transaction_impl : public Rdb_transaction {
 
     s = merge_auto_incr_map(
         m_rocksdb_tx[table_type]->GetWriteBatch()->GetWriteBatch());
+    if (table_type == USER_TABLE) note_batch_size();
 #ifndef DBUG_OFF
     DBUG_EXECUTE_IF("myrocks_commit_merge_io_error",
                     dbug_change_status_to_io_error(&s););
@@ -5125,6 +6218,7 @@ class Rdb_transaction_impl : public Rdb_transaction {
     reset_flags();
     if (m_rocksdb_tx[TABLE_TYPE::USER_TABLE]) {
       release_snapshot(TABLE_TYPE::USER_TABLE);
+      note_batch_size();
       /* This will also release all of the locks: */
       m_rocksdb_tx[TABLE_TYPE::USER_TABLE]->Rollback();
 
@@ -5156,6 +6250,14 @@ class Rdb_transaction_impl : public Rdb_transaction {
       if (m_explicit_snapshot) {
         auto snapshot = m_explicit_snapshot->get_snapshot()->snapshot();
         snapshot_created(snapshot);
+        // older than the start of the statement
+        query_result_cache_disallow(m_thd);
+      } else if (can_use_shared_snapshot()) {
+        m_shared_snapshot = Rdb_shared_snapshot::get(
+            rdb, THDVAR(m_thd, shared_snapshot_refresh_ms),
+            m_last_write_commit_seq);
+        snapshot_created(m_shared_snapshot->snapshot());
+        query_result_cache_disallow(m_thd);
       } else if (is_tx_read_only()) {
         snapshot_created(rdb->GetSnapshot());
       } else if (acquire_now) {
@@ -5180,6 +6282,9 @@ class Rdb_transaction_impl : public Rdb_transaction {
       if (m_explicit_snapshot) {
         m_explicit_snapshot.reset();
         need_clear = false;
+      } else if (m_shared_snapshot) {
+        m_shared_snapshot.reset();
+        need_clear = false;
       } else if (is_tx_read_only()) {
         rdb->ReleaseSnapshot(m_read_opts[table_type].snapshot);
         need_clear = false;
@@ -5290,7 +6395,13 @@ class Rdb_transaction_impl : public Rdb_transaction {
   void multi_get(rocksdb::ColumnFamilyHandle &column_family, size_t num_keys,
                  const rocksdb::Slice *keys, rocksdb::PinnableSlice *values,
                  TABLE_TYPE table_type, rocksdb::Status *statuses,
-                 bool sorted_input) const override {
+                 bool sorted_input, bool async_io) const override {
+    if (async_io) {
+      m_rocksdb_tx[table_type]->MultiGet(
+          multi_get_options(m_read_opts[table_type], true), &column_family,
+          num_keys, keys, values, statuses, sorted_input);
+      return;
+    }
     m_rocksdb_tx[table_type]->MultiGet(m_read_opts[table_type], &column_family,
                                        num_keys, keys, values, statuses,
                                        sorted_input);
@@ -5364,6 +6475,13 @@ class Rdb_transaction_impl : public Rdb_transaction {
         m_rocksdb_tx[table_type]->GetIterator(options, &column_family));
   }
 
+  [[nodiscard]] bool has_index_writes(const Rdb_key_def &kd,
+                                      TABLE_TYPE table_type) const override {
+    return m_rocksdb_tx[table_type] != nullptr &&
+           rdb_batch_has_index_writes(
+               m_rocksdb_tx[table_type]->GetWriteBatch(), kd);
+  }
+
   [[nodiscard]] std::unique_ptr<rocksdb::Iterator> get_iterator_next_spatial(
       const rocksdb::ReadOptions &options,
       rocksdb::ColumnFamilyHandle &column_family,
@@ -5561,7 +6679,17 @@ class Rdb_writebatch_impl : public Rdb_transaction {
   rocksdb::WriteOptions write_opts;
   // Called after commit/rollback.
   void reset() {
-    m_batch->Clear();
+    // Clear() keeps the buffer, so drop a batch that grew past
+    // @@rocksdb_write_batch_cached_length rather than hold on to it.
+    if (rocksdb_write_batch_cached_length &&
+        m_batch->GetWriteBatch()->GetDataSize() >
+            rocksdb_write_batch_cached_length) {
+      delete m_batch;
+      m_batch = new rocksdb::WriteBatchWithIndex(rocksdb::BytewiseComparator(),
+                                                 0, true);
+    } else {
+      m_batch->Clear();
+    }
     m_read_opts[USER_TABLE] = rocksdb::ReadOptions();
     m_read_opts[USER_TABLE].ignore_range_deletions =
         !rocksdb_enable_delete_range_for_drop_index;
@@ -5631,6 +6759,8 @@ class Rdb_writebatch_impl : public Rdb_transaction {
 
   void set_sync(bool sync) override { write_opts.sync = sync; }
 
+  bool is_sync() const override { return write_opts.sync; }
+
   void release_lock(const Rdb_key_def &key_descr MY_ATTRIBUTE((unused)),
                     const std::string &rowkey MY_ATTRIBUTE((unused)),
                     bool force MY_ATTRIBUTE((unused))) override {
@@ -5759,11 +6889,17 @@ class Rdb_writebatch_impl : public Rdb_transaction {
   void multi_get(rocksdb::ColumnFamilyHandle &column_family, size_t num_keys,
                  const rocksdb::Slice *keys, rocksdb::PinnableSlice *values,
                  TABLE_TYPE table_type, rocksdb::Status *statuses,
-                 bool sorted_input) const override {
+                 bool sorted_input, bool async_io) const override {
     if (table_type == INTRINSIC_TMP) {
       assert(false);
       return;
     }
+    if (async_io) {
+      m_batch->MultiGetFromBatchAndDB(
+          rdb, multi_get_options(m_read_opts[table_type], true),
+          &column_family, num_keys, keys, values, statuses, sorted_input);
+      return;
+    }
     m_batch->MultiGetFromBatchAndDB(rdb, m_read_opts[table_type],
                                     &column_family, num_keys, keys, values,
                                     statuses, sorted_input);
@@ -5803,6 +6939,12 @@ class Rdb_writebatch_impl : public Rdb_transaction {
     const auto it = rdb->NewIterator(options);
     return std::unique_ptr<rocksdb::Iterator>(m_batch->NewIteratorWithBase(it));
   }
+
+  [[nodiscard]] bool has_index_writes(const Rdb_key_def &kd,
+                                      TABLE_TYPE) const override {
+    return rdb_batch_has_index_writes(m_batch, kd);
+  }
+
   [[nodiscard]] std::unique_ptr<rocksdb::Iterator> get_iterator_next_spatial(
       const rocksdb::ReadOptions &options, rocksdb::ColumnFamilyHandle &,
       TABLE_TYPE table_type) override {
@@ -6070,6 +7212,11 @@ Rdb_transaction *get_tx_from_thd(THD *const thd) {
   return get_ha_data(thd)->get_trx();
 }
 
+static bool rdb_has_vector_list_writes(THD *const thd, Index_id index_id) {
+  const Rdb_transaction *const tx = get_tx_from_thd(thd);
+  return tx != nullptr && tx->has_vector_list_writes(index_id);
+}
+
 void add_tmp_table_handler(THD *const thd, ha_rocksdb *rocksdb_handler) {
   get_ha_data(thd)->add_tmp_table_handler(rocksdb_handler);
 }
@@ -6548,6 +7695,7 @@ static int rocksdb_recover(handlerton *const hton [[maybe_unused]],
     return HA_EXIT_SUCCESS;
   }
 
+  const auto start = std::chrono::steady_clock::now();
   std::vector<rocksdb::Transaction *> trans_list;
   rdb->GetAllPreparedTransactions(&trans_list);
 
@@ -6560,9 +7708,44 @@ static int rocksdb_recover(handlerton *const hton [[maybe_unused]],
     rdb_xid_from_string(name, &xid_list[count].id);
     count++;
   }
+  st_rdb_exec_time.add("rocksdb_recover", start,
+                       std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count(),
+                       count);
   return count;
 }
 
+/**
+  Syncs the WAL for the commits of rocksdb_async_commit, once for all the
+  commits written before the sync.
+*/
+class Rdb_commit_ack_waiter : public Commit_ack_waiter {
+ public:
+  bool sync(ulonglong ticket) override {
+    if (m_synced.load(std::memory_order_acquire) >= ticket) return false;
+    std::lock_guard<std::mutex> guard(m_mutex);
+    // synced while waiting for the mutex
+    if (m_synced.load(std::memory_order_relaxed) >= ticket) return false;
+
+    const rocksdb::SequenceNumber seq = rdb->GetLatestSequenceNumber();
+    rocksdb_wal_group_syncs++;
+    const rocksdb::Status s = rdb->FlushWAL(true);
+    if (!s.ok()) {
+      rdb_handle_io_error(s, RDB_IO_ERROR_TX_COMMIT);
+      return true;
+    }
+    m_synced.store(seq, std::memory_order_release);
+    return false;
+  }
+
+ private:
+  std::mutex m_mutex;
+  std::atomic<rocksdb::SequenceNumber> m_synced{0};
+};
+
+static Rdb_commit_ack_waiter rdb_commit_ack_waiter;
+
 static int rocksdb_commit(handlerton *const hton MY_ATTRIBUTE((__unused__)),
                           THD *const thd, bool all) {
   DBUG_ENTER_FUNC();
@@ -6587,9 +7770,19 @@ static int rocksdb_commit(handlerton *const hton MY_ATTRIBUTE((__unused__)),
          - For a COMMIT statement that finishes a multi-statement transaction
          - For a statement that has its own transaction
       */
+      // the sync is left to the OK packet of the statement
+      const bool defer_sync = THDVAR(thd, async_commit) &&
+                              tx->get_write_count() > 0 &&
+                              !tx->is_dd_transaction() && tx->is_sync() &&
+                              thd->can_defer_commit_ack();
+      if (defer_sync) tx->set_sync(false);
       if (tx->commit()) {
         DBUG_RETURN(HA_ERR_ROCKSDB_COMMIT_FAILED);
       }
+      if (defer_sync) {
+        thd->defer_commit_ack(&rdb_commit_ack_waiter,
+                              rdb->GetLatestSequenceNumber());
+      }
     } else {
       /*
         We get here when committing a statement within a transaction.
@@ -6980,6 +8173,14 @@ std::vector<Rdb_trx_info> rdb_get_all_trx_info() {
   return trx_info;
 }
 
+/*
+  returns the partial index groups queued for materialization
+  for use by information_schema.rocksdb_partial_index_queue
+*/
+std::vector<Rdb_partial_index_request> rdb_get_partial_index_queue() {
+  return rdb_pi_thread.get_requests();
+}
+
 /*
   returns a vector of info of recent deadlocks
   for use by information_schema.rocksdb_deadlock
@@ -7927,6 +9128,14 @@ static int rocksdb_init_internal(void *const p) {
         reinterpret_cast<SERVICE_TYPE_NO_CONST(mysql_command_error_info) *>(
             h_command_srv);
   }
+  if (reg_srv->acquire_related("mysql_command_thread", h_command_factory_srv,
+                               &h_command_srv)) {
+    DBUG_RETURN(HA_EXIT_FAILURE);
+  } else {
+    mysql_service_mysql_command_thread =
+        reinterpret_cast<SERVICE_TYPE_NO_CONST(mysql_command_thread) *>(
+            h_command_srv);
+  }
   cmd_srv_helper = std::make_unique<Rdb_cmd_srv_helper>(
       mysql_service_mysql_command_factory, mysql_service_mysql_command_options,
       mysql_service_mysql_command_query,
@@ -7968,6 +9177,42 @@ static int rocksdb_init_internal(void *const p) {
   }
 #endif
 
+  const bool tiered = rocksdb_cold_data_dir != nullptr && *rocksdb_cold_data_dir;
+  if ((tiered || rocksdb_io_latency_histograms) &&
+      rocksdb_db_options->env != rocksdb::Env::Default()) {
+    // NO_LINT_DEBUG
+    LogPluginErrMsg(WARNING_LEVEL, ER_LOG_PRINTF_MSG,
+                    "RocksDB: I/O latency histograms and the cold data "
+                    "directory are only supported on the default "
+                    "environment.");
+  } else if (tiered || rocksdb_io_latency_histograms) {
+    std::shared_ptr<rocksdb::FileSystem> fs =
+        rocksdb_db_options->env->GetFileSystem();
+    if (tiered) {
+      std::string cold_dir(rocksdb_cold_data_dir);
+      while (cold_dir.size() > 1 && cold_dir.back() == '/') cold_dir.pop_back();
+      const auto s = (cold_dir[0] == '/')
+                         ? fs->CreateDirIfMissing(cold_dir,
+                                                  rocksdb::IOOptions(), nullptr)
+                         : rocksdb::IOStatus::InvalidArgument("relative path");
+      if (!s.ok()) {
+        // NO_LINT_DEBUG
+        LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                        "RocksDB: rocksdb_cold_data_dir %s must be an absolute "
+                        "path to a directory that can be created: %s",
+                        rocksdb_cold_data_dir, s.ToString().c_str());
+        DBUG_RETURN(HA_EXIT_FAILURE);
+      }
+      fs = std::make_shared<Rdb_tiered_fs>(fs, cold_dir);
+    }
+    if (rocksdb_io_latency_histograms) {
+      io_latency_fs = std::make_shared<Rdb_io_latency_fs>(fs);
+      fs = io_latency_fs;
+    }
+    wrapped_fs_env = rocksdb::NewCompositeEnv(fs);
+    rocksdb_db_options->env = wrapped_fs_env.get();
+  }
+
   clone::fixup_on_startup();
   move_wals_to_target_dir();
 
@@ -8017,11 +9262,16 @@ static int rocksdb_init_internal(void *const p) {
                            rdb_signal_drop_idx_psi_cond_key);
   rdb_is_thread.init(rdb_signal_is_psi_mutex_key, rdb_signal_is_psi_cond_key);
   rdb_mc_thread.init(rdb_signal_mc_psi_mutex_key, rdb_signal_mc_psi_cond_key);
+  rdb_pi_thread.init(rdb_signal_pi_psi_mutex_key, rdb_signal_pi_psi_cond_key);
+  rdb_setup_thread.init(rdb_signal_setup_psi_mutex_key,
+                        rdb_signal_setup_psi_cond_key);
 #else
   rdb_bg_thread.init();
   rdb_drop_idx_thread.init();
   rdb_is_thread.init();
   rdb_mc_thread.init();
+  rdb_pi_thread.init();
+  rdb_setup_thread.init();
 #endif
   rdb_collation_data_mutex.init(rdb_collation_data_mutex_key,
                                 MY_MUTEX_INIT_FAST);
@@ -8068,6 +9318,7 @@ static int rocksdb_init_internal(void *const p) {
       rocksdb_update_binlog_ttl_compaction_ts;
   rocksdb_hton->is_user_table_blocked = rocksdb_user_table_blocked;
   rocksdb_hton->bypass_select_by_key = rocksdb_select_by_key;
+  rocksdb_hton->add_engine_counters = rocksdb_add_engine_counters;
 
   rocksdb_hton->clone_interface.clone_capability = rocksdb_clone_get_capability;
   rocksdb_hton->clone_interface.clone_begin = rocksdb_clone_begin;
@@ -8092,7 +9343,9 @@ static int rocksdb_init_internal(void *const p) {
   rocksdb_hton->dict_recover = rocksdb_dict_recover;
   rocksdb_hton->dict_cache_reset = rocksdb_dict_cache_reset;
 
-  rocksdb_hton->flags = HTON_SUPPORTS_EXTENDED_KEYS | HTON_CAN_RECREATE;
+  rocksdb_hton->flags = HTON_SUPPORTS_EXTENDED_KEYS | HTON_CAN_RECREATE |
+                        HTON_SUPPORTS_SECONDARY_ENGINE |
+                        HTON_SUPPORTS_RESULT_CACHE;
 
   rocksdb_hton->partition_flags = rocksdb_partition_flags;
 
@@ -8109,6 +9362,8 @@ static int rocksdb_init_internal(void *const p) {
   }
 
   rdb_read_free_regex_handler.set_patterns(DEFAULT_READ_FREE_RPL_TABLES);
+  rdb_set_perf_context_sample_statements(
+      rocksdb_perf_context_sample_statements);
 
   rocksdb_stats = rocksdb::CreateDBStatistics();
   rocksdb_stats->set_stats_level(
@@ -8140,6 +9395,27 @@ static int rocksdb_init_internal(void *const p) {
   rocksdb_db_options->track_and_verify_wals_in_manifest =
       rocksdb_track_and_verify_wals_in_manifest;
 
+  if (rocksdb_db_options->enable_pipelined_write &&
+      rocksdb_db_options->two_write_queues) {
+    // Pipelined writes are not supported with two write queues, which are
+    // on by default. The second queue only serves the prepare phase of the
+    // write prepared and unprepared policies.
+    if (rocksdb_write_policy == rocksdb::TxnDBWritePolicy::WRITE_COMMITTED) {
+      // NO_LINT_DEBUG
+      LogPluginErrMsg(WARNING_LEVEL, ER_LOG_PRINTF_MSG,
+                      "RocksDB: Turning off two_write_queues, as "
+                      "enable_pipelined_write is on\n");
+      rocksdb_db_options->two_write_queues = false;
+    } else {
+      // NO_LINT_DEBUG
+      LogPluginErrMsg(WARNING_LEVEL, ER_LOG_PRINTF_MSG,
+                      "RocksDB: Turning off enable_pipelined_write, as "
+                      "two_write_queues is on and write_policy is not "
+                      "write_committed\n");
+      rocksdb_db_options->enable_pipelined_write = false;
+    }
+  }
+
   if (rocksdb_db_options->allow_mmap_reads &&
       rocksdb_db_options->use_direct_reads) {
     // allow_mmap_reads implies !use_direct_reads and RocksDB will not open if
@@ -8526,6 +9802,15 @@ static int rocksdb_init_internal(void *const p) {
   rocksdb::TransactionDBOptions tx_db_options;
   tx_db_options.transaction_lock_timeout = 2000;  // 2 seconds
   tx_db_options.custom_mutex_factory = std::make_shared<Rdb_mutex_factory>();
+  // The default 16 stripes have concurrent writers of a hot table wait on
+  // the mutexes of each other's rows.
+  if (rocksdb_lock_stripes == 0) {
+    rocksdb_lock_stripes = 16;
+    while (rocksdb_lock_stripes < 4 * std::thread::hardware_concurrency() &&
+           rocksdb_lock_stripes < 1024)
+      rocksdb_lock_stripes *= 2;
+  }
+  tx_db_options.num_stripes = rocksdb_lock_stripes;
   tx_db_options.write_policy =
       static_cast<rocksdb::TxnDBWritePolicy>(rocksdb_write_policy);
 
@@ -8548,8 +9833,11 @@ static int rocksdb_init_internal(void *const p) {
   // NO_LINT_DEBUG
   LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
                   "RocksDB: Opening TransactionDB...");
-  status = rocksdb::TransactionDB::Open(
-      main_opts, tx_db_options, rocksdb_datadir, cf_descr, &cf_handles, &rdb);
+  status = st_rdb_exec_time.exec("rocksdb::TransactionDB::Open", [&]() {
+    return rocksdb::TransactionDB::Open(main_opts, tx_db_options,
+                                        rocksdb_datadir, cf_descr, &cf_handles,
+                                        &rdb);
+  });
 
   DBUG_EXECUTE_IF("rocksdb_init_failure_open_db", {
     // Simulate opening TransactionDB failure
@@ -8563,6 +9851,9 @@ static int rocksdb_init_internal(void *const p) {
     DBUG_RETURN(HA_EXIT_FAILURE);
   }
 
+  // Before anything is written, to tell if the DDL snapshot is current
+  const rocksdb::SequenceNumber open_seq = rdb->GetLatestSequenceNumber();
+
   if (rocksdb_file_checksums >=
       file_checksums_type::CHECKSUMS_WRITE_AND_VERIFY) {
     LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
@@ -8623,8 +9914,12 @@ static int rocksdb_init_internal(void *const p) {
                   "RocksDB: Initializing DDL Manager...");
 
   if (st_rdb_exec_time.exec("Rdb_ddl_manager::init", [&]() {
-        return ddl_manager.init(&dict_manager, &cf_manager,
-                                rocksdb_validate_tables);
+        return ddl_manager.init(
+            &dict_manager, &cf_manager, rocksdb_validate_tables,
+            rocksdb_ddl_snapshot
+                ? rdb_concat_paths(rocksdb_datadir, "ddl_snapshot")
+                : "",
+            open_seq);
       })) {
     // NO_LINT_DEBUG
     LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
@@ -8714,6 +10009,37 @@ static int rocksdb_init_internal(void *const p) {
     DBUG_RETURN(HA_EXIT_FAILURE);
   }
 
+  err = rdb_pi_thread.create_thread(PARTIAL_INDEX_THREAD_NAME
+#ifdef HAVE_PSI_INTERFACE
+                                    ,
+                                    rdb_pi_psi_thread_key
+#endif
+  );
+  if (err != 0) {
+    // NO_LINT_DEBUG
+    LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                    "RocksDB: Couldn't start the partial index materialization "
+                    "thread: (errno=%d)",
+                    err);
+    DBUG_RETURN(HA_EXIT_FAILURE);
+  }
+
+  if (rocksdb_vector_index_setup_threads) {
+    err = rdb_setup_thread.create_thread(INDEX_SETUP_THREAD_NAME
+#ifdef HAVE_PSI_INTERFACE
+                                         ,
+                                         rdb_setup_psi_thread_key
+#endif
+    );
+    if (err != 0) {
+      // NO_LINT_DEBUG
+      LogPluginErrMsg(
+          ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+          "RocksDB: Couldn't start the index setup thread: (errno=%d)", err);
+      DBUG_RETURN(HA_EXIT_FAILURE);
+    }
+  }
+
   DBUG_EXECUTE_IF("rocksdb_init_failure_threads",
                   { DBUG_RETURN(HA_EXIT_FAILURE); });
 
@@ -8765,6 +10091,8 @@ static int rocksdb_init_internal(void *const p) {
 #endif
 
   compaction_stats.resize_history(rocksdb_max_compaction_history);
+  rdb_get_vector_value_cache().set_capacity(rocksdb_vector_value_cache_size);
+  rdb_get_vector_list_cache().set_capacity(rocksdb_vector_list_cache_size);
 
   // Remove tables that may have been leftover during truncation
   rocksdb_truncation_table_cleanup();
@@ -8827,6 +10155,12 @@ static int rocksdb_shutdown(bool minimalShutdown) {
     // signal the manual compaction thread to stop
     rdb_mc_thread.signal(true);
 
+    // signal the partial index materialization thread to stop
+    rdb_pi_thread.signal(true);
+
+    // signal the index setup thread to stop
+    rdb_setup_thread.signal(true);
+
     // Wait for the background thread to finish.
     // NO_LINT_DEBUG
     LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
@@ -8880,6 +10214,34 @@ static int rocksdb_shutdown(bool minimalShutdown) {
           err);
     }
 
+    // Wait for the partial index materialization thread to finish.
+    // NO_LINT_DEBUG
+    LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
+                    "Waiting for MyRocks partial index thread to finish");
+    err = rdb_pi_thread.join();
+    if (err != 0) {
+      // NO_LINT_DEBUG
+      LogPluginErrMsg(
+          ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+          "RocksDB: Couldn't stop the partial index materialization thread: "
+          "(errno=%d)",
+          err);
+    }
+
+    if (rocksdb_vector_index_setup_threads) {
+      // Wait for the index setup thread to finish.
+      // NO_LINT_DEBUG
+      LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
+                      "Waiting for MyRocks index setup thread to finish");
+      err = rdb_setup_thread.join();
+      if (err != 0) {
+        // NO_LINT_DEBUG
+        LogPluginErrMsg(
+            ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+            "RocksDB: Couldn't stop the index setup thread: (errno=%d)", err);
+      }
+    }
+
     if (rdb_open_tables.count()) {
       // Looks like we are getting unloaded and yet we have some open tables
       // left behind.
@@ -8908,6 +10270,7 @@ static int rocksdb_shutdown(bool minimalShutdown) {
       it = nullptr;
     }
 
+    if (rocksdb_ddl_snapshot) ddl_manager.write_snapshot();
     ddl_manager.cleanup();
     binlog_manager.cleanup();
     dict_manager.cleanup();
@@ -8915,6 +10278,7 @@ static int rocksdb_shutdown(bool minimalShutdown) {
     clone::client_shutdown();
     clone::donor_shutdown();
 
+    Rdb_shared_snapshot::release();
     delete rdb;
     rdb = nullptr;
 
@@ -8975,6 +10339,11 @@ static int rocksdb_shutdown(bool minimalShutdown) {
         const_cast<SERVICE_TYPE_NO_CONST(mysql_command_error_info) *>(
             mysql_service_mysql_command_error_info)));
   }
+  if (mysql_service_mysql_command_thread) {
+    reg_srv->release(reinterpret_cast<my_h_service>(
+        const_cast<SERVICE_TYPE_NO_CONST(mysql_command_thread) *>(
+            mysql_service_mysql_command_thread)));
+  }
 
 #ifdef MYSQL_DYNAMIC_PLUGIN
   deinit_logging_service_for_plugin(&reg_srv, &log_bi, &log_bs);
@@ -9006,7 +10375,7 @@ static int rocksdb_init_func(void *const p) {
   return ret;
 }
 
-int get_table_info(std::string cf_name, std::vector<rocksdb::BlockBasedTableOptions::FieldInfo>* field_info_list,
+static int load_table_info(const std::string &cf_name, std::vector<rocksdb::BlockBasedTableOptions::FieldInfo>* field_info_list,
                           rocksdb::BlockBasedTableOptions::TableConfig *table_config) {
   // Retrieve field info list and table config if exists
     // log_to_file("cf_name: " + cf_name);
@@ -9083,20 +10452,310 @@ int get_table_info(std::string cf_name, std::vector<rocksdb::BlockBasedTableOpti
     return 1;
 }
 
-
+namespace {
 /**
-  @brief
-  Example of simple lock controls. The "table_handler" it creates is a
-  structure we will pass to each ha_rocksdb handler. Do you have to have
-  one of these? Well, you have pieces that are used for locking, and
-  they are needed to function.
+  parsed table_options files of a column family. vector queries ask for
+  them on every search, the files only change when create_cfs rewrites them
+  or the column family is dropped, which invalidate the entry.
 */
+struct Rdb_table_info {
+  std::vector<rocksdb::BlockBasedTableOptions::FieldInfo> m_field_info_list;
+  rocksdb::BlockBasedTableOptions::TableConfig m_table_config;
+};
 
-Rdb_table_handler *Rdb_open_tables_map::get_table_handler(
-    const char *const table_name) {
-  assert(table_name != nullptr);
-
-  Rdb_table_handler *table_handler;
+std::mutex rdb_table_info_mutex;
+std::unordered_map<std::string, std::shared_ptr<const Rdb_table_info>>
+    rdb_table_info_cache;
+// bumped by every invalidation, so a load that raced with one is not cached
+uint64_t rdb_table_info_version = 0;
+}  // namespace
+
+int get_table_info(std::string cf_name, std::vector<rocksdb::BlockBasedTableOptions::FieldInfo>* field_info_list,
+                          rocksdb::BlockBasedTableOptions::TableConfig *table_config) {
+  uint64_t version;
+  {
+    std::lock_guard<std::mutex> lock(rdb_table_info_mutex);
+    const auto it = rdb_table_info_cache.find(cf_name);
+    if (it != rdb_table_info_cache.end()) {
+      field_info_list->insert(field_info_list->end(),
+                              it->second->m_field_info_list.begin(),
+                              it->second->m_field_info_list.end());
+      *table_config = it->second->m_table_config;
+      return 0;
+    }
+    version = rdb_table_info_version;
+  }
+
+  // failures are not cached, the files may show up with the next ddl
+  auto table_info = std::make_shared<Rdb_table_info>();
+  const int ret = load_table_info(cf_name, &table_info->m_field_info_list,
+                                  &table_info->m_table_config);
+  if (ret) {
+    return ret;
+  }
+  field_info_list->insert(field_info_list->end(),
+                          table_info->m_field_info_list.begin(),
+                          table_info->m_field_info_list.end());
+  *table_config = table_info->m_table_config;
+
+  std::lock_guard<std::mutex> lock(rdb_table_info_mutex);
+  if (version == rdb_table_info_version) {
+    rdb_table_info_cache.emplace(cf_name, std::move(table_info));
+  }
+  return 0;
+}
+
+void rdb_invalidate_table_info(const std::string &cf_name) {
+  std::lock_guard<std::mutex> lock(rdb_table_info_mutex);
+  rdb_table_info_cache.erase(cf_name);
+  rdb_table_info_version++;
+}
+
+// Helper function to extract a specific field from an encoded value slice
+uint DecodeFieldFromValue(
+    rocksdb::BlockBasedTableOptions::TableConfig& table_config,
+    std::vector<rocksdb::BlockBasedTableOptions::FieldInfo>& field_info_list,
+    std::vector<size_t>& field_indexs,
+    const rocksdb::Slice& value,
+    std::vector<rocksdb::Slice>* field_values) {
+  // Clear the output vector first
+  field_values->clear();
+
+  // 1. Setup string reader for value slice  
+  const char* pos = value.data();
+  size_t remaining = value.size();
+
+  // 2. Skip TTL bytes if configured
+  if (table_config.has_ttl) {
+    if (remaining < 8) {
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    pos += 8;
+    remaining -= 8;
+  }
+
+  // 3. Process null bytes
+  const char* null_bytes = nullptr;
+  if (table_config.null_bytes_length > 0) {
+    if (remaining < table_config.null_bytes_length) {
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    null_bytes = pos;
+    pos += table_config.null_bytes_length;
+    remaining -= table_config.null_bytes_length;
+  }
+
+  // 4. Skip unpack info if configured
+  // temporarily commented out as unpack info set wrongly in test dataset
+
+  // if (table_options.table_config.has_unpack_info) {
+  //   if (remaining < 3) {
+  //     return Status::Corruption("Value too short for unpack info header");
+  //   }
+  //   // Validate unpack info tag
+  //   if (pos[0] != 0) { // First byte should be tag=0
+  //     return Status::Corruption("Invalid unpack info tag");
+  //   }
+  //   // Get unpack info length from next 2 bytes
+  //   uint16_t unpack_len = *reinterpret_cast<const uint16_t*>(pos + 1);
+  //   if (remaining < unpack_len) {
+  //     return Status::Corruption("Value too short for unpack info data");
+  //   }
+  //   pos += unpack_len;
+  //   remaining -= unpack_len;
+  // }
+
+  // 5. Find target field info 
+  // If field_indexs is empty, return an empty result
+  if (field_indexs.empty()) {
+    return HA_EXIT_SUCCESS;
+  }
+  
+  // Find the maximum field index to determine how far we need to scan
+  size_t max_field_index = 0;
+  for (size_t idx : field_indexs) {
+    if (idx >= field_info_list.size()) {
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    max_field_index = std::max(max_field_index, idx);
+  }
+
+  // Pre-allocate the output vector
+  field_values->resize(field_indexs.size());
+
+  // Create a mapping from field index to position in result vector
+  std::unordered_map<size_t, size_t> index_to_result_pos;
+  for (size_t i = 0; i < field_indexs.size(); i++) {
+    index_to_result_pos[field_indexs[i]] = i;
+  }
+
+  // Parse through all fields up to max_field_index
+  for (size_t i = 0; i <= max_field_index; i++) {
+    const auto& field_info = field_info_list[i];
+
+    // Check if current field is null
+    bool is_null = false;
+    if (field_info.is_nullable && null_bytes != nullptr) {
+      is_null = (null_bytes[i/8] & (1 << (i%8))) != 0;
+    }
+
+    // Check if this field is in our target list
+    bool is_target_field = index_to_result_pos.find(i) != index_to_result_pos.end();
+
+    if (is_null) {
+      // If this is a target field, add an empty slice to the result
+      if (is_target_field) {
+        (*field_values)[index_to_result_pos[i]] = rocksdb::Slice();
+      }
+      // Skip to next field (no data to skip for null fields)
+      continue;
+    }
+
+    // Handle field data based on type
+    if (field_info.type == MYSQL_TYPE_VARCHAR) {
+      if (remaining < field_info.length_bytes) {
+        return HA_ERR_ROCKSDB_CORRUPT_DATA;
+      }
+      size_t len = (field_info.length_bytes == 1) ? 
+                  static_cast<uint8_t>(pos[0]) : *reinterpret_cast<const uint16_t*>(pos);
+      pos += field_info.length_bytes;
+      remaining -= field_info.length_bytes;
+      
+      if (remaining < len) {
+        return HA_ERR_ROCKSDB_CORRUPT_DATA;
+      }
+      
+      // If this is a target field, add it to the result
+      if (is_target_field) {
+        (*field_values)[index_to_result_pos[i]] = rocksdb::Slice(pos, len);
+      }
+      
+      // Move past this field's data
+      pos += len;
+      remaining -= len;
+    } else if (field_info.type == MYSQL_TYPE_BLOB || 
+               field_info.type == MYSQL_TYPE_JSON || 
+               field_info.type == MYSQL_TYPE_GEOMETRY) {
+      if (remaining < field_info.length_bytes) {
+        return HA_ERR_ROCKSDB_CORRUPT_DATA;
+      }
+      size_t len = 0;
+      memcpy(&len, pos, field_info.length_bytes);
+      pos += field_info.length_bytes;
+      remaining -= field_info.length_bytes;
+      
+      if (remaining < len) {
+        return HA_ERR_ROCKSDB_CORRUPT_DATA;
+      }
+      
+      // If this is a target field, add it to the result
+      if (is_target_field) {
+        (*field_values)[index_to_result_pos[i]] = rocksdb::Slice(pos, len);
+      }
+      
+      // Move past this field's data
+      pos += len;
+      remaining -= len;
+    } else {
+      // Fixed length field
+      if (remaining < field_info.pack_length) {
+        return HA_ERR_ROCKSDB_CORRUPT_DATA;
+      }
+      
+      // If this is a target field, add it to the result
+      if (is_target_field) {
+        (*field_values)[index_to_result_pos[i]] = rocksdb::Slice(pos, field_info.pack_length);
+      }
+      
+      // Move past this field's data
+      pos += field_info.pack_length;
+      remaining -= field_info.pack_length;
+    }
+  }
+
+  return HA_EXIT_SUCCESS;
+}
+
+Rdb_point_value_layout rdb_point_value_layout(
+    const rocksdb::BlockBasedTableOptions::TableConfig &table_config,
+    const std::vector<rocksdb::BlockBasedTableOptions::FieldInfo>
+        &field_info_list,
+    size_t field_index) {
+  Rdb_point_value_layout layout;
+  if (field_index >= field_info_list.size() ||
+      field_info_list[field_index].type != MYSQL_TYPE_GEOMETRY) {
+    return layout;
+  }
+
+  // the same prefix DecodeFieldFromValue skips
+  const long ttl_bytes = table_config.has_ttl ? 8 : 0;
+  long offset = ttl_bytes + table_config.null_bytes_length;
+  for (size_t i = 0; i < field_index; i++) {
+    const auto &field_info = field_info_list[i];
+    if ((field_info.is_nullable && table_config.null_bytes_length > 0) ||
+        field_info.type == MYSQL_TYPE_VARCHAR ||
+        field_info.type == MYSQL_TYPE_BLOB ||
+        field_info.type == MYSQL_TYPE_JSON ||
+        field_info.type == MYSQL_TYPE_GEOMETRY) {
+      return layout;
+    }
+    offset += field_info.pack_length;
+  }
+
+  const auto &point_info = field_info_list[field_index];
+  if (point_info.is_nullable && table_config.null_bytes_length > 0) {
+    layout.m_null_offset = ttl_bytes + field_index / 8;
+    layout.m_null_mask = 1 << (field_index % 8);
+  }
+  layout.m_length_bytes = point_info.length_bytes;
+  layout.m_offset = offset;
+  return layout;
+}
+
+bool rdb_point_from_value(const Rdb_point_value_layout &layout,
+                          const rocksdb::Slice &value, double *lon,
+                          double *lat) {
+  assert(layout.fixed());
+  const char *const data = value.data();
+  if (layout.m_null_mask != 0 &&
+      (static_cast<size_t>(layout.m_null_offset) >= value.size() ||
+       (data[layout.m_null_offset] & layout.m_null_mask) != 0)) {
+    return false;
+  }
+
+  const size_t start = layout.m_offset + layout.m_length_bytes;
+  if (layout.m_length_bytes > sizeof(size_t) ||
+      value.size() < start + RDB_WKB_POINT_SIZE) {
+    return false;
+  }
+  size_t length = 0;
+  memcpy(&length, data + layout.m_offset, layout.m_length_bytes);
+  // srid, little endian byte order and the point type, then lon and lat
+  const char *const geometry = data + start;
+  uint32_t wkb_type = 0;
+  memcpy(&wkb_type, geometry + 5, sizeof(wkb_type));
+  if (length != RDB_WKB_POINT_SIZE || geometry[4] != 1 || wkb_type != 1) {
+    return false;
+  }
+  memcpy(lon, geometry + 9, sizeof(double));
+  memcpy(lat, geometry + 17, sizeof(double));
+  return true;
+}
+
+
+/**
+  @brief
+  Example of simple lock controls. The "table_handler" it creates is a
+  structure we will pass to each ha_rocksdb handler. Do you have to have
+  one of these? Well, you have pieces that are used for locking, and
+  they are needed to function.
+*/
+
+Rdb_table_handler *Rdb_open_tables_map::get_table_handler(
+    const char *const table_name) {
+  assert(table_name != nullptr);
+
+  Rdb_table_handler *table_handler;
 
   std::string table_name_str(table_name);
 
@@ -9429,6 +11088,8 @@ ha_rocksdb::ha_rocksdb(my_core::handlerton *const hton,
       m_no_read_locking(false),
       mrr_rowid_reader(nullptr),
       mrr_n_elements(0),
+      mrr_async(false),
+      mrr_half(0),
       mrr_enabled_keyread(false),
       mrr_used_cpk(false),
       m_in_rpl_delete_rows(false),
@@ -9642,7 +11303,17 @@ int ha_rocksdb::convert_record_from_storage_format(
 int ha_rocksdb::convert_record_from_storage_format(
     const rocksdb::Slice *const key, const rocksdb::Slice *const value,
     uchar *const buf) {
-  auto rc = m_converter->decode(*m_pk_descr, buf, key, value);
+  int rc;
+  if (ha_thd()->lex->is_explain_analyze) {
+    const auto start = std::chrono::steady_clock::now();
+    rc = m_converter->decode(*m_pk_descr, buf, key, value);
+    rdb_explain_decode_ns +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count();
+  } else {
+    rc = m_converter->decode(*m_pk_descr, buf, key, value);
+  }
 
   DBUG_EXECUTE_IF(
       "simulate_corrupt_data_read", if (m_tbl_def->full_tablename() == "a.t1") {
@@ -10184,6 +11855,22 @@ int ha_rocksdb::create_key_defs(
     }
   }
 
+  /*
+    The vector and spatial indexes decode the PK values in the order of the
+    columns, see DecodeFieldFromValue().
+  */
+  if (tbl_def_arg.m_key_descr_arr[pk_index(table_arg, tbl_def_arg)]
+          ->has_fixed_offsets()) {
+    for (uint i = 0; i < tbl_def_arg.m_key_count; i++) {
+      const Rdb_key_def &kd = *tbl_def_arg.m_key_descr_arr[i];
+      if (kd.is_vector_index() || kd.is_next_spatial_index()) {
+        my_error(ER_NOT_SUPPORTED_YET, MYF(0),
+                 "fixed_offsets with vector or spatial indexes");
+        DBUG_RETURN(HA_EXIT_FAILURE);
+      }
+    }
+  }
+
   DBUG_RETURN(HA_EXIT_SUCCESS);
 }
 
@@ -10296,8 +11983,20 @@ bool ha_rocksdb::create_cfs(
   // Then populate field info list
   std::vector<rocksdb::BlockBasedTableOptions::FieldInfo> field_info_list;
   field_info_list.clear();
+  /*
+    fixed_offsets tables store the fixed width fields first, and zero-fill
+    the NULL ones, see Rdb_converter::setup_field_encoders()
+  */
+  const bool fixed_offsets =
+      Rdb_key_def::extract_fixed_offsets(table_arg, tbl_def_arg);
+  std::vector<rocksdb::BlockBasedTableOptions::FieldInfo>
+      variable_field_info_list;
   for (uint i = 0; i < table_arg.s->fields; i++) {
     Field *field = table_arg.field[i];
+    // not stored in the value
+    if (fixed_offsets && field->is_virtual_gcol()) {
+      continue;
+    }
 
     // Skip if field is part of primary key
     bool is_pk_field = false;
@@ -10348,15 +12047,27 @@ bool ha_rocksdb::create_cfs(
     }
 
     // Set pack length for fixed length fields  
-    if (field->type() != MYSQL_TYPE_VARCHAR &&
-        field->type() != MYSQL_TYPE_BLOB &&
-        field->type() != MYSQL_TYPE_JSON &&
-        field->type() != MYSQL_TYPE_GEOMETRY) {
+    const bool fixed_length = field->type() != MYSQL_TYPE_VARCHAR &&
+                              field->type() != MYSQL_TYPE_BLOB &&
+                              field->type() != MYSQL_TYPE_JSON &&
+                              field->type() != MYSQL_TYPE_GEOMETRY;
+    if (fixed_length) {
       field_info.pack_length = field->pack_length();
     }
 
-    field_info_list.push_back(field_info);
+    if (!fixed_offsets) {
+      field_info_list.push_back(field_info);
+    } else if (fixed_length) {
+      // always pack_length bytes, whether NULL or not
+      field_info.is_nullable = false;
+      field_info_list.push_back(field_info);
+    } else {
+      variable_field_info_list.push_back(field_info);
+    }
   }
+  field_info_list.insert(field_info_list.end(),
+                         variable_field_info_list.begin(),
+                         variable_field_info_list.end());
 
   /*
     The first loop checks the index parameters and creates
@@ -10541,6 +12252,7 @@ bool ha_rocksdb::create_cfs(
           table_config_file << "  \"has_checksums\": " << (table_config.has_checksums ? "true" : "false") << "\n";
           table_config_file << "}\n";
           table_config_file.close();
+          rdb_invalidate_table_info(cf_name);
           updated_cf_names.insert(cf_name);
         }
       }
@@ -10842,6 +12554,10 @@ int ha_rocksdb::create_key_def(
   }
 
   uint32 index_flags = (ttl_duration > 0 ? Rdb_key_def::TTL_FLAG : 0);
+  if (index_type != Rdb_key_def::INDEX_TYPE_SECONDARY &&
+      Rdb_key_def::extract_fixed_offsets(table_arg, tbl_def_arg)) {
+    index_flags |= Rdb_key_def::FIXED_OFFSETS_FLAG;
+  }
 
   uint32 ttl_rec_offset =
       Rdb_key_def::has_index_flag(index_flags, Rdb_key_def::TTL_FLAG)
@@ -11511,6 +13227,350 @@ ulong ha_rocksdb::index_flags(uint inx, uint part, bool all_parts) const {
   return index_flags(m_pk_can_be_decoded, table_share, inx, part, all_parts);
 }
 
+/**
+  Replace the candidates of a quantized vector index by the LIMIT closest
+  ones. The rows of all the candidates are read with one MultiGet, and the
+  exact distances computed from their vectors against the query, as the
+  refine stage of faiss::IndexRefine. MAXSIM scores are left to the
+  distance function.
+
+  @return
+    HA_EXIT_SUCCESS  OK
+    other            HA_ERR error code (can be SE-specific)
+*/
+int ha_rocksdb::vector_index_rerank(const Rdb_key_def &kd, uchar *const buf) {
+  auto vector_db_handler = get_vector_db_handler();
+  Item_func_fb_vector_distance *distance_func =
+      vector_db_handler->distance_func();
+  const bool maxsim = distance_func->functype() == Item_func::FB_VECTOR_MAXSIM;
+  Rdb_vector_result rows;
+  std::string vector_index_key;
+  std::vector<float> vector;
+  for (; vector_db_handler->has_more_results();
+       vector_db_handler->next_result()) {
+    int rc = vector_db_handler->current_key(vector_index_key);
+    if (rc) {
+      return rc;
+    }
+    const rocksdb::Slice key(vector_index_key);
+    const uint size =
+        kd.get_primary_key_tuple(*m_pk_descr, &key, m_pk_packed_tuple);
+    if (size == RDB_INVALID_KEY_LEN) {
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    m_last_rowkey.copy((const char *)m_pk_packed_tuple, size, &my_charset_bin);
+    bool skip_row = false;
+    rc = candidate_row_read(kd, buf, &skip_row, SIZE_MAX);
+    if (rc == HA_ERR_KEY_NOT_FOUND || skip_row) {
+      // row is gone or expired, the index will not return it either
+      continue;
+    }
+    if (rc) {
+      return rc;
+    }
+    if (maxsim) {
+      const double distance = distance_func->val_real();
+      if (distance_func->null_value) {
+        continue;
+      }
+      rows.emplace_back(vector_index_key, distance);
+      continue;
+    }
+    rc = kd.read_vector(table, buf, &vector);
+    if (rc) {
+      return rc;
+    }
+    if (vector.empty()) {
+      // a NULL vector has no distance
+      continue;
+    }
+    rows.emplace_back(vector_index_key,
+                      vector_db_handler->exact_distance(vector));
+  }
+  vector_db_handler->set_reranked_result(std::move(rows));
+  return HA_EXIT_SUCCESS;
+}
+
+/**
+  Fuse the knn results with the matches of the MATCH ... AGAINST term of
+  the ORDER BY, searched for as many rows in the same transaction. The
+  fused results are rowids, ranked by rocksdb_vector_text_fusion.
+
+  @return
+    HA_EXIT_SUCCESS  OK
+    other            HA_ERR error code (can be SE-specific)
+*/
+int ha_rocksdb::vector_index_fuse_text(const Rdb_key_def &kd) {
+  auto vector_db_handler = get_vector_db_handler();
+  auto *search = static_cast<Rdb_fulltext_search *>(
+      vector_db_handler->text_relevance()->ft_handler);
+  if (search == nullptr) {
+    // the search is made by init_ftfuncs, which the plan did not run
+    return HA_EXIT_SUCCESS;
+  }
+
+  Rdb_vector_result rows;
+  vector_db_handler->knn_results(&rows);
+  // lsm and sparse index keys are already pks
+  if (kd.get_vector_index_config().type() != FB_VECTOR_INDEX_TYPE::LSMIDX &&
+      !kd.is_sparse_vector_index()) {
+    for (auto &row : rows) {
+      const rocksdb::Slice key(row.first);
+      const uint size =
+          kd.get_primary_key_tuple(*m_pk_descr, &key, m_pk_packed_tuple);
+      if (size == RDB_INVALID_KEY_LEN) {
+        return HA_ERR_ROCKSDB_CORRUPT_DATA;
+      }
+      row.first.assign(reinterpret_cast<const char *>(m_pk_packed_tuple),
+                       size);
+    }
+  }
+
+  const ha_rows limit = vector_db_handler->distance_func()->m_limit;
+  search->set_limit(std::max<ha_rows>(rows.size(), limit));
+  const int rc = search->execute();
+  if (rc) {
+    return rc;
+  }
+  THD *const thd = ha_thd();
+  vector_db_handler->fuse_text_matches(
+      std::move(rows), search->matches(), search->has_all_matches(),
+      THDVAR(thd, vector_text_fusion) == VECTOR_TEXT_RRF,
+      THDVAR(thd, vector_text_rrf_k));
+  return HA_EXIT_SUCCESS;
+}
+
+/**
+  The leading pk columns the pushed condition of a vector index search
+  fixes with equalities to constants, e.g. the tenant of a table shared by
+  many tenants.
+
+  @param      pk_index_cond  condition on the pk columns
+  @param[out] prefix         the columns packed as in the keys, without the
+                             index id, empty when no leading column is fixed
+  @param[out] rows           estimated number of rows with the prefix
+*/
+void ha_rocksdb::vector_index_pk_prefix(Item *pk_index_cond,
+                                        std::string *prefix, ha_rows *rows) {
+  prefix->clear();
+  *rows = 0;
+  if (has_hidden_pk(*table)) {
+    return;
+  }
+
+  // the condition is an equality or an AND of conditions
+  std::vector<Item_func *> equalities;
+  const auto add_equality = [&equalities](Item *item) {
+    if (item->type() == Item::FUNC_ITEM &&
+        down_cast<Item_func *>(item)->functype() == Item_func::EQ_FUNC) {
+      equalities.push_back(down_cast<Item_func *>(item));
+    }
+  };
+  if (pk_index_cond->type() == Item::COND_ITEM &&
+      down_cast<Item_cond *>(pk_index_cond)->functype() ==
+          Item_func::COND_AND_FUNC) {
+    for (Item &item : *down_cast<Item_cond *>(pk_index_cond)->argument_list()) {
+      add_equality(&item);
+    }
+  } else {
+    add_equality(pk_index_cond);
+  }
+
+  // store the constants in the record to pack them, only those that fit
+  // the column exactly fix it
+  THD *const thd = ha_thd();
+  const enum_check_fields saved_check_fields =
+      thd->check_for_truncated_fields;
+  thd->check_for_truncated_fields = CHECK_FIELD_IGNORE;
+  my_bitmap_map *const old_write_map =
+      dbug_tmp_use_all_columns(table, table->write_set);
+  my_bitmap_map *const old_read_map =
+      dbug_tmp_use_all_columns(table, table->read_set);
+  const auto fix_column = [&equalities](Field *field) {
+    if (field->result_type() != INT_RESULT &&
+        field->result_type() != STRING_RESULT) {
+      return false;
+    }
+    for (Item_func *equality : equalities) {
+      for (uint i = 0; i < 2; i++) {
+        Item *const column = equality->arguments()[i]->real_item();
+        Item *const value = equality->arguments()[1 - i];
+        if (column->type() != Item::FIELD_ITEM ||
+            down_cast<Item_field *>(column)->field != field ||
+            !value->const_for_execution() || value->is_expensive() ||
+            value->result_type() != field->result_type() ||
+            (field->result_type() == STRING_RESULT &&
+             value->collation.collation != field->charset())) {
+          continue;
+        }
+        if (value->save_in_field(field, false) == TYPE_OK &&
+            !field->is_null()) {
+          return true;
+        }
+      }
+    }
+    return false;
+  };
+  const KEY &pk_info = table->key_info[table->s->primary_key];
+  uint parts = 0;
+  uint length = 0;
+  while (parts < pk_info.user_defined_key_parts &&
+         fix_column(pk_info.key_part[parts].field)) {
+    length += pk_info.key_part[parts].store_length;
+    parts++;
+  }
+  uchar key[MAX_KEY_LENGTH];
+  if (parts > 0) {
+    key_copy(key, table->record[0], &pk_info, length);
+  }
+  dbug_tmp_restore_column_map(table->read_set, old_read_map);
+  dbug_tmp_restore_column_map(table->write_set, old_write_map);
+  thd->check_for_truncated_fields = saved_check_fields;
+  if (parts == 0) {
+    return;
+  }
+
+  const key_part_map keypart_map = make_prev_keypart_map(parts);
+  const uint size = m_pk_descr->pack_index_tuple(
+      table, m_pack_buffer, m_pk_packed_tuple, key, keypart_map);
+  prefix->assign(
+      reinterpret_cast<const char *>(m_pk_packed_tuple) +
+          Rdb_key_def::INDEX_NUMBER_SIZE,
+      size - Rdb_key_def::INDEX_NUMBER_SIZE);
+
+  key_range min_key{key, length, keypart_map, HA_READ_KEY_EXACT};
+  key_range max_key{key, length, keypart_map, HA_READ_AFTER_KEY};
+  *rows = records_in_range(table->s->primary_key, &min_key, &max_key);
+}
+
+/**
+  secondary_index_read for the candidates of a vector or next spatial index
+  search, whose rows are read through candidate_row_read.
+*/
+int ha_rocksdb::candidate_index_read(const Rdb_key_def &kd, uchar *const buf,
+                                     const rocksdb::Slice *key,
+                                     const rocksdb::Slice *value,
+                                     bool *skip_row) {
+  const bool covered_lookup =
+      (m_keyread_only && kd.can_cover_lookup()) ||
+      kd.covers_lookup(value, m_converter->get_lookup_bitmap());
+  if (covered_lookup || m_lock_rows != RDB_LOCK_NONE) {
+    return secondary_index_read(active_index, buf, key, value, skip_row);
+  }
+  return candidate_row_read(kd, buf, skip_row);
+}
+
+/**
+  Read the row of the candidate whose rowid is in m_last_rowkey, like
+  get_row_by_rowid. The rows of the next batch_size candidates the search
+  already holds, rocksdb_mrr_batch_size when 0, are read with one MultiGet,
+  rather than with a point read each.
+
+  @return
+    HA_EXIT_SUCCESS  OK
+    other            HA_ERR error code (can be SE-specific)
+*/
+int ha_rocksdb::candidate_row_read(const Rdb_key_def &kd, uchar *const buf,
+                                   bool *skip_row, size_t batch_size) {
+  // rows past their TTL are only returned by the point read
+  if (m_lock_rows != RDB_LOCK_NONE ||
+      THDVAR(ha_thd(), mrr_batch_size) == 0 ||
+      (m_pk_descr->has_ttl() && !rdb_is_binlog_ttl_enabled())) {
+    return get_row_by_rowid(buf, m_last_rowkey.ptr(), m_last_rowkey.length(),
+                            skip_row, false, !rdb_is_binlog_ttl_enabled());
+  }
+
+  const rocksdb::Slice rowid(m_last_rowkey.ptr(), m_last_rowkey.length());
+  if (m_candidate_next >= m_candidate_pks.size() ||
+      rocksdb::Slice(m_candidate_pks[m_candidate_next]) != rowid) {
+    fill_candidate_rows(kd, batch_size > 0 ? batch_size
+                                           : THDVAR(ha_thd(), mrr_batch_size));
+  }
+  if (m_candidate_next >= m_candidate_pks.size() ||
+      rocksdb::Slice(m_candidate_pks[m_candidate_next]) != rowid) {
+    // the search holds no candidates past this one
+    return get_row_by_rowid(buf, m_last_rowkey.ptr(), m_last_rowkey.length(),
+                            skip_row, false, !rdb_is_binlog_ttl_enabled());
+  }
+
+  if (skip_row) {
+    *skip_row = false;
+  }
+  const size_t i = m_candidate_next++;
+  int rc = m_candidate_rcs[i];
+  if (rc) {
+    return rc;
+  }
+  auto &row = m_candidate_rows[i];
+  m_retrieved_record.Reset();
+  if (row.IsPinned()) {
+    m_retrieved_record.PinSlice(row, &row);
+  } else {
+    m_retrieved_record.PinSelf(row);
+  }
+  rc = convert_record_from_storage_format(&rowid, buf);
+  if (rc) {
+    return rc;
+  }
+  table->m_status = 0;
+  return fill_virtual_columns();
+}
+
+/**
+  Read the rows of the current candidate and of those after it that the
+  search already holds, up to n, with one MultiGet.
+*/
+void ha_rocksdb::fill_candidate_rows(const Rdb_key_def &kd, size_t n) {
+  free_candidate_rows();
+
+  std::vector<std::string> keys;
+  bool rowids = false;
+  if (kd.is_vector_index()) {
+    get_vector_db_handler()->upcoming_keys(n, &keys);
+    rowids = get_vector_db_handler()->results_are_rowids();
+  } else {
+    get_next_spatial_db_handler()->upcoming_keys(n, &keys);
+  }
+  for (const auto &key : keys) {
+    if (rowids) {
+      m_candidate_pks.push_back(key);
+      continue;
+    }
+    const rocksdb::Slice key_slice(key);
+    const uint size =
+        kd.get_primary_key_tuple(*m_pk_descr, &key_slice, m_pk_packed_tuple);
+    if (size == RDB_INVALID_KEY_LEN) {
+      // the point read of this candidate reports it
+      break;
+    }
+    m_candidate_pks.emplace_back(reinterpret_cast<char *>(m_pk_packed_tuple),
+                                 size);
+  }
+  if (m_candidate_pks.size() < 2) {
+    // a single row is read as fast by the point read
+    m_candidate_pks.clear();
+    return;
+  }
+
+  Rdb_transaction *const tx =
+      get_or_create_tx(table->in_use, m_tbl_def->get_table_type());
+  tx->acquire_snapshot(tx->can_acquire_snapshot_without_conflicts(),
+                       m_tbl_def->get_table_type());
+  std::vector<rocksdb::Slice> key_slices(m_candidate_pks.begin(),
+                                         m_candidate_pks.end());
+  m_candidate_rows = std::vector<rocksdb::PinnableSlice>(key_slices.size());
+  m_candidate_rcs.assign(key_slices.size(), HA_EXIT_SUCCESS);
+  get_pk_iterator()->multi_get(key_slices, m_candidate_rows, m_candidate_rcs,
+                               false);
+}
+
+void ha_rocksdb::free_candidate_rows() {
+  m_candidate_pks.clear();
+  m_candidate_rows.clear();
+  m_candidate_rcs.clear();
+  m_candidate_next = 0;
+}
+
 /**
   @brief
   Read from primary key if secondary key is not covering.
@@ -11759,12 +13819,60 @@ int ha_rocksdb::index_read_intern(uchar *const buf, const uchar *const key,
   if (kd.is_vector_index()) {
     // log_to_file("index_read_intern is_vector_index()");
     auto vector_db_handler = get_vector_db_handler();
-    rc = vector_db_handler->search(
-        thd, table, kd.get_vector_index(), &kd,
-        (pushed_idx_cond_keyno == active_index) ? pushed_idx_cond : nullptr);
+    free_candidate_rows();
+    Item *const pk_index_cond =
+        (pushed_idx_cond_keyno == active_index) ? pushed_idx_cond : nullptr;
+    if (pk_index_cond && kd.get_vector_index_config().type() ==
+                             FB_VECTOR_INDEX_TYPE::LSMIDX) {
+      // lsm index entries are whole rows, decode them so the pushed
+      // condition drops rows before they compete for the top k
+      vector_db_handler->set_row_filter(
+          [this, pk_index_cond](const rocksdb::Slice &row_key,
+                                const rocksdb::Slice &row_value,
+                                bool *match) -> uint {
+            const int rtn = m_converter->decode(*m_pk_descr, table->record[0],
+                                                &row_key, &row_value);
+            if (rtn) {
+              return rtn;
+            }
+            *match = pk_index_cond->val_int();
+            return HA_EXIT_SUCCESS;
+          });
+    } else {
+      vector_db_handler->set_row_filter(nullptr);
+    }
+    std::string pk_prefix;
+    ha_rows pk_prefix_rows = 0;
+    if (pk_index_cond && kd.get_vector_index_config().type() !=
+                             FB_VECTOR_INDEX_TYPE::LSMIDX) {
+      vector_index_pk_prefix(pk_index_cond, &pk_prefix, &pk_prefix_rows);
+    }
+    const bool all_lists =
+        !pk_prefix.empty() &&
+        pk_prefix_rows <= THDVAR(thd, vector_prefix_exact_rows);
+    vector_db_handler->set_pk_prefix(std::move(pk_prefix), all_lists);
+    vector_db_handler->set_pk_descr(m_pk_descr.get());
+    const Rdb_transaction *const tx = get_tx_from_thd(thd);
+    vector_db_handler->set_result_cache_enabled(tx == nullptr ||
+                                                tx->get_write_count() == 0);
+    rc = vector_db_handler->search(thd, table, kd.get_vector_index(), &kd,
+                                   pk_index_cond);
     if (rc) {
       DBUG_RETURN(rc);
     }
+    if (vector_db_handler->needs_rerank(kd.get_vector_index()) &&
+        buf == table->record[0]) {
+      rc = vector_index_rerank(kd, buf);
+      if (rc) {
+        DBUG_RETURN(rc);
+      }
+    }
+    if (vector_db_handler->text_relevance() != nullptr) {
+      rc = vector_index_fuse_text(kd);
+      if (rc) {
+        DBUG_RETURN(rc);
+      }
+    }
     if (!vector_db_handler->has_more_results()) {
       DBUG_RETURN(HA_ERR_END_OF_FILE);
     }
@@ -11774,6 +13882,14 @@ int ha_rocksdb::index_read_intern(uchar *const buf, const uchar *const key,
       DBUG_RETURN(rc);
     }
 
+    if (vector_db_handler->results_are_rowids()) {
+      THD_STAGE_INFO(thd, stage_vector_fetching_rows);
+      m_last_rowkey.copy(vector_index_key.data(), vector_index_key.size(),
+                         &my_charset_bin);
+      bool skip_row = false;
+      DBUG_RETURN(candidate_row_read(kd, buf, &skip_row));
+    }
+
     rocksdb::Slice key(vector_index_key);
     uint size;
 
@@ -11815,26 +13931,38 @@ int ha_rocksdb::index_read_intern(uchar *const buf, const uchar *const key,
       rc = secondary_index_parse(active_index, buf, &key, &value, &skip_row, current_value);
       DBUG_RETURN(rc);
     } else {
-      rc = secondary_index_read(active_index, buf, &key, &value, &skip_row);
+      THD_STAGE_INFO(thd, stage_vector_fetching_rows);
+      const auto fetch_start = my_micro_time();
+      rc = candidate_index_read(kd, buf, &key, &value, &skip_row);
+      kd.get_vector_index()->search_stats().add_fetch(
+          1, my_micro_time() - fetch_start);
       DBUG_RETURN(rc);
     }
   }
 
   if (kd.is_next_spatial_index()) {
-    double x_min;
-    double x_max;
-    double y_min;
-    double y_max;
-    memcpy(&y_min, key, sizeof(double));
-    memcpy(&y_max, key + 8, sizeof(double));
-    memcpy(&x_min, key + 16, sizeof(double));
-    memcpy(&x_max, key + 24, sizeof(double));
-    // log_to_file("Parsing start key range");
-    // log_to_file(std::to_string(x_min)+" "+std::to_string(x_max)+" "+std::to_string(y_min)+" "+std::to_string(y_max));
     auto next_spatial_db_handler = get_next_spatial_db_handler();
-    // TODO_JC
-    rc = next_spatial_db_handler->range_search(thd,
-        kd.get_next_spatial_index(), x_min, x_max, y_min, y_max);
+    free_candidate_rows();
+    if (key == nullptr) {
+      // a scan of the whole index is ordered by st_distance, read the rows
+      // nearest to the query point first
+      rc = next_spatial_db_handler->knn_search(thd,
+                                               kd.get_next_spatial_index());
+    } else {
+      double x_min;
+      double x_max;
+      double y_min;
+      double y_max;
+      memcpy(&y_min, key, sizeof(double));
+      memcpy(&y_max, key + 8, sizeof(double));
+      memcpy(&x_min, key + 16, sizeof(double));
+      memcpy(&x_max, key + 24, sizeof(double));
+      // log_to_file("Parsing start key range");
+      // log_to_file(std::to_string(x_min)+" "+std::to_string(x_max)+" "+std::to_string(y_min)+" "+std::to_string(y_max));
+      // TODO_JC
+      rc = next_spatial_db_handler->range_search(thd,
+          kd.get_next_spatial_index(), x_min, x_max, y_min, y_max);
+    }
     if (rc) {
       DBUG_RETURN(rc);
     }
@@ -11857,8 +13985,17 @@ int ha_rocksdb::index_read_intern(uchar *const buf, const uchar *const key,
     rocksdb::Slice key(next_spatial_index_key);
     // const uint size =
     //     kd.get_primary_key_tuple(*m_pk_descr, &key, m_pk_packed_tuple);
-    const uint size = next_spatial_index_key.size();
-    std::memcpy(m_pk_packed_tuple, next_spatial_index_key.data(), next_spatial_index_key.size());
+    // the entries of an index that keeps no rows are secondary keys, the
+    // row is read through the pk they end with
+    const bool rows_in_entries =
+        kd.get_next_spatial_index()->rows_in_entries();
+    const uint size =
+        rows_in_entries
+            ? next_spatial_index_key.size()
+            : kd.get_primary_key_tuple(*m_pk_descr, &key, m_pk_packed_tuple);
+    if (rows_in_entries) {
+      std::memcpy(m_pk_packed_tuple, next_spatial_index_key.data(), size);
+    }
     if (size == RDB_INVALID_KEY_LEN) {
       // log_to_file("rocksdb corrupt data");
       rc = HA_ERR_ROCKSDB_CORRUPT_DATA;
@@ -11882,6 +14019,11 @@ int ha_rocksdb::index_read_intern(uchar *const buf, const uchar *const key,
     if (rc1) {
       DBUG_RETURN(rc1);
     }
+    if (!rows_in_entries) {
+      value = rocksdb::Slice(current_value);
+      rc = candidate_index_read(kd, buf, &key, &value, &skip_row);
+      DBUG_RETURN(rc);
+    }
     rc = secondary_index_parse(active_index, buf, &key, &value, &skip_row, current_value);
     // std::string s(reinterpret_cast<const char*>(buf), current_value.size());
     // log_to_file("current_value size: " + std::to_string(current_value.size()));
@@ -12023,6 +14165,8 @@ int ha_rocksdb::index_read_intern(uchar *const buf, const uchar *const key,
       get_or_create_tx(table->in_use, m_tbl_def->get_table_type());
   const bool is_new_snapshot = !tx->has_snapshot(m_tbl_def->get_table_type());
 
+  m_iterator->set_scan_rows(expected_scan_rows(key == nullptr));
+
   // Loop as long as we get a deadlock error AND we end up creating the
   // snapshot here (i.e. it did not exist prior to this)
   for (;;) {
@@ -12223,7 +14367,11 @@ int ha_rocksdb::check(THD *const thd MY_ATTRIBUTE((__unused__)),
   bool first_index = true;
 
   for (uint keyno = 0; keyno < table->s->keys; keyno++) {
-    if (keyno != pk) {
+    // the postings of a FULLTEXT or sparse vector index and the lists of
+    // a multi-vector index are not one entry per row
+    if (keyno != pk && !m_key_descr_arr[keyno]->is_fulltext_index() &&
+        !m_key_descr_arr[keyno]->is_sparse_vector_index() &&
+        !m_key_descr_arr[keyno]->is_multi_vector_index()) {
       extra(HA_EXTRA_KEYREAD);
       ha_index_init(keyno, true);
       ha_rows rows = 0;
@@ -12608,9 +14756,33 @@ int ha_rocksdb::get_row_from_value(uchar *const buf, const char *const rowid,
   DBUG_RETURN(rc);
 }
 
+bool ha_rocksdb::shared_index_entries(const uchar *const record,
+                                      std::vector<std::string> *const images) {
+  if (!rocksdb_write_set_shared_index_entries) {
+    return false;
+  }
+  std::string image;
+  for (uint i = 0; i < table->s->keys; i++) {
+    const Rdb_key_def &kd = *m_key_descr_arr[i];
+    if (!kd.is_vector_index() && !kd.overwrites_entries()) continue;
+
+    if (kd.read_shared_entry(table, record, &image) != HA_EXIT_SUCCESS) {
+      return true;
+    }
+    if (!image.empty()) {
+      images->emplace_back(table->key_info[i].name);
+      images->back().append(image);
+    }
+  }
+  return false;
+}
+
 int ha_rocksdb::records(ha_rows *num_rows) {
   if (m_lock_rows == RDB_LOCK_NONE) {
     // SELECT COUNT(*) without locking, fast path
+    const int rc = parallel_records(*m_pk_descr, num_rows);
+    if (rc != HA_ERR_UNSUPPORTED) return rc;
+
     m_iteration_only = true;
     auto iteration_guard =
         create_scope_guard([this]() { m_iteration_only = false; });
@@ -12624,6 +14796,9 @@ int ha_rocksdb::records(ha_rows *num_rows) {
 int ha_rocksdb::records_from_index(ha_rows *num_rows, uint index) {
   if (m_lock_rows == RDB_LOCK_NONE) {
     // SELECT COUNT(*) without locking, fast path
+    const int rc = parallel_records(*m_key_descr_arr[index], num_rows);
+    if (rc != HA_ERR_UNSUPPORTED) return rc;
+
     m_iteration_only = true;
     auto iteration_guard =
         create_scope_guard([this]() { m_iteration_only = false; });
@@ -12634,6 +14809,212 @@ int ha_rocksdb::records_from_index(ha_rows *num_rows, uint index) {
   }
 }
 
+/*
+  A scan of all the entries of kd by max_threads threads at most, nullptr
+  if they cannot be read from the snapshot on other threads: the transaction
+  has writes the snapshot does not see, or kd does not have one entry per
+  row. The rows are not locked, so statements locking them do not use it.
+*/
+std::unique_ptr<Rdb_parallel_scan> ha_rocksdb::new_parallel_scan(
+    const Rdb_key_def &kd, uint max_threads) {
+  if (m_tbl_def->get_table_type() != TABLE_TYPE::USER_TABLE ||
+      kd.is_vector_index() || kd.is_next_spatial_index() ||
+      kd.is_partial_index() || kd.is_fulltext_index()) {
+    return nullptr;
+  }
+
+  Rdb_transaction *const tx =
+      get_or_create_tx(ha_thd(), TABLE_TYPE::USER_TABLE);
+  if (tx->get_write_count(TABLE_TYPE::USER_TABLE) > 0) {
+    return nullptr;
+  }
+  const rocksdb::ReadOptions read_opts =
+      tx->get_snapshot_read_options(TABLE_TYPE::USER_TABLE);
+
+  // the threads only read the TTL read filtering time, so set it here
+  const bool check_ttl = kd.has_ttl();
+  if (check_ttl) {
+    (void)tx->get_or_create_ttl_read_filtering_ts();
+  }
+
+  uchar lower[Rdb_key_def::INDEX_NUMBER_SIZE];
+  uchar upper[Rdb_key_def::INDEX_NUMBER_SIZE];
+  uint size;
+  kd.get_infimum_key(lower, &size);
+  kd.get_supremum_key(upper, &size);
+  rocksdb::Slice lower_slice(reinterpret_cast<const char *>(lower), size);
+  rocksdb::Slice upper_slice(reinterpret_cast<const char *>(upper), size);
+  if (kd.m_is_reverse_cf) {
+    std::swap(lower_slice, upper_slice);
+  }
+
+  return std::make_unique<Rdb_parallel_scan>(rdb, kd, tx, read_opts,
+                                             lower_slice, upper_slice,
+                                             check_ttl, max_threads);
+}
+
+/*
+  Count the entries of kd with @@rocksdb_parallel_scan_threads threads.
+
+  @return
+    HA_ERR_UNSUPPORTED  the entries are to be counted on this thread
+*/
+int ha_rocksdb::parallel_records(const Rdb_key_def &kd, ha_rows *num_rows) {
+  THD *const thd = ha_thd();
+  const uint max_threads = THDVAR(thd, parallel_scan_threads);
+  if (max_threads <= 1) return HA_ERR_UNSUPPORTED;
+
+  const auto scan = new_parallel_scan(kd, max_threads);
+  if (scan == nullptr || scan->threads() <= 1) return HA_ERR_UNSUPPORTED;
+
+  // a cache line for the count of each thread
+  struct alignas(64) Thread_rows {
+    ha_rows m_rows = 0;
+  };
+  std::vector<Thread_rows> counts(scan->threads());
+  const rocksdb::Status s =
+      scan->run([thd, &counts](uint thread, const rocksdb::Slice &,
+                               const rocksdb::Slice &) {
+        return ++counts[thread].m_rows % 4096 == 0 && thd->killed;
+      });
+
+  *num_rows = HA_POS_ERROR;
+  if (thd->killed) return HA_ERR_QUERY_INTERRUPTED;
+  if (!s.ok()) {
+    return rdb_tx_set_status_error(*get_tx_from_thd(thd), s, kd, m_tbl_def);
+  }
+
+  ha_rows rows = 0;
+  for (const auto &count : counts) {
+    rows += count.m_rows;
+  }
+  update_row_read(rows);
+  *num_rows = rows;
+  return HA_EXIT_SUCCESS;
+}
+
+/*
+  The state of a parallel_scan(): the scan, and for each thread a converter
+  and a buffer to decode its rows into.
+*/
+struct Rdb_parallel_scan_ctx {
+  std::unique_ptr<Rdb_parallel_scan> m_scan;
+  std::vector<std::unique_ptr<Rdb_converter>> m_converters;
+  std::vector<std::vector<uchar>> m_records;
+};
+
+/*
+  Start a scan of the primary key with @@rocksdb_parallel_scan_threads
+  threads at most, see Rdb_parallel_scan.
+
+  @return
+    HA_EXIT_SUCCESS     OK
+    HA_ERR_UNSUPPORTED  the statement locks the rows, or the transaction
+                        has writes
+*/
+int ha_rocksdb::parallel_scan_init(void *&scan_ctx, size_t *num_threads,
+                                   bool use_reserved_threads
+                                   [[maybe_unused]]) {
+  DBUG_ENTER_FUNC();
+
+  scan_ctx = nullptr;
+  if (m_lock_rows != RDB_LOCK_NONE) {
+    DBUG_RETURN(HA_ERR_UNSUPPORTED);
+  }
+
+  THD *const thd = ha_thd();
+  auto ctx = std::make_unique<Rdb_parallel_scan_ctx>();
+  ctx->m_scan = new_parallel_scan(
+      *m_pk_descr, std::max<uint>(THDVAR(thd, parallel_scan_threads), 1));
+  if (ctx->m_scan == nullptr) {
+    DBUG_RETURN(HA_ERR_UNSUPPORTED);
+  }
+
+  const dd::Table *dd_table = nullptr;
+  dd::cache::Dictionary_client *dd_client = thd->dd_client();
+  dd::cache::Dictionary_client::Auto_releaser releaser(dd_client);
+  if (dd_client->acquire(table->s->db.str, table->s->table_name.str,
+                         &dd_table)) {
+    DBUG_RETURN(HA_ERR_ROCKSDB_INVALID_TABLE);
+  }
+
+  for (uint thread = 0; thread < ctx->m_scan->threads(); thread++) {
+    ctx->m_converters.emplace_back(
+        new Rdb_converter(thd, m_tbl_def, table, dd_table));
+    ctx->m_converters.back()->setup_field_decoders(
+        table->read_set, table->s->primary_key, true /* keyread_only */,
+        true /* decode_all_fields */);
+    ctx->m_records.emplace_back(
+        table->s->default_values,
+        table->s->default_values + table->s->reclength);
+  }
+
+  *num_threads = ctx->m_scan->threads();
+  scan_ctx = ctx.release();
+  DBUG_RETURN(HA_EXIT_SUCCESS);
+}
+
+/*
+  Give each row to load_fn in the format of record[0], one at a time. The
+  values of BLOB columns point into the row as read, so they are only valid
+  during the call. Virtual generated columns are not computed.
+*/
+int ha_rocksdb::parallel_scan(void *scan_ctx, void **thread_ctxs,
+                              Load_init_cbk init_fn, Load_cbk load_fn,
+                              Load_end_cbk end_fn) {
+  DBUG_ENTER_FUNC();
+
+  auto *const ctx = static_cast<Rdb_parallel_scan_ctx *>(scan_ctx);
+  assert(ctx != nullptr);
+
+  std::vector<ulong> offsets;
+  std::vector<ulong> null_byte_offsets;
+  std::vector<ulong> null_bitmasks;
+  for (uint i = 0; i < table->s->fields; i++) {
+    const Field *const field = table->field[i];
+    offsets.push_back(field->offset(table->record[0]));
+    null_byte_offsets.push_back(field->null_offset());
+    null_bitmasks.push_back(field->null_bit);
+  }
+
+  std::atomic<int> decode_error{HA_EXIT_SUCCESS};
+  const rocksdb::Status s = ctx->m_scan->run(
+      [&](uint thread, const rocksdb::Slice &key,
+          const rocksdb::Slice &value) {
+        uchar *const record = ctx->m_records[thread].data();
+        const int rc = ctx->m_converters[thread]->decode(*m_pk_descr, record,
+                                                         &key, &value);
+        if (rc != HA_EXIT_SUCCESS) {
+          decode_error = rc;
+          return true;
+        }
+        return load_fn(thread_ctxs[thread], 1, record,
+                       std::numeric_limits<uint64_t>::max());
+      },
+      [&](uint thread) {
+        return init_fn(thread_ctxs[thread], offsets.size(),
+                       table->s->reclength, offsets.data(),
+                       null_byte_offsets.data(), null_bitmasks.data());
+      },
+      [&](uint thread) { end_fn(thread_ctxs[thread]); });
+
+  if (decode_error != HA_EXIT_SUCCESS) {
+    DBUG_RETURN(decode_error);
+  }
+  if (s.IsAborted()) {
+    DBUG_RETURN(HA_ERR_QUERY_INTERRUPTED);
+  }
+  if (!s.ok()) {
+    DBUG_RETURN(rdb_tx_set_status_error(*get_tx_from_thd(ha_thd()), s,
+                                        *m_pk_descr, m_tbl_def));
+  }
+  DBUG_RETURN(HA_EXIT_SUCCESS);
+}
+
+void ha_rocksdb::parallel_scan_end(void *scan_ctx) {
+  delete static_cast<Rdb_parallel_scan_ctx *>(scan_ctx);
+}
+
 /*
   The analagous function to ha_rocksdb::get_row_by_rowid for performing
   secondary key lookups.
@@ -12766,6 +15147,22 @@ int ha_rocksdb::index_next_with_direction_intern(uchar *const buf,
   if (kd.is_vector_index()) {
     auto vector_db_handler = get_vector_db_handler();
     vector_db_handler->next_result();
+    if (!vector_db_handler->has_more_results()) {
+      // the server still wants rows, look further from the query vector
+      rc = vector_db_handler->expand_search(
+          thd, table, kd.get_vector_index(), &kd,
+          (pushed_idx_cond_keyno == active_index) ? pushed_idx_cond : nullptr);
+      if (rc) {
+        DBUG_RETURN(rc);
+      }
+      if (vector_db_handler->needs_rerank(kd.get_vector_index()) &&
+          buf == table->record[0]) {
+        rc = vector_index_rerank(kd, buf);
+        if (rc) {
+          DBUG_RETURN(rc);
+        }
+      }
+    }
     if (!vector_db_handler->has_more_results()) {
       DBUG_RETURN(HA_ERR_END_OF_FILE);
     }
@@ -12775,6 +15172,13 @@ int ha_rocksdb::index_next_with_direction_intern(uchar *const buf,
       DBUG_RETURN(rc);
     }
 
+    if (vector_db_handler->results_are_rowids()) {
+      m_last_rowkey.copy(vector_index_key.data(), vector_index_key.size(),
+                         &my_charset_bin);
+      bool skip_row = false;
+      DBUG_RETURN(candidate_row_read(kd, buf, &skip_row));
+    }
+
     rocksdb::Slice key(vector_index_key);
     uint size;
 
@@ -12810,7 +15214,10 @@ int ha_rocksdb::index_next_with_direction_intern(uchar *const buf,
       rc = secondary_index_parse(active_index, buf, &key, &value, &skip_row, current_value);
       DBUG_RETURN(rc);
     } else {
-      rc = secondary_index_read(active_index, buf, &key, &value, &skip_row);
+      const auto fetch_start = my_micro_time();
+      rc = candidate_index_read(kd, buf, &key, &value, &skip_row);
+      kd.get_vector_index()->search_stats().add_fetch(
+          1, my_micro_time() - fetch_start);
       DBUG_RETURN(rc);
     }
 
@@ -12818,7 +15225,10 @@ int ha_rocksdb::index_next_with_direction_intern(uchar *const buf,
 
   if (kd.is_next_spatial_index()) {
     auto next_spatial_db_handler = get_next_spatial_db_handler();
-    next_spatial_db_handler->next_result();
+    rc = next_spatial_db_handler->next_result();
+    if (rc) {
+      DBUG_RETURN(rc);
+    }
     if (!next_spatial_db_handler->has_more_results()) {
       DBUG_RETURN(HA_ERR_END_OF_FILE);
     }
@@ -12834,8 +15244,17 @@ int ha_rocksdb::index_next_with_direction_intern(uchar *const buf,
     rocksdb::Slice key(next_spatial_index_key);
     // const uint size =
     //     kd.get_primary_key_tuple(*m_pk_descr, &key, m_pk_packed_tuple);
-    const uint size = next_spatial_index_key.size();
-    std::memcpy(m_pk_packed_tuple, next_spatial_index_key.data(), next_spatial_index_key.size());
+    // the entries of an index that keeps no rows are secondary keys, the
+    // row is read through the pk they end with
+    const bool rows_in_entries =
+        kd.get_next_spatial_index()->rows_in_entries();
+    const uint size =
+        rows_in_entries
+            ? next_spatial_index_key.size()
+            : kd.get_primary_key_tuple(*m_pk_descr, &key, m_pk_packed_tuple);
+    if (rows_in_entries) {
+      std::memcpy(m_pk_packed_tuple, next_spatial_index_key.data(), size);
+    }
     if (size == RDB_INVALID_KEY_LEN) {
       rc = HA_ERR_ROCKSDB_CORRUPT_DATA;
       DBUG_RETURN(rc);
@@ -12850,6 +15269,11 @@ int ha_rocksdb::index_next_with_direction_intern(uchar *const buf,
     if (rc1) {
       DBUG_RETURN(rc1);
     }
+    if (!rows_in_entries) {
+      value = rocksdb::Slice(current_value);
+      rc = candidate_index_read(kd, buf, &key, &value, &skip_row);
+      DBUG_RETURN(rc);
+    }
     rc = secondary_index_parse(active_index, buf, &key, &value, &skip_row, current_value);
     DBUG_RETURN(rc);
   }
@@ -12905,7 +15329,25 @@ int ha_rocksdb::index_next_with_direction_intern(uchar *const buf,
       } else {
         /* Unpack from the row we've read */
         m_last_rowkey.copy(key.data(), key.size(), &my_charset_bin);
-        rc = convert_record_from_storage_format(&key, &value, buf);
+        Runtime_filter *const filter =
+            (buf == table->record[0]) ? ha_get_runtime_filter() : nullptr;
+        const bool filter_on_pk =
+            filter != nullptr && runtime_filter_on_pk(*filter);
+        if (filter_on_pk) {
+          /* Reject the row from its key, before the value is decoded */
+          rc = m_converter->decode(*m_pk_descr, buf, &key, &value,
+                                   false /* decode_value */);
+          if (rc == HA_EXIT_SUCCESS && !filter->may_match()) {
+            continue;
+          }
+        }
+        if (rc == HA_EXIT_SUCCESS) {
+          rc = convert_record_from_storage_format(&key, &value, buf);
+        }
+        if (rc == HA_EXIT_SUCCESS && filter != nullptr && !filter_on_pk &&
+            !filter->may_match()) {
+          continue;
+        }
       }
     } else {
       rc = kd.unpack_record(table, buf, &key, &value,
@@ -13091,6 +15533,20 @@ int ha_rocksdb::index_read_intern(uchar *const buf, bool first) {
   DBUG_RETURN(rc);
 }
 
+/**
+  The rows the optimizer expects a scan of the active index to read: all of
+  them for a full scan, else the estimate of the range optimizer. A lookup
+  the range optimizer did not consider, as of a ref access in a join, is
+  expected to read few rows.
+*/
+ha_rows ha_rocksdb::expected_scan_rows(bool full_scan) const {
+  if (full_scan) return stats.records;
+  if (active_index < MAX_KEY && table->quick_keys.is_set(active_index)) {
+    return table->quick_rows[active_index];
+  }
+  return 0;
+}
+
 void ha_rocksdb::unlock_row() {
   DBUG_ENTER_FUNC();
 
@@ -13390,6 +15846,9 @@ int ha_rocksdb::write_row(uchar *const buf) {
   int rv = check_disk_usage();
   if (rv) DBUG_RETURN(rv);
 
+  rv = check_cf_write_throttle();
+  if (rv) DBUG_RETURN(rv);
+
   if (table->next_number_field) {
     assert(!m_tbl_def->is_intrinsic_tmp_table());
     int err;
@@ -13861,20 +16320,12 @@ int ha_rocksdb::check_uniqueness_and_lock(
   return HA_EXIT_SUCCESS;
 }
 
-int ha_rocksdb::bulk_load_key(Rdb_transaction *const tx, const Rdb_key_def &kd,
-                              const rocksdb::Slice &key,
-                              const rocksdb::Slice &value, bool sort) {
-  DBUG_ENTER_FUNC();
-  int res;
-  THD *thd = ha_thd();
-  if (thd) {
-    if (thd->killed) {
-      DBUG_RETURN(HA_ERR_QUERY_INTERRUPTED);
-    }
-
-    thd->check_yield();
-  }
-
+/*
+  Register the bulk load of the entries of kd with the transaction.
+*/
+int ha_rocksdb::bulk_load_start(Rdb_transaction *const tx,
+                                const Rdb_key_def &kd) {
+  THD *const thd = ha_thd();
   auto &cf = kd.get_cf();
 
   if (THDVAR(thd, bulk_load_use_sst_partitioner) &&
@@ -13884,7 +16335,7 @@ int ha_rocksdb::bulk_load_key(Rdb_transaction *const tx, const Rdb_key_def &kd,
                     "MyRocks: failed to bulk load. Index number %d "
                     "is being used by another bulk load transaction.",
                     kd.get_index_number());
-    DBUG_RETURN(HA_ERR_ROCKSDB_BULK_LOAD);
+    return HA_ERR_ROCKSDB_BULK_LOAD;
   }
 
   // In the case of unsorted inserts, m_sst_info allocated here is not
@@ -13893,15 +16344,38 @@ int ha_rocksdb::bulk_load_key(Rdb_transaction *const tx, const Rdb_key_def &kd,
   if (m_sst_info == nullptr || m_sst_info->is_done()) {
     m_sst_info.reset(new Rdb_sst_info(
         rdb, m_table_handler->m_table_name, kd.get_name(), cf,
-        *rocksdb_db_options, THDVAR(ha_thd(), trace_sst_api),
-        THDVAR(ha_thd(), bulk_load_compression_parallel_threads)));
-    res = tx->start_bulk_load(this, m_sst_info);
+        *rocksdb_db_options, THDVAR(thd, trace_sst_api),
+        THDVAR(thd, bulk_load_compression_parallel_threads)));
+    const int res = tx->start_bulk_load(this, m_sst_info);
     if (res != HA_EXIT_SUCCESS) {
-      DBUG_RETURN(res);
+      return res;
     }
   }
   assert(m_sst_info);
 
+  return HA_EXIT_SUCCESS;
+}
+
+int ha_rocksdb::bulk_load_key(Rdb_transaction *const tx, const Rdb_key_def &kd,
+                              const rocksdb::Slice &key,
+                              const rocksdb::Slice &value, bool sort) {
+  DBUG_ENTER_FUNC();
+  int res;
+  THD *thd = ha_thd();
+  if (thd) {
+    if (thd->killed) {
+      DBUG_RETURN(HA_ERR_QUERY_INTERRUPTED);
+    }
+
+    thd->check_yield();
+  }
+
+  auto &cf = kd.get_cf();
+
+  if ((res = bulk_load_start(tx, kd))) {
+    DBUG_RETURN(res);
+  }
+
   if (sort) {
     Rdb_index_merge *key_merge;
 
@@ -14084,6 +16558,30 @@ int ha_rocksdb::check_disk_usage() {
   return error;
 }
 
+/*
+  Admit a row write to the column families of the table, see
+  Rdb_cf_write_throttle.
+*/
+int ha_rocksdb::check_cf_write_throttle() {
+  if (!rocksdb_cf_write_throttle || !cf_write_throttle.any_stalled() ||
+      m_tbl_def->get_table_type() != TABLE_TYPE::USER_TABLE) {
+    return HA_EXIT_SUCCESS;
+  }
+
+  std::vector<std::string> cf_names;
+  cf_names.reserve(m_tbl_def->m_key_count);
+  for (uint i = 0; i < m_tbl_def->m_key_count; i++) {
+    cf_names.push_back(m_key_descr_arr[i]->get_cf().GetName());
+  }
+  const int error = cf_write_throttle.admit(
+      ha_thd(), cf_names, rocksdb_cf_write_throttle_delay_us,
+      rocksdb_cf_write_throttle_max_wait_ms);
+  if (error) {
+    print_error(error, MYF(0));
+  }
+  return error;
+}
+
 void ha_rocksdb::record_disk_usage_change(longlong delta) {
   THD *thd = current_thd;
   if (thd) {
@@ -14132,6 +16630,170 @@ int ha_rocksdb::check_partial_index_prefix(const TABLE *table_arg,
     HA_EXIT_SUCCESS OK
     Other           HA_ERR error code (can be SE-specific)
  */
+/*
+  Replace the postings of the row in the FULLTEXT index kd, old_data is
+  nullptr for an insert and new_data for a delete.
+*/
+int ha_rocksdb::write_fulltext_sk(const TABLE *const table_arg,
+                                  const Rdb_key_def &kd,
+                                  Rdb_transaction *const tx,
+                                  const uchar *old_data,
+                                  const rocksdb::Slice &old_pk,
+                                  const uchar *new_data,
+                                  const rocksdb::Slice &new_pk) {
+  const uint key_id = kd.get_keyno();
+  Rdb_fulltext_terms old_terms;
+  Rdb_fulltext_terms new_terms;
+  uint32 old_length = 0;
+  uint32 new_length = 0;
+  if (old_data != nullptr) {
+    old_length = rdb_fulltext_record_terms(
+        table_arg, key_id, old_data, rocksdb_ft_min_token_size,
+        rocksdb_ft_max_token_size, &old_terms);
+  }
+  if (new_data != nullptr) {
+    new_length = rdb_fulltext_record_terms(
+        table_arg, key_id, new_data, rocksdb_ft_min_token_size,
+        rocksdb_ft_max_token_size, &new_terms);
+  }
+  if (old_pk == new_pk && old_terms == new_terms) {
+    return HA_EXIT_SUCCESS;
+  }
+
+  const rocksdb::Status s = rdb_fulltext_write(
+      tx->get_indexed_write_batch(m_tbl_def->get_table_type()), kd, old_pk,
+      &old_terms, old_length, new_pk, &new_terms, new_length);
+  if (!s.ok()) {
+    return tx->set_status_error(table->in_use, s, kd, m_tbl_def,
+                                m_table_handler);
+  }
+  tx->update_bytes_written(new_pk.size() * new_terms.size(),
+                           m_tbl_def->get_table_type());
+  return HA_EXIT_SUCCESS;
+}
+
+/*
+  Replace the postings of the row in the sparse vector index kd, old_data is
+  nullptr for an insert and new_data for a delete.
+*/
+int ha_rocksdb::write_sparse_vector_sk(const TABLE *const table_arg,
+                                       const Rdb_key_def &kd,
+                                       Rdb_transaction *const tx,
+                                       const uchar *old_data,
+                                       const rocksdb::Slice &old_pk,
+                                       const uchar *new_data,
+                                       const rocksdb::Slice &new_pk) {
+  const uint key_id = kd.get_keyno();
+  Fb_sparse_vector old_vector;
+  Fb_sparse_vector new_vector;
+  for (const bool is_old : {true, false}) {
+    const uchar *const data = is_old ? old_data : new_data;
+    if (data != nullptr &&
+        rdb_sparse_vector_record(table_arg, key_id, data,
+                                 is_old ? &old_vector : &new_vector)) {
+      LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                      "invalid sparse vector for index %s",
+                      kd.get_name().c_str());
+      return HA_EXIT_FAILURE;
+    }
+  }
+  if (old_pk == new_pk && old_vector == new_vector) {
+    return HA_EXIT_SUCCESS;
+  }
+
+  const rocksdb::Status s = rdb_sparse_vector_write(
+      tx->get_indexed_write_batch(m_tbl_def->get_table_type()), kd, old_pk,
+      &old_vector, new_pk, &new_vector);
+  if (!s.ok()) {
+    return tx->set_status_error(table->in_use, s, kd, m_tbl_def,
+                                m_table_handler);
+  }
+  tx->update_bytes_written(new_pk.size() * new_vector.size(),
+                           m_tbl_def->get_table_type());
+  return HA_EXIT_SUCCESS;
+}
+
+/*
+  Replace the entries of the row in the multi-vector index kd, one per list
+  the vectors of the row fall into, holding the codes of those vectors.
+  old_data is nullptr for an insert and new_data for a delete.
+*/
+int ha_rocksdb::write_multi_vector_sk(const TABLE *const table_arg,
+                                      const Rdb_key_def &kd,
+                                      Rdb_transaction *const tx,
+                                      const uchar *old_data,
+                                      const rocksdb::Slice &old_pk,
+                                      const uchar *new_data,
+                                      const rocksdb::Slice &new_pk,
+                                      const longlong hidden_pk_id) {
+  std::vector<float> old_vectors;
+  std::vector<float> new_vectors;
+  int rc = HA_EXIT_SUCCESS;
+  if (old_data != nullptr &&
+      (rc = kd.read_vector(table_arg, old_data, &old_vectors))) {
+    return rc;
+  }
+  if (new_data != nullptr &&
+      (rc = kd.read_vector(table_arg, new_data, &new_vectors))) {
+    return rc;
+  }
+  if (old_pk == new_pk && old_vectors == new_vectors &&
+      !(kd.has_ttl() && m_ttl_bytes_updated)) {
+    return HA_EXIT_SUCCESS;
+  }
+
+  Rdb_vector_index *const vector_index = kd.get_vector_index();
+  const auto wb = tx->get_indexed_write_batch(m_tbl_def->get_table_type());
+  const bool store_row_debug_checksums = should_store_row_debug_checksums();
+  std::vector<Rdb_vector_index_assignment> assignments;
+  std::vector<Rdb_vector_index_assignment> entries;
+  ulonglong bytes_written = 0;
+  for (const bool is_old : {true, false}) {
+    const uchar *const data = is_old ? old_data : new_data;
+    const auto &vectors = is_old ? old_vectors : new_vectors;
+    if (vectors.empty()) {
+      continue;
+    }
+    vector_index->assign_vectors(vectors.size() / vector_index->dimension(),
+                                 vectors.data(), assignments);
+    rdb_multi_vector_entries(assignments, &entries);
+    for (const auto &entry : entries) {
+      const uint packed_size = kd.pack_record(
+          table_arg, m_pack_buffer, data, m_sk_packed_tuple, &m_sk_tails,
+          store_row_debug_checksums, hidden_pk_id, 0, nullptr, m_ttl_bytes,
+          &entry);
+      const rocksdb::Slice key(
+          reinterpret_cast<const char *>(m_sk_packed_tuple), packed_size);
+      const rocksdb::Slice value(
+          reinterpret_cast<const char *>(m_sk_tails.ptr()),
+          m_sk_tails.get_current_pos());
+      // the new entries of the row can have the keys of old ones, which
+      // they overwrite, so the old ones are removed with Delete
+      const rocksdb::Status s =
+          is_old ? wb->Delete(&kd.get_cf(), key)
+                 : wb->Put(&kd.get_cf(), key, value);
+      if (!s.ok()) {
+        return tx->set_status_error(table->in_use, s, kd, m_tbl_def,
+                                    m_table_handler);
+      }
+      if (is_old) {
+        rc = vector_index->on_entry_update(tx, wb, key, value,
+                                           rocksdb::Slice(), rocksdb::Slice());
+      } else {
+        vector_index->note_write();
+        rc = vector_index->on_entry_update(tx, wb, rocksdb::Slice(),
+                                           rocksdb::Slice(), key, value);
+      }
+      if (rc) {
+        return rc;
+      }
+      bytes_written += key.size() + (is_old ? 0 : value.size());
+    }
+  }
+  tx->update_bytes_written(bytes_written, m_tbl_def->get_table_type());
+  return HA_EXIT_SUCCESS;
+}
+
 int ha_rocksdb::update_write_sk(const TABLE *const table_arg,
                                 const Rdb_key_def &kd,
                                 const struct update_row_info &row_info,
@@ -14143,6 +16805,7 @@ int ha_rocksdb::update_write_sk(const TABLE *const table_arg,
   rocksdb::Slice new_key_slice;
   rocksdb::Slice new_value_slice;
   rocksdb::Slice old_key_slice;
+  rocksdb::Slice old_value_slice;
 
   const uint key_id = kd.get_keyno();
 
@@ -14157,6 +16820,46 @@ int ha_rocksdb::update_write_sk(const TABLE *const table_arg,
     return HA_EXIT_SUCCESS;
   }
 
+  if (kd.is_fulltext_index()) {
+    return write_fulltext_sk(table_arg, kd, row_info.tx, row_info.old_data,
+                             row_info.old_pk_slice, row_info.new_data,
+                             row_info.new_pk_slice);
+  }
+
+  if (kd.is_sparse_vector_index()) {
+    return write_sparse_vector_sk(table_arg, kd, row_info.tx,
+                                  row_info.old_data, row_info.old_pk_slice,
+                                  row_info.new_data, row_info.new_pk_slice);
+  }
+
+  if (kd.is_multi_vector_index()) {
+    return write_multi_vector_sk(table_arg, kd, row_info.tx,
+                                 row_info.old_data, row_info.old_pk_slice,
+                                 row_info.new_data, row_info.new_pk_slice,
+                                 row_info.hidden_pk_id);
+  }
+
+  if (m_batch_vector_entries && row_info.old_data == nullptr &&
+      !bulk_load_sk && kd.is_vector_index() &&
+      kd.get_vector_index_config().type() != FB_VECTOR_INDEX_TYPE::LSMIDX) {
+    Rdb_pending_vector_entry entry{.m_keyno = key_id,
+                                   .m_hidden_pk_id = row_info.hidden_pk_id};
+    // a NULL vector is not assigned to any list, its entry is written now
+    if (kd.read_vector(table_arg, row_info.new_data, &entry.m_vector) ==
+            HA_EXIT_SUCCESS &&
+        !entry.m_vector.empty()) {
+      entry.m_record.assign(
+          reinterpret_cast<const char *>(row_info.new_data),
+          table_arg->s->reclength);
+      entry.m_ttl_bytes.assign(m_ttl_bytes, ROCKSDB_SIZEOF_TTL_RECORD);
+      m_pending_vector_entries.push_back(std::move(entry));
+      if (m_pending_vector_entries.size() >= RDB_VECTOR_INSERT_BATCH_SIZE) {
+        return write_pending_vector_entries();
+      }
+      return HA_EXIT_SUCCESS;
+    }
+  }
+
   bool store_row_debug_checksums = should_store_row_debug_checksums();
   new_packed_size =
       kd.pack_record(table_arg, m_pack_buffer, row_info.new_data,
@@ -14202,6 +16905,9 @@ int ha_rocksdb::update_write_sk(const TABLE *const table_arg,
     */
     old_key_slice = rocksdb::Slice(
         reinterpret_cast<const char *>(m_sk_packed_tuple_old), old_packed_size);
+    old_value_slice =
+        rocksdb::Slice(reinterpret_cast<const char *>(m_sk_tails_old.ptr()),
+                       m_sk_tails_old.get_current_pos());
 
     // TODO(mung) - If the new_data and old_data below to the same partial index
     // group (ie. have the same prefix), we can make use of the read below to
@@ -14216,7 +16922,13 @@ int ha_rocksdb::update_write_sk(const TABLE *const table_arg,
     //
     // If rocksdb_partial_index_blind_delete is off, then we check if a prefix
     // is materialized before issuing the SingleDelete.
-    if (kd.is_partial_index() && !rocksdb_partial_index_blind_delete) {
+    if (kd.overwrites_entries() && old_packed_size == new_packed_size &&
+        memcmp(m_sk_packed_tuple_old, m_sk_packed_tuple, old_packed_size) ==
+            0) {
+      // The entry keeps its key, e.g. a point of a hilbert spatial index
+      // moving within its cell, so the put below overwrites it in place.
+      // Such entries are removed with Delete, as they can have several puts.
+    } else if (kd.is_partial_index() && !rocksdb_partial_index_blind_delete) {
       rc = check_partial_index_prefix(table_arg, kd, row_info.tx,
                                       row_info.old_data);
       if (!rc) {
@@ -14233,9 +16945,11 @@ int ha_rocksdb::update_write_sk(const TABLE *const table_arg,
       }
     } else {
       // Unconditionally issue SD if rocksdb_partial_index_blind_delete.
-      const auto s =
-          row_info.tx->get_indexed_write_batch(m_tbl_def->get_table_type())
-              ->SingleDelete(&kd.get_cf(), old_key_slice);
+      const auto wb =
+          row_info.tx->get_indexed_write_batch(m_tbl_def->get_table_type());
+      const auto s = kd.overwrites_entries()
+                         ? wb->Delete(&kd.get_cf(), old_key_slice)
+                         : wb->SingleDelete(&kd.get_cf(), old_key_slice);
       if (!s.ok()) {
         return row_info.tx->set_status_error(table->in_use, s, kd, m_tbl_def,
                                              m_table_handler);
@@ -14278,8 +16992,18 @@ int ha_rocksdb::update_write_sk(const TABLE *const table_arg,
   if (bulk_load_sk && row_info.old_data == nullptr) {
     rc = bulk_load_key(row_info.tx, kd, new_key_slice, new_value_slice, true);
   } else {
-    row_info.tx->get_indexed_write_batch(m_tbl_def->get_table_type())
-        ->Put(&kd.get_cf(), new_key_slice, new_value_slice);
+    const auto wb =
+        row_info.tx->get_indexed_write_batch(m_tbl_def->get_table_type());
+    wb->Put(&kd.get_cf(), new_key_slice, new_value_slice);
+    if (kd.is_vector_index()) {
+      kd.get_vector_index()->note_write();
+      rc = kd.get_vector_index()->on_entry_update(
+          row_info.tx, wb, old_key_slice, old_value_slice, new_key_slice,
+          new_value_slice);
+      if (rc) {
+        return rc;
+      }
+    }
   }
 
   bytes_written += new_key_slice.size() + new_value_slice.size();
@@ -14565,9 +17289,28 @@ int ha_rocksdb::rnd_init(bool scan MY_ATTRIBUTE((__unused__))) {
 
   m_need_build_decoder = true;
   m_rnd_scan_started = false;
-  DBUG_RETURN(
+  m_batch_pos = 0;
+  m_batch_rc = HA_EXIT_SUCCESS;
+  if (ha_get_record_buffer() != nullptr) {
+    // a second rnd_init() restarts the scan, drop the rows read ahead
+    ha_get_record_buffer()->clear();
+  }
+  const int rc =
       index_init(has_hidden_pk(*table) ? MAX_KEY : pk_index(*table, *m_tbl_def),
-                 false /* sorted */));
+                 false /* sorted */);
+  m_rnd_scan = (rc == HA_EXIT_SUCCESS);
+  DBUG_RETURN(rc);
+}
+
+/**
+  An unlocked full table scan decodes its rows in batches into the record
+  buffer, see rnd_next_batched(). Blobs point into the row last read, so
+  the rows of tables with blobs are decoded one at a time.
+*/
+bool ha_rocksdb::is_record_buffer_wanted(ha_rows *const max_rows) const {
+  *max_rows = rocksdb_scan_batch_rows;
+  return m_rnd_scan && *max_rows > 0 && m_lock_rows == RDB_LOCK_NONE &&
+         !m_iteration_only && table->s->blob_fields == 0;
 }
 
 /**
@@ -14580,9 +17323,18 @@ int ha_rocksdb::rnd_next(uchar *const buf) {
 
   check_build_decoder();
 
-  int rc;
   ha_statistic_increment(&System_status_var::ha_read_rnd_next_count);
 
+  Record_buffer *const record_buffer = ha_get_record_buffer();
+  if (record_buffer != nullptr && m_rnd_scan) {
+    DBUG_RETURN(rnd_next_batched(buf, record_buffer));
+  }
+  DBUG_RETURN(rnd_next_intern(buf));
+}
+
+int ha_rocksdb::rnd_next_intern(uchar *const buf) {
+  int rc;
+
   /*
     Since order does not matter, the scan will occur go with natural index
     order.
@@ -14599,7 +17351,83 @@ int ha_rocksdb::rnd_next(uchar *const buf) {
     }
   }
 
-  DBUG_RETURN(rc);
+  return rc;
+}
+
+/**
+  Return the next row of the scan from the record buffer, first filling the
+  buffer with the rows that follow when all of it was returned. Decoding a
+  batch per call keeps the iterator and the decoder hot and saves the
+  per-row overhead of the handler interface. An error met while filling is
+  returned after the rows read before it.
+*/
+int ha_rocksdb::rnd_next_batched(uchar *const buf,
+                                 Record_buffer *const record_buffer) {
+  if (m_batch_pos >= record_buffer->records()) {
+    if (m_batch_rc != HA_EXIT_SUCCESS) {
+      return m_batch_rc;
+    }
+
+    record_buffer->clear();
+    m_batch_pos = 0;
+    m_batch_keys.clear();
+    m_batch_key_ends.clear();
+    while (record_buffer->records() < record_buffer->max_records()) {
+      const int rc = rnd_next_intern(buf);
+      if (rc != HA_EXIT_SUCCESS) {
+        m_batch_rc = rc;
+        break;
+      }
+      memcpy(record_buffer->add_record(), buf, record_buffer->record_size());
+      m_batch_keys.append(m_last_rowkey.ptr(), m_last_rowkey.length());
+      m_batch_key_ends.push_back(m_batch_keys.size());
+    }
+    if (record_buffer->records() == 0) {
+      return m_batch_rc;
+    }
+  }
+
+  const ha_rows pos = m_batch_pos++;
+  memcpy(buf, record_buffer->record(pos), record_buffer->record_size());
+  // position() reads the key of the row returned last
+  const size_t key_begin = (pos == 0) ? 0 : m_batch_key_ends[pos - 1];
+  m_last_rowkey.copy(m_batch_keys.data() + key_begin,
+                     m_batch_key_ends[pos] - key_begin, &my_charset_bin);
+  table->m_status = 0;
+  return HA_EXIT_SUCCESS;
+}
+
+/**
+  Whether the fields the runtime filter of the scan reads are all columns of
+  the primary key, so that the filter can be checked on the decoded key. The
+  answer is kept for the rest of the scan.
+*/
+bool ha_rocksdb::runtime_filter_on_pk(const Runtime_filter &filter) {
+  if (&filter == m_runtime_filter_checked) {
+    return m_runtime_filter_on_pk;
+  }
+  m_runtime_filter_checked = &filter;
+  m_runtime_filter_on_pk = !has_hidden_pk(*table);
+  if (!m_runtime_filter_on_pk) {
+    return false;
+  }
+
+  const KEY &pk = table->key_info[table->s->primary_key];
+  const MY_BITMAP &fields = filter.fields();
+  for (uint i = bitmap_get_first_set(&fields);
+       i != MY_BIT_NONE && m_runtime_filter_on_pk;
+       i = bitmap_get_next_set(&fields, i)) {
+    m_runtime_filter_on_pk = false;
+    for (uint part = 0; part < pk.user_defined_key_parts; part++) {
+      // a prefix of the column is not enough to check the filter
+      if (pk.key_part[part].fieldnr == i + 1 &&
+          !(pk.key_part[part].key_part_flag & HA_PART_KEY_SEG)) {
+        m_runtime_filter_on_pk = true;
+        break;
+      }
+    }
+  }
+  return m_runtime_filter_on_pk;
 }
 
 int ha_rocksdb::rnd_end() {
@@ -14637,6 +17465,12 @@ int ha_rocksdb::index_init(uint idx, bool sorted MY_ATTRIBUTE((__unused__))) {
     thd->check_yield();
   }
 
+  // reads of the statement see the entries of the rows it wrote
+  const int pending_rc = write_pending_vector_entries();
+  if (pending_rc) {
+    DBUG_RETURN(pending_rc);
+  }
+
   Rdb_transaction *const tx =
       get_or_create_tx(thd, m_tbl_def->get_table_type());
   assert(tx != nullptr);
@@ -14680,6 +17514,8 @@ int ha_rocksdb::index_end() {
   DBUG_ENTER_FUNC();
 
   m_need_build_decoder = false;
+  m_rnd_scan = false;
+  m_runtime_filter_checked = nullptr;
 
   m_iterator.reset(nullptr);
 
@@ -14687,6 +17523,8 @@ int ha_rocksdb::index_end() {
 
   next_spatial_index_end();
 
+  free_candidate_rows();
+
   active_index = MAX_KEY;
   in_range_check_pushed_down = false;
 
@@ -14697,6 +17535,82 @@ int ha_rocksdb::index_end() {
   DBUG_RETURN(HA_EXIT_SUCCESS);
 }
 
+FT_INFO *ha_rocksdb::fulltext_search_init(uint flags, uint inx,
+                                          const String *key, ha_rows limit) {
+  DBUG_ENTER_FUNC();
+
+  if (flags & (FT_BOOL | FT_EXPAND)) {
+    my_error(ER_NOT_SUPPORTED_YET, MYF(0),
+             "MyRocks FULLTEXT search in boolean mode or with query "
+             "expansion");
+    DBUG_RETURN(nullptr);
+  }
+  if (inx >= table->s->keys || !m_key_descr_arr[inx]->is_fulltext_index()) {
+    my_error(ER_FT_MATCHING_KEY_NOT_FOUND, MYF(0));
+    DBUG_RETURN(nullptr);
+  }
+
+  Rdb_fulltext_terms terms;
+  rdb_fulltext_tokenize(key->charset(), key->ptr(), key->length(),
+                        rocksdb_ft_min_token_size, rocksdb_ft_max_token_size,
+                        &terms);
+  DBUG_RETURN(new Rdb_fulltext_search(ha_thd(), *m_key_descr_arr[inx],
+                                      &m_last_rowkey, std::move(terms),
+                                      limit));
+}
+
+FT_INFO *ha_rocksdb::ft_init_ext(uint flags, uint inx, String *key) {
+  return fulltext_search_init(flags, inx, key, HA_POS_ERROR);
+}
+
+FT_INFO *ha_rocksdb::ft_init_ext_with_hints(uint inx, String *key,
+                                            Ft_hints *hints) {
+  /* A query that needs only the best rows sets the limit */
+  return fulltext_search_init(hints->get_flags(), inx, key,
+                              hints->get_limit());
+}
+
+/**
+  Find the matches of the search of the FULLTEXT index scan.
+
+  @return
+    HA_EXIT_SUCCESS  OK
+    other            HA_ERR error code (can be SE-specific)
+*/
+int ha_rocksdb::ft_init() {
+  DBUG_ENTER_FUNC();
+
+  auto *const search = static_cast<Rdb_fulltext_search *>(ft_handler);
+  if (search == nullptr) DBUG_RETURN(HA_ERR_WRONG_COMMAND);
+  const int rc = search->execute();
+  search->rewind();
+  DBUG_RETURN(rc);
+}
+
+/**
+  Read the next row of the FULLTEXT index scan, best match first.
+
+  @return
+    HA_EXIT_SUCCESS  OK
+    other            HA_ERR error code (can be SE-specific)
+*/
+int ha_rocksdb::ft_read(uchar *const buf) {
+  DBUG_ENTER_FUNC();
+
+  auto *const search = static_cast<Rdb_fulltext_search *>(ft_handler);
+  for (;;) {
+    const Rdb_fulltext_match *const match = search->next();
+    if (match == nullptr) DBUG_RETURN(HA_ERR_END_OF_FILE);
+
+    bool skip_row = false;
+    const int rc =
+        get_row_by_rowid(buf, match->m_pk.data(), match->m_pk.size(),
+                         &skip_row, false, !rdb_is_binlog_ttl_enabled());
+    if (rc == HA_ERR_KEY_NOT_FOUND || skip_row) continue;
+    DBUG_RETURN(rc);
+  }
+}
+
 /**
   @return
     HA_EXIT_SUCCESS  OK
@@ -14707,6 +17621,24 @@ int ha_rocksdb::vector_index_init(Item *distance_func) {
   return vector_db_handler->vector_index_orderby_init(distance_func);
 }
 
+/**
+  @return
+    HA_EXIT_SUCCESS  OK
+    other            HA_ERR error code (can be SE-specific)
+*/
+int ha_rocksdb::vector_index_prefetch(
+    uint keyno, std::vector<std::vector<float>> *query_vectors) {
+  const Rdb_key_def &kd = *m_key_descr_arr[keyno];
+  if (!kd.is_vector_index()) {
+    return HA_ERR_WRONG_COMMAND;
+  }
+  Item *const pk_index_cond =
+      (pushed_idx_cond_keyno == keyno) ? pushed_idx_cond : nullptr;
+  auto vector_db_handler = get_vector_db_handler();
+  return vector_db_handler->prefetch(ha_thd(), table, kd.get_vector_index(),
+                                     &kd, pk_index_cond, *query_vectors);
+}
+
 /**
   @return
     HA_EXIT_SUCCESS  OK
@@ -14718,6 +17650,17 @@ int ha_rocksdb::next_spatial_index_init(Item *distance_func) {
   return HA_EXIT_SUCCESS;
 }
 
+/**
+  rows of range scans over the next spatial index keyno are refined against
+  the spatial predicates of cond until the end of the statement
+*/
+void ha_rocksdb::next_spatial_cond_push(uint keyno, Item *cond) {
+  auto next_spatial_db_handler = get_next_spatial_db_handler();
+  next_spatial_db_handler->next_spatial_cond_end();
+  next_spatial_db_handler->next_spatial_cond_push(
+      table->key_info[keyno].key_part[0].field, cond);
+}
+
 /**
   Called by index_end() to clean up vector index related state if needed
 
@@ -14745,6 +17688,7 @@ void ha_rocksdb::next_spatial_index_end() {
     // Note: we are not making sure here that this is, in fact,
     // a KNN search index, but it should not matter at least today.
     auto next_spatial_db_handler = get_next_spatial_db_handler();
+    next_spatial_db_handler->next_spatial_index_end();
   }
 }
 
@@ -14797,6 +17741,12 @@ int ha_rocksdb::reset() {
   m_pk_iterator.reset(nullptr);
   m_converter->reset_buffer();
   m_no_read_locking = false;
+  if (m_next_spatial_db_handler) {
+    m_next_spatial_db_handler->next_spatial_cond_end();
+  }
+  // left over only by a statement that failed before end_bulk_insert
+  m_batch_vector_entries = false;
+  m_pending_vector_entries.clear();
   DBUG_RETURN(HA_EXIT_SUCCESS);
 }
 
@@ -14818,6 +17768,13 @@ int ha_rocksdb::delete_row(const uchar *const buf) {
   assert(buf == table->record[0] || buf == table->record[1]);
 
   ha_statistic_increment(&System_status_var::ha_delete_count);
+
+  const int throttle_err = check_cf_write_throttle();
+  if (throttle_err) DBUG_RETURN(throttle_err);
+
+  const int pending_err = write_pending_vector_entries();
+  if (pending_err) DBUG_RETURN(pending_err);
+
   set_last_rowkey(buf);
 
   rocksdb::Slice key_slice(m_last_rowkey.ptr(), m_last_rowkey.length());
@@ -14849,6 +17806,28 @@ int ha_rocksdb::delete_row(const uchar *const buf) {
       int packed_size;
       const Rdb_key_def &kd = *m_key_descr_arr[i];
 
+      if (kd.is_fulltext_index()) {
+        const int rc = write_fulltext_sk(table, kd, tx, buf, key_slice,
+                                         nullptr, rocksdb::Slice());
+        if (rc) DBUG_RETURN(rc);
+        continue;
+      }
+
+      if (kd.is_sparse_vector_index()) {
+        const int rc = write_sparse_vector_sk(table, kd, tx, buf, key_slice,
+                                              nullptr, rocksdb::Slice());
+        if (rc) DBUG_RETURN(rc);
+        continue;
+      }
+
+      if (kd.is_multi_vector_index()) {
+        const int rc =
+            write_multi_vector_sk(table, kd, tx, buf, key_slice, nullptr,
+                                  rocksdb::Slice(), hidden_pk_id);
+        if (rc) DBUG_RETURN(rc);
+        continue;
+      }
+
       // The unique key should be locked so that behavior is
       // similar to InnoDB and reduce conflicts. The key
       // used for locking does not include the extended fields.
@@ -14879,15 +17858,31 @@ int ha_rocksdb::delete_row(const uchar *const buf) {
         if (rc) DBUG_RETURN(rc);
       }
 
-      packed_size = kd.pack_record(table, m_pack_buffer, buf, m_sk_packed_tuple,
-                                   nullptr, false, hidden_pk_id);
+      // vector indexes get the codes of the removed entry along with its key
+      packed_size = kd.pack_record(
+          table, m_pack_buffer, buf, m_sk_packed_tuple,
+          kd.is_vector_index() ? &m_sk_tails : nullptr, false, hidden_pk_id);
       rocksdb::Slice secondary_key_slice(
           reinterpret_cast<const char *>(m_sk_packed_tuple), packed_size);
-      s = tx->get_indexed_write_batch(m_tbl_def->get_table_type())
-              ->SingleDelete(&kd.get_cf(), secondary_key_slice);
+      const auto wb = tx->get_indexed_write_batch(m_tbl_def->get_table_type());
+      s = kd.overwrites_entries()
+              ? wb->Delete(&kd.get_cf(), secondary_key_slice)
+              : wb->SingleDelete(&kd.get_cf(), secondary_key_slice);
       if (!s.ok()) {
         DBUG_RETURN(rdb_error_to_mysql(s));
       }
+      if (kd.is_vector_index()) {
+        const rocksdb::Slice secondary_value_slice(
+            reinterpret_cast<const char *>(m_sk_tails.ptr()),
+            m_sk_tails.get_current_pos());
+        kd.get_vector_index()->note_write();
+        const int rc = kd.get_vector_index()->on_entry_update(
+            tx, wb, secondary_key_slice, secondary_value_slice,
+            rocksdb::Slice(), rocksdb::Slice());
+        if (rc) {
+          DBUG_RETURN(rc);
+        }
+      }
       bytes_written += secondary_key_slice.size();
     }
   }
@@ -15332,6 +18327,13 @@ int ha_rocksdb::update_row(const uchar *const old_data, uchar *const new_data) {
   int err = check_disk_usage();
   if (err) DBUG_RETURN(err);
 
+  err = check_cf_write_throttle();
+  if (err) DBUG_RETURN(err);
+
+  // the row may be one of the batch, e.g. of INSERT ... ON DUPLICATE KEY
+  err = write_pending_vector_entries();
+  if (err) DBUG_RETURN(err);
+
   const int rv = update_write_row(old_data, new_data);
 
   if (rv == 0) {
@@ -15347,10 +18349,6 @@ int ha_rocksdb::update_row(const uchar *const old_data, uchar *const new_data) {
 void ha_rocksdb::update_table_stats_if_needed() {
   DBUG_ENTER_FUNC();
 
-  if (!rocksdb_table_stats_use_table_scan) {
-    DBUG_VOID_RETURN;
-  }
-
   /*
     InnoDB performs a similar operation to update counters during query
     processing. Because the changes in MyRocks are made to a write batch,
@@ -15366,7 +18364,11 @@ void ha_rocksdb::update_table_stats_if_needed() {
                              n_rows * rocksdb_table_stats_recalc_threshold_pct /
                              100.0))) {
     // Add the table to the recalc queue
-    rdb_is_thread.add_index_stats_request(m_tbl_def->full_tablename());
+    if (rocksdb_table_stats_use_table_scan) {
+      rdb_is_thread.add_index_stats_request(m_tbl_def->full_tablename());
+    }
+    // the histograms, which SST properties cannot give, go stale alike
+    histogram_refresher_enqueue(*table->s);
     m_tbl_def->m_tbl_stats.m_stat_modified_counter = 0;
   }
 
@@ -15589,6 +18591,8 @@ int ha_rocksdb::external_lock(THD *const thd, int lock_type) {
         tx->set_dd_transaction();
       }
     }
+    if (lock_type == F_WRLCK || m_lock_rows != RDB_LOCK_NONE)
+      tx->set_locking_stmt();
     tx->m_n_mysql_tables_in_use++;
     rocksdb_register_tx(rocksdb_hton, thd, tx);
     tx->io_perf_start(&m_io_perf);
@@ -16189,6 +19193,20 @@ int ha_rocksdb::extra(enum ha_extra_function operation) {
     case HA_EXTRA_NO_READ_LOCKING:
       m_no_read_locking = true;
       break;
+    case HA_EXTRA_BEGIN_BULK_LOAD:
+      // as SET rocksdb_bulk_load = 1, the rows go to SST files
+      THDVAR(ha_thd(), bulk_load) = 1;
+      break;
+    case HA_EXTRA_END_BULK_LOAD: {
+      // ingest the SST files, each load of a chunk makes its own
+      Rdb_transaction *const tx = get_tx_from_thd(ha_thd());
+      THDVAR(ha_thd(), bulk_load) = 0;
+      if (tx != nullptr) {
+        const int rc = tx->finish_bulk_load();
+        if (rc != HA_EXIT_SUCCESS) DBUG_RETURN(rc);
+      }
+      break;
+    }
     default:
       break;
   }
@@ -16216,18 +19234,32 @@ ha_rows ha_rocksdb::records_in_range(uint inx, key_range *const min_key,
   }
 
   const Rdb_key_def &kd = *m_key_descr_arr[inx];
-  auto disk_size = kd.m_stats.m_actual_disk_size;
-  if (disk_size == 0) disk_size = kd.m_stats.m_data_size;
-  auto rows = kd.m_stats.m_rows;
-  if (rows == 0 || disk_size == 0) {
-    rows = 1;
-    disk_size = ROCKSDB_ASSUMED_KEY_VALUE_DISK_SIZE;
+  // the key of a spatial range is the mbr of its window, lon range then lat
+  // range, which the key space of the index says nothing about
+  double spatial_fraction = -1;
+  if (kd.is_next_spatial_index() && min_key != nullptr &&
+      min_key->length >= 4 * sizeof(double)) {
+    double mbr[4];
+    memcpy(mbr, min_key->key, sizeof(mbr));
+    spatial_fraction = rdb_spatial_histogram_fraction(
+        kd.m_stats.m_spatial_histogram, {mbr[2], mbr[3], mbr[0], mbr[1]});
+  }
+  if (spatial_fraction >= 0) {
+    ret = spatial_fraction * stats.records;
+  } else {
+    auto disk_size = kd.m_stats.m_actual_disk_size;
+    if (disk_size == 0) disk_size = kd.m_stats.m_data_size;
+    auto rows = kd.m_stats.m_rows;
+    if (rows == 0 || disk_size == 0) {
+      rows = 1;
+      disk_size = ROCKSDB_ASSUMED_KEY_VALUE_DISK_SIZE;
+    }
+    ulonglong total_size = 0;
+    ulonglong total_row = 0;
+    records_in_range_internal(inx, min_key, max_key, disk_size, rows,
+                              &total_size, &total_row);
+    ret = total_row;
   }
-  ulonglong total_size = 0;
-  ulonglong total_row = 0;
-  records_in_range_internal(inx, min_key, max_key, disk_size, rows, &total_size,
-                            &total_row);
-  ret = total_row;
   /*
     GetApproximateSizes() gives estimates so ret might exceed stats.records.
     MySQL then decides to use full index scan rather than range scan, which
@@ -16661,9 +19693,10 @@ static int calculate_stats(
     }
   }
 
+  // if this is initiated from background thread, current thd is not set,
+  // the vector indexes that need one skip the analyze then.
   THD *thd = thd_get_current_thd();
-  // if this is initiated from background thread, current thd is not set.
-  if (scan_type == SCAN_TYPE_FULL_TABLE && thd) {
+  if (scan_type == SCAN_TYPE_FULL_TABLE) {
     for (auto &key : to_recalc) {
       if (key.second->is_vector_index()) {
         ret = key.second->get_vector_index()->analyze(thd, max_num_rows_scanned,
@@ -17051,7 +20084,8 @@ const char *dbug_print_item(Item *const item) {
     which means that field value can be restored from the index tuple.
 
   @return
-    Part of condition we couldn't check (always nullptr).
+    Part of condition we couldn't check, nullptr unless keyno is a sparse
+    vector index.
 */
 
 class Item *ha_rocksdb::idx_cond_push(uint keyno, class Item *const idx_cond) {
@@ -17060,6 +20094,12 @@ class Item *ha_rocksdb::idx_cond_push(uint keyno, class Item *const idx_cond) {
   assert(keyno != MAX_KEY);
   assert(idx_cond != nullptr);
 
+  // a sparse vector index search does not filter its postings, the
+  // condition is checked on the rows it returns
+  if (m_key_descr_arr[keyno]->is_sparse_vector_index()) {
+    DBUG_RETURN(idx_cond);
+  }
+
   pushed_idx_cond = idx_cond;
   pushed_idx_cond_keyno = keyno;
   in_range_check_pushed_down = true;
@@ -17259,6 +20299,7 @@ my_core::enum_alter_inplace_result ha_rocksdb::check_if_supported_inplace_alter(
         my_core::Alter_inplace_info::DROP_UNIQUE_INDEX |
         my_core::Alter_inplace_info::ADD_INDEX |
         my_core::Alter_inplace_info::ADD_UNIQUE_INDEX |
+        my_core::Alter_inplace_info::ADD_SPATIAL_INDEX |
         my_core::Alter_inplace_info::CHANGE_CREATE_OPTION |
         my_core::Alter_inplace_info::DROP_PARTITION |
         (rocksdb_alter_column_default_inplace
@@ -17267,6 +20308,39 @@ my_core::enum_alter_inplace_result ha_rocksdb::check_if_supported_inplace_alter(
     DBUG_RETURN(my_core::HA_ALTER_INPLACE_NOT_SUPPORTED);
   }
 
+  /*
+    The entries of a hilbert next spatial index are ordinary secondary keys
+    sorted by the curve, so they are bulk loaded like any other index. Other
+    spatial indexes are built from the primary key files and need a copy.
+  */
+  if (ha_alter_info->handler_flags &
+      my_core::Alter_inplace_info::ADD_SPATIAL_INDEX) {
+    for (uint i = 0; i < ha_alter_info->index_add_count; i++) {
+      const KEY &key =
+          ha_alter_info->key_info_buffer[ha_alter_info->index_add_buffer[i]];
+      if ((key.flags & HA_SPATIAL) &&
+          key.next_spatial_index_config.type() !=
+              NEXT_SPATIAL_INDEX_TYPE::HILBERT_INDEX) {
+        DBUG_RETURN(my_core::HA_ALTER_INPLACE_NOT_SUPPORTED);
+      }
+    }
+  }
+
+  /* FULLTEXT and sparse vector indexes are written row by row, with their
+     stats, and so are the entries per list of multi-vector indexes */
+  if (ha_alter_info->handler_flags &
+      my_core::Alter_inplace_info::ADD_INDEX) {
+    for (uint i = 0; i < ha_alter_info->index_add_count; i++) {
+      const KEY &key =
+          ha_alter_info->key_info_buffer[ha_alter_info->index_add_buffer[i]];
+      if ((key.flags & HA_FULLTEXT) ||
+          key.fb_vector_index_config.multi() ||
+          key.fb_vector_index_config.sparse()) {
+        DBUG_RETURN(my_core::HA_ALTER_INPLACE_NOT_SUPPORTED);
+      }
+    }
+  }
+
   /* We don't support unique keys on table w/ no primary keys */
   if ((ha_alter_info->handler_flags &
        my_core::Alter_inplace_info::ADD_UNIQUE_INDEX) &&
@@ -17323,6 +20397,11 @@ my_core::enum_alter_inplace_result ha_rocksdb::check_if_supported_inplace_alter(
         (ttl_duration > 0 && altered_ttl_duration == 0))
       DBUG_RETURN(my_core::HA_ALTER_INPLACE_NOT_SUPPORTED);
 
+    // the record format changes with fixed_offsets
+    if (m_tbl_def->m_key_descr_arr[pk]->has_fixed_offsets() !=
+        Rdb_key_def::extract_fixed_offsets(*altered_table, *m_tbl_def))
+      DBUG_RETURN(my_core::HA_ALTER_INPLACE_NOT_SUPPORTED);
+
     // Support instant alter when ttl duration is unchanged
     if (rocksdb_enable_instant_ddl_for_table_comment_changes &&
         (ttl_duration == altered_ttl_duration)) {
@@ -17392,7 +20471,8 @@ bool ha_rocksdb::prepare_inplace_alter_table(
        (my_core::Alter_inplace_info::DROP_INDEX |
         my_core::Alter_inplace_info::DROP_UNIQUE_INDEX |
         my_core::Alter_inplace_info::ADD_INDEX |
-        my_core::Alter_inplace_info::ADD_UNIQUE_INDEX)) ||
+        my_core::Alter_inplace_info::ADD_UNIQUE_INDEX |
+        my_core::Alter_inplace_info::ADD_SPATIAL_INDEX)) ||
       is_instant(ha_alter_info) || update_comment) {
     if (has_hidden_pk(*altered_table)) {
       new_n_keys += 1;
@@ -17546,7 +20626,8 @@ bool ha_rocksdb::inplace_alter_table(
 
   if (!(ha_alter_info->handler_flags &
         (my_core::Alter_inplace_info::ADD_INDEX |
-         my_core::Alter_inplace_info::ADD_UNIQUE_INDEX))) {
+         my_core::Alter_inplace_info::ADD_UNIQUE_INDEX |
+         my_core::Alter_inplace_info::ADD_SPATIAL_INDEX))) {
     DBUG_RETURN(res);
   }
 
@@ -17650,6 +20731,418 @@ int ha_rocksdb::fill_virtual_columns() {
 /**
  Scan the Primary Key index entries and populate the new secondary keys.
 */
+/**
+  Whether a primary key column of the table is a blob, such columns point
+  outside of the record buffer.
+*/
+static bool rdb_pk_has_blob_part(const TABLE &table) {
+  if (table.s->primary_key == MAX_KEY) {
+    return false;
+  }
+  const KEY &pk = table.key_info[table.s->primary_key];
+  for (uint i = 0; i < pk.user_defined_key_parts; i++) {
+    if (pk.key_part[i].key_part_flag & HA_BLOB_PART) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+  Scan the table and bulk load the entries of a new ivf or graph vector
+  index. Rows are buffered in batches so the vectors of a whole batch are
+  assigned to the index at once, which lets an ivf index run its quantizer
+  over the batch on the vector worker threads instead of searching the
+  centroids once per row. The entries still go through bulk_load_key, so
+  they are sorted by Rdb_index_merge and ingested as SST files.
+
+  The buffered records are copied, so the caller makes sure no primary key
+  column is a blob.
+
+  @return
+    HA_ERR_END_OF_FILE  every row was loaded
+    other               HA_ERR error code
+*/
+int ha_rocksdb::inplace_populate_vector_sk(TABLE *const new_table_arg,
+                                           Rdb_transaction *const tx,
+                                           const Rdb_key_def &index) {
+  struct Pending_row {
+    std::string m_record;
+    std::string m_ttl_bytes;
+    longlong m_hidden_pk_id;
+    bool m_has_vector;
+  };
+  const bool hidden_pk_exists = has_hidden_pk(*table);
+  Rdb_vector_index *const vector_index = index.get_vector_index();
+  const std::size_t dimension = vector_index->dimension();
+  std::vector<Pending_row> rows;
+  // vectors of the buffered rows that have one, back to back
+  std::vector<float> vectors;
+  std::vector<float> vector;
+  std::vector<Rdb_vector_index_assignment> assignments;
+  rows.reserve(RDB_VECTOR_POPULATE_BATCH_SIZE);
+  vectors.reserve(RDB_VECTOR_POPULATE_BATCH_SIZE * dimension);
+
+  const auto load_rows = [&]() -> int {
+    vector_index->assign_vectors(vectors.size() / dimension, vectors.data(),
+                                 assignments);
+    std::size_t assigned = 0;
+    for (const auto &row : rows) {
+      const Rdb_vector_index_assignment *const assignment =
+          row.m_has_vector ? &assignments[assigned++] : nullptr;
+      const int new_packed_size = index.pack_record(
+          new_table_arg, m_pack_buffer,
+          reinterpret_cast<const uchar *>(row.m_record.data()),
+          m_sk_packed_tuple, &m_sk_tails, should_store_row_debug_checksums(),
+          row.m_hidden_pk_id, 0, nullptr, row.m_ttl_bytes.data(), assignment);
+
+      const rocksdb::Slice key = rocksdb::Slice(
+          reinterpret_cast<const char *>(m_sk_packed_tuple), new_packed_size);
+      const rocksdb::Slice val =
+          rocksdb::Slice(reinterpret_cast<const char *>(m_sk_tails.ptr()),
+                         m_sk_tails.get_current_pos());
+      const int rc = bulk_load_key(tx, index, key, val, true);
+      if (rc) {
+        return rc;
+      }
+    }
+    rows.clear();
+    vectors.clear();
+    return HA_EXIT_SUCCESS;
+  };
+
+  int res;
+  for (res = ha_rnd_next(table->record[0]); res == 0;
+       res = ha_rnd_next(table->record[0])) {
+    Pending_row row{.m_hidden_pk_id = 0, .m_has_vector = false};
+    if (hidden_pk_exists &&
+        (res = read_hidden_pk_id_from_rowkey(&row.m_hidden_pk_id))) {
+      // NO_LINT_DEBUG
+      LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                      "Error retrieving hidden pk id.");
+      return res;
+    }
+
+    if ((res = fill_virtual_columns())) {
+      return res;
+    }
+
+    if ((res = index.read_vector(new_table_arg, table->record[0], &vector))) {
+      return res;
+    }
+    row.m_has_vector = !vector.empty();
+    vectors.insert(vectors.end(), vector.begin(), vector.end());
+    row.m_record.assign(reinterpret_cast<const char *>(table->record[0]),
+                        table->s->reclength);
+    row.m_ttl_bytes.assign(m_ttl_bytes, ROCKSDB_SIZEOF_TTL_RECORD);
+    rows.push_back(std::move(row));
+
+    if (rows.size() == RDB_VECTOR_POPULATE_BATCH_SIZE &&
+        (res = load_rows())) {
+      return res;
+    }
+  }
+
+  if (res == HA_ERR_END_OF_FILE && !rows.empty()) {
+    const int rc = load_rows();
+    if (rc) {
+      return rc;
+    }
+  }
+  return res;
+}
+
+/**
+  Rows of multi-row INSERTs, LOAD DATA and replicated row events are
+  written between start_bulk_insert and end_bulk_insert. The entries of
+  their ivf and graph vector indexes are written in batches, see
+  write_pending_vector_entries, rather than assigning each vector on its own.
+*/
+void ha_rocksdb::start_bulk_insert(ha_rows rows) {
+  DBUG_ENTER_FUNC();
+
+  // the buffered records are copied, so no primary key column is a blob
+  m_batch_vector_entries = false;
+  if (rows == 1 || m_tbl_def->is_intrinsic_tmp_table() ||
+      rdb_pk_has_blob_part(*table)) {
+    DBUG_VOID_RETURN;
+  }
+  for (uint i = 0; i < table->s->keys; i++) {
+    const Rdb_key_def &kd = *m_key_descr_arr[i];
+    if (kd.is_vector_index() && kd.get_vector_index_config().type() !=
+                                    FB_VECTOR_INDEX_TYPE::LSMIDX) {
+      m_batch_vector_entries = true;
+      break;
+    }
+  }
+
+  DBUG_VOID_RETURN;
+}
+
+int ha_rocksdb::end_bulk_insert() {
+  DBUG_ENTER_FUNC();
+
+  m_batch_vector_entries = false;
+  DBUG_RETURN(write_pending_vector_entries());
+}
+
+/**
+  Write the vector index entries of the rows buffered by update_write_sk.
+  The vectors of each index are assigned in one batch, so an ivf index runs
+  its quantizer once over all of them, on the vector worker threads.
+
+  @return
+    HA_EXIT_SUCCESS  OK
+    other            HA_ERR error code (can be SE-specific)
+*/
+int ha_rocksdb::write_pending_vector_entries() {
+  if (m_pending_vector_entries.empty()) {
+    return HA_EXIT_SUCCESS;
+  }
+
+  Rdb_transaction *const tx =
+      get_or_create_tx(table->in_use, m_tbl_def->get_table_type());
+  const auto wb = tx->get_indexed_write_batch(m_tbl_def->get_table_type());
+  const bool store_row_debug_checksums = should_store_row_debug_checksums();
+  std::vector<float> vectors;
+  std::vector<Rdb_vector_index_assignment> assignments;
+  ulonglong bytes_written = 0;
+  int rc = HA_EXIT_SUCCESS;
+  for (uint keyno = 0; keyno < table->s->keys && rc == HA_EXIT_SUCCESS;
+       keyno++) {
+    vectors.clear();
+    for (const auto &entry : m_pending_vector_entries) {
+      if (entry.m_keyno == keyno) {
+        vectors.insert(vectors.end(), entry.m_vector.begin(),
+                       entry.m_vector.end());
+      }
+    }
+    if (vectors.empty()) {
+      continue;
+    }
+
+    const Rdb_key_def &kd = *m_key_descr_arr[keyno];
+    Rdb_vector_index *const vector_index = kd.get_vector_index();
+    vector_index->assign_vectors(vectors.size() / vector_index->dimension(),
+                                 vectors.data(), assignments);
+    std::size_t assigned = 0;
+    for (const auto &entry : m_pending_vector_entries) {
+      if (entry.m_keyno != keyno) {
+        continue;
+      }
+      const uint packed_size = kd.pack_record(
+          table, m_pack_buffer,
+          reinterpret_cast<const uchar *>(entry.m_record.data()),
+          m_sk_packed_tuple, &m_sk_tails, store_row_debug_checksums,
+          entry.m_hidden_pk_id, 0, nullptr, entry.m_ttl_bytes.data(),
+          &assignments[assigned++]);
+      const rocksdb::Slice key(
+          reinterpret_cast<const char *>(m_sk_packed_tuple), packed_size);
+      const rocksdb::Slice value(
+          reinterpret_cast<const char *>(m_sk_tails.ptr()),
+          m_sk_tails.get_current_pos());
+      wb->Put(&kd.get_cf(), key, value);
+      vector_index->note_write();
+      rc = vector_index->on_entry_update(tx, wb, rocksdb::Slice(),
+                                         rocksdb::Slice(), key, value);
+      if (rc) {
+        break;
+      }
+      bytes_written += key.size() + value.size();
+    }
+  }
+  m_pending_vector_entries.clear();
+
+  if (rc == HA_EXIT_SUCCESS) {
+    tx->update_bytes_written(bytes_written, m_tbl_def->get_table_type());
+  }
+  return rc;
+}
+
+/**
+  Add the entries of a new secondary index for the rows of a scan of the
+  primary key by @@rocksdb_index_build_threads threads, see
+  Rdb_parallel_scan. Each thread packs the entries of its rows and sorts
+  them into runs of an Rdb_index_merge of its own, whose runs the merge of
+  the transaction then takes over, so finish_bulk_load merges the runs of
+  all the threads in one pass.
+
+  pack_record moves the fields of the key parts, so each thread packs with
+  a TABLE of its own opened from the share of new_table_arg.
+
+  @return
+    HA_EXIT_SUCCESS     the entries of every row were added
+    HA_ERR_UNSUPPORTED  the rows are to be scanned on this thread
+    other               HA_ERR error code
+*/
+int ha_rocksdb::inplace_populate_sk_parallel(TABLE *const new_table_arg,
+                                             Rdb_transaction *const tx,
+                                             const Rdb_key_def &index) {
+  struct Populate_thread {
+    std::unique_ptr<Rdb_converter> m_converter;
+    TABLE *m_table = nullptr;
+    std::unique_ptr<uchar[]> m_pack_buffer;
+    std::unique_ptr<uchar[]> m_packed_tuple;
+    Rdb_string_writer m_tails;
+    std::unique_ptr<Rdb_index_merge> m_merge;
+    ha_rows m_rows = 0;
+    int m_error = HA_EXIT_SUCCESS;
+  };
+
+  THD *const thd = ha_thd();
+  const uint max_threads = THDVAR(thd, index_build_threads);
+  // fill_virtual_columns computes the virtual columns on this thread only
+  if (max_threads <= 1 || table->vfield != nullptr ||
+      index.is_vector_index() || index.is_next_spatial_index() ||
+      index.is_fulltext_index()) {
+    return HA_ERR_UNSUPPORTED;
+  }
+
+  const auto scan = new_parallel_scan(*m_pk_descr, max_threads);
+  if (scan == nullptr || scan->threads() <= 1) {
+    return HA_ERR_UNSUPPORTED;
+  }
+
+  const dd::Table *dd_table = nullptr;
+  dd::cache::Dictionary_client *dd_client = thd->dd_client();
+  dd::cache::Dictionary_client::Auto_releaser releaser(dd_client);
+  if (dd_client->acquire(table->s->db.str, table->s->table_name.str,
+                         &dd_table)) {
+    return HA_ERR_ROCKSDB_INVALID_TABLE;
+  }
+
+  std::vector<Populate_thread> threads(scan->threads());
+  Ensure_cleanup tables_cleanup([&threads]() {
+    for (auto &thread : threads) {
+      if (thread.m_table != nullptr) {
+        closefrm(thread.m_table, false);
+        my_free(thread.m_table);
+      }
+    }
+  });
+
+  const uint max_packed_sk_len = index.max_storage_fmt_length();
+  for (auto &thread : threads) {
+    thread.m_converter.reset(
+        new Rdb_converter(thd, m_tbl_def, table, dd_table));
+    thread.m_converter->setup_field_decoders(
+        table->read_set, table->s->primary_key, true /* keyread_only */,
+        true /* decode_all_fields */);
+
+    // Without a handler opened, DELAYED_OPEN gives the TABLE its own record
+    auto *const clone = static_cast<TABLE *>(
+        my_malloc(PSI_NOT_INSTRUMENTED, sizeof(TABLE), MYF(MY_WME)));
+    if (clone == nullptr) {
+      return HA_ERR_OUT_OF_MEM;
+    }
+    if (open_table_from_share(thd, new_table_arg->s, new_table_arg->alias, 0,
+                              DELAYED_OPEN, 0, clone, false, nullptr)) {
+      my_free(clone);
+      return HA_ERR_INTERNAL_ERROR;
+    }
+    thread.m_table = clone;
+
+    thread.m_pack_buffer.reset(new uchar[max_packed_sk_len]);
+    thread.m_packed_tuple.reset(new uchar[max_packed_sk_len]);
+    thread.m_merge.reset(new Rdb_index_merge(
+        get_rocksdb_tmpdir(), THDVAR(thd, merge_buf_size),
+        THDVAR(thd, merge_combine_read_size),
+        THDVAR(thd, merge_tmp_file_removal_delay_ms), index.get_cf()));
+    const int rc = thread.m_merge->init();
+    if (rc != HA_EXIT_SUCCESS) {
+      return rc;
+    }
+  }
+
+  const bool hidden_pk_exists = has_hidden_pk(*table);
+  const rocksdb::Status s = scan->run(
+      [&](uint thread_no, const rocksdb::Slice &key,
+          const rocksdb::Slice &value) {
+        Populate_thread &thread = threads[thread_no];
+        TABLE *const clone = thread.m_table;
+        int rc = thread.m_converter->decode(*m_pk_descr, clone->record[0], &key,
+                                            &value);
+
+        longlong hidden_pk_id = 0;
+        if (rc == HA_EXIT_SUCCESS && hidden_pk_exists) {
+          // As read_hidden_pk_id_from_rowkey, from the key of this thread
+          Rdb_string_reader reader(&key);
+          const uchar *from = nullptr;
+          if (reader.read(Rdb_key_def::INDEX_NUMBER_SIZE)) {
+            from = reinterpret_cast<const uchar *>(
+                reader.read(Field_longlong::PACK_LENGTH));
+          }
+          if (from == nullptr) {
+            rc = HA_ERR_ROCKSDB_CORRUPT_DATA;
+          } else {
+            hidden_pk_id = rdb_netbuf_read_uint64(&from);
+          }
+        }
+        if (rc != HA_EXIT_SUCCESS) {
+          thread.m_error = rc;
+          return true;
+        }
+
+        const int new_packed_size = index.pack_record(
+            clone, thread.m_pack_buffer.get(), clone->record[0],
+            thread.m_packed_tuple.get(), &thread.m_tails,
+            should_store_row_debug_checksums(), hidden_pk_id, 0, nullptr,
+            thread.m_converter->get_ttl_bytes_buffer());
+
+        const rocksdb::Slice sk_key(
+            reinterpret_cast<const char *>(thread.m_packed_tuple.get()),
+            new_packed_size);
+        const rocksdb::Slice sk_val(
+            reinterpret_cast<const char *>(thread.m_tails.ptr()),
+            thread.m_tails.get_current_pos());
+        if ((rc = thread.m_merge->add(sk_key, sk_val))) {
+          thread.m_error = rc;
+          return true;
+        }
+
+        return ++thread.m_rows % 4096 == 0 && thd->killed;
+      });
+
+  if (thd->killed) {
+    return HA_ERR_QUERY_INTERRUPTED;
+  }
+  ha_rows rows = 0;
+  for (const auto &thread : threads) {
+    if (thread.m_error == HA_ERR_ROCKSDB_CORRUPT_DATA) {
+      return handle_rocksdb_corrupt_data_error(thd);
+    }
+    if (thread.m_error != HA_EXIT_SUCCESS) {
+      return thread.m_error;
+    }
+    rows += thread.m_rows;
+  }
+  if (!s.ok()) {
+    return rdb_tx_set_status_error(*tx, s, *m_pk_descr, m_tbl_def);
+  }
+  update_row_read(rows);
+
+  // As bulk_load_key, nothing is loaded for an empty table
+  if (rows == 0) {
+    return HA_EXIT_SUCCESS;
+  }
+
+  int rc = bulk_load_start(tx, index);
+  if (rc != HA_EXIT_SUCCESS) {
+    return rc;
+  }
+  Rdb_index_merge *key_merge;
+  if ((rc = tx->get_key_merge(index.get_gl_index_id(), index.get_cf(),
+                              &key_merge))) {
+    return rc;
+  }
+  for (auto &thread : threads) {
+    if ((rc = key_merge->add_runs(thread.m_merge.get()))) {
+      return rc;
+    }
+  }
+  return HA_EXIT_SUCCESS;
+}
+
 int ha_rocksdb::inplace_populate_sk(
     TABLE *const new_table_arg,
     const std::unordered_set<std::shared_ptr<Rdb_key_def>> &indexes) {
@@ -17763,43 +21256,56 @@ int ha_rocksdb::inplace_populate_sk(
     res = ha_rnd_init(true /* scan */);
     if (res) DBUG_RETURN(res);
 
-    /* Scan each record in the primary key in order */
-    for (res = ha_rnd_next(table->record[0]); res == 0;
-         res = ha_rnd_next(table->record[0])) {
-      longlong hidden_pk_id = 0;
-      if (hidden_pk_exists &&
-          (res = read_hidden_pk_id_from_rowkey(&hidden_pk_id))) {
-        // NO_LINT_DEBUG
-        LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
-                        "Error retrieving hidden pk id.");
-        ha_rnd_end();
-        DBUG_RETURN(res);
-      }
+    if (index->is_vector_index() &&
+        index->get_vector_index_config().type() !=
+            FB_VECTOR_INDEX_TYPE::LSMIDX &&
+        !rdb_pk_has_blob_part(*table)) {
+      res = inplace_populate_vector_sk(new_table_arg, tx, *index);
+    } else if ((res = inplace_populate_sk_parallel(new_table_arg, tx,
+                                                   *index)) !=
+               HA_ERR_UNSUPPORTED) {
+      // the entries of all the rows are in the merge of the transaction
+      if (res == HA_EXIT_SUCCESS) res = HA_ERR_END_OF_FILE;
+    } else {
+      /* Scan each record in the primary key in order */
+      for (res = ha_rnd_next(table->record[0]); res == 0;
+           res = ha_rnd_next(table->record[0])) {
+        longlong hidden_pk_id = 0;
+        if (hidden_pk_exists &&
+            (res = read_hidden_pk_id_from_rowkey(&hidden_pk_id))) {
+          // NO_LINT_DEBUG
+          LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                          "Error retrieving hidden pk id.");
+          ha_rnd_end();
+          DBUG_RETURN(res);
+        }
 
-      if ((res = fill_virtual_columns())) {
-        ha_rnd_end();
-        DBUG_RETURN(res);
-      }
+        if ((res = fill_virtual_columns())) {
+          ha_rnd_end();
+          DBUG_RETURN(res);
+        }
 
-      /* Create new secondary index entry */
-      const int new_packed_size = index->pack_record(
-          new_table_arg, m_pack_buffer, table->record[0], m_sk_packed_tuple,
-          &m_sk_tails, should_store_row_debug_checksums(), hidden_pk_id, 0,
-          nullptr, m_ttl_bytes);
+        /* Create new secondary index entry */
+        const int new_packed_size = index->pack_record(
+            new_table_arg, m_pack_buffer, table->record[0], m_sk_packed_tuple,
+            &m_sk_tails, should_store_row_debug_checksums(), hidden_pk_id, 0,
+            nullptr, m_ttl_bytes);
 
-      const rocksdb::Slice key = rocksdb::Slice(
-          reinterpret_cast<const char *>(m_sk_packed_tuple), new_packed_size);
-      const rocksdb::Slice val =
-          rocksdb::Slice(reinterpret_cast<const char *>(m_sk_tails.ptr()),
-                         m_sk_tails.get_current_pos());
+        const rocksdb::Slice key = rocksdb::Slice(
+            reinterpret_cast<const char *>(m_sk_packed_tuple),
+            new_packed_size);
+        const rocksdb::Slice val =
+            rocksdb::Slice(reinterpret_cast<const char *>(m_sk_tails.ptr()),
+                           m_sk_tails.get_current_pos());
 
-      /*
-        Add record to offset tree in preparation for writing out to
-        disk in sorted chunks.
-      */
-      if ((res = bulk_load_key(tx, *index, key, val, true))) {
-        ha_rnd_end();
-        DBUG_RETURN(res);
+        /*
+          Add record to offset tree in preparation for writing out to
+          disk in sorted chunks.
+        */
+        if ((res = bulk_load_key(tx, *index, key, val, true))) {
+          ha_rnd_end();
+          DBUG_RETURN(res);
+        }
       }
     }
 
@@ -17830,6 +21336,16 @@ int ha_rocksdb::inplace_populate_sk(
                       "Error finishing bulk load.");
       DBUG_RETURN(res);
     }
+
+    if (!res && index->is_vector_index()) {
+      res = index->get_vector_index()->populate(ha_thd());
+      if (res) {
+        // NO_LINT_DEBUG
+        LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                        "Error populating vector index.");
+        DBUG_RETURN(res);
+      }
+    }
   }
 
   /*
@@ -18001,7 +21517,8 @@ bool ha_rocksdb::commit_inplace_alter_table(
       (my_core::Alter_inplace_info::DROP_INDEX |
        my_core::Alter_inplace_info::DROP_UNIQUE_INDEX |
        my_core::Alter_inplace_info::ADD_INDEX |
-       my_core::Alter_inplace_info::ADD_UNIQUE_INDEX)) {
+       my_core::Alter_inplace_info::ADD_UNIQUE_INDEX |
+       my_core::Alter_inplace_info::ADD_SPATIAL_INDEX)) {
     auto local_dict_manager =
         dict_manager.get_dict_manager_selector_non_const(table_default_cf_id);
     const std::unique_ptr<rocksdb::WriteBatch> wb = local_dict_manager->begin();
@@ -18395,6 +21912,14 @@ static void myrocks_update_status() {
       global_stats.covered_secondary_key_lookups;
   export_stats.intrinsic_tmp_table_commits =
       global_stats.intrinsic_tmp_table_commits;
+
+  export_stats.large_scans = rdb_large_scan_stats.m_scans;
+  export_stats.large_scan_block_read_count =
+      rdb_large_scan_stats.m_block_read_count;
+  export_stats.large_scan_block_read_bytes =
+      rdb_large_scan_stats.m_block_read_byte;
+  export_stats.large_scan_block_cache_hits =
+      rdb_large_scan_stats.m_block_cache_hit_count;
 }
 
 static void myrocks_update_memory_status() {
@@ -18456,6 +21981,17 @@ static SHOW_VAR myrocks_status_variables[] = {
     DEF_STATUS_VAR_FUNC("intrinsic_tmp_table_commits",
                         &export_stats.intrinsic_tmp_table_commits,
                         SHOW_LONGLONG),
+    DEF_STATUS_VAR_FUNC("large_scans", &export_stats.large_scans,
+                        SHOW_LONGLONG),
+    DEF_STATUS_VAR_FUNC("large_scan_block_read_count",
+                        &export_stats.large_scan_block_read_count,
+                        SHOW_LONGLONG),
+    DEF_STATUS_VAR_FUNC("large_scan_block_read_bytes",
+                        &export_stats.large_scan_block_read_bytes,
+                        SHOW_LONGLONG),
+    DEF_STATUS_VAR_FUNC("large_scan_block_cache_hits",
+                        &export_stats.large_scan_block_cache_hits,
+                        SHOW_LONGLONG),
     {NullS, NullS, SHOW_LONG, SHOW_SCOPE_GLOBAL}};
 
 static int show_myrocks_vars(THD *thd MY_ATTRIBUTE((unused)), SHOW_VAR *var,
@@ -18710,6 +22246,10 @@ static SHOW_VAR rocksdb_status_vars[] = {
                        &rocksdb_partial_index_rows_sorted, SHOW_LONGLONG),
     DEF_STATUS_VAR_PTR("partial_index_rows_materialized",
                        &rocksdb_partial_index_rows_materialized, SHOW_LONGLONG),
+    DEF_STATUS_VAR_PTR("partial_index_groups_queued",
+                       &rocksdb_partial_index_groups_queued, SHOW_LONGLONG),
+    DEF_STATUS_VAR_PTR("partial_index_groups_stale",
+                       &rocksdb_partial_index_groups_stale, SHOW_LONGLONG),
 
     // the variables generated by SHOW_FUNC are sorted only by prefix (first
     // arg in the tuple below), so make sure it is unique to make sorting
@@ -18803,13 +22343,86 @@ void Rdb_background_thread::run() {
       }
     }
 
-    // Set the next timestamp for mysql_cond_timedwait() (which ends up calling
-    // pthread_cond_timedwait()) to wait on.
-    ts_next_sync.tv_sec = ts.tv_sec + WAKE_UP_INTERVAL;
-  }
-
-  // save remaining stats which might've left unsaved
-  ddl_manager.persist_stats();
+    // Set the next timestamp for mysql_cond_timedwait() (which ends up calling
+    // pthread_cond_timedwait()) to wait on.
+    ts_next_sync.tv_sec = ts.tv_sec + WAKE_UP_INTERVAL;
+  }
+
+  // save remaining stats which might've left unsaved
+  ddl_manager.persist_stats();
+}
+
+void Rdb_index_setup_thread::run() {
+  // tables are opened through the command service, which needs the server
+  // to be up
+  for (;;) {
+    timespec ts;
+    set_timespec(&ts, 1);
+    RDB_MUTEX_LOCK_CHECK(m_signal_mutex);
+    if (!m_killed && get_server_state() != SERVER_OPERATING) {
+      mysql_cond_timedwait(&m_signal_cond, &m_signal_mutex, &ts);
+    }
+    const bool killed = m_killed;
+    RDB_MUTEX_UNLOCK_CHECK(m_signal_mutex);
+    if (killed) return;
+    if (get_server_state() == SERVER_OPERATING) break;
+  }
+
+  // vector and spatial indexes are secondary ones, partitions of a table
+  // are all set up by opening it once
+  struct Rdb_setup_collector : public Rdb_tables_scanner {
+    std::set<std::pair<std::string, std::string>> m_tables;
+    int add_table(Rdb_tbl_def *tdef) override {
+      if (tdef->get_table_type() == TABLE_TYPE::USER_TABLE &&
+          tdef->m_key_count > 1 && !is_tmp_table(tdef->full_tablename()) &&
+          tdef->base_tablename().find(TRUNCATE_TABLE_PREFIX) ==
+              std::string::npos) {
+        m_tables.emplace(tdef->base_dbname(), tdef->base_tablename());
+      }
+      return HA_EXIT_SUCCESS;
+    }
+  } collector;
+  ddl_manager.scan_for_tables(&collector);
+  const std::vector<std::pair<std::string, std::string>> tables(
+      collector.m_tables.begin(), collector.m_tables.end());
+
+  const auto start = std::chrono::steady_clock::now();
+  std::atomic<size_t> next{0};
+  std::atomic<uint64_t> opened{0};
+  auto worker = [&]() {
+    if (mysql_service_mysql_command_thread->init()) return;
+    for (size_t i = next++; i < tables.size() && !m_killed; i = next++) {
+      const auto status =
+          cmd_srv_helper->open_table(tables[i].first, tables[i].second);
+      if (status.error()) {
+        // NO_LINT_DEBUG
+        LogPluginErrMsg(WARNING_LEVEL, ER_LOG_PRINTF_MSG,
+                        "RocksDB: Failed to set up the indexes of %s.%s: %s",
+                        tables[i].first.c_str(), tables[i].second.c_str(),
+                        status.message().c_str());
+      } else {
+        opened++;
+      }
+    }
+    mysql_service_mysql_command_thread->end();
+  };
+
+  std::vector<std::thread> workers;
+  const size_t num_workers =
+      std::min<size_t>(rocksdb_vector_index_setup_threads, tables.size());
+  for (size_t i = 0; i < num_workers; i++) workers.emplace_back(worker);
+  for (auto &thread : workers) thread.join();
+
+  const uint64_t elapsed_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start)
+          .count();
+  st_rdb_exec_time.add("index setup", start, elapsed_us, opened);
+  // NO_LINT_DEBUG
+  LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
+                  "RocksDB: Set up the indexes of %" PRIu64
+                  " tables in %" PRIu64 " ms with %zu threads",
+                  opened.load(), elapsed_us / 1000, num_workers);
 }
 
 void Rdb_index_stats_thread::run() {
@@ -19005,6 +22618,219 @@ size_t Rdb_index_stats_thread::get_request_queue_size() {
   return len;
 }
 
+/*
+  A background thread to materialize the groups of partial indexes the
+  readers queued, one at a time and at most
+  rocksdb_partial_index_materialize_rate rows a second.
+*/
+void Rdb_partial_index_thread::run() {
+  for (;;) {
+    RDB_MUTEX_LOCK_CHECK(m_signal_mutex);
+    if (m_killed) {
+      RDB_MUTEX_UNLOCK_CHECK(m_signal_mutex);
+      break;
+    }
+
+    // add_request() signals under m_signal_mutex, so it cannot be missed
+    RDB_MUTEX_LOCK_CHECK(m_req_mutex);
+    const bool empty = m_requests.empty();
+    RDB_MUTEX_UNLOCK_CHECK(m_req_mutex);
+    if (empty) {
+      mysql_cond_wait(&m_signal_cond, &m_signal_mutex);
+    }
+    const bool killed = m_killed;
+    RDB_MUTEX_UNLOCK_CHECK(m_signal_mutex);
+    if (killed) break;
+
+    RDB_MUTEX_LOCK_CHECK(m_req_mutex);
+    if (m_requests.empty()) {
+      RDB_MUTEX_UNLOCK_CHECK(m_req_mutex);
+      continue;
+    }
+    // the front request is only removed here, so it can be read unlocked
+    Rdb_partial_index_request &req = m_requests.front();
+    req.running = true;
+    RDB_MUTEX_UNLOCK_CHECK(m_req_mutex);
+
+    const bool materialized = materialize(req);
+    const ulonglong num_rows = req.num_rows;
+
+    RDB_MUTEX_LOCK_CHECK(m_req_mutex);
+    m_prefixes.erase(req.prefix);
+    m_requests.pop_front();
+    RDB_MUTEX_UNLOCK_CHECK(m_req_mutex);
+
+    if (materialized) wait_for_rate(num_rows);
+  }
+
+  clear_all_requests();
+}
+
+/*
+  Whether the rows of the group in the primary key are still the ones the
+  reader of the request saw.
+*/
+static bool rdb_partial_index_group_unchanged(
+    const Rdb_key_def &pkd, const Rdb_partial_index_request &req) {
+  uchar index_buf[INDEX_NUMBER_SIZE];
+  uint size;
+  pkd.get_infimum_key(index_buf, &size);
+  std::string pk_prefix(req.prefix);
+  pk_prefix.replace(0, size, reinterpret_cast<const char *>(index_buf), size);
+
+  std::unordered_map<std::string_view, std::string_view> rows;
+  for (const auto &row : req.pk_rows) {
+    rows.emplace(row.first, row.second);
+  }
+
+  rocksdb::ReadOptions read_opts;
+  read_opts.total_order_seek = true;
+  std::unique_ptr<rocksdb::Iterator> it(
+      rdb->NewIterator(read_opts, &pkd.get_cf()));
+  const rocksdb::Slice prefix(pk_prefix);
+  size_t num_rows = 0;
+  for (rocksdb_smart_seek(pkd.m_is_reverse_cf, *it, prefix);
+       it->Valid() && it->key().starts_with(prefix);
+       rocksdb_smart_next(pkd.m_is_reverse_cf, *it)) {
+    const auto row =
+        rows.find(std::string_view(it->key().data(), it->key().size()));
+    if (row == rows.end() ||
+        row->second !=
+            std::string_view(it->value().data(), it->value().size())) {
+      return false;
+    }
+    num_rows++;
+  }
+  return it->status().ok() && num_rows == rows.size();
+}
+
+/*
+  Write the rows the reader saw into the partial index, if the group has not
+  changed since. The exclusive lock on the sentinel waits for the writers
+  into the group, which skip the index while it is not materialized, and
+  holds off new ones until it is.
+
+  @return true if the group is materialized
+*/
+bool Rdb_partial_index_thread::materialize(
+    const Rdb_partial_index_request &req) {
+  const auto kd = ddl_manager.safe_find(req.sk_id);
+  const auto pkd = ddl_manager.safe_find(req.pk_id);
+  if (kd == nullptr || pkd == nullptr) {
+    // The index was dropped since.
+    return false;
+  }
+
+  rocksdb::WriteOptions write_opts;
+  write_opts.sync = false;
+  std::unique_ptr<rocksdb::Transaction> tx(
+      rdb->BeginTransaction(write_opts, rocksdb::TransactionOptions()));
+
+  const rocksdb::Slice sentinel(req.prefix);
+  std::string value;
+  rocksdb::Status s = tx->GetForUpdate(rocksdb::ReadOptions(), &kd->get_cf(),
+                                       sentinel, &value, true /* exclusive */);
+  bool materialized = s.ok();
+
+  if (s.IsNotFound() && rdb_partial_index_group_unchanged(*pkd, req)) {
+    rocksdb::WriteBatch wb;
+    s = wb.Put(&kd->get_cf(), sentinel, rocksdb::Slice());
+    for (auto row = req.sk_rows.begin(); s.ok() && row != req.sk_rows.end();
+         row++) {
+      s = wb.Put(&kd->get_cf(), row->first, row->second);
+    }
+
+    rocksdb::TransactionDBWriteOptimizations optimize;
+    optimize.skip_concurrency_control = true;
+    if (s.ok()) s = rdb->Write(write_opts, optimize, &wb);
+
+    if (s.ok()) {
+      materialized = true;
+      rocksdb_partial_index_groups_materialized++;
+      rocksdb_partial_index_rows_materialized += req.sk_rows.size();
+    } else {
+      // NO_LINT_DEBUG
+      LogPluginErrMsg(WARNING_LEVEL, ER_LOG_PRINTF_MSG,
+                      "RocksDB: Failed to materialize a group of %s.%s.%s: %s",
+                      req.db_name.c_str(), req.table_name.c_str(),
+                      req.index_name.c_str(), s.ToString().c_str());
+    }
+  } else if (!materialized) {
+    // The group changed or the lock timed out, a later reader queues it again.
+    rocksdb_partial_index_groups_stale++;
+  }
+
+  // Releases the lock on the sentinel.
+  tx->Rollback();
+  return materialized;
+}
+
+void Rdb_partial_index_thread::wait_for_rate(ulonglong num_rows) {
+  const ulong rate = rocksdb_partial_index_materialize_rate;
+  if (rate == 0) return;
+
+  timespec ts;
+  set_timespec_nsec(&ts, num_rows * 1000000000ULL / rate);
+
+  RDB_MUTEX_LOCK_CHECK(m_signal_mutex);
+  // New requests signal the thread too, wait the whole time out.
+  while (!m_killed) {
+    if (mysql_cond_timedwait(&m_signal_cond, &m_signal_mutex, &ts) != 0) break;
+  }
+  RDB_MUTEX_UNLOCK_CHECK(m_signal_mutex);
+}
+
+bool Rdb_partial_index_thread::add_request(Rdb_partial_index_request &&req) {
+  RDB_MUTEX_LOCK_CHECK(m_req_mutex);
+
+  /* Quit if already in the queue, or if the queue is full */
+  if (m_requests.size() >= MAX_REQUESTS ||
+      !m_prefixes.insert(req.prefix).second) {
+    RDB_MUTEX_UNLOCK_CHECK(m_req_mutex);
+    return false;
+  }
+
+  req.queued_time = time(nullptr);
+  req.running = false;
+  m_requests.push_back(std::move(req));
+  RDB_MUTEX_UNLOCK_CHECK(m_req_mutex);
+  signal();
+  return true;
+}
+
+std::vector<Rdb_partial_index_request> Rdb_partial_index_thread::get_requests()
+    const {
+  std::vector<Rdb_partial_index_request> requests;
+  RDB_MUTEX_LOCK_CHECK(m_req_mutex);
+  for (const auto &req : m_requests) {
+    Rdb_partial_index_request info;
+    info.sk_id = req.sk_id;
+    info.pk_id = req.pk_id;
+    info.db_name = req.db_name;
+    info.table_name = req.table_name;
+    info.index_name = req.index_name;
+    info.prefix = req.prefix;
+    info.num_rows = req.num_rows;
+    info.queued_time = req.queued_time;
+    info.running = req.running;
+    requests.push_back(std::move(info));
+  }
+  RDB_MUTEX_UNLOCK_CHECK(m_req_mutex);
+  return requests;
+}
+
+void Rdb_partial_index_thread::clear_all_requests() {
+  RDB_MUTEX_LOCK_CHECK(m_req_mutex);
+  auto req = m_requests.begin();
+  // Leave the one being materialized to the thread.
+  if (req != m_requests.end() && req->running) req++;
+  while (req != m_requests.end()) {
+    m_prefixes.erase(req->prefix);
+    req = m_requests.erase(req);
+  }
+  RDB_MUTEX_UNLOCK_CHECK(m_req_mutex);
+}
+
 /*
   A background thread to handle manual compactions,
   except for dropping indexes/tables. Every second, it checks
@@ -19434,6 +23260,8 @@ rocksdb::TransactionDB *rdb_get_rocksdb_db() { return rdb; }
 
 Rdb_cf_manager &rdb_get_cf_manager() { return cf_manager; }
 
+Rdb_io_latency_fs *rdb_get_io_latency_fs() { return io_latency_fs.get(); }
+
 const rocksdb::BlockBasedTableOptions &rdb_get_table_options() {
   return *rocksdb_tbl_options;
 }
@@ -19442,6 +23270,9 @@ bool rdb_is_table_scan_index_stats_calculation_enabled() {
   return rocksdb_table_stats_use_table_scan;
 }
 bool rdb_is_ttl_enabled() { return rocksdb_enable_ttl; }
+uint64_t rdb_get_vector_list_partition_size() {
+  return rocksdb_vector_list_partition_size;
+}
 static bool rdb_is_ttl_read_filtering_enabled() {
   return rocksdb_enable_ttl_read_filtering;
 }
@@ -19552,6 +23383,8 @@ Rdb_ddl_manager *rdb_get_ddl_manager(void) { return &ddl_manager; }
 
 Rdb_binlog_manager *rdb_get_binlog_manager(void) { return &binlog_manager; }
 
+Rdb_exec_time &rdb_get_startup_timeline() { return st_rdb_exec_time; }
+
 static void rocksdb_set_compaction_options(
     my_core::THD *const thd MY_ATTRIBUTE((__unused__)),
     my_core::SYS_VAR *const var MY_ATTRIBUTE((__unused__)), void *const var_ptr,
@@ -20310,6 +24143,22 @@ static void rocksdb_max_compaction_history_update(
   compaction_stats.resize_history(val);
 }
 
+static void rocksdb_vector_value_cache_size_update(
+    my_core::THD *const /* unused */, my_core::SYS_VAR *const /* unused */,
+    void *const var_ptr, const void *const save) {
+  uint64_t val = *static_cast<uint64_t *>(var_ptr) =
+      *static_cast<const uint64_t *>(save);
+  rdb_get_vector_value_cache().set_capacity(val);
+}
+
+static void rocksdb_vector_list_cache_size_update(
+    my_core::THD *const /* unused */, my_core::SYS_VAR *const /* unused */,
+    void *const var_ptr, const void *const save) {
+  uint64_t val = *static_cast<uint64_t *>(var_ptr) =
+      *static_cast<const uint64_t *>(save);
+  rdb_get_vector_list_cache().set_capacity(val);
+}
+
 void Rdb_compaction_stats::resize_history(size_t max_history_len) {
   std::lock_guard<std::mutex> guard(m_mutex);
   m_max_history_len = max_history_len;
@@ -20379,6 +24228,188 @@ void Rdb_compaction_stats::record_end(rocksdb::CompactionJobInfo info) {
   m_history.emplace_back(std::move(record));
 }
 
+void Rdb_cf_write_throttle::set_condition(
+    const std::string &cf_name, rocksdb::WriteStallCondition condition) {
+  std::lock_guard<std::mutex> guard(m_mutex);
+  auto &record = m_cfs[cf_name];
+  record.cf_name = cf_name;
+  const bool was_stalled =
+      record.condition != rocksdb::WriteStallCondition::kNormal;
+  const bool is_stalled = condition != rocksdb::WriteStallCondition::kNormal;
+  if (!was_stalled && is_stalled) {
+    m_stalled_cfs++;
+    record.stall_events++;
+  } else if (was_stalled && !is_stalled) {
+    m_stalled_cfs--;
+  }
+  record.condition = condition;
+  record.since = time(nullptr);
+  m_cond.notify_all();
+}
+
+// the most stalled of the column families, nullptr if none is stalled
+Rdb_cf_write_throttle_record *Rdb_cf_write_throttle::find_stalled(
+    const std::vector<std::string> &cf_names) {
+  Rdb_cf_write_throttle_record *stalled = nullptr;
+  for (const auto &cf_name : cf_names) {
+    const auto it = m_cfs.find(cf_name);
+    if (it == m_cfs.end() ||
+        it->second.condition == rocksdb::WriteStallCondition::kNormal) {
+      continue;
+    }
+    if (stalled == nullptr ||
+        it->second.condition == rocksdb::WriteStallCondition::kStopped) {
+      stalled = &it->second;
+    }
+  }
+  return stalled;
+}
+
+/*
+  The priority of the resource group of the session, 0 for the default
+  groups, below 0 for groups running ahead of them.
+*/
+static int rdb_resource_group_priority(THD *const thd) {
+  const resourcegroups::Resource_group *const group =
+      thd->resource_group_ctx()->m_cur_resource_group;
+  return group == nullptr ? 0 : group->controller()->priority();
+}
+
+int Rdb_cf_write_throttle::admit(THD *const thd,
+                                 const std::vector<std::string> &cf_names,
+                                 uint delay_us, uint max_wait_ms) {
+  const int priority = rdb_resource_group_priority(thd);
+  std::unique_lock<std::mutex> lock(m_mutex);
+  Rdb_cf_write_throttle_record *stalled = find_stalled(cf_names);
+  if (stalled == nullptr || priority < 0) {
+    return HA_EXIT_SUCCESS;
+  }
+
+  if (stalled->condition == rocksdb::WriteStallCondition::kDelayed) {
+    if (delay_us > 0) {
+      stalled->delayed_writes++;
+      m_cond.wait_for(lock, std::chrono::microseconds(delay_us));
+    }
+    return HA_EXIT_SUCCESS;
+  }
+
+  if (priority > 0) {
+    stalled->shed_writes++;
+    return HA_ERR_ROCKSDB_STATUS_BUSY;
+  }
+
+  // wait for the stop to clear, checking for kills now and then
+  stalled->delayed_writes++;
+  const auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(max_wait_ms);
+  while (!thd->killed) {
+    stalled = find_stalled(cf_names);
+    const auto now = std::chrono::steady_clock::now();
+    if (stalled == nullptr ||
+        stalled->condition != rocksdb::WriteStallCondition::kStopped ||
+        now >= deadline) {
+      break;
+    }
+    m_cond.wait_until(lock,
+                      std::min(deadline, now + std::chrono::milliseconds(100)));
+  }
+  return HA_EXIT_SUCCESS;
+}
+
+std::vector<Rdb_cf_write_throttle_record> Rdb_cf_write_throttle::get_records() {
+  std::lock_guard<std::mutex> guard(m_mutex);
+  std::vector<Rdb_cf_write_throttle_record> res;
+  res.reserve(m_cfs.size());
+  for (const auto &cf : m_cfs) {
+    res.push_back(cf.second);
+  }
+  return res;
+}
+
+uint Rdb_key_access_record::recommended_prefix_len(double share) const {
+  if (seeks == 0) return Rdb_key_def::INDEX_NUMBER_SIZE;
+
+  // seeks with an equal condition at least len long
+  uint64_t covered = 0;
+  for (uint len = MAX_EQ_COND_LEN; len > Rdb_key_def::INDEX_NUMBER_SIZE;
+       len--) {
+    covered += seek_eq_cond_lens[len];
+    if (covered >= share * seeks) return len;
+  }
+  return Rdb_key_def::INDEX_NUMBER_SIZE;
+}
+
+uint Rdb_key_access_record::recommended_bloom_bits(uint levels) const {
+  if (gets == 0) return 0;
+
+  // the filters a point read probes for a key they do not hold: every level
+  // for a miss, the levels above it, half of them on average, for a hit
+  const double misses = static_cast<double>(get_misses) / gets;
+  levels = std::max(levels, 1U);
+  const double negative_probes =
+      misses * levels + (1 - misses) * (levels - 1) / 2.0;
+  if (negative_probes <= 0.01) return 0;
+
+  // a bloom filter with the best number of probes has a false positive rate
+  // of about 0.6185^bits
+  const double bits = std::ceil(std::log(0.01 / negative_probes) /
+                                std::log(0.6185));
+  return std::min(static_cast<uint>(std::max(bits, 0.0)), 20U);
+}
+
+bool Rdb_key_access_sampler::sample(uint sample_rate) {
+  thread_local uint countdown = 0;
+  if (sample_rate == 0) return false;
+  if (countdown == 0 || countdown > sample_rate) countdown = sample_rate;
+  return --countdown == 0;
+}
+
+void Rdb_key_access_sampler::record_seek(const GL_INDEX_ID &gl_index_id,
+                                         size_t eq_cond_len) {
+  std::lock_guard<std::mutex> guard(m_mutex);
+  auto &record = m_records[gl_index_id];
+  record.gl_index_id = gl_index_id;
+  record.seeks++;
+  record.seek_eq_cond_lens[std::min<size_t>(
+      eq_cond_len, Rdb_key_access_record::MAX_EQ_COND_LEN)]++;
+}
+
+void Rdb_key_access_sampler::record_get(const GL_INDEX_ID &gl_index_id,
+                                        bool found) {
+  std::lock_guard<std::mutex> guard(m_mutex);
+  auto &record = m_records[gl_index_id];
+  record.gl_index_id = gl_index_id;
+  record.gets++;
+  if (!found) record.get_misses++;
+}
+
+std::vector<Rdb_key_access_record> Rdb_key_access_sampler::get_records() {
+  std::lock_guard<std::mutex> guard(m_mutex);
+  std::vector<Rdb_key_access_record> res;
+  res.reserve(m_records.size());
+  for (const auto &record : m_records) {
+    res.push_back(record.second);
+  }
+  return res;
+}
+
+void Rdb_key_access_sampler::clear() {
+  std::lock_guard<std::mutex> guard(m_mutex);
+  m_records.clear();
+}
+
+void rdb_sample_seek(const Rdb_key_def &kd, size_t eq_cond_len) {
+  if (Rdb_key_access_sampler::sample(rocksdb_key_access_sample_rate)) {
+    key_access_sampler.record_seek(kd.get_gl_index_id(), eq_cond_len);
+  }
+}
+
+void rdb_sample_get(const Rdb_key_def &kd, bool found) {
+  if (Rdb_key_access_sampler::sample(rocksdb_key_access_sample_rate)) {
+    key_access_sampler.record_get(kd.get_gl_index_id(), found);
+  }
+}
+
 select_bypass_policy_type get_select_bypass_policy() {
   return static_cast<select_bypass_policy_type>(rocksdb_select_bypass_policy);
 }
@@ -20422,6 +24453,12 @@ unsigned long long get_partial_index_sort_max_mem(THD *thd) {
   return THDVAR(thd, partial_index_sort_max_mem);
 }
 
+bool rdb_queue_partial_index_group(Rdb_partial_index_request &&req) {
+  if (!rdb_pi_thread.add_request(std::move(req))) return false;
+  rocksdb_partial_index_groups_queued++;
+  return true;
+}
+
 const rocksdb::ReadOptions &rdb_tx_acquire_snapshot(Rdb_transaction *tx) {
   tx->acquire_snapshot(true, TABLE_TYPE::USER_TABLE);
   return tx->m_read_opts[TABLE_TYPE::USER_TABLE];
@@ -20432,7 +24469,8 @@ std::unique_ptr<rocksdb::Iterator> rdb_tx_get_iterator(
     const rocksdb::Slice &eq_cond_lower_bound,
     const rocksdb::Slice &eq_cond_upper_bound,
     const rocksdb::Snapshot **snapshot, TABLE_TYPE table_type,
-    bool read_current, bool create_snapshot) {
+    bool read_current, bool create_snapshot, ha_rows scan_rows,
+    bool merge_batch) {
   if (commit_in_the_middle(thd)) {
     assert(snapshot && *snapshot == nullptr);
     if (snapshot) {
@@ -20450,7 +24488,29 @@ std::unique_ptr<rocksdb::Iterator> rdb_tx_get_iterator(
     Rdb_transaction *tx = get_tx_from_thd(thd);
     return tx->get_iterator(cf, skip_bloom_filter, eq_cond_lower_bound,
                             eq_cond_upper_bound, table_type, read_current,
-                            create_snapshot);
+                            create_snapshot, scan_rows, merge_batch);
+  }
+}
+
+bool rdb_tx_merges_batch(THD *thd, const Rdb_key_def &kd,
+                         TABLE_TYPE table_type) {
+  // rdb_tx_get_iterator reads the snapshot alone in the middle of a commit
+  if (commit_in_the_middle(thd)) return false;
+  if (!rocksdb_skip_unwritten_index_merge || table_type != USER_TABLE) {
+    return true;
+  }
+  return get_tx_from_thd(thd)->has_index_writes(kd, table_type);
+}
+
+bool rdb_tx_has_index_writes(THD *thd, const Rdb_key_def &kd) {
+  if (commit_in_the_middle(thd)) return true;
+  return get_tx_from_thd(thd)->has_index_writes(kd, USER_TABLE);
+}
+
+void rdb_tx_note_vector_list_write(Rdb_transaction *tx, Index_id index_id,
+                                   uint64 list_id) {
+  if (tx != nullptr) {
+    tx->log_vector_list_write(index_id, list_id);
   }
 }
 
@@ -20511,6 +24571,7 @@ std::unique_ptr<rocksdb::Iterator> rdb_tx_get_iterator_vector(
       read_opts.num_returns = k;
       read_opts.is_ivf_vector_index_scan = true;
       read_opts.async_io = true;
+      read_opts.pin_data = true;
       // TODO(mung): set based on WHERE conditions
       // read_opts.total_order_seek = true;
       read_opts.snapshot = *snapshot;
@@ -20825,10 +24886,22 @@ int ha_rocksdb::multi_range_read_init(RANGE_SEQ_IF *seq, void *seq_init_param,
   mrr_n_elements = 0;  // nothing to cleanup, yet.
   mrr_enabled_keyread = false;
   mrr_rowid_reader = nullptr;
+  mrr_free_next();
 
   mrr_funcs = *seq;
   mrr_buf = *buf;
 
+  // The rows of the next batch are read on another thread, which is only
+  // safe while the statement neither locks nor writes what it reads, and
+  // each half of the buffer must hold a batch
+  THD *const thd = table->in_use;
+  mrr_async = THDVAR(thd, mrr_async_io) && m_lock_rows == RDB_LOCK_NONE &&
+              thd->lex->sql_command == SQLCOM_SELECT &&
+              m_tbl_def->get_table_type() == USER_TABLE &&
+              (buf->buffer_end - buf->buffer) / 2 >=
+                  2 * mrr_get_length_per_rec();
+  mrr_half = 0;
+
   bool is_mrr_assoc = !(mode & HA_MRR_NO_ASSOCIATION);
   if (is_mrr_assoc) {
     ++table->in_use->status_var.ha_multi_range_read_init_count;
@@ -20913,11 +24986,87 @@ static void align_ptr(char **p) {
   Note that the buffer may be much larger than necessary. For range scans,
   @@rnd_buffer_size=256K is passed, even if there will be only a few lookup
   values.
+
+  With @@rocksdb_mrr_async_io, each half of the buffer holds the arrays of
+  one batch: the rows of the current batch are returned from one half while
+  the MultiGet of the next batch fills the other.
 */
 int ha_rocksdb::mrr_fill_buffer() {
   mrr_free_rows();
   mrr_read_index = 0;
 
+  Rdb_transaction *const tx =
+      get_or_create_tx(table->in_use, m_tbl_def->get_table_type());
+
+  uchar *const half =
+      mrr_buf.buffer + (mrr_buf.buffer_end - mrr_buf.buffer) / 2;
+  int err;
+  if (mrr_next_read.valid()) {
+    // The batch read ahead becomes the current one
+    mrr_next_read.get();
+    mrr_keys = mrr_next.keys;
+    mrr_statuses = mrr_next.statuses;
+    mrr_range_ptrs = mrr_next.range_ptrs;
+    mrr_values = mrr_next.values;
+    mrr_n_elements = mrr_next.n_elements;
+    mrr_next = Mrr_batch();
+    mrr_half ^= 1;
+  } else {
+    Mrr_batch batch;
+    err = mrr_async ? mrr_collect_batch(mrr_half ? half : mrr_buf.buffer,
+                                        mrr_half ? mrr_buf.buffer_end : half,
+                                        &batch)
+                    : mrr_collect_batch(mrr_buf.buffer, mrr_buf.buffer_end,
+                                        &batch);
+    mrr_keys = batch.keys;
+    mrr_statuses = batch.statuses;
+    mrr_range_ptrs = batch.range_ptrs;
+    mrr_values = batch.values;
+    mrr_n_elements = batch.n_elements;
+    if (err) {
+      return err;
+    }
+
+    /* TODO - row stats are gone in 8.0
+    if (active_index == table->s->primary_key) {
+      stats.rows_requested += mrr_n_elements;
+    }
+    */
+
+    mrr_read_batch(tx, batch, mrr_async);
+  }
+
+  if (!mrr_async || mrr_rowid_reader->eof()) {
+    return 0;
+  }
+
+  // Collect the next batch into the other half, and read it while the rows
+  // of this one are returned
+  err = mrr_collect_batch(mrr_half ? mrr_buf.buffer : half,
+                          mrr_half ? half : mrr_buf.buffer_end, &mrr_next);
+  if (err) {
+    return err == HA_ERR_END_OF_FILE ? 0 : err;
+  }
+  tx->acquire_snapshot(true, m_tbl_def->get_table_type());
+  const Mrr_batch next = mrr_next;
+  mrr_next_read = std::async(std::launch::async, [this, tx, next] {
+    mrr_read_batch(tx, next, true);
+  });
+  return 0;
+}
+
+/*
+  Lay out the arrays of a batch in [begin, end), and fill its keys with the
+  rowids from mrr_rowid_reader.
+
+  @return
+    0                    OK
+    HA_ERR_END_OF_FILE   No rowids left, the batch is empty
+    other                HA_ERR error code, the elements in the batch must
+                         still be freed
+*/
+int ha_rocksdb::mrr_collect_batch(uchar *begin, uchar *end,
+                                  Mrr_batch *batch) {
   // This should agree with the code in mrr_get_length_per_rec():
   ssize_t element_size = sizeof(rocksdb::Slice) + sizeof(rocksdb::Status) +
                          sizeof(rocksdb::PinnableSlice) +
@@ -20925,7 +25074,7 @@ int ha_rocksdb::mrr_fill_buffer() {
                          m_pk_descr->max_storage_fmt_length();
 
   // The buffer has space for this many elements:
-  ssize_t n_elements = (mrr_buf.buffer_end - mrr_buf.buffer) / element_size;
+  ssize_t n_elements = (end - begin) / element_size;
 
   THD *thd = table->in_use;
   ssize_t elements_limit = THDVAR(thd, mrr_batch_size);
@@ -20938,25 +25087,25 @@ int ha_rocksdb::mrr_fill_buffer() {
     return HA_ERR_INTERNAL_ERROR;
   }
 
-  char *buf = (char *)mrr_buf.buffer;
+  char *buf = (char *)begin;
 
   align_ptr<rocksdb::Slice>(&buf);
-  mrr_keys = (rocksdb::Slice *)buf;
+  batch->keys = (rocksdb::Slice *)buf;
   buf += sizeof(rocksdb::Slice) * n_elements;
 
   align_ptr<rocksdb::Status>(&buf);
-  mrr_statuses = (rocksdb::Status *)buf;
+  batch->statuses = (rocksdb::Status *)buf;
   buf += sizeof(rocksdb::Status) * n_elements;
 
   align_ptr<rocksdb::PinnableSlice>(&buf);
-  mrr_values = (rocksdb::PinnableSlice *)buf;
+  batch->values = (rocksdb::PinnableSlice *)buf;
   buf += sizeof(rocksdb::PinnableSlice) * n_elements;
 
   align_ptr<char *>(&buf);
-  mrr_range_ptrs = (char **)buf;
+  batch->range_ptrs = (char **)buf;
   buf += sizeof(char *) * n_elements;
 
-  if (buf + m_pk_descr->max_storage_fmt_length() > (char *)mrr_buf.buffer_end) {
+  if (buf + m_pk_descr->max_storage_fmt_length() > (char *)end) {
     // a VERY unlikely scenario:  we were given a really small buffer,
     // (probably for just one rowid), and also we had to use some bytes for
     // alignment. As a result, there's no buffer space left to hold even one
@@ -20967,7 +25116,7 @@ int ha_rocksdb::mrr_fill_buffer() {
 
   ssize_t elem = 0;
 
-  mrr_n_elements = elem;
+  batch->n_elements = elem;
   int key_size;
   char *range_ptr;
   int err;
@@ -20980,17 +25129,17 @@ int ha_rocksdb::mrr_fill_buffer() {
 
     table->in_use->check_yield();
 
-    new (&mrr_keys[elem]) rocksdb::Slice(buf, key_size);
-    new (&mrr_statuses[elem]) rocksdb::Status;
-    new (&mrr_values[elem]) rocksdb::PinnableSlice;
-    mrr_range_ptrs[elem] = range_ptr;
+    new (&batch->keys[elem]) rocksdb::Slice(buf, key_size);
+    new (&batch->statuses[elem]) rocksdb::Status;
+    new (&batch->values[elem]) rocksdb::PinnableSlice;
+    batch->range_ptrs[elem] = range_ptr;
     buf += key_size;
 
     elem++;
-    mrr_n_elements = elem;
+    batch->n_elements = elem;
 
-    if ((elem == n_elements) || (buf + m_pk_descr->max_storage_fmt_length() >=
-                                 (char *)mrr_buf.buffer_end)) {
+    if ((elem == n_elements) ||
+        (buf + m_pk_descr->max_storage_fmt_length() >= (char *)end)) {
       // No more buffer space
       break;
     }
@@ -21000,36 +25149,47 @@ int ha_rocksdb::mrr_fill_buffer() {
     return err;
   }
 
-  if (mrr_n_elements == 0) {
+  if (batch->n_elements == 0) {
     return HA_ERR_END_OF_FILE;  // nothing to scan
   }
 
-  Rdb_transaction *const tx =
-      get_or_create_tx(table->in_use, m_tbl_def->get_table_type());
-
-  /* TODO - row stats are gone in 8.0
-  if (active_index == table->s->primary_key) {
-    stats.rows_requested += mrr_n_elements;
-  }
-  */
-
-  tx->multi_get(m_pk_descr->get_cf(), mrr_n_elements, mrr_keys, mrr_values,
-                m_tbl_def->get_table_type(), mrr_statuses, mrr_sorted_mode);
-
   return 0;
 }
 
+/*
+  Read the rows of a batch with one MultiGet. With async_io this may run
+  on another thread than the one of the query, see rocksdb_mrr_async_io.
+*/
+void ha_rocksdb::mrr_read_batch(Rdb_transaction *tx, const Mrr_batch &batch,
+                                bool async_io) {
+  tx->multi_get(m_pk_descr->get_cf(), batch.n_elements, batch.keys,
+                batch.values, m_tbl_def->get_table_type(), batch.statuses,
+                mrr_sorted_mode, async_io);
+}
+
 void ha_rocksdb::mrr_free() {
   // Free everything
   if (mrr_enabled_keyread) {
     m_keyread_only = false;
     mrr_enabled_keyread = false;
   }
+  mrr_free_next();
   mrr_free_rows();
   delete mrr_rowid_reader;
   mrr_rowid_reader = nullptr;
 }
 
+void ha_rocksdb::mrr_free_next() {
+  if (mrr_next_read.valid()) {
+    mrr_next_read.get();
+  }
+  for (ssize_t i = 0; i < mrr_next.n_elements; i++) {
+    mrr_next.values[i].~PinnableSlice();
+    mrr_next.statuses[i].~Status();
+  }
+  mrr_next = Mrr_batch();
+}
+
 void ha_rocksdb::mrr_free_rows() {
   for (ssize_t i = 0; i < mrr_n_elements; i++) {
     mrr_values[i].~PinnableSlice();
@@ -21071,7 +25231,8 @@ int ha_rocksdb::multi_range_read_next(char **range_info) {
       table->in_use->check_yield();
 
       if (mrr_read_index >= mrr_n_elements) {
-        if (mrr_rowid_reader->eof() || mrr_n_elements == 0) {
+        if ((mrr_rowid_reader->eof() && !mrr_next_read.valid()) ||
+            mrr_n_elements == 0) {
           table->m_status = STATUS_NOT_FOUND;  // not sure if this is necessary?
           mrr_free_rows();
           return HA_ERR_END_OF_FILE;
@@ -21176,13 +25337,20 @@ bool ha_rocksdb::get_se_private_data(dd::Table *dd_table, bool reset) {
      3. check if this FUNC ITEM is a vector DB func
         a. check the order direction is NOT DESC for L2, either ASC or
         unspecified is ok.
-        b. check the order direction is DESC for IP
+        b. check the order direction is DESC for IP, COSINE and MAXSIM
      4. check if the first arg is a FIELD_ITEM with data_type
   MYSQL_TYPE_JSON/MYSQL_TYPE_BLOB
      5. check if the FIELD_ITEM is assocaited with a vector index
+        a. an index with normalized vectors only serves COSINE, and COSINE
+        needs normalized vectors unless the index scores raw vectors
+        (LSMIDX, GRAPH)
+        b. a multi-vector index only serves MAXSIM, which needs one
+        c. a sparse index only serves IP
      6. check if the second arg is:
         a. Item::STRING_ITEM with data_type mapping to MYSQL_TYPE_VARCHAR
         b. Item::CACHE_ITEM with data_type mapping to MYSQL_TYPE_JSON
+        c. a reference to the outer query only, holding a json, string or
+        blob vector
  */
 bool ha_rocksdb::index_supports_vector_scan(ORDER *order, int idx) {
   if (idx >= (int)table->s->keys) return false;
@@ -21194,28 +25362,31 @@ bool ha_rocksdb::index_supports_vector_scan(ORDER *order, int idx) {
       ((Item *)*(order->item))->type() != Item::FUNC_ITEM)  // 2.
     return false;
 
-  Item_func *item_func = (Item_func *)*(order->item);
+  Fb_hybrid_score score;
+  if (fb_parse_hybrid_score(order, &score)) return false;
+  Item_func *item_func = score.m_vector_distance;
 
-  if ((strcmp(item_func->func_name(), "+") == 0) && (((Item_func *)item_func)->argument_count() == 2)) {
-    Item *arg0 = (Item *)item_func->arguments()[0];
-    Item *real_arg0 = arg0->real_item();
-    if (real_arg0->type() == Item::FUNC_ITEM) {
-      item_func = (Item_func *)real_arg0;
-    } else {
-      return false;
-    }
-  }
+  // the matches of a fulltext term come from a FULLTEXT index of this table
+  const Item_func_match *match = score.m_text_relevance;
+  if (match != nullptr &&
+      (match->table_ref == nullptr || match->table_ref->table != table ||
+       match->key >= table->s->keys ||
+       !(table->key_info[match->key].flags & HA_FULLTEXT)))
+    return false;
 
-  if ((item_func->functype() != Item_func::FB_VECTOR_L2) &&
-      (item_func->functype() != Item_func::FB_VECTOR_IP))  // 3.
+  const auto functype = item_func->functype();
+  if ((functype != Item_func::FB_VECTOR_L2) &&
+      (functype != Item_func::FB_VECTOR_IP) &&
+      (functype != Item_func::FB_VECTOR_COSINE) &&
+      (functype != Item_func::FB_VECTOR_MAXSIM))  // 3.
     return false;
 
   const auto order_direction = order->direction;
-  if (item_func->functype() == Item_func::FB_VECTOR_L2 &&
+  if (functype == Item_func::FB_VECTOR_L2 &&
       order_direction == ORDER_DESC) {  // 3.a
     return false;
   }
-  if (item_func->functype() == Item_func::FB_VECTOR_IP &&
+  if (functype != Item_func::FB_VECTOR_L2 &&
       order_direction != ORDER_DESC) {  // 3.b
     return false;
   }
@@ -21252,12 +25423,125 @@ bool ha_rocksdb::index_supports_vector_scan(ORDER *order, int idx) {
 
   if (fld_index < 0) return false;
 
+  const auto &vector_config = table->key_info[fld_index].fb_vector_index_config;
+  if (vector_config.normalized() != (functype == Item_func::FB_VECTOR_COSINE) &&
+      (vector_config.normalized() ||
+       (vector_config.type() != FB_VECTOR_INDEX_TYPE::LSMIDX &&
+        vector_config.type() != FB_VECTOR_INDEX_TYPE::GRAPH)))  // 5a.
+    return false;
+  if (vector_config.multi() != (functype == Item_func::FB_VECTOR_MAXSIM))
+    return false;  // 5b.
+  if (vector_config.sparse() && functype != Item_func::FB_VECTOR_IP)
+    return false;  // 5c.
+
   if (((arg1->type() == Item::STRING_ITEM) &&
        (arg1->data_type() == MYSQL_TYPE_VARCHAR)) ||  // 6a.
       ((arg1->type() == Item::CACHE_ITEM) &&
        (arg1->data_type() == MYSQL_TYPE_JSON)))  // 6b.
     return true;
 
+  if (arg1->used_tables() == OUTER_REF_TABLE_BIT &&
+      (arg1->data_type() == MYSQL_TYPE_JSON ||
+       arg1->data_type() == MYSQL_TYPE_VARCHAR ||
+       (arg1->data_type() == MYSQL_TYPE_BLOB &&
+        arg1->type() == Item::FIELD_ITEM)))  // 6c.
+    return true;
+
+  return false;
+}
+
+/*
+  Given an ORDER, a TABLE and optionally an index id, check whether this ORDER
+  clause can be served by a nearest neighbour scan of a spatial index.
+
+  The following checks are needed:
+     1. check if chosen index is a next spatial index, unless an index has
+        not been provided (i.e., a value of < 0)
+     2. check if ORDER is a single ascending ST_DISTANCE
+     3. check if the first arg is a FIELD_ITEM covered by a next spatial
+        index
+     4. check if the second arg is a constant geographic point
+*/
+bool ha_rocksdb::index_supports_spatial_knn_scan(ORDER *order, int idx) {
+  if (idx >= (int)table->s->keys) return false;
+
+  if ((idx >= 0) && !table->key_info[idx].is_next_spatial_index())  // 1.
+    return false;
+
+  if (!order || !order->item || order->next ||
+      order->direction == ORDER_DESC ||
+      ((Item *)*(order->item))->type() != Item::FUNC_ITEM)  // 2.
+    return false;
+
+  Item_func *item_func = down_cast<Item_func *>(*order->item);
+  if (strcmp(item_func->func_name(), "st_distance") != 0 ||
+      item_func->argument_count() != 2)  // 2.
+    return false;
+
+  Item *arg0 = item_func->arguments()[0];
+  Item *arg1 = item_func->arguments()[1];
+  if (arg0->type() != Item::FIELD_ITEM) return false;  // 3.
+
+  Field *field = down_cast<Item_field *>(arg0)->field;
+  bool covered = false;
+  for (uint key_idx = 0; key_idx < table->s->keys && !covered; ++key_idx) {
+    if ((idx < 0 || key_idx == (uint)idx) &&
+        table->key_info[key_idx].is_next_spatial_index() &&
+        table->key_info[key_idx].key_part[0].field == field) {  // 3.
+      covered = true;
+    }
+  }
+  if (!covered) return false;
+
+  if (!arg1->const_item()) return false;  // 4.
+  String buffer;
+  const String *point = arg1->val_str(&buffer);
+  double lon;
+  double lat;
+  return point != nullptr &&
+         rdb_spatial_parse_point(point->ptr(), point->length(), &lon,
+                                 &lat);  // 4.
+}
+
+/**
+  costs a knn scan as comparing the query against the stored codes the index
+  expects to visit, reading those codes, and fetching each returned row
+*/
+bool ha_rocksdb::vector_index_scan_cost(uint keyno, ha_rows rows,
+                                        Cost_estimate *cost) {
+  if (keyno >= table->s->keys || !table->key_info[keyno].is_fb_vector_index())
+    return true;
+
+  const Rdb_key_def &kd = *m_key_descr_arr[keyno];
+  Rdb_vector_index *const vector_index = kd.get_vector_index();
+  if (vector_index == nullptr) return true;
+
+  const THD *const thd = ha_thd();
+  const ha_rows table_rows = std::max<ha_rows>(stats.records, 1);
+  const ha_rows k = std::min(rows, table_rows);
+  uint64_t candidates = vector_index->search_candidates(
+      k, thd->variables.fb_vector_search_nprobe,
+      thd->variables.fb_vector_search_target_candidates);
+  if (candidates == 0) {
+    // no index statistics yet, assume the whole index is scanned
+    candidates = table_rows;
+  }
+  candidates = std::max<uint64_t>(candidates, k);
+
+  std::size_t code_size = vector_index->dump_info().m_code_size;
+  if (code_size == 0) {
+    code_size = vector_index->dimension() * sizeof(float);
+  }
+  const double code_pages =
+      std::ceil(static_cast<double>(candidates) * code_size / IO_SIZE);
+
+  cost->reset();
+  cost->add_cpu(table->cost_model()->row_evaluate_cost(candidates));
+  cost->add_io(page_read_cost(keyno, code_pages));
+  // lsm vector index entries carry the whole row
+  if (kd.get_vector_index_config().type() != FB_VECTOR_INDEX_TYPE::LSMIDX) {
+    cost->add_io(page_read_cost(table->s->primary_key, k));
+  }
   return false;
 }
 
@@ -21290,13 +25574,22 @@ mysql_declare_plugin(rocksdb_se){
 },
     myrocks::rdb_i_s_cfstats, myrocks::rdb_i_s_dbstats,
     myrocks::rdb_i_s_perf_context, myrocks::rdb_i_s_perf_context_global,
-    myrocks::rdb_i_s_cfoptions, myrocks::rdb_i_s_compact_stats,
-    myrocks::rdb_i_s_active_compact_stats, myrocks::rdb_i_s_compact_history,
+    myrocks::rdb_i_s_perf_context_samples, myrocks::rdb_i_s_cfoptions,
+    myrocks::rdb_i_s_compact_stats, myrocks::rdb_i_s_active_compact_stats,
+    myrocks::rdb_i_s_compact_history,
     myrocks::rdb_i_s_global_info, myrocks::rdb_i_s_ddl,
     myrocks::rdb_i_s_sst_props, myrocks::rdb_i_s_index_file_map,
     myrocks::rdb_i_s_lock_info, myrocks::rdb_i_s_trx_info,
     myrocks::rdb_i_s_deadlock_info,
+    myrocks::rdb_i_s_partial_index_queue,
+    myrocks::rdb_i_s_startup_timeline,
+    myrocks::rdb_i_s_cf_write_throttle,
+    myrocks::rdb_i_s_key_access_recommendations,
+    myrocks::rdb_i_s_io_latency,
+    myrocks::rdb_i_s_slow_io,
     myrocks::rdb_i_s_bypass_rejected_query_history,
     myrocks::rdb_i_s_live_files_metadata,
     myrocks::rdb_i_s_vector_index_config,
+    myrocks::rdb_i_s_vector_index_stats,
+    myrocks::rdb_i_s_vector_index_lists,
     myrocks::rdb_i_s_next_spatial_index_config mysql_declare_plugin_end;
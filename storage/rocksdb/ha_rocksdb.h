@@ -20,7 +20,11 @@
 #endif
 
 /* C++ standard header files */
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <deque>
+#include <future>
 #include <map>
 #include <memory>
 #include <string>
@@ -39,6 +43,7 @@
 
 /* RocksDB header files */
 #include "rocksdb/merge_operator.h"
+#include "rocksdb/types.h"
 #include "rocksdb/utilities/write_batch_with_index.h"
 
 /* MyRocks header files */
@@ -73,6 +78,7 @@ class Rdb_writebatch_impl;
 class Rdb_field_encoder;
 class Rdb_vector_db_handler;
 class Rdb_next_spatial_db_handler;
+class Rdb_parallel_scan;
 
 #if defined(HAVE_PSI_INTERFACE)
 extern PSI_rwlock_key key_rwlock_read_free_rpl_tables;
@@ -276,6 +282,33 @@ class ha_rocksdb : public my_core::handler, public blob_buffer {
   */
   rocksdb::PinnableSlice m_retrieved_record;
 
+  /*
+    Rows of the candidates a vector or next spatial index search holds past
+    the current one, read with one MultiGet by candidate_index_read.
+    m_candidate_pks[i] is the rowid of m_candidate_rows[i], whose read
+    returned m_candidate_rcs[i].
+  */
+  std::vector<std::string> m_candidate_pks;
+  std::vector<rocksdb::PinnableSlice> m_candidate_rows;
+  std::vector<int> m_candidate_rcs;
+  size_t m_candidate_next = 0;
+
+  /*
+    Rows of a bulk insert whose vector index entries are written together by
+    write_pending_vector_entries, so that their vectors are assigned to the
+    index in one batch. Only set between start_bulk_insert and
+    end_bulk_insert.
+  */
+  struct Rdb_pending_vector_entry {
+    uint m_keyno;
+    std::vector<float> m_vector;
+    std::string m_record;
+    std::string m_ttl_bytes;
+    longlong m_hidden_pk_id;
+  };
+  bool m_batch_vector_entries = false;
+  std::vector<Rdb_pending_vector_entry> m_pending_vector_entries;
+
   /*
     For INSERT ON DUPLICATE KEY UPDATE, we store the duplicate record during
     write_row here so that we don't have to re-read in the following
@@ -298,6 +331,26 @@ class ha_rocksdb : public my_core::handler, public blob_buffer {
 
   bool m_rnd_scan_started;
 
+  /* Whether rnd_init() started a full table scan */
+  bool m_rnd_scan = false;
+
+  /*
+    The runtime filter of the scan last checked by runtime_filter_on_pk(),
+    and whether it reads primary key columns alone.
+  */
+  const Runtime_filter *m_runtime_filter_checked = nullptr;
+  bool m_runtime_filter_on_pk = false;
+
+  /*
+    The next row of the record buffer rnd_next() returns, and the error that
+    ended the last fill of the buffer. The keys of the rows in the buffer
+    are concatenated in m_batch_keys, each ending at its m_batch_key_ends.
+  */
+  ha_rows m_batch_pos = 0;
+  int m_batch_rc = 0;
+  std::string m_batch_keys;
+  std::vector<size_t> m_batch_key_ends;
+
   bool m_full_key_lookup = false;
 
   /*
@@ -372,6 +425,30 @@ class ha_rocksdb : public my_core::handler, public blob_buffer {
                            std::string &record_value)
       MY_ATTRIBUTE((__warn_unused_result__));
 
+  int vector_index_rerank(const Rdb_key_def &kd, uchar *const buf)
+      MY_ATTRIBUTE((__warn_unused_result__));
+
+  int vector_index_fuse_text(const Rdb_key_def &kd)
+      MY_ATTRIBUTE((__warn_unused_result__));
+
+  void vector_index_pk_prefix(Item *pk_index_cond, std::string *prefix,
+                              ha_rows *rows);
+
+  int candidate_index_read(const Rdb_key_def &kd, uchar *const buf,
+                           const rocksdb::Slice *key,
+                           const rocksdb::Slice *value, bool *skip_row)
+      MY_ATTRIBUTE((__warn_unused_result__));
+  int candidate_row_read(const Rdb_key_def &kd, uchar *const buf,
+                         bool *skip_row, size_t batch_size = 0)
+      MY_ATTRIBUTE((__warn_unused_result__));
+  void fill_candidate_rows(const Rdb_key_def &kd, size_t n);
+  void free_candidate_rows();
+
+  std::unique_ptr<Rdb_parallel_scan> new_parallel_scan(const Rdb_key_def &kd,
+                                                       uint max_threads);
+  int parallel_records(const Rdb_key_def &kd, ha_rows *num_rows)
+      MY_ATTRIBUTE((__warn_unused_result__));
+
   rocksdb::Status get_for_update(Rdb_transaction *const tx,
                                  const Rdb_key_def &kd,
                                  const rocksdb::Slice &key) const;
@@ -519,7 +596,8 @@ class ha_rocksdb : public my_core::handler, public blob_buffer {
                 (rocksdb_column_default_value_as_expression
                      ? HA_SUPPORTS_DEFAULT_EXPRESSION
                      : 0) |
-                HA_ATTACHABLE_TRX_COMPATIBLE | HA_NO_READ_LOCAL_LOCK);
+                HA_ATTACHABLE_TRX_COMPATIBLE | HA_NO_READ_LOCAL_LOCK |
+                HA_CAN_FULLTEXT);
   }
 
   [[nodiscard]] enum row_type get_real_row_type(
@@ -548,6 +626,9 @@ class ha_rocksdb : public my_core::handler, public blob_buffer {
   */
   ulong index_flags(uint inx, uint part, bool all_parts) const override;
 
+  bool shared_index_entries(const uchar *const record,
+                            std::vector<std::string> *const images) override;
+
   bool primary_key_is_clustered() const override {
     DBUG_ENTER_FUNC();
 
@@ -764,11 +845,32 @@ class ha_rocksdb : public my_core::handler, public blob_buffer {
   ssize_t mrr_n_elements;  // Number of elements in the above arrays
   ssize_t mrr_read_index;  // Number of the element we will return next
 
+  // The arrays of one MultiGet, laid out in mrr_buf
+  struct Mrr_batch {
+    rocksdb::Slice *keys = nullptr;
+    rocksdb::Status *statuses = nullptr;
+    char **range_ptrs = nullptr;
+    rocksdb::PinnableSlice *values = nullptr;
+    ssize_t n_elements = 0;
+  };
+
+  // true <=> rocksdb_mrr_async_io: mrr_buf is split in two halves, and the
+  // MultiGet of the batch in one runs in mrr_next_read while the rows of
+  // the other are returned
+  bool mrr_async;
+  int mrr_half;  // half of mrr_buf the current batch is in
+  Mrr_batch mrr_next;
+  std::future<void> mrr_next_read;
+
   // if true, MRR code has enabled keyread (and should disable it back)
   bool mrr_enabled_keyread;
   bool mrr_used_cpk;
 
   int mrr_fill_buffer();
+  int mrr_collect_batch(uchar *begin, uchar *end, Mrr_batch *batch);
+  void mrr_read_batch(Rdb_transaction *tx, const Mrr_batch &batch,
+                      bool async_io);
+  void mrr_free_next();
   void mrr_free_rows();
   void mrr_free();
   uint mrr_get_length_per_rec();
@@ -858,9 +960,14 @@ class ha_rocksdb : public my_core::handler, public blob_buffer {
       MY_ATTRIBUTE((__warn_unused_result__));
   int index_read_intern(uchar *buf, bool first)
       MY_ATTRIBUTE((__nonnull__, __warn_unused_result__));
+  ha_rows expected_scan_rows(bool full_scan) const;
   int index_next_with_direction_intern(uchar *const buf, bool forward,
                                        bool skip_next)
       MY_ATTRIBUTE((__warn_unused_result__));
+  int rnd_next_intern(uchar *const buf)
+      MY_ATTRIBUTE((__warn_unused_result__));
+  int rnd_next_batched(uchar *const buf, Record_buffer *const record_buffer)
+      MY_ATTRIBUTE((__warn_unused_result__));
   Rdb_iterator_base *get_pk_iterator() MY_ATTRIBUTE((__warn_unused_result__));
 
   enum icp_result check_index_cond() const;
@@ -885,6 +992,8 @@ class ha_rocksdb : public my_core::handler, public blob_buffer {
                          const rocksdb::Slice *key,
                          struct unique_sk_buf_info *sk_info)
       MY_ATTRIBUTE((__nonnull__, __warn_unused_result__));
+  int bulk_load_start(Rdb_transaction *const tx, const Rdb_key_def &kd)
+      MY_ATTRIBUTE((__nonnull__, __warn_unused_result__));
   int bulk_load_key(Rdb_transaction *const tx, const Rdb_key_def &kd,
                     const rocksdb::Slice &key, const rocksdb::Slice &value,
                     bool sort)
@@ -902,9 +1011,30 @@ class ha_rocksdb : public my_core::handler, public blob_buffer {
                       const struct update_row_info &row_info,
                       const bool bulk_load_sk)
       MY_ATTRIBUTE((__warn_unused_result__));
+  int write_fulltext_sk(const TABLE *const table_arg, const Rdb_key_def &kd,
+                        Rdb_transaction *const tx, const uchar *old_data,
+                        const rocksdb::Slice &old_pk, const uchar *new_data,
+                        const rocksdb::Slice &new_pk)
+      MY_ATTRIBUTE((__warn_unused_result__));
+  int write_sparse_vector_sk(const TABLE *const table_arg,
+                             const Rdb_key_def &kd, Rdb_transaction *const tx,
+                             const uchar *old_data,
+                             const rocksdb::Slice &old_pk,
+                             const uchar *new_data,
+                             const rocksdb::Slice &new_pk)
+      MY_ATTRIBUTE((__warn_unused_result__));
+  int write_multi_vector_sk(const TABLE *const table_arg,
+                            const Rdb_key_def &kd, Rdb_transaction *const tx,
+                            const uchar *old_data,
+                            const rocksdb::Slice &old_pk,
+                            const uchar *new_data,
+                            const rocksdb::Slice &new_pk,
+                            const longlong hidden_pk_id)
+      MY_ATTRIBUTE((__warn_unused_result__));
   int update_write_indexes(const struct update_row_info &row_info,
                            const bool pk_changed)
       MY_ATTRIBUTE((__warn_unused_result__));
+  int write_pending_vector_entries() MY_ATTRIBUTE((__warn_unused_result__));
 
   Rdb_tbl_def *get_table_if_exists(const char *const tablename)
       MY_ATTRIBUTE((__nonnull__, __warn_unused_result__));
@@ -917,6 +1047,14 @@ class ha_rocksdb : public my_core::handler, public blob_buffer {
       TABLE *const table_arg,
       const std::unordered_set<std::shared_ptr<Rdb_key_def>> &indexes)
       MY_ATTRIBUTE((__nonnull__, __warn_unused_result__));
+  int inplace_populate_vector_sk(TABLE *const new_table_arg,
+                                 Rdb_transaction *const tx,
+                                 const Rdb_key_def &index)
+      MY_ATTRIBUTE((__nonnull__, __warn_unused_result__));
+  int inplace_populate_sk_parallel(TABLE *const new_table_arg,
+                                   Rdb_transaction *const tx,
+                                   const Rdb_key_def &index)
+      MY_ATTRIBUTE((__nonnull__, __warn_unused_result__));
 
   int finalize_bulk_load(bool print_client_error = true)
       MY_ATTRIBUTE((__warn_unused_result__));
@@ -935,16 +1073,29 @@ class ha_rocksdb : public my_core::handler, public blob_buffer {
   Rdb_vector_db_handler *get_vector_db_handler();
   Rdb_next_spatial_db_handler *get_next_spatial_db_handler();
 
+  FT_INFO *fulltext_search_init(uint flags, uint inx, const String *key,
+                                ha_rows limit);
+
  public:
   void set_pk_can_be_decoded(bool flag) { m_pk_can_be_decoded = flag; }
   int index_init(uint idx, bool sorted) override
       MY_ATTRIBUTE((__warn_unused_result__));
   int index_end() override MY_ATTRIBUTE((__warn_unused_result__));
   int vector_index_init(Item *distance_func) override;
+  int vector_index_prefetch(
+      uint keyno, std::vector<std::vector<float>> *query_vectors) override;
   int next_spatial_index_init(Item *distance_func);
+  void next_spatial_cond_push(uint keyno, Item *cond) override;
   void vector_index_end();
   void next_spatial_index_end();
 
+  /* MATCH ... AGAINST on a FULLTEXT index, see rdb_fulltext.h */
+  FT_INFO *ft_init_ext(uint flags, uint inx, String *key) override;
+  FT_INFO *ft_init_ext_with_hints(uint inx, String *key,
+                                  Ft_hints *hints) override;
+  int ft_init() override;
+  int ft_read(uchar *const buf) override;
+
   void unlock_row() override;
 
   /** @brief
@@ -959,6 +1110,8 @@ class ha_rocksdb : public my_core::handler, public blob_buffer {
   int rnd_end() override MY_ATTRIBUTE((__warn_unused_result__));
   int rnd_next(uchar *const buf) override
       MY_ATTRIBUTE((__warn_unused_result__));
+  bool is_record_buffer_wanted(ha_rows *const max_rows) const override;
+  bool runtime_filter_on_pk(const Runtime_filter &filter);
 
   int rnd_pos(uchar *const buf, uchar *const pos) override
       MY_ATTRIBUTE((__warn_unused_result__));
@@ -991,6 +1144,9 @@ class ha_rocksdb : public my_core::handler, public blob_buffer {
 
   int reset() override;
 
+  void start_bulk_insert(ha_rows rows) override;
+  int end_bulk_insert() override MY_ATTRIBUTE((__warn_unused_result__));
+
   int check(THD *const thd, HA_CHECK_OPT *const check_opt) override
       MY_ATTRIBUTE((__warn_unused_result__));
   ha_rows records_in_range(uint inx, key_range *const min_key,
@@ -1082,6 +1238,12 @@ class ha_rocksdb : public my_core::handler, public blob_buffer {
   int records_from_index(ha_rows *num_rows, uint index) override;
 
  public:
+  int parallel_scan_init(void *&scan_ctx, size_t *num_threads,
+                         bool use_reserved_threads) override;
+  int parallel_scan(void *scan_ctx, void **thread_ctxs, Load_init_cbk init_fn,
+                    Load_cbk load_fn, Load_end_cbk end_fn) override;
+  void parallel_scan_end(void *scan_ctx) override;
+
   virtual void rpl_before_delete_rows() override;
   virtual void rpl_after_delete_rows() override;
   virtual void rpl_before_update_rows() override;
@@ -1101,9 +1263,13 @@ class ha_rocksdb : public my_core::handler, public blob_buffer {
 
  public:
   int check_disk_usage();
+  int check_cf_write_throttle();
   void record_disk_usage_change(longlong delta);
 
   bool index_supports_vector_scan(ORDER *order, int idx) override;
+  bool index_supports_spatial_knn_scan(ORDER *order, int idx) override;
+  bool vector_index_scan_cost(uint keyno, ha_rows rows,
+                              Cost_estimate *cost) override;
 };
 
 /*
@@ -1212,6 +1378,98 @@ class Rdb_compaction_stats {
 
 extern Rdb_compaction_stats compaction_stats;
 
+struct Rdb_cf_write_throttle_record {
+  std::string cf_name;
+  rocksdb::WriteStallCondition condition =
+      rocksdb::WriteStallCondition::kNormal;
+  // when the condition last changed
+  time_t since = 0;
+  // times the column family went from normal to delayed or stopped
+  uint64_t stall_events = 0;
+  uint64_t delayed_writes = 0;
+  uint64_t shed_writes = 0;
+};
+
+// Write stall conditions of the column families as RocksDB reports them, and
+// admission of the row writes to them. Writes to a column family nearing a
+// stall are delayed, and shed for low priority resource groups once it is
+// stopped, so that a bulk job on one column family backs off before RocksDB
+// holds up the writers of every column family.
+class Rdb_cf_write_throttle {
+ public:
+  Rdb_cf_write_throttle() {}
+
+  void set_condition(const std::string &cf_name,
+                     rocksdb::WriteStallCondition condition);
+
+  // whether any column family is delayed or stopped
+  bool any_stalled() const {
+    return m_stalled_cfs.load(std::memory_order_relaxed) > 0;
+  }
+
+  // admit a write to the column families, waiting if needed. returns
+  // HA_ERR_ROCKSDB_STATUS_BUSY if the write is shed.
+  int admit(THD *thd, const std::vector<std::string> &cf_names,
+            uint delay_us, uint max_wait_ms);
+
+  std::vector<Rdb_cf_write_throttle_record> get_records();
+
+ private:
+  Rdb_cf_write_throttle_record *find_stalled(
+      const std::vector<std::string> &cf_names);
+
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  std::map<std::string, Rdb_cf_write_throttle_record> m_cfs;
+  std::atomic<uint> m_stalled_cfs{0};
+};
+
+extern Rdb_cf_write_throttle cf_write_throttle;
+
+// The sampled key accesses of an index, to recommend the prefix extractor
+// and bloom filter of its column family from the workload.
+struct Rdb_key_access_record {
+  // equal conditions longer than this are counted as this long
+  static constexpr uint MAX_EQ_COND_LEN = 64;
+
+  GL_INDEX_ID gl_index_id;
+  uint64_t seeks = 0;
+  uint64_t gets = 0;
+  uint64_t get_misses = 0;
+  // seeks by the length of their equal condition, the index id included
+  std::array<uint64_t, MAX_EQ_COND_LEN + 1> seek_eq_cond_lens{};
+
+  // the longest capped prefix that at least the given share of the seeks
+  // can use a prefix bloom filter with
+  uint recommended_prefix_len(double share) const;
+
+  // the bloom bits per key for the false positives of the point reads to
+  // cost at most 1% more block reads, with this many levels holding data
+  uint recommended_bloom_bits(uint levels) const;
+};
+
+class Rdb_key_access_sampler {
+ public:
+  // whether to record this access, one of every sample_rate of the thread
+  static bool sample(uint sample_rate);
+
+  void record_seek(const GL_INDEX_ID &gl_index_id, size_t eq_cond_len);
+  void record_get(const GL_INDEX_ID &gl_index_id, bool found);
+
+  std::vector<Rdb_key_access_record> get_records();
+  void clear();
+
+ private:
+  std::mutex m_mutex;
+  std::unordered_map<GL_INDEX_ID, Rdb_key_access_record> m_records;
+};
+
+extern Rdb_key_access_sampler key_access_sampler;
+
+/* Sample a seek or a point read for the key access recommendations */
+void rdb_sample_seek(const Rdb_key_def &kd, size_t eq_cond_len);
+void rdb_sample_get(const Rdb_key_def &kd, bool found);
+
 /* Whether ROCKSDB_ENABLE_SELECT_BYPASS is enabled */
 select_bypass_policy_type get_select_bypass_policy();
 
@@ -1242,6 +1500,9 @@ bool should_log_rejected_bypass_rpc();
 
 unsigned long long get_partial_index_sort_max_mem(THD *thd);
 
+/* Queue a group of a partial index for the background materialization */
+bool rdb_queue_partial_index_group(Rdb_partial_index_request &&req);
+
 Rdb_transaction *get_tx_from_thd(THD *const thd);
 void add_tmp_table_handler(THD *const thd, ha_rocksdb *rocksdb_handler);
 void remove_tmp_table_handler(THD *const thd, ha_rocksdb *rocksdb_handler);
@@ -1253,7 +1514,29 @@ const rocksdb::ReadOptions &rdb_tx_acquire_snapshot(Rdb_transaction *tx);
     const rocksdb::Slice &eq_cond_lower_bound,
     const rocksdb::Slice &eq_cond_upper_bound,
     const rocksdb::Snapshot **snapshot, TABLE_TYPE table_type,
-    bool read_current = false, bool create_snapshot = true);
+    bool read_current = false, bool create_snapshot = true,
+    ha_rows scan_rows = 0, bool merge_batch = true);
+
+/*
+  Whether the iterators of the index kd have to merge the reads with the
+  write batch of the transaction, that is whether it wrote to the index.
+*/
+bool rdb_tx_merges_batch(THD *thd, const Rdb_key_def &kd,
+                         TABLE_TYPE table_type);
+
+/*
+  Whether the transaction wrote to the index kd, or reads in the middle of a
+  commit, so that its reads may not match its snapshot.
+*/
+bool rdb_tx_has_index_writes(THD *thd, const Rdb_key_def &kd);
+
+/*
+  Record that the transaction wrote to the list list_id of the ivf index
+  index_id, the list is not served from the list cache until it ends, see
+  Rdb_vector_list_cache.
+*/
+void rdb_tx_note_vector_list_write(Rdb_transaction *tx, Index_id index_id,
+                                   uint64 list_id);
 
 [[nodiscard]] std::unique_ptr<rocksdb::Iterator> rdb_tx_get_iterator_next_spatial(
     THD *thd, rocksdb::ColumnFamilyHandle &cf, 
@@ -1329,6 +1612,48 @@ int get_table_info(
     std::string cf_name,
     std::vector<rocksdb::BlockBasedTableOptions::FieldInfo>* field_info_list,
     rocksdb::BlockBasedTableOptions::TableConfig* table_config);
+/** drops the cached get_table_info result of a column family */
+void rdb_invalidate_table_info(const std::string &cf_name);
+/**
+  slices of the given fields of a row value laid out as get_table_info
+  describes, an empty slice for a null field
+*/
+uint DecodeFieldFromValue(
+    rocksdb::BlockBasedTableOptions::TableConfig &table_config,
+    std::vector<rocksdb::BlockBasedTableOptions::FieldInfo> &field_info_list,
+    std::vector<size_t> &field_indexs, const rocksdb::Slice &value,
+    std::vector<rocksdb::Slice> *field_values);
+
+/**
+  where a POINT column sits in row values laid out as get_table_info
+  describes. when every field before it is fixed length and not nullable
+  its offset is the same in every row, and scans read the coordinates of
+  the wkb point there without decoding the row.
+*/
+struct Rdb_point_value_layout {
+  // offset of the length of the column, -1 when it varies between rows
+  long m_offset{-1};
+  uint m_length_bytes{0};
+  // null bit of the column, 0 when it is not nullable
+  long m_null_offset{-1};
+  uchar m_null_mask{0};
+
+  [[nodiscard]] bool fixed() const { return m_offset >= 0; }
+};
+
+Rdb_point_value_layout rdb_point_value_layout(
+    const rocksdb::BlockBasedTableOptions::TableConfig &table_config,
+    const std::vector<rocksdb::BlockBasedTableOptions::FieldInfo>
+        &field_info_list,
+    size_t field_index);
+
+/**
+  lon and lat of the point in a row value at a fixed layout, false if the
+  column is null or holds another geometry
+*/
+bool rdb_point_from_value(const Rdb_point_value_layout &layout,
+                          const rocksdb::Slice &value, double *lon,
+                          double *lat);
 
 extern std::atomic<uint64_t> rocksdb_select_bypass_executed;
 extern std::atomic<uint64_t> rocksdb_select_bypass_rejected;
@@ -1343,12 +1668,17 @@ extern std::atomic<uint64_t> rocksdb_partial_index_groups_sorted;
 extern std::atomic<uint64_t> rocksdb_partial_index_groups_materialized;
 extern std::atomic<uint64_t> rocksdb_partial_index_rows_sorted;
 extern std::atomic<uint64_t> rocksdb_partial_index_rows_materialized;
+extern std::atomic<uint64_t> rocksdb_partial_index_groups_queued;
+extern std::atomic<uint64_t> rocksdb_partial_index_groups_stale;
 extern std::atomic<uint64_t> rocksdb_binlog_ttl_compaction_timestamp;
 extern bool rocksdb_enable_tmp_table;
 extern bool rocksdb_enable_delete_range_for_drop_index;
 extern bool rocksdb_disable_instant_ddl;
 extern bool rocksdb_enable_instant_ddl;
 extern bool rocksdb_partial_index_ignore_killed;
+extern bool rocksdb_partial_index_materialize_in_background;
+extern uint rocksdb_vector_rerank_factor;
+extern uint rocksdb_vector_result_cache_entries;
 
 extern bool rocksdb_enable_instant_ddl_for_append_column;
 extern bool rocksdb_enable_instant_ddl_for_column_default_changes;
@@ -1361,6 +1691,9 @@ extern char *rocksdb_datadir;
 
 extern uint rocksdb_clone_checkpoint_max_age;
 extern uint rocksdb_clone_checkpoint_max_count;
+extern bool rocksdb_clone_checksums;
+
+extern unsigned long long rocksdb_slow_io_threshold_us;
 
 extern unsigned long long rocksdb_converter_record_cached_length;
 
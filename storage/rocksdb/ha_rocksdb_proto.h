@@ -80,6 +80,10 @@ rocksdb::TransactionDB *rdb_get_rocksdb_db();
 class Rdb_cf_manager;
 Rdb_cf_manager &rdb_get_cf_manager();
 
+class Rdb_io_latency_fs;
+/* nullptr when @@rocksdb_io_latency_histograms is off */
+Rdb_io_latency_fs *rdb_get_io_latency_fs();
+
 const rocksdb::BlockBasedTableOptions &rdb_get_table_options();
 bool rdb_is_table_scan_index_stats_calculation_enabled();
 bool rdb_is_ttl_enabled();
@@ -90,6 +94,7 @@ bool rdb_dbug_set_ttl_ignore_pk();
 #endif
 bool rdb_is_ttl_compaction_filter_paused();
 bool rdb_is_binlog_ttl_enabled();
+uint64_t rdb_get_vector_list_partition_size();
 
 /* Whether WSEnvironment is enabled */
 bool rdb_has_wsenv();
@@ -112,4 +117,8 @@ Rdb_ddl_manager *rdb_get_ddl_manager(void)
 class Rdb_binlog_manager;
 Rdb_binlog_manager *rdb_get_binlog_manager(void)
     MY_ATTRIBUTE((__warn_unused_result__));
+
+/* The phases of the startup, for ROCKSDB_STARTUP_TIMELINE */
+class Rdb_exec_time;
+Rdb_exec_time &rdb_get_startup_timeline();
 }  // namespace myrocks
@@ -30,6 +30,7 @@
 
 /* MySQL header files */
 #include "./sql/item.h"
+#include "./sql/item_fb_vector_func.h"
 #include "./sql/item_func.h"
 #include "./sql/mysqld.h"
 #include "./sql/protocol.h"
@@ -568,6 +569,12 @@ class base_select_parser {
       const {
     return m_item_field_list;
   };
+  // ORDER BY FB_VECTOR_*(field, const) read through the vector index m_index
+  Item_func *get_vector_order() const { return m_vector_order; }
+  // WHERE MBR predicate read through the spatial index m_index
+  Item_func *get_spatial_cond() const { return m_spatial_cond; }
+  Item *get_spatial_value() const { return m_spatial_value; }
+  ha_rkey_function get_spatial_flag() const { return m_spatial_flag; }
 
  protected:
   // Update m_is_order_desc. If orders are not matched or orders are not in
@@ -651,6 +658,10 @@ class base_select_parser {
   // items saved to be set up later in execution phase,
   // it is combination of select item and condition items
   std::vector<std::pair<Item_field *, Field *>> m_item_field_list;
+  Item_func *m_vector_order = nullptr;
+  Item_func *m_spatial_cond = nullptr;
+  Item *m_spatial_value = nullptr;
+  ha_rkey_function m_spatial_flag = HA_READ_MBR_INTERSECT;
 };
 
 /*
@@ -834,6 +845,11 @@ class sql_select_parser : public base_select_parser {
     }
 
     auto order = m_select_lex->order_list.first;
+    if (m_select_lex->order_list.elements == 1 &&
+        (*order->item)->type() == Item::FUNC_ITEM) {
+      return parse_vector_order(order);
+    }
+
     bool is_first = true;
     KEY *key = &m_table->key_info[m_index];
     uint cur_index = key->actual_key_parts;
@@ -872,6 +888,152 @@ class sql_select_parser : public base_select_parser {
             type == Item::VARBIN_ITEM || is_constant_bool(op_arg, type));
   }
 
+  // A literal, or a function of literals such as ST_GeomFromText('...')
+  bool is_constant_expr(Item *item) {
+    if (is_supported_op_arg(item)) {
+      return true;
+    }
+    if (item->type() != Item::FUNC_ITEM) {
+      return false;
+    }
+    auto func = static_cast<Item_func *>(item);
+    for (uint i = 0; i < func->argument_count(); ++i) {
+      if (!is_constant_expr(func->arguments()[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Resolve the field argument of a vector distance or spatial predicate
+  // whose other argument is constant, and switch to the vector or spatial
+  // index on the field. Returns the field, nullptr if not supported
+  Field *parse_index_func_field(Item_func *func, uint field_arg_no,
+                                bool vector) {
+    const auto args = func->arguments();
+    if (func->argument_count() != 2 ||
+        args[field_arg_no]->type() != Item::FIELD_ITEM ||
+        !is_constant_expr(args[1 - field_arg_no])) {
+      update_error_msg("%s() should compare a field with a constant",
+                       func->func_name());
+      return nullptr;
+    }
+
+    auto field_arg = static_cast<Item_field *>(args[field_arg_no]);
+    auto field_name = field_arg->field_name;
+    uint field_index = field_arg->field_index;
+    Field *found =
+        find_field_in_table(m_table, field_name, false, &field_index);
+    if (!found) {
+      update_error_msg("Unrecognized field name: '%s'", field_name);
+      return nullptr;
+    }
+
+    uint index = MAX_KEY;
+    for (uint i = 0; i < m_table->s->keys; ++i) {
+      const KEY &key = m_table->key_info[i];
+      if ((vector ? key.is_fb_vector_index()
+                  : key.is_next_spatial_index() &&
+                        (key.flags & HA_SPATIAL)) &&
+          key.key_part[0].field == found) {
+        index = i;
+        break;
+      }
+    }
+    if (index == MAX_KEY) {
+      update_error_msg("No %s index on field: '%s'",
+                       vector ? "vector" : "spatial", field_name);
+      return nullptr;
+    }
+    if (m_table_list->index_hints != nullptr && m_index != index) {
+      m_error_msg = "FORCE INDEX should name the vector or spatial index";
+      return nullptr;
+    }
+    m_index = index;
+
+    m_item_field_list.emplace_back(field_arg, found);
+    return found;
+  }
+
+  // ORDER BY FB_VECTOR_L2(field, const) ascending, or FB_VECTOR_IP() or
+  // FB_VECTOR_COSINE() descending, with a LIMIT is a knn search
+  bool parse_vector_order(ORDER *order) {
+    auto func = static_cast<Item_func *>(*order->item);
+    auto type = func->functype();
+    if (type != Item_func::FB_VECTOR_L2 && type != Item_func::FB_VECTOR_IP &&
+        type != Item_func::FB_VECTOR_COSINE) {
+      m_error_msg = "ORDER BY should be only using field or FB_VECTOR_*()";
+      return true;
+    }
+    if ((type == Item_func::FB_VECTOR_L2) == (order->direction == ORDER_DESC)) {
+      m_error_msg =
+          "ORDER BY FB_VECTOR_L2() should be ascending, FB_VECTOR_IP() and "
+          "FB_VECTOR_COSINE() descending";
+      return true;
+    }
+    if (m_select_lex->select_limit == nullptr) {
+      m_error_msg = "ORDER BY FB_VECTOR_*() without LIMIT is not supported";
+      return true;
+    }
+
+    Field *field = parse_index_func_field(func, 0, true /* vector */);
+    if (!field) {
+      return true;
+    }
+    if (field->type() != MYSQL_TYPE_JSON && field->type() != MYSQL_TYPE_BLOB) {
+      m_error_msg = "FB_VECTOR_*() field should be JSON or BLOB";
+      return true;
+    }
+
+    m_is_order_desc = false;
+    m_vector_order = func;
+    return false;
+  }
+
+  // An MBR predicate between a field and a constant geometry is a range
+  // search of the spatial index, whose rows are checked against it
+  bool parse_spatial_cond(Item_func *func) {
+    if (m_select_lex->order_list.elements > 0) {
+      m_error_msg = "ORDER BY with a spatial WHERE not supported";
+      return true;
+    }
+
+    const auto args = func->arguments();
+    const uint field_arg_no =
+        func->argument_count() == 2 && args[1]->type() == Item::FIELD_ITEM;
+    if (!parse_index_func_field(func, field_arg_no, false /* vector */)) {
+      return true;
+    }
+
+    // with the field second the predicate reads the other way around
+    switch (func->functype()) {
+      case Item_func::SP_CONTAINS_FUNC:
+        m_spatial_flag =
+            field_arg_no ? HA_READ_MBR_WITHIN : HA_READ_MBR_CONTAIN;
+        break;
+      case Item_func::SP_WITHIN_FUNC:
+        m_spatial_flag =
+            field_arg_no ? HA_READ_MBR_CONTAIN : HA_READ_MBR_WITHIN;
+        break;
+      case Item_func::SP_EQUALS_FUNC:
+        m_spatial_flag = HA_READ_MBR_EQUAL;
+        break;
+      default:
+        m_spatial_flag = HA_READ_MBR_INTERSECT;
+    }
+
+    m_spatial_cond = func;
+    m_spatial_value = args[1 - field_arg_no];
+    return false;
+  }
+
+  bool inline is_spatial_func(Item_func::Functype type) {
+    return type == Item_func::SP_CONTAINS_FUNC ||
+           type == Item_func::SP_WITHIN_FUNC ||
+           type == Item_func::SP_INTERSECTS_FUNC ||
+           type == Item_func::SP_EQUALS_FUNC;
+  }
+
   bool inline parse_cond(Item_func *func) {
     auto type = func->functype();
     if (!is_supported_item_func(type)) {
@@ -978,6 +1140,14 @@ class sql_select_parser : public base_select_parser {
 
   bool parse_where() {
     auto where = m_select_lex->where_cond();
+    if (m_vector_order != nullptr) {
+      if (where != nullptr) {
+        m_error_msg = "WHERE with ORDER BY FB_VECTOR_*() not supported";
+        return true;
+      }
+      return false;
+    }
+
     if (where == nullptr) {
       m_error_msg = where_err_msg;
       return true;
@@ -1006,7 +1176,11 @@ class sql_select_parser : public base_select_parser {
         }
       }
     } else if (where_type == Item::FUNC_ITEM) {
-      if (parse_cond(static_cast<Item_func *>(where))) {
+      auto func = static_cast<Item_func *>(where);
+      if (is_spatial_func(func->functype())) {
+        return parse_spatial_cond(func);
+      }
+      if (parse_cond(func)) {
         return true;
       }
     } else {
@@ -1565,6 +1739,9 @@ class select_exec {
   select_exec_result scan_where();
   void scan_value();
   bool run_query();
+  select_exec_result run_handler_query();
+  int read_vector_index(Item_func *order);
+  int read_spatial_index(Item_func *cond);
   bool run_range_query(txn_wrapper *txn);
   bool unpack_for_sk(txn_wrapper *txn, const rocksdb::Slice &rkey,
                      const rocksdb::Slice &rvalue);
@@ -2254,6 +2431,10 @@ select_exec_result INLINE_ATTR select_exec::run() {
   m_key_def = m_tbl_def->m_key_descr_arr[m_index];
   m_pk_def = m_tbl_def->m_key_descr_arr[m_table_share->primary_key];
 
+  if (m_parser.get_vector_order() || m_parser.get_spatial_cond()) {
+    return run_handler_query();
+  }
+
   // Query on table with instant cols require dd::Table
   dd::cache::Dictionary_client *dd_client = m_thd->dd_client();
   dd::cache::Dictionary_client::Auto_releaser releaser(dd_client);
@@ -2348,6 +2529,129 @@ bool INLINE_ATTR select_exec::run_query() {
   return ret;
 }
 
+/*
+  Vector and spatial indexes are read through the handler, which searches
+  them with Rdb_vector_db_handler and Rdb_next_spatial_db_handler as it does
+  for the index scans the optimizer plans, without parsing and optimizing
+ */
+select_exec_result INLINE_ATTR select_exec::run_handler_query() {
+  Item_func *const vector_order = m_parser.get_vector_order();
+  Item_func *const spatial_cond = m_parser.get_spatial_cond();
+
+  // after prepare_fields it is not safe to fall back
+  if (prepare_fields()) {
+    return FAIL;
+  }
+  Item *func = vector_order ? vector_order : spatial_cond;
+  if (!func->fixed && func->fix_fields(m_thd, &func)) {
+    return FAIL;
+  }
+
+  for (Field *field : m_parser.get_field_list()) {
+    bitmap_set_bit(m_table->read_set, field->field_index());
+  }
+  // re-ranking quantized vectors and the spatial predicate read the field
+  bitmap_set_bit(m_table->read_set,
+                 m_index_info->key_part[0].field->field_index());
+
+  if (m_protocol.send_result_metadata()) {
+    return FAIL;
+  }
+
+  if (m_select_limit == 0) {
+    return SUCCESS;
+  }
+
+  txn_wrapper txn(m_thd, m_tbl_def->get_table_type());
+  if (txn.start()) {
+    return FAIL;
+  }
+
+  bool failed = false;
+  int rc = m_handler->ha_index_init(m_index, true /* sorted */);
+  if (!rc) {
+    rc = vector_order ? read_vector_index(vector_order)
+                      : read_spatial_index(spatial_cond);
+    for (; !rc; rc = m_handler->ha_index_next(m_table->record[0])) {
+      if (unlikely(handle_killed())) {
+        failed = true;
+        break;
+      }
+
+      // the index matched the MBRs only
+      if (spatial_cond && !spatial_cond->val_int()) {
+        m_examined_rows++;
+        continue;
+      }
+
+      const int ret = eval_and_send();
+      if (ret > 0) {
+        failed = true;
+        break;
+      } else if (ret < 0) {
+        // no more items
+        break;
+      }
+    }
+    m_handler->ha_index_end();
+  }
+  if (!failed && rc && rc != HA_ERR_END_OF_FILE) {
+    m_handler->print_error(rc, 0);
+    failed = true;
+  }
+
+  // the handler counted the rows it read
+  m_thd->inc_sent_row_count(m_rows_sent);
+  m_thd->inc_examined_row_count(m_examined_rows);
+
+  return failed || m_thd->is_error() ? FAIL : SUCCESS;
+}
+
+int INLINE_ATTR select_exec::read_vector_index(Item_func *order) {
+  // the search hints the optimizer gives a vector ORDER BY with a LIMIT
+  auto distance = static_cast<Item_func_fb_vector_distance *>(order);
+  const auto &variables = m_thd->variables;
+  ha_rows limit = m_select_limit;
+  if (variables.fb_vector_search_limit_multiplier > 0) {
+    limit *= variables.fb_vector_search_limit_multiplier;
+  }
+  distance->m_limit = limit;
+  distance->m_search_type =
+      variables.fb_vector_search_type == FB_VECTOR_SEARCH_INDEX_SCAN
+          ? FB_VECTOR_SEARCH_INDEX_SCAN
+          : FB_VECTOR_SEARCH_KNN_FIRST;
+  distance->m_nprobe = variables.fb_vector_search_nprobe;
+  distance->m_threads = variables.fb_vector_search_threads;
+  distance->m_target_candidates = variables.fb_vector_search_target_candidates;
+
+  int rc = m_handler->vector_index_init(distance);
+  if (rc) {
+    return rc;
+  }
+  return m_handler->ha_index_first(m_table->record[0]);
+}
+
+int INLINE_ATTR select_exec::read_spatial_index(Item_func *cond) {
+  // the key is the MBR of the constant, as the range optimizer builds it
+  Field *const field = m_index_info->key_part[0].field;
+  if (m_parser.get_spatial_value()->save_in_field_no_warnings(field, true) !=
+      TYPE_OK) {
+    // no geometry matches, raise the error the predicate would if any
+    cond->val_int();
+    return HA_ERR_END_OF_FILE;
+  }
+
+  // spatial key parts are NOT NULL, the key has no null byte
+  m_index_tuple_buf.resize(m_index_info->key_length);
+  field->get_key_image(m_index_tuple_buf.data(),
+                       m_index_info->key_part[0].length, Field::itMBR);
+
+  m_handler->next_spatial_cond_push(m_index, cond);
+  return m_handler->ha_index_read_map(m_table->record[0],
+                                      m_index_tuple_buf.data(), 1,
+                                      m_parser.get_spatial_flag());
+}
+
 bool INLINE_ATTR select_exec::run_pk_point_query() {
   if (m_key_index_tuples.size() > get_select_bypass_multiget_min()) {
     size_t size = m_key_index_tuples.size();
@@ -179,6 +179,13 @@ void Rdb_tbl_prop_coll::CollectStatsForRow(const rocksdb::Slice &key,
 
   if (m_keydef != nullptr && type == rocksdb::kEntryPut) {
     m_cardinality_collector.ProcessKey(key, m_keydef.get(), stats);
+
+    double lon = 0;
+    double lat = 0;
+    if (m_keydef->is_next_spatial_index() &&
+        m_keydef->next_spatial_entry_point(key, value, &lon, &lat)) {
+      stats->m_spatial_histogram[rdb_spatial_histogram_cell(lon, lat)]++;
+    }
   }
 }
 
@@ -326,7 +333,12 @@ std::string Rdb_tbl_prop_coll::GetReadableStats(const Rdb_index_stats &it) {
     s.append(std::to_string(num));
     s.append(" ");
   }
-  s.append("]}");
+  s.append("]");
+  if (!it.m_spatial_histogram.empty()) {
+    s.append(", spatial cells:");
+    s.append(std::to_string(it.m_spatial_histogram.size()));
+  }
+  s.append("}");
   return s;
 }
 
@@ -353,7 +365,7 @@ std::vector<Rdb_index_stats> Rdb_tbl_prop_coll::read_stats_from_tbl_props(
 std::string Rdb_index_stats::materialize(
     const std::vector<Rdb_index_stats> &stats) {
   String ret;
-  rdb_netstr_append_uint16(&ret, INDEX_STATS_VERSION_ENTRY_TYPES);
+  rdb_netstr_append_uint16(&ret, INDEX_STATS_VERSION_SPATIAL_HISTOGRAM);
   for (const auto &i : stats) {
     rdb_netstr_append_uint32(&ret, i.m_gl_index_id.cf_id);
     rdb_netstr_append_uint32(&ret, i.m_gl_index_id.index_id);
@@ -369,6 +381,11 @@ std::string Rdb_index_stats::materialize(
     for (const auto &num_keys : i.m_distinct_keys_per_prefix) {
       rdb_netstr_append_uint64(&ret, num_keys);
     }
+    rdb_netstr_append_uint64(&ret, i.m_spatial_histogram.size());
+    for (const auto &cell : i.m_spatial_histogram) {
+      rdb_netstr_append_uint32(&ret, cell.first);
+      rdb_netstr_append_uint64(&ret, cell.second);
+    }
   }
 
   return std::string((char *)ret.ptr(), ret.length());
@@ -395,7 +412,7 @@ int Rdb_index_stats::unmaterialize(const std::string &s,
   Rdb_index_stats stats;
   // Make sure version is within supported range.
   if (version < INDEX_STATS_VERSION_INITIAL ||
-      version > INDEX_STATS_VERSION_ENTRY_TYPES) {
+      version > INDEX_STATS_VERSION_SPATIAL_HISTOGRAM) {
     rdb_fatal_error(
         "Index stats version %d was outside of supported range. "
         "This should not happen so aborting the system.",
@@ -435,6 +452,24 @@ int Rdb_index_stats::unmaterialize(const std::string &s,
     for (std::size_t i = 0; i < stats.m_distinct_keys_per_prefix.size(); i++) {
       stats.m_distinct_keys_per_prefix[i] = rdb_netbuf_read_uint64(&p);
     }
+    stats.m_spatial_histogram.clear();
+    if (version >= INDEX_STATS_VERSION_SPATIAL_HISTOGRAM) {
+      if (p + sizeof(uint64) > p2) {
+        return HA_EXIT_FAILURE;
+      }
+      const uint64 cells = rdb_netbuf_read_uint64(&p);
+      if (cells > RDB_NEXT_SPATIAL_HISTOGRAM_CELLS ||
+          p + cells * (sizeof(uint32) + sizeof(uint64)) > p2) {
+        return HA_EXIT_FAILURE;
+      }
+      for (uint64 i = 0; i < cells; i++) {
+        const uint32 cell = rdb_netbuf_read_uint32(&p);
+        if (cell >= RDB_NEXT_SPATIAL_HISTOGRAM_CELLS) {
+          return HA_EXIT_FAILURE;
+        }
+        stats.m_spatial_histogram[cell] = rdb_netbuf_read_uint64(&p);
+      }
+    }
     ret->push_back(stats);
   }
   return HA_EXIT_SUCCESS;
@@ -480,6 +515,9 @@ void Rdb_index_stats::merge(const Rdb_index_stats &s, const bool increment,
     for (i = 0; i < s.m_distinct_keys_per_prefix.size(); i++) {
       m_distinct_keys_per_prefix[i] += s.m_distinct_keys_per_prefix[i];
     }
+    for (const auto &cell : s.m_spatial_histogram) {
+      m_spatial_histogram[cell.first] += cell.second;
+    }
   } else {
     m_rows -= s.m_rows;
     m_data_size -= s.m_data_size;
@@ -494,6 +532,13 @@ void Rdb_index_stats::merge(const Rdb_index_stats &s, const bool increment,
     for (i = 0; i < s.m_distinct_keys_per_prefix.size(); i++) {
       m_distinct_keys_per_prefix[i] -= s.m_distinct_keys_per_prefix[i];
     }
+    for (const auto &cell : s.m_spatial_histogram) {
+      const auto it = m_spatial_histogram.find(cell.first);
+      if (it == m_spatial_histogram.end()) continue;
+      // a cell emptied by a compaction is dropped
+      it->second -= cell.second;
+      if (it->second <= 0) m_spatial_histogram.erase(it);
+    }
   }
 }
 
@@ -25,6 +25,7 @@
 
 /* MyRocks header files */
 #include "./ha_rocksdb.h"
+#include "./rdb_next_spatial_db.h"
 #include "rdb_psi.h"
 
 namespace myrocks {
@@ -49,12 +50,16 @@ struct Rdb_index_stats {
   enum {
     INDEX_STATS_VERSION_INITIAL = 1,
     INDEX_STATS_VERSION_ENTRY_TYPES = 2,
+    INDEX_STATS_VERSION_SPATIAL_HISTOGRAM = 3,
   };
   GL_INDEX_ID m_gl_index_id;
   int64_t m_data_size, m_rows, m_actual_disk_size;
   int64_t m_entry_deletes, m_entry_single_deletes;
   int64_t m_entry_merges, m_entry_others;
   std::vector<int64_t> m_distinct_keys_per_prefix;
+  // entries of a next spatial index per cell of the grid over the globe,
+  // empty for other indexes
+  Rdb_spatial_histogram m_spatial_histogram;
   std::string m_name;  // name is not persisted
 
   static std::string materialize(const std::vector<Rdb_index_stats> &stats);
@@ -30,6 +30,7 @@
 /* MyRocks header files */
 #include "./rdb_cf_manager.h"
 #include "./rdb_compact_filter.h"
+#include "./rdb_fulltext.h"
 #include "./rdb_sst_partitioner_factory.h"
 
 namespace myrocks {
@@ -348,10 +349,12 @@ const rocksdb::Comparator *Rdb_cf_options::get_cf_comparator(
 
 std::shared_ptr<rocksdb::MergeOperator> Rdb_cf_options::get_cf_merge_operator(
     std::string_view cf_name) {
-  return (cf_name == DEFAULT_SYSTEM_CF_NAME ||
-          cf_name == DEFAULT_TMP_SYSTEM_CF_NAME)
-             ? std::make_shared<Rdb_system_merge_op>()
-             : nullptr;
+  if (cf_name == DEFAULT_SYSTEM_CF_NAME ||
+      cf_name == DEFAULT_TMP_SYSTEM_CF_NAME) {
+    return std::make_shared<Rdb_system_merge_op>();
+  }
+  // the stats of the FULLTEXT indexes in the column family
+  return std::make_shared<Rdb_fulltext_merge_op>();
 }
 
 bool Rdb_cf_options::get_cf_options(const std::string &cf_name,
@@ -33,6 +33,8 @@ constexpr std::string_view INDEX_DATA_TYPE_METADATA = "metadata";
 constexpr std::string_view INDEX_DATA_TYPE_QUANTIZER = "quantizer";
 constexpr std::string_view INDEX_DATA_TYPE_PRODUCT_QUANTIZER =
     "product_quantizer";
+constexpr std::string_view INDEX_DATA_TYPE_SCALAR_QUANTIZER =
+    "scalar_quantizer";
 
 enum class Rdb_vector_index_data_version { NONE, V1 };
 constexpr std::string_view METADATA_KEY_VERSION = "version";
@@ -387,11 +389,40 @@ Rdb_cmd_srv_status Rdb_cmd_srv_helper::load_index_data(
   }
   if (index_data->m_pq_m > 0) {
     // only read pq codes when needed
-    return read_codes(db_name, table_name, id,
-                      INDEX_DATA_TYPE_PRODUCT_QUANTIZER,
-                      index_data->m_pq_codes);
+    status = read_codes(db_name, table_name, id,
+                        INDEX_DATA_TYPE_PRODUCT_QUANTIZER,
+                        index_data->m_pq_codes);
+    if (status.error()) {
+      return status;
+    }
   }
-  return status;
+  return read_codes(db_name, table_name, id, INDEX_DATA_TYPE_SCALAR_QUANTIZER,
+                    index_data->m_sq_codes);
+}
+
+static std::string quote_identifier(const std::string &name) {
+  std::string quoted = "`";
+  for (const char c : name) {
+    if (c == '`') quoted += '`';
+    quoted += c;
+  }
+  return quoted + "`";
+}
+
+Rdb_cmd_srv_status Rdb_cmd_srv_helper::open_table(
+    const std::string &db_name, const std::string &table_name) {
+  MYSQL_H_wrapper mysql_wrapper(m_command_factory);
+  auto status = connect(mysql_wrapper);
+  if (status.error()) {
+    return status;
+  }
+
+  MYSQL_RES_H_wrapper mysql_res_wrapper(m_command_query_result);
+  // the table is opened even though no row is read
+  const auto query = "SELECT 1 FROM " + quote_identifier(table_name) +
+                     " LIMIT 0";
+  return execute_query(quote_identifier(db_name), query, mysql_wrapper,
+                       mysql_res_wrapper);
 }
 
 }  // namespace myrocks
@@ -35,6 +35,7 @@ class Rdb_vector_index_data {
   uint m_pq_nbits = 0;
   std::vector<float> m_quantizer_codes;
   std::vector<float> m_pq_codes;
+  std::vector<float> m_sq_codes;
 };
 
 class Rdb_cmd_srv_status {
@@ -108,12 +109,24 @@ class Rdb_cmd_srv_helper {
   3. product quantizer codes. The type is set to "product_quantizer". The value
   is a json array of float values. There could be multiple product_quantizer
   records per index. The records are ordered by seqno when they are read.
+  4. scalar quantizer ranges, optional. The type is set to
+  "scalar_quantizer". The value is a json array of float values, the
+  per dimension minimums followed by the per dimension ranges used by
+  8 bit scalar quantization. The records are ordered by seqno when they are
+  read.
   */
   Rdb_cmd_srv_status load_index_data(
       const std::string &db_name, const std::string &table_name,
       const std::string &id,
       std::unique_ptr<Rdb_vector_index_data> &index_data);
 
+  /**
+    open a table in a session of its own, which sets up its indexes. the
+    thread must have been initialized for the command service
+  */
+  Rdb_cmd_srv_status open_table(const std::string &db_name,
+                                const std::string &table_name);
+
  private:
   const mysql_service_mysql_command_factory_t *m_command_factory;
   const mysql_service_mysql_command_options_t *m_command_options;
@@ -24,8 +24,13 @@
 #ifndef NDEBUG
 #include <ctime>
 #endif
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 /* RocksDB includes */
 #include "rocksdb/compaction_filter.h"
@@ -36,12 +41,94 @@
 
 namespace myrocks {
 
+/*
+  Whether each index of a column family is being dropped, its TTL, and the
+  generation of the centroids of its ivf lists, as of one version of the
+  data dictionary. The compaction filters of the column
+  family share it read only, so that looking up an index takes no lock.
+*/
+struct Rdb_compact_filter_snapshot {
+  struct Index_info {
+    bool should_delete = false;
+    uchar index_type = 0;
+    uint64 ttl_duration = 0;
+    uint32 ttl_offset = 0;
+    // ivf list entries with a lower list id belong to retired centroids
+    uint64 min_list_id = 0;
+  };
+
+  // the Rdb_dict_manager::get_version() this was read at
+  uint64_t version = 0;
+  std::unordered_map<GL_INDEX_ID, Index_info> indexes;
+
+  static std::shared_ptr<const Rdb_compact_filter_snapshot> create(
+      uint32_t cf_id) {
+    const Rdb_dict_manager *const dict_manager =
+        rdb_get_dict_manager()->get_dict_manager_selector_const(cf_id);
+    auto snapshot = std::make_shared<Rdb_compact_filter_snapshot>();
+    snapshot->version = dict_manager->get_version();
+
+    std::unordered_set<GL_INDEX_ID> dropped;
+    dict_manager->get_ongoing_drop_indexes(&dropped);
+    for (const auto &gl_index_id : dropped) {
+      if (gl_index_id.cf_id == cf_id) {
+        snapshot->indexes[gl_index_id].should_delete = true;
+      }
+    }
+
+    /*
+      If key is part of system column family, it's definitely not a TTL key.
+    */
+    rocksdb::ColumnFamilyHandle *s_cf = dict_manager->get_system_cf();
+    if (s_cf == nullptr || cf_id == s_cf->GetID()) {
+      return snapshot;
+    }
+
+    std::vector<GL_INDEX_ID> gl_index_ids;
+    dict_manager->get_cf_index_ids(cf_id, &gl_index_ids);
+    for (const auto &gl_index_id : gl_index_ids) {
+      uint64 generation = 0;
+      uint nlist = 0;
+      if (dict_manager->get_vector_quantizer(gl_index_id, &generation, &nlist,
+                                             nullptr) &&
+          generation > 0) {
+        snapshot->indexes[gl_index_id].min_list_id =
+            generation << Rdb_key_def::VECTOR_INDEX_GENERATION_SHIFT;
+      }
+
+      struct Rdb_index_info index_info;
+      if (!dict_manager->get_index_info(gl_index_id, &index_info) ||
+          index_info.m_ttl_duration == 0) {
+        continue;
+      }
+
+      Index_info &info = snapshot->indexes[gl_index_id];
+      info.index_type = index_info.m_index_type;
+      info.ttl_duration = index_info.m_ttl_duration;
+      if (Rdb_key_def::has_index_flag(index_info.m_index_flags,
+                                      Rdb_key_def::TTL_FLAG)) {
+        info.ttl_offset = Rdb_key_def::calculate_index_flag_offset(
+            index_info.m_index_flags, Rdb_key_def::TTL_FLAG);
+      }
+    }
+    return snapshot;
+  }
+
+  const Index_info *find(const GL_INDEX_ID &gl_index_id) const {
+    const auto it = indexes.find(gl_index_id);
+    return it == indexes.end() ? nullptr : &it->second;
+  }
+};
+
 class Rdb_compact_filter : public rocksdb::CompactionFilter {
  public:
   Rdb_compact_filter(const Rdb_compact_filter &) = delete;
   Rdb_compact_filter &operator=(const Rdb_compact_filter &) = delete;
 
-  explicit Rdb_compact_filter(uint32_t _cf_id) : m_cf_id(_cf_id) {}
+  Rdb_compact_filter(
+      uint32_t _cf_id,
+      std::shared_ptr<const Rdb_compact_filter_snapshot> snapshot)
+      : m_cf_id(_cf_id), m_snapshot(std::move(snapshot)) {}
   ~Rdb_compact_filter() {
     // Increment stats by num expired at the end of compaction
     rdb_update_global_stats(ROWS_EXPIRED, m_num_expired);
@@ -92,12 +179,14 @@ class Rdb_compact_filter : public rocksdb::CompactionFilter {
     assert(gl_index_id.index_id >= 1);
 
     if (gl_index_id != m_prev_index) {
-      m_should_delete = rdb_get_dict_manager()
-                            ->get_dict_manager_selector_const(gl_index_id.cf_id)
-                            ->is_drop_index_ongoing(gl_index_id);
-
-      if (!m_should_delete) {
-        get_ttl_duration_and_offset(gl_index_id, &m_ttl_duration,
+      const auto *const index_info = m_snapshot->find(gl_index_id);
+      m_should_delete = index_info != nullptr && index_info->should_delete;
+      m_ttl_duration = 0;
+      m_min_list_id = index_info != nullptr ? index_info->min_list_id : 0;
+      start_vector_stats(gl_index_id);
+
+      if (!m_should_delete && index_info != nullptr) {
+        get_ttl_duration_and_offset(*index_info, &m_ttl_duration,
                                     &m_ttl_offset);
 
         if (m_ttl_duration != 0 && !m_expiration_timestamp.has_value()) {
@@ -112,7 +201,7 @@ class Rdb_compact_filter : public rocksdb::CompactionFilter {
       m_prev_index = gl_index_id;
     }
 
-    if (m_should_delete) {
+    if (m_should_delete || is_retired_list_entry(key)) {
       m_num_deleted++;
       return true;
     } else if (m_ttl_duration > 0 &&
@@ -121,16 +210,56 @@ class Rdb_compact_filter : public rocksdb::CompactionFilter {
       return true;
     }
 
+    if (m_vector_stats != nullptr) {
+      m_vector_stats->add_entry(key, existing_value);
+    }
     return false;
   }
 
+  /*
+    Start collecting the distances to their centroid of the ivf list entries
+    of a vector index, the previous index hands over what it collected.
+  */
+  void start_vector_stats(const GL_INDEX_ID &gl_index_id) const {
+    m_vector_stats.reset();
+    m_vector_kd.reset();
+    if (m_should_delete) {
+      return;
+    }
+
+    auto kd = rdb_get_ddl_manager()->safe_find(gl_index_id);
+    if (kd == nullptr || !kd->is_vector_index() ||
+        kd->get_vector_index() == nullptr) {
+      return;
+    }
+    m_vector_stats = kd->get_vector_index()->new_compaction_stats();
+    if (m_vector_stats != nullptr) {
+      // keeps the index alive until its stats are handed over
+      m_vector_kd = std::move(kd);
+    }
+  }
+
+  /*
+    Entries of the ivf lists of centroids a retrain replaced. The retrain
+    hides them with one range delete, dropping them here frees their space
+    without waiting for the range delete to reach the last level.
+  */
+  bool is_retired_list_entry(const rocksdb::Slice &key) const {
+    constexpr size_t prefix_size =
+        Rdb_key_def::INDEX_NUMBER_SIZE + sizeof(uint64);
+    return m_min_list_id > 0 && key.size() >= prefix_size &&
+           rdb_netbuf_to_uint64(reinterpret_cast<const uchar *>(key.data()) +
+                                Rdb_key_def::INDEX_NUMBER_SIZE) <
+               m_min_list_id;
+  }
+
   virtual bool IgnoreSnapshots() const override { return true; }
 
   virtual const char *Name() const override { return "Rdb_compact_filter"; }
 
-  void get_ttl_duration_and_offset(const GL_INDEX_ID &gl_index_id,
-                                   uint64 *ttl_duration,
-                                   uint32 *ttl_offset) const {
+  void get_ttl_duration_and_offset(
+      const Rdb_compact_filter_snapshot::Index_info &index_info,
+      uint64 *ttl_duration, uint32 *ttl_offset) const {
     assert(ttl_duration != nullptr);
     /*
       If TTL is disabled set ttl_duration to 0.  This prevents the compaction
@@ -141,39 +270,16 @@ class Rdb_compact_filter : public rocksdb::CompactionFilter {
       return;
     }
 
-    /*
-      If key is part of system column family, it's definitely not a TTL key.
-    */
-    rocksdb::ColumnFamilyHandle *s_cf =
-        rdb_get_dict_manager()
-            ->get_dict_manager_selector_const(gl_index_id.cf_id)
-            ->get_system_cf();
-    if (s_cf == nullptr || gl_index_id.cf_id == s_cf->GetID()) {
-      *ttl_duration = 0;
-      return;
-    }
-
-    struct Rdb_index_info index_info;
-    if (!rdb_get_dict_manager()
-             ->get_dict_manager_selector_const(gl_index_id.cf_id)
-             ->get_index_info(gl_index_id, &index_info)) {
-      return;
-    }
-
 #ifndef NDEBUG
     if (rdb_dbug_set_ttl_ignore_pk() &&
-        index_info.m_index_type == Rdb_key_def::INDEX_TYPE_PRIMARY) {
+        index_info.index_type == Rdb_key_def::INDEX_TYPE_PRIMARY) {
       *ttl_duration = 0;
       return;
     }
 #endif
 
-    *ttl_duration = index_info.m_ttl_duration;
-    if (Rdb_key_def::has_index_flag(index_info.m_index_flags,
-                                    Rdb_key_def::TTL_FLAG)) {
-      *ttl_offset = Rdb_key_def::calculate_index_flag_offset(
-          index_info.m_index_flags, Rdb_key_def::TTL_FLAG);
-    }
+    *ttl_duration = index_info.ttl_duration;
+    *ttl_offset = index_info.ttl_offset;
   }
 
   bool should_filter_ttl_rec(const rocksdb::Slice &key
@@ -215,6 +321,8 @@ class Rdb_compact_filter : public rocksdb::CompactionFilter {
  private:
   // Column family for this compaction filter
   const uint32_t m_cf_id;
+  // The indexes of the column family when the compaction started
+  const std::shared_ptr<const Rdb_compact_filter_snapshot> m_snapshot;
   // Index id of the previous record
   mutable GL_INDEX_ID m_prev_index = {0, 0};
   // Number of rows deleted for the same index id
@@ -227,8 +335,14 @@ class Rdb_compact_filter : public rocksdb::CompactionFilter {
   mutable uint64 m_ttl_duration = 0;
   // TTL offset for all records in the current index
   mutable uint32 m_ttl_offset = 0;
+  // Lowest live ivf list id of the current index, 0 if it has no retired one
+  mutable uint64 m_min_list_id = 0;
   // Timestamp below which rows can be compacted away
   mutable std::optional<uint64_t> m_expiration_timestamp;
+  // Vector index of the current index, if it collects compaction stats
+  mutable std::shared_ptr<const Rdb_key_def> m_vector_kd;
+  // Declared after m_vector_kd, so that it is destroyed first
+  mutable std::unique_ptr<Rdb_vector_compaction_stats> m_vector_stats;
 };
 
 class Rdb_compact_filter_factory : public rocksdb::CompactionFilterFactory {
@@ -244,9 +358,33 @@ class Rdb_compact_filter_factory : public rocksdb::CompactionFilterFactory {
 
   std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
       const rocksdb::CompactionFilter::Context &context) override {
-    return std::unique_ptr<rocksdb::CompactionFilter>(
-        new Rdb_compact_filter(context.column_family_id));
+    return std::unique_ptr<rocksdb::CompactionFilter>(new Rdb_compact_filter(
+        context.column_family_id, get_snapshot(context.column_family_id)));
+  }
+
+ private:
+  /*
+    The snapshot of the indexes of the column family, read again only once
+    the data dictionary changed.
+  */
+  std::shared_ptr<const Rdb_compact_filter_snapshot> get_snapshot(
+      uint32_t cf_id) {
+    const uint64_t version = rdb_get_dict_manager()
+                                 ->get_dict_manager_selector_const(cf_id)
+                                 ->get_version();
+
+    std::lock_guard<std::mutex> guard(m_snapshots_mutex);
+    auto &snapshot = m_snapshots[cf_id];
+    if (snapshot == nullptr || snapshot->version != version) {
+      snapshot = Rdb_compact_filter_snapshot::create(cf_id);
+    }
+    return snapshot;
   }
+
+  std::mutex m_snapshots_mutex;
+  std::unordered_map<uint32_t,
+                     std::shared_ptr<const Rdb_compact_filter_snapshot>>
+      m_snapshots;
 };
 
 }  // namespace myrocks
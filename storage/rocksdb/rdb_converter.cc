@@ -359,6 +359,12 @@ int Rdb_value_field_iterator<value_field_decoder, dst_type>::next() {
       m_is_null = maybe_null && ((m_null_bytes[m_field_dec->m_null_offset] &
                                   m_field_dec->m_null_mask) != 0);
 
+      // NULL values at fixed offsets still take their bytes
+      if (m_is_null && m_field_dec->m_fixed_offset &&
+          !m_value_slice_reader->read(m_field_dec->m_field_pack_length)) {
+        return HA_ERR_ROCKSDB_CORRUPT_DATA;
+      }
+
       // Decode each field
       err = value_field_decoder::decode(
           m_buf, m_table, m_field_dec, m_value_slice_reader, decode, m_is_null);
@@ -500,7 +506,7 @@ void Rdb_converter::setup_field_decoders(const MY_BITMAP *field_map,
     }
   }
 
-  for (uint i = 0; i < m_table->s->fields; i++) {
+  for (const uint i : m_storage_order) {
     bool field_requested =
         decode_all_fields || m_verify_row_debug_checksums ||
         bitmap_is_set(field_map, m_table->field[i]->field_index()) || bases[i];
@@ -522,13 +528,13 @@ void Rdb_converter::setup_field_decoders(const MY_BITMAP *field_map,
       skip_size = 0;
     } else {
       if (m_encoder_arr[i].uses_variable_len_encoding() ||
-          m_encoder_arr[i].maybe_null()) {
+          (m_encoder_arr[i].maybe_null() && !m_encoder_arr[i].m_fixed_offset)) {
         // For variable-length field, we need to read the data and skip it
         m_decoders_vect.push_back({&m_encoder_arr[i], false, skip_size});
         skip_size = 0;
       } else {
-        // Fixed-width field can be skipped without looking at it.
-        // Add appropriate skip_size to the next field.
+        // Fixed-width field, or one at a fixed offset, can be skipped
+        // without looking at it. Add appropriate skip_size to the next field.
         skip_size += m_encoder_arr[i].m_field_pack_length;
       }
     }
@@ -556,6 +562,10 @@ void Rdb_converter::setup_field_encoders(const dd::Table *dd_table) {
     return;
   }
 
+  const bool fixed_offsets =
+      m_tbl_def->m_key_descr_arr[ha_rocksdb::pk_index(*m_table, *m_tbl_def)]
+          ->has_fixed_offsets();
+
   // whether table contains instant cols
   bool is_instant_table = false;
   // num of cols before first instant cols append
@@ -650,6 +660,22 @@ void Rdb_converter::setup_field_encoders(const dd::Table *dd_table) {
       m_encoder_arr[i].m_null_offset = 0;
       m_encoder_arr[i].m_null_mask = 0;
     }
+
+    // instant cols stay at the end, old records do not have them
+    m_encoder_arr[i].m_fixed_offset =
+        fixed_offsets &&
+        m_encoder_arr[i].m_storage_type == Rdb_field_encoder::STORE_ALL &&
+        !m_encoder_arr[i].m_is_virtual_gcol &&
+        !m_encoder_arr[i].m_is_instant_field &&
+        !m_encoder_arr[i].uses_variable_len_encoding();
+  }
+
+  m_storage_order.clear();
+  for (uint i = 0; i < m_table->s->fields; i++) {
+    if (m_encoder_arr[i].m_fixed_offset) m_storage_order.push_back(i);
+  }
+  for (uint i = 0; i < m_table->s->fields; i++) {
+    if (!m_encoder_arr[i].m_fixed_offset) m_storage_order.push_back(i);
   }
 
   // Count the last, unfinished NULL-bits byte
@@ -968,7 +994,7 @@ int Rdb_converter::encode_value_slice(
     m_storage_record.append(reinterpret_cast<char *>(pk_unpack_info->ptr()),
                             pk_unpack_info->get_current_pos());
   }
-  for (uint i = 0; i < m_table->s->fields; i++) {
+  for (const uint i : m_storage_order) {
     Rdb_field_encoder &encoder = m_encoder_arr[i];
     /* Don't pack decodable PK key parts */
     if (encoder.m_storage_type != Rdb_field_encoder::STORE_ALL) {
@@ -989,7 +1015,11 @@ int Rdb_converter::encode_value_slice(
 
       if (field->is_null()) {
         data[encoder.m_null_offset] |= encoder.m_null_mask;
-        /* Don't write anything for NULL values */
+        /* Don't write anything for NULL values, but keep the offsets */
+        if (encoder.m_fixed_offset) {
+          m_storage_record.fill(
+              m_storage_record.length() + encoder.m_field_pack_length, 0);
+        }
         continue;
       }
     }
@@ -247,6 +247,12 @@ class Rdb_converter {
     record.
   */
   Rdb_field_encoder *m_encoder_arr;
+  /*
+    The fields in the order they are stored in the record: all of them in
+    table order, or the fixed-offset ones first if the PK has
+    FIXED_OFFSETS_FLAG.
+  */
+  std::vector<uint> m_storage_order;
   /*
     Array of request fields telling how to decode data in RocksDB format
   */
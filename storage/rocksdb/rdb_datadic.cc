@@ -34,11 +34,18 @@
 #include <map>
 #include <set>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 #include <iostream>
 #include <sstream>
 
+/* System header files */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 /* MySQL header files */
 #include "./m_ctype.h"
 #include "./my_bit.h"
@@ -312,6 +319,7 @@ Rdb_key_def::Rdb_key_def(const Rdb_key_def &k)
       m_cf_handle(k.m_cf_handle),
       m_vector_index_config(k.m_vector_index_config),
       m_next_spatial_index_config(k.m_next_spatial_index_config),
+      m_is_fulltext(k.m_is_fulltext),
       m_is_reverse_cf(k.m_is_reverse_cf),
       m_is_per_partition_cf(k.m_is_per_partition_cf),
       m_name(k.m_name),
@@ -382,6 +390,7 @@ uint Rdb_key_def::setup(const TABLE &tbl, const Rdb_tbl_def &tbl_def,
       m_name = std::string(key_info->name);
       m_vector_index_config = key_info->fb_vector_index_config;
       m_next_spatial_index_config = key_info->next_spatial_index_config;
+      m_is_fulltext = key_info->flags & HA_FULLTEXT;
     } else {
       m_name = HIDDEN_PK_NAME;
     }
@@ -578,6 +587,14 @@ uint Rdb_key_def::setup(const TABLE &tbl, const Rdb_tbl_def &tbl_def,
     m_key_parts = dst_i;
     m_max_blob_length = max_blob_length;
     m_store_covered_bitmap = store_covered_bitmap && secondary_key;
+
+    // Keys of integer columns only are packed in one pass, see
+    // pack_integer_key_parts(). A hidden pk part has no column.
+    m_integer_key = !is_hidden_pk;
+    for (uint i = 0; i < m_key_parts && m_integer_key; i++) {
+      m_integer_key = m_pack_info[i].m_integer_pack_func != nullptr &&
+                      m_pack_info[i].m_field_offset >= 0;
+    }
     /* Initialize the memory needed by the stats structure */
     m_stats.m_distinct_keys_per_prefix.resize(get_key_parts());
 
@@ -603,6 +620,12 @@ uint Rdb_key_def::setup(const TABLE &tbl, const Rdb_tbl_def &tbl_def,
     }
     // log_to_file("Rdb_key_def::setup successful setup_next_spatial_index");
 
+    rtn = setup_fulltext_index(tbl_def);
+    if (rtn) {
+      RDB_MUTEX_UNLOCK_CHECK(m_mutex);
+      return rtn;
+    }
+
     /*
       This should be the last member variable set before releasing the mutex
       so that other threads can't see the object partially set up.
@@ -651,6 +674,23 @@ uint Rdb_key_def::extract_ttl_duration(const TABLE &table_arg,
   return HA_EXIT_SUCCESS;
 }
 
+/*
+  Determine if the table stores its fixed-width columns at fixed offsets by
+  parsing the table comment for fixed_offsets=1.
+*/
+bool Rdb_key_def::extract_fixed_offsets(const TABLE &table_arg,
+                                        const Rdb_tbl_def &tbl_def_arg) {
+  std::string table_comment(table_arg.s->comment.str,
+                            table_arg.s->comment.length);
+
+  bool per_part_match_found = false;
+  const std::string value = Rdb_key_def::parse_comment_for_qualifier(
+      table_comment, table_arg, tbl_def_arg, per_part_match_found,
+      RDB_FIXED_OFFSETS_QUALIFIER);
+
+  return !value.empty() && std::strtoull(value.c_str(), nullptr, 0) != 0;
+}
+
 /*
   Determine if the table has TTL enabled by parsing the table comment.
 
@@ -1286,7 +1326,8 @@ uchar *Rdb_key_def::pack_field(
     Field *const field, Rdb_field_packing *pack_info, uchar *tuple,
     uchar *const packed_tuple MY_ATTRIBUTE((__unused__)),
     uchar *const pack_buffer, Rdb_string_writer *const unpack_info,
-    uint *const n_null_fields) const {
+    uint *const n_null_fields,
+    const Rdb_vector_index_assignment *const vector_assignment) const {
   if (field->is_nullable()) {
     assert(is_storage_available(tuple - packed_tuple, 1));
     if (field->is_real_null()) {
@@ -1306,6 +1347,7 @@ uchar *Rdb_key_def::pack_field(
        pack_info->uses_unpack_info());  // and this keypart uses it
   Rdb_pack_field_context pack_ctx(unpack_info);
   pack_ctx.vector_index = m_vector_index.get();
+  pack_ctx.vector_assignment = vector_assignment;
 
   // Set the offset for methods which do not take an offset as an argument
   assert(
@@ -1321,6 +1363,36 @@ uchar *Rdb_key_def::pack_field(
   return tuple;
 }
 
+/**
+  Pack the first n_key_parts of a key whose parts are all integer columns
+  straight from the record, without moving the fields onto it and calling
+  through pack_field() for each part.
+
+  @return
+    The end of the packed tuple
+*/
+uchar *Rdb_key_def::pack_integer_key_parts(const uchar *const record,
+                                           uchar *tuple,
+                                           const uint n_key_parts,
+                                           uint *const n_null_fields) const {
+  assert(m_integer_key);
+  for (uint i = 0; i < n_key_parts; i++) {
+    const Rdb_field_packing &fpi = m_pack_info[i];
+    if (fpi.m_field_is_nullable) {
+      if (record[fpi.m_field_null_offset] & fpi.m_field_null_bit_mask) {
+        /* NULL value. store '\0' so that it sorts before non-NULL values */
+        *tuple++ = 0;
+        if (n_null_fields) (*n_null_fields)++;
+        continue;
+      }
+      *tuple++ = 1;
+    }
+    fpi.m_integer_pack_func(record + fpi.m_field_offset, tuple);
+    tuple += fpi.m_max_image_len;
+  }
+  return tuple;
+}
+
 /**
   Get index columns from the record and pack them into mem-comparable form.
 
@@ -1351,7 +1423,9 @@ uint Rdb_key_def::pack_record(const TABLE *const tbl, uchar *const pack_buffer,
                               const bool should_store_row_debug_checksums,
                               const longlong hidden_pk_id, uint n_key_parts,
                               uint *const n_null_fields,
-                              const char *const ttl_bytes) const {
+                              const char *const ttl_bytes,
+                              const Rdb_vector_index_assignment
+                                  *const vector_assignment) const {
   assert(tbl != nullptr);
   assert(pack_buffer != nullptr);
   assert(record != nullptr);
@@ -1433,6 +1507,12 @@ uint Rdb_key_def::pack_record(const TABLE *const tbl, uchar *const pack_buffer,
   uint curr_bitmap_pos = 0;
   bitmap_init(&covered_bitmap, &covered_bits, MAX_REF_PARTS);
 
+  // Integer key parts need neither unpack info nor the covered bitmap.
+  if (m_integer_key) {
+    tuple = pack_integer_key_parts(record, tuple, n_key_parts, n_null_fields);
+    n_key_parts = 0;
+  }
+
   for (uint i = 0; i < n_key_parts; i++) {
     // Fill hidden pk id into the last key part for secondary keys for tables
     // with no pk
@@ -1455,7 +1535,7 @@ uint Rdb_key_def::pack_record(const TABLE *const tbl, uchar *const pack_buffer,
     // WARNING! Don't return without restoring field->field_ptr() and
     // field->null_ptr
     tuple = pack_field(field, &m_pack_info[i], tuple, packed_tuple, pack_buffer,
-                       unpack_info, n_null_fields);
+                       unpack_info, n_null_fields, vector_assignment);
 
     // If this key part is a prefix of a VARCHAR field, check if it's covered.
     if (m_store_covered_bitmap &&
@@ -1945,14 +2025,33 @@ int Rdb_key_def::skip_variable_space_pad(const Rdb_field_packing *const fpi,
 }
 
 /*
-  Function of type rdb_index_field_unpack_t
+  Packs an integer by converting it to big endian. After that, unsigned
+  integers are naturally in the right order. For signed integers, reverse
+  the sign bit so that positive numbers are bigger than negative numbers,
+  byte-wise.
+*/
+template <int length, bool is_unsigned>
+static void rdb_pack_integer(const uchar *const ptr, uchar *const to) {
+#ifdef WORDS_BIGENDIAN
+  // Reverse the sign bit of signed integers.
+  to[0] = is_unsigned ? ptr[0] : static_cast<char>(ptr[0] ^ 128);
+
+  /* Parameterized length should enable loop unrolling */
+  for (int i = 1; i < length; i++) to[i] = ptr[i];
+#else
+  const int sign_byte = ptr[length - 1];
+  // Reverse the sign bit of signed integers.
+  to[0] = is_unsigned ? sign_byte : static_cast<char>(sign_byte ^ 128);
+
+  /* Parameterized length should enable loop unrolling */
+  for (int i = 1, j = length - 2; i < length; ++i, --j) to[i] = ptr[j];
+#endif
+}
 
-  Packs an integer by converting them to big endian. After that,
-  unsigned integers are naturally in the right order. For signed
-  integer, reverse the sign bit so that positive numbers are
-  bigger than negative numbers, byte-wise.
+/*
+  Function of type rdb_index_field_pack_t, see rdb_pack_integer().
 */
-template <int length>
+template <int length, bool is_unsigned>
 void Rdb_key_def::pack_integer(
     Rdb_field_packing *const fpi MY_ATTRIBUTE((__unused__)), Field *const field,
     uchar *buf MY_ATTRIBUTE((__unused__)), uchar **dst,
@@ -1961,34 +2060,9 @@ void Rdb_key_def::pack_integer(
   assert(dst != nullptr);
   assert(*dst != nullptr);
   assert(length == fpi->m_max_image_len);
-  const uchar *ptr = field->field_ptr();
-  uchar *to = *dst;
-
-#ifdef WORDS_BIGENDIAN
-  {
-    if (fpi->m_field_unsigned_flag) {
-      to[0] = ptr[0];
-    } else {
-      to[0] = static_cast<char>(ptr[0] ^ 128);  // Reverse the sign bit.
-    }
-
-    /* Parameterized length should enable loop unrolling */
-    for (int i = 1; i < length; i++) to[i] = ptr[i];
-  }
-#else
-  {
-    const int sign_byte = ptr[length - 1];
-    if (fpi->m_field_unsigned_flag) {
-      to[0] = sign_byte;
-    } else {
-      to[0] = static_cast<char>(sign_byte ^ 128);  // Reverse the sign bit.
-    }
-
-    /* Parameterized length should enable loop unrolling */
-    for (int i = 1, j = length - 2; i < length; ++i, --j) to[i] = ptr[j];
-  }
-#endif
+  assert(is_unsigned == fpi->m_field_unsigned_flag);
 
+  rdb_pack_integer<length, is_unsigned>(field->field_ptr(), *dst);
   *dst += length;
 }
 
@@ -2016,13 +2090,14 @@ void Rdb_key_def::pack_unsigned(
   *dst += length;
 }
 
-template <int length>
+template <int length, bool is_unsigned>
 int Rdb_key_def::unpack_integer(
     Rdb_field_packing *const fpi MY_ATTRIBUTE((__unused__)),
     Rdb_unpack_func_context *const, uchar *const to,
     Rdb_string_reader *const reader,
     Rdb_string_reader *const unp_reader MY_ATTRIBUTE((__unused__))) {
   assert(length == fpi->m_max_image_len);
+  assert(is_unsigned == fpi->m_field_unsigned_flag);
 
   const uchar *from;
   if (!(from = (const uchar *)reader->read(length))) {
@@ -2031,7 +2106,7 @@ int Rdb_key_def::unpack_integer(
 
 #ifdef WORDS_BIGENDIAN
   {
-    if (fpi->m_field_unsigned_flag) {
+    if (is_unsigned) {
       to[0] = from[0];
     } else {
       to[0] = static_cast<char>(from[0] ^ 128);  // Reverse the sign bit.
@@ -2042,7 +2117,7 @@ int Rdb_key_def::unpack_integer(
 #else
   {
     const int sign_byte = from[0];
-    if (fpi->m_field_unsigned_flag) {
+    if (is_unsigned) {
       to[length - 1] = sign_byte;
     } else {
       to[length - 1] =
@@ -2607,6 +2682,73 @@ const size_t xfrm_len = charset->coll->strnxfrm(
 pack_variable_format(buf, xfrm_len, dst);
 }
 
+bool Rdb_key_def::next_spatial_entry_point(const rocksdb::Slice &key,
+                                           const rocksdb::Slice &value,
+                                           double *lon, double *lat) const {
+  assert(is_next_spatial_index());
+  const uchar *image = reinterpret_cast<const uchar *>(key.data());
+  if (m_next_spatial_index_config.type() ==
+      NEXT_SPATIAL_INDEX_TYPE::HILBERT_INDEX) {
+    return rdb_spatial_cell_entry_point(value, lon, lat);
+  }
+
+  // The geometry is stored with pack_geom, in the variable length format.
+  // Gather the pieces until the last one, a point takes 4 of them.
+  uchar geometry[RDB_WKB_POINT_SIZE];
+  size_t length = 0;
+  const uchar *ptr = image + INDEX_NUMBER_SIZE;
+  const uchar *const end = image + key.size();
+  for (;;) {
+    if (ptr + RDB_ESCAPE_LENGTH > end) return false;
+    const uchar flag = ptr[RDB_ESCAPE_LENGTH - 1];
+    const size_t used =
+        flag == RDB_ESCAPE_LENGTH ? RDB_ESCAPE_LENGTH - 1 : flag;
+    if (used > RDB_ESCAPE_LENGTH - 1 || length + used > sizeof(geometry)) {
+      return false;
+    }
+    memcpy(geometry + length, ptr, used);
+    length += used;
+    ptr += RDB_ESCAPE_LENGTH;
+    if (flag != RDB_ESCAPE_LENGTH) break;
+  }
+  // srid, little endian byte order and the point type, then lon and lat
+  if (length != RDB_WKB_POINT_SIZE || geometry[4] != 1) return false;
+  uint32_t wkb_type = 0;
+  memcpy(&wkb_type, geometry + 5, sizeof(wkb_type));
+  if (wkb_type != 1) return false;
+  memcpy(lon, geometry + 9, sizeof(double));
+  memcpy(lat, geometry + 17, sizeof(double));
+  return true;
+}
+
+/*
+  Function of type rdb_index_field_pack_t for the geometry of a hilbert next
+  spatial index: the cell of the point on the hilbert curve, so that near
+  points sort together. The point itself goes to the value, see
+  make_unpack_next_spatial_point.
+*/
+void Rdb_key_def::pack_next_spatial_cell(
+    Rdb_field_packing *const fpi MY_ATTRIBUTE((__unused__)),
+    Field *const field, uchar *const buf MY_ATTRIBUTE((__unused__)),
+    uchar **dst,
+    Rdb_pack_field_context *const pack_ctx MY_ATTRIBUTE((__unused__))) {
+  rdb_spatial_cell_image(get_data_value(field), field->data_length(), *dst);
+  *dst += RDB_NEXT_SPATIAL_CELL_IMAGE_SIZE;
+}
+
+/*
+  Function of type rdb_make_unpack_info_t for the geometry of a hilbert next
+  spatial index: the lon and lat of the point. Keeping them out of the key
+  lets a point that moves within its cell overwrite its entry.
+*/
+void Rdb_key_def::make_unpack_next_spatial_point(
+    const Rdb_field_packing *const fpi MY_ATTRIBUTE((__unused__)),
+    const Field *const field, Rdb_pack_field_context *const pack_ctx) {
+  uchar point[RDB_NEXT_SPATIAL_CELL_POINT_SIZE];
+  rdb_spatial_cell_point(get_data_value(field), field->data_length(), point);
+  pack_ctx->writer->write(point, sizeof(point));
+}
+
 /*
   Function of type rdb_index_field_unpack_t.
   For UTF-8, we need to convert 2- or 3-byte wide-character entities back into
@@ -2742,36 +2884,64 @@ void Rdb_key_def::pack_with_varlength_encoding(
 }
 
 /**
-  Pack a vector index field. The vector field is stored as a list id.
-*/
-static void pack_vector(Rdb_field_packing *const fpi [[maybe_unused]],
-                        Field *const field, uchar *buf [[maybe_unused]],
-                        uchar **dst, Rdb_pack_field_context *const pack_ctx) {
-  assert(dst != nullptr);
-  assert(*dst != nullptr);
-  assert(pack_ctx->vector_index);
+  Parse the vector stored in a vector index field.
 
-  // when we reach this point, the field should store a valid vector.
-  // it is impossible to have invalid data here.
+  @return true on failure
+*/
+static bool parse_vector_field(Field *const field, Fb_vector &parsed_vector) {
   Field_blob *field_blob = down_cast<Field_blob *>(field);
   if (field_blob == nullptr) {
     LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
                     "unexpected field type for vector index");
-    assert(false);
+    return true;
   }
   Field_json *field_json = dynamic_cast<Field_json *>(field_blob);
-  Fb_vector parsed_vector;
   if (field_json == nullptr) {
     parse_fb_vector_from_blob(field, parsed_vector);
   } else {
     Json_wrapper wrapper;
     field_json->val_json(&wrapper);
-    if (parse_fb_vector_from_json(wrapper, parsed_vector.get_data_ref())) {
+    if (field->m_fb_vector_multi
+            ? parse_fb_multi_vector_from_json(wrapper,
+                                              field->m_fb_vector_dimension,
+                                              parsed_vector.get_data_ref())
+            : parse_fb_vector_from_json(wrapper,
+                                        parsed_vector.get_data_ref())) {
       LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
                       "failed to parse vector for vector index");
-      assert(false);
+      return true;
     }
   }
+  return false;
+}
+
+/**
+  Pack a vector index field. The vector field is stored as a list id.
+*/
+static void pack_vector(Rdb_field_packing *const fpi [[maybe_unused]],
+                        Field *const field, uchar *buf [[maybe_unused]],
+                        uchar **dst, Rdb_pack_field_context *const pack_ctx) {
+  assert(dst != nullptr);
+  assert(*dst != nullptr);
+  assert(pack_ctx->vector_index);
+
+  // the vector was already assigned by a batch, see Rdb_key_def::read_vector.
+  // the entries of a multi-vector index always are
+  assert(pack_ctx->vector_assignment ||
+         !pack_ctx->vector_index->get_config().multi());
+  if (pack_ctx->vector_assignment) {
+    pack_ctx->vector_codes = pack_ctx->vector_assignment->m_codes;
+    rdb_netbuf_store_uint64(*dst, pack_ctx->vector_assignment->m_list_id);
+    *dst += sizeof(pack_ctx->vector_assignment->m_list_id);
+    return;
+  }
+
+  // when we reach this point, the field should store a valid vector.
+  // it is impossible to have invalid data here.
+  Fb_vector parsed_vector;
+  if (parse_vector_field(field, parsed_vector)) {
+    assert(false);
+  }
 
   auto dimension = pack_ctx->vector_index->dimension();
   if (parsed_vector.get_dimension() != dimension) {
@@ -2787,6 +2957,11 @@ static void pack_vector(Rdb_field_packing *const fpi [[maybe_unused]],
       return ;
   }
 
+  // cosine indexes store unit vectors so searches are inner products
+  if (pack_ctx->vector_index->get_config().normalized()) {
+    fb_vector_normalize_l2(parsed_vector.get_data(), dimension);
+  }
+
   Rdb_vector_index_assignment assignment;
   pack_ctx->vector_index->assign_vector(parsed_vector.get_data_view(),
                                         assignment);
@@ -2795,6 +2970,117 @@ static void pack_vector(Rdb_field_packing *const fpi [[maybe_unused]],
   *dst += sizeof(assignment.m_list_id); 
 }
 
+/**
+  Read the vector of a vector index key from a record, normalized the way
+  pack_vector would store it, or an empty vector when it is NULL. Lets
+  callers assign the vectors of many rows at once and hand the assignments
+  to pack_record.
+
+  @return
+    HA_EXIT_SUCCESS  OK
+    other            HA_ERR error code
+*/
+int Rdb_key_def::read_vector(const TABLE *const tbl, const uchar *const record,
+                             std::vector<float> *const vector) const {
+  assert(is_vector_index());
+  for (uint i = 0; i < m_key_parts; i++) {
+    if (m_pack_info[i].m_pack_func != pack_vector) continue;
+
+    Field *const field = m_pack_info[i].get_field_in_table(tbl);
+    const uint field_offset = field->field_ptr() - tbl->record[0];
+    const uint null_offset = field->null_offset(tbl->record[0]);
+    const bool maybe_null = field->is_nullable();
+    field->move_field(
+        const_cast<uchar *>(record) + field_offset,
+        maybe_null ? const_cast<uchar *>(record) + null_offset : nullptr,
+        field->null_bit);
+    Fb_vector parsed_vector;
+    // a NULL vector is not assigned to any list
+    const bool is_null = field->is_real_null();
+    const bool failed = !is_null && parse_vector_field(field, parsed_vector);
+    field->move_field(tbl->record[0] + field_offset,
+                      maybe_null ? tbl->record[0] + null_offset : nullptr,
+                      field->null_bit);
+    if (failed) {
+      return HA_EXIT_FAILURE;
+    }
+    if (is_null) {
+      vector->clear();
+      return HA_EXIT_SUCCESS;
+    }
+
+    const auto dimension = m_vector_index->dimension();
+    const bool multi = m_vector_index->get_config().multi();
+    const std::size_t size = parsed_vector.get_dimension();
+    if (multi ? size == 0 || size % dimension : size != dimension) {
+      LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                      "vector dimension does not match index dimension");
+      return HA_EXIT_FAILURE;
+    }
+    const float *data = parsed_vector.get_data_view();
+    vector->assign(data, data + size);
+    if (m_vector_index->get_config().normalized()) {
+      fb_vector_normalize_l2(vector->data(), dimension);
+    }
+    return HA_EXIT_SUCCESS;
+  }
+  return HA_EXIT_FAILURE;
+}
+
+int Rdb_key_def::read_shared_entry(const TABLE *const tbl,
+                                   const uchar *const record,
+                                   std::string *const image) const {
+  image->clear();
+  if (is_vector_index()) {
+    // an LSMIDX index stores no entries, a sparse index stores postings
+    if (m_vector_index->get_config().type() == FB_VECTOR_INDEX_TYPE::LSMIDX ||
+        is_sparse_vector_index()) {
+      return HA_EXIT_SUCCESS;
+    }
+    std::vector<float> vector;
+    const int rc = read_vector(tbl, record, &vector);
+    if (rc != HA_EXIT_SUCCESS || vector.empty()) {
+      return rc;
+    }
+    Rdb_vector_index_assignment assignment;
+    m_vector_index->assign_vector(vector.data(), assignment);
+    uchar list_id[sizeof(assignment.m_list_id)];
+    rdb_netbuf_store_uint64(list_id, assignment.m_list_id);
+    image->assign(reinterpret_cast<const char *>(list_id), sizeof(list_id));
+    return HA_EXIT_SUCCESS;
+  }
+
+  if (!overwrites_entries()) {
+    return HA_EXIT_SUCCESS;
+  }
+  for (uint i = 0; i < m_key_parts; i++) {
+    if (m_pack_info[i].m_pack_func != pack_next_spatial_cell) continue;
+
+    Field *const field = m_pack_info[i].get_field_in_table(tbl);
+    const uint field_offset = field->field_ptr() - tbl->record[0];
+    const uint null_offset = field->null_offset(tbl->record[0]);
+    const bool maybe_null = field->is_nullable();
+    field->move_field(
+        const_cast<uchar *>(record) + field_offset,
+        maybe_null ? const_cast<uchar *>(record) + null_offset : nullptr,
+        field->null_bit);
+    uchar cell[RDB_NEXT_SPATIAL_CELL_IMAGE_SIZE];
+    const bool is_null = field->is_real_null();
+    if (!is_null) {
+      rdb_spatial_cell_image(get_data_value(field), field->data_length(),
+                             cell);
+    }
+    field->move_field(tbl->record[0] + field_offset,
+                      maybe_null ? tbl->record[0] + null_offset : nullptr,
+                      field->null_bit);
+    if (!is_null) {
+      image->assign(reinterpret_cast<const char *>(cell), sizeof(cell));
+    }
+    break;
+  }
+  return HA_EXIT_SUCCESS;
+}
+
 /*
   Compare the string suffix with a hypothetical infinite string of
   spaces. It could be that the first difference is beyond the end of
@@ -3699,6 +3985,29 @@ uint Rdb_key_def::setup_vector_index(const TABLE &tbl,
                              m_vector_index);
 }
 
+uint Rdb_key_def::setup_fulltext_index(const Rdb_tbl_def &tbl_def) const {
+  if (!m_is_fulltext) {
+    return HA_EXIT_SUCCESS;
+  }
+
+  // the sql layer never makes a FULLTEXT primary key
+  if (is_primary_key() || tbl_def.get_table_type() != TABLE_TYPE::USER_TABLE) {
+    LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                    "fulltext index is only supported as secondary key of "
+                    "user tables");
+    assert(false);
+    return HA_ERR_UNSUPPORTED;
+  }
+  // the postings of a term are read by seeking forward to their prefix
+  if (m_index_flags_bitmap != 0 || m_is_reverse_cf) {
+    LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
+                    "fulltext index is not supported on ttl tables or in "
+                    "reverse column families");
+    return HA_ERR_UNSUPPORTED;
+  }
+  return HA_EXIT_SUCCESS;
+}
+
 uint Rdb_key_def::setup_next_spatial_index(const TABLE &tbl,
     const Rdb_tbl_def &tbl_def,
     Rdb_cmd_srv_helper &cmd_srv_helper) {
@@ -3729,6 +4038,15 @@ uint Rdb_key_def::setup_next_spatial_index(const TABLE &tbl,
     return HA_ERR_UNSUPPORTED;
   }
   KEY *key_info = &tbl.key_info[m_keyno];
+  // the entries of a hilbert index are keyed by the cell of the point, a
+  // null geometry has none
+  if (m_next_spatial_index_config.type() ==
+          NEXT_SPATIAL_INDEX_TYPE::HILBERT_INDEX &&
+      key_info->key_part[0].field->is_nullable()) {
+    LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
+                    "hilbert next spatial index needs a not null geometry");
+    return HA_ERR_UNSUPPORTED;
+  }
   // if (key_info->actual_key_parts != 1) {
   //   log_to_file(std::to_string(key_info->actual_key_parts), "/home/jingyi/Desktop/myrocks-spatial-x-db-runtime/usr/local/mysql/data/next_debug_log");
   //   LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
@@ -3943,6 +4261,20 @@ static int get_segment_size_from_collation(const CHARSET_INFO *const cs) {
   return ret;
 }
 
+template <int length>
+void Rdb_field_packing::setup_integer() {
+  if (m_field_unsigned_flag) {
+    m_pack_func = Rdb_key_def::pack_integer<length, true>;
+    m_unpack_func = Rdb_key_def::unpack_integer<length, true>;
+    m_integer_pack_func = rdb_pack_integer<length, true>;
+  } else {
+    m_pack_func = Rdb_key_def::pack_integer<length, false>;
+    m_unpack_func = Rdb_key_def::unpack_integer<length, false>;
+    m_integer_pack_func = rdb_pack_integer<length, false>;
+  }
+  m_covered = Rdb_key_def::KEY_COVERED;
+}
+
 /*
   @brief
     Setup packing of index field into its mem-comparable form
@@ -4002,38 +4334,29 @@ bool Rdb_field_packing::setup(const Rdb_key_def *const key_descr,
 
   m_skip_func = Rdb_key_def::skip_max_length;
   m_pack_func = nullptr;
+  m_integer_pack_func = nullptr;
 
   m_covered = Rdb_key_def::KEY_NOT_COVERED;
 
   switch (type) {
     case MYSQL_TYPE_LONGLONG:
-      m_pack_func = Rdb_key_def::pack_integer<8>;
-      m_unpack_func = Rdb_key_def::unpack_integer<8>;
-      m_covered = Rdb_key_def::KEY_COVERED;
+      setup_integer<8>();
       return true;
 
     case MYSQL_TYPE_LONG:
-      m_pack_func = Rdb_key_def::pack_integer<4>;
-      m_unpack_func = Rdb_key_def::unpack_integer<4>;
-      m_covered = Rdb_key_def::KEY_COVERED;
+      setup_integer<4>();
       return true;
 
     case MYSQL_TYPE_INT24:
-      m_pack_func = Rdb_key_def::pack_integer<3>;
-      m_unpack_func = Rdb_key_def::unpack_integer<3>;
-      m_covered = Rdb_key_def::KEY_COVERED;
+      setup_integer<3>();
       return true;
 
     case MYSQL_TYPE_SHORT:
-      m_pack_func = Rdb_key_def::pack_integer<2>;
-      m_unpack_func = Rdb_key_def::unpack_integer<2>;
-      m_covered = Rdb_key_def::KEY_COVERED;
+      setup_integer<2>();
       return true;
 
     case MYSQL_TYPE_TINY:
-      m_pack_func = Rdb_key_def::pack_integer<1>;
-      m_unpack_func = Rdb_key_def::unpack_integer<1>;
-      m_covered = Rdb_key_def::KEY_COVERED;
+      setup_integer<1>();
       return true;
 
     case MYSQL_TYPE_DOUBLE:
@@ -4161,6 +4484,13 @@ bool Rdb_field_packing::setup(const Rdb_key_def *const key_descr,
           !"Unexpected MYSQL_TYPE_GEOMETRY seen in packing for none next spatial index");
         return false;
       }
+      if (key_descr->get_next_spatial_index_config().type() ==
+          NEXT_SPATIAL_INDEX_TYPE::HILBERT_INDEX) {
+        m_pack_func = Rdb_key_def::pack_next_spatial_cell;
+        m_make_unpack_info_func = Rdb_key_def::make_unpack_next_spatial_point;
+        m_max_image_len = RDB_NEXT_SPATIAL_CELL_IMAGE_SIZE;
+        return false;
+      }
       m_pack_func = Rdb_key_def::pack_geom;
       m_max_image_len = 8;
       // m_pack_func = Rdb_key_def::pack_with_varlength_encoding;
@@ -4480,8 +4810,8 @@ bool Rdb_tbl_def::put_dict(Rdb_dict_manager *const dict,
 
 // Length that each index flag takes inside the record.
 // Each index in the array maps to the enum INDEX_FLAG
-static const std::array<uint, 1> index_flag_lengths = {
-    {ROCKSDB_SIZEOF_TTL_RECORD}};
+static const std::array<uint, 2> index_flag_lengths = {
+    {ROCKSDB_SIZEOF_TTL_RECORD, 0}};
 
 bool Rdb_key_def::has_index_flag(uint32 index_flags, enum INDEX_FLAG flag) {
   return flag & index_flags;
@@ -4571,6 +4901,7 @@ GL_INDEX_ID Rdb_tbl_def::get_autoincr_gl_index_id() {
 
 void Rdb_ddl_manager::erase_index_num(const GL_INDEX_ID &gl_index_id) {
   m_index_num_to_keydef.erase(gl_index_id);
+  invalidate_keydef_snapshot();
 }
 
 void Rdb_ddl_manager::add_uncommitted_keydefs(
@@ -4579,6 +4910,7 @@ void Rdb_ddl_manager::add_uncommitted_keydefs(
   for (const auto &index : indexes) {
     m_index_num_to_uncommitted_keydef[index->get_gl_index_id()] = index;
   }
+  invalidate_keydef_snapshot();
   mysql_rwlock_unlock(&m_rwlock);
 }
 
@@ -4588,6 +4920,7 @@ void Rdb_ddl_manager::remove_uncommitted_keydefs(
   for (const auto &index : indexes) {
     m_index_num_to_uncommitted_keydef.erase(index->get_gl_index_id());
   }
+  invalidate_keydef_snapshot();
   mysql_rwlock_unlock(&m_rwlock);
 }
 
@@ -4830,7 +5163,16 @@ bool Rdb_ddl_manager::populate(uint32_t validate_tables, bool lock) {
 
   uint system_cf_id = m_cf_manager->get_cf(DEFAULT_SYSTEM_CF_NAME)->GetID();
 
-  for (it->Seek(ddl_entry_slice); it->Valid(); it->Next()) {
+  // The snapshot stands in for the DDL entries, an unpositioned iterator
+  // is not valid and the loop below reads nothing.
+  const bool from_snapshot =
+      m_use_snapshot && !load_snapshot(max_dd_index_id_in_dict,
+                                       max_index_id_in_dict, system_cf_id,
+                                       lock, &i);
+  m_use_snapshot = false;
+  if (!from_snapshot) it->Seek(ddl_entry_slice);
+
+  for (; it->Valid(); it->Next()) {
     const uchar *ptr;
     const uchar *ptr_end;
     const rocksdb::Slice key = it->key();
@@ -5008,16 +5350,22 @@ bool Rdb_ddl_manager::populate(uint32_t validate_tables, bool lock) {
   delete it;
   // NO_LINT_DEBUG
   LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
-                  "RocksDB: Table_store: loaded DDL data for %d tables", i);
+                  "RocksDB: Table_store: loaded DDL data for %d tables%s", i,
+                  from_snapshot ? " from snapshot" : "");
 
   return false;
 }
 
 bool Rdb_ddl_manager::init(Rdb_dict_manager_selector *const dict_arg,
                            Rdb_cf_manager *const cf_manager,
-                           const uint32_t validate_tables) {
+                           const uint32_t validate_tables,
+                           const std::string &snapshot_path,
+                           const rocksdb::SequenceNumber open_seq) {
   m_dict = dict_arg;
   m_cf_manager = cf_manager;
+  m_snapshot_path = snapshot_path;
+  m_open_seq = open_seq;
+  m_use_snapshot = !snapshot_path.empty();
   mysql_rwlock_init(0, &m_rwlock);
 
   if (populate(validate_tables)) return true;
@@ -5026,6 +5374,218 @@ bool Rdb_ddl_manager::init(Rdb_dict_manager_selector *const dict_arg,
   return false;
 }
 
+namespace {
+/* "RDDS", followed by the format version */
+constexpr uint32 RDB_DDL_SNAPSHOT_MAGIC = 0x52444453;
+constexpr uint16 RDB_DDL_SNAPSHOT_VERSION = 1;
+}  // namespace
+
+/*
+  The snapshot is the sequence number and identity of the DB, the table
+  definitions as populate() would build them, and a checksum of all that:
+
+    magic, version, sequence number, identity length, identity,
+    table count, then for every table:
+      name length, name, key count, then for every key:
+        cf id, index id, dict version, index type, kv version, cf flags,
+        index flags, ttl duration, stats length, stats
+    checksum
+*/
+void Rdb_ddl_manager::write_snapshot() const {
+  if (m_snapshot_path.empty()) return;
+
+  rocksdb::DB *const rdb = rdb_get_rocksdb_db();
+  std::string db_identity;
+  if (!rdb->GetDbIdentity(db_identity).ok()) return;
+
+  Rdb_string_writer writer;
+  writer.write_uint32(RDB_DDL_SNAPSHOT_MAGIC);
+  writer.write_uint16(RDB_DDL_SNAPSHOT_VERSION);
+
+  mysql_rwlock_rdlock(&m_rwlock);
+  writer.write_uint64(rdb->GetLatestSequenceNumber());
+  writer.write_uint32(db_identity.size());
+  writer.write_string(db_identity);
+
+  uint32 count = 0;
+  for (const auto &it : m_ddl_map) {
+    if (it.second->get_table_type() == TABLE_TYPE::USER_TABLE) count++;
+  }
+  writer.write_uint32(count);
+
+  for (const auto &it : m_ddl_map) {
+    const Rdb_tbl_def *const tdef = it.second;
+    if (tdef->get_table_type() != TABLE_TYPE::USER_TABLE) continue;
+
+    writer.write_uint32(tdef->full_tablename().size());
+    writer.write_string(tdef->full_tablename());
+    writer.write_uint32(tdef->m_key_count);
+    for (uint keyno = 0; keyno < tdef->m_key_count; keyno++) {
+      const Rdb_key_def &kd = *tdef->m_key_descr_arr[keyno];
+      const uint32 cf_flags =
+          (kd.m_is_reverse_cf ? Rdb_key_def::REVERSE_CF_FLAG : 0) |
+          (kd.m_is_per_partition_cf ? Rdb_key_def::PER_PARTITION_CF_FLAG : 0);
+      const std::string stats = Rdb_index_stats::materialize({kd.m_stats});
+
+      writer.write_uint32(kd.get_cf().GetID());
+      writer.write_uint32(kd.get_index_number());
+      writer.write_uint16(kd.m_index_dict_version);
+      writer.write_uint8(kd.m_index_type);
+      writer.write_uint16(kd.m_kv_format_version);
+      writer.write_uint32(cf_flags);
+      writer.write_uint32(kd.m_index_flags_bitmap);
+      writer.write_uint64(kd.m_ttl_duration);
+      writer.write_uint32(stats.size());
+      writer.write_string(stats);
+    }
+  }
+  mysql_rwlock_unlock(&m_rwlock);
+
+  writer.write_uint32(my_checksum(0, writer.ptr(), writer.get_current_pos()));
+
+  const std::string tmp_path = m_snapshot_path + ".tmp";
+  const File fd = my_open(tmp_path.c_str(), O_CREAT | O_TRUNC | O_WRONLY,
+                          MYF(MY_WME));
+  if (fd < 0) return;
+  const bool failed = my_write(fd, writer.ptr(), writer.get_current_pos(),
+                               MYF(MY_WME | MY_NABP)) ||
+                      my_sync(fd, MYF(MY_WME));
+  my_close(fd, MYF(MY_WME));
+  if (failed || my_rename(tmp_path.c_str(), m_snapshot_path.c_str(),
+                          MYF(MY_WME))) {
+    my_delete(tmp_path.c_str(), MYF(0));
+    return;
+  }
+
+  // NO_LINT_DEBUG
+  LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
+                  "RocksDB: Table_store: wrote snapshot of %u tables", count);
+}
+
+bool Rdb_ddl_manager::load_snapshot(uint max_dd_index_id_in_dict,
+                                    uint max_index_id_in_dict,
+                                    uint system_cf_id, bool lock,
+                                    int *count) {
+  const int fd = open(m_snapshot_path.c_str(), O_RDONLY);
+  if (fd < 0) return true;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0 || st.st_size > UINT_MAX) {
+    close(fd);
+    return true;
+  }
+  const size_t size = st.st_size;
+  void *const map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) return true;
+
+  const uchar *const data = static_cast<const uchar *>(map);
+  std::vector<Rdb_tbl_def *> tdefs;
+  const auto parse = [&]() -> bool {
+    if (size < sizeof(uint32)) return true;
+    Rdb_string_reader checksum_reader(data + size - sizeof(uint32),
+                                      sizeof(uint32));
+    uint32 checksum;
+    if (checksum_reader.read_uint32(&checksum) ||
+        checksum != my_checksum(0, data, size - sizeof(uint32)))
+      return true;
+
+    std::string db_identity;
+    if (!rdb_get_rocksdb_db()->GetDbIdentity(db_identity).ok()) return true;
+
+    Rdb_string_reader reader(data, size - sizeof(uint32));
+    uint32 magic, identity_len, table_count;
+    uint version;
+    uint64 seq;
+    const char *identity;
+    if (reader.read_uint32(&magic) || magic != RDB_DDL_SNAPSHOT_MAGIC ||
+        reader.read_uint16(&version) ||
+        version != RDB_DDL_SNAPSHOT_VERSION || reader.read_uint64(&seq) ||
+        seq != m_open_seq || reader.read_uint32(&identity_len) ||
+        !(identity = reader.read(identity_len)) ||
+        db_identity != std::string(identity, identity_len) ||
+        reader.read_uint32(&table_count))
+      return true;
+
+    for (uint32 t = 0; t < table_count; t++) {
+      uint32 name_len, key_count;
+      const char *name;
+      if (reader.read_uint32(&name_len) || !(name = reader.read(name_len)) ||
+          reader.read_uint32(&key_count) || key_count == 0 ||
+          key_count > MAX_INDEXES + 1)
+        return true;
+
+      Rdb_tbl_def *const tdef = new Rdb_tbl_def(
+          std::string(name, name_len), TABLE_TYPE::USER_TABLE);
+      tdefs.push_back(tdef);
+      tdef->m_key_count = key_count;
+      tdef->m_pk_index = MAX_INDEXES;
+      tdef->m_key_descr_arr = new std::shared_ptr<Rdb_key_def>[key_count];
+
+      for (uint keyno = 0; keyno < key_count; keyno++) {
+        uint32 cf_id, index_id, cf_flags, index_flags, stats_len;
+        uint dict_version, index_type, kv_version;
+        uint64 ttl_duration;
+        const char *stats_data;
+        if (reader.read_uint32(&cf_id) || reader.read_uint32(&index_id) ||
+            reader.read_uint16(&dict_version) ||
+            reader.read_uint8(&index_type) ||
+            reader.read_uint16(&kv_version) ||
+            reader.read_uint32(&cf_flags) ||
+            reader.read_uint32(&index_flags) ||
+            reader.read_uint64(&ttl_duration) ||
+            reader.read_uint32(&stats_len) ||
+            !(stats_data = reader.read(stats_len)))
+          return true;
+
+        const uint cur_max_index_id = cf_id == system_cf_id
+                                          ? max_dd_index_id_in_dict
+                                          : max_index_id_in_dict;
+        std::vector<Rdb_index_stats> stats;
+        if (cur_max_index_id < index_id ||
+            Rdb_index_stats::unmaterialize(
+                std::string(stats_data, stats_len), &stats) ||
+            stats.size() != 1)
+          return true;
+
+        std::shared_ptr<rocksdb::ColumnFamilyHandle> cfh =
+            m_cf_manager->get_cf(cf_id);
+        if (!cfh) return true;
+
+        const uint32 ttl_rec_offset =
+            Rdb_key_def::has_index_flag(index_flags, Rdb_key_def::TTL_FLAG)
+                ? Rdb_key_def::calculate_index_flag_offset(
+                      index_flags, Rdb_key_def::TTL_FLAG)
+                : UINT_MAX;
+        tdef->m_key_descr_arr[keyno] = std::make_shared<Rdb_key_def>(
+            index_id, keyno, cfh, dict_version, index_type, kv_version,
+            cf_flags & Rdb_key_def::REVERSE_CF_FLAG,
+            cf_flags & Rdb_key_def::PER_PARTITION_CF_FLAG, "", stats[0],
+            index_flags, ttl_rec_offset, ttl_duration);
+        if (index_type == Rdb_key_def::INDEX_TYPE_PRIMARY) {
+          tdef->m_pk_index = keyno;
+        }
+      }
+      tdef->m_tbl_stats.set(tdef->m_key_descr_arr[0]->m_stats.m_rows, 0, 0);
+    }
+    return reader.remaining_bytes() != 0;
+  };
+  const bool failed = parse();
+  munmap(map, size);
+
+  if (failed) {
+    for (Rdb_tbl_def *const tdef : tdefs) delete tdef;
+    // NO_LINT_DEBUG
+    LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
+                    "RocksDB: Table_store: snapshot is stale or invalid, "
+                    "reading the data dictionary");
+    return true;
+  }
+
+  for (Rdb_tbl_def *const tdef : tdefs) put(tdef, lock);
+  *count = tdefs.size();
+  return false;
+}
+
 Rdb_tbl_def *Rdb_ddl_manager::find(const std::string &table_name,
                                    bool lock) const {
   if (lock) {
@@ -5091,39 +5651,82 @@ int Rdb_ddl_manager::find_table_stats(const std::string &table_name,
   return HA_EXIT_SUCCESS;
 }
 
-// this is a safe version of the find() function below.  It acquires a read
-// lock on m_rwlock to make sure the Rdb_key_def is not discarded while we
-// are finding it.  Copying it into 'ret' increments the count making sure
-// that the object will not be discarded until we are finished with it.
+// this is a safe version of the find() function below.  It looks the index
+// up in the snapshot of the mappings while registered as its reader, which
+// makes sure the Rdb_key_def is not discarded while we are finding it.
+// Copying it into 'ret' increments the count making sure that the object
+// will not be discarded until we are finished with it.  A read lock on
+// m_rwlock is only taken to rebuild the snapshot after DDL dropped it.
 std::shared_ptr<const Rdb_key_def> Rdb_ddl_manager::safe_find(
     GL_INDEX_ID gl_index_id) const {
   std::shared_ptr<const Rdb_key_def> ret(nullptr);
+  const auto lookup = [&](const Keydef_snapshot &snapshot) {
+    const auto it = snapshot.find(gl_index_id);
+    if (it != snapshot.end() && it->second->max_storage_fmt_length() != 0) {
+      ret = it->second;
+    }
+  };
+
+  const size_t slot =
+      RDB_INDEXER<uint64_t, KEYDEF_READER_SLOTS>().get_rnd_index() %
+      KEYDEF_READER_SLOTS;
+  auto &readers =
+      m_keydef_readers[(m_keydef_epoch.load() & 1) * KEYDEF_READER_SLOTS + slot]
+          .m_count;
+  readers.fetch_add(1);
+  const Keydef_snapshot *snapshot = m_keydef_snapshot.load();
+  if (snapshot != nullptr) lookup(*snapshot);
+  readers.fetch_sub(1);
+  if (snapshot != nullptr) return ret;
 
   mysql_rwlock_rdlock(&m_rwlock);
+  lookup(*get_keydef_snapshot());
+  mysql_rwlock_unlock(&m_rwlock);
 
-  const auto it = m_index_num_to_keydef.find(gl_index_id);
-  if (it != m_index_num_to_keydef.end()) {
-    const auto table_def = find(it->second.first, false);
-    if (table_def && it->second.second < table_def->m_key_count) {
-      const auto &kd = table_def->m_key_descr_arr[it->second.second];
-      if (kd->max_storage_fmt_length() != 0) {
-        ret = kd;
-      }
-    }
-  } else {
-    const auto uncommitted_it =
-        m_index_num_to_uncommitted_keydef.find(gl_index_id);
-    if (uncommitted_it != m_index_num_to_uncommitted_keydef.end()) {
-      const auto &kd = uncommitted_it->second;
-      if (kd->max_storage_fmt_length() != 0) {
-        ret = kd;
+  return ret;
+}
+
+// this method assumes at least read-only lock on m_rwlock
+const Rdb_ddl_manager::Keydef_snapshot *Rdb_ddl_manager::get_keydef_snapshot()
+    const {
+  const std::lock_guard<std::mutex> guard(m_keydef_snapshot_mutex);
+  const Keydef_snapshot *snapshot = m_keydef_snapshot.load();
+  if (snapshot == nullptr) {
+    auto new_snapshot = new Keydef_snapshot();
+    for (const auto &it : m_index_num_to_keydef) {
+      const auto &kd = find(it.first);
+      if (kd) new_snapshot->emplace(it.first, kd);
+    }
+    // As in find(), uncommitted key definitions are only looked at for
+    // index ids which m_index_num_to_keydef doesn't know about.
+    for (const auto &it : m_index_num_to_uncommitted_keydef) {
+      if (m_index_num_to_keydef.count(it.first) == 0) {
+        new_snapshot->emplace(it.first, it.second);
       }
     }
+    snapshot = new_snapshot;
+    m_keydef_snapshot.store(snapshot);
   }
+  return snapshot;
+}
 
-  mysql_rwlock_unlock(&m_rwlock);
+// this method assumes write lock on m_rwlock
+void Rdb_ddl_manager::invalidate_keydef_snapshot() {
+  const Keydef_snapshot *snapshot = m_keydef_snapshot.exchange(nullptr);
+  if (snapshot == nullptr) return;
 
-  return ret;
+  // Readers which might still use the snapshot have registered with the
+  // counters of either epoch. Flip the epoch twice so that new readers
+  // move away from the counters being waited for.
+  for (int i = 0; i < 2; i++) {
+    const uint64_t epoch = m_keydef_epoch.fetch_add(1);
+    const auto first = m_keydef_readers.begin() +
+                       (epoch & 1) * KEYDEF_READER_SLOTS;
+    for (auto it = first; it != first + KEYDEF_READER_SLOTS; ++it) {
+      while (it->m_count.load() != 0) std::this_thread::yield();
+    }
+  }
+  delete snapshot;
 }
 
 // this method assumes at least read-only lock on m_rwlock
@@ -5324,6 +5927,7 @@ int Rdb_ddl_manager::put(Rdb_tbl_def *const tbl, const bool lock) {
         std::make_pair(dbname_tablename, keyno);
   }
   tbl->check_and_set_read_free_rpl_table();
+  invalidate_keydef_snapshot();
 
   if (lock) mysql_rwlock_unlock(&m_rwlock);
   return 0;
@@ -5348,6 +5952,7 @@ void Rdb_ddl_manager::remove(Rdb_tbl_def *const tbl,
     delete it->second;
 
     m_ddl_map.erase(it);
+    invalidate_keydef_snapshot();
   }
 
   if (lock) mysql_rwlock_unlock(&m_rwlock);
@@ -5407,6 +6012,7 @@ void Rdb_ddl_manager::cleanup(bool destroy_rwlock) {
     delete kv.second;
   }
   m_ddl_map.clear();
+  invalidate_keydef_snapshot();
 
   if (destroy_rwlock) {
     mysql_rwlock_destroy(&m_rwlock);
@@ -5554,6 +6160,18 @@ bool Rdb_binlog_manager::read(char *const binlog_name,
   return ret;
 }
 
+bool Rdb_binlog_manager::read(rocksdb::DB *const db,
+                              rocksdb::ColumnFamilyHandle *const system_cf,
+                              char *const binlog_name,
+                              my_off_t *const binlog_pos,
+                              char *const binlog_gtid) const {
+  std::string value;
+  const rocksdb::Status status =
+      db->Get(rocksdb::ReadOptions(), system_cf, m_key_slice, &value);
+  return status.ok() && !unpack_value((const uchar *)value.c_str(),
+                                      binlog_name, binlog_pos, binlog_gtid);
+}
+
 /**
   Unpack value then split into binlog_name, binlog_pos (and binlog_gtid)
   @param[IN]  value        Binlog state info fetched from RocksDB
@@ -5712,6 +6330,7 @@ int Rdb_dict_manager::commit(rocksdb::WriteBatch *const batch,
   rocksdb::TransactionDBWriteOptimizations optimize;
   optimize.skip_concurrency_control = true;
   rocksdb::Status s = m_db->Write(options, optimize, batch);
+  m_version.fetch_add(1, std::memory_order_release);
   res = !s.ok();  // we return true when something failed
   if (res) {
     rdb_handle_io_error(s, RDB_IO_ERROR_DICT_COMMIT);
@@ -5797,6 +6416,32 @@ void Rdb_dict_manager::delete_index_info(rocksdb::WriteBatch *batch,
   delete_with_prefix(batch, Rdb_key_def::INDEX_INFO, gl_index_id);
   delete_with_prefix(batch, Rdb_key_def::INDEX_STATISTICS, gl_index_id);
   delete_with_prefix(batch, Rdb_key_def::AUTO_INC, gl_index_id);
+  delete_with_prefix(batch, Rdb_key_def::VECTOR_INDEX_QUANTIZER, gl_index_id);
+  delete_with_prefix(batch, Rdb_key_def::VECTOR_INDEX_LIST_SIZES, gl_index_id);
+}
+
+/*
+  Get the ids of the indexes of the column family that have an INDEX_INFO
+*/
+void Rdb_dict_manager::get_cf_index_ids(
+    const uint cf_id, std::vector<GL_INDEX_ID> *const gl_index_ids) const {
+  Rdb_buf_writer<Rdb_key_def::INDEX_NUMBER_SIZE * 2> prefix_writer;
+  prefix_writer.write_uint32(Rdb_key_def::INDEX_INFO);
+  prefix_writer.write_uint32(cf_id);
+  const rocksdb::Slice prefix = prefix_writer.to_slice();
+
+  std::unique_ptr<rocksdb::Iterator> it(new_iterator());
+  for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix);
+       it->Next()) {
+    const rocksdb::Slice key = it->key();
+    if (key.size() != Rdb_key_def::INDEX_NUMBER_SIZE * 3) continue;
+
+    GL_INDEX_ID gl_index_id;
+    gl_index_id.cf_id = cf_id;
+    gl_index_id.index_id = rdb_netbuf_to_uint32(
+        (const uchar *)key.data() + 2 * Rdb_key_def::INDEX_NUMBER_SIZE);
+    gl_index_ids->push_back(gl_index_id);
+  }
 }
 
 bool Rdb_dict_manager::get_index_info(
@@ -6483,6 +7128,115 @@ bool Rdb_dict_manager::get_auto_incr_val(const GL_INDEX_ID &gl_index_id,
   return false;
 }
 
+void Rdb_dict_manager::put_vector_quantizer(
+    rocksdb::WriteBatch *const batch, const GL_INDEX_ID &gl_index_id,
+    uint64 generation, uint nlist, const std::vector<float> &centroids) const {
+  assert(batch != nullptr);
+  assert(nlist > 0 && centroids.size() % nlist == 0);
+
+  Rdb_buf_writer<Rdb_key_def::INDEX_NUMBER_SIZE * 3> key_writer;
+  dump_index_id(&key_writer, Rdb_key_def::VECTOR_INDEX_QUANTIZER, gl_index_id);
+
+  Rdb_string_writer value_writer;
+  value_writer.write_uint16(Rdb_key_def::VECTOR_INDEX_QUANTIZER_VERSION);
+  value_writer.write_uint64(generation);
+  value_writer.write_uint32(nlist);
+  value_writer.write_uint32(centroids.size() / nlist);
+  value_writer.write(reinterpret_cast<const uchar *>(centroids.data()),
+                     centroids.size() * sizeof(float));
+
+  batch->Put(m_system_cfh, key_writer.to_slice(), value_writer.to_slice());
+}
+
+bool Rdb_dict_manager::get_vector_quantizer(
+    const GL_INDEX_ID &gl_index_id, uint64 *generation, uint *nlist,
+    std::vector<float> *centroids) const {
+  Rdb_buf_writer<Rdb_key_def::INDEX_NUMBER_SIZE * 3> key_writer;
+  dump_index_id(&key_writer, Rdb_key_def::VECTOR_INDEX_QUANTIZER, gl_index_id);
+
+  std::string value;
+  const rocksdb::Status status = get_value(key_writer.to_slice(), &value);
+  if (!status.ok()) {
+    return false;
+  }
+
+  Rdb_string_reader reader(value);
+  uint version;
+  uint32 value_nlist;
+  uint32 dimension;
+  if (reader.read_uint16(&version) ||
+      version > Rdb_key_def::VECTOR_INDEX_QUANTIZER_VERSION ||
+      reader.read_uint64(generation) || reader.read_uint32(&value_nlist) ||
+      reader.read_uint32(&dimension)) {
+    return false;
+  }
+  const size_t centroids_size =
+      static_cast<size_t>(value_nlist) * dimension * sizeof(float);
+  const char *const data = reader.read(centroids_size);
+  if (data == nullptr || reader.remaining_bytes() != 0) {
+    return false;
+  }
+  *nlist = value_nlist;
+  if (centroids != nullptr) {
+    centroids->resize(static_cast<size_t>(value_nlist) * dimension);
+    memcpy(centroids->data(), data, centroids_size);
+  }
+  return true;
+}
+
+void Rdb_dict_manager::put_vector_list_sizes(
+    rocksdb::WriteBatch *const batch, const GL_INDEX_ID &gl_index_id,
+    uint64 generation, const std::vector<int64_t> &list_sizes) const {
+  assert(batch != nullptr);
+
+  Rdb_buf_writer<Rdb_key_def::INDEX_NUMBER_SIZE * 3> key_writer;
+  dump_index_id(&key_writer, Rdb_key_def::VECTOR_INDEX_LIST_SIZES,
+                gl_index_id);
+
+  Rdb_string_writer value_writer;
+  value_writer.write_uint16(Rdb_key_def::VECTOR_INDEX_LIST_SIZES_VERSION);
+  value_writer.write_uint64(generation);
+  value_writer.write_uint32(list_sizes.size());
+  for (const auto list_size : list_sizes) {
+    value_writer.write_uint64(static_cast<uint64>(list_size));
+  }
+
+  batch->Put(m_system_cfh, key_writer.to_slice(), value_writer.to_slice());
+}
+
+bool Rdb_dict_manager::get_vector_list_sizes(
+    const GL_INDEX_ID &gl_index_id, uint64 *generation,
+    std::vector<int64_t> *list_sizes) const {
+  Rdb_buf_writer<Rdb_key_def::INDEX_NUMBER_SIZE * 3> key_writer;
+  dump_index_id(&key_writer, Rdb_key_def::VECTOR_INDEX_LIST_SIZES,
+                gl_index_id);
+
+  std::string value;
+  const rocksdb::Status status = get_value(key_writer.to_slice(), &value);
+  if (!status.ok()) {
+    return false;
+  }
+
+  Rdb_string_reader reader(value);
+  uint version;
+  uint32 nlist;
+  if (reader.read_uint16(&version) ||
+      version > Rdb_key_def::VECTOR_INDEX_LIST_SIZES_VERSION ||
+      reader.read_uint64(generation) || reader.read_uint32(&nlist) ||
+      reader.remaining_bytes() != nlist * sizeof(uint64)) {
+    return false;
+  }
+  list_sizes->resize(nlist);
+  for (auto &list_size : *list_sizes) {
+    uint64 stored;
+    if (reader.read_uint64(&stored)) {
+      return false;
+    }
+    list_size = static_cast<int64_t>(stored);
+  }
+  return true;
+}
+
 uint Rdb_seq_generator::get_and_update_next_number(Rdb_dict_manager *const dict,
                                                    bool is_dd_tbl) {
   assert(dict != nullptr);
@@ -20,6 +20,8 @@
 #include <array>
 #include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -109,6 +111,8 @@ class Rdb_pack_field_context {
   Rdb_string_writer *writer;
   Rdb_vector_index *vector_index;
   std::string vector_codes;
+  // list and codes computed ahead of packing, nullptr assigns while packing
+  const Rdb_vector_index_assignment *vector_assignment = nullptr;
 };
 
 /*
@@ -172,6 +176,8 @@ using rdb_index_field_skip_t = int (*)(const Rdb_field_packing *fpi,
 using rdb_index_field_pack_t = void (*)(Rdb_field_packing *fpi, Field *field,
                                         uchar *buf, uchar **dst,
                                         Rdb_pack_field_context *pack_ctx);
+/* Packs an integer straight from its place in the record */
+using rdb_integer_pack_t = void (*)(const uchar *from, uchar *to);
 
 const uint RDB_INVALID_KEY_LEN = uint(-1);
 
@@ -280,7 +286,9 @@ class Rdb_key_def {
                     uchar *tuple, uchar *const packed_tuple,
                     uchar *const pack_buffer,
                     Rdb_string_writer *const unpack_info,
-                    uint *const n_null_fields) const;
+                    uint *const n_null_fields,
+                    const Rdb_vector_index_assignment *const vector_assignment =
+                        nullptr) const;
   /* Convert a key from Table->record format to mem-comparable form */
   uint pack_record(const TABLE *const tbl, uchar *const pack_buffer,
                    const uchar *const record, uchar *const packed_tuple,
@@ -288,7 +296,22 @@ class Rdb_key_def {
                    const bool should_store_row_debug_checksums,
                    const longlong hidden_pk_id = 0, uint n_key_parts = 0,
                    uint *const n_null_fields = nullptr,
-                   const char *const ttl_bytes = nullptr) const;
+                   const char *const ttl_bytes = nullptr,
+                   const Rdb_vector_index_assignment *const vector_assignment =
+                       nullptr) const;
+  /*
+    Read the vector indexed by a vector index from the record, the vectors
+    one after the other for a multi-vector index
+  */
+  int read_vector(const TABLE *const tbl, const uchar *const record,
+                  std::vector<float> *const vector) const;
+  /*
+    Read the part of the entry of this index for the record that entries of
+    other rows share: the ivf list of a vector index, or the cell of a
+    hilbert next spatial index. Empty for other indexes and NULL columns.
+  */
+  int read_shared_entry(const TABLE *const tbl, const uchar *const record,
+                        std::string *const image) const;
   /* Pack the hidden primary key into mem-comparable form. */
   uint pack_hidden_pk(const longlong hidden_pk_id,
                       uchar *const packed_tuple) const;
@@ -455,13 +478,17 @@ class Rdb_key_def {
   };
 
   // bit flags which denote myrocks specific fields stored in the record
-  // currently only used for TTL.
+  // or the layout of the record.
   enum INDEX_FLAG {
     TTL_FLAG = 1 << 0,
 
+    // The PK value stores the fixed-width columns first, at fixed offsets
+    // from the end of the header, the NULL ones as zeros. Takes no bytes.
+    FIXED_OFFSETS_FLAG = 1 << 1,
+
     // MAX_FLAG marks where the actual record starts
     // This flag always needs to be set to the last index flag enum.
-    MAX_FLAG = TTL_FLAG << 1,
+    MAX_FLAG = FIXED_OFFSETS_FLAG << 1,
   };
 
   // Set of flags to ignore when comparing two CF-s and determining if
@@ -482,6 +509,8 @@ class Rdb_key_def {
     DROPPED_CF = 10,
     MAX_DD_INDEX_ID = 11,
     SERVER_VERSION = 12,
+    VECTOR_INDEX_QUANTIZER = 13,
+    VECTOR_INDEX_LIST_SIZES = 14,
     END_DICT_INDEX_ID = 255,
     MIN_DD_INDEX_ID = 256,
   };
@@ -499,6 +528,8 @@ class Rdb_key_def {
     AUTO_INCREMENT_VERSION = 1,
     DROPPED_CF_VERSION = 1,
     SERVER_VERSION_VERSION = 1,
+    VECTOR_INDEX_QUANTIZER_VERSION = 1,
+    VECTOR_INDEX_LIST_SIZES_VERSION = 1,
     // Version for index stats is stored in IndexStats struct
   };
 
@@ -606,6 +637,12 @@ class Rdb_key_def {
                                             bool skip_checks = false);
   inline bool has_ttl() const { return m_ttl_duration > 0; }
 
+  [[nodiscard]] static bool extract_fixed_offsets(
+      const TABLE &table_arg, const Rdb_tbl_def &tbl_def_arg);
+  inline bool has_fixed_offsets() const {
+    return has_index_flag(m_index_flags_bitmap, FIXED_OFFSETS_FLAG);
+  }
+
   [[nodiscard]] uint extract_partial_index_info(const TABLE &table_arg,
                                                 const Rdb_tbl_def &tbl_def_arg);
   inline bool is_partial_index() const { return m_partial_index_threshold > 0; }
@@ -647,6 +684,18 @@ class Rdb_key_def {
     return m_vector_index_config;
   }
 
+  /* A vector index of a multi-vector column has an entry per list a row's
+     vectors fall into, see ha_rocksdb::write_multi_vector_sk */
+  bool is_multi_vector_index() const {
+    return is_vector_index() && m_vector_index_config.multi();
+  }
+
+  /* A sparse vector index keeps postings like a FULLTEXT index, see
+     rdb_sparse_vector_write */
+  bool is_sparse_vector_index() const {
+    return is_vector_index() && m_vector_index_config.sparse();
+  }
+
   Rdb_vector_index *get_vector_index() const { return m_vector_index.get(); }
 
   bool is_next_spatial_index() const {
@@ -659,6 +708,28 @@ class Rdb_key_def {
 
   Rdb_next_spatial_index *get_next_spatial_index() const { return m_next_spatial_index.get(); }
 
+  /* A FULLTEXT index, an inverted index of its columns, see rdb_fulltext.h */
+  bool is_fulltext_index() const { return m_is_fulltext; }
+
+  /*
+    Read the lon/lat of the point an entry of this next spatial index is keyed
+    by, from its key and value. Returns false if the geometry is not a point.
+  */
+  bool next_spatial_entry_point(const rocksdb::Slice &key,
+                                const rocksdb::Slice &value, double *lon,
+                                double *lat) const;
+
+  /*
+    Whether an update that keeps the key of an entry overwrites it with a
+    put. Such entries are removed with Delete, as they can have more than
+    one put.
+  */
+  bool overwrites_entries() const {
+    return is_next_spatial_index() &&
+           m_next_spatial_index_config.type() ==
+               NEXT_SPATIAL_INDEX_TYPE::HILBERT_INDEX;
+  }
+
   /* Check if keypart #kp can be unpacked from index tuple */
   inline bool can_unpack(const uint kp) const;
   /* Check if keypart #kp needs unpack info */
@@ -682,7 +753,7 @@ class Rdb_key_def {
       Rdb_field_packing *const fpi, Field *const field, uchar *buf, uchar **dst,
       Rdb_pack_field_context *const pack_ctx);
 
-  template <int length>
+  template <int length, bool is_unsigned>
   static void pack_integer(Rdb_field_packing *const fpi, Field *const field,
                            uchar *buf MY_ATTRIBUTE((__unused__)), uchar **dst,
                            Rdb_pack_field_context *const pack_ctx
@@ -694,7 +765,7 @@ class Rdb_key_def {
                             Rdb_pack_field_context *const pack_ctx
                                 MY_ATTRIBUTE((__unused__)));
 
-  template <int length>
+  template <int length, bool is_unsigned>
   static int unpack_integer(
       Rdb_field_packing *const fpi, Rdb_unpack_func_context *const ctx,
       uchar *const to, Rdb_string_reader *const reader,
@@ -758,6 +829,12 @@ class Rdb_key_def {
       uchar *const buf MY_ATTRIBUTE((__unused__)), uchar **dst,
       Rdb_pack_field_context *const pack_ctx MY_ATTRIBUTE((__unused__)));
 
+  static void pack_next_spatial_cell(
+      Rdb_field_packing *const fpi MY_ATTRIBUTE((__unused__)),
+      Field *const field, uchar *const buf MY_ATTRIBUTE((__unused__)),
+      uchar **dst,
+      Rdb_pack_field_context *const pack_ctx MY_ATTRIBUTE((__unused__)));
+
   static int unpack_binary_varlength(
       Rdb_field_packing *const fpi, Rdb_unpack_func_context *const ctx,
       uchar *dst MY_ATTRIBUTE((__unused__)), Rdb_string_reader *const reader,
@@ -821,6 +898,10 @@ class Rdb_key_def {
                                  const Field *const field,
                                  Rdb_pack_field_context *const pack_ctx);
 
+  static void make_unpack_next_spatial_point(
+      const Rdb_field_packing *const fpi MY_ATTRIBUTE((__unused__)),
+      const Field *const field, Rdb_pack_field_context *const pack_ctx);
+
   static void make_unpack_unknown(
       const Rdb_field_packing *const fpi MY_ATTRIBUTE((__unused__)),
       const Field *const field, Rdb_pack_field_context *const pack_ctx);
@@ -859,6 +940,10 @@ class Rdb_key_def {
   static constexpr auto INVALID_INDEX_NUMBER =
       static_cast<std::uint32_t>(dd::INVALID_OBJECT_ID);
 
+  // the list id of an ivf index entry keeps the generation of its centroids
+  // in the bits from this one up
+  static constexpr uint VECTOR_INDEX_GENERATION_SHIFT = 32;
+
  private:
 #ifndef NDEBUG
   inline bool is_storage_available(const int offset, const int needed) const {
@@ -890,6 +975,10 @@ class Rdb_key_def {
     const Rdb_tbl_def &tbl_def,
     Rdb_cmd_srv_helper &cmd_srv_helper);
 
+  bool m_is_fulltext{false};
+
+  [[nodiscard]] uint setup_fulltext_index(const Rdb_tbl_def &tbl_def) const;
+
   static void pack_variable_format(const uchar *src, size_t src_len,
                                    uchar **dst);
 
@@ -928,6 +1017,14 @@ class Rdb_key_def {
   static bool is_varlength_prefix_covering(const Field *field,
                                            const Rdb_field_packing *const fpi);
 
+  /*
+    Packs the first n_key_parts of a key that has only integer columns
+    (m_integer_key is set) straight from the record.
+  */
+  uchar *pack_integer_key_parts(const uchar *const record, uchar *tuple,
+                                const uint n_key_parts,
+                                uint *const n_null_fields) const;
+
  public:
   uint16_t m_index_dict_version;
   uchar m_index_type;
@@ -1019,6 +1116,12 @@ class Rdb_key_def {
   /* True if the index contains any key of type KEY_MAY_BE_COVERED */
   bool m_store_covered_bitmap;
 
+  /*
+    True if every key part is an integer column, so that pack_record() needs
+    neither the Field objects nor unpack info.
+  */
+  bool m_integer_key{false};
+
   /* mutex to protect setup */
   mysql_mutex_t m_mutex;
 };
@@ -1130,6 +1233,13 @@ class Rdb_field_packing {
   rdb_index_field_pack_t m_pack_func;
   rdb_make_unpack_info_t m_make_unpack_info_func;
 
+  /*
+    For integer columns, the packing of m_pack_func without the Field, so
+    that keys made only of integers are packed in one pass over the record.
+    nullptr for other types.
+  */
+  rdb_integer_pack_t m_integer_pack_func;
+
   /*
     This function takes
     - mem-comparable form
@@ -1174,6 +1284,10 @@ class Rdb_field_packing {
   uint m_keynr;
   uint m_key_part;
 
+  /* Sets up the packing of a signed or unsigned integer of length bytes */
+  template <int length>
+  void setup_integer();
+
  public:
   bool setup(const Rdb_key_def *const key_descr, const Field *const field,
              const uint keynr_arg, const uint key_part_arg,
@@ -1223,6 +1337,8 @@ class Rdb_field_encoder {
   ptrdiff_t m_field_null_offset;
   ptrdiff_t m_field_offset;
   bool m_is_virtual_gcol;
+  // stored before the other fields, also when NULL, see FIXED_OFFSETS_FLAG
+  bool m_fixed_offset;
 
   bool m_is_instant_field;
   // nullptr means null value for that field
@@ -1469,6 +1585,24 @@ class Rdb_ddl_manager : public Ensure_initialized {
       m_index_num_to_uncommitted_keydef;
   mutable mysql_rwlock_t m_rwlock;
 
+  // Read-only copy of the index id -> key definition mappings above, so
+  // that safe_find() readers don't take m_rwlock. They announce themselves
+  // in a per-cpu counter of the current epoch instead. Changes to the
+  // mappings drop the copy under m_rwlock write lock and wait for the
+  // readers of both epochs to go away before freeing it, RCU style. The
+  // next reader rebuilds it.
+  using Keydef_snapshot =
+      std::unordered_map<GL_INDEX_ID, std::shared_ptr<const Rdb_key_def>>;
+  static constexpr size_t KEYDEF_READER_SLOTS = 64;
+  struct alignas(64) Keydef_reader_count {
+    std::atomic<uint64_t> m_count{0};
+  };
+  mutable std::array<Keydef_reader_count, 2 * KEYDEF_READER_SLOTS>
+      m_keydef_readers;
+  std::atomic<uint64_t> m_keydef_epoch{0};
+  mutable std::atomic<const Keydef_snapshot *> m_keydef_snapshot{nullptr};
+  mutable std::mutex m_keydef_snapshot_mutex;
+
   Rdb_seq_generator m_dd_table_sequence;
   Rdb_seq_generator m_user_table_sequence;
   Rdb_seq_generator m_tmp_table_sequence;
@@ -1478,6 +1612,13 @@ class Rdb_ddl_manager : public Ensure_initialized {
   // and consumed by the rocksdb background thread
   std::map<GL_INDEX_ID, Rdb_index_stats> m_stats2store;
 
+  // Snapshot of the table definitions written at clean shutdown, and the
+  // sequence number the DB was opened at. The snapshot is only loaded when
+  // it was taken at that sequence number, i.e. nothing changed since.
+  std::string m_snapshot_path;
+  rocksdb::SequenceNumber m_open_seq = 0;
+  bool m_use_snapshot = false;
+
   [[nodiscard]] const std::shared_ptr<Rdb_key_def> &find(
       GL_INDEX_ID gl_index_id) const;
 
@@ -1488,7 +1629,12 @@ class Rdb_ddl_manager : public Ensure_initialized {
 
   /* Load the data dictionary from on-disk storage */
   bool init(Rdb_dict_manager_selector *const dict_arg,
-            Rdb_cf_manager *const cf_manager, const uint32_t validate_tables);
+            Rdb_cf_manager *const cf_manager, const uint32_t validate_tables,
+            const std::string &snapshot_path = "",
+            const rocksdb::SequenceNumber open_seq = 0);
+
+  /* Write the table definitions to the snapshot, at clean shutdown */
+  void write_snapshot() const;
 
   /* reset during ddse upgrade */
   void reset_map();
@@ -1539,6 +1685,10 @@ class Rdb_ddl_manager : public Ensure_initialized {
  private:
   bool populate(uint32_t validate_tables, bool lock = true);
 
+  /* Load the table definitions from the snapshot, false if loaded */
+  bool load_snapshot(uint max_dd_index_id_in_dict, uint max_index_id_in_dict,
+                     uint system_cf_id, bool lock, int *count);
+
   /* Put the data into in-memory table (only) */
   int put(Rdb_tbl_def *const key_descr, const bool lock = true);
 
@@ -1550,6 +1700,9 @@ class Rdb_ddl_manager : public Ensure_initialized {
   [[nodiscard]] bool validate_schemas() const;
 
   [[nodiscard]] bool validate_auto_incr() const;
+
+  [[nodiscard]] const Keydef_snapshot *get_keydef_snapshot() const;
+  void invalidate_keydef_snapshot();
 };
 
 /*
@@ -1582,6 +1735,10 @@ class Rdb_binlog_manager {
                   const char *const max_gtid, const bool sync);
   bool read(char *const binlog_name, my_off_t *const binlog_pos,
             char *const binlog_gtid) const;
+  /* read() from another DB, such as a checkpoint opened read only */
+  bool read(rocksdb::DB *const db, rocksdb::ColumnFamilyHandle *const system_cf,
+            char *const binlog_name, my_off_t *const binlog_pos,
+            char *const binlog_gtid) const;
 
  private:
   Rdb_dict_manager *m_dict = nullptr;
@@ -1658,6 +1815,18 @@ class Rdb_binlog_manager {
   value: version, {server version}
   server version is 4 bytes
 
+  13. retrained vector index centroids
+  key: Rdb_key_def::VECTOR_INDEX_QUANTIZER(0xd) + cf_id + index_id
+  value: version, generation, nlist, dimension, {centroids}
+  generation is 8 bytes, nlist and dimension are 4 bytes.
+  centroids are nlist * dimension floats in host byte order.
+
+  14. vector index list sizes
+  key: Rdb_key_def::VECTOR_INDEX_LIST_SIZES(0xe) + cf_id + index_id
+  value: version, generation, nlist, {list size}*nlist
+  generation and list sizes are 8 bytes, nlist is 4 bytes.
+  a list size of -1 means the list was never counted.
+
   Data dictionary operations are atomic inside RocksDB. For example,
   when creating a table with two indexes, it is necessary to call Put
   three times. They have to be atomic. Rdb_dict_manager has a wrapper function
@@ -1680,6 +1849,9 @@ class Rdb_dict_manager : public Ensure_initialized {
   uchar m_key_buf_server_version[Rdb_key_def::INDEX_NUMBER_SIZE] = {0};
   rocksdb::Slice m_key_slice_server_version;
 
+  /* Bumped by every commit() */
+  mutable std::atomic<uint64_t> m_version{0};
+
   static void dump_index_id(uchar *const netbuf,
                             Rdb_key_def::DATA_DICT_TYPE dict_type,
                             const GL_INDEX_ID &gl_index_id);
@@ -1740,6 +1912,14 @@ class Rdb_dict_manager : public Ensure_initialized {
                   const rocksdb::Slice &key) const;
   rocksdb::Iterator *new_iterator() const;
 
+  /*
+    Changes whenever the data dictionary may have, read it before reading
+    the dictionary to tell whether what was read is still current.
+  */
+  uint64_t get_version() const {
+    return m_version.load(std::memory_order_acquire);
+  }
+
   /* Internal Index id => CF */
   void add_or_update_index_cf_mapping(
       rocksdb::WriteBatch *batch,
@@ -1748,6 +1928,8 @@ class Rdb_dict_manager : public Ensure_initialized {
                          const GL_INDEX_ID &index_id) const;
   bool get_index_info(const GL_INDEX_ID &gl_index_id,
                       struct Rdb_index_info *const index_info) const;
+  void get_cf_index_ids(const uint cf_id,
+                        std::vector<GL_INDEX_ID> *const gl_index_ids) const;
 
   /* CF id => CF flags */
   void add_cf_flags(rocksdb::WriteBatch *const batch, const uint cf_id,
@@ -1854,6 +2036,20 @@ class Rdb_dict_manager : public Ensure_initialized {
   bool get_auto_incr_val(const GL_INDEX_ID &gl_index_id,
                          ulonglong *new_val) const;
 
+  void put_vector_quantizer(rocksdb::WriteBatch *const batch,
+                            const GL_INDEX_ID &gl_index_id, uint64 generation,
+                            uint nlist,
+                            const std::vector<float> &centroids) const;
+  // centroids may be nullptr when only the generation is needed
+  bool get_vector_quantizer(const GL_INDEX_ID &gl_index_id, uint64 *generation,
+                            uint *nlist, std::vector<float> *centroids) const;
+
+  void put_vector_list_sizes(rocksdb::WriteBatch *const batch,
+                             const GL_INDEX_ID &gl_index_id, uint64 generation,
+                             const std::vector<int64_t> &list_sizes) const;
+  bool get_vector_list_sizes(const GL_INDEX_ID &gl_index_id, uint64 *generation,
+                             std::vector<int64_t> *list_sizes) const;
+
  private:
   /* dropped cf flags */
   void delete_cf_flags(rocksdb::WriteBatch *const batch,
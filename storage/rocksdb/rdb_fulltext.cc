@@ -0,0 +1,701 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "./rdb_fulltext.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <queue>
+#include <unordered_set>
+
+#include "ha_rocksdb.h"
+#include "ha_rocksdb_proto.h"
+#include "rdb_buff.h"
+#include "rdb_datadic.h"
+#include "sql/field.h"
+#include "sql/key.h"
+#include "sql/sql_class.h"
+#include "sql/table.h"
+#include "util/coding.h"
+
+namespace myrocks {
+
+namespace {
+
+/* BM25 parameters */
+constexpr double BM25_K1 = 1.2;
+constexpr double BM25_B = 0.75;
+
+/* Size of the value of the index stats: documents, total length */
+constexpr size_t INDEX_STATS_SIZE = 2 * sizeof(uint64);
+
+/* Size of the term stats of a sparse vector index: documents, max value */
+constexpr size_t SPARSE_TERM_STATS_SIZE = sizeof(uint64) + sizeof(float);
+
+std::string fulltext_key(const Rdb_key_def &kd) {
+  uchar index[Rdb_key_def::INDEX_NUMBER_SIZE];
+  rdb_netbuf_store_index(index, kd.get_index_number());
+  return std::string(reinterpret_cast<const char *>(index), sizeof(index));
+}
+
+/* Key of the stats of a term */
+std::string term_key(const Rdb_key_def &kd, const std::string &term) {
+  return fulltext_key(kd) + term;
+}
+
+/* Prefix of the postings of a term */
+std::string posting_prefix(const Rdb_key_def &kd, const std::string &term) {
+  std::string key = term_key(kd, term);
+  key.push_back('\0');
+  return key;
+}
+
+std::string counters(std::initializer_list<int64> values) {
+  std::string value;
+  for (const int64 v : values) {
+    uchar buf[sizeof(uint64)];
+    rdb_netbuf_store_uint64(buf, static_cast<uint64>(v));
+    value.append(reinterpret_cast<const char *>(buf), sizeof(buf));
+  }
+  return value;
+}
+
+int64 counter(const rocksdb::Slice &value, size_t i) {
+  return static_cast<int64>(rdb_netbuf_to_uint64(
+      reinterpret_cast<const uchar *>(value.data()) + i * sizeof(uint64)));
+}
+
+/* A float in network byte order */
+std::string float_value(float v) {
+  uint32 bits;
+  memcpy(&bits, &v, sizeof(bits));
+  uchar buf[sizeof(bits)];
+  rdb_netbuf_store_uint32(buf, bits);
+  return std::string(reinterpret_cast<const char *>(buf), sizeof(buf));
+}
+
+float float_at(const rocksdb::Slice &value, size_t offset) {
+  const uint32 bits = rdb_netbuf_to_uint32(
+      reinterpret_cast<const uchar *>(value.data()) + offset);
+  float v;
+  memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+/* Term of the postings of an index of a sparse vector */
+std::string sparse_term(uint32 index) { return std::to_string(index); }
+
+bool is_word_char(int ctype, uchar c) {
+  return (ctype & (_MY_U | _MY_L | _MY_NMR)) || c == '_';
+}
+
+}  // namespace
+
+uint32 rdb_fulltext_tokenize(const CHARSET_INFO *cs, const char *text,
+                             size_t length, uint min_len, uint max_len,
+                             Rdb_fulltext_terms *terms) {
+  const uchar *p = reinterpret_cast<const uchar *>(text);
+  const uchar *const end = p + length;
+  const uchar *word = nullptr;
+  uint chars = 0;
+  uint32 count = 0;
+
+  const auto add_word = [&](const uchar *word_end) {
+    if (chars < min_len || chars > max_len) return;
+    std::string src(reinterpret_cast<const char *>(word), word_end - word);
+    std::string term(src.size() * cs->casedn_multiply, '\0');
+    term.resize(cs->cset->casedn(cs, src.data(), src.size(), term.data(),
+                                 term.size()));
+    (*terms)[term]++;
+    count++;
+  };
+
+  for (;;) {
+    int ctype = 0;
+    int mbl = 0;
+    if (p < end) mbl = cs->cset->ctype(cs, &ctype, p, end);
+    if (p < end && is_word_char(ctype, *p)) {
+      if (word == nullptr) {
+        word = p;
+        chars = 0;
+      }
+      chars++;
+    } else if (word != nullptr) {
+      add_word(p);
+      word = nullptr;
+    }
+    if (p >= end) break;
+    p += std::min<size_t>(mbl > 0 ? mbl : (mbl < 0 ? -mbl : 1), end - p);
+  }
+  return count;
+}
+
+uint32 rdb_fulltext_record_terms(const TABLE *table, uint keyno,
+                                 const uchar *record, uint min_len,
+                                 uint max_len, Rdb_fulltext_terms *terms) {
+  const KEY &key = table->key_info[keyno];
+  const ptrdiff_t offset = record - table->record[0];
+  my_bitmap_map *const old_map =
+      dbug_tmp_use_all_columns(const_cast<TABLE *>(table), table->read_set);
+  String buffer;
+  uint32 count = 0;
+  for (uint i = 0; i < key.user_defined_key_parts; i++) {
+    Field *const field = key.key_part[i].field;
+    field->move_field_offset(offset);
+    if (!field->is_null()) {
+      const String *const value = field->val_str(&buffer);
+      count += rdb_fulltext_tokenize(field->charset(), value->ptr(),
+                                     value->length(), min_len, max_len,
+                                     terms);
+    }
+    field->move_field_offset(-offset);
+  }
+  dbug_tmp_restore_column_map(table->read_set, old_map);
+  return count;
+}
+
+bool rdb_sparse_vector_record(const TABLE *table, uint keyno,
+                              const uchar *record, Fb_sparse_vector *vector) {
+  Field *const field = table->key_info[keyno].key_part[0].field;
+  const ptrdiff_t offset = record - table->record[0];
+  my_bitmap_map *const old_map =
+      dbug_tmp_use_all_columns(const_cast<TABLE *>(table), table->read_set);
+  field->move_field_offset(offset);
+  vector->clear();
+  bool error = false;
+  if (!field->is_null()) {
+    Json_wrapper wrapper;
+    error = down_cast<Field_json *>(field)->val_json(&wrapper) ||
+            parse_fb_sparse_vector_from_json(wrapper, *vector);
+  }
+  field->move_field_offset(-offset);
+  dbug_tmp_restore_column_map(table->read_set, old_map);
+  return error;
+}
+
+rocksdb::Status rdb_fulltext_write(
+    rocksdb::WriteBatchBase *wb, const Rdb_key_def &kd,
+    const rocksdb::Slice &old_pk, const Rdb_fulltext_terms *old_terms,
+    uint32 old_length, const rocksdb::Slice &new_pk,
+    const Rdb_fulltext_terms *new_terms, uint32 new_length) {
+  static const Rdb_fulltext_terms no_terms;
+  if (old_terms == nullptr) old_terms = &no_terms;
+  if (new_terms == nullptr) new_terms = &no_terms;
+  rocksdb::ColumnFamilyHandle *const cf = &kd.get_cf();
+  rocksdb::Status s;
+
+  for (const auto &[term, tf] : *old_terms) {
+    s = wb->Delete(cf, posting_prefix(kd, term) + old_pk.ToString());
+    if (!s.ok()) return s;
+    if (new_terms->count(term) == 0) {
+      s = wb->Merge(cf, term_key(kd, term), counters({-1}));
+      if (!s.ok()) return s;
+    }
+  }
+
+  for (const auto &[term, tf] : *new_terms) {
+    std::string value;
+    rocksdb::PutVarint32(&value, tf);
+    rocksdb::PutVarint32(&value, new_length);
+    s = wb->Put(cf, posting_prefix(kd, term) + new_pk.ToString(), value);
+    if (!s.ok()) return s;
+    if (old_terms->count(term) == 0) {
+      s = wb->Merge(cf, term_key(kd, term), counters({1}));
+      if (!s.ok()) return s;
+    }
+  }
+
+  /* Documents without terms are not counted */
+  const int64 docs =
+      int64{!new_terms->empty()} - int64{!old_terms->empty()};
+  const int64 length = int64{new_length} - int64{old_length};
+  if (docs == 0 && length == 0) return s;
+  return wb->Merge(cf, fulltext_key(kd), counters({docs, length}));
+}
+
+rocksdb::Status rdb_sparse_vector_write(rocksdb::WriteBatchBase *wb,
+                                        const Rdb_key_def &kd,
+                                        const rocksdb::Slice &old_pk,
+                                        const Fb_sparse_vector *old_vector,
+                                        const rocksdb::Slice &new_pk,
+                                        const Fb_sparse_vector *new_vector) {
+  static const Fb_sparse_vector no_vector;
+  if (old_vector == nullptr) old_vector = &no_vector;
+  if (new_vector == nullptr) new_vector = &no_vector;
+  rocksdb::ColumnFamilyHandle *const cf = &kd.get_cf();
+  rocksdb::Status s;
+
+  /* Both are sorted by index */
+  const auto has_index = [](const Fb_sparse_vector &v, uint32 index) {
+    return std::binary_search(
+        v.begin(), v.end(), std::make_pair(index, 0.0f),
+        [](const auto &a, const auto &b) { return a.first < b.first; });
+  };
+
+  for (const auto &[index, value] : *old_vector) {
+    const std::string term = sparse_term(index);
+    s = wb->Delete(cf, posting_prefix(kd, term) + old_pk.ToString());
+    if (!s.ok()) return s;
+    if (!has_index(*new_vector, index)) {
+      s = wb->Merge(cf, term_key(kd, term), counters({-1}) + float_value(0));
+      if (!s.ok()) return s;
+    }
+  }
+
+  for (const auto &[index, value] : *new_vector) {
+    const std::string term = sparse_term(index);
+    s = wb->Put(cf, posting_prefix(kd, term) + new_pk.ToString(),
+                float_value(value));
+    if (!s.ok()) return s;
+    /* The max value of the term only grows, it is an upper bound */
+    s = wb->Merge(cf, term_key(kd, term),
+                  counters({has_index(*old_vector, index) ? 0 : 1}) +
+                      float_value(std::fabs(value)));
+    if (!s.ok()) return s;
+  }
+
+  const int64 docs =
+      int64{!new_vector->empty()} - int64{!old_vector->empty()};
+  const int64 nnz = static_cast<int64>(new_vector->size()) -
+                    static_cast<int64>(old_vector->size());
+  if (docs == 0 && nnz == 0) return s;
+  return wb->Merge(cf, fulltext_key(kd), counters({docs, nnz}));
+}
+
+bool Rdb_fulltext_merge_op::Merge(const rocksdb::Slice &key [[maybe_unused]],
+                                  const rocksdb::Slice *existing_value,
+                                  const rocksdb::Slice &value,
+                                  std::string *new_value,
+                                  rocksdb::Logger *logger
+                                  [[maybe_unused]]) const {
+  /* The term stats of sparse vector indexes end with a max value */
+  const size_t max_size = value.size() % sizeof(uint64);
+  if (max_size != 0 && max_size != sizeof(float)) return false;
+  if (existing_value == nullptr) {
+    new_value->assign(value.data(), value.size());
+    return true;
+  }
+  if (existing_value->size() != value.size()) return false;
+
+  new_value->clear();
+  for (size_t i = 0; i < value.size() / sizeof(uint64); i++) {
+    const uint64 sum = static_cast<uint64>(counter(*existing_value, i)) +
+                       static_cast<uint64>(counter(value, i));
+    uchar buf[sizeof(uint64)];
+    rdb_netbuf_store_uint64(buf, sum);
+    new_value->append(reinterpret_cast<const char *>(buf), sizeof(buf));
+  }
+  if (max_size != 0) {
+    const size_t offset = value.size() - max_size;
+    new_value->append(float_value(std::max(float_at(*existing_value, offset),
+                                           float_at(value, offset))));
+  }
+  return true;
+}
+
+namespace {
+
+/*
+  The postings of one query term, read in pk order in the snapshot of the
+  transaction.
+*/
+class Posting_cursor {
+ public:
+  /* bound is the most the term adds to the score of any document */
+  Posting_cursor(std::string &&prefix, double bound)
+      : m_prefix(std::move(prefix)), m_upper(m_prefix), m_bound(bound) {
+    m_upper.back() = '\1';
+  }
+
+  virtual ~Posting_cursor() {
+    m_it.reset();
+    if (m_snapshot != nullptr) {
+      rdb_get_rocksdb_db()->ReleaseSnapshot(m_snapshot);
+    }
+  }
+
+  Posting_cursor(const Posting_cursor &) = delete;
+  Posting_cursor &operator=(const Posting_cursor &) = delete;
+
+  void open(THD *thd, rocksdb::ColumnFamilyHandle &cf) {
+    m_it = rdb_tx_get_iterator(thd, cf, true, m_prefix, m_upper, &m_snapshot,
+                               TABLE_TYPE::USER_TABLE);
+    m_it->Seek(m_prefix);
+  }
+
+  bool valid() const {
+    return m_it->Valid() && m_it->key().starts_with(m_prefix);
+  }
+
+  const rocksdb::Status status() const { return m_it->status(); }
+
+  /* pk of the current posting */
+  rocksdb::Slice doc() const {
+    rocksdb::Slice key = m_it->key();
+    key.remove_prefix(m_prefix.size());
+    return key;
+  }
+
+  void next() { m_it->Next(); }
+
+  /* Move to the first posting of pk or a later document */
+  void seek(const std::string &pk) { m_it->Seek(m_prefix + pk); }
+
+  double upper_bound() const { return m_bound; }
+
+  /* What the term adds to the score of the current document */
+  virtual double score() const = 0;
+
+ protected:
+  rocksdb::Slice value() const { return m_it->value(); }
+
+ private:
+  const std::string m_prefix;
+  std::string m_upper;
+  const double m_bound;
+  std::unique_ptr<rocksdb::Iterator> m_it;
+  const rocksdb::Snapshot *m_snapshot = nullptr;
+};
+
+/* Postings of a FULLTEXT index, scored with BM25 */
+class Bm25_cursor : public Posting_cursor {
+ public:
+  Bm25_cursor(std::string &&prefix, double weight, double avg_length)
+      : Posting_cursor(std::move(prefix), weight * (BM25_K1 + 1)),
+        m_weight(weight),
+        m_avg_length(avg_length) {}
+
+  double score() const override {
+    rocksdb::Slice v = value();
+    uint32 tf = 0;
+    uint32 length = 0;
+    if (!rocksdb::GetVarint32(&v, &tf) || !rocksdb::GetVarint32(&v, &length)) {
+      return 0;
+    }
+    const double norm = 1 - BM25_B + BM25_B * length / m_avg_length;
+    return m_weight * tf * (BM25_K1 + 1) / (tf + BM25_K1 * norm);
+  }
+
+ private:
+  const double m_weight;
+  const double m_avg_length;
+};
+
+/* Postings of a sparse vector index, scored with the inner product */
+class Sparse_cursor : public Posting_cursor {
+ public:
+  Sparse_cursor(std::string &&prefix, double weight, double max_value)
+      : Posting_cursor(std::move(prefix), std::fabs(weight) * max_value),
+        m_weight(weight) {}
+
+  double score() const override {
+    const rocksdb::Slice v = value();
+    if (v.size() != sizeof(float)) return 0;
+    return m_weight * float_at(v, 0);
+  }
+
+ private:
+  const double m_weight;
+};
+
+/*
+  The k best documents of the posting lists with WAND, best first. A
+  document is only scored when the upper bounds of the lists it can be in
+  add up to more than the k-th best score so far.
+*/
+int wand_top_k(THD *thd, std::vector<std::unique_ptr<Posting_cursor>> *cursors,
+               size_t k, std::vector<Rdb_fulltext_match> *matches) {
+  std::vector<Posting_cursor *> live;
+  for (const auto &cursor : *cursors) live.push_back(cursor.get());
+
+  /* The best matches so far, the worst on top */
+  using Scored = std::pair<float, std::string>;
+  std::priority_queue<Scored, std::vector<Scored>, std::greater<Scored>> best;
+  double threshold = 0;
+
+  for (;;) {
+    for (auto it = live.begin(); it != live.end();) {
+      if ((*it)->valid()) {
+        ++it;
+        continue;
+      }
+      const rocksdb::Status s = (*it)->status();
+      if (!s.ok()) return ha_rocksdb::rdb_error_to_mysql(s);
+      it = live.erase(it);
+    }
+    if (live.empty() || k == 0) break;
+    if (thd_killed(thd)) return HA_ERR_QUERY_INTERRUPTED;
+
+    std::sort(live.begin(), live.end(),
+              [](const Posting_cursor *a, const Posting_cursor *b) {
+                return a->doc().compare(b->doc()) < 0;
+              });
+
+    /*
+      The pivot is the first document whose terms can make it into the
+      best: no document before it can.
+    */
+    double bound = 0;
+    size_t pivot = 0;
+    while (pivot < live.size()) {
+      bound += live[pivot]->upper_bound();
+      if (bound > threshold) break;
+      pivot++;
+    }
+    if (pivot == live.size()) break;
+    const std::string pivot_doc = live[pivot]->doc().ToString();
+
+    if (live[0]->doc() != pivot_doc) {
+      for (size_t i = 0; i < pivot; i++) live[i]->seek(pivot_doc);
+      continue;
+    }
+
+    double score = 0;
+    for (Posting_cursor *const cursor : live) {
+      if (cursor->doc() != pivot_doc) break;
+      score += cursor->score();
+      cursor->next();
+    }
+    if (best.size() < k) {
+      best.emplace(score, pivot_doc);
+    } else if (score > best.top().first) {
+      best.pop();
+      best.emplace(score, pivot_doc);
+    }
+    if (best.size() == k) threshold = best.top().first;
+  }
+
+  matches->reserve(best.size());
+  while (!best.empty()) {
+    matches->push_back({best.top().second, best.top().first});
+    best.pop();
+  }
+  std::reverse(matches->begin(), matches->end());
+  return HA_EXIT_SUCCESS;
+}
+
+/*
+  Rows sharing no index with a sparse query have no posting and score zero.
+  When fewer than k matches score zero or more, such rows are read from the
+  primary key and ranked ahead of the negative scores, the list cut to k.
+*/
+int add_zero_scores(THD *thd, const Rdb_key_def &pk_descr, size_t k,
+                    std::vector<Rdb_fulltext_match> *matches) {
+  const auto negative = std::find_if(
+      matches->begin(), matches->end(),
+      [](const Rdb_fulltext_match &match) { return match.m_score < 0; });
+  const size_t scored = negative - matches->begin();
+  if (scored >= k) return HA_EXIT_SUCCESS;
+  const size_t wanted = k - scored;
+
+  std::unordered_set<std::string> found;
+  for (const Rdb_fulltext_match &match : *matches) found.insert(match.m_pk);
+
+  uchar infimum[Rdb_key_def::INDEX_NUMBER_SIZE];
+  uchar supremum[Rdb_key_def::INDEX_NUMBER_SIZE];
+  uint size;
+  pk_descr.get_infimum_key(infimum, &size);
+  pk_descr.get_supremum_key(supremum, &size);
+  /* A reverse column family reaches the keys of the index from the other
+     side */
+  const rocksdb::Slice first(
+      reinterpret_cast<const char *>(pk_descr.m_is_reverse_cf ? supremum
+                                                              : infimum),
+      size);
+  const rocksdb::Slice last(
+      reinterpret_cast<const char *>(pk_descr.m_is_reverse_cf ? infimum
+                                                              : supremum),
+      size);
+
+  int rc = HA_EXIT_SUCCESS;
+  std::vector<Rdb_fulltext_match> zeros;
+  const rocksdb::Snapshot *snapshot = nullptr;
+  {
+    std::unique_ptr<rocksdb::Iterator> it =
+        rdb_tx_get_iterator(thd, pk_descr.get_cf(), true, first, last,
+                            &snapshot, TABLE_TYPE::USER_TABLE);
+    for (it->Seek(first); it->Valid() && pk_descr.covers_key(it->key()) &&
+                          zeros.size() < wanted;
+         it->Next()) {
+      if (thd_killed(thd)) {
+        rc = HA_ERR_QUERY_INTERRUPTED;
+        break;
+      }
+      std::string pk = it->key().ToString();
+      if (found.count(pk) == 0) zeros.push_back({std::move(pk), 0});
+    }
+    if (rc == HA_EXIT_SUCCESS && !it->status().ok()) {
+      rc = ha_rocksdb::rdb_error_to_mysql(it->status());
+    }
+  }
+  if (snapshot != nullptr) rdb_get_rocksdb_db()->ReleaseSnapshot(snapshot);
+  if (rc != HA_EXIT_SUCCESS) return rc;
+
+  matches->insert(matches->begin() + scored,
+                  std::make_move_iterator(zeros.begin()),
+                  std::make_move_iterator(zeros.end()));
+  if (matches->size() > k) matches->resize(k);
+  return HA_EXIT_SUCCESS;
+}
+
+int fulltext_search_read_next(FT_INFO *, char *) {
+  return HA_ERR_WRONG_COMMAND;
+}
+
+float fulltext_search_find_relevance(FT_INFO *info, uchar *, uint) {
+  return static_cast<Rdb_fulltext_search *>(info)->row_relevance();
+}
+
+void fulltext_search_close(FT_INFO *info) {
+  delete static_cast<Rdb_fulltext_search *>(info);
+}
+
+float fulltext_search_get_relevance(FT_INFO *info) {
+  return static_cast<Rdb_fulltext_search *>(info)->current_relevance();
+}
+
+void fulltext_search_reinit(FT_INFO *info) {
+  static_cast<Rdb_fulltext_search *>(info)->rewind();
+}
+
+_ft_vft fulltext_search_vft = {
+    fulltext_search_read_next, fulltext_search_find_relevance,
+    fulltext_search_close, fulltext_search_get_relevance,
+    fulltext_search_reinit};
+
+}  // namespace
+
+Rdb_fulltext_search::Rdb_fulltext_search(THD *thd, const Rdb_key_def &kd,
+                                         const String *rowkey,
+                                         Rdb_fulltext_terms &&terms,
+                                         ha_rows limit)
+    : m_thd(thd),
+      m_kd(kd),
+      m_rowkey(rowkey),
+      m_terms(std::move(terms)),
+      m_limit(limit) {
+  please = &fulltext_search_vft;
+}
+
+int Rdb_fulltext_search::read_stats(
+    double *docs, double *avg_length,
+    std::vector<std::pair<std::string, double>> *dfs) const {
+  Rdb_transaction *const tx = get_tx_from_thd(m_thd);
+  rdb_tx_acquire_snapshot(tx);
+  rocksdb::PinnableSlice value;
+
+  *docs = 0;
+  *avg_length = 1;
+  rocksdb::Status s = rdb_tx_get(tx, m_kd.get_cf(), fulltext_key(m_kd),
+                                 &value, TABLE_TYPE::USER_TABLE);
+  if (s.IsNotFound()) return HA_EXIT_SUCCESS;
+  if (!s.ok()) return ha_rocksdb::rdb_error_to_mysql(s);
+  if (value.size() != INDEX_STATS_SIZE) return HA_ERR_ROCKSDB_CORRUPT_DATA;
+  *docs = counter(value, 0);
+  if (*docs <= 0) return HA_EXIT_SUCCESS;
+  *avg_length = std::max<double>(counter(value, 1) / *docs, 1);
+
+  for (const auto &[term, qtf] : m_terms) {
+    value.Reset();
+    s = rdb_tx_get(tx, m_kd.get_cf(), term_key(m_kd, term), &value,
+                   TABLE_TYPE::USER_TABLE);
+    if (s.IsNotFound()) continue;
+    if (!s.ok()) return ha_rocksdb::rdb_error_to_mysql(s);
+    if (value.size() != sizeof(uint64)) return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    const int64 df = counter(value, 0);
+    if (df > 0) dfs->emplace_back(term, df);
+  }
+  return HA_EXIT_SUCCESS;
+}
+
+int Rdb_fulltext_search::execute() {
+  if (m_executed) return HA_EXIT_SUCCESS;
+  m_executed = true;
+
+  double docs = 0;
+  double avg_length = 1;
+  std::vector<std::pair<std::string, double>> dfs;
+  int rc = read_stats(&docs, &avg_length, &dfs);
+  if (rc != HA_EXIT_SUCCESS) return rc;
+
+  std::vector<std::unique_ptr<Posting_cursor>> cursors;
+  for (const auto &[term, df] : dfs) {
+    const double idf = std::log(1 + (docs - df + 0.5) / (df + 0.5));
+    cursors.emplace_back(std::make_unique<Bm25_cursor>(
+        posting_prefix(m_kd, term), idf * m_terms.at(term), avg_length));
+    cursors.back()->open(m_thd, m_kd.get_cf());
+  }
+
+  rc = wand_top_k(m_thd, &cursors,
+                  m_limit == HA_POS_ERROR ? SIZE_MAX : m_limit, &m_matches);
+  if (rc != HA_EXIT_SUCCESS) return rc;
+  rewind();
+  return HA_EXIT_SUCCESS;
+}
+
+const Rdb_fulltext_match *Rdb_fulltext_search::next() {
+  if (m_pos >= m_matches.size()) return nullptr;
+  const Rdb_fulltext_match *const match = &m_matches[m_pos++];
+  m_score = match->m_score;
+  return match;
+}
+
+float Rdb_fulltext_search::row_relevance() {
+  if (!m_executed && execute() != HA_EXIT_SUCCESS) return 0;
+  if (m_relevance.empty()) {
+    for (const Rdb_fulltext_match &match : m_matches) {
+      m_relevance.emplace(match.m_pk, match.m_score);
+    }
+  }
+  const auto it = m_relevance.find(
+      std::string(m_rowkey->ptr(), m_rowkey->length()));
+  return it == m_relevance.end() ? 0 : it->second;
+}
+
+int rdb_sparse_vector_search(THD *thd, const Rdb_key_def &kd,
+                             const Rdb_key_def &pk_descr,
+                             const Fb_sparse_vector &query, size_t k,
+                             std::vector<Rdb_fulltext_match> *matches) {
+  Rdb_transaction *const tx = get_tx_from_thd(thd);
+  rdb_tx_acquire_snapshot(tx);
+  rocksdb::PinnableSlice value;
+
+  std::vector<std::unique_ptr<Posting_cursor>> cursors;
+  for (const auto &[index, weight] : query) {
+    const std::string term = sparse_term(index);
+    value.Reset();
+    const rocksdb::Status s = rdb_tx_get(tx, kd.get_cf(), term_key(kd, term),
+                                         &value, TABLE_TYPE::USER_TABLE);
+    if (s.IsNotFound()) continue;
+    if (!s.ok()) return ha_rocksdb::rdb_error_to_mysql(s);
+    if (value.size() != SPARSE_TERM_STATS_SIZE) {
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    if (counter(value, 0) <= 0) continue;
+    cursors.emplace_back(std::make_unique<Sparse_cursor>(
+        posting_prefix(kd, term), weight, float_at(value, sizeof(uint64))));
+    cursors.back()->open(thd, kd.get_cf());
+  }
+
+  const int rc = wand_top_k(thd, &cursors, k, matches);
+  if (rc != HA_EXIT_SUCCESS) return rc;
+  return add_zero_scores(thd, pk_descr, k, matches);
+}
+
+}  // namespace myrocks
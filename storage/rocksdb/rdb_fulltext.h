@@ -0,0 +1,210 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+#pragma once
+
+/*
+  FULLTEXT indexes of MyRocks tables, an inverted index kept as ordinary
+  keys of the column family of the index:
+
+    posting     index id, term, 0, pk       tf, document length (varints)
+    term stats  index id, term              number of documents with term
+    index stats index id                    number of documents, total length
+
+  The postings of a term are sorted by pk, so a posting list is a range
+  scan, and the column family stores it compressed: the keys of a block
+  share their index id and term prefix. Terms never contain a 0 byte, so the
+  stats of a term sort before its postings and are not part of them.
+
+  The stats are written with Merge, their operands are added by
+  Rdb_fulltext_merge_op, so that writers of the same terms do not conflict.
+  They are part of the transaction, so they follow its rollbacks.
+
+  MATCH ... AGAINST in natural language mode ranks the rows with BM25. The
+  posting lists of the query terms are read document at a time with WAND:
+  a document is only scored when the upper bounds of the scores of the
+  terms it can contain add up to more than the k-th best score so far.
+*/
+
+#include <rocksdb/merge_operator.h>
+#include <rocksdb/slice.h>
+#include <rocksdb/write_batch_base.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "./rdb_global.h"
+#include "ft_global.h"
+#include "m_ctype.h"
+#include "my_base.h"
+#include "sql/fb_vector_base.h"
+
+class String;
+class THD;
+struct TABLE;
+
+namespace myrocks {
+
+class Rdb_key_def;
+
+/* The terms of a document, and how many times each occurs in it */
+using Rdb_fulltext_terms = std::map<std::string, uint32>;
+
+/*
+  Split text into terms: runs of letters, digits and '_' of min_len to
+  max_len characters, lowercased.
+  @return number of terms in the text, counting repeats
+*/
+uint32 rdb_fulltext_tokenize(const CHARSET_INFO *cs, const char *text,
+                             size_t length, uint min_len, uint max_len,
+                             Rdb_fulltext_terms *terms);
+
+/*
+  Terms of the columns of a FULLTEXT index in a record of the table.
+  @return number of terms, counting repeats
+*/
+uint32 rdb_fulltext_record_terms(const TABLE *table, uint keyno,
+                                 const uchar *record, uint min_len,
+                                 uint max_len, Rdb_fulltext_terms *terms);
+
+/*
+  Write the postings and stats changes of a row to the index. old_terms
+  are removed, new_terms added, either can be nullptr.
+*/
+rocksdb::Status rdb_fulltext_write(
+    rocksdb::WriteBatchBase *wb, const Rdb_key_def &kd,
+    const rocksdb::Slice &old_pk, const Rdb_fulltext_terms *old_terms,
+    uint32 old_length, const rocksdb::Slice &new_pk,
+    const Rdb_fulltext_terms *new_terms, uint32 new_length);
+
+/*
+  The sparse vector of the column of a sparse vector index in a record of
+  the table, empty for NULL.
+  @return true if the column does not hold a sparse vector
+*/
+bool rdb_sparse_vector_record(const TABLE *table, uint keyno,
+                              const uchar *record, Fb_sparse_vector *vector);
+
+/*
+  Write the postings and stats changes of a row to a sparse vector index.
+  Its postings have the decimal indexes of the vector as terms and the
+  values as big endian floats, the term stats add the largest absolute
+  value of the term, an upper bound of its postings. old_vector is
+  removed, new_vector added, either can be nullptr.
+*/
+rocksdb::Status rdb_sparse_vector_write(rocksdb::WriteBatchBase *wb,
+                                        const Rdb_key_def &kd,
+                                        const rocksdb::Slice &old_pk,
+                                        const Fb_sparse_vector *old_vector,
+                                        const rocksdb::Slice &new_pk,
+                                        const Fb_sparse_vector *new_vector);
+
+/*
+  Adds the counters of the stats of FULLTEXT indexes, big endian int64s,
+  and keeps the max of the big endian float that ends the term stats of
+  sparse vector indexes.
+*/
+class Rdb_fulltext_merge_op : public rocksdb::AssociativeMergeOperator {
+ public:
+  bool Merge(const rocksdb::Slice &key, const rocksdb::Slice *existing_value,
+             const rocksdb::Slice &value, std::string *new_value,
+             rocksdb::Logger *logger) const override;
+
+  const char *Name() const override { return "Rdb_fulltext_merge_op"; }
+};
+
+/* One row found by a search */
+struct Rdb_fulltext_match {
+  std::string m_pk;
+  float m_score;
+};
+
+/*
+  A MATCH ... AGAINST search of a FULLTEXT index, the FT_INFO handed to the
+  sql layer. The matches are found on the first call of execute(), in the
+  snapshot of the transaction, and are read in order of relevance.
+
+  The relevance of rows read some other way is looked up by the pk of the
+  current row of the handler, rowkey.
+*/
+class Rdb_fulltext_search : public FT_INFO {
+ public:
+  /* limit is the number of rows the query needs, HA_POS_ERROR for all */
+  Rdb_fulltext_search(THD *thd, const Rdb_key_def &kd, const String *rowkey,
+                      Rdb_fulltext_terms &&terms, ha_rows limit);
+
+  Rdb_fulltext_search(const Rdb_fulltext_search &) = delete;
+  Rdb_fulltext_search &operator=(const Rdb_fulltext_search &) = delete;
+
+  /* Number of rows the query needs, before execute() */
+  void set_limit(ha_rows limit) { m_limit = limit; }
+
+  /* Find the matches, once. Returns an HA_ERR code */
+  int execute();
+
+  /* The matches found by execute(), best first */
+  const std::vector<Rdb_fulltext_match> &matches() const { return m_matches; }
+
+  /* Whether the matches are all the rows with any of the terms */
+  bool has_all_matches() const { return m_matches.size() < m_limit; }
+
+  /* Start over at the best match */
+  void rewind() {
+    m_pos = 0;
+    m_score = 0;
+  }
+
+  /* The next match in order of relevance, nullptr after the last */
+  const Rdb_fulltext_match *next();
+
+  /* Relevance of the current row of the handler, 0 if it does not match */
+  float row_relevance();
+
+  /* Relevance of the match last returned by next() */
+  float current_relevance() const { return m_score; }
+
+ private:
+  int read_stats(double *docs, double *avg_length,
+                 std::vector<std::pair<std::string, double>> *dfs) const;
+
+  THD *const m_thd;
+  const Rdb_key_def &m_kd;
+  const String *const m_rowkey;
+  const Rdb_fulltext_terms m_terms;
+  ha_rows m_limit;
+
+  bool m_executed = false;
+  std::vector<Rdb_fulltext_match> m_matches;
+  std::unordered_map<std::string, float> m_relevance;
+  size_t m_pos = 0;
+  float m_score = 0;
+};
+
+/*
+  The k rows of a sparse vector index with the largest inner product with
+  query, best first, found with WAND like the FULLTEXT matches. Rows that
+  share no index with the query have no posting and score zero: when fewer
+  than k rows score zero or more, they are read from the primary key
+  pk_descr, so the search is exact. Returns an HA_ERR code.
+*/
+int rdb_sparse_vector_search(THD *thd, const Rdb_key_def &kd,
+                             const Rdb_key_def &pk_descr,
+                             const Fb_sparse_vector &query, size_t k,
+                             std::vector<Rdb_fulltext_match> *matches);
+
+}  // namespace myrocks
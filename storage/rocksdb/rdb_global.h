@@ -20,6 +20,7 @@
 
 /* C++ standard header files */
 #include <string>
+#include <utility>
 #include <vector>
 
 #ifdef __APPLE__
@@ -142,6 +143,16 @@ const char *const INDEX_STATS_THREAD_NAME = "myrocks-is";
 */
 const char *const MANUAL_COMPACTION_THREAD_NAME = "myrocks-mc";
 
+/*
+  Name for the partial index materialization thread.
+*/
+const char *const PARTIAL_INDEX_THREAD_NAME = "myrocks-pi";
+
+/*
+  Name for the index setup thread.
+*/
+const char *const INDEX_SETUP_THREAD_NAME = "myrocks-setup";
+
 /*
   Separator between partition name and the qualifier. Sample usage:
 
@@ -192,6 +203,11 @@ const char *const RDB_PARTIAL_INDEX_KEYPARTS_QUALIFIER =
 const char *const RDB_PARTIAL_INDEX_THRESHOLD_QUALIFIER =
     "partial_group_threshold";
 
+/*
+  Qualifier name for storing the fixed-width columns at fixed offsets
+*/
+const char *const RDB_FIXED_OFFSETS_QUALIFIER = "fixed_offsets";
+
 /*
   Default, minimal valid, and maximum valid sampling rate values when collecting
   statistics about table.
@@ -391,6 +407,29 @@ typedef struct _gl_index_id_s {
   }
 } GL_INDEX_ID;
 
+/*
+ * a group of a partial index queued for materialization in the background,
+ * also exported for information_schema.rocksdb_partial_index_queue
+ */
+struct Rdb_partial_index_request {
+  GL_INDEX_ID sk_id;
+  GL_INDEX_ID pk_id;
+  std::string db_name;
+  std::string table_name;
+  std::string index_name;
+  // the sentinel key of the group
+  std::string prefix;
+  ulonglong num_rows;
+  // the rows of the group as the reader saw them, in PK and in SK format
+  std::vector<std::pair<std::string, std::string>> pk_rows;
+  std::vector<std::pair<std::string, std::string>> sk_rows;
+  time_t queued_time;
+  bool running;
+};
+
+// the queued groups, without their rows
+std::vector<Rdb_partial_index_request> rdb_get_partial_index_queue();
+
 enum operation_type : int {
   ROWS_DELETED = 0,
   ROWS_INSERTED,
@@ -459,6 +498,11 @@ struct st_export_stats {
 
   ulonglong covered_secondary_key_lookups;
   ulonglong intrinsic_tmp_table_commits;
+
+  ulonglong large_scans;
+  ulonglong large_scan_block_read_count;
+  ulonglong large_scan_block_read_bytes;
+  ulonglong large_scan_block_cache_hits;
 };
 
 /* Struct used for exporting RocksDB memory status */
@@ -43,6 +43,8 @@
 #include "./nosql_access.h"
 #include "./rdb_cf_manager.h"
 #include "./rdb_datadic.h"
+#include "./rdb_io_latency.h"
+#include "./rdb_tiered_fs.h"
 #include "./rdb_utils.h"
 // #include "sql/next_spatial_base.h"
 
@@ -434,6 +436,93 @@ static int rdb_i_s_perf_context_global_init(void *const p) {
   DBUG_RETURN(0);
 }
 
+/*
+  Support for INFORMATION_SCHEMA.ROCKSDB_PERF_CONTEXT_SAMPLES dynamic table
+ */
+namespace RDB_PERF_CONTEXT_SAMPLES_FIELD {
+enum { THREAD_ID = 0, QUERY_ID, DIGEST, QUERY_TYPE, STAT_TYPE, VALUE };
+}  // namespace RDB_PERF_CONTEXT_SAMPLES_FIELD
+
+static ST_FIELD_INFO rdb_i_s_perf_context_samples_fields_info[] = {
+    ROCKSDB_FIELD_INFO("THREAD_ID", sizeof(uint64_t), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("QUERY_ID", sizeof(uint64_t), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("DIGEST", NAME_LEN + 1, MYSQL_TYPE_STRING,
+                       MY_I_S_MAYBE_NULL),
+    ROCKSDB_FIELD_INFO("QUERY_TYPE", NAME_LEN + 1, MYSQL_TYPE_STRING,
+                       MY_I_S_MAYBE_NULL),
+    ROCKSDB_FIELD_INFO("STAT_TYPE", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("VALUE", sizeof(uint64_t), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO_END};
+
+static void rdb_i_s_store_nullable(Field *const field,
+                                   const std::string &value) {
+  if (value.empty()) {
+    field->set_null();
+  } else {
+    field->set_notnull();
+    field->store(value.c_str(), value.size(), system_charset_info);
+  }
+}
+
+static int rdb_i_s_perf_context_samples_fill_table(
+    my_core::THD *const thd, my_core::Table_ref *const tables,
+    my_core::Item *const cond MY_ATTRIBUTE((__unused__))) {
+  DBUG_ENTER_FUNC();
+
+  assert(thd != nullptr);
+  assert(tables != nullptr);
+  assert(tables->table != nullptr);
+
+  Field **field = tables->table->field;
+  assert(field != nullptr);
+
+  for (const auto &sample : rdb_get_perf_context_samples()) {
+    field[RDB_PERF_CONTEXT_SAMPLES_FIELD::THREAD_ID]->store(sample.m_thread_id,
+                                                            true);
+    field[RDB_PERF_CONTEXT_SAMPLES_FIELD::QUERY_ID]->store(sample.m_query_id,
+                                                           false);
+    rdb_i_s_store_nullable(field[RDB_PERF_CONTEXT_SAMPLES_FIELD::DIGEST],
+                           sample.m_digest);
+    rdb_i_s_store_nullable(field[RDB_PERF_CONTEXT_SAMPLES_FIELD::QUERY_TYPE],
+                           sample.m_query_type);
+
+    for (int i = 0; i < PC_MAX_IDX; i++) {
+      // only what the statement did
+      if (sample.m_value[i] == 0) continue;
+
+      field[RDB_PERF_CONTEXT_SAMPLES_FIELD::STAT_TYPE]->store(
+          rdb_pc_stat_types[i].c_str(), rdb_pc_stat_types[i].size(),
+          system_charset_info);
+      field[RDB_PERF_CONTEXT_SAMPLES_FIELD::VALUE]->store(sample.m_value[i],
+                                                          true);
+
+      const int ret = static_cast<int>(
+          my_core::schema_table_store_record(thd, tables->table));
+
+      if (ret) {
+        DBUG_RETURN(ret);
+      }
+    }
+  }
+
+  DBUG_RETURN(0);
+}
+
+static int rdb_i_s_perf_context_samples_init(void *const p) {
+  DBUG_ENTER_FUNC();
+
+  assert(p != nullptr);
+
+  my_core::ST_SCHEMA_TABLE *schema;
+
+  schema = (my_core::ST_SCHEMA_TABLE *)p;
+
+  schema->fields_info = rdb_i_s_perf_context_samples_fields_info;
+  schema->fill_table = rdb_i_s_perf_context_samples_fill_table;
+
+  DBUG_RETURN(0);
+}
+
 /*
   Support for INFORMATION_SCHEMA.ROCKSDB_CFOPTIONS dynamic table
  */
@@ -1413,6 +1502,28 @@ class Rdb_vector_index_scanner : public Rdb_tables_scanner {
   my_core::TABLE *m_table;
 };
 
+class Rdb_vector_index_stats_scanner : public Rdb_tables_scanner {
+ public:
+  Rdb_vector_index_stats_scanner(my_core::THD *thd, my_core::TABLE *table)
+      : m_thd(thd), m_table(table) {}
+  int add_table(Rdb_tbl_def *tdef) override;
+
+ private:
+  my_core::THD *m_thd;
+  my_core::TABLE *m_table;
+};
+
+class Rdb_vector_index_lists_scanner : public Rdb_tables_scanner {
+ public:
+  Rdb_vector_index_lists_scanner(my_core::THD *thd, my_core::TABLE *table)
+      : m_thd(thd), m_table(table) {}
+  int add_table(Rdb_tbl_def *tdef) override;
+
+ private:
+  my_core::THD *m_thd;
+  my_core::TABLE *m_table;
+};
+
 class Rdb_next_spatial_index_scanner : public Rdb_tables_scanner {
   public:
    Rdb_next_spatial_index_scanner(my_core::THD *thd, my_core::TABLE *table)
@@ -1691,6 +1802,17 @@ enum {
   MAX_LIST_SIZE,
   AVG_LIST_SIZE,
   MEDIAN_LIST_SIZE,
+  RETRAIN_STATE,
+  RETRAIN_ROWS,
+  RESULT_CACHE_HITS,
+  RESULT_CACHE_MISSES,
+  MIN_CENTROID_DISTANCE,
+  MAX_CENTROID_DISTANCE,
+  AVG_CENTROID_DISTANCE,
+  COUNTED_LISTS,
+  NTOTAL_LOW,
+  NTOTAL_HIGH,
+  LIST_CACHE_HIT_RATE,
 };
 }  // namespace RDB_VECTOR_INDEX_FIELD
 
@@ -1712,6 +1834,23 @@ static ST_FIELD_INFO rdb_i_s_vector_index_config_fields_info[] = {
     ROCKSDB_FIELD_INFO("AVG_LIST_SIZE", sizeof(uint64), MYSQL_TYPE_LONGLONG, 0),
     ROCKSDB_FIELD_INFO("MEDIAN_LIST_SIZE", sizeof(uint64), MYSQL_TYPE_LONGLONG,
                        0),
+    ROCKSDB_FIELD_INFO("RETRAIN_STATE", 16, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("RETRAIN_ROWS", sizeof(uint64), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("RESULT_CACHE_HITS", sizeof(uint64), MYSQL_TYPE_LONGLONG,
+                       0),
+    ROCKSDB_FIELD_INFO("RESULT_CACHE_MISSES", sizeof(uint64),
+                       MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("MIN_CENTROID_DISTANCE", sizeof(double),
+                       MYSQL_TYPE_DOUBLE, 0),
+    ROCKSDB_FIELD_INFO("MAX_CENTROID_DISTANCE", sizeof(double),
+                       MYSQL_TYPE_DOUBLE, 0),
+    ROCKSDB_FIELD_INFO("AVG_CENTROID_DISTANCE", sizeof(double),
+                       MYSQL_TYPE_DOUBLE, 0),
+    ROCKSDB_FIELD_INFO("COUNTED_LISTS", sizeof(uint64), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("NTOTAL_LOW", sizeof(uint64), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("NTOTAL_HIGH", sizeof(uint64), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("LIST_CACHE_HIT_RATE", sizeof(double),
+                       MYSQL_TYPE_DOUBLE, 0),
     ROCKSDB_FIELD_INFO_END};
 
 int Rdb_vector_index_scanner::add_table(Rdb_tbl_def *tdef) {
@@ -1773,6 +1912,29 @@ int Rdb_vector_index_scanner::add_table(Rdb_tbl_def *tdef) {
         vector_index_info.m_avg_list_size, true);
     field[RDB_VECTOR_INDEX_FIELD::MEDIAN_LIST_SIZE]->store(
         vector_index_info.m_median_list_size, true);
+    field[RDB_VECTOR_INDEX_FIELD::RETRAIN_STATE]->store(
+        vector_index_info.m_retrain_state.c_str(),
+        vector_index_info.m_retrain_state.size(), system_charset_info);
+    field[RDB_VECTOR_INDEX_FIELD::RETRAIN_ROWS]->store(
+        vector_index_info.m_retrain_rows, true);
+    field[RDB_VECTOR_INDEX_FIELD::RESULT_CACHE_HITS]->store(
+        vector_index->result_cache().hits(), true);
+    field[RDB_VECTOR_INDEX_FIELD::RESULT_CACHE_MISSES]->store(
+        vector_index->result_cache().misses(), true);
+    field[RDB_VECTOR_INDEX_FIELD::MIN_CENTROID_DISTANCE]->store(
+        vector_index_info.m_min_centroid_distance);
+    field[RDB_VECTOR_INDEX_FIELD::MAX_CENTROID_DISTANCE]->store(
+        vector_index_info.m_max_centroid_distance);
+    field[RDB_VECTOR_INDEX_FIELD::AVG_CENTROID_DISTANCE]->store(
+        vector_index_info.m_avg_centroid_distance);
+    field[RDB_VECTOR_INDEX_FIELD::COUNTED_LISTS]->store(
+        vector_index_info.m_counted_lists, true);
+    field[RDB_VECTOR_INDEX_FIELD::NTOTAL_LOW]->store(
+        vector_index_info.m_ntotal_low, true);
+    field[RDB_VECTOR_INDEX_FIELD::NTOTAL_HIGH]->store(
+        vector_index_info.m_ntotal_high, true);
+    field[RDB_VECTOR_INDEX_FIELD::LIST_CACHE_HIT_RATE]->store(
+        vector_index->list_cache_hit_rate());
 
     ret = my_core::schema_table_store_record(m_thd, m_table);
     if (ret) return ret;
@@ -1819,6 +1981,303 @@ static int rdb_i_s_vector_index_config_init(void *p) {
   DBUG_RETURN(0);
 }
 
+/*
+  Support for INFORMATION_SCHEMA.ROCKSDB_VECTOR_INDEX_STATS dynamic table
+ */
+namespace RDB_VECTOR_INDEX_STATS_FIELD {
+enum {
+  INDEX_NUMBER = 0,
+  TABLE_SCHEMA,
+  TABLE_NAME,
+  INDEX_NAME,
+  SEARCHES,
+  LISTS_PROBED,
+  VECTORS_SCANNED,
+  BYTES_DECODED,
+  ASSIGN_TIME_US,
+  SCAN_TIME_US,
+  FETCH_ROWS,
+  FETCH_TIME_US,
+  // one column per Rdb_vector_search_stats latency bucket
+  LATENCY_UNDER_100US,
+  LATENCY_UNDER_1MS,
+  LATENCY_UNDER_10MS,
+  LATENCY_UNDER_100MS,
+  LATENCY_UNDER_1S,
+  LATENCY_OVER_1S,
+};
+}  // namespace RDB_VECTOR_INDEX_STATS_FIELD
+
+static_assert(RDB_VECTOR_INDEX_STATS_FIELD::LATENCY_OVER_1S -
+                      RDB_VECTOR_INDEX_STATS_FIELD::LATENCY_UNDER_100US + 1 ==
+                  Rdb_vector_search_stats::LATENCY_BUCKETS,
+              "a column for every latency bucket");
+
+static ST_FIELD_INFO rdb_i_s_vector_index_stats_fields_info[] = {
+    ROCKSDB_FIELD_INFO("INDEX_NUMBER", sizeof(uint32), MYSQL_TYPE_LONG, 0),
+    ROCKSDB_FIELD_INFO("TABLE_SCHEMA", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("TABLE_NAME", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("INDEX_NAME", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("SEARCHES", sizeof(uint64), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("LISTS_PROBED", sizeof(uint64), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("VECTORS_SCANNED", sizeof(uint64), MYSQL_TYPE_LONGLONG,
+                       0),
+    ROCKSDB_FIELD_INFO("BYTES_DECODED", sizeof(uint64), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("ASSIGN_TIME_US", sizeof(uint64), MYSQL_TYPE_LONGLONG,
+                       0),
+    ROCKSDB_FIELD_INFO("SCAN_TIME_US", sizeof(uint64), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("FETCH_ROWS", sizeof(uint64), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("FETCH_TIME_US", sizeof(uint64), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("LATENCY_UNDER_100US", sizeof(uint64),
+                       MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("LATENCY_UNDER_1MS", sizeof(uint64), MYSQL_TYPE_LONGLONG,
+                       0),
+    ROCKSDB_FIELD_INFO("LATENCY_UNDER_10MS", sizeof(uint64),
+                       MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("LATENCY_UNDER_100MS", sizeof(uint64),
+                       MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("LATENCY_UNDER_1S", sizeof(uint64), MYSQL_TYPE_LONGLONG,
+                       0),
+    ROCKSDB_FIELD_INFO("LATENCY_OVER_1S", sizeof(uint64), MYSQL_TYPE_LONGLONG,
+                       0),
+    ROCKSDB_FIELD_INFO_END};
+
+int Rdb_vector_index_stats_scanner::add_table(Rdb_tbl_def *tdef) {
+  assert(tdef != nullptr);
+
+  int ret = 0;
+
+  assert(m_table != nullptr);
+  Field **field = m_table->field;
+  assert(field != nullptr);
+
+  const std::string &dbname = tdef->base_dbname();
+  field[RDB_VECTOR_INDEX_STATS_FIELD::TABLE_SCHEMA]->store(
+      dbname.c_str(), dbname.size(), system_charset_info);
+
+  const std::string &tablename = tdef->base_tablename();
+  field[RDB_VECTOR_INDEX_STATS_FIELD::TABLE_NAME]->store(
+      tablename.c_str(), tablename.size(), system_charset_info);
+
+  for (uint i = 0; i < tdef->m_key_count; i++) {
+    const Rdb_key_def &kd = *tdef->m_key_descr_arr[i];
+    if (!kd.is_vector_index()) {
+      continue;
+    }
+
+    field[RDB_VECTOR_INDEX_STATS_FIELD::INDEX_NAME]->store(
+        kd.m_name.c_str(), kd.m_name.size(), system_charset_info);
+    field[RDB_VECTOR_INDEX_STATS_FIELD::INDEX_NUMBER]->store(
+        kd.get_gl_index_id().index_id, true);
+
+    const auto &stats = kd.get_vector_index()->search_stats();
+    field[RDB_VECTOR_INDEX_STATS_FIELD::SEARCHES]->store(stats.searches(),
+                                                         true);
+    field[RDB_VECTOR_INDEX_STATS_FIELD::LISTS_PROBED]->store(
+        stats.lists_probed(), true);
+    field[RDB_VECTOR_INDEX_STATS_FIELD::VECTORS_SCANNED]->store(
+        stats.vectors_scanned(), true);
+    field[RDB_VECTOR_INDEX_STATS_FIELD::BYTES_DECODED]->store(
+        stats.bytes_decoded(), true);
+    field[RDB_VECTOR_INDEX_STATS_FIELD::ASSIGN_TIME_US]->store(
+        stats.assign_time_us(), true);
+    field[RDB_VECTOR_INDEX_STATS_FIELD::SCAN_TIME_US]->store(
+        stats.scan_time_us(), true);
+    field[RDB_VECTOR_INDEX_STATS_FIELD::FETCH_ROWS]->store(stats.fetch_rows(),
+                                                           true);
+    field[RDB_VECTOR_INDEX_STATS_FIELD::FETCH_TIME_US]->store(
+        stats.fetch_time_us(), true);
+    for (std::size_t bucket = 0;
+         bucket < Rdb_vector_search_stats::LATENCY_BUCKETS; bucket++) {
+      field[RDB_VECTOR_INDEX_STATS_FIELD::LATENCY_UNDER_100US + bucket]->store(
+          stats.latency(bucket), true);
+    }
+
+    ret = my_core::schema_table_store_record(m_thd, m_table);
+    if (ret) return ret;
+  }
+  return HA_EXIT_SUCCESS;
+}
+
+static int rdb_i_s_vector_index_stats_fill_table(
+    my_core::THD *thd, my_core::Table_ref *tables,
+    my_core::Item *cond MY_ATTRIBUTE((__unused__))) {
+  DBUG_ENTER_FUNC();
+
+  assert(thd != nullptr);
+  assert(tables != nullptr);
+  assert(tables->table != nullptr);
+
+  int ret = HA_EXIT_SUCCESS;
+  rocksdb::DB *const rdb = rdb_get_rocksdb_db();
+
+  if (!rdb) {
+    DBUG_RETURN(ret);
+  }
+
+  Rdb_vector_index_stats_scanner ddl_arg(thd, tables->table);
+  Rdb_ddl_manager *ddl_manager = rdb_get_ddl_manager();
+  assert(ddl_manager != nullptr);
+
+  ret = ddl_manager->scan_for_tables(&ddl_arg);
+
+  DBUG_RETURN(ret);
+}
+
+static int rdb_i_s_vector_index_stats_init(void *p) {
+  my_core::ST_SCHEMA_TABLE *schema;
+
+  DBUG_ENTER_FUNC();
+  assert(p != nullptr);
+
+  schema = reinterpret_cast<my_core::ST_SCHEMA_TABLE *>(p);
+
+  schema->fields_info = rdb_i_s_vector_index_stats_fields_info;
+  schema->fill_table = rdb_i_s_vector_index_stats_fill_table;
+
+  DBUG_RETURN(0);
+}
+
+/*
+  Support for INFORMATION_SCHEMA.ROCKSDB_VECTOR_INDEX_LISTS dynamic table
+ */
+namespace RDB_VECTOR_INDEX_LISTS_FIELD {
+enum {
+  INDEX_NUMBER = 0,
+  TABLE_SCHEMA,
+  TABLE_NAME,
+  INDEX_NAME,
+  LIST_NO,
+  LIST_SIZE,
+  DISTANCE_COUNT,
+  MIN_CENTROID_DISTANCE,
+  MAX_CENTROID_DISTANCE,
+  AVG_CENTROID_DISTANCE,
+};
+}  // namespace RDB_VECTOR_INDEX_LISTS_FIELD
+
+static ST_FIELD_INFO rdb_i_s_vector_index_lists_fields_info[] = {
+    ROCKSDB_FIELD_INFO("INDEX_NUMBER", sizeof(uint32), MYSQL_TYPE_LONG, 0),
+    ROCKSDB_FIELD_INFO("TABLE_SCHEMA", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("TABLE_NAME", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("INDEX_NAME", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("LIST_NO", sizeof(uint64), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("LIST_SIZE", sizeof(uint64), MYSQL_TYPE_LONGLONG,
+                       MY_I_S_MAYBE_NULL),
+    ROCKSDB_FIELD_INFO("DISTANCE_COUNT", sizeof(uint64), MYSQL_TYPE_LONGLONG,
+                       0),
+    ROCKSDB_FIELD_INFO("MIN_CENTROID_DISTANCE", sizeof(double),
+                       MYSQL_TYPE_DOUBLE, MY_I_S_MAYBE_NULL),
+    ROCKSDB_FIELD_INFO("MAX_CENTROID_DISTANCE", sizeof(double),
+                       MYSQL_TYPE_DOUBLE, MY_I_S_MAYBE_NULL),
+    ROCKSDB_FIELD_INFO("AVG_CENTROID_DISTANCE", sizeof(double),
+                       MYSQL_TYPE_DOUBLE, MY_I_S_MAYBE_NULL),
+    ROCKSDB_FIELD_INFO_END};
+
+/* LIST_SIZE is NULL until the list is counted, the distances until the
+   list is compacted */
+int Rdb_vector_index_lists_scanner::add_table(Rdb_tbl_def *tdef) {
+  assert(tdef != nullptr);
+
+  int ret = 0;
+
+  assert(m_table != nullptr);
+  Field **field = m_table->field;
+  assert(field != nullptr);
+
+  const std::string &dbname = tdef->base_dbname();
+  field[RDB_VECTOR_INDEX_LISTS_FIELD::TABLE_SCHEMA]->store(
+      dbname.c_str(), dbname.size(), system_charset_info);
+
+  const std::string &tablename = tdef->base_tablename();
+  field[RDB_VECTOR_INDEX_LISTS_FIELD::TABLE_NAME]->store(
+      tablename.c_str(), tablename.size(), system_charset_info);
+
+  for (uint i = 0; i < tdef->m_key_count; i++) {
+    const Rdb_key_def &kd = *tdef->m_key_descr_arr[i];
+    if (!kd.is_vector_index() || kd.get_vector_index() == nullptr) {
+      continue;
+    }
+
+    field[RDB_VECTOR_INDEX_LISTS_FIELD::INDEX_NAME]->store(
+        kd.m_name.c_str(), kd.m_name.size(), system_charset_info);
+    field[RDB_VECTOR_INDEX_LISTS_FIELD::INDEX_NUMBER]->store(
+        kd.get_gl_index_id().index_id, true);
+
+    for (const auto &list : kd.get_vector_index()->dump_lists()) {
+      field[RDB_VECTOR_INDEX_LISTS_FIELD::LIST_NO]->store(list.m_list_no,
+                                                          true);
+      if (list.m_size >= 0) {
+        field[RDB_VECTOR_INDEX_LISTS_FIELD::LIST_SIZE]->set_notnull();
+        field[RDB_VECTOR_INDEX_LISTS_FIELD::LIST_SIZE]->store(list.m_size,
+                                                              true);
+      } else {
+        field[RDB_VECTOR_INDEX_LISTS_FIELD::LIST_SIZE]->set_null();
+      }
+      field[RDB_VECTOR_INDEX_LISTS_FIELD::DISTANCE_COUNT]->store(
+          list.m_distance_count, true);
+      const std::pair<uint, float> distances[] = {
+          {RDB_VECTOR_INDEX_LISTS_FIELD::MIN_CENTROID_DISTANCE,
+           list.m_min_distance},
+          {RDB_VECTOR_INDEX_LISTS_FIELD::MAX_CENTROID_DISTANCE,
+           list.m_max_distance},
+          {RDB_VECTOR_INDEX_LISTS_FIELD::AVG_CENTROID_DISTANCE,
+           list.m_avg_distance}};
+      for (const auto &distance : distances) {
+        if (list.m_distance_count > 0) {
+          field[distance.first]->set_notnull();
+          field[distance.first]->store(distance.second);
+        } else {
+          field[distance.first]->set_null();
+        }
+      }
+
+      ret = my_core::schema_table_store_record(m_thd, m_table);
+      if (ret) return ret;
+    }
+  }
+  return HA_EXIT_SUCCESS;
+}
+
+static int rdb_i_s_vector_index_lists_fill_table(
+    my_core::THD *thd, my_core::Table_ref *tables,
+    my_core::Item *cond MY_ATTRIBUTE((__unused__))) {
+  DBUG_ENTER_FUNC();
+
+  assert(thd != nullptr);
+  assert(tables != nullptr);
+  assert(tables->table != nullptr);
+
+  int ret = HA_EXIT_SUCCESS;
+  rocksdb::DB *const rdb = rdb_get_rocksdb_db();
+
+  if (!rdb) {
+    DBUG_RETURN(ret);
+  }
+
+  Rdb_vector_index_lists_scanner ddl_arg(thd, tables->table);
+  Rdb_ddl_manager *ddl_manager = rdb_get_ddl_manager();
+  assert(ddl_manager != nullptr);
+
+  ret = ddl_manager->scan_for_tables(&ddl_arg);
+
+  DBUG_RETURN(ret);
+}
+
+static int rdb_i_s_vector_index_lists_init(void *p) {
+  my_core::ST_SCHEMA_TABLE *schema;
+
+  DBUG_ENTER_FUNC();
+  assert(p != nullptr);
+
+  schema = reinterpret_cast<my_core::ST_SCHEMA_TABLE *>(p);
+
+  schema->fields_info = rdb_i_s_vector_index_lists_fields_info;
+  schema->fill_table = rdb_i_s_vector_index_lists_fill_table;
+
+  DBUG_RETURN(0);
+}
+
 /*
   Support for INFORMATION_SCHEMA.ROCKSDB_NEXT_SPATIAL_INDEX dynamic table
  */
@@ -1963,6 +2422,9 @@ enum {
   OLDEST_KEY_TIME,
   FILTER_POLICY,
   COMPRESSION_OPTIONS,
+  LEVEL,
+  TEMPERATURE,
+  STORAGE_DIR,
 };
 }  // namespace RDB_SST_PROPS_FIELD
 
@@ -1996,6 +2458,11 @@ static ST_FIELD_INFO rdb_i_s_sst_props_fields_info[] = {
                        MY_I_S_MAYBE_NULL),
     ROCKSDB_FIELD_INFO("COMPRESSION_OPTIONS", NAME_LEN + 1, MYSQL_TYPE_STRING,
                        MY_I_S_MAYBE_NULL),
+    ROCKSDB_FIELD_INFO("LEVEL", sizeof(int32_t), MYSQL_TYPE_LONG,
+                       MY_I_S_MAYBE_NULL),
+    ROCKSDB_FIELD_INFO("TEMPERATURE", NAME_LEN + 1, MYSQL_TYPE_STRING,
+                       MY_I_S_MAYBE_NULL),
+    ROCKSDB_FIELD_INFO("STORAGE_DIR", FN_REFLEN + 1, MYSQL_TYPE_STRING, 0),
     ROCKSDB_FIELD_INFO_END};
 
 static int rdb_i_s_sst_props_fill_table(
@@ -2020,6 +2487,14 @@ static int rdb_i_s_sst_props_fill_table(
 
   const Rdb_cf_manager &cf_manager = rdb_get_cf_manager();
 
+  /* the level and temperature of the files, the properties have neither */
+  std::vector<rocksdb::LiveFileMetaData> metadata;
+  rdb->GetLiveFilesMetaData(&metadata);
+  std::map<std::string, const rocksdb::LiveFileMetaData *> live_files;
+  for (const auto &file : metadata) {
+    live_files.emplace(file.relative_filename, &file);
+  }
+
   for (const auto &cf_handle : cf_manager.get_all_cf()) {
     /* Grab the the properties of all the tables in the column family */
     rocksdb::TablePropertiesCollection table_props_collection;
@@ -2091,7 +2566,24 @@ static int rdb_i_s_sst_props_fill_table(
             props.second->compression_options.c_str(),
             props.second->compression_options.size(), system_charset_info);
       }
-
+      const auto live_file = live_files.find(sst_name);
+      if (live_file == live_files.end()) {
+        field[RDB_SST_PROPS_FIELD::LEVEL]->set_null();
+        field[RDB_SST_PROPS_FIELD::TEMPERATURE]->set_null();
+      } else {
+        const std::string temperature =
+            GetTemperatureString(live_file->second->temperature);
+        field[RDB_SST_PROPS_FIELD::LEVEL]->set_notnull();
+        field[RDB_SST_PROPS_FIELD::LEVEL]->store(live_file->second->level,
+                                                 false);
+        field[RDB_SST_PROPS_FIELD::TEMPERATURE]->set_notnull();
+        field[RDB_SST_PROPS_FIELD::TEMPERATURE]->store(
+            temperature.c_str(), temperature.size(), system_charset_info);
+      }
+      const std::string storage_dir = Rdb_tiered_fs::storage_dir(props.first);
+      field[RDB_SST_PROPS_FIELD::STORAGE_DIR]->store(
+          storage_dir.c_str(), storage_dir.size(), system_charset_info);
+
       /* Tell MySQL about this row in the virtual table */
       ret = static_cast<int>(
           my_core::schema_table_store_record(thd, tables->table));
@@ -2616,6 +3108,677 @@ static int rdb_i_s_deadlock_info_init(void *const p) {
   DBUG_RETURN(0);
 }
 
+/*
+  Support for INFORMATION_SCHEMA.ROCKSDB_PARTIAL_INDEX_QUEUE dynamic table
+ */
+namespace RDB_PARTIAL_INDEX_QUEUE_FIELD {
+enum {
+  TABLE_SCHEMA = 0,
+  TABLE_NAME,
+  INDEX_NAME,
+  COLUMN_FAMILY,
+  INDEX_NUMBER,
+  PREFIX,
+  ROWS,
+  STATE,
+  QUEUED_SECONDS
+};
+}  // namespace RDB_PARTIAL_INDEX_QUEUE_FIELD
+
+static ST_FIELD_INFO rdb_i_s_partial_index_queue_fields_info[] = {
+    ROCKSDB_FIELD_INFO("TABLE_SCHEMA", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("TABLE_NAME", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("INDEX_NAME", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("COLUMN_FAMILY", sizeof(uint32_t), MYSQL_TYPE_LONG, 0),
+    ROCKSDB_FIELD_INFO("INDEX_NUMBER", sizeof(uint32_t), MYSQL_TYPE_LONG, 0),
+    ROCKSDB_FIELD_INFO("PREFIX", FN_REFLEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("ROWS", sizeof(ulonglong), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("STATE", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("QUEUED_SECONDS", sizeof(ulonglong), MYSQL_TYPE_LONGLONG,
+                       0),
+    ROCKSDB_FIELD_INFO_END};
+
+/* Fill the information_schema.rocksdb_partial_index_queue virtual table */
+static int rdb_i_s_partial_index_queue_fill_table(
+    my_core::THD *const thd, my_core::Table_ref *const tables,
+    my_core::Item *const cond MY_ATTRIBUTE((__unused__))) {
+  DBUG_ENTER_FUNC();
+
+  assert(thd != nullptr);
+  assert(tables != nullptr);
+  assert(tables->table != nullptr);
+  assert(tables->table->field != nullptr);
+
+  int ret = 0;
+  if (!rdb_get_rocksdb_db()) {
+    DBUG_RETURN(ret);
+  }
+
+  const time_t now = time(nullptr);
+  Field **field = tables->table->field;
+  for (const auto &req : rdb_get_partial_index_queue()) {
+    const auto prefix_hexstr =
+        rdb_hexdump(req.prefix.data(), req.prefix.size());
+    const std::string state = req.running ? "RUNNING" : "QUEUED";
+
+    field[RDB_PARTIAL_INDEX_QUEUE_FIELD::TABLE_SCHEMA]->store(
+        req.db_name.c_str(), req.db_name.length(), system_charset_info);
+    field[RDB_PARTIAL_INDEX_QUEUE_FIELD::TABLE_NAME]->store(
+        req.table_name.c_str(), req.table_name.length(), system_charset_info);
+    field[RDB_PARTIAL_INDEX_QUEUE_FIELD::INDEX_NAME]->store(
+        req.index_name.c_str(), req.index_name.length(), system_charset_info);
+    field[RDB_PARTIAL_INDEX_QUEUE_FIELD::COLUMN_FAMILY]->store(req.sk_id.cf_id,
+                                                              true);
+    field[RDB_PARTIAL_INDEX_QUEUE_FIELD::INDEX_NUMBER]->store(
+        req.sk_id.index_id, true);
+    field[RDB_PARTIAL_INDEX_QUEUE_FIELD::PREFIX]->store(
+        prefix_hexstr.c_str(), prefix_hexstr.length(), system_charset_info);
+    field[RDB_PARTIAL_INDEX_QUEUE_FIELD::ROWS]->store(req.num_rows, true);
+    field[RDB_PARTIAL_INDEX_QUEUE_FIELD::STATE]->store(
+        state.c_str(), state.length(), system_charset_info);
+    field[RDB_PARTIAL_INDEX_QUEUE_FIELD::QUEUED_SECONDS]->store(
+        now > req.queued_time ? now - req.queued_time : 0, true);
+
+    /* Tell MySQL about this row in the virtual table */
+    ret = static_cast<int>(
+        my_core::schema_table_store_record(thd, tables->table));
+
+    if (ret != 0) {
+      break;
+    }
+  }
+
+  DBUG_RETURN(ret);
+}
+
+/* Initialize the information_schema.rocksdb_partial_index_queue table */
+static int rdb_i_s_partial_index_queue_init(void *const p) {
+  DBUG_ENTER_FUNC();
+
+  assert(p != nullptr);
+
+  my_core::ST_SCHEMA_TABLE *schema;
+
+  schema = (my_core::ST_SCHEMA_TABLE *)p;
+
+  schema->fields_info = rdb_i_s_partial_index_queue_fields_info;
+  schema->fill_table = rdb_i_s_partial_index_queue_fill_table;
+
+  DBUG_RETURN(0);
+}
+
+/*
+  Support for INFORMATION_SCHEMA.ROCKSDB_STARTUP_TIMELINE dynamic table
+ */
+namespace RDB_STARTUP_TIMELINE_FIELD {
+enum { PHASE = 0, START_US, DURATION_US, ITEMS };
+}  // namespace RDB_STARTUP_TIMELINE_FIELD
+
+static ST_FIELD_INFO rdb_i_s_startup_timeline_fields_info[] = {
+    ROCKSDB_FIELD_INFO("PHASE", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("START_US", sizeof(ulonglong), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("DURATION_US", sizeof(ulonglong), MYSQL_TYPE_LONGLONG,
+                       0),
+    ROCKSDB_FIELD_INFO("ITEMS", sizeof(ulonglong), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO_END};
+
+/* Fill the information_schema.rocksdb_startup_timeline virtual table */
+static int rdb_i_s_startup_timeline_fill_table(
+    my_core::THD *const thd, my_core::Table_ref *const tables,
+    my_core::Item *const cond MY_ATTRIBUTE((__unused__))) {
+  DBUG_ENTER_FUNC();
+
+  assert(thd != nullptr);
+  assert(tables != nullptr);
+  assert(tables->table != nullptr);
+  assert(tables->table->field != nullptr);
+
+  int ret = 0;
+  Field **field = tables->table->field;
+  for (const auto &entry : rdb_get_startup_timeline().entries()) {
+    field[RDB_STARTUP_TIMELINE_FIELD::PHASE]->store(
+        entry.name.c_str(), entry.name.length(), system_charset_info);
+    field[RDB_STARTUP_TIMELINE_FIELD::START_US]->store(entry.start_us, true);
+    field[RDB_STARTUP_TIMELINE_FIELD::DURATION_US]->store(entry.elapsed_us,
+                                                          true);
+    field[RDB_STARTUP_TIMELINE_FIELD::ITEMS]->store(entry.items, true);
+
+    /* Tell MySQL about this row in the virtual table */
+    ret = static_cast<int>(
+        my_core::schema_table_store_record(thd, tables->table));
+
+    if (ret != 0) {
+      break;
+    }
+  }
+
+  DBUG_RETURN(ret);
+}
+
+/* Initialize the information_schema.rocksdb_startup_timeline table */
+static int rdb_i_s_startup_timeline_init(void *const p) {
+  DBUG_ENTER_FUNC();
+
+  assert(p != nullptr);
+
+  my_core::ST_SCHEMA_TABLE *schema;
+
+  schema = (my_core::ST_SCHEMA_TABLE *)p;
+
+  schema->fields_info = rdb_i_s_startup_timeline_fields_info;
+  schema->fill_table = rdb_i_s_startup_timeline_fill_table;
+
+  DBUG_RETURN(0);
+}
+
+/*
+  Support for INFORMATION_SCHEMA.ROCKSDB_CF_WRITE_THROTTLE dynamic table
+ */
+namespace RDB_CF_WRITE_THROTTLE_FIELD {
+enum {
+  CF_NAME = 0,
+  CONDITION,
+  SECONDS_IN_CONDITION,
+  STALL_EVENTS,
+  DELAYED_WRITES,
+  SHED_WRITES
+};
+}  // namespace RDB_CF_WRITE_THROTTLE_FIELD
+
+static ST_FIELD_INFO rdb_i_s_cf_write_throttle_fields_info[] = {
+    ROCKSDB_FIELD_INFO("CF_NAME", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("CONDITION", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("SECONDS_IN_CONDITION", sizeof(ulonglong),
+                       MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("STALL_EVENTS", sizeof(ulonglong), MYSQL_TYPE_LONGLONG,
+                       0),
+    ROCKSDB_FIELD_INFO("DELAYED_WRITES", sizeof(ulonglong),
+                       MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("SHED_WRITES", sizeof(ulonglong), MYSQL_TYPE_LONGLONG,
+                       0),
+    ROCKSDB_FIELD_INFO_END};
+
+static const char *rdb_write_stall_condition_name(
+    const rocksdb::WriteStallCondition condition) {
+  switch (condition) {
+    case rocksdb::WriteStallCondition::kDelayed:
+      return "DELAYED";
+    case rocksdb::WriteStallCondition::kStopped:
+      return "STOPPED";
+    default:
+      return "NORMAL";
+  }
+}
+
+/* Fill the information_schema.rocksdb_cf_write_throttle virtual table */
+static int rdb_i_s_cf_write_throttle_fill_table(
+    my_core::THD *const thd, my_core::Table_ref *const tables,
+    my_core::Item *const cond MY_ATTRIBUTE((__unused__))) {
+  DBUG_ENTER_FUNC();
+
+  assert(thd != nullptr);
+  assert(tables != nullptr);
+  assert(tables->table != nullptr);
+  assert(tables->table->field != nullptr);
+
+  int ret = 0;
+  if (!rdb_get_rocksdb_db()) {
+    DBUG_RETURN(ret);
+  }
+
+  const time_t now = time(nullptr);
+  Field **field = tables->table->field;
+  for (const auto &record : cf_write_throttle.get_records()) {
+    const std::string condition =
+        rdb_write_stall_condition_name(record.condition);
+
+    field[RDB_CF_WRITE_THROTTLE_FIELD::CF_NAME]->store(
+        record.cf_name.c_str(), record.cf_name.length(), system_charset_info);
+    field[RDB_CF_WRITE_THROTTLE_FIELD::CONDITION]->store(
+        condition.c_str(), condition.length(), system_charset_info);
+    field[RDB_CF_WRITE_THROTTLE_FIELD::SECONDS_IN_CONDITION]->store(
+        now > record.since ? now - record.since : 0, true);
+    field[RDB_CF_WRITE_THROTTLE_FIELD::STALL_EVENTS]->store(
+        record.stall_events, true);
+    field[RDB_CF_WRITE_THROTTLE_FIELD::DELAYED_WRITES]->store(
+        record.delayed_writes, true);
+    field[RDB_CF_WRITE_THROTTLE_FIELD::SHED_WRITES]->store(record.shed_writes,
+                                                          true);
+
+    /* Tell MySQL about this row in the virtual table */
+    ret = static_cast<int>(
+        my_core::schema_table_store_record(thd, tables->table));
+
+    if (ret != 0) {
+      break;
+    }
+  }
+
+  DBUG_RETURN(ret);
+}
+
+/* Initialize the information_schema.rocksdb_cf_write_throttle table */
+static int rdb_i_s_cf_write_throttle_init(void *const p) {
+  DBUG_ENTER_FUNC();
+
+  assert(p != nullptr);
+
+  my_core::ST_SCHEMA_TABLE *schema;
+
+  schema = (my_core::ST_SCHEMA_TABLE *)p;
+
+  schema->fields_info = rdb_i_s_cf_write_throttle_fields_info;
+  schema->fill_table = rdb_i_s_cf_write_throttle_fill_table;
+
+  DBUG_RETURN(0);
+}
+
+/*
+  Support for INFORMATION_SCHEMA.ROCKSDB_KEY_ACCESS_RECOMMENDATIONS dynamic
+  table
+ */
+namespace RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD {
+enum {
+  COLUMN_FAMILY = 0,
+  INDEX_NUMBER,
+  CF_NAME,
+  INDEX_NAME,
+  SAMPLED_SEEKS,
+  SAMPLED_GETS,
+  SAMPLED_GET_MISSES,
+  PREFIX_EXTRACTOR,
+  RECOMMENDED_PREFIX_LENGTH,
+  RECOMMENDED_BLOOM_BITS,
+  RECOMMENDED_CF_OPTIONS
+};
+}  // namespace RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD
+
+static ST_FIELD_INFO rdb_i_s_key_access_recommendations_fields_info[] = {
+    ROCKSDB_FIELD_INFO("COLUMN_FAMILY", sizeof(uint32_t), MYSQL_TYPE_LONG, 0),
+    ROCKSDB_FIELD_INFO("INDEX_NUMBER", sizeof(uint32_t), MYSQL_TYPE_LONG, 0),
+    ROCKSDB_FIELD_INFO("CF_NAME", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("INDEX_NAME", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("SAMPLED_SEEKS", sizeof(ulonglong), MYSQL_TYPE_LONGLONG,
+                       0),
+    ROCKSDB_FIELD_INFO("SAMPLED_GETS", sizeof(ulonglong), MYSQL_TYPE_LONGLONG,
+                       0),
+    ROCKSDB_FIELD_INFO("SAMPLED_GET_MISSES", sizeof(ulonglong),
+                       MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("PREFIX_EXTRACTOR", NAME_LEN + 1, MYSQL_TYPE_STRING,
+                       MY_I_S_MAYBE_NULL),
+    ROCKSDB_FIELD_INFO("RECOMMENDED_PREFIX_LENGTH", sizeof(uint32_t),
+                       MYSQL_TYPE_LONG, MY_I_S_MAYBE_NULL),
+    ROCKSDB_FIELD_INFO("RECOMMENDED_BLOOM_BITS", sizeof(uint32_t),
+                       MYSQL_TYPE_LONG, MY_I_S_MAYBE_NULL),
+    ROCKSDB_FIELD_INFO("RECOMMENDED_CF_OPTIONS", FN_REFLEN + 1,
+                       MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO_END};
+
+/* the share of the seeks the recommended prefix bloom filter must serve */
+static constexpr double RDB_PREFIX_BLOOM_SEEK_SHARE = 0.9;
+
+/* the levels of the column family a point read may probe */
+static uint rdb_cf_probed_levels(rocksdb::DB *const rdb,
+                                 rocksdb::ColumnFamilyHandle &cf) {
+  rocksdb::ColumnFamilyMetaData metadata;
+  rdb->GetColumnFamilyMetaData(&cf, &metadata);
+
+  uint levels = 0;
+  for (const auto &level : metadata.levels) {
+    // the files of L0 overlap, each of them is probed
+    levels += (level.level == 0) ? level.files.size() : !level.files.empty();
+  }
+  return levels;
+}
+
+/*
+  Fill the information_schema.rocksdb_key_access_recommendations virtual
+  table. The recommendations are for each index; the indexes of a column
+  family share its prefix extractor and bloom filter.
+*/
+static int rdb_i_s_key_access_recommendations_fill_table(
+    my_core::THD *const thd, my_core::Table_ref *const tables,
+    my_core::Item *const cond MY_ATTRIBUTE((__unused__))) {
+  DBUG_ENTER_FUNC();
+
+  assert(thd != nullptr);
+  assert(tables != nullptr);
+  assert(tables->table != nullptr);
+  assert(tables->table->field != nullptr);
+
+  int ret = 0;
+  rocksdb::DB *const rdb = rdb_get_rocksdb_db();
+  if (!rdb) {
+    DBUG_RETURN(ret);
+  }
+
+  Rdb_ddl_manager *const ddl_manager = rdb_get_ddl_manager();
+  assert(ddl_manager != nullptr);
+
+  Field **field = tables->table->field;
+  for (const auto &record : key_access_sampler.get_records()) {
+    const auto kd = ddl_manager->safe_find(record.gl_index_id);
+    if (!kd) {
+      continue;
+    }
+
+    const std::string cf_name = kd->get_cf().GetName();
+    const rocksdb::SliceTransform *const extractor = kd->get_extractor();
+    std::string cf_options;
+
+    field[RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD::COLUMN_FAMILY]->store(
+        record.gl_index_id.cf_id, true);
+    field[RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD::INDEX_NUMBER]->store(
+        record.gl_index_id.index_id, true);
+    field[RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD::CF_NAME]->store(
+        cf_name.c_str(), cf_name.length(), system_charset_info);
+    field[RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD::INDEX_NAME]->store(
+        kd->get_name().c_str(), kd->get_name().length(), system_charset_info);
+    field[RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD::SAMPLED_SEEKS]->store(
+        record.seeks, true);
+    field[RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD::SAMPLED_GETS]->store(
+        record.gets, true);
+    field[RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD::SAMPLED_GET_MISSES]->store(
+        record.get_misses, true);
+
+    if (extractor) {
+      const char *const name = extractor->Name();
+      field[RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD::PREFIX_EXTRACTOR]
+          ->set_notnull();
+      field[RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD::PREFIX_EXTRACTOR]->store(
+          name, strlen(name), system_charset_info);
+    } else {
+      field[RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD::PREFIX_EXTRACTOR]
+          ->set_null();
+    }
+
+    if (record.seeks > 0) {
+      const uint prefix_len =
+          record.recommended_prefix_len(RDB_PREFIX_BLOOM_SEEK_SHARE);
+      field[RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD::RECOMMENDED_PREFIX_LENGTH]
+          ->set_notnull();
+      field[RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD::RECOMMENDED_PREFIX_LENGTH]
+          ->store(prefix_len, true);
+      cf_options = "prefix_extractor=capped:" + std::to_string(prefix_len);
+    } else {
+      field[RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD::RECOMMENDED_PREFIX_LENGTH]
+          ->set_null();
+    }
+
+    if (record.gets > 0) {
+      const uint bloom_bits = record.recommended_bloom_bits(
+          rdb_cf_probed_levels(rdb, kd->get_cf()));
+      field[RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD::RECOMMENDED_BLOOM_BITS]
+          ->set_notnull();
+      field[RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD::RECOMMENDED_BLOOM_BITS]
+          ->store(bloom_bits, true);
+      if (bloom_bits > 0) {
+        if (!cf_options.empty()) cf_options += ';';
+        cf_options += "block_based_table_factory={filter_policy=bloomfilter:" +
+                      std::to_string(bloom_bits) + ":false}";
+      }
+    } else {
+      field[RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD::RECOMMENDED_BLOOM_BITS]
+          ->set_null();
+    }
+
+    field[RDB_KEY_ACCESS_RECOMMENDATIONS_FIELD::RECOMMENDED_CF_OPTIONS]->store(
+        cf_options.c_str(), cf_options.length(), system_charset_info);
+
+    /* Tell MySQL about this row in the virtual table */
+    ret = static_cast<int>(
+        my_core::schema_table_store_record(thd, tables->table));
+
+    if (ret != 0) {
+      break;
+    }
+  }
+
+  DBUG_RETURN(ret);
+}
+
+/* Initialize the information_schema.rocksdb_key_access_recommendations table */
+static int rdb_i_s_key_access_recommendations_init(void *const p) {
+  DBUG_ENTER_FUNC();
+
+  assert(p != nullptr);
+
+  my_core::ST_SCHEMA_TABLE *schema;
+
+  schema = (my_core::ST_SCHEMA_TABLE *)p;
+
+  schema->fields_info = rdb_i_s_key_access_recommendations_fields_info;
+  schema->fill_table = rdb_i_s_key_access_recommendations_fill_table;
+
+  DBUG_RETURN(0);
+}
+
+/*
+  Support for INFORMATION_SCHEMA.ROCKSDB_IO_LATENCY dynamic table
+ */
+namespace RDB_IO_LATENCY_FIELD {
+enum {
+  DEVICE = 0,
+  PATH,
+  OPERATION,
+  COUNT,
+  AVERAGE_US,
+  P50_US,
+  P95_US,
+  P99_US,
+  P999_US,
+  MAX_US,
+  SLOW_COUNT
+};
+}  // namespace RDB_IO_LATENCY_FIELD
+
+static ST_FIELD_INFO rdb_i_s_io_latency_fields_info[] = {
+    ROCKSDB_FIELD_INFO("DEVICE", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("PATH", FN_REFLEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("OPERATION", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("COUNT", sizeof(ulonglong), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("AVERAGE_US", sizeof(double), MYSQL_TYPE_DOUBLE, 0),
+    ROCKSDB_FIELD_INFO("P50_US", sizeof(double), MYSQL_TYPE_DOUBLE, 0),
+    ROCKSDB_FIELD_INFO("P95_US", sizeof(double), MYSQL_TYPE_DOUBLE, 0),
+    ROCKSDB_FIELD_INFO("P99_US", sizeof(double), MYSQL_TYPE_DOUBLE, 0),
+    ROCKSDB_FIELD_INFO("P999_US", sizeof(double), MYSQL_TYPE_DOUBLE, 0),
+    ROCKSDB_FIELD_INFO("MAX_US", sizeof(ulonglong), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("SLOW_COUNT", sizeof(ulonglong), MYSQL_TYPE_LONGLONG,
+                       0),
+    ROCKSDB_FIELD_INFO_END};
+
+/* Fill the information_schema.rocksdb_io_latency virtual table */
+static int rdb_i_s_io_latency_fill_table(
+    my_core::THD *const thd, my_core::Table_ref *const tables,
+    my_core::Item *const cond MY_ATTRIBUTE((__unused__))) {
+  DBUG_ENTER_FUNC();
+
+  assert(thd != nullptr);
+  assert(tables != nullptr);
+  assert(tables->table != nullptr);
+  assert(tables->table->field != nullptr);
+
+  int ret = 0;
+  const Rdb_io_latency_fs *const fs = rdb_get_io_latency_fs();
+  if (!fs) {
+    DBUG_RETURN(ret);
+  }
+
+  Field **field = tables->table->field;
+  for (const Rdb_io_device *device : fs->get_devices()) {
+    for (uint op = 0; op < RDB_IO_OPS; op++) {
+      const rocksdb::HistogramImpl &latencies = device->latencies[op];
+      const char *const op_name = rdb_io_op_name(static_cast<Rdb_io_op>(op));
+
+      field[RDB_IO_LATENCY_FIELD::DEVICE]->store(
+          device->name.c_str(), device->name.length(), system_charset_info);
+      field[RDB_IO_LATENCY_FIELD::PATH]->store(
+          device->path.c_str(), device->path.length(), system_charset_info);
+      field[RDB_IO_LATENCY_FIELD::OPERATION]->store(op_name, strlen(op_name),
+                                                    system_charset_info);
+      field[RDB_IO_LATENCY_FIELD::COUNT]->store(latencies.num(), true);
+      field[RDB_IO_LATENCY_FIELD::AVERAGE_US]->store(latencies.Average());
+      field[RDB_IO_LATENCY_FIELD::P50_US]->store(latencies.Percentile(50));
+      field[RDB_IO_LATENCY_FIELD::P95_US]->store(latencies.Percentile(95));
+      field[RDB_IO_LATENCY_FIELD::P99_US]->store(latencies.Percentile(99));
+      field[RDB_IO_LATENCY_FIELD::P999_US]->store(latencies.Percentile(99.9));
+      field[RDB_IO_LATENCY_FIELD::MAX_US]->store(
+          latencies.num() > 0 ? latencies.max() : 0, true);
+      field[RDB_IO_LATENCY_FIELD::SLOW_COUNT]->store(
+          device->slow_ios[op].load(), true);
+
+      /* Tell MySQL about this row in the virtual table */
+      ret = static_cast<int>(
+          my_core::schema_table_store_record(thd, tables->table));
+
+      if (ret != 0) {
+        DBUG_RETURN(ret);
+      }
+    }
+  }
+
+  DBUG_RETURN(ret);
+}
+
+/* Initialize the information_schema.rocksdb_io_latency virtual table */
+static int rdb_i_s_io_latency_init(void *const p) {
+  DBUG_ENTER_FUNC();
+
+  assert(p != nullptr);
+
+  my_core::ST_SCHEMA_TABLE *schema;
+
+  schema = (my_core::ST_SCHEMA_TABLE *)p;
+
+  schema->fields_info = rdb_i_s_io_latency_fields_info;
+  schema->fill_table = rdb_i_s_io_latency_fill_table;
+
+  DBUG_RETURN(0);
+}
+
+/*
+  Support for INFORMATION_SCHEMA.ROCKSDB_SLOW_IO dynamic table
+ */
+namespace RDB_SLOW_IO_FIELD {
+enum {
+  FILE_NAME = 0,
+  CF_NAME,
+  LEVEL,
+  DEVICE,
+  OPERATION,
+  COUNT,
+  MAX_US,
+  LAST_US,
+  LAST_TIME
+};
+}  // namespace RDB_SLOW_IO_FIELD
+
+static ST_FIELD_INFO rdb_i_s_slow_io_fields_info[] = {
+    ROCKSDB_FIELD_INFO("FILE_NAME", FN_REFLEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("CF_NAME", NAME_LEN + 1, MYSQL_TYPE_STRING,
+                       MY_I_S_MAYBE_NULL),
+    ROCKSDB_FIELD_INFO("LEVEL", sizeof(int32_t), MYSQL_TYPE_LONG,
+                       MY_I_S_MAYBE_NULL),
+    ROCKSDB_FIELD_INFO("DEVICE", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("OPERATION", NAME_LEN + 1, MYSQL_TYPE_STRING, 0),
+    ROCKSDB_FIELD_INFO("COUNT", sizeof(ulonglong), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("MAX_US", sizeof(ulonglong), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("LAST_US", sizeof(ulonglong), MYSQL_TYPE_LONGLONG, 0),
+    ROCKSDB_FIELD_INFO("LAST_TIME", 0, MYSQL_TYPE_TIMESTAMP, 0),
+    ROCKSDB_FIELD_INFO_END};
+
+/*
+  Fill the information_schema.rocksdb_slow_io virtual table. The column
+  family and level are those of the live SST files; the other files, and
+  the SST files compacted away since, have none.
+*/
+static int rdb_i_s_slow_io_fill_table(
+    my_core::THD *const thd, my_core::Table_ref *const tables,
+    my_core::Item *const cond MY_ATTRIBUTE((__unused__))) {
+  DBUG_ENTER_FUNC();
+
+  assert(thd != nullptr);
+  assert(tables != nullptr);
+  assert(tables->table != nullptr);
+  assert(tables->table->field != nullptr);
+
+  int ret = 0;
+  rocksdb::DB *const rdb = rdb_get_rocksdb_db();
+  const Rdb_io_latency_fs *const fs = rdb_get_io_latency_fs();
+  if (!rdb || !fs) {
+    DBUG_RETURN(ret);
+  }
+
+  std::vector<rocksdb::LiveFileMetaData> metadata;
+  rdb->GetLiveFilesMetaData(&metadata);
+  std::map<std::string, const rocksdb::LiveFileMetaData *> live_files;
+  for (const auto &file : metadata) {
+    live_files.emplace(file.relative_filename, &file);
+  }
+
+  Field **field = tables->table->field;
+  for (const auto &record : fs->get_slow_ios()) {
+    const size_t slash = record.file_name.rfind('/');
+    const auto live_file = live_files.find(
+        slash == std::string::npos ? record.file_name
+                                   : record.file_name.substr(slash + 1));
+    const char *const op_name = rdb_io_op_name(record.op);
+
+    field[RDB_SLOW_IO_FIELD::FILE_NAME]->store(record.file_name.c_str(),
+                                               record.file_name.length(),
+                                               system_charset_info);
+    if (live_file != live_files.end()) {
+      const rocksdb::LiveFileMetaData &file = *live_file->second;
+      field[RDB_SLOW_IO_FIELD::CF_NAME]->set_notnull();
+      field[RDB_SLOW_IO_FIELD::CF_NAME]->store(
+          file.column_family_name.c_str(), file.column_family_name.size(),
+          system_charset_info);
+      field[RDB_SLOW_IO_FIELD::LEVEL]->set_notnull();
+      field[RDB_SLOW_IO_FIELD::LEVEL]->store(file.level, false);
+    } else {
+      field[RDB_SLOW_IO_FIELD::CF_NAME]->set_null();
+      field[RDB_SLOW_IO_FIELD::LEVEL]->set_null();
+    }
+    field[RDB_SLOW_IO_FIELD::DEVICE]->store(
+        record.device.c_str(), record.device.length(), system_charset_info);
+    field[RDB_SLOW_IO_FIELD::OPERATION]->store(op_name, strlen(op_name),
+                                               system_charset_info);
+    field[RDB_SLOW_IO_FIELD::COUNT]->store(record.count, true);
+    field[RDB_SLOW_IO_FIELD::MAX_US]->store(record.max_micros, true);
+    field[RDB_SLOW_IO_FIELD::LAST_US]->store(record.last_micros, true);
+    my_timeval last_time;
+    last_time.m_tv_sec = record.last_time;
+    last_time.m_tv_usec = 0;
+    field[RDB_SLOW_IO_FIELD::LAST_TIME]->store_timestamp(&last_time);
+
+    /* Tell MySQL about this row in the virtual table */
+    ret = static_cast<int>(
+        my_core::schema_table_store_record(thd, tables->table));
+
+    if (ret != 0) {
+      break;
+    }
+  }
+
+  DBUG_RETURN(ret);
+}
+
+/* Initialize the information_schema.rocksdb_slow_io virtual table */
+static int rdb_i_s_slow_io_init(void *const p) {
+  DBUG_ENTER_FUNC();
+
+  assert(p != nullptr);
+
+  my_core::ST_SCHEMA_TABLE *schema;
+
+  schema = (my_core::ST_SCHEMA_TABLE *)p;
+
+  schema->fields_info = rdb_i_s_slow_io_fields_info;
+  schema->fill_table = rdb_i_s_slow_io_fill_table;
+
+  DBUG_RETURN(0);
+}
+
 static int rdb_i_s_deinit(void *p MY_ATTRIBUTE((__unused__))) {
   DBUG_ENTER_FUNC();
   DBUG_RETURN(0);
@@ -2692,6 +3855,23 @@ struct st_mysql_plugin rdb_i_s_perf_context_global = {
     0,       /* flags */
 };
 
+struct st_mysql_plugin rdb_i_s_perf_context_samples = {
+    MYSQL_INFORMATION_SCHEMA_PLUGIN,
+    &rdb_i_s_info,
+    "ROCKSDB_PERF_CONTEXT_SAMPLES",
+    "Facebook",
+    "RocksDB perf context stats of sampled statements",
+    PLUGIN_LICENSE_GPL,
+    rdb_i_s_perf_context_samples_init,
+    nullptr, /* uninstall */
+    rdb_i_s_deinit,
+    0x0001,  /* version number (0.1) */
+    nullptr, /* status variables */
+    nullptr, /* system variables */
+    nullptr, /* config options */
+    0,       /* flags */
+};
+
 struct st_mysql_plugin rdb_i_s_cfoptions = {
     MYSQL_INFORMATION_SCHEMA_PLUGIN,
     &rdb_i_s_info,
@@ -2896,6 +4076,109 @@ struct st_mysql_plugin rdb_i_s_deadlock_info = {
     0,       /* flags */
 };
 
+struct st_mysql_plugin rdb_i_s_partial_index_queue = {
+    MYSQL_INFORMATION_SCHEMA_PLUGIN,
+    &rdb_i_s_info,
+    "ROCKSDB_PARTIAL_INDEX_QUEUE",
+    "Facebook",
+    "RocksDB partial index groups queued for materialization",
+    PLUGIN_LICENSE_GPL,
+    rdb_i_s_partial_index_queue_init,
+    nullptr, /* uninstall */
+    rdb_i_s_deinit,
+    0x0001,  /* version number (0.1) */
+    nullptr, /* status variables */
+    nullptr, /* system variables */
+    nullptr, /* config options */
+    0,       /* flags */
+};
+
+struct st_mysql_plugin rdb_i_s_startup_timeline = {
+    MYSQL_INFORMATION_SCHEMA_PLUGIN,
+    &rdb_i_s_info,
+    "ROCKSDB_STARTUP_TIMELINE",
+    "Facebook",
+    "RocksDB startup phases and their duration",
+    PLUGIN_LICENSE_GPL,
+    rdb_i_s_startup_timeline_init,
+    nullptr, /* uninstall */
+    rdb_i_s_deinit,
+    0x0001,  /* version number (0.1) */
+    nullptr, /* status variables */
+    nullptr, /* system variables */
+    nullptr, /* config options */
+    0,       /* flags */
+};
+
+struct st_mysql_plugin rdb_i_s_cf_write_throttle = {
+    MYSQL_INFORMATION_SCHEMA_PLUGIN,
+    &rdb_i_s_info,
+    "ROCKSDB_CF_WRITE_THROTTLE",
+    "Facebook",
+    "RocksDB write stall conditions and throttled writes per column family",
+    PLUGIN_LICENSE_GPL,
+    rdb_i_s_cf_write_throttle_init,
+    nullptr, /* uninstall */
+    rdb_i_s_deinit,
+    0x0001,  /* version number (0.1) */
+    nullptr, /* status variables */
+    nullptr, /* system variables */
+    nullptr, /* config options */
+    0,       /* flags */
+};
+
+struct st_mysql_plugin rdb_i_s_key_access_recommendations = {
+    MYSQL_INFORMATION_SCHEMA_PLUGIN,
+    &rdb_i_s_info,
+    "ROCKSDB_KEY_ACCESS_RECOMMENDATIONS",
+    "Facebook",
+    "RocksDB prefix extractor and bloom filter recommendations per index from "
+    "sampled key accesses",
+    PLUGIN_LICENSE_GPL,
+    rdb_i_s_key_access_recommendations_init,
+    nullptr, /* uninstall */
+    rdb_i_s_deinit,
+    0x0001,  /* version number (0.1) */
+    nullptr, /* status variables */
+    nullptr, /* system variables */
+    nullptr, /* config options */
+    0,       /* flags */
+};
+
+struct st_mysql_plugin rdb_i_s_io_latency = {
+    MYSQL_INFORMATION_SCHEMA_PLUGIN,
+    &rdb_i_s_info,
+    "ROCKSDB_IO_LATENCY",
+    "Facebook",
+    "RocksDB file I/O latencies per device and operation",
+    PLUGIN_LICENSE_GPL,
+    rdb_i_s_io_latency_init,
+    nullptr, /* uninstall */
+    rdb_i_s_deinit,
+    0x0001,  /* version number (0.1) */
+    nullptr, /* status variables */
+    nullptr, /* system variables */
+    nullptr, /* config options */
+    0,       /* flags */
+};
+
+struct st_mysql_plugin rdb_i_s_slow_io = {
+    MYSQL_INFORMATION_SCHEMA_PLUGIN,
+    &rdb_i_s_info,
+    "ROCKSDB_SLOW_IO",
+    "Facebook",
+    "RocksDB files with I/O slower than rocksdb_slow_io_threshold_us",
+    PLUGIN_LICENSE_GPL,
+    rdb_i_s_slow_io_init,
+    nullptr, /* uninstall */
+    rdb_i_s_deinit,
+    0x0001,  /* version number (0.1) */
+    nullptr, /* status variables */
+    nullptr, /* system variables */
+    nullptr, /* config options */
+    0,       /* flags */
+};
+
 struct st_mysql_plugin rdb_i_s_bypass_rejected_query_history = {
     MYSQL_INFORMATION_SCHEMA_PLUGIN,
     &rdb_i_s_info,
@@ -2930,6 +4213,40 @@ struct st_mysql_plugin rdb_i_s_vector_index_config = {
     0,       /* flags */
 };
 
+struct st_mysql_plugin rdb_i_s_vector_index_stats = {
+    MYSQL_INFORMATION_SCHEMA_PLUGIN,
+    &rdb_i_s_info,
+    "ROCKSDB_VECTOR_INDEX_STATS",
+    "Facebook",
+    "vector index search counters and latency histogram",
+    PLUGIN_LICENSE_GPL,
+    rdb_i_s_vector_index_stats_init,
+    nullptr, /* uninstall */
+    rdb_i_s_deinit,
+    0x0001,  /* version number (0.1) */
+    nullptr, /* status variables */
+    nullptr, /* system variables */
+    nullptr, /* config options */
+    0,       /* flags */
+};
+
+struct st_mysql_plugin rdb_i_s_vector_index_lists = {
+    MYSQL_INFORMATION_SCHEMA_PLUGIN,
+    &rdb_i_s_info,
+    "ROCKSDB_VECTOR_INDEX_LISTS",
+    "Facebook",
+    "ivf list sizes and distances to the centroids",
+    PLUGIN_LICENSE_GPL,
+    rdb_i_s_vector_index_lists_init,
+    nullptr, /* uninstall */
+    rdb_i_s_deinit,
+    0x0001,  /* version number (0.1) */
+    nullptr, /* status variables */
+    nullptr, /* system variables */
+    nullptr, /* config options */
+    0,       /* flags */
+};
+
 struct st_mysql_plugin rdb_i_s_next_spatial_index_config = {
   MYSQL_INFORMATION_SCHEMA_PLUGIN,
   &rdb_i_s_info,
@@ -25,6 +25,7 @@ extern struct st_mysql_plugin rdb_i_s_cfstats;
 extern struct st_mysql_plugin rdb_i_s_dbstats;
 extern struct st_mysql_plugin rdb_i_s_perf_context;
 extern struct st_mysql_plugin rdb_i_s_perf_context_global;
+extern struct st_mysql_plugin rdb_i_s_perf_context_samples;
 extern struct st_mysql_plugin rdb_i_s_cfoptions;
 extern struct st_mysql_plugin rdb_i_s_compact_stats;
 extern struct st_mysql_plugin rdb_i_s_active_compact_stats;
@@ -36,8 +37,16 @@ extern struct st_mysql_plugin rdb_i_s_index_file_map;
 extern struct st_mysql_plugin rdb_i_s_lock_info;
 extern struct st_mysql_plugin rdb_i_s_trx_info;
 extern struct st_mysql_plugin rdb_i_s_deadlock_info;
+extern struct st_mysql_plugin rdb_i_s_partial_index_queue;
+extern struct st_mysql_plugin rdb_i_s_startup_timeline;
+extern struct st_mysql_plugin rdb_i_s_cf_write_throttle;
+extern struct st_mysql_plugin rdb_i_s_key_access_recommendations;
+extern struct st_mysql_plugin rdb_i_s_io_latency;
+extern struct st_mysql_plugin rdb_i_s_slow_io;
 extern struct st_mysql_plugin rdb_i_s_bypass_rejected_query_history;
 extern struct st_mysql_plugin rdb_i_s_live_files_metadata;
 extern struct st_mysql_plugin rdb_i_s_vector_index_config;
+extern struct st_mysql_plugin rdb_i_s_vector_index_stats;
+extern struct st_mysql_plugin rdb_i_s_vector_index_lists;
 extern struct st_mysql_plugin rdb_i_s_next_spatial_index_config;
 }  // namespace myrocks
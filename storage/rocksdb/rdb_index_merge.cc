@@ -45,6 +45,18 @@ Rdb_index_merge::Rdb_index_merge(const char *tmpfile_path,
       m_output_buf(nullptr) {}
 
 Rdb_index_merge::~Rdb_index_merge() {
+  merge_file_close(m_merge_file);
+  for (const auto &merge_file : m_merged_files) {
+    merge_file_close(merge_file);
+  }
+}
+
+void Rdb_index_merge::merge_file_close(const merge_file_info &merge_file) {
+  /* The file was handed over to another merge by add_runs */
+  if (merge_file.m_fd == -1) {
+    return;
+  }
+
   /*
     If merge_tmp_file_removal_delay is set, sleep between calls to chsize.
 
@@ -52,9 +64,9 @@ Rdb_index_merge::~Rdb_index_merge() {
     being deleted too quickly.
   */
   if (m_merge_tmp_file_removal_delay > 0) {
-    uint64 curr_size = m_merge_buf_size * m_merge_file.m_num_sort_buffers;
-    for (uint i = 0; i < m_merge_file.m_num_sort_buffers; i++) {
-      if (my_chsize(m_merge_file.m_fd, curr_size, 0, MYF(MY_WME))) {
+    uint64 curr_size = m_merge_buf_size * merge_file.m_num_sort_buffers;
+    for (uint i = 0; i < merge_file.m_num_sort_buffers; i++) {
+      if (my_chsize(merge_file.m_fd, curr_size, 0, MYF(MY_WME))) {
         // NO_LINT_DEBUG
         LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
                         "Error truncating file during fast index creation.");
@@ -62,7 +74,7 @@ Rdb_index_merge::~Rdb_index_merge() {
 
       my_sleep(m_merge_tmp_file_removal_delay * 1000);
       // Not aborting on fsync error since the tmp file is not used anymore
-      if (mysql_file_sync(m_merge_file.m_fd, MYF(MY_WME))) {
+      if (mysql_file_sync(merge_file.m_fd, MYF(MY_WME))) {
         // NO_LINT_DEBUG
         LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
                         "Error flushing truncated MyRocks merge buffer.");
@@ -75,7 +87,7 @@ Rdb_index_merge::~Rdb_index_merge() {
     Close file descriptor, we don't need to worry about deletion,
     mysql handles it.
   */
-  my_close(m_merge_file.m_fd, MYF(MY_WME));
+  my_close(merge_file.m_fd, MYF(MY_WME));
 }
 
 int Rdb_index_merge::init() {
@@ -209,6 +221,34 @@ int Rdb_index_merge::add(const rocksdb::Slice &key, const rocksdb::Slice &val) {
   return HA_EXIT_SUCCESS;
 }
 
+/**
+  Take over the sorted runs of another merge of the same index, so that the
+  entries of both come out of next(). Used to merge the runs sorted by the
+  threads of a parallel index build in one pass.
+*/
+int Rdb_index_merge::add_runs(Rdb_index_merge *const other) {
+  assert(m_merge_min_heap.empty());
+  assert(other->m_merge_min_heap.empty());
+  /* The runs of a merge file are read at multiples of the buffer size */
+  assert(other->m_merge_buf_size == m_merge_buf_size);
+
+  /* Write out the records the other merge still holds in memory */
+  if (!other->m_offset_tree.empty() && other->merge_buf_write()) {
+    return HA_ERR_ROCKSDB_MERGE_FILE_ERR;
+  }
+
+  if (other->m_merge_file.m_num_sort_buffers > 0) {
+    m_merged_files.push_back(other->m_merge_file);
+    other->m_merge_file.m_fd = -1;
+    other->m_merge_file.m_num_sort_buffers = 0;
+  }
+  m_merged_files.insert(m_merged_files.end(), other->m_merged_files.begin(),
+                        other->m_merged_files.end());
+  other->m_merged_files.clear();
+
+  return HA_EXIT_SUCCESS;
+}
+
 /**
   Sort + write merge buffer chunk out to disk.
 */
@@ -294,29 +334,49 @@ int Rdb_index_merge::merge_heap_prepare() {
     return HA_ERR_ROCKSDB_MERGE_FILE_ERR;
   }
 
-  assert(m_merge_file.m_num_sort_buffers > 0);
+  ulonglong num_sort_buffers = m_merge_file.m_num_sort_buffers;
+  for (const auto &merge_file : m_merged_files) {
+    num_sort_buffers += merge_file.m_num_sort_buffers;
+  }
+  assert(num_sort_buffers > 0);
 
   /*
     For an n-way merge, we need to read chunks of each merge file
     simultaneously.
   */
-  ulonglong chunk_size =
-      m_merge_combine_read_size / m_merge_file.m_num_sort_buffers;
+  ulonglong chunk_size = m_merge_combine_read_size / num_sort_buffers;
   if (chunk_size >= m_merge_buf_size) {
     chunk_size = m_merge_buf_size;
   }
 
+  int res = merge_heap_add_runs(m_merge_file, chunk_size);
+  for (const auto &merge_file : m_merged_files) {
+    if (res != HA_EXIT_SUCCESS) {
+      break;
+    }
+    res = merge_heap_add_runs(merge_file, chunk_size);
+  }
+
+  return res;
+}
+
+/**
+  Push the first record of each sorted run of a merge file onto the heap.
+*/
+int Rdb_index_merge::merge_heap_add_runs(const merge_file_info &merge_file,
+                                         const ulonglong chunk_size) {
   /* Allocate buffers for each chunk */
-  for (ulonglong i = 0; i < m_merge_file.m_num_sort_buffers; i++) {
+  for (ulonglong i = 0; i < merge_file.m_num_sort_buffers; i++) {
     const auto entry =
         std::make_shared<merge_heap_entry>(m_cf_handle.GetComparator());
+    entry->m_fd = merge_file.m_fd;
 
     /*
       Read chunk_size bytes from each chunk on disk, and place inside
       respective chunk buffer.
     */
     const size_t total_size =
-        entry->prepare(m_merge_file.m_fd, i * m_merge_buf_size, chunk_size);
+        entry->prepare(merge_file.m_fd, i * m_merge_buf_size, chunk_size);
 
     if (total_size == (size_t)-1) {
       return HA_ERR_ROCKSDB_MERGE_FILE_ERR;
@@ -354,7 +414,7 @@ int Rdb_index_merge::next(rocksdb::Slice *const key,
     If there are no sort buffer records (alters on empty tables),
     also exit here.
   */
-  if (m_merge_file.m_num_sort_buffers == 0) {
+  if (m_merge_file.m_num_sort_buffers == 0 && m_merged_files.empty()) {
     if (m_offset_tree.empty()) {
       return -1;
     }
@@ -448,7 +508,7 @@ int Rdb_index_merge::merge_heap_pop_and_get_next(rocksdb::Slice *const key,
     or we've reached the end of the respective chunk.
   */
   if (entry->read_rec(&entry->m_key, &entry->m_val)) {
-    if (entry->read_next_chunk_from_disk(m_merge_file.m_fd)) {
+    if (entry->read_next_chunk_from_disk(entry->m_fd)) {
       return HA_ERR_ROCKSDB_MERGE_FILE_ERR;
     }
 
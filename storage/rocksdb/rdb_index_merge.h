@@ -106,6 +106,7 @@ class Rdb_index_merge {
     std::shared_ptr<merge_buf_info> m_chunk_info; /* pointer to buffer info */
     uchar *m_block; /* pointer to heap memory where record is stored */
     const rocksdb::Comparator *const m_comparator;
+    File m_fd; /* merge file the chunk is read from */
     rocksdb::Slice m_key; /* current key pointed to by block ptr */
     rocksdb::Slice m_val;
 
@@ -123,7 +124,10 @@ class Rdb_index_merge {
         MY_ATTRIBUTE((__nonnull__));
 
     explicit merge_heap_entry(const rocksdb::Comparator *const comparator)
-        : m_chunk_info(nullptr), m_block(nullptr), m_comparator(comparator) {}
+        : m_chunk_info(nullptr),
+          m_block(nullptr),
+          m_comparator(comparator),
+          m_fd(-1) {}
   };
 
   struct merge_heap_comparator {
@@ -155,6 +159,8 @@ class Rdb_index_merge {
   const ulonglong m_merge_tmp_file_removal_delay;
   rocksdb::ColumnFamilyHandle &m_cf_handle;
   struct merge_file_info m_merge_file;
+  /* merge files of the sorted runs taken over from other merges */
+  std::vector<merge_file_info> m_merged_files;
   std::shared_ptr<merge_buf_info> m_rec_buf_unsorted;
   std::shared_ptr<merge_buf_info> m_output_buf;
   std::set<merge_record> m_offset_tree;
@@ -191,6 +197,11 @@ class Rdb_index_merge {
   void read_slice(rocksdb::Slice *slice, const uchar *block_ptr)
       MY_ATTRIBUTE((__nonnull__));
 
+  void merge_file_close(const merge_file_info &merge_file);
+
+  [[nodiscard]] int merge_heap_add_runs(const merge_file_info &merge_file,
+                                        ulonglong chunk_size);
+
  public:
   Rdb_index_merge(const char *tmpfile_path, ulonglong merge_buf_size,
                   ulonglong merge_combine_read_size,
@@ -204,6 +215,8 @@ class Rdb_index_merge {
 
   [[nodiscard]] int add(const rocksdb::Slice &key, const rocksdb::Slice &val);
 
+  [[nodiscard]] int add_runs(Rdb_index_merge *other);
+
   [[nodiscard]] int merge_buf_write();
 
   [[nodiscard]] int next(rocksdb::Slice *const key, rocksdb::Slice *const val);
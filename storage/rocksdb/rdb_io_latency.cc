@@ -0,0 +1,360 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+/* This C++ file's header */
+#include "./rdb_io_latency.h"
+
+/* C++ standard header files */
+#include <algorithm>
+#include <chrono>
+
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+
+/* MyRocks header files */
+#include "./ha_rocksdb.h"
+
+namespace myrocks {
+
+namespace {
+
+/* the files whose slow I/O is kept */
+constexpr size_t RDB_SLOW_IO_MAX_FILES = 1024;
+
+/* Times an I/O from its construction to its destruction */
+class Rdb_io_timer {
+ public:
+  Rdb_io_timer(Rdb_io_latency_fs *fs, Rdb_io_device *device,
+               const std::string &fname, Rdb_io_op op)
+      : m_fs(fs),
+        m_device(device),
+        m_fname(fname),
+        m_op(op),
+        m_start(std::chrono::steady_clock::now()) {}
+
+  ~Rdb_io_timer() {
+    const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - m_start)
+                            .count();
+    m_fs->record(m_device, m_fname, m_op, micros);
+  }
+
+ private:
+  Rdb_io_latency_fs *const m_fs;
+  Rdb_io_device *const m_device;
+  const std::string &m_fname;
+  const Rdb_io_op m_op;
+  const std::chrono::steady_clock::time_point m_start;
+};
+
+class Rdb_timed_sequential_file
+    : public rocksdb::FSSequentialFileOwnerWrapper {
+ public:
+  Rdb_timed_sequential_file(std::unique_ptr<rocksdb::FSSequentialFile> &&file,
+                            Rdb_io_latency_fs *fs, Rdb_io_device *device,
+                            const std::string &fname)
+      : rocksdb::FSSequentialFileOwnerWrapper(std::move(file)),
+        m_fs(fs),
+        m_device(device),
+        m_fname(fname) {}
+
+  rocksdb::IOStatus Read(size_t n, const rocksdb::IOOptions &options,
+                         rocksdb::Slice *result, char *scratch,
+                         rocksdb::IODebugContext *dbg) override {
+    Rdb_io_timer timer(m_fs, m_device, m_fname, Rdb_io_op::READ);
+    return target()->Read(n, options, result, scratch, dbg);
+  }
+
+  rocksdb::IOStatus PositionedRead(uint64_t offset, size_t n,
+                                   const rocksdb::IOOptions &options,
+                                   rocksdb::Slice *result, char *scratch,
+                                   rocksdb::IODebugContext *dbg) override {
+    Rdb_io_timer timer(m_fs, m_device, m_fname, Rdb_io_op::READ);
+    return target()->PositionedRead(offset, n, options, result, scratch, dbg);
+  }
+
+ private:
+  Rdb_io_latency_fs *const m_fs;
+  Rdb_io_device *const m_device;
+  const std::string m_fname;
+};
+
+class Rdb_timed_random_access_file
+    : public rocksdb::FSRandomAccessFileOwnerWrapper {
+ public:
+  Rdb_timed_random_access_file(
+      std::unique_ptr<rocksdb::FSRandomAccessFile> &&file,
+      Rdb_io_latency_fs *fs, Rdb_io_device *device, const std::string &fname)
+      : rocksdb::FSRandomAccessFileOwnerWrapper(std::move(file)),
+        m_fs(fs),
+        m_device(device),
+        m_fname(fname) {}
+
+  rocksdb::IOStatus Read(uint64_t offset, size_t n,
+                         const rocksdb::IOOptions &options,
+                         rocksdb::Slice *result, char *scratch,
+                         rocksdb::IODebugContext *dbg) const override {
+    Rdb_io_timer timer(m_fs, m_device, m_fname, Rdb_io_op::READ);
+    return target()->Read(offset, n, options, result, scratch, dbg);
+  }
+
+  // the reads of a batch are issued together, one latency for all
+  rocksdb::IOStatus MultiRead(rocksdb::FSReadRequest *reqs, size_t num_reqs,
+                              const rocksdb::IOOptions &options,
+                              rocksdb::IODebugContext *dbg) override {
+    Rdb_io_timer timer(m_fs, m_device, m_fname, Rdb_io_op::READ);
+    return target()->MultiRead(reqs, num_reqs, options, dbg);
+  }
+
+ private:
+  Rdb_io_latency_fs *const m_fs;
+  Rdb_io_device *const m_device;
+  const std::string m_fname;
+};
+
+class Rdb_timed_writable_file : public rocksdb::FSWritableFileOwnerWrapper {
+ public:
+  Rdb_timed_writable_file(std::unique_ptr<rocksdb::FSWritableFile> &&file,
+                          Rdb_io_latency_fs *fs, Rdb_io_device *device,
+                          const std::string &fname)
+      : rocksdb::FSWritableFileOwnerWrapper(std::move(file)),
+        m_fs(fs),
+        m_device(device),
+        m_fname(fname) {}
+
+  rocksdb::IOStatus Append(const rocksdb::Slice &data,
+                           const rocksdb::IOOptions &options,
+                           rocksdb::IODebugContext *dbg) override {
+    Rdb_io_timer timer(m_fs, m_device, m_fname, Rdb_io_op::WRITE);
+    return target()->Append(data, options, dbg);
+  }
+
+  rocksdb::IOStatus Append(const rocksdb::Slice &data,
+                           const rocksdb::IOOptions &options,
+                           const rocksdb::DataVerificationInfo &info,
+                           rocksdb::IODebugContext *dbg) override {
+    Rdb_io_timer timer(m_fs, m_device, m_fname, Rdb_io_op::WRITE);
+    return target()->Append(data, options, info, dbg);
+  }
+
+  rocksdb::IOStatus PositionedAppend(const rocksdb::Slice &data,
+                                     uint64_t offset,
+                                     const rocksdb::IOOptions &options,
+                                     rocksdb::IODebugContext *dbg) override {
+    Rdb_io_timer timer(m_fs, m_device, m_fname, Rdb_io_op::WRITE);
+    return target()->PositionedAppend(data, offset, options, dbg);
+  }
+
+  rocksdb::IOStatus PositionedAppend(const rocksdb::Slice &data,
+                                     uint64_t offset,
+                                     const rocksdb::IOOptions &options,
+                                     const rocksdb::DataVerificationInfo &info,
+                                     rocksdb::IODebugContext *dbg) override {
+    Rdb_io_timer timer(m_fs, m_device, m_fname, Rdb_io_op::WRITE);
+    return target()->PositionedAppend(data, offset, options, info, dbg);
+  }
+
+  rocksdb::IOStatus Sync(const rocksdb::IOOptions &options,
+                         rocksdb::IODebugContext *dbg) override {
+    Rdb_io_timer timer(m_fs, m_device, m_fname, Rdb_io_op::SYNC);
+    return target()->Sync(options, dbg);
+  }
+
+  rocksdb::IOStatus Fsync(const rocksdb::IOOptions &options,
+                          rocksdb::IODebugContext *dbg) override {
+    Rdb_io_timer timer(m_fs, m_device, m_fname, Rdb_io_op::SYNC);
+    return target()->Fsync(options, dbg);
+  }
+
+  rocksdb::IOStatus RangeSync(uint64_t offset, uint64_t nbytes,
+                              const rocksdb::IOOptions &options,
+                              rocksdb::IODebugContext *dbg) override {
+    Rdb_io_timer timer(m_fs, m_device, m_fname, Rdb_io_op::SYNC);
+    return target()->RangeSync(offset, nbytes, options, dbg);
+  }
+
+ private:
+  Rdb_io_latency_fs *const m_fs;
+  Rdb_io_device *const m_device;
+  const std::string m_fname;
+};
+
+}  // namespace
+
+const char *rdb_io_op_name(Rdb_io_op op) {
+  switch (op) {
+    case Rdb_io_op::READ:
+      return "READ";
+    case Rdb_io_op::WRITE:
+      return "WRITE";
+    case Rdb_io_op::SYNC:
+      return "SYNC";
+  }
+  return "";
+}
+
+rocksdb::IOStatus Rdb_io_latency_fs::NewSequentialFile(
+    const std::string &fname, const rocksdb::FileOptions &file_opts,
+    std::unique_ptr<rocksdb::FSSequentialFile> *result,
+    rocksdb::IODebugContext *dbg) {
+  rocksdb::IOStatus s = target()->NewSequentialFile(fname, file_opts, result,
+                                                    dbg);
+  Rdb_io_device *const device = s.ok() ? get_device(fname) : nullptr;
+  if (device != nullptr) {
+    *result = std::make_unique<Rdb_timed_sequential_file>(std::move(*result),
+                                                          this, device, fname);
+  }
+  return s;
+}
+
+rocksdb::IOStatus Rdb_io_latency_fs::NewRandomAccessFile(
+    const std::string &fname, const rocksdb::FileOptions &file_opts,
+    std::unique_ptr<rocksdb::FSRandomAccessFile> *result,
+    rocksdb::IODebugContext *dbg) {
+  rocksdb::IOStatus s =
+      target()->NewRandomAccessFile(fname, file_opts, result, dbg);
+  Rdb_io_device *const device = s.ok() ? get_device(fname) : nullptr;
+  if (device != nullptr) {
+    *result = std::make_unique<Rdb_timed_random_access_file>(
+        std::move(*result), this, device, fname);
+  }
+  return s;
+}
+
+rocksdb::IOStatus Rdb_io_latency_fs::NewWritableFile(
+    const std::string &fname, const rocksdb::FileOptions &file_opts,
+    std::unique_ptr<rocksdb::FSWritableFile> *result,
+    rocksdb::IODebugContext *dbg) {
+  rocksdb::IOStatus s = target()->NewWritableFile(fname, file_opts, result,
+                                                  dbg);
+  Rdb_io_device *const device = s.ok() ? get_device(fname) : nullptr;
+  if (device != nullptr) {
+    *result = std::make_unique<Rdb_timed_writable_file>(std::move(*result),
+                                                        this, device, fname);
+  }
+  return s;
+}
+
+rocksdb::IOStatus Rdb_io_latency_fs::ReopenWritableFile(
+    const std::string &fname, const rocksdb::FileOptions &file_opts,
+    std::unique_ptr<rocksdb::FSWritableFile> *result,
+    rocksdb::IODebugContext *dbg) {
+  rocksdb::IOStatus s =
+      target()->ReopenWritableFile(fname, file_opts, result, dbg);
+  Rdb_io_device *const device = s.ok() ? get_device(fname) : nullptr;
+  if (device != nullptr) {
+    *result = std::make_unique<Rdb_timed_writable_file>(std::move(*result),
+                                                        this, device, fname);
+  }
+  return s;
+}
+
+rocksdb::IOStatus Rdb_io_latency_fs::ReuseWritableFile(
+    const std::string &fname, const std::string &old_fname,
+    const rocksdb::FileOptions &file_opts,
+    std::unique_ptr<rocksdb::FSWritableFile> *result,
+    rocksdb::IODebugContext *dbg) {
+  rocksdb::IOStatus s =
+      target()->ReuseWritableFile(fname, old_fname, file_opts, result, dbg);
+  Rdb_io_device *const device = s.ok() ? get_device(fname) : nullptr;
+  if (device != nullptr) {
+    *result = std::make_unique<Rdb_timed_writable_file>(std::move(*result),
+                                                        this, device, fname);
+  }
+  return s;
+}
+
+/*
+  The device holding the file fname, found once it is opened. The files that
+  cannot be stat()ed are not timed.
+*/
+Rdb_io_device *Rdb_io_latency_fs::get_device(const std::string &fname) {
+  struct stat st;
+  if (stat(fname.c_str(), &st) != 0) {
+    return nullptr;
+  }
+
+  const std::lock_guard<std::mutex> lock(m_mutex);
+  auto &device = m_devices[st.st_dev];
+  if (!device) {
+    device = std::make_unique<Rdb_io_device>();
+    device->name = std::to_string(major(st.st_dev)) + ":" +
+                   std::to_string(minor(st.st_dev));
+    const size_t slash = fname.rfind('/');
+    device->path =
+        (slash == std::string::npos) ? "." : fname.substr(0, slash + 1);
+  }
+  return device.get();
+}
+
+void Rdb_io_latency_fs::record(Rdb_io_device *device, const std::string &fname,
+                               Rdb_io_op op, uint64_t micros) {
+  // `Add()` is implemented in a thread-safe manner.
+  device->latencies[static_cast<uint>(op)].Add(micros);
+
+  if (rocksdb_slow_io_threshold_us > 0 &&
+      micros >= rocksdb_slow_io_threshold_us) {
+    device->slow_ios[static_cast<uint>(op)]++;
+    record_slow_io(*device, fname, op, micros);
+  }
+}
+
+void Rdb_io_latency_fs::record_slow_io(const Rdb_io_device &device,
+                                       const std::string &fname, Rdb_io_op op,
+                                       uint64_t micros) {
+  const std::lock_guard<std::mutex> lock(m_mutex);
+  const auto key = std::make_pair(fname, op);
+  auto it = m_slow_ios.find(key);
+  if (it == m_slow_ios.end()) {
+    if (m_slow_ios.size() >= RDB_SLOW_IO_MAX_FILES) {
+      m_slow_ios.erase(std::min_element(
+          m_slow_ios.begin(), m_slow_ios.end(),
+          [](const auto &a, const auto &b) {
+            return a.second.last_time < b.second.last_time;
+          }));
+    }
+    it = m_slow_ios.emplace(key, Rdb_slow_io_record()).first;
+    it->second.file_name = fname;
+    it->second.device = device.name;
+    it->second.op = op;
+  }
+
+  Rdb_slow_io_record &record = it->second;
+  record.count++;
+  record.max_micros = std::max(record.max_micros, micros);
+  record.last_micros = micros;
+  record.last_time = time(nullptr);
+}
+
+std::vector<const Rdb_io_device *> Rdb_io_latency_fs::get_devices() const {
+  const std::lock_guard<std::mutex> lock(m_mutex);
+  std::vector<const Rdb_io_device *> devices;
+  for (const auto &it : m_devices) {
+    devices.push_back(it.second.get());
+  }
+  return devices;
+}
+
+std::vector<Rdb_slow_io_record> Rdb_io_latency_fs::get_slow_ios() const {
+  const std::lock_guard<std::mutex> lock(m_mutex);
+  std::vector<Rdb_slow_io_record> records;
+  for (const auto &it : m_slow_ios) {
+    records.push_back(it.second);
+  }
+  return records;
+}
+
+}  // namespace myrocks
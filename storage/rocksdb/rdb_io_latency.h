@@ -0,0 +1,127 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+#pragma once
+
+/* C++ standard header files */
+#include <atomic>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sys/types.h>
+
+/* RocksDB header files */
+#include "monitoring/histogram.h"
+#include "rocksdb/file_system.h"
+
+#include "my_inttypes.h"
+
+namespace myrocks {
+
+enum class Rdb_io_op { READ = 0, WRITE, SYNC };
+constexpr uint RDB_IO_OPS = 3;
+
+const char *rdb_io_op_name(Rdb_io_op op);
+
+/* The latencies of the I/O to the files of one device, in microseconds */
+struct Rdb_io_device {
+  /* major:minor of the device */
+  std::string name;
+  /* the directory of the first file opened on the device */
+  std::string path;
+  rocksdb::HistogramImpl latencies[RDB_IO_OPS];
+  std::atomic<uint64_t> slow_ios[RDB_IO_OPS] = {};
+};
+
+/* The I/O of one operation on one file that was slower than the threshold */
+struct Rdb_slow_io_record {
+  std::string file_name;
+  std::string device;
+  Rdb_io_op op = Rdb_io_op::READ;
+  uint64_t count = 0;
+  uint64_t max_micros = 0;
+  uint64_t last_micros = 0;
+  time_t last_time = 0;
+};
+
+/*
+  A file system timing the reads, writes and syncs of the files it opens. It
+  keeps a latency histogram per device and operation. It also records the
+  files whose I/O took longer than @@rocksdb_slow_io_threshold_us, so that a
+  slow device can be traced to column families and levels.
+*/
+class Rdb_io_latency_fs : public rocksdb::FileSystemWrapper {
+ public:
+  explicit Rdb_io_latency_fs(
+      const std::shared_ptr<rocksdb::FileSystem> &target)
+      : rocksdb::FileSystemWrapper(target) {}
+
+  static const char *kClassName() { return "Rdb_io_latency_fs"; }
+  const char *Name() const override { return kClassName(); }
+
+  rocksdb::IOStatus NewSequentialFile(
+      const std::string &fname, const rocksdb::FileOptions &file_opts,
+      std::unique_ptr<rocksdb::FSSequentialFile> *result,
+      rocksdb::IODebugContext *dbg) override;
+
+  rocksdb::IOStatus NewRandomAccessFile(
+      const std::string &fname, const rocksdb::FileOptions &file_opts,
+      std::unique_ptr<rocksdb::FSRandomAccessFile> *result,
+      rocksdb::IODebugContext *dbg) override;
+
+  rocksdb::IOStatus NewWritableFile(
+      const std::string &fname, const rocksdb::FileOptions &file_opts,
+      std::unique_ptr<rocksdb::FSWritableFile> *result,
+      rocksdb::IODebugContext *dbg) override;
+
+  rocksdb::IOStatus ReopenWritableFile(
+      const std::string &fname, const rocksdb::FileOptions &file_opts,
+      std::unique_ptr<rocksdb::FSWritableFile> *result,
+      rocksdb::IODebugContext *dbg) override;
+
+  rocksdb::IOStatus ReuseWritableFile(
+      const std::string &fname, const std::string &old_fname,
+      const rocksdb::FileOptions &file_opts,
+      std::unique_ptr<rocksdb::FSWritableFile> *result,
+      rocksdb::IODebugContext *dbg) override;
+
+  /* Record an I/O to the file fname on device taking micros */
+  void record(Rdb_io_device *device, const std::string &fname, Rdb_io_op op,
+              uint64_t micros);
+
+  /* The devices, which live as long as the file system */
+  std::vector<const Rdb_io_device *> get_devices() const;
+
+  std::vector<Rdb_slow_io_record> get_slow_ios() const;
+
+ private:
+  Rdb_io_device *get_device(const std::string &fname);
+  void record_slow_io(const Rdb_io_device &device, const std::string &fname,
+                      Rdb_io_op op, uint64_t micros);
+
+  mutable std::mutex m_mutex;
+  std::unordered_map<dev_t, std::unique_ptr<Rdb_io_device>> m_devices;
+
+  /* by file and operation, the least recent dropped past the limit */
+  std::map<std::pair<std::string, Rdb_io_op>, Rdb_slow_io_record> m_slow_ios;
+};
+
+}  // namespace myrocks
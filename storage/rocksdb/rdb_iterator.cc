@@ -58,6 +58,7 @@ Rdb_iterator_base::Rdb_iterator_base(THD *thd, ha_rocksdb *rocksdb_handler,
       m_rocksdb_handler(rocksdb_handler),
       m_scan_it(nullptr),
       m_scan_it_skips_bloom(false),
+      m_scan_it_merges_batch(true),
       m_scan_it_snapshot(nullptr),
       m_scan_it_lower_bound(nullptr),
       m_scan_it_upper_bound(nullptr),
@@ -65,7 +66,8 @@ Rdb_iterator_base::Rdb_iterator_base(THD *thd, ha_rocksdb *rocksdb_handler,
       m_table_type(tbl_def->get_table_type()),
       m_valid(false),
       m_check_iterate_bounds(false),
-      m_ignore_killed(false) {
+      m_ignore_killed(false),
+      m_scan_rows(0) {
   if (tbl_def->get_table_type() == INTRINSIC_TMP) {
     if (m_rocksdb_handler) {
       add_tmp_table_handler(m_thd, m_rocksdb_handler);
@@ -159,6 +161,7 @@ void Rdb_iterator_base::setup_scan_iterator(
   bool skip_bloom = true;
 
   const rocksdb::Slice eq_cond(slice->data(), eq_cond_len);
+  rdb_sample_seek(m_kd, eq_cond_len);
 
   // The size of m_scan_it_lower_bound (and upper) is technically
   // max_packed_sk_len as calculated in ha_rocksdb::alloc_key_buffers.  Rather
@@ -196,15 +199,25 @@ void Rdb_iterator_base::setup_scan_iterator(
     release_scan_iterator();
   }
 
+  /*
+    An iterator reading the snapshot alone would miss the rows the
+    transaction has written to the index since it was created.
+  */
+  if (m_scan_it && !m_scan_it_merges_batch &&
+      rdb_tx_merges_batch(m_thd, m_kd, m_table_type)) {
+    release_scan_iterator();
+  }
+
   /*
     SQL layer can call rnd_init() multiple times in a row.
     In that case, re-use the iterator, but re-position it at the table start.
     */
   if (!m_scan_it) {
+    m_scan_it_merges_batch = rdb_tx_merges_batch(m_thd, m_kd, m_table_type);
     m_scan_it = rdb_tx_get_iterator(
         m_thd, m_kd.get_cf(), skip_bloom, m_scan_it_lower_bound_slice,
         m_scan_it_upper_bound_slice, &m_scan_it_snapshot, m_table_type,
-        read_current, !read_current);
+        read_current, !read_current, m_scan_rows, m_scan_it_merges_batch);
     m_scan_it_skips_bloom = skip_bloom;
   }
 }
@@ -452,6 +465,7 @@ int Rdb_iterator_base::get(const rocksdb::Slice *key,
         s = rocksdb::Status::Corruption();
       });
 
+  rdb_sample_get(m_kd, !s.IsNotFound());
   return convert_get_status(*tx, s, value, skip_ttl_check);
 }
 
@@ -822,17 +836,51 @@ exit:
   return rc;
 }
 
+/*
+ * Queues the group in m_cur_prefix_key for the background thread, with the
+ * rows in m_records and m_pk_records.
+ */
+void Rdb_iterator_partial::queue_prefix() {
+  uint tmp;
+  m_kd.get_infimum_key(m_cur_prefix_key, &tmp);
+
+  Rdb_partial_index_request req;
+  req.sk_id = m_kd.get_gl_index_id();
+  req.pk_id = m_pkd.get_gl_index_id();
+  req.db_name = m_tbl_def->base_dbname();
+  req.table_name = m_tbl_def->base_tablename();
+  req.index_name = m_kd.get_name();
+  req.prefix.assign((const char *)m_cur_prefix_key, m_cur_prefix_key_len);
+  req.num_rows = m_records.size();
+  req.sk_rows.reserve(m_records.size());
+  for (const auto &row : m_records) {
+    req.sk_rows.emplace_back(row.first.ToString(), row.second.ToString());
+  }
+  req.pk_rows.reserve(m_pk_records.size());
+  for (const auto &row : m_pk_records) {
+    req.pk_rows.emplace_back(row.first.ToString(), row.second.ToString());
+  }
+
+  rdb_queue_partial_index_group(std::move(req));
+}
+
 /*
  * Reads keys from PK in m_cur_prefix_key and populates them into m_records.
- * Will also materialize the prefix group if needed.
+ * Will also materialize the prefix group if needed, or queue it for the
+ * background thread with rocksdb_partial_index_materialize_in_background.
  */
 int Rdb_iterator_partial::read_prefix_from_pk() {
   uint tmp;
   int rc = 0;
   size_t num_rows = 0;
+  // The background thread checks the group against the PK rows read here,
+  // which is not possible with rows hidden by TTL.
+  const bool in_background =
+      rocksdb_partial_index_materialize_in_background && !m_pkd.has_ttl();
 
   m_mem_root.ClearForReuse();
   m_records.clear();
+  m_pk_records.clear();
 
   rocksdb::Slice cur_prefix_key((const char *)m_cur_prefix_key,
                                 m_cur_prefix_key_len);
@@ -894,6 +942,19 @@ int Rdb_iterator_partial::read_prefix_from_pk() {
     m_records.emplace_back(rocksdb::Slice(key, sk_packed_size),
                            rocksdb::Slice(val, m_sk_tails.get_current_pos()));
 
+    if (in_background) {
+      const char *pk_key =
+          (const char *)memdup_root(&m_mem_root, rkey.data(), rkey.size());
+      const char *pk_val =
+          (const char *)memdup_root(&m_mem_root, rval.data(), rval.size());
+      if (pk_key == nullptr || pk_val == nullptr) {
+        rc = HA_ERR_OUT_OF_MEM;
+        goto exit;
+      }
+      m_pk_records.emplace_back(rocksdb::Slice(pk_key, rkey.size()),
+                                rocksdb::Slice(pk_val, rval.size()));
+    }
+
     num_rows++;
 
 #ifndef NDEBUG
@@ -917,8 +978,10 @@ int Rdb_iterator_partial::read_prefix_from_pk() {
 
 exit:
   if (num_rows > m_threshold) {
-    if (rc == 0 || (rocksdb_partial_index_ignore_killed &&
-                    rc == HA_ERR_QUERY_INTERRUPTED)) {
+    if (in_background) {
+      if (rc == 0) queue_prefix();
+    } else if (rc == 0 || (rocksdb_partial_index_ignore_killed &&
+                           rc == HA_ERR_QUERY_INTERRUPTED)) {
       rc = materialize_prefix();
     }
   }
@@ -1193,6 +1256,7 @@ void Rdb_iterator_partial::reset() {
   m_mem_root.ClearForReuse();
   m_iterator_pk_position = Iterator_position::UNKNOWN;
   m_records.clear();
+  m_pk_records.clear();
   m_iterator_pk.reset();
   Rdb_iterator_base::reset();
 }
@@ -79,6 +79,8 @@ class Rdb_iterator {
   virtual rocksdb::Slice value() = 0;
   virtual void reset() = 0;
   virtual bool is_valid() = 0;
+  // the rows the optimizer expects the scans of the next seek to read
+  virtual void set_scan_rows(ha_rows rows) = 0;
 };
 
 class Rdb_iterator_base : public Rdb_iterator {
@@ -133,6 +135,7 @@ class Rdb_iterator_base : public Rdb_iterator {
   }
 
   bool is_valid() override { return m_valid; }
+  void set_scan_rows(ha_rows rows) override { m_scan_rows = rows; }
   void set_ignore_killed(bool flag) { m_ignore_killed = flag; }
 
  protected:
@@ -158,6 +161,9 @@ class Rdb_iterator_base : public Rdb_iterator {
   /* Whether m_scan_it was created with skip_bloom=true */
   bool m_scan_it_skips_bloom;
 
+  /* Whether m_scan_it merges the reads with the transaction's write batch */
+  bool m_scan_it_merges_batch;
+
   const rocksdb::Snapshot *m_scan_it_snapshot;
 
   /* Buffers used for upper/lower bounds for m_scan_it. */
@@ -172,6 +178,7 @@ class Rdb_iterator_base : public Rdb_iterator {
   bool m_valid;
   bool m_check_iterate_bounds;
   bool m_ignore_killed;
+  ha_rows m_scan_rows;
 
   Rdb_iterator_base(const Rdb_iterator_base &) = delete;
   Rdb_iterator_base(Rdb_iterator_base &&) = delete;
@@ -218,6 +225,7 @@ class Rdb_iterator_partial : public Rdb_iterator_base {
   int get_next_prefix(bool direction);
   int seek_next_prefix(bool direction);
   int materialize_prefix();
+  void queue_prefix();
   int read_prefix_from_pk();
   int next_with_direction_in_group(bool direction);
   int next_with_direction(bool direction);
@@ -245,6 +253,8 @@ class Rdb_iterator_partial : public Rdb_iterator_base {
 
   Records m_records;
   Records::iterator m_records_it;
+  // the rows of m_records as read from the PK, to queue the group with
+  Records m_pk_records;
   slice_comparator m_comparator;
 
  public:
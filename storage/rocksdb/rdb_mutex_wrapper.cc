@@ -197,7 +197,9 @@ void Rdb_mutex::set_unlock_action(const PSI_stage_info *const old_stage_arg) {
 // Unlock Mutex that was successfully locked by Lock() or TryLockUntil()
 void Rdb_mutex::UnLock() {
 #ifndef STANDALONE_UNITTEST
-  if (m_old_stage_info.count(current_thd) > 0) {
+  // Only waits leave a stage to restore, skip the lookup of the thread for
+  // the locks that were not waited for.
+  if (!m_old_stage_info.empty() && m_old_stage_info.count(current_thd) > 0) {
     const std::shared_ptr<PSI_stage_info> old_stage =
         m_old_stage_info[current_thd];
     m_old_stage_info.erase(current_thd);
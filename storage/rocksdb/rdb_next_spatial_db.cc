@@ -16,26 +16,493 @@
 
    #include "./rdb_next_spatial_db.h"
    #include <algorithm>
+   #include <cmath>
    #include <cstddef>
+   #include <cstring>
+   #include <limits>
    #include <string_view>
    #include "ha_rocksdb.h"
    #include "rdb_buff.h"
+   #include "rdb_datadic.h"
    #include "rdb_global.h"
    #include "rdb_utils.h"
    #include "sql-common/json_dom.h"
+   #include "sql/fb_vector_distance.h"
    #include "sql/field.h"
+   #include "sql/item_cmpfunc.h"
    #include "sql/next_spatial_base.h"
    #ifdef WITH_NEXT_SPATIALDB
    #endif
    #include <rocksdb/db.h>
    
    namespace myrocks {
-   
+
+double st_distance_simple(double lon1_deg, double lat1_deg,
+                          double lon2_deg, double lat2_deg) {
+  return fb_spatial_distance(
+      fb_spatial_query(lon1_deg, lat1_deg, RDB_EARTH_RADIUS), lon2_deg,
+      lat2_deg);
+}
+
+std::vector<double> rdb_spatial_radius_mbr(const double lon, const double lat,
+                                           const double radius) {
+  return next_spatial_radius_mbr(lon, lat, radius);
+}
+
+bool rdb_spatial_mbr_contains(const std::vector<double> &mbr,
+                              const double lon, const double lat) {
+  return !mbr.empty() && lat >= mbr[0] && lat <= mbr[1] && lon >= mbr[2] &&
+         lon <= mbr[3];
+}
+
+bool rdb_spatial_mbr_is_whole_globe(const std::vector<double> &mbr) {
+  return mbr[0] <= -90 && mbr[1] >= 90 && mbr[2] <= -180 && mbr[3] >= 180;
+}
+
+bool rdb_spatial_parse_point(const char *geometry, const std::size_t length,
+                             double *lon, double *lat) {
+  Next_spatial_query_geometry point;
+  if (point.parse(geometry, length) ||
+      point.type() != Next_spatial_query_geometry::Type::POINT ||
+      point.srid() == 0) {
+    return false;
+  }
+  *lon = point.points().front().first;
+  *lat = point.points().front().second;
+  return true;
+}
+
+namespace {
+
+// finest quads a window is covered with, about this many of them span the
+// longer side of the window
+constexpr uint64_t RDB_NEXT_SPATIAL_COVER_CELLS = 16;
+
+/** column or row of a coordinate in the grid of the hilbert curve */
+uint64_t rdb_spatial_hilbert_coordinate(const double value, const double min,
+                                        const double max) {
+  const uint64_t side = uint64_t{1} << RDB_NEXT_SPATIAL_HILBERT_ORDER;
+  const double scaled = std::floor((value - min) / (max - min) * side);
+  if (!(scaled > 0)) return 0;
+  if (scaled >= side) return side - 1;
+  return static_cast<uint64_t>(scaled);
+}
+
+/** position on the hilbert curve of a grid cell */
+uint64_t rdb_spatial_hilbert_index(uint64_t x, uint64_t y) {
+  const uint64_t side = uint64_t{1} << RDB_NEXT_SPATIAL_HILBERT_ORDER;
+  uint64_t d = 0;
+  for (uint64_t s = side / 2; s > 0; s /= 2) {
+    const uint64_t rx = (x & s) ? 1 : 0;
+    const uint64_t ry = (y & s) ? 1 : 0;
+    d += s * s * ((3 * rx) ^ ry);
+    // rotate the quadrant so its curve starts where the parent's does
+    if (ry == 0) {
+      if (rx == 1) {
+        x = side - 1 - x;
+        y = side - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
+/**
+  add the cells of the quad of side cells at x, y that may hold points of
+  the window, quads the window covers and quads of min_side are added whole
+*/
+void rdb_spatial_hilbert_descend(
+    const uint64_t x, const uint64_t y, const uint64_t side,
+    const uint64_t min_side, const std::array<uint64_t, 4> &window,
+    std::vector<std::pair<uint64_t, uint64_t>> &ranges) {
+  if (x > window[1] || x + side - 1 < window[0] || y > window[3] ||
+      y + side - 1 < window[2]) {
+    return;
+  }
+  const bool covered = x >= window[0] && x + side - 1 <= window[1] &&
+                       y >= window[2] && y + side - 1 <= window[3];
+  if (covered || side <= min_side) {
+    // every cell of an aligned quad shares the high bits of its index
+    const uint64_t first =
+        rdb_spatial_hilbert_index(x, y) & ~(side * side - 1);
+    const uint64_t last = first + (side * side - 1);
+    if (!ranges.empty() && ranges.back().second + 1 == first) {
+      ranges.back().second = last;
+    } else {
+      ranges.emplace_back(first, last);
+    }
+    return;
+  }
+  const uint64_t half = side / 2;
+  // visit the children in curve order so the ranges come out sorted
+  std::array<std::pair<uint64_t, std::pair<uint64_t, uint64_t>>, 4> children;
+  size_t i = 0;
+  for (const uint64_t cx : {x, x + half}) {
+    for (const uint64_t cy : {y, y + half}) {
+      children[i++] = {rdb_spatial_hilbert_index(cx, cy), {cx, cy}};
+    }
+  }
+  std::sort(children.begin(), children.end());
+  for (const auto &child : children) {
+    rdb_spatial_hilbert_descend(child.second.first, child.second.second, half,
+                                min_side, window, ranges);
+  }
+}
+
+}  // namespace
+
+uint64_t rdb_spatial_hilbert_cell(const double lon, const double lat) {
+  if (std::isnan(lon) || std::isnan(lat)) {
+    return RDB_NEXT_SPATIAL_NO_CELL;
+  }
+  return rdb_spatial_hilbert_index(
+      rdb_spatial_hilbert_coordinate(lon, -180, 180),
+      rdb_spatial_hilbert_coordinate(lat, -90, 90));
+}
+
+void rdb_spatial_hilbert_cover(
+    const std::vector<double> &mbr, const std::size_t max_ranges,
+    std::vector<std::pair<uint64_t, uint64_t>> &ranges) {
+  ranges.clear();
+  if (mbr.size() < 4 || !(mbr[0] <= mbr[1]) || !(mbr[2] <= mbr[3])) {
+    return;
+  }
+  const std::array<uint64_t, 4> window{
+      rdb_spatial_hilbert_coordinate(mbr[2], -180, 180),
+      rdb_spatial_hilbert_coordinate(mbr[3], -180, 180),
+      rdb_spatial_hilbert_coordinate(mbr[0], -90, 90),
+      rdb_spatial_hilbert_coordinate(mbr[1], -90, 90)};
+  const uint64_t span =
+      std::max(window[1] - window[0], window[3] - window[2]) + 1;
+  uint64_t min_side = 1;
+  while (min_side * RDB_NEXT_SPATIAL_COVER_CELLS < span) min_side *= 2;
+  rdb_spatial_hilbert_descend(0, 0,
+                              uint64_t{1} << RDB_NEXT_SPATIAL_HILBERT_ORDER,
+                              min_side, window, ranges);
+
+  if (max_ranges == 0 || ranges.size() <= max_ranges) return;
+  // close the smallest gaps, reading a few cells too many is cheaper than
+  // seeking to another range
+  std::vector<std::pair<uint64_t, std::size_t>> gaps;
+  for (std::size_t i = 1; i < ranges.size(); i++) {
+    gaps.emplace_back(ranges[i].first - ranges[i - 1].second, i);
+  }
+  std::sort(gaps.begin(), gaps.end());
+  std::vector<bool> merged(ranges.size(), false);
+  for (std::size_t i = 0; i < ranges.size() - max_ranges; i++) {
+    merged[gaps[i].second] = true;
+  }
+  std::size_t kept = 0;
+  for (std::size_t i = 1; i < ranges.size(); i++) {
+    if (merged[i]) {
+      ranges[kept].second = ranges[i].second;
+    } else {
+      ranges[++kept] = ranges[i];
+    }
+  }
+  ranges.resize(kept + 1);
+}
+
+uint32_t rdb_spatial_histogram_cell(const double lon, const double lat) {
+  const auto index = [](const double value, const double min,
+                        const double max, const uint32_t cells) -> uint32_t {
+    const double scaled = std::floor((value - min) / (max - min) * cells);
+    if (!(scaled > 0)) return 0;
+    if (scaled >= cells) return cells - 1;
+    return static_cast<uint32_t>(scaled);
+  };
+  return index(lat, -90, 90, RDB_NEXT_SPATIAL_HISTOGRAM_LAT_CELLS) *
+             RDB_NEXT_SPATIAL_HISTOGRAM_LON_CELLS +
+         index(lon, -180, 180, RDB_NEXT_SPATIAL_HISTOGRAM_LON_CELLS);
+}
+
+double rdb_spatial_histogram_fraction(const Rdb_spatial_histogram &histogram,
+                                      const std::vector<double> &mbr) {
+  if (mbr.size() < 4) return -1;
+  constexpr double lon_side = 360.0 / RDB_NEXT_SPATIAL_HISTOGRAM_LON_CELLS;
+  constexpr double lat_side = 180.0 / RDB_NEXT_SPATIAL_HISTOGRAM_LAT_CELLS;
+  // share of the cell starting at min the range min_value..max_value covers
+  const auto overlap = [](const double min, const double side,
+                          const double min_value, const double max_value) {
+    const double covered =
+        std::min(min + side, max_value) - std::max(min, min_value);
+    return covered > 0 ? covered / side : 0.0;
+  };
+  double total = 0;
+  double inside = 0;
+  for (const auto &cell : histogram) {
+    // counts of merged stats can drop below 0 for a while
+    if (cell.second <= 0) continue;
+    total += cell.second;
+    const uint32_t lat_cell = cell.first / RDB_NEXT_SPATIAL_HISTOGRAM_LON_CELLS;
+    const uint32_t lon_cell = cell.first % RDB_NEXT_SPATIAL_HISTOGRAM_LON_CELLS;
+    inside += cell.second *
+              overlap(-90 + lat_cell * lat_side, lat_side, mbr[0], mbr[1]) *
+              overlap(-180 + lon_cell * lon_side, lon_side, mbr[2], mbr[3]);
+  }
+  if (total == 0) return -1;
+  return std::min(inside / total, 1.0);
+}
+
+namespace {
+
+void rdb_spatial_geometry_point(const char *geometry, const std::size_t length,
+                                double *lon, double *lat) {
+  *lon = std::numeric_limits<double>::quiet_NaN();
+  *lat = std::numeric_limits<double>::quiet_NaN();
+  uint32_t type = 0;
+  // srid, little endian byte order and the point type, then lon and lat
+  if (length == RDB_WKB_POINT_SIZE && geometry[4] == 1) {
+    memcpy(&type, geometry + 5, sizeof(type));
+  }
+  if (type == 1) {
+    memcpy(lon, geometry + 9, sizeof(double));
+    memcpy(lat, geometry + 17, sizeof(double));
+  }
+}
+
+}  // anonymous namespace
+
+void rdb_spatial_cell_image(const char *geometry, const std::size_t length,
+                            uchar *image) {
+  double lon;
+  double lat;
+  rdb_spatial_geometry_point(geometry, length, &lon, &lat);
+  rdb_netbuf_store_uint64(image, rdb_spatial_hilbert_cell(lon, lat));
+}
+
+void rdb_spatial_cell_point(const char *geometry, const std::size_t length,
+                            uchar *point) {
+  double lon;
+  double lat;
+  rdb_spatial_geometry_point(geometry, length, &lon, &lat);
+  memcpy(point, &lon, sizeof(double));
+  memcpy(point + sizeof(double), &lat, sizeof(double));
+}
+
+bool rdb_spatial_cell_entry_point(const rocksdb::Slice &value, double *lon,
+                                  double *lat) {
+  // the point is the first unpack data of the entry, after the header
+  if (value.empty() || !Rdb_key_def::is_unpack_data_tag(value.data()[0])) {
+    return false;
+  }
+  const std::size_t header_size =
+      Rdb_key_def::get_unpack_header_size(value.data()[0]);
+  if (value.size() < header_size + RDB_NEXT_SPATIAL_CELL_POINT_SIZE) {
+    return false;
+  }
+  memcpy(lon, value.data() + header_size, sizeof(double));
+  memcpy(lat, value.data() + header_size + sizeof(double), sizeof(double));
+  return !std::isnan(*lon) && !std::isnan(*lat);
+}
+
+namespace {
+
+// metres a row may be off the max distance of a refine and still match,
+// covers the rounding of the distance kernel
+constexpr double RDB_NEXT_SPATIAL_REFINE_MARGIN = 1;
+// latitude the edge margin of a polygon is computed at, at most
+constexpr double RDB_NEXT_SPATIAL_MARGIN_MAX_LAT = 89;
+
+std::array<double, 3> rdb_spatial_unit_vector(const double lon,
+                                              const double lat) {
+  const double lon_rad = lon * M_PI / 180;
+  const double lat_rad = lat * M_PI / 180;
+  return {std::cos(lat_rad) * std::cos(lon_rad),
+          std::cos(lat_rad) * std::sin(lon_rad), std::sin(lat_rad)};
+}
+
+std::array<double, 3> rdb_spatial_cross(const std::array<double, 3> &a,
+                                        const std::array<double, 3> &b) {
+  return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2],
+          a[0] * b[1] - a[1] * b[0]};
+}
+
+double rdb_spatial_dot(const std::array<double, 3> &a,
+                       const std::array<double, 3> &b) {
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+/** planar even-odd test of a closed lon/lat ring */
+bool rdb_spatial_ring_contains(
+    const std::vector<Next_spatial_query_geometry::Point> &ring,
+    const double lon, const double lat) {
+  bool inside = false;
+  for (std::size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+    const auto &a = ring[i];
+    const auto &b = ring[j];
+    if ((a.second > lat) != (b.second > lat) &&
+        lon < (b.first - a.first) * (lat - a.second) / (b.second - a.second) +
+                  a.first) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+}  // namespace
+
+Rdb_spatial_query_distance::Rdb_spatial_query_distance(
+    const Next_spatial_query_geometry &geometry)
+    : m_geometry(geometry) {
+  const bool polygon =
+      geometry.type() == Next_spatial_query_geometry::Type::POLYGON;
+  for (const auto &ring : geometry.rings()) {
+    for (const auto &point : ring) {
+      m_vertices.push_back(
+          fb_spatial_query(point.first, point.second, RDB_EARTH_RADIUS));
+      if (polygon) {
+        m_normals.push_back(rdb_spatial_unit_vector(point.first, point.second));
+      }
+    }
+  }
+  if (!polygon) return;
+
+  // an arc of angle t strays about t^2 / 8 radians from the straight lon/lat
+  // segment, more towards the poles; twice that bounds it
+  std::size_t first = 0;
+  for (const auto &ring : geometry.rings()) {
+    for (std::size_t i = first; i + 1 < first + ring.size(); ++i) {
+      const auto &b = ring[i - first + 1];
+      const double angle =
+          fb_spatial_distance(m_vertices[i], b.first, b.second) /
+          RDB_EARTH_RADIUS;
+      const double lat = std::min(
+          std::max(std::fabs(ring[i - first].second), std::fabs(b.second)),
+          RDB_NEXT_SPATIAL_MARGIN_MAX_LAT);
+      m_edge_margin =
+          std::max(m_edge_margin, RDB_EARTH_RADIUS * angle * angle *
+                                      (1 + std::tan(lat * M_PI / 180)) / 4);
+    }
+    first += ring.size();
+  }
+}
+
+bool Rdb_spatial_query_distance::polygon_contains(const double lon,
+                                                  const double lat) const {
+  const auto &rings = m_geometry.rings();
+  if (!rdb_spatial_ring_contains(rings.front(), lon, lat)) return false;
+  for (std::size_t i = 1; i < rings.size(); ++i) {
+    // inside a hole
+    if (rdb_spatial_ring_contains(rings[i], lon, lat)) return false;
+  }
+  return true;
+}
+
+double Rdb_spatial_query_distance::operator()(const double lon,
+                                              const double lat) const {
+  double distance = std::numeric_limits<double>::max();
+  if (m_geometry.type() != Next_spatial_query_geometry::Type::POLYGON) {
+    for (const auto &vertex : m_vertices) {
+      distance = std::min(distance, fb_spatial_distance(vertex, lon, lat));
+    }
+    return distance;
+  }
+
+  if (polygon_contains(lon, lat)) return 0;
+  const auto p = rdb_spatial_unit_vector(lon, lat);
+  std::size_t first = 0;
+  for (const auto &ring : m_geometry.rings()) {
+    // the ring is closed, its last vertex repeats the first
+    for (std::size_t i = first; i + 1 < first + ring.size(); ++i) {
+      const auto &a = m_normals[i];
+      const auto &b = m_normals[i + 1];
+      const auto n = rdb_spatial_cross(a, b);
+      const double n_norm = std::sqrt(rdb_spatial_dot(n, n));
+      if (n_norm > 0) {
+        // the closest point of the great circle through the edge is on the
+        // edge itself when it lies between both ends
+        const double sin_cross_track =
+            std::min(std::fabs(rdb_spatial_dot(p, n)) / n_norm, 1.0);
+        const auto c = rdb_spatial_cross(n, rdb_spatial_cross(p, n));
+        if (rdb_spatial_dot(rdb_spatial_cross(a, c), n) >= 0 &&
+            rdb_spatial_dot(rdb_spatial_cross(c, b), n) >= 0) {
+          distance = std::min(distance,
+                              RDB_EARTH_RADIUS * std::asin(sin_cross_track));
+          continue;
+        }
+      }
+      distance = std::min(
+          {distance, fb_spatial_distance(m_vertices[i], lon, lat),
+           fb_spatial_distance(m_vertices[i + 1], lon, lat)});
+    }
+    first += ring.size();
+  }
+  return distance;
+}
+
+void Rdb_spatial_query_distance::operator()(const double *lons,
+                                            const double *lats,
+                                            const std::size_t n,
+                                            double *distances) const {
+  if (m_geometry.type() == Next_spatial_query_geometry::Type::POLYGON) {
+    for (std::size_t i = 0; i < n; i++) {
+      distances[i] = (*this)(lons[i], lats[i]);
+    }
+    return;
+  }
+  fb_spatial_distances(m_vertices.front(), lons, lats, n, distances);
+  if (m_vertices.size() == 1) return;
+  std::vector<double> vertex_distances(n);
+  for (std::size_t v = 1; v < m_vertices.size(); v++) {
+    fb_spatial_distances(m_vertices[v], lons, lats, n,
+                         vertex_distances.data());
+    for (std::size_t i = 0; i < n; i++) {
+      distances[i] = std::min(distances[i], vertex_distances[i]);
+    }
+  }
+}
+
+std::vector<double> Rdb_spatial_query_distance::radius_mbr(
+    const double radius) const {
+  std::vector<double> mbr;
+  for (const auto &ring : m_geometry.rings()) {
+    for (const auto &point : ring) {
+      const auto box =
+          rdb_spatial_radius_mbr(point.first, point.second, radius);
+      if (mbr.empty()) {
+        mbr = box;
+        continue;
+      }
+      mbr[0] = std::min(mbr[0], box[0]);
+      mbr[1] = std::max(mbr[1], box[1]);
+      mbr[2] = std::min(mbr[2], box[2]);
+      mbr[3] = std::max(mbr[3], box[3]);
+    }
+  }
+  return mbr;
+}
+
+Rdb_next_spatial_refine::Rdb_next_spatial_refine(
+    const Next_spatial_query_geometry &geometry, const double max_distance)
+    : m_geometry(geometry),
+      m_distance(m_geometry),
+      m_max_distance(max_distance * (1 + NEXT_SPATIAL_DISTANCE_SLACK) +
+                     m_distance.edge_margin() +
+                     RDB_NEXT_SPATIAL_REFINE_MARGIN) {}
+
+void Rdb_next_spatial_refine::filter(const std::vector<double> &lons,
+                                     const std::vector<double> &lats,
+                                     std::vector<bool> &keep) const {
+  std::vector<double> distances(lons.size());
+  m_distance(lons.data(), lats.data(), lons.size(), distances.data());
+  for (std::size_t i = 0; i < distances.size(); i++) {
+    // a row that is no point is left to the server
+    if (std::isnan(lons[i]) || std::isnan(lats[i])) continue;
+    if (distances[i] > m_max_distance) keep[i] = false;
+  }
+}
+
    #ifdef WITH_NEXT_SPATIALDB
    namespace {
    
    // list number for flat index
    constexpr size_t LIST_NUMBER_FLAT = 0;
+   // radius in metres of the first box a nearest neighbour search reads
+   constexpr double RDB_NEXT_SPATIAL_KNN_INITIAL_RADIUS = 1000;
+   // growth of the box radius between the rounds of a nearest neighbour search
+   constexpr double RDB_NEXT_SPATIAL_KNN_RADIUS_GROWTH = 4;
    
    static void write_inverted_list_key(Rdb_string_writer &writer,
                                        const Index_id index_id,
@@ -617,6 +1084,83 @@
                         std::vector<float> &old_value) override {
        return HA_EXIT_SUCCESS;
      }
+
+    uint range_search(THD *thd, std::vector<double> &query_coordinate,
+            Rdb_next_spatial_range_search_params &params [[maybe_unused]],
+            std::unique_ptr<Rdb_next_spatial_iterator> &cursor) override {
+      m_hit++;
+      open_cursor(thd, query_coordinate, cursor);
+      cursor->seek_to_first();
+      return HA_EXIT_SUCCESS;
+    }
+
+    uint knn_search(
+        THD *thd, Rdb_next_spatial_knn_state &state, const uint batch_size,
+        Rdb_next_spatial_result &result) override {
+      result.clear();
+      if (state.m_radius == 0) m_hit++;
+
+      const Fb_spatial_query query =
+          fb_spatial_query(state.m_lon, state.m_lat, RDB_EARTH_RADIUS);
+      std::unique_ptr<Rdb_next_spatial_iterator> iter;
+      // rows of the box being read, their distances are computed together
+      Rdb_next_spatial_result rows;
+      std::vector<double> lons;
+      std::vector<double> lats;
+      std::vector<double> distances;
+      for (;;) {
+        // a row inside the covered radius is closer than any unread row
+        while (result.size() < batch_size && !state.m_pending.empty() &&
+               state.m_pending.top().first <= state.m_covered) {
+          result.push_back(state.m_pending.top().second);
+          state.m_pending.pop();
+        }
+        if (!result.empty() || state.m_exhausted) {
+          return HA_EXIT_SUCCESS;
+        }
+
+        state.m_radius = state.m_radius == 0
+                             ? RDB_NEXT_SPATIAL_KNN_INITIAL_RADIUS
+                             : state.m_radius * RDB_NEXT_SPATIAL_KNN_RADIUS_GROWTH;
+        const auto mbr =
+            rdb_spatial_radius_mbr(state.m_lon, state.m_lat, state.m_radius);
+        open_cursor(thd, mbr, iter);
+        for (iter->seek_to_first(); iter->is_available(); iter->next()) {
+          rows.emplace_back(iter->key().ToString(), iter->value().ToString());
+        }
+        iter.reset();
+        const uint rtn = row_points(rows, 0, lons, lats);
+        if (rtn) return rtn;
+        // rows of the previous boxes are already pending or handed out, a
+        // row that is no point has no distance to be ordered by
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < rows.size(); i++) {
+          if (!rdb_spatial_mbr_contains(mbr, lons[i], lats[i]) ||
+              rdb_spatial_mbr_contains(state.m_scanned, lons[i], lats[i])) {
+            continue;
+          }
+          rows[kept] = std::move(rows[i]);
+          lons[kept] = lons[i];
+          lats[kept] = lats[i];
+          kept++;
+        }
+        distances.resize(kept);
+        fb_spatial_distances(query, lons.data(), lats.data(), kept,
+                             distances.data());
+        for (std::size_t i = 0; i < kept; i++) {
+          state.m_pending.emplace(distances[i], std::move(rows[i]));
+        }
+        rows.clear();
+        state.m_scanned = mbr;
+        if (rdb_spatial_mbr_is_whole_globe(mbr)) {
+          state.m_exhausted = true;
+          state.m_covered = std::numeric_limits<double>::infinity();
+        } else {
+          // the box holds every point within its radius
+          state.m_covered = state.m_radius;
+        }
+      }
+    }
    
     protected:
      Index_id m_index_id;
@@ -626,6 +1170,11 @@
    
      // the number of vectors in the inverted list
      virtual uint64 get_list_id(const std::vector<double> &value) const = 0;
+
+     /** cursor over the entries in the query window, not positioned yet */
+     virtual void open_cursor(
+         THD *thd, const std::vector<double> &query_mbr,
+         std::unique_ptr<Rdb_next_spatial_iterator> &cursor) = 0;
    };
    
    /**
@@ -686,74 +1235,55 @@
     //    return HA_EXIT_SUCCESS;
     //  }
 
-    uint range_search(THD *thd, std::vector<double> &query_coordinate,
-            Rdb_next_spatial_range_search_params &params,
-            std::vector<std::pair<std::string, std::string>> &result) {
-
-      // log_to_file("range_search");
-
-      // if (metric != FB_VECTOR_INDEX_METRIC::L2 &&
-      // metric != FB_VECTOR_INDEX_METRIC::IP) {
-      // LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG, "Unsupported metric %d",
-      //           metric);
-      // return HA_ERR_UNSUPPORTED;
-      // }
-
-      // m_hit++;
-
-      // const uint k = 100;
-      // // there is no point of having a batch of less than k. set the
-      // // batch size as 2k or batch size, whichever is bigger.
-      // uint batch_size = std::max(2 * k, params.m_batch_size);
-
-      // Rdb_next_spatial_iterator next_spatial_iter(thd, m_index_id, *(m_cf_handle.get()),
-      //                         get_list_id(query_coordinate));
-      // uint rtn;
-      // Rdb_next_spatial_range_computer computer(query_coordinate, params.m_distance,
-      //                         batch_size);
-      // int64_t keys_scanned = 0;
-      // while (next_spatial_iter.is_available()) {
-      // rtn = computer.update_range_result(next_spatial_iter);
-      // keys_scanned++;
-      // if (rtn) {
-      // return rtn;
-      // }
-      // next_spatial_iter.next();
-      // }
-      // m_ntotal = keys_scanned;
-      // rtn = computer.finalize();
-      // if (rtn) {
-      // return rtn;
-      // }
-      // rtn = computer.populate_result(result);
-      // if (rtn) {
-      // return rtn;
-      // }
-
-      (void) params;
-      Rdb_next_spatial_iterator next_spatial_iter(thd, m_index_id, *(m_cf_handle.get()),
-                              query_coordinate);
-      // log_to_file("iterator initialized");
-
-      result.clear();
-      int count = 0;
-      for (next_spatial_iter.seek_to_first(); next_spatial_iter.is_available(); next_spatial_iter.next()) {
-        count++;
-        // log_to_file("iterator results: ");
-        // log_to_file("key size: " + std::to_string(next_spatial_iter.return_key_str().size()) + 
-        //             ", value size: " + std::to_string(next_spatial_iter.return_val_str().size()));
-        // log_to_file_raw(next_spatial_iter.return_key_str());
-        // log_to_file_raw(next_spatial_iter.return_val_str());
-        if (next_spatial_iter.return_val_str().size() != 0) {
-          result.emplace_back(next_spatial_iter.return_key_str(), next_spatial_iter.return_val_str());
+    uint row_points(
+        const Rdb_next_spatial_result &rows, const std::size_t first,
+        std::vector<double> &lons, std::vector<double> &lats) override {
+      lons.clear();
+      lats.clear();
+      std::vector<rocksdb::BlockBasedTableOptions::FieldInfo> field_info_list;
+      rocksdb::BlockBasedTableOptions::TableConfig table_config;
+      if (get_table_info(m_cf_handle->GetName(), &field_info_list,
+                         &table_config)) {
+        return HA_ERR_ROCKSDB_CORRUPT_DATA;
+      }
+      std::vector<size_t> point_field;
+      for (size_t i = 0; i < field_info_list.size(); i++) {
+        if (field_info_list[i].type == MYSQL_TYPE_GEOMETRY) {
+          point_field.push_back(i);
+          break;
         }
-      };
-      // log_to_file("number of records from iterator: " + std::to_string(count));
-      // log_to_file("size of iterator result: " + std::to_string(result.size()));
+      }
+      if (point_field.empty()) {
+        return HA_ERR_UNSUPPORTED;
+      }
+      const Rdb_point_value_layout layout =
+          rdb_point_value_layout(table_config, field_info_list, point_field[0]);
 
-      return HA_EXIT_SUCCESS;
+      std::vector<rocksdb::Slice> fields;
+      for (size_t i = first; i < rows.size(); i++) {
+        double lon = std::numeric_limits<double>::quiet_NaN();
+        double lat = std::numeric_limits<double>::quiet_NaN();
+        if (layout.fixed()) {
+          // left NaN when the row holds no point
+          rdb_point_from_value(layout, rows[i].second, &lon, &lat);
+          lons.push_back(lon);
+          lats.push_back(lat);
+          continue;
+        }
+        if (DecodeFieldFromValue(table_config, field_info_list, point_field,
+                                 rows[i].second, &fields)) {
+          return HA_ERR_ROCKSDB_CORRUPT_DATA;
+        }
+        if (fields[0].size() == RDB_WKB_POINT_SIZE) {
+          memcpy(&lon, fields[0].data() + 9, sizeof(double));
+          memcpy(&lat, fields[0].data() + 17, sizeof(double));
+        }
+        lons.push_back(lon);
+        lats.push_back(lat);
       }
-   
+      return HA_EXIT_SUCCESS;
+    }
+
      Rdb_next_spatial_index_info dump_info() override {
        return {.m_ntotal = m_ntotal, .m_hit = m_hit};
      }
@@ -763,10 +1293,167 @@
      uint64 get_list_id(const std::vector<double> &value) const override {
        return LIST_NUMBER_FLAT;
      }
+
+     void open_cursor(
+         THD *thd, const std::vector<double> &query_mbr,
+         std::unique_ptr<Rdb_next_spatial_iterator> &cursor) override {
+       cursor = std::make_unique<Rdb_next_spatial_rtree_iterator>(
+           thd, m_index_id, *(m_cf_handle.get()), query_mbr);
+     }
    
     private:
      std::atomic<int64_t> m_ntotal{0};
    };
+
+   /**
+     entries of a hilbert index in a query window. the window is read as a few
+     ranges of cells, seeking from one to the next, and the entries of a range
+     outside the window are skipped. entries that are no point are read too.
+   */
+   class Rdb_next_spatial_cell_iterator : public Rdb_next_spatial_iterator {
+    public:
+     Rdb_next_spatial_cell_iterator(THD *thd, const Index_id index_id,
+                                    rocksdb::ColumnFamilyHandle &cf,
+                                    const std::vector<double> &query_mbr)
+         : m_index_id(index_id), m_query_mbr(query_mbr) {
+       rdb_spatial_hilbert_cover(m_query_mbr, RDB_NEXT_SPATIAL_MAX_CELL_RANGES,
+                                 m_ranges);
+       m_ranges.emplace_back(RDB_NEXT_SPATIAL_NO_CELL,
+                             RDB_NEXT_SPATIAL_NO_CELL);
+
+       Rdb_string_writer lower_key_writer;
+       write_cell_key(lower_key_writer, m_ranges.front().first);
+       m_iterator_lower_bound_key.PinSelf(lower_key_writer.to_slice());
+       Rdb_string_writer upper_key_writer;
+       upper_key_writer.write_index_id(m_index_id + 1);
+       m_iterator_upper_bound_key.PinSelf(upper_key_writer.to_slice());
+       m_iterator = rdb_tx_get_iterator(
+           thd, cf, /* skip_bloom_filter */ true, m_iterator_lower_bound_key,
+           m_iterator_upper_bound_key, /* snapshot */ nullptr,
+           TABLE_TYPE::USER_TABLE);
+     }
+
+     void seek_to_first() override {
+       m_range = 0;
+       seek_range();
+     }
+
+     rocksdb::Slice key() const override { return m_iterator->key(); }
+
+     rocksdb::Slice value() const override { return m_iterator->value(); }
+
+     bool is_available() const override {
+       return m_range < m_ranges.size() && m_iterator->Valid();
+     }
+
+     void next() override {
+       m_iterator->Next();
+       skip_outside();
+     }
+
+    private:
+     void write_cell_key(Rdb_string_writer &writer, const uint64_t cell) const {
+       writer.write_index_id(m_index_id);
+       writer.write_uint64(cell);
+     }
+
+     void seek_range() {
+       if (m_range == m_ranges.size()) return;
+       Rdb_string_writer writer;
+       write_cell_key(writer, m_ranges[m_range].first);
+       m_iterator->Seek(writer.to_slice());
+       skip_outside();
+     }
+
+     /** move on to the first entry of the window from the current one */
+     void skip_outside() {
+       while (m_range < m_ranges.size() && m_iterator->Valid()) {
+         const rocksdb::Slice key = m_iterator->key();
+         if (key.size() < INDEX_NUMBER_SIZE + RDB_NEXT_SPATIAL_CELL_IMAGE_SIZE) {
+           m_iterator->Next();
+           continue;
+         }
+         const uchar *image =
+             reinterpret_cast<const uchar *>(key.data()) + INDEX_NUMBER_SIZE;
+         const uint64_t cell = rdb_netbuf_to_uint64(image);
+         if (cell > m_ranges[m_range].second) {
+           m_range++;
+           seek_range();
+           return;
+         }
+         if (cell == RDB_NEXT_SPATIAL_NO_CELL) return;
+         double lon = 0;
+         double lat = 0;
+         if (rdb_spatial_cell_entry_point(m_iterator->value(), &lon, &lat) &&
+             rdb_spatial_mbr_contains(m_query_mbr, lon, lat)) {
+           return;
+         }
+         m_iterator->Next();
+       }
+     }
+
+     Index_id m_index_id;
+     std::vector<double> m_query_mbr;
+     // ranges of cells holding the window, the cell of the entries that are
+     // no point last
+     std::vector<std::pair<uint64_t, uint64_t>> m_ranges;
+     std::size_t m_range = 0;
+     std::unique_ptr<rocksdb::Iterator> m_iterator;
+     rocksdb::PinnableSlice m_iterator_lower_bound_key;
+     rocksdb::PinnableSlice m_iterator_upper_bound_key;
+   };
+
+   /**
+     keys every point by its cell on a hilbert curve over the globe, so near
+     points are near in the index and a window is read as a few key ranges
+   */
+   class Rdb_next_spatial_index_hilbert : public Rdb_next_spatial_index_base {
+    public:
+     Rdb_next_spatial_index_hilbert(
+         const NEXT_spatial_index_config index_def,
+         std::shared_ptr<rocksdb::ColumnFamilyHandle> cf_handle,
+         const Index_id index_id)
+         : Rdb_next_spatial_index_base(index_def, cf_handle, index_id) {
+       assert(index_def.type() == NEXT_SPATIAL_INDEX_TYPE::HILBERT_INDEX);
+     }
+
+     virtual ~Rdb_next_spatial_index_hilbert() override = default;
+
+     uint row_points(
+         const Rdb_next_spatial_result &rows, const std::size_t first,
+         std::vector<double> &lons, std::vector<double> &lats) override {
+       lons.clear();
+       lats.clear();
+       // the point is in the value of the entry
+       for (std::size_t i = first; i < rows.size(); i++) {
+         double lon = std::numeric_limits<double>::quiet_NaN();
+         double lat = std::numeric_limits<double>::quiet_NaN();
+         rdb_spatial_cell_entry_point(rows[i].second, &lon, &lat);
+         lons.push_back(lon);
+         lats.push_back(lat);
+       }
+       return HA_EXIT_SUCCESS;
+     }
+
+     bool rows_in_entries() const override { return false; }
+
+     Rdb_next_spatial_index_info dump_info() override {
+       return {.m_ntotal = 0, .m_hit = m_hit};
+     }
+
+    protected:
+     // the cell of a lon/lat point
+     uint64 get_list_id(const std::vector<double> &value) const override {
+       return rdb_spatial_hilbert_cell(value[0], value[1]);
+     }
+
+     void open_cursor(
+         THD *thd, const std::vector<double> &query_mbr,
+         std::unique_ptr<Rdb_next_spatial_iterator> &cursor) override {
+       cursor = std::make_unique<Rdb_next_spatial_cell_iterator>(
+           thd, m_index_id, *(m_cf_handle.get()), query_mbr);
+     }
+   };
    
    }  // anonymous namespace
    
@@ -779,6 +1466,11 @@
            std::make_unique<Rdb_next_spatial_index_global>(index_def, cf_handle, index_id);
        return HA_EXIT_SUCCESS;
      }
+     if (index_def.type() == NEXT_SPATIAL_INDEX_TYPE::HILBERT_INDEX) {
+       index = std::make_unique<Rdb_next_spatial_index_hilbert>(
+           index_def, cf_handle, index_id);
+       return HA_EXIT_SUCCESS;
+     }
      assert(false);
      return HA_ERR_UNSUPPORTED;
    }
@@ -849,10 +1541,115 @@
 
   // TODO_JC
 
+   int Rdb_next_spatial_db_handler::next_spatial_index_init(Item *sort_func,
+                                                            uint batch_size) {
+     m_batch_size = batch_size;
+     m_has_knn_point = false;
+     m_knn.reset();
+
+     if (sort_func->type() != Item::FUNC_ITEM) {
+       return HA_ERR_UNSUPPORTED;
+     }
+     Item_func *item_func = down_cast<Item_func *>(sort_func);
+     if (strcmp(item_func->func_name(), "st_distance") != 0 ||
+         item_func->argument_count() != 2) {
+       return HA_ERR_UNSUPPORTED;
+     }
+
+     // the query point is the second argument, the indexed column the first
+     String buffer;
+     const String *point = item_func->arguments()[1]->val_str(&buffer);
+     if (point == nullptr ||
+         !rdb_spatial_parse_point(point->ptr(), point->length(), &m_knn_lon,
+                                  &m_knn_lat)) {
+       LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                       "st_distance on a spatial index needs a geographic "
+                       "point to search around");
+       return HA_ERR_UNSUPPORTED;
+     }
+     m_has_knn_point = true;
+     return HA_EXIT_SUCCESS;
+   }
+
+   void Rdb_next_spatial_db_handler::add_refine(Item *geometry,
+                                                const double max_distance) {
+     if (!geometry->const_item()) return;
+     String buffer;
+     const String *wkb = geometry->val_str(&buffer);
+     Next_spatial_query_geometry query_geometry;
+     // the index coordinates are lon/lat, a cartesian geometry is left alone
+     if (wkb == nullptr || query_geometry.parse(wkb->ptr(), wkb->length()) ||
+         query_geometry.srid() == 0) {
+       return;
+     }
+     m_refines.push_back(std::make_unique<Rdb_next_spatial_refine>(
+         query_geometry, max_distance));
+   }
+
+   void Rdb_next_spatial_db_handler::next_spatial_cond_push(const Field *field,
+                                                            Item *cond) {
+     if (cond->type() == Item::COND_ITEM) {
+       Item_cond *cond_item = down_cast<Item_cond *>(cond);
+       if (cond_item->functype() != Item_func::COND_AND_FUNC) return;
+       for (Item &arg : *cond_item->argument_list()) {
+         next_spatial_cond_push(field, &arg);
+       }
+       return;
+     }
+     if (cond->type() != Item::FUNC_ITEM) return;
+     Item_func *func = down_cast<Item_func *>(cond);
+
+     Item_field *distance_field;
+     Item *geometry;
+     Item *radius;
+     if (get_next_spatial_distance_bound(func, &distance_field, &geometry,
+                                         &radius)) {
+       if (distance_field->field->eq(field) && radius->const_item()) {
+         const double max_distance = radius->val_real();
+         if (!radius->null_value) add_refine(geometry, max_distance);
+       }
+       return;
+     }
+
+     // a point row contains, is within or intersects a geometry only where
+     // its distance to it is 0; the mbr functions are left alone
+     if ((strcmp(func->func_name(), "st_contains") != 0 &&
+          strcmp(func->func_name(), "st_within") != 0 &&
+          strcmp(func->func_name(), "st_intersects") != 0) ||
+         func->argument_count() != 2) {
+       return;
+     }
+     for (uint i = 0; i < 2; i++) {
+       Item *column = func->arguments()[i]->real_item();
+       if (column->type() == Item::FIELD_ITEM &&
+           down_cast<Item_field *>(column)->field->eq(field)) {
+         add_refine(func->arguments()[1 - i], 0);
+         return;
+       }
+     }
+   }
+
+   uint Rdb_next_spatial_db_handler::knn_search(THD *thd,
+                                                Rdb_next_spatial_index *index) {
+     m_search_result.clear();
+     m_next_spatial_db_result_iter = m_search_result.cend();
+     m_cursor.reset();
+     if (!m_has_knn_point) {
+       // only a scan ordered by st_distance reads the whole index
+       return HA_ERR_UNSUPPORTED;
+     }
+     m_knn = std::make_unique<Rdb_next_spatial_knn_state>(m_knn_lon, m_knn_lat);
+     m_knn_thd = thd;
+     m_knn_index = index;
+     return fill_batch();
+   }
+
    uint Rdb_next_spatial_db_handler::range_search(THD *thd, Rdb_next_spatial_index *index, double x_min, double x_max, double y_min, double y_max) {
     // log_to_file("rdb_next_spaital_db_handler::range_search");
     m_search_result.clear();
     m_next_spatial_db_result_iter = m_search_result.cend();
+    m_cursor.reset();
+    m_knn.reset();
   
     // if (!m_buffer.size() || !m_limit) return HA_ERR_END_OF_FILE;
 
@@ -872,21 +1669,83 @@
   
     Rdb_next_spatial_range_search_params params{
         .m_distance = m_distance, .m_batch_size = m_batch_size};
-    uint rtn = index->range_search(thd, query_mbr, params, m_search_result);
-    // log_to_file("result pk list after range search: ");
-    // for (const auto& pair : m_search_result) {
-    //     log_to_file("key: ");
-    //     log_to_file_raw(pair.first);
-    //     log_to_file("value: ");
-    //     log_to_file_raw(pair.second);
-    // }
+    uint rtn = index->range_search(thd, query_mbr, params, m_cursor);
     if (rtn) {
       return rtn;
     }
+    m_range_index = index;
+    m_memory_limit = thd->variables.fb_vector_search_memory_limit;
+    return fill_batch();
+  }
+
+   uint Rdb_next_spatial_db_handler::fill_batch() {
+    m_search_result.clear();
+    const uint batch_size = std::max(m_batch_size, 1U);
+    if (m_knn) {
+      const uint rtn = m_knn_index->knn_search(m_knn_thd, *m_knn, batch_size,
+                                               m_search_result);
+      m_next_spatial_db_result_iter = m_search_result.cbegin();
+      return rtn;
+    }
+    // a batch of large rows ends early at the memory limit, the rest of
+    // the window is read by later batches
+    std::size_t batch_bytes = 0;
+    const auto batch_full = [&]() {
+      return m_search_result.size() >= batch_size ||
+             (m_memory_limit > 0 && batch_bytes >= m_memory_limit);
+    };
+    // refined rows leave gaps, read on until the batch is full again
+    while (m_cursor && !batch_full()) {
+      const std::size_t first = m_search_result.size();
+      while (m_cursor->is_available() && !batch_full()) {
+        m_search_result.emplace_back(m_cursor->key().ToString(),
+                                     m_cursor->value().ToString());
+        batch_bytes += m_cursor->key().size() + m_cursor->value().size();
+        m_cursor->next();
+      }
+      if (!m_cursor->is_available()) {
+        // release the iterator as soon as the window is read
+        m_cursor.reset();
+      }
+      const uint rtn = refine_batch(first);
+      if (rtn) {
+        m_search_result.clear();
+        m_next_spatial_db_result_iter = m_search_result.cend();
+        return rtn;
+      }
+      batch_bytes = 0;
+      for (const auto &row : m_search_result) {
+        batch_bytes += row.first.size() + row.second.size();
+      }
+    }
     m_next_spatial_db_result_iter = m_search_result.cbegin();
-  
-    return rtn;
+    return HA_EXIT_SUCCESS;
   }
+
+   uint Rdb_next_spatial_db_handler::refine_batch(const std::size_t first) {
+     if (m_refines.empty() || first == m_search_result.size()) {
+       return HA_EXIT_SUCCESS;
+     }
+     std::vector<double> lons;
+     std::vector<double> lats;
+     const uint rtn =
+         m_range_index->row_points(m_search_result, first, lons, lats);
+     if (rtn) return rtn;
+     std::vector<bool> keep(lons.size(), true);
+     for (const auto &refine : m_refines) {
+       refine->filter(lons, lats, keep);
+     }
+     std::size_t kept = first;
+     for (std::size_t i = 0; i < keep.size(); i++) {
+       if (!keep[i]) continue;
+       if (kept != first + i) {
+         m_search_result[kept] = std::move(m_search_result[first + i]);
+       }
+       kept++;
+     }
+     m_search_result.resize(kept);
+     return HA_EXIT_SUCCESS;
+   }
    
    std::string Rdb_next_spatial_db_handler::current_pk(
        const Index_id pk_index_id) const {
@@ -905,5 +1764,14 @@
       value = m_next_spatial_db_result_iter->second;
       return HA_EXIT_SUCCESS;
   }
+
+   void Rdb_next_spatial_db_handler::upcoming_keys(
+       size_t n, std::vector<std::string> *keys) const {
+     keys->clear();
+     for (auto it = m_next_spatial_db_result_iter;
+          it != m_search_result.cend() && keys->size() < n; ++it) {
+       keys->push_back(it->first);
+     }
+   }
    
   }  // namespace myrocks
\ No newline at end of file
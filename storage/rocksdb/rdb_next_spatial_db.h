@@ -14,6 +14,15 @@
    along with this program; if not, write to the Free Software
    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
    #pragma once
+   #include <array>
+   #include <cstddef>
+   #include <cstdint>
+   #include <functional>
+   #include <limits>
+   #include <map>
+   #include <queue>
+   #include <string>
+   #include <utility>
    #include <vector>
    #ifdef WITH_NEXT_SPATIALDB
    #endif
@@ -23,12 +32,22 @@
    #include "rdb_utils.h"
    #include "./rdb_cmd_srv_helper.h"
    #include "./rdb_global.h"
+   #include "./rdb_psi.h"
+   #include "sql/fb_vector_distance.h"
    #include "sql/item_geofunc.h"
    #include "sql/sql_class.h"
    #include "sql/next_spatial_base.h"
    #include "ha_rocksdb.h"
    
    namespace myrocks {
+
+   /**
+     rows of a spatial search, the key and value of each entry. held for the
+     statement, so they are charged to the connection.
+   */
+   using Rdb_next_spatial_result = std::vector<
+       std::pair<std::string, std::string>,
+       Rdb_search_result_allocator<std::pair<std::string, std::string>>>;
    
    /** for infomation schema */
    class Rdb_next_spatial_index_info {
@@ -49,6 +68,213 @@
      uint m_distance = 0;
      uint m_batch_size = 0;
    };
+
+   class Rdb_next_spatial_iterator;
+
+   // mean earth radius in metres
+   constexpr double RDB_EARTH_RADIUS = NEXT_SPATIAL_EARTH_RADIUS;
+   // srid, byte order, type and the two coordinates of a wkb point
+   constexpr std::size_t RDB_WKB_POINT_SIZE = 25;
+
+   /** great circle distance in metres between two lon/lat points */
+   double st_distance_simple(double lon1_deg, double lat1_deg,
+                             double lon2_deg, double lat2_deg);
+
+   /**
+     bounding box of the points within radius metres of a point, laid out like
+     the query mbr Rdb_next_spatial_db_handler::range_search builds: latitude
+     range then longitude range. a box reaching a pole or the antimeridian
+     spans every longitude.
+   */
+   std::vector<double> rdb_spatial_radius_mbr(const double lon, const double lat,
+                                              const double radius);
+
+   bool rdb_spatial_mbr_contains(const std::vector<double> &mbr,
+                                 const double lon, const double lat);
+
+   bool rdb_spatial_mbr_is_whole_globe(const std::vector<double> &mbr);
+
+   // bits of each coordinate in a hilbert cell
+   constexpr uint RDB_NEXT_SPATIAL_HILBERT_ORDER = 31;
+   // cell of the entries that are no point, every search reads them
+   constexpr uint64_t RDB_NEXT_SPATIAL_NO_CELL =
+       std::numeric_limits<uint64_t>::max();
+   // key image of a hilbert index: the cell of the point
+   constexpr uint RDB_NEXT_SPATIAL_CELL_IMAGE_SIZE = sizeof(uint64_t);
+   // lon and lat of the point, kept in the value of a hilbert entry so a
+   // move within the cell rewrites the entry under the same key
+   constexpr uint RDB_NEXT_SPATIAL_CELL_POINT_SIZE = 2 * sizeof(double);
+   // most key ranges a window of a hilbert index is read in
+   constexpr std::size_t RDB_NEXT_SPATIAL_MAX_CELL_RANGES = 32;
+
+   /**
+     cell of a lon/lat point on the hilbert curve through the
+     2^order x 2^order grid over the globe, nan is no cell
+   */
+   uint64_t rdb_spatial_hilbert_cell(double lon, double lat);
+
+   /**
+     sorted, disjoint ranges of hilbert cells holding every point of the mbr,
+     laid out like rdb_spatial_radius_mbr. at most max_ranges of them, the
+     closest ranges are merged to stay under it.
+   */
+   void rdb_spatial_hilbert_cover(
+       const std::vector<double> &mbr, std::size_t max_ranges,
+       std::vector<std::pair<uint64_t, uint64_t>> &ranges);
+
+   // columns and rows of the grid over the globe the entries of a spatial
+   // index are counted in for the optimizer, only the cells holding entries
+   // are kept
+   constexpr uint RDB_NEXT_SPATIAL_HISTOGRAM_LON_CELLS = 1024;
+   constexpr uint RDB_NEXT_SPATIAL_HISTOGRAM_LAT_CELLS = 512;
+   constexpr uint RDB_NEXT_SPATIAL_HISTOGRAM_CELLS =
+       RDB_NEXT_SPATIAL_HISTOGRAM_LON_CELLS *
+       RDB_NEXT_SPATIAL_HISTOGRAM_LAT_CELLS;
+
+   using Rdb_spatial_histogram = std::map<uint32_t, int64_t>;
+
+   /** cell of the histogram grid holding a lon/lat point, row by row */
+   uint32_t rdb_spatial_histogram_cell(double lon, double lat);
+
+   /**
+     share of the entries counted in histogram that lie in the mbr, laid out
+     like rdb_spatial_radius_mbr. entries are taken to be spread evenly over
+     a cell.
+     @return a negative value if the histogram counts no entry
+   */
+   double rdb_spatial_histogram_fraction(const Rdb_spatial_histogram &histogram,
+                                         const std::vector<double> &mbr);
+
+   /**
+     key image of a geometry in a hilbert index, RDB_NEXT_SPATIAL_CELL_IMAGE_SIZE
+     bytes. a geometry that is no point gets RDB_NEXT_SPATIAL_NO_CELL.
+   */
+   void rdb_spatial_cell_image(const char *geometry, std::size_t length,
+                               uchar *image);
+
+   /**
+     lon and lat of a geometry as stored in the value of a hilbert entry,
+     RDB_NEXT_SPATIAL_CELL_POINT_SIZE bytes. nan for a geometry that is no
+     point.
+   */
+   void rdb_spatial_cell_point(const char *geometry, std::size_t length,
+                               uchar *point);
+
+   /**
+     lon/lat of a hilbert entry, read from its value.
+     @return false if the entry is no point or the value is too short
+   */
+   bool rdb_spatial_cell_entry_point(const rocksdb::Slice &value, double *lon,
+                                     double *lat);
+
+   /**
+     lon/lat of a geographic point in the internal geometry format, srid
+     followed by wkb.
+     @return false if the geometry is not a point with a geographic srid
+   */
+   bool rdb_spatial_parse_point(const char *geometry, std::size_t length,
+                                double *lon, double *lat);
+
+   /**
+     distance in metres from a query geometry to lon/lat points. a point or
+     multipoint is as far as its closest point, a polygon is 0 at points it
+     contains and otherwise as far as its closest edge. the trig of every
+     vertex is computed once, so a scan can share one instance across rows.
+   */
+   class Rdb_spatial_query_distance {
+    public:
+     explicit Rdb_spatial_query_distance(
+         const Next_spatial_query_geometry &geometry);
+
+     double operator()(double lon, double lat) const;
+
+     /**
+       distances of n points, a point geometry goes through the batched
+       haversine kernel
+     */
+     void operator()(const double *lons, const double *lats, std::size_t n,
+                     double *distances) const;
+
+     /**
+       how far the geodesic edges of a polygon can stray from the lon/lat
+       segments its containment is tested against, 0 for points
+     */
+     double edge_margin() const { return m_edge_margin; }
+
+     /**
+       bounding box of the points within radius metres of the geometry,
+       laid out like rdb_spatial_radius_mbr
+     */
+     std::vector<double> radius_mbr(double radius) const;
+
+    private:
+     bool polygon_contains(double lon, double lat) const;
+
+     const Next_spatial_query_geometry &m_geometry;
+     // every vertex, the rings of a polygon one after the other
+     std::vector<Fb_spatial_query> m_vertices;
+     // unit vectors of the vertices, for the distance to polygon edges
+     std::vector<std::array<double, 3>> m_normals;
+     double m_edge_margin = 0;
+   };
+
+   /**
+     conservative check of a spatial predicate of a range scan, run on the
+     rows of a batch before they are returned. a row is dropped only when it
+     is farther than the max distance from the query geometry by more than
+     the error of the spherical distance, so the server, which still checks
+     the predicate exactly, would have rejected it too.
+   */
+   class Rdb_next_spatial_refine {
+    public:
+     Rdb_next_spatial_refine(const Next_spatial_query_geometry &geometry,
+                             double max_distance);
+
+     Rdb_next_spatial_refine(const Rdb_next_spatial_refine &) = delete;
+     Rdb_next_spatial_refine &operator=(const Rdb_next_spatial_refine &) =
+         delete;
+
+     /**
+       clear keep of the rows that cannot match, rows whose coordinates are
+       nan are kept
+     */
+     void filter(const std::vector<double> &lons,
+                 const std::vector<double> &lats,
+                 std::vector<bool> &keep) const;
+
+    private:
+     Next_spatial_query_geometry m_geometry;
+     Rdb_spatial_query_distance m_distance;
+     double m_max_distance;
+   };
+
+   /**
+     state of a nearest neighbour scan around a point. the scan reads boxes
+     of growing radius and hands out the rows no unread row can beat, closest
+     first.
+   */
+   class Rdb_next_spatial_knn_state {
+    public:
+     // distance, then pk and value of a row
+     using Entry = std::pair<double, std::pair<std::string, std::string>>;
+
+     Rdb_next_spatial_knn_state(const double lon, const double lat)
+         : m_lon(lon), m_lat(lat) {}
+
+     double m_lon;
+     double m_lat;
+     // radius of the last box read, 0 before the first one
+     double m_radius = 0;
+     // every row closer than this has been read
+     double m_covered = 0;
+     // the last box read
+     std::vector<double> m_scanned;
+     // rows read but not handed out yet, closest on top
+     std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>
+         m_pending;
+     // the last box read was the whole globe
+     bool m_exhausted = false;
+   };
    
    /**
      spatial index base class
@@ -73,16 +299,40 @@
                                 const rocksdb::Slice &pk,
                                 std::vector<float> &old_value) = 0;
    
+     /**
+       open a cursor over the entries in the query window, positioned at the
+       first one. the caller pulls them in batches, so a large window is
+       never held in memory at once.
+     */
      virtual uint range_search(
          THD *thd, std::vector<double> &query_mbr,
          Rdb_next_spatial_range_search_params &params,
-         std::vector<std::pair<std::string, std::string>> &result) = 0;
+         std::unique_ptr<Rdb_next_spatial_iterator> &cursor) = 0;
+
+     /**
+       hand out the next rows nearest to the point of the state, closest
+       first, at most batch_size of them. result is left empty once every
+       row is handed out.
+     */
+     virtual uint knn_search(
+         THD *thd, Rdb_next_spatial_knn_state &state, uint batch_size,
+         Rdb_next_spatial_result &result) = 0;
 
-    //  virtual uint knn_search(
-    //      THD *thd, std::vector<float> &query_vector,
-    //      Rdb_vector_search_params &params,
-    //      std::vector<std::pair<std::string, float>> &result) = 0;
+     /**
+       lon/lat of the indexed point of rows[first] onwards, nan for a row
+       whose geometry is not a point
+     */
+     virtual uint row_points(
+         const Rdb_next_spatial_result &rows, std::size_t first,
+         std::vector<double> &lons, std::vector<double> &lats) = 0;
    
+     /**
+       whether the value of an entry is the row itself, as in the r-tree of
+       the global index. otherwise an entry is a secondary key ending with the
+       pk of its row, and the row is read through the pk.
+     */
+     virtual bool rows_in_entries() const { return true; }
+
      virtual Rdb_next_spatial_index_info dump_info() = 0;
    
    };
@@ -116,73 +366,56 @@
               m_next_spatial_db_result_iter != m_search_result.cend();
       }
     
-      void next_result() {
+      uint next_result() {
         if (has_more_results()) {
           ++m_next_spatial_db_result_iter;
+          if (m_next_spatial_db_result_iter == m_search_result.cend()) {
+            return fill_batch();
+          }
         }
+        return HA_EXIT_SUCCESS;
       }
    
      std::string current_pk(const Index_id pk_index_id) const;
      uint current_key(std::string &key) const;
      uint current_value(std::string &value) const;
+     /**
+       the keys of the current result and of at most n - 1 results after
+       it in the current batch
+     */
+     void upcoming_keys(size_t n, std::vector<std::string> *keys) const;
    
     //  uint knn_search(THD *thd, Rdb_next_spatial_index *index);
      uint range_search(THD *thd, Rdb_next_spatial_index *index, double x_min, double x_max, double y_min, double y_max);
-     int next_spatial_index_init(Item *sort_func, uint batch_size) {
-      //  log_to_file("Rdb_next_spatial_db_handler next_spatial_index_init");
-
-       m_batch_size = batch_size;
-   
-      //  input_coordinate to store input query coordinate;
-       std::vector<float> input_coordinate;
-       Item_func *item_func = (Item_func *)sort_func;
-       Item **args = ((Item_func *)item_func)->arguments();
-   
-       auto func_name = item_func->func_name();
-       if (func_name != "st_distance") {
-         // should never happen
-         assert(false);
-         return HA_ERR_UNSUPPORTED;
-       }
-   
-       // input spatial coordinate is expected as the second argument
-       uint arg_idx = 1;
-       String tmp_str;
-
-        // assert(args[0]->type() == Item::FIELD_ITEM);
-        // assert(args[1]->type() == Item::STRING_ITEM);
-
-        Item_func *query_coordinate_from_text = (Item_func *)args[1];
-        assert(query_coordinate_from_text->functype == GEOMFROMTEXT);
-
-        // Create a String buffer to use as input/output
-        String buffer;
-
-        // Call the function
-        String *result = query_coordinate_from_text->val_str(&buffer);
-        std::string result_string(result->ptr(), result->length());
-
-        // You can now use `result` (may or may not be the same as &buffer)
-        if (result == nullptr) {
-            // For example, print the result as hex
-            // log_to_file("GEOMETRY WKB with SRID: ");
-            // log_to_file(result_string);
-        } else {
-            assert(false);
-        }
+     /**
+       nearest neighbour search around the query point set by
+       next_spatial_index_init, rows come out closest first
+     */
+     uint knn_search(THD *thd, Rdb_next_spatial_index *index);
+     /**
+       remember the query point of the ORDER BY st_distance, so a scan of
+       the whole index returns its nearest rows first
+     */
+     int next_spatial_index_init(Item *sort_func, uint batch_size);
 
-        // trying to parse the input coordinate and distance
-        // if (parse_spatial_from_item(args, arg_idx, tmp_str, __FUNCTION__,
-        //                               input_coordinate))
-        //   return HA_EXIT_FAILURE;
+     /**
+       pick the st_contains, st_within, st_intersects and st_distance bounds
+       on field out of the and of cond, the rows of later range searches are
+       refined against them until next_spatial_cond_end
+     */
+     void next_spatial_cond_push(const Field *field, Item *cond);
 
-        // m_buffer = std::move(input_coordinate.data);
-       return HA_EXIT_SUCCESS;
-     }
+     void next_spatial_cond_end() { m_refines.clear(); }
    
      void next_spatial_index_end() {
        m_limit = 0;
        m_buffer.clear();
+       // the cursor iterates the transaction, do not keep it past the scan
+       m_cursor.reset();
+       m_knn.reset();
+       m_has_knn_point = false;
+       m_search_result.clear();
+       m_next_spatial_db_result_iter = m_search_result.cend();
      }
    
     private:
@@ -191,22 +424,69 @@
      std::vector<float> m_buffer;
      // old vector for index write
      std::vector<float> m_buffer2;
-     // search result string, vector of pks
-     std::vector<std::pair<std::string, std::string>> m_search_result;
+     // current batch of the range search, pk and value of each entry
+     Rdb_next_spatial_result m_search_result;
      decltype(m_search_result.cbegin()) m_next_spatial_db_result_iter;
+     // rest of the query window, nullptr once it is read to the end
+     std::unique_ptr<Rdb_next_spatial_iterator> m_cursor;
+     // query point of the ORDER BY st_distance
+     bool m_has_knn_point = false;
+     double m_knn_lon = 0;
+     double m_knn_lat = 0;
+     // the running nearest neighbour search, nullptr for a range search
+     std::unique_ptr<Rdb_next_spatial_knn_state> m_knn;
+     THD *m_knn_thd = nullptr;
+     Rdb_next_spatial_index *m_knn_index = nullptr;
+     // index of the range search, decodes the rows to refine
+     Rdb_next_spatial_index *m_range_index = nullptr;
+     // spatial predicates every row of a range search is refined against
+     std::vector<std::unique_ptr<Rdb_next_spatial_refine>> m_refines;
      float m_distance;
    
      // LIMIT associated with the ORDER BY clause
      uint m_limit;
-     uint m_batch_size;
+     uint m_batch_size = 0;
+     // fb_vector_search_memory_limit of the range search, bytes a batch of
+     // it may hold
+     ulonglong m_memory_limit = 0;
    
      uint decode_value_to_buffer(Field *field,
                                  std::vector<float> &buffer);
+
+     /** replace the current batch by the next m_batch_size entries */
+     uint fill_batch();
+
+     /** drop the rows of the current batch from first on m_refines rule out */
+     uint refine_batch(std::size_t first);
+
+     void add_refine(Item *geometry, double max_distance);
    };
 
+   /**
+     cursor over the entries of a query window of a spatial index
+   */
    class Rdb_next_spatial_iterator {
     public:
-     Rdb_next_spatial_iterator(THD *thd, Index_id index_id,
+     virtual ~Rdb_next_spatial_iterator() = default;
+
+     virtual void seek_to_first() = 0;
+
+     virtual rocksdb::Slice key() const = 0;
+
+     virtual rocksdb::Slice value() const = 0;
+
+     virtual bool is_available() const = 0;
+
+     virtual void next() = 0;
+   };
+
+   /**
+     entries of the r-tree of the global index in a query window, entries
+     without a value carry no row and are skipped
+   */
+   class Rdb_next_spatial_rtree_iterator : public Rdb_next_spatial_iterator {
+    public:
+     Rdb_next_spatial_rtree_iterator(THD *thd, Index_id index_id,
                          rocksdb::ColumnFamilyHandle &cf,
                          const std::vector<double> query_coordinates)
          : m_index_id(index_id), m_query_coordinates(query_coordinates) {
@@ -214,17 +494,33 @@
            thd, cf, /* snapshot */ nullptr, TABLE_TYPE::USER_TABLE, m_query_coordinates);
      }
 
-     void seek_to_first() {m_iterator -> SeekToFirst();}
+     void seek_to_first() override {
+       m_iterator->SeekToFirst();
+       skip_empty();
+     }
+
+     rocksdb::Slice key() const override { return m_iterator->key(); }
+
+     rocksdb::Slice value() const override { return m_iterator->value(); }
 
      std::string return_key_str() {return m_iterator->key().ToString();}
 
      std::string return_val_str() {return m_iterator->value().ToString();}
    
-     bool is_available() const { return m_iterator->Valid(); }
+     bool is_available() const override { return m_iterator->Valid(); }
    
-     void next() { m_iterator->Next(); }
+     void next() override {
+       m_iterator->Next();
+       skip_empty();
+     }
    
     private:
+     void skip_empty() {
+       while (m_iterator->Valid() && m_iterator->value().empty()) {
+         m_iterator->Next();
+       }
+     }
+
      Index_id m_index_id;
     //  size_t m_list_id;
      std::vector<double> m_query_coordinates;
@@ -0,0 +1,178 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "./rdb_parallel_scan.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+/* RocksDB header files */
+#include "rocksdb/comparator.h"
+#include "rocksdb/metadata.h"
+
+#include "./ha_rocksdb.h"
+#include "./rdb_datadic.h"
+
+namespace myrocks {
+
+namespace {
+
+/** pieces per thread, so that the threads done first take the rest */
+constexpr uint RDB_PARALLEL_SCAN_PIECES_PER_THREAD = 4;
+
+}  // namespace
+
+Rdb_parallel_scan::Rdb_parallel_scan(rocksdb::DB *rdb, const Rdb_key_def &kd,
+                                     Rdb_transaction *tx,
+                                     const rocksdb::ReadOptions &read_opts,
+                                     const rocksdb::Slice &lower,
+                                     const rocksdb::Slice &upper,
+                                     bool check_ttl, uint max_threads)
+    : m_rdb(rdb),
+      m_kd(kd),
+      m_tx(tx),
+      m_read_opts(read_opts),
+      m_check_ttl(check_ttl),
+      m_bounds({lower.ToString(), upper.ToString()}) {
+  // the pieces are read in no particular order and the bounds are set on
+  // each iterator, so the prefix bloom filter cannot be used
+  m_read_opts.total_order_seek = true;
+  m_read_opts.prefix_same_as_start = false;
+
+  split(std::max(max_threads, 1U) * RDB_PARALLEL_SCAN_PIECES_PER_THREAD);
+  m_threads = std::min<uint>(std::max(max_threads, 1U), m_bounds.size() - 1);
+}
+
+/**
+  Cut the range at the smallest keys of the SST files of the level holding
+  most of it, at about equal sizes of data. The files of a level other than
+  L0 do not overlap, and the last non-empty level holds most of the data,
+  so the pieces are about as large as each other.
+*/
+void Rdb_parallel_scan::split(uint max_pieces) {
+  if (max_pieces <= 1) return;
+
+  const rocksdb::Comparator *const cmp = m_kd.get_cf().GetComparator();
+  const rocksdb::Slice lower(m_bounds.front());
+  const rocksdb::Slice upper(m_bounds.back());
+
+  rocksdb::ColumnFamilyMetaData metadata;
+  m_rdb->GetColumnFamilyMetaData(&m_kd.get_cf(), &metadata);
+
+  std::vector<const rocksdb::SstFileMetaData *> files;
+  uint64_t files_size = 0;
+  for (const auto &level : metadata.levels) {
+    std::vector<const rocksdb::SstFileMetaData *> level_files;
+    uint64_t level_size = 0;
+    for (const auto &file : level.files) {
+      if (cmp->Compare(file.largestkey, lower) < 0 ||
+          cmp->Compare(file.smallestkey, upper) >= 0)
+        continue;
+      level_files.push_back(&file);
+      level_size += file.size;
+    }
+    if (level_size > files_size) {
+      files = std::move(level_files);
+      files_size = level_size;
+    }
+  }
+  if (files.size() <= 1) return;
+
+  std::sort(files.begin(), files.end(),
+            [cmp](const rocksdb::SstFileMetaData *a,
+                  const rocksdb::SstFileMetaData *b) {
+              return cmp->Compare(a->smallestkey, b->smallestkey) < 0;
+            });
+
+  std::vector<std::string> bounds;
+  bounds.push_back(m_bounds.front());
+  uint64_t before = 0;
+  for (const auto *file : files) {
+    // cut before the file once the pieces so far hold their share
+    const uint cuts = bounds.size();
+    if (cuts < max_pieces && before * max_pieces >= files_size * cuts &&
+        cmp->Compare(file->smallestkey, bounds.back()) > 0 &&
+        cmp->Compare(file->smallestkey, upper) < 0)
+      bounds.push_back(file->smallestkey);
+    before += file->size;
+  }
+  bounds.push_back(m_bounds.back());
+  m_bounds = std::move(bounds);
+}
+
+rocksdb::Status Rdb_parallel_scan::scan_piece(uint thread, size_t piece,
+                                              const Row_fn &fn,
+                                              const std::atomic<bool> &stop) {
+  rocksdb::ReadOptions options = m_read_opts;
+  const rocksdb::Slice lower(m_bounds[piece]);
+  const rocksdb::Slice upper(m_bounds[piece + 1]);
+  options.iterate_lower_bound = &lower;
+  options.iterate_upper_bound = &upper;
+
+  std::unique_ptr<rocksdb::Iterator> it(
+      m_rdb->NewIterator(options, &m_kd.get_cf()));
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    if (stop.load(std::memory_order_relaxed)) break;
+
+    const rocksdb::Slice value = it->value();
+    if (m_check_ttl && rdb_should_hide_ttl_rec(m_kd, &value, *m_tx)) continue;
+
+    if (fn(thread, it->key(), value)) return rocksdb::Status::Aborted();
+  }
+  return it->status();
+}
+
+rocksdb::Status Rdb_parallel_scan::run(const Row_fn &fn,
+                                       const Begin_fn &begin_fn,
+                                       const End_fn &end_fn) {
+  std::atomic<size_t> next_piece{0};
+  std::atomic<bool> stop{false};
+  std::vector<rocksdb::Status> statuses(m_threads);
+
+  const auto worker = [&](uint thread) {
+    if (begin_fn && begin_fn(thread)) {
+      statuses[thread] = rocksdb::Status::Aborted();
+      stop = true;
+      return;
+    }
+    for (size_t piece = next_piece++;
+         piece + 1 < m_bounds.size() && !stop.load(); piece = next_piece++) {
+      rocksdb::Status s = scan_piece(thread, piece, fn, stop);
+      if (!s.ok()) {
+        statuses[thread] = s;
+        stop = true;
+      }
+    }
+    if (end_fn) end_fn(thread);
+  };
+
+  std::vector<std::thread> workers;
+  for (uint thread = 1; thread < m_threads; thread++) {
+    workers.emplace_back(worker, thread);
+  }
+  worker(0);
+  for (auto &thread : workers) {
+    thread.join();
+  }
+
+  for (const auto &s : statuses) {
+    if (!s.ok()) return s;
+  }
+  return rocksdb::Status::OK();
+}
+
+}  // namespace myrocks
@@ -0,0 +1,98 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+/* RocksDB header files */
+#include "rocksdb/db.h"
+#include "rocksdb/options.h"
+
+#include "my_inttypes.h"
+
+namespace myrocks {
+
+class Rdb_key_def;
+class Rdb_transaction;
+
+/**
+  A scan of a range of an index, split into pieces at the boundaries of the
+  SST files of its column family and read by several threads, each with its
+  own iterator on one snapshot. A thread takes the next piece when it is
+  done with one, so a piece slower than the others does not hold them up.
+
+  The rows are read from the snapshot only: the transaction must have no
+  writes of its own.
+*/
+class Rdb_parallel_scan {
+ public:
+  /**
+    Called for each visible row of the range on the thread numbered thread,
+    the slices are only valid during the call.
+    @return true to stop the scan
+  */
+  using Row_fn = std::function<bool(uint thread, const rocksdb::Slice &key,
+                                    const rocksdb::Slice &value)>;
+
+  /** Called on each thread before its first row, true to stop the scan */
+  using Begin_fn = std::function<bool(uint thread)>;
+
+  /** Called on each thread after its last row */
+  using End_fn = std::function<void(uint thread)>;
+
+  /**
+    @param read_opts    options with the snapshot of the transaction
+    @param lower,upper  the range, in the order of the column family
+    @param check_ttl    whether to hide the rows past their TTL
+    @param max_threads  the threads to read with at most
+  */
+  Rdb_parallel_scan(rocksdb::DB *rdb, const Rdb_key_def &kd,
+                    Rdb_transaction *tx, const rocksdb::ReadOptions &read_opts,
+                    const rocksdb::Slice &lower, const rocksdb::Slice &upper,
+                    bool check_ttl, uint max_threads);
+
+  /** the threads run() reads with, at most one per piece */
+  uint threads() const { return m_threads; }
+
+  /**
+    Call fn on every row of the range from threads() threads, the calling
+    thread being thread 0.
+    @return Status::Aborted() if fn or begin_fn stopped the scan, else the
+            first error of the iterators
+  */
+  rocksdb::Status run(const Row_fn &fn, const Begin_fn &begin_fn = nullptr,
+                      const End_fn &end_fn = nullptr);
+
+ private:
+  void split(uint max_pieces);
+  rocksdb::Status scan_piece(uint thread, size_t piece, const Row_fn &fn,
+                             const std::atomic<bool> &stop);
+
+  rocksdb::DB *const m_rdb;
+  const Rdb_key_def &m_kd;
+  Rdb_transaction *const m_tx;
+  rocksdb::ReadOptions m_read_opts;
+  const bool m_check_ttl;
+
+  /** piece i is [m_bounds[i], m_bounds[i + 1]) */
+  std::vector<std::string> m_bounds;
+  uint m_threads;
+};
+
+}  // namespace myrocks
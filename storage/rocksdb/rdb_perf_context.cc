@@ -19,10 +19,15 @@
 #include "./rdb_perf_context.h"
 
 /* C++ system header files */
+#include <mutex>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 /* MySQL header files */
 #include "sql/sql_class.h"
+#include "sql/sql_digest.h"
+#include "sql/sql_digest_stream.h"
 
 /* RocksDB header files */
 #include "rocksdb/iostats_context.h"
@@ -31,6 +36,7 @@
 /* MyRocks header files */
 #include "./ha_rocksdb.h"
 #include "./ha_rocksdb_proto.h"
+#include "./rdb_utils.h"
 
 namespace myrocks {
 
@@ -99,22 +105,27 @@ std::string rdb_pc_stat_types[] = {
     "IO_RANGE_SYNC_NANOS",
     "IO_LOGGER_NANOS"};
 
-#define IO_PERF_RECORD(_field_)                                       \
-  do {                                                                \
-    if (rocksdb::get_perf_context()->_field_ > 0) {                   \
-      counters->m_value[idx] += rocksdb::get_perf_context()->_field_; \
-    }                                                                 \
-    idx++;                                                            \
+#define IO_PERF_RECORD(_field_)                        \
+  do {                                                 \
+    if (rocksdb::get_perf_context()->_field_ > 0) {    \
+      add(idx, rocksdb::get_perf_context()->_field_);  \
+    }                                                  \
+    idx++;                                             \
   } while (0)
-#define IO_STAT_RECORD(_field_)                                          \
-  do {                                                                   \
-    if (rocksdb::get_iostats_context()->_field_ > 0) {                   \
-      counters->m_value[idx] += rocksdb::get_iostats_context()->_field_; \
-    }                                                                    \
-    idx++;                                                               \
+#define IO_STAT_RECORD(_field_)                          \
+  do {                                                   \
+    if (rocksdb::get_iostats_context()->_field_ > 0) {   \
+      add(idx, rocksdb::get_iostats_context()->_field_); \
+    }                                                    \
+    idx++;                                               \
   } while (0)
 
-static void harvest_diffs(Rdb_atomic_perf_counters *const counters) {
+/*
+  Calls add(idx, value) for the non zero perf context counters of the
+  thread.
+*/
+template <typename Add>
+static void for_each_perf_counter(Add &&add) {
   // (C) These should be in the same order as the PC enum
   size_t idx = 0;
   IO_PERF_RECORD(user_key_comparison_count);
@@ -179,18 +190,157 @@ static void harvest_diffs(Rdb_atomic_perf_counters *const counters) {
   }
 }
 
+static void harvest_diffs(Rdb_atomic_perf_counters *const counters) {
+  auto &shard = counters->local_shard();
+  for_each_perf_counter([&shard](size_t idx, uint64_t value) {
+    shard.m_value[idx].fetch_add(value, std::memory_order_relaxed);
+  });
+}
+
 #undef IO_PERF_DIFF
 #undef IO_STAT_DIFF
 
 static Rdb_atomic_perf_counters rdb_global_perf_counters;
 
+Rdb_large_scan_stats rdb_large_scan_stats;
+
 void rdb_get_global_perf_counters(Rdb_perf_counters *const counters) {
   counters->load(rdb_global_perf_counters);
 }
 
+// sampled statements kept for INFORMATION_SCHEMA.ROCKSDB_PERF_CONTEXT_SAMPLES
+static constexpr size_t RDB_PERF_CONTEXT_SAMPLES = 128;
+
+static std::mutex rdb_sample_statements_mutex;
+static std::unordered_set<std::string> rdb_sample_statements;
+static std::atomic<bool> rdb_sample_statements_empty{true};
+
+// ring of the last sampled statements
+static std::mutex rdb_samples_mutex;
+static std::vector<Rdb_perf_context_sample> rdb_samples;
+static size_t rdb_samples_next = 0;
+
+/*
+  The sampling decision for the last statement that called into the engine
+  from this thread, and its counters if it is sampled.
+*/
+struct Rdb_perf_context_sample_state {
+  int64_t m_query_id = -1;
+  bool m_sampled = false;
+  // slot in rdb_samples, SIZE_MAX until the statement is first recorded
+  size_t m_slot = SIZE_MAX;
+  Rdb_perf_context_sample m_sample;
+};
+
+static thread_local Rdb_perf_context_sample_state rdb_sample_state;
+
+void rdb_set_perf_context_sample_statements(const char *const list) {
+  std::unordered_set<std::string> statements;
+  if (list != nullptr) {
+    for (auto &token : parse_into_tokens(list, ',')) {
+      token.erase(0, token.find_first_not_of(" \t"));
+      token.erase(token.find_last_not_of(" \t") + 1);
+      if (!token.empty()) statements.insert(std::move(token));
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(rdb_sample_statements_mutex);
+  rdb_sample_statements.swap(statements);
+  rdb_sample_statements_empty = rdb_sample_statements.empty();
+}
+
+static std::string rdb_statement_digest(THD *const thd) {
+  if (thd->m_digest == nullptr || thd->m_digest->is_empty()) return "";
+
+  unsigned char hash[DIGEST_HASH_SIZE];
+  compute_digest_hash(&thd->m_digest->m_digest_storage, hash);
+  char hash_string[DIGEST_HASH_TO_STRING_LENGTH + 1];
+  DIGEST_HASH_TO_STRING(hash, hash_string);
+  return hash_string;
+}
+
+bool rdb_perf_context_sample(THD *const thd, const uint32_t sample_rate) {
+  auto &state = rdb_sample_state;
+  if (state.m_query_id == thd->query_id) return state.m_sampled;
+
+  state.m_query_id = thd->query_id;
+  state.m_slot = SIZE_MAX;
+  state.m_sampled = sample_rate > 0 && thd->query_id % sample_rate == 0;
+  const bool match_statements = !rdb_sample_statements_empty;
+  if (!state.m_sampled && !match_statements) return false;
+
+  std::string digest = rdb_statement_digest(thd);
+  if (!state.m_sampled) {
+    std::lock_guard<std::mutex> lock(rdb_sample_statements_mutex);
+    state.m_sampled =
+        (!digest.empty() && rdb_sample_statements.count(digest) > 0) ||
+        (!thd->query_type.empty() &&
+         rdb_sample_statements.count(thd->query_type) > 0);
+  }
+
+  if (state.m_sampled) {
+    state.m_sample = Rdb_perf_context_sample();
+    state.m_sample.m_thread_id = thd->thread_id();
+    state.m_sample.m_query_id = thd->query_id;
+    state.m_sample.m_digest = std::move(digest);
+    state.m_sample.m_query_type = thd->query_type;
+  }
+  return state.m_sampled;
+}
+
+/*
+  Adds the perf context of the calling thread to the sample of its statement,
+  and publishes the sum so far to the ring and to the slow log of the
+  statement.
+*/
+static void rdb_record_perf_context_sample(THD *const thd) {
+  auto &state = rdb_sample_state;
+  if (!state.m_sampled || state.m_query_id != thd->query_id) return;
+
+  auto &sample = state.m_sample;
+  for_each_perf_counter(
+      [&sample](size_t idx, uint64_t value) { sample.m_value[idx] += value; });
+
+  {
+    std::lock_guard<std::mutex> lock(rdb_samples_mutex);
+    // the slot may have been reused by a later statement since
+    if (state.m_slot == SIZE_MAX ||
+        rdb_samples[state.m_slot].m_query_id != sample.m_query_id) {
+      state.m_slot = rdb_samples_next;
+      rdb_samples_next = (rdb_samples_next + 1) % RDB_PERF_CONTEXT_SAMPLES;
+      if (state.m_slot == rdb_samples.size()) rdb_samples.emplace_back();
+    }
+    rdb_samples[state.m_slot] = sample;
+  }
+
+  std::string &perf_context = thd->engine_perf_context;
+  perf_context.clear();
+  for (int i = 0; i < PC_MAX_IDX; i++) {
+    if (sample.m_value[i] == 0) continue;
+    if (!perf_context.empty()) perf_context += ' ';
+    perf_context += rdb_pc_stat_types[i];
+    perf_context += '=';
+    perf_context += std::to_string(sample.m_value[i]);
+  }
+}
+
+std::vector<Rdb_perf_context_sample> rdb_get_perf_context_samples() {
+  std::lock_guard<std::mutex> lock(rdb_samples_mutex);
+  const size_t count = rdb_samples.size();
+  const size_t oldest =
+      count < RDB_PERF_CONTEXT_SAMPLES ? 0 : rdb_samples_next;
+
+  std::vector<Rdb_perf_context_sample> samples;
+  samples.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    samples.push_back(rdb_samples[(oldest + i) % count]);
+  }
+  return samples;
+}
+
 void Rdb_perf_counters::load(const Rdb_atomic_perf_counters &atomic_counters) {
   for (int i = 0; i < PC_MAX_IDX; i++) {
-    m_value[i] = atomic_counters.m_value[i].load(std::memory_order_relaxed);
+    m_value[i] = atomic_counters.value(i);
   }
 }
 
@@ -232,6 +382,7 @@ void Rdb_io_perf::end_and_record(THD *thd) {
       static_cast<rocksdb::PerfLevel>(perf_context_level);
 
   if (perf_level == rocksdb::kDisable) {
+    m_large_scans = 0;
     return;
   }
 
@@ -239,6 +390,16 @@ void Rdb_io_perf::end_and_record(THD *thd) {
     harvest_diffs(m_atomic_counters);
   }
   harvest_diffs(&rdb_global_perf_counters);
+  rdb_record_perf_context_sample(thd);
+
+  if (m_large_scans != 0) {
+    const auto *const perf_context = rocksdb::get_perf_context();
+    rdb_large_scan_stats.m_block_read_count += perf_context->block_read_count;
+    rdb_large_scan_stats.m_block_read_byte += perf_context->block_read_byte;
+    rdb_large_scan_stats.m_block_cache_hit_count +=
+        perf_context->block_cache_hit_count;
+    m_large_scans = 0;
+  }
 
   if (m_shared_io_perf_read &&
       (rocksdb::get_perf_context()->block_read_byte != 0 ||
@@ -20,12 +20,14 @@
 #include <atomic>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 /* MySQL header files */
 #include "sql/handler.h"
 
 /* MyRocks header files */
 #include "./my_io_perf.h"
+#include "./rdb_global.h"
 
 namespace myrocks {
 
@@ -94,10 +96,35 @@ class Rdb_perf_counters;
 
 /*
   A collection of performance counters that can be safely incremented by
-  multiple threads since it stores atomic datapoints.
+  multiple threads since it stores atomic datapoints. Like ib_counter_t, the
+  counters are spread over shards picked by the CPU of the thread, on cache
+  lines of their own, so that the cores do not bounce the lines between them.
+  The shards are summed when the counters are read.
 */
 struct Rdb_atomic_perf_counters {
-  std::atomic_ullong m_value[PC_MAX_IDX];
+  static constexpr int SHARDS = 16;
+
+  struct Shard {
+    // keeps the counters off the cache lines of the previous shard
+    char m_pad[INNOBASE_CACHE_LINE_SIZE];
+    std::atomic_ullong m_value[PC_MAX_IDX];
+  };
+
+  Shard m_shards[SHARDS];
+  char m_pad[INNOBASE_CACHE_LINE_SIZE];
+
+  /* The shard of the CPU the calling thread runs on */
+  Shard &local_shard() {
+    return m_shards[RDB_INDEXER<ulonglong, SHARDS>().get_rnd_index() % SHARDS];
+  }
+
+  ulonglong value(int idx) const {
+    ulonglong total = 0;
+    for (const auto &shard : m_shards) {
+      total += shard.m_value[idx].load(std::memory_order_relaxed);
+    }
+    return total;
+  }
 };
 
 /*
@@ -117,6 +144,45 @@ class Rdb_perf_counters {
 
 extern std::string rdb_pc_stat_types[PC_MAX_IDX];
 
+/*
+  The scans started with the options of large scans (rocksdb_large_scan_rows),
+  and the block reads of the statements that ran them, to see how much the
+  readahead saved and how little the block cache was filled.
+*/
+struct Rdb_large_scan_stats {
+  std::atomic_ullong m_scans{0};
+  std::atomic_ullong m_block_read_count{0};
+  std::atomic_ullong m_block_read_byte{0};
+  std::atomic_ullong m_block_cache_hit_count{0};
+};
+
+extern Rdb_large_scan_stats rdb_large_scan_stats;
+
+/*
+  The perf context of a sampled statement, summed over its calls into the
+  engine. A statement is sampled if its query id is a multiple of
+  rocksdb_perf_context_sample_rate, or if its digest or query_info query type
+  is listed in rocksdb_perf_context_sample_statements. Sampled statements run
+  at rocksdb_perf_context_sample_level, write their counters to the slow log,
+  and the last ones are kept for
+  INFORMATION_SCHEMA.ROCKSDB_PERF_CONTEXT_SAMPLES.
+*/
+struct Rdb_perf_context_sample {
+  my_thread_id m_thread_id = 0;
+  int64_t m_query_id = 0;
+  std::string m_digest;
+  std::string m_query_type;
+  uint64_t m_value[PC_MAX_IDX] = {};
+};
+
+void rdb_set_perf_context_sample_statements(const char *const list);
+
+/* Whether the current statement of thd is sampled, decided once for each */
+bool rdb_perf_context_sample(THD *const thd, const uint32_t sample_rate);
+
+/* The samples kept, oldest first */
+std::vector<Rdb_perf_context_sample> rdb_get_perf_context_samples();
+
 /*
   Perf timers for data reads
  */
@@ -129,6 +195,7 @@ class Rdb_io_perf {
 
   uint64_t io_write_bytes;
   uint64_t io_write_requests;
+  uint64_t m_large_scans = 0;
 
  public:
   Rdb_io_perf(const Rdb_io_perf &) = delete;
@@ -150,9 +217,11 @@ class Rdb_io_perf {
 
     io_write_bytes = 0;
     io_write_requests = 0;
+    m_large_scans = 0;
   }
 
   bool start(const uint32_t perf_context_level);
+  void record_large_scan() { m_large_scans++; }
   void update_bytes_written(const uint32_t perf_context_level,
                             ulonglong bytes_written);
   void end_and_record(THD *thd);
@@ -31,11 +31,29 @@ namespace myrocks {
 my_core::PSI_stage_info stage_waiting_on_row_lock = {0, "Waiting for row lock",
                                                      0, PSI_DOCUMENT_ME};
 
+/* phases of a knn search on a vector index */
+my_core::PSI_stage_info stage_vector_assigning_lists = {
+    0, "Assigning vector index lists", 0, PSI_DOCUMENT_ME};
+my_core::PSI_stage_info stage_vector_scanning_lists = {
+    0, "Scanning vector index lists", PSI_FLAG_STAGE_PROGRESS,
+    PSI_DOCUMENT_ME};
+my_core::PSI_stage_info stage_vector_ranking_candidates = {
+    0, "Ranking vector index candidates", 0, PSI_DOCUMENT_ME};
+my_core::PSI_stage_info stage_vector_fetching_rows = {
+    0, "Fetching vector index rows", 0, PSI_DOCUMENT_ME};
+
+/* needed by the search result allocator with or without P_S */
+my_core::PSI_memory_key rdb_search_result_memory_key = PSI_NOT_INSTRUMENTED;
+
 #ifdef HAVE_PSI_INTERFACE
-my_core::PSI_stage_info *all_rocksdb_stages[] = {&stage_waiting_on_row_lock};
+my_core::PSI_stage_info *all_rocksdb_stages[] = {
+    &stage_waiting_on_row_lock, &stage_vector_assigning_lists,
+    &stage_vector_scanning_lists, &stage_vector_ranking_candidates,
+    &stage_vector_fetching_rows};
 
 my_core::PSI_thread_key rdb_background_psi_thread_key,
-    rdb_drop_idx_psi_thread_key, rdb_is_psi_thread_key, rdb_mc_psi_thread_key;
+    rdb_drop_idx_psi_thread_key, rdb_is_psi_thread_key, rdb_mc_psi_thread_key,
+    rdb_pi_psi_thread_key, rdb_setup_psi_thread_key;
 
 my_core::PSI_thread_info all_rocksdb_threads[] = {
     {&rdb_background_psi_thread_key, "background", "background",
@@ -46,13 +64,19 @@ my_core::PSI_thread_info all_rocksdb_threads[] = {
      PSI_FLAG_SINGLETON, 0, PSI_DOCUMENT_ME},
     {&rdb_mc_psi_thread_key, "manual compaction", "mc_psi", PSI_FLAG_SINGLETON,
      0, PSI_DOCUMENT_ME},
+    {&rdb_pi_psi_thread_key, "partial index materialization", "pi_psi",
+     PSI_FLAG_SINGLETON, 0, PSI_DOCUMENT_ME},
+    {&rdb_setup_psi_thread_key, "index setup", "setup_psi",
+     PSI_FLAG_SINGLETON, 0, PSI_DOCUMENT_ME},
 };
 
 my_core::PSI_mutex_key rdb_psi_open_tbls_mutex_key, rdb_signal_bg_psi_mutex_key,
     rdb_signal_drop_idx_psi_mutex_key, rdb_signal_is_psi_mutex_key,
-    rdb_signal_mc_psi_mutex_key, rdb_collation_data_mutex_key,
-    rdb_mem_cmp_space_mutex_key, key_mutex_tx_list, rdb_cfm_mutex_key,
-    rdb_sst_commit_key, rdb_block_cache_resize_mutex_key,
+    rdb_signal_mc_psi_mutex_key, rdb_signal_pi_psi_mutex_key,
+    rdb_signal_setup_psi_mutex_key, rdb_collation_data_mutex_key,
+    rdb_mem_cmp_space_mutex_key,
+    key_mutex_tx_list, rdb_cfm_mutex_key, rdb_sst_commit_key,
+    rdb_block_cache_resize_mutex_key,
     rdb_bottom_pri_background_compactions_resize_mutex_key,
     clone_donor_file_metadata_mutex_key, clone_main_task_remaining_mutex_key,
     clone_error_mutex_key;
@@ -68,6 +92,10 @@ my_core::PSI_mutex_info all_rocksdb_mutexes[] = {
      PSI_FLAG_SINGLETON, 0, PSI_DOCUMENT_ME},
     {&rdb_signal_mc_psi_mutex_key, "signal manual compaction",
      PSI_FLAG_SINGLETON, 0, PSI_DOCUMENT_ME},
+    {&rdb_signal_pi_psi_mutex_key, "signal partial index materialization",
+     PSI_FLAG_SINGLETON, 0, PSI_DOCUMENT_ME},
+    {&rdb_signal_setup_psi_mutex_key, "signal index setup", PSI_FLAG_SINGLETON,
+     0, PSI_DOCUMENT_ME},
     {&rdb_collation_data_mutex_key, "collation data init", PSI_FLAG_SINGLETON,
      0, PSI_DOCUMENT_ME},
     {&rdb_mem_cmp_space_mutex_key, "collation space char data init",
@@ -109,7 +137,8 @@ my_core::PSI_rwlock_info all_rocksdb_rwlocks[] = {
 
 my_core::PSI_cond_key rdb_signal_bg_psi_cond_key,
     rdb_signal_drop_idx_psi_cond_key, rdb_signal_is_psi_cond_key,
-    rdb_signal_mc_psi_cond_key, rdb_signal_clone_main_task_remaining_key,
+    rdb_signal_mc_psi_cond_key, rdb_signal_pi_psi_cond_key,
+    rdb_signal_setup_psi_cond_key, rdb_signal_clone_main_task_remaining_key,
     rdb_signal_clone_reconnection_key;
 
 my_core::PSI_cond_info all_rocksdb_conds[] = {
@@ -121,6 +150,10 @@ my_core::PSI_cond_info all_rocksdb_conds[] = {
      PSI_FLAG_SINGLETON, 0, PSI_DOCUMENT_ME},
     {&rdb_signal_mc_psi_cond_key, "cond signal manual compaction",
      PSI_FLAG_SINGLETON, 0, PSI_DOCUMENT_ME},
+    {&rdb_signal_pi_psi_cond_key, "cond signal partial index materialization",
+     PSI_FLAG_SINGLETON, 0, PSI_DOCUMENT_ME},
+    {&rdb_signal_setup_psi_cond_key, "cond signal index setup",
+     PSI_FLAG_SINGLETON, 0, PSI_DOCUMENT_ME},
     {&rdb_signal_clone_main_task_remaining_key,
      "cond signal clone main task remaining", 0, 0, PSI_DOCUMENT_ME},
     {&rdb_signal_clone_reconnection_key, "cond signal clone reconnected", 0, 0,
@@ -134,6 +167,11 @@ my_core::PSI_file_info all_rocksdb_files[] = {
     {&rdb_clone_client_file_key, "clone_client_file", 0, 0, PSI_DOCUMENT_ME},
 };
 
+my_core::PSI_memory_info all_rocksdb_memory[] = {
+    {&rdb_search_result_memory_key, "search_result", PSI_FLAG_MEM_COLLECT, 0,
+     "Result buffers of vector and spatial index searches."},
+};
+
 void init_rocksdb_psi_keys() {
   const char *const category = "rocksdb";
   int count;
@@ -157,6 +195,8 @@ void init_rocksdb_psi_keys() {
 
   count = array_elements(all_rocksdb_files);
   mysql_file_register(category, all_rocksdb_files, count);
+  count = array_elements(all_rocksdb_memory);
+  mysql_memory_register(category, all_rocksdb_memory, count);
 }
 #else   // HAVE_PSI_INTERFACE
 void init_rocksdb_psi_keys() {}
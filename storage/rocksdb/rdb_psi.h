@@ -17,14 +17,19 @@
 #ifndef _rdb_psi_h_
 #define _rdb_psi_h_
 
+/* C++ standard header files */
+#include <new>
+
 /* MySQL header files */
 
 #include <mysql/psi/mysql_cond.h>
 #include <mysql/psi/mysql_file.h>
+#include <mysql/psi/mysql_memory.h>
 #include <mysql/psi/mysql_mutex.h>
 #include <mysql/psi/mysql_rwlock.h>
 #include <mysql/psi/mysql_stage.h>
 #include <mysql/psi/mysql_thread.h>
+#include "my_sys.h"
 
 /* MyRocks header files */
 #include "./rdb_utils.h"
@@ -36,16 +41,22 @@ namespace myrocks {
   irrespectively of whether we're compiling with P_S or not.
 */
 extern my_core::PSI_stage_info stage_waiting_on_row_lock;
+extern my_core::PSI_stage_info stage_vector_assigning_lists,
+    stage_vector_scanning_lists, stage_vector_ranking_candidates,
+    stage_vector_fetching_rows;
 
 #ifdef HAVE_PSI_INTERFACE
 extern my_core::PSI_thread_key rdb_background_psi_thread_key,
-    rdb_drop_idx_psi_thread_key, rdb_is_psi_thread_key, rdb_mc_psi_thread_key;
+    rdb_drop_idx_psi_thread_key, rdb_is_psi_thread_key, rdb_mc_psi_thread_key,
+    rdb_pi_psi_thread_key, rdb_setup_psi_thread_key;
 
 extern my_core::PSI_mutex_key rdb_psi_open_tbls_mutex_key,
     rdb_signal_bg_psi_mutex_key, rdb_signal_drop_idx_psi_mutex_key,
     rdb_signal_is_psi_mutex_key, rdb_signal_mc_psi_mutex_key,
-    rdb_collation_data_mutex_key, rdb_mem_cmp_space_mutex_key,
-    key_mutex_tx_list, rdb_cfm_mutex_key, rdb_sst_commit_key,
+    rdb_signal_pi_psi_mutex_key, rdb_signal_setup_psi_mutex_key,
+    rdb_collation_data_mutex_key,
+    rdb_mem_cmp_space_mutex_key, key_mutex_tx_list, rdb_cfm_mutex_key,
+    rdb_sst_commit_key,
     rdb_block_cache_resize_mutex_key,
     rdb_bottom_pri_background_compactions_resize_mutex_key,
     clone_donor_file_metadata_mutex_key, clone_main_task_remaining_mutex_key,
@@ -58,7 +69,8 @@ extern my_core::PSI_rwlock_key key_rwlock_collation_exception_list,
 
 extern my_core::PSI_cond_key rdb_signal_bg_psi_cond_key,
     rdb_signal_drop_idx_psi_cond_key, rdb_signal_is_psi_cond_key,
-    rdb_signal_mc_psi_cond_key, rdb_signal_clone_main_task_remaining_key,
+    rdb_signal_mc_psi_cond_key, rdb_signal_pi_psi_cond_key,
+    rdb_signal_setup_psi_cond_key, rdb_signal_clone_main_task_remaining_key,
     rdb_signal_clone_reconnection_key;
 
 extern my_core::PSI_file_key rdb_clone_donor_file_key,
@@ -66,6 +78,47 @@ extern my_core::PSI_file_key rdb_clone_donor_file_key,
 
 #endif  // HAVE_PSI_INTERFACE
 
+/*
+  Result buffers of vector and spatial searches. The key collects memory,
+  so the buffers count against the connection memory of the thread.
+*/
+extern my_core::PSI_memory_key rdb_search_result_memory_key;
+
+/*
+  STL allocator of the search result buffers, allocating through my_malloc()
+  with rdb_search_result_memory_key.
+*/
+template <class T>
+class Rdb_search_result_allocator {
+ public:
+  using value_type = T;
+
+  Rdb_search_result_allocator() = default;
+  template <class U>
+  Rdb_search_result_allocator(const Rdb_search_result_allocator<U> &) {}
+
+  T *allocate(std::size_t n) {
+    T *const p = static_cast<T *>(my_malloc(rdb_search_result_memory_key,
+                                            n * sizeof(T), MYF(MY_WME)));
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+  }
+
+  void deallocate(T *p, std::size_t) { my_free(p); }
+};
+
+template <class T, class U>
+bool operator==(const Rdb_search_result_allocator<T> &,
+                const Rdb_search_result_allocator<U> &) {
+  return true;
+}
+
+template <class T, class U>
+bool operator!=(const Rdb_search_result_allocator<T> &,
+                const Rdb_search_result_allocator<U> &) {
+  return false;
+}
+
 void init_rocksdb_psi_keys();
 
 }  // namespace myrocks
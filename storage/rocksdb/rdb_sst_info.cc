@@ -18,8 +18,10 @@
 #include "./rdb_sst_info.h"
 
 /* C++ standard header files */
+#include <algorithm>
 #include <cinttypes>
 #include <cstdio>
+#include <cstring>
 #include <string>
 #include <utility>
 #include <vector>
@@ -557,4 +559,171 @@ void Rdb_sst_info::init(const rocksdb::DB *const db) {
 
 std::atomic<uint64_t> Rdb_sst_info::m_prefix_counter(0);
 std::string Rdb_sst_info::m_suffix = ".bulk_load.tmp.sst";
+
+static void rdb_segment_append(std::string *const data,
+                               const rocksdb::Slice &slice) {
+  const uint64_t size = slice.size();
+  data->append(reinterpret_cast<const char *>(&size), sizeof(size));
+  data->append(slice.data(), slice.size());
+}
+
+static rocksdb::Slice rdb_segment_read(const char **const ptr) {
+  uint64_t size;
+  memcpy(&size, *ptr, sizeof(size));
+  const rocksdb::Slice slice(*ptr + sizeof(size), size);
+  *ptr += sizeof(size) + size;
+  return slice;
+}
+
+Rdb_sst_parallel_writer::Rdb_sst_parallel_writer(
+    rocksdb::DB *db, const std::string &tablename,
+    const std::string &indexname, rocksdb::ColumnFamilyHandle &cf,
+    const rocksdb::DBOptions &db_options, bool tracing,
+    uint32_t compression_parallel_threads, uint threads)
+    : m_db(db),
+      m_tablename(tablename),
+      m_indexname(indexname),
+      m_cf(cf),
+      m_db_options(db_options),
+      m_tracing(tracing),
+      m_compression_parallel_threads(compression_parallel_threads),
+      m_segment(new Rdb_sst_segment),
+      m_done(false),
+      m_error(HA_EXIT_SUCCESS) {
+  rocksdb::ColumnFamilyDescriptor cf_descr;
+  const auto s = m_cf.GetDescriptor(&cf_descr);
+  // Same default as Rdb_sst_info if we can't get the cf's target size
+  m_segment_size =
+      s.ok() ? cf_descr.options.target_file_size_base : 64 * 1024 * 1024;
+
+  for (uint i = 0; i < std::max(threads, 1U); i++) {
+    m_threads.emplace_back(&Rdb_sst_parallel_writer::write_segments, this);
+  }
+}
+
+Rdb_sst_parallel_writer::~Rdb_sst_parallel_writer() {
+  {
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.clear();
+  }
+  stop();
+}
+
+void Rdb_sst_parallel_writer::stop() {
+  {
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    m_done = true;
+  }
+  m_cond.notify_all();
+
+  for (auto &thread : m_threads) {
+    thread.join();
+  }
+  m_threads.clear();
+}
+
+int Rdb_sst_parallel_writer::put(const rocksdb::Slice &key,
+                                 const rocksdb::Slice &value) {
+  rdb_segment_append(&m_segment->m_data, key);
+  rdb_segment_append(&m_segment->m_data, value);
+
+  if (m_segment->m_data.size() >= m_segment_size) {
+    return submit_segment();
+  }
+  return HA_EXIT_SUCCESS;
+}
+
+int Rdb_sst_parallel_writer::submit_segment() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  // Bound the memory held by the segments waiting for a thread
+  m_cond.wait(lock, [this]() {
+    return m_error != HA_EXIT_SUCCESS || m_queue.size() < m_threads.size();
+  });
+  if (m_error != HA_EXIT_SUCCESS) {
+    return m_error;
+  }
+
+  m_queue.push_back(std::move(m_segment));
+  lock.unlock();
+  m_cond.notify_all();
+
+  m_segment.reset(new Rdb_sst_segment);
+  return HA_EXIT_SUCCESS;
+}
+
+void Rdb_sst_parallel_writer::write_segments() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for (;;) {
+    m_cond.wait(lock, [this]() { return m_done || !m_queue.empty(); });
+    if (m_queue.empty()) {
+      return;
+    }
+
+    std::unique_ptr<Rdb_sst_segment> segment = std::move(m_queue.front());
+    m_queue.pop_front();
+    lock.unlock();
+    m_cond.notify_all();
+
+    Rdb_sst_info::Rdb_sst_commit_info commit_info;
+    const int rc = write_segment(*segment, &commit_info);
+    segment.reset();
+
+    lock.lock();
+    if (rc != HA_EXIT_SUCCESS) {
+      // Drop the segments not written yet, the whole load fails
+      if (m_error == HA_EXIT_SUCCESS) {
+        m_error = rc;
+      }
+      m_queue.clear();
+      m_cond.notify_all();
+    } else if (commit_info.has_work()) {
+      m_commit_infos.push_back(std::move(commit_info));
+    }
+  }
+}
+
+int Rdb_sst_parallel_writer::write_segment(
+    const Rdb_sst_segment &segment,
+    Rdb_sst_info::Rdb_sst_commit_info *commit_info) {
+  Rdb_sst_info sst_info(m_db, m_tablename, m_indexname, m_cf, m_db_options,
+                        m_tracing, m_compression_parallel_threads);
+  // There is no client to report to on this thread
+  sst_info.set_print_client_error(false);
+
+  int rc = HA_EXIT_SUCCESS;
+  const char *ptr = segment.m_data.data();
+  const char *const end = ptr + segment.m_data.size();
+  while (ptr < end) {
+    const rocksdb::Slice key = rdb_segment_read(&ptr);
+    const rocksdb::Slice value = rdb_segment_read(&ptr);
+    if ((rc = sst_info.put(key, value)) != HA_EXIT_SUCCESS) {
+      break;
+    }
+  }
+
+  // Finish the sst_info even on errors so that its files are removed
+  const int finish_rc = sst_info.finish(commit_info, false);
+  return rc != HA_EXIT_SUCCESS ? rc : finish_rc;
+}
+
+int Rdb_sst_parallel_writer::finish(
+    std::vector<Rdb_sst_info::Rdb_sst_commit_info> *commit_list) {
+  int rc = HA_EXIT_SUCCESS;
+  if (!m_segment->m_data.empty()) {
+    rc = submit_segment();
+  }
+  stop();
+
+  if (rc == HA_EXIT_SUCCESS) {
+    rc = m_error;
+  }
+  if (rc == HA_EXIT_SUCCESS) {
+    for (auto &commit_info : m_commit_infos) {
+      commit_list->emplace_back(std::move(commit_info));
+    }
+  }
+  // Any files not handed over are removed here
+  m_commit_infos.clear();
+  return rc;
+}
 }  // namespace myrocks
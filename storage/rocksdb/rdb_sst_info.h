@@ -18,8 +18,13 @@
 
 /* C++ standard header files */
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <stack>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -227,6 +232,11 @@ class Rdb_sst_info {
   int put(const rocksdb::Slice &key, const rocksdb::Slice &value);
   int finish(Rdb_sst_commit_info *commit_info, bool print_client_error = true);
 
+  /* Whether errors of put() are reported to the client */
+  void set_print_client_error(bool print_client_error) {
+    m_print_client_error = print_client_error;
+  }
+
   bool is_done() const { return m_done; }
 
   bool have_background_error() { return m_background_error != 0; }
@@ -259,4 +269,63 @@ class Rdb_sst_info {
                                const char *sst_file_name);
 };
 
+/*
+  Writes keys put in ascending order into SST files on several threads. The
+  keys are cut into segments of about the target file size of the column
+  family, and each segment is written into SST files of its own by one of
+  the threads, so the files of different segments do not overlap and can be
+  ingested together.
+*/
+class Rdb_sst_parallel_writer {
+  Rdb_sst_parallel_writer(const Rdb_sst_parallel_writer &) = delete;
+  Rdb_sst_parallel_writer &operator=(const Rdb_sst_parallel_writer &) = delete;
+
+  /* keys and values of a segment, each preceded by its length */
+  struct Rdb_sst_segment {
+    std::string m_data;
+  };
+
+  rocksdb::DB *const m_db;
+  const std::string m_tablename;
+  const std::string m_indexname;
+  rocksdb::ColumnFamilyHandle &m_cf;
+  const rocksdb::DBOptions &m_db_options;
+  const bool m_tracing;
+  const uint32_t m_compression_parallel_threads;
+  uint64_t m_segment_size;
+
+  std::unique_ptr<Rdb_sst_segment> m_segment;
+  std::vector<std::thread> m_threads;
+
+  /* protects the members below */
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  std::deque<std::unique_ptr<Rdb_sst_segment>> m_queue;
+  bool m_done;
+  int m_error;
+  std::vector<Rdb_sst_info::Rdb_sst_commit_info> m_commit_infos;
+
+  int submit_segment();
+  void write_segments();
+  int write_segment(const Rdb_sst_segment &segment,
+                    Rdb_sst_info::Rdb_sst_commit_info *commit_info);
+  void stop();
+
+ public:
+  Rdb_sst_parallel_writer(rocksdb::DB *db, const std::string &tablename,
+                          const std::string &indexname,
+                          rocksdb::ColumnFamilyHandle &cf,
+                          const rocksdb::DBOptions &db_options, bool tracing,
+                          uint32_t compression_parallel_threads, uint threads);
+  ~Rdb_sst_parallel_writer();
+
+  int put(const rocksdb::Slice &key, const rocksdb::Slice &value);
+
+  /*
+    Wait for the segments to be written, and append the SST files of each
+    to commit_list. The errors are not reported to the client.
+  */
+  int finish(std::vector<Rdb_sst_info::Rdb_sst_commit_info> *commit_list);
+};
+
 }  // namespace myrocks
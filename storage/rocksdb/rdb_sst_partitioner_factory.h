@@ -19,6 +19,7 @@
 #include <strings.h>
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <map>
 #include <memory>
 #include <utility>
@@ -26,6 +27,7 @@
 #include "rocksdb/sst_partitioner.h"
 #include "rocksdb/utilities/transaction_db.h"
 
+#include "./ha_rocksdb_proto.h"
 #include "./rdb_cf_manager.h"
 #include "./rdb_datadic.h"
 
@@ -148,9 +150,76 @@ class Rdb_index_boundary_sst_partitioner : public rocksdb::SstPartitioner {
   };
 };
 
+/**
+ * This class ends output sst files at the boundaries between the ivf lists
+ * of vector indexes, once a file holds at least min_file_size bytes. Keys of
+ * ivf entries start with index id and list id, a list is probed with one
+ * range scan, so a list that does not straddle files is read from fewer of
+ * them. Other splits, such as the bulk load ones, are passed through from
+ * the next partitioner.
+ */
+class Rdb_vector_list_sst_partitioner : public rocksdb::SstPartitioner {
+ private:
+  static constexpr size_t LIST_PREFIX_SIZE =
+      Rdb_key_def::INDEX_NUMBER_SIZE + sizeof(uint64);
+
+  const std::set<Index_id> m_index_ids;
+  const uint64_t m_min_file_size;
+  const std::unique_ptr<rocksdb::SstPartitioner> m_next;
+
+  bool is_list_boundary(const rocksdb::Slice &previous_key,
+                        const rocksdb::Slice &current_key) const {
+    if (previous_key.size() < LIST_PREFIX_SIZE ||
+        current_key.size() < LIST_PREFIX_SIZE ||
+        memcmp(previous_key.data(), current_key.data(),
+               Rdb_key_def::INDEX_NUMBER_SIZE) != 0 ||
+        memcmp(previous_key.data(), current_key.data(), LIST_PREFIX_SIZE) ==
+            0) {
+      return false;
+    }
+    const Index_id index_id = rdb_netbuf_to_uint32(
+        reinterpret_cast<const uchar *>(current_key.data()));
+    return m_index_ids.count(index_id) != 0;
+  }
+
+ public:
+  Rdb_vector_list_sst_partitioner(
+      std::set<Index_id> index_ids, uint64_t min_file_size,
+      std::unique_ptr<rocksdb::SstPartitioner> next)
+      : m_index_ids(std::move(index_ids)),
+        m_min_file_size(min_file_size),
+        m_next(std::move(next)) {}
+
+  ~Rdb_vector_list_sst_partitioner() override {}
+
+  const char *Name() const override {
+    return "Rdb_vector_list_sst_partitioner";
+  }
+
+  rocksdb::PartitionerResult ShouldPartition(
+      const rocksdb::PartitionerRequest &request) override {
+    if (m_next != nullptr && m_next->ShouldPartition(request) ==
+                                 rocksdb::PartitionerResult::kRequired) {
+      return rocksdb::PartitionerResult::kRequired;
+    }
+    if (request.current_output_file_size >= m_min_file_size &&
+        is_list_boundary(*request.prev_user_key, *request.current_user_key)) {
+      return rocksdb::PartitionerResult::kRequired;
+    }
+    return rocksdb::PartitionerResult::kNotRequired;
+  };
+
+  bool CanDoTrivialMove(const rocksdb::Slice &smallest_user_key,
+                        const rocksdb::Slice &largest_user_key) override {
+    return m_next == nullptr ||
+           m_next->CanDoTrivialMove(smallest_user_key, largest_user_key);
+  };
+};
+
 /**
  * creates sst partitioner used in compaction.
- * see comments in Rdb_index_boundary_sst_partitioner.
+ * see comments in Rdb_index_boundary_sst_partitioner and
+ * Rdb_vector_list_sst_partitioner.
  */
 class Rdb_sst_partitioner_factory : public rocksdb::SstPartitionerFactory {
   const rocksdb::Comparator *m_comparator;
@@ -158,6 +227,8 @@ class Rdb_sst_partitioner_factory : public rocksdb::SstPartitionerFactory {
   const bool m_is_reverse_cf;
   mutable std::mutex m_index_ids_mutex;
   std::set<Index_id> m_index_ids;
+  // ivf index -> vector index objects using it
+  std::map<Index_id, uint> m_vector_index_ids;
 
   std::set<Index_id> get_index_ids() const {
     const std::lock_guard<std::mutex> lock(m_index_ids_mutex);
@@ -165,6 +236,15 @@ class Rdb_sst_partitioner_factory : public rocksdb::SstPartitionerFactory {
     return result;
   };
 
+  std::set<Index_id> get_vector_index_ids() const {
+    const std::lock_guard<std::mutex> lock(m_index_ids_mutex);
+    std::set<Index_id> result;
+    for (const auto &entry : m_vector_index_ids) {
+      result.insert(entry.first);
+    }
+    return result;
+  };
+
  public:
   Rdb_sst_partitioner_factory(const rocksdb::Comparator *comparator,
                               int num_levels, int is_reverse_cf)
@@ -179,6 +259,22 @@ class Rdb_sst_partitioner_factory : public rocksdb::SstPartitionerFactory {
 
   std::unique_ptr<rocksdb::SstPartitioner> CreatePartitioner(
       const rocksdb::SstPartitioner::Context &context) const override {
+    auto partitioner = create_index_boundary_partitioner(context);
+    const uint64_t list_partition_size = rdb_get_vector_list_partition_size();
+    if (list_partition_size > 0) {
+      auto vector_index_ids = get_vector_index_ids();
+      if (!vector_index_ids.empty()) {
+        return std::unique_ptr<rocksdb::SstPartitioner>(
+            new Rdb_vector_list_sst_partitioner(std::move(vector_index_ids),
+                                                list_partition_size,
+                                                std::move(partitioner)));
+      }
+    }
+    return partitioner;
+  };
+
+  std::unique_ptr<rocksdb::SstPartitioner> create_index_boundary_partitioner(
+      const rocksdb::SstPartitioner::Context &context) const {
     // we need special partitioner for Lmax.
     // when rocksdb checks if SstPartitioner is used in a manual compaction,
     // it passes -1 as output_level to indicate output_level is not yet known.
@@ -226,6 +322,36 @@ class Rdb_sst_partitioner_factory : public rocksdb::SstPartitionerFactory {
     const std::lock_guard<std::mutex> lock(m_index_ids_mutex);
     return m_index_ids.erase(index_id) == 1;
   }
+
+  /**
+   * split sst files at the ivf list boundaries of the index, an index can be
+   * added several times and is split until it is removed as many times
+   */
+  void add_vector_index(Index_id index_id) {
+    const std::lock_guard<std::mutex> lock(m_index_ids_mutex);
+    m_vector_index_ids[index_id]++;
+  }
+
+  void remove_vector_index(Index_id index_id) {
+    const std::lock_guard<std::mutex> lock(m_index_ids_mutex);
+    const auto it = m_vector_index_ids.find(index_id);
+    if (it != m_vector_index_ids.end() && --it->second == 0) {
+      m_vector_index_ids.erase(it);
+    }
+  }
+
+  /**
+   * the factory of a column family, nullptr if it has none or the db is
+   * not open
+   */
+  static Rdb_sst_partitioner_factory *get(rocksdb::DB *rdb,
+                                          rocksdb::ColumnFamilyHandle &cf) {
+    if (rdb == nullptr) {
+      return nullptr;
+    }
+    return dynamic_cast<Rdb_sst_partitioner_factory *>(
+        rdb->GetOptions(&cf).sst_partitioner_factory.get());
+  }
 };
 
 /**
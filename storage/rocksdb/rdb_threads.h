@@ -18,8 +18,11 @@
 
 /* C++ standard header files */
 #include <deque>
+#include <list>
 #include <map>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 /* MySQL includes */
 #include <mysql/psi/mysql_table.h>
@@ -217,6 +220,41 @@ class Rdb_manual_compaction_thread : public Rdb_thread {
                                         const int timeout_100ms);
 };
 
+/*
+  Partial index materialization thread control
+
+  Readers of a partial index that find a group over the threshold queue it
+  here, with the rows they read, and go on with the rows sorted in memory.
+  The thread writes the groups into the index one at a time, at most
+  rocksdb_partial_index_materialize_rate rows a second.
+*/
+
+class Rdb_partial_index_thread : public Rdb_thread {
+ private:
+  // the groups queued at most, each holding all its rows
+  static constexpr size_t MAX_REQUESTS = 64;
+
+  mutable mysql_mutex_t m_req_mutex;
+  // the request at the front is the one being materialized, if running
+  std::list<Rdb_partial_index_request> m_requests;
+  std::unordered_set<std::string> m_prefixes;
+
+  bool materialize(const Rdb_partial_index_request &req);
+  void wait_for_rate(ulonglong num_rows);
+
+ public:
+  virtual void on_init() override {
+    mysql_mutex_init(0, &m_req_mutex, MY_MUTEX_INIT_FAST);
+  }
+
+  virtual void on_uninit() override { mysql_mutex_destroy(&m_req_mutex); }
+
+  virtual void run() override;
+  bool add_request(Rdb_partial_index_request &&req);
+  std::vector<Rdb_partial_index_request> get_requests() const;
+  void clear_all_requests();
+};
+
 /*
   Drop index thread control
 */
@@ -225,4 +263,13 @@ struct Rdb_drop_index_thread : public Rdb_thread {
   virtual void run() override;
 };
 
+/*
+  Sets up the indexes of all tables once the server has started, over
+  rocksdb_vector_index_setup_threads workers, so that the trained data of the
+  vector indexes is not loaded by the first queries.
+*/
+struct Rdb_index_setup_thread : public Rdb_thread {
+  virtual void run() override;
+};
+
 }  // namespace myrocks
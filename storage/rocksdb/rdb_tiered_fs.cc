@@ -0,0 +1,104 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+/* This C++ file's header */
+#include "./rdb_tiered_fs.h"
+
+/* C++ standard header files */
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace myrocks {
+
+namespace {
+
+std::string rdb_file_dir(const std::string &fname) {
+  const size_t slash = fname.rfind('/');
+  return (slash == std::string::npos) ? "." : fname.substr(0, slash);
+}
+
+std::string rdb_file_base(const std::string &fname) {
+  const size_t slash = fname.rfind('/');
+  return (slash == std::string::npos) ? fname : fname.substr(slash + 1);
+}
+
+/* the target of the symbolic link fname, empty if it is not one */
+std::string rdb_link_target(const std::string &fname) {
+  char target[PATH_MAX];
+  const ssize_t len = readlink(fname.c_str(), target, sizeof(target) - 1);
+  return (len > 0) ? std::string(target, len) : std::string();
+}
+
+}  // namespace
+
+rocksdb::IOStatus Rdb_tiered_fs::NewWritableFile(
+    const std::string &fname, const rocksdb::FileOptions &file_opts,
+    std::unique_ptr<rocksdb::FSWritableFile> *result,
+    rocksdb::IODebugContext *dbg) {
+  if (!is_cold(file_opts.temperature)) {
+    return target()->NewWritableFile(fname, file_opts, result, dbg);
+  }
+
+  const std::string cold_fname = m_cold_dir + "/" + rdb_file_base(fname);
+  rocksdb::IOStatus s =
+      target()->NewWritableFile(cold_fname, file_opts, result, dbg);
+  if (!s.ok()) {
+    return s;
+  }
+
+  if (symlink(cold_fname.c_str(), fname.c_str()) != 0) {
+    const int err = errno;
+    result->reset();
+    target()->DeleteFile(cold_fname, rocksdb::IOOptions(), dbg);
+    return rocksdb::IOStatus::IOError("While linking " + fname + " to " +
+                                      cold_fname,
+                                      strerror(err));
+  }
+  return s;
+}
+
+rocksdb::IOStatus Rdb_tiered_fs::DeleteFile(const std::string &fname,
+                                            const rocksdb::IOOptions &options,
+                                            rocksdb::IODebugContext *dbg) {
+  struct stat st;
+  std::string cold_fname;
+  // a checkpoint hard links the link itself, the file stays while it does
+  if (lstat(fname.c_str(), &st) == 0 && S_ISLNK(st.st_mode) &&
+      st.st_nlink == 1) {
+    cold_fname = rdb_link_target(fname);
+    if (rdb_file_dir(cold_fname) != m_cold_dir) {
+      cold_fname.clear();
+    }
+  }
+
+  rocksdb::IOStatus s = target()->DeleteFile(fname, options, dbg);
+  if (s.ok() && !cold_fname.empty()) {
+    s = target()->DeleteFile(cold_fname, options, dbg);
+  }
+  return s;
+}
+
+std::string Rdb_tiered_fs::storage_dir(const std::string &fname) {
+  const std::string target = rdb_link_target(fname);
+  return rdb_file_dir(target.empty() ? fname : target);
+}
+
+}  // namespace myrocks
@@ -0,0 +1,67 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+#pragma once
+
+/* C++ standard header files */
+#include <memory>
+#include <string>
+
+/* RocksDB header files */
+#include "rocksdb/file_system.h"
+
+namespace myrocks {
+
+/*
+  A file system placing the files RocksDB writes with a cold temperature in
+  another directory, usually on a cheaper device. A column family hints the
+  temperature of its last level with last_level_temperature=kCold in
+  @@rocksdb_override_cf_options.
+
+  A cold file lives in the cold directory under its own name, with a
+  symbolic link to it where RocksDB created it, so every other access goes
+  through the link unchanged. The file is removed with the last link to it,
+  which the hard links of checkpoints keep alive.
+*/
+class Rdb_tiered_fs : public rocksdb::FileSystemWrapper {
+ public:
+  Rdb_tiered_fs(const std::shared_ptr<rocksdb::FileSystem> &target,
+                const std::string &cold_dir)
+      : rocksdb::FileSystemWrapper(target), m_cold_dir(cold_dir) {}
+
+  static const char *kClassName() { return "Rdb_tiered_fs"; }
+  const char *Name() const override { return kClassName(); }
+
+  rocksdb::IOStatus NewWritableFile(
+      const std::string &fname, const rocksdb::FileOptions &file_opts,
+      std::unique_ptr<rocksdb::FSWritableFile> *result,
+      rocksdb::IODebugContext *dbg) override;
+
+  rocksdb::IOStatus DeleteFile(const std::string &fname,
+                               const rocksdb::IOOptions &options,
+                               rocksdb::IODebugContext *dbg) override;
+
+  /* the directory the file fname is stored in, after the link if any */
+  static std::string storage_dir(const std::string &fname);
+
+ private:
+  static bool is_cold(rocksdb::Temperature temperature) {
+    return temperature == rocksdb::Temperature::kCold;
+  }
+
+  const std::string m_cold_dir;
+};
+
+}  // namespace myrocks
@@ -19,6 +19,7 @@
 
 /* C++ standard header files */
 #include <array>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -40,6 +41,7 @@
 #include "rocksdb/env.h"
 #include "rocksdb/file_system.h"
 #include "rocksdb/io_status.h"
+#include "rocksdb/utilities/write_batch_with_index.h"
 
 namespace myrocks {
 
@@ -309,6 +311,20 @@ void rdb_log_status_error(const rocksdb::Status &s, const char *msg) {
                   s.ToString().c_str());
 }
 
+bool rdb_batch_has_prefix(rocksdb::WriteBatchWithIndex *wb,
+                          rocksdb::ColumnFamilyHandle *cf,
+                          const rocksdb::Slice &prefix, bool is_reverse_cf) {
+  if (wb == nullptr || wb->GetWriteBatch()->Count() == 0) return false;
+
+  std::unique_ptr<rocksdb::WBWIIterator> it(wb->NewIterator(cf));
+  if (is_reverse_cf) {
+    it->SeekForPrev(prefix);
+  } else {
+    it->Seek(prefix);
+  }
+  return it->Valid() && it->Entry().key.starts_with(prefix);
+}
+
 bool rdb_has_rocksdb_corruption() {
   rocksdb::DBOptions *rocksdb_db_options = get_rocksdb_db_options();
   assert(rocksdb_db_options->env != nullptr);
@@ -17,6 +17,7 @@
 
 /* C++ standard header files */
 #include <chrono>
+#include <mutex>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -33,6 +34,11 @@
 #include "rocksdb/slice.h"
 #include "rocksdb/status.h"
 
+namespace rocksdb {
+class ColumnFamilyHandle;
+class WriteBatchWithIndex;
+}  // namespace rocksdb
+
 /* MyRocks header files */
 #include "./rdb_global.h"
 
@@ -271,6 +277,13 @@ inline void rdb_check_mutex_call_result(const char *function_name,
 
 void rdb_log_status_error(const rocksdb::Status &s, const char *msg = nullptr);
 
+// Whether the write batch holds a key of the column family cf that starts
+// with prefix. The iterator of a reverse column family reaches the keys
+// starting with prefix from the other side.
+bool rdb_batch_has_prefix(rocksdb::WriteBatchWithIndex *wb,
+                          rocksdb::ColumnFamilyHandle *cf,
+                          const rocksdb::Slice &prefix, bool is_reverse_cf);
+
 // return true if the marker file exists which indicates that the corruption
 // has been detected
 bool rdb_has_rocksdb_corruption();
@@ -357,9 +370,9 @@ bool rdb_database_exists(std::string_view db_name);
 
 /**
   Helper class wrappers to meansure startup time
-  Warning: not thread safe. It is mainly designed to
-  be used during the server startup to collect stats
-  on startup function's exection time.
+  It is mainly designed to be used during the server startup to collect
+  stats on startup function's exection time. The phases are kept in the
+  order they started for INFORMATION_SCHEMA.ROCKSDB_STARTUP_TIMELINE.
 
 Usage:
   * member function: MyClass::func(args...)
@@ -373,8 +386,21 @@ Usage:
   *   Rdb_exec_time::report();
 */
 class Rdb_exec_time {
+ public:
+  struct Entry {
+    std::string name;
+    // microseconds since the first phase started
+    uint64_t start_us;
+    uint64_t elapsed_us;
+    // tables, indexes or transactions the phase went through, if counted
+    uint64_t items;
+  };
+
  private:
-  std::unordered_map<std::string, uint64_t> entries_;
+  mutable std::mutex mutex_;
+  std::vector<Entry> entries_;
+  std::chrono::steady_clock::time_point origin_;
+  size_t reported_ = 0;
 
   struct Auto_timer {
     explicit Auto_timer(std::function<void(uint64_t &)> &&cb)
@@ -406,21 +432,44 @@ class Rdb_exec_time {
   template <class Fn, class... Args>
   auto exec(const std::string &key, const Fn &&fn, Args &&...args)
       -> decltype(fn(args...)) {
-    Auto_timer timer([&](uint64_t &e) { entries_.emplace(key, e); });
+    const auto start = std::chrono::steady_clock::now();
+    Auto_timer timer([&](uint64_t &e) { add(key, start, e, 0); });
     return fn(args...);
   }
 
+  /** record a phase which started at start and took elapsed_us */
+  void add(const std::string &key, std::chrono::steady_clock::time_point start,
+           uint64_t elapsed_us, uint64_t items) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (entries_.empty()) origin_ = start;
+    const auto offset = start > origin_ ? start - origin_
+                                        : std::chrono::steady_clock::duration();
+    entries_.push_back(
+        {key,
+         static_cast<uint64_t>(
+             std::chrono::duration_cast<std::chrono::microseconds>(offset)
+                 .count()),
+         elapsed_us, items});
+  }
+
+  std::vector<Entry> entries() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return entries_;
+  }
+
+  /** log the phases recorded since the last report */
   void report() {
-    if (entries_.size() == 0) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (reported_ == entries_.size()) {
       return;
     }
 
     std::string result = "\n{\n";
-    for (auto const &t : entries_) {
-      result += "  \"" + t.first + "\" : ";
-      result += std::to_string(t.second) + "\n";
+    for (size_t i = reported_; i < entries_.size(); i++) {
+      result += "  \"" + entries_[i].name + "\" : ";
+      result += std::to_string(entries_[i].elapsed_us) + "\n";
     }
-    entries_.clear();
+    reported_ = entries_.size();
 
     result += "}";
 
@@ -15,200 +15,346 @@
    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
 
 #include "./rdb_vector_db.h"
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <algorithm>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <cfloat>
+#include <chrono>
 #include <cmath>
+#include <deque>
+#include <functional>
+#include <map>
 #include <memory>
+#include <numeric>
+#include <optional>
 #include <queue>
+#include <random>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include "ha_rocksdb.h"
+#include "ha_rocksdb_proto.h"
 #include "rdb_buff.h"
 #include "rdb_cmd_srv_helper.h"
+#include "rdb_datadic.h"
+#include "rdb_fulltext.h"
 #include "rdb_global.h"
 #include "rdb_iterator.h"
+#include "rdb_next_spatial_db.h"
+#include "rdb_psi.h"
+#include "rdb_sst_partitioner_factory.h"
 #include "rdb_utils.h"
+#include "sql-common/json_binary.h"
+#include "sql/fb_vector_distance.h"
+#include "sql/malloc_arena.h"
 #include "sql/next_spatial_base.h"
 #ifdef WITH_FB_VECTORDB
+#include <faiss/Clustering.h>
 #include <faiss/IndexFlat.h>
 #include <faiss/IndexIVFFlat.h>
 #include <faiss/IndexIVFPQ.h>
+#include <faiss/IndexScalarQuantizer.h>
 #include <faiss/utils/Heap.h>
 #include <faiss/utils/distances.h>
 #endif
 #include <rocksdb/db.h>
+#include <rocksdb/utilities/write_batch_with_index.h>
+#include "util/hash.h"
 
 namespace myrocks {
 
-#ifdef WITH_FB_VECTORDB
-namespace {
-// Helper function to extract a specific field from an encoded value slice
-static uint DecodeFieldFromValue(
-    rocksdb::BlockBasedTableOptions::TableConfig& table_config,
-    std::vector<rocksdb::BlockBasedTableOptions::FieldInfo>& field_info_list,
-    std::vector<size_t>& field_indexs,
-    const rocksdb::Slice& value,
-    std::vector<rocksdb::Slice>* field_values) {
-  // Clear the output vector first
-  field_values->clear();
-
-  // 1. Setup string reader for value slice  
-  const char* pos = value.data();
-  size_t remaining = value.size();
-
-  // 2. Skip TTL bytes if configured
-  if (table_config.has_ttl) {
-    if (remaining < 8) {
-      return HA_ERR_ROCKSDB_CORRUPT_DATA;
-    }
-    pos += 8;
-    remaining -= 8;
+void Rdb_vector_value_cache::set_capacity(uint64_t capacity) {
+  m_capacity.store(capacity, std::memory_order_relaxed);
+  const uint64_t shard_capacity = capacity / NUM_SHARDS;
+  for (auto &shard : m_shards) {
+    const std::lock_guard<std::mutex> lock(shard.m_mutex);
+    evict(shard, shard_capacity);
   }
+}
 
-  // 3. Process null bytes
-  const char* null_bytes = nullptr;
-  if (table_config.null_bytes_length > 0) {
-    if (remaining < table_config.null_bytes_length) {
-      return HA_ERR_ROCKSDB_CORRUPT_DATA;
-    }
-    null_bytes = pos;
-    pos += table_config.null_bytes_length;
-    remaining -= table_config.null_bytes_length;
-  }
-
-  // 4. Skip unpack info if configured
-  // temporarily commented out as unpack info set wrongly in test dataset
-
-  // if (table_options.table_config.has_unpack_info) {
-  //   if (remaining < 3) {
-  //     return Status::Corruption("Value too short for unpack info header");
-  //   }
-  //   // Validate unpack info tag
-  //   if (pos[0] != 0) { // First byte should be tag=0
-  //     return Status::Corruption("Invalid unpack info tag");
-  //   }
-  //   // Get unpack info length from next 2 bytes
-  //   uint16_t unpack_len = *reinterpret_cast<const uint16_t*>(pos + 1);
-  //   if (remaining < unpack_len) {
-  //     return Status::Corruption("Value too short for unpack info data");
-  //   }
-  //   pos += unpack_len;
-  //   remaining -= unpack_len;
-  // }
-
-  // 5. Find target field info 
-  // If field_indexs is empty, return an empty result
-  if (field_indexs.empty()) {
-    return HA_EXIT_SUCCESS;
+Rdb_vector_value_cache::Vector_ptr Rdb_vector_value_cache::lookup(
+    const rocksdb::Slice &key, uint64_t value_hash) {
+  const std::string key_str = key.ToString();
+  Shard &shard = get_shard(key_str);
+  const std::lock_guard<std::mutex> lock(shard.m_mutex);
+  auto iter = shard.m_entries.find(key_str);
+  if (iter == shard.m_entries.end() ||
+      iter->second.m_value_hash != value_hash) {
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
   }
-  
-  // Find the maximum field index to determine how far we need to scan
-  size_t max_field_index = 0;
-  for (size_t idx : field_indexs) {
-    if (idx >= field_info_list.size()) {
-      return HA_ERR_ROCKSDB_CORRUPT_DATA;
-    }
-    max_field_index = std::max(max_field_index, idx);
+  shard.m_lru.splice(shard.m_lru.begin(), shard.m_lru,
+                     iter->second.m_lru_pos);
+  m_hits.fetch_add(1, std::memory_order_relaxed);
+  return iter->second.m_vector;
+}
+
+void Rdb_vector_value_cache::insert(const rocksdb::Slice &key,
+                                    uint64_t value_hash, Vector_ptr vector) {
+  const uint64_t shard_capacity =
+      m_capacity.load(std::memory_order_relaxed) / NUM_SHARDS;
+  // rough per entry overhead of the map node, lru node and shared_ptr
+  // control block
+  const std::size_t charge =
+      2 * key.size() + vector->size() * sizeof(float) + 128;
+  if (charge > shard_capacity) {
+    return;
+  }
+
+  std::string key_str = key.ToString();
+  Shard &shard = get_shard(key_str);
+  const std::lock_guard<std::mutex> lock(shard.m_mutex);
+  auto iter = shard.m_entries.find(key_str);
+  if (iter != shard.m_entries.end()) {
+    // replace the stale entry left behind by an update of the row
+    shard.m_usage -= iter->second.m_charge;
+    shard.m_lru.erase(iter->second.m_lru_pos);
+    shard.m_entries.erase(iter);
+  }
+  shard.m_lru.push_front(key_str);
+  shard.m_entries.emplace(
+      std::move(key_str),
+      Entry{value_hash, std::move(vector), charge, shard.m_lru.begin()});
+  shard.m_usage += charge;
+  evict(shard, shard_capacity);
+}
+
+uint64_t Rdb_vector_value_cache::usage() const {
+  uint64_t usage = 0;
+  for (const auto &shard : m_shards) {
+    const std::lock_guard<std::mutex> lock(shard.m_mutex);
+    usage += shard.m_usage;
+  }
+  return usage;
+}
+
+void Rdb_vector_value_cache::evict(Shard &shard, uint64_t shard_capacity) {
+  while (shard.m_usage > shard_capacity && !shard.m_lru.empty()) {
+    auto iter = shard.m_entries.find(shard.m_lru.back());
+    assert(iter != shard.m_entries.end());
+    shard.m_usage -= iter->second.m_charge;
+    shard.m_entries.erase(iter);
+    shard.m_lru.pop_back();
+  }
+}
+
+Rdb_vector_value_cache &rdb_get_vector_value_cache() {
+  static Rdb_vector_value_cache cache;
+  return cache;
+}
+
+bool Rdb_vector_result_cache::lookup(const std::string &key,
+                                     uint64_t write_seq,
+                                     Rdb_vector_result &result) {
+  const std::lock_guard<std::mutex> lock(m_mutex);
+  auto iter = m_entries.find(key);
+  if (iter == m_entries.end() || iter->second.m_write_seq != write_seq) {
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  m_lru.splice(m_lru.begin(), m_lru, iter->second.m_lru_pos);
+  m_hits.fetch_add(1, std::memory_order_relaxed);
+  result.assign(iter->second.m_result.begin(), iter->second.m_result.end());
+  return true;
+}
+
+void Rdb_vector_result_cache::insert(const std::string &key,
+                                     uint64_t write_seq,
+                                     const Rdb_vector_result &result,
+                                     uint capacity) {
+  const std::lock_guard<std::mutex> lock(m_mutex);
+  auto iter = m_entries.find(key);
+  if (iter != m_entries.end()) {
+    // replace the entry invalidated by a write
+    m_lru.erase(iter->second.m_lru_pos);
+    m_entries.erase(iter);
   }
+  m_lru.push_front(key);
+  m_entries.emplace(
+      key, Entry{write_seq, Result(result.begin(), result.end()),
+                 m_lru.begin()});
+  while (m_entries.size() > capacity) {
+    m_entries.erase(m_lru.back());
+    m_lru.pop_back();
+  }
+}
 
-  // Pre-allocate the output vector
-  field_values->resize(field_indexs.size());
+void Rdb_vector_list_cache::set_capacity(uint64_t capacity) {
+  m_capacity.store(capacity, std::memory_order_relaxed);
+  const uint64_t shard_capacity = capacity / NUM_SHARDS;
+  for (auto &shard : m_shards) {
+    const std::lock_guard<std::mutex> lock(shard.m_mutex);
+    evict(shard, shard_capacity);
+  }
+}
 
-  // Create a mapping from field index to position in result vector
-  std::unordered_map<size_t, size_t> index_to_result_pos;
-  for (size_t i = 0; i < field_indexs.size(); i++) {
-    index_to_result_pos[field_indexs[i]] = i;
+Rdb_vector_list_cache::List_ptr Rdb_vector_list_cache::lookup(
+    Index_id index_id, uint64 list_id, rocksdb::SequenceNumber seq,
+    bool *admit) {
+  *admit = false;
+  const Key key{index_id, list_id};
+  Shard &shard = get_shard(key);
+  const std::lock_guard<std::mutex> lock(shard.m_mutex);
+  List_state &state = shard.m_states[key];
+  if (state.m_writers > 0 || state.m_commit_seq > seq) {
+    // the list may differ from the snapshot, reads go to rocksdb
+    return nullptr;
   }
+  if (state.m_list) {
+    if (state.m_commit_seq <= state.m_list_seq) {
+      shard.m_lru.splice(shard.m_lru.begin(), shard.m_lru, state.m_lru_pos);
+      return state.m_list;
+    }
+    // committed to after it was read
+    drop_list(shard, state);
+  }
+  if (++state.m_misses >= ADMIT_MISSES) {
+    state.m_misses = 0;
+    *admit = true;
+  }
+  return nullptr;
+}
 
-  // Parse through all fields up to max_field_index
-  for (size_t i = 0; i <= max_field_index; i++) {
-    const auto& field_info = field_info_list[i];
+void Rdb_vector_list_cache::insert(Index_id index_id, uint64 list_id,
+                                   rocksdb::SequenceNumber seq,
+                                   List_ptr list) {
+  const uint64_t shard_capacity =
+      m_capacity.load(std::memory_order_relaxed) / NUM_SHARDS;
+  // rough overhead of the map node, lru node and shared_ptr control block
+  const std::size_t charge = list->m_codes.size() + list->m_keys.size() +
+                             list->m_key_ends.size() * sizeof(uint32_t) + 128;
+  if (charge > shard_capacity) {
+    return;
+  }
 
-    // Check if current field is null
-    bool is_null = false;
-    if (field_info.is_nullable && null_bytes != nullptr) {
-      is_null = (null_bytes[i/8] & (1 << (i%8))) != 0;
+  const Key key{index_id, list_id};
+  Shard &shard = get_shard(key);
+  const std::lock_guard<std::mutex> lock(shard.m_mutex);
+  List_state &state = shard.m_states[key];
+  if (state.m_writers > 0 || state.m_commit_seq > seq) {
+    // written while it was read
+    return;
+  }
+  if (state.m_list) {
+    if (state.m_list_seq >= seq) {
+      // a reader of a later snapshot got there first
+      return;
     }
+    drop_list(shard, state);
+  }
+  shard.m_lru.push_front(key);
+  state.m_list = std::move(list);
+  state.m_list_seq = seq;
+  state.m_charge = charge;
+  state.m_lru_pos = shard.m_lru.begin();
+  shard.m_usage += charge;
+  evict(shard, shard_capacity);
+}
 
-    // Check if this field is in our target list
-    bool is_target_field = index_to_result_pos.find(i) != index_to_result_pos.end();
+void Rdb_vector_list_cache::begin_write(Index_id index_id, uint64 list_id) {
+  const Key key{index_id, list_id};
+  Shard &shard = get_shard(key);
+  const std::lock_guard<std::mutex> lock(shard.m_mutex);
+  List_state &state = shard.m_states[key];
+  state.m_writers++;
+  if (state.m_list) {
+    drop_list(shard, state);
+  }
+}
+
+void Rdb_vector_list_cache::end_write(Index_id index_id, uint64 list_id,
+                                      rocksdb::SequenceNumber commit_seq) {
+  const Key key{index_id, list_id};
+  Shard &shard = get_shard(key);
+  const std::lock_guard<std::mutex> lock(shard.m_mutex);
+  List_state &state = shard.m_states[key];
+  assert(state.m_writers > 0);
+  if (state.m_writers > 0 && --state.m_writers == 0) {
+    state.m_idle_count++;
+  }
+  state.m_commit_seq = std::max(state.m_commit_seq, commit_seq);
+}
 
-    if (is_null) {
-      // If this is a target field, add an empty slice to the result
-      if (is_target_field) {
-        (*field_values)[index_to_result_pos[i]] = rocksdb::Slice();
+std::vector<std::pair<uint64, uint64>> Rdb_vector_list_cache::writing_lists(
+    Index_id index_id) const {
+  std::vector<std::pair<uint64, uint64>> lists;
+  for (const auto &shard : m_shards) {
+    const std::lock_guard<std::mutex> lock(shard.m_mutex);
+    for (const auto &entry : shard.m_states) {
+      if (entry.first.first == index_id && entry.second.m_writers > 0) {
+        lists.emplace_back(entry.first.second, entry.second.m_idle_count);
       }
-      // Skip to next field (no data to skip for null fields)
-      continue;
     }
+  }
+  return lists;
+}
 
-    // Handle field data based on type
-    if (field_info.type == MYSQL_TYPE_VARCHAR) {
-      if (remaining < field_info.length_bytes) {
-        return HA_ERR_ROCKSDB_CORRUPT_DATA;
-      }
-      size_t len = (field_info.length_bytes == 1) ? 
-                  static_cast<uint8_t>(pos[0]) : *reinterpret_cast<const uint16_t*>(pos);
-      pos += field_info.length_bytes;
-      remaining -= field_info.length_bytes;
-      
-      if (remaining < len) {
-        return HA_ERR_ROCKSDB_CORRUPT_DATA;
-      }
-      
-      // If this is a target field, add it to the result
-      if (is_target_field) {
-        (*field_values)[index_to_result_pos[i]] = rocksdb::Slice(pos, len);
-      }
-      
-      // Move past this field's data
-      pos += len;
-      remaining -= len;
-    } else if (field_info.type == MYSQL_TYPE_BLOB || 
-               field_info.type == MYSQL_TYPE_JSON || 
-               field_info.type == MYSQL_TYPE_GEOMETRY) {
-      if (remaining < field_info.length_bytes) {
-        return HA_ERR_ROCKSDB_CORRUPT_DATA;
-      }
-      size_t len = 0;
-      memcpy(&len, pos, field_info.length_bytes);
-      pos += field_info.length_bytes;
-      remaining -= field_info.length_bytes;
-      
-      if (remaining < len) {
-        return HA_ERR_ROCKSDB_CORRUPT_DATA;
-      }
-      
-      // If this is a target field, add it to the result
-      if (is_target_field) {
-        (*field_values)[index_to_result_pos[i]] = rocksdb::Slice(pos, len);
-      }
-      
-      // Move past this field's data
-      pos += len;
-      remaining -= len;
-    } else {
-      // Fixed length field
-      if (remaining < field_info.pack_length) {
-        return HA_ERR_ROCKSDB_CORRUPT_DATA;
-      }
-      
-      // If this is a target field, add it to the result
-      if (is_target_field) {
-        (*field_values)[index_to_result_pos[i]] = rocksdb::Slice(pos, field_info.pack_length);
+bool Rdb_vector_list_cache::writers_ended(
+    Index_id index_id,
+    const std::vector<std::pair<uint64, uint64>> &lists) const {
+  for (const auto &list : lists) {
+    const Key key{index_id, list.first};
+    const Shard &shard = m_shards[Key_hash{}(key) % NUM_SHARDS];
+    const std::lock_guard<std::mutex> lock(shard.m_mutex);
+    const auto it = shard.m_states.find(key);
+    // the writers of then are gone once the list went idle after
+    if (it != shard.m_states.end() && it->second.m_writers > 0 &&
+        it->second.m_idle_count == list.second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Rdb_vector_list_cache::drop_index(Index_id index_id) {
+  for (auto &shard : m_shards) {
+    const std::lock_guard<std::mutex> lock(shard.m_mutex);
+    for (auto &entry : shard.m_states) {
+      if (entry.first.first == index_id && entry.second.m_list) {
+        drop_list(shard, entry.second);
       }
-      
-      // Move past this field's data
-      pos += field_info.pack_length;
-      remaining -= field_info.pack_length;
     }
   }
+}
+
+uint64_t Rdb_vector_list_cache::usage() const {
+  uint64_t usage = 0;
+  for (const auto &shard : m_shards) {
+    const std::lock_guard<std::mutex> lock(shard.m_mutex);
+    usage += shard.m_usage;
+  }
+  return usage;
+}
 
-  return HA_EXIT_SUCCESS;
+void Rdb_vector_list_cache::drop_list(Shard &shard, List_state &state) {
+  assert(state.m_list);
+  shard.m_usage -= state.m_charge;
+  shard.m_lru.erase(state.m_lru_pos);
+  state.m_list.reset();
+  state.m_charge = 0;
+}
+
+void Rdb_vector_list_cache::evict(Shard &shard, uint64_t shard_capacity) {
+  while (shard.m_usage > shard_capacity && !shard.m_lru.empty()) {
+    auto iter = shard.m_states.find(shard.m_lru.back());
+    assert(iter != shard.m_states.end());
+    drop_list(shard, iter->second);
+  }
+}
+
+Rdb_vector_list_cache &rdb_get_vector_list_cache() {
+  static Rdb_vector_list_cache cache;
+  return cache;
 }
 
+#ifdef WITH_FB_VECTORDB
+namespace {
 float l2_distance(const std::vector<float>& a, const std::vector<float>& b) {
     float sum = 0.0f;
     for (size_t i = 0; i < a.size(); ++i) {
@@ -219,28 +365,6 @@ float l2_distance(const std::vector<float>& a, const std::vector<float>& b) {
     return std::sqrt(sum);
 }
 
-double st_distance_simple(double lon1_deg, double lat1_deg,
-                                 double lon2_deg, double lat2_deg)
-{
-    constexpr double R = 6'371'008.8;          // mean Earth radius (m)
-
-    auto deg2rad = [](double d) { return d * M_PI / 180.0; };
-
-    double lat1 = deg2rad(lat1_deg);
-    double lat2 = deg2rad(lat2_deg);
-    double dlat = deg2rad(lat2_deg - lat1_deg);
-    double dlon = deg2rad(lon2_deg - lon1_deg);
-
-    double sin_dlat = std::sin(dlat * 0.5);
-    double sin_dlon = std::sin(dlon * 0.5);
-
-    double a = sin_dlat * sin_dlat +
-               std::cos(lat1) * std::cos(lat2) * sin_dlon * sin_dlon;
-
-    double c = 2.0 * std::atan2(std::sqrt(a), std::sqrt(1.0 - a));
-    return R * c;                             // metres (arc length)
-}
-
 template <typename T>
 int ExtractVectorFromJson(const std::string_view& json_binary, std::vector<T>* result) {
   assert(result != nullptr);
@@ -251,6 +375,19 @@ int ExtractVectorFromJson(const std::string_view& json_binary, std::vector<T>* r
     return HA_ERR_ROCKSDB_CORRUPT_DATA;
   }
 
+  // arrays of doubles, as vectors are usually stored, convert in bulk
+  if constexpr (std::is_same_v<T, float>) {
+    const auto value =
+        ::json_binary::parse_binary(json_binary.data(), json_binary.size());
+    if (value.type() == ::json_binary::Value::ARRAY) {
+      result->resize(value.element_count());
+      if (!value.get_float_array(result->data())) {
+        return HA_EXIT_SUCCESS;
+      }
+      result->clear();
+    }
+  }
+
   const uint8_t* data = reinterpret_cast<const uint8_t*>(json_binary.data());
   size_t length = json_binary.size();
 
@@ -520,6 +657,69 @@ int ExtractVectorFromJson(const std::string_view& json_binary, std::vector<T>* r
   return HA_EXIT_SUCCESS;
 }
 
+/**
+  decode the vector column of a scanned row. when the vector value cache is
+  enabled the decoded vector is shared with the cache and kept alive by
+  holder, otherwise it is decoded into buffer, which callers reuse across
+  rows. data points to dimension floats on success. with normalize the
+  vector is scaled to unit length in buffer; the cache only holds the raw
+  vector, so scans of either form share its entry. binary columns,
+  VECTOR(N) and blobs with
+  FB_VECTOR_DIMENSION, hold the floats themselves and are read in place.
+*/
+static uint decode_vector_field(const rocksdb::Slice &key,
+                                const rocksdb::Slice &field,
+                                const std::size_t dimension,
+                                const bool binary, const bool normalize,
+                                Rdb_vector_value_cache::Vector_ptr &holder,
+                                std::vector<float> &buffer,
+                                const float **data) {
+  if (binary) {
+    if (field.size() != dimension * sizeof(float)) {
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    if (!normalize) {
+      *data = reinterpret_cast<const float *>(field.data());
+      return HA_EXIT_SUCCESS;
+    }
+    buffer.resize(dimension);
+    memcpy(buffer.data(), field.data(), field.size());
+    fb_vector_normalize_l2(buffer.data(), buffer.size());
+    *data = buffer.data();
+    return HA_EXIT_SUCCESS;
+  }
+
+  const std::string_view json_binary(field.data(), field.size());
+  const std::vector<float> *vector = &buffer;
+  auto &cache = rdb_get_vector_value_cache();
+  if (cache.enabled()) {
+    const uint64_t value_hash = rocksdb::Hash64(field.data(), field.size(), 0);
+    holder = cache.lookup(key, value_hash);
+    if (!holder) {
+      auto decoded = std::make_shared<std::vector<float>>();
+      if (ExtractVectorFromJson<float>(json_binary, decoded.get())) {
+        return HA_ERR_ROCKSDB_CORRUPT_DATA;
+      }
+      holder = decoded;
+      cache.insert(key, value_hash, holder);
+    }
+    vector = holder.get();
+  } else if (ExtractVectorFromJson<float>(json_binary, &buffer)) {
+    return HA_ERR_ROCKSDB_CORRUPT_DATA;
+  }
+
+  if (vector->size() != dimension) {
+    return HA_ERR_ROCKSDB_CORRUPT_DATA;
+  }
+  if (normalize) {
+    if (vector != &buffer) buffer.assign(vector->begin(), vector->end());
+    fb_vector_normalize_l2(buffer.data(), buffer.size());
+    vector = &buffer;
+  }
+  *data = vector->data();
+  return HA_EXIT_SUCCESS;
+}
+
 // vector ids are generated in read time.
 // use this dummy value for apis require passing vector ids.
 constexpr faiss::idx_t DUMMY_VECTOR_ID = 42;
@@ -582,6 +782,77 @@ static uint read_inverted_list_key(Rdb_string_reader &reader,
   return HA_EXIT_SUCCESS;
 }
 
+/**
+  split the value of a vector index entry.
+  value format is:
+  [DATA TAG] [VECTOR CODES] [UNPACK INFO FOR CHARS/VARCHARS etc]
+  data written before the write path used Rdb_key_def::pack_record is
+  exactly code_size bytes of codes.
+  unpack_value, when given, gets the value minus the vector codes, which is
+  what Rdb_key_def::unpack_record expects.
+*/
+static uint split_vector_entry_value(const rocksdb::Slice &value,
+                                     const std::size_t code_size,
+                                     rocksdb::Slice *codes,
+                                     std::string *unpack_value) {
+  if (value.size() < code_size) {
+    return HA_ERR_ROCKSDB_CORRUPT_DATA;
+  }
+  const std::size_t extra_bytes = value.size() - code_size;
+  std::size_t header_size = 0;
+  if (extra_bytes > 0) {
+    const char tag = value.data()[0];
+    if (!Rdb_key_def::is_unpack_data_tag(tag)) {
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    header_size = Rdb_key_def::get_unpack_header_size(tag);
+    if (extra_bytes < header_size) {
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+  }
+  if (codes) {
+    *codes = rocksdb::Slice(value.data() + header_size, code_size);
+  }
+  if (unpack_value) {
+    unpack_value->assign(value.data(), header_size);
+    unpack_value->append(value.data() + header_size + code_size,
+                         extra_bytes - header_size);
+  }
+  return HA_EXIT_SUCCESS;
+}
+
+/**
+  split the value of an entry of a multi-vector index like
+  split_vector_entry_value, its codes are the number of vectors of the row
+  in the list followed by their codes. pack_record always writes the unpack
+  data tag ahead of them. codes gets the codes of the vectors.
+*/
+static uint split_multi_vector_entry_value(const rocksdb::Slice &value,
+                                           const std::size_t code_size,
+                                           rocksdb::Slice *codes,
+                                           std::string *unpack_value) {
+  if (value.empty() || !Rdb_key_def::is_unpack_data_tag(value.data()[0])) {
+    return HA_ERR_ROCKSDB_CORRUPT_DATA;
+  }
+  const std::size_t header_size =
+      Rdb_key_def::get_unpack_header_size(value.data()[0]);
+  if (value.size() < header_size + RDB_MULTI_VECTOR_COUNT_SIZE) {
+    return HA_ERR_ROCKSDB_CORRUPT_DATA;
+  }
+  const std::size_t count = rdb_netbuf_to_uint32(
+      reinterpret_cast<const uchar *>(value.data() + header_size));
+  const uint rtn = split_vector_entry_value(
+      value, RDB_MULTI_VECTOR_COUNT_SIZE + count * code_size, codes,
+      unpack_value);
+  if (rtn) {
+    return rtn;
+  }
+  if (codes) {
+    codes->remove_prefix(RDB_MULTI_VECTOR_COUNT_SIZE);
+  }
+  return HA_EXIT_SUCCESS;
+}
+
 /**
   context passed to inverted list.
   no need to synchronize here, as we set openmp threads to 1.
@@ -599,10 +870,44 @@ class Rdb_faiss_inverted_list_context {
   const TABLE *const m_tbl;
   Item *m_pk_index_cond;
   const Rdb_key_def *m_sk_descr;
+  // lists are read from the entries of this pk prefix only, see
+  // Rdb_vector_search_params::m_pk_prefix
+  std::string m_pk_prefix;
+  // entries hold the vectors of a row of a multi-vector index in the list
+  bool m_multi = false;
   uint m_error = HA_EXIT_SUCCESS;
   std::size_t m_current_list_size = 0;
   // list id to list size pairs
   std::vector<std::pair<std::size_t, std::size_t>> m_list_size_stats;
+  std::size_t m_lists_scanned = 0;
+  std::size_t m_vectors_scanned = 0;
+  // report scanned lists as the work completed of the current stage
+  bool m_report_progress = false;
+  // snapshot whole lists are read at, served from and read into the list
+  // cache at, 0 when the cache is not used
+  rocksdb::SequenceNumber m_list_cache_seq = 0;
+  Rdb_vector_index *m_list_cache_index = nullptr;
+
+  /**
+    serve the lists of index from the list cache where possible. lists read
+    by a pk condition or a pk prefix, entries of multi-vector rows and lists
+    merged with the writes of the transaction are never cached.
+  */
+  void use_list_cache(Rdb_vector_index *index) {
+    if (!rdb_get_vector_list_cache().enabled() || m_thd == nullptr ||
+        m_sk_descr == nullptr || m_pk_index_cond != nullptr ||
+        !m_pk_prefix.empty() || m_multi ||
+        rdb_tx_has_index_writes(m_thd, *m_sk_descr)) {
+      return;
+    }
+    const rocksdb::Snapshot *snapshot =
+        rdb_tx_acquire_snapshot(get_tx_from_thd(m_thd)).snapshot;
+    if (snapshot == nullptr) {
+      return;
+    }
+    m_list_cache_seq = snapshot->GetSequenceNumber();
+    m_list_cache_index = index;
+  }
 
   void on_iterator_end(std::size_t list_id) {
     if (!m_error) {
@@ -610,9 +915,17 @@ class Rdb_faiss_inverted_list_context {
       m_list_size_stats.push_back({list_id, m_current_list_size});
     }
     m_current_list_size = 0;
+    m_lists_scanned++;
+    if (m_report_progress) {
+      mysql_stage_set_work_completed(m_thd->m_stage_progress_psi,
+                                     m_lists_scanned);
+    }
   }
 
-  void on_iterator_record() { m_current_list_size++; }
+  void on_iterator_record() {
+    m_current_list_size++;
+    m_vectors_scanned++;
+  }
 
   faiss::idx_t add_key(const std::string &key) {
     auto vector_id = m_vector_id++;
@@ -622,7 +935,7 @@ class Rdb_faiss_inverted_list_context {
 
   uint populate_result(std::vector<faiss::idx_t> &vector_ids,
                        std::vector<float> &distances,
-                       std::vector<std::pair<std::string, float>> &result) {
+                       Rdb_vector_result &result) {
     for (uint i = 0; i < vector_ids.size(); i++) {
       auto vector_id = vector_ids[i];
       if (vector_id < 0) {
@@ -671,13 +984,38 @@ class Rdb_vector_iterator : public faiss::InvertedListsIterator {
         m_index_id(index_id),
         m_list_id(list_id),
         m_code_size(code_size) {
+    if (context->m_list_cache_seq != 0) {
+      bool admit;
+      m_cached_list = rdb_get_vector_list_cache().lookup(
+          index_id, list_id, context->m_list_cache_seq, &admit);
+      context->m_list_cache_index->note_list_cache_lookup(
+          m_cached_list != nullptr);
+      if (m_cached_list) {
+        return;
+      }
+      if (admit) {
+        m_filled_list = std::make_shared<Rdb_vector_cached_list>();
+      }
+    }
     Rdb_string_writer lower_key_writer;
     write_inverted_list_key(lower_key_writer, index_id, list_id);
-    m_iterator_lower_bound_key.PinSelf(lower_key_writer.to_slice());
+    if (context->m_pk_prefix.empty()) {
+      m_iterator_lower_bound_key.PinSelf(lower_key_writer.to_slice());
 
-    Rdb_string_writer upper_key_writer;
-    write_inverted_list_key(upper_key_writer, index_id, list_id + 1);
-    m_iterator_upper_bound_key.PinSelf(upper_key_writer.to_slice());
+      Rdb_string_writer upper_key_writer;
+      write_inverted_list_key(upper_key_writer, index_id, list_id + 1);
+      m_iterator_upper_bound_key.PinSelf(upper_key_writer.to_slice());
+    } else {
+      // the entries of a list are sorted by pk, those of the prefix are
+      // one range of it
+      lower_key_writer.write_slice(context->m_pk_prefix);
+      m_iterator_lower_bound_key.PinSelf(lower_key_writer.to_slice());
+
+      std::string upper_key = lower_key_writer.to_slice().ToString();
+      Rdb_key_def::successor(reinterpret_cast<uchar *>(upper_key.data()),
+                             upper_key.size());
+      m_iterator_upper_bound_key.PinSelf(upper_key);
+    }
     m_iterator = rdb_tx_get_iterator(
         context->m_thd, cf, /* skip_bloom_filter */ true,
         m_iterator_lower_bound_key, m_iterator_upper_bound_key,
@@ -685,10 +1023,27 @@ class Rdb_vector_iterator : public faiss::InvertedListsIterator {
     m_iterator->SeekToFirst();
   }
 
-  void next() override { m_iterator->Next(); }
+  void next() override {
+    if (m_cached_list) {
+      m_cached_pos++;
+    } else {
+      m_iterator->Next();
+    }
+  }
 
   bool is_available() const override {
     THD *thd = m_context->m_thd;
+    if (m_cached_list) {
+      if (thd && thd->killed) {
+        m_context->m_error = HA_ERR_QUERY_INTERRUPTED;
+      }
+      const bool available =
+          !m_context->m_error && m_cached_pos < m_cached_list->size();
+      if (!available) {
+        m_context->on_iterator_end(m_list_id);
+      }
+      return available;
+    }
     std::string sk;
     std::string sk_value;
     rocksdb::Slice key_slice;
@@ -745,6 +1100,13 @@ class Rdb_vector_iterator : public faiss::InvertedListsIterator {
     bool available = !m_context->m_error && m_iterator->Valid();
 
     if (!available) {
+      if (m_filled_list && !m_context->m_error) {
+        // read to the end, keep it for the next searches
+        rdb_get_vector_list_cache().insert(m_index_id, m_list_id,
+                                           m_context->m_list_cache_seq,
+                                           std::move(m_filled_list));
+      }
+      m_filled_list.reset();
       m_context->on_iterator_end(m_list_id);
     }
     return available;
@@ -752,6 +1114,8 @@ class Rdb_vector_iterator : public faiss::InvertedListsIterator {
 
   uint get_key_and_value(std::string &key, std::string &value,
                          bool need_value = true) const {
+    // the lists of pk conditions and index scans are not cached
+    assert(!m_cached_list);
     assert(m_context->m_error == false);
     assert(m_iterator->Valid());
 
@@ -778,59 +1142,35 @@ class Rdb_vector_iterator : public faiss::InvertedListsIterator {
     }
 
     /*
-      Vector index Value format:
-      [DATA TAG] [VECTOR CODES] [UNPACK INFO FOR CHARS/VARCHARS etc]
-
       To unpack CHARs and VARCHARs, we need to have a complete VALUE
       corresponding to the KEY above. This is needed to be able to
       evaluate PK query conditions on CHAR/VARCHAR PK key parts.
 
       The vector codes are not expected in VALUE during the unpacking,
-      and the following code recreates VALUE minus the vector codes.
-
+      so VALUE is recreated minus the vector codes.
      */
-    rocksdb::Slice value_slice = m_iterator->value();
-    unsigned long int value_bytes = value_slice.size() - m_code_size;
-    if (value_bytes < 0) {
+    const rocksdb::Slice value_slice = m_iterator->value();
+    if (split_value(value_slice, nullptr, &value)) {
       LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
                       "Invalid value size %lu for key in index %d, list id %lu",
                       value_slice.size(), m_index_id, m_list_id);
       return HA_ERR_ROCKSDB_CORRUPT_DATA;
     }
-    if (value_bytes > 0) {
-      char tag = value_slice.data()[0];
-      if (!Rdb_key_def::is_unpack_data_tag(tag)) {
-        LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
-                        "Invalid data tag for key in index %d, list id %lu",
-                        m_index_id, m_list_id);
-        return HA_ERR_ROCKSDB_CORRUPT_DATA;
-      }
-      auto header_size = Rdb_key_def::get_unpack_header_size(tag);
-      if ((size_t)value_bytes < header_size) {
-        LogPluginErrMsg(
-            ERROR_LEVEL, ER_LOG_PRINTF_MSG,
-            "Invalid value size %lu for key in index %d, list id %lu",
-            value_slice.size(), m_index_id, m_list_id);
-        return HA_ERR_ROCKSDB_CORRUPT_DATA;
-      }
-
-      value.reserve(value_bytes);
-
-      for (uint i = 0; i < header_size; i++) {
-        value += value_slice.data()[i];
-      }
-
-      for (uint i = header_size; i < value_bytes; i++) {
-        value += value_slice.data()[i + m_code_size];
-      }
-    }
-    assert(value.size() == value_bytes);
 
     return HA_EXIT_SUCCESS;
   }
 
   uint get_key_and_codes(std::string &key, rocksdb::Slice &codes) const {
     assert(m_context->m_error == false);
+    if (m_cached_list) {
+      assert(m_cached_pos < m_cached_list->size());
+      key = m_cached_list->key(m_cached_pos).ToString();
+      codes = rocksdb::Slice(
+          m_cached_list->m_codes.data() + m_cached_pos * m_code_size,
+          m_code_size);
+      m_context->on_iterator_record();
+      return HA_EXIT_SUCCESS;
+    }
     assert(m_iterator->Valid());
 
     rocksdb::Slice key_slice = m_iterator->key();
@@ -851,41 +1191,29 @@ class Rdb_vector_iterator : public faiss::InvertedListsIterator {
     // copy the key bytes
     key = key_slice.ToString();
 
-    rocksdb::Slice value = m_iterator->value();
-    codes = value;
     // after consolidating write logic to use Rdb_key_def::pack_record,
     // the vector codes is prefixed with data tag, and followed by
     // other column data.
-    // for data written before the change, the value is exactly m_code_size.
-    int extra_bytes = codes.size() - m_code_size;
-    if (extra_bytes < 0) {
+    const rocksdb::Slice value = m_iterator->value();
+    if (split_value(value, &codes, nullptr)) {
       LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
                       "Invalid value size %lu for key in index %d, list id %lu",
-                      codes.size(), m_index_id, m_list_id);
+                      value.size(), m_index_id, m_list_id);
       return HA_ERR_ROCKSDB_CORRUPT_DATA;
     }
-    if (extra_bytes > 0) {
-      char tag = codes.data()[0];
-      if (!Rdb_key_def::is_unpack_data_tag(tag)) {
-        LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
-                        "Invalid data tag for key in index %d, list id %lu",
-                        m_index_id, m_list_id);
-        return HA_ERR_ROCKSDB_CORRUPT_DATA;
-      }
-      auto header_size = Rdb_key_def::get_unpack_header_size(tag);
-      if ((size_t)extra_bytes < header_size) {
-        LogPluginErrMsg(
-            ERROR_LEVEL, ER_LOG_PRINTF_MSG,
-            "Invalid value size %lu for key in index %d, list id %lu",
-            codes.size(), m_index_id, m_list_id);
-        return HA_ERR_ROCKSDB_CORRUPT_DATA;
-      }
 
-      codes.remove_prefix(header_size);
-      codes.remove_suffix(extra_bytes - header_size);
+    if (m_filled_list) {
+      if (codes.size() != m_code_size ||
+          m_filled_list->m_codes.size() + m_filled_list->m_keys.size() +
+                  codes.size() + key.size() >
+              rdb_get_vector_list_cache().max_charge()) {
+        m_filled_list.reset();
+      } else {
+        m_filled_list->m_codes.append(codes.data(), codes.size());
+        m_filled_list->m_keys.append(key);
+        m_filled_list->m_key_ends.push_back(m_filled_list->m_keys.size());
+      }
     }
-    assert(codes.size() == m_code_size);
-
     m_context->on_iterator_record();
     return HA_EXIT_SUCCESS;
   }
@@ -908,6 +1236,15 @@ class Rdb_vector_iterator : public faiss::InvertedListsIterator {
   }
 
  private:
+  uint split_value(const rocksdb::Slice &value, rocksdb::Slice *codes,
+                   std::string *unpack_value) const {
+    return m_context->m_multi
+               ? split_multi_vector_entry_value(value, m_code_size, codes,
+                                                unpack_value)
+               : split_vector_entry_value(value, m_code_size, codes,
+                                          unpack_value);
+  }
+
   Rdb_faiss_inverted_list_context *m_context;
   Index_id m_index_id;
   size_t m_list_id;
@@ -916,6 +1253,11 @@ class Rdb_vector_iterator : public faiss::InvertedListsIterator {
   rocksdb::PinnableSlice m_iterator_lower_bound_key;
   rocksdb::PinnableSlice m_iterator_upper_bound_key;
   std::vector<uint8_t> m_codes_buffer;
+  // the list served from the list cache, m_iterator is not used then
+  Rdb_vector_list_cache::List_ptr m_cached_list;
+  std::size_t m_cached_pos = 0;
+  // the list read into the list cache while it is scanned
+  mutable std::shared_ptr<Rdb_vector_cached_list> m_filled_list;
 };
 
 class Rdb_vector_list_iterator : public Rdb_vector_db_iterator {
@@ -980,8 +1322,11 @@ class Rdb_vector_list_iterator : public Rdb_vector_db_iterator {
 class Rdb_faiss_inverted_list : public faiss::InvertedLists {
  public:
   Rdb_faiss_inverted_list(Index_id index_id, rocksdb::ColumnFamilyHandle &cf,
-                          uint nlist, uint code_size)
-      : InvertedLists(nlist, code_size), m_index_id(index_id), m_cf(cf) {
+                          uint nlist, uint code_size, uint64 list_id_base = 0)
+      : InvertedLists(nlist, code_size),
+        m_index_id(index_id),
+        m_cf(cf),
+        m_list_id_base(list_id_base) {
     use_iterator = true;
   }
   ~Rdb_faiss_inverted_list() override = default;
@@ -1003,7 +1348,7 @@ class Rdb_faiss_inverted_list : public faiss::InvertedLists {
     return new Rdb_vector_iterator(
         reinterpret_cast<Rdb_faiss_inverted_list_context *>(
             inverted_list_context),
-        m_index_id, m_cf, code_size, list_no);
+        m_index_id, m_cf, code_size, m_list_id_base + list_no);
   }
 
   const uint8_t *get_codes(size_t list_no) const override {
@@ -1050,6 +1395,8 @@ class Rdb_faiss_inverted_list : public faiss::InvertedLists {
  private:
   Index_id m_index_id;
   rocksdb::ColumnFamilyHandle &m_cf;
+  // list id of list 0 in the keys, see IVF_GENERATION_SHIFT
+  uint64 m_list_id_base;
 };
 
 class Rdb_vector_lsm_iterator {
@@ -1076,6 +1423,20 @@ class Rdb_vector_lsm_iterator {
     return m_iterator->value();
   }
 
+  /**
+    true when key() and value() stay valid until the iterator is destroyed
+  */
+  bool is_pinned() const {
+    std::string prop;
+    if (!m_iterator->GetProperty("rocksdb.iterator.is-key-pinned", &prop).ok() ||
+        prop != "1") {
+      return false;
+    }
+    return m_iterator->GetProperty("rocksdb.iterator.is-value-pinned", &prop)
+               .ok() &&
+           prop == "1";
+  }
+
   std::string return_key_str() {return m_iterator->key().ToString();}
 
   std::string return_val_str() {return m_iterator->value().ToString();}
@@ -1090,75 +1451,450 @@ class Rdb_vector_lsm_iterator {
   rocksdb::PinnableSlice m_iterator_upper_bound_key;
 };
 
-class Rdb_vector_index_lsm : public Rdb_vector_index {
+/**
+  small pool of threads shared by all parallel lsm vector scans. workers are
+  started lazily and never exceed the number of cores.
+*/
+class Rdb_vector_worker_pool {
  public:
-  Rdb_vector_index_lsm(const FB_vector_index_config index_def,
-                       std::shared_ptr<rocksdb::ColumnFamilyHandle> cf_handle,
-                       const Index_id index_id)
-      : m_index_id{index_id},
-        m_index_def{index_def},
-        m_cf_handle{cf_handle} {}
+  Rdb_vector_worker_pool() = default;
+  Rdb_vector_worker_pool(const Rdb_vector_worker_pool &) = delete;
+  Rdb_vector_worker_pool &operator=(const Rdb_vector_worker_pool &) = delete;
+
+  ~Rdb_vector_worker_pool() {
+    {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto &worker : m_workers) {
+      worker.join();
+    }
+  }
 
-  ~Rdb_vector_index_lsm() override = default;
+  /**
+    run fn(0) ... fn(n - 1) and wait for all of them. fn(0) runs on the
+    calling thread.
+  */
+  void run(uint n, const std::function<void(uint)> &fn) {
+    if (n == 0) return;
+
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    uint pending = n - 1;
+    if (pending > 0) {
+      std::lock_guard<std::mutex> guard(m_mutex);
+      grow(pending);
+      for (uint i = 1; i < n; i++) {
+        m_tasks.emplace_back([&, i] {
+          fn(i);
+          std::lock_guard<std::mutex> done_guard(done_mutex);
+          if (--pending == 0) done_cv.notify_one();
+        });
+      }
+    }
+    m_cv.notify_all();
 
-  void assign_vector(const float *data,
-                     Rdb_vector_index_assignment &assignment) override {
-    assignment.m_list_id = 0;
-    assignment.m_codes.assign(
-        reinterpret_cast<const char *>(data),
-        dimension() * sizeof(float));
+    fn(0);
+
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done_cv.wait(lock, [&pending] { return pending == 0; });
   }
 
-  uint knn_search(
-      THD *thd, const TABLE *const tbl, Item *pk_index_cond,
-      const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
-      Rdb_vector_search_params &params,
-      std::vector<std::pair<std::string, float>> &result) override {
-    return HA_ERR_UNSUPPORTED;
+  static uint max_workers() {
+    return std::max(1U, std::thread::hardware_concurrency());
   }
 
-  uint knn_search_with_value(
-      THD *thd, const TABLE *const tbl, Item *pk_index_cond,
-      const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
-      Rdb_vector_search_params &params,
-      std::vector<std::pair<std::string, std::pair<float, std::string>>>
-          &result) override;
+ private:
+  // caller holds m_mutex
+  void grow(uint n) {
+    const uint target = std::min(n, max_workers());
+    while (m_workers.size() < target) {
+      m_workers.emplace_back([this] { work(); });
+    }
+  }
 
-  uint knn_search_hybrid_with_value(
-      THD *thd, const TABLE *const tbl, Item *pk_index_cond,
-      const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
-      Rdb_vector_search_params &params,
-      std::vector<std::pair<std::string, std::pair<float, std::string>>>
-          &result) override;
+  void work() {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+        if (m_tasks.empty()) return;
+        task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+      }
+      task();
+    }
+  }
 
-  uint index_scan(
-      THD *thd, const TABLE *const tbl, Item *pk_index_cond,
-      const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
-      uint nprobe,
-      std::unique_ptr<Rdb_vector_db_iterator> &index_scan_result_iter)
-      override {
-        return HA_ERR_UNSUPPORTED;
-      };
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::deque<std::function<void()>> m_tasks;
+  std::vector<std::thread> m_workers;
+  bool m_stop = false;
+};
 
-  uint index_scan_with_value(
-      THD *thd, const TABLE *const tbl, Item *pk_index_cond,
-      const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
-      uint nprobe,
-      std::vector<std::pair<std::string, std::pair<float, std::string>>>
-          &result)
-      override;
+Rdb_vector_worker_pool &rdb_get_vector_worker_pool() {
+  static Rdb_vector_worker_pool pool;
+  return pool;
+}
 
-  uint analyze(THD *thd, uint64_t max_num_rows_scanned,
-               std::atomic<THD::killed_state> *killed) override {
-    return HA_EXIT_SUCCESS;
+/**
+  keeps the k rows with the smallest score seen so far. a candidate only
+  references the row while the iterator pins it, otherwise key and value
+  are copied into one buffer when the row enters the heap. rows are turned
+  into strings for the final k only.
+*/
+class Rdb_vector_top_k {
+ public:
+  explicit Rdb_vector_top_k(uint k) : m_k(k) {}
+
+  bool accepts(float score) const {
+    return m_heap.size() < m_k || score < m_heap.front().m_score;
   }
 
-  Rdb_vector_index_info dump_info() override {
-    return {.m_ntotal = m_ntotal, .m_hit = m_hit};
+  bool full() const { return m_heap.size() == m_k; }
+
+  /**
+    largest score kept, only meaningful once full
+  */
+  float worst() const { return m_heap.front().m_score; }
+
+  void push(float score, const rocksdb::Slice &key,
+            const rocksdb::Slice &value, bool pinned) {
+    if (!accepts(score)) return;
+    if (m_heap.size() == m_k) {
+      std::pop_heap(m_heap.begin(), m_heap.end(), less);
+      m_heap.pop_back();
+    }
+    m_heap.emplace_back();
+    auto &candidate = m_heap.back();
+    candidate.m_score = score;
+    candidate.m_key_size = key.size();
+    candidate.m_value_size = value.size();
+    if (pinned) {
+      candidate.m_key = key.data();
+      candidate.m_value = value.data();
+    } else {
+      candidate.m_row.reserve(key.size() + value.size());
+      candidate.m_row.append(key.data(), key.size());
+      candidate.m_row.append(value.data(), value.size());
+    }
+    std::push_heap(m_heap.begin(), m_heap.end(), less);
   }
 
-  FB_vector_dimension dimension() const override {
-    return m_index_def.dimension();
+  void merge(Rdb_vector_top_k &other) {
+    for (auto &candidate : other.m_heap) {
+      if (!accepts(candidate.m_score)) continue;
+      if (m_heap.size() == m_k) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), less);
+        m_heap.pop_back();
+      }
+      m_heap.push_back(std::move(candidate));
+      std::push_heap(m_heap.begin(), m_heap.end(), less);
+    }
+    other.m_heap.clear();
+  }
+
+  /**
+    materialize the rows into result, sorted by ascending score
+  */
+  void to_result(Rdb_vector_result_with_value &result) {
+    std::sort_heap(m_heap.begin(), m_heap.end(), less);
+    result.reserve(result.size() + m_heap.size());
+    for (const auto &candidate : m_heap) {
+      result.emplace_back(candidate.key().ToString(),
+                          std::make_pair(candidate.m_score,
+                                         candidate.value().ToString()));
+    }
+    m_heap.clear();
+  }
+
+ private:
+  struct Candidate {
+    float m_score = 0;
+    // point into iterator pinned memory when m_row is empty
+    const char *m_key = nullptr;
+    const char *m_value = nullptr;
+    std::size_t m_key_size = 0;
+    std::size_t m_value_size = 0;
+    // key followed by value for unpinned rows
+    std::string m_row;
+
+    rocksdb::Slice key() const {
+      return m_row.empty() ? rocksdb::Slice(m_key, m_key_size)
+                           : rocksdb::Slice(m_row.data(), m_key_size);
+    }
+    rocksdb::Slice value() const {
+      return m_row.empty()
+                 ? rocksdb::Slice(m_value, m_value_size)
+                 : rocksdb::Slice(m_row.data() + m_key_size, m_value_size);
+    }
+  };
+
+  static bool less(const Candidate &a, const Candidate &b) {
+    return a.m_score < b.m_score;
+  }
+
+  uint m_k;
+  std::vector<Candidate> m_heap;
+};
+
+/**
+  per thread state reused across the rows scored by one worker
+*/
+struct Rdb_vector_scan_scratch {
+  std::vector<rocksdb::Slice> m_fields;
+  std::vector<float> m_vector_buffer;
+  Rdb_vector_value_cache::Vector_ptr m_cached_vector;
+};
+
+using Rdb_vector_scorer =
+    std::function<uint(const rocksdb::Slice &key, const rocksdb::Slice &value,
+                       Rdb_vector_scan_scratch &scratch, float *score)>;
+// spatial term of a hybrid score, also returns the point of the row
+using Rdb_hybrid_spatial_scorer = std::function<uint(
+    const rocksdb::Slice &value, Rdb_vector_scan_scratch &scratch, double *lon,
+    double *lat, float *score)>;
+// vector term of a hybrid score, after the spatial scorer of the same row
+using Rdb_hybrid_vector_scorer =
+    std::function<uint(const rocksdb::Slice &key, const rocksdb::Slice &value,
+                       Rdb_vector_scan_scratch &scratch, float *score)>;
+
+// rows handed to each worker per batch
+constexpr uint RDB_VECTOR_SCAN_ROWS_PER_WORKER = 256;
+// candidates asked from the lsm iterator per result row when rows are
+// filtered, so rows dropped by the filter do not leave the top k short
+constexpr uint RDB_VECTOR_FILTERED_FETCH_FACTOR = 4;
+
+/**
+  number of candidates the lsm iterator should return for k results
+*/
+uint rdb_vector_fetch_count(const uint k,
+                            const Rdb_vector_search_params &params) {
+  return params.m_row_filter ? k * RDB_VECTOR_FILTERED_FETCH_FACTOR : k;
+}
+
+// radius in metres of the first box a hybrid search reads around the query
+constexpr double RDB_HYBRID_INITIAL_RADIUS = 1000;
+// growth of the box radius while a hybrid search has fewer than k rows
+constexpr double RDB_HYBRID_RADIUS_GROWTH = 4;
+/**
+  score of a scanned row for the search metric, smaller is closer.
+  similarities are negated so every metric shares the same top k, see
+  rdb_vector_restore_distances. with normalized vectors cosine is a plain
+  inner product.
+*/
+float rdb_vector_row_score(const FB_VECTOR_INDEX_METRIC metric,
+                           const bool normalized, const float *query,
+                           const float *vector, const std::size_t dimension) {
+  switch (metric) {
+    case FB_VECTOR_INDEX_METRIC::IP:
+      return -fb_vector_inner_product(query, vector, dimension);
+    case FB_VECTOR_INDEX_METRIC::COSINE:
+      return normalized ? -fb_vector_inner_product(query, vector, dimension)
+                        : -fb_vector_cosine(query, vector, dimension);
+    default:
+      return fb_vector_l2sqr(query, vector, dimension);
+  }
+}
+
+void rdb_vector_restore_distances(const FB_VECTOR_INDEX_METRIC metric,
+                                  Rdb_vector_result_with_value &result) {
+  if (metric != FB_VECTOR_INDEX_METRIC::IP &&
+      metric != FB_VECTOR_INDEX_METRIC::COSINE) {
+    return;
+  }
+  for (auto &row : result) {
+    row.second.first = -row.second.first;
+  }
+}
+
+/**
+  drain the iterator and keep the k rows with the smallest score. with more
+  than one thread, rows are read in batches by the calling thread (the
+  rocksdb iterator is not thread safe), each batch is split evenly across
+  the workers, every worker keeps its own top k and the heaps are merged at
+  the end. a batch references pinned rows in place and copies the others
+  into one arena that is reused across batches. rows failing the filter are
+  dropped by the calling thread before they are scored, the filter may
+  evaluate items that are not safe to share across threads.
+*/
+uint rdb_vector_scan_top_k(Rdb_vector_lsm_iterator &iter, uint k,
+                           uint threads, const Rdb_vector_scorer &scorer,
+                           const Rdb_vector_row_filter &filter,
+                           Rdb_vector_result_with_value &result) {
+  if (k == 0) return HA_EXIT_SUCCESS;
+  const auto filtered_out = [&](const rocksdb::Slice &key,
+                                const rocksdb::Slice &value, uint *rtn) {
+    bool match = true;
+    *rtn = filter ? filter(key, value, &match) : HA_EXIT_SUCCESS;
+    return *rtn || !match;
+  };
+  threads = std::max(1U, std::min(threads, Rdb_vector_worker_pool::max_workers()));
+
+  if (threads == 1) {
+    Rdb_vector_top_k top_k(k);
+    Rdb_vector_scan_scratch scratch;
+    for (iter.seek_to_first(); iter.is_available(); iter.next()) {
+      const rocksdb::Slice value = iter.value();
+      if (value.empty()) continue;
+      float score = 0;
+      const rocksdb::Slice key = iter.key();
+      uint rtn = HA_EXIT_SUCCESS;
+      if (filtered_out(key, value, &rtn)) {
+        if (rtn) return rtn;
+        continue;
+      }
+      rtn = scorer(key, value, scratch, &score);
+      if (rtn) return rtn;
+      if (top_k.accepts(score)) {
+        top_k.push(score, key, value, iter.is_pinned());
+      }
+    }
+    top_k.to_result(result);
+    return HA_EXIT_SUCCESS;
+  }
+
+  struct Batch_row {
+    bool m_pinned;
+    // pointers for pinned rows, arena offsets otherwise
+    const char *m_key;
+    const char *m_value;
+    std::size_t m_key_offset;
+    std::size_t m_key_size;
+    std::size_t m_value_size;
+  };
+  std::vector<Rdb_vector_top_k> heaps(threads, Rdb_vector_top_k(k));
+  std::vector<Rdb_vector_scan_scratch> scratches(threads);
+  std::vector<uint> errors(threads, HA_EXIT_SUCCESS);
+  std::vector<Batch_row> batch;
+  std::string arena;
+  const std::size_t batch_size = threads * RDB_VECTOR_SCAN_ROWS_PER_WORKER;
+  batch.reserve(batch_size);
+
+  const auto score_partition = [&](uint worker) {
+    const std::size_t begin = batch.size() * worker / threads;
+    const std::size_t end = batch.size() * (worker + 1) / threads;
+    for (std::size_t i = begin; i < end && !errors[worker]; i++) {
+      const auto &row = batch[i];
+      const char *key_data =
+          row.m_pinned ? row.m_key : arena.data() + row.m_key_offset;
+      const char *value_data =
+          row.m_pinned ? row.m_value : key_data + row.m_key_size;
+      const rocksdb::Slice key(key_data, row.m_key_size);
+      const rocksdb::Slice value(value_data, row.m_value_size);
+      float score = 0;
+      errors[worker] = scorer(key, value, scratches[worker], &score);
+      if (!errors[worker]) {
+        heaps[worker].push(score, key, value, row.m_pinned);
+      }
+    }
+  };
+
+  iter.seek_to_first();
+  while (iter.is_available()) {
+    batch.clear();
+    arena.clear();
+    for (; iter.is_available() && batch.size() < batch_size; iter.next()) {
+      const rocksdb::Slice value = iter.value();
+      if (value.empty()) continue;
+      const rocksdb::Slice key = iter.key();
+      uint rtn = HA_EXIT_SUCCESS;
+      if (filtered_out(key, value, &rtn)) {
+        if (rtn) return rtn;
+        continue;
+      }
+      Batch_row row{.m_pinned = iter.is_pinned(),
+                    .m_key = key.data(),
+                    .m_value = value.data(),
+                    .m_key_offset = arena.size(),
+                    .m_key_size = key.size(),
+                    .m_value_size = value.size()};
+      if (!row.m_pinned) {
+        arena.append(key.data(), key.size());
+        arena.append(value.data(), value.size());
+      }
+      batch.push_back(row);
+    }
+    rdb_get_vector_worker_pool().run(threads, score_partition);
+    for (const uint rtn : errors) {
+      if (rtn) return rtn;
+    }
+  }
+
+  for (uint i = 1; i < threads; i++) {
+    heaps[0].merge(heaps[i]);
+  }
+  heaps[0].to_result(result);
+  return HA_EXIT_SUCCESS;
+}
+
+class Rdb_vector_index_lsm : public Rdb_vector_index {
+ public:
+  Rdb_vector_index_lsm(const FB_vector_index_config index_def,
+                       std::shared_ptr<rocksdb::ColumnFamilyHandle> cf_handle,
+                       const Index_id index_id)
+      : m_index_id{index_id},
+        m_index_def{index_def},
+        m_cf_handle{cf_handle} {}
+
+  ~Rdb_vector_index_lsm() override = default;
+
+  void assign_vector(const float *data,
+                     Rdb_vector_index_assignment &assignment) override {
+    assignment.m_list_id = 0;
+    assignment.m_codes.assign(
+        reinterpret_cast<const char *>(data),
+        dimension() * sizeof(float));
+  }
+
+  uint knn_search(
+      THD *thd, const TABLE *const tbl, Item *pk_index_cond,
+      const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
+      Rdb_vector_search_params &params, Rdb_vector_result &result) override {
+    return HA_ERR_UNSUPPORTED;
+  }
+
+  uint knn_search_with_value(
+      THD *thd, const TABLE *const tbl, Item *pk_index_cond,
+      const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
+      Rdb_vector_search_params &params,
+      Rdb_vector_result_with_value &result) override;
+
+  uint knn_search_hybrid_with_value(
+      THD *thd, const TABLE *const tbl, Item *pk_index_cond,
+      const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
+      Rdb_vector_search_params &params,
+      Rdb_vector_result_with_value &result) override;
+
+  uint index_scan(
+      THD *thd, const TABLE *const tbl, Item *pk_index_cond,
+      const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
+      const Rdb_vector_search_params &params,
+      std::unique_ptr<Rdb_vector_db_iterator> &index_scan_result_iter)
+      override {
+        return HA_ERR_UNSUPPORTED;
+      };
+
+  uint index_scan_with_value(
+      THD *thd, const TABLE *const tbl, Item *pk_index_cond,
+      const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
+      Rdb_vector_search_params &params, Rdb_vector_result_with_value &result)
+      override;
+
+  uint analyze(THD *thd, uint64_t max_num_rows_scanned,
+               std::atomic<THD::killed_state> *killed) override {
+    return HA_EXIT_SUCCESS;
+  }
+
+  Rdb_vector_index_info dump_info() override {
+    return {.m_ntotal = m_ntotal, .m_hit = m_hit};
+  }
+
+  FB_vector_dimension dimension() const override {
+    return m_index_def.dimension();
   }
 
   const FB_vector_index_config &get_config() const override {              
@@ -1198,33 +1934,40 @@ class Rdb_vector_index_lsm : public Rdb_vector_index {
   std::shared_ptr<rocksdb::ColumnFamilyHandle> m_cf_handle;
   std::atomic<uint> m_hit{0};
   std::atomic<int64_t> m_ntotal{0};
+
+  /**
+    hybrid top k read from the spatial index in growing boxes around the
+    query geometry. the vector distance is never negative, so once k rows
+    score at most t every better row lies within t / weight metres of the
+    query geometry. the last box covers that radius, so the result is exact
+    up to the bulge of long polygon edges, and rows whose spatial term alone
+    is worse than the k-th best are skipped before their vector is decoded.
+  */
+  uint hybrid_spatial_top_k(THD *thd, const uint k,
+                            const Rdb_spatial_query_distance &spatial_distance,
+                            const Rdb_vector_search_params &params,
+                            const Rdb_hybrid_spatial_scorer &spatial_score,
+                            const Rdb_hybrid_vector_scorer &vector_score,
+                            Rdb_vector_result_with_value &result);
 };
 
 uint Rdb_vector_index_lsm::knn_search_with_value(
     THD *thd, const TABLE *const tbl, Item *pk_index_cond,
     const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
-    Rdb_vector_search_params &params,
-    std::vector<std::pair<std::string, std::pair<float, std::string>>> &result) {
+    Rdb_vector_search_params &params, Rdb_vector_result_with_value &result) {
   m_hit++;
   result.clear();
 
   uint k = params.m_k;
 
-  using PqElement = std::pair<float, std::pair<std::string, std::string>>;
-  auto cmp = [](const PqElement &a, const PqElement &b) {
-    return a.first < b.first;
-  };
-  std::priority_queue<PqElement, std::vector<PqElement>, decltype(cmp)>
-      top_k_heap(cmp);
-
   // log_to_file("knn search with value, query_vector size: " + std::to_string(query_vector.size()) +
   //             " elements, k: " + std::to_string(k) +
   //             ", nprobe: " + std::to_string(params.m_nprobe));
 
   Rdb_vector_lsm_iterator iter(thd, m_index_id, *m_cf_handle.get(),
-                               query_vector, params.m_k, params.m_nprobe);
+                               query_vector, rdb_vector_fetch_count(k, params),
+                               params.m_nprobe);
   // log_to_file("iterator initialized");
-  int64_t keys_scanned = 0;
 
   std::vector<rocksdb::BlockBasedTableOptions::FieldInfo> field_info_list;
   rocksdb::BlockBasedTableOptions::TableConfig table_config;
@@ -1238,103 +1981,54 @@ uint Rdb_vector_index_lsm::knn_search_with_value(
   // log_to_file("table info retrieved, field_info_list size: " +
   //             std::to_string(field_info_list.size()));
 
-  // iter.seek_to_first();
-  // log_to_file("iterator seeked to first");
-  for (iter.seek_to_first(); iter.is_available(); iter.next()) {
-    // log_to_file("inside loop, iterator is available");
-    keys_scanned++;
-
-    if (iter.return_val_str().size() != 0) {
-      // log_to_file("iterator results: ");
-      // log_to_file("key size: " + std::to_string(iter.return_key_str().size()) +
-      //             ", value size: " +
-      //             std::to_string(iter.return_val_str().size()));
-      // log_to_file_raw(iter.return_key_str());
-      // log_to_file_raw(iter.return_val_str());
-      std::vector<rocksdb::Slice> index_fields;
-      std::vector<size_t> field_indexes_to_extract = {8};
-      int s_decode = DecodeFieldFromValue(
-          table_config, field_info_list, field_indexes_to_extract,
-          iter.value(), &index_fields);
-      if (s_decode) {
-        return HA_ERR_ROCKSDB_CORRUPT_DATA;
-      }
-      std::vector<float> vector_data;
-      rocksdb::Slice index_field = index_fields[0];
-      // log_to_file("geting binary from index field, size: " +
-      //             std::to_string(index_field.size()));
-      std::string_view json_binary(index_field.data(), index_field.size());
-      // log_to_file("starting to extract vector from json, size: " +
-      //             std::to_string(json_binary.size()));
-      int s =
-          ExtractVectorFromJson<float>(json_binary, &vector_data);
-      if (s) {
-        // log_to_file("Failed to extract vector from json: " +
-        //             std::to_string(s));
-        return HA_ERR_ROCKSDB_CORRUPT_DATA;
-      }
-      // log_to_file("vector_data:" +
-      //     std::to_string(vector_data.size()) + " elements, status: " +
-      //     std::to_string(s));
-        
-      // float distance = l2_distance(query_vector, vector_data);
-      float distance = faiss::fvec_L2sqr(
-          query_vector.data(), vector_data.data(), query_vector.size());
-      // log_to_file("distance: " + std::to_string(distance));
-
-      if (top_k_heap.size() < k) {
-        top_k_heap.push({distance,
-                         {iter.return_key_str(), iter.return_val_str()}});
-      } else if (distance < top_k_heap.top().first) {
-        top_k_heap.pop();
-        top_k_heap.push({distance,
-                         {iter.return_key_str(), iter.return_val_str()}});
-      }
-    }
-  }
-
-  result.reserve(top_k_heap.size());
-  while (!top_k_heap.empty()) {
-    const auto &top = top_k_heap.top();
-    result.emplace_back(top.second.first,
-                        std::make_pair(top.first, top.second.second));
-    top_k_heap.pop();
+  std::vector<size_t> field_indexes_to_extract = {8};
+  if (field_info_list.size() <= field_indexes_to_extract[0]) {
+    return HA_ERR_ROCKSDB_CORRUPT_DATA;
   }
-  std::reverse(result.begin(), result.end());
-
-  // log_to_file("number of records from iterator: " +
-  //             std::to_string(keys_scanned));
-  // log_to_file("size of iterator result: " + std::to_string(result.size()));
+  const bool binary =
+      field_info_list[field_indexes_to_extract[0]].type == MYSQL_TYPE_BLOB;
+  const bool normalized = m_index_def.normalized();
+  const auto scorer = [&](const rocksdb::Slice &key,
+                          const rocksdb::Slice &value,
+                          Rdb_vector_scan_scratch &scratch,
+                          float *score) -> uint {
+    if (DecodeFieldFromValue(table_config, field_info_list,
+                             field_indexes_to_extract, value,
+                             &scratch.m_fields)) {
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    const float *vector_data = nullptr;
+    if (decode_vector_field(key, scratch.m_fields[0], query_vector.size(),
+                            binary, normalized, scratch.m_cached_vector,
+                            scratch.m_vector_buffer, &vector_data)) {
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    *score = rdb_vector_row_score(params.m_metric, normalized,
+                                  query_vector.data(), vector_data,
+                                  query_vector.size());
+    return HA_EXIT_SUCCESS;
+  };
 
-  return HA_EXIT_SUCCESS;
+  const uint rc =
+      rdb_vector_scan_top_k(iter, k, params.m_threads, scorer,
+                            params.m_row_filter, result);
+  rdb_vector_restore_distances(params.m_metric, result);
+  return rc;
 }
 
 uint Rdb_vector_index_lsm::knn_search_hybrid_with_value(
     THD *thd, const TABLE *const tbl, Item *pk_index_cond,
     const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
-    Rdb_vector_search_params &params,
-    std::vector<std::pair<std::string, std::pair<float, std::string>>> &result) {
+    Rdb_vector_search_params &params, Rdb_vector_result_with_value &result) {
   m_hit++;
   result.clear();
 
   uint k = params.m_k;
 
-  using PqElement = std::pair<float, std::pair<std::string, std::string>>;
-  auto cmp = [](const PqElement &a, const PqElement &b) {
-    return a.first < b.first;
-  };
-  std::priority_queue<PqElement, std::vector<PqElement>, decltype(cmp)>
-      top_k_heap(cmp);
-
   // log_to_file("knn search with value, query_vector size: " + std::to_string(query_vector.size()) +
   //             " elements, k: " + std::to_string(k) +
   //             ", nprobe: " + std::to_string(params.m_nprobe));
 
-  Rdb_vector_lsm_iterator iter(thd, m_index_id, *m_cf_handle.get(),
-                               query_vector, params.m_k, params.m_nprobe);
-  // log_to_file("iterator initialized");
-  int64_t keys_scanned = 0;
-
   std::vector<rocksdb::BlockBasedTableOptions::FieldInfo> field_info_list;
   rocksdb::BlockBasedTableOptions::TableConfig table_config;
 
@@ -1347,7 +2041,7 @@ uint Rdb_vector_index_lsm::knn_search_hybrid_with_value(
   // log_to_file("table info retrieved, field_info_list size: " +
   //             std::to_string(field_info_list.size()));
   std::vector<size_t> field_indexes_to_extract = {};
-  int spatial_field_index;
+  int spatial_field_index = -1;
   int vector_field_index;
   int count = 0;
     // check if field contains spatial index
@@ -1374,124 +2068,200 @@ uint Rdb_vector_index_lsm::knn_search_hybrid_with_value(
       }
       count++;
     }
+  if (spatial_field_index < 0) {
+    return HA_ERR_UNSUPPORTED;
+  }
 
-  std::vector<float> query_coordinates;
-
-  double lon_query = *reinterpret_cast<const double*>(params.m_query_coordinate.data() + 9);
-  double lat_query = *reinterpret_cast<const double*>(params.m_query_coordinate.data() + 17);
-  query_coordinates.push_back(lon_query);
-  query_coordinates.push_back(lat_query);
-  // log_to_file("query_coordinates: " +
-  //             std::to_string(query_coordinates.size()) + " elements, ymin: " +
-  //             std::to_string(lon_query) + ", xmin: " + std::to_string(lat_query));
-
-
-  // iter.seek_to_first();
-  // log_to_file("iterator seeked to first");
-  for (iter.seek_to_first(); iter.is_available(); iter.next()) {
-    // log_to_file("inside loop, iterator is available");
-    keys_scanned++;
-
-    if (iter.return_val_str().size() != 0) {
-      // log_to_file("iterator results: ");
-      // log_to_file("key size: " + std::to_string(iter.return_key_str().size()) +
-      //             ", value size: " +
-      //             std::to_string(iter.return_val_str().size()));
-      // log_to_file_raw(iter.return_key_str());
-      // log_to_file_raw(iter.return_val_str());
-      std::vector<rocksdb::Slice> index_fields;
-      int s_decode = DecodeFieldFromValue(
-          table_config, field_info_list, field_indexes_to_extract,
-          iter.value(), &index_fields);
-      if (s_decode) {
+  if (params.m_query_geometry == nullptr || params.m_query_geometry->empty()) {
+    LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                    "hybrid search needs a point, multipoint or polygon to "
+                    "measure the spatial distance from");
+    return HA_ERR_UNSUPPORTED;
+  }
+
+  // the trig of the query geometry is shared by every row
+  const Rdb_spatial_query_distance spatial_distance(*params.m_query_geometry);
+  const Rdb_point_value_layout point_layout = rdb_point_value_layout(
+      table_config, field_info_list,
+      field_indexes_to_extract[spatial_field_index]);
+
+  // spatial term of a row. the point is read in place when its offset is
+  // fixed, and the vector scorer decodes the row only for rows it scores,
+  // else the extracted fields are decoded into scratch for both
+  const auto spatial_score = [&](const rocksdb::Slice &value,
+                                 Rdb_vector_scan_scratch &scratch,
+                                 double *lon, double *lat,
+                                 float *score) -> uint {
+    if (point_layout.fixed()) {
+      scratch.m_fields.clear();
+      if (!rdb_point_from_value(point_layout, value, lon, lat)) {
         return HA_ERR_ROCKSDB_CORRUPT_DATA;
       }
-      std::vector<float> vector_data;
-      rocksdb::Slice index_field = index_fields[vector_field_index];
-      // log_to_file("geting binary from index field, size: " +
-      //             std::to_string(index_field.size()));
-      std::string_view json_binary(index_field.data(), index_field.size());
-      // log_to_file("starting to extract vector from json, size: " +
-      //             std::to_string(json_binary.size()));
-      int s =
-          ExtractVectorFromJson<float>(json_binary, &vector_data);
-      if (s) {
-        // log_to_file("Failed to extract vector from json: " +
-        //             std::to_string(s));
+    } else {
+      if (DecodeFieldFromValue(table_config, field_info_list,
+                               field_indexes_to_extract, value,
+                               &scratch.m_fields)) {
+        return HA_ERR_ROCKSDB_CORRUPT_DATA;
+      }
+      const rocksdb::Slice &index_field_spatial =
+          scratch.m_fields[spatial_field_index];
+      if (index_field_spatial.size() < RDB_WKB_POINT_SIZE) {
         return HA_ERR_ROCKSDB_CORRUPT_DATA;
       }
-      // log_to_file("vector_data:" +
-      //     std::to_string(vector_data.size()) + " elements, status: " +
-      //     std::to_string(s));
+      *lon = *reinterpret_cast<const double*>(index_field_spatial.data() + 9);
+      *lat =
+          *reinterpret_cast<const double*>(index_field_spatial.data() + 17);
+    }
+
+    float distance_spatial = spatial_distance(*lon, *lat);
+    // log_to_file("spatial distance: " + std::to_string(distance_spatial));
+    *score = params.m_weight * distance_spatial;
+    return HA_EXIT_SUCCESS;
+  };
+
+  // vector term of a row after spatial_score, the vector column is located
+  // above as the JSON one
+  const auto vector_score = [&](const rocksdb::Slice &key,
+                                const rocksdb::Slice &value,
+                                Rdb_vector_scan_scratch &scratch,
+                                float *score) -> uint {
+    if (scratch.m_fields.empty() &&
+        DecodeFieldFromValue(table_config, field_info_list,
+                             field_indexes_to_extract, value,
+                             &scratch.m_fields)) {
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    const float *vector_data = nullptr;
+    if (decode_vector_field(key, scratch.m_fields[vector_field_index],
+                            query_vector.size(), false,
+                            m_index_def.normalized(), scratch.m_cached_vector,
+                            scratch.m_vector_buffer, &vector_data)) {
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    *score = fb_vector_l2sqr(query_vector.data(), vector_data,
+                             query_vector.size());
+    return HA_EXIT_SUCCESS;
+  };
+
+  if (params.m_weight > 0) {
+    return hybrid_spatial_top_k(thd, k, spatial_distance, params,
+                                spatial_score, vector_score, result);
+  }
 
-      std::vector<double> spatial_coordinate;
-      rocksdb::Slice index_field_spatial = index_fields[spatial_field_index];
-      double lon = *reinterpret_cast<const double*>(index_field_spatial.data() + 9);
-      double lat = *reinterpret_cast<const double*>(index_field_spatial.data() + 17);
-      // log_to_file("spatial coordinate: lon: " + std::to_string(lon) +
-      //             ", lat: " + std::to_string(lat));
-      
+  Rdb_vector_lsm_iterator iter(thd, m_index_id, *m_cf_handle.get(),
+                               query_vector, rdb_vector_fetch_count(k, params),
+                               params.m_nprobe);
+  // log_to_file("iterator initialized");
+
+  const auto scorer = [&](const rocksdb::Slice &key,
+                          const rocksdb::Slice &value,
+                          Rdb_vector_scan_scratch &scratch,
+                          float *score) -> uint {
+    double lon = 0;
+    double lat = 0;
+    float spatial = 0;
+    float distance = 0;
+    uint rtn = spatial_score(value, scratch, &lon, &lat, &spatial);
+    if (!rtn) {
+      rtn = vector_score(key, value, scratch, &distance);
+    }
+    // log_to_file("vector distance: " + std::to_string(distance));
+    *score = distance + spatial;
+    return rtn;
+  };
 
-      float distance_spatial = st_distance_simple(query_coordinates[0], query_coordinates[1], lon, lat);
-      float distance = faiss::fvec_L2sqr(
-          query_vector.data(), vector_data.data(), query_vector.size());
-      // log_to_file("vector distance: " + std::to_string(distance));
-      // log_to_file("spatial distance: " + std::to_string(distance_spatial));
-      // log_to_file("combined distance: " +
-      //             std::to_string(distance + params.m_weight*distance_spatial));
+  return rdb_vector_scan_top_k(iter, k, params.m_threads, scorer,
+                               params.m_row_filter, result);
+}
 
-      if (top_k_heap.size() < k) {
-        top_k_heap.push({distance + params.m_weight*distance_spatial,
-                         {iter.return_key_str(), iter.return_val_str()}});
-      } else if (distance < top_k_heap.top().first) {
-        top_k_heap.pop();
-        top_k_heap.push({distance,
-                         {iter.return_key_str(), iter.return_val_str()}});
+uint Rdb_vector_index_lsm::hybrid_spatial_top_k(
+    THD *thd, const uint k, const Rdb_spatial_query_distance &spatial_distance,
+    const Rdb_vector_search_params &params,
+    const Rdb_hybrid_spatial_scorer &spatial_score,
+    const Rdb_hybrid_vector_scorer &vector_score,
+    Rdb_vector_result_with_value &result) {
+  if (k == 0) return HA_EXIT_SUCCESS;
+
+  Rdb_vector_top_k top_k(k);
+  Rdb_vector_scan_scratch scratch;
+  // box of the previous round, its rows are already in top_k
+  std::vector<double> scanned;
+
+  const auto scan = [&](const std::vector<double> &mbr) -> uint {
+    Rdb_next_spatial_rtree_iterator iter(thd, m_index_id, *m_cf_handle, mbr);
+    for (iter.seek_to_first(); iter.is_available(); iter.next()) {
+      const rocksdb::Slice value = iter.value();
+      if (value.empty()) continue;
+      const rocksdb::Slice key = iter.key();
+      double lon = 0;
+      double lat = 0;
+      float spatial = 0;
+      uint rtn = spatial_score(value, scratch, &lon, &lat, &spatial);
+      if (rtn) return rtn;
+      // the vector distance is never negative, so the spatial term alone
+      // may already rule the row out before its vector is decoded
+      if (rdb_spatial_mbr_contains(scanned, lon, lat) ||
+          !top_k.accepts(spatial)) {
+        continue;
+      }
+      if (params.m_row_filter) {
+        bool match = true;
+        rtn = params.m_row_filter(key, value, &match);
+        if (rtn) return rtn;
+        if (!match) continue;
       }
+      float distance = 0;
+      rtn = vector_score(key, value, scratch, &distance);
+      if (rtn) return rtn;
+      top_k.push(distance + spatial, key, value, false);
     }
-  }
+    return HA_EXIT_SUCCESS;
+  };
 
-  result.reserve(top_k_heap.size());
-  while (!top_k_heap.empty()) {
-    const auto &top = top_k_heap.top();
-    result.emplace_back(top.second.first,
-                        std::make_pair(top.first, top.second.second));
-    top_k_heap.pop();
+  double radius = RDB_HYBRID_INITIAL_RADIUS;
+  for (;;) {
+    const auto mbr = spatial_distance.radius_mbr(radius);
+    const uint rtn = scan(mbr);
+    if (rtn) return rtn;
+    scanned = mbr;
+    if (top_k.full()) {
+      // a row scoring below the k-th best is closer than this
+      const double bound = top_k.worst() / params.m_weight;
+      if (bound > radius) {
+        // scores only improve, every better row is inside this box
+        const uint last_rtn = scan(spatial_distance.radius_mbr(bound));
+        if (last_rtn) return last_rtn;
+      }
+      break;
+    }
+    if (rdb_spatial_mbr_is_whole_globe(mbr)) {
+      // the table has fewer than k rows
+      break;
+    }
+    radius *= RDB_HYBRID_RADIUS_GROWTH;
   }
-  std::reverse(result.begin(), result.end());
-
-  // log_to_file("number of records from iterator: " +
-  //             std::to_string(keys_scanned));
-  // log_to_file("size of iterator result: " + std::to_string(result.size()));
 
+  top_k.to_result(result);
   return HA_EXIT_SUCCESS;
 }
 
 uint Rdb_vector_index_lsm::index_scan_with_value(
     THD *thd, const TABLE *const tbl, Item *pk_index_cond,
     const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
-    uint nprobe,
-    std::vector<std::pair<std::string, std::pair<float, std::string>>> &result) {
+    Rdb_vector_search_params &params, Rdb_vector_result_with_value &result) {
   m_hit++;
   result.clear();
 
   uint k = 100; // default k value for index scan
 
-  using PqElement = std::pair<float, std::pair<std::string, std::string>>;
-  auto cmp = [](const PqElement &a, const PqElement &b) {
-    return a.first < b.first;
-  };
-  std::priority_queue<PqElement, std::vector<PqElement>, decltype(cmp)>
-      top_k_heap(cmp);
-
   // log_to_file("query_vector size: " + std::to_string(query_vector.size()) +
   //             " elements, k: " + std::to_string(k) +
   //             ", nprobe: " + std::to_string(params.m_nprobe));
 
   Rdb_vector_lsm_iterator iter(thd, m_index_id, *m_cf_handle.get(),
-                               query_vector, 500, nprobe);
+                               query_vector, rdb_vector_fetch_count(500, params),
+                               params.m_nprobe);
   // log_to_file("iterator initialized");
-  int64_t keys_scanned = 0;
 
   std::vector<rocksdb::BlockBasedTableOptions::FieldInfo> field_info_list;
   rocksdb::BlockBasedTableOptions::TableConfig table_config;
@@ -1505,68 +2275,175 @@ uint Rdb_vector_index_lsm::index_scan_with_value(
   // log_to_file("table info retrieved, field_info_list size: " +
   //             std::to_string(field_info_list.size()));
 
-  for (iter.seek_to_first(); iter.is_available(); iter.next()) {
-    keys_scanned++;
-
-    // log_to_file("iterator results: ");
-    // log_to_file("key size: " + std::to_string(iter.return_key_str().size()) +
-    //             ", value size: " +
-    //             std::to_string(iter.return_val_str().size()));
-    // log_to_file_raw(iter.return_key_str());
-    // log_to_file_raw(iter.return_val_str());
-
-    if (iter.return_val_str().size() != 0) {
-      std::vector<rocksdb::Slice> index_fields;
-      std::vector<size_t> field_indexes_to_extract = {8};
-      int s_decode = DecodeFieldFromValue(
-          table_config, field_info_list, field_indexes_to_extract,
-          iter.value(), &index_fields);
-      if (s_decode) {
-        return HA_ERR_ROCKSDB_CORRUPT_DATA;
-      }
-      std::vector<float> vector_data;
-      rocksdb::Slice index_field = index_fields[0];
-      std::string_view json_binary(index_field.data(), index_field.size());
-      int s =
-          ExtractVectorFromJson<float>(json_binary, &vector_data);
-      if (s) {
-        // log_to_file("Failed to extract vector from json: " +
-        //             std::to_string(s));
-        return HA_ERR_ROCKSDB_CORRUPT_DATA;
-      }
-      // log_to_file("vector_data:" +
-      //     std::to_string(vector_data.size()) + " elements, status: " +
-      //     std::to_string(s));
-        
-      // float distance = l2_distance(query_vector, vector_data);
-      float distance = faiss::fvec_L2sqr(
-          query_vector.data(), vector_data.data(), query_vector.size());
-      // log_to_file("distance: " + std::to_string(distance));
+  std::vector<size_t> field_indexes_to_extract = {8};
+  if (field_info_list.size() <= field_indexes_to_extract[0]) {
+    return HA_ERR_ROCKSDB_CORRUPT_DATA;
+  }
+  const bool binary =
+      field_info_list[field_indexes_to_extract[0]].type == MYSQL_TYPE_BLOB;
+  const bool normalized = m_index_def.normalized();
+  const auto scorer = [&](const rocksdb::Slice &key,
+                          const rocksdb::Slice &value,
+                          Rdb_vector_scan_scratch &scratch,
+                          float *score) -> uint {
+    if (DecodeFieldFromValue(table_config, field_info_list,
+                             field_indexes_to_extract, value,
+                             &scratch.m_fields)) {
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    const float *vector_data = nullptr;
+    if (decode_vector_field(key, scratch.m_fields[0], query_vector.size(),
+                            binary, normalized, scratch.m_cached_vector,
+                            scratch.m_vector_buffer, &vector_data)) {
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    *score = rdb_vector_row_score(params.m_metric, normalized,
+                                  query_vector.data(), vector_data,
+                                  query_vector.size());
+    return HA_EXIT_SUCCESS;
+  };
+
+  const uint rc =
+      rdb_vector_scan_top_k(iter, k, params.m_threads, scorer,
+                            params.m_row_filter, result);
+  rdb_vector_restore_distances(params.m_metric, result);
+  return rc;
+}
+
+/**
+  a retrain writes the entries of an ivf index again under new centroids
+  while the old ones keep serving queries. the generation of the centroids
+  is kept in the high bits of the list id in the key, so the entries of both
+  generations live side by side. indexes that were never retrained are
+  generation 0 and keep their original layout.
+*/
+constexpr uint IVF_GENERATION_SHIFT =
+    Rdb_key_def::VECTOR_INDEX_GENERATION_SHIFT;
+// memory budget of the vectors sampled to train new centroids
+constexpr std::size_t IVF_RETRAIN_SAMPLE_BYTES = 256ULL << 20;
+// entries copied per write batch by a retrain
+constexpr std::size_t IVF_RETRAIN_BATCH_SIZE = 1024;
+// list size updates between two writes of the sizes to the dictionary,
+// at least nlist so a write costs about one byte per update
+constexpr uint64_t IVF_LIST_SIZES_PERSIST_INTERVAL = 1024;
+// smallest slice of a batch worth assigning on its own worker
+constexpr std::size_t IVF_ASSIGN_ROWS_PER_WORKER = 256;
+// transparent huge page size the centroids are advised onto
+constexpr std::size_t IVF_HUGE_PAGE_SIZE = 2ULL << 20;
+
+/**
+  ask the kernel to back the whole huge pages within [data, data + size) by
+  huge pages. centroids are scanned by every search, huge pages cut the tlb
+  misses. best effort, smaller buffers are not touched.
+*/
+static void rdb_advise_huge_pages(const void *data, std::size_t size) {
+#ifdef MADV_HUGEPAGE
+  const auto begin = reinterpret_cast<uintptr_t>(data);
+  const uintptr_t aligned_begin =
+      (begin + IVF_HUGE_PAGE_SIZE - 1) & ~(IVF_HUGE_PAGE_SIZE - 1);
+  const uintptr_t aligned_end = (begin + size) & ~(IVF_HUGE_PAGE_SIZE - 1);
+  if (aligned_end > aligned_begin) {
+    madvise(reinterpret_cast<void *>(aligned_begin),
+            aligned_end - aligned_begin, MADV_HUGEPAGE);
+  }
+#else
+  (void)data;
+  (void)size;
+#endif
+}
 
-      if (top_k_heap.size() < k) {
-        top_k_heap.push({distance,
-                         {iter.return_key_str(), iter.return_val_str()}});
-      } else if (distance < top_k_heap.top().first) {
-        top_k_heap.pop();
-        top_k_heap.push({distance,
-                         {iter.return_key_str(), iter.return_val_str()}});
+/**
+  centroid quantizers of ivf indexes, which are read only once built.
+  indexes with the same centroids, e.g. the partitions of a table trained
+  from one trained index table, or flat indexes of the same dimension,
+  share one copy. a quantizer is freed with the last index using it.
+*/
+class Rdb_ivf_quantizer_store {
+ public:
+  std::shared_ptr<faiss::IndexFlatL2> get(FB_vector_dimension dimension,
+                                          const std::vector<float> &centroids) {
+    const std::size_t ncentroids = centroids.size() / dimension;
+    const uint64_t hash = rocksdb::Hash64(
+        reinterpret_cast<const char *>(centroids.data()),
+        centroids.size() * sizeof(float), dimension);
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    auto range = m_quantizers.equal_range(hash);
+    for (auto iter = range.first; iter != range.second;) {
+      auto quantizer = iter->second.lock();
+      if (!quantizer) {
+        iter = m_quantizers.erase(iter);
+        continue;
       }
+      if (quantizer->d == static_cast<faiss::idx_t>(dimension) &&
+          quantizer->ntotal == static_cast<faiss::idx_t>(ncentroids) &&
+          std::memcmp(quantizer->codes.data(), centroids.data(),
+                      centroids.size() * sizeof(float)) == 0) {
+        return quantizer;
+      }
+      ++iter;
     }
+    auto quantizer = std::make_shared<faiss::IndexFlatL2>(dimension);
+    quantizer->add(ncentroids, centroids.data());
+    rdb_advise_huge_pages(quantizer->codes.data(), quantizer->codes.size());
+    m_quantizers.emplace(hash, quantizer);
+    return quantizer;
   }
 
-  result.reserve(top_k_heap.size());
-  while (!top_k_heap.empty()) {
-    const auto &top = top_k_heap.top();
-    result.emplace_back(top.second.first,
-                        std::make_pair(top.first, top.second.second));
-    top_k_heap.pop();
-  }
-  std::reverse(result.begin(), result.end());
+ private:
+  std::mutex m_mutex;
+  std::unordered_multimap<uint64_t, std::weak_ptr<faiss::IndexFlatL2>>
+      m_quantizers;
+};
+
+static Rdb_ivf_quantizer_store &rdb_get_ivf_quantizer_store() {
+  static Rdb_ivf_quantizer_store store;
+  return store;
+}
+
+enum class Rdb_ivf_retrain_phase {
+  NONE,
+  SAMPLING,
+  TRAINING,
+  BACKFILL,
+  SWAP,
+  CLEANUP,
+  DONE,
+  FAILED
+};
 
-  // log_to_file("number of records from iterator: " +
-  //             std::to_string(keys_scanned));
-  // log_to_file("size of iterator result: " + std::to_string(result.size()));
+static const char *rdb_ivf_retrain_phase_name(
+    const Rdb_ivf_retrain_phase phase) {
+  switch (phase) {
+    case Rdb_ivf_retrain_phase::NONE:
+      return "";
+    case Rdb_ivf_retrain_phase::SAMPLING:
+      return "SAMPLING";
+    case Rdb_ivf_retrain_phase::TRAINING:
+      return "TRAINING";
+    case Rdb_ivf_retrain_phase::BACKFILL:
+      return "BACKFILL";
+    case Rdb_ivf_retrain_phase::SWAP:
+      return "SWAP";
+    case Rdb_ivf_retrain_phase::CLEANUP:
+      return "CLEANUP";
+    case Rdb_ivf_retrain_phase::DONE:
+      return "DONE";
+    case Rdb_ivf_retrain_phase::FAILED:
+      return "FAILED";
+  }
+  return "";
+}
 
+/**
+  list id of a secondary key entry, generation included
+*/
+static uint read_inverted_list_key_id(const rocksdb::Slice &key,
+                                      uint64 *list_key_id) {
+  if (key.size() < INDEX_NUMBER_SIZE + sizeof(uint64)) {
+    return HA_ERR_ROCKSDB_CORRUPT_DATA;
+  }
+  *list_key_id = rdb_netbuf_to_uint64(
+      reinterpret_cast<const uchar *>(key.data() + INDEX_NUMBER_SIZE));
   return HA_EXIT_SUCCESS;
 }
 
@@ -1575,44 +2452,108 @@ class Rdb_vector_index_ivf : public Rdb_vector_index {
   Rdb_vector_index_ivf(const FB_vector_index_config index_def,
                        std::shared_ptr<rocksdb::ColumnFamilyHandle> cf_handle,
                        const Index_id index_id)
-      : m_index_id{index_id}, m_index_def{index_def}, m_cf_handle{cf_handle} {}
+      : m_index_id{index_id}, m_index_def{index_def}, m_cf_handle{cf_handle} {
+    auto *const partitioner_factory =
+        Rdb_sst_partitioner_factory::get(rdb_get_rocksdb_db(), *m_cf_handle);
+    if (partitioner_factory != nullptr) {
+      partitioner_factory->add_vector_index(m_index_id);
+    }
+  }
 
-  virtual ~Rdb_vector_index_ivf() override = default;
+  virtual ~Rdb_vector_index_ivf() override {
+    auto *const partitioner_factory =
+        Rdb_sst_partitioner_factory::get(rdb_get_rocksdb_db(), *m_cf_handle);
+    if (partitioner_factory != nullptr) {
+      partitioner_factory->remove_vector_index(m_index_id);
+    }
+  }
 
   void assign_vector(const float *data,
                      Rdb_vector_index_assignment &assignment) override {
-    faiss_ivf_list_id list_id = get_list_id(data);
+    const auto state = current_state();
+    faiss_ivf_list_id list_id = get_list_id(*state, data);
     constexpr faiss::idx_t vector_count = 1;
     // vector id is not actually used, use a dummy value here
-    m_index_l2->add_core(vector_count, data, &DUMMY_VECTOR_ID, &list_id,
-                         &assignment);
+    state->m_index_l2->add_core(vector_count, data, &DUMMY_VECTOR_ID,
+                                &list_id, &assignment);
+    assignment.m_list_id = state->list_key_id(assignment.m_list_id);
+  }
+
+  void assign_vectors(
+      std::size_t n, const float *data,
+      std::vector<Rdb_vector_index_assignment> &assignments) override {
+    const auto state = current_state();
+    const std::size_t dim = dimension();
+    const faiss::IndexIVF &index = *state->m_index_l2;
+    const std::size_t code_size = index.code_size;
+    assignments.resize(n);
+    std::vector<faiss::idx_t> list_ids(n, 0);
+    std::vector<uint8_t> codes(n * code_size);
+    // the quantizer and the encoder are read only, so slices are assigned
+    // and encoded concurrently, each with one call. encode_vectors does not
+    // count the vectors in the index totals as add_core does, which the
+    // entries in rocksdb make unused.
+    const uint threads = std::max<std::size_t>(
+        1, std::min<std::size_t>(Rdb_vector_worker_pool::max_workers(),
+                                 n / IVF_ASSIGN_ROWS_PER_WORKER));
+    rdb_get_vector_worker_pool().run(threads, [&](uint worker) {
+      const std::size_t begin = n * worker / threads;
+      const std::size_t end = n * (worker + 1) / threads;
+      if (begin >= end) {
+        return;
+      }
+      if (index.nlist > 1) {
+        index.quantizer->assign(end - begin, data + begin * dim,
+                                list_ids.data() + begin);
+      }
+      index.encode_vectors(end - begin, data + begin * dim,
+                           list_ids.data() + begin,
+                           codes.data() + begin * code_size);
+    });
+    for (std::size_t i = 0; i < n; i++) {
+      assignments[i].m_list_id = state->list_key_id(list_ids[i]);
+      assignments[i].m_codes.assign(
+          reinterpret_cast<const char *>(codes.data() + i * code_size),
+          code_size);
+    }
   }
 
   FB_vector_dimension dimension() const override {
     return m_index_def.dimension();
   }
 
-  const FB_vector_index_config &get_config() const override {             
-    return m_index_def; }     
+  const FB_vector_index_config &get_config() const override {
+    return m_index_def; }
 
   virtual uint index_scan(THD *thd, const TABLE *const tbl, Item *pk_index_cond,
                           const Rdb_key_def *sk_descr,
-                          std::vector<float> &query_vector, uint nprobe,
+                          std::vector<float> &query_vector,
+                          const Rdb_vector_search_params &params,
                           std::unique_ptr<Rdb_vector_db_iterator>
                               &index_scan_result_iter) override {
     m_hit++;
 
+    const auto state = current_state();
+    const faiss::idx_t nprobe = params.m_search_all_lists
+                                    ? state->m_index_l2->nlist
+                                    : faiss::idx_t{params.m_nprobe};
     constexpr faiss::idx_t vector_count = 1;
     std::vector<faiss::idx_t> vector_ids(nprobe);
     std::vector<float> distances(nprobe);
 
-    m_quantizer->search(vector_count, query_vector.data(), nprobe,
-                        distances.data(), vector_ids.data());
+    state->m_quantizer->search(vector_count, query_vector.data(), nprobe,
+                               distances.data(), vector_ids.data());
+    for (auto &list_id : vector_ids) {
+      if (list_id >= 0) {
+        list_id = state->list_key_id(list_id);
+      }
+    }
 
     Rdb_faiss_inverted_list_context context(thd, tbl, pk_index_cond, sk_descr);
+    context.m_pk_prefix = params.m_pk_prefix;
     index_scan_result_iter.reset(new Rdb_vector_list_iterator(
         std::move(context), m_index_id, m_cf_handle.get(),
-        m_index_l2->code_size, std::move(vector_ids)));
+        state->m_index_l2->code_size, std::move(vector_ids)));
 
     return HA_EXIT_SUCCESS;
   }
@@ -1620,12 +2561,13 @@ class Rdb_vector_index_ivf : public Rdb_vector_index {
   virtual uint knn_search(
       THD *thd, const TABLE *const tbl, Item *pk_index_cond,
       const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
-      Rdb_vector_search_params &params,
-      std::vector<std::pair<std::string, float>> &result) override {
+      Rdb_vector_search_params &params, Rdb_vector_result &result) override {
     m_hit++;
-    faiss::IndexIVF *index = m_index_l2.get();
-    if (params.m_metric == FB_VECTOR_INDEX_METRIC::IP) {
-      index = m_index_ip.get();
+    const auto state = current_state();
+    faiss::IndexIVF *index = state->m_index_l2.get();
+    if (params.m_metric == FB_VECTOR_INDEX_METRIC::IP ||
+        params.m_metric == FB_VECTOR_INDEX_METRIC::COSINE) {
+      index = state->m_index_ip.get();
     }
     faiss::idx_t k = params.m_k;
     std::vector<faiss::idx_t> vector_ids(k);
@@ -1633,58 +2575,395 @@ class Rdb_vector_index_ivf : public Rdb_vector_index {
     constexpr faiss::idx_t vector_count = 1;
     faiss::IVFSearchParameters search_params;
 
-    search_params.nprobe = params.m_nprobe;
     Rdb_faiss_inverted_list_context context(thd, tbl, pk_index_cond, sk_descr);
+    context.m_pk_prefix = params.m_pk_prefix;
+    context.use_list_cache(this);
     search_params.inverted_list_context = &context;
-    index->search(vector_count, query_vector.data(), k, distances.data(),
-                  vector_ids.data(), &search_params);
+    std::vector<faiss::idx_t> list_ids;
+    std::vector<float> centroid_distances;
+    // assign the lists here rather than in search() to time the phases
+    THD_STAGE_INFO(thd, stage_vector_assigning_lists);
+    const auto assign_start = my_micro_time();
+    // the list sizes count the entries of all prefixes, a prefix only has
+    // its share of them
+    const bool whole_lists = params.m_pk_prefix.empty();
+    if (!whole_lists ||
+        !probe_lists_for_target(*state, query_vector.data(),
+                                params.m_target_candidates, list_ids,
+                                centroid_distances)) {
+      const faiss::idx_t nprobe =
+          params.m_search_all_lists
+              ? index->nlist
+              : std::clamp<faiss::idx_t>(params.m_nprobe, 1, index->nlist);
+      list_ids.resize(nprobe);
+      centroid_distances.resize(nprobe);
+      state->m_quantizer->search(vector_count, query_vector.data(), nprobe,
+                                 centroid_distances.data(), list_ids.data());
+    }
+    search_params.nprobe = list_ids.size();
+
+    THD_STAGE_INFO(thd, stage_vector_scanning_lists);
+    mysql_stage_set_work_estimated(thd->m_stage_progress_psi,
+                                   list_ids.size());
+    context.m_report_progress = true;
+    const auto scan_start = my_micro_time();
+    index->search_preassigned(vector_count, query_vector.data(), k,
+                              list_ids.data(), centroid_distances.data(),
+                              distances.data(), vector_ids.data(),
+                              /* store_pairs */ false, &search_params);
+    const auto scan_end = my_micro_time();
+    context.m_report_progress = false;
+    search_stats().add_scan(
+        context.m_lists_scanned, context.m_vectors_scanned,
+        context.m_vectors_scanned * index->code_size,
+        scan_start - assign_start, scan_end - scan_start);
     if (context.m_error) {
       return context.m_error;
     }
+    THD_STAGE_INFO(thd, stage_vector_ranking_candidates);
     auto rtn = context.populate_result(vector_ids, distances, result);
     if (rtn) {
       return rtn;
     }
 
     // update counters
-    for (auto &list_size_entry : context.m_list_size_stats) {
-      m_list_size_stats[list_size_entry.first] = list_size_entry.second;
+    if (whole_lists) {
+      update_list_size_stats(context);
     }
     return HA_EXIT_SUCCESS;
   }
 
-  virtual uint analyze(THD *thd, uint64_t max_num_rows_scanned,
-                       std::atomic<THD::killed_state> *killed) override {
-    assert(thd);
-    std::string key;
-    rocksdb::Slice codes;
-    uint64_t ntotal = 0;
-    for (std::size_t i = 0; i < m_list_size_stats.size(); i++) {
-      std::size_t list_size = 0;
-      Rdb_faiss_inverted_list_context context(thd, nullptr, nullptr, nullptr);
-      Rdb_vector_iterator vector_iter(&context, m_index_id, *m_cf_handle,
-                                      m_index_l2->code_size, i);
-      while (vector_iter.is_available()) {
-        uint rtn = vector_iter.get_key_and_codes(key, codes);
-        if (rtn) {
-          return rtn;
-        }
-        list_size++;
-        ntotal++;
-        if (max_num_rows_scanned > 0 && ntotal > max_num_rows_scanned) {
-          return HA_EXIT_SUCCESS;
-        }
-        if (killed && *killed) {
-          return HA_EXIT_FAILURE;
-        }
-        vector_iter.next();
-      }
-      m_list_size_stats[i] = list_size;
+  /**
+    flat codes are the raw vectors, so every probed list is read once and
+    each stored vector is compared against all queries probing that list
+    with one fvec_*_ny call. quantized codes go through the per query path.
+  */
+  virtual uint knn_search_batch(
+      THD *thd, const TABLE *const tbl, Item *pk_index_cond,
+      const Rdb_key_def *sk_descr,
+      std::vector<std::vector<float>> &query_vectors,
+      Rdb_vector_search_params &params,
+      std::vector<Rdb_vector_result> &results)
+      override {
+    if ((m_index_def.type() != FB_VECTOR_INDEX_TYPE::FLAT &&
+         m_index_def.type() != FB_VECTOR_INDEX_TYPE::IVFFLAT) ||
+        query_vectors.size() <= 1 || !params.m_pk_prefix.empty()) {
+      return Rdb_vector_index::knn_search_batch(thd, tbl, pk_index_cond,
+                                                sk_descr, query_vectors,
+                                                params, results);
     }
-    return HA_EXIT_SUCCESS;
-  }
-
-  virtual uint setup(const std::string &db_name,
+    m_hit++;
+    results.clear();
+    results.resize(query_vectors.size());
+
+    const auto state = current_state();
+    const std::size_t nq = query_vectors.size();
+    const std::size_t d = m_index_def.dimension();
+    const bool is_cosine = params.m_metric == FB_VECTOR_INDEX_METRIC::COSINE;
+    const bool is_ip =
+        params.m_metric == FB_VECTOR_INDEX_METRIC::IP || is_cosine;
+    const faiss::idx_t nlist = state->m_index_l2->nlist;
+    const faiss::idx_t nprobe =
+        params.m_search_all_lists
+            ? nlist
+            : std::clamp<faiss::idx_t>(params.m_nprobe, 1, nlist);
+    if (params.m_k == 0) {
+      return HA_EXIT_SUCCESS;
+    }
+
+    std::vector<float> queries(nq * d);
+    for (std::size_t i = 0; i < nq; i++) {
+      if (query_vectors[i].size() != d) {
+        return HA_EXIT_FAILURE;
+      }
+      std::copy(query_vectors[i].begin(), query_vectors[i].end(),
+                queries.begin() + i * d);
+      if (is_cosine) {
+        fb_vector_normalize_l2(queries.data() + i * d, d);
+      }
+    }
+
+    // invert the query -> lists assignment so each list is read once
+    std::map<faiss::idx_t, std::vector<std::size_t>> list_queries;
+    std::vector<faiss::idx_t> list_ids;
+    std::vector<float> centroid_distances;
+    if (probe_lists_for_target(*state, queries.data(),
+                               params.m_target_candidates, list_ids,
+                               centroid_distances)) {
+      // every query probes its own number of lists
+      for (std::size_t i = 0; i < nq; i++) {
+        if (i > 0) {
+          probe_lists_for_target(*state, queries.data() + i * d,
+                                 params.m_target_candidates, list_ids,
+                                 centroid_distances);
+        }
+        for (const auto list_id : list_ids) {
+          list_queries[list_id].push_back(i);
+        }
+      }
+    } else {
+      list_ids.resize(nq * nprobe);
+      centroid_distances.resize(nq * nprobe);
+      state->m_quantizer->search(nq, queries.data(), nprobe,
+                                 centroid_distances.data(), list_ids.data());
+      for (std::size_t i = 0; i < nq; i++) {
+        for (faiss::idx_t j = 0; j < nprobe; j++) {
+          const auto list_id = list_ids[i * nprobe + j];
+          if (list_id >= 0) {
+            list_queries[list_id].push_back(i);
+          }
+        }
+      }
+    }
+
+    // heaps keep the smallest score, inner product is negated
+    std::vector<Rdb_vector_top_k> heaps(nq, Rdb_vector_top_k(params.m_k));
+    std::vector<float> group;
+    std::vector<float> scores;
+    std::string key;
+    rocksdb::Slice codes;
+    Rdb_faiss_inverted_list_context context(thd, tbl, pk_index_cond, sk_descr);
+    context.use_list_cache(this);
+    for (const auto &entry : list_queries) {
+      const auto &group_queries = entry.second;
+      const std::size_t ny = group_queries.size();
+      group.resize(ny * d);
+      for (std::size_t i = 0; i < ny; i++) {
+        std::copy_n(queries.begin() + group_queries[i] * d, d,
+                    group.begin() + i * d);
+      }
+      scores.resize(ny);
+
+      Rdb_vector_iterator vector_iter(&context, m_index_id, *m_cf_handle,
+                                      state->m_index_l2->code_size,
+                                      state->list_key_id(entry.first));
+      for (; vector_iter.is_available(); vector_iter.next()) {
+        uint rtn = vector_iter.get_key_and_codes(key, codes);
+        if (rtn) {
+          return rtn;
+        }
+        const float *vector = reinterpret_cast<const float *>(codes.data());
+        if (is_ip) {
+          faiss::fvec_inner_products_ny(scores.data(), vector, group.data(), d,
+                                        ny);
+        } else {
+          faiss::fvec_L2sqr_ny(scores.data(), vector, group.data(), d, ny);
+        }
+        for (std::size_t i = 0; i < ny; i++) {
+          const float score = is_ip ? -scores[i] : scores[i];
+          auto &heap = heaps[group_queries[i]];
+          if (heap.accepts(score)) {
+            heap.push(score, key, rocksdb::Slice(), /* pinned */ false);
+          }
+        }
+      }
+      if (context.m_error) {
+        return context.m_error;
+      }
+    }
+
+    Rdb_vector_result_with_value scan_result;
+    for (std::size_t i = 0; i < nq; i++) {
+      scan_result.clear();
+      heaps[i].to_result(scan_result);
+      results[i].reserve(scan_result.size());
+      for (auto &row : scan_result) {
+        const float distance = is_ip ? -row.second.first : row.second.first;
+        results[i].emplace_back(std::move(row.first), distance);
+      }
+    }
+
+    update_list_size_stats(context);
+    return HA_EXIT_SUCCESS;
+  }
+
+  /**
+    the lists probed by any query vector are read once. a row has one entry
+    per list holding its vectors in the list, the best score of each query
+    vector against the row's vectors read so far is kept. a query vector
+    that met none of them scores the least any row scored for it, so the
+    sum is an estimate the caller re-ranks with the exact FB_VECTOR_MAXSIM.
+  */
+  virtual uint knn_search_maxsim(
+      THD *thd, const TABLE *const tbl, Item *pk_index_cond,
+      const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
+      Rdb_vector_search_params &params, Rdb_vector_result &result) override {
+    if (!m_index_def.multi()) {
+      return HA_ERR_UNSUPPORTED;
+    }
+    m_hit++;
+    result.clear();
+    const auto state = current_state();
+    const std::size_t d = m_index_def.dimension();
+    const std::size_t nq = query_vector.size() / d;
+    if (nq == 0 || query_vector.size() % d != 0) {
+      return HA_EXIT_FAILURE;
+    }
+    if (params.m_k == 0) {
+      return HA_EXIT_SUCCESS;
+    }
+    const faiss::idx_t nlist = state->m_index_l2->nlist;
+    const faiss::idx_t nprobe =
+        params.m_search_all_lists
+            ? nlist
+            : std::clamp<faiss::idx_t>(params.m_nprobe, 1, nlist);
+
+    THD_STAGE_INFO(thd, stage_vector_assigning_lists);
+    const auto assign_start = my_micro_time();
+    std::vector<faiss::idx_t> list_ids(nq * nprobe);
+    std::vector<float> centroid_distances(nq * nprobe);
+    state->m_quantizer->search(nq, query_vector.data(), nprobe,
+                               centroid_distances.data(), list_ids.data());
+    std::map<faiss::idx_t, std::vector<std::size_t>> list_queries;
+    for (std::size_t i = 0; i < nq; i++) {
+      for (faiss::idx_t j = 0; j < nprobe; j++) {
+        const auto list_id = list_ids[i * nprobe + j];
+        if (list_id >= 0) {
+          list_queries[list_id].push_back(i);
+        }
+      }
+    }
+
+    THD_STAGE_INFO(thd, stage_vector_scanning_lists);
+    const auto scan_start = my_micro_time();
+    struct Row {
+      std::string m_key;
+      std::vector<float> m_best;
+    };
+    // rows by pk
+    std::unordered_map<std::string, Row> rows;
+    std::vector<float> group;
+    std::vector<float> scores;
+    std::string key;
+    rocksdb::Slice codes;
+    const std::size_t code_size = state->m_index_l2->code_size;
+    const std::size_t pk_offset =
+        INDEX_NUMBER_SIZE + sizeof(faiss_ivf_list_id);
+    Rdb_faiss_inverted_list_context context(thd, tbl, pk_index_cond, sk_descr);
+    context.m_pk_prefix = params.m_pk_prefix;
+    context.m_multi = true;
+    for (const auto &entry : list_queries) {
+      const auto &group_queries = entry.second;
+      const std::size_t ny = group_queries.size();
+      group.resize(ny * d);
+      for (std::size_t i = 0; i < ny; i++) {
+        std::copy_n(query_vector.begin() + group_queries[i] * d, d,
+                    group.begin() + i * d);
+      }
+      scores.resize(ny);
+
+      Rdb_vector_iterator vector_iter(&context, m_index_id, *m_cf_handle,
+                                      code_size,
+                                      state->list_key_id(entry.first));
+      for (; vector_iter.is_available(); vector_iter.next()) {
+        uint rtn = vector_iter.get_key_and_codes(key, codes);
+        if (rtn) {
+          return rtn;
+        }
+        if (key.size() < pk_offset) {
+          return HA_ERR_ROCKSDB_CORRUPT_DATA;
+        }
+        auto &row = rows[key.substr(pk_offset)];
+        if (row.m_best.empty()) {
+          row.m_key = key;
+          row.m_best.assign(nq, -FLT_MAX);
+        }
+        const std::size_t count = codes.size() / code_size;
+        for (std::size_t v = 0; v < count; v++) {
+          const float *vector =
+              reinterpret_cast<const float *>(codes.data() + v * code_size);
+          faiss::fvec_inner_products_ny(scores.data(), vector, group.data(),
+                                        d, ny);
+          for (std::size_t i = 0; i < ny; i++) {
+            float &best = row.m_best[group_queries[i]];
+            best = std::max(best, scores[i]);
+          }
+        }
+      }
+      if (context.m_error) {
+        return context.m_error;
+      }
+    }
+    const auto scan_end = my_micro_time();
+    search_stats().add_scan(
+        context.m_lists_scanned, context.m_vectors_scanned,
+        context.m_vectors_scanned * code_size, scan_start - assign_start,
+        scan_end - scan_start);
+
+    THD_STAGE_INFO(thd, stage_vector_ranking_candidates);
+    // the least score seen of each query vector stands in for the ones
+    // not met
+    std::vector<float> least(nq, FLT_MAX);
+    for (const auto &row : rows) {
+      for (std::size_t i = 0; i < nq; i++) {
+        if (row.second.m_best[i] != -FLT_MAX) {
+          least[i] = std::min(least[i], row.second.m_best[i]);
+        }
+      }
+    }
+    for (auto &score : least) {
+      if (score == FLT_MAX) {
+        score = 0;
+      }
+    }
+    std::vector<std::pair<float, const Row *>> ranked;
+    ranked.reserve(rows.size());
+    for (const auto &row : rows) {
+      float sum = 0;
+      for (std::size_t i = 0; i < nq; i++) {
+        const float best = row.second.m_best[i];
+        sum += best == -FLT_MAX ? least[i] : best;
+      }
+      ranked.emplace_back(sum, &row.second);
+    }
+    const std::size_t k = std::min<std::size_t>(params.m_k, ranked.size());
+    std::partial_sort(
+        ranked.begin(), ranked.begin() + k, ranked.end(),
+        [](const auto &a, const auto &b) { return a.first > b.first; });
+    result.reserve(k);
+    for (std::size_t i = 0; i < k; i++) {
+      result.emplace_back(ranked[i].second->m_key, ranked[i].first);
+    }
+
+    if (params.m_pk_prefix.empty()) {
+      update_list_size_stats(context);
+    }
+    return HA_EXIT_SUCCESS;
+  }
+
+  /**
+    counts the lists. with max_num_rows_scanned, whole lists are counted in
+    random order until that many entries are, a sample the sizes of the
+    others are extrapolated from, see dump_info(). reads the latest data
+    outside of any transaction, so it also runs without a thd.
+  */
+  virtual uint analyze(THD *thd [[maybe_unused]],
+                       uint64_t max_num_rows_scanned,
+                       std::atomic<THD::killed_state> *killed) override {
+    const auto state = current_state();
+    std::vector<std::size_t> list_order(m_list_size_stats.size());
+    std::iota(list_order.begin(), list_order.end(), 0);
+    if (max_num_rows_scanned > 0) {
+      std::shuffle(list_order.begin(), list_order.end(),
+                   std::mt19937_64(std::random_device()()));
+    }
+    uint64_t ntotal = 0;
+    for (const auto list_no : list_order) {
+      uint64_t list_size = 0;
+      const uint rtn = count_list(*state, list_no, killed, list_size);
+      if (rtn) {
+        return rtn;
+      }
+      set_list_size(list_no, list_size);
+      ntotal += list_size;
+      if (max_num_rows_scanned > 0 && ntotal >= max_num_rows_scanned) {
+        break;
+      }
+    }
+    return persist_list_sizes(*state, /* wait */ true);
+  }
+
+  virtual uint setup(const std::string &db_name,
                      Rdb_cmd_srv_helper &cmd_srv_helper) override {
     std::unique_ptr<Rdb_vector_index_data> index_data;
     if (m_index_def.type() == FB_VECTOR_INDEX_TYPE::FLAT) {
@@ -1723,160 +3002,2039 @@ class Rdb_vector_index_ivf : public Rdb_vector_index {
         return HA_EXIT_FAILURE;
       }
     }
-    uint rtn = setup_quantizer(index_data.get());
+    if (m_index_def.type() == FB_VECTOR_INDEX_TYPE::IVFSQ8) {
+      if (index_data->m_sq_codes.empty() && index_data->m_nlist < 2) {
+        LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
+                        "sq codes is required for IVFSQ8 with one list");
+        return HA_EXIT_FAILURE;
+      }
+      if (!index_data->m_sq_codes.empty() &&
+          index_data->m_sq_codes.size() != 2 * m_index_def.dimension()) {
+        LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
+                        "Invalid sq codes, expected code size %u.",
+                        2 * m_index_def.dimension());
+        return HA_EXIT_FAILURE;
+      }
+    }
+
+    // centroids of a retrain replace the ones of the trained table
+    uint64 generation = 0;
+    if (m_index_def.type() == FB_VECTOR_INDEX_TYPE::IVFFLAT) {
+      uint nlist = 0;
+      std::vector<float> centroids;
+      const GL_INDEX_ID gl_index_id{m_cf_handle->GetID(), m_index_id};
+      const auto *dict_manager =
+          rdb_get_dict_manager()->get_dict_manager_selector_const(
+              gl_index_id.cf_id);
+      if (dict_manager->get_vector_quantizer(gl_index_id, &generation, &nlist,
+                                             &centroids)) {
+        if (nlist != index_data->m_nlist ||
+            centroids.size() != index_data->m_quantizer_codes.size()) {
+          LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                          "Retrained centroids of index %d do not match the "
+                          "trained index, nlist %u",
+                          m_index_id, nlist);
+          return HA_ERR_ROCKSDB_CORRUPT_DATA;
+        }
+        index_data->m_quantizer_codes = std::move(centroids);
+      }
+    }
+
+    std::shared_ptr<Ivf_state> state;
+    const uint rtn = create_state(index_data.get(), generation, state);
+    if (rtn) {
+      return rtn;
+    }
+
+    // initialize the list size stats. does not allow resize here
+    // because atomic is not move insertable
+    m_list_size_stats =
+        std::vector<std::atomic<long>>(state->m_index_l2->nlist);
+    for (auto &list_size : m_list_size_stats) {
+      list_size.store(-1);
+    }
+    m_counted_total = 0;
+    m_counted_lists = 0;
+    // sizes counted before the restart, as long as the centroids are the same
+    uint64 sizes_generation = 0;
+    std::vector<int64_t> list_sizes;
+    const GL_INDEX_ID gl_index_id{m_cf_handle->GetID(), m_index_id};
+    if (rdb_get_dict_manager()
+            ->get_dict_manager_selector_const(gl_index_id.cf_id)
+            ->get_vector_list_sizes(gl_index_id, &sizes_generation,
+                                    &list_sizes) &&
+        sizes_generation == generation &&
+        list_sizes.size() == m_list_size_stats.size()) {
+      for (std::size_t i = 0; i < list_sizes.size(); i++) {
+        set_list_size(i, list_sizes[i]);
+      }
+    }
+    std::lock_guard<std::mutex> lock(m_state_mutex);
+    m_state = std::move(state);
+    return HA_EXIT_SUCCESS;
+  }
+
+  uint64_t search_candidates(uint k, uint nprobe,
+                             uint target_candidates) override {
+    // list sizes are unknown until the index is scanned
+    const int64_t counted_total = m_counted_total;
+    const int64_t counted_lists = m_counted_lists;
+    if (counted_total <= 0 || counted_lists <= 0) return 0;
+    // the lists not counted are assumed to have the average size
+    const int64_t nlist = m_list_size_stats.size();
+    const int64_t ntotal = counted_total * nlist / counted_lists;
+    uint64_t candidates =
+        target_candidates
+            ? target_candidates
+            : static_cast<uint64_t>(nprobe) * (ntotal / counted_lists);
+    candidates = std::max<uint64_t>(candidates, k);
+    // the query is also compared against every centroid
+    return std::min<uint64_t>(candidates, ntotal) + m_list_size_stats.size();
+  }
+
+  /**
+    the totals are kept as the sizes change, only the min, max and median
+    look at the sizes of the lists, none scans the index
+  */
+  Rdb_vector_index_info dump_info() override {
+    const auto state = current_state();
+    const int64_t counted_total = std::max<int64_t>(m_counted_total, 0);
+    const int64_t counted_lists = m_counted_lists;
+    std::optional<uint> min_list_size;
+    std::optional<uint> max_list_size;
+    std::vector<uint> list_size_stats;
+    list_size_stats.reserve(m_list_size_stats.size());
+    double sum_squares = 0;
+    for (const auto &list_size : m_list_size_stats) {
+      const auto list_size_value = list_size.load();
+      if (list_size_value >= 0) {
+        list_size_stats.push_back(list_size_value);
+        sum_squares += static_cast<double>(list_size_value) * list_size_value;
+        if (!min_list_size.has_value() ||
+            list_size_value < min_list_size.value()) {
+          min_list_size = list_size_value;
+        }
+        if (!max_list_size.has_value() ||
+            list_size_value > max_list_size.value()) {
+          max_list_size = list_size_value;
+        }
+      }
+    }
+    uint avg_list_size = counted_lists > 0 ? counted_total / counted_lists : 0;
+    int64_t ntotal = counted_total;
+    int64_t ntotal_low = counted_total;
+    int64_t ntotal_high = counted_total;
+    const int64_t nlist = m_list_size_stats.size();
+    if (counted_lists > 0 && counted_lists < nlist) {
+      // the counted lists are a random sample of all lists, see analyze()
+      const double mean = static_cast<double>(counted_total) / counted_lists;
+      const double variance =
+          counted_lists > 1
+              ? std::max(sum_squares - counted_lists * mean * mean, 0.0) /
+                    (counted_lists - 1)
+              : mean * mean;
+      const double estimate = nlist * mean;
+      // 95% confidence, with the finite population correction
+      const double error =
+          1.96 * nlist * std::sqrt(variance / counted_lists) *
+          std::sqrt(static_cast<double>(nlist - counted_lists) / (nlist - 1));
+      ntotal = std::llround(estimate);
+      ntotal_low =
+          std::max<int64_t>(std::llround(estimate - error), counted_total);
+      ntotal_high = std::llround(estimate + error);
+    }
+    // compute median value of list size
+    const auto median = list_size_stats.begin() + list_size_stats.size() / 2;
+    std::nth_element(list_size_stats.begin(), median, list_size_stats.end());
+    uint median_list_size = list_size_stats.empty() ? 0 : *median;
+    List_distance distance;
+    {
+      std::lock_guard<std::mutex> lock(m_distance_mutex);
+      if (m_distance_generation == state->m_generation) {
+        for (const auto &list_distance : m_list_distances) {
+          distance.merge(list_distance);
+        }
+      }
+    }
+    uint pq_m = 0;
+    uint pq_nbits = 0;
+    if (m_index_def.type() == FB_VECTOR_INDEX_TYPE::IVFPQ) {
+      faiss::IndexIVFPQ *index_ivfpq =
+          dynamic_cast<faiss::IndexIVFPQ *>(state->m_index_l2.get());
+      pq_m = index_ivfpq->pq.M;
+      pq_nbits = index_ivfpq->pq.nbits;
+    }
+    return {.m_ntotal = ntotal,
+            .m_hit = m_hit,
+            .m_code_size = state->m_index_l2->code_size,
+            .m_nlist = state->m_index_l2->nlist,
+            .m_pq_m = pq_m,
+            .m_pq_nbits = pq_nbits,
+            .m_min_list_size = min_list_size.value_or(0),
+            .m_max_list_size = max_list_size.value_or(0),
+            .m_avg_list_size = avg_list_size,
+            .m_median_list_size = median_list_size,
+            .m_counted_lists = static_cast<uint64_t>(counted_lists),
+            .m_ntotal_low = ntotal_low,
+            .m_ntotal_high = ntotal_high,
+            .m_min_centroid_distance = distance.m_min,
+            .m_max_centroid_distance = distance.m_max,
+            .m_avg_centroid_distance = distance.avg(),
+            .m_retrain_state = rdb_ivf_retrain_phase_name(m_retrain_phase),
+            .m_retrain_rows = m_retrain_rows};
+  }
+
+  std::vector<Rdb_vector_list_info> dump_lists() override {
+    const auto state = current_state();
+    std::vector<Rdb_vector_list_info> lists(m_list_size_stats.size());
+    for (std::size_t i = 0; i < lists.size(); i++) {
+      lists[i].m_list_no = i;
+      lists[i].m_size = m_list_size_stats[i].load();
+    }
+    std::lock_guard<std::mutex> lock(m_distance_mutex);
+    if (m_distance_generation == state->m_generation &&
+        m_list_distances.size() == lists.size()) {
+      for (std::size_t i = 0; i < lists.size(); i++) {
+        const List_distance &distance = m_list_distances[i];
+        lists[i].m_distance_count = distance.m_count;
+        lists[i].m_min_distance = distance.m_min;
+        lists[i].m_max_distance = distance.m_max;
+        lists[i].m_avg_distance = distance.avg();
+      }
+    }
+    return lists;
+  }
+
+  std::unique_ptr<Rdb_vector_compaction_stats> new_compaction_stats()
+      override {
+    auto state = current_state();
+    if (state == nullptr) {
+      return nullptr;
+    }
+    return std::make_unique<Compaction_stats>(*this, std::move(state));
+  }
+
+  /**
+    while a retrain runs, entries are mirrored into the generation being
+    built. writes that were assigned by the old centroids but raced with the
+    swap are mirrored into the new current generation the same way.
+  */
+  uint on_entry_update(Rdb_transaction *tx, rocksdb::WriteBatchBase *wb,
+                       const rocksdb::Slice &old_key,
+                       const rocksdb::Slice &old_value,
+                       const rocksdb::Slice &new_key,
+                       const rocksdb::Slice &new_value) override {
+    note_list_write(tx, old_key);
+    note_list_write(tx, new_key);
+    std::shared_ptr<const Ivf_state> states[2];
+    {
+      std::lock_guard<std::mutex> lock(m_state_mutex);
+      states[0] = m_state;
+      states[1] = m_shadow;
+    }
+    uint rtn = count_entry_update(*states[0], old_key, new_key);
     if (rtn) {
       return rtn;
     }
+    for (const auto &state : states) {
+      if (!state) {
+        continue;
+      }
+      if (!old_key.empty()) {
+        rtn = mirror_entry(tx, *state, wb, old_key, old_value,
+                           /* put */ false);
+        if (rtn) {
+          return rtn;
+        }
+      }
+      if (!new_key.empty()) {
+        rtn = mirror_entry(tx, *state, wb, new_key, new_value,
+                           /* put */ true);
+        if (rtn) {
+          return rtn;
+        }
+      }
+    }
+    return HA_EXIT_SUCCESS;
+  }
+
+  /**
+    only ivfflat is supported. its codes are the vectors themselves, so
+    entries can be assigned to new centroids from their stored value without
+    reading the rows. the steps are:
+      sampling  reservoir sample of the current generation
+      training  k-means on the sample, same nlist
+      backfill  entries are double written from now on, the ones written
+                before are copied to the new generation
+      swap      the centroids are persisted and queries switch over
+      cleanup   entries of the old generation are range deleted
+  */
+  uint retrain(THD *thd) override {
+    // entries of multi-vector rows are not single vectors to retrain on
+    if (m_index_def.type() != FB_VECTOR_INDEX_TYPE::IVFFLAT ||
+        m_index_def.multi()) {
+      return HA_ERR_UNSUPPORTED;
+    }
+    bool expected = false;
+    if (!m_retrain_running.compare_exchange_strong(expected, true)) {
+      LogPluginErrMsg(WARNING_LEVEL, ER_LOG_PRINTF_MSG,
+                      "Retrain of vector index %d is already running",
+                      m_index_id);
+      return HA_EXIT_FAILURE;
+    }
+    const uint rtn = retrain_generation(thd);
+    m_retrain_phase = rtn ? Rdb_ivf_retrain_phase::FAILED
+                          : Rdb_ivf_retrain_phase::DONE;
+    m_retrain_running = false;
+    // the lists of the old generation are not probed anymore
+    rdb_get_vector_list_cache().drop_index(m_index_id);
+    return rtn;
+  }
+
+ private:
+  /** distances of entries to the centroid of their list */
+  struct List_distance {
+    uint64_t m_count = 0;
+    double m_sum = 0;
+    float m_min = 0;
+    float m_max = 0;
+
+    void add(const float distance) {
+      m_min = m_count == 0 ? distance : std::min(m_min, distance);
+      m_max = m_count == 0 ? distance : std::max(m_max, distance);
+      m_sum += distance;
+      m_count++;
+    }
+
+    void merge(const List_distance &other) {
+      if (other.m_count == 0) {
+        return;
+      }
+      m_min = m_count == 0 ? other.m_min : std::min(m_min, other.m_min);
+      m_max = m_count == 0 ? other.m_max : std::max(m_max, other.m_max);
+      m_sum += other.m_sum;
+      m_count += other.m_count;
+    }
+
+    float avg() const { return m_count == 0 ? 0 : m_sum / m_count; }
+  };
+
+  /** faiss structures built from one set of centroids */
+  struct Ivf_state {
+    uint64 m_generation = 0;
+    // read only, may be shared with other indexes
+    std::shared_ptr<faiss::IndexFlatL2> m_quantizer;
+    std::unique_ptr<faiss::IndexIVF> m_index_l2;
+    std::unique_ptr<faiss::IndexIVF> m_index_ip;
+    std::unique_ptr<Rdb_faiss_inverted_list> m_inverted_list;
+
+    /** list id written in the keys of the entries of list_no */
+    uint64 list_key_id(const faiss::idx_t list_no) const {
+      return (m_generation << IVF_GENERATION_SHIFT) + list_no;
+    }
+  };
+
+  /**
+    decodes the codes of the entries a compaction keeps, by the centroids
+    current when the compaction started, and measures them against their
+    centroid. entries of other generations are skipped.
+  */
+  class Compaction_stats : public Rdb_vector_compaction_stats {
+   public:
+    Compaction_stats(Rdb_vector_index_ivf &index,
+                     std::shared_ptr<const Ivf_state> state)
+        : m_index(index),
+          m_state(std::move(state)),
+          m_code(m_state->m_index_l2->coarse_code_size() +
+                 m_state->m_index_l2->code_size),
+          m_vector(m_state->m_index_l2->d),
+          m_centroid(m_state->m_index_l2->d) {}
+
+    ~Compaction_stats() override {
+      m_index.merge_list_distances(m_state->m_generation, m_lists);
+    }
+
+    void add_entry(const rocksdb::Slice &key,
+                   const rocksdb::Slice &value) override {
+      constexpr uint64 list_no_mask = (1ULL << IVF_GENERATION_SHIFT) - 1;
+      const faiss::IndexIVF &index = *m_state->m_index_l2;
+      uint64 list_key_id;
+      if (read_inverted_list_key_id(key, &list_key_id) ||
+          (list_key_id >> IVF_GENERATION_SHIFT) != m_state->m_generation ||
+          static_cast<faiss::idx_t>(list_key_id & list_no_mask) >=
+              static_cast<faiss::idx_t>(index.nlist)) {
+        return;
+      }
+      const faiss::idx_t list_no = list_key_id & list_no_mask;
+
+      rocksdb::Slice codes;
+      const uint rtn =
+          m_index.m_index_def.multi()
+              ? split_multi_vector_entry_value(value, index.code_size, &codes,
+                                               nullptr)
+              : split_vector_entry_value(value, index.code_size, &codes,
+                                         nullptr);
+      if (rtn || index.code_size == 0 || codes.size() % index.code_size) {
+        return;
+      }
+
+      if (list_no != m_list_no) {
+        m_state->m_quantizer->reconstruct(list_no, m_centroid.data());
+        m_list_no = list_no;
+      }
+      const std::size_t coarse_size = index.coarse_code_size();
+      index.encode_listno(list_no, m_code.data());
+      List_distance &distance = m_lists[list_no];
+      for (std::size_t offset = 0; offset < codes.size();
+           offset += index.code_size) {
+        memcpy(m_code.data() + coarse_size, codes.data() + offset,
+               index.code_size);
+        index.sa_decode(1, m_code.data(), m_vector.data());
+        distance.add(std::sqrt(faiss::fvec_L2sqr(
+            m_vector.data(), m_centroid.data(), m_vector.size())));
+      }
+    }
+
+   private:
+    Rdb_vector_index_ivf &m_index;
+    const std::shared_ptr<const Ivf_state> m_state;
+    std::vector<uint8_t> m_code;
+    std::vector<float> m_vector;
+    std::vector<float> m_centroid;
+    faiss::idx_t m_list_no = -1;
+    std::unordered_map<faiss::idx_t, List_distance> m_lists;
+  };
+
+  Index_id m_index_id;
+  FB_vector_index_config m_index_def;
+  std::shared_ptr<rocksdb::ColumnFamilyHandle> m_cf_handle;
+  std::atomic<uint> m_hit{0};
+  // protects the pointers, the states themselves are immutable
+  mutable std::mutex m_state_mutex;
+  std::shared_ptr<const Ivf_state> m_state;
+  // generation being built by a retrain
+  std::shared_ptr<const Ivf_state> m_shadow;
+  std::vector<std::atomic<long>> m_list_size_stats;
+  // sum of the counted list sizes and number of counted lists, kept by
+  // set_list_size() and adjust_list_size()
+  std::atomic<int64_t> m_counted_total{0};
+  std::atomic<int64_t> m_counted_lists{0};
+  // distances to the centroids of generation m_distance_generation, per list
+  mutable std::mutex m_distance_mutex;
+  uint64 m_distance_generation = 0;
+  std::vector<List_distance> m_list_distances;
+  std::atomic<bool> m_retrain_running{false};
+  std::atomic<Rdb_ivf_retrain_phase> m_retrain_phase{
+      Rdb_ivf_retrain_phase::NONE};
+  std::atomic<uint64_t> m_retrain_rows{0};
+  // list size changes since the sizes were last written to the dictionary
+  std::atomic<uint64_t> m_list_size_updates{0};
+  std::mutex m_persist_mutex;
+
+  std::shared_ptr<const Ivf_state> current_state() const {
+    std::lock_guard<std::mutex> lock(m_state_mutex);
+    return m_state;
+  }
+
+  /**
+    the lists a compaction saw replace what earlier compactions found,
+    unless the centroids changed meanwhile
+  */
+  void merge_list_distances(
+      const uint64 generation,
+      const std::unordered_map<faiss::idx_t, List_distance> &lists) {
+    if (lists.empty() || current_state()->m_generation != generation) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(m_distance_mutex);
+    if (m_distance_generation != generation || m_list_distances.empty()) {
+      m_list_distances.assign(m_list_size_stats.size(), List_distance());
+      m_distance_generation = generation;
+    }
+    for (const auto &list : lists) {
+      if (static_cast<std::size_t>(list.first) < m_list_distances.size()) {
+        m_list_distances[list.first] = list.second;
+      }
+    }
+  }
+
+  void update_list_size_stats(const Rdb_faiss_inverted_list_context &context) {
+    constexpr uint64 list_no_mask = (1ULL << IVF_GENERATION_SHIFT) - 1;
+    for (const auto &list_size_entry : context.m_list_size_stats) {
+      set_list_size(list_size_entry.first & list_no_mask,
+                    list_size_entry.second);
+    }
+  }
+
+  /** counts the entries of list_no in the latest data */
+  uint count_list(const Ivf_state &state, const std::size_t list_no,
+                  std::atomic<THD::killed_state> *killed,
+                  uint64_t &count) const {
+    const uint64 list_key_id = state.list_key_id(list_no);
+    Rdb_string_writer lower_key_writer;
+    write_inverted_list_key(lower_key_writer, m_index_id, list_key_id);
+    Rdb_string_writer upper_key_writer;
+    write_inverted_list_key(upper_key_writer, m_index_id, list_key_id + 1);
+    const rocksdb::Slice lower_bound = lower_key_writer.to_slice();
+    const rocksdb::Slice upper_bound = upper_key_writer.to_slice();
+    rocksdb::ReadOptions read_options;
+    read_options.iterate_lower_bound = &lower_bound;
+    read_options.iterate_upper_bound = &upper_bound;
+    // a one off scan, keep the block cache for the queries
+    read_options.fill_cache = false;
+    std::unique_ptr<rocksdb::Iterator> iter(
+        rdb_get_rocksdb_db()->NewIterator(read_options, m_cf_handle.get()));
+    count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      if (killed && *killed) {
+        return HA_EXIT_FAILURE;
+      }
+      count++;
+    }
+    if (!iter->status().ok()) {
+      return ha_rocksdb::rdb_error_to_mysql(iter->status());
+    }
+    return HA_EXIT_SUCCESS;
+  }
+
+  /** counts list_no as size, -1 for uncounted, keeping the totals */
+  void set_list_size(const std::size_t list_no, const long size) {
+    const long old_size = m_list_size_stats[list_no].exchange(size);
+    if (old_size >= 0) {
+      m_counted_total -= old_size;
+      m_counted_lists--;
+    }
+    if (size >= 0) {
+      m_counted_total += size;
+      m_counted_lists++;
+    }
+  }
+
+  /**
+    lists in centroid distance order until their sizes add up to target.
+    lists never counted are assumed to have the average size of the counted
+    ones. returns false when target is 0 or no list was counted yet, the
+    caller then probes a fixed number of lists.
+  */
+  bool probe_lists_for_target(const Ivf_state &state, const float *query,
+                              const uint target,
+                              std::vector<faiss::idx_t> &list_ids,
+                              std::vector<float> &centroid_distances) const {
+    if (target == 0) {
+      return false;
+    }
+    const int64_t counted_total = std::max<int64_t>(m_counted_total, 0);
+    const int64_t counted_lists = m_counted_lists;
+    if (counted_lists <= 0) {
+      return false;
+    }
+    const uint64_t uncounted_size =
+        std::max<int64_t>(counted_total / counted_lists, 1);
+
+    const faiss::idx_t nlist = state.m_index_l2->nlist;
+    list_ids.resize(nlist);
+    centroid_distances.resize(nlist);
+    constexpr faiss::idx_t vector_count = 1;
+    state.m_quantizer->search(vector_count, query, nlist,
+                              centroid_distances.data(), list_ids.data());
+    uint64_t candidates = 0;
+    faiss::idx_t nprobe = 0;
+    while (nprobe < nlist && list_ids[nprobe] >= 0 && candidates < target) {
+      const auto list_size = m_list_size_stats[list_ids[nprobe]].load();
+      candidates += list_size >= 0 ? list_size : uncounted_size;
+      nprobe++;
+    }
+    list_ids.resize(nprobe);
+    centroid_distances.resize(nprobe);
+    return true;
+  }
+
+  void adjust_list_size(const std::size_t list_no, const long delta) {
+    auto &list_size = m_list_size_stats[list_no];
+    long list_size_value = list_size.load();
+    long new_size_value = 0;
+    // uncounted lists stay uncounted until analyze
+    do {
+      if (list_size_value < 0) {
+        return;
+      }
+      new_size_value = std::max(list_size_value + delta, 0L);
+    } while (
+        !list_size.compare_exchange_weak(list_size_value, new_size_value));
+    m_counted_total += new_size_value - list_size_value;
+  }
+
+  /**
+    keeps the list sizes current on writes. the sizes change when the
+    entry is written rather than when it commits, rollbacks leave them off
+    until the list is counted again.
+  */
+  uint count_entry_update(const Ivf_state &state, const rocksdb::Slice &old_key,
+                          const rocksdb::Slice &new_key) {
+    constexpr uint64 list_no_mask = (1ULL << IVF_GENERATION_SHIFT) - 1;
+    uint64_t updates = 0;
+    for (const auto &entry : {std::make_pair(&old_key, -1L),
+                              std::make_pair(&new_key, 1L)}) {
+      if (entry.first->empty()) {
+        continue;
+      }
+      uint64 list_key_id;
+      if (read_inverted_list_key_id(*entry.first, &list_key_id)) {
+        return HA_ERR_ROCKSDB_CORRUPT_DATA;
+      }
+      if ((list_key_id >> IVF_GENERATION_SHIFT) != state.m_generation ||
+          (list_key_id & list_no_mask) >= m_list_size_stats.size()) {
+        continue;
+      }
+      adjust_list_size(list_key_id & list_no_mask, entry.second);
+      updates++;
+    }
+    const uint64_t interval = std::max<uint64_t>(
+        IVF_LIST_SIZES_PERSIST_INTERVAL, m_list_size_stats.size());
+    if (updates > 0 && (m_list_size_updates += updates) >= interval) {
+      // a failed write is retried after the next interval
+      persist_list_sizes(state, /* wait */ false);
+    }
+    return HA_EXIT_SUCCESS;
+  }
+
+  /**
+    writes the list sizes to the dictionary. writers do not wait for
+    each other, whoever holds the lock writes the latest sizes anyway.
+  */
+  uint persist_list_sizes(const Ivf_state &state, const bool wait) {
+    std::unique_lock<std::mutex> lock(m_persist_mutex, std::defer_lock);
+    if (wait) {
+      lock.lock();
+    } else if (!lock.try_lock()) {
+      return HA_EXIT_SUCCESS;
+    }
+    m_list_size_updates = 0;
+    std::vector<int64_t> list_sizes;
+    list_sizes.reserve(m_list_size_stats.size());
+    for (const auto &list_size : m_list_size_stats) {
+      list_sizes.push_back(list_size.load());
+    }
+    const GL_INDEX_ID gl_index_id{m_cf_handle->GetID(), m_index_id};
+    const auto *dict_manager =
+        rdb_get_dict_manager()->get_dict_manager_selector_const(
+            gl_index_id.cf_id);
+    const std::unique_ptr<rocksdb::WriteBatch> wb = dict_manager->begin();
+    dict_manager->put_vector_list_sizes(wb.get(), gl_index_id,
+                                        state.m_generation, list_sizes);
+    if (dict_manager->commit(wb.get(), /* sync */ false)) {
+      LogPluginErrMsg(WARNING_LEVEL, ER_LOG_PRINTF_MSG,
+                      "Failed to persist list sizes of index %d", m_index_id);
+      return HA_EXIT_FAILURE;
+    }
+    return HA_EXIT_SUCCESS;
+  }
+
+  uint delete_vector_from_list(rocksdb::WriteBatchBase *write_batch,
+                               const uint64 list_id, const rocksdb::Slice &pk) {
+    Rdb_string_writer key_writer;
+    write_inverted_list_item_key(key_writer, m_index_id, list_id, pk);
+    auto status = write_batch->Delete(m_cf_handle.get(), key_writer.to_slice());
+    if (!status.ok()) {
+      LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                      "Failed to write codes for index %d", m_index_id);
+      return ha_rocksdb::rdb_error_to_mysql(status);
+    }
+    return HA_EXIT_SUCCESS;
+  }
+
+  uint64 get_list_id(const Ivf_state &state, const float *data) const {
+    if (state.m_index_l2->nlist == 1) {
+      return 0;
+    }
+    faiss::idx_t list_id = 0;
+    constexpr faiss::idx_t vector_count = 1;
+    state.m_index_l2->quantizer->assign(vector_count, data, &list_id);
+    return list_id;
+  }
+
+  /**
+    key of the entry under the centroids of state, empty when the entry
+    already belongs to that generation
+  */
+  uint rekey_entry(const Ivf_state &state, const rocksdb::Slice &key,
+                   const rocksdb::Slice &value, std::vector<float> &vector,
+                   Rdb_string_writer &key_writer) const {
+    key_writer.clear();
+    uint64 list_key_id;
+    if (read_inverted_list_key_id(key, &list_key_id)) {
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    if ((list_key_id >> IVF_GENERATION_SHIFT) == state.m_generation) {
+      return HA_EXIT_SUCCESS;
+    }
+    // only the raw ivfflat codes can be reassigned
+    assert(m_index_def.type() == FB_VECTOR_INDEX_TYPE::IVFFLAT);
+    rocksdb::Slice codes;
+    if (split_vector_entry_value(value, state.m_index_l2->code_size, &codes,
+                                 nullptr)) {
+      LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                      "Invalid value size %lu for key in index %d",
+                      value.size(), m_index_id);
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    vector.resize(dimension());
+    memcpy(vector.data(), codes.data(), codes.size());
+    const auto list_no = get_list_id(state, vector.data());
+    write_inverted_list_key(key_writer, m_index_id,
+                            state.list_key_id(list_no));
+    constexpr std::size_t prefix_size = INDEX_NUMBER_SIZE + sizeof(uint64);
+    key_writer.write(reinterpret_cast<const uchar *>(key.data()) + prefix_size,
+                     key.size() - prefix_size);
+    return HA_EXIT_SUCCESS;
+  }
+
+  /**
+    the list of key is not served from the list cache until tx ends
+  */
+  void note_list_write(Rdb_transaction *tx, const rocksdb::Slice &key) const {
+    uint64 list_key_id;
+    if (!key.empty() && !read_inverted_list_key_id(key, &list_key_id)) {
+      rdb_tx_note_vector_list_write(tx, m_index_id, list_key_id);
+    }
+  }
+
+  uint mirror_entry(Rdb_transaction *tx, const Ivf_state &state,
+                    rocksdb::WriteBatchBase *wb, const rocksdb::Slice &key,
+                    const rocksdb::Slice &value, const bool put) const {
+    std::vector<float> vector;
+    Rdb_string_writer key_writer;
+    const uint rtn = rekey_entry(state, key, value, vector, key_writer);
+    if (rtn || key_writer.get_current_pos() == 0) {
+      return rtn;
+    }
+    // the mirrored key can be put twice, by the backfill and by a write
+    const auto status =
+        put ? wb->Put(m_cf_handle.get(), key_writer.to_slice(), value)
+            : wb->Delete(m_cf_handle.get(), key_writer.to_slice());
+    if (!status.ok()) {
+      return ha_rocksdb::rdb_error_to_mysql(status);
+    }
+    note_list_write(tx, key_writer.to_slice());
+    return HA_EXIT_SUCCESS;
+  }
+
+  /**
+    visit every entry of a generation, thd is checked for kills when set
+  */
+  uint scan_generation(
+      THD *thd, const uint64 generation,
+      const std::function<uint(const rocksdb::Slice &, const rocksdb::Slice &)>
+          &visitor) const {
+    Rdb_string_writer lower_key_writer;
+    write_inverted_list_key(lower_key_writer, m_index_id,
+                            generation << IVF_GENERATION_SHIFT);
+    Rdb_string_writer upper_key_writer;
+    write_inverted_list_key(upper_key_writer, m_index_id,
+                            (generation + 1) << IVF_GENERATION_SHIFT);
+    const rocksdb::Slice lower_bound = lower_key_writer.to_slice();
+    const rocksdb::Slice upper_bound = upper_key_writer.to_slice();
+    rocksdb::ReadOptions read_options;
+    read_options.iterate_lower_bound = &lower_bound;
+    read_options.iterate_upper_bound = &upper_bound;
+    std::unique_ptr<rocksdb::Iterator> iter(
+        rdb_get_rocksdb_db()->NewIterator(read_options, m_cf_handle.get()));
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      if (thd && thd->killed) {
+        return HA_ERR_QUERY_INTERRUPTED;
+      }
+      const uint rtn = visitor(iter->key(), iter->value());
+      if (rtn) {
+        return rtn;
+      }
+    }
+    if (!iter->status().ok()) {
+      return ha_rocksdb::rdb_error_to_mysql(iter->status());
+    }
+    return HA_EXIT_SUCCESS;
+  }
+
+  /**
+    hide every entry of a generation behind one range delete instead of a
+    tombstone per entry. once the generation is retired in the dictionary
+    the compaction filter drops its entries as it meets them.
+  */
+  uint delete_generation(const uint64 generation) {
+    Rdb_string_writer begin_key_writer;
+    write_inverted_list_key(begin_key_writer, m_index_id,
+                            generation << IVF_GENERATION_SHIFT);
+    Rdb_string_writer end_key_writer;
+    write_inverted_list_key(end_key_writer, m_index_id,
+                            (generation + 1) << IVF_GENERATION_SHIFT);
+    rocksdb::Slice begin_key = begin_key_writer.to_slice();
+    rocksdb::Slice end_key = end_key_writer.to_slice();
+    if (m_cf_handle->GetComparator()->Compare(begin_key, end_key) > 0) {
+      std::swap(begin_key, end_key);
+    }
+    rocksdb::WriteBatch batch;
+    auto status = batch.DeleteRange(m_cf_handle.get(), begin_key, end_key);
+    if (status.ok()) {
+      status = rdb_get_rocksdb_db()->Write(rocksdb::WriteOptions(), &batch);
+    }
+    return status.ok() ? HA_EXIT_SUCCESS
+                       : ha_rocksdb::rdb_error_to_mysql(status);
+  }
+
+  /**
+    wait for the transactions writing to the index when the shadow was
+    published to end. they wrote their entries to the current generation
+    only, the backfill, which starts once they are committed, copies them.
+    transactions writing later see the shadow and double write.
+    the wait is bounded by lock_wait_timeout, as a metadata lock is.
+  */
+  uint wait_for_writers(THD *thd) const {
+    const auto &list_cache = rdb_get_vector_list_cache();
+    const auto lists = list_cache.writing_lists(m_index_id);
+    const auto deadline =
+        std::chrono::steady_clock::now() +
+        std::chrono::seconds(thd ? thd->variables.lock_wait_timeout
+                                 : LONG_TIMEOUT);
+    while (!list_cache.writers_ended(m_index_id, lists)) {
+      if (thd && thd->killed) {
+        return HA_ERR_QUERY_INTERRUPTED;
+      }
+      if (std::chrono::steady_clock::now() >= deadline) {
+        return HA_ERR_LOCK_WAIT_TIMEOUT;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return HA_EXIT_SUCCESS;
+  }
+
+  /**
+    copies the entries of current to next and counts the copies per list.
+    an entry deleted between the scan and the copy is caught by reading its
+    source key again once the copies are written, later deletes remove the
+    copy themselves.
+  */
+  uint backfill(THD *thd, const Ivf_state &current, const Ivf_state &next,
+                std::vector<int64_t> &list_sizes) {
+    constexpr uint64 list_no_mask = (1ULL << IVF_GENERATION_SHIFT) - 1;
+    list_sizes.assign(next.m_index_l2->nlist, 0);
+    rocksdb::WriteBatch batch;
+    std::vector<std::pair<std::string, std::string>> copied;
+    std::vector<float> vector;
+    Rdb_string_writer key_writer;
+    const auto flush = [&]() -> uint {
+      auto status =
+          rdb_get_rocksdb_db()->Write(rocksdb::WriteOptions(), &batch);
+      batch.Clear();
+      if (!status.ok()) {
+        return ha_rocksdb::rdb_error_to_mysql(status);
+      }
+      rocksdb::PinnableSlice value;
+      for (const auto &entry : copied) {
+        value.Reset();
+        status = rdb_get_rocksdb_db()->Get(rocksdb::ReadOptions(),
+                                           m_cf_handle.get(), entry.first,
+                                           &value);
+        if (status.IsNotFound()) {
+          status = batch.Delete(m_cf_handle.get(), entry.second);
+          uint64 list_key_id = 0;
+          read_inverted_list_key_id(entry.second, &list_key_id);
+          list_sizes[list_key_id & list_no_mask]--;
+        }
+        if (!status.ok()) {
+          return ha_rocksdb::rdb_error_to_mysql(status);
+        }
+      }
+      copied.clear();
+      if (batch.Count() == 0) {
+        return HA_EXIT_SUCCESS;
+      }
+      status = rdb_get_rocksdb_db()->Write(rocksdb::WriteOptions(), &batch);
+      batch.Clear();
+      return status.ok() ? HA_EXIT_SUCCESS
+                         : ha_rocksdb::rdb_error_to_mysql(status);
+    };
+    uint rtn = scan_generation(
+        thd, current.m_generation,
+        [&](const rocksdb::Slice &key, const rocksdb::Slice &value) -> uint {
+          const uint rekey_rtn =
+              rekey_entry(next, key, value, vector, key_writer);
+          if (rekey_rtn) {
+            return rekey_rtn;
+          }
+          const auto status =
+              batch.Put(m_cf_handle.get(), key_writer.to_slice(), value);
+          if (!status.ok()) {
+            return ha_rocksdb::rdb_error_to_mysql(status);
+          }
+          uint64 list_key_id = 0;
+          read_inverted_list_key_id(key_writer.to_slice(), &list_key_id);
+          list_sizes[list_key_id & list_no_mask]++;
+          copied.emplace_back(key.ToString(),
+                              key_writer.to_slice().ToString());
+          if (++m_retrain_rows % IVF_RETRAIN_BATCH_SIZE == 0) {
+            return flush();
+          }
+          return HA_EXIT_SUCCESS;
+        });
+    if (rtn) {
+      return rtn;
+    }
+    return flush();
+  }
+
+  uint retrain_generation(THD *thd) {
+    const auto current = current_state();
+    const std::size_t d = dimension();
+    const std::size_t nlist = current->m_index_l2->nlist;
+    const std::size_t code_size = current->m_index_l2->code_size;
+
+    m_retrain_phase = Rdb_ivf_retrain_phase::SAMPLING;
+    m_retrain_rows = 0;
+    const std::size_t max_samples =
+        std::max(nlist, IVF_RETRAIN_SAMPLE_BYTES / code_size);
+    std::vector<float> samples;
+    std::size_t nsamples = 0;
+    uint64 nseen = 0;
+    std::mt19937_64 rng(m_index_id + current->m_generation);
+    uint rtn = scan_generation(
+        thd, current->m_generation,
+        [&](const rocksdb::Slice &, const rocksdb::Slice &value) -> uint {
+          rocksdb::Slice codes;
+          if (split_vector_entry_value(value, code_size, &codes, nullptr)) {
+            LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                            "Invalid value size %lu for key in index %d",
+                            value.size(), m_index_id);
+            return HA_ERR_ROCKSDB_CORRUPT_DATA;
+          }
+          std::size_t slot = nsamples;
+          if (nsamples < max_samples) {
+            nsamples++;
+            samples.resize(nsamples * d);
+          } else {
+            slot = std::uniform_int_distribution<uint64>(0, nseen)(rng);
+          }
+          if (slot < max_samples) {
+            memcpy(samples.data() + slot * d, codes.data(), code_size);
+          }
+          nseen++;
+          m_retrain_rows++;
+          return HA_EXIT_SUCCESS;
+        });
+    if (rtn) {
+      return rtn;
+    }
+    if (nsamples < nlist) {
+      LogPluginErrMsg(WARNING_LEVEL, ER_LOG_PRINTF_MSG,
+                      "Index %d has %lu vectors, at least %lu are needed to "
+                      "retrain its centroids",
+                      m_index_id, nsamples, nlist);
+      return HA_EXIT_FAILURE;
+    }
+
+    m_retrain_phase = Rdb_ivf_retrain_phase::TRAINING;
+    Rdb_vector_index_data index_data;
+    index_data.m_nlist = nlist;
+    try {
+      faiss::Clustering clustering(d, nlist);
+      faiss::IndexFlatL2 assigner(d);
+      clustering.train(nsamples, samples.data(), assigner);
+      index_data.m_quantizer_codes = std::move(clustering.centroids);
+    } catch (const std::exception &e) {
+      LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                      "Failed to train centroids for index %d. %s",
+                      m_index_id, e.what());
+      return HA_EXIT_FAILURE;
+    }
+    samples = {};
+
+    std::shared_ptr<Ivf_state> next;
+    rtn = create_state(&index_data, current->m_generation + 1, next);
+    if (rtn) {
+      return rtn;
+    }
+
+    // writes from here on are double written by on_entry_update
+    m_retrain_phase = Rdb_ivf_retrain_phase::BACKFILL;
+    m_retrain_rows = 0;
+    {
+      std::lock_guard<std::mutex> lock(m_state_mutex);
+      m_shadow = next;
+    }
+    std::vector<int64_t> list_sizes;
+    rtn = wait_for_writers(thd);
+    if (!rtn) {
+      rtn = backfill(thd, *current, *next, list_sizes);
+    }
+    if (rtn) {
+      {
+        std::lock_guard<std::mutex> lock(m_state_mutex);
+        m_shadow.reset();
+      }
+      delete_generation(next->m_generation);
+      return rtn;
+    }
+
+    m_retrain_phase = Rdb_ivf_retrain_phase::SWAP;
+    const GL_INDEX_ID gl_index_id{m_cf_handle->GetID(), m_index_id};
+    auto *dict_manager =
+        rdb_get_dict_manager()->get_dict_manager_selector_non_const(
+            gl_index_id.cf_id);
+    const std::unique_ptr<rocksdb::WriteBatch> wb = dict_manager->begin();
+    dict_manager->put_vector_quantizer(wb.get(), gl_index_id,
+                                       next->m_generation, nlist,
+                                       index_data.m_quantizer_codes);
+    if (dict_manager->commit(wb.get())) {
+      {
+        std::lock_guard<std::mutex> lock(m_state_mutex);
+        m_shadow.reset();
+      }
+      delete_generation(next->m_generation);
+      return HA_EXIT_FAILURE;
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_state_mutex);
+      m_state = next;
+      m_shadow.reset();
+    }
+    // writes double written during the backfill are not in the counts,
+    // they are picked up by the next analyze or search of the list
+    for (std::size_t i = 0; i < list_sizes.size(); i++) {
+      set_list_size(i, std::max<int64_t>(list_sizes[i], 0));
+    }
+    persist_list_sizes(*next, /* wait */ true);
+
+    m_retrain_phase = Rdb_ivf_retrain_phase::CLEANUP;
+    m_retrain_rows = 0;
+    return delete_generation(current->m_generation);
+  }
+
+  uint create_state(Rdb_vector_index_data *index_data, const uint64 generation,
+                    std::shared_ptr<Ivf_state> &state) {
+    auto new_state = std::make_shared<Ivf_state>();
+    new_state->m_generation = generation;
+    uint rtn = setup_quantizer(*new_state, index_data);
+    if (rtn) {
+      return rtn;
+    }
+
+    rtn = create_index(*new_state, new_state->m_index_l2, index_data,
+                       faiss::METRIC_L2);
+    if (rtn) {
+      return rtn;
+    }
+    rtn = create_index(*new_state, new_state->m_index_ip, index_data,
+                       faiss::METRIC_INNER_PRODUCT);
+    if (rtn) {
+      return rtn;
+    }
+
+    // create inverted list
+    new_state->m_inverted_list = std::make_unique<Rdb_faiss_inverted_list>(
+        m_index_id, *m_cf_handle, new_state->m_index_l2->nlist,
+        new_state->m_index_l2->code_size, new_state->list_key_id(0));
+    new_state->m_index_l2->replace_invlists(new_state->m_inverted_list.get());
+    new_state->m_index_ip->replace_invlists(new_state->m_inverted_list.get());
+    state = std::move(new_state);
+    return HA_EXIT_SUCCESS;
+  }
+
+  uint setup_quantizer(Ivf_state &state, Rdb_vector_index_data *index_data) {
+    const auto total_code_size =
+        index_data->m_quantizer_codes.size() * sizeof(float);
+    const auto ncentroids = index_data->m_nlist;
+    if (total_code_size !=
+        ncentroids * m_index_def.dimension() * sizeof(float)) {
+      LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
+                      "Invalid codes, total code size %lu.", total_code_size);
+      return HA_EXIT_FAILURE;
+    }
+    state.m_quantizer = rdb_get_ivf_quantizer_store().get(
+        m_index_def.dimension(), index_data->m_quantizer_codes);
+    return HA_EXIT_SUCCESS;
+  }
+
+  uint create_index(Ivf_state &state, std::unique_ptr<faiss::IndexIVF> &index,
+                    Rdb_vector_index_data *index_data,
+                    faiss::MetricType metric_type) {
+    const auto ncentroids = index_data->m_nlist;
+    if (m_index_def.type() == FB_VECTOR_INDEX_TYPE::FLAT ||
+        m_index_def.type() == FB_VECTOR_INDEX_TYPE::IVFFLAT) {
+      index = std::make_unique<faiss::IndexIVFFlat>(
+          state.m_quantizer.get(), m_index_def.dimension(), ncentroids,
+          metric_type);
+    } else if (m_index_def.type() == FB_VECTOR_INDEX_TYPE::IVFSQ8 ||
+               m_index_def.type() == FB_VECTOR_INDEX_TYPE::IVFFP16) {
+      index = create_sq_index(state, index_data, metric_type);
+    } else {
+      auto ivfpq_index = std::make_unique<faiss::IndexIVFPQ>(
+          state.m_quantizer.get(), m_index_def.dimension(), ncentroids,
+          index_data->m_pq_m, index_data->m_pq_nbits, metric_type);
+      // pq centroids is already resized to the correct size
+      if (ivfpq_index->pq.centroids.size() != index_data->m_pq_codes.size()) {
+        LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
+                        "Invalid pq codes, expected code size %lu.",
+                        ivfpq_index->pq.centroids.size());
+        return HA_EXIT_FAILURE;
+      }
+
+      ivfpq_index->pq.centroids = index_data->m_pq_codes;
+      ivfpq_index->precompute_table();
+      // only the l2 view has a table, nlist * pq m * 2^nbits floats
+      rdb_advise_huge_pages(ivfpq_index->precomputed_table.data(),
+                            ivfpq_index->precomputed_table.size() *
+                                sizeof(float));
+
+      index = std::move(ivfpq_index);
+    }
+    index->is_trained = true;
+    return HA_EXIT_SUCCESS;
+  }
+
+  /**
+    codes encode the vectors themselves rather than residuals, so the l2 and
+    ip indexes share them and the 8 bit ranges can come from the trained
+    table. without trained ranges they are taken from the centroids, values
+    outside of them are clamped and fixed up by the re-rank.
+  */
+  std::unique_ptr<faiss::IndexIVF> create_sq_index(
+      Ivf_state &state, Rdb_vector_index_data *index_data,
+      faiss::MetricType metric_type) {
+    const bool is_fp16 = m_index_def.type() == FB_VECTOR_INDEX_TYPE::IVFFP16;
+    auto sq_index = std::make_unique<faiss::IndexIVFScalarQuantizer>(
+        state.m_quantizer.get(), m_index_def.dimension(), index_data->m_nlist,
+        is_fp16 ? faiss::ScalarQuantizer::QT_fp16
+                : faiss::ScalarQuantizer::QT_8bit,
+        metric_type, /* by_residual */ false);
+    if (!is_fp16) {
+      if (index_data->m_sq_codes.empty()) {
+        sq_index->sq.train(index_data->m_nlist,
+                           index_data->m_quantizer_codes.data());
+      } else {
+        sq_index->sq.trained = index_data->m_sq_codes;
+      }
+    }
+    return sq_index;
+  }
+};
+
+/**
+  graph index layout. every key lives under the index id and starts with
+  the write_inverted_list_key prefix:
+    GRAPH_VECTOR_LIST_ID + node id    secondary key entry, the codes are the
+                                      raw vector
+    GRAPH_NEIGHBOR_LIST_ID + node id  out edges of the node
+    GRAPH_ENTRY_LIST_ID               node id of the search entry point
+  the node id is the primary key tuple without its index id.
+*/
+constexpr faiss_ivf_list_id GRAPH_VECTOR_LIST_ID = 0;
+constexpr faiss_ivf_list_id GRAPH_NEIGHBOR_LIST_ID = 1;
+constexpr faiss_ivf_list_id GRAPH_ENTRY_LIST_ID = 2;
+// max out degree of a node
+constexpr uint GRAPH_MAX_DEGREE = 32;
+// beam width used to find the neighbors of a new node
+constexpr uint GRAPH_BUILD_BEAM = 64;
+// beam width of a search when fb_vector_search_nprobe is not set
+constexpr uint GRAPH_SEARCH_BEAM = 64;
+// an edge to c is pruned when a kept neighbor is alpha times closer to c
+constexpr float GRAPH_PRUNE_ALPHA = 1.2f;
+// nodes linked per write batch when populating a new index
+constexpr uint GRAPH_POPULATE_BATCH_SIZE = 1024;
+
+/**
+  point reads and writes of graph keys
+*/
+class Rdb_vector_graph_store {
+ public:
+  virtual ~Rdb_vector_graph_store() = default;
+  virtual rocksdb::Status get(rocksdb::ColumnFamilyHandle &cf,
+                              const rocksdb::Slice &key,
+                              rocksdb::PinnableSlice *value) = 0;
+  virtual rocksdb::WriteBatchBase *write_batch() = 0;
+};
+
+/**
+  reads through the transaction, so a statement sees the graph keys it
+  wrote itself, and writes into the batch the row is written to
+*/
+class Rdb_vector_graph_tx_store : public Rdb_vector_graph_store {
+ public:
+  Rdb_vector_graph_tx_store(Rdb_transaction *tx, rocksdb::WriteBatchBase *wb)
+      : m_tx(tx), m_write_batch(wb) {}
+
+  rocksdb::Status get(rocksdb::ColumnFamilyHandle &cf,
+                      const rocksdb::Slice &key,
+                      rocksdb::PinnableSlice *value) override {
+    return rdb_tx_get(m_tx, cf, key, value, TABLE_TYPE::USER_TABLE);
+  }
+
+  rocksdb::WriteBatchBase *write_batch() override { return m_write_batch; }
+
+ private:
+  Rdb_transaction *m_tx;
+  rocksdb::WriteBatchBase *m_write_batch;
+};
+
+/**
+  used when populating a bulk loaded index outside of any transaction.
+  writes are buffered in an indexed batch so later nodes see the edges of
+  earlier ones, and the batch is flushed every few nodes to bound memory.
+*/
+class Rdb_vector_graph_batch_store : public Rdb_vector_graph_store {
+ public:
+  Rdb_vector_graph_batch_store()
+      : m_batch(rocksdb::BytewiseComparator(), 0, /* overwrite_key */ true) {}
+
+  rocksdb::Status get(rocksdb::ColumnFamilyHandle &cf,
+                      const rocksdb::Slice &key,
+                      rocksdb::PinnableSlice *value) override {
+    value->Reset();
+    return m_batch.GetFromBatchAndDB(rdb_get_rocksdb_db(), m_read_options,
+                                     &cf, key, value);
+  }
+
+  rocksdb::WriteBatchBase *write_batch() override { return &m_batch; }
+
+  rocksdb::Status flush() {
+    const auto status = rdb_get_rocksdb_db()->Write(rocksdb::WriteOptions(),
+                                                    m_batch.GetWriteBatch());
+    m_batch.Clear();
+    return status;
+  }
+
+ private:
+  rocksdb::WriteBatchWithIndex m_batch;
+  rocksdb::ReadOptions m_read_options;
+};
+
+/**
+  iterate keys collected up front
+*/
+class Rdb_vector_key_list_iterator : public Rdb_vector_db_iterator {
+ public:
+  explicit Rdb_vector_key_list_iterator(std::vector<std::string> &&keys)
+      : m_keys(std::move(keys)) {}
+
+  bool is_available() override { return m_pos < m_keys.size(); }
+
+  void next() override { m_pos++; }
+
+  uint get_key(std::string &key) override {
+    key = m_keys[m_pos];
+    return HA_EXIT_SUCCESS;
+  }
+
+ private:
+  std::vector<std::string> m_keys;
+  std::size_t m_pos = 0;
+};
+
+/**
+  proximity graph index in the style of vamana/diskann. nodes are the
+  secondary key entries, each keeps at most GRAPH_MAX_DEGREE out edges
+  chosen by robust pruning, and a search is a greedy beam search from a
+  single entry point. a search only reads the nodes it visits, so its cost
+  depends on the beam width rather than on the number of vectors.
+
+  the graph is maintained by the write path: a new node is linked to the
+  nodes found by a beam search on its vector and gets back edges from them,
+  a deleted node hands its edges over to its neighbors. edges left pointing
+  at deleted nodes are skipped at read time.
+*/
+class Rdb_vector_index_graph : public Rdb_vector_index {
+ public:
+  Rdb_vector_index_graph(const FB_vector_index_config index_def,
+                         std::shared_ptr<rocksdb::ColumnFamilyHandle> cf_handle,
+                         const Index_id index_id)
+      : m_index_id{index_id},
+        m_index_def{index_def},
+        m_cf_handle{cf_handle} {}
+
+  ~Rdb_vector_index_graph() override = default;
+
+  void assign_vector(const float *data,
+                     Rdb_vector_index_assignment &assignment) override {
+    assignment.m_list_id = GRAPH_VECTOR_LIST_ID;
+    assignment.m_codes.assign(reinterpret_cast<const char *>(data),
+                              code_size());
+  }
+
+  uint knn_search(
+      THD *thd, const TABLE *const tbl, Item *pk_index_cond,
+      const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
+      Rdb_vector_search_params &params, Rdb_vector_result &result) override {
+    m_hit++;
+    result.clear();
+    Rdb_transaction *const tx = get_tx_from_thd(thd);
+    if (tx == nullptr) {
+      return HA_EXIT_FAILURE;
+    }
+    rdb_tx_acquire_snapshot(tx);
+    Rdb_vector_graph_tx_store store(tx, nullptr);
+
+    // nprobe is the beam width for graph indexes
+    const uint beam_width = std::max(
+        params.m_k, params.m_nprobe ? params.m_nprobe : GRAPH_SEARCH_BEAM);
+    std::vector<Graph_node> beam;
+    uint rtn = beam_search(store, thd, query_vector.data(), params.m_metric,
+                           m_index_def.normalized(), beam_width, beam);
+    if (rtn) {
+      return rtn;
+    }
+
+    const bool similarity = params.m_metric == FB_VECTOR_INDEX_METRIC::IP ||
+                            params.m_metric == FB_VECTOR_INDEX_METRIC::COSINE;
+    for (const auto &node : beam) {
+      if (result.size() >= params.m_k) {
+        break;
+      }
+      std::string key = node_key(GRAPH_VECTOR_LIST_ID, node.m_id);
+      if (pk_index_cond) {
+        bool match = false;
+        rtn = match_pk_cond(store, tbl, pk_index_cond, sk_descr, key, &match);
+        if (rtn) {
+          return rtn;
+        }
+        if (!match) {
+          continue;
+        }
+      }
+      // scores of similarities are negated, see rdb_vector_row_score
+      result.emplace_back(std::move(key),
+                          similarity ? -node.m_score : node.m_score);
+    }
+    return HA_EXIT_SUCCESS;
+  }
+
+  /**
+    the iterator returns the nodes of a wide beam, ordered by the metric
+    the index was built for, the caller sorts them by the query metric
+  */
+  uint index_scan(THD *thd, const TABLE *const tbl, Item *pk_index_cond,
+                  const Rdb_key_def *sk_descr,
+                  std::vector<float> &query_vector,
+                  const Rdb_vector_search_params &params,
+                  std::unique_ptr<Rdb_vector_db_iterator>
+                      &index_scan_result_iter) override {
+    m_hit++;
+    Rdb_transaction *const tx = get_tx_from_thd(thd);
+    if (tx == nullptr) {
+      return HA_EXIT_FAILURE;
+    }
+    rdb_tx_acquire_snapshot(tx);
+    Rdb_vector_graph_tx_store store(tx, nullptr);
+
+    const uint beam_width = std::max(params.m_nprobe, 1U) * GRAPH_SEARCH_BEAM;
+    const auto metric = m_index_def.normalized()
+                            ? FB_VECTOR_INDEX_METRIC::COSINE
+                            : FB_VECTOR_INDEX_METRIC::L2;
+    std::vector<Graph_node> beam;
+    uint rtn = beam_search(store, thd, query_vector.data(), metric,
+                           m_index_def.normalized(), beam_width, beam);
+    if (rtn) {
+      return rtn;
+    }
+
+    std::vector<std::string> keys;
+    keys.reserve(beam.size());
+    for (const auto &node : beam) {
+      std::string key = node_key(GRAPH_VECTOR_LIST_ID, node.m_id);
+      if (pk_index_cond) {
+        bool match = false;
+        rtn = match_pk_cond(store, tbl, pk_index_cond, sk_descr, key, &match);
+        if (rtn) {
+          return rtn;
+        }
+        if (!match) {
+          continue;
+        }
+      }
+      keys.push_back(std::move(key));
+    }
+    index_scan_result_iter.reset(
+        new Rdb_vector_key_list_iterator(std::move(keys)));
+    return HA_EXIT_SUCCESS;
+  }
+
+  uint analyze(THD *thd, uint64_t max_num_rows_scanned,
+               std::atomic<THD::killed_state> *killed) override {
+    // the scan reads through a transaction, left to ANALYZE TABLE
+    if (!thd) {
+      return HA_EXIT_SUCCESS;
+    }
+    std::string key;
+    rocksdb::Slice codes;
+    int64_t ntotal = 0;
+    Rdb_faiss_inverted_list_context context(thd, nullptr, nullptr, nullptr);
+    Rdb_vector_iterator vector_iter(&context, m_index_id, *m_cf_handle,
+                                    code_size(), GRAPH_VECTOR_LIST_ID);
+    while (vector_iter.is_available()) {
+      uint rtn = vector_iter.get_key_and_codes(key, codes);
+      if (rtn) {
+        return rtn;
+      }
+      ntotal++;
+      if (max_num_rows_scanned > 0 &&
+          static_cast<uint64_t>(ntotal) > max_num_rows_scanned) {
+        break;
+      }
+      if (killed && *killed) {
+        return HA_EXIT_FAILURE;
+      }
+      vector_iter.next();
+    }
+    m_ntotal = ntotal;
+    return HA_EXIT_SUCCESS;
+  }
+
+  Rdb_vector_index_info dump_info() override {
+    return {.m_ntotal = m_ntotal, .m_hit = m_hit, .m_code_size = code_size()};
+  }
+
+  uint64_t search_candidates(uint k, uint nprobe,
+                             uint target_candidates [[maybe_unused]]) override {
+    // every node taken off the beam has up to GRAPH_MAX_DEGREE neighbors
+    // scored
+    const uint64_t visited =
+        static_cast<uint64_t>(std::max(k, nprobe)) * GRAPH_MAX_DEGREE;
+    const int64_t ntotal = m_ntotal.load();
+    return ntotal > 0 ? std::min<uint64_t>(visited, ntotal) : visited;
+  }
+
+  FB_vector_dimension dimension() const override {
+    return m_index_def.dimension();
+  }
+
+  const FB_vector_index_config &get_config() const override {
+    return m_index_def;
+  }
+
+  uint on_entry_update(Rdb_transaction *tx, rocksdb::WriteBatchBase *wb,
+                       const rocksdb::Slice &old_key,
+                       const rocksdb::Slice &old_value [[maybe_unused]],
+                       const rocksdb::Slice &new_key,
+                       const rocksdb::Slice &new_value) override {
+    Rdb_vector_graph_tx_store store(tx, wb);
+    std::string node_id;
+    uint rtn;
+    if (!old_key.empty()) {
+      rtn = read_node_id(old_key, node_id);
+      if (rtn) {
+        return rtn;
+      }
+      rtn = unlink(store, node_id);
+      if (rtn) {
+        return rtn;
+      }
+    }
+    if (new_key.empty()) {
+      return HA_EXIT_SUCCESS;
+    }
+
+    rtn = read_node_id(new_key, node_id);
+    if (rtn) {
+      return rtn;
+    }
+    rocksdb::Slice codes;
+    if (split_vector_entry_value(new_value, code_size(), &codes, nullptr)) {
+      LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                      "Invalid value size %lu for key in index %d",
+                      new_value.size(), m_index_id);
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    std::vector<float> vector(dimension());
+    memcpy(vector.data(), codes.data(), code_size());
+    return link(store, nullptr, node_id, vector);
+  }
+
+  uint populate(THD *thd) override {
+    Rdb_vector_graph_batch_store store;
+    const std::string lower_key = node_key(GRAPH_VECTOR_LIST_ID, {});
+    const std::string upper_key = node_key(GRAPH_VECTOR_LIST_ID + 1, {});
+    const rocksdb::Slice lower_bound(lower_key);
+    const rocksdb::Slice upper_bound(upper_key);
+    rocksdb::ReadOptions read_options;
+    read_options.iterate_lower_bound = &lower_bound;
+    read_options.iterate_upper_bound = &upper_bound;
+    std::unique_ptr<rocksdb::Iterator> iter(
+        rdb_get_rocksdb_db()->NewIterator(read_options, m_cf_handle.get()));
+
+    std::string node_id;
+    std::vector<float> vector(dimension());
+    uint linked = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      if (thd && thd->killed) {
+        return HA_ERR_QUERY_INTERRUPTED;
+      }
+      uint rtn = read_node_id(iter->key(), node_id);
+      if (rtn) {
+        return rtn;
+      }
+      rocksdb::Slice codes;
+      if (split_vector_entry_value(iter->value(), code_size(), &codes,
+                                   nullptr)) {
+        LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                        "Invalid value size %lu for key in index %d",
+                        iter->value().size(), m_index_id);
+        return HA_ERR_ROCKSDB_CORRUPT_DATA;
+      }
+      memcpy(vector.data(), codes.data(), code_size());
+      rtn = link(store, thd, node_id, vector);
+      if (rtn) {
+        return rtn;
+      }
+      if (++linked % GRAPH_POPULATE_BATCH_SIZE == 0) {
+        const auto status = store.flush();
+        if (!status.ok()) {
+          return ha_rocksdb::rdb_error_to_mysql(status);
+        }
+      }
+    }
+    if (!iter->status().ok()) {
+      return ha_rocksdb::rdb_error_to_mysql(iter->status());
+    }
+    const auto status = store.flush();
+    if (!status.ok()) {
+      return ha_rocksdb::rdb_error_to_mysql(status);
+    }
+    m_ntotal = linked;
+    return HA_EXIT_SUCCESS;
+  }
+
+ private:
+  struct Graph_node {
+    // rdb_vector_row_score of the node, smaller is closer
+    float m_score;
+    std::string m_id;
+    std::vector<float> m_vector;
+    bool m_expanded = false;
+  };
+
+  Index_id m_index_id;
+  FB_vector_index_config m_index_def;
+  std::shared_ptr<rocksdb::ColumnFamilyHandle> m_cf_handle;
+  std::atomic<uint> m_hit{0};
+  std::atomic<int64_t> m_ntotal{0};
+
+  std::size_t code_size() const { return dimension() * sizeof(float); }
+
+  std::string node_key(const faiss_ivf_list_id list_id,
+                       const rocksdb::Slice &node_id) const {
+    Rdb_string_writer writer;
+    write_inverted_list_key(writer, m_index_id, list_id);
+    writer.write_slice(node_id);
+    return writer.to_slice().ToString();
+  }
+
+  uint read_node_id(const rocksdb::Slice &key, std::string &node_id) const {
+    Rdb_string_reader reader(&key);
+    uint rtn = read_inverted_list_key(reader, m_index_id, GRAPH_VECTOR_LIST_ID);
+    if (rtn) {
+      return rtn;
+    }
+    if (reader.remaining_bytes() == 0) {
+      LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG, "Invalid pk in index %d",
+                      m_index_id);
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    node_id.assign(reader.get_current_ptr(), reader.remaining_bytes());
+    return HA_EXIT_SUCCESS;
+  }
+
+  /**
+    found is false when the node was deleted
+  */
+  uint read_vector(Rdb_vector_graph_store &store, const std::string &node_id,
+                   std::vector<float> &vector, bool *found) const {
+    rocksdb::PinnableSlice value;
+    const auto status = store.get(
+        *m_cf_handle, node_key(GRAPH_VECTOR_LIST_ID, node_id), &value);
+    *found = status.ok();
+    if (status.IsNotFound()) {
+      return HA_EXIT_SUCCESS;
+    }
+    if (!status.ok()) {
+      return ha_rocksdb::rdb_error_to_mysql(status);
+    }
+    rocksdb::Slice codes;
+    if (split_vector_entry_value(value, code_size(), &codes, nullptr)) {
+      LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                      "Invalid value size %lu for key in index %d",
+                      value.size(), m_index_id);
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    vector.resize(dimension());
+    memcpy(vector.data(), codes.data(), code_size());
+    return HA_EXIT_SUCCESS;
+  }
+
+  /**
+    neighbor list value format is:
+    [uint16 count] ([uint16 id size] [id bytes]) * count
+  */
+  uint read_neighbors(Rdb_vector_graph_store &store,
+                      const std::string &node_id,
+                      std::vector<std::string> &neighbors) const {
+    neighbors.clear();
+    rocksdb::PinnableSlice value;
+    const auto status = store.get(
+        *m_cf_handle, node_key(GRAPH_NEIGHBOR_LIST_ID, node_id), &value);
+    if (status.IsNotFound()) {
+      return HA_EXIT_SUCCESS;
+    }
+    if (!status.ok()) {
+      return ha_rocksdb::rdb_error_to_mysql(status);
+    }
+    const rocksdb::Slice value_slice(value);
+    Rdb_string_reader reader(&value_slice);
+    uint count;
+    if (reader.read_uint16(&count)) {
+      return corrupt_neighbors();
+    }
+    neighbors.reserve(count);
+    for (uint i = 0; i < count; i++) {
+      uint id_size;
+      const char *id;
+      if (reader.read_uint16(&id_size) || !(id = reader.read(id_size))) {
+        return corrupt_neighbors();
+      }
+      neighbors.emplace_back(id, id_size);
+    }
+    return HA_EXIT_SUCCESS;
+  }
+
+  uint corrupt_neighbors() const {
+    LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                    "Invalid neighbor list in index %d", m_index_id);
+    return HA_ERR_ROCKSDB_CORRUPT_DATA;
+  }
+
+  uint write_neighbors(Rdb_vector_graph_store &store,
+                       const std::string &node_id,
+                       const std::vector<std::string> &neighbors) {
+    Rdb_string_writer value_writer;
+    value_writer.write_uint16(neighbors.size());
+    for (const auto &neighbor : neighbors) {
+      value_writer.write_uint16(neighbor.size());
+      value_writer.write_string(neighbor);
+    }
+    const auto status = store.write_batch()->Put(
+        m_cf_handle.get(), node_key(GRAPH_NEIGHBOR_LIST_ID, node_id),
+        value_writer.to_slice());
+    if (!status.ok()) {
+      LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                      "Failed to write neighbors for index %d", m_index_id);
+      return ha_rocksdb::rdb_error_to_mysql(status);
+    }
+    return HA_EXIT_SUCCESS;
+  }
+
+  uint delete_key(Rdb_vector_graph_store &store, const std::string &key) {
+    const auto status = store.write_batch()->Delete(m_cf_handle.get(), key);
+    if (!status.ok()) {
+      LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                      "Failed to delete graph key for index %d", m_index_id);
+      return ha_rocksdb::rdb_error_to_mysql(status);
+    }
+    return HA_EXIT_SUCCESS;
+  }
+
+  uint read_entry(Rdb_vector_graph_store &store, std::string &node_id,
+                  bool *found) const {
+    rocksdb::PinnableSlice value;
+    const auto status =
+        store.get(*m_cf_handle, node_key(GRAPH_ENTRY_LIST_ID, {}), &value);
+    *found = status.ok();
+    if (status.IsNotFound()) {
+      return HA_EXIT_SUCCESS;
+    }
+    if (!status.ok()) {
+      return ha_rocksdb::rdb_error_to_mysql(status);
+    }
+    node_id = value.ToString();
+    return HA_EXIT_SUCCESS;
+  }
+
+  uint write_entry(Rdb_vector_graph_store &store, const std::string &node_id) {
+    const auto status = store.write_batch()->Put(
+        m_cf_handle.get(), node_key(GRAPH_ENTRY_LIST_ID, {}), node_id);
+    if (!status.ok()) {
+      LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                      "Failed to write entry point for index %d", m_index_id);
+      return ha_rocksdb::rdb_error_to_mysql(status);
+    }
+    return HA_EXIT_SUCCESS;
+  }
+
+  /**
+    greedy beam search from the entry point. beam holds the beam_width
+    closest nodes found, sorted by score. memory is bounded by the beam and
+    by the visited set, which stops the search after beam_width *
+    GRAPH_MAX_DEGREE nodes.
+  */
+  uint beam_search(Rdb_vector_graph_store &store, THD *thd, const float *query,
+                   const FB_VECTOR_INDEX_METRIC metric, const bool normalized,
+                   const uint beam_width, std::vector<Graph_node> &beam) const {
+    beam.clear();
+    std::string entry;
+    bool found = false;
+    uint rtn = read_entry(store, entry, &found);
+    if (rtn || !found) {
+      return rtn;
+    }
+
+    const std::size_t max_visits =
+        static_cast<std::size_t>(beam_width) * GRAPH_MAX_DEGREE;
+    std::unordered_set<std::string> visited;
+    const auto visit = [&](const std::string &node_id) -> uint {
+      if (!visited.insert(node_id).second) {
+        return HA_EXIT_SUCCESS;
+      }
+      Graph_node node;
+      bool exists = false;
+      const uint rc = read_vector(store, node_id, node.m_vector, &exists);
+      if (rc || !exists) {
+        return rc;
+      }
+      node.m_score = rdb_vector_row_score(metric, normalized, query,
+                                          node.m_vector.data(), dimension());
+      if (beam.size() >= beam_width && node.m_score >= beam.back().m_score) {
+        return HA_EXIT_SUCCESS;
+      }
+      node.m_id = node_id;
+      const auto pos = std::upper_bound(
+          beam.begin(), beam.end(), node.m_score,
+          [](float score, const Graph_node &n) { return score < n.m_score; });
+      beam.insert(pos, std::move(node));
+      if (beam.size() > beam_width) {
+        beam.pop_back();
+      }
+      return HA_EXIT_SUCCESS;
+    };
+
+    rtn = visit(entry);
+    std::vector<std::string> neighbors;
+    while (!rtn && visited.size() < max_visits) {
+      if (thd && thd->killed) {
+        return HA_ERR_QUERY_INTERRUPTED;
+      }
+      auto next = std::find_if(beam.begin(), beam.end(),
+                               [](const Graph_node &n) { return !n.m_expanded; });
+      if (next == beam.end()) {
+        break;
+      }
+      next->m_expanded = true;
+      // visiting a neighbor may move the node within the beam
+      const std::string node_id = next->m_id;
+      rtn = read_neighbors(store, node_id, neighbors);
+      for (std::size_t i = 0; !rtn && i < neighbors.size(); i++) {
+        rtn = visit(neighbors[i]);
+      }
+    }
+    return rtn;
+  }
+
+  /**
+    robust pruning. candidates are sorted by squared l2 distance to the node
+    and a candidate is kept unless a kept neighbor is GRAPH_PRUNE_ALPHA times
+    closer to it than the node is.
+  */
+  void robust_prune(const std::vector<Graph_node> &candidates,
+                    std::vector<std::string> &neighbors) const {
+    constexpr float alpha_sqr = GRAPH_PRUNE_ALPHA * GRAPH_PRUNE_ALPHA;
+    std::vector<const Graph_node *> kept;
+    for (const auto &candidate : candidates) {
+      if (kept.size() >= GRAPH_MAX_DEGREE) {
+        break;
+      }
+      const bool pruned =
+          std::any_of(kept.begin(), kept.end(), [&](const Graph_node *k) {
+            return alpha_sqr * fb_vector_l2sqr(k->m_vector.data(),
+                                               candidate.m_vector.data(),
+                                               dimension()) <=
+                   candidate.m_score;
+          });
+      if (!pruned) {
+        kept.push_back(&candidate);
+      }
+    }
+    neighbors.clear();
+    for (const auto *node : kept) {
+      neighbors.push_back(node->m_id);
+    }
+  }
+
+  /**
+    prune the edges of node_id down to GRAPH_MAX_DEGREE, dropping edges to
+    deleted nodes on the way
+  */
+  uint prune_neighbors(Rdb_vector_graph_store &store,
+                       const std::string &node_id,
+                       const std::vector<float> &node_vector,
+                       const std::vector<std::string> &neighbors) {
+    std::vector<Graph_node> candidates;
+    candidates.reserve(neighbors.size());
+    for (const auto &neighbor : neighbors) {
+      Graph_node candidate;
+      bool exists = false;
+      uint rtn = read_vector(store, neighbor, candidate.m_vector, &exists);
+      if (rtn) {
+        return rtn;
+      }
+      if (!exists) {
+        continue;
+      }
+      candidate.m_id = neighbor;
+      candidate.m_score = fb_vector_l2sqr(
+          node_vector.data(), candidate.m_vector.data(), dimension());
+      candidates.push_back(std::move(candidate));
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Graph_node &a, const Graph_node &b) {
+                return a.m_score < b.m_score;
+              });
+    std::vector<std::string> pruned;
+    robust_prune(candidates, pruned);
+    return write_neighbors(store, node_id, pruned);
+  }
+
+  /**
+    add node_id to the graph. the graph is built on l2 distance whatever
+    the query metric, for normalized vectors it orders like cosine.
+  */
+  uint link(Rdb_vector_graph_store &store, THD *thd,
+            const std::string &node_id, const std::vector<float> &vector) {
+    std::vector<Graph_node> beam;
+    uint rtn = beam_search(store, thd, vector.data(),
+                           FB_VECTOR_INDEX_METRIC::L2, false, GRAPH_BUILD_BEAM,
+                           beam);
+    if (rtn) {
+      return rtn;
+    }
+    // an updated row finds its own new vector
+    beam.erase(std::remove_if(beam.begin(), beam.end(),
+                              [&](const Graph_node &n) {
+                                return n.m_id == node_id;
+                              }),
+               beam.end());
+
+    std::vector<std::string> neighbors;
+    robust_prune(beam, neighbors);
+    rtn = write_neighbors(store, node_id, neighbors);
+    if (rtn) {
+      return rtn;
+    }
+    if (beam.empty()) {
+      // first node of the index
+      return write_entry(store, node_id);
+    }
+
+    std::vector<std::string> back_neighbors;
+    for (const auto &neighbor : neighbors) {
+      rtn = read_neighbors(store, neighbor, back_neighbors);
+      if (rtn) {
+        return rtn;
+      }
+      if (std::find(back_neighbors.begin(), back_neighbors.end(), node_id) !=
+          back_neighbors.end()) {
+        continue;
+      }
+      back_neighbors.push_back(node_id);
+      if (back_neighbors.size() <= GRAPH_MAX_DEGREE) {
+        rtn = write_neighbors(store, neighbor, back_neighbors);
+      } else {
+        const auto node = std::find_if(
+            beam.begin(), beam.end(),
+            [&](const Graph_node &n) { return n.m_id == neighbor; });
+        assert(node != beam.end());
+        rtn = prune_neighbors(store, neighbor, node->m_vector, back_neighbors);
+      }
+      if (rtn) {
+        return rtn;
+      }
+    }
+    return HA_EXIT_SUCCESS;
+  }
+
+  /**
+    remove node_id from the graph. its in-neighbors that are also its
+    out-neighbors take over its edges, other in-edges are left dangling
+    and skipped at read time. the vector of node_id is already deleted.
+  */
+  uint unlink(Rdb_vector_graph_store &store, const std::string &node_id) {
+    std::vector<std::string> neighbors;
+    uint rtn = read_neighbors(store, node_id, neighbors);
+    if (rtn) {
+      return rtn;
+    }
+
+    std::vector<std::string> merged;
+    std::vector<float> neighbor_vector;
+    for (const auto &neighbor : neighbors) {
+      rtn = read_neighbors(store, neighbor, merged);
+      if (rtn) {
+        return rtn;
+      }
+      const auto pos = std::find(merged.begin(), merged.end(), node_id);
+      if (pos == merged.end()) {
+        continue;
+      }
+      merged.erase(pos);
+      for (const auto &other : neighbors) {
+        if (other != neighbor &&
+            std::find(merged.begin(), merged.end(), other) == merged.end()) {
+          merged.push_back(other);
+        }
+      }
+      if (merged.size() <= GRAPH_MAX_DEGREE) {
+        rtn = write_neighbors(store, neighbor, merged);
+      } else {
+        bool exists = false;
+        rtn = read_vector(store, neighbor, neighbor_vector, &exists);
+        if (!rtn && exists) {
+          rtn = prune_neighbors(store, neighbor, neighbor_vector, merged);
+        }
+      }
+      if (rtn) {
+        return rtn;
+      }
+    }
+    rtn = delete_key(store, node_key(GRAPH_NEIGHBOR_LIST_ID, node_id));
+    if (rtn) {
+      return rtn;
+    }
+
+    std::string entry;
+    bool found = false;
+    rtn = read_entry(store, entry, &found);
+    if (rtn || !found || entry != node_id) {
+      return rtn;
+    }
+    for (const auto &neighbor : neighbors) {
+      bool exists = false;
+      rtn = read_vector(store, neighbor, neighbor_vector, &exists);
+      if (rtn) {
+        return rtn;
+      }
+      if (exists) {
+        return write_entry(store, neighbor);
+      }
+    }
+    return delete_key(store, node_key(GRAPH_ENTRY_LIST_ID, {}));
+  }
 
-    rtn = create_index(m_index_l2, index_data.get(), faiss::METRIC_L2);
-    if (rtn) {
-      return rtn;
+  /**
+    evaluate the pushed down pk condition on the secondary key entry
+  */
+  uint match_pk_cond(Rdb_vector_graph_store &store, const TABLE *const tbl,
+                     Item *pk_index_cond, const Rdb_key_def *sk_descr,
+                     const std::string &key, bool *match) const {
+    *match = false;
+    rocksdb::PinnableSlice value;
+    const auto status = store.get(*m_cf_handle, key, &value);
+    if (status.IsNotFound()) {
+      return HA_EXIT_SUCCESS;
+    }
+    if (!status.ok()) {
+      return ha_rocksdb::rdb_error_to_mysql(status);
     }
-    rtn =
-        create_index(m_index_ip, index_data.get(), faiss::METRIC_INNER_PRODUCT);
+    std::string unpack_value;
+    if (split_vector_entry_value(value, code_size(), nullptr, &unpack_value)) {
+      LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
+                      "Invalid value size %lu for key in index %d",
+                      value.size(), m_index_id);
+      return HA_ERR_ROCKSDB_CORRUPT_DATA;
+    }
+    const rocksdb::Slice key_slice(key);
+    const rocksdb::Slice value_slice(unpack_value);
+    const int rtn = sk_descr->unpack_record(const_cast<TABLE *>(tbl),
+                                            tbl->record[0], &key_slice,
+                                            &value_slice, false);
     if (rtn) {
       return rtn;
     }
-
-    // create inverted list
-    m_inverted_list = std::make_unique<Rdb_faiss_inverted_list>(
-        m_index_id, *m_cf_handle, m_index_l2->nlist, m_index_l2->code_size);
-    m_index_l2->replace_invlists(m_inverted_list.get());
-    m_index_ip->replace_invlists(m_inverted_list.get());
-
-    // initialize the list size stats. does not allow resize here
-    // because atomic is not move insertable
-    m_list_size_stats = std::vector<std::atomic<long>>(m_index_l2->nlist);
-    for (auto &list_size : m_list_size_stats) {
-      list_size.store(-1);
-    }
+    *match = pk_index_cond->val_int();
     return HA_EXIT_SUCCESS;
   }
+};
 
-  Rdb_vector_index_info dump_info() override {
-    uint ntotal = 0;
-    std::optional<uint> min_list_size;
-    std::optional<uint> max_list_size;
-    std::vector<uint> list_size_stats;
-    list_size_stats.reserve(m_list_size_stats.size());
-    for (const auto &list_size : m_list_size_stats) {
-      const auto list_size_value = list_size.load();
-      if (list_size_value >= 0) {
-        ntotal += list_size_value;
-        list_size_stats.push_back(list_size_value);
-        if (!min_list_size.has_value() ||
-            list_size_value < min_list_size.value()) {
-          min_list_size = list_size_value;
-        }
-        if (!max_list_size.has_value() ||
-            list_size_value > max_list_size.value()) {
-          max_list_size = list_size_value;
-        }
-      }
-    }
-    uint avg_list_size =
-        list_size_stats.empty() ? 0 : ntotal / list_size_stats.size();
-    // compute median value of list size
-    std::sort(list_size_stats.begin(), list_size_stats.end());
-    uint median_list_size = list_size_stats.empty()
-                                ? 0
-                                : list_size_stats[list_size_stats.size() / 2];
-    uint pq_m = 0;
-    uint pq_nbits = 0;
-    if (m_index_def.type() == FB_VECTOR_INDEX_TYPE::IVFPQ) {
-      faiss::IndexIVFPQ *index_ivfpq =
-          dynamic_cast<faiss::IndexIVFPQ *>(m_index_l2.get());
-      pq_m = index_ivfpq->pq.M;
-      pq_nbits = index_ivfpq->pq.nbits;
-    }
-    return {.m_ntotal = ntotal,
-            .m_hit = m_hit,
-            .m_code_size = m_index_l2->code_size,
-            .m_nlist = m_index_l2->nlist,
-            .m_pq_m = pq_m,
-            .m_pq_nbits = pq_nbits,
-            .m_min_list_size = min_list_size.value_or(0),
-            .m_max_list_size = max_list_size.value_or(0),
-            .m_avg_list_size = avg_list_size,
-            .m_median_list_size = median_list_size};
+/**
+  index of a json column of sparse vectors, its entries are the postings
+  written by rdb_sparse_vector_write with the rows, so it holds no lists
+  or codes of its own. the search is exact.
+*/
+class Rdb_vector_index_sparse : public Rdb_vector_index {
+ public:
+  explicit Rdb_vector_index_sparse(const FB_vector_index_config index_def)
+      : m_index_def{index_def} {}
+
+  ~Rdb_vector_index_sparse() override = default;
+
+  void assign_vector(const float *data [[maybe_unused]],
+                     Rdb_vector_index_assignment &assignment) override {
+    assert(false);
+    assignment.m_list_id = 0;
+    assignment.m_codes.clear();
   }
 
- private:
-  Index_id m_index_id;
-  FB_vector_index_config m_index_def;
-  std::shared_ptr<rocksdb::ColumnFamilyHandle> m_cf_handle;
-  std::atomic<uint> m_hit{0};
-  std::unique_ptr<faiss::IndexFlatL2> m_quantizer;
-  std::unique_ptr<faiss::IndexIVF> m_index_l2;
-  std::unique_ptr<faiss::IndexIVF> m_index_ip;
-  std::unique_ptr<Rdb_faiss_inverted_list> m_inverted_list;
-  std::vector<std::atomic<long>> m_list_size_stats;
+  uint knn_search(THD *thd [[maybe_unused]],
+                  const TABLE *const tbl [[maybe_unused]],
+                  Item *pk_index_cond [[maybe_unused]],
+                  const Rdb_key_def *sk_descr [[maybe_unused]],
+                  std::vector<float> &query_vector [[maybe_unused]],
+                  Rdb_vector_search_params &params [[maybe_unused]],
+                  Rdb_vector_result &result [[maybe_unused]]) override {
+    return HA_ERR_UNSUPPORTED;
+  }
 
-  uint delete_vector_from_list(rocksdb::WriteBatchBase *write_batch,
-                               const uint64 list_id, const rocksdb::Slice &pk) {
-    Rdb_string_writer key_writer;
-    write_inverted_list_item_key(key_writer, m_index_id, list_id, pk);
-    auto status = write_batch->Delete(m_cf_handle.get(), key_writer.to_slice());
-    if (!status.ok()) {
-      LogPluginErrMsg(ERROR_LEVEL, ER_LOG_PRINTF_MSG,
-                      "Failed to write codes for index %d", m_index_id);
-      return ha_rocksdb::rdb_error_to_mysql(status);
+  uint knn_search_sparse(THD *thd, const TABLE *const tbl [[maybe_unused]],
+                         const Rdb_key_def *sk_descr,
+                         const Fb_sparse_vector &query,
+                         Rdb_vector_search_params &params,
+                         Rdb_vector_result &result) override {
+    m_hit++;
+    std::vector<Rdb_fulltext_match> matches;
+    assert(params.m_pk_descr != nullptr);
+    const int rtn = rdb_sparse_vector_search(
+        thd, *sk_descr, *params.m_pk_descr, query, params.m_k, &matches);
+    if (rtn) {
+      return rtn;
+    }
+    result.clear();
+    result.reserve(matches.size());
+    for (auto &match : matches) {
+      result.emplace_back(std::move(match.m_pk), match.m_score);
     }
     return HA_EXIT_SUCCESS;
   }
 
-  uint64 get_list_id(const float *data) const {
-    if (m_index_l2->nlist == 1) {
-      return 0;
-    }
-    faiss::idx_t list_id = 0;
-    constexpr faiss::idx_t vector_count = 1;
-    m_index_l2->quantizer->assign(vector_count, data, &list_id);
-    return list_id;
+  uint index_scan(
+      THD *thd [[maybe_unused]], const TABLE *const tbl [[maybe_unused]],
+      Item *pk_index_cond [[maybe_unused]],
+      const Rdb_key_def *sk_descr [[maybe_unused]],
+      std::vector<float> &query_vector [[maybe_unused]],
+      const Rdb_vector_search_params &params [[maybe_unused]],
+      std::unique_ptr<Rdb_vector_db_iterator> &index_scan_result_iter
+      [[maybe_unused]]) override {
+    return HA_ERR_UNSUPPORTED;
   }
 
-  uint setup_quantizer(Rdb_vector_index_data *index_data) {
-    m_quantizer = std::make_unique<faiss::IndexFlatL2>(m_index_def.dimension());
-    const auto total_code_size =
-        index_data->m_quantizer_codes.size() * sizeof(float);
-    const auto ncentroids = index_data->m_nlist;
-    if (total_code_size != ncentroids * m_quantizer->code_size) {
-      LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
-                      "Invalid codes, total code size %lu.", total_code_size);
-      return HA_EXIT_FAILURE;
-    }
-    m_quantizer->add(ncentroids, index_data->m_quantizer_codes.data());
+  uint analyze(THD *thd [[maybe_unused]],
+               uint64_t max_num_rows_scanned [[maybe_unused]],
+               std::atomic<THD::killed_state> *killed
+               [[maybe_unused]]) override {
     return HA_EXIT_SUCCESS;
   }
 
-  uint create_index(std::unique_ptr<faiss::IndexIVF> &index,
-                    Rdb_vector_index_data *index_data,
-                    faiss::MetricType metric_type) {
-    const auto ncentroids = index_data->m_nlist;
-    if (m_index_def.type() == FB_VECTOR_INDEX_TYPE::FLAT ||
-        m_index_def.type() == FB_VECTOR_INDEX_TYPE::IVFFLAT) {
-      index = std::make_unique<faiss::IndexIVFFlat>(
-          m_quantizer.get(), m_index_def.dimension(), ncentroids, metric_type);
-    } else {
-      auto ivfpq_index = std::make_unique<faiss::IndexIVFPQ>(
-          m_quantizer.get(), m_index_def.dimension(), ncentroids,
-          index_data->m_pq_m, index_data->m_pq_nbits, metric_type);
-      // pq centroids is already resized to the correct size
-      if (ivfpq_index->pq.centroids.size() != index_data->m_pq_codes.size()) {
-        LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
-                        "Invalid pq codes, expected code size %lu.",
-                        ivfpq_index->pq.centroids.size());
-        return HA_EXIT_FAILURE;
-      }
+  Rdb_vector_index_info dump_info() override { return {.m_hit = m_hit}; }
 
-      ivfpq_index->pq.centroids = index_data->m_pq_codes;
-      ivfpq_index->precompute_table();
+  FB_vector_dimension dimension() const override { return 0; }
 
-      index = std::move(ivfpq_index);
-    }
-    index->is_trained = true;
-    return HA_EXIT_SUCCESS;
+  const FB_vector_index_config &get_config() const override {
+    return m_index_def;
   }
+
+ private:
+  FB_vector_index_config m_index_def;
+  std::atomic<uint> m_hit{0};
 };
 
 }  // anonymous namespace
@@ -1889,12 +5047,19 @@ uint create_vector_index(Rdb_cmd_srv_helper &cmd_srv_helper,
                          std::unique_ptr<Rdb_vector_index> &index) {
   if (index_def.type() == FB_VECTOR_INDEX_TYPE::FLAT ||
       index_def.type() == FB_VECTOR_INDEX_TYPE::IVFFLAT ||
-      index_def.type() == FB_VECTOR_INDEX_TYPE::IVFPQ) {
+      index_def.type() == FB_VECTOR_INDEX_TYPE::IVFPQ ||
+      index_def.type() == FB_VECTOR_INDEX_TYPE::IVFSQ8 ||
+      index_def.type() == FB_VECTOR_INDEX_TYPE::IVFFP16) {
     index =
         std::make_unique<Rdb_vector_index_ivf>(index_def, cf_handle, index_id);
   } else if (index_def.type() == FB_VECTOR_INDEX_TYPE::LSMIDX) {
     index =
         std::make_unique<Rdb_vector_index_lsm>(index_def, cf_handle, index_id);
+  } else if (index_def.type() == FB_VECTOR_INDEX_TYPE::GRAPH) {
+    index = std::make_unique<Rdb_vector_index_graph>(index_def, cf_handle,
+                                                     index_id);
+  } else if (index_def.type() == FB_VECTOR_INDEX_TYPE::SPARSE) {
+    index = std::make_unique<Rdb_vector_index_sparse>(index_def);
   } else {
     assert(false);
     return HA_ERR_UNSUPPORTED;
@@ -1919,6 +5084,56 @@ uint create_vector_index(Rdb_cmd_srv_helper &cmd_srv_helper [[maybe_unused]],
 
 #endif
 
+void rdb_multi_vector_entries(
+    const std::vector<Rdb_vector_index_assignment> &assignments,
+    std::vector<Rdb_vector_index_assignment> *entries) {
+  std::map<faiss_ivf_list_id, std::vector<const std::string *>> lists;
+  for (const auto &assignment : assignments) {
+    lists[assignment.m_list_id].push_back(&assignment.m_codes);
+  }
+  entries->clear();
+  entries->reserve(lists.size());
+  for (const auto &[list_id, codes] : lists) {
+    Rdb_vector_index_assignment &entry = entries->emplace_back();
+    entry.m_list_id = list_id;
+    uchar count[RDB_MULTI_VECTOR_COUNT_SIZE];
+    rdb_netbuf_store_uint32(count, codes.size());
+    entry.m_codes.assign(reinterpret_cast<const char *>(count), sizeof(count));
+    for (const std::string *code : codes) {
+      entry.m_codes.append(*code);
+    }
+  }
+}
+
+// knn rounds stop growing nprobe and target candidates past this
+constexpr uint RDB_VECTOR_MAX_EXPAND = 1U << 30;
+
+// knn results fb_vector_search_memory_limit holds, 0 when there is no limit
+static uint rdb_vector_memory_limit_rows(THD *thd, const TABLE *const tbl) {
+  const ulonglong memory_limit = thd->variables.fb_vector_search_memory_limit;
+  if (memory_limit == 0) return 0;
+  const ulonglong row_bytes =
+      sizeof(Rdb_vector_result::value_type) + tbl->file->ref_length;
+  return static_cast<uint>(std::min<ulonglong>(
+      std::max<ulonglong>(memory_limit / row_bytes, 1), UINT_MAX));
+}
+
+static std::string rdb_query_vector_key(const std::vector<float> &query_vector) {
+  return std::string(reinterpret_cast<const char *>(query_vector.data()),
+                     query_vector.size() * sizeof(float));
+}
+
+// everything a knn search result depends on besides the index contents
+static std::string rdb_result_cache_key(const Rdb_vector_search_params &params,
+                                        const std::vector<float> &query_vector) {
+  std::string key;
+  const uint fields[] = {static_cast<uint>(params.m_metric), params.m_k,
+                         params.m_nprobe, params.m_target_candidates};
+  key.append(reinterpret_cast<const char *>(fields), sizeof(fields));
+  key.append(rdb_query_vector_key(query_vector));
+  return key;
+}
+
 Rdb_vector_db_handler::Rdb_vector_db_handler() {}
 
 uint Rdb_vector_db_handler::search(THD *thd, const TABLE *const tbl,
@@ -1928,10 +5143,22 @@ uint Rdb_vector_db_handler::search(THD *thd, const TABLE *const tbl,
   assert((m_search_type == FB_VECTOR_SEARCH_INDEX_SCAN) ||
          (m_search_type == FB_VECTOR_SEARCH_KNN_FIRST) || 
          (m_search_type == FB_VECTOR_SEARCH_KNN_HYBRID));
-  
+  const Malloc_arena_scope arena_scope(MALLOC_ARENA_VECTOR);
+
+  // a query vector taken from the outer row changes between searches
+  if (m_distance_func &&
+      !m_distance_func->arguments()[1]->const_for_execution()) {
+    const uint rtn = read_query_vector(m_buffer);
+    if (rtn) {
+      return rtn;
+    }
+  }
 
   if (m_search_type == FB_VECTOR_SEARCH_KNN_FIRST) {
     // log_to_file("m_search_type == FB_VECTOR_SEARCH_KNN_FIRST, m_limit: " + std::to_string(m_limit) + "; m_nprobe = " + std::to_string(m_nprobe));
+    m_returned_keys.clear();
+    m_search_nprobe = m_nprobe;
+    m_search_target_candidates = m_target_candidates;
     return knn_search(thd, tbl, index, sk_descr, pk_index_cond);
   } else if (m_search_type == FB_VECTOR_SEARCH_KNN_HYBRID) {
     return knn_search_hybrid(thd, tbl, index, sk_descr, pk_index_cond);
@@ -1947,21 +5174,32 @@ uint Rdb_vector_db_handler::index_scan(THD *thd, const TABLE *const tbl,
                                        const Rdb_key_def *sk_descr,
                                        Item *pk_index_cond) {
   if (!m_buffer.size()) return HA_ERR_END_OF_FILE;
+  // rows of a multi-vector index are not in order of any one query vector,
+  // a sparse index only holds the rows with some index of the query
+  if (m_metric == FB_VECTOR_INDEX_METRIC::MAXSIM ||
+      index->get_config().sparse()) {
+    return HA_ERR_UNSUPPORTED;
+  }
 
-  if (m_buffer.size() < index->dimension()) {
-    m_buffer.resize(index->dimension(), 0.0);
-  } else if (m_buffer.size() > index->dimension()) {
-    LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
-                    "query vector dimension is too big for vector index");
-    return HA_EXIT_FAILURE;
+  uint rtn = fit_query_vector(index, m_buffer);
+  if (rtn) {
+    return rtn;
   }
 
-  uint rtn = index->index_scan(thd, tbl, pk_index_cond, sk_descr, m_buffer,
-                           m_nprobe, m_index_scan_result_iter);
+  Rdb_vector_search_params params{.m_metric = m_metric,
+                                  .m_nprobe = m_nprobe,
+                                  .m_threads = m_threads,
+                                  .m_target_candidates = m_target_candidates,
+                                  .m_row_filter = m_row_filter,
+                                  .m_pk_prefix = m_pk_prefix,
+                                  .m_search_all_lists = m_search_all_lists};
+  rtn = index->index_scan(thd, tbl, pk_index_cond, sk_descr, m_buffer, params,
+                          m_index_scan_result_iter);
 
   if (rtn == HA_ERR_UNSUPPORTED) {
-    rtn = index->index_scan_with_value(thd, tbl, pk_index_cond, sk_descr, m_buffer, m_nprobe,
-                            m_search_result_with_value);
+    rtn = index->index_scan_with_value(thd, tbl, pk_index_cond, sk_descr,
+                                       m_buffer, params,
+                                       m_search_result_with_value);
     if (rtn) {
       return rtn;
     }
@@ -1977,39 +5215,375 @@ uint Rdb_vector_db_handler::knn_search(THD *thd, const TABLE *const tbl,
                                        Item *pk_index_cond) {
   m_search_result.clear();
   m_search_result_with_value.clear();
+  m_results_are_rowids = false;
 
   m_vector_db_result_iter = m_search_result.cend();
   m_vector_db_result_with_value_iter = m_search_result_with_value.cend();
 
-  if (!m_buffer.size() || !m_limit) return HA_ERR_END_OF_FILE;
+  if ((!m_buffer.size() && m_sparse_buffer.empty()) || !m_limit) {
+    return HA_ERR_END_OF_FILE;
+  }
 
-  if (m_buffer.size() < index->dimension()) {
-    m_buffer.resize(index->dimension(), 0.0);
-  } else if (m_buffer.size() > index->dimension()) {
-    LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
-                    "query vector dimension is too big for vector index");
-    return HA_EXIT_FAILURE;
+  uint rtn = fit_query_vector(index, m_buffer);
+  if (rtn) {
+    return rtn;
   }
 
+  // rows already returned by earlier rounds are searched again and dropped
+  const uint limit = m_limit + m_returned_keys.size();
+  uint k = needs_rerank(index) ? limit * rocksdb_vector_rerank_factor : limit;
+  // re-rank candidates past the memory limit are left out, the rows the
+  // query asked for are still searched
+  const uint limit_rows = rdb_vector_memory_limit_rows(thd, tbl);
+  if (limit_rows > 0 && k > limit_rows) {
+    k = std::max(limit, limit_rows);
+  }
   Rdb_vector_search_params params{
-      .m_metric = m_metric, .m_k = m_limit, .m_nprobe = m_nprobe};
-  uint rtn = index->knn_search_with_value(thd, tbl, pk_index_cond, sk_descr,
-                                          m_buffer, params,
-                                          m_search_result_with_value);
-  if (rtn == HA_ERR_UNSUPPORTED) {
-    rtn = index->knn_search(thd, tbl, pk_index_cond, sk_descr, m_buffer, params,
-                            m_search_result);
+      .m_metric = m_metric,
+      .m_k = k,
+      .m_nprobe = m_search_nprobe,
+      .m_threads = m_threads,
+      .m_target_candidates = m_search_target_candidates,
+      .m_row_filter = m_row_filter,
+      .m_pk_prefix = m_pk_prefix,
+      .m_search_all_lists = m_search_all_lists,
+      .m_pk_descr = m_pk_descr};
+  const bool sparse = index->get_config().sparse();
+  // later rounds probe more lists than the prefetched search did, and a
+  // search of a pk prefix reads other entries, or all lists
+  const auto prefetched =
+      m_returned_keys.empty() && !sparse && m_pk_prefix.empty()
+          ? m_prefetched.find(rdb_query_vector_key(m_buffer))
+          : m_prefetched.end();
+  // lsm indexes return whole rows, conditions and expanded rounds depend on
+  // more than the query vector, none of those are cached, nor are sparse
+  // queries, which the cache keys do not hold
+  const bool use_result_cache =
+      rocksdb_vector_result_cache_entries > 0 && m_result_cache_enabled &&
+      m_returned_keys.empty() && !pk_index_cond && !m_row_filter &&
+      index->get_config().type() != FB_VECTOR_INDEX_TYPE::LSMIDX && !sparse;
+  std::string cache_key;
+  uint64_t write_seq = 0;
+  if (use_result_cache) {
+    cache_key = rdb_result_cache_key(params, m_buffer);
+    // read before searching, a write racing the search invalidates the entry
+    write_seq = index->write_seq();
+  }
+  const auto search_start = my_micro_time();
+  if (prefetched != m_prefetched.end()) {
+    m_search_result = prefetched->second;
+  } else if (use_result_cache && index->result_cache().lookup(
+                                     cache_key, write_seq, m_search_result)) {
+    // served from the cache
+  } else if (sparse) {
+    // the postings of a sparse index are keyed by pk
+    rtn = index->knn_search_sparse(thd, tbl, sk_descr, m_sparse_buffer,
+                                   params, m_search_result);
+    m_results_are_rowids = true;
+  } else if (m_metric == FB_VECTOR_INDEX_METRIC::MAXSIM) {
+    rtn = index->knn_search_maxsim(thd, tbl, pk_index_cond, sk_descr,
+                                   m_buffer, params, m_search_result);
+    if (!rtn && use_result_cache) {
+      index->result_cache().insert(cache_key, write_seq, m_search_result,
+                                   rocksdb_vector_result_cache_entries);
+    }
+  } else {
+    rtn = index->knn_search_with_value(thd, tbl, pk_index_cond, sk_descr,
+                                       m_buffer, params,
+                                       m_search_result_with_value);
+    if (rtn == HA_ERR_UNSUPPORTED) {
+      rtn = index->knn_search(thd, tbl, pk_index_cond, sk_descr, m_buffer,
+                              params, m_search_result);
+      if (!rtn && use_result_cache) {
+        index->result_cache().insert(cache_key, write_seq, m_search_result,
+                                     rocksdb_vector_result_cache_entries);
+      }
+    }
   }
 
   if (rtn) {
     return rtn;
   }
+  index->search_stats().add_search(my_micro_time() - search_start);
+  if (!m_returned_keys.empty()) {
+    const auto returned = [this](const auto &row) {
+      return m_returned_keys.count(row.first) > 0;
+    };
+    m_search_result.erase(std::remove_if(m_search_result.begin(),
+                                         m_search_result.end(), returned),
+                          m_search_result.end());
+    m_search_result_with_value.erase(
+        std::remove_if(m_search_result_with_value.begin(),
+                       m_search_result_with_value.end(), returned),
+        m_search_result_with_value.end());
+  }
+  // re-ranked candidates are bounded once their distances are exact
+  if (m_distance_bound.has_value() && !needs_rerank(index)) {
+    m_search_result.erase(
+        std::remove_if(m_search_result.begin(), m_search_result.end(),
+                       [this](const auto &row) {
+                         return beyond_distance_bound(row.second);
+                       }),
+        m_search_result.end());
+    m_search_result_with_value.erase(
+        std::remove_if(m_search_result_with_value.begin(),
+                       m_search_result_with_value.end(),
+                       [this](const auto &row) {
+                         return beyond_distance_bound(row.second.first);
+                       }),
+        m_search_result_with_value.end());
+  }
   m_vector_db_result_iter = m_search_result.cbegin();
   m_vector_db_result_with_value_iter = m_search_result_with_value.cbegin();
 
   return rtn;
 }
 
+uint Rdb_vector_db_handler::prefetch(
+    THD *thd, const TABLE *const tbl, Rdb_vector_index *index,
+    const Rdb_key_def *sk_descr, Item *pk_index_cond,
+    std::vector<std::vector<float>> &query_vectors) {
+  m_prefetched.clear();
+  if (m_search_type != FB_VECTOR_SEARCH_KNN_FIRST || !m_limit ||
+      pk_index_cond || query_vectors.empty() ||
+      m_metric == FB_VECTOR_INDEX_METRIC::MAXSIM ||
+      index->get_config().sparse()) {
+    return HA_EXIT_SUCCESS;
+  }
+  for (auto &query_vector : query_vectors) {
+    if (query_vector.empty()) {
+      return HA_EXIT_SUCCESS;
+    }
+    // same preparation as read_query_vector(), so the keys match
+    if (m_metric == FB_VECTOR_INDEX_METRIC::COSINE) {
+      fb_vector_normalize_l2(query_vector.data(), query_vector.size());
+    }
+    uint rtn = fit_query_vector(index, query_vector);
+    if (rtn) {
+      return rtn;
+    }
+  }
+
+  uint k =
+      needs_rerank(index) ? m_limit * rocksdb_vector_rerank_factor : m_limit;
+  // the results of all the queries are held at once, over the memory limit
+  // each query is left to search() on its own
+  const uint limit_rows = rdb_vector_memory_limit_rows(thd, tbl);
+  if (limit_rows > 0) {
+    const uint query_rows = limit_rows / query_vectors.size();
+    if (query_rows < m_limit) {
+      return HA_EXIT_SUCCESS;
+    }
+    k = std::min(k, query_rows);
+  }
+  Rdb_vector_search_params params{.m_metric = m_metric,
+                                  .m_k = k,
+                                  .m_nprobe = m_nprobe,
+                                  .m_threads = m_threads,
+                                  .m_target_candidates = m_target_candidates};
+  std::vector<Rdb_vector_result> results;
+  const uint rtn = index->knn_search_batch(thd, tbl, nullptr, sk_descr,
+                                           query_vectors, params, results);
+  if (rtn == HA_ERR_UNSUPPORTED) {
+    // e.g. lsm indexes only search with values, leave it to search()
+    return HA_EXIT_SUCCESS;
+  }
+  if (rtn) {
+    return rtn;
+  }
+  for (std::size_t i = 0; i < query_vectors.size(); i++) {
+    m_prefetched[rdb_query_vector_key(query_vectors[i])] =
+        std::move(results[i]);
+  }
+  return HA_EXIT_SUCCESS;
+}
+
+uint Rdb_vector_db_handler::fit_query_vector(
+    const Rdb_vector_index *index, std::vector<float> &query_vector) const {
+  // a sparse index is searched with the sparse query alone
+  if (index->get_config().sparse() != !m_sparse_buffer.empty() ||
+      (index->get_config().sparse() && !query_vector.empty())) {
+    LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
+                    "query vector does not match the kind of vector index");
+    return HA_EXIT_FAILURE;
+  }
+  if (index->get_config().sparse()) {
+    return HA_EXIT_SUCCESS;
+  }
+  if (m_metric == FB_VECTOR_INDEX_METRIC::MAXSIM) {
+    // the query vectors one after the other, each of the index dimension
+    if (query_vector.empty() || query_vector.size() % index->dimension()) {
+      LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
+                      "query vectors do not match the vector index dimension");
+      return HA_EXIT_FAILURE;
+    }
+    return HA_EXIT_SUCCESS;
+  }
+  if (query_vector.size() < index->dimension()) {
+    query_vector.resize(index->dimension(), 0.0);
+  } else if (query_vector.size() > index->dimension()) {
+    LogPluginErrMsg(INFORMATION_LEVEL, ER_LOG_PRINTF_MSG,
+                    "query vector dimension is too big for vector index");
+    return HA_EXIT_FAILURE;
+  }
+  return HA_EXIT_SUCCESS;
+}
+
+uint Rdb_vector_db_handler::expand_search(THD *thd, const TABLE *const tbl,
+                                          Rdb_vector_index *index,
+                                          const Rdb_key_def *sk_descr,
+                                          Item *pk_index_cond) {
+  // fused results hold every candidate of both rankings
+  if (m_search_type != FB_VECTOR_SEARCH_KNN_FIRST || !m_limit ||
+      m_text_relevance != nullptr) {
+    return HA_EXIT_SUCCESS;
+  }
+  const std::size_t returned = m_returned_keys.size();
+  for (const auto &row : m_search_result) {
+    m_returned_keys.insert(row.first);
+  }
+  for (const auto &row : m_search_result_with_value) {
+    m_returned_keys.insert(row.first);
+  }
+  if (m_returned_keys.size() == returned) {
+    // the last round found nothing new, the index is exhausted
+    m_search_result.clear();
+    m_search_result_with_value.clear();
+    m_vector_db_result_iter = m_search_result.cend();
+    m_vector_db_result_with_value_iter = m_search_result_with_value.cend();
+    return HA_EXIT_SUCCESS;
+  }
+  // probe the next ring of lists around the query
+  if (m_search_nprobe < RDB_VECTOR_MAX_EXPAND) {
+    m_search_nprobe = std::max(m_search_nprobe, 1U) * 2;
+  }
+  if (m_search_target_candidates < RDB_VECTOR_MAX_EXPAND) {
+    m_search_target_candidates *= 2;
+  }
+  return knn_search(thd, tbl, index, sk_descr, pk_index_cond);
+}
+
+void Rdb_vector_db_handler::knn_results(Rdb_vector_result *rows) const {
+  rows->clear();
+  for (const auto &row : m_search_result) {
+    rows->emplace_back(row.first, row.second);
+  }
+  for (const auto &row : m_search_result_with_value) {
+    rows->emplace_back(row.first, row.second.first);
+  }
+}
+
+void Rdb_vector_db_handler::fuse_text_matches(
+    Rdb_vector_result &&vector_rows,
+    const std::vector<Rdb_fulltext_match> &text_rows, bool all_text_rows,
+    bool rrf, uint rrf_k) {
+  // l2 is a distance, ip and cosine are similarities
+  const bool ascending = m_metric == FB_VECTOR_INDEX_METRIC::L2;
+  std::stable_sort(vector_rows.begin(), vector_rows.end(),
+                   [ascending](const auto &a, const auto &b) {
+                     return ascending ? a.second < b.second
+                                      : a.second > b.second;
+                   });
+
+  struct Fused_row {
+    std::optional<float> m_distance;
+    std::optional<float> m_relevance;
+    double m_rrf = 0;
+  };
+  std::unordered_map<std::string, Fused_row> rows;
+  for (size_t i = 0; i < vector_rows.size(); i++) {
+    Fused_row &row = rows[vector_rows[i].first];
+    row.m_distance = vector_rows[i].second;
+    row.m_rrf += 1.0 / (rrf_k + i + 1);
+  }
+  const double text_weight = std::abs(m_text_weight);
+  for (size_t i = 0; i < text_rows.size(); i++) {
+    Fused_row &row = rows[text_rows[i].m_pk];
+    row.m_relevance = text_rows[i].m_score;
+    row.m_rrf += text_weight / (rrf_k + i + 1);
+  }
+
+  const float worst_distance =
+      vector_rows.empty() ? 0 : vector_rows.back().second;
+  const float worst_relevance =
+      all_text_rows || text_rows.empty() ? 0 : text_rows.back().m_score;
+  m_search_result.clear();
+  m_search_result_with_value.clear();
+  for (const auto &[rowid, row] : rows) {
+    const float score =
+        rrf ? static_cast<float>(row.m_rrf)
+            : row.m_distance.value_or(worst_distance) +
+                  m_text_weight * row.m_relevance.value_or(worst_relevance);
+    m_search_result.emplace_back(rowid, score);
+  }
+  // rrf scores grow as rows get better, like similarities
+  const bool fused_ascending = ascending && !rrf;
+  std::sort(m_search_result.begin(), m_search_result.end(),
+            [fused_ascending](const auto &a, const auto &b) {
+              if (a.second != b.second) {
+                return fused_ascending ? a.second < b.second
+                                       : a.second > b.second;
+              }
+              return a.first < b.first;
+            });
+  m_results_are_rowids = true;
+  m_vector_db_result_iter = m_search_result.cbegin();
+  m_vector_db_result_with_value_iter = m_search_result_with_value.cend();
+}
+
+bool Rdb_vector_db_handler::needs_rerank(
+    const Rdb_vector_index *index) const {
+  const auto type = index->get_config().type();
+  if (m_search_type == FB_VECTOR_SEARCH_KNN_FIRST &&
+      m_metric == FB_VECTOR_INDEX_METRIC::MAXSIM) {
+    return true;
+  }
+  return m_search_type == FB_VECTOR_SEARCH_KNN_FIRST &&
+         rocksdb_vector_rerank_factor > 1 &&
+         (type == FB_VECTOR_INDEX_TYPE::IVFPQ ||
+          type == FB_VECTOR_INDEX_TYPE::IVFSQ8 ||
+          type == FB_VECTOR_INDEX_TYPE::IVFFP16);
+}
+
+float Rdb_vector_db_handler::exact_distance(
+    const std::vector<float> &vector) const {
+  const std::size_t dimension = std::min(vector.size(), m_buffer.size());
+  switch (m_metric) {
+    case FB_VECTOR_INDEX_METRIC::L2:
+      return fb_vector_l2sqr(vector.data(), m_buffer.data(), dimension);
+    case FB_VECTOR_INDEX_METRIC::COSINE:
+      return fb_vector_cosine(vector.data(), m_buffer.data(), dimension);
+    default:
+      return fb_vector_inner_product(vector.data(), m_buffer.data(),
+                                     dimension);
+  }
+}
+
+void Rdb_vector_db_handler::set_reranked_result(
+    Rdb_vector_result &&rows) {
+  // l2 is a distance, ip and cosine are similarities
+  const bool ascending = m_metric == FB_VECTOR_INDEX_METRIC::L2;
+  std::stable_sort(rows.begin(), rows.end(),
+                   [ascending](const auto &a, const auto &b) {
+                     return ascending ? a.second < b.second
+                                      : a.second > b.second;
+                   });
+  if (m_distance_bound.has_value()) {
+    rows.erase(std::remove_if(rows.begin(), rows.end(),
+                              [this](const auto &row) {
+                                return beyond_distance_bound(row.second);
+                              }),
+               rows.end());
+  }
+  if (rows.size() > m_limit) {
+    rows.resize(m_limit);
+  }
+  m_search_result_with_value.clear();
+  m_vector_db_result_with_value_iter = m_search_result_with_value.cend();
+  m_search_result = std::move(rows);
+  m_vector_db_result_iter = m_search_result.cbegin();
+}
+
 uint Rdb_vector_db_handler::knn_search_hybrid(THD *thd, const TABLE *const tbl,
                                        Rdb_vector_index *index,
                                        const Rdb_key_def *sk_descr,
@@ -2028,8 +5602,14 @@ uint Rdb_vector_db_handler::knn_search_hybrid(THD *thd, const TABLE *const tbl,
     return HA_EXIT_FAILURE;
   }
 
-  Rdb_vector_search_params params{
-      .m_metric = m_metric, .m_k = m_limit * 5, .m_nprobe = m_nprobe, .m_weight = m_weight, .m_query_coordinate = m_query_coordinate};
+  Rdb_vector_search_params params{.m_metric = m_metric,
+                                  .m_k = m_limit * 5,
+                                  .m_nprobe = m_nprobe,
+                                  .m_threads = m_threads,
+                                  .m_target_candidates = m_target_candidates,
+                                  .m_weight = m_weight,
+                                  .m_query_geometry = &m_query_geometry,
+                                  .m_row_filter = m_row_filter};
   uint rtn = index->knn_search_hybrid_with_value(thd, tbl, pk_index_cond, sk_descr,
                                           m_buffer, params,
                                           m_search_result_with_value);
@@ -2068,4 +5648,23 @@ uint Rdb_vector_db_handler::current_value(std::string &value) const {
   return HA_ERR_UNSUPPORTED;
 }
 
+void Rdb_vector_db_handler::upcoming_keys(
+    size_t n, std::vector<std::string> *keys) const {
+  keys->clear();
+  if (m_search_type == FB_VECTOR_SEARCH_KNN_FIRST &&
+      !m_search_result.empty()) {
+    for (auto it = m_vector_db_result_iter;
+         it != m_search_result.cend() && keys->size() < n; ++it) {
+      keys->push_back(it->first);
+    }
+    return;
+  }
+  if (!m_search_result_with_value.empty()) {
+    for (auto it = m_vector_db_result_with_value_iter;
+         it != m_search_result_with_value.cend() && keys->size() < n; ++it) {
+      keys->push_back(it->first);
+    }
+  }
+}
+
 }  // namespace myrocks
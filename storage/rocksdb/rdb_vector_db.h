@@ -19,19 +19,50 @@
 #include <faiss/Index.h>
 #endif
 #include <rocksdb/slice.h>
+#include <rocksdb/types.h>
 #include <rocksdb/write_batch.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <list>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include "./rdb_cmd_srv_helper.h"
 #include "./rdb_global.h"
+#include "./rdb_psi.h"
 #include "rdb_utils.h"
+#include "sql/fb_vector_distance.h"
 #include "sql/item_fb_vector_func.h"
 #include "sql/item_json_func.h"
+#include "sql/next_spatial_base.h"
 #include "sql/sql_class.h"
 
 namespace myrocks {
 using faiss_ivf_list_id = int64_t;
 
 class Rdb_key_def;
+class Rdb_transaction;
+struct Rdb_fulltext_match;
+
+/**
+  knn results, the key and score of each row. held for the statement, so
+  they are charged to the connection, see Rdb_search_result_allocator.
+*/
+using Rdb_vector_result =
+    std::vector<std::pair<std::string, float>,
+                Rdb_search_result_allocator<std::pair<std::string, float>>>;
+
+/** results of indexes that return the rows, with the value of each row */
+using Rdb_vector_result_with_value = std::vector<
+    std::pair<std::string, std::pair<float, std::string>>,
+    Rdb_search_result_allocator<
+        std::pair<std::string, std::pair<float, std::string>>>>;
+
 class Rdb_vector_db_iterator {
  public:
   virtual ~Rdb_vector_db_iterator() = default;
@@ -46,6 +77,7 @@ class Rdb_vector_index_info {
   /**
     total number of vectors, this is populated when
     scanning the index, not garanteed to be accurate.
+    extrapolated from the counted lists when not all of them are.
    */
   int64_t m_ntotal{0};
   /**
@@ -66,15 +98,430 @@ class Rdb_vector_index_info {
   uint m_max_list_size{0};
   uint m_avg_list_size{0};
   uint m_median_list_size{0};
+  /**
+    lists counted so far, and the 95% confidence bounds of ntotal
+    extrapolated from them, equal to ntotal once all lists are counted
+  */
+  uint64_t m_counted_lists{0};
+  int64_t m_ntotal_low{0};
+  int64_t m_ntotal_high{0};
+
+  /**
+    distances of the entries of the ivf lists to their centroid, over the
+    lists compacted since startup, see Rdb_vector_list_info
+  */
+  float m_min_centroid_distance{0};
+  float m_max_centroid_distance{0};
+  float m_avg_centroid_distance{0};
+
+  /**
+    phase of the last centroid retrain, empty when the index was never
+    retrained since startup
+  */
+  std::string m_retrain_state;
+  /** vectors sampled or copied by the current retrain phase */
+  uint64_t m_retrain_rows{0};
+};
+
+/**
+  one ivf list, for information schema. the distances to the centroid are
+  those of the entries the last compaction of the list kept, compactions
+  of upper levels only see part of the list. m_distance_count is 0 until
+  the list is compacted.
+*/
+struct Rdb_vector_list_info {
+  std::size_t m_list_no{0};
+  /** -1 until the list is counted */
+  int64_t m_size{-1};
+  uint64_t m_distance_count{0};
+  float m_min_distance{0};
+  float m_max_distance{0};
+  float m_avg_distance{0};
 };
 
+/**
+  collects the distances of the ivf list entries a compaction keeps to their
+  centroid, and hands them to the index when destroyed. one per compaction
+  and index, used by the compaction thread only.
+*/
+class Rdb_vector_compaction_stats {
+ public:
+  virtual ~Rdb_vector_compaction_stats() = default;
+
+  virtual void add_entry(const rocksdb::Slice &key,
+                         const rocksdb::Slice &value) = 0;
+};
+
+/**
+  predicate evaluated on a scanned row before it is scored, clears *match to
+  drop the row. always called from the thread that owns the handler.
+*/
+using Rdb_vector_row_filter =
+    std::function<uint(const rocksdb::Slice &key, const rocksdb::Slice &value,
+                       bool *match)>;
+
 class Rdb_vector_search_params {
  public:
   FB_VECTOR_INDEX_METRIC m_metric = FB_VECTOR_INDEX_METRIC::NONE;
   uint m_k = 0;
   uint m_nprobe = 0;
+  // number of threads an lsm scan may split its candidates across
+  uint m_threads = 1;
+  // ivf probes lists until about this many candidates, 0 uses m_nprobe
+  uint m_target_candidates = 0;
   float m_weight = 0;
-  std::string m_query_coordinate;
+  // query geometry of a hybrid search, owned by the handler
+  const Next_spatial_query_geometry *m_query_geometry = nullptr;
+  // pushed down condition of lsm scans, empty when there is none
+  Rdb_vector_row_filter m_row_filter;
+  // ivf searches read only the entries whose pk starts with these packed
+  // leading pk columns, empty reads all entries
+  std::string m_pk_prefix;
+  // ivf searches of a pk prefix read every list, an exact search
+  bool m_search_all_lists = false;
+  // primary key of the table, sparse searches read the rows of zero score
+  // from it, see rdb_sparse_vector_search()
+  const Rdb_key_def *m_pk_descr = nullptr;
+};
+
+/**
+  cache of vector column values decoded from the json binary stored in the
+  row, used by lsm vector index scans so a hot row is decoded only once.
+  entries are keyed by the rocksdb row key and remember a hash of the encoded
+  value they were decoded from. an entry whose hash does not match the row
+  being scanned is a miss, so writes never need to invalidate the cache.
+*/
+class Rdb_vector_value_cache {
+ public:
+  using Vector_ptr = std::shared_ptr<const std::vector<float>>;
+
+  Rdb_vector_value_cache() = default;
+  Rdb_vector_value_cache(const Rdb_vector_value_cache &) = delete;
+  Rdb_vector_value_cache &operator=(const Rdb_vector_value_cache &) = delete;
+
+  bool enabled() const {
+    return m_capacity.load(std::memory_order_relaxed) > 0;
+  }
+
+  /**
+    capacity in bytes, 0 disables the cache and drops all entries
+  */
+  void set_capacity(uint64_t capacity);
+
+  Vector_ptr lookup(const rocksdb::Slice &key, uint64_t value_hash);
+
+  void insert(const rocksdb::Slice &key, uint64_t value_hash,
+              Vector_ptr vector);
+
+  uint64_t usage() const;
+  uint64_t hits() const { return m_hits.load(std::memory_order_relaxed); }
+  uint64_t misses() const { return m_misses.load(std::memory_order_relaxed); }
+
+ private:
+  static constexpr uint NUM_SHARDS = 16;
+
+  struct Entry {
+    uint64_t m_value_hash;
+    Vector_ptr m_vector;
+    std::size_t m_charge;
+    std::list<std::string>::iterator m_lru_pos;
+  };
+
+  struct Shard {
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    // most recently used key at the front
+    std::list<std::string> m_lru;
+    uint64_t m_usage = 0;
+  };
+
+  Shard &get_shard(const std::string &key) {
+    return m_shards[std::hash<std::string>{}(key) % NUM_SHARDS];
+  }
+
+  // evict from the tail until the shard fits in capacity. caller holds
+  // the shard mutex.
+  void evict(Shard &shard, uint64_t shard_capacity);
+
+  std::atomic<uint64_t> m_capacity{0};
+  std::atomic<uint64_t> m_hits{0};
+  std::atomic<uint64_t> m_misses{0};
+  Shard m_shards[NUM_SHARDS];
+};
+
+Rdb_vector_value_cache &rdb_get_vector_value_cache();
+
+/**
+  cache of knn search results of one vector index, keyed by the search
+  parameters and the exact query vector. entries remember the write sequence
+  number of the index they were computed at, once a write bumped it they are
+  misses, so writes never need to walk the cache.
+*/
+class Rdb_vector_result_cache {
+ public:
+  using Result = std::vector<std::pair<std::string, float>>;
+
+  Rdb_vector_result_cache() = default;
+  Rdb_vector_result_cache(const Rdb_vector_result_cache &) = delete;
+  Rdb_vector_result_cache &operator=(const Rdb_vector_result_cache &) = delete;
+
+  /**
+    copy the result cached for key into result, return false on a miss
+  */
+  bool lookup(const std::string &key, uint64_t write_seq,
+              Rdb_vector_result &result);
+
+  /**
+    cache result, evicting the least recently used entries beyond capacity.
+    the cache outlives the statement, its copy is not charged to it.
+  */
+  void insert(const std::string &key, uint64_t write_seq,
+              const Rdb_vector_result &result, uint capacity);
+
+  uint64_t hits() const { return m_hits.load(std::memory_order_relaxed); }
+  uint64_t misses() const { return m_misses.load(std::memory_order_relaxed); }
+
+ private:
+  struct Entry {
+    uint64_t m_write_seq;
+    Result m_result;
+    std::list<std::string>::iterator m_lru_pos;
+  };
+
+  std::mutex m_mutex;
+  std::unordered_map<std::string, Entry> m_entries;
+  // most recently used key at the front
+  std::list<std::string> m_lru;
+  std::atomic<uint64_t> m_hits{0};
+  std::atomic<uint64_t> m_misses{0};
+};
+
+/**
+  the entries of an ivf list as faiss scans them, the codes of all entries
+  back to back and the keys they belong to
+*/
+struct Rdb_vector_cached_list {
+  std::string m_codes;
+  std::string m_keys;
+  // end offset in m_keys of the key of each entry
+  std::vector<uint32_t> m_key_ends;
+
+  std::size_t size() const { return m_key_ends.size(); }
+
+  rocksdb::Slice key(std::size_t i) const {
+    const uint32_t begin = i == 0 ? 0 : m_key_ends[i - 1];
+    return rocksdb::Slice(m_keys.data() + begin, m_key_ends[i] - begin);
+  }
+};
+
+/**
+  cache of the hot lists of ivf indexes, keyed by index id and list id, so
+  that the lists most searches probe are scanned from memory rather than
+  read and split from rocksdb entries, and are not evicted from the block
+  cache by unrelated scans.
+
+  lists are admitted on their ADMIT_MISSES-th miss, lists probed once in a
+  while never displace hot ones. every list keeps its write state: the
+  transactions with uncommitted writes to it and the latest sequence number
+  it was committed at, see rdb_tx_note_vector_list_write. a cached list is
+  the list as of the snapshot it was read at, it is served to snapshots
+  taken after the last commit to the list while no writes are pending, the
+  list cannot differ between those snapshots.
+*/
+class Rdb_vector_list_cache {
+ public:
+  using List_ptr = std::shared_ptr<const Rdb_vector_cached_list>;
+
+  Rdb_vector_list_cache() = default;
+  Rdb_vector_list_cache(const Rdb_vector_list_cache &) = delete;
+  Rdb_vector_list_cache &operator=(const Rdb_vector_list_cache &) = delete;
+
+  bool enabled() const {
+    return m_capacity.load(std::memory_order_relaxed) > 0;
+  }
+
+  /**
+    capacity in bytes, 0 disables the cache and drops all lists
+  */
+  void set_capacity(uint64_t capacity);
+
+  /**
+    the list for a reader of snapshot seq, nullptr on a miss. admit is set
+    when the caller should read the list into the cache.
+  */
+  List_ptr lookup(Index_id index_id, uint64 list_id,
+                  rocksdb::SequenceNumber seq, bool *admit);
+
+  /**
+    cache list read at snapshot seq, dropped if the list was written since
+  */
+  void insert(Index_id index_id, uint64 list_id, rocksdb::SequenceNumber seq,
+              List_ptr list);
+
+  /**
+    a transaction wrote to the list, lookups miss until it ends
+  */
+  void begin_write(Index_id index_id, uint64 list_id);
+
+  /**
+    the transaction ended, commit_seq is 0 when it rolled back
+  */
+  void end_write(Index_id index_id, uint64 list_id,
+                 rocksdb::SequenceNumber commit_seq);
+
+  /**
+    drop the lists of an index whose entries were written without going
+    through transactions, e.g. by a bulk load
+  */
+  void drop_index(Index_id index_id);
+
+  /**
+    the lists of an index with uncommitted writes, each with the number of
+    times it was left by its last writer so far
+  */
+  std::vector<std::pair<uint64, uint64>> writing_lists(
+      Index_id index_id) const;
+
+  /**
+    whether every transaction that was writing to the lists when
+    writing_lists returned them has ended
+  */
+  bool writers_ended(Index_id index_id,
+                     const std::vector<std::pair<uint64, uint64>> &lists) const;
+
+  /** largest list worth reading into the cache */
+  uint64_t max_charge() const {
+    return m_capacity.load(std::memory_order_relaxed) / NUM_SHARDS;
+  }
+
+  uint64_t usage() const;
+
+ private:
+  static constexpr uint NUM_SHARDS = 16;
+  static constexpr uint ADMIT_MISSES = 2;
+
+  using Key = std::pair<Index_id, uint64>;
+
+  struct Key_hash {
+    std::size_t operator()(const Key &key) const {
+      return std::hash<uint64>{}(key.second * 31 + key.first);
+    }
+  };
+
+  struct List_state {
+    // transactions with uncommitted writes to the list
+    uint m_writers = 0;
+    // times m_writers dropped to 0
+    uint64 m_idle_count = 0;
+    rocksdb::SequenceNumber m_commit_seq = 0;
+    uint m_misses = 0;
+    List_ptr m_list;
+    rocksdb::SequenceNumber m_list_seq = 0;
+    std::size_t m_charge = 0;
+    std::list<Key>::iterator m_lru_pos;
+  };
+
+  struct Shard {
+    mutable std::mutex m_mutex;
+    // write states are kept when lists are evicted, there are as many as
+    // lists ever read or written
+    std::unordered_map<Key, List_state, Key_hash> m_states;
+    // most recently used cached list at the front
+    std::list<Key> m_lru;
+    uint64_t m_usage = 0;
+  };
+
+  Shard &get_shard(const Key &key) {
+    return m_shards[Key_hash{}(key) % NUM_SHARDS];
+  }
+
+  // drop the cached list of state. caller holds the shard mutex.
+  static void drop_list(Shard &shard, List_state &state);
+
+  // evict from the tail until the shard fits in capacity. caller holds
+  // the shard mutex.
+  static void evict(Shard &shard, uint64_t shard_capacity);
+
+  std::atomic<uint64_t> m_capacity{0};
+  Shard m_shards[NUM_SHARDS];
+};
+
+Rdb_vector_list_cache &rdb_get_vector_list_cache();
+
+/**
+  counters of the knn searches of one vector index, shown by
+  information_schema.rocksdb_vector_index_stats. times are in microseconds.
+*/
+class Rdb_vector_search_stats {
+ public:
+  // upper bounds of the latency buckets, the last bucket is unbounded
+  static constexpr uint64_t LATENCY_BOUNDS_US[] = {100, 1000, 10000, 100000,
+                                                   1000000};
+  static constexpr std::size_t LATENCY_BUCKETS =
+      std::size(LATENCY_BOUNDS_US) + 1;
+
+  /**
+    count one search and its end to end latency
+  */
+  void add_search(uint64_t us) {
+    add(m_searches, 1);
+    std::size_t bucket = 0;
+    while (bucket < std::size(LATENCY_BOUNDS_US) &&
+           us >= LATENCY_BOUNDS_US[bucket]) {
+      bucket++;
+    }
+    add(m_latency[bucket], 1);
+  }
+
+  /**
+    count the lists probed by a search and the vectors whose codes it decoded
+  */
+  void add_scan(uint64_t lists, uint64_t vectors, uint64_t bytes,
+                uint64_t assign_us, uint64_t scan_us) {
+    add(m_lists_probed, lists);
+    add(m_vectors_scanned, vectors);
+    add(m_bytes_decoded, bytes);
+    add(m_assign_time_us, assign_us);
+    add(m_scan_time_us, scan_us);
+  }
+
+  /**
+    count the rows fetched from the primary key for a search
+  */
+  void add_fetch(uint64_t rows, uint64_t us) {
+    add(m_fetch_rows, rows);
+    add(m_fetch_time_us, us);
+  }
+
+  uint64_t searches() const { return load(m_searches); }
+  uint64_t lists_probed() const { return load(m_lists_probed); }
+  uint64_t vectors_scanned() const { return load(m_vectors_scanned); }
+  uint64_t bytes_decoded() const { return load(m_bytes_decoded); }
+  uint64_t assign_time_us() const { return load(m_assign_time_us); }
+  uint64_t scan_time_us() const { return load(m_scan_time_us); }
+  uint64_t fetch_rows() const { return load(m_fetch_rows); }
+  uint64_t fetch_time_us() const { return load(m_fetch_time_us); }
+  uint64_t latency(std::size_t bucket) const {
+    return load(m_latency[bucket]);
+  }
+
+ private:
+  static void add(std::atomic<uint64_t> &counter, uint64_t value) {
+    counter.fetch_add(value, std::memory_order_relaxed);
+  }
+  static uint64_t load(const std::atomic<uint64_t> &counter) {
+    return counter.load(std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> m_searches{0};
+  std::atomic<uint64_t> m_lists_probed{0};
+  std::atomic<uint64_t> m_vectors_scanned{0};
+  std::atomic<uint64_t> m_bytes_decoded{0};
+  std::atomic<uint64_t> m_assign_time_us{0};
+  std::atomic<uint64_t> m_scan_time_us{0};
+  std::atomic<uint64_t> m_fetch_rows{0};
+  std::atomic<uint64_t> m_fetch_time_us{0};
+  std::atomic<uint64_t> m_latency[LATENCY_BUCKETS] = {};
 };
 
 /**
@@ -100,53 +547,136 @@ class Rdb_vector_index {
   virtual void assign_vector(const float *data,
                              Rdb_vector_index_assignment &assignment) = 0;
 
+  /**
+    assign n vectors stored one after another to the index, used when an
+    index is built over existing rows and by bulk inserts. the default
+    assigns them one by one.
+  */
+  virtual void assign_vectors(
+      std::size_t n, const float *data,
+      std::vector<Rdb_vector_index_assignment> &assignments) {
+    assignments.resize(n);
+    for (std::size_t i = 0; i < n; i++) {
+      assign_vector(data + i * dimension(), assignments[i]);
+    }
+  }
+
   virtual uint knn_search(
       THD *thd, const TABLE *const tbl, Item *pk_index_cond,
       const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
-      Rdb_vector_search_params &params,
-      std::vector<std::pair<std::string, float>> &result) = 0;
+      Rdb_vector_search_params &params, Rdb_vector_result &result) = 0;
 
   virtual uint knn_search_with_value(
       THD *thd, const TABLE *const tbl, Item *pk_index_cond,
       const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
+      Rdb_vector_search_params &params, Rdb_vector_result_with_value &result) {
+    return HA_ERR_UNSUPPORTED;
+  }
+
+  /**
+    knn search for many query vectors at once. results[i] holds the
+    neighbours of query_vectors[i]. the default runs knn_search once per
+    query, index types that can share list scans across queries override it.
+  */
+  virtual uint knn_search_batch(
+      THD *thd, const TABLE *const tbl, Item *pk_index_cond,
+      const Rdb_key_def *sk_descr,
+      std::vector<std::vector<float>> &query_vectors,
       Rdb_vector_search_params &params,
-      std::vector<std::pair<std::string, std::pair<float, std::string>>>
-          &result) {
+      std::vector<Rdb_vector_result> &results) {
+    results.clear();
+    results.resize(query_vectors.size());
+    for (std::size_t i = 0; i < query_vectors.size(); i++) {
+      uint rtn = knn_search(thd, tbl, pk_index_cond, sk_descr,
+                            query_vectors[i], params, results[i]);
+      if (rtn) {
+        return rtn;
+      }
+    }
+    return HA_EXIT_SUCCESS;
+  }
+
+  /**
+    knn search of a multi-vector index, ranking rows by FB_VECTOR_MAXSIM()
+    of the query vectors held one after the other in query_vector
+  */
+  virtual uint knn_search_maxsim(
+      THD *thd [[maybe_unused]], const TABLE *const tbl [[maybe_unused]],
+      Item *pk_index_cond [[maybe_unused]],
+      const Rdb_key_def *sk_descr [[maybe_unused]],
+      std::vector<float> &query_vector [[maybe_unused]],
+      Rdb_vector_search_params &params [[maybe_unused]],
+      Rdb_vector_result &result [[maybe_unused]]) {
+    return HA_ERR_UNSUPPORTED;
+  }
+
+  /**
+    knn search of a sparse vector index, ranking rows by their inner
+    product with query. the results are pks with their scores.
+  */
+  virtual uint knn_search_sparse(
+      THD *thd [[maybe_unused]], const TABLE *const tbl [[maybe_unused]],
+      const Rdb_key_def *sk_descr [[maybe_unused]],
+      const Fb_sparse_vector &query [[maybe_unused]],
+      Rdb_vector_search_params &params [[maybe_unused]],
+      Rdb_vector_result &result [[maybe_unused]]) {
     return HA_ERR_UNSUPPORTED;
   }
 
   virtual uint knn_search_hybrid_with_value(
       THD *thd, const TABLE *const tbl, Item *pk_index_cond,
       const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
-      Rdb_vector_search_params &params,
-      std::vector<std::pair<std::string, std::pair<float, std::string>>>
-          &result) {
+      Rdb_vector_search_params &params, Rdb_vector_result_with_value &result) {
     return HA_ERR_UNSUPPORTED;
   }
 
   virtual uint index_scan(
       THD *thd, const TABLE *const tbl, Item *pk_index_cond,
       const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
-      uint nprobe,
+      const Rdb_vector_search_params &params,
       std::unique_ptr<Rdb_vector_db_iterator> &index_scan_result_iter) = 0;
 
   virtual uint index_scan_with_value(
       THD *thd, const TABLE *const tbl, Item *pk_index_cond,
       const Rdb_key_def *sk_descr, std::vector<float> &query_vector,
-      uint nprobe,
-      std::vector<std::pair<std::string, std::pair<float, std::string>>>
-          &result) {
+      Rdb_vector_search_params &params, Rdb_vector_result_with_value &result) {
         return HA_ERR_UNSUPPORTED;
       }
 
   /**
-    scans all vectors in index and populate counters
+    scans all vectors in index and populate counters. thd is nullptr when
+    called from the background stats thread.
   */
   virtual uint analyze(THD *thd, uint64_t max_num_rows_scanned,
                        std::atomic<THD::killed_state> *killed) = 0;
 
   virtual Rdb_vector_index_info dump_info() = 0;
 
+  /** the ivf lists of the index, empty for other index types */
+  virtual std::vector<Rdb_vector_list_info> dump_lists() { return {}; }
+
+  /**
+    stats collector for the entries of the index seen by a compaction,
+    nullptr when the index type keeps none
+  */
+  virtual std::unique_ptr<Rdb_vector_compaction_stats>
+  new_compaction_stats() {
+    return nullptr;
+  }
+
+  /**
+    rough number of stored vectors a knn search for k rows compares the query
+    against, used by the optimizer to cost vector index scans. 0 when the
+    index does not know its size yet.
+  */
+  virtual uint64_t search_candidates(uint k [[maybe_unused]],
+                                     uint nprobe [[maybe_unused]],
+                                     uint target_candidates
+                                     [[maybe_unused]]) {
+    // scans every vector
+    return std::max<int64_t>(dump_info().m_ntotal, 0);
+  }
+
   virtual FB_vector_dimension dimension() const = 0;
 
   virtual const FB_vector_index_config &get_config() const = 0;
@@ -155,6 +685,78 @@ class Rdb_vector_index {
                      Rdb_cmd_srv_helper &cmd_srv_helper [[maybe_unused]]) {
     return HA_EXIT_SUCCESS;
   }
+
+  /**
+    called by the write path after the secondary key entry of a row was
+    written to wb. old_key is empty for inserts, new_key is empty for
+    deletes. index types that keep state next to the entries, like the
+    graph neighbor lists, update it here in the same write batch.
+  */
+  virtual uint on_entry_update(Rdb_transaction *tx [[maybe_unused]],
+                               rocksdb::WriteBatchBase *wb [[maybe_unused]],
+                               const rocksdb::Slice &old_key
+                               [[maybe_unused]],
+                               const rocksdb::Slice &old_value
+                               [[maybe_unused]],
+                               const rocksdb::Slice &new_key
+                               [[maybe_unused]],
+                               const rocksdb::Slice &new_value
+                               [[maybe_unused]]) {
+    return HA_EXIT_SUCCESS;
+  }
+
+  /**
+    called once the entries of a new index were bulk loaded by an online
+    alter, bulk loading bypasses on_entry_update.
+  */
+  virtual uint populate(THD *thd [[maybe_unused]]) { return HA_EXIT_SUCCESS; }
+
+  /**
+    trains new centroids from a sample of the stored vectors and moves the
+    entries over to them while the index stays online. runs in the calling
+    thread until the new centroids are in use.
+  */
+  virtual uint retrain(THD *thd [[maybe_unused]]) {
+    return HA_ERR_UNSUPPORTED;
+  }
+
+  /**
+    called when entries of the index are written and again when the writes
+    commit, invalidates the cached knn results
+  */
+  void note_write() { m_write_seq.fetch_add(1, std::memory_order_relaxed); }
+
+  uint64_t write_seq() const {
+    return m_write_seq.load(std::memory_order_relaxed);
+  }
+
+  Rdb_vector_result_cache &result_cache() { return m_result_cache; }
+
+  Rdb_vector_search_stats &search_stats() { return m_search_stats; }
+
+  void note_list_cache_lookup(bool hit) {
+    m_list_cache_lookups.fetch_add(1, std::memory_order_relaxed);
+    if (hit) {
+      m_list_cache_hits.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /** share of the lists probed that were served by the list cache */
+  double list_cache_hit_rate() const {
+    const uint64_t lookups =
+        m_list_cache_lookups.load(std::memory_order_relaxed);
+    return lookups == 0 ? 0
+                        : static_cast<double>(m_list_cache_hits.load(
+                              std::memory_order_relaxed)) /
+                              lookups;
+  }
+
+ private:
+  std::atomic<uint64_t> m_write_seq{0};
+  std::atomic<uint64_t> m_list_cache_lookups{0};
+  std::atomic<uint64_t> m_list_cache_hits{0};
+  Rdb_vector_result_cache m_result_cache;
+  Rdb_vector_search_stats m_search_stats;
 };
 
 uint create_vector_index(Rdb_cmd_srv_helper &cmd_srv_helper,
@@ -164,6 +766,18 @@ uint create_vector_index(Rdb_cmd_srv_helper &cmd_srv_helper,
                          const Index_id index_id,
                          std::unique_ptr<Rdb_vector_index> &index);
 
+// bytes of the number of vectors of an entry of a multi-vector index
+constexpr std::size_t RDB_MULTI_VECTOR_COUNT_SIZE = sizeof(uint32);
+
+/**
+  the entries of a row of a multi-vector index from the assignments of its
+  vectors, one per list. the codes of an entry are the number of vectors of
+  the row in the list, 4 bytes, followed by their codes.
+*/
+void rdb_multi_vector_entries(
+    const std::vector<Rdb_vector_index_assignment> &assignments,
+    std::vector<Rdb_vector_index_assignment> *entries);
+
 /**
   one instance per handler, hold the vector buffers and knn results for the
   handler.
@@ -212,6 +826,13 @@ class Rdb_vector_db_handler {
   uint current_key(std::string &key) const;
   uint current_value(std::string &value) const;
 
+  /**
+    the keys of the current result and of at most n - 1 results after it,
+    as far as the search already holds them. an index scan reads its
+    results one at a time and has none past the current one.
+  */
+  void upcoming_keys(size_t n, std::vector<std::string> *keys) const;
+
   uint search(THD *thd, const TABLE *const tbl, Rdb_vector_index *index,
               const Rdb_key_def *sk_descr, Item *pk_index_cond);
 
@@ -224,58 +845,193 @@ class Rdb_vector_db_handler {
   uint knn_search_hybrid(THD *thd, const TABLE *const tbl, Rdb_vector_index *index,
                   const Rdb_key_def *sk_descr, Item *pk_index_cond);
 
+  /**
+    runs the knn searches for a batch of query vectors the handler is about
+    to be asked for, e.g. by the outer rows of a knn join, as one batched
+    index search. a later search() with one of these vectors returns the
+    prefetched neighbours. searches with a pushed condition are not
+    prefetched, the condition may depend on the outer row.
+  */
+  uint prefetch(THD *thd, const TABLE *const tbl, Rdb_vector_index *index,
+                const Rdb_key_def *sk_descr, Item *pk_index_cond,
+                std::vector<std::vector<float>> &query_vectors);
+
+  /**
+    called when the knn results ran out before the query had enough rows,
+    e.g. because a join or WHERE condition rejected them. searches again
+    probing twice as many lists and keeps the closest rows that were not
+    returned yet, so the caller can keep reading in distance order. leaves
+    no results once a round finds nothing new.
+  */
+  uint expand_search(THD *thd, const TABLE *const tbl, Rdb_vector_index *index,
+                     const Rdb_key_def *sk_descr, Item *pk_index_cond);
+
+  /**
+    quantized codes only approximate the distance, so knn searches on such
+    indexes fetch rocksdb_vector_rerank_factor times LIMIT candidates, and
+    the caller re-ranks them by the exact distance evaluated on the rows.
+    maxsim searches only estimate the scores of rows, so they always are.
+  */
+  bool needs_rerank(const Rdb_vector_index *index) const;
+
+  /**
+    exact distance of a stored vector, as read by Rdb_key_def::read_vector,
+    to the query vector, as the distance function computes it
+  */
+  float exact_distance(const std::vector<float> &vector) const;
+
+  /**
+    replace the knn candidates by the LIMIT closest of the re-ranked rows
+  */
+  void set_reranked_result(Rdb_vector_result &&rows);
+
+  /**
+    the MATCH ... AGAINST term of a hybrid ORDER BY, whose fulltext matches
+    the knn results are fused with, or nullptr
+  */
+  Item_func_match *text_relevance() const { return m_text_relevance; }
+
+  /** the keys and scores of the knn results, best first */
+  void knn_results(Rdb_vector_result *rows) const;
+
+  /**
+    replace the knn results by their fusion with the matches of the
+    fulltext search, both given by rowid, best first. with rrf a row scores
+    1 / (rrf_k + rank) in each ranking, the text rank weighted by the text
+    weight. otherwise it scores its distance plus the weighted relevance, a
+    row missing from one ranking gets the worst score of that ranking, or a
+    relevance of 0 when all_text_rows holds every match.
+  */
+  void fuse_text_matches(Rdb_vector_result &&vector_rows,
+                         const std::vector<Rdb_fulltext_match> &text_rows,
+                         bool all_text_rows, bool rrf, uint rrf_k);
+
+  /** whether the results are rowids, as after fuse_text_matches() */
+  bool results_are_rowids() const { return m_results_are_rowids; }
+
+  /**
+    rows failing the filter are skipped by lsm scans before they compete for
+    the top k, so a filtered search still returns up to LIMIT matching rows
+  */
+  void set_row_filter(Rdb_vector_row_filter filter) {
+    m_row_filter = std::move(filter);
+  }
+
+  /**
+    restrict ivf searches to the entries whose pk starts with prefix, the
+    leading pk columns a pushed condition fixes, e.g. the tenant of a table
+    shared by many tenants. the entries of a list are sorted by pk, so the
+    search reads only the entries of the prefix, however many rows other
+    prefixes have. with all_lists it reads every list of the prefix, which
+    has few enough rows to compare all of them. an empty prefix searches
+    all entries.
+  */
+  void set_pk_prefix(std::string prefix, bool all_lists) {
+    m_pk_prefix = std::move(prefix);
+    m_search_all_lists = all_lists;
+  }
+
+  /**
+    whether knn searches may use the result cache of the index. the caller
+    turns it off for transactions that wrote rows, their searches see
+    uncommitted entries other transactions must not be served.
+  */
+  void set_result_cache_enabled(bool enabled) {
+    m_result_cache_enabled = enabled;
+  }
+
+  /**
+    primary key of the table. sparse searches finding fewer than LIMIT rows
+    that share an index with the query take the rest of the rows, whose
+    inner product is zero, from it.
+  */
+  void set_pk_descr(const Rdb_key_def *pk_descr) { m_pk_descr = pk_descr; }
+
+  Item_func_fb_vector_distance *distance_func() const {
+    return m_distance_func;
+  }
+
   int vector_index_orderby_init(Item *sort_func) {
     // log_to_file("vector_index_orderby_init");
-    Item_func_fb_vector_distance * distance_func;
-    Item_func *func = (Item_func *)(sort_func);
-    if ((strcmp(func->func_name(), "+") == 0)) {
-      // log_to_file("vector_index_orderby_init: parsing weighted distance function ");
-      Item *arg0 = (Item *)func->arguments()[0];
-      arg0 = arg0->real_item();
-      distance_func =
-            down_cast<Item_func_fb_vector_distance *>((Item_func *)arg0);
-        
-    } else{
-      distance_func = down_cast<Item_func_fb_vector_distance *>(sort_func);
-    }
+    Fb_hybrid_score score;
+    // index_supports_vector_scan() already accepted the expression
+    fb_parse_hybrid_score(sort_func, &score);
+    Item_func_fb_vector_distance *distance_func = score.m_vector_distance;
+    m_distance_func = distance_func;
     m_limit = distance_func->m_limit;
     m_search_type = distance_func->m_search_type;
     m_nprobe = distance_func->m_nprobe;
+    m_threads = distance_func->m_threads;
+    m_target_candidates = distance_func->m_target_candidates;
+    m_distance_bound = distance_func->m_distance_bound;
     // log_to_file("m_search_type: " + std::to_string(m_search_type) +
     //             ", m_limit: " + std::to_string(m_limit) +
     //             ", m_nprobe: " + std::to_string(m_nprobe));
     if (m_search_type == FB_VECTOR_SEARCH_KNN_HYBRID) {
       m_weight = distance_func->m_weight;
-      m_query_coordinate = distance_func->m_query_coordinate;
-      // log_to_file("m_weight: " + std::to_string(m_weight) +
-      //             ", m_query_coordinate: ");
-      // log_to_file_raw(m_query_coordinate);
+      m_query_geometry = distance_func->m_query_geometry;
+      // log_to_file("m_weight: " + std::to_string(m_weight));
     } 
+    // an index scan is reordered by a filesort on the whole ORDER BY
+    if (m_search_type == FB_VECTOR_SEARCH_KNN_FIRST) {
+      m_text_relevance = distance_func->m_text_relevance;
+      m_text_weight = distance_func->m_text_weight;
+    }
 
     auto functype = distance_func->functype();
     if (functype == Item_func::FB_VECTOR_L2) {
       m_metric = FB_VECTOR_INDEX_METRIC::L2;
     } else if (functype == Item_func::FB_VECTOR_IP) {
       m_metric = FB_VECTOR_INDEX_METRIC::IP;
+    } else if (functype == Item_func::FB_VECTOR_COSINE) {
+      m_metric = FB_VECTOR_INDEX_METRIC::COSINE;
+    } else if (functype == Item_func::FB_VECTOR_MAXSIM) {
+      m_metric = FB_VECTOR_INDEX_METRIC::MAXSIM;
     } else {
       // should never happen
       assert(false);
       return HA_ERR_UNSUPPORTED;
     }
 
-    if (distance_func->get_input_vector(m_buffer)) {
+    return read_query_vector(m_buffer);
+  }
+
+  /**
+    read the query vector of the ORDER BY distance into buffer, for cosine
+    it is normalized to unit length. a sparse query is read into
+    m_sparse_buffer, leaving buffer empty.
+  */
+  uint read_query_vector(std::vector<float> &buffer) {
+    if (m_distance_func->get_input_vector(buffer) ||
+        m_distance_func->get_input_sparse_vector(m_sparse_buffer)) {
       return HA_EXIT_FAILURE;
     }
+    // with a unit query the cosine similarity is an inner product
+    // against the normalized stored vectors
+    if (m_metric == FB_VECTOR_INDEX_METRIC::COSINE) {
+      fb_vector_normalize_l2(buffer.data(), buffer.size());
+    }
     return HA_EXIT_SUCCESS;
   }
 
   void vector_index_orderby_end() {
     m_search_type = FB_VECTOR_SEARCH_KNN_FIRST;
     m_metric = FB_VECTOR_INDEX_METRIC::NONE;
+    m_distance_func = nullptr;
     // reset ORDER BY related
     m_limit = 0;
     m_nprobe = 0;
+    m_threads = 1;
+    m_target_candidates = 0;
+    m_distance_bound.reset();
+    m_text_relevance = nullptr;
+    m_text_weight = 0;
+    m_results_are_rowids = false;
+    m_row_filter = nullptr;
+    m_returned_keys.clear();
+    m_prefetched.clear();
     m_buffer.clear();
+    m_sparse_buffer.clear();
 
     if (m_index_scan_result_iter) {
       m_index_scan_result_iter = nullptr;
@@ -285,18 +1041,52 @@ class Rdb_vector_db_handler {
  private:
   // input vector from the USER query,
   std::vector<float> m_buffer;
+  // sparse input vector from the USER query, searched by sparse indexes
+  Fb_sparse_vector m_sparse_buffer;
   enum_fb_vector_search_type m_search_type = FB_VECTOR_SEARCH_KNN_FIRST;
-  std::vector<std::pair<std::string, float>> m_search_result;
-  std::vector<std::pair<std::string, std::pair<float, std::string>>> m_search_result_with_value;
+  Rdb_vector_result m_search_result;
+  Rdb_vector_result_with_value m_search_result_with_value;
   decltype(m_search_result.cbegin()) m_vector_db_result_iter;
   decltype(m_search_result_with_value.cbegin()) m_vector_db_result_with_value_iter;
   std::unique_ptr<Rdb_vector_db_iterator> m_index_scan_result_iter = nullptr;
   FB_VECTOR_INDEX_METRIC m_metric = FB_VECTOR_INDEX_METRIC::NONE;
+  Item_func_fb_vector_distance *m_distance_func = nullptr;
   // LIMIT associated with the ORDER BY clause
   uint m_limit;
   uint m_nprobe;
+  uint m_threads = 1;
+  uint m_target_candidates = 0;
+  // the WHERE condition drops the knn results ranked beyond it anyway
+  std::optional<double> m_distance_bound;
   float m_weight;
-  std::string m_query_coordinate;
+  Next_spatial_query_geometry m_query_geometry;
+  Item_func_match *m_text_relevance = nullptr;
+  float m_text_weight = 0;
+  bool m_results_are_rowids = false;
+  Rdb_vector_row_filter m_row_filter;
+  std::string m_pk_prefix;
+  bool m_search_all_lists = false;
+  const Rdb_key_def *m_pk_descr = nullptr;
+  bool m_result_cache_enabled = true;
+  // nprobe and target candidates of the current knn round
+  uint m_search_nprobe = 0;
+  uint m_search_target_candidates = 0;
+  // keys returned by earlier knn rounds of this search
+  std::unordered_set<std::string> m_returned_keys;
+  // knn results of prefetched queries, keyed by the query vector bytes
+  std::unordered_map<std::string, Rdb_vector_result>
+      m_prefetched;
+
+  /** if a knn result of this score is ranked beyond m_distance_bound */
+  bool beyond_distance_bound(float score) const {
+    // l2 is a distance, ip and cosine are similarities
+    return m_metric == FB_VECTOR_INDEX_METRIC::L2 ? score > *m_distance_bound
+                                                  : score < *m_distance_bound;
+  }
+
+  /** pad the query vector to the index dimension, fails if it is longer */
+  uint fit_query_vector(const Rdb_vector_index *index,
+                        std::vector<float> &query_vector) const;
 
   uint decode_value_to_buffer(Field *field, FB_vector_dimension dimension,
                               std::vector<float> &buffer);
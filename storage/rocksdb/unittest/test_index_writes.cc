@@ -0,0 +1,130 @@
+/*
+   Copyright (c) 2023, Facebook, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+// C++ standard header files
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+/* RocksDB header files */
+#include "rocksdb/comparator.h"
+#include "rocksdb/db.h"
+#include "rocksdb/env.h"
+#include "rocksdb/utilities/write_batch_with_index.h"
+
+/* MyRocks header files */
+#include "../rdb_buff.h"
+#include "../rdb_datadic.h"
+#include "../rdb_utils.h"
+
+// Unlike assert(), the checks also run in release builds.
+static void check(bool condition) {
+  if (!condition) abort();
+}
+
+static std::string index_key(uint32 index_number, const std::string &suffix) {
+  uchar buf[myrocks::Rdb_key_def::INDEX_NUMBER_SIZE];
+  myrocks::rdb_netbuf_store_index(buf, index_number);
+  return std::string(reinterpret_cast<char *>(buf), sizeof(buf)) + suffix;
+}
+
+static bool has_index_writes(rocksdb::WriteBatchWithIndex *batch,
+                             rocksdb::ColumnFamilyHandle *cf,
+                             bool is_reverse_cf, uint32 index_number) {
+  const std::string prefix = index_key(index_number, "");
+  return myrocks::rdb_batch_has_prefix(batch, cf, prefix, is_reverse_cf);
+}
+
+static int count_rows(rocksdb::Iterator *it, uint32 index_number) {
+  const std::string prefix = index_key(index_number, "");
+  int rows = 0;
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    if (it->key().starts_with(prefix)) rows++;
+  }
+  check(it->status().ok());
+  return rows;
+}
+
+/*
+  One transaction writes to an index and then reads it, the way
+  rdb_tx_merges_batch() and Rdb_iterator_base::setup_scan_iterator() decide
+  whether the read merges the write batch.
+*/
+static void check_index_writes(rocksdb::DB *db, rocksdb::ColumnFamilyHandle *cf,
+                               bool is_reverse_cf) {
+  const rocksdb::WriteOptions write_opts;
+  check(db->Put(write_opts, cf, index_key(0x101, "a"), "").ok());
+  check(db->Put(write_opts, cf, index_key(0x103, "a"), "").ok());
+
+  rocksdb::WriteBatchWithIndex batch(rocksdb::BytewiseComparator(), 0, true);
+  const rocksdb::ReadOptions read_opts;
+
+  // Nothing written yet: the scan iterator reads the snapshot alone and
+  // the server caches it.
+  check(!has_index_writes(&batch, cf, is_reverse_cf, 0x101));
+  std::unique_ptr<rocksdb::Iterator> cached(db->NewIterator(read_opts, cf));
+  check(count_rows(cached.get(), 0x101) == 1);
+
+  // Writes to the indexes on either side do not touch index 0x101.
+  check(batch.Put(cf, index_key(0x100, "z"), "").ok());
+  check(batch.Put(cf, index_key(0x102, ""), "").ok());
+  check(!has_index_writes(&batch, cf, is_reverse_cf, 0x101));
+
+  // The transaction writes to index 0x101. The cached iterator misses the
+  // row, so it has to be recreated over the write batch.
+  check(batch.Put(cf, index_key(0x101, "b"), "").ok());
+  check(has_index_writes(&batch, cf, is_reverse_cf, 0x101));
+  check(count_rows(cached.get(), 0x101) == 1);
+
+  std::unique_ptr<rocksdb::Iterator> merged(
+      batch.NewIteratorWithBase(cf, db->NewIterator(read_opts, cf)));
+  check(count_rows(merged.get(), 0x101) == 2);
+
+  // A delete is a write too: the merged read must hide the deleted row.
+  check(!has_index_writes(&batch, cf, is_reverse_cf, 0x103));
+  check(batch.Delete(cf, index_key(0x103, "a")).ok());
+  check(has_index_writes(&batch, cf, is_reverse_cf, 0x103));
+  merged.reset(batch.NewIteratorWithBase(cf, db->NewIterator(read_opts, cf)));
+  check(count_rows(merged.get(), 0x103) == 0);
+}
+
+int main(int argc, char **argv) {
+  std::unique_ptr<rocksdb::Env> env(
+      rocksdb::NewMemEnv(rocksdb::Env::Default()));
+  rocksdb::Options options;
+  options.create_if_missing = true;
+  options.env = env.get();
+
+  rocksdb::DB *db = nullptr;
+  check(rocksdb::DB::Open(options, "/test_index_writes", &db).ok());
+
+  rocksdb::ColumnFamilyOptions reverse_options(options);
+  reverse_options.comparator = rocksdb::ReverseBytewiseComparator();
+  rocksdb::ColumnFamilyHandle *reverse_cf = nullptr;
+  check(db->CreateColumnFamily(reverse_options, "rev:cf", &reverse_cf).ok());
+
+  // An empty transaction has written to no index.
+  check(!myrocks::rdb_batch_has_prefix(nullptr, db->DefaultColumnFamily(),
+                                       index_key(0x101, ""), false));
+
+  check_index_writes(db, db->DefaultColumnFamily(), false);
+  check_index_writes(db, reverse_cf, true);
+
+  check(db->DestroyColumnFamilyHandle(reverse_cf).ok());
+  delete db;
+
+  return 0;
+}
@@ -0,0 +1,560 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "storage/secondary_engine_columnar/columnar_table.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "m_string.h"
+#include "my_bitmap.h"
+#include "sql/fb_vector_base.h"
+#include "sql/fb_vector_distance.h"
+#include "sql/field.h"
+#include "sql/key.h"
+#include "sql/table.h"
+#include "sql_string.h"
+
+namespace columnar {
+
+namespace {
+
+/// Rows of committed transactions queued for a table nobody reads, beyond
+/// which it is left stale rather than growing the queue.
+constexpr size_t MAX_QUEUED_ROWS = 1 << 20;
+
+/// Whether the field is the column of a vector index, and its dimension.
+bool vector_column(const TABLE &table, const Field *field, uint *dimension) {
+  for (uint i = 0; i < table.s->keys; i++) {
+    const KEY &key = table.key_info[i];
+    const FB_vector_index_config &config = key.fb_vector_index_config;
+    if (key.is_fb_vector_index() && !config.multi() && !config.sparse() &&
+        key.key_part[0].field != nullptr &&
+        key.key_part[0].field->field_index() == field->field_index()) {
+      *dimension = config.dimension();
+      return true;
+    }
+  }
+  return false;
+}
+
+Column_kind column_kind(const TABLE &table, const Field *field,
+                        uint *dimension) {
+  if (vector_column(table, field, dimension)) return Column_kind::VECTOR;
+  switch (field->type()) {
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONG:
+      return Column_kind::INT;
+    case MYSQL_TYPE_LONGLONG:
+      // unsigned values past the int64 range are kept as text
+      return field->is_unsigned() ? Column_kind::TEXT : Column_kind::INT;
+    case MYSQL_TYPE_FLOAT:
+    case MYSQL_TYPE_DOUBLE:
+      return Column_kind::REAL;
+    default:
+      return Column_kind::TEXT;
+  }
+}
+
+/**
+  Keep the rows of selection whose value is not NULL and passes compare,
+  in order, without a branch on the outcome.
+  @return number of rows kept
+*/
+template <class T, class Compare>
+size_t select_rows(const T *values, const uchar *nulls, Compare compare,
+                   size_t *selection, size_t count) {
+  size_t kept = 0;
+  for (size_t i = 0; i < count; i++) {
+    const size_t row = selection[i];
+    selection[kept] = row;
+    kept += !nulls[row] & compare(values[row]);
+  }
+  return kept;
+}
+
+/// The filter kernel of a comparison, values converted to C to compare.
+template <class C, class T>
+size_t compare_rows(Predicate::Op op, const T *values, const uchar *nulls,
+                    C constant, size_t *selection, size_t count) {
+  switch (op) {
+    case Predicate::Op::EQ:
+      return select_rows(
+          values, nulls,
+          [constant](T value) { return static_cast<C>(value) == constant; },
+          selection, count);
+    case Predicate::Op::NE:
+      return select_rows(
+          values, nulls,
+          [constant](T value) { return static_cast<C>(value) != constant; },
+          selection, count);
+    case Predicate::Op::LT:
+      return select_rows(
+          values, nulls,
+          [constant](T value) { return static_cast<C>(value) < constant; },
+          selection, count);
+    case Predicate::Op::LE:
+      return select_rows(
+          values, nulls,
+          [constant](T value) { return static_cast<C>(value) <= constant; },
+          selection, count);
+    case Predicate::Op::GT:
+      return select_rows(
+          values, nulls,
+          [constant](T value) { return static_cast<C>(value) > constant; },
+          selection, count);
+    case Predicate::Op::GE:
+      return select_rows(
+          values, nulls,
+          [constant](T value) { return static_cast<C>(value) >= constant; },
+          selection, count);
+    default:
+      assert(false);
+      return count;
+  }
+}
+
+/// The kernel of a NULL test.
+size_t null_rows(bool is_null, const uchar *nulls, size_t *selection,
+                 size_t count) {
+  size_t kept = 0;
+  for (size_t i = 0; i < count; i++) {
+    const size_t row = selection[i];
+    selection[kept] = row;
+    kept += nulls[row] == is_null;
+  }
+  return kept;
+}
+
+}  // namespace
+
+Table::Table() { thr_lock_init(&lock); }
+
+Table::~Table() { thr_lock_delete(&lock); }
+
+std::unique_ptr<Table> Table::create(const TABLE &table, std::string *error) {
+  if (table.s->primary_key == MAX_KEY) {
+    *error = "Table has no primary key";
+    return nullptr;
+  }
+  std::unique_ptr<Table> loaded(new Table());
+  uint visible_index = 0;
+  for (Field **field_ptr = table.field; *field_ptr != nullptr; field_ptr++) {
+    const Field *field = *field_ptr;
+    if (field->is_hidden_by_system()) continue;
+    Column column;
+    column.field_index = field->field_index();
+    column.visible_index = visible_index++;
+    if (!bitmap_is_set(table.read_set, column.field_index)) continue;
+    column.kind = column_kind(table, field, &column.dimension);
+    column.json = field->type() == MYSQL_TYPE_JSON;
+    loaded->m_columns.push_back(std::move(column));
+  }
+
+  const KEY &key = table.key_info[table.s->primary_key];
+  for (uint i = 0; i < key.user_defined_key_parts; i++) {
+    const int column = loaded->column_of(key.key_part[i].field->field_index());
+    if (column < 0) {
+      *error = "Columns of the primary key must be loaded";
+      return nullptr;
+    }
+    loaded->m_key_columns.push_back(column);
+  }
+  return loaded;
+}
+
+int Table::column_of(uint field_index) const {
+  for (size_t i = 0; i < m_columns.size(); i++) {
+    if (m_columns[i].field_index == field_index) return i;
+  }
+  return -1;
+}
+
+void Table::append_key(std::string *key, const char *value, size_t length) {
+  const uint32 size = length;
+  key->append(reinterpret_cast<const char *>(&size), sizeof(size));
+  key->append(value, length);
+}
+
+void Table::append(const TABLE &table) {
+  std::string key;
+  String buffer;
+  for (const uint column : m_key_columns) {
+    const String *value =
+        table.field[m_columns[column].field_index]->val_str(&buffer);
+    append_key(&key, value->ptr(), value->length());
+  }
+  for (Column &column : m_columns)
+    append_value(&column, table.field[column.field_index]);
+  m_deleted.push_back(0);
+  m_rows_by_key[key] = m_rows++;
+  m_live_rows++;
+}
+
+void Table::append_value(Column *column, Field *field) {
+  if (field->is_null()) {
+    append_null(column);
+    return;
+  }
+  switch (column->kind) {
+    case Column_kind::INT:
+      column->nulls.push_back(0);
+      column->ints.push_back(field->val_int());
+      return;
+    case Column_kind::REAL:
+      column->nulls.push_back(0);
+      column->reals.push_back(field->val_real());
+      return;
+    case Column_kind::VECTOR:
+    case Column_kind::TEXT: {
+      String buffer;
+      const String *value = field->val_str(&buffer);
+      append_text(column, value->ptr(), value->length());
+      return;
+    }
+  }
+}
+
+void Table::append_text(Column *column, const char *value, size_t length) {
+  column->nulls.push_back(0);
+  switch (column->kind) {
+    case Column_kind::INT: {
+      const char *end = value + length;
+      int error;
+      column->ints.push_back(my_strtoll10(value, &end, &error));
+      return;
+    }
+    case Column_kind::REAL: {
+      const char *end = value + length;
+      int error;
+      column->reals.push_back(my_strtod(value, &end, &error));
+      return;
+    }
+    case Column_kind::VECTOR: {
+      std::vector<float> vector;
+      bool error;
+      if (column->json) {
+        error = parse_fb_vector_from_json_text(value, length, vector);
+      } else {
+        error = length % sizeof(float) != 0;
+        if (!error) {
+          vector.resize(length / sizeof(float));
+          memcpy(vector.data(), value, length);
+        }
+      }
+      if (error || vector.size() != column->dimension) {
+        column->irregular++;
+        vector.assign(column->dimension, 0.0f);
+      }
+      column->matrix.insert(column->matrix.end(), vector.begin(),
+                            vector.end());
+      break;
+    }
+    case Column_kind::TEXT:
+      break;
+  }
+  // VECTOR columns keep their text too, to be read back as stored
+  column->text.append(value, length);
+  column->text_ends.push_back(column->text.size());
+}
+
+void Table::append_null(Column *column) {
+  column->nulls.push_back(1);
+  switch (column->kind) {
+    case Column_kind::INT:
+      column->ints.push_back(0);
+      return;
+    case Column_kind::REAL:
+      column->reals.push_back(0);
+      return;
+    case Column_kind::VECTOR:
+      column->matrix.resize(column->matrix.size() + column->dimension, 0.0f);
+      [[fallthrough]];
+    case Column_kind::TEXT:
+      column->text_ends.push_back(column->text.size());
+      return;
+  }
+}
+
+void Table::deliver(const std::vector<Change_stream_batch_ptr> &batches) {
+  std::lock_guard<std::mutex> guard(m_queue_mutex);
+  if (m_stale) return;
+  for (const Change_stream_batch_ptr &batch : batches) {
+    m_queue.push_back(batch);
+    m_queued_rows += batch->rows.size();
+  }
+  if (m_queued_rows > MAX_QUEUED_ROWS) {
+    m_stale = true;
+    m_queue.clear();
+    m_queued_rows = 0;
+  }
+}
+
+bool Table::refresh() {
+  {
+    std::lock_guard<std::mutex> guard(m_queue_mutex);
+    if (m_queue.empty()) return !m_stale;
+  }
+  // the queue is taken with the latch held, so that the batches are applied
+  // in the order of their commits
+  std::unique_lock<std::shared_mutex> latch(m_latch);
+  std::vector<Change_stream_batch_ptr> queue;
+  {
+    std::lock_guard<std::mutex> guard(m_queue_mutex);
+    queue.swap(m_queue);
+    m_queued_rows = 0;
+  }
+  for (const Change_stream_batch_ptr &batch : queue) {
+    if (m_stale) break;
+    apply(*batch);
+  }
+  return !m_stale;
+}
+
+void Table::apply(const Change_stream_batch &batch) {
+  if (batch.emptied) clear();
+  if (batch.rows_dropped) {
+    m_stale = true;
+    return;
+  }
+  for (const Change_stream_row &row : batch.rows) {
+    switch (row.type) {
+      case Change_stream_row::Type::INSERT:
+        append_image(row.after);
+        break;
+      case Change_stream_row::Type::UPDATE:
+        if (!delete_image(row.before)) m_stale = true;
+        append_image(row.after);
+        break;
+      case Change_stream_row::Type::DELETE:
+        if (!delete_image(row.before)) m_stale = true;
+        break;
+    }
+    if (m_stale) return;
+  }
+}
+
+void Table::append_image(const Change_stream_image &image) {
+  for (const Column &column : m_columns) {
+    if (column.visible_index >= image.values.size()) {
+      m_stale = true;
+      return;
+    }
+  }
+  // a row of the same key, e.g. replaced, is gone
+  delete_image(image);
+
+  std::string key;
+  for (const uint column : m_key_columns) {
+    const std::string &value = image.values[m_columns[column].visible_index];
+    append_key(&key, value.data(), value.size());
+  }
+  for (Column &column : m_columns) {
+    if (image.nulls[column.visible_index]) {
+      append_null(&column);
+    } else {
+      const std::string &value = image.values[column.visible_index];
+      append_text(&column, value.data(), value.size());
+    }
+  }
+  m_deleted.push_back(0);
+  m_rows_by_key[key] = m_rows++;
+  m_live_rows++;
+}
+
+bool Table::delete_image(const Change_stream_image &image) {
+  std::string key;
+  for (const uint column : m_key_columns) {
+    const uint visible_index = m_columns[column].visible_index;
+    if (visible_index >= image.values.size()) return false;
+    const std::string &value = image.values[visible_index];
+    append_key(&key, value.data(), value.size());
+  }
+  auto it = m_rows_by_key.find(key);
+  if (it == m_rows_by_key.end()) return false;
+  m_deleted[it->second] = 1;
+  m_rows_by_key.erase(it);
+  m_live_rows--;
+  return true;
+}
+
+void Table::clear() {
+  for (Column &column : m_columns) {
+    column.irregular = 0;
+    column.nulls.clear();
+    column.ints.clear();
+    column.reals.clear();
+    column.matrix.clear();
+    column.text.clear();
+    column.text_ends.clear();
+  }
+  m_rows = 0;
+  m_live_rows = 0;
+  m_deleted.clear();
+  m_rows_by_key.clear();
+}
+
+Scan::Scan(const Table &table, std::vector<Predicate> predicates,
+           const Knn *knn)
+    : m_table(table), m_predicates(std::move(predicates)) {
+  std::shared_lock<std::shared_mutex> latch(m_table.m_latch);
+  m_end = m_table.m_rows;
+  // the matrix holds zeros for vectors of another dimension
+  if (knn != nullptr && m_table.m_columns[knn->column].irregular == 0) {
+    m_knn = true;
+    nearest(*knn);
+  }
+}
+
+bool Scan::next(TABLE *table, uchar *buf, size_t *row) {
+  std::shared_lock<std::shared_mutex> latch(m_table.m_latch);
+  for (;;) {
+    // rows past the end are gone when the table was emptied meanwhile
+    const size_t end = std::min(m_end, m_table.m_rows);
+    if (m_pos < m_selection.size()) {
+      *row = m_selection[m_pos++];
+      if (*row >= end) continue;
+      read_row(m_table, *row, table, buf);
+      return true;
+    }
+    if (m_knn || m_next >= end) return false;
+    const size_t batch_end = std::min(m_next + BATCH_ROWS, end);
+    filter(m_next, batch_end);
+    m_next = batch_end;
+  }
+}
+
+bool Scan::read(const Table &table, size_t row, TABLE *target, uchar *buf) {
+  std::shared_lock<std::shared_mutex> latch(table.m_latch);
+  if (row >= table.m_rows) return false;
+  read_row(table, row, target, buf);
+  return true;
+}
+
+void Scan::filter(size_t begin, size_t end) {
+  m_selection.clear();
+  m_pos = 0;
+  for (size_t row = begin; row < end; row++) {
+    if (!m_table.m_deleted[row]) m_selection.push_back(row);
+  }
+  size_t count = m_selection.size();
+  for (const Predicate &predicate : m_predicates) {
+    if (count == 0) break;
+    const Column &column = m_table.m_columns[predicate.column];
+    const uchar *nulls = column.nulls.data();
+    size_t *selection = m_selection.data();
+    if (predicate.never) {
+      count = 0;
+    } else if (predicate.op == Predicate::Op::IS_NULL ||
+               predicate.op == Predicate::Op::IS_NOT_NULL) {
+      count = null_rows(predicate.op == Predicate::Op::IS_NULL, nulls,
+                        selection, count);
+    } else if (column.kind == Column_kind::REAL) {
+      count = compare_rows(predicate.op, column.reals.data(), nulls,
+                           predicate.real_value, selection, count);
+    } else if (predicate.int_compare) {
+      count = compare_rows(predicate.op, column.ints.data(), nulls,
+                           predicate.int_value, selection, count);
+    } else {
+      count = compare_rows(predicate.op, column.ints.data(), nulls,
+                           predicate.real_value, selection, count);
+    }
+  }
+  m_selection.resize(count);
+}
+
+void Scan::nearest(const Knn &knn) {
+  const Column &column = m_table.m_columns[knn.column];
+  const size_t dimension = column.dimension;
+  // NULL sorts first, so it is nearest in ascending order
+  const float null_score = knn.descending
+                               ? std::numeric_limits<float>::infinity()
+                               : -std::numeric_limits<float>::infinity();
+  std::vector<std::pair<float, size_t>> scored;
+  for (size_t begin = 0; begin < m_end; begin += BATCH_ROWS) {
+    filter(begin, std::min(begin + BATCH_ROWS, m_end));
+    for (const size_t row : m_selection) {
+      float score = null_score;
+      if (!column.nulls[row]) {
+        const float *vector = column.matrix.data() + row * dimension;
+        switch (knn.metric) {
+          case Knn::Metric::L2:
+            score = fb_vector_l2sqr(vector, knn.query.data(), dimension);
+            break;
+          case Knn::Metric::IP:
+            score = fb_vector_inner_product(vector, knn.query.data(),
+                                            dimension);
+            break;
+          case Knn::Metric::COSINE:
+            score = fb_vector_cosine(vector, knn.query.data(), dimension);
+            break;
+        }
+        if (knn.descending) score = -score;
+      }
+      scored.emplace_back(score, row);
+    }
+  }
+  if (scored.size() > knn.k) {
+    std::nth_element(scored.begin(), scored.begin() + knn.k, scored.end());
+    scored.resize(knn.k);
+  }
+  m_selection.clear();
+  m_pos = 0;
+  for (const auto &score_row : scored) m_selection.push_back(score_row.second);
+  // read in the order of the rows, the sort above the scan orders them
+  std::sort(m_selection.begin(), m_selection.end());
+}
+
+void Scan::read_row(const Table &table, size_t row, TABLE *target,
+                    uchar *buf) {
+  const ptrdiff_t offset = buf - target->record[0];
+  my_bitmap_map *old_map =
+      dbug_tmp_use_all_columns(target, target->write_set);
+  for (const Column &column : table.m_columns) {
+    // only the columns the statement reads
+    if (!bitmap_is_set(target->read_set, column.field_index)) continue;
+    Field *field = target->field[column.field_index];
+    field->move_field_offset(offset);
+    if (column.nulls[row]) {
+      field->set_null();
+    } else {
+      field->set_notnull();
+      switch (column.kind) {
+        case Column_kind::INT:
+          field->store(column.ints[row], field->is_unsigned());
+          break;
+        case Column_kind::REAL:
+          field->store(column.reals[row]);
+          break;
+        case Column_kind::VECTOR:
+        case Column_kind::TEXT: {
+          const size_t begin = row == 0 ? 0 : column.text_ends[row - 1];
+          field->store(column.text.data() + begin,
+                       column.text_ends[row] - begin, field->charset());
+          break;
+        }
+      }
+    }
+    field->move_field_offset(-offset);
+  }
+  dbug_tmp_restore_column_map(target->write_set, old_map);
+}
+
+}  // namespace columnar
@@ -0,0 +1,226 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+/**
+  @file
+  In-memory column store of the COLUMNAR secondary engine.
+
+  A loaded table keeps every column in an array of its own: integers and
+  floating point numbers as int64 and double, the columns of vector indexes
+  as a row major float matrix, anything else as the text of its values.
+  Rows are only appended, an update appends the new row and marks the old
+  one deleted, so the position of a row never changes until the table is
+  loaded again.
+
+  The table follows the change stream of its primary table, see
+  change_stream.h. The batches of committed transactions are queued as
+  they are delivered and applied by the next statement reading the table,
+  matching rows by primary key. A transaction changing more rows than the
+  stream captures leaves the table stale, until it is loaded again.
+
+  Scans read a batch of rows at a time, filtered column by column by the
+  predicates pushed down with tight loops over the arrays, and only then
+  copy the rows left into the record of the table.
+*/
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "my_base.h"
+#include "my_inttypes.h"
+#include "sql/change_stream.h"
+#include "thr_lock.h"
+
+class Field;
+struct TABLE;
+
+namespace columnar {
+
+/// Rows filtered at a time by a scan.
+constexpr size_t BATCH_ROWS = 1024;
+
+/// How the values of a column are kept.
+enum class Column_kind { INT, REAL, VECTOR, TEXT };
+
+struct Column {
+  Column_kind kind;
+  /// Position of the field in the table, and among its visible fields,
+  /// which is the position of its value in the rows of the change stream.
+  uint field_index;
+  uint visible_index;
+  /// Dimension of the vectors of a VECTOR column, and whether they are
+  /// JSON arrays rather than the floats of a blob.
+  uint dimension{0};
+  bool json{false};
+  /// Vectors of a VECTOR column that are not of its dimension, the column
+  /// then cannot be searched from its matrix.
+  size_t irregular{0};
+
+  std::vector<uchar> nulls;
+  std::vector<longlong> ints;
+  std::vector<double> reals;
+  /// Row major, dimension floats a row, zeros for NULL.
+  std::vector<float> matrix;
+  /// The values of VECTOR and TEXT columns one after the other.
+  std::string text;
+  std::vector<size_t> text_ends;
+};
+
+/**
+  A comparison of a column with a constant, or a NULL test, applied to a
+  batch by a filter kernel.
+*/
+struct Predicate {
+  enum class Op { EQ, NE, LT, LE, GT, GE, IS_NULL, IS_NOT_NULL };
+  Op op;
+  size_t column;
+  /// Compare the values of an INT column as integers, else as doubles.
+  bool int_compare{false};
+  longlong int_value{0};
+  double real_value{0};
+  /// The constant is NULL, no row passes.
+  bool never{false};
+};
+
+/**
+  The k nearest rows to a query vector, for an ORDER BY of a vector
+  distance with a LIMIT.
+*/
+struct Knn {
+  enum class Metric { L2, IP, COSINE };
+  Metric metric;
+  size_t column;
+  std::vector<float> query;
+  ha_rows k;
+  /// ORDER BY ... DESC, e.g. of a similarity.
+  bool descending{false};
+};
+
+class Table : public Change_stream_subscriber {
+ public:
+  /**
+    The columns of table loaded, those in its read set.
+    @param[out] error why the table cannot be loaded, on failure
+  */
+  static std::unique_ptr<Table> create(const TABLE &table,
+                                       std::string *error);
+
+  ~Table() override;
+
+  Table(const Table &) = delete;
+  Table &operator=(const Table &) = delete;
+
+  /// Append the current row of the primary table.
+  void append(const TABLE &table);
+
+  /// Queue the batches of a committed transaction.
+  void deliver(const std::vector<Change_stream_batch_ptr> &batches) override;
+
+  /**
+    Apply the batches queued.
+    @return false if the table is stale and must be loaded again
+  */
+  bool refresh();
+
+  /// Rows not deleted.
+  ha_rows live_rows() const { return m_live_rows.load(); }
+
+  const std::vector<Column> &columns() const { return m_columns; }
+
+  /// Column of a field, -1 if it is not loaded.
+  int column_of(uint field_index) const;
+
+  THR_LOCK lock;
+
+ private:
+  friend class Scan;
+
+  Table();
+
+  void append_value(Column *column, Field *field);
+  void append_text(Column *column, const char *value, size_t length);
+  void append_null(Column *column);
+  void apply(const Change_stream_batch &batch);
+  void append_image(const Change_stream_image &image);
+  bool delete_image(const Change_stream_image &image);
+  void clear();
+  /// The primary key of a row, from the text of its key columns.
+  static void append_key(std::string *key, const char *value, size_t length);
+
+  std::vector<Column> m_columns;
+  /// Columns of the primary key, positions in m_columns.
+  std::vector<uint> m_key_columns;
+
+  /// Held shared by scans, exclusively to apply changes.
+  mutable std::shared_mutex m_latch;
+  size_t m_rows{0};
+  std::atomic<ha_rows> m_live_rows{0};
+  std::vector<uchar> m_deleted;
+  std::unordered_map<std::string, size_t> m_rows_by_key;
+
+  std::mutex m_queue_mutex;
+  std::vector<Change_stream_batch_ptr> m_queue;
+  size_t m_queued_rows{0};
+  std::atomic<bool> m_stale{false};
+};
+
+/**
+  A scan of a table, the rows passing the predicates, or the knn rows
+  among them.
+*/
+class Scan {
+ public:
+  Scan(const Table &table, std::vector<Predicate> predicates,
+       const Knn *knn);
+
+  /**
+    Read the next row into the record of table at buf.
+    @return false at the end
+  */
+  bool next(TABLE *table, uchar *buf, size_t *row);
+
+  /**
+    Read a row returned before, by its position.
+    @return false if the table was emptied since
+  */
+  static bool read(const Table &table, size_t row, TABLE *target,
+                   uchar *buf);
+
+ private:
+  /// The rows of [begin, end) that are not deleted and pass the predicates.
+  void filter(size_t begin, size_t end);
+  void nearest(const Knn &knn);
+  static void read_row(const Table &table, size_t row, TABLE *target,
+                       uchar *buf);
+
+  const Table &m_table;
+  const std::vector<Predicate> m_predicates;
+  /// Rows appended once the scan started are not read.
+  size_t m_end;
+  size_t m_next{0};
+  std::vector<size_t> m_selection;
+  size_t m_pos{0};
+  bool m_knn{false};
+};
+
+}  // namespace columnar
@@ -0,0 +1,539 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include "storage/secondary_engine_columnar/ha_columnar.h"
+
+#include <cassert>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "my_byteorder.h"
+#include "my_dbug.h"
+#include "mysql/plugin.h"
+#include "mysqld_error.h"
+#include "sql/filesort.h"
+#include "sql/handler.h"
+#include "sql/item.h"
+#include "sql/item_cmpfunc.h"
+#include "sql/item_fb_vector_func.h"
+#include "sql/join_optimizer/access_path.h"
+#include "sql/join_optimizer/walk_access_paths.h"
+#include "sql/sort_param.h"
+#include "sql/sql_class.h"
+#include "sql/sql_const.h"
+#include "sql/sql_lex.h"
+#include "sql/table.h"
+#include "template_utils.h"
+
+namespace {
+
+handlerton *columnar_hton{nullptr};
+
+// Map from (db_name, table_name) to the loaded tables.
+class Loaded_tables {
+  std::map<std::pair<std::string, std::string>,
+           std::shared_ptr<columnar::Table>>
+      m_tables;
+  std::mutex m_mutex;
+
+ public:
+  ~Loaded_tables() {
+    for (auto &loaded : m_tables)
+      change_stream_unsubscribe(loaded.second.get());
+  }
+
+  /// Replaces the table loaded before, and follows the changes of the
+  /// primary table.
+  void add(const std::string &db, const std::string &table,
+           std::shared_ptr<columnar::Table> loaded) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::shared_ptr<columnar::Table> &entry = m_tables[{db, table}];
+    if (entry != nullptr) change_stream_unsubscribe(entry.get());
+    change_stream_subscribe(loaded.get(), {{db, table}});
+    entry = std::move(loaded);
+  }
+
+  std::shared_ptr<columnar::Table> get(const std::string &db,
+                                       const std::string &table) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto it = m_tables.find({db, table});
+    return it == m_tables.end() ? nullptr : it->second;
+  }
+
+  bool erase(const std::string &db, const std::string &table) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto it = m_tables.find({db, table});
+    if (it == m_tables.end()) return false;
+    change_stream_unsubscribe(it->second.get());
+    m_tables.erase(it);
+    return true;
+  }
+};
+
+Loaded_tables *loaded_tables{nullptr};
+
+/// The comparison of a column with a constant the other way round.
+columnar::Predicate::Op reverse(columnar::Predicate::Op op) {
+  using Op = columnar::Predicate::Op;
+  switch (op) {
+    case Op::LT:
+      return Op::GT;
+    case Op::LE:
+      return Op::GE;
+    case Op::GT:
+      return Op::LT;
+    case Op::GE:
+      return Op::LE;
+    default:
+      return op;
+  }
+}
+
+}  // namespace
+
+namespace columnar {
+
+ha_columnar::ha_columnar(handlerton *hton, TABLE_SHARE *table_share_arg)
+    : handler(hton, table_share_arg) {
+  ref_length = sizeof(uint64);
+}
+
+int ha_columnar::open(const char *, int, unsigned int, const dd::Table *) {
+  m_table =
+      loaded_tables->get(table_share->db.str, table_share->table_name.str);
+  if (m_table == nullptr) {
+    // The table has not been loaded into the secondary storage engine yet.
+    my_error(ER_SECONDARY_ENGINE_PLUGIN, MYF(0), "Table has not been loaded");
+    return HA_ERR_GENERIC;
+  }
+  thr_lock_data_init(&m_table->lock, &m_lock, nullptr);
+  return 0;
+}
+
+int ha_columnar::close() {
+  m_scan.reset();
+  m_table.reset();
+  return 0;
+}
+
+int ha_columnar::external_lock(THD *, int lock_type) {
+  if (lock_type == F_UNLCK) return 0;
+  // Apply the changes committed since, a stale table has the statement
+  // executed by the primary engine.
+  if (!m_table->refresh()) {
+    my_error(ER_SECONDARY_ENGINE_PLUGIN, MYF(0),
+             "Table is stale and must be loaded again");
+    return HA_ERR_GENERIC;
+  }
+  return 0;
+}
+
+int ha_columnar::rnd_init(bool) {
+  std::vector<Predicate> predicates;
+  std::unique_ptr<Knn> knn;
+  if (evaluate_predicates(&predicates) || evaluate_knn(&knn))
+    return HA_ERR_GENERIC;
+  m_scan = std::make_unique<Scan>(*m_table, std::move(predicates), knn.get());
+  return 0;
+}
+
+int ha_columnar::rnd_next(unsigned char *buf) {
+  if (thd_killed(ha_thd())) return HA_ERR_QUERY_INTERRUPTED;
+  if (!m_scan->next(table, buf, &m_row)) return HA_ERR_END_OF_FILE;
+  return 0;
+}
+
+int ha_columnar::rnd_end() {
+  m_scan.reset();
+  return 0;
+}
+
+int ha_columnar::rnd_pos(unsigned char *buf, unsigned char *pos) {
+  m_row = uint8korr(pos);
+  if (!Scan::read(*m_table, m_row, table, buf)) return HA_ERR_KEY_NOT_FOUND;
+  return 0;
+}
+
+void ha_columnar::position(const unsigned char *) { int8store(ref, m_row); }
+
+int ha_columnar::info(unsigned int flags) {
+  // Get the cardinality statistics from the primary storage engine, the
+  // number of rows is the one loaded.
+  handler *primary = ha_get_primary_handler();
+  int ret = primary->info(flags);
+  if (ret == 0) {
+    stats.records = m_table->live_rows();
+  }
+  return ret;
+}
+
+handler::Table_flags ha_columnar::table_flags() const {
+  // Secondary engines do not support index access. Indexes are only used for
+  // cost estimates.
+  return HA_NO_INDEX_ACCESS;
+}
+
+unsigned long ha_columnar::index_flags(unsigned int idx, unsigned int part,
+                                       bool all_parts) const {
+  const handler *primary = ha_get_primary_handler();
+  const unsigned long primary_flags =
+      primary == nullptr ? 0 : primary->index_flags(idx, part, all_parts);
+  // Ranges are estimated by the primary engine, see ha_mock::index_flags().
+  return ((HA_READ_RANGE | HA_KEY_SCAN_NOT_ROR) & primary_flags);
+}
+
+ha_rows ha_columnar::records_in_range(unsigned int index, key_range *min_key,
+                                      key_range *max_key) {
+  return ha_get_primary_handler()->records_in_range(index, min_key, max_key);
+}
+
+THR_LOCK_DATA **ha_columnar::store_lock(THD *, THR_LOCK_DATA **to,
+                                        thr_lock_type lock_type) {
+  if (lock_type != TL_IGNORE && m_lock.type == TL_UNLOCK)
+    m_lock.type = lock_type;
+  *to++ = &m_lock;
+  return to;
+}
+
+bool ha_columnar::compile(Item *item) {
+  if (item->type() != Item::FUNC_ITEM) return false;
+  Item_func *func = down_cast<Item_func *>(item);
+  Predicate::Op op;
+  switch (func->functype()) {
+    case Item_func::EQ_FUNC:
+      op = Predicate::Op::EQ;
+      break;
+    case Item_func::NE_FUNC:
+      op = Predicate::Op::NE;
+      break;
+    case Item_func::LT_FUNC:
+      op = Predicate::Op::LT;
+      break;
+    case Item_func::LE_FUNC:
+      op = Predicate::Op::LE;
+      break;
+    case Item_func::GT_FUNC:
+      op = Predicate::Op::GT;
+      break;
+    case Item_func::GE_FUNC:
+      op = Predicate::Op::GE;
+      break;
+    case Item_func::ISNULL_FUNC:
+      op = Predicate::Op::IS_NULL;
+      break;
+    case Item_func::ISNOTNULL_FUNC:
+      op = Predicate::Op::IS_NOT_NULL;
+      break;
+    default:
+      return false;
+  }
+
+  // the column, on either side of a comparison
+  Item **args = func->arguments();
+  uint side = 0;
+  int column = -1;
+  for (; side < func->argument_count(); side++) {
+    Item *arg = args[side]->real_item();
+    if (arg->type() != Item::FIELD_ITEM) continue;
+    const Field *field = down_cast<Item_field *>(arg)->field;
+    if (field->table != table) continue;
+    column = m_table->column_of(field->field_index());
+    break;
+  }
+  if (column < 0) return false;
+  if (op == Predicate::Op::IS_NULL || op == Predicate::Op::IS_NOT_NULL) {
+    m_predicates.push_back({op, static_cast<size_t>(column), nullptr});
+    return true;
+  }
+
+  Item *constant = args[1 - side];
+  if (!constant->const_for_execution() || constant->is_expensive() ||
+      constant->is_temporal())
+    return false;
+  const Column_kind kind = m_table->columns()[column].kind;
+  switch (constant->result_type()) {
+    case INT_RESULT:
+    case REAL_RESULT:
+      if (kind != Column_kind::INT && kind != Column_kind::REAL) return false;
+      break;
+    case DECIMAL_RESULT:
+      // integers are compared with decimals as decimals
+      if (kind != Column_kind::REAL) return false;
+      break;
+    default:
+      return false;
+  }
+  if (side == 1) op = reverse(op);
+  m_predicates.push_back({op, static_cast<size_t>(column), constant});
+  return true;
+}
+
+const Item *ha_columnar::cond_push(const Item *cond) {
+  m_predicates.clear();
+  Item *item = const_cast<Item *>(cond);
+  if (item->type() == Item::COND_ITEM &&
+      down_cast<Item_cond *>(item)->functype() == Item_func::COND_AND_FUNC) {
+    m_cond_exact = true;
+    for (Item &conjunct : *down_cast<Item_cond *>(item)->argument_list()) {
+      if (!compile(&conjunct)) m_cond_exact = false;
+    }
+  } else {
+    m_cond_exact = compile(item);
+  }
+  pushed_cond = cond;
+  return cond;
+}
+
+bool ha_columnar::push_knn(Item_func_fb_vector_distance *distance, ha_rows k,
+                           bool descending) {
+  if (pushed_cond != nullptr && !m_cond_exact) return false;
+  Item **args = distance->arguments();
+  Item *arg = args[0]->real_item();
+  if (arg->type() != Item::FIELD_ITEM) return false;
+  const Field *field = down_cast<Item_field *>(arg)->field;
+  if (field->table != table) return false;
+  const int column = m_table->column_of(field->field_index());
+  if (column < 0 || m_table->columns()[column].kind != Column_kind::VECTOR ||
+      !args[1]->const_for_execution())
+    return false;
+  m_knn_distance = distance;
+  m_knn_column = column;
+  m_knn_k = k;
+  m_knn_descending = descending;
+  return true;
+}
+
+bool ha_columnar::evaluate_predicates(std::vector<Predicate> *predicates) {
+  THD *thd = ha_thd();
+  for (const Pushed_predicate &pushed : m_predicates) {
+    Predicate predicate;
+    predicate.op = pushed.op;
+    predicate.column = pushed.column;
+    Item *constant = pushed.constant;
+    if (constant != nullptr) {
+      const Column_kind kind = m_table->columns()[pushed.column].kind;
+      if (kind == Column_kind::INT && constant->result_type() == INT_RESULT) {
+        predicate.int_value = constant->val_int();
+        // unsigned values past the int64 range are compared as doubles
+        predicate.int_compare =
+            !(constant->unsigned_flag && predicate.int_value < 0);
+        predicate.real_value =
+            static_cast<double>(static_cast<ulonglong>(predicate.int_value));
+      } else {
+        predicate.real_value = constant->val_real();
+      }
+      predicate.never = constant->null_value;
+      if (thd->is_error()) return true;
+    }
+    predicates->push_back(predicate);
+  }
+  return false;
+}
+
+bool ha_columnar::evaluate_knn(std::unique_ptr<Knn> *knn) {
+  if (m_knn_distance == nullptr) return false;
+  auto searched = std::make_unique<Knn>();
+  switch (m_knn_distance->functype()) {
+    case Item_func::FB_VECTOR_L2:
+      searched->metric = Knn::Metric::L2;
+      break;
+    case Item_func::FB_VECTOR_IP:
+      searched->metric = Knn::Metric::IP;
+      break;
+    case Item_func::FB_VECTOR_COSINE:
+      searched->metric = Knn::Metric::COSINE;
+      break;
+    default:
+      return false;
+  }
+  if (m_knn_distance->get_input_vector(searched->query))
+    return ha_thd()->is_error();
+  // the distance pads the shorter vector, the matrix cannot
+  if (searched->query.size() != m_table->columns()[m_knn_column].dimension)
+    return false;
+  searched->column = m_knn_column;
+  searched->k = m_knn_k;
+  searched->descending = m_knn_descending;
+  *knn = std::move(searched);
+  return false;
+}
+
+int ha_columnar::reset() {
+  m_predicates.clear();
+  m_cond_exact = false;
+  m_knn_distance = nullptr;
+  return 0;
+}
+
+int ha_columnar::load_table(const TABLE &table_arg) {
+  assert(table_arg.file != nullptr);
+  std::string error;
+  std::shared_ptr<Table> loaded = Table::create(table_arg, &error);
+  if (loaded == nullptr) {
+    my_error(ER_SECONDARY_ENGINE, MYF(0), error.c_str());
+    return HA_ERR_GENERIC;
+  }
+
+  handler *primary = table_arg.file;
+  int ret = primary->ha_rnd_init(true);
+  if (ret == 0) {
+    while ((ret = primary->ha_rnd_next(table_arg.record[0])) == 0) {
+      if (thd_killed(current_thd)) {
+        ret = HA_ERR_QUERY_INTERRUPTED;
+        break;
+      }
+      loaded->append(table_arg);
+    }
+    primary->ha_rnd_end();
+  }
+  if (ret != HA_ERR_END_OF_FILE) {
+    primary->print_error(ret, MYF(0));
+    return ret;
+  }
+
+  // No change is committed meanwhile, the table is locked exclusively.
+  loaded_tables->add(table_arg.s->db.str, table_arg.s->table_name.str,
+                     std::move(loaded));
+  return 0;
+}
+
+int ha_columnar::unload_table(const char *db_name, const char *table_name,
+                              bool error_if_not_loaded) {
+  if (!loaded_tables->erase(db_name, table_name) && error_if_not_loaded) {
+    my_error(ER_SECONDARY_ENGINE_PLUGIN, MYF(0),
+             "Table is not loaded on a secondary engine");
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace columnar
+
+/// The columnar handler of the table path scans, nullptr if it is not one.
+static columnar::ha_columnar *columnar_scan(AccessPath *path) {
+  if (path->type != AccessPath::TABLE_SCAN) return nullptr;
+  TABLE *table = path->table_scan().table;
+  if (table->file->ht != columnar_hton) return nullptr;
+  return down_cast<columnar::ha_columnar *>(table->file);
+}
+
+/// Push the condition of a filter on a table scan down to the scan.
+static columnar::ha_columnar *push_filter(AccessPath *path) {
+  if (path->type != AccessPath::FILTER) return nullptr;
+  columnar::ha_columnar *handler = columnar_scan(path->filter().child);
+  if (handler != nullptr && handler->pushed_cond != path->filter().condition)
+    handler->cond_push(path->filter().condition);
+  return handler;
+}
+
+/**
+  Push an ORDER BY of a vector distance with a LIMIT down to the table scan
+  it sorts, when all of the filter in between, if any, was pushed too.
+*/
+static void push_sort(AccessPath *path) {
+  const Filesort *filesort = path->sort().filesort;
+  if (filesort == nullptr || filesort->sort_order_length() != 1 ||
+      filesort->limit == HA_POS_ERROR || path->sort().remove_duplicates)
+    return;
+  AccessPath *child = path->sort().child;
+  columnar::ha_columnar *handler = child->type == AccessPath::FILTER
+                                       ? push_filter(child)
+                                       : columnar_scan(child);
+  if (handler == nullptr) return;
+  Item *item = filesort->sortorder[0].item->real_item();
+  if (item->type() != Item::FUNC_ITEM) return;
+  switch (down_cast<Item_func *>(item)->functype()) {
+    case Item_func::FB_VECTOR_L2:
+    case Item_func::FB_VECTOR_IP:
+    case Item_func::FB_VECTOR_COSINE:
+      break;
+    default:
+      return;
+  }
+  handler->push_knn(down_cast<Item_func_fb_vector_distance *>(item),
+                    filesort->limit, filesort->sortorder[0].reverse);
+}
+
+static bool PrepareSecondaryEngine(THD *, LEX *lex) {
+  // Disable use of constant tables and evaluation of subqueries during
+  // optimization, there is no index to read a constant table with.
+  lex->add_statement_options(OPTION_NO_CONST_TABLES |
+                             OPTION_NO_SUBQUERY_DURING_OPTIMIZATION);
+  return false;
+}
+
+static bool OptimizeSecondaryEngine(THD *, LEX *lex) {
+  WalkAccessPaths(lex->unit->root_access_path(), nullptr,
+                  WalkAccessPathPolicy::ENTIRE_TREE,
+                  [](AccessPath *path, const JOIN *) {
+                    if (path->type == AccessPath::SORT)
+                      push_sort(path);
+                    else
+                      push_filter(path);
+                    return false;
+                  });
+  return false;
+}
+
+static handler *Create(handlerton *hton, TABLE_SHARE *table_share, bool,
+                       MEM_ROOT *mem_root) {
+  return new (mem_root) columnar::ha_columnar(hton, table_share);
+}
+
+static int Init(MYSQL_PLUGIN p) {
+  loaded_tables = new Loaded_tables();
+
+  handlerton *hton = static_cast<handlerton *>(p);
+  columnar_hton = hton;
+  hton->create = Create;
+  hton->state = SHOW_OPTION_YES;
+  hton->flags = HTON_IS_SECONDARY_ENGINE;
+  hton->db_type = DB_TYPE_UNKNOWN;
+  hton->prepare_secondary_engine = PrepareSecondaryEngine;
+  hton->optimize_secondary_engine = OptimizeSecondaryEngine;
+  hton->secondary_engine_flags =
+      MakeSecondaryEngineFlags(SecondaryEngineFlag::SUPPORTS_HASH_JOIN);
+  return 0;
+}
+
+static int Deinit(MYSQL_PLUGIN) {
+  delete loaded_tables;
+  loaded_tables = nullptr;
+  columnar_hton = nullptr;
+  return 0;
+}
+
+static st_mysql_storage_engine columnar_storage_engine{
+    MYSQL_HANDLERTON_INTERFACE_VERSION};
+
+mysql_declare_plugin(columnar){
+    MYSQL_STORAGE_ENGINE_PLUGIN,
+    &columnar_storage_engine,
+    "COLUMNAR",
+    "James Yang",
+    "In-memory columnar secondary engine",
+    PLUGIN_LICENSE_GPL,
+    Init,
+    nullptr,
+    Deinit,
+    0x0001,
+    nullptr,
+    nullptr,
+    nullptr,
+    0,
+} mysql_declare_plugin_end;
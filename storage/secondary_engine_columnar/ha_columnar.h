@@ -0,0 +1,151 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "my_base.h"
+#include "sql/handler.h"
+#include "storage/secondary_engine_columnar/columnar_table.h"
+#include "thr_lock.h"
+
+class Item;
+class Item_func_fb_vector_distance;
+class THD;
+struct TABLE;
+struct TABLE_SHARE;
+
+namespace dd {
+class Table;
+}
+
+namespace columnar {
+
+/**
+  The COLUMNAR secondary engine keeps tables loaded with ALTER TABLE ...
+  SECONDARY_LOAD in memory, column by column, see columnar_table.h, for
+  analytical queries to be offloaded from the primary engine, e.g. MyRocks.
+
+  Joins are hash joins and aggregates are computed by the iterators of the
+  server over the rows of the scans. What the engine evaluates itself is
+  pushed down to the scans when the statement is optimized: the
+  comparisons of numeric columns with constants of the conditions on a
+  table, run by filter kernels over batches of rows, and an ORDER BY of a
+  vector distance with a LIMIT, run as a brute force search of the matrix
+  of the vector column that only returns the nearest rows.
+
+  Like any secondary engine it cannot be a primary engine.
+*/
+class ha_columnar : public handler {
+ public:
+  ha_columnar(handlerton *hton, TABLE_SHARE *table_share);
+
+  /**
+    Have the scans only return the k rows nearest to the query of distance,
+    if this engine can compute it, see Knn. The pushed condition, if any,
+    must be evaluated in full by the filter kernels.
+    @return true if pushed
+  */
+  bool push_knn(Item_func_fb_vector_distance *distance, ha_rows k,
+                bool descending);
+
+  /**
+    Compile the conjuncts of cond the filter kernels evaluate. The whole
+    condition is still evaluated by the server on the rows returned.
+  */
+  const Item *cond_push(const Item *cond) override;
+
+ private:
+  int create(const char *, TABLE *, HA_CREATE_INFO *, dd::Table *) override {
+    return HA_ERR_WRONG_COMMAND;
+  }
+
+  int open(const char *name, int mode, unsigned int test_if_locked,
+           const dd::Table *table_def) override;
+
+  int close() override;
+
+  int external_lock(THD *thd, int lock_type) override;
+
+  int rnd_init(bool scan) override;
+
+  int rnd_next(unsigned char *buf) override;
+
+  int rnd_end() override;
+
+  int rnd_pos(unsigned char *buf, unsigned char *pos) override;
+
+  void position(const unsigned char *record) override;
+
+  int info(unsigned int flags) override;
+
+  ha_rows records_in_range(unsigned int index, key_range *min_key,
+                           key_range *max_key) override;
+
+  unsigned long index_flags(unsigned int, unsigned int, bool) const override;
+
+  THR_LOCK_DATA **store_lock(THD *thd, THR_LOCK_DATA **to,
+                             thr_lock_type lock_type) override;
+
+  Table_flags table_flags() const override;
+
+  const char *table_type() const override { return "COLUMNAR"; }
+
+  int reset() override;
+
+  int load_table(const TABLE &table) override;
+
+  int unload_table(const char *db_name, const char *table_name,
+                   bool error_if_not_loaded) override;
+
+  /// A conjunct of the pushed condition, its constant not evaluated yet.
+  struct Pushed_predicate {
+    Predicate::Op op;
+    size_t column;
+    Item *constant;
+  };
+
+  bool compile(Item *item);
+  /**
+    The pushed predicates with their constants evaluated.
+    @return true on error
+  */
+  bool evaluate_predicates(std::vector<Predicate> *predicates);
+  /**
+    The knn pushed with its query evaluated, left empty if the query does
+    not fit the column.
+    @return true on error
+  */
+  bool evaluate_knn(std::unique_ptr<Knn> *knn);
+
+  THR_LOCK_DATA m_lock;
+  std::shared_ptr<Table> m_table;
+  std::unique_ptr<Scan> m_scan;
+  /// Position of the row read last.
+  size_t m_row{0};
+
+  std::vector<Pushed_predicate> m_predicates;
+  /// All of the pushed condition is in m_predicates.
+  bool m_cond_exact{false};
+  Item_func_fb_vector_distance *m_knn_distance{nullptr};
+  size_t m_knn_column{0};
+  ha_rows m_knn_k{0};
+  bool m_knn_descending{false};
+};
+
+}  // namespace columnar
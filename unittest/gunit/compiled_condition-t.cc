@@ -0,0 +1,158 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include <gtest/gtest.h>
+#include <initializer_list>
+
+#include "sql/item_cmpfunc.h"
+#include "sql/item_func.h"
+#include "sql/iterators/compiled_condition.h"
+#include "sql/parse_tree_helpers.h"
+#include "sql/sql_class.h"
+#include "sql/sql_lex.h"
+#include "unittest/gunit/fake_table.h"
+#include "unittest/gunit/mock_field_long.h"
+#include "unittest/gunit/test_utils.h"
+
+namespace compiled_condition_unittest {
+
+using my_testing::Server_initializer;
+
+/// Values the columns take, the last one stands for NULL.
+static const std::initializer_list<int> column_values = {
+    -100, -1, 0, 1, 3, 5, 7, 9, 100, 0};
+
+class CompiledConditionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    m_initializer.SetUp();
+    m_table = new Fake_TABLE(new Mock_field_long("field_1", true, false),
+                             new Mock_field_long("field_2", true, true));
+  }
+
+  void TearDown() override {
+    delete m_table;
+    m_initializer.TearDown();
+  }
+
+  THD *thd() { return m_initializer.thd(); }
+  Item_field *column(int i) { return new Item_field(m_table->field[i]); }
+
+  Item *fix(Item *item) {
+    EXPECT_FALSE(item->fix_fields(thd(), &item));
+    return item;
+  }
+
+  Item *itemize_and_fix(Item *item) {
+    Parse_context pc(thd(), thd()->lex->current_query_block());
+    EXPECT_FALSE(item->itemize(&pc, &item));
+    return fix(item);
+  }
+
+  void store(Field *field, const int *value) {
+    if (value == column_values.end() - 1) {
+      field->set_null();
+      return;
+    }
+    field->set_notnull();
+    field->store(*value, false);
+  }
+
+  /**
+    Compile a condition and check that the program agrees with val_int()
+    on every pair of column values.
+  */
+  void check(Item *condition, bool worth_compiling = true) {
+    CompiledCondition compiled;
+    EXPECT_EQ(!worth_compiling, compiled.Compile(condition));
+    ASSERT_FALSE(compiled.Bind(thd()));
+    for (const int *a = column_values.begin(); a != column_values.end(); ++a) {
+      for (const int *b = column_values.begin(); b != column_values.end();
+           ++b) {
+        store(m_table->field[0], a);
+        store(m_table->field[1], b);
+        SCOPED_TRACE(a - column_values.begin());
+        SCOPED_TRACE(b - column_values.begin());
+        EXPECT_EQ(condition->val_int() != 0, compiled.Evaluate());
+      }
+    }
+  }
+
+  Server_initializer m_initializer;
+  Fake_TABLE *m_table{nullptr};
+};
+
+TEST_F(CompiledConditionTest, Comparisons) {
+  check(fix(new Item_func_gt(column(0), new Item_int(5))));
+  check(fix(new Item_func_ge(new Item_int(5), column(0))));
+  check(fix(new Item_func_lt(column(0), new Item_int(-1))));
+  check(fix(new Item_func_le(column(1), new Item_int(-1))));
+  check(fix(new Item_func_eq(column(0), column(1))));
+  check(fix(new Item_func_ne(column(1), new Item_float(2.5, 1))));
+}
+
+/**
+  Reals of fixed decimals are equal up to their precision, here 0.05, as
+  0 and 0.04 are for val_int().
+*/
+TEST_F(CompiledConditionTest, FixedDecimals) {
+  check(fix(new Item_func_eq(column(0), new Item_float(0.04, 1))));
+  check(fix(new Item_func_ne(column(1), new Item_float(-0.04, 1))));
+  check(fix(new Item_func_lt(column(0), new Item_float(0.04, 1))));
+  check(fix(new Item_func_ge(new Item_float(-0.96, 1), column(1))));
+}
+
+TEST_F(CompiledConditionTest, BetweenAndIn) {
+  check(itemize_and_fix(new Item_func_between(
+      POS(), column(0), new Item_int(-1), new Item_int(7), false)));
+  check(itemize_and_fix(new Item_func_between(
+      POS(), column(1), new Item_int(-1), new Item_int(7), false)));
+
+  PT_item_list *list = new (thd()->mem_root) PT_item_list;
+  list->push_back(column(0));
+  list->push_back(new Item_int(9));
+  list->push_back(new Item_null());
+  list->push_back(new Item_int(-100));
+  list->push_back(new Item_int(1));
+  check(itemize_and_fix(new Item_func_in(POS(), list, false)));
+}
+
+TEST_F(CompiledConditionTest, NullTests) {
+  check(fix(new Item_func_isnull(column(0))));
+  check(fix(new Item_func_isnotnull(column(1))));
+}
+
+/**
+  AND and OR short-circuit, and what cannot be compiled is left to
+  val_int() in between.
+*/
+TEST_F(CompiledConditionTest, AndOr) {
+  check(fix(new Item_cond_or(
+      new Item_cond_and(new Item_func_gt(column(0), new Item_int(0)),
+                        new Item_func_lt(column(1), new Item_int(5))),
+      new Item_func_isnull(column(0)))));
+  check(fix(new Item_cond_and(
+      new Item_func_gt(new Item_func_plus(column(0), new Item_int(1)),
+                       new Item_int(5)),
+      new Item_func_ne(column(1), new Item_int(3)))));
+
+  // Nothing but val_int() is not worth it.
+  check(fix(new Item_func_gt(new Item_func_plus(column(0), new Item_int(1)),
+                             new Item_int(5))),
+        false);
+}
+
+}  // namespace compiled_condition_unittest
@@ -0,0 +1,276 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "sql-common/json_binary.h"
+#include "sql-common/json_dom.h"
+#include "sql/fb_vector_base.h"
+#include "sql/fb_vector_distance.h"
+#include "sql_string.h"
+#include "unittest/gunit/benchmark.h"
+#include "unittest/gunit/test_utils.h"
+
+namespace fb_vector_unittest {
+
+static std::vector<float> random_vectors(size_t count, size_t dimension) {
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  std::vector<float> vectors(count * dimension);
+  for (auto &element : vectors) element = distribution(generator);
+  return vectors;
+}
+
+static double reference_l2sqr(const float *v1, const float *v2,
+                              size_t dimension) {
+  double sum = 0;
+  for (size_t i = 0; i < dimension; ++i) {
+    const double diff = static_cast<double>(v1[i]) - v2[i];
+    sum += diff * diff;
+  }
+  return sum;
+}
+
+static double reference_inner_product(const float *v1, const float *v2,
+                                      size_t dimension) {
+  double sum = 0;
+  for (size_t i = 0; i < dimension; ++i)
+    sum += static_cast<double>(v1[i]) * v2[i];
+  return sum;
+}
+
+/**
+  The kernels picked for this cpu agree with a plain loop, at the dimensions
+  of the common embedding models and at one that is not a multiple of the
+  vector width.
+*/
+TEST(FbVectorTest, DistanceKernels) {
+  for (const size_t dimension : {3, 128, 768, 1536}) {
+    SCOPED_TRACE(dimension);
+    const auto vectors = random_vectors(2, dimension);
+    const float *v1 = vectors.data();
+    const float *v2 = vectors.data() + dimension;
+
+    const double l2sqr = reference_l2sqr(v1, v2, dimension);
+    const double ip = reference_inner_product(v1, v2, dimension);
+    const double cosine =
+        ip / std::sqrt(reference_inner_product(v1, v1, dimension) *
+                       reference_inner_product(v2, v2, dimension));
+    EXPECT_NEAR(l2sqr, fb_vector_l2sqr(v1, v2, dimension), 1e-4 * l2sqr);
+    EXPECT_NEAR(ip, fb_vector_inner_product(v1, v2, dimension),
+                1e-4 * std::max(1.0, std::abs(ip)));
+    EXPECT_NEAR(cosine, fb_vector_cosine(v1, v2, dimension), 1e-4);
+  }
+}
+
+/**
+  Helper function for microbenchmarks of the distance kernels: scores a
+  query against 1000 vectors of the given dimension per iteration.
+*/
+static void distance_benchmark(float (*distance)(const float *, const float *,
+                                                 size_t),
+                               size_t dimension, size_t num_iterations) {
+  StopBenchmarkTiming();
+
+  constexpr size_t count = 1000;
+  const auto query = random_vectors(1, dimension);
+  auto vectors = random_vectors(count + 1, dimension);
+  vectors.erase(vectors.begin(), vectors.begin() + dimension);
+
+  float sum = 0;
+  StartBenchmarkTiming();
+  for (size_t i = 0; i < num_iterations; ++i) {
+    for (size_t row = 0; row < count; ++row)
+      sum += distance(query.data(), vectors.data() + row * dimension,
+                      dimension);
+  }
+  StopBenchmarkTiming();
+
+  SetBytesProcessed(num_iterations * count * dimension * sizeof(float));
+  EXPECT_TRUE(std::isfinite(sum));
+}
+
+static void BM_FbVectorL2sqr128(size_t num_iterations) {
+  distance_benchmark(fb_vector_l2sqr, 128, num_iterations);
+}
+BENCHMARK(BM_FbVectorL2sqr128)
+
+static void BM_FbVectorL2sqr768(size_t num_iterations) {
+  distance_benchmark(fb_vector_l2sqr, 768, num_iterations);
+}
+BENCHMARK(BM_FbVectorL2sqr768)
+
+static void BM_FbVectorL2sqr1536(size_t num_iterations) {
+  distance_benchmark(fb_vector_l2sqr, 1536, num_iterations);
+}
+BENCHMARK(BM_FbVectorL2sqr1536)
+
+static void BM_FbVectorInnerProduct768(size_t num_iterations) {
+  distance_benchmark(fb_vector_inner_product, 768, num_iterations);
+}
+BENCHMARK(BM_FbVectorInnerProduct768)
+
+static void BM_FbVectorCosine768(size_t num_iterations) {
+  distance_benchmark(fb_vector_cosine, 768, num_iterations);
+}
+BENCHMARK(BM_FbVectorCosine768)
+
+/**
+  Arrays of doubles take the bulk conversion, and arrays that mix in other
+  element types are refused by it and still decode element by element.
+*/
+TEST(FbVectorTest, ParseJsonDoubleArray) {
+  my_testing::Server_initializer initializer;
+  initializer.SetUp();
+
+  for (const bool mixed : {false, true}) {
+    SCOPED_TRACE(mixed);
+    const auto vector = random_vectors(1, 768);
+    Json_array array;
+    for (const float element : vector)
+      array.append_alias(create_dom_ptr<Json_double>(element));
+    if (mixed) array.append_alias(create_dom_ptr<Json_int>(7));
+    String buf;
+    EXPECT_FALSE(json_binary::serialize(initializer.thd(), &array, &buf));
+
+    const auto value = json_binary::parse_binary(buf.ptr(), buf.length());
+    std::vector<float> bulk(value.element_count());
+    EXPECT_EQ(mixed, value.get_float_array(bulk.data()));
+
+    Json_wrapper wrapper(value);
+    std::vector<float> data;
+    EXPECT_FALSE(parse_fb_vector_from_json(wrapper, data));
+    ASSERT_EQ(vector.size() + (mixed ? 1 : 0), data.size());
+    for (size_t i = 0; i < vector.size(); ++i) EXPECT_EQ(vector[i], data[i]);
+    if (mixed) EXPECT_EQ(7.0f, data.back());
+  }
+  initializer.TearDown();
+}
+
+/**
+  Microbenchmark which tests the performance of decoding a 768 dimension
+  vector stored as a JSON array, as the rows of a vector column are.
+*/
+static void BM_FbVectorParseJson768(size_t num_iterations) {
+  StopBenchmarkTiming();
+
+  my_testing::Server_initializer initializer;
+  initializer.SetUp();
+
+  constexpr size_t dimension = 768;
+  const auto vector = random_vectors(1, dimension);
+  Json_array array;
+  for (const float element : vector)
+    array.append_alias(create_dom_ptr<Json_double>(element));
+  String buf;
+  EXPECT_FALSE(json_binary::serialize(initializer.thd(), &array, &buf));
+
+  std::vector<float> data;
+  StartBenchmarkTiming();
+  for (size_t i = 0; i < num_iterations; ++i) {
+    Json_wrapper wrapper(json_binary::parse_binary(buf.ptr(), buf.length()));
+    EXPECT_FALSE(parse_fb_vector_from_json(wrapper, data));
+  }
+  StopBenchmarkTiming();
+
+  SetBytesProcessed(num_iterations * buf.length());
+  EXPECT_EQ(dimension, data.size());
+  initializer.TearDown();
+}
+BENCHMARK(BM_FbVectorParseJson768)
+
+/**
+  Microbenchmark which tests the performance of taking a 768 dimension
+  vector bound as raw floats, which needs no decoding.
+*/
+static void BM_FbVectorParseBinary768(size_t num_iterations) {
+  StopBenchmarkTiming();
+
+  constexpr size_t dimension = 768;
+  const auto vector = random_vectors(1, dimension);
+  const String str(reinterpret_cast<const char *>(vector.data()),
+                   dimension * sizeof(float), &my_charset_bin);
+
+  size_t parsed = 0;
+  StartBenchmarkTiming();
+  for (size_t i = 0; i < num_iterations; ++i) {
+    Fb_vector data;
+    EXPECT_FALSE(parse_fb_vector_from_binary(&str, false, data));
+    parsed += data.get_dimension();
+  }
+  StopBenchmarkTiming();
+
+  EXPECT_EQ(num_iterations * dimension, parsed);
+}
+BENCHMARK(BM_FbVectorParseBinary768)
+
+/**
+  Helper function for microbenchmarks of a brute force knn search: scores
+  10000 vectors of dimension 128 and keeps the k closest in a max heap, the
+  way lsm vector index scans do.
+*/
+static void top_k_benchmark(size_t k, size_t num_iterations) {
+  StopBenchmarkTiming();
+
+  constexpr size_t dimension = 128;
+  constexpr size_t count = 10000;
+  const auto query = random_vectors(1, dimension);
+  auto vectors = random_vectors(count + 1, dimension);
+  vectors.erase(vectors.begin(), vectors.begin() + dimension);
+
+  std::vector<std::pair<float, size_t>> heap;
+  heap.reserve(k);
+  StartBenchmarkTiming();
+  for (size_t i = 0; i < num_iterations; ++i) {
+    heap.clear();
+    for (size_t row = 0; row < count; ++row) {
+      const float score = fb_vector_l2sqr(
+          query.data(), vectors.data() + row * dimension, dimension);
+      if (heap.size() == k) {
+        if (score >= heap.front().first) continue;
+        std::pop_heap(heap.begin(), heap.end());
+        heap.pop_back();
+      }
+      heap.emplace_back(score, row);
+      std::push_heap(heap.begin(), heap.end());
+    }
+    std::sort_heap(heap.begin(), heap.end());
+  }
+  StopBenchmarkTiming();
+
+  EXPECT_EQ(k, heap.size());
+}
+
+static void BM_FbVectorTopK10(size_t num_iterations) {
+  top_k_benchmark(10, num_iterations);
+}
+BENCHMARK(BM_FbVectorTopK10)
+
+static void BM_FbVectorTopK100(size_t num_iterations) {
+  top_k_benchmark(100, num_iterations);
+}
+BENCHMARK(BM_FbVectorTopK100)
+
+static void BM_FbVectorTopK1000(size_t num_iterations) {
+  top_k_benchmark(1000, num_iterations);
+}
+BENCHMARK(BM_FbVectorTopK1000)
+
+}  // namespace fb_vector_unittest
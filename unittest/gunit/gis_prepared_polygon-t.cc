@@ -0,0 +1,127 @@
+/*
+   Copyright (c) 2025, James Yang.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+
+#include "sql/gis/geometries.h"
+#include "sql/gis/geometries_cs.h"
+#include "sql/gis/prepared_polygon.h"
+#include "sql/gis/relops.h"
+
+namespace gis_prepared_polygon_unittest {
+
+using gis::Cartesian_point;
+using gis::Point_location;
+
+/// A regular polygon with n vertices on a circle, closed.
+static gis::Cartesian_linearring circle(double x, double y, double r, int n) {
+  gis::Cartesian_linearring ring;
+  for (int i = 0; i <= n; ++i) {
+    double a = 2 * M_PI * (i % n) / n;
+    ring.push_back(Cartesian_point(x + r * std::cos(a), y + r * std::sin(a)));
+  }
+  return ring;
+}
+
+/// A square with its lower left corner at (x, y), closed.
+static gis::Cartesian_linearring square(double x, double y, double side) {
+  gis::Cartesian_linearring ring;
+  ring.push_back(Cartesian_point(x, y));
+  ring.push_back(Cartesian_point(x + side, y));
+  ring.push_back(Cartesian_point(x + side, y + side));
+  ring.push_back(Cartesian_point(x, y + side));
+  ring.push_back(Cartesian_point(x, y));
+  return ring;
+}
+
+/// Locates points on a grid and checks them against gis::within and
+/// gis::intersects.
+static void check_grid(const gis::Geometry &g, double from, double to) {
+  std::unique_ptr<gis::Prepared_polygon> prepared =
+      gis::Prepared_polygon::create(g);
+  ASSERT_NE(nullptr, prepared);
+
+  const int steps = 60;
+  for (int i = 0; i <= steps; ++i) {
+    for (int j = 0; j <= steps; ++j) {
+      Cartesian_point pt(from + (to - from) * i / steps,
+                         from + (to - from) * j / steps);
+      Point_location location = prepared->locate(pt);
+      if (location == Point_location::kUnknown) continue;
+
+      bool within, intersects, null;
+      EXPECT_FALSE(gis::within(nullptr, &pt, &g, "unittest", &within, &null));
+      EXPECT_FALSE(
+          gis::intersects(nullptr, &pt, &g, "unittest", &intersects, &null));
+      SCOPED_TRACE(pt.x());
+      SCOPED_TRACE(pt.y());
+      EXPECT_EQ(within, location == Point_location::kInterior);
+      EXPECT_EQ(intersects, location == Point_location::kInterior);
+    }
+  }
+}
+
+TEST(PreparedPolygonTest, NotAPolygon) {
+  Cartesian_point pt(0, 0);
+  EXPECT_EQ(nullptr, gis::Prepared_polygon::create(pt));
+  gis::Cartesian_polygon empty;
+  EXPECT_EQ(nullptr, gis::Prepared_polygon::create(empty));
+}
+
+TEST(PreparedPolygonTest, PolygonWithHole) {
+  gis::Cartesian_polygon py;
+  py.push_back(circle(0, 0, 10, 1000));
+  gis::Cartesian_linearring hole = square(-3, -3, 6);
+  // Interior rings are clockwise.
+  gis::Cartesian_linearring clockwise;
+  for (size_t i = hole.size(); i-- > 0;) clockwise.push_back(hole[i]);
+  py.push_back(clockwise);
+  check_grid(py, -12, 12);
+}
+
+TEST(PreparedPolygonTest, Multipolygon) {
+  gis::Cartesian_multipolygon mpy;
+  gis::Cartesian_polygon a;
+  a.push_back(square(0, 0, 4));
+  gis::Cartesian_polygon b;
+  b.push_back(circle(10, 10, 3, 7));
+  mpy.push_back(a);
+  mpy.push_back(b);
+  check_grid(mpy, -1, 14);
+}
+
+/// Points on the boundary are left to Boost.Geometry.
+TEST(PreparedPolygonTest, Boundary) {
+  gis::Cartesian_polygon py;
+  py.push_back(square(0, 0, 4));
+  std::unique_ptr<gis::Prepared_polygon> prepared =
+      gis::Prepared_polygon::create(py);
+  ASSERT_NE(nullptr, prepared);
+  EXPECT_EQ(Point_location::kUnknown, prepared->locate(Cartesian_point(0, 2)));
+  EXPECT_EQ(Point_location::kUnknown, prepared->locate(Cartesian_point(4, 4)));
+  EXPECT_EQ(Point_location::kInterior,
+            prepared->locate(Cartesian_point(2, 2)));
+  // A ray through a vertex.
+  EXPECT_EQ(Point_location::kExterior,
+            prepared->locate(Cartesian_point(-1, 4)));
+  EXPECT_EQ(Point_location::kExterior,
+            prepared->locate(Cartesian_point(5, 2)));
+}
+
+}  // namespace gis_prepared_polygon_unittest
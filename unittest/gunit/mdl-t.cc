@@ -410,6 +410,58 @@ TEST_F(MDLTest, SharedLocksBetweenContexts) {
   mdl_context2.release_transactional_locks();
 }
 
+#ifndef NDEBUG
+/*
+  Verifies that shared read locks accounted for in per-cpu counters of
+  a hot table conflict with exclusive lock, and that these counters are
+  used again once the exclusive lock is gone.
+ */
+TEST_F(MDLTest, ShardedSharedReadLocks) {
+  mdl_max_sharded_locks = 1;
+  DBUG_SET("+d,mdl_shard_fast_path_locks");
+
+  MDL_context mdl_context2;
+  mdl_context2.init(this);
+  MDL_request request_2;
+  MDL_request request_3;
+  MDL_REQUEST_INIT(&m_request, MDL_key::TABLE, db_name, table_name1,
+                   MDL_SHARED_READ, MDL_TRANSACTION);
+  MDL_REQUEST_INIT(&request_2, MDL_key::TABLE, db_name, table_name1,
+                   MDL_SHARED_READ, MDL_TRANSACTION);
+  MDL_REQUEST_INIT(&request_3, MDL_key::TABLE, db_name, table_name1,
+                   MDL_EXCLUSIVE, MDL_TRANSACTION);
+
+  /* The first request attaches counters, the second one uses them. */
+  EXPECT_FALSE(m_mdl_context.try_acquire_lock(&m_request));
+  EXPECT_NE(m_null_ticket, m_request.ticket);
+  m_mdl_context.release_transactional_locks();
+  m_request.ticket = nullptr;
+  EXPECT_FALSE(m_mdl_context.try_acquire_lock(&m_request));
+  EXPECT_NE(m_null_ticket, m_request.ticket);
+
+  EXPECT_FALSE(mdl_context2.try_acquire_lock(&request_3));
+  EXPECT_EQ(m_null_ticket, request_3.ticket);
+
+  m_mdl_context.release_transactional_locks();
+  EXPECT_FALSE(mdl_context2.try_acquire_lock(&request_3));
+  EXPECT_NE(m_null_ticket, request_3.ticket);
+
+  EXPECT_FALSE(m_mdl_context.try_acquire_lock(&request_2));
+  EXPECT_EQ(m_null_ticket, request_2.ticket);
+
+  mdl_context2.release_transactional_locks();
+  EXPECT_FALSE(m_mdl_context.try_acquire_lock(&request_2));
+  EXPECT_NE(m_null_ticket, request_2.ticket);
+  EXPECT_TRUE(m_mdl_context.owns_equal_or_stronger_lock(
+      MDL_key::TABLE, db_name, table_name1, MDL_SHARED_READ));
+
+  m_mdl_context.release_transactional_locks();
+  mdl_context2.destroy();
+  DBUG_SET("-d,mdl_shard_fast_path_locks");
+  mdl_max_sharded_locks = 0;
+}
+#endif
+
 /*
   Verifies that we can upgrade a shared lock to exclusive.
  */
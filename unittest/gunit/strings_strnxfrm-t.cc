@@ -2192,6 +2192,37 @@ TEST(StrxfrmTest, Contractions) {
   EXPECT_LT(compare_through_strxfrm(hu_ai_ci, "cukor", "csak"), 0);
 }
 
+/*
+  Comparisons skip a common ASCII prefix and sort keys weigh long ASCII runs
+  eight bytes at a time; both must agree with each other on strings that
+  share prefixes of various lengths and differ after them.
+*/
+TEST(StrxfrmTest, AsciiPrefix) {
+  const char *suffixes[] = {"", "a", "A", "b", u8"\u00e9", "\t", " a", "\x01"};
+  for (const char *name :
+       {"utf8mb4_0900_ai_ci", "utf8mb4_0900_as_ci", "utf8mb4_0900_as_cs"}) {
+    SCOPED_TRACE(name);
+    CHARSET_INFO *cs = init_collation(name);
+    for (const size_t prefix_len : {0, 3, 8, 13, 24}) {
+      const std::string prefix =
+          std::string("customer_0000012345_abcd").substr(0, prefix_len);
+      for (const char *s_suffix : suffixes) {
+        for (const char *t_suffix : suffixes) {
+          const std::string s = prefix + s_suffix;
+          const std::string t = prefix + t_suffix;
+          const int expected =
+              compare_through_strxfrm(cs, s.c_str(), t.c_str());
+          const int cmp = my_strnncoll(
+              cs, pointer_cast<const uchar *>(s.data()), s.size(),
+              pointer_cast<const uchar *>(t.data()), t.size());
+          EXPECT_EQ((expected > 0) - (expected < 0), (cmp > 0) - (cmp < 0))
+              << "'" << s << "' vs '" << t << "'";
+        }
+      }
+    }
+  }
+}
+
 /*
   This test is disabled by default since it needs ~10 seconds to run,
   even in optimized mode.
@@ -28,6 +28,7 @@
 #include <gmock/gmock.h>
 #include <string>
 
+#include "plugin/x/src/continuous_query_subscriptions.h"
 #include "plugin/x/src/interface/client.h"
 #include "plugin/x/src/interface/session.h"
 
@@ -75,6 +76,8 @@ class Session : public iface::Session {
       (override));
   MOCK_METHOD(iface::Document_id_aggregator &, get_document_id_aggregator, (),
               (override));
+  MOCK_METHOD(Continuous_query_subscriptions &,
+              get_continuous_query_subscriptions, (), (override));
 };
 
 }  // namespace mock
@@ -33,6 +33,7 @@
 #include "violite.h"  // NOLINT(build/include_subdir)
 
 #include "plugin/x/src/xpl_performance_schema.h"
+#include "sql/continuous_query.h"
 #include "sql/replication.h"
 #include "unittest/gunit/xplugin/xpl/mock/component_services.h"
 
@@ -64,6 +65,14 @@ int unregister_server_state_observer(Server_state_observer *, void *) {
   return 0;
 }
 
+bool continuous_query_listen(const std::string &, const std::string &, bool,
+                             ulonglong, ulonglong,
+                             Continuous_query_listener *) {
+  return true;
+}
+
+void continuous_query_unlisten(ulonglong, Continuous_query_listener *) {}
+
 void ssl_wrapper_version(Vio *, char *, const size_t) {}
 
 void ssl_wrapper_cipher(Vio *, char *, const size_t) {}